@@ -13,10 +13,14 @@ class BuildSamples(Builder.Action):
         samples = [
             'samples/mqtt/basic_pub_sub',
             'samples/mqtt/raw_pub_sub',
+            'samples/mqtt/pub_sub_load',
             'samples/shadow/shadow_sync',
+            'samples/shadow/shadow_benchmark',
             'samples/greengrass/basic_discovery',
             'samples/identity/fleet_provisioning',
+            'samples/identity/provisioning_benchmark',
             'samples/jobs/describe_job_execution',
+            'samples/fleet/device_simulator',
         ]
         for sample_path in samples:
             build_path = os.path.join('build', sample_path)
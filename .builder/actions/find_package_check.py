@@ -0,0 +1,19 @@
+import Builder
+import os
+import sys
+
+
+class FindPackageCheck(Builder.Action):
+    def run(self, env):
+        if env.args.cli_config['variables'].get('find_package_check', "0") == "0":
+            print('find_package_check is not defined. Skipping the find_package check...')
+            return
+
+        project_path = os.path.join('.builder', 'find_package_check')
+        build_path = os.path.join('build', 'find_package_check')
+        steps = [['cmake',
+                  f'-B{build_path}',
+                  f'-H{project_path}',
+                  f'-DCMAKE_PREFIX_PATH={env.install_dir}']]
+
+        return Builder.Script(steps)
@@ -0,0 +1,137 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/clock.h>
+#include <aws/crt/Types.h>
+
+#include <cstdio>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+
+        /**
+         * Written by every benchmark body so the compiler cannot drop the measured work.
+         */
+        extern volatile size_t g_sink;
+
+        /**
+         * Each benchmark runs for at least this long after one untimed warm-up call.
+         */
+        static const uint64_t s_minDurationNs = 200 * 1000 * 1000;
+
+        /**
+         * Calls `op` repeatedly and prints the mean wall time per call, plus throughput when `payloadBytes`
+         * is non-zero. Output is one tab-separated line per benchmark so runs can be diffed.
+         */
+        template <typename Op> void Run(const char *name, size_t payloadBytes, Op &&op)
+        {
+            op();
+
+            uint64_t iterations = 0;
+            uint64_t start = 0;
+            uint64_t now = 0;
+            aws_high_res_clock_get_ticks(&start);
+            do
+            {
+                for (int i = 0; i < 64; ++i)
+                {
+                    op();
+                }
+                iterations += 64;
+                aws_high_res_clock_get_ticks(&now);
+            } while (now - start < s_minDurationNs);
+
+            double nsPerOp = static_cast<double>(now - start) / static_cast<double>(iterations);
+            if (payloadBytes)
+            {
+                double mbPerSecond = static_cast<double>(payloadBytes) * 1000.0 / nsPerOp;
+                printf("%-56s\t%8zu B\t%12.1f ns/op\t%10.1f MB/s\n", name, payloadBytes, nsPerOp, mbPerSecond);
+            }
+            else
+            {
+                printf("%-56s\t%8s  \t%12.1f ns/op\n", name, "-", nsPerOp);
+            }
+        }
+
+        /**
+         * Representative payload sizes: a typical control message, a mid-sized document and a large one.
+         */
+        static const size_t s_payloadSizes[] = {256, 4 * 1024, 64 * 1024};
+
+        /**
+         * Returns a JSON object of string members whose encoded size is roughly `targetBytes`, used as a
+         * job document or shadow state body.
+         */
+        Crt::String MakeJsonDocument(size_t targetBytes);
+
+        Crt::ByteBuf ByteBufFromString(const Crt::String &value) noexcept;
+
+        void RunShadowBenchmarks();
+        void RunJobsBenchmarks();
+        void RunIdentityBenchmarks();
+
+        /**
+         * Parses, loads and serializes every generated shadow, jobs and identity model, and parses the discovery
+         * models when built with Discovery, over the payloads of BuildCorpus.
+         */
+        void RunModelBenchmarks();
+
+        /**
+         * Compares finding and walking members of corpus payloads with Iotdevicecommon::JsonPayloadScanner, in
+         * whichever scanning it was built with, against parsing them into a Crt::JsonObject.
+         */
+        void RunJsonBackendBenchmarks();
+
+        /**
+         * Drives the shadow and jobs clients and the fleet provisioning pipeline end to end against an in-process
+         * MockBroker and reports request rate, devices per minute and round-trip latency. Returns false if any
+         * request failed or timed out.
+         */
+        bool RunLoopbackBenchmarks();
+
+        /**
+         * Compares publish-to-subscriber message rate and latency between two Discovery::GreengrassIpcClient
+         * components of an in-process MockIpcServer and two MQTT connections through a MockBroker. Returns false
+         * if a message was lost. Only built with Discovery.
+         */
+        bool RunIpcBenchmarks();
+
+        /**
+         * Runs shadow updates, job notifications and, when built with Device Defender, metrics reports against
+         * a MockBroker for `minutes`, sampling resident memory, the SDK's heap and latency percentiles. Returns
+         * false if a request failed or a sampled series grew steadily over the run.
+         */
+        bool RunSoakTest(uint32_t minutes);
+
+        /**
+         * Publishes the inbound shadow and jobs messages of a trace written by Iotdevicecommon::TrafficRecorder
+         * through a MockBroker to the shadow and jobs clients of another connection, subscribed to them for every
+         * thing of the trace, at the trace's own pace or, with `maxSpeed`, as fast as they can be published, and
+         * reports the rate they were parsed and handled at. With `dispatch`, the clients' subscriptions go
+         * through an Iotdevicecommon::ThingTopicDispatcher. Returns false if the trace could not be read or a
+         * message was lost.
+         */
+        bool RunTraceReplay(const char *path, bool maxSpeed, bool dispatch);
+
+        /**
+         * Encodes Device Defender custom metric reports of several sizes as JSON and as CBOR, printing each
+         * format's encoded size with its time per report. Only built with Device Defender.
+         */
+        void RunDeviceDefenderBenchmarks();
+
+        /**
+         * Feeds DATA frames of several sizes to a destination-mode Iotsecuretunneling::SecureTunnel through its
+         * websocket payload handler and reports receive throughput, per-frame latency and CPU time per MB. Only
+         * the receive path is measured: no proxy, no source side. Then round-trips text and random bytes through
+         * the stream compression at several levels and windows, reporting the ratio and CPU time per MB. Returns
+         * false if a byte was not delivered or decoded. Only built with Secure Tunneling.
+         */
+        bool RunSecureTunnelingBenchmarks();
+
+    } // namespace Benchmarks
+} // namespace Aws
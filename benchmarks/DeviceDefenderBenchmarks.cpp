@@ -0,0 +1,58 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+
+#ifdef AWS_BENCHMARKS_DEVICE_DEFENDER
+
+#    include <aws/iotdevicedefender/DeviceDefender.h>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+
+        void RunDeviceDefenderBenchmarks()
+        {
+            const size_t metricCounts[] = {10, 100, 500};
+            for (size_t metricCount : metricCounts)
+            {
+                Iotdevicedefenderv1::CustomMetricValues values;
+                for (size_t i = 0; i < metricCount; ++i)
+                {
+                    char name[32];
+                    snprintf(name, sizeof(name), "connection_%zu", i);
+                    values.emplace_back(name, static_cast<int64_t>(i * 7919) % 65536);
+                }
+
+                struct Format
+                {
+                    const char *Name;
+                    Iotdevicedefenderv1::ReportFormat Value;
+                };
+                const Format formats[] = {
+                    {"json", Iotdevicedefenderv1::ReportFormat::AWS_IDDRF_JSON},
+                    {"cbor", Iotdevicedefenderv1::ReportFormat::AWS_IDDRF_CBOR}};
+                for (const Format &format : formats)
+                {
+                    Crt::Vector<uint8_t> encoded;
+                    int64_t reportId = 1600000000000LL;
+                    Iotdevicedefenderv1::EncodeCustomMetricsReport(format.Value, reportId, values, encoded);
+
+                    /* The payload size printed is the encoded report's, so the formats compare in size too. */
+                    char name[96];
+                    snprintf(name, sizeof(name), "defender/encode/%s/%zu metrics", format.Name, metricCount);
+                    Run(name, encoded.size(), [&format, &reportId, &values, &encoded]() {
+                        Iotdevicedefenderv1::EncodeCustomMetricsReport(format.Value, ++reportId, values, encoded);
+                        g_sink = encoded.size();
+                    });
+                }
+            }
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+
+#include <aws/iotdevicecommon/PayloadBufferPool.h>
+#include <aws/iotdevicecommon/PayloadCodec.h>
+#include <aws/iotidentity/RegisterThingRequest.h>
+#include <aws/iotidentity/RegisterThingResponse.h>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+
+        void RunIdentityBenchmarks()
+        {
+            /* Provisioning messages are small and sent once per device, so only the typical size is measured. */
+            Crt::String payload = Crt::String("{\"thingName\":\"benchmark-thing\",\"deviceConfiguration\":") +
+                                  MakeJsonDocument(s_payloadSizes[0]) + "}";
+            Run("identity/parse/RegisterThingResponse", payload.size(), [&payload]() {
+                Crt::JsonObject jsonObject(payload);
+                Iotidentity::RegisterThingResponse response(jsonObject);
+                g_sink = response.DeviceConfiguration->size();
+            });
+
+            Iotidentity::RegisterThingRequest request;
+            request.TemplateName = "benchmark-template";
+            request.CertificateOwnershipToken = Crt::String(512, 't');
+            request.Parameters = Crt::Map<Crt::String, Crt::String>();
+            (*request.Parameters)["SerialNumber"] = "0123456789";
+            (*request.Parameters)["DeviceLocation"] = "benchmark-lab";
+
+            Crt::JsonObject tree;
+            request.SerializeToObject(tree);
+            size_t encodedSize = tree.View().WriteCompact(true).size();
+
+            Run("identity/serialize/RegisterThingRequest/tree", encodedSize, [&request]() {
+                Crt::JsonObject object;
+                request.SerializeToObject(object);
+                Crt::String outgoingJson = object.View().WriteCompact(true);
+                g_sink = outgoingJson.size();
+            });
+
+            Iotdevicecommon::PayloadBufferPool pool(1, SIZE_MAX);
+            Run("identity/serialize/RegisterThingRequest/json", encodedSize, [&request, &pool]() {
+                Crt::ByteBuf buf = pool.Acquire();
+                Iotdevicecommon::SerializePayload(request, Iotdevicecommon::PayloadFormat::Json, buf);
+                g_sink = buf.len;
+                pool.Release(buf);
+            });
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
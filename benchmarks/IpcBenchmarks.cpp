@@ -0,0 +1,208 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+#include "LoopbackHarness.h"
+
+#if !defined(_WIN32) && defined(AWS_BENCHMARKS_DISCOVERY)
+
+#    include "MockIpcServer.h"
+
+#    include <aws/discovery/GreengrassIpcClient.h>
+
+#    include <cstring>
+#    include <future>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            /* Messages per measurement, at most s_window of them published and not yet received. */
+            const size_t s_messageCount = 2000;
+            const size_t s_window = 32;
+
+            const char *s_topic = "benchmarks/ipc";
+
+            /* The publish time travels in the message, so the receiving side needs no shared state. */
+            void s_stamp(Crt::String &payload)
+            {
+                uint64_t now = Ticks();
+                memcpy(&payload[0], &now, sizeof(now));
+            }
+
+            uint64_t s_stampOf(const uint8_t *payload, size_t length)
+            {
+                uint64_t stamp = 0;
+                if (length >= sizeof(stamp))
+                {
+                    memcpy(&stamp, payload, sizeof(stamp));
+                }
+                return stamp;
+            }
+
+            /* Same line as the loopback runs': message rate and publish-to-delivery latency percentiles. */
+            void s_report(const char *name, size_t payloadBytes, Crt::Vector<uint64_t> latencies, uint64_t elapsedNs)
+            {
+                size_t count = latencies.size();
+                LatencySummary summary;
+                if (!Summarize(std::move(latencies), summary))
+                {
+                    return;
+                }
+                printf(
+                    "%-56s\t%8zu B\t%10.0f msg/s\tp50 %9.1f us\tp99 %9.1f us\tmax %9.1f us\n",
+                    name,
+                    payloadBytes,
+                    static_cast<double>(count) * 1e9 / static_cast<double>(elapsedNs),
+                    summary.P50Us,
+                    summary.P99Us,
+                    summary.MaxUs);
+            }
+
+            /* Publishes s_messageCount stamped messages of `size` bytes with `publish`, keeping s_window in flight. */
+            template <typename Publish>
+            bool s_measure(const char *path, size_t size, Completions &completions, Publish &&publish)
+            {
+                Crt::String payload(size, 'x');
+                uint64_t start = Ticks();
+                for (size_t issued = 0; issued < s_messageCount; ++issued)
+                {
+                    if (!completions.Wait(issued, s_window - 1))
+                    {
+                        fprintf(stderr, "ipc: %s delivery timed out\n", path);
+                        return false;
+                    }
+                    s_stamp(payload);
+                    if (!publish(payload))
+                    {
+                        fprintf(stderr, "ipc: %s publish failed\n", path);
+                        return false;
+                    }
+                }
+                if (!completions.Wait(s_messageCount, 0) || completions.Failed())
+                {
+                    fprintf(stderr, "ipc: %zu %s publishes failed\n", completions.Failed(), path);
+                    return false;
+                }
+
+                char name[96];
+                snprintf(name, sizeof(name), "ipc/publish-to-subscriber/%s/%zu", path, size);
+                s_report(name, size, completions.TakeLatencies(), Ticks() - start);
+                return true;
+            }
+
+            bool s_runIpc()
+            {
+                MockIpcServer server;
+                if (!server.Start())
+                {
+                    fprintf(stderr, "ipc: could not start the mock IPC server\n");
+                    return false;
+                }
+
+                Discovery::GreengrassIpcClientConfig config;
+                config.SocketPath = server.GetSocketPath();
+                config.AuthToken = "benchmark";
+                auto publisher = Discovery::GreengrassIpcClient::Create(config);
+                auto subscriber = Discovery::GreengrassIpcClient::Create(config);
+                if (!publisher || !subscriber || !publisher->Connect() || !subscriber->Connect())
+                {
+                    fprintf(stderr, "ipc: could not connect to the mock IPC server\n");
+                    return false;
+                }
+
+                Completions completions;
+                std::promise<int> subscribed;
+                int32_t subscription = subscriber->Subscribe(
+                    s_topic,
+                    [&completions](const Crt::String &, const Crt::ByteCursor &payload) {
+                        completions.Complete(s_stampOf(payload.ptr, payload.len), true);
+                    },
+                    [&subscribed](int errorCode, const Crt::String &) { subscribed.set_value(errorCode); });
+                auto subscribedResult = subscribed.get_future();
+                if (!subscription || subscribedResult.wait_for(s_loopbackTimeout) != std::future_status::ready ||
+                    subscribedResult.get())
+                {
+                    fprintf(stderr, "ipc: subscription failed\n");
+                    return false;
+                }
+
+                for (size_t size : s_payloadSizes)
+                {
+                    bool measured = s_measure("ipc", size, completions, [&publisher](const Crt::String &payload) {
+                        auto bytes = reinterpret_cast<const uint8_t *>(payload.data());
+                        return publisher->Publish(s_topic, Crt::ByteCursorFromArray(bytes, payload.size()));
+                    });
+                    if (!measured)
+                    {
+                        return false;
+                    }
+                }
+
+                subscriber->Close();
+                publisher->Close();
+                return true;
+            }
+
+            bool s_runMqtt()
+            {
+                MockBroker broker;
+                if (!broker.Start())
+                {
+                    fprintf(stderr, "ipc: could not start the mock broker\n");
+                    return false;
+                }
+
+                LoopbackConnection publisher;
+                LoopbackConnection subscriber;
+                if (!publisher.Connect(broker, "ipc-benchmark-publisher") ||
+                    !subscriber.Connect(broker, "ipc-benchmark-subscriber"))
+                {
+                    return false;
+                }
+
+                Completions completions;
+                std::promise<int> subscribed;
+                subscriber.GetConnection()->Subscribe(
+                    s_topic,
+                    AWS_MQTT_QOS_AT_MOST_ONCE,
+                    [&completions](Crt::Mqtt::MqttConnection &, const Crt::String &, const Crt::ByteBuf &payload) {
+                        completions.Complete(s_stampOf(payload.buffer, payload.len), true);
+                    },
+                    [&subscribed](
+                        Crt::Mqtt::MqttConnection &, uint16_t, const Crt::String &, Crt::Mqtt::QOS, int ioErr) {
+                        subscribed.set_value(ioErr);
+                    });
+                auto subscribedResult = subscribed.get_future();
+                if (subscribedResult.wait_for(s_loopbackTimeout) != std::future_status::ready || subscribedResult.get())
+                {
+                    fprintf(stderr, "ipc: mqtt subscription failed\n");
+                    return false;
+                }
+
+                const auto &connection = publisher.GetConnection();
+                for (size_t size : s_payloadSizes)
+                {
+                    bool measured = s_measure("mqtt-tcp", size, completions, [&connection](const Crt::String &payload) {
+                        Crt::ByteBuf buf = ByteBufFromString(payload);
+                        return connection->Publish(s_topic, AWS_MQTT_QOS_AT_MOST_ONCE, false, buf, nullptr) != 0;
+                    });
+                    if (!measured)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        } // namespace
+
+        bool RunIpcBenchmarks() { return s_runIpc() && s_runMqtt(); }
+
+    } // namespace Benchmarks
+} // namespace Aws
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+
+#include <aws/iotdevicecommon/PayloadBufferPool.h>
+#include <aws/iotdevicecommon/PayloadCodec.h>
+#include <aws/iotdevicecommon/TopicBuilder.h>
+#include <aws/iotjobs/JobExecutionDataView.h>
+#include <aws/iotjobs/JobPayloadScanner.h>
+#include <aws/iotjobs/NextJobExecutionChangedEvent.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+
+#include <memory>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            Crt::String s_makeNextJobExecutionChangedEvent(size_t jobDocumentBytes)
+            {
+                return Crt::String("{\"execution\":{\"jobId\":\"benchmark-job\",\"thingName\":\"benchmark-thing\","
+                                   "\"status\":\"QUEUED\",\"queuedAt\":1600000000,\"lastUpdatedAt\":1600000000,"
+                                   "\"versionNumber\":1,\"executionNumber\":1,\"jobDocument\":") +
+                       MakeJsonDocument(jobDocumentBytes) + "},\"timestamp\":1600000000}";
+            }
+
+            void s_runParseBenchmarks(size_t size)
+            {
+                Crt::String payload = s_makeNextJobExecutionChangedEvent(size);
+                Crt::ByteBuf payloadBuf = ByteBufFromString(payload);
+
+                char name[96];
+                snprintf(name, sizeof(name), "jobs/parse/NextJobExecutionChangedEvent/eager/%zu", size);
+                Run(name, payload.size(), [&payload]() {
+                    Crt::JsonObject jsonObject(payload);
+                    Iotjobs::NextJobExecutionChangedEvent event(jsonObject);
+                    g_sink = event.Execution->JobId->size();
+                });
+
+                snprintf(name, sizeof(name), "jobs/parse/NextJobExecutionChangedEvent/view/%zu", size);
+                Run(name, payload.size(), [&payload]() {
+                    auto message = Crt::MakeShared<Crt::JsonObject>(Crt::DefaultAllocator(), payload);
+                    Iotjobs::JobExecutionDataView view(message);
+                    g_sink = view.GetJobId()->size();
+                });
+
+                snprintf(name, sizeof(name), "jobs/parse/NextJobExecutionChangedEvent/raw-scan/%zu", size);
+                Run(name, payload.size(), [&payloadBuf]() {
+                    Crt::ByteCursor jobDocument;
+                    AWS_ZERO_STRUCT(jobDocument);
+                    Iotjobs::JobPayloadScanner::FindJobDocument(Crt::ByteCursorFromByteBuf(payloadBuf), jobDocument);
+                    g_sink = jobDocument.len;
+                });
+            }
+
+            /* The update topic, built the way the client used to and the way it does now. */
+            void s_runTopicBenchmarks()
+            {
+                Crt::String thingName("benchmark-thing");
+                Crt::String jobId("benchmark-job");
+
+                Run("jobs/topic/UpdateJobExecution/string-stream", 0, [&thingName, &jobId]() {
+                    Crt::StringStream topic;
+                    topic << "$aws"
+                          << "/"
+                          << "things"
+                          << "/" << thingName << "/"
+                          << "jobs"
+                          << "/" << jobId << "/"
+                          << "update";
+                    g_sink = topic.str().size();
+                });
+
+                Run("jobs/topic/UpdateJobExecution/topic-builder", 0, [&thingName, &jobId]() {
+                    Iotdevicecommon::TopicBuilder topic;
+                    topic << "$aws"
+                          << "/"
+                          << "things"
+                          << "/" << thingName << "/"
+                          << "jobs"
+                          << "/" << jobId << "/"
+                          << "update";
+                    g_sink = topic.length();
+                });
+            }
+
+            void s_runSerializeBenchmarks(size_t size)
+            {
+                Iotjobs::UpdateJobExecutionRequest request;
+                request.ThingName = "benchmark-thing";
+                request.JobId = "benchmark-job";
+                request.Status = Iotjobs::JobStatus::IN_PROGRESS;
+                request.ExpectedVersion = 1;
+                request.ClientToken = "a8b6b0a0-6c8f-4a3e-9d3e-6f0a7b8c9d0e";
+                request.StatusDetails = Iotdevicecommon::FlatStringMap();
+
+                /* Status details are the variable-size part of a progress update. */
+                char key[32];
+                for (size_t i = 0; i * 32 < size; ++i)
+                {
+                    snprintf(key, sizeof(key), "step%06zu", i);
+                    (*request.StatusDetails)[key] = "completed";
+                }
+
+                Crt::JsonObject tree;
+                request.SerializeToObject(tree);
+                size_t encodedSize = tree.View().WriteCompact(true).size();
+
+                char name[96];
+                snprintf(name, sizeof(name), "jobs/serialize/UpdateJobExecutionRequest/tree/%zu", size);
+                Run(name, encodedSize, [&request]() {
+                    Crt::JsonObject object;
+                    request.SerializeToObject(object);
+                    Crt::String outgoingJson = object.View().WriteCompact(true);
+                    g_sink = outgoingJson.size();
+                });
+
+                Iotdevicecommon::PayloadBufferPool pool(1, SIZE_MAX);
+                const Iotdevicecommon::PayloadFormat formats[] = {Iotdevicecommon::PayloadFormat::Json,
+                                                                  Iotdevicecommon::PayloadFormat::Cbor};
+                for (auto format : formats)
+                {
+                    Crt::ByteBuf sized = pool.Acquire();
+                    Iotdevicecommon::SerializePayload(request, format, sized);
+                    size_t formatSize = sized.len;
+                    pool.Release(sized);
+
+                    snprintf(
+                        name,
+                        sizeof(name),
+                        "jobs/serialize/UpdateJobExecutionRequest/%s/%zu",
+                        format == Iotdevicecommon::PayloadFormat::Json ? "json" : "cbor",
+                        size);
+                    Run(name, formatSize, [&request, &pool, format]() {
+                        Crt::ByteBuf buf = pool.Acquire();
+                        Iotdevicecommon::SerializePayload(request, format, buf);
+                        g_sink = buf.len;
+                        pool.Release(buf);
+                    });
+                }
+            }
+        } // namespace
+
+        void RunJobsBenchmarks()
+        {
+            for (size_t size : s_payloadSizes)
+            {
+                s_runParseBenchmarks(size);
+                s_runSerializeBenchmarks(size);
+            }
+            s_runTopicBenchmarks();
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
@@ -0,0 +1,123 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+#include "PayloadCorpus.h"
+
+#include <aws/crt/JsonObject.h>
+#include <aws/iotdevicecommon/JsonPayloadScanner.h>
+#include <aws/iotjobs/JobPayloadScanner.h>
+
+#include <cstring>
+#include <functional>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            namespace Scanner = Iotdevicecommon::JsonPayloadScanner;
+
+            /* Visits every value of a document through the scanner alone, as a typed binding does. */
+            size_t s_scanValues(const Crt::ByteCursor &value)
+            {
+                size_t values = 1;
+                const uint8_t first = value.len ? value.ptr[0] : 0;
+                if (first == '{')
+                {
+                    Scanner::ForEachMember(value, [&values](const Crt::ByteCursor &, const Crt::ByteCursor &member) {
+                        values += s_scanValues(member);
+                        return true;
+                    });
+                }
+                else if (first == '[')
+                {
+                    Scanner::ForEachElement(value, [&values](const Crt::ByteCursor &element) {
+                        values += s_scanValues(element);
+                        return true;
+                    });
+                }
+                return values;
+            }
+
+            void s_runPair(
+                const char *task,
+                const CorpusEntry &entry,
+                const std::function<size_t(const Crt::ByteCursor &)> &scan,
+                const std::function<size_t(const Crt::String &)> &parse)
+            {
+                Crt::ByteCursor payload = Crt::ByteCursorFromString(entry.Payload);
+                char name[96];
+                snprintf(name, sizeof(name), "json/%s/%s/%s/%s", Scanner::Backend(), task, entry.Model, entry.Size);
+                Run(name, entry.Payload.size(), [&scan, &payload]() { g_sink = scan(payload); });
+
+                snprintf(name, sizeof(name), "json/cjson/%s/%s/%s", task, entry.Model, entry.Size);
+                Run(name, entry.Payload.size(), [&parse, &entry]() { g_sink = parse(entry.Payload); });
+            }
+        } // namespace
+
+        void RunJsonBackendBenchmarks()
+        {
+            /* The shadow version a client checks before deciding to decode an update at all. */
+            for (const CorpusEntry &entry : BuildCorpus("shadow"))
+            {
+                if (strcmp(entry.Model, "GetShadowResponse") != 0 && strcmp(entry.Model, "ShadowUpdatedEvent") != 0)
+                {
+                    continue;
+                }
+                const char *key = strcmp(entry.Model, "GetShadowResponse") == 0 ? "version" : "timestamp";
+                s_runPair(
+                    "find-integer",
+                    entry,
+                    [key](const Crt::ByteCursor &payload) {
+                        Crt::ByteCursor value;
+                        int64_t integer = 0;
+                        if (Scanner::FindMember(payload, key, value))
+                        {
+                            Scanner::ReadInteger(value, integer);
+                        }
+                        return static_cast<size_t>(integer);
+                    },
+                    [key](const Crt::String &payload) {
+                        Crt::JsonObject document(payload);
+                        return static_cast<size_t>(document.View().GetInt64(key));
+                    });
+                s_runPair(
+                    "walk",
+                    entry,
+                    [](const Crt::ByteCursor &payload) { return s_scanValues(payload); },
+                    [](const Crt::String &payload) {
+                        Crt::JsonObject document(payload);
+                        return static_cast<size_t>(document.WasParseSuccessful());
+                    });
+            }
+
+            /* The job document a raw-payload job subscription hands to the application. */
+            for (const CorpusEntry &entry : BuildCorpus("jobs"))
+            {
+                if (strcmp(entry.Model, "StartNextJobExecutionResponse") != 0)
+                {
+                    continue;
+                }
+                s_runPair(
+                    "find-job-document",
+                    entry,
+                    [](const Crt::ByteCursor &payload) {
+                        Crt::ByteCursor jobDocument;
+                        Iotjobs::JobPayloadScanner::FindJobDocument(payload, jobDocument);
+                        return jobDocument.len;
+                    },
+                    [](const Crt::String &payload) {
+                        Crt::JsonObject document(payload);
+                        Crt::JsonView jobDocument = document.View().GetJsonObject("execution").GetJsonObject(
+                            "jobDocument");
+                        return static_cast<size_t>(jobDocument.IsObject());
+                    });
+            }
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
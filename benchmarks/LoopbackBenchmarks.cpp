@@ -0,0 +1,326 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+#include "LoopbackHarness.h"
+
+#ifndef _WIN32
+
+#    include <aws/iotidentity/IotIdentityClient.h>
+#    include <aws/iotidentity/ProvisioningPipeline.h>
+#    include <aws/iotjobs/IotJobsClient.h>
+#    include <aws/iotjobs/JobsRequestCorrelator.h>
+#    include <aws/iotjobs/StartNextJobExecutionResponse.h>
+#    include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
+#    include <aws/iotjobs/UpdateJobExecutionRequest.h>
+#    include <aws/iotjobs/UpdateJobExecutionResponse.h>
+#    include <aws/iotshadow/IotShadowClient.h>
+#    include <aws/iotshadow/ShadowRequestCorrelator.h>
+#    include <aws/iotshadow/UpdateShadowResponse.h>
+
+#    include <future>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            /* Requests per measurement; with the pipelined runs, at most s_window are in flight at once. */
+            const size_t s_requestCount = 1000;
+            const size_t s_window = 32;
+
+            /* One tab-separated line, like Run's: request rate and round-trip latency percentiles. */
+            void s_report(const char *name, size_t payloadBytes, Crt::Vector<uint64_t> latencies, uint64_t elapsedNs)
+            {
+                size_t count = latencies.size();
+                LatencySummary summary;
+                if (!Summarize(std::move(latencies), summary))
+                {
+                    return;
+                }
+                printf(
+                    "%-56s\t%8zu B\t%10.0f req/s\tp50 %9.1f us\tp99 %9.1f us\tmax %9.1f us\n",
+                    name,
+                    payloadBytes,
+                    static_cast<double>(count) * 1e9 / static_cast<double>(elapsedNs),
+                    summary.P50Us,
+                    summary.P99Us,
+                    summary.MaxUs);
+            }
+
+            bool s_runShadowBenchmarks(
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection)
+            {
+                Iotshadow::IotShadowClient client(connection);
+                auto correlator = Iotshadow::ShadowRequestCorrelator::Create(
+                    client, eventLoopGroup, "loopback-thing", Iotshadow::ShadowRequestCorrelatorConfig());
+                std::promise<int> subscribed;
+                if (!correlator || !correlator->Subscribe(AWS_MQTT_QOS_AT_LEAST_ONCE, [&subscribed](int ioErr) {
+                        subscribed.set_value(ioErr);
+                    }))
+                {
+                    return false;
+                }
+                auto subscribedResult = subscribed.get_future();
+                if (subscribedResult.wait_for(s_loopbackTimeout) != std::future_status::ready || subscribedResult.get())
+                {
+                    fprintf(stderr, "loopback: shadow subscriptions failed\n");
+                    return false;
+                }
+
+                for (size_t size : s_payloadSizes)
+                {
+                    Iotshadow::ShadowState state;
+                    state.Reported = Crt::JsonObject(MakeJsonDocument(size));
+
+                    const size_t windows[] = {1, s_window};
+                    for (size_t window : windows)
+                    {
+                        Completions completions;
+                        uint64_t start = Ticks();
+                        for (size_t issued = 0; issued < s_requestCount; ++issued)
+                        {
+                            if (!completions.Wait(issued, window - 1))
+                            {
+                                fprintf(stderr, "loopback: shadow update timed out\n");
+                                return false;
+                            }
+
+                            uint64_t requestStart = Ticks();
+                            bool sent = correlator->UpdateShadowAsync(
+                                state,
+                                Crt::Optional<int32_t>(),
+                                AWS_MQTT_QOS_AT_LEAST_ONCE,
+                                [&completions, requestStart](
+                                    Iotshadow::UpdateShadowResponse *response, Iotshadow::ErrorResponse *, int) {
+                                    completions.Complete(requestStart, response != nullptr);
+                                });
+                            if (!sent)
+                            {
+                                return false;
+                            }
+                        }
+                        if (!completions.Wait(s_requestCount, 0) || completions.Failed())
+                        {
+                            fprintf(stderr, "loopback: %zu shadow updates failed\n", completions.Failed());
+                            return false;
+                        }
+
+                        char name[96];
+                        snprintf(
+                            name,
+                            sizeof(name),
+                            "loopback/shadow/update/%s/%zu",
+                            window == 1 ? "serial" : "pipelined",
+                            size);
+                        s_report(name, size, completions.TakeLatencies(), Ticks() - start);
+                    }
+                }
+                return true;
+            }
+
+            bool s_runJobsBenchmarks(
+                MockBroker &broker,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection)
+            {
+                Iotjobs::IotJobsClient client(connection);
+                auto correlator = Iotjobs::JobsRequestCorrelator::Create(
+                    client, eventLoopGroup, "loopback-thing", Iotjobs::JobsRequestCorrelatorConfig());
+                std::promise<int> subscribed;
+                if (!correlator || !correlator->Subscribe([&subscribed](int ioErr) { subscribed.set_value(ioErr); }))
+                {
+                    return false;
+                }
+                auto subscribedResult = subscribed.get_future();
+                if (subscribedResult.wait_for(s_loopbackTimeout) != std::future_status::ready || subscribedResult.get())
+                {
+                    fprintf(stderr, "loopback: jobs subscriptions failed\n");
+                    return false;
+                }
+
+                for (size_t size : s_payloadSizes)
+                {
+                    Crt::JsonObject jobDocument(MakeJsonDocument(size));
+                    for (size_t i = 0; i < s_requestCount; ++i)
+                    {
+                        char jobId[64];
+                        snprintf(jobId, sizeof(jobId), "loopback-job-%zu-%zu", size, i);
+                        broker.AddJob("loopback-thing", jobId, jobDocument);
+                    }
+
+                    /* Each cycle is the agent's inner loop: start the next job, then report it done. */
+                    Completions completions;
+                    uint64_t start = Ticks();
+                    for (size_t i = 0; i < s_requestCount; ++i)
+                    {
+                        uint64_t cycleStart = Ticks();
+                        std::promise<Crt::String> started;
+                        correlator->StartNextPendingJobExecutionAsync(
+                            Iotjobs::StartNextPendingJobExecutionRequest(),
+                            [&started](
+                                Iotjobs::StartNextJobExecutionResponse *response, Iotjobs::RejectedError *, int) {
+                                bool hasJob = response && response->Execution && response->Execution->JobId;
+                                started.set_value(hasJob ? *response->Execution->JobId : Crt::String());
+                            });
+                        auto startedJob = started.get_future();
+                        if (startedJob.wait_for(s_loopbackTimeout) != std::future_status::ready)
+                        {
+                            fprintf(stderr, "loopback: start-next timed out\n");
+                            return false;
+                        }
+
+                        Iotjobs::UpdateJobExecutionRequest update;
+                        update.JobId = startedJob.get();
+                        update.Status = Iotjobs::JobStatus::SUCCEEDED;
+                        correlator->UpdateJobExecutionAsync(
+                            update,
+                            [&completions, cycleStart](
+                                Iotjobs::UpdateJobExecutionResponse *response, Iotjobs::RejectedError *, int) {
+                                completions.Complete(cycleStart, response != nullptr);
+                            });
+                        if (!completions.Wait(i + 1, 0))
+                        {
+                            fprintf(stderr, "loopback: job update timed out\n");
+                            return false;
+                        }
+                    }
+                    if (completions.Failed())
+                    {
+                        fprintf(stderr, "loopback: %zu job updates failed\n", completions.Failed());
+                        return false;
+                    }
+
+                    char name[96];
+                    snprintf(name, sizeof(name), "loopback/jobs/start-next+update/%zu", size);
+                    s_report(name, size, completions.TakeLatencies(), Ticks() - start);
+                }
+                return true;
+            }
+
+            /* A flow's stage mean and max, from the pipeline's own per-stage timing. */
+            void s_reportStage(const char *name, const Iotidentity::ProvisioningStageStats &stage)
+            {
+                if (stage.Count == 0)
+                {
+                    return;
+                }
+                printf(
+                    "%-56s\t%8s  \t%10s      \tmean %8.1f us\tmax %9.1f us\n",
+                    name,
+                    "",
+                    "",
+                    static_cast<double>(stage.TotalNs) / static_cast<double>(stage.Count) / 1e3,
+                    static_cast<double>(stage.MaxNs) / 1e3);
+            }
+
+            bool s_runProvisioningBenchmarks(
+                MockBroker &broker,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection)
+            {
+                /* A placeholder CSR: the mock broker only checks that one is present. */
+                Iotidentity::ProvisioningRequest request;
+                request.CertificateSigningRequest =
+                    "-----BEGIN CERTIFICATE REQUEST-----\nloopback\n-----END CERTIFICATE REQUEST-----\n";
+
+                const size_t windows[] = {1, s_window};
+                for (size_t window : windows)
+                {
+                    Iotidentity::IotIdentityClient client(connection);
+                    Iotidentity::ProvisioningPipelineConfig config;
+                    config.TemplateName = "loopback-template";
+                    config.MaxInFlight = window;
+                    auto pipeline = Iotidentity::ProvisioningPipeline::Create(client, eventLoopGroup, config);
+                    std::promise<int> subscribed;
+                    if (!pipeline || !pipeline->Subscribe([&subscribed](int ioErr) { subscribed.set_value(ioErr); }))
+                    {
+                        return false;
+                    }
+                    auto subscribedResult = subscribed.get_future();
+                    if (subscribedResult.wait_for(s_loopbackTimeout) != std::future_status::ready ||
+                        subscribedResult.get())
+                    {
+                        fprintf(stderr, "loopback: provisioning subscriptions failed\n");
+                        return false;
+                    }
+
+                    /* The pipeline bounds what is in flight itself, so every device is queued up front. */
+                    uint64_t registeredBefore = broker.GetRegisteredThingCount();
+                    Completions completions;
+                    uint64_t start = Ticks();
+                    for (size_t i = 0; i < s_requestCount; ++i)
+                    {
+                        char serial[64];
+                        snprintf(serial, sizeof(serial), "loopback-device-%zu-%zu", window, i);
+                        request.Parameters["SerialNumber"] = serial;
+                        uint64_t requestStart = Ticks();
+                        bool queued = pipeline->Provision(
+                            request,
+                            [&completions, requestStart](
+                                Iotidentity::ProvisioningResult *result, Iotidentity::ErrorResponse *, int) {
+                                completions.Complete(requestStart, result != nullptr);
+                            });
+                        if (!queued)
+                        {
+                            return false;
+                        }
+                    }
+                    if (!completions.Wait(s_requestCount, 0) || completions.Failed() ||
+                        broker.GetRegisteredThingCount() - registeredBefore != s_requestCount)
+                    {
+                        fprintf(stderr, "loopback: %zu provisioning flows failed\n", completions.Failed());
+                        pipeline->CancelAll(AWS_ERROR_INVALID_STATE);
+                        return false;
+                    }
+                    uint64_t elapsedNs = Ticks() - start;
+
+                    /* Queueing time is part of each flow's latency here, so the stage lines show the broker's share. */
+                    const char *mode = window == 1 ? "serial" : "pipelined";
+                    char name[96];
+                    snprintf(name, sizeof(name), "loopback/identity/provision/%s", mode);
+                    s_report(name, 0, completions.TakeLatencies(), elapsedNs);
+                    printf(
+                        "%-56s\t%8s  \t%10.0f dev/min\n",
+                        name,
+                        "",
+                        static_cast<double>(s_requestCount) * 60e9 / static_cast<double>(elapsedNs));
+
+                    Iotidentity::ProvisioningStats stats = pipeline->GetStats();
+                    snprintf(name, sizeof(name), "loopback/identity/create-certificate/%s", mode);
+                    s_reportStage(name, stats.CreateCertificate);
+                    snprintf(name, sizeof(name), "loopback/identity/register-thing/%s", mode);
+                    s_reportStage(name, stats.RegisterThing);
+                }
+                return true;
+            }
+        } // namespace
+
+        bool RunLoopbackBenchmarks()
+        {
+            MockBroker broker;
+            if (!broker.Start())
+            {
+                fprintf(stderr, "loopback: could not start the mock broker\n");
+                return false;
+            }
+
+            LoopbackConnection loopback;
+            if (!loopback.Connect(broker, "loopback-benchmark"))
+            {
+                return false;
+            }
+
+            return s_runShadowBenchmarks(loopback.GetEventLoopGroup(), loopback.GetConnection()) &&
+                   s_runJobsBenchmarks(broker, loopback.GetEventLoopGroup(), loopback.GetConnection()) &&
+                   s_runProvisioningBenchmarks(broker, loopback.GetEventLoopGroup(), loopback.GetConnection());
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
+
+#endif /* !_WIN32 */
@@ -0,0 +1,113 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "LoopbackHarness.h"
+
+#ifndef _WIN32
+
+#    include <algorithm>
+#    include <cstdio>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        void Completions::Complete(uint64_t startNs, bool succeeded)
+        {
+            uint64_t latency = Ticks() - startNs;
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_latencies.push_back(latency);
+            m_failed += succeeded ? 0 : 1;
+            m_signal.notify_all();
+        }
+
+        bool Completions::Wait(size_t issued, size_t outstanding)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            return m_signal.wait_for(lock, s_loopbackTimeout, [this, issued, outstanding]() {
+                return m_latencies.size() + outstanding >= issued;
+            });
+        }
+
+        size_t Completions::Failed()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_failed;
+        }
+
+        Crt::Vector<uint64_t> Completions::TakeLatencies()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            Crt::Vector<uint64_t> latencies;
+            latencies.swap(m_latencies);
+            return latencies;
+        }
+
+        bool Summarize(Crt::Vector<uint64_t> latencies, LatencySummary &summary)
+        {
+            if (latencies.empty())
+            {
+                return false;
+            }
+
+            std::sort(latencies.begin(), latencies.end());
+            auto percentile = [&latencies](double fraction) {
+                size_t index = static_cast<size_t>(fraction * static_cast<double>(latencies.size() - 1));
+                return static_cast<double>(latencies[index]) / 1000.0;
+            };
+            summary.P50Us = percentile(0.50);
+            summary.P99Us = percentile(0.99);
+            summary.MaxUs = percentile(1.0);
+            return true;
+        }
+
+        LoopbackConnection::LoopbackConnection(Crt::Allocator *allocator)
+            : m_eventLoopGroup(1, allocator), m_resolver(m_eventLoopGroup, 2, 30, allocator),
+              m_bootstrap(m_eventLoopGroup, m_resolver, allocator), m_client(m_bootstrap, allocator)
+        {
+            m_bootstrap.EnableBlockingShutdown();
+        }
+
+        LoopbackConnection::~LoopbackConnection()
+        {
+            if (m_connection && m_connection->Disconnect())
+            {
+                m_disconnected.get_future().wait_for(s_loopbackTimeout);
+            }
+        }
+
+        bool LoopbackConnection::Connect(const MockBroker &broker, const char *clientId)
+        {
+            Crt::Io::SocketOptions socketOptions;
+            socketOptions.SetConnectTimeoutMs(3000);
+            m_connection = m_client.NewConnection("127.0.0.1", broker.GetPort(), socketOptions);
+            if (!m_connection)
+            {
+                return false;
+            }
+
+            /* Shared with the handler, which the connection keeps after this returns. */
+            auto connected = Crt::MakeShared<std::promise<int>>(Crt::DefaultAllocator());
+            m_connection->OnConnectionCompleted =
+                [connected](Crt::Mqtt::MqttConnection &, int errorCode, Crt::Mqtt::ReturnCode returnCode, bool) {
+                    connected->set_value(errorCode ? errorCode : static_cast<int>(returnCode));
+                };
+            m_connection->OnDisconnect = [this](Crt::Mqtt::MqttConnection &) { m_disconnected.set_value(); };
+
+            auto connectedResult = connected->get_future();
+            if (!m_connection->Connect(clientId, true, 0) ||
+                connectedResult.wait_for(s_loopbackTimeout) != std::future_status::ready || connectedResult.get())
+            {
+                fprintf(stderr, "loopback: could not connect to the mock broker\n");
+                return false;
+            }
+
+            return true;
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
+
+#endif /* !_WIN32 */
@@ -0,0 +1,111 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "MockBroker.h"
+
+#include <aws/common/clock.h>
+#include <aws/crt/Types.h>
+#include <aws/crt/io/Bootstrap.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/crt/io/HostResolver.h>
+#include <aws/crt/mqtt/MqttClient.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+
+        /**
+         * How long a loopback run waits on any one response before it counts the request as lost.
+         */
+        static const std::chrono::seconds s_loopbackTimeout(10);
+
+        inline uint64_t Ticks()
+        {
+            uint64_t now = 0;
+            aws_high_res_clock_get_ticks(&now);
+            return now;
+        }
+
+        /**
+         * Records round-trip latencies of requests completed on the event loop, so the driving thread can wait
+         * on them.
+         */
+        class Completions
+        {
+          public:
+            void Complete(uint64_t startNs, bool succeeded);
+
+            /**
+             * Waits until at most `outstanding` of the `issued` requests have not completed.
+             *
+             * @return false if that took longer than s_loopbackTimeout.
+             */
+            bool Wait(size_t issued, size_t outstanding);
+
+            size_t Failed();
+
+            /**
+             * Hands over the latencies recorded so far and starts a new set.
+             */
+            Crt::Vector<uint64_t> TakeLatencies();
+
+          private:
+            std::mutex m_lock;
+            std::condition_variable m_signal;
+            Crt::Vector<uint64_t> m_latencies;
+            size_t m_failed = 0;
+        };
+
+        struct LatencySummary
+        {
+            double P50Us = 0;
+            double P99Us = 0;
+            double MaxUs = 0;
+        };
+
+        /**
+         * @return false if `latencies` is empty.
+         */
+        bool Summarize(Crt::Vector<uint64_t> latencies, LatencySummary &summary);
+
+        /**
+         * A plain TCP MQTT connection to a MockBroker, with its own event loop group and bootstrap.
+         */
+        class LoopbackConnection final
+        {
+          public:
+            explicit LoopbackConnection(Crt::Allocator *allocator = Crt::DefaultAllocator());
+            ~LoopbackConnection();
+
+            LoopbackConnection(const LoopbackConnection &) = delete;
+            LoopbackConnection &operator=(const LoopbackConnection &) = delete;
+
+            /**
+             * Connects with a clean session and waits for the CONNACK.
+             */
+            bool Connect(const MockBroker &broker, const char *clientId);
+
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &GetConnection() const noexcept { return m_connection; }
+            Crt::Io::EventLoopGroup &GetEventLoopGroup() noexcept { return m_eventLoopGroup; }
+
+          private:
+            Crt::Io::EventLoopGroup m_eventLoopGroup;
+            Crt::Io::DefaultHostResolver m_resolver;
+            Crt::Io::ClientBootstrap m_bootstrap;
+            Crt::Mqtt::MqttClient m_client;
+            std::shared_ptr<Crt::Mqtt::MqttConnection> m_connection;
+            std::promise<void> m_disconnected;
+        };
+
+    } // namespace Benchmarks
+} // namespace Aws
@@ -0,0 +1,1003 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "MockBroker.h"
+
+#ifndef _WIN32
+
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <netinet/tcp.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+
+#    include <algorithm>
+#    include <cerrno>
+#    include <cinttypes>
+#    include <cstdio>
+#    include <ctime>
+#    include <utility>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            enum PacketType : uint8_t
+            {
+                Connect = 1,
+                Publish = 3,
+                PubRel = 6,
+                Subscribe = 8,
+                Unsubscribe = 10,
+                PingReq = 12,
+                Disconnect = 14,
+            };
+
+            bool s_readFull(int fd, char *buffer, size_t length)
+            {
+                while (length)
+                {
+                    ssize_t received = recv(fd, buffer, length, 0);
+                    if (received <= 0)
+                    {
+                        if (received < 0 && errno == EINTR)
+                        {
+                            continue;
+                        }
+                        return false;
+                    }
+                    buffer += received;
+                    length -= static_cast<size_t>(received);
+                }
+                return true;
+            }
+
+            bool s_readPacket(int fd, uint8_t &header, Crt::String &body)
+            {
+                char byte = 0;
+                if (!s_readFull(fd, &byte, 1))
+                {
+                    return false;
+                }
+                header = static_cast<uint8_t>(byte);
+
+                size_t remaining = 0;
+                size_t multiplier = 1;
+                for (int i = 0; i < 4; ++i)
+                {
+                    if (!s_readFull(fd, &byte, 1))
+                    {
+                        return false;
+                    }
+                    remaining += (static_cast<uint8_t>(byte) & 0x7F) * multiplier;
+                    multiplier *= 128;
+                    if ((static_cast<uint8_t>(byte) & 0x80) == 0)
+                    {
+                        break;
+                    }
+                }
+
+                body.assign(remaining, '\0');
+                return remaining == 0 || s_readFull(fd, &body[0], remaining);
+            }
+
+            void s_appendRemainingLength(Crt::String &packet, size_t length)
+            {
+                do
+                {
+                    uint8_t byte = static_cast<uint8_t>(length % 128);
+                    length /= 128;
+                    packet.push_back(static_cast<char>(length ? byte | 0x80 : byte));
+                } while (length);
+            }
+
+            void s_appendU16(Crt::String &packet, size_t value)
+            {
+                packet.push_back(static_cast<char>((value >> 8) & 0xFF));
+                packet.push_back(static_cast<char>(value & 0xFF));
+            }
+
+            uint16_t s_readU16(const Crt::String &body, size_t &position)
+            {
+                if (position + 2 > body.size())
+                {
+                    position = body.size();
+                    return 0;
+                }
+                uint16_t value = static_cast<uint16_t>(
+                    (static_cast<uint8_t>(body[position]) << 8) | static_cast<uint8_t>(body[position + 1]));
+                position += 2;
+                return value;
+            }
+
+            Crt::String s_readString(const Crt::String &body, size_t &position)
+            {
+                size_t length = s_readU16(body, position);
+                length = std::min(length, body.size() - position);
+                Crt::String value = body.substr(position, length);
+                position += length;
+                return value;
+            }
+
+            Crt::String s_packet(uint8_t header, const Crt::String &body)
+            {
+                Crt::String packet(1, static_cast<char>(header));
+                s_appendRemainingLength(packet, body.size());
+                packet.append(body);
+                return packet;
+            }
+
+            Crt::String s_ack(uint8_t header, uint16_t packetId)
+            {
+                Crt::String body;
+                s_appendU16(body, packetId);
+                return s_packet(header, body);
+            }
+
+            Crt::Vector<Crt::String> s_split(const Crt::String &topic)
+            {
+                Crt::Vector<Crt::String> levels;
+                size_t start = 0;
+                for (;;)
+                {
+                    size_t slash = topic.find('/', start);
+                    size_t length = slash == Crt::String::npos ? Crt::String::npos : slash - start;
+                    levels.push_back(topic.substr(start, length));
+                    if (slash == Crt::String::npos)
+                    {
+                        return levels;
+                    }
+                    start = slash + 1;
+                }
+            }
+
+            bool s_matches(const Crt::String &filter, const Crt::Vector<Crt::String> &topicLevels)
+            {
+                Crt::Vector<Crt::String> filterLevels = s_split(filter);
+                for (size_t i = 0; i < filterLevels.size(); ++i)
+                {
+                    if (filterLevels[i] == "#")
+                    {
+                        return true;
+                    }
+                    if (i >= topicLevels.size() || (filterLevels[i] != "+" && filterLevels[i] != topicLevels[i]))
+                    {
+                        return false;
+                    }
+                }
+                return filterLevels.size() == topicLevels.size();
+            }
+
+            Crt::String s_join(const Crt::Vector<Crt::String> &levels, size_t count)
+            {
+                Crt::String joined;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    joined.append(i ? "/" : "").append(levels[i]);
+                }
+                return joined;
+            }
+
+            int64_t s_now() { return static_cast<int64_t>(time(nullptr)); }
+
+            /* The response every service sends: a timestamp, and the request's clientToken echoed back. */
+            Crt::JsonObject s_response(const Crt::JsonView &request)
+            {
+                Crt::JsonObject response;
+                response.WithInt64("timestamp", s_now());
+                if (request.ValueExists("clientToken"))
+                {
+                    response.WithString("clientToken", request.GetString("clientToken"));
+                }
+                return response;
+            }
+
+            /* Applies a shadow state section: null members are removed from target, others replace it. */
+            void s_merge(Crt::JsonObject &target, bool &hasTarget, const Crt::JsonView &patch)
+            {
+                Crt::JsonObject merged;
+                if (hasTarget)
+                {
+                    for (const auto &member : target.View().GetAllObjects())
+                    {
+                        if (!patch.KeyExists(member.first))
+                        {
+                            merged.WithObject(member.first, member.second.Materialize());
+                        }
+                    }
+                }
+                for (const auto &member : patch.GetAllObjects())
+                {
+                    if (!member.second.IsNull())
+                    {
+                        merged.WithObject(member.first, member.second.Materialize());
+                    }
+                }
+                target = std::move(merged);
+                hasTarget = true;
+            }
+
+            /* The desired members that reported does not match, or nothing if they all match. */
+            bool s_delta(const Crt::JsonObject &desired, const Crt::JsonObject &reported, Crt::JsonObject &delta)
+            {
+                bool any = false;
+                Crt::JsonView reportedView = reported.View();
+                for (const auto &member : desired.View().GetAllObjects())
+                {
+                    if (!reportedView.KeyExists(member.first) ||
+                        reportedView.GetJsonObject(member.first).WriteCompact(false) !=
+                            member.second.WriteCompact(false))
+                    {
+                        delta.WithObject(member.first, member.second.Materialize());
+                        any = true;
+                    }
+                }
+                return any;
+            }
+
+            bool s_isPending(const Crt::String &status) { return status == "QUEUED" || status == "IN_PROGRESS"; }
+
+            void s_rejectJob(
+                const Crt::String &topic,
+                const Crt::JsonView &request,
+                const char *code,
+                const Crt::String &message,
+                Crt::Vector<std::pair<Crt::String, Crt::String>> &out)
+            {
+                Crt::JsonObject response = s_response(request);
+                response.WithString("code", code).WithString("message", message);
+                out.emplace_back(topic + "/rejected", response.View().WriteCompact(true));
+            }
+        } // namespace
+
+        struct MockBroker::Session
+        {
+            int Fd = -1;
+            std::mutex WriteLock;
+            std::mutex FiltersLock;
+            Crt::Vector<Crt::String> Filters;
+
+            bool Send(const Crt::String &packet)
+            {
+                std::lock_guard<std::mutex> lock(WriteLock);
+                const char *data = packet.data();
+                size_t remaining = packet.size();
+                while (remaining)
+                {
+#    ifdef MSG_NOSIGNAL
+                    ssize_t sent = send(Fd, data, remaining, MSG_NOSIGNAL);
+#    else
+                    ssize_t sent = send(Fd, data, remaining, 0);
+#    endif
+                    if (sent <= 0)
+                    {
+                        if (sent < 0 && errno == EINTR)
+                        {
+                            continue;
+                        }
+                        return false;
+                    }
+                    data += sent;
+                    remaining -= static_cast<size_t>(sent);
+                }
+                return true;
+            }
+        };
+
+        MockBroker::MockBroker() noexcept
+            : m_listenFd(-1), m_port(0), m_running(false), m_publishCount(0), m_registeredThings(0)
+        {
+        }
+
+        MockBroker::~MockBroker() { Stop(); }
+
+        bool MockBroker::Start()
+        {
+            m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+            if (m_listenFd < 0)
+            {
+                return false;
+            }
+
+            int enable = 1;
+            setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+            socklen_t addressLength = sizeof(address);
+            if (bind(m_listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+                listen(m_listenFd, 16) != 0 ||
+                getsockname(m_listenFd, reinterpret_cast<sockaddr *>(&address), &addressLength) != 0)
+            {
+                close(m_listenFd);
+                m_listenFd = -1;
+                return false;
+            }
+
+            m_port = ntohs(address.sin_port);
+            m_running = true;
+            m_acceptThread = std::thread(&MockBroker::AcceptLoop, this);
+            return true;
+        }
+
+        void MockBroker::Stop()
+        {
+            if (!m_running.exchange(false))
+            {
+                return;
+            }
+
+            /* Shutting the listener down wakes the blocked accept. */
+            shutdown(m_listenFd, SHUT_RDWR);
+            m_acceptThread.join();
+            close(m_listenFd);
+            m_listenFd = -1;
+
+            Crt::Vector<std::thread> threads;
+            Crt::Vector<std::shared_ptr<Session>> sessions;
+            {
+                std::lock_guard<std::mutex> lock(m_sessionsLock);
+                for (const auto &session : m_sessions)
+                {
+                    shutdown(session->Fd, SHUT_RDWR);
+                }
+                threads.swap(m_sessionThreads);
+                sessions.swap(m_sessions);
+            }
+
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+            for (const auto &session : sessions)
+            {
+                close(session->Fd);
+            }
+        }
+
+        void MockBroker::AddJob(
+            const Crt::String &thingName,
+            const Crt::String &jobId,
+            const Crt::JsonObject &jobDocument)
+        {
+            Crt::String notification;
+            {
+                std::lock_guard<std::mutex> lock(m_stateLock);
+                Crt::Vector<JobExecution> &jobs = m_jobs[thingName];
+
+                JobExecution job;
+                job.JobId = jobId;
+                job.Status = "QUEUED";
+                job.JobDocument = jobDocument;
+                job.QueuedAt = s_now();
+                job.LastUpdatedAt = job.QueuedAt;
+                jobs.push_back(std::move(job));
+
+                if (FindJob(thingName, "$next") == &jobs.back())
+                {
+                    Crt::JsonObject next;
+                    next.WithInt64("timestamp", s_now()).WithObject("execution", ToExecution(thingName, jobs.back()));
+                    notification = next.View().WriteCompact(true);
+                }
+            }
+
+            if (!notification.empty())
+            {
+                Deliver("$aws/things/" + thingName + "/jobs/notify-next", notification);
+            }
+        }
+
+        void MockBroker::AcceptLoop()
+        {
+            while (m_running)
+            {
+                int fd = accept(m_listenFd, nullptr, nullptr);
+                if (fd < 0)
+                {
+                    if (m_running && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return;
+                }
+
+                int enable = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+#    ifdef SO_NOSIGPIPE
+                setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#    endif
+
+                auto session = Crt::MakeShared<Session>(Crt::DefaultAllocator());
+                session->Fd = fd;
+
+                std::lock_guard<std::mutex> lock(m_sessionsLock);
+                m_sessions.push_back(session);
+                m_sessionThreads.emplace_back(&MockBroker::SessionLoop, this, session);
+            }
+        }
+
+        void MockBroker::SessionLoop(std::shared_ptr<Session> session)
+        {
+            uint8_t header = 0;
+            Crt::String body;
+            while (s_readPacket(session->Fd, header, body))
+            {
+                size_t position = 0;
+                switch (header >> 4)
+                {
+                    case Connect:
+                    {
+                        /* Session present 0, return code 0 (accepted). */
+                        session->Send(s_packet(0x20, Crt::String(2, '\0')));
+                        break;
+                    }
+                    case Publish:
+                    {
+                        uint8_t qos = (header >> 1) & 0x03;
+                        Crt::String topic = s_readString(body, position);
+                        uint16_t packetId = qos ? s_readU16(body, position) : 0;
+                        Crt::String payload = body.substr(std::min(position, body.size()));
+                        ++m_publishCount;
+                        if (qos)
+                        {
+                            session->Send(s_ack(qos == 1 ? 0x40 : 0x50, packetId));
+                        }
+                        Route(topic, payload);
+                        break;
+                    }
+                    case PubRel:
+                    {
+                        session->Send(s_ack(0x70, s_readU16(body, position)));
+                        break;
+                    }
+                    case Subscribe:
+                    {
+                        uint16_t packetId = s_readU16(body, position);
+                        Crt::String granted;
+                        {
+                            std::lock_guard<std::mutex> lock(session->FiltersLock);
+                            while (position < body.size())
+                            {
+                                Crt::String filter = s_readString(body, position);
+                                uint8_t requested = position < body.size() ? static_cast<uint8_t>(body[position]) : 0;
+                                ++position;
+                                session->Filters.push_back(filter);
+                                granted.push_back(static_cast<char>(std::min<uint8_t>(requested, 1)));
+                            }
+                        }
+                        Crt::String suback;
+                        s_appendU16(suback, packetId);
+                        session->Send(s_packet(0x90, suback + granted));
+                        break;
+                    }
+                    case Unsubscribe:
+                    {
+                        uint16_t packetId = s_readU16(body, position);
+                        {
+                            std::lock_guard<std::mutex> lock(session->FiltersLock);
+                            while (position < body.size())
+                            {
+                                Crt::String filter = s_readString(body, position);
+                                auto &filters = session->Filters;
+                                filters.erase(std::remove(filters.begin(), filters.end(), filter), filters.end());
+                            }
+                        }
+                        session->Send(s_ack(0xB0, packetId));
+                        break;
+                    }
+                    case PingReq:
+                    {
+                        session->Send(s_packet(0xD0, Crt::String()));
+                        break;
+                    }
+                    case Disconnect:
+                    {
+                        shutdown(session->Fd, SHUT_RDWR);
+                        break;
+                    }
+                    default:
+                        /* PUBACKs for nothing we sent at QoS 1, and anything else, are ignored. */
+                        break;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(session->FiltersLock);
+            session->Filters.clear();
+        }
+
+        void MockBroker::Route(const Crt::String &topic, const Crt::String &payload)
+        {
+            Deliver(topic, payload);
+
+            Crt::Vector<Crt::String> levels = s_split(topic);
+            if (levels.size() >= 4 && levels[0] == "$aws" &&
+                (levels[1] == "certificates" || levels[1] == "provisioning-templates"))
+            {
+                HandleIdentity(levels, payload);
+                return;
+            }
+            if (levels.size() < 5 || levels[0] != "$aws" || levels[1] != "things")
+            {
+                return;
+            }
+
+            if (levels[3] == "shadow")
+            {
+                HandleShadow(levels, payload);
+            }
+            else if (levels[3] == "jobs")
+            {
+                HandleJobs(levels, payload);
+            }
+        }
+
+        void MockBroker::Deliver(const Crt::String &topic, const Crt::String &payload)
+        {
+            Crt::Vector<std::shared_ptr<Session>> sessions;
+            {
+                std::lock_guard<std::mutex> lock(m_sessionsLock);
+                sessions = m_sessions;
+            }
+
+            Crt::Vector<Crt::String> levels = s_split(topic);
+            Crt::String body;
+            s_appendU16(body, topic.size());
+            body.append(topic).append(payload);
+            Crt::String packet = s_packet(0x30, body);
+
+            for (const auto &session : sessions)
+            {
+                bool matched = false;
+                {
+                    std::lock_guard<std::mutex> lock(session->FiltersLock);
+                    for (const Crt::String &filter : session->Filters)
+                    {
+                        if (s_matches(filter, levels))
+                        {
+                            matched = true;
+                            break;
+                        }
+                    }
+                }
+                if (matched)
+                {
+                    session->Send(packet);
+                }
+            }
+        }
+
+        void MockBroker::HandleIdentity(const Crt::Vector<Crt::String> &levels, const Crt::String &payload)
+        {
+            /* $aws/certificates/create-from-csr/json and $aws/provisioning-templates/<template>/provision/json */
+            bool createCertificate = levels.size() == 4 && levels[1] == "certificates" &&
+                                     levels[2] == "create-from-csr" && levels[3] == "json";
+            bool registerThing = levels.size() == 5 && levels[1] == "provisioning-templates" &&
+                                 levels[3] == "provision" && levels[4] == "json";
+            if (!createCertificate && !registerThing)
+            {
+                return;
+            }
+
+            const Crt::String topic = s_join(levels, levels.size());
+            Crt::JsonObject requestObject(payload.empty() ? Crt::String("{}") : payload);
+            Crt::JsonView request = requestObject.View();
+
+            Crt::String responseTopic;
+            Crt::JsonObject response;
+            auto reject = [&](const Crt::String &message) {
+                response.WithInteger("statusCode", 400)
+                    .WithString("errorCode", "InvalidPayload")
+                    .WithString("errorMessage", message);
+                responseTopic = topic + "/rejected";
+            };
+
+            if (!requestObject.WasParseSuccessful())
+            {
+                reject("Payload contains invalid json");
+            }
+            else if (createCertificate)
+            {
+                if (!request.ValueExists("certificateSigningRequest") ||
+                    request.GetString("certificateSigningRequest").empty())
+                {
+                    reject("Missing required node: certificateSigningRequest");
+                }
+                else
+                {
+                    char certificateId[32];
+                    Crt::String ownershipToken;
+                    {
+                        std::lock_guard<std::mutex> lock(m_stateLock);
+                        snprintf(certificateId, sizeof(certificateId), "%016" PRIx64, ++m_certificateCount);
+                        ownershipToken = Crt::String("token-") + certificateId;
+                        m_ownershipTokens[ownershipToken] = certificateId;
+                    }
+                    response.WithString("certificateId", certificateId)
+                        .WithString(
+                            "certificatePem",
+                            Crt::String("-----BEGIN CERTIFICATE-----\n") + certificateId +
+                                "\n-----END CERTIFICATE-----\n")
+                        .WithString("certificateOwnershipToken", ownershipToken);
+                    responseTopic = topic + "/accepted";
+                }
+            }
+            else
+            {
+                Crt::String certificateId;
+                Crt::String ownershipToken = request.ValueExists("certificateOwnershipToken")
+                                                 ? request.GetString("certificateOwnershipToken")
+                                                 : Crt::String();
+                {
+                    std::lock_guard<std::mutex> lock(m_stateLock);
+                    auto token = m_ownershipTokens.find(ownershipToken);
+                    if (token != m_ownershipTokens.end())
+                    {
+                        certificateId = token->second;
+                        m_ownershipTokens.erase(token);
+                    }
+                }
+
+                if (certificateId.empty())
+                {
+                    reject("Invalid certificate ownership token");
+                }
+                else
+                {
+                    Crt::JsonView parameters = request.GetJsonObject("parameters");
+                    Crt::String thingName = request.ValueExists("parameters") && parameters.ValueExists("SerialNumber")
+                                                ? parameters.GetString("SerialNumber")
+                                                : "thing-" + certificateId;
+                    ++m_registeredThings;
+                    response.WithString("thingName", thingName).WithObject("deviceConfiguration", Crt::JsonObject());
+                    responseTopic = topic + "/accepted";
+                }
+            }
+
+            Deliver(responseTopic, response.View().WriteCompact(true));
+        }
+
+        void MockBroker::HandleShadow(const Crt::Vector<Crt::String> &levels, const Crt::String &payload)
+        {
+            size_t operationLevel = 4;
+            Crt::String shadowName;
+            if (levels.size() == 7 && levels[4] == "name")
+            {
+                shadowName = levels[5];
+                operationLevel = 6;
+            }
+            else if (levels.size() != 5)
+            {
+                return;
+            }
+
+            const Crt::String &operation = levels[operationLevel];
+            if (operation != "get" && operation != "update" && operation != "delete")
+            {
+                return;
+            }
+
+            const Crt::String base = s_join(levels, operationLevel);
+            const Crt::String topic = base + "/" + operation;
+            Crt::JsonObject requestObject(payload.empty() ? Crt::String("{}") : payload);
+            Crt::JsonView request = requestObject.View();
+
+            Crt::Vector<std::pair<Crt::String, Crt::String>> out;
+            auto reject = [&](int code, const Crt::String &message) {
+                Crt::JsonObject response = s_response(request);
+                response.WithInteger("code", code).WithString("message", message);
+                out.emplace_back(topic + "/rejected", response.View().WriteCompact(true));
+            };
+
+            {
+                std::lock_guard<std::mutex> lock(m_stateLock);
+                const Crt::String key = levels[2] + "/" + shadowName;
+                auto shadow = m_shadows.find(key);
+
+                if (!requestObject.WasParseSuccessful())
+                {
+                    reject(400, "Payload contains invalid json");
+                }
+                else if (operation == "update")
+                {
+                    Crt::JsonView state = request.GetJsonObject("state");
+                    int64_t currentVersion = shadow == m_shadows.end() ? 0 : shadow->second.Version;
+                    if (!request.ValueExists("state") || !state.IsObject())
+                    {
+                        reject(400, "Missing required node: state");
+                    }
+                    else if (request.ValueExists("version") && request.GetInt64("version") != currentVersion)
+                    {
+                        reject(409, "Version conflict");
+                    }
+                    else
+                    {
+                        Shadow &document = m_shadows[key];
+                        const char *sections[] = {"desired", "reported"};
+                        for (const char *section : sections)
+                        {
+                            Crt::JsonObject &target = section[0] == 'd' ? document.Desired : document.Reported;
+                            bool &hasTarget = section[0] == 'd' ? document.HasDesired : document.HasReported;
+                            if (!state.KeyExists(section))
+                            {
+                                continue;
+                            }
+                            if (state.GetJsonObject(section).IsNull())
+                            {
+                                target = Crt::JsonObject();
+                                hasTarget = false;
+                            }
+                            else
+                            {
+                                s_merge(target, hasTarget, state.GetJsonObject(section));
+                            }
+                        }
+                        ++document.Version;
+
+                        Crt::JsonObject accepted = s_response(request);
+                        accepted.WithObject("state", state.Materialize())
+                            .WithObject("metadata", Crt::JsonObject())
+                            .WithInt64("version", document.Version);
+                        out.emplace_back(topic + "/accepted", accepted.View().WriteCompact(true));
+
+                        Crt::JsonObject delta;
+                        if (document.HasDesired && s_delta(document.Desired, document.Reported, delta))
+                        {
+                            Crt::JsonObject deltaEvent;
+                            deltaEvent.WithObject("state", delta)
+                                .WithObject("metadata", Crt::JsonObject())
+                                .WithInt64("version", document.Version)
+                                .WithInt64("timestamp", s_now());
+                            out.emplace_back(base + "/update/delta", deltaEvent.View().WriteCompact(true));
+                        }
+                    }
+                }
+                else if (shadow == m_shadows.end())
+                {
+                    reject(404, "No shadow exists with name: '" + levels[2] + "'");
+                }
+                else if (operation == "get")
+                {
+                    Crt::JsonObject state;
+                    Crt::JsonObject delta;
+                    if (shadow->second.HasDesired)
+                    {
+                        state.WithObject("desired", shadow->second.Desired);
+                        if (s_delta(shadow->second.Desired, shadow->second.Reported, delta))
+                        {
+                            state.WithObject("delta", delta);
+                        }
+                    }
+                    if (shadow->second.HasReported)
+                    {
+                        state.WithObject("reported", shadow->second.Reported);
+                    }
+
+                    Crt::JsonObject accepted = s_response(request);
+                    accepted.WithObject("state", std::move(state))
+                        .WithObject("metadata", Crt::JsonObject())
+                        .WithInt64("version", shadow->second.Version);
+                    out.emplace_back(topic + "/accepted", accepted.View().WriteCompact(true));
+                }
+                else
+                {
+                    Crt::JsonObject accepted = s_response(request);
+                    accepted.WithInt64("version", shadow->second.Version);
+                    out.emplace_back(topic + "/accepted", accepted.View().WriteCompact(true));
+                    m_shadows.erase(shadow);
+                }
+            }
+
+            for (const auto &response : out)
+            {
+                Deliver(response.first, response.second);
+            }
+        }
+
+        void MockBroker::HandleJobs(const Crt::Vector<Crt::String> &levels, const Crt::String &payload)
+        {
+            const Crt::String &thingName = levels[2];
+            const Crt::String topic = s_join(levels, levels.size());
+            Crt::JsonObject requestObject(payload.empty() ? Crt::String("{}") : payload);
+            Crt::JsonView request = requestObject.View();
+
+            Crt::Vector<std::pair<Crt::String, Crt::String>> out;
+            {
+                std::lock_guard<std::mutex> lock(m_stateLock);
+                /* Compared by id, since finishing a job moves the executions after it. */
+                JobExecution *previousNext = FindJob(thingName, "$next");
+                const Crt::String previousNextId = previousNext ? previousNext->JobId : Crt::String();
+
+                if (levels.size() == 5 && levels[4] == "get")
+                {
+                    Crt::Vector<Crt::JsonObject> inProgress;
+                    Crt::Vector<Crt::JsonObject> queued;
+                    for (const JobExecution &job : m_jobs[thingName])
+                    {
+                        Crt::JsonObject summary;
+                        summary.WithString("jobId", job.JobId)
+                            .WithInt64("executionNumber", job.ExecutionNumber)
+                            .WithInt64("versionNumber", job.VersionNumber)
+                            .WithInt64("queuedAt", job.QueuedAt)
+                            .WithInt64("lastUpdatedAt", job.LastUpdatedAt);
+                        if (job.Status == "IN_PROGRESS")
+                        {
+                            inProgress.push_back(std::move(summary));
+                        }
+                        else if (job.Status == "QUEUED")
+                        {
+                            queued.push_back(std::move(summary));
+                        }
+                    }
+
+                    Crt::JsonObject accepted = s_response(request);
+                    accepted.WithArray("inProgressJobs", std::move(inProgress))
+                        .WithArray("queuedJobs", std::move(queued));
+                    out.emplace_back(topic + "/accepted", accepted.View().WriteCompact(true));
+                }
+                else if (levels.size() == 5 && levels[4] == "start-next")
+                {
+                    Crt::JsonObject accepted = s_response(request);
+                    JobExecution *job = FindJob(thingName, "$next");
+                    if (job)
+                    {
+                        if (job->Status == "QUEUED")
+                        {
+                            job->Status = "IN_PROGRESS";
+                            ++job->VersionNumber;
+                            job->LastUpdatedAt = s_now();
+                        }
+                        if (request.ValueExists("statusDetails"))
+                        {
+                            job->StatusDetails = request.GetJsonObjectCopy("statusDetails");
+                        }
+                        accepted.WithObject("execution", ToExecution(thingName, *job));
+                    }
+                    out.emplace_back(topic + "/accepted", accepted.View().WriteCompact(true));
+                }
+                else if (levels.size() == 6 && levels[5] == "get")
+                {
+                    JobExecution *job = FindJob(thingName, levels[4]);
+                    if (!job)
+                    {
+                        s_rejectJob(topic, request, "ResourceNotFound", "Job execution not found", out);
+                    }
+                    else
+                    {
+                        Crt::JsonObject accepted = s_response(request);
+                        accepted.WithObject("execution", ToExecution(thingName, *job));
+                        out.emplace_back(topic + "/accepted", accepted.View().WriteCompact(true));
+                    }
+                }
+                else if (levels.size() == 6 && levels[5] == "update")
+                {
+                    JobExecution *job = FindJob(thingName, levels[4]);
+                    if (!requestObject.WasParseSuccessful() || !request.ValueExists("status"))
+                    {
+                        s_rejectJob(topic, request, "InvalidRequest", "Missing required field: status", out);
+                    }
+                    else if (!job)
+                    {
+                        s_rejectJob(topic, request, "ResourceNotFound", "Job execution not found", out);
+                    }
+                    else if (
+                        request.ValueExists("expectedVersion") &&
+                        request.GetInt64("expectedVersion") != job->VersionNumber)
+                    {
+                        s_rejectJob(topic, request, "VersionMismatch", "Expected version does not match", out);
+                    }
+                    else if (!s_isPending(job->Status))
+                    {
+                        s_rejectJob(topic, request, "InvalidStateTransition", "Job execution is terminal", out);
+                    }
+                    else
+                    {
+                        job->Status = request.GetString("status");
+                        if (request.ValueExists("statusDetails"))
+                        {
+                            job->StatusDetails = request.GetJsonObjectCopy("statusDetails");
+                        }
+                        ++job->VersionNumber;
+                        job->LastUpdatedAt = s_now();
+
+                        Crt::JsonObject executionState;
+                        executionState.WithString("status", job->Status)
+                            .WithObject("statusDetails", job->StatusDetails)
+                            .WithInt64("versionNumber", job->VersionNumber);
+                        Crt::JsonObject accepted = s_response(request);
+                        accepted.WithObject("executionState", std::move(executionState));
+                        if (request.ValueExists("includeJobDocument") && request.GetBool("includeJobDocument"))
+                        {
+                            accepted.WithObject("jobDocument", job->JobDocument);
+                        }
+                        out.emplace_back(topic + "/accepted", accepted.View().WriteCompact(true));
+
+                        /* Finished executions are forgotten, so a long run does not grow the broker. */
+                        if (!s_isPending(job->Status))
+                        {
+                            Crt::Vector<JobExecution> &executions = m_jobs[thingName];
+                            executions.erase(executions.begin() + (job - executions.data()));
+                        }
+                    }
+                }
+
+                JobExecution *next = FindJob(thingName, "$next");
+                if ((next ? next->JobId : Crt::String()) != previousNextId)
+                {
+                    Crt::JsonObject notification;
+                    notification.WithInt64("timestamp", s_now());
+                    if (next)
+                    {
+                        notification.WithObject("execution", ToExecution(thingName, *next));
+                    }
+                    out.emplace_back(
+                        "$aws/things/" + thingName + "/jobs/notify-next", notification.View().WriteCompact(true));
+                }
+            }
+
+            for (const auto &response : out)
+            {
+                Deliver(response.first, response.second);
+            }
+        }
+
+        MockBroker::JobExecution *MockBroker::FindJob(const Crt::String &thingName, const Crt::String &jobId)
+        {
+            auto jobs = m_jobs.find(thingName);
+            if (jobs == m_jobs.end())
+            {
+                return nullptr;
+            }
+
+            if (jobId != "$next")
+            {
+                for (JobExecution &job : jobs->second)
+                {
+                    if (job.JobId == jobId)
+                    {
+                        return &job;
+                    }
+                }
+                return nullptr;
+            }
+
+            /* An execution already in progress comes before anything still queued. */
+            JobExecution *queued = nullptr;
+            for (JobExecution &job : jobs->second)
+            {
+                if (job.Status == "IN_PROGRESS")
+                {
+                    return &job;
+                }
+                if (!queued && job.Status == "QUEUED")
+                {
+                    queued = &job;
+                }
+            }
+            return queued;
+        }
+
+        Crt::JsonObject MockBroker::ToExecution(const Crt::String &thingName, const JobExecution &job) const
+        {
+            Crt::JsonObject execution;
+            execution.WithString("jobId", job.JobId)
+                .WithString("thingName", thingName)
+                .WithString("status", job.Status)
+                .WithObject("jobDocument", job.JobDocument)
+                .WithObject("statusDetails", job.StatusDetails)
+                .WithInt64("versionNumber", job.VersionNumber)
+                .WithInt64("executionNumber", job.ExecutionNumber)
+                .WithInt64("queuedAt", job.QueuedAt)
+                .WithInt64("lastUpdatedAt", job.LastUpdatedAt);
+            return execution;
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
+
+#endif /* !_WIN32 */
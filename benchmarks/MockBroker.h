@@ -0,0 +1,133 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Types.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+
+        /**
+         * An in-process MQTT 3.1.1 broker on a loopback TCP port, standing in for AWS IoT Core so the service
+         * clients can be driven end to end without an endpoint or credentials.
+         *
+         * Besides plain publish/subscribe routing, publishes to the shadow, jobs and fleet provisioning request
+         * topics are answered on their accepted/rejected topics the way the services answer them: shadows are
+         * kept in memory with versions and a delta, jobs queued with AddJob move through start-next, describe
+         * and update, and CreateCertificateFromCsr hands out placeholder certificates whose ownership token
+         * RegisterThing accepts once.
+         * Only JSON payloads are understood. Everything is delivered at QoS 0, and there is no TLS, so the
+         * client connects with MqttClient::NewConnection(host, port, socketOptions).
+         *
+         * Requires POSIX sockets; not available on Windows.
+         */
+        class MockBroker final
+        {
+          public:
+            MockBroker() noexcept;
+            ~MockBroker();
+
+            MockBroker(const MockBroker &) = delete;
+            MockBroker &operator=(const MockBroker &) = delete;
+
+            /**
+             * Starts listening on 127.0.0.1 at a port chosen by the OS.
+             *
+             * @return false, with errno set, if the socket could not be bound.
+             */
+            bool Start();
+
+            /**
+             * Closes the listener and every client connection, and waits for their threads.
+             */
+            void Stop();
+
+            uint16_t GetPort() const noexcept { return m_port; }
+
+            /**
+             * Queues a job execution for `thingName`; it is reported by get-pending and handed out by
+             * start-next in the order added. An execution is dropped once it is updated to a terminal status.
+             */
+            void AddJob(const Crt::String &thingName, const Crt::String &jobId, const Crt::JsonObject &jobDocument);
+
+            /**
+             * @return the number of PUBLISH packets received from clients.
+             */
+            uint64_t GetPublishCount() const noexcept { return m_publishCount.load(); }
+
+            /**
+             * @return the number of things registered through RegisterThing.
+             */
+            uint64_t GetRegisteredThingCount() const noexcept { return m_registeredThings.load(); }
+
+          private:
+            struct Session;
+
+            struct Shadow
+            {
+                Crt::JsonObject Desired;
+                Crt::JsonObject Reported;
+                bool HasDesired = false;
+                bool HasReported = false;
+                int64_t Version = 0;
+            };
+
+            struct JobExecution
+            {
+                Crt::String JobId;
+                Crt::String Status;
+                Crt::JsonObject JobDocument;
+                Crt::JsonObject StatusDetails;
+                int64_t VersionNumber = 1;
+                int64_t ExecutionNumber = 1;
+                int64_t QueuedAt = 0;
+                int64_t LastUpdatedAt = 0;
+            };
+
+            void AcceptLoop();
+            void SessionLoop(std::shared_ptr<Session> session);
+
+            /* Delivers to every session with a matching subscription, then answers service request topics. */
+            void Route(const Crt::String &topic, const Crt::String &payload);
+            void Deliver(const Crt::String &topic, const Crt::String &payload);
+
+            void HandleShadow(const Crt::Vector<Crt::String> &levels, const Crt::String &payload);
+            void HandleJobs(const Crt::Vector<Crt::String> &levels, const Crt::String &payload);
+            void HandleIdentity(const Crt::Vector<Crt::String> &levels, const Crt::String &payload);
+
+            /* Requires m_stateLock. */
+            JobExecution *FindJob(const Crt::String &thingName, const Crt::String &jobId);
+            Crt::JsonObject ToExecution(const Crt::String &thingName, const JobExecution &job) const;
+
+            int m_listenFd;
+            uint16_t m_port;
+            std::thread m_acceptThread;
+            std::atomic<bool> m_running;
+            std::atomic<uint64_t> m_publishCount;
+            std::atomic<uint64_t> m_registeredThings;
+
+            std::mutex m_sessionsLock;
+            Crt::Vector<std::shared_ptr<Session>> m_sessions;
+            Crt::Vector<std::thread> m_sessionThreads;
+
+            /* Guards the emulated service state; held only while computing a response, never while sending. */
+            std::mutex m_stateLock;
+            Crt::Map<Crt::String, Shadow> m_shadows;
+            Crt::Map<Crt::String, Crt::Vector<JobExecution>> m_jobs;
+            /* Ownership tokens handed out by CreateCertificateFromCsr and not yet used, to certificate ids. */
+            Crt::Map<Crt::String, Crt::String> m_ownershipTokens;
+            uint64_t m_certificateCount = 0;
+        };
+
+    } // namespace Benchmarks
+} // namespace Aws
@@ -0,0 +1,477 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "MockIpcServer.h"
+
+#ifndef _WIN32
+
+#    include <aws/crt/JsonObject.h>
+
+#    include <sys/socket.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+
+#    include <algorithm>
+#    include <cerrno>
+#    include <cstdio>
+#    include <cstdlib>
+#    include <cstring>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            const int32_t s_applicationMessage = 0;
+            const int32_t s_applicationError = 1;
+            const int32_t s_ping = 2;
+            const int32_t s_pingResponse = 3;
+            const int32_t s_connect = 4;
+            const int32_t s_connectAck = 5;
+            const int32_t s_connectionAccepted = 1;
+            const int32_t s_terminateStream = 2;
+
+            const size_t s_preludeSize = 12;
+            const size_t s_crcSize = 4;
+            const size_t s_maxFrameSize = 16 * 1024 * 1024;
+
+            struct Crc32Table
+            {
+                Crc32Table() noexcept
+                {
+                    for (uint32_t i = 0; i < 256; ++i)
+                    {
+                        uint32_t crc = i;
+                        for (int bit = 0; bit < 8; ++bit)
+                        {
+                            crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+                        }
+                        Entries[i] = crc;
+                    }
+                }
+
+                uint32_t Entries[256];
+            };
+
+            uint32_t s_crc32(const char *data, size_t length)
+            {
+                static const Crc32Table s_table;
+                uint32_t crc = 0xFFFFFFFFu;
+                for (size_t i = 0; i < length; ++i)
+                {
+                    crc = s_table.Entries[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+                }
+                return crc ^ 0xFFFFFFFFu;
+            }
+
+            void s_appendU32(Crt::String &out, uint32_t value)
+            {
+                out.push_back(static_cast<char>((value >> 24) & 0xFF));
+                out.push_back(static_cast<char>((value >> 16) & 0xFF));
+                out.push_back(static_cast<char>((value >> 8) & 0xFF));
+                out.push_back(static_cast<char>(value & 0xFF));
+            }
+
+            uint32_t s_readU32(const char *data)
+            {
+                return static_cast<uint32_t>(static_cast<uint8_t>(data[0])) << 24 |
+                       static_cast<uint32_t>(static_cast<uint8_t>(data[1])) << 16 |
+                       static_cast<uint32_t>(static_cast<uint8_t>(data[2])) << 8 |
+                       static_cast<uint32_t>(static_cast<uint8_t>(data[3]));
+            }
+
+            void s_appendInt32Header(Crt::String &headers, const char *name, int32_t value)
+            {
+                headers.push_back(static_cast<char>(strlen(name)));
+                headers.append(name);
+                headers.push_back(4);
+                s_appendU32(headers, static_cast<uint32_t>(value));
+            }
+
+            void s_appendStringHeader(Crt::String &headers, const char *name, const char *value)
+            {
+                size_t length = strlen(value);
+                headers.push_back(static_cast<char>(strlen(name)));
+                headers.append(name);
+                headers.push_back(7);
+                headers.push_back(static_cast<char>((length >> 8) & 0xFF));
+                headers.push_back(static_cast<char>(length & 0xFF));
+                headers.append(value, length);
+            }
+
+            Crt::String s_frame(
+                int32_t messageType,
+                int32_t flags,
+                int32_t streamId,
+                const char *serviceModelType,
+                const Crt::String &payload)
+            {
+                Crt::String headers;
+                s_appendInt32Header(headers, ":message-type", messageType);
+                s_appendInt32Header(headers, ":message-flags", flags);
+                s_appendInt32Header(headers, ":stream-id", streamId);
+                if (serviceModelType)
+                {
+                    s_appendStringHeader(headers, "service-model-type", serviceModelType);
+                }
+
+                size_t total = s_preludeSize + headers.size() + payload.size() + s_crcSize;
+                Crt::String frame;
+                frame.reserve(total);
+                s_appendU32(frame, static_cast<uint32_t>(total));
+                s_appendU32(frame, static_cast<uint32_t>(headers.size()));
+                s_appendU32(frame, s_crc32(frame.data(), 8));
+                frame.append(headers).append(payload);
+                s_appendU32(frame, s_crc32(frame.data(), frame.size()));
+                return frame;
+            }
+
+            bool s_readFull(int fd, char *buffer, size_t length)
+            {
+                while (length)
+                {
+                    ssize_t received = recv(fd, buffer, length, 0);
+                    if (received <= 0)
+                    {
+                        if (received < 0 && errno == EINTR)
+                        {
+                            continue;
+                        }
+                        return false;
+                    }
+                    buffer += received;
+                    length -= static_cast<size_t>(received);
+                }
+                return true;
+            }
+
+            /* The headers the server acts on; the client's frames are trusted, so no CRC is checked. */
+            struct Request
+            {
+                int32_t MessageType = -1;
+                int32_t Flags = 0;
+                int32_t StreamId = 0;
+                Crt::String Operation;
+                Crt::String Payload;
+            };
+
+            bool s_readRequest(int fd, Crt::String &frame, Request &request)
+            {
+                char prelude[s_preludeSize];
+                if (!s_readFull(fd, prelude, sizeof(prelude)))
+                {
+                    return false;
+                }
+                size_t total = s_readU32(prelude);
+                size_t headersLength = s_readU32(prelude + 4);
+                if (total < s_preludeSize + s_crcSize + headersLength || total > s_maxFrameSize)
+                {
+                    return false;
+                }
+                frame.resize(total - s_preludeSize);
+                if (!s_readFull(fd, &frame[0], frame.size()))
+                {
+                    return false;
+                }
+
+                request = Request();
+                size_t position = 0;
+                while (position + 2 <= headersLength)
+                {
+                    size_t nameLength = static_cast<uint8_t>(frame[position++]);
+                    Crt::String name(frame, position, nameLength);
+                    position += nameLength;
+                    uint8_t type = static_cast<uint8_t>(frame[position++]);
+                    if (type == 4)
+                    {
+                        int32_t value = static_cast<int32_t>(s_readU32(&frame[position]));
+                        position += 4;
+                        if (name == ":message-type")
+                        {
+                            request.MessageType = value;
+                        }
+                        else if (name == ":message-flags")
+                        {
+                            request.Flags = value;
+                        }
+                        else if (name == ":stream-id")
+                        {
+                            request.StreamId = value;
+                        }
+                    }
+                    else if (type == 7)
+                    {
+                        size_t valueLength = static_cast<size_t>(static_cast<uint8_t>(frame[position])) << 8 |
+                                             static_cast<uint8_t>(frame[position + 1]);
+                        position += 2;
+                        if (name == "operation")
+                        {
+                            request.Operation.assign(frame, position, valueLength);
+                        }
+                        position += valueLength;
+                    }
+                    else
+                    {
+                        /* The client only sends int32 and string headers. */
+                        return false;
+                    }
+                }
+
+                request.Payload.assign(frame, headersLength, frame.size() - headersLength - s_crcSize);
+                return true;
+            }
+        } // namespace
+
+        struct MockIpcServer::Session
+        {
+            int Fd = -1;
+            std::mutex WriteLock;
+
+            bool Send(const Crt::String &frame)
+            {
+                std::lock_guard<std::mutex> lock(WriteLock);
+                const char *data = frame.data();
+                size_t remaining = frame.size();
+                while (remaining)
+                {
+#    ifdef MSG_NOSIGNAL
+                    ssize_t sent = send(Fd, data, remaining, MSG_NOSIGNAL);
+#    else
+                    ssize_t sent = send(Fd, data, remaining, 0);
+#    endif
+                    if (sent <= 0)
+                    {
+                        if (sent < 0 && errno == EINTR)
+                        {
+                            continue;
+                        }
+                        return false;
+                    }
+                    data += sent;
+                    remaining -= static_cast<size_t>(sent);
+                }
+                return true;
+            }
+        };
+
+        MockIpcServer::MockIpcServer() noexcept : m_listenFd(-1), m_running(false) {}
+
+        MockIpcServer::~MockIpcServer() { Stop(); }
+
+        bool MockIpcServer::Start()
+        {
+            static std::atomic<unsigned> s_instance(0);
+            const char *directory = getenv("TMPDIR");
+            char path[sizeof(sockaddr_un::sun_path)];
+            snprintf(
+                path,
+                sizeof(path),
+                "%s/aws-ipc-bench-%d-%u.sock",
+                directory && *directory ? directory : "/tmp",
+                static_cast<int>(getpid()),
+                s_instance++);
+
+            m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (m_listenFd < 0)
+            {
+                return false;
+            }
+
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+            unlink(path);
+            if (bind(m_listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+                listen(m_listenFd, 16) != 0)
+            {
+                close(m_listenFd);
+                m_listenFd = -1;
+                return false;
+            }
+
+            m_socketPath = path;
+            m_running = true;
+            m_acceptThread = std::thread(&MockIpcServer::AcceptLoop, this);
+            return true;
+        }
+
+        void MockIpcServer::Stop()
+        {
+            if (!m_running.exchange(false))
+            {
+                return;
+            }
+
+            /* Shutting the listener down wakes the blocked accept. */
+            shutdown(m_listenFd, SHUT_RDWR);
+            m_acceptThread.join();
+            close(m_listenFd);
+            m_listenFd = -1;
+            unlink(m_socketPath.c_str());
+
+            Crt::Vector<std::thread> threads;
+            Crt::Vector<std::shared_ptr<Session>> sessions;
+            {
+                std::lock_guard<std::mutex> lock(m_sessionsLock);
+                for (const auto &session : m_sessions)
+                {
+                    shutdown(session->Fd, SHUT_RDWR);
+                }
+                threads.swap(m_sessionThreads);
+                sessions.swap(m_sessions);
+                m_subscriptions.clear();
+            }
+
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+            for (const auto &session : sessions)
+            {
+                close(session->Fd);
+            }
+        }
+
+        void MockIpcServer::AcceptLoop()
+        {
+            while (m_running)
+            {
+                int fd = accept(m_listenFd, nullptr, nullptr);
+                if (fd < 0)
+                {
+                    if (m_running && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return;
+                }
+
+#    ifdef SO_NOSIGPIPE
+                int enable = 1;
+                setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#    endif
+
+                auto session = Crt::MakeShared<Session>(Crt::DefaultAllocator());
+                session->Fd = fd;
+
+                std::lock_guard<std::mutex> lock(m_sessionsLock);
+                m_sessions.push_back(session);
+                m_sessionThreads.emplace_back(&MockIpcServer::SessionLoop, this, session);
+            }
+        }
+
+        void MockIpcServer::SessionLoop(std::shared_ptr<Session> session)
+        {
+            Crt::String frame;
+            Request request;
+            while (s_readRequest(session->Fd, frame, request))
+            {
+                if (request.MessageType == s_connect)
+                {
+                    session->Send(s_frame(s_connectAck, s_connectionAccepted, 0, nullptr, Crt::String()));
+                    continue;
+                }
+                if (request.MessageType == s_ping)
+                {
+                    session->Send(s_frame(s_pingResponse, 0, 0, nullptr, Crt::String()));
+                    continue;
+                }
+                if (request.MessageType != s_applicationMessage)
+                {
+                    continue;
+                }
+
+                if (request.Flags & s_terminateStream)
+                {
+                    std::lock_guard<std::mutex> lock(m_sessionsLock);
+                    m_subscriptions.erase(
+                        std::remove_if(
+                            m_subscriptions.begin(),
+                            m_subscriptions.end(),
+                            [&](const Subscription &subscription) {
+                                return subscription.Subscriber == session &&
+                                       subscription.StreamId == request.StreamId;
+                            }),
+                        m_subscriptions.end());
+                    continue;
+                }
+
+                Crt::JsonObject body(request.Payload);
+                Crt::JsonView view = body.View();
+                if (request.Operation == "aws.greengrass#PublishToTopic")
+                {
+                    Crt::String topic = view.GetString("topic");
+                    Crt::String message =
+                        view.GetJsonObject("publishMessage").GetJsonObject("binaryMessage").GetString("message");
+                    session->Send(s_frame(
+                        s_applicationMessage,
+                        s_terminateStream,
+                        request.StreamId,
+                        "aws.greengrass#PublishToTopicResponse",
+                        "{}"));
+                    Deliver(topic, message);
+                }
+                else if (request.Operation == "aws.greengrass#SubscribeToTopic")
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m_sessionsLock);
+                        m_subscriptions.push_back({session, request.StreamId, view.GetString("topic")});
+                    }
+                    session->Send(s_frame(
+                        s_applicationMessage,
+                        0,
+                        request.StreamId,
+                        "aws.greengrass#SubscribeToTopicResponse",
+                        "{}"));
+                }
+                else
+                {
+                    session->Send(s_frame(
+                        s_applicationError,
+                        s_terminateStream,
+                        request.StreamId,
+                        "aws.greengrass#ServiceError",
+                        "{\"message\":\"unsupported operation\"}"));
+                }
+            }
+        }
+
+        void MockIpcServer::Deliver(const Crt::String &topic, const Crt::String &message)
+        {
+            Crt::Vector<Subscription> matching;
+            {
+                std::lock_guard<std::mutex> lock(m_sessionsLock);
+                for (const auto &subscription : m_subscriptions)
+                {
+                    if (subscription.Topic == topic)
+                    {
+                        matching.push_back(subscription);
+                    }
+                }
+            }
+            if (matching.empty())
+            {
+                return;
+            }
+
+            /* The base64 message is forwarded as received; topics need no escaping in the benchmark's use. */
+            Crt::String event("{\"binaryMessage\":{\"message\":\"");
+            event.append(message).append("\",\"context\":{\"topic\":\"").append(topic).append("\"}}}");
+            for (const auto &subscription : matching)
+            {
+                subscription.Subscriber->Send(s_frame(
+                    s_applicationMessage,
+                    0,
+                    subscription.StreamId,
+                    "aws.greengrass#SubscriptionResponseMessage",
+                    event));
+            }
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
+
+#endif // !_WIN32
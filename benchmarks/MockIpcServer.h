@@ -0,0 +1,79 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+
+        /**
+         * An in-process stand-in for the Greengrass core's IPC service on a Unix domain socket, so
+         * Discovery::GreengrassIpcClient can be driven without a core.
+         *
+         * Accepts any auth token. PublishToTopic is answered and its message delivered to every
+         * SubscribeToTopic stream of the same topic, on any connection; wildcards and every other operation
+         * are not understood.
+         *
+         * Requires POSIX sockets; not available on Windows.
+         */
+        class MockIpcServer final
+        {
+          public:
+            MockIpcServer() noexcept;
+            ~MockIpcServer();
+
+            MockIpcServer(const MockIpcServer &) = delete;
+            MockIpcServer &operator=(const MockIpcServer &) = delete;
+
+            /**
+             * Starts listening on a socket in the temporary directory.
+             *
+             * @return false, with errno set, if the socket could not be bound.
+             */
+            bool Start();
+
+            /**
+             * Closes the listener and every client connection, waits for their threads and removes the socket.
+             */
+            void Stop();
+
+            const Crt::String &GetSocketPath() const noexcept { return m_socketPath; }
+
+          private:
+            struct Session;
+
+            struct Subscription
+            {
+                std::shared_ptr<Session> Subscriber;
+                int32_t StreamId;
+                Crt::String Topic;
+            };
+
+            void AcceptLoop();
+            void SessionLoop(std::shared_ptr<Session> session);
+
+            void Deliver(const Crt::String &topic, const Crt::String &message);
+
+            int m_listenFd;
+            Crt::String m_socketPath;
+            std::thread m_acceptThread;
+            std::atomic<bool> m_running;
+
+            std::mutex m_sessionsLock;
+            Crt::Vector<std::shared_ptr<Session>> m_sessions;
+            Crt::Vector<std::thread> m_sessionThreads;
+            Crt::Vector<Subscription> m_subscriptions;
+        };
+
+    } // namespace Benchmarks
+} // namespace Aws
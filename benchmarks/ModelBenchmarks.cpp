@@ -0,0 +1,232 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+#include "PayloadCorpus.h"
+
+#include <aws/crt/JsonObject.h>
+
+#include <aws/iotshadow/DeleteNamedShadowRequest.h>
+#include <aws/iotshadow/DeleteShadowRequest.h>
+#include <aws/iotshadow/DeleteShadowResponse.h>
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/GetNamedShadowRequest.h>
+#include <aws/iotshadow/GetShadowRequest.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowMetadata.h>
+#include <aws/iotshadow/ShadowState.h>
+#include <aws/iotshadow/ShadowStateWithDelta.h>
+#include <aws/iotshadow/ShadowUpdatedEvent.h>
+#include <aws/iotshadow/ShadowUpdatedSnapshot.h>
+#include <aws/iotshadow/UpdateNamedShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowResponse.h>
+
+#include <aws/iotjobs/DescribeJobExecutionRequest.h>
+#include <aws/iotjobs/DescribeJobExecutionResponse.h>
+#include <aws/iotjobs/GetPendingJobExecutionsRequest.h>
+#include <aws/iotjobs/GetPendingJobExecutionsResponse.h>
+#include <aws/iotjobs/JobExecutionData.h>
+#include <aws/iotjobs/JobExecutionState.h>
+#include <aws/iotjobs/JobExecutionSummary.h>
+#include <aws/iotjobs/JobExecutionsChangedEvent.h>
+#include <aws/iotjobs/NextJobExecutionChangedEvent.h>
+#include <aws/iotjobs/RejectedError.h>
+#include <aws/iotjobs/StartNextJobExecutionResponse.h>
+#include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+#include <aws/iotjobs/UpdateJobExecutionResponse.h>
+
+#include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
+#include <aws/iotidentity/CreateCertificateFromCsrResponse.h>
+#include <aws/iotidentity/CreateKeysAndCertificateRequest.h>
+#include <aws/iotidentity/CreateKeysAndCertificateResponse.h>
+#include <aws/iotidentity/ErrorResponse.h>
+#include <aws/iotidentity/RegisterThingRequest.h>
+#include <aws/iotidentity/RegisterThingResponse.h>
+
+#ifdef AWS_BENCHMARKS_DISCOVERY
+#    include <aws/discovery/ConnectivityInfo.h>
+#    include <aws/discovery/DiscoverResponse.h>
+#    include <aws/discovery/GGCore.h>
+#    include <aws/discovery/GGGroup.h>
+#endif
+
+#include <cstring>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            template <typename Model> size_t s_touch(const Model &model)
+            {
+                return static_cast<size_t>(reinterpret_cast<uintptr_t>(&model));
+            }
+
+            /*
+             * "parse" is what a subscription callback pays, text to model; "load" isolates LoadFromObject on an
+             * already parsed tree.
+             */
+            template <typename Model> void s_runLoadBenchmarks(const char *service, const CorpusEntry &entry)
+            {
+                Crt::JsonObject parsed(entry.Payload);
+                if (!parsed.WasParseSuccessful())
+                {
+                    fprintf(
+                        stderr, "model/%s/%s/%s: corpus payload is not valid JSON\n", service, entry.Model, entry.Size);
+                    return;
+                }
+
+                char name[96];
+                snprintf(name, sizeof(name), "model/%s/%s/parse/%s", service, entry.Model, entry.Size);
+                Run(name, entry.Payload.size(), [&entry]() {
+                    Crt::JsonObject jsonObject(entry.Payload);
+                    Model model(jsonObject.View());
+                    g_sink = s_touch(model);
+                });
+
+                Crt::JsonView view = parsed.View();
+                snprintf(name, sizeof(name), "model/%s/%s/load/%s", service, entry.Model, entry.Size);
+                Run(name, entry.Payload.size(), [&view]() {
+                    Model model(view);
+                    g_sink = s_touch(model);
+                });
+            }
+
+            template <typename Model> void s_runSerializeBenchmarks(const char *service, const CorpusEntry &entry)
+            {
+                Crt::JsonObject parsed(entry.Payload);
+                Model model(parsed.View());
+
+                Crt::JsonObject tree;
+                model.SerializeToObject(tree);
+                size_t encodedSize = tree.View().WriteCompact(true).size();
+
+                char name[96];
+                snprintf(name, sizeof(name), "model/%s/%s/serialize/%s", service, entry.Model, entry.Size);
+                Run(name, encodedSize, [&model]() {
+                    Crt::JsonObject object;
+                    model.SerializeToObject(object);
+                    Crt::String outgoingJson = object.View().WriteCompact(true);
+                    g_sink = outgoingJson.size();
+                });
+            }
+
+            /* Every payload of the corpus for `model`, at each of its sizes. */
+            template <typename Model>
+            void s_runModel(const char *service, const Crt::Vector<CorpusEntry> &corpus, const char *model)
+            {
+                for (const CorpusEntry &entry : corpus)
+                {
+                    if (strcmp(entry.Model, model) == 0)
+                    {
+                        s_runLoadBenchmarks<Model>(service, entry);
+                        s_runSerializeBenchmarks<Model>(service, entry);
+                    }
+                }
+            }
+
+            /* The discovery models are parse-only: a device never sends them. */
+            template <typename Model>
+            void s_runParseOnlyModel(const char *service, const Crt::Vector<CorpusEntry> &corpus, const char *model)
+            {
+                for (const CorpusEntry &entry : corpus)
+                {
+                    if (strcmp(entry.Model, model) == 0)
+                    {
+                        s_runLoadBenchmarks<Model>(service, entry);
+                    }
+                }
+            }
+
+            void s_runShadowModels()
+            {
+                const char *service = "shadow";
+                Crt::Vector<CorpusEntry> corpus = BuildCorpus(service);
+                s_runModel<Iotshadow::ShadowState>(service, corpus, "ShadowState");
+                s_runModel<Iotshadow::ShadowStateWithDelta>(service, corpus, "ShadowStateWithDelta");
+                s_runModel<Iotshadow::ShadowMetadata>(service, corpus, "ShadowMetadata");
+                s_runModel<Iotshadow::GetShadowResponse>(service, corpus, "GetShadowResponse");
+                s_runModel<Iotshadow::UpdateShadowRequest>(service, corpus, "UpdateShadowRequest");
+                s_runModel<Iotshadow::UpdateNamedShadowRequest>(service, corpus, "UpdateNamedShadowRequest");
+                s_runModel<Iotshadow::UpdateShadowResponse>(service, corpus, "UpdateShadowResponse");
+                s_runModel<Iotshadow::ShadowDeltaUpdatedEvent>(service, corpus, "ShadowDeltaUpdatedEvent");
+                s_runModel<Iotshadow::ShadowUpdatedSnapshot>(service, corpus, "ShadowUpdatedSnapshot");
+                s_runModel<Iotshadow::ShadowUpdatedEvent>(service, corpus, "ShadowUpdatedEvent");
+                s_runModel<Iotshadow::GetShadowRequest>(service, corpus, "GetShadowRequest");
+                s_runModel<Iotshadow::GetNamedShadowRequest>(service, corpus, "GetNamedShadowRequest");
+                s_runModel<Iotshadow::DeleteShadowRequest>(service, corpus, "DeleteShadowRequest");
+                s_runModel<Iotshadow::DeleteNamedShadowRequest>(service, corpus, "DeleteNamedShadowRequest");
+                s_runModel<Iotshadow::DeleteShadowResponse>(service, corpus, "DeleteShadowResponse");
+                s_runModel<Iotshadow::ErrorResponse>(service, corpus, "ErrorResponse");
+            }
+
+            void s_runJobsModels()
+            {
+                const char *service = "jobs";
+                Crt::Vector<CorpusEntry> corpus = BuildCorpus(service);
+                s_runModel<Iotjobs::JobExecutionData>(service, corpus, "JobExecutionData");
+                s_runModel<Iotjobs::NextJobExecutionChangedEvent>(service, corpus, "NextJobExecutionChangedEvent");
+                s_runModel<Iotjobs::DescribeJobExecutionResponse>(service, corpus, "DescribeJobExecutionResponse");
+                s_runModel<Iotjobs::StartNextJobExecutionResponse>(service, corpus, "StartNextJobExecutionResponse");
+                s_runModel<Iotjobs::UpdateJobExecutionResponse>(service, corpus, "UpdateJobExecutionResponse");
+                s_runModel<Iotjobs::GetPendingJobExecutionsResponse>(
+                    service, corpus, "GetPendingJobExecutionsResponse");
+                s_runModel<Iotjobs::JobExecutionsChangedEvent>(service, corpus, "JobExecutionsChangedEvent");
+                s_runModel<Iotjobs::UpdateJobExecutionRequest>(service, corpus, "UpdateJobExecutionRequest");
+                s_runModel<Iotjobs::JobExecutionState>(service, corpus, "JobExecutionState");
+                s_runModel<Iotjobs::JobExecutionSummary>(service, corpus, "JobExecutionSummary");
+                s_runModel<Iotjobs::DescribeJobExecutionRequest>(service, corpus, "DescribeJobExecutionRequest");
+                s_runModel<Iotjobs::GetPendingJobExecutionsRequest>(service, corpus, "GetPendingJobExecutionsRequest");
+                s_runModel<Iotjobs::StartNextPendingJobExecutionRequest>(
+                    service, corpus, "StartNextPendingJobExecutionRequest");
+                s_runModel<Iotjobs::RejectedError>(service, corpus, "RejectedError");
+            }
+
+            void s_runIdentityModels()
+            {
+                const char *service = "identity";
+                Crt::Vector<CorpusEntry> corpus = BuildCorpus(service);
+                s_runModel<Iotidentity::CreateKeysAndCertificateRequest>(
+                    service, corpus, "CreateKeysAndCertificateRequest");
+                s_runModel<Iotidentity::CreateKeysAndCertificateResponse>(
+                    service, corpus, "CreateKeysAndCertificateResponse");
+                s_runModel<Iotidentity::CreateCertificateFromCsrRequest>(
+                    service, corpus, "CreateCertificateFromCsrRequest");
+                s_runModel<Iotidentity::CreateCertificateFromCsrResponse>(
+                    service, corpus, "CreateCertificateFromCsrResponse");
+                s_runModel<Iotidentity::RegisterThingRequest>(service, corpus, "RegisterThingRequest");
+                s_runModel<Iotidentity::RegisterThingResponse>(service, corpus, "RegisterThingResponse");
+                s_runModel<Iotidentity::ErrorResponse>(service, corpus, "ErrorResponse");
+            }
+
+#ifdef AWS_BENCHMARKS_DISCOVERY
+            void s_runDiscoveryModels()
+            {
+                const char *service = "discovery";
+                Crt::Vector<CorpusEntry> corpus = BuildCorpus(service);
+                s_runParseOnlyModel<Discovery::DiscoverResponse>(service, corpus, "DiscoverResponse");
+                s_runParseOnlyModel<Discovery::GGGroup>(service, corpus, "GGGroup");
+                s_runParseOnlyModel<Discovery::GGCore>(service, corpus, "GGCore");
+                s_runParseOnlyModel<Discovery::ConnectivityInfo>(service, corpus, "ConnectivityInfo");
+            }
+#endif
+        } // namespace
+
+        void RunModelBenchmarks()
+        {
+            s_runShadowModels();
+            s_runJobsModels();
+            s_runIdentityModels();
+#ifdef AWS_BENCHMARKS_DISCOVERY
+            s_runDiscoveryModels();
+#endif
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
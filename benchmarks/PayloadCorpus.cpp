@@ -0,0 +1,430 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "PayloadCorpus.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            struct CorpusSize
+            {
+                const char *Name;
+                /* How many repeated elements (sensors, packages, jobs, groups) the payload holds. */
+                size_t Count;
+            };
+
+            /* Shadow state sections of about 150 bytes, 3 KB and 45 KB; job documents of 200 bytes, 5 KB and 75 KB. */
+            const CorpusSize s_documentSizes[] = {{"small", 1}, {"medium", 25}, {"large", 400}};
+            const CorpusSize s_listSizes[] = {{"small", 1}, {"medium", 10}, {"large", 100}};
+
+            const char *s_clientToken = "\"clientToken\":\"5f1c9e0a-8d3b-4c7e-a2f4-9b6d1e3c7a58\"";
+            const char *s_timestamp = "\"timestamp\":1700000000";
+
+            Crt::String s_format(const char *format, size_t value)
+            {
+                char buffer[128];
+                snprintf(buffer, sizeof(buffer), format, value);
+                return Crt::String(buffer);
+            }
+
+            /* A device's reported sensors, about 160 bytes each, as a shadow state section. */
+            Crt::String s_sensorDocument(size_t sensors)
+            {
+                Crt::String document("{\"mode\":\"auto\",\"sensors\":{");
+                for (size_t i = 0; i < sensors; ++i)
+                {
+                    document.append(i ? "," : "")
+                        .append(s_format("\"sensor-%04zu\":", i))
+                        .append("{\"temperature\":21.5,\"humidity\":40,\"online\":true,\"firmware\":\"1.4.2\","
+                                "\"thresholds\":{\"high\":30,\"low\":5}}");
+                }
+                return document.append("}}");
+            }
+
+            /* The metadata the service keeps for s_sensorDocument: a timestamp for every leaf. */
+            Crt::String s_sensorMetadata(size_t sensors)
+            {
+                const char *leaf = "{\"timestamp\":1700000000}";
+                Crt::String metadata("{\"mode\":");
+                metadata.append(leaf).append(",\"sensors\":{");
+                for (size_t i = 0; i < sensors; ++i)
+                {
+                    metadata.append(i ? "," : "").append(s_format("\"sensor-%04zu\":", i));
+                    metadata.append("{\"temperature\":").append(leaf).append(",\"humidity\":").append(leaf);
+                    metadata.append(",\"online\":").append(leaf).append(",\"firmware\":").append(leaf);
+                    metadata.append(",\"thresholds\":{\"high\":").append(leaf).append(",\"low\":").append(leaf);
+                    metadata.append("}}");
+                }
+                return metadata.append("}}");
+            }
+
+            /* An install job: one package entry, about 200 bytes, per count. */
+            Crt::String s_jobDocument(size_t packages)
+            {
+                Crt::String document("{\"operation\":\"install\",\"rebootAfter\":true,\"packages\":[");
+                for (size_t i = 0; i < packages; ++i)
+                {
+                    Crt::String name = s_format("pkg-%04zu", i);
+                    document.append(i ? "," : "")
+                        .append("{\"name\":\"")
+                        .append(name)
+                        .append("\",\"version\":\"2.3.1\",\"url\":\"https://example-bucket.s3.amazonaws.com/packages/")
+                        .append(name)
+                        .append("-2.3.1.tar.gz\",\"sha256\":\"")
+                        .append("3b7e9c1f5a2d8e4b6c0f9a1d3e5b7c9f2a4d6e8b0c1f3a5d7e9b2c4f6a8d0e1b")
+                        .append("\"}");
+                }
+                return document.append("]}");
+            }
+
+            Crt::String s_statusDetails(size_t entries)
+            {
+                Crt::String details("{");
+                for (size_t i = 0; i < entries; ++i)
+                {
+                    details.append(i ? "," : "")
+                        .append(s_format("\"step-%03zu\":", i))
+                        .append("\"downloaded and verified\"");
+                }
+                return details.append("}");
+            }
+
+            Crt::String s_jobExecution(size_t packages)
+            {
+                return Crt::String("{\"jobId\":\"install-firmware-2024-06\",\"thingName\":\"sensor-gateway-0042\","
+                                   "\"status\":\"QUEUED\",\"queuedAt\":1700000000,\"startedAt\":1700000010,"
+                                   "\"lastUpdatedAt\":1700000020,\"versionNumber\":3,\"executionNumber\":1,"
+                                   "\"statusDetails\":") +
+                       s_statusDetails(2) + ",\"jobDocument\":" + s_jobDocument(packages) + "}";
+            }
+
+            Crt::String s_jobSummary(size_t index)
+            {
+                return s_format("{\"jobId\":\"rollout-%04zu\",", index) +
+                       "\"executionNumber\":1,\"versionNumber\":1,\"queuedAt\":1700000000,"
+                       "\"startedAt\":1700000010,\"lastUpdatedAt\":1700000020}";
+            }
+
+            Crt::String s_jobSummaries(size_t jobs)
+            {
+                Crt::String summaries("[");
+                for (size_t i = 0; i < jobs; ++i)
+                {
+                    summaries.append(i ? "," : "").append(s_jobSummary(i));
+                }
+                return summaries.append("]");
+            }
+
+            /* PEM-shaped text of `bytes` base64 characters, with JSON-escaped line breaks every 64. */
+            Crt::String s_pem(const char *label, size_t bytes, uint32_t seed)
+            {
+                static const char s_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+                Crt::String pem("-----BEGIN ");
+                pem.append(label).append("-----\\n");
+                for (size_t i = 0; i < bytes; ++i)
+                {
+                    seed = seed * 1103515245u + 12345u;
+                    pem.push_back(s_alphabet[(seed >> 16) % 64]);
+                    if (i % 64 == 63)
+                    {
+                        pem.append("\\n");
+                    }
+                }
+                return pem.append("\\n-----END ").append(label).append("-----\\n");
+            }
+
+            Crt::String s_ownershipToken()
+            {
+                Crt::String token = s_pem("TOKEN", 640, 7);
+                /* A single base64 line rather than PEM. */
+                Crt::String line;
+                for (char c : token)
+                {
+                    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))
+                    {
+                        line.push_back(c);
+                    }
+                }
+                return line;
+            }
+
+            Crt::String s_connectivity(size_t endpoints)
+            {
+                Crt::String connectivity("[");
+                for (size_t i = 0; i < endpoints; ++i)
+                {
+                    connectivity.append(i ? "," : "")
+                        .append(s_format("{\"Id\":\"endpoint-%zu\",", i))
+                        .append(s_format("\"HostAddress\":\"192.168.1.%zu\",", 10 + i))
+                        .append("\"PortNumber\":8883,\"Metadata\":\"lan\"}");
+                }
+                return connectivity.append("]");
+            }
+
+            Crt::String s_core(size_t index, size_t endpoints)
+            {
+                return s_format("{\"thingArn\":\"arn:aws:iot:us-east-1:123456789012:thing/gg-core-%04zu\",", index) +
+                       "\"Connectivity\":" + s_connectivity(endpoints) + "}";
+            }
+
+            Crt::String s_group(size_t index, size_t cores, size_t endpoints, size_t cas)
+            {
+                Crt::String group = s_format("{\"GGGroupId\":\"gg-group-%04zu\",\"Cores\":[", index);
+                for (size_t i = 0; i < cores; ++i)
+                {
+                    group.append(i ? "," : "").append(s_core(index * 100 + i, endpoints));
+                }
+                group.append("],\"CAs\":[");
+                for (size_t i = 0; i < cas; ++i)
+                {
+                    group.append(i ? ",\"" : "\"")
+                        .append(s_pem("CERTIFICATE", 1200, static_cast<uint32_t>(index * 16 + i)))
+                        .append("\"");
+                }
+                return group.append("]}");
+            }
+
+            void s_shadowCorpus(Crt::Vector<CorpusEntry> &corpus)
+            {
+                for (const CorpusSize &size : s_documentSizes)
+                {
+                    Crt::String document = s_sensorDocument(size.Count);
+                    Crt::String metadata = s_sensorMetadata(size.Count);
+                    Crt::String state = "{\"desired\":" + document + ",\"reported\":" + document + "}";
+                    Crt::String stateMetadata = "{\"desired\":" + metadata + ",\"reported\":" + metadata + "}";
+                    Crt::String snapshot =
+                        "{\"state\":" + state + ",\"metadata\":" + stateMetadata + ",\"version\":42}";
+
+                    corpus.push_back({"ShadowState", size.Name, state});
+                    corpus.push_back(
+                        {"ShadowStateWithDelta",
+                         size.Name,
+                         "{\"desired\":" + document + ",\"reported\":" + document + ",\"delta\":" + document + "}"});
+                    corpus.push_back({"ShadowMetadata", size.Name, stateMetadata});
+                    corpus.push_back(
+                        {"GetShadowResponse",
+                         size.Name,
+                         "{\"state\":" + state + ",\"metadata\":" + stateMetadata + ",\"version\":42," + s_timestamp +
+                             "," + s_clientToken + "}"});
+                    corpus.push_back(
+                        {"UpdateShadowRequest",
+                         size.Name,
+                         "{\"state\":{\"reported\":" + document + "},\"version\":42," + s_clientToken + "}"});
+                    corpus.push_back(
+                        {"UpdateNamedShadowRequest",
+                         size.Name,
+                         "{\"state\":{\"reported\":" + document + "},\"version\":42," + s_clientToken + "}"});
+                    corpus.push_back(
+                        {"UpdateShadowResponse",
+                         size.Name,
+                         "{\"state\":{\"reported\":" + document + "},\"metadata\":{\"reported\":" + metadata +
+                             "},\"version\":43," + s_timestamp + "," + s_clientToken + "}"});
+                    corpus.push_back(
+                        {"ShadowDeltaUpdatedEvent",
+                         size.Name,
+                         "{\"state\":" + document + ",\"metadata\":" + metadata + ",\"version\":43," + s_timestamp +
+                             "," + s_clientToken + "}"});
+                    corpus.push_back({"ShadowUpdatedSnapshot", size.Name, snapshot});
+                    corpus.push_back(
+                        {"ShadowUpdatedEvent",
+                         size.Name,
+                         "{\"previous\":" + snapshot + ",\"current\":" + snapshot + "," + s_timestamp + "," +
+                             s_clientToken + "}"});
+                }
+
+                Crt::String tokenOnly = Crt::String("{") + s_clientToken + "}";
+                corpus.push_back({"GetShadowRequest", "typical", tokenOnly});
+                corpus.push_back({"GetNamedShadowRequest", "typical", tokenOnly});
+                corpus.push_back({"DeleteShadowRequest", "typical", tokenOnly});
+                corpus.push_back({"DeleteNamedShadowRequest", "typical", tokenOnly});
+                corpus.push_back(
+                    {"DeleteShadowResponse",
+                     "typical",
+                     Crt::String("{\"version\":43,") + s_timestamp + "," + s_clientToken + "}"});
+                corpus.push_back(
+                    {"ErrorResponse",
+                     "typical",
+                     Crt::String("{\"code\":409,\"message\":\"Version conflict\",") + s_timestamp + "," +
+                         s_clientToken + "}"});
+            }
+
+            void s_jobsCorpus(Crt::Vector<CorpusEntry> &corpus)
+            {
+                for (const CorpusSize &size : s_documentSizes)
+                {
+                    Crt::String execution = s_jobExecution(size.Count);
+                    Crt::String wrapped =
+                        "{\"execution\":" + execution + "," + s_timestamp + "," + s_clientToken + "}";
+                    corpus.push_back({"JobExecutionData", size.Name, execution});
+                    corpus.push_back(
+                        {"NextJobExecutionChangedEvent",
+                         size.Name,
+                         "{\"execution\":" + execution + "," + s_timestamp + "}"});
+                    corpus.push_back({"DescribeJobExecutionResponse", size.Name, wrapped});
+                    corpus.push_back({"StartNextJobExecutionResponse", size.Name, wrapped});
+                    corpus.push_back(
+                        {"UpdateJobExecutionResponse",
+                         size.Name,
+                         "{\"executionState\":{\"status\":\"IN_PROGRESS\",\"statusDetails\":" + s_statusDetails(2) +
+                             ",\"versionNumber\":4},\"jobDocument\":" + s_jobDocument(size.Count) + "," +
+                             s_timestamp + "," + s_clientToken + "}"});
+                }
+
+                for (const CorpusSize &size : s_listSizes)
+                {
+                    Crt::String summaries = s_jobSummaries(size.Count);
+                    corpus.push_back(
+                        {"GetPendingJobExecutionsResponse",
+                         size.Name,
+                         "{\"inProgressJobs\":" + summaries + ",\"queuedJobs\":" + summaries + "," + s_timestamp +
+                             "," + s_clientToken + "}"});
+                    corpus.push_back(
+                        {"JobExecutionsChangedEvent",
+                         size.Name,
+                         "{\"jobs\":{\"QUEUED\":" + summaries + ",\"IN_PROGRESS\":" + summaries + "}," +
+                             s_timestamp + "}"});
+
+                    /* Progress reports: a couple of steps normally, many for a long multi-stage install. */
+                    Crt::String details = s_statusDetails(size.Count * 2);
+                    corpus.push_back(
+                        {"UpdateJobExecutionRequest",
+                         size.Name,
+                         "{\"status\":\"IN_PROGRESS\",\"statusDetails\":" + details +
+                             ",\"expectedVersion\":3,\"executionNumber\":1,\"includeJobExecutionState\":true,"
+                             "\"includeJobDocument\":false,\"stepTimeoutInMinutes\":30," +
+                             s_clientToken + "}"});
+                    corpus.push_back(
+                        {"JobExecutionState",
+                         size.Name,
+                         "{\"status\":\"IN_PROGRESS\",\"statusDetails\":" + details + ",\"versionNumber\":4}"});
+                }
+
+                corpus.push_back({"JobExecutionSummary", "typical", s_jobSummary(0)});
+                corpus.push_back(
+                    {"DescribeJobExecutionRequest",
+                     "typical",
+                     Crt::String("{\"executionNumber\":1,\"includeJobDocument\":true,") + s_clientToken + "}"});
+                corpus.push_back(
+                    {"GetPendingJobExecutionsRequest", "typical", Crt::String("{") + s_clientToken + "}"});
+                corpus.push_back(
+                    {"StartNextPendingJobExecutionRequest",
+                     "typical",
+                     "{\"statusDetails\":" + s_statusDetails(2) + ",\"stepTimeoutInMinutes\":30," + s_clientToken +
+                         "}"});
+                corpus.push_back(
+                    {"RejectedError",
+                     "typical",
+                     Crt::String("{\"code\":\"VersionMismatch\",\"message\":\"Expected version does not match\","
+                                 "\"executionState\":{\"status\":\"IN_PROGRESS\",\"versionNumber\":5},") +
+                         s_timestamp + "," + s_clientToken + "}"});
+            }
+
+            void s_identityCorpus(Crt::Vector<CorpusEntry> &corpus)
+            {
+                Crt::String certificate = s_pem("CERTIFICATE", 1200, 1);
+                Crt::String certificateId =
+                    "\"certificateId\":\"a1b2c3d4e5f60718293a4b5c6d7e8f90a1b2c3d4e5f60718293a4b5c6d7e8f90\"";
+                Crt::String token = "\"certificateOwnershipToken\":\"" + s_ownershipToken() + "\"";
+
+                corpus.push_back(
+                    {"CreateKeysAndCertificateResponse",
+                     "typical",
+                     "{" + certificateId + ",\"certificatePem\":\"" + certificate + "\",\"privateKey\":\"" +
+                         s_pem("RSA PRIVATE KEY", 1600, 2) + "\"," + token + "}"});
+                corpus.push_back({"CreateKeysAndCertificateRequest", "typical", "{}"});
+                corpus.push_back(
+                    {"CreateCertificateFromCsrResponse",
+                     "typical",
+                     "{" + certificateId + ",\"certificatePem\":\"" + certificate + "\"," + token + "}"});
+                corpus.push_back(
+                    {"CreateCertificateFromCsrRequest",
+                     "typical",
+                     "{\"certificateSigningRequest\":\"" + s_pem("CERTIFICATE REQUEST", 900, 3) + "\"}"});
+                corpus.push_back(
+                    {"ErrorResponse",
+                     "typical",
+                     "{\"statusCode\":400,\"errorCode\":\"InvalidPayload\","
+                     "\"errorMessage\":\"Template parameter SerialNumber is missing\"}"});
+
+                for (const CorpusSize &size : s_listSizes)
+                {
+                    Crt::String parameters("{");
+                    for (size_t i = 0; i < size.Count * 4; ++i)
+                    {
+                        parameters.append(i ? "," : "")
+                            .append(s_format("\"Parameter%03zu\":\"", i))
+                            .append(s_format("value-%06zu\"", i * 7919));
+                    }
+                    parameters.append("}");
+                    corpus.push_back(
+                        {"RegisterThingRequest", size.Name, "{" + token + ",\"parameters\":" + parameters + "}"});
+                    corpus.push_back(
+                        {"RegisterThingResponse",
+                         size.Name,
+                         "{\"thingName\":\"sensor-gateway-0042\",\"deviceConfiguration\":" + parameters + "}"});
+                }
+            }
+
+            void s_discoveryCorpus(Crt::Vector<CorpusEntry> &corpus)
+            {
+                struct DiscoverSize
+                {
+                    const char *Name;
+                    size_t Groups;
+                    size_t Cores;
+                    size_t Endpoints;
+                    size_t Cas;
+                };
+                const DiscoverSize sizes[] = {{"small", 1, 1, 1, 1}, {"medium", 2, 3, 3, 2}, {"large", 8, 8, 4, 4}};
+
+                for (const DiscoverSize &size : sizes)
+                {
+                    Crt::String response("{\"GGGroups\":[");
+                    for (size_t i = 0; i < size.Groups; ++i)
+                    {
+                        response.append(i ? "," : "").append(s_group(i, size.Cores, size.Endpoints, size.Cas));
+                    }
+                    corpus.push_back({"DiscoverResponse", size.Name, response.append("]}")});
+                    corpus.push_back({"GGGroup", size.Name, s_group(0, size.Cores, size.Endpoints, size.Cas)});
+                    corpus.push_back({"GGCore", size.Name, s_core(0, size.Endpoints * 2)});
+                }
+                corpus.push_back(
+                    {"ConnectivityInfo",
+                     "typical",
+                     "{\"Id\":\"endpoint-0\",\"HostAddress\":\"192.168.1.10\",\"PortNumber\":8883,"
+                     "\"Metadata\":\"lan\"}"});
+            }
+        } // namespace
+
+        Crt::Vector<CorpusEntry> BuildCorpus(const char *service)
+        {
+            Crt::Vector<CorpusEntry> corpus;
+            if (strcmp(service, "shadow") == 0)
+            {
+                s_shadowCorpus(corpus);
+            }
+            else if (strcmp(service, "jobs") == 0)
+            {
+                s_jobsCorpus(corpus);
+            }
+            else if (strcmp(service, "identity") == 0)
+            {
+                s_identityCorpus(corpus);
+            }
+            else if (strcmp(service, "discovery") == 0)
+            {
+                s_discoveryCorpus(corpus);
+            }
+            return corpus;
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
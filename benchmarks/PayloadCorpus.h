@@ -0,0 +1,35 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+
+        /**
+         * One payload of the corpus: what a device receives or sends for `Model`, at a given size.
+         */
+        struct CorpusEntry
+        {
+            /* The generated model class the payload parses into, e.g. "GetShadowResponse". */
+            const char *Model;
+            /* "small", "medium" or "large"; models whose payloads do not vary in size only have "typical". */
+            const char *Size;
+            Crt::String Payload;
+        };
+
+        /**
+         * Realistic payloads for every generated model of a service ("shadow", "jobs", "identity" or
+         * "discovery"): nested shadow documents of sensors and settings, job executions carrying a large
+         * jobDocument, fleet provisioning responses with PEM certificates and keys, and Discover responses
+         * listing many groups, cores and CAs. The corpus is built deterministically, so runs compare.
+         */
+        Crt::Vector<CorpusEntry> BuildCorpus(const char *service);
+
+    } // namespace Benchmarks
+} // namespace Aws
@@ -0,0 +1,292 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+
+#if !defined(_WIN32) && defined(AWS_BENCHMARKS_SECURE_TUNNELING)
+
+#    include <aws/crt/io/SocketOptions.h>
+#    include <aws/iotdevice/private/serializer.h>
+#    include <aws/iotdevicecommon/IotDevice.h>
+#    include <aws/iotsecuretunneling/SecureTunnel.h>
+#    include <aws/iotsecuretunneling/TunnelCompression.h>
+
+#    include <cstring>
+#    include <ctime>
+
+extern "C"
+{
+    struct aws_websocket_incoming_frame;
+    /* aws-c-iot's websocket payload handler, called directly so no proxy is needed. */
+    extern bool on_websocket_incoming_frame_payload(
+        struct aws_websocket *websocket,
+        const struct aws_websocket_incoming_frame *frame,
+        struct aws_byte_cursor data,
+        void *user_data);
+}
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            const int32_t s_streamId = 10;
+            const size_t s_bytesPerFrameSize = 8 * 1024 * 1024;
+
+            size_t s_receivedBytes = 0;
+
+            /* Serializes `message` into a websocket frame payload, with the 2 byte length prefix of the protocol. */
+            void s_initWebsocketFrame(
+                aws_byte_buf &websocketFrame,
+                const aws_iot_st_msg &message,
+                Crt::Allocator *allocator)
+            {
+                aws_byte_buf serialized;
+                aws_iot_st_msg_serialize_from_struct(&serialized, allocator, message);
+
+                aws_byte_buf_init(&websocketFrame, allocator, serialized.len + 2);
+                aws_byte_buf_write_be16(&websocketFrame, static_cast<uint16_t>(serialized.len));
+                aws_byte_cursor serializedCursor = aws_byte_cursor_from_buf(&serialized);
+                aws_byte_buf_append(&websocketFrame, &serializedCursor);
+
+                aws_byte_buf_clean_up(&serialized);
+            }
+
+            /*
+             * Feeds DATA frames of each size through the destination's receive path, the way the websocket
+             * would, and reports throughput, per-frame latency and CPU time per MB. Nothing is sent: the
+             * source side and the proxy are not part of the measurement.
+             */
+            bool s_runReceiveThroughput(Crt::Allocator *allocator)
+            {
+                Iotdevicecommon::DeviceApiHandle deviceApiHandle(allocator);
+                Crt::Io::EventLoopGroup eventLoopGroup(1, allocator);
+                Crt::Io::DefaultHostResolver resolver(eventLoopGroup, 8, 30, allocator);
+                Crt::Io::ClientBootstrap clientBootstrap(eventLoopGroup, resolver, allocator);
+                Iotsecuretunneling::SecureTunnel secureTunnel(
+                    allocator,
+                    &clientBootstrap,
+                    Crt::Io::SocketOptions(),
+                    "access_token",
+                    AWS_SECURE_TUNNELING_DESTINATION_MODE,
+                    "endpoint",
+                    "",
+                    []() {},
+                    []() {},
+                    [](int) {},
+                    [](const Crt::ByteBuf &data) { s_receivedBytes += data.len; },
+                    []() {},
+                    []() {},
+                    []() {});
+                aws_secure_tunnel *tunnel = secureTunnel.GetUnderlyingHandle();
+
+                aws_iot_st_msg message;
+                AWS_ZERO_STRUCT(message);
+                message.type = STREAM_START;
+                message.stream_id = s_streamId;
+                aws_byte_buf streamStart;
+                s_initWebsocketFrame(streamStart, message, allocator);
+                on_websocket_incoming_frame_payload(nullptr, nullptr, aws_byte_cursor_from_buf(&streamStart), tunnel);
+                aws_byte_buf_clean_up(&streamStart);
+
+                bool delivered = true;
+                const size_t frameSizes[] = {64, 512, 4096, 16384, 60000};
+                for (size_t frameSize : frameSizes)
+                {
+                    aws_byte_buf payload;
+                    aws_byte_buf_init(&payload, allocator, frameSize);
+                    memset(payload.buffer, 'x', frameSize);
+                    payload.len = frameSize;
+
+                    AWS_ZERO_STRUCT(message);
+                    message.type = DATA;
+                    message.stream_id = s_streamId;
+                    message.payload = payload;
+                    aws_byte_buf frame;
+                    s_initWebsocketFrame(frame, message, allocator);
+                    aws_byte_buf_clean_up(&payload);
+
+                    size_t frameCount = s_bytesPerFrameSize / frameSize;
+                    uint64_t maxFrameNs = 0;
+                    s_receivedBytes = 0;
+
+                    clock_t cpuStart = clock();
+                    uint64_t wallStart = 0;
+                    aws_high_res_clock_get_ticks(&wallStart);
+                    for (size_t i = 0; i < frameCount; ++i)
+                    {
+                        uint64_t frameStart = 0;
+                        aws_high_res_clock_get_ticks(&frameStart);
+                        on_websocket_incoming_frame_payload(nullptr, nullptr, aws_byte_cursor_from_buf(&frame), tunnel);
+                        uint64_t frameEnd = 0;
+                        aws_high_res_clock_get_ticks(&frameEnd);
+                        maxFrameNs = frameEnd - frameStart > maxFrameNs ? frameEnd - frameStart : maxFrameNs;
+                    }
+                    uint64_t wallEnd = 0;
+                    aws_high_res_clock_get_ticks(&wallEnd);
+                    clock_t cpuEnd = clock();
+
+                    aws_byte_buf_clean_up(&frame);
+
+                    if (s_receivedBytes != frameCount * frameSize)
+                    {
+                        fprintf(
+                            stderr, "tunnel: %zu of %zu bytes delivered\n", s_receivedBytes, frameCount * frameSize);
+                        delivered = false;
+                        continue;
+                    }
+
+                    char name[96];
+                    snprintf(name, sizeof(name), "tunnel/receive/%zu", frameSize);
+                    double seconds = static_cast<double>(wallEnd - wallStart) / 1e9;
+                    double megabytes = static_cast<double>(s_receivedBytes) / (1024.0 * 1024.0);
+                    double cpuSeconds = static_cast<double>(cpuEnd - cpuStart) / CLOCKS_PER_SEC;
+                    printf(
+                        "%-56s\t%8zu B\t%10.1f MB/s\tavg %9.0f ns\tmax %9llu ns\t%7.3f ms CPU/MB\n",
+                        name,
+                        frameSize,
+                        seconds > 0 ? megabytes / seconds : 0.0,
+                        static_cast<double>(wallEnd - wallStart) / static_cast<double>(frameCount),
+                        static_cast<unsigned long long>(maxFrameNs),
+                        megabytes > 0 ? cpuSeconds * 1000.0 / megabytes : 0.0);
+                }
+
+                return delivered;
+            }
+
+            /* Log-like lines, mostly repeated structure with varying fields, the way tunneled shells and tails look. */
+            void s_appendLogLines(Crt::Vector<uint8_t> &corpus, size_t bytes)
+            {
+                uint32_t state = 12345;
+                char line[160];
+                while (corpus.size() < bytes)
+                {
+                    state = state * 1103515245 + 12345;
+                    int written = snprintf(
+                        line,
+                        sizeof(line),
+                        "2026-10-14T05:%02u:%02u.%03u INFO [worker-%u] GET /api/v1/items/%u status=200 bytes=%u\n",
+                        (state >> 8) % 60,
+                        (state >> 12) % 60,
+                        (state >> 4) % 1000,
+                        (state >> 20) % 8,
+                        (state >> 6) % 5000,
+                        (state >> 3) % 90000);
+                    corpus.insert(corpus.end(), line, line + written);
+                }
+                corpus.resize(bytes);
+            }
+
+            void s_appendRandomBytes(Crt::Vector<uint8_t> &corpus, size_t bytes)
+            {
+                uint32_t state = 54321;
+                while (corpus.size() < bytes)
+                {
+                    state = state * 1103515245 + 12345;
+                    corpus.push_back(static_cast<uint8_t>(state >> 16));
+                }
+            }
+
+            /*
+             * Encodes and decodes log-like text and incompressible bytes at several levels and window sizes,
+             * reporting the compression ratio and the CPU time each end spends per MB; compare the ratio with the
+             * link's cost per MB to see when compression pays.
+             */
+            bool s_runCompression(Crt::Allocator *allocator)
+            {
+                if (!Iotsecuretunneling::TunnelStreamEncoder::IsDeflateSupported())
+                {
+                    printf("tunnel/compression: built without USE_TUNNEL_COMPRESSION, nothing to measure\n");
+                    return true;
+                }
+
+                const size_t corpusBytes = 4 * 1024 * 1024;
+                const size_t writeBytes = 4096;
+                const size_t minCompressedBytes = 64;
+                Crt::Vector<uint8_t> text(allocator);
+                s_appendLogLines(text, corpusBytes);
+                Crt::Vector<uint8_t> random(allocator);
+                s_appendRandomBytes(random, corpusBytes);
+
+                struct Corpus
+                {
+                    const char *Name;
+                    const Crt::Vector<uint8_t> *Data;
+                };
+                const Corpus corpora[] = {{"text", &text}, {"random", &random}};
+                const int settings[][2] = {{1, 10}, {6, 10}, {6, 15}, {9, 15}};
+
+                for (const Corpus &corpus : corpora)
+                {
+                    for (const auto &setting : settings)
+                    {
+                        Iotsecuretunneling::TunnelStreamEncoder encoder(
+                            setting[0], setting[1], minCompressedBytes, allocator);
+                        encoder.OnPeerOffer(setting[1]);
+                        Crt::Vector<uint8_t> wire(allocator);
+                        wire.reserve(corpusBytes + corpusBytes / 8);
+
+                        clock_t encodeStart = clock();
+                        for (size_t offset = 0; offset < corpus.Data->size(); offset += writeBytes)
+                        {
+                            Crt::ByteCursor write =
+                                aws_byte_cursor_from_array(corpus.Data->data() + offset, writeBytes);
+                            if (encoder.Append(write, wire) != AWS_OP_SUCCESS)
+                            {
+                                fprintf(stderr, "tunnel: encoding failed: %s\n", aws_error_name(aws_last_error()));
+                                return false;
+                            }
+                        }
+                        clock_t encodeEnd = clock();
+
+                        Iotsecuretunneling::TunnelStreamDecoder decoder(setting[1], allocator);
+                        int peerWindowBits = -1;
+                        size_t decodedBytes = 0;
+                        clock_t decodeStart = clock();
+                        int decodeResult = decoder.Decode(
+                            aws_byte_cursor_from_array(wire.data(), wire.size()),
+                            peerWindowBits,
+                            [&decodedBytes](const Crt::ByteCursor &data) { decodedBytes += data.len; });
+                        clock_t decodeEnd = clock();
+                        if (decodeResult != AWS_OP_SUCCESS || decodedBytes != corpus.Data->size())
+                        {
+                            fprintf(stderr, "tunnel: %zu of %zu bytes decoded\n", decodedBytes, corpus.Data->size());
+                            return false;
+                        }
+
+                        char name[96];
+                        snprintf(
+                            name,
+                            sizeof(name),
+                            "tunnel/compression/%s/level %d/window 2^%d",
+                            corpus.Name,
+                            setting[0],
+                            setting[1]);
+                        double megabytes = static_cast<double>(corpus.Data->size()) / (1024.0 * 1024.0);
+                        printf(
+                            "%-56s\tratio %5.2f\t%7.2f ms CPU/MB to compress\t%6.2f ms CPU/MB to inflate\n",
+                            name,
+                            static_cast<double>(encoder.GetBytesIn()) / static_cast<double>(encoder.GetBytesOut()),
+                            static_cast<double>(encodeEnd - encodeStart) * 1000.0 / CLOCKS_PER_SEC / megabytes,
+                            static_cast<double>(decodeEnd - decodeStart) * 1000.0 / CLOCKS_PER_SEC / megabytes);
+                    }
+                }
+
+                return true;
+            }
+        } // namespace
+
+        bool RunSecureTunnelingBenchmarks()
+        {
+            bool received = s_runReceiveThroughput(Crt::DefaultAllocator());
+            bool compressed = s_runCompression(Crt::DefaultAllocator());
+            return received && compressed;
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
+
+#endif
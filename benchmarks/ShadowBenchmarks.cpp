@@ -0,0 +1,133 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+
+#include <aws/iotdevicecommon/PayloadBufferPool.h>
+#include <aws/iotdevicecommon/PayloadCodec.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/GetShadowSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowTopicDemultiplexer.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            Crt::String s_makeGetShadowResponse(size_t targetBytes)
+            {
+                return Crt::String("{\"state\":{\"reported\":") + MakeJsonDocument(targetBytes) +
+                       "},\"version\":42,\"timestamp\":1600000000}";
+            }
+
+            void s_runSerializeBenchmarks(size_t size)
+            {
+                Iotshadow::UpdateShadowRequest request;
+                request.ThingName = "benchmark-thing";
+                request.ClientToken = "a8b6b0a0-6c8f-4a3e-9d3e-6f0a7b8c9d0e";
+                request.Version = 42;
+                request.State = Iotshadow::ShadowState();
+                request.State->Reported = Crt::JsonObject(MakeJsonDocument(size));
+
+                size_t encodedSize = 0;
+                Crt::JsonObject tree;
+                request.SerializeToObject(tree);
+                encodedSize = tree.View().WriteCompact(true).size();
+
+                char name[96];
+                snprintf(name, sizeof(name), "shadow/serialize/UpdateShadowRequest/tree/%zu", size);
+                Run(name, encodedSize, [&request]() {
+                    Crt::JsonObject object;
+                    request.SerializeToObject(object);
+                    Crt::String outgoingJson = object.View().WriteCompact(true);
+                    g_sink = outgoingJson.size();
+                });
+
+                Iotdevicecommon::PayloadBufferPool pool(1, SIZE_MAX);
+                const Iotdevicecommon::PayloadFormat formats[] = {Iotdevicecommon::PayloadFormat::Json,
+                                                                  Iotdevicecommon::PayloadFormat::Cbor};
+                for (auto format : formats)
+                {
+                    Crt::ByteBuf sized = pool.Acquire();
+                    Iotdevicecommon::SerializePayload(request, format, sized);
+                    size_t formatSize = sized.len;
+                    pool.Release(sized);
+
+                    snprintf(
+                        name,
+                        sizeof(name),
+                        "shadow/serialize/UpdateShadowRequest/%s/%zu",
+                        format == Iotdevicecommon::PayloadFormat::Json ? "json" : "cbor",
+                        size);
+                    Run(name, formatSize, [&request, &pool, format]() {
+                        Crt::ByteBuf buf = pool.Acquire();
+                        Iotdevicecommon::SerializePayload(request, format, buf);
+                        g_sink = buf.len;
+                        pool.Release(buf);
+                    });
+                }
+            }
+
+            void s_runParseBenchmarks(size_t size)
+            {
+                Crt::String payload = s_makeGetShadowResponse(size);
+
+                char name[96];
+                snprintf(name, sizeof(name), "shadow/parse/GetShadowResponse/%zu", size);
+                Run(name, payload.size(), [&payload]() {
+                    Crt::JsonObject jsonObject(payload);
+                    Iotshadow::GetShadowResponse response(jsonObject);
+                    g_sink = static_cast<size_t>(*response.Version);
+                });
+            }
+
+            void s_runDispatchBenchmarks(size_t size)
+            {
+                auto demultiplexer = Iotshadow::ShadowTopicDemultiplexer::Create(nullptr);
+
+                Iotshadow::GetShadowSubscriptionRequest request;
+                request.ThingName = "benchmark-thing";
+                demultiplexer->OnGetShadowAccepted(request, [](Iotshadow::GetShadowResponse *response, int) {
+                    g_sink = response && response->Version ? static_cast<size_t>(*response->Version) : 0;
+                });
+
+                Crt::String payload = s_makeGetShadowResponse(size);
+                Crt::ByteBuf payloadBuf = ByteBufFromString(payload);
+
+                char name[96];
+                snprintf(name, sizeof(name), "shadow/dispatch/get-accepted/%zu", size);
+                Crt::String matched("$aws/things/benchmark-thing/shadow/get/accepted");
+                Run(name, payload.size(), [&demultiplexer, &matched, &payloadBuf]() {
+                    demultiplexer->Dispatch(matched, payloadBuf);
+                });
+            }
+        } // namespace
+
+        void RunShadowBenchmarks()
+        {
+            /* Topic matching alone: no handler is registered for this topic, so nothing is parsed. */
+            auto demultiplexer = Iotshadow::ShadowTopicDemultiplexer::Create(nullptr);
+            Iotshadow::GetShadowSubscriptionRequest request;
+            request.ThingName = "+";
+            demultiplexer->OnGetShadowAccepted(request, [](Iotshadow::GetShadowResponse *, int) {});
+
+            Crt::String unmatched("$aws/things/benchmark-thing/shadow/name/config/update/delta");
+            Crt::ByteBuf empty = Crt::ByteBufFromCString("");
+            Run("shadow/dispatch/unmatched-topic", 0, [&demultiplexer, &unmatched, &empty]() {
+                demultiplexer->Dispatch(unmatched, empty);
+            });
+
+            for (size_t size : s_payloadSizes)
+            {
+                s_runParseBenchmarks(size);
+                s_runSerializeBenchmarks(size);
+                s_runDispatchBenchmarks(size);
+            }
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
@@ -0,0 +1,384 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+#include "LoopbackHarness.h"
+
+#ifndef _WIN32
+
+#    include <aws/common/common.h>
+#    include <aws/iotjobs/IotJobsClient.h>
+#    include <aws/iotjobs/JobsRequestCorrelator.h>
+#    include <aws/iotjobs/NextJobExecutionChangedEvent.h>
+#    include <aws/iotjobs/NextJobExecutionChangedSubscriptionRequest.h>
+#    include <aws/iotjobs/StartNextJobExecutionResponse.h>
+#    include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
+#    include <aws/iotjobs/UpdateJobExecutionRequest.h>
+#    include <aws/iotjobs/UpdateJobExecutionResponse.h>
+#    include <aws/iotshadow/IotShadowClient.h>
+#    include <aws/iotshadow/ShadowRequestCorrelator.h>
+#    include <aws/iotshadow/UpdateShadowResponse.h>
+#    ifdef AWS_BENCHMARKS_DEVICE_DEFENDER
+#        include <aws/iotdevicedefender/DeviceDefender.h>
+#    endif
+
+#    include <unistd.h>
+
+#    include <algorithm>
+#    include <atomic>
+#    include <cstdio>
+#    include <thread>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            /* Work done every round; a round runs about once a second. */
+            const size_t s_shadowUpdatesPerRound = 50;
+            const size_t s_jobsPerRound = 5;
+
+            /* Samples before this fraction of the run are warm-up, while caches and pools fill. */
+            const double s_warmUpFraction = 0.1;
+
+            /* Growth below this, relative to the first quarter, is noise rather than a leak or creep. */
+            const double s_memoryTolerance = 0.05;
+            const double s_latencyTolerance = 0.25;
+
+            struct Sample
+            {
+                uint64_t ElapsedSeconds = 0;
+                uint64_t RssBytes = 0;
+                uint64_t TrackedBytes = 0;
+                uint64_t TrackedAllocations = 0;
+                LatencySummary Shadow;
+                LatencySummary JobNotification;
+            };
+
+            uint64_t s_residentBytes()
+            {
+#    ifdef __linux__
+                FILE *statm = fopen("/proc/self/statm", "r");
+                if (!statm)
+                {
+                    return 0;
+                }
+                unsigned long size = 0;
+                unsigned long resident = 0;
+                int parsed = fscanf(statm, "%lu %lu", &size, &resident);
+                fclose(statm);
+                return parsed == 2 ? static_cast<uint64_t>(resident) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE))
+                                   : 0;
+#    else
+                return 0;
+#    endif
+            }
+
+            /*
+             * Flags a series that keeps growing: past warm-up, the median of each quarter is above the one
+             * before it, and the last ends more than `tolerance` above the first. A leak or latency creep rises
+             * steadily; a one-off spike or a plateau does not.
+             */
+            bool s_grows(const Crt::Vector<double> &series, double tolerance)
+            {
+                size_t start = static_cast<size_t>(static_cast<double>(series.size()) * s_warmUpFraction);
+                size_t quarter = (series.size() - start) / 4;
+                if (quarter < 2)
+                {
+                    return false;
+                }
+
+                double medians[4];
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    Crt::Vector<double> values(
+                        series.begin() + static_cast<std::ptrdiff_t>(start + i * quarter),
+                        series.begin() + static_cast<std::ptrdiff_t>(start + (i + 1) * quarter));
+                    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+                    medians[i] = values[values.size() / 2];
+                    if (i && medians[i] <= medians[i - 1])
+                    {
+                        return false;
+                    }
+                }
+                return medians[0] > 0 && (medians[3] - medians[0]) / medians[0] > tolerance;
+            }
+
+            struct Check
+            {
+                const char *Name;
+                double (*Field)(const Sample &);
+                double Tolerance;
+            };
+
+            bool s_check(const Crt::Vector<Sample> &samples, const Check &check)
+            {
+                Crt::Vector<double> series;
+                series.reserve(samples.size());
+                for (const Sample &sample : samples)
+                {
+                    series.push_back(check.Field(sample));
+                }
+                if (s_grows(series, check.Tolerance))
+                {
+                    fprintf(stderr, "soak: %s grew steadily over the run\n", check.Name);
+                    return false;
+                }
+                return true;
+            }
+
+            template <typename Future> bool s_ready(Future &future)
+            {
+                return future.wait_for(s_loopbackTimeout) == std::future_status::ready;
+            }
+        } // namespace
+
+        bool RunSoakTest(uint32_t minutes)
+        {
+            /*
+             * Every SDK allocation goes through the tracer, so its byte count is the SDK's live heap. It is never
+             * destroyed: event loop threads can still free through it while they shut down.
+             */
+            Crt::Allocator *allocator = aws_mem_tracer_new(aws_default_allocator(), nullptr, AWS_MEMTRACE_BYTES, 0);
+
+            bool succeeded = true;
+            Crt::Vector<Sample> samples;
+            {
+                MockBroker broker;
+                LoopbackConnection loopback(allocator);
+                if (!broker.Start() || !loopback.Connect(broker, "soak-thing"))
+                {
+                    fprintf(stderr, "soak: could not connect to the mock broker\n");
+                    return false;
+                }
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection = loopback.GetConnection();
+
+                Iotshadow::IotShadowClient shadowClient(connection, allocator);
+                auto shadow = Iotshadow::ShadowRequestCorrelator::Create(
+                    shadowClient,
+                    loopback.GetEventLoopGroup(),
+                    "soak-thing",
+                    Iotshadow::ShadowRequestCorrelatorConfig(),
+                    allocator);
+
+                Iotjobs::IotJobsClient jobsClient(connection, allocator);
+                auto jobs = Iotjobs::JobsRequestCorrelator::Create(
+                    jobsClient,
+                    loopback.GetEventLoopGroup(),
+                    "soak-thing",
+                    Iotjobs::JobsRequestCorrelatorConfig(),
+                    allocator);
+
+                std::promise<int> shadowSubscribed;
+                std::promise<int> jobsSubscribed;
+                std::promise<int> notifySubscribed;
+                Completions notifications;
+                std::atomic<uint64_t> jobAddedAt(0);
+
+                Iotjobs::NextJobExecutionChangedSubscriptionRequest notifyRequest;
+                notifyRequest.ThingName = "soak-thing";
+                bool subscribing =
+                    shadow && jobs &&
+                    shadow->Subscribe(
+                        AWS_MQTT_QOS_AT_LEAST_ONCE,
+                        [&shadowSubscribed](int ioErr) { shadowSubscribed.set_value(ioErr); }) &&
+                    jobs->Subscribe([&jobsSubscribed](int ioErr) { jobsSubscribed.set_value(ioErr); }) &&
+                    jobsClient.SubscribeToNextJobExecutionChangedEvents(
+                        notifyRequest,
+                        AWS_MQTT_QOS_AT_LEAST_ONCE,
+                        [&notifications, &jobAddedAt](Iotjobs::NextJobExecutionChangedEvent *event, int) {
+                            /* The event after the last job completes carries no execution. */
+                            if (event && event->Execution)
+                            {
+                                notifications.Complete(jobAddedAt.load(), true);
+                            }
+                        },
+                        [&notifySubscribed](int ioErr) { notifySubscribed.set_value(ioErr); });
+                auto shadowReady = shadowSubscribed.get_future();
+                auto jobsReady = jobsSubscribed.get_future();
+                auto notifyReady = notifySubscribed.get_future();
+                if (!subscribing || !s_ready(shadowReady) || shadowReady.get() || !s_ready(jobsReady) ||
+                    jobsReady.get() || !s_ready(notifyReady) || notifyReady.get())
+                {
+                    fprintf(stderr, "soak: subscriptions failed\n");
+                    return false;
+                }
+
+#    ifdef AWS_BENCHMARKS_DEVICE_DEFENDER
+                auto reportedRounds = Crt::MakeShared<Iotdevicedefenderv1::CustomMetric>(
+                    allocator, Iotdevicedefenderv1::CustomMetric::Kind::Counter);
+                std::promise<void> defenderStopped;
+                Iotdevicedefenderv1::ReportTaskBuilder defenderBuilder(
+                    allocator, connection, loopback.GetEventLoopGroup(), "soak-thing");
+                defenderBuilder.WithTaskPeriodSeconds(5)
+                    .WithNetworkConnectionSamplePeriodSeconds(5)
+                    .WithCustomMetric("soak-rounds", reportedRounds)
+                    .WithTaskCancelledHandler([&defenderStopped](void *) { defenderStopped.set_value(); });
+                auto defender = defenderBuilder.BuildShared();
+                if (!defender || defender->StartTask() != AWS_OP_SUCCESS)
+                {
+                    fprintf(stderr, "soak: could not start the Device Defender report task\n");
+                    succeeded = false;
+                }
+#    endif
+
+                Iotshadow::ShadowState state;
+                Completions shadowUpdates;
+                Completions jobUpdates;
+                uint64_t start = Ticks();
+                uint64_t end = start + static_cast<uint64_t>(minutes) * 60ULL * 1000ULL * 1000ULL * 1000ULL;
+                uint64_t sampleIntervalNs = std::max<uint64_t>(10, minutes / 2) * 1000ULL * 1000ULL * 1000ULL;
+                uint64_t nextSample = start + sampleIntervalNs;
+                size_t shadowIssued = 0;
+                size_t jobsIssued = 0;
+                size_t jobsDone = 0;
+
+                printf(
+                    "%8s\t%12s\t%12s\t%10s\t%12s\t%12s\t%12s\t%12s\n",
+                    "elapsed",
+                    "rss",
+                    "sdk bytes",
+                    "sdk allocs",
+                    "shadow p50",
+                    "shadow p99",
+                    "notify p50",
+                    "notify p99");
+                for (uint64_t round = 0; succeeded && Ticks() < end; ++round)
+                {
+                    uint64_t roundStart = Ticks();
+
+                    for (size_t i = 0; i < s_shadowUpdatesPerRound && succeeded; ++i)
+                    {
+                        Crt::JsonObject reported;
+                        reported.WithInt64("round", static_cast<int64_t>(round))
+                            .WithInt64("update", static_cast<int64_t>(i));
+                        state.Reported = reported;
+                        uint64_t requestStart = Ticks();
+                        auto onUpdated = [&shadowUpdates, requestStart](
+                                             Iotshadow::UpdateShadowResponse *response,
+                                             Iotshadow::ErrorResponse *,
+                                             int) { shadowUpdates.Complete(requestStart, response != nullptr); };
+                        succeeded = shadow->UpdateShadowAsync(
+                                        state, Crt::Optional<int32_t>(), AWS_MQTT_QOS_AT_LEAST_ONCE, onUpdated) &&
+                                    shadowUpdates.Wait(++shadowIssued, 0);
+                    }
+
+                    for (size_t i = 0; i < s_jobsPerRound && succeeded; ++i)
+                    {
+                        char jobId[64];
+                        snprintf(jobId, sizeof(jobId), "soak-job-%llu-%zu", (unsigned long long)round, i);
+                        Crt::JsonObject jobDocument;
+                        jobDocument.WithString("operation", "soak");
+                        jobAddedAt = Ticks();
+                        broker.AddJob("soak-thing", jobId, jobDocument);
+                        if (!notifications.Wait(++jobsIssued, 0))
+                        {
+                            fprintf(stderr, "soak: no notify-next for %s\n", jobId);
+                            succeeded = false;
+                            break;
+                        }
+
+                        std::promise<bool> started;
+                        auto onStarted = [&started](
+                                             Iotjobs::StartNextJobExecutionResponse *response,
+                                             Iotjobs::RejectedError *,
+                                             int) { started.set_value(response && response->Execution); };
+                        auto startedJob = started.get_future();
+                        if (!jobs->StartNextPendingJobExecutionAsync(
+                                Iotjobs::StartNextPendingJobExecutionRequest(), onStarted) ||
+                            !s_ready(startedJob) || !startedJob.get())
+                        {
+                            fprintf(stderr, "soak: could not start %s\n", jobId);
+                            succeeded = false;
+                            break;
+                        }
+
+                        Iotjobs::UpdateJobExecutionRequest update;
+                        update.JobId = Crt::String(jobId);
+                        update.Status = Iotjobs::JobStatus::SUCCEEDED;
+                        uint64_t updateStart = Ticks();
+                        auto onUpdated = [&jobUpdates, updateStart](
+                                             Iotjobs::UpdateJobExecutionResponse *response,
+                                             Iotjobs::RejectedError *,
+                                             int) { jobUpdates.Complete(updateStart, response != nullptr); };
+                        succeeded = jobs->UpdateJobExecutionAsync(update, onUpdated) && jobUpdates.Wait(++jobsDone, 0);
+                    }
+
+#    ifdef AWS_BENCHMARKS_DEVICE_DEFENDER
+                    reportedRounds->Add(1);
+#    endif
+
+                    if (succeeded && (shadowUpdates.Failed() || jobUpdates.Failed()))
+                    {
+                        fprintf(stderr, "soak: requests were rejected\n");
+                        succeeded = false;
+                    }
+
+                    if (Ticks() >= nextSample)
+                    {
+                        Sample sample;
+                        sample.ElapsedSeconds = (Ticks() - start) / (1000ULL * 1000ULL * 1000ULL);
+                        sample.RssBytes = s_residentBytes();
+                        sample.TrackedBytes = aws_mem_tracer_bytes(allocator);
+                        sample.TrackedAllocations = aws_mem_tracer_count(allocator);
+                        Summarize(shadowUpdates.TakeLatencies(), sample.Shadow);
+                        Summarize(notifications.TakeLatencies(), sample.JobNotification);
+                        jobUpdates.TakeLatencies();
+                        shadowIssued = 0;
+                        jobsIssued = 0;
+                        jobsDone = 0;
+                        printf(
+                            "%7llus\t%12llu\t%12llu\t%10llu\t%9.1f us\t%9.1f us\t%9.1f us\t%9.1f us\n",
+                            (unsigned long long)sample.ElapsedSeconds,
+                            (unsigned long long)sample.RssBytes,
+                            (unsigned long long)sample.TrackedBytes,
+                            (unsigned long long)sample.TrackedAllocations,
+                            sample.Shadow.P50Us,
+                            sample.Shadow.P99Us,
+                            sample.JobNotification.P50Us,
+                            sample.JobNotification.P99Us);
+                        fflush(stdout);
+                        samples.push_back(sample);
+                        nextSample += sampleIntervalNs;
+                    }
+
+                    /* Pace rounds to about one a second, so a longer run means more uptime, not more load. */
+                    uint64_t roundNs = Ticks() - roundStart;
+                    if (roundNs < 1000ULL * 1000ULL * 1000ULL)
+                    {
+                        std::this_thread::sleep_for(std::chrono::nanoseconds(1000ULL * 1000ULL * 1000ULL - roundNs));
+                    }
+                }
+
+#    ifdef AWS_BENCHMARKS_DEVICE_DEFENDER
+                if (defender && defender->GetStatus() == Iotdevicedefenderv1::ReportTaskStatus::Running)
+                {
+                    auto stopped = defenderStopped.get_future();
+                    defender->StopTask();
+                    s_ready(stopped);
+                }
+#    endif
+            }
+
+            const Check checks[] = {
+                {"resident memory", [](const Sample &s) { return (double)s.RssBytes; }, s_memoryTolerance},
+                {"SDK heap", [](const Sample &s) { return (double)s.TrackedBytes; }, s_memoryTolerance},
+                {"shadow update p99", [](const Sample &s) { return s.Shadow.P99Us; }, s_latencyTolerance},
+                {"job notification p99", [](const Sample &s) { return s.JobNotification.P99Us; }, s_latencyTolerance},
+            };
+            for (const Check &check : checks)
+            {
+                succeeded = s_check(samples, check) && succeeded;
+            }
+
+            printf("soak: %s after %zu samples\n", succeeded ? "passed" : "FAILED", samples.size());
+            return succeeded;
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
+
+#endif /* !_WIN32 */
@@ -0,0 +1,390 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+#include "LoopbackHarness.h"
+
+#ifndef _WIN32
+
+#    include <aws/common/common.h>
+#    include <aws/iotdevicecommon/MessageContext.h>
+#    include <aws/iotdevicecommon/ThingTopicDispatcher.h>
+#    include <aws/iotdevicecommon/TrafficRecorder.h>
+#    include <aws/iotjobs/DescribeJobExecutionSubscriptionRequest.h>
+#    include <aws/iotjobs/GetPendingJobExecutionsSubscriptionRequest.h>
+#    include <aws/iotjobs/IotJobsClient.h>
+#    include <aws/iotjobs/JobExecutionsChangedSubscriptionRequest.h>
+#    include <aws/iotjobs/NextJobExecutionChangedSubscriptionRequest.h>
+#    include <aws/iotjobs/StartNextPendingJobExecutionSubscriptionRequest.h>
+#    include <aws/iotjobs/UpdateJobExecutionSubscriptionRequest.h>
+#    include <aws/iotshadow/DeleteShadowSubscriptionRequest.h>
+#    include <aws/iotshadow/GetNamedShadowSubscriptionRequest.h>
+#    include <aws/iotshadow/GetShadowSubscriptionRequest.h>
+#    include <aws/iotshadow/IotShadowClient.h>
+#    include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#    include <aws/iotshadow/NamedShadowUpdatedSubscriptionRequest.h>
+#    include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+#    include <aws/iotshadow/ShadowUpdatedSubscriptionRequest.h>
+#    include <aws/iotshadow/UpdateNamedShadowSubscriptionRequest.h>
+#    include <aws/iotshadow/UpdateShadowSubscriptionRequest.h>
+
+#    include <algorithm>
+#    include <atomic>
+#    include <thread>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        namespace
+        {
+            /*
+             * The topics each thing of the trace is subscribed to, below "$aws/things/<thing>/", as
+             * s_subscribeThing subscribes to them. Only the inbound records on these are replayed: the others
+             * would reach no handler, and those on request topics would be answered by the broker as well.
+             */
+            const char *const s_replayedTopics[] = {
+                "shadow/get/accepted",
+                "shadow/get/rejected",
+                "shadow/update/accepted",
+                "shadow/update/rejected",
+                "shadow/update/delta",
+                "shadow/update/documents",
+                "shadow/delete/accepted",
+                "shadow/name/+/get/accepted",
+                "shadow/name/+/update/accepted",
+                "shadow/name/+/update/delta",
+                "shadow/name/+/update/documents",
+                "jobs/notify",
+                "jobs/notify-next",
+                "jobs/get/accepted",
+                "jobs/start-next/accepted",
+                "jobs/+/get/accepted",
+                "jobs/+/update/accepted",
+            };
+
+            /* A replay that delivers nothing for this long has lost the rest of its messages. */
+            const uint64_t s_stallNs = 10ull * 1000 * 1000 * 1000;
+
+            /* Counts the messages that reached a client handler, whatever their model. */
+            struct DeliveryCounter
+            {
+                std::atomic<size_t> *Delivered;
+
+                template <typename Response> void operator()(Response *, int) const { ++*Delivered; }
+            };
+
+            /* Matches `topic` against a filter of s_replayedTopics, whose only wildcard is "+". */
+            bool s_matches(const char *filter, const Crt::String &topic, size_t start)
+            {
+                size_t position = start;
+                while (true)
+                {
+                    if (*filter == '+')
+                    {
+                        ++filter;
+                        while (position < topic.size() && topic[position] != '/')
+                        {
+                            ++position;
+                        }
+                    }
+                    else
+                    {
+                        while (*filter && *filter != '/' && position < topic.size() && topic[position] == *filter)
+                        {
+                            ++filter;
+                            ++position;
+                        }
+                        if ((*filter && *filter != '/') || (position < topic.size() && topic[position] != '/'))
+                        {
+                            return false;
+                        }
+                    }
+
+                    if (!*filter || position == topic.size())
+                    {
+                        return !*filter && position == topic.size();
+                    }
+                    ++filter;
+                    ++position;
+                }
+            }
+
+            /* @return the thing of a record to replay, or an empty string for one to skip. */
+            Crt::String s_replayedThing(const Iotdevicecommon::TrafficRecord &record)
+            {
+                if (record.Direction != Iotdevicecommon::TrafficDirection::Inbound)
+                {
+                    return Crt::String();
+                }
+                Crt::ByteCursor thing = Iotdevicecommon::ThingNameOfTopic(record.Topic);
+                if (thing.len == 0)
+                {
+                    return Crt::String();
+                }
+
+                Crt::String topic(reinterpret_cast<const char *>(record.Topic.ptr), record.Topic.len);
+                size_t start = static_cast<size_t>(thing.ptr - record.Topic.ptr) + thing.len + 1;
+                for (const char *filter : s_replayedTopics)
+                {
+                    if (s_matches(filter, topic, start))
+                    {
+                        return Crt::String(reinterpret_cast<const char *>(thing.ptr), thing.len);
+                    }
+                }
+                return Crt::String();
+            }
+
+            /* @return the number of subscriptions queued, or 0 if one could not be. */
+            size_t s_subscribeThing(
+                Iotshadow::IotShadowClient &shadowClient,
+                Iotjobs::IotJobsClient &jobsClient,
+                const Crt::String &thingName,
+                std::atomic<size_t> &delivered,
+                Completions &subAcks)
+            {
+                const Crt::Mqtt::QOS qos = AWS_MQTT_QOS_AT_MOST_ONCE;
+                const DeliveryCounter counter{&delivered};
+                const uint64_t startNs = Ticks();
+                auto onSubAck = [&subAcks, startNs](int ioErr) { subAcks.Complete(startNs, ioErr == 0); };
+                Crt::String anyName("+");
+
+                Iotshadow::GetShadowSubscriptionRequest getShadow;
+                getShadow.ThingName = thingName;
+                Iotshadow::UpdateShadowSubscriptionRequest updateShadow;
+                updateShadow.ThingName = thingName;
+                Iotshadow::ShadowDeltaUpdatedSubscriptionRequest shadowDelta;
+                shadowDelta.ThingName = thingName;
+                Iotshadow::ShadowUpdatedSubscriptionRequest shadowUpdated;
+                shadowUpdated.ThingName = thingName;
+                Iotshadow::DeleteShadowSubscriptionRequest deleteShadow;
+                deleteShadow.ThingName = thingName;
+                Iotshadow::GetNamedShadowSubscriptionRequest getNamedShadow;
+                getNamedShadow.ThingName = thingName;
+                getNamedShadow.ShadowName = anyName;
+                Iotshadow::UpdateNamedShadowSubscriptionRequest updateNamedShadow;
+                updateNamedShadow.ThingName = thingName;
+                updateNamedShadow.ShadowName = anyName;
+                Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest namedShadowDelta;
+                namedShadowDelta.ThingName = thingName;
+                namedShadowDelta.ShadowName = anyName;
+                Iotshadow::NamedShadowUpdatedSubscriptionRequest namedShadowUpdated;
+                namedShadowUpdated.ThingName = thingName;
+                namedShadowUpdated.ShadowName = anyName;
+
+                Iotjobs::JobExecutionsChangedSubscriptionRequest jobsChanged;
+                jobsChanged.ThingName = thingName;
+                Iotjobs::NextJobExecutionChangedSubscriptionRequest nextJobChanged;
+                nextJobChanged.ThingName = thingName;
+                Iotjobs::GetPendingJobExecutionsSubscriptionRequest getPending;
+                getPending.ThingName = thingName;
+                Iotjobs::StartNextPendingJobExecutionSubscriptionRequest startNext;
+                startNext.ThingName = thingName;
+                Iotjobs::DescribeJobExecutionSubscriptionRequest describeJob;
+                describeJob.ThingName = thingName;
+                describeJob.JobId = anyName;
+                Iotjobs::UpdateJobExecutionSubscriptionRequest updateJob;
+                updateJob.ThingName = thingName;
+                updateJob.JobId = anyName;
+
+                const bool queued[] = {
+                    shadowClient.SubscribeToGetShadowAccepted(getShadow, qos, counter, onSubAck),
+                    shadowClient.SubscribeToGetShadowRejected(getShadow, qos, counter, onSubAck),
+                    shadowClient.SubscribeToUpdateShadowAccepted(updateShadow, qos, counter, onSubAck),
+                    shadowClient.SubscribeToUpdateShadowRejected(updateShadow, qos, counter, onSubAck),
+                    shadowClient.SubscribeToShadowDeltaUpdatedEvents(shadowDelta, qos, counter, onSubAck),
+                    shadowClient.SubscribeToShadowUpdatedEvents(shadowUpdated, qos, counter, onSubAck),
+                    shadowClient.SubscribeToDeleteShadowAccepted(deleteShadow, qos, counter, onSubAck),
+                    shadowClient.SubscribeToGetNamedShadowAccepted(getNamedShadow, qos, counter, onSubAck),
+                    shadowClient.SubscribeToUpdateNamedShadowAccepted(updateNamedShadow, qos, counter, onSubAck),
+                    shadowClient.SubscribeToNamedShadowDeltaUpdatedEvents(namedShadowDelta, qos, counter, onSubAck),
+                    shadowClient.SubscribeToNamedShadowUpdatedEvents(namedShadowUpdated, qos, counter, onSubAck),
+                    jobsClient.SubscribeToJobExecutionsChangedEvents(jobsChanged, qos, counter, onSubAck),
+                    jobsClient.SubscribeToNextJobExecutionChangedEvents(nextJobChanged, qos, counter, onSubAck),
+                    jobsClient.SubscribeToGetPendingJobExecutionsAccepted(getPending, qos, counter, onSubAck),
+                    jobsClient.SubscribeToStartNextPendingJobExecutionAccepted(startNext, qos, counter, onSubAck),
+                    jobsClient.SubscribeToDescribeJobExecutionAccepted(describeJob, qos, counter, onSubAck),
+                    jobsClient.SubscribeToUpdateJobExecutionAccepted(updateJob, qos, counter, onSubAck),
+                };
+                for (bool subscribed : queued)
+                {
+                    if (!subscribed)
+                    {
+                        return 0;
+                    }
+                }
+                return sizeof(queued) / sizeof(queued[0]);
+            }
+        } // namespace
+
+        bool RunTraceReplay(const char *path, bool maxSpeed, bool dispatch)
+        {
+            std::shared_ptr<Iotdevicecommon::TrafficTrace> trace = Iotdevicecommon::TrafficTrace::Open(path);
+            if (!trace)
+            {
+                fprintf(
+                    stderr, "replay: could not read the trace %s: %s\n", path, aws_error_debug_str(aws_last_error()));
+                return false;
+            }
+
+            Crt::Vector<Crt::String> thingNames;
+            Crt::Vector<size_t> replayed;
+            size_t offset = 0;
+            size_t recordOffset = 0;
+            Iotdevicecommon::TrafficRecord record;
+            while (trace->Next(offset, record))
+            {
+                Crt::String thingName = s_replayedThing(record);
+                if (!thingName.empty())
+                {
+                    thingNames.push_back(std::move(thingName));
+                    replayed.push_back(recordOffset);
+                }
+                recordOffset = offset;
+            }
+            std::sort(thingNames.begin(), thingNames.end());
+            thingNames.erase(std::unique(thingNames.begin(), thingNames.end()), thingNames.end());
+            if (replayed.empty())
+            {
+                fprintf(stderr, "replay: %s has no inbound shadow or jobs messages\n", path);
+                return false;
+            }
+
+            MockBroker broker;
+            if (!broker.Start())
+            {
+                fprintf(stderr, "replay: could not start the mock broker\n");
+                return false;
+            }
+
+            LoopbackConnection device;
+            LoopbackConnection source;
+            if (!device.Connect(broker, "replay-device") || !source.Connect(broker, "replay-source"))
+            {
+                return false;
+            }
+
+            /* Created before the clients subscribe, so it takes over every subscription below. */
+            std::shared_ptr<Iotdevicecommon::ThingTopicDispatcher> dispatcher;
+            if (dispatch)
+            {
+                dispatcher = Iotdevicecommon::ThingTopicDispatcher::Create(device.GetConnection());
+                if (!dispatcher)
+                {
+                    fprintf(stderr, "replay: could not create the thing topic dispatcher\n");
+                    return false;
+                }
+            }
+
+            Iotshadow::IotShadowClient shadowClient(device.GetConnection());
+            Iotjobs::IotJobsClient jobsClient(device.GetConnection());
+            std::atomic<size_t> delivered(0);
+            Completions subAcks;
+            size_t subscriptions = 0;
+            for (const Crt::String &thingName : thingNames)
+            {
+                size_t queued = s_subscribeThing(shadowClient, jobsClient, thingName, delivered, subAcks);
+                if (queued == 0)
+                {
+                    fprintf(stderr, "replay: subscribing %s failed\n", thingName.c_str());
+                    return false;
+                }
+                subscriptions += queued;
+            }
+            if (!subAcks.Wait(subscriptions, 0) || subAcks.Failed())
+            {
+                fprintf(stderr, "replay: subscriptions failed\n");
+                return false;
+            }
+
+            /* Published from the other connection, so every message crosses the broker and the device's socket. */
+            const auto &connection = source.GetConnection();
+            uint64_t payloadBytes = 0;
+            uint64_t firstNs = 0;
+            uint64_t startNs = Ticks();
+            for (size_t i = 0; i < replayed.size(); ++i)
+            {
+                size_t at = replayed[i];
+                trace->Next(at, record);
+                if (i == 0)
+                {
+                    firstNs = record.TimestampNs;
+                }
+                else if (!maxSpeed)
+                {
+                    uint64_t dueNs = startNs + (record.TimestampNs - firstNs);
+                    uint64_t nowNs = Ticks();
+                    if (dueNs > nowNs)
+                    {
+                        std::this_thread::sleep_for(std::chrono::nanoseconds(dueNs - nowNs));
+                    }
+                }
+
+                Crt::String topic(reinterpret_cast<const char *>(record.Topic.ptr), record.Topic.len);
+                Crt::ByteBuf payload = Crt::ByteBufFromArray(record.Payload.ptr, record.Payload.len);
+                if (connection->Publish(topic.c_str(), AWS_MQTT_QOS_AT_MOST_ONCE, false, payload, nullptr) == 0)
+                {
+                    fprintf(stderr, "replay: publishing %s failed\n", topic.c_str());
+                    return false;
+                }
+                payloadBytes += record.Payload.len;
+            }
+
+            size_t lastDelivered = 0;
+            uint64_t progressNs = Ticks();
+            uint64_t endNs = progressNs;
+            while (true)
+            {
+                size_t deliveredNow = delivered.load();
+                endNs = Ticks();
+                if (deliveredNow >= replayed.size())
+                {
+                    break;
+                }
+                if (deliveredNow != lastDelivered)
+                {
+                    lastDelivered = deliveredNow;
+                    progressNs = endNs;
+                }
+                else if (endNs - progressNs > s_stallNs)
+                {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            /* One tab-separated line, like Run's: delivery rate and payload throughput over the replay. */
+            char name[128];
+            snprintf(
+                name,
+                sizeof(name),
+                "replay/%s/%s",
+                maxSpeed ? "max-speed" : "original-timing",
+                dispatch ? "dispatcher" : "per-topic");
+            double seconds = static_cast<double>(endNs - startNs) / 1e9;
+            printf(
+                "%-56s\t%8zu msgs\t%6zu things\t%10.0f msg/s\t%10.1f MB/s\n",
+                name,
+                replayed.size(),
+                thingNames.size(),
+                static_cast<double>(delivered.load()) / seconds,
+                static_cast<double>(payloadBytes) / 1e6 / seconds);
+
+            if (delivered.load() < replayed.size())
+            {
+                fprintf(
+                    stderr,
+                    "replay: %zu of %zu messages were not delivered\n",
+                    replayed.size() - delivered.load(),
+                    replayed.size());
+                return false;
+            }
+            return true;
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
+
+#endif /* !_WIN32 */
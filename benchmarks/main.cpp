@@ -0,0 +1,140 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "BenchmarkHarness.h"
+
+#include <aws/crt/Api.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace Aws
+{
+    namespace Benchmarks
+    {
+        volatile size_t g_sink = 0;
+
+        Crt::String MakeJsonDocument(size_t targetBytes)
+        {
+            Crt::String document("{");
+            char member[64];
+            for (size_t i = 0; document.size() + 1 < targetBytes; ++i)
+            {
+                snprintf(member, sizeof(member), "%s\"key%06zu\":\"value%06zu\"", i ? "," : "", i, i);
+                document.append(member);
+            }
+            document.append("}");
+            return document;
+        }
+
+        Crt::ByteBuf ByteBufFromString(const Crt::String &value) noexcept
+        {
+            return Crt::ByteBufFromArray(reinterpret_cast<const uint8_t *>(value.data()), value.size());
+        }
+
+    } // namespace Benchmarks
+} // namespace Aws
+
+/**
+ * Runs every benchmark, or only those of the clients named on the command line ("shadow", "jobs",
+ * "identity", "defender" for the metrics report encoders, "models" for every generated model over the payload
+ * corpus, "json" for the raw payload scanner against JsonObject, "loopback" for the end-to-end runs against the
+ * mock broker, "ipc" for Greengrass IPC against MQTT, or "tunnel" for the secure tunnel receive path and stream
+ * compression). Exits non-zero if a loopback, ipc or tunnel run fails, so it can be run under CTest.
+ *
+ * "soak [minutes]" instead runs only the soak test, for 60 minutes unless given, and exits non-zero if it
+ * failed or saw memory or latency grow steadily.
+ *
+ * "replay <trace> [max] [dispatch]" instead replays a trace recorded with Iotdevicecommon::TrafficRecorder
+ * against the shadow and jobs clients, at the trace's pace unless "max" is given, and through a
+ * ThingTopicDispatcher with "dispatch". Exits non-zero if the trace could not be read or a message was lost.
+ */
+int main(int argc, char *argv[])
+{
+    Aws::Crt::ApiHandle apiHandle;
+
+#ifndef _WIN32
+    if (argc >= 2 && strcmp(argv[1], "soak") == 0)
+    {
+        uint32_t minutes = argc >= 3 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 60;
+        return Aws::Benchmarks::RunSoakTest(minutes ? minutes : 60) ? 0 : 1;
+    }
+    if (argc >= 3 && strcmp(argv[1], "replay") == 0)
+    {
+        bool maxSpeed = false;
+        bool dispatch = false;
+        for (int i = 3; i < argc; ++i)
+        {
+            maxSpeed = maxSpeed || strcmp(argv[i], "max") == 0;
+            dispatch = dispatch || strcmp(argv[i], "dispatch") == 0;
+        }
+        return Aws::Benchmarks::RunTraceReplay(argv[2], maxSpeed, dispatch) ? 0 : 1;
+    }
+#endif
+
+    auto selected = [argc, argv](const char *client) {
+        if (argc < 2)
+        {
+            return true;
+        }
+        for (int i = 1; i < argc; ++i)
+        {
+            if (strcmp(argv[i], client) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (selected("shadow"))
+    {
+        Aws::Benchmarks::RunShadowBenchmarks();
+    }
+    if (selected("jobs"))
+    {
+        Aws::Benchmarks::RunJobsBenchmarks();
+    }
+    if (selected("identity"))
+    {
+        Aws::Benchmarks::RunIdentityBenchmarks();
+    }
+    if (selected("models"))
+    {
+        Aws::Benchmarks::RunModelBenchmarks();
+    }
+    if (selected("json"))
+    {
+        Aws::Benchmarks::RunJsonBackendBenchmarks();
+    }
+#ifdef AWS_BENCHMARKS_DEVICE_DEFENDER
+    if (selected("defender"))
+    {
+        Aws::Benchmarks::RunDeviceDefenderBenchmarks();
+    }
+#endif
+
+    int result = 0;
+#ifndef _WIN32
+    if (selected("loopback") && !Aws::Benchmarks::RunLoopbackBenchmarks())
+    {
+        result = 1;
+    }
+#    ifdef AWS_BENCHMARKS_DISCOVERY
+    if (selected("ipc") && !Aws::Benchmarks::RunIpcBenchmarks())
+    {
+        result = 1;
+    }
+#    endif
+#    ifdef AWS_BENCHMARKS_SECURE_TUNNELING
+    if (selected("tunnel") && !Aws::Benchmarks::RunSecureTunnelingBenchmarks())
+    {
+        result = 1;
+    }
+#    endif
+#endif
+
+    return result;
+}
@@ -10,6 +10,10 @@
 #include <aws/crt/mqtt/MqttClient.h>
 
 #include <aws/iotdevice/device_defender.h>
+#include <aws/iotdevicecommon/HandlerExecutor.h>
+
+#include <atomic>
+#include <memory>
 
 namespace Aws
 {
@@ -42,7 +46,56 @@ namespace Aws
         };
 
         /**
-         * Represents a persistent DeviceDefender V1 task.
+         * An application-level metric, updated lock-free from hot paths and read once per report. A counter
+         * reports what was added since the previous report; a gauge reports its latest value.
+         */
+        class AWS_IOTDEVICEDEFENDER_API CustomMetric final
+        {
+          public:
+            enum class Kind
+            {
+                Counter = 0,
+                Gauge = 1,
+            };
+
+            explicit CustomMetric(Kind kind) noexcept : m_kind(kind), m_value(0) {}
+            CustomMetric(const CustomMetric &) = delete;
+            CustomMetric &operator=(const CustomMetric &) = delete;
+
+            void Add(int64_t delta) noexcept { m_value.fetch_add(delta, std::memory_order_relaxed); }
+
+            void Set(int64_t value) noexcept { m_value.store(value, std::memory_order_relaxed); }
+
+            Kind GetKind() const noexcept { return m_kind; }
+
+            /**
+             * @return the value to report. Counters restart from zero.
+             */
+            int64_t Collect() noexcept;
+
+          private:
+            Kind m_kind;
+            std::atomic<int64_t> m_value;
+        };
+
+        using CustomMetricList = Crt::Vector<std::pair<Crt::String, std::shared_ptr<CustomMetric>>>;
+        using CustomMetricValues = Crt::Vector<std::pair<Crt::String, int64_t>>;
+
+        /**
+         * Encodes a custom metrics report into output, as JSON or as CBOR with the schema's short key names.
+         * CBOR is the more compact of the two.
+         *
+         * @return AWS_OP_ERR, raising AWS_ERROR_IOTDEVICE_DEFENDER_UNSUPPORTED_REPORT_FORMAT, for other formats.
+         */
+        AWS_IOTDEVICEDEFENDER_API int EncodeCustomMetricsReport(
+            ReportFormat format,
+            int64_t reportId,
+            const CustomMetricValues &values,
+            Crt::Vector<uint8_t> &output) noexcept;
+
+        /**
+         * Represents a persistent DeviceDefender V1 task. aws-c-iot keeps a pointer to the task while it runs,
+         * so a running task must not be moved; use ReportTaskBuilder::BuildShared to hold tasks in containers.
          */
         class AWS_IOTDEVICEDEFENDER_API ReportTask final
         {
@@ -70,6 +123,33 @@ namespace Aws
              */
             ReportTaskStatus GetStatus() noexcept;
 
+            /**
+             * Changes the task and network connection sample periods. A running task switches over without
+             * a StopTask/StartTask cycle and without invoking OnTaskCancelled; the new periods count from
+             * now.
+             */
+            int UpdatePeriods(uint32_t taskPeriodSeconds, uint32_t networkConnectionSamplePeriodSeconds) noexcept;
+
+            /**
+             * Requests a custom metrics report now, e.g. when the application detects an anomaly. The report
+             * takes the place of the next periodic one, whose schedule then restarts from it, so the metrics
+             * are not reported twice. Reports are at least ReportTaskBuilder::WithReportTriggerInterval apart:
+             * a trigger sooner than that after the last report is deferred until the interval has passed, and
+             * triggers while one is pending, or with the periodic report due first, are merged into it.
+             *
+             * The built-in report is generated by aws-c-iot on its own timer and is not affected.
+             *
+             * @return AWS_OP_ERR, with AWS_ERROR_INVALID_STATE, if the task is not running or has no custom
+             * metrics.
+             */
+            int TriggerReport() noexcept;
+
+            /**
+             * @return the number of custom metrics reports left out as unchanged, see
+             * ReportTaskBuilder::WithUnchangedReportSuppression.
+             */
+            uint64_t GetSkippedReportCount() const noexcept;
+
             OnTaskCancelledHandler OnTaskCancelled;
 
             void *cancellationUserdata;
@@ -80,24 +160,55 @@ namespace Aws
             int LastError() const noexcept { return m_lastError; }
 
           private:
+            struct CustomMetricsReporter;
+            struct CustomMetricsReportTask;
+
             Crt::Allocator *m_allocator;
             ReportTaskStatus m_status;
+            Crt::String m_thingName;
             aws_iotdevice_defender_report_task_config m_taskConfig;
             aws_iotdevice_defender_v1_task *m_owningTask;
             int m_lastError;
+            std::shared_ptr<CustomMetricsReporter> m_customMetrics;
+            /* Cancellations of tasks replaced by UpdatePeriods, which are not surfaced. */
+            std::atomic<int> m_replacedTasks;
+            /* Set when the last shared reference went away while running; the cancellation frees the task. */
+            bool m_deleteOnCancel;
+            double m_periodJitter;
 
             ReportTask(
                 Crt::Allocator *allocator,
                 std::shared_ptr<Crt::Mqtt::MqttConnection> mqttConnection,
                 const Crt::String &thingName,
-                Crt::Io::EventLoopGroup &eventLoopGroup,
+                aws_event_loop *eventLoop,
                 ReportFormat reportFormat,
                 uint32_t taskPeriodSeconds,
                 uint32_t networkConnectionSamplePeriodSeconds,
+                const CustomMetricList &customMetrics,
+                uint32_t adaptiveMinPeriodSeconds,
+                double adaptiveChangeThreshold,
+                ReportFormat customMetricsReportFormat,
+                double periodJitter,
+                uint32_t minTriggerIntervalSeconds,
+                uint32_t maxSkippedReports,
+                Iotdevicecommon::HandlerExecutor &&collectionExecutor,
                 OnTaskCancelledHandler &&onCancelled = NULL,
                 void *cancellationUserdata = nullptr) noexcept;
 
             static void s_onDefenderV1TaskCancelled(void *userData);
+            static void s_deleteShared(ReportTask *task);
+            static void s_scheduleCustomMetricsReport(
+                const std::shared_ptr<CustomMetricsReporter> &reporter,
+                uint64_t generation,
+                bool first);
+            static void s_scheduleCustomMetricsReportAt(
+                const std::shared_ptr<CustomMetricsReporter> &reporter,
+                uint64_t generation,
+                uint64_t reportAtNs);
+            static void s_onCustomMetricsReportTask(aws_task *task, void *arg, aws_task_status status);
+            static void s_runCustomMetricsReport(
+                const std::shared_ptr<CustomMetricsReporter> &reporter,
+                uint64_t generation);
         };
 
         /**
@@ -124,6 +235,10 @@ namespace Aws
 
             /**
              * Sets the network connection sample period seconds. Defaults to 5 minutes.
+             *
+             * Each sample is taken by aws-c-iot, which reads the whole connection table, so its cost grows
+             * with the number of open sockets rather than with churn. On hosts with very many sockets, prefer
+             * a longer period here; ReportTask::UpdatePeriods can shorten it while investigating.
              */
             ReportTaskBuilder &WithNetworkConnectionSamplePeriodSeconds(
                 uint32_t networkConnectionSamplePeriodSeconds) noexcept;
@@ -138,21 +253,106 @@ namespace Aws
              */
             ReportTaskBuilder &WithTaskCancellationUserData(void *cancellationUserdata) noexcept;
 
+            /**
+             * Adds a custom metric, reported under name once per task period. All custom metrics are
+             * aggregated into a single report message per period, published next to the built-in one. The
+             * metric must also be defined in Device Defender under the same name.
+             */
+            ReportTaskBuilder &WithCustomMetric(const Crt::String &name, std::shared_ptr<CustomMetric> metric) noexcept;
+
+            /**
+             * Makes the custom metrics report adaptive. When a metric moves by more than changeThreshold
+             * (relative, with counters compared as rates) between two reports, the next report comes after
+             * minTaskPeriodSeconds; each steady report then doubles the interval back up to the task period.
+             * Zero, the default, keeps the fixed task period.
+             */
+            ReportTaskBuilder &WithAdaptivePeriod(uint32_t minTaskPeriodSeconds, double changeThreshold) noexcept;
+
+            /**
+             * Sets the format of the custom metrics report, JSON (the default) or CBOR. The built-in report
+             * is encoded by aws-c-iot, which only supports JSON, so WithReportFormat cannot select CBOR.
+             */
+            ReportTaskBuilder &WithCustomMetricsReportFormat(ReportFormat reportFormat) noexcept;
+
+            /**
+             * Spreads periodic publishes so a fleet that starts together does not report in lockstep. The
+             * built-in report gets a period randomly within fraction of the task period, fixed per task, and
+             * the custom metrics report makes its first report at a random point in the period and jitters each
+             * interval by fraction. Clamped to [0, 0.5]; zero, the default, disables jitter.
+             */
+            ReportTaskBuilder &WithPeriodJitter(double fraction) noexcept;
+
+            /**
+             * Sets the shortest interval between a custom metrics report and one requested with
+             * ReportTask::TriggerReport. Defaults to 1 minute; Device Defender throttles things that report too
+             * often.
+             */
+            ReportTaskBuilder &WithReportTriggerInterval(uint32_t minIntervalSeconds) noexcept;
+
+            /**
+             * Leaves out a periodic custom metrics report when it would repeat the last one published: every
+             * gauge at its reported value and every counter zero, as reported before. At most
+             * maxSkippedReports reports in a row are left out, so the service still sees the thing at least
+             * every maxSkippedReports + 1 periods; set behaviors' durations with that in mind. Zero, the default,
+             * publishes every report.
+             *
+             * The built-in network report is generated and published by aws-c-iot and is always sent in full;
+             * lengthen WithNetworkConnectionSamplePeriodSeconds and the task period to reduce it.
+             */
+            ReportTaskBuilder &WithUnchangedReportSuppression(uint32_t maxSkippedReports) noexcept;
+
+            /**
+             * Runs the task's reports on `eventLoop`, which must be one of the builder's event loop group, e.g.
+             * a loop an Iotdevicecommon::EventLoopLayout set aside for Device Defender. By default the group
+             * hands out its next loop.
+             */
+            ReportTaskBuilder &WithEventLoop(aws_event_loop *eventLoop) noexcept;
+
+            /**
+             * Collects and encodes each custom metrics report on `executor` instead of the task's event loop,
+             * e.g. a WorkStealingExecutor or a loop of an Iotdevicecommon::EventLoopLayout's Handlers role.
+             * Only the encoded report reaches the MQTT connection, whose publish queues it onto the
+             * connection's own loop. The timers stay on the task's event loop.
+             *
+             * aws-c-iot samples the network connections for the built-in report on the task's event loop, so
+             * keep those scans off the connection's loops by giving the builder a group of its own, such as the
+             * layout's DeviceDefender group, or a loop with WithEventLoop.
+             */
+            ReportTaskBuilder &WithCollectionExecutor(Iotdevicecommon::HandlerExecutor executor) noexcept;
+
             /**
              * Builds a device defender v1 task object from the set options.
              */
             ReportTask Build() noexcept;
 
+            /**
+             * Builds the task on the heap behind a shared_ptr, so it never moves and can be held in
+             * containers. Releasing the last reference stops a running task; the task is freed once aws-c-iot
+             * confirms the cancellation, after OnTaskCancelled.
+             */
+            std::shared_ptr<ReportTask> BuildShared() noexcept;
+
           private:
+            aws_event_loop *TaskEventLoop() const noexcept;
+
             Crt::Allocator *m_allocator;
             std::shared_ptr<Crt::Mqtt::MqttConnection> m_mqttConnection;
             Crt::String m_thingName;
             Crt::Io::EventLoopGroup &m_eventLoopGroup;
+            aws_event_loop *m_eventLoop;
             ReportFormat m_reportFormat;
             uint32_t m_taskPeriodSeconds;
             uint32_t m_networkConnectionSamplePeriodSeconds;
             OnTaskCancelledHandler m_onCancelled;
             void *m_cancellationUserdata;
+            CustomMetricList m_customMetrics;
+            uint32_t m_adaptiveMinPeriodSeconds;
+            double m_adaptiveChangeThreshold;
+            ReportFormat m_customMetricsReportFormat;
+            double m_periodJitter;
+            uint32_t m_minTriggerIntervalSeconds;
+            uint32_t m_maxSkippedReports;
+            Iotdevicecommon::HandlerExecutor m_collectionExecutor;
         };
 
     } // namespace Iotdevicedefenderv1
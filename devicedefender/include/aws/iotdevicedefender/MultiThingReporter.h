@@ -0,0 +1,123 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicedefender/DeviceDefender.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicedefenderv1
+    {
+        class AWS_IOTDEVICEDEFENDER_API MultiThingReporterConfig final
+        {
+          public:
+            MultiThingReporterConfig() noexcept;
+            MultiThingReporterConfig(const MultiThingReporterConfig &rhs) = default;
+            MultiThingReporterConfig(MultiThingReporterConfig &&rhs) = default;
+
+            MultiThingReporterConfig &operator=(const MultiThingReporterConfig &rhs) = default;
+            MultiThingReporterConfig &operator=(MultiThingReporterConfig &&rhs) = default;
+
+            ~MultiThingReporterConfig() = default;
+
+            /**
+             * The connection every thing's reports are published on.
+             * Required.
+             */
+            std::shared_ptr<Crt::Mqtt::MqttConnection> Connection;
+
+            /**
+             * The event loop group the single report timer runs on.
+             * Required.
+             */
+            Crt::Io::EventLoopGroup *EventLoopGroup;
+
+            /**
+             * How often each thing is reported. Defaults to 5 minutes.
+             */
+            uint32_t PeriodSeconds;
+
+            /**
+             * JSON (the default) or CBOR.
+             */
+            ReportFormat Format;
+
+            /**
+             * Fraction of each tick interval, up to 0.5, by which ticks are randomly spread, so that gateways
+             * started together do not tick in lockstep. The first tick also lands at a random point in its
+             * interval. Defaults to 0, no jitter.
+             */
+            double PeriodJitter;
+        };
+
+        /**
+         * Publishes custom metrics reports on behalf of many things, e.g. the child devices of a gateway,
+         * from one timer on one event loop instead of one ReportTask each. Reports are staggered evenly
+         * across the period, one thing per tick, so the broker sees a steady trickle rather than a burst
+         * every period.
+         *
+         * Network metrics describe the host, so they are left to the gateway's own ReportTask.
+         */
+        class AWS_IOTDEVICEDEFENDER_API MultiThingReporter final
+            : public std::enable_shared_from_this<MultiThingReporter>
+        {
+          public:
+            MultiThingReporter(const MultiThingReporter &) = delete;
+            MultiThingReporter(MultiThingReporter &&) = delete;
+            MultiThingReporter &operator=(const MultiThingReporter &) = delete;
+            MultiThingReporter &operator=(MultiThingReporter &&) = delete;
+
+            ~MultiThingReporter() = default;
+
+            /**
+             * Adds a thing, or replaces the metrics of one already added. Takes effect from the next tick.
+             */
+            void AddThing(const Crt::String &thingName, const CustomMetricList &metrics);
+
+            void RemoveThing(const Crt::String &thingName);
+
+            size_t GetThingCount() const;
+
+            int Start();
+
+            void Stop();
+
+            static std::shared_ptr<MultiThingReporter> Create(
+                const MultiThingReporterConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Thing
+            {
+                Crt::String Name;
+                Crt::String Topic;
+                CustomMetricList Metrics;
+                int64_t LastReportId;
+            };
+            struct TickTask;
+
+            MultiThingReporter(const MultiThingReporterConfig &config, Crt::Allocator *allocator) noexcept;
+
+            void ScheduleTick(uint64_t generation, bool first);
+            void Tick(uint64_t generation);
+
+            static void s_onTickTask(aws_task *task, void *arg, aws_task_status status);
+
+            MultiThingReporterConfig m_config;
+            Crt::Allocator *m_allocator;
+            aws_event_loop *m_eventLoop;
+
+            mutable std::mutex m_lock;
+            Crt::Vector<Thing> m_things;
+            size_t m_next;
+            bool m_running;
+            /* Bumped on every start and stop, so a tick left over from an earlier run stands down. */
+            uint64_t m_generation;
+        };
+    } // namespace Iotdevicedefenderv1
+} // namespace Aws
@@ -3,7 +3,15 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 #include <aws/common/clock.h>
+#include <aws/common/device_random.h>
 #include <aws/iotdevicedefender/DeviceDefender.h>
+#include <aws/iotdevicecommon/IotDevice.h>
+#include <aws/iotdevicecommon/JsonTemplate.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
 
 namespace Aws
 {
@@ -15,32 +23,491 @@ namespace Aws
     namespace Iotdevicedefenderv1
     {
 
+        struct ReportTask::CustomMetricsReporter
+        {
+            std::mutex Lock;
+            /* Bumped on every start and stop, so a report task left over from an earlier run stands down. */
+            uint64_t Generation;
+            bool Running;
+            std::shared_ptr<Crt::Mqtt::MqttConnection> Connection;
+            Crt::String Topic;
+            ReportFormat Format;
+            CustomMetricList Metrics;
+            /* The JSON report with the metric names laid out once; its slots are the report id and the values. */
+            Iotdevicecommon::JsonTemplate JsonReport;
+            aws_event_loop *EventLoop;
+            /* The task period; adaptive reports move CurrentPeriodNs between MinPeriodNs and this. */
+            uint64_t PeriodNs;
+            uint64_t MinPeriodNs;
+            uint64_t CurrentPeriodNs;
+            double ChangeThreshold;
+            /* Per metric value of the previous report, with counters as a rate per second. */
+            Crt::Vector<double> LastLevels;
+            int64_t LastReportId;
+            double Jitter;
+            /* Event loop clock times of the last report run and of the one scheduled next. */
+            uint64_t LastReportNs;
+            uint64_t NextReportNs;
+            uint64_t MinTriggerIntervalNs;
+            /* Set while a report requested by TriggerReport is scheduled. */
+            bool TriggerPending;
+            /* Per metric value of the last published report, for leaving out unchanged ones. */
+            Crt::Vector<int64_t> LastValues;
+            uint32_t MaxSkippedReports;
+            uint32_t SkippedInARow;
+            uint64_t SkippedReports;
+            /* Runs collection off the event loop when set; CollectLock keeps a triggered run from overlapping. */
+            Iotdevicecommon::HandlerExecutor CollectionExecutor;
+            std::mutex CollectLock;
+            Crt::Allocator *Allocator;
+        };
+
+        struct ReportTask::CustomMetricsReportTask
+        {
+            aws_task Task;
+            std::shared_ptr<CustomMetricsReporter> Reporter;
+            uint64_t Generation;
+            Crt::Allocator *Allocator;
+        };
+
+        namespace
+        {
+            /* A uniformly random period within fraction of periodNs either side of it. */
+            uint64_t s_jitterPeriod(uint64_t periodNs, double fraction)
+            {
+                if (fraction <= 0.0 || periodNs == 0)
+                {
+                    return periodNs;
+                }
+
+                uint32_t random = 0;
+                aws_device_random_u32(&random);
+                double offset = (static_cast<double>(random) / UINT32_MAX * 2.0 - 1.0) * fraction;
+                return static_cast<uint64_t>(static_cast<double>(periodNs) * (1.0 + offset));
+            }
+
+            /* Minimal CBOR (RFC 8949) writer: just the definite-length items a report needs. */
+            void s_cborWriteHead(Crt::Vector<uint8_t> &out, uint8_t majorType, uint64_t value)
+            {
+                uint8_t major = static_cast<uint8_t>(majorType << 5);
+                if (value < 24)
+                {
+                    out.push_back(static_cast<uint8_t>(major | value));
+                    return;
+                }
+
+                size_t width = value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFF ? 4 : 8;
+                uint8_t additional = width == 1 ? 24 : width == 2 ? 25 : width == 4 ? 26 : 27;
+                out.push_back(static_cast<uint8_t>(major | additional));
+                for (size_t shift = width * 8; shift > 0; shift -= 8)
+                {
+                    out.push_back(static_cast<uint8_t>(value >> (shift - 8)));
+                }
+            }
+
+            void s_cborWriteInt(Crt::Vector<uint8_t> &out, int64_t value)
+            {
+                if (value >= 0)
+                {
+                    s_cborWriteHead(out, 0, static_cast<uint64_t>(value));
+                }
+                else
+                {
+                    s_cborWriteHead(out, 1, static_cast<uint64_t>(-(value + 1)));
+                }
+            }
+
+            void s_cborWriteText(Crt::Vector<uint8_t> &out, const char *text, size_t length)
+            {
+                s_cborWriteHead(out, 3, length);
+                out.insert(out.end(), text, text + length);
+            }
+
+            void s_cborWriteText(Crt::Vector<uint8_t> &out, const char *text)
+            {
+                s_cborWriteText(out, text, strlen(text));
+            }
+
+            void s_encodeCbor(int64_t reportId, const CustomMetricValues &values, Crt::Vector<uint8_t> &out)
+            {
+                /* CBOR reports use the short key names of the Device Defender report schema. */
+                s_cborWriteHead(out, 5, 3);
+
+                s_cborWriteText(out, "hed");
+                s_cborWriteHead(out, 5, 2);
+                s_cborWriteText(out, "rid");
+                s_cborWriteInt(out, reportId);
+                s_cborWriteText(out, "v");
+                s_cborWriteText(out, "1.0");
+
+                s_cborWriteText(out, "met");
+                s_cborWriteHead(out, 5, 0);
+
+                s_cborWriteText(out, "cmet");
+                s_cborWriteHead(out, 5, values.size());
+                for (const auto &value : values)
+                {
+                    s_cborWriteText(out, value.first.data(), value.first.length());
+                    s_cborWriteHead(out, 4, 1);
+                    s_cborWriteHead(out, 5, 1);
+                    s_cborWriteText(out, "number");
+                    s_cborWriteInt(out, value.second);
+                }
+            }
+
+            /*
+             * The report is `{"header":{...},"metrics":{},"custom_metrics":{"<name>":[{"number":N}],...}}`, in
+             * that order, so everything but the numbers can be laid out ahead of time.
+             */
+            template <typename Names>
+            Iotdevicecommon::JsonTemplate s_buildJsonReport(const Names &names, Crt::Allocator *allocator)
+            {
+                Iotdevicecommon::JsonTemplate report(allocator);
+                report.Literal("{\"header\":{\"report_id\":")
+                    .Slot()
+                    .Literal(",\"version\":\"1.0\"},\"metrics\":{},\"custom_metrics\":{");
+                bool first = true;
+                for (const auto &name : names)
+                {
+                    if (!first)
+                    {
+                        report.Literal(",");
+                    }
+                    first = false;
+                    report.Quoted(name.first).Literal(":[{\"number\":").Slot().Literal("}]");
+                }
+                report.Literal("}}");
+                return report;
+            }
+
+            void s_encodeJson(int64_t reportId, const CustomMetricValues &values, Crt::Vector<uint8_t> &out)
+            {
+                Crt::Allocator *allocator = Crt::DefaultAllocator();
+                Iotdevicecommon::JsonTemplate report = s_buildJsonReport(values, allocator);
+
+                Crt::Vector<Iotdevicecommon::TemplateNumber> numbers;
+                numbers.reserve(values.size() + 1);
+                numbers.emplace_back(reportId);
+                for (const auto &value : values)
+                {
+                    numbers.emplace_back(value.second);
+                }
+
+                Crt::ByteBuf payload;
+                aws_byte_buf_init(&payload, allocator, 0);
+                if (report.Render(numbers.data(), numbers.size(), payload))
+                {
+                    out.assign(payload.buffer, payload.buffer + payload.len);
+                }
+                aws_byte_buf_clean_up(&payload);
+            }
+        } // namespace
+
+        int EncodeCustomMetricsReport(
+            ReportFormat format,
+            int64_t reportId,
+            const CustomMetricValues &values,
+            Crt::Vector<uint8_t> &output) noexcept
+        {
+            output.clear();
+            switch (format)
+            {
+                case ReportFormat::AWS_IDDRF_JSON:
+                    s_encodeJson(reportId, values, output);
+                    return AWS_OP_SUCCESS;
+                case ReportFormat::AWS_IDDRF_CBOR:
+                    s_encodeCbor(reportId, values, output);
+                    return AWS_OP_SUCCESS;
+                default:
+                    return aws_raise_error(AWS_ERROR_IOTDEVICE_DEFENDER_UNSUPPORTED_REPORT_FORMAT);
+            }
+        }
+
+        int64_t CustomMetric::Collect() noexcept
+        {
+            if (m_kind == Kind::Counter)
+            {
+                return m_value.exchange(0, std::memory_order_relaxed);
+            }
+
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+        void ReportTask::s_scheduleCustomMetricsReport(
+            const std::shared_ptr<CustomMetricsReporter> &reporter,
+            uint64_t generation,
+            bool first)
+        {
+            uint64_t delay = 0;
+            {
+                std::lock_guard<std::mutex> guard(reporter->Lock);
+                delay = s_jitterPeriod(reporter->CurrentPeriodNs, reporter->Jitter);
+                if (first && reporter->Jitter > 0.0 && reporter->CurrentPeriodNs > 0)
+                {
+                    /* A random first report spreads devices that started together across the period. */
+                    uint64_t random = 0;
+                    aws_device_random_u64(&random);
+                    delay = random % reporter->CurrentPeriodNs;
+                }
+            }
+
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(reporter->EventLoop, &now);
+            s_scheduleCustomMetricsReportAt(reporter, generation, now + delay);
+        }
+
+        void ReportTask::s_scheduleCustomMetricsReportAt(
+            const std::shared_ptr<CustomMetricsReporter> &reporter,
+            uint64_t generation,
+            uint64_t reportAtNs)
+        {
+            auto *reportTask = Crt::New<CustomMetricsReportTask>(reporter->Allocator);
+            if (!reportTask)
+            {
+                return;
+            }
+
+            reportTask->Reporter = reporter;
+            reportTask->Generation = generation;
+            reportTask->Allocator = reporter->Allocator;
+            aws_task_init(&reportTask->Task, s_onCustomMetricsReportTask, reportTask, "DeviceDefenderCustomMetrics");
+
+            {
+                std::lock_guard<std::mutex> guard(reporter->Lock);
+                reporter->NextReportNs = reportAtNs;
+            }
+            aws_event_loop_schedule_task_future(reporter->EventLoop, &reportTask->Task, reportAtNs);
+        }
+
+        void ReportTask::s_onCustomMetricsReportTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *reportTask = static_cast<CustomMetricsReportTask *>(arg);
+            std::shared_ptr<CustomMetricsReporter> reporter = reportTask->Reporter;
+            uint64_t generation = reportTask->Generation;
+            Crt::Delete(reportTask, reportTask->Allocator);
+
+            if (status != AWS_TASK_STATUS_RUN_READY)
+            {
+                return;
+            }
+
+            if (reporter->CollectionExecutor)
+            {
+                reporter->CollectionExecutor(
+                    reporter->Topic, [reporter, generation]() { s_runCustomMetricsReport(reporter, generation); });
+                return;
+            }
+            s_runCustomMetricsReport(reporter, generation);
+        }
+
+        void ReportTask::s_runCustomMetricsReport(
+            const std::shared_ptr<CustomMetricsReporter> &reporter,
+            uint64_t generation)
+        {
+            std::lock_guard<std::mutex> collectGuard(reporter->CollectLock);
+            int64_t reportId = 0;
+            uint64_t period = 0;
+            bool triggered = false;
+            {
+                std::lock_guard<std::mutex> guard(reporter->Lock);
+                if (!reporter->Running || reporter->Generation != generation)
+                {
+                    return;
+                }
+
+                /*
+                 * Report ids only have to increase per thing. Milliseconds keep ours clear of the built-in
+                 * report, which is stamped in seconds.
+                 */
+                uint64_t nowNs = 0;
+                aws_sys_clock_get_ticks(&nowNs);
+                reportId = static_cast<int64_t>(
+                    aws_timestamp_convert(nowNs, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL));
+                reportId = std::max(reportId, reporter->LastReportId + 1);
+                reporter->LastReportId = reportId;
+                period = reporter->CurrentPeriodNs;
+                aws_event_loop_current_clock_time(reporter->EventLoop, &reporter->LastReportNs);
+                triggered = reporter->TriggerPending;
+                reporter->TriggerPending = false;
+            }
+
+            /* Slot 0 of the JSON report is its id; the values follow in metric order. */
+            Crt::Vector<Iotdevicecommon::TemplateNumber> numbers;
+            numbers.reserve(reporter->Metrics.size() + 1);
+            numbers.emplace_back(reportId);
+            bool changed = false;
+            bool repeated = reporter->LastValues.size() == reporter->Metrics.size();
+            for (size_t i = 0; i < reporter->Metrics.size(); ++i)
+            {
+                const std::shared_ptr<CustomMetric> &metric = reporter->Metrics[i].second;
+                int64_t value = metric->Collect();
+                numbers.emplace_back(value);
+
+                /* A counter repeating a non-zero value still counts new events. */
+                repeated = repeated && reporter->LastValues[i] == value &&
+                           (metric->GetKind() == CustomMetric::Kind::Gauge || value == 0);
+
+                /* Counters cover a varying window when adaptive, so compare their rates. */
+                double level = static_cast<double>(value);
+                if (metric->GetKind() == CustomMetric::Kind::Counter && period > 0)
+                {
+                    level = level * 1e9 / static_cast<double>(period);
+                }
+                if (i < reporter->LastLevels.size())
+                {
+                    double previous = reporter->LastLevels[i];
+                    changed |= std::fabs(level - previous) >
+                               reporter->ChangeThreshold * std::max(std::fabs(previous), 1.0);
+                    reporter->LastLevels[i] = level;
+                }
+                else
+                {
+                    reporter->LastLevels.push_back(level);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> guard(reporter->Lock);
+                if (reporter->MinPeriodNs > 0)
+                {
+                    reporter->CurrentPeriodNs = changed ? reporter->MinPeriodNs
+                                                        : std::min(reporter->PeriodNs, reporter->CurrentPeriodNs * 2);
+                }
+
+                if (repeated && !triggered && reporter->SkippedInARow < reporter->MaxSkippedReports)
+                {
+                    ++reporter->SkippedInARow;
+                    ++reporter->SkippedReports;
+                }
+                else
+                {
+                    repeated = false;
+                    reporter->SkippedInARow = 0;
+                }
+            }
+
+            if (repeated)
+            {
+                s_scheduleCustomMetricsReport(reporter, generation, false);
+                return;
+            }
+
+            if (reporter->MaxSkippedReports > 0)
+            {
+                reporter->LastValues.resize(reporter->Metrics.size());
+                for (size_t i = 0; i < reporter->Metrics.size(); ++i)
+                {
+                    reporter->LastValues[i] = numbers[i + 1].Integer;
+                }
+            }
+
+            Crt::ByteBuf buf;
+            if (reporter->Format == ReportFormat::AWS_IDDRF_JSON)
+            {
+                aws_byte_buf_init(&buf, reporter->Allocator, 0);
+                if (!reporter->JsonReport.Render(numbers.data(), numbers.size(), buf))
+                {
+                    aws_byte_buf_clean_up(&buf);
+                    s_scheduleCustomMetricsReport(reporter, generation, false);
+                    return;
+                }
+            }
+            else
+            {
+                CustomMetricValues values;
+                values.reserve(reporter->Metrics.size());
+                for (size_t i = 0; i < reporter->Metrics.size(); ++i)
+                {
+                    values.emplace_back(reporter->Metrics[i].first, numbers[i + 1].Integer);
+                }
+
+                Crt::Vector<uint8_t> payload;
+                if (EncodeCustomMetricsReport(reporter->Format, reportId, values, payload) != AWS_OP_SUCCESS)
+                {
+                    s_scheduleCustomMetricsReport(reporter, generation, false);
+                    return;
+                }
+                buf = Crt::ByteBufNewCopy(reporter->Allocator, payload.data(), payload.size());
+            }
+
+            uint16_t packetId = reporter->Connection->Publish(
+                reporter->Topic.c_str(),
+                AWS_MQTT_QOS_AT_MOST_ONCE,
+                false,
+                buf,
+                [buf](Crt::Mqtt::MqttConnection &, uint16_t, int) {
+                    Crt::ByteBufDelete(const_cast<Crt::ByteBuf &>(buf));
+                });
+            if (packetId == 0)
+            {
+                Crt::ByteBufDelete(buf);
+            }
+
+            s_scheduleCustomMetricsReport(reporter, generation, false);
+        }
+
         void ReportTask::s_onDefenderV1TaskCancelled(void *userData)
         {
             auto *taskWrapper = reinterpret_cast<ReportTask *>(userData);
+            /* Tasks are cancelled in the order they were stopped, so replaced ones come first. */
+            int replaced = taskWrapper->m_replacedTasks.load();
+            while (replaced > 0 && !taskWrapper->m_replacedTasks.compare_exchange_weak(replaced, replaced - 1))
+            {
+            }
+            if (replaced > 0)
+            {
+                return;
+            }
+
             taskWrapper->m_status = ReportTaskStatus::Stopped;
 
             if (taskWrapper->OnTaskCancelled)
             {
                 taskWrapper->OnTaskCancelled(taskWrapper->cancellationUserdata);
             }
+
+            if (taskWrapper->m_deleteOnCancel)
+            {
+                Crt::Delete(taskWrapper, taskWrapper->m_allocator);
+            }
+        }
+
+        void ReportTask::s_deleteShared(ReportTask *task)
+        {
+            if (task->GetStatus() == ReportTaskStatus::Running && task->m_owningTask != nullptr)
+            {
+                /* aws-c-iot still refers to the task until it confirms the cancellation. */
+                task->m_deleteOnCancel = true;
+                task->StopTask();
+                return;
+            }
+
+            Crt::Delete(task, task->m_allocator);
         }
 
         ReportTask::ReportTask(
             Aws::Crt::Allocator *allocator,
             std::shared_ptr<Crt::Mqtt::MqttConnection> mqttConnection,
             const Crt::String &thingName,
-            Crt::Io::EventLoopGroup &eventLoopGroup,
+            aws_event_loop *eventLoop,
             ReportFormat reportFormat,
             uint32_t taskPeriodSeconds,
             uint32_t networkConnectionSamplePeriodSeconds,
+            const CustomMetricList &customMetrics,
+            uint32_t adaptiveMinPeriodSeconds,
+            double adaptiveChangeThreshold,
+            ReportFormat customMetricsReportFormat,
+            double periodJitter,
+            uint32_t minTriggerIntervalSeconds,
+            uint32_t maxSkippedReports,
+            Iotdevicecommon::HandlerExecutor &&collectionExecutor,
             OnTaskCancelledHandler &&onCancelled,
             void *cancellationUserdata) noexcept
             : OnTaskCancelled(std::move(onCancelled)), cancellationUserdata(cancellationUserdata),
-              m_allocator(allocator), m_status(ReportTaskStatus::Ready),
+              m_allocator(allocator), m_status(ReportTaskStatus::Ready), m_thingName(thingName),
               m_taskConfig{mqttConnection.get()->GetUnderlyingConnection(),
-                           ByteCursorFromString(thingName),
-                           aws_event_loop_group_get_next_loop(eventLoopGroup.GetUnderlyingHandle()),
+                           ByteCursorFromString(m_thingName),
+                           eventLoop,
                            reportFormat,
                            aws_timestamp_convert(taskPeriodSeconds, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL),
                            aws_timestamp_convert(
@@ -50,15 +517,70 @@ namespace Aws
                                NULL),
                            ReportTask::s_onDefenderV1TaskCancelled,
                            this},
-              m_lastError(0)
+              m_lastError(0), m_replacedTasks(0), m_deleteOnCancel(false), m_periodJitter(periodJitter)
         {
+            Iotdevicecommon::DeviceApiHandle::EnsureInitialized();
+
+            /*
+             * aws-c-iot reports on a fixed timer, so give each task its own slightly different period instead;
+             * devices that rebooted together drift apart a little more with every report.
+             */
+            m_taskConfig.task_period_ns = s_jitterPeriod(m_taskConfig.task_period_ns, m_periodJitter);
+
+            if (customMetrics.empty())
+            {
+                return;
+            }
+
+            m_customMetrics = Crt::MakeShared<CustomMetricsReporter>(allocator);
+            if (!m_customMetrics)
+            {
+                return;
+            }
+
+            m_customMetrics->Generation = 0;
+            m_customMetrics->Running = false;
+            m_customMetrics->Connection = mqttConnection;
+            m_customMetrics->Topic = "$aws/things/";
+            m_customMetrics->Topic.append(thingName).append(
+                customMetricsReportFormat == ReportFormat::AWS_IDDRF_CBOR ? "/defender/metrics/cbor"
+                                                                          : "/defender/metrics/json");
+            m_customMetrics->Format = customMetricsReportFormat;
+            m_customMetrics->Metrics = customMetrics;
+            if (customMetricsReportFormat == ReportFormat::AWS_IDDRF_JSON)
+            {
+                m_customMetrics->JsonReport = s_buildJsonReport(customMetrics, allocator);
+            }
+            m_customMetrics->EventLoop = m_taskConfig.event_loop;
+            m_customMetrics->PeriodNs = m_taskConfig.task_period_ns;
+            m_customMetrics->MinPeriodNs = std::min(
+                m_taskConfig.task_period_ns,
+                aws_timestamp_convert(adaptiveMinPeriodSeconds, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL));
+            m_customMetrics->CurrentPeriodNs = m_taskConfig.task_period_ns;
+            m_customMetrics->ChangeThreshold = adaptiveChangeThreshold;
+            m_customMetrics->LastReportId = 0;
+            m_customMetrics->Jitter = periodJitter;
+            m_customMetrics->LastReportNs = 0;
+            m_customMetrics->NextReportNs = 0;
+            m_customMetrics->MinTriggerIntervalNs =
+                aws_timestamp_convert(minTriggerIntervalSeconds, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+            m_customMetrics->TriggerPending = false;
+            m_customMetrics->MaxSkippedReports = maxSkippedReports;
+            m_customMetrics->SkippedInARow = 0;
+            m_customMetrics->SkippedReports = 0;
+            m_customMetrics->CollectionExecutor = std::move(collectionExecutor);
+            m_customMetrics->Allocator = allocator;
         }
 
         ReportTask::ReportTask(ReportTask &&toMove) noexcept
             : OnTaskCancelled(std::move(toMove.OnTaskCancelled)), cancellationUserdata(toMove.cancellationUserdata),
               m_allocator(toMove.m_allocator), m_status(toMove.m_status), m_taskConfig(std::move(toMove.m_taskConfig)),
-              m_owningTask(toMove.m_owningTask), m_lastError(toMove.m_lastError)
+              m_owningTask(toMove.m_owningTask), m_lastError(toMove.m_lastError),
+              m_customMetrics(std::move(toMove.m_customMetrics)), m_replacedTasks(toMove.m_replacedTasks.load()),
+              m_deleteOnCancel(toMove.m_deleteOnCancel), m_periodJitter(toMove.m_periodJitter)
         {
+            m_thingName = std::move(toMove.m_thingName);
+            m_taskConfig.thing_name = ByteCursorFromString(m_thingName);
             m_taskConfig.cancellation_userdata = this;
             toMove.OnTaskCancelled = nullptr;
             toMove.cancellationUserdata = nullptr;
@@ -79,10 +601,16 @@ namespace Aws
                 cancellationUserdata = toMove.cancellationUserdata;
                 m_allocator = toMove.m_allocator;
                 m_status = toMove.m_status;
+                m_thingName = std::move(toMove.m_thingName);
                 m_taskConfig = std::move(toMove.m_taskConfig);
+                m_taskConfig.thing_name = ByteCursorFromString(m_thingName);
                 m_taskConfig.cancellation_userdata = this;
                 m_owningTask = toMove.m_owningTask;
                 m_lastError = toMove.m_lastError;
+                m_customMetrics = std::move(toMove.m_customMetrics);
+                m_replacedTasks = toMove.m_replacedTasks.load();
+                m_deleteOnCancel = toMove.m_deleteOnCancel;
+                m_periodJitter = toMove.m_periodJitter;
 
                 toMove.OnTaskCancelled = nullptr;
                 toMove.cancellationUserdata = nullptr;
@@ -98,6 +626,99 @@ namespace Aws
 
         ReportTaskStatus ReportTask::GetStatus() noexcept { return this->m_status; }
 
+        int ReportTask::UpdatePeriods(
+            uint32_t taskPeriodSeconds,
+            uint32_t networkConnectionSamplePeriodSeconds) noexcept
+        {
+            uint64_t taskPeriodNs =
+                aws_timestamp_convert(taskPeriodSeconds, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+            m_taskConfig.task_period_ns = s_jitterPeriod(taskPeriodNs, m_periodJitter);
+            m_taskConfig.netconn_sample_period_ns = aws_timestamp_convert(
+                networkConnectionSamplePeriodSeconds, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+
+            if (m_customMetrics)
+            {
+                std::lock_guard<std::mutex> guard(m_customMetrics->Lock);
+                m_customMetrics->PeriodNs = m_taskConfig.task_period_ns;
+                m_customMetrics->MinPeriodNs = std::min(m_customMetrics->MinPeriodNs, m_customMetrics->PeriodNs);
+                /* An adaptive report keeps its pace, within the new bounds. */
+                uint64_t current = m_customMetrics->MinPeriodNs > 0 ? m_customMetrics->CurrentPeriodNs : UINT64_MAX;
+                m_customMetrics->CurrentPeriodNs = std::min(current, m_customMetrics->PeriodNs);
+            }
+
+            if (this->GetStatus() != ReportTaskStatus::Running || !this->m_owningTask)
+            {
+                return AWS_OP_SUCCESS;
+            }
+
+            /* aws-c-iot fixes the periods when a task is created, so start a replacement and retire the old one. */
+            aws_iotdevice_defender_v1_task *replacement =
+                aws_iotdevice_defender_v1_report_task(this->m_allocator, &this->m_taskConfig);
+            if (replacement == nullptr)
+            {
+                this->m_lastError = aws_last_error();
+                return aws_raise_error(this->m_lastError);
+            }
+
+            ++m_replacedTasks;
+            aws_iotdevice_defender_v1_stop_task(this->m_owningTask);
+            this->m_owningTask = replacement;
+            return AWS_OP_SUCCESS;
+        }
+
+        int ReportTask::TriggerReport() noexcept
+        {
+            if (this->GetStatus() != ReportTaskStatus::Running || !m_customMetrics)
+            {
+                this->m_lastError = AWS_ERROR_INVALID_STATE;
+                return aws_raise_error(this->m_lastError);
+            }
+
+            uint64_t generation = 0;
+            uint64_t reportAtNs = 0;
+            {
+                std::lock_guard<std::mutex> guard(m_customMetrics->Lock);
+                if (!m_customMetrics->Running)
+                {
+                    this->m_lastError = AWS_ERROR_INVALID_STATE;
+                    return aws_raise_error(this->m_lastError);
+                }
+
+                uint64_t now = 0;
+                aws_event_loop_current_clock_time(m_customMetrics->EventLoop, &now);
+                reportAtNs = now;
+                if (m_customMetrics->LastReportNs > 0)
+                {
+                    reportAtNs =
+                        std::max(now, m_customMetrics->LastReportNs + m_customMetrics->MinTriggerIntervalNs);
+                }
+
+                /* Already coming no later; the trigger merges into it. */
+                if (m_customMetrics->TriggerPending || m_customMetrics->NextReportNs <= reportAtNs)
+                {
+                    return AWS_OP_SUCCESS;
+                }
+
+                /* The scheduled periodic report stands down; the triggered one reschedules it. */
+                generation = ++m_customMetrics->Generation;
+                m_customMetrics->TriggerPending = true;
+            }
+
+            s_scheduleCustomMetricsReportAt(m_customMetrics, generation, reportAtNs);
+            return AWS_OP_SUCCESS;
+        }
+
+        uint64_t ReportTask::GetSkippedReportCount() const noexcept
+        {
+            if (!m_customMetrics)
+            {
+                return 0;
+            }
+
+            std::lock_guard<std::mutex> guard(m_customMetrics->Lock);
+            return m_customMetrics->SkippedReports;
+        }
+
         int ReportTask::StartTask() noexcept
         {
             if (this->GetStatus() == ReportTaskStatus::Ready || this->GetStatus() == ReportTaskStatus::Stopped)
@@ -114,6 +735,17 @@ namespace Aws
                 else
                 {
                     this->m_status = ReportTaskStatus::Running;
+                    if (m_customMetrics)
+                    {
+                        uint64_t generation = 0;
+                        {
+                            std::lock_guard<std::mutex> guard(m_customMetrics->Lock);
+                            m_customMetrics->Running = true;
+                            m_customMetrics->TriggerPending = false;
+                            generation = ++m_customMetrics->Generation;
+                        }
+                        s_scheduleCustomMetricsReport(m_customMetrics, generation, true);
+                    }
                 }
             }
             return AWS_OP_SUCCESS;
@@ -125,6 +757,12 @@ namespace Aws
             {
                 aws_iotdevice_defender_v1_stop_task(this->m_owningTask);
                 this->m_owningTask = nullptr;
+                if (m_customMetrics)
+                {
+                    std::lock_guard<std::mutex> guard(m_customMetrics->Lock);
+                    m_customMetrics->Running = false;
+                    ++m_customMetrics->Generation;
+                }
             }
         }
 
@@ -143,13 +781,19 @@ namespace Aws
             Crt::Io::EventLoopGroup &eventLoopGroup,
             const Crt::String &thingName)
             : m_allocator(allocator), m_mqttConnection(mqttConnection), m_thingName(thingName),
-              m_eventLoopGroup(eventLoopGroup)
+              m_eventLoopGroup(eventLoopGroup), m_eventLoop(nullptr)
         {
             m_reportFormat = ReportFormat::AWS_IDDRF_JSON;
             m_taskPeriodSeconds = 5UL * 60UL;
             m_networkConnectionSamplePeriodSeconds = 5UL * 60UL;
             m_onCancelled = nullptr;
             m_cancellationUserdata = nullptr;
+            m_adaptiveMinPeriodSeconds = 0;
+            m_adaptiveChangeThreshold = 0.0;
+            m_customMetricsReportFormat = ReportFormat::AWS_IDDRF_JSON;
+            m_periodJitter = 0.0;
+            m_minTriggerIntervalSeconds = 60;
+            m_maxSkippedReports = 0;
         }
 
         ReportTaskBuilder &ReportTaskBuilder::WithReportFormat(ReportFormat reportFormat) noexcept
@@ -183,6 +827,71 @@ namespace Aws
             return *this;
         }
 
+        ReportTaskBuilder &ReportTaskBuilder::WithCustomMetric(
+            const Crt::String &name,
+            std::shared_ptr<CustomMetric> metric) noexcept
+        {
+            if (metric)
+            {
+                m_customMetrics.emplace_back(name, std::move(metric));
+            }
+            return *this;
+        }
+
+        ReportTaskBuilder &ReportTaskBuilder::WithAdaptivePeriod(
+            uint32_t minTaskPeriodSeconds,
+            double changeThreshold) noexcept
+        {
+            m_adaptiveMinPeriodSeconds = minTaskPeriodSeconds;
+            m_adaptiveChangeThreshold = changeThreshold;
+            return *this;
+        }
+
+        ReportTaskBuilder &ReportTaskBuilder::WithCustomMetricsReportFormat(ReportFormat reportFormat) noexcept
+        {
+            m_customMetricsReportFormat = reportFormat;
+            return *this;
+        }
+
+        ReportTaskBuilder &ReportTaskBuilder::WithPeriodJitter(double fraction) noexcept
+        {
+            m_periodJitter = std::min(std::max(fraction, 0.0), 0.5);
+            return *this;
+        }
+
+        ReportTaskBuilder &ReportTaskBuilder::WithReportTriggerInterval(uint32_t minIntervalSeconds) noexcept
+        {
+            m_minTriggerIntervalSeconds = minIntervalSeconds;
+            return *this;
+        }
+
+        ReportTaskBuilder &ReportTaskBuilder::WithUnchangedReportSuppression(uint32_t maxSkippedReports) noexcept
+        {
+            m_maxSkippedReports = maxSkippedReports;
+            return *this;
+        }
+
+        ReportTaskBuilder &ReportTaskBuilder::WithEventLoop(aws_event_loop *eventLoop) noexcept
+        {
+            m_eventLoop = eventLoop;
+            return *this;
+        }
+
+        ReportTaskBuilder &ReportTaskBuilder::WithCollectionExecutor(Iotdevicecommon::HandlerExecutor executor) noexcept
+        {
+            m_collectionExecutor = std::move(executor);
+            return *this;
+        }
+
+        aws_event_loop *ReportTaskBuilder::TaskEventLoop() const noexcept
+        {
+            if (m_eventLoop)
+            {
+                return m_eventLoop;
+            }
+            return aws_event_loop_group_get_next_loop(m_eventLoopGroup.GetUnderlyingHandle());
+        }
+
         ReportTask ReportTaskBuilder::Build() noexcept
         {
 
@@ -190,12 +899,49 @@ namespace Aws
                 m_allocator,
                 m_mqttConnection,
                 m_thingName,
-                m_eventLoopGroup,
+                TaskEventLoop(),
+                m_reportFormat,
+                m_taskPeriodSeconds,
+                m_networkConnectionSamplePeriodSeconds,
+                m_customMetrics,
+                m_adaptiveMinPeriodSeconds,
+                m_adaptiveChangeThreshold,
+                m_customMetricsReportFormat,
+                m_periodJitter,
+                m_minTriggerIntervalSeconds,
+                m_maxSkippedReports,
+                Iotdevicecommon::HandlerExecutor(m_collectionExecutor),
+                static_cast<OnTaskCancelledHandler &&>(m_onCancelled),
+                m_cancellationUserdata);
+        }
+
+        std::shared_ptr<ReportTask> ReportTaskBuilder::BuildShared() noexcept
+        {
+            auto *toSeat = static_cast<ReportTask *>(aws_mem_acquire(m_allocator, sizeof(ReportTask)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) ReportTask(
+                m_allocator,
+                m_mqttConnection,
+                m_thingName,
+                TaskEventLoop(),
                 m_reportFormat,
                 m_taskPeriodSeconds,
                 m_networkConnectionSamplePeriodSeconds,
+                m_customMetrics,
+                m_adaptiveMinPeriodSeconds,
+                m_adaptiveChangeThreshold,
+                m_customMetricsReportFormat,
+                m_periodJitter,
+                m_minTriggerIntervalSeconds,
+                m_maxSkippedReports,
+                Iotdevicecommon::HandlerExecutor(m_collectionExecutor),
                 static_cast<OnTaskCancelledHandler &&>(m_onCancelled),
                 m_cancellationUserdata);
+            return std::shared_ptr<ReportTask>(toSeat, ReportTask::s_deleteShared);
         }
 
     } // namespace Iotdevicedefenderv1
@@ -0,0 +1,248 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicedefender/MultiThingReporter.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/device_random.h>
+#include <aws/io/event_loop.h>
+
+#include <algorithm>
+
+namespace Aws
+{
+    namespace Iotdevicedefenderv1
+    {
+        struct MultiThingReporter::TickTask
+        {
+            aws_task Task;
+            std::weak_ptr<MultiThingReporter> Owner;
+            uint64_t Generation;
+            Crt::Allocator *Allocator;
+        };
+
+        MultiThingReporterConfig::MultiThingReporterConfig() noexcept
+            : Connection(), EventLoopGroup(nullptr), PeriodSeconds(5UL * 60UL), Format(ReportFormat::AWS_IDDRF_JSON),
+              PeriodJitter(0.0)
+        {
+        }
+
+        MultiThingReporter::MultiThingReporter(const MultiThingReporterConfig &config, Crt::Allocator *allocator)
+            noexcept
+            : m_config(config), m_allocator(allocator), m_eventLoop(nullptr), m_next(0), m_running(false),
+              m_generation(0)
+        {
+            m_eventLoop = aws_event_loop_group_get_next_loop(m_config.EventLoopGroup->GetUnderlyingHandle());
+        }
+
+        std::shared_ptr<MultiThingReporter> MultiThingReporter::Create(
+            const MultiThingReporterConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (!config.Connection || !config.EventLoopGroup || config.PeriodSeconds == 0 ||
+                config.PeriodJitter < 0.0 || config.PeriodJitter > 0.5 ||
+                (config.Format != ReportFormat::AWS_IDDRF_JSON && config.Format != ReportFormat::AWS_IDDRF_CBOR))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<MultiThingReporter *>(aws_mem_acquire(allocator, sizeof(MultiThingReporter)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) MultiThingReporter(config, allocator);
+            return std::shared_ptr<MultiThingReporter>(
+                toSeat, [allocator](MultiThingReporter *reporter) { Crt::Delete(reporter, allocator); });
+        }
+
+        void MultiThingReporter::AddThing(const Crt::String &thingName, const CustomMetricList &metrics)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            for (Thing &thing : m_things)
+            {
+                if (thing.Name == thingName)
+                {
+                    thing.Metrics = metrics;
+                    return;
+                }
+            }
+
+            Thing thing;
+            thing.Name = thingName;
+            thing.Topic = "$aws/things/";
+            thing.Topic.append(thingName).append(
+                m_config.Format == ReportFormat::AWS_IDDRF_CBOR ? "/defender/metrics/cbor" : "/defender/metrics/json");
+            thing.Metrics = metrics;
+            thing.LastReportId = 0;
+            m_things.push_back(std::move(thing));
+        }
+
+        void MultiThingReporter::RemoveThing(const Crt::String &thingName)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            for (size_t i = 0; i < m_things.size(); ++i)
+            {
+                if (m_things[i].Name == thingName)
+                {
+                    m_things.erase(m_things.begin() + static_cast<std::ptrdiff_t>(i));
+                    /* Keep the round robin on the thing that would have come next. */
+                    if (m_next > i)
+                    {
+                        --m_next;
+                    }
+                    return;
+                }
+            }
+        }
+
+        size_t MultiThingReporter::GetThingCount() const
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_things.size();
+        }
+
+        int MultiThingReporter::Start()
+        {
+            uint64_t generation = 0;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (m_running)
+                {
+                    return AWS_OP_SUCCESS;
+                }
+
+                m_running = true;
+                generation = ++m_generation;
+            }
+
+            ScheduleTick(generation, true);
+            return AWS_OP_SUCCESS;
+        }
+
+        void MultiThingReporter::Stop()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_running = false;
+            ++m_generation;
+        }
+
+        void MultiThingReporter::ScheduleTick(uint64_t generation, bool first)
+        {
+            auto *tickTask = Crt::New<TickTask>(m_allocator);
+            if (!tickTask)
+            {
+                return;
+            }
+
+            tickTask->Owner = shared_from_this();
+            tickTask->Generation = generation;
+            tickTask->Allocator = m_allocator;
+            aws_task_init(&tickTask->Task, s_onTickTask, tickTask, "DeviceDefenderMultiThingReport");
+
+            /* One thing per tick spreads each period's reports evenly across it. */
+            size_t thingCount = std::max<size_t>(1, GetThingCount());
+            uint64_t period =
+                aws_timestamp_convert(m_config.PeriodSeconds, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+            uint64_t delay = period / thingCount;
+            if (m_config.PeriodJitter > 0.0 && delay > 0)
+            {
+                /* Gateways that rebooted together start at a random point in the tick, then drift on. */
+                uint64_t random = 0;
+                aws_device_random_u64(&random);
+                if (first)
+                {
+                    delay = random % delay;
+                }
+                else
+                {
+                    double offset =
+                        (static_cast<double>(random) / static_cast<double>(UINT64_MAX) * 2.0 - 1.0) *
+                        m_config.PeriodJitter;
+                    delay = static_cast<uint64_t>(static_cast<double>(delay) * (1.0 + offset));
+                }
+            }
+
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &now);
+            aws_event_loop_schedule_task_future(m_eventLoop, &tickTask->Task, now + delay);
+        }
+
+        void MultiThingReporter::Tick(uint64_t generation)
+        {
+            Crt::String topic;
+            CustomMetricList metrics;
+            int64_t reportId = 0;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (!m_running || generation != m_generation)
+                {
+                    return;
+                }
+
+                if (!m_things.empty())
+                {
+                    m_next %= m_things.size();
+                    Thing &thing = m_things[m_next++];
+                    topic = thing.Topic;
+                    metrics = thing.Metrics;
+
+                    uint64_t nowNs = 0;
+                    aws_sys_clock_get_ticks(&nowNs);
+                    reportId = static_cast<int64_t>(
+                        aws_timestamp_convert(nowNs, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL));
+                    reportId = std::max(reportId, thing.LastReportId + 1);
+                    thing.LastReportId = reportId;
+                }
+            }
+
+            if (!topic.empty())
+            {
+                CustomMetricValues values;
+                values.reserve(metrics.size());
+                for (const auto &metric : metrics)
+                {
+                    values.emplace_back(metric.first, metric.second->Collect());
+                }
+
+                Crt::Vector<uint8_t> payload;
+                if (EncodeCustomMetricsReport(m_config.Format, reportId, values, payload) == AWS_OP_SUCCESS)
+                {
+                    Crt::ByteBuf buf = Crt::ByteBufNewCopy(m_allocator, payload.data(), payload.size());
+                    uint16_t packetId = m_config.Connection->Publish(
+                        topic.c_str(),
+                        AWS_MQTT_QOS_AT_MOST_ONCE,
+                        false,
+                        buf,
+                        [buf](Crt::Mqtt::MqttConnection &, uint16_t, int) {
+                            Crt::ByteBufDelete(const_cast<Crt::ByteBuf &>(buf));
+                        });
+                    if (packetId == 0)
+                    {
+                        Crt::ByteBufDelete(buf);
+                    }
+                }
+            }
+
+            ScheduleTick(generation, false);
+        }
+
+        void MultiThingReporter::s_onTickTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *tickTask = static_cast<TickTask *>(arg);
+            if (status == AWS_TASK_STATUS_RUN_READY)
+            {
+                auto reporter = tickTask->Owner.lock();
+                if (reporter)
+                {
+                    reporter->Tick(tickTask->Generation);
+                }
+            }
+
+            Crt::Delete(tickTask, tickTask->Allocator);
+        }
+    } // namespace Iotdevicedefenderv1
+} // namespace Aws
@@ -0,0 +1,70 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotdevicedefender/DeviceDefender.h>
+#include <aws/testing/aws_test_harness.h>
+
+static int s_TestDeviceDefenderCborReportEncoding(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+
+        Aws::Iotdevicedefenderv1::CustomMetricValues values;
+        values.emplace_back("a", -500);
+
+        Aws::Crt::Vector<uint8_t> encoded;
+        ASSERT_SUCCESS(Aws::Iotdevicedefenderv1::EncodeCustomMetricsReport(
+            Aws::Iotdevicedefenderv1::ReportFormat::AWS_IDDRF_CBOR, 1600000000000LL, values, encoded));
+
+        const uint8_t expected[] = {
+            0xA3,                                                       /* map(3) */
+            0x63, 'h',  'e',  'd',  0xA2,                               /* "hed": map(2) */
+            0x63, 'r',  'i',  'd',  0x1B, 0x00, 0x00, 0x01, 0x74, 0x87, /* "rid": uint64 */
+            0x6E, 0x80, 0x00, 0x61, 'v',  0x63, '1',  '.',  '0',        /* "v": "1.0" */
+            0x63, 'm',  'e',  't',  0xA0,                               /* "met": map(0) */
+            0x64, 'c',  'm',  'e',  't',  0xA1,                         /* "cmet": map(1) */
+            0x61, 'a',  0x81, 0xA1,                                     /* "a": [ { */
+            0x66, 'n',  'u',  'm',  'b',  'e',  'r',  0x39, 0x01, 0xF3, /* "number": -500 } ] */
+        };
+        ASSERT_BIN_ARRAYS_EQUALS(expected, sizeof(expected), encoded.data(), encoded.size());
+
+        ASSERT_ERROR(
+            AWS_ERROR_IOTDEVICE_DEFENDER_UNSUPPORTED_REPORT_FORMAT,
+            Aws::Iotdevicedefenderv1::EncodeCustomMetricsReport(
+                Aws::Iotdevicedefenderv1::ReportFormat::AWS_IDDRF_SHORT_JSON, 1, values, encoded));
+    }
+
+    return AWS_ERROR_SUCCESS;
+}
+
+AWS_TEST_CASE(DeviceDefenderCborReportEncoding, s_TestDeviceDefenderCborReportEncoding)
+
+static int s_TestDeviceDefenderJsonReportEncoding(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+
+        Aws::Iotdevicedefenderv1::CustomMetricValues values;
+        values.emplace_back("a", -500);
+        values.emplace_back("b\"c", 9007199254740993LL);
+
+        Aws::Crt::Vector<uint8_t> encoded;
+        ASSERT_SUCCESS(Aws::Iotdevicedefenderv1::EncodeCustomMetricsReport(
+            Aws::Iotdevicedefenderv1::ReportFormat::AWS_IDDRF_JSON, 1600000000000LL, values, encoded));
+
+        /* Past 2^53, so a document tree storing numbers as doubles would round the last value. */
+        const char expected[] = "{\"header\":{\"report_id\":1600000000000,\"version\":\"1.0\"},\"metrics\":{},"
+                                "\"custom_metrics\":{\"a\":[{\"number\":-500}],"
+                                "\"b\\\"c\":[{\"number\":9007199254740993}]}}";
+        ASSERT_BIN_ARRAYS_EQUALS(expected, sizeof(expected) - 1, encoded.data(), encoded.size());
+    }
+
+    return AWS_ERROR_SUCCESS;
+}
+
+AWS_TEST_CASE(DeviceDefenderJsonReportEncoding, s_TestDeviceDefenderJsonReportEncoding)
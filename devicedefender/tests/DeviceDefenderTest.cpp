@@ -145,4 +145,181 @@ static int s_TestDeviceDefenderFailedTest(Aws::Crt::Allocator *allocator, void *
     return AWS_ERROR_SUCCESS;
 }
 
-AWS_TEST_CASE(DeviceDefenderFailedTest, s_TestDeviceDefenderFailedTest)
\ No newline at end of file
+AWS_TEST_CASE(DeviceDefenderFailedTest, s_TestDeviceDefenderFailedTest)
+
+static int s_TestDeviceDefenderCustomMetricCollect(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)allocator;
+    (void)ctx;
+
+    Aws::Iotdevicedefenderv1::CustomMetric counter(Aws::Iotdevicedefenderv1::CustomMetric::Kind::Counter);
+    counter.Add(3);
+    counter.Add(4);
+    ASSERT_INT_EQUALS(7, (int)counter.Collect());
+    ASSERT_INT_EQUALS(0, (int)counter.Collect());
+
+    Aws::Iotdevicedefenderv1::CustomMetric gauge(Aws::Iotdevicedefenderv1::CustomMetric::Kind::Gauge);
+    gauge.Set(42);
+    ASSERT_INT_EQUALS(42, (int)gauge.Collect());
+    ASSERT_INT_EQUALS(42, (int)gauge.Collect());
+    gauge.Add(-2);
+    ASSERT_INT_EQUALS(40, (int)gauge.Collect());
+
+    return AWS_ERROR_SUCCESS;
+}
+
+AWS_TEST_CASE(DeviceDefenderCustomMetricCollect, s_TestDeviceDefenderCustomMetricCollect)
+
+static int s_TestDeviceDefenderSharedTasks(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        Aws::Iotdevicecommon::DeviceApiHandle deviceApiHandle(allocator);
+        Aws::Crt::Io::TlsContextOptions tlsCtxOptions = Aws::Crt::Io::TlsContextOptions::InitDefaultClient();
+
+        Aws::Crt::Io::TlsContext tlsContext(tlsCtxOptions, Aws::Crt::Io::TlsMode::CLIENT, allocator);
+        ASSERT_TRUE(tlsContext);
+
+        Aws::Crt::Io::SocketOptions socketOptions;
+        socketOptions.SetConnectTimeoutMs(3000);
+
+        Aws::Crt::Io::EventLoopGroup eventLoopGroup(0, allocator);
+        ASSERT_TRUE(eventLoopGroup);
+
+        Aws::Crt::Io::DefaultHostResolver defaultHostResolver(eventLoopGroup, 8, 30, allocator);
+        ASSERT_TRUE(defaultHostResolver);
+
+        Aws::Crt::Io::ClientBootstrap clientBootstrap(eventLoopGroup, defaultHostResolver, allocator);
+        ASSERT_TRUE(clientBootstrap);
+        clientBootstrap.EnableBlockingShutdown();
+
+        Aws::Crt::Mqtt::MqttClient mqttClient(clientBootstrap, allocator);
+        ASSERT_TRUE(mqttClient);
+
+        auto mqttConnection = mqttClient.NewConnection("www.example.com", 443, socketOptions, tlsContext);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        int cancelled = 0;
+
+        /* Tasks built shared never move, so they can live in a growing vector while running. */
+        Aws::Crt::Vector<std::shared_ptr<Aws::Iotdevicedefenderv1::ReportTask>> tasks;
+        for (int i = 0; i < 3; ++i)
+        {
+            Aws::Crt::String thingName("TestThing");
+            Aws::Iotdevicedefenderv1::ReportTaskBuilder taskBuilder(
+                allocator, mqttConnection, eventLoopGroup, thingName);
+            taskBuilder.WithTaskPeriodSeconds((uint32_t)1UL)
+                .WithNetworkConnectionSamplePeriodSeconds((uint32_t)1UL)
+                .WithTaskCancelledHandler([&](void *) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ++cancelled;
+                    cv.notify_one();
+                });
+
+            tasks.push_back(taskBuilder.BuildShared());
+            ASSERT_NOT_NULL(tasks.back());
+            ASSERT_SUCCESS(tasks.back()->StartTask());
+        }
+
+        /* Dropping the references stops the tasks; each is freed after its cancellation. */
+        tasks.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return cancelled == 3; });
+        }
+
+        mqttConnection->Disconnect();
+    }
+
+    return AWS_ERROR_SUCCESS;
+}
+
+AWS_TEST_CASE(DeviceDefenderSharedTasks, s_TestDeviceDefenderSharedTasks)
+
+static int s_TestDeviceDefenderTriggerReport(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        Aws::Iotdevicecommon::DeviceApiHandle deviceApiHandle(allocator);
+        Aws::Crt::Io::TlsContextOptions tlsCtxOptions = Aws::Crt::Io::TlsContextOptions::InitDefaultClient();
+
+        Aws::Crt::Io::TlsContext tlsContext(tlsCtxOptions, Aws::Crt::Io::TlsMode::CLIENT, allocator);
+        ASSERT_TRUE(tlsContext);
+
+        Aws::Crt::Io::SocketOptions socketOptions;
+        socketOptions.SetConnectTimeoutMs(3000);
+
+        Aws::Crt::Io::EventLoopGroup eventLoopGroup(0, allocator);
+        ASSERT_TRUE(eventLoopGroup);
+
+        Aws::Crt::Io::DefaultHostResolver defaultHostResolver(eventLoopGroup, 8, 30, allocator);
+        ASSERT_TRUE(defaultHostResolver);
+
+        Aws::Crt::Io::ClientBootstrap clientBootstrap(eventLoopGroup, defaultHostResolver, allocator);
+        ASSERT_TRUE(clientBootstrap);
+        clientBootstrap.EnableBlockingShutdown();
+
+        Aws::Crt::Mqtt::MqttClient mqttClient(clientBootstrap, allocator);
+        ASSERT_TRUE(mqttClient);
+
+        auto mqttConnection = mqttClient.NewConnection("www.example.com", 443, socketOptions, tlsContext);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        int cancelled = 0;
+        auto onCancelled = [&](void *) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++cancelled;
+            cv.notify_one();
+        };
+
+        const Aws::Crt::String thingName("TestThing");
+        auto errors = std::make_shared<Aws::Iotdevicedefenderv1::CustomMetric>(
+            Aws::Iotdevicedefenderv1::CustomMetric::Kind::Counter);
+
+        /* Without custom metrics there is nothing to report out of band. */
+        Aws::Iotdevicedefenderv1::ReportTaskBuilder plainBuilder(allocator, mqttConnection, eventLoopGroup, thingName);
+        plainBuilder.WithTaskCancelledHandler(onCancelled);
+        std::shared_ptr<Aws::Iotdevicedefenderv1::ReportTask> plainTask = plainBuilder.BuildShared();
+        ASSERT_NOT_NULL(plainTask);
+        ASSERT_SUCCESS(plainTask->StartTask());
+        ASSERT_INT_EQUALS(AWS_OP_ERR, plainTask->TriggerReport());
+        ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, plainTask->LastError());
+
+        Aws::Iotdevicedefenderv1::ReportTaskBuilder taskBuilder(allocator, mqttConnection, eventLoopGroup, thingName);
+        taskBuilder.WithTaskPeriodSeconds((uint32_t)3600UL)
+            .WithCustomMetric("errors", errors)
+            .WithReportTriggerInterval((uint32_t)3600UL)
+            .WithTaskCancelledHandler(onCancelled);
+        std::shared_ptr<Aws::Iotdevicedefenderv1::ReportTask> task = taskBuilder.BuildShared();
+        ASSERT_NOT_NULL(task);
+
+        ASSERT_INT_EQUALS(AWS_OP_ERR, task->TriggerReport());
+        ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, task->LastError());
+
+        ASSERT_SUCCESS(task->StartTask());
+        errors->Add(1);
+        ASSERT_SUCCESS(task->TriggerReport());
+        /* Merged into the pending one, or deferred by the trigger interval. */
+        ASSERT_SUCCESS(task->TriggerReport());
+
+        plainTask->StopTask();
+        task->StopTask();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return cancelled == 2; });
+        }
+        ASSERT_INT_EQUALS(AWS_OP_ERR, task->TriggerReport());
+
+        plainTask.reset();
+        task.reset();
+        mqttConnection->Disconnect();
+    }
+
+    return AWS_ERROR_SUCCESS;
+}
+
+AWS_TEST_CASE(DeviceDefenderTriggerReport, s_TestDeviceDefenderTriggerReport)
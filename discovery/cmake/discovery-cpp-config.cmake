@@ -1,6 +1,7 @@
 include(CMakeFindDependencyMacro)
 
 find_dependency(aws-crt-cpp)
+find_dependency(IotDeviceCommon-cpp)
 
 if (BUILD_SHARED_LIBS)
     include(${CMAKE_CURRENT_LIST_DIR}/shared/@PROJECT_NAME@-targets.cmake)
@@ -0,0 +1,88 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/ConnectivityInfo.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        class AWS_DISCOVERY_API ConnectivityHistoryConfig
+        {
+          public:
+            ConnectivityHistoryConfig() noexcept;
+            ConnectivityHistoryConfig(const ConnectivityHistoryConfig &rhs) = default;
+            ConnectivityHistoryConfig(ConnectivityHistoryConfig &&rhs) = default;
+
+            ConnectivityHistoryConfig &operator=(const ConnectivityHistoryConfig &rhs) = default;
+            ConnectivityHistoryConfig &operator=(ConnectivityHistoryConfig &&rhs) = default;
+
+            ~ConnectivityHistoryConfig() = default;
+
+            /**
+             * File the history is loaded from on creation and saved to after every change, so rankings
+             * survive restarts. Optional. When empty, the history is in memory only.
+             */
+            Crt::String PersistPath;
+        };
+
+        /**
+         * Connect latency and outcome per endpoint (host and port), used to try the historically fastest
+         * endpoint first. Thread-safe; attach one through ConnectivityRacerConfig::History.
+         */
+        class AWS_DISCOVERY_API ConnectivityHistory final
+        {
+          public:
+            ConnectivityHistory(const ConnectivityHistory &) = delete;
+            ConnectivityHistory(ConnectivityHistory &&) = delete;
+            ConnectivityHistory &operator=(const ConnectivityHistory &) = delete;
+            ConnectivityHistory &operator=(ConnectivityHistory &&) = delete;
+
+            ~ConnectivityHistory() = default;
+
+            void RecordSuccess(const ConnectivityInfo &connectivityInfo, uint64_t latencyMs);
+
+            void RecordFailure(const ConnectivityInfo &connectivityInfo);
+
+            /**
+             * Stably reorders candidates best first: endpoints whose last attempt succeeded, fastest first,
+             * then endpoints never tried, then endpoints that have been failing, fewest failures first.
+             *
+             * @return the number of leading candidates whose last attempt succeeded.
+             */
+            size_t Rank(Crt::Vector<ConnectivityInfo> &candidates) const;
+
+            static std::shared_ptr<ConnectivityHistory> Create(
+                const ConnectivityHistoryConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Entry
+            {
+                /* Exponentially weighted, so one slow connect does not demote an endpoint for good. */
+                uint64_t SmoothedLatencyMs = 0;
+                uint32_t Successes = 0;
+                uint32_t ConsecutiveFailures = 0;
+            };
+
+            ConnectivityHistory(const ConnectivityHistoryConfig &config, Crt::Allocator *allocator) noexcept;
+
+            static Crt::String Key(const ConnectivityInfo &connectivityInfo);
+
+            void Load();
+            /* Requires m_lock. */
+            void Save() const;
+
+            ConnectivityHistoryConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, Entry> m_entries;
+        };
+    } // namespace Discovery
+} // namespace Aws
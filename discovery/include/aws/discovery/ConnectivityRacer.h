@@ -0,0 +1,159 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/ConnectivityHistory.h>
+#include <aws/discovery/ConnectivityInfo.h>
+
+#include <aws/crt/io/Bootstrap.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/crt/io/SocketOptions.h>
+#include <aws/crt/io/TlsOptions.h>
+#include <aws/iot/MqttClient.h>
+
+#include <memory>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        /**
+         * Invoked once per race, with the outcome of the MQTT connect to the winning endpoint as reported by
+         * OnConnectionCompleted. The caller takes ownership of `connection` and may replace its
+         * OnConnectionCompleted handler from here on; `winner` is only valid during the call.
+         *
+         * `connection` and `winner` are null if no probe succeeded or the MQTT connection could not be
+         * created, in which case errorCode says why.
+         */
+        using OnConnectivityRaceComplete = std::function<void(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const ConnectivityInfo *winner,
+            int errorCode,
+            Crt::Mqtt::ReturnCode returnCode)>;
+
+        /**
+         * Builds the MQTT connection config for one endpoint, typically with
+         * MqttClientConnectionConfigBuilder(...).WithEndpoint(*info.HostAddress).WithPortOverride(*info.Port).
+         */
+        using ConnectionConfigFactory =
+            std::function<Iot::MqttClientConnectionConfig(const ConnectivityInfo &connectivityInfo)>;
+
+        class AWS_DISCOVERY_API ConnectivityRacerConfig final
+        {
+          public:
+            ConnectivityRacerConfig() noexcept;
+            ConnectivityRacerConfig(const ConnectivityRacerConfig &rhs) = default;
+            ConnectivityRacerConfig(ConnectivityRacerConfig &&rhs) = default;
+
+            ConnectivityRacerConfig &operator=(const ConnectivityRacerConfig &rhs) = default;
+            ConnectivityRacerConfig &operator=(ConnectivityRacerConfig &&rhs) = default;
+
+            ~ConnectivityRacerConfig() = default;
+
+            /**
+             * The client bootstrap the probe connections are made with.
+             * Required.
+             */
+            Crt::Io::ClientBootstrap *Bootstrap;
+
+            /**
+             * The socket options of the probe connections. Their connect timeout bounds how long an
+             * unreachable endpoint can hold up the race.
+             * Required.
+             */
+            Crt::Io::SocketOptions SocketOptions;
+
+            /**
+             * When set, a probe only succeeds once the TLS handshake completes, so an endpoint with a bad
+             * certificate loses the race. It should trust the group CA and carry the client certificate.
+             * Optional. When unset, probes stop at the TCP connect.
+             *
+             * Without a ConnectionConfig, the winning MQTT connection is made with this context too. Every
+             * handshake then shares one context, so certificates are loaded once, and TLS implementations
+             * that cache sessions per context can resume the winning probe's session.
+             */
+            Crt::Optional<Crt::Io::TlsContext> TlsContext;
+
+            /**
+             * The client the winning MQTT connection is created from.
+             * Required.
+             */
+            Iot::MqttClient *MqttClient;
+
+            /**
+             * Builds the MQTT connection config for the winning endpoint.
+             * Required unless TlsContext is set.
+             */
+            ConnectionConfigFactory ConnectionConfig;
+
+            /**
+             * The client id, clean session flag and keep alive the winning connection connects with.
+             */
+            Crt::String ClientId;
+            bool CleanSession;
+            uint16_t KeepAliveTimeSecs;
+
+            /**
+             * Probe latencies and failures are recorded here, and candidates are probed best first.
+             * Optional.
+             */
+            std::shared_ptr<ConnectivityHistory> History;
+
+            /**
+             * Event loop group the head start below is timed on.
+             * Optional. When unset, all candidates are probed at once, in ranked order.
+             */
+            Crt::Io::EventLoopGroup *EventLoopGroup;
+
+            /**
+             * How long, in milliseconds, the best ranked candidate is probed alone when its last attempt
+             * succeeded. The others are probed once it fails or the head start runs out. Requires History
+             * and EventLoopGroup.
+             */
+            uint32_t PreferredHeadStartMs;
+        };
+
+        /**
+         * Picks a Greengrass core endpoint by probing all of its connectivity entries at once instead of
+         * trying MQTT connections one after another. Every candidate gets a TCP (or TLS) probe in parallel;
+         * the first to complete wins, the other probes are closed, and a single MQTT connection is made to
+         * the winner. Only one MQTT connection is ever opened, so candidates that reach the same core cannot
+         * take over each other's session.
+         *
+         * With a ConnectivityHistory attached, an endpoint that answered last time gets a short head start,
+         * so after the first run the fastest known endpoint is usually connected to without contention.
+         */
+        class AWS_DISCOVERY_API ConnectivityRacer final
+        {
+          public:
+            ConnectivityRacer(const ConnectivityRacer &) = delete;
+            ConnectivityRacer(ConnectivityRacer &&) = delete;
+            ConnectivityRacer &operator=(const ConnectivityRacer &) = delete;
+            ConnectivityRacer &operator=(ConnectivityRacer &&) = delete;
+
+            ~ConnectivityRacer() = default;
+
+            /**
+             * Races the candidates that have both a HostAddress and a Port. Races are independent of each
+             * other and of the racer's lifetime. onComplete may be invoked before Race returns, if every
+             * probe fails to start.
+             *
+             * @return false, without invoking onComplete, if no candidate is usable.
+             */
+            bool Race(
+                const Crt::Vector<ConnectivityInfo> &candidates,
+                const OnConnectivityRaceComplete &onComplete) noexcept;
+
+            static std::shared_ptr<ConnectivityRacer> Create(
+                const ConnectivityRacerConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            ConnectivityRacer(const ConnectivityRacerConfig &config, Crt::Allocator *allocator) noexcept;
+
+            ConnectivityRacerConfig m_config;
+            Crt::Allocator *m_allocator;
+        };
+    } // namespace Discovery
+} // namespace Aws
@@ -0,0 +1,115 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/Exports.h>
+
+#include <aws/crt/Types.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        class AWS_DISCOVERY_API DiscoveryCacheConfig
+        {
+          public:
+            DiscoveryCacheConfig() noexcept;
+            DiscoveryCacheConfig(const DiscoveryCacheConfig &rhs) = default;
+            DiscoveryCacheConfig(DiscoveryCacheConfig &&rhs) = default;
+
+            DiscoveryCacheConfig &operator=(const DiscoveryCacheConfig &rhs) = default;
+            DiscoveryCacheConfig &operator=(DiscoveryCacheConfig &&rhs) = default;
+
+            ~DiscoveryCacheConfig() = default;
+
+            /**
+             * Age, in seconds, after which a cached response is refreshed. Stale responses are still served
+             * by DiscoveryClient::DiscoverCached while the refresh runs.
+             */
+            uint64_t TtlSeconds;
+
+            /**
+             * File the cache is loaded from on creation and saved to after every change, so it survives
+             * restarts. Optional. When empty, the cache is in memory only.
+             */
+            Crt::String PersistPath;
+        };
+
+        /**
+         * Last-known discover responses, keyed by thing name. Responses are kept as the raw JSON the service
+         * returned. Thread-safe; attach one through DiscoveryClientConfig::Cache.
+         */
+        class AWS_DISCOVERY_API DiscoveryCache final
+        {
+          public:
+            DiscoveryCache(const DiscoveryCache &) = delete;
+            DiscoveryCache(DiscoveryCache &&) = delete;
+            DiscoveryCache &operator=(const DiscoveryCache &) = delete;
+            DiscoveryCache &operator=(DiscoveryCache &&) = delete;
+
+            ~DiscoveryCache() = default;
+
+            /**
+             * Looks up the response cached for thingName.
+             *
+             * @param stale set to true if the response is older than the TTL.
+             * @return false if nothing is cached for thingName.
+             */
+            bool Lookup(const Crt::String &thingName, Crt::String &responseBody, bool &stale) const;
+
+            /**
+             * Caches responseBody for thingName, with the ETag and Last-Modified validators it was served
+             * with, if any.
+             */
+            void Store(
+                const Crt::String &thingName,
+                const Crt::String &responseBody,
+                const Crt::String &eTag = Crt::String(),
+                const Crt::String &lastModified = Crt::String());
+
+            /**
+             * Looks up the validators stored with thingName's response, for a conditional request.
+             *
+             * @return false if nothing is cached for thingName or it was stored without validators.
+             */
+            bool LookupValidators(const Crt::String &thingName, Crt::String &eTag, Crt::String &lastModified) const;
+
+            /**
+             * Marks thingName's response as current again, after the service confirmed it is unchanged.
+             */
+            void Touch(const Crt::String &thingName);
+
+            void Remove(const Crt::String &thingName);
+
+            static std::shared_ptr<DiscoveryCache> Create(
+                const DiscoveryCacheConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Entry
+            {
+                Crt::String ResponseBody;
+                Crt::String ETag;
+                Crt::String LastModified;
+                /* Seconds since the Unix epoch, so ages carry across restarts. */
+                uint64_t StoredAtSeconds = 0;
+            };
+
+            DiscoveryCache(const DiscoveryCacheConfig &config, Crt::Allocator *allocator) noexcept;
+
+            void Load();
+            /* Requires m_lock. */
+            void Save() const;
+
+            DiscoveryCacheConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, Entry> m_entries;
+        };
+    } // namespace Discovery
+} // namespace Aws
@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 #include <aws/discovery/DiscoverResponse.h>
+#include <aws/discovery/DiscoveryCache.h>
+#include <aws/discovery/EndpointResolutionCache.h>
 
 #include <aws/crt/http/HttpConnectionManager.h>
 
@@ -13,6 +15,53 @@ namespace Aws
     {
         using OnDiscoverResponse = std::function<void(DiscoverResponse *, int errorCode, int httpResponseCode)>;
 
+        /**
+         * The outcome of discovering one thing as part of DiscoverMany.
+         */
+        struct DiscoverResult
+        {
+            Crt::Optional<DiscoverResponse> Response;
+            int ErrorCode = AWS_ERROR_SUCCESS;
+            int HttpResponseCode = 0;
+        };
+
+        using OnDiscoverManyComplete = std::function<void(const Crt::Map<Crt::String, DiscoverResult> &results)>;
+
+        /**
+         * Where the time of one Discover went, in nanoseconds. Each phase starts where the previous one ended;
+         * phases the request did not get to are zero.
+         */
+        struct DiscoverTimings
+        {
+            /* Waiting for a connection: DNS, TCP and the TLS handshake for a new one, or a queue for a busy pool. */
+            uint64_t ConnectionAcquireNs = 0;
+            /* Building the request and handing it to the connection. */
+            uint64_t RequestSentNs = 0;
+            /* Until the response headers were in: the network round trip plus the service's time. */
+            uint64_t HeadersReceivedNs = 0;
+            /* Until the last byte of the body. */
+            uint64_t BodyCompleteNs = 0;
+            /* Parsing the body into a DiscoverResponse; zero when the response was unchanged. */
+            uint64_t ParseCompleteNs = 0;
+        };
+
+        using OnDiscoverTimings = std::function<void(const Crt::String &thingName, const DiscoverTimings &timings)>;
+
+        /**
+         * Bounds on how long one Discover waits for the service. Zero leaves a bound off.
+         */
+        struct DiscoverTimeouts
+        {
+            /* After this, the Discover fails with AWS_IO_SOCKET_TIMEOUT; a response still coming is only cached. */
+            uint32_t TimeoutMs = 0;
+            /*
+             * After this without a response, a second request goes out on another pooled connection and the
+             * first success of the two is delivered, so one slow connection or server does not hold the boot
+             * up. Needs MaxConnections of 2 or more.
+             */
+            uint32_t HedgeAfterMs = 0;
+        };
+
         class AWS_DISCOVERY_API DiscoveryClientConfig
         {
           public:
@@ -32,7 +81,8 @@ namespace Aws
             Crt::Io::ClientBootstrap *Bootstrap;
 
             /**
-             * The TLS options for all http connections made by this client.
+             * The TLS options for all http connections made by this client. Every connection is made from this
+             * one context and kept alive between requests, so most discovers skip the handshake altogether.
              * Optional.
              */
             Crt::Optional<Crt::Io::TlsContext> TlsContext;
@@ -50,7 +100,10 @@ namespace Aws
             Crt::String Region;
 
             /**
-             * The maximum number of concurrent connections allowed
+             * The maximum number of concurrent connections allowed. Connections are kept alive and reused
+             * by later requests, and requests beyond this wait for a free one. Discovery is served over
+             * HTTP/1.1 with one request per connection at a time, so this is also the most TLS sessions a
+             * DiscoverMany batch opens; set it to 1 to run a batch over a single session.
              */
             size_t MaxConnections;
 
@@ -59,23 +112,94 @@ namespace Aws
              * Optional.
              */
             Crt::Optional<Crt::Http::HttpClientConnectionProxyOptions> ProxyOptions;
+
+            /**
+             * Cache that successful discover responses are stored in and DiscoverCached reads from.
+             * Optional.
+             */
+            std::shared_ptr<DiscoveryCache> Cache;
+
+            /**
+             * Keeps the discovery endpoint resolved in the background, so connections do not wait on DNS.
+             * Share it with the MQTT connection's endpoint. Must use Bootstrap's resolver.
+             * Optional.
+             */
+            std::shared_ptr<EndpointResolutionCache> ResolutionCache;
+
+            /**
+             * Invoked with the phase breakdown of every Discover, on the thread that completed it, right after
+             * its onDiscoverResponse returns.
+             * Optional.
+             */
+            OnDiscoverTimings OnTimings;
+
+            /**
+             * The timeout and hedging of every Discover not given its own. Defaults to neither.
+             */
+            DiscoverTimeouts Timeouts;
         };
 
         class AWS_DISCOVERY_API DiscoveryClient final
         {
           public:
+            /**
+             * Discovers thingName's groups. Repeat requests are conditional on the validators (ETag,
+             * Last-Modified) of the previous response, kept in memory and in the Cache if one is attached.
+             * When the service reports the response unchanged, or returns the same body again, the response
+             * parsed last time is passed with an httpResponseCode of 304, so connection state built from it
+             * can be kept.
+             */
             bool Discover(const Crt::String &thingName, const OnDiscoverResponse &onDiscoverResponse) noexcept;
 
+            /**
+             * Discovers thingName's groups within `timeouts`, in place of the config's.
+             */
+            bool Discover(
+                const Crt::String &thingName,
+                const DiscoverTimeouts &timeouts,
+                const OnDiscoverResponse &onDiscoverResponse) noexcept;
+
+            /**
+             * Discovers every thing in thingNames at once. The requests share the client's connection
+             * manager, so up to MaxConnections run in parallel over reused connections and the rest queue for
+             * the next free one. onComplete is invoked once, with a result per distinct thing name.
+             */
+            bool DiscoverMany(
+                const Crt::Vector<Crt::String> &thingNames,
+                const OnDiscoverManyComplete &onComplete) noexcept;
+
+            /**
+             * Serves the cached response for thingName straight away, with an httpResponseCode of 0. If it is
+             * stale, a Discover is started in the background to refresh the cache and its result is passed to
+             * onRefreshed (optional). Without a cached response this behaves like Discover.
+             */
+            bool DiscoverCached(
+                const Crt::String &thingName,
+                const OnDiscoverResponse &onDiscoverResponse,
+                const OnDiscoverResponse &onRefreshed = OnDiscoverResponse()) noexcept;
+
             static std::shared_ptr<DiscoveryClient> CreateClient(
                 const DiscoveryClientConfig &config,
                 Crt::Allocator *allocator = Crt::DefaultAllocator());
 
           private:
+            /* The last response delivered per thing, shared with requests still in flight. */
+            struct KnownResponses;
+
             DiscoveryClient(const DiscoveryClientConfig &config, Crt::Allocator *allocator) noexcept;
 
+            /* Sends a single request, without timeout or hedging. */
+            bool StartAttempt(const Crt::String &thingName, const OnDiscoverResponse &onDiscoverResponse) noexcept;
+
             std::shared_ptr<Crt::Http::HttpClientConnectionManager> m_connectionManager;
             Crt::String m_hostName;
             Crt::Allocator *m_allocator;
+            std::shared_ptr<DiscoveryCache> m_cache;
+            std::shared_ptr<KnownResponses> m_known;
+            OnDiscoverTimings m_onTimings;
+            DiscoverTimeouts m_timeouts;
+            size_t m_maxConnections;
+            aws_event_loop_group *m_eventLoopGroup;
         };
     } // namespace Discovery
 } // namespace Aws
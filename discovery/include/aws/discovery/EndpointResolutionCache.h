@@ -0,0 +1,128 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/Exports.h>
+
+#include <aws/crt/Types.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/crt/io/HostResolver.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        class AWS_DISCOVERY_API EndpointResolutionCacheConfig
+        {
+          public:
+            EndpointResolutionCacheConfig() noexcept;
+            EndpointResolutionCacheConfig(const EndpointResolutionCacheConfig &rhs) = default;
+            EndpointResolutionCacheConfig(EndpointResolutionCacheConfig &&rhs) = default;
+
+            EndpointResolutionCacheConfig &operator=(const EndpointResolutionCacheConfig &rhs) = default;
+            EndpointResolutionCacheConfig &operator=(EndpointResolutionCacheConfig &&rhs) = default;
+
+            ~EndpointResolutionCacheConfig() = default;
+
+            /**
+             * The resolver behind the ClientBootstrap that the MQTT connection and DiscoveryClient connect
+             * with. Refreshes go through it, which keeps its own cache warm.
+             * Required.
+             */
+            Crt::Io::HostResolver *HostResolver;
+
+            /**
+             * Event loop group that background refreshes are timed on.
+             * Required.
+             */
+            Crt::Io::EventLoopGroup *EventLoopGroup;
+
+            /**
+             * How often, in milliseconds, every prefetched host is resolved again.
+             */
+            uint32_t RefreshIntervalMs;
+
+            /**
+             * Age, in seconds, after which addresses that could not be refreshed are reported as stale.
+             * Stale addresses are still returned by Lookup.
+             */
+            uint64_t TtlSeconds;
+        };
+
+        /**
+         * Keeps the addresses of the endpoints a device reconnects to resolved ahead of time. Each prefetched
+         * host is resolved again in the background every RefreshIntervalMs, so the bootstrap's resolver
+         * always holds it and a reconnect, MQTT or discovery, starts without waiting on DNS. Addresses from
+         * the last successful resolution are kept through DNS failures and served by Lookup.
+         *
+         * Thread-safe; attach one through DiscoveryClientConfig::ResolutionCache and Prefetch the MQTT
+         * endpoint.
+         */
+        class AWS_DISCOVERY_API EndpointResolutionCache final
+            : public std::enable_shared_from_this<EndpointResolutionCache>
+        {
+          public:
+            EndpointResolutionCache(const EndpointResolutionCache &) = delete;
+            EndpointResolutionCache(EndpointResolutionCache &&) = delete;
+            EndpointResolutionCache &operator=(const EndpointResolutionCache &) = delete;
+            EndpointResolutionCache &operator=(EndpointResolutionCache &&) = delete;
+
+            ~EndpointResolutionCache() = default;
+
+            /**
+             * Resolves host now and keeps it refreshed for as long as the cache lives. Prefetching a host
+             * twice is harmless.
+             *
+             * @return false if the first resolution could not be started.
+             */
+            bool Prefetch(const Crt::String &host);
+
+            /**
+             * Looks up the addresses last resolved for host.
+             *
+             * @param stale set to true if they are older than the TTL.
+             * @return false if host has never resolved.
+             */
+            bool Lookup(const Crt::String &host, Crt::Vector<Crt::String> &addresses, bool &stale) const;
+
+            /**
+             * @return the number of resolutions, initial or refresh, that failed.
+             */
+            uint64_t GetFailedResolutionCount() const;
+
+            static std::shared_ptr<EndpointResolutionCache> Create(
+                const EndpointResolutionCacheConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Entry
+            {
+                Crt::Vector<Crt::String> Addresses;
+                /* High-resolution clock ticks; 0 until the host first resolves. */
+                uint64_t ResolvedAtNs = 0;
+            };
+
+            /* The resolver and refresh task callbacks, defined with the implementation. */
+            struct Callbacks;
+
+            EndpointResolutionCache(const EndpointResolutionCacheConfig &config, Crt::Allocator *allocator) noexcept;
+
+            bool Resolve(const Crt::String &host);
+            void OnResolved(const Crt::String &host, int errorCode, Crt::Vector<Crt::String> &&addresses);
+            bool ScheduleRefresh();
+            void Refresh();
+
+            EndpointResolutionCacheConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, Entry> m_entries;
+            bool m_refreshScheduled;
+            uint64_t m_failedResolutions;
+        };
+    } // namespace Discovery
+} // namespace Aws
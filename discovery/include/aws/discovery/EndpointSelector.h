@@ -0,0 +1,190 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/ConnectivityHistory.h>
+#include <aws/discovery/ConnectivityInfo.h>
+#include <aws/discovery/DiscoverResponse.h>
+
+#include <aws/crt/io/Bootstrap.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/crt/io/SocketOptions.h>
+#include <aws/crt/io/TlsOptions.h>
+#include <aws/iot/MqttClient.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        /**
+         * Invoked at the end of every evaluation. `selected` is the endpoint to connect to, or null if none
+         * has answered yet; `changed` says whether this evaluation picked a different one. errorCode is the
+         * last probe failure if no candidate answered this time, in which case the previous selection stands.
+         * `selected` is only valid during the call.
+         */
+        using OnEndpointSelected = std::function<void(const ConnectivityInfo *selected, bool changed, int errorCode)>;
+
+        class AWS_DISCOVERY_API EndpointSelectorConfig final
+        {
+          public:
+            EndpointSelectorConfig() noexcept;
+            EndpointSelectorConfig(const EndpointSelectorConfig &rhs) = default;
+            EndpointSelectorConfig(EndpointSelectorConfig &&rhs) = default;
+
+            EndpointSelectorConfig &operator=(const EndpointSelectorConfig &rhs) = default;
+            EndpointSelectorConfig &operator=(EndpointSelectorConfig &&rhs) = default;
+
+            ~EndpointSelectorConfig() = default;
+
+            /**
+             * The endpoints to choose between; those without both a HostAddress and a Port are ignored. See
+             * CandidatesOf for building them from endpoint names or a DiscoverResponse.
+             * Required.
+             */
+            Crt::Vector<ConnectivityInfo> Candidates;
+
+            /**
+             * The client bootstrap the probe connections are made with.
+             * Required.
+             */
+            Crt::Io::ClientBootstrap *Bootstrap;
+
+            /**
+             * The socket options of the probe connections. Their connect timeout bounds how long an
+             * unreachable endpoint can hold up an evaluation.
+             * Required.
+             */
+            Crt::Io::SocketOptions SocketOptions;
+
+            /**
+             * When set, a probe only succeeds once the TLS handshake completes, so an endpoint that rejects
+             * the device's certificate is not selected. Optional. When unset, probes stop at the TCP connect.
+             */
+            Crt::Optional<Crt::Io::TlsContext> TlsContext;
+
+            /**
+             * Probe latencies and failures are recorded here as well. Optional.
+             */
+            std::shared_ptr<ConnectivityHistory> History;
+
+            /**
+             * Event loop group the periodic evaluations are timed on.
+             * Required by Start.
+             */
+            Crt::Io::EventLoopGroup *EventLoopGroup;
+
+            /**
+             * How long, in milliseconds, Start waits between the end of one evaluation and the next.
+             * Defaults to 300000.
+             */
+            uint32_t ReevaluateIntervalMs;
+
+            /**
+             * How much faster, in milliseconds, another endpoint must answer than the selected one, while that
+             * one still answers, to be selected instead, so jitter does not move the device back and forth.
+             * Defaults to 20.
+             */
+            uint32_t SwitchMarginMs;
+
+            /**
+             * Invoked at the end of every evaluation. Optional.
+             */
+            OnEndpointSelected OnSelected;
+        };
+
+        /**
+         * Picks the endpoint to connect to among several, such as the IoT endpoints of several regions or the
+         * connectivity entries of Greengrass cores: probes every candidate in parallel with a TCP (or TLS)
+         * connect, and selects the fastest that answered. Unlike ConnectivityRacer, which connects to the
+         * first endpoint to answer once, the selector waits for every probe and keeps evaluating on a period,
+         * so the application can move to a better endpoint when the current one degrades or fails.
+         *
+         * The selector does not connect; ApplyTo sets the selected endpoint on the connection config builder.
+         */
+        class AWS_DISCOVERY_API EndpointSelector final : public std::enable_shared_from_this<EndpointSelector>
+        {
+          public:
+            EndpointSelector(const EndpointSelector &) = delete;
+            EndpointSelector(EndpointSelector &&) = delete;
+            EndpointSelector &operator=(const EndpointSelector &) = delete;
+            EndpointSelector &operator=(EndpointSelector &&) = delete;
+
+            ~EndpointSelector() = default;
+
+            /**
+             * Probes every candidate once. An evaluation already under way is not restarted.
+             *
+             * @return false if no candidate is usable or no probe could be started.
+             */
+            bool Evaluate() noexcept;
+
+            /**
+             * Evaluates now and then every ReevaluateIntervalMs until Stop.
+             */
+            bool Start() noexcept;
+
+            void Stop() noexcept;
+
+            /**
+             * @return the selected endpoint, if an evaluation has selected one.
+             */
+            Crt::Optional<ConnectivityInfo> GetSelected() const;
+
+            /**
+             * Sets the selected endpoint's host and port on `builder`.
+             *
+             * @return false, with AWS_ERROR_INVALID_STATE raised, if none is selected yet.
+             */
+            bool ApplyTo(Iot::MqttClientConnectionConfigBuilder &builder) const;
+
+            /**
+             * Replaces the candidates from the next evaluation on, e.g. with a new DiscoverResponse's. The
+             * selection stands until an evaluation replaces it.
+             */
+            void SetCandidates(const Crt::Vector<ConnectivityInfo> &candidates);
+
+            /**
+             * @return one candidate per endpoint name, all on `port`.
+             */
+            static Crt::Vector<ConnectivityInfo> CandidatesOf(
+                const Crt::Vector<Crt::String> &endpoints,
+                uint16_t port = 8883);
+
+            /**
+             * @return the connectivity entries of every core of every group in `response`.
+             */
+            static Crt::Vector<ConnectivityInfo> CandidatesOf(const DiscoverResponse &response);
+
+            static std::shared_ptr<EndpointSelector> Create(
+                const EndpointSelectorConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Evaluation;
+            struct ReevaluateTask;
+
+            EndpointSelector(const EndpointSelectorConfig &config, Crt::Allocator *allocator) noexcept;
+
+            void StartProbe(const std::shared_ptr<Evaluation> &evaluation, size_t candidate);
+            void OnProbeDone(const std::shared_ptr<Evaluation> &evaluation, size_t candidate, int errorCode);
+            void Complete(const Evaluation &evaluation);
+            bool ScheduleNext(uint64_t generation);
+            void OnReevaluate(uint64_t generation);
+
+            EndpointSelectorConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Vector<ConnectivityInfo> m_candidates;
+            Crt::Optional<ConnectivityInfo> m_selected;
+            bool m_evaluating;
+            bool m_running;
+            /* Bumped by Start and Stop, so wake-ups of an earlier run do nothing. */
+            uint64_t m_generation;
+        };
+    } // namespace Discovery
+} // namespace Aws
@@ -0,0 +1,188 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/Exports.h>
+
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        /**
+         * Completion of a GreengrassIpcClient operation: AWS_ERROR_SUCCESS once the core answered, else why
+         * not: AWS_ERROR_UNKNOWN, with `errorModel` naming the core's error, such as
+         * "aws.greengrass#UnauthorizedError", if it rejected the request. `errorModel` is empty otherwise.
+         */
+        using OnIpcOperationComplete = std::function<void(int errorCode, const Crt::String &errorModel)>;
+
+        /**
+         * A message of a subscription. `payload` is only valid during the call.
+         */
+        using OnIpcMessage = std::function<void(const Crt::String &topic, const Crt::ByteCursor &payload)>;
+
+        class AWS_DISCOVERY_API GreengrassIpcClientConfig final
+        {
+          public:
+            /**
+             * Reads SocketPath and AuthToken from the environment the core starts components with.
+             */
+            GreengrassIpcClientConfig() noexcept;
+            GreengrassIpcClientConfig(const GreengrassIpcClientConfig &rhs) = default;
+            GreengrassIpcClientConfig(GreengrassIpcClientConfig &&rhs) = default;
+
+            GreengrassIpcClientConfig &operator=(const GreengrassIpcClientConfig &rhs) = default;
+            GreengrassIpcClientConfig &operator=(GreengrassIpcClientConfig &&rhs) = default;
+
+            ~GreengrassIpcClientConfig() = default;
+
+            /**
+             * The core's IPC socket. Defaults to AWS_GG_NUCLEUS_DOMAIN_SOCKET_FILEPATH_FOR_COMPONENT.
+             */
+            Crt::String SocketPath;
+
+            /**
+             * The token the component authenticates with. Defaults to SVCUID.
+             */
+            Crt::String AuthToken;
+        };
+
+        /**
+         * A client of the Greengrass core's local IPC service, for components running on the same host as the
+         * core. It talks to the core over its Unix domain socket in the event stream framing of the IPC
+         * protocol: no TLS handshake, no MQTT session, and no per-message encryption, so a co-located
+         * component moves messages at a fraction of the cost of an MQTT connection to the core.
+         *
+         * Publish and Subscribe use the core's local publish/subscribe; PublishToIotCore and SubscribeToIotCore
+         * relay through the core's own connection to AWS IoT Core. Requests are pipelined: any number may be
+         * outstanding, and each completes when the core answers it.
+         *
+         * Completions and messages are invoked on the client's reader thread, one at a time and in the order
+         * the core sent them; a handler that blocks holds up every other one. A handler may Close the client
+         * or release the last reference to it. Available on POSIX systems; elsewhere Connect fails with
+         * AWS_ERROR_UNSUPPORTED_OPERATION.
+         */
+        class AWS_DISCOVERY_API GreengrassIpcClient final : public std::enable_shared_from_this<GreengrassIpcClient>
+        {
+          public:
+            GreengrassIpcClient(const GreengrassIpcClient &) = delete;
+            GreengrassIpcClient(GreengrassIpcClient &&) = delete;
+            GreengrassIpcClient &operator=(const GreengrassIpcClient &) = delete;
+            GreengrassIpcClient &operator=(GreengrassIpcClient &&) = delete;
+
+            ~GreengrassIpcClient();
+
+            /**
+             * Connects to the core and authenticates, waiting for the core to accept the connection.
+             *
+             * @return false, with the error raised, if the client is connected, or was closed from a handler and
+             * not yet Closed again from another thread (AWS_ERROR_INVALID_STATE), the socket could not be
+             * connected (AWS_ERROR_SYS_CALL_FAILURE) or the core refused the token (AWS_ERROR_NO_PERMISSION).
+             */
+            bool Connect();
+
+            /**
+             * Closes the connection. Outstanding operations and subscriptions complete with
+             * AWS_IO_SOCKET_CLOSED. Called from a handler, it stops the reader and fails what is outstanding,
+             * but the reader thread is joined and the socket released by the next Close from another thread,
+             * or by the destructor.
+             */
+            void Close();
+
+            /**
+             * Publishes `payload` to the local topic, as a binary message.
+             */
+            bool Publish(
+                const Crt::String &topic,
+                const Crt::ByteCursor &payload,
+                const OnIpcOperationComplete &onComplete = OnIpcOperationComplete());
+
+            /**
+             * Subscribes to a local topic, which may contain wildcards. onSubAck is invoked once the core
+             * accepted or rejected the subscription.
+             *
+             * @return the subscription's id, or 0 if the request could not be sent.
+             */
+            int32_t Subscribe(
+                const Crt::String &topic,
+                const OnIpcMessage &onMessage,
+                const OnIpcOperationComplete &onSubAck = OnIpcOperationComplete());
+
+            /**
+             * Publishes `payload` to AWS IoT Core through the core's connection.
+             */
+            bool PublishToIotCore(
+                const Crt::String &topic,
+                Crt::Mqtt::QOS qos,
+                const Crt::ByteCursor &payload,
+                const OnIpcOperationComplete &onComplete = OnIpcOperationComplete());
+
+            /**
+             * Subscribes to an AWS IoT Core topic through the core's connection.
+             *
+             * @return the subscription's id, or 0 if the request could not be sent.
+             */
+            int32_t SubscribeToIotCore(
+                const Crt::String &topic,
+                Crt::Mqtt::QOS qos,
+                const OnIpcMessage &onMessage,
+                const OnIpcOperationComplete &onSubAck = OnIpcOperationComplete());
+
+            /**
+             * Ends a subscription. A message of it the reader thread is handing over already still arrives.
+             */
+            bool Unsubscribe(int32_t subscriptionId);
+
+            static std::shared_ptr<GreengrassIpcClient> Create(
+                const GreengrassIpcClientConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Stream
+            {
+                OnIpcOperationComplete OnResponse;
+                /* Shared, so a message is handed over without copying the handler or holding the lock. */
+                std::shared_ptr<OnIpcMessage> OnMessage;
+                /* Whether the stream's message events carry an IoT Core message or a local one. */
+                bool IotCore = false;
+                bool Responded = false;
+            };
+
+            GreengrassIpcClient(const GreengrassIpcClientConfig &config, Crt::Allocator *allocator) noexcept;
+
+            int32_t StartStream(
+                const char *operation,
+                const char *requestModel,
+                const Crt::String &request,
+                Stream &&stream);
+            bool Send(const Crt::String &frame);
+            static void ReadLoop(const std::weak_ptr<GreengrassIpcClient> &weakClient, int fd);
+            void Dispatch(const Crt::String &frame);
+            void FailAll(int errorCode);
+
+            GreengrassIpcClientConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            int m_fd;
+            std::thread m_reader;
+            std::atomic<bool> m_closing;
+
+            std::mutex m_writeLock;
+            std::mutex m_streamsLock;
+            Crt::Map<int32_t, Stream> m_streams;
+            int32_t m_nextStreamId;
+
+            /* Owned by the reader thread: reused for every message it decodes. */
+            Crt::String m_decoded;
+        };
+    } // namespace Discovery
+} // namespace Aws
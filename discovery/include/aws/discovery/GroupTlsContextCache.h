@@ -0,0 +1,95 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/Exports.h>
+
+#include <aws/crt/Types.h>
+#include <aws/crt/io/TlsOptions.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        class AWS_DISCOVERY_API GroupTlsContextCacheConfig
+        {
+          public:
+            GroupTlsContextCacheConfig() noexcept;
+            GroupTlsContextCacheConfig(const GroupTlsContextCacheConfig &rhs) = default;
+            GroupTlsContextCacheConfig(GroupTlsContextCacheConfig &&rhs) = default;
+
+            GroupTlsContextCacheConfig &operator=(const GroupTlsContextCacheConfig &rhs) = default;
+            GroupTlsContextCacheConfig &operator=(GroupTlsContextCacheConfig &&rhs) = default;
+
+            ~GroupTlsContextCacheConfig() = default;
+
+            /**
+             * The client certificate and private key every context presents.
+             * Required.
+             */
+            Crt::String CertificatePath;
+            Crt::String PrivateKeyPath;
+
+            /**
+             * The most contexts kept. Past it, the least recently used is dropped; connections made from it
+             * keep it alive until they close.
+             */
+            size_t MaxContexts;
+        };
+
+        /**
+         * Client TLS contexts trusting the CAs of a Greengrass group, keyed by the group's CA set. Building a
+         * context loads the client certificate and parses every CA into a trust store, so connecting to the
+         * same group again, or to another group with the same CAs, reuses the context built the first time.
+         * Thread-safe.
+         */
+        class AWS_DISCOVERY_API GroupTlsContextCache final
+        {
+          public:
+            GroupTlsContextCache(const GroupTlsContextCache &) = delete;
+            GroupTlsContextCache(GroupTlsContextCache &&) = delete;
+            GroupTlsContextCache &operator=(const GroupTlsContextCache &) = delete;
+            GroupTlsContextCache &operator=(GroupTlsContextCache &&) = delete;
+
+            ~GroupTlsContextCache() = default;
+
+            /**
+             * Finds or builds the context trusting exactly `cas`, in any order.
+             *
+             * @return false, with the error raised, if a context had to be built and could not be.
+             */
+            bool GetContext(const Crt::Vector<Crt::String> &cas, Crt::Io::TlsContext &context);
+
+            size_t GetCachedCount() const;
+
+            static std::shared_ptr<GroupTlsContextCache> Create(
+                const GroupTlsContextCacheConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Entry
+            {
+                uint64_t Hash = 0;
+                /* Sorted, so a CA set matches whatever order the service lists it in. */
+                Crt::Vector<Crt::String> Cas;
+                Crt::Io::TlsContext Context;
+            };
+
+            GroupTlsContextCache(const GroupTlsContextCacheConfig &config, Crt::Allocator *allocator) noexcept;
+
+            /* Requires m_lock; moves a hit to the front. */
+            bool Find(uint64_t hash, const Crt::Vector<Crt::String> &sortedCas, Crt::Io::TlsContext &context);
+
+            GroupTlsContextCacheConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            /* Most recently used first. */
+            Crt::List<Entry> m_entries;
+        };
+    } // namespace Discovery
+} // namespace Aws
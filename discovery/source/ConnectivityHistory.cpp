@@ -0,0 +1,200 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/ConnectivityHistory.h>
+
+#include <aws/crt/JsonObject.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        namespace
+        {
+            /* Ranks of the three groups Rank orders candidates into. */
+            const int s_rankSucceeded = 0;
+            const int s_rankUntried = 1;
+            const int s_rankFailing = 2;
+        } // namespace
+
+        ConnectivityHistoryConfig::ConnectivityHistoryConfig() noexcept : PersistPath() {}
+
+        ConnectivityHistory::ConnectivityHistory(
+            const ConnectivityHistoryConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_config(config), m_allocator(allocator)
+        {
+        }
+
+        std::shared_ptr<ConnectivityHistory> ConnectivityHistory::Create(
+            const ConnectivityHistoryConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<ConnectivityHistory *>(aws_mem_acquire(allocator, sizeof(ConnectivityHistory)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ConnectivityHistory(config, allocator);
+                std::shared_ptr<ConnectivityHistory> history(
+                    toSeat, [allocator](ConnectivityHistory *doomed) { Crt::Delete(doomed, allocator); });
+                history->Load();
+                return history;
+            }
+
+            return nullptr;
+        }
+
+        Crt::String ConnectivityHistory::Key(const ConnectivityInfo &connectivityInfo)
+        {
+            char port[16];
+            snprintf(port, sizeof(port), ":%d", connectivityInfo.Port ? static_cast<int>(*connectivityInfo.Port) : 0);
+
+            Crt::String key(connectivityInfo.HostAddress ? *connectivityInfo.HostAddress : Crt::String());
+            key.append(port);
+            return key;
+        }
+
+        void ConnectivityHistory::RecordSuccess(const ConnectivityInfo &connectivityInfo, uint64_t latencyMs)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            Entry &entry = m_entries[Key(connectivityInfo)];
+            entry.SmoothedLatencyMs =
+                entry.Successes == 0 ? latencyMs : (entry.SmoothedLatencyMs * 3 + latencyMs) / 4;
+            ++entry.Successes;
+            entry.ConsecutiveFailures = 0;
+            Save();
+        }
+
+        void ConnectivityHistory::RecordFailure(const ConnectivityInfo &connectivityInfo)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            ++m_entries[Key(connectivityInfo)].ConsecutiveFailures;
+            Save();
+        }
+
+        size_t ConnectivityHistory::Rank(Crt::Vector<ConnectivityInfo> &candidates) const
+        {
+            struct Ranked
+            {
+                int Group;
+                uint64_t Order;
+                size_t Index;
+            };
+
+            Crt::Vector<Ranked> ranked;
+            ranked.reserve(candidates.size());
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                for (size_t i = 0; i < candidates.size(); ++i)
+                {
+                    auto entry = m_entries.find(Key(candidates[i]));
+                    if (entry == m_entries.end())
+                    {
+                        ranked.push_back({s_rankUntried, 0, i});
+                    }
+                    else if (entry->second.ConsecutiveFailures == 0)
+                    {
+                        ranked.push_back({s_rankSucceeded, entry->second.SmoothedLatencyMs, i});
+                    }
+                    else
+                    {
+                        ranked.push_back({s_rankFailing, entry->second.ConsecutiveFailures, i});
+                    }
+                }
+            }
+
+            std::stable_sort(ranked.begin(), ranked.end(), [](const Ranked &lhs, const Ranked &rhs) {
+                return lhs.Group != rhs.Group ? lhs.Group < rhs.Group : lhs.Order < rhs.Order;
+            });
+
+            Crt::Vector<ConnectivityInfo> reordered;
+            reordered.reserve(candidates.size());
+            size_t succeeded = 0;
+            for (const Ranked &rank : ranked)
+            {
+                reordered.push_back(std::move(candidates[rank.Index]));
+                succeeded += rank.Group == s_rankSucceeded ? 1 : 0;
+            }
+            candidates.swap(reordered);
+            return succeeded;
+        }
+
+        void ConnectivityHistory::Load()
+        {
+            if (m_config.PersistPath.empty())
+            {
+                return;
+            }
+
+            std::ifstream file(m_config.PersistPath.c_str(), std::ios::in | std::ios::binary);
+            if (!file)
+            {
+                return;
+            }
+
+            std::stringstream contents;
+            contents << file.rdbuf();
+            Crt::JsonObject document(Crt::String(contents.str().c_str()));
+            if (!document.WasParseSuccessful())
+            {
+                /* A corrupt history is not fatal; it is rewritten on the next record. */
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            for (const auto &endpoint : document.View().GetAllObjects())
+            {
+                if (!endpoint.second.ValueExists("latencyMs") || !endpoint.second.ValueExists("successes") ||
+                    !endpoint.second.ValueExists("failures"))
+                {
+                    continue;
+                }
+
+                Entry &entry = m_entries[endpoint.first];
+                entry.SmoothedLatencyMs = static_cast<uint64_t>(endpoint.second.GetInt64("latencyMs"));
+                entry.Successes = static_cast<uint32_t>(endpoint.second.GetInt64("successes"));
+                entry.ConsecutiveFailures = static_cast<uint32_t>(endpoint.second.GetInt64("failures"));
+            }
+        }
+
+        void ConnectivityHistory::Save() const
+        {
+            if (m_config.PersistPath.empty())
+            {
+                return;
+            }
+
+            Crt::JsonObject document;
+            for (const auto &entry : m_entries)
+            {
+                Crt::JsonObject endpoint;
+                endpoint.WithInt64("latencyMs", static_cast<int64_t>(entry.second.SmoothedLatencyMs));
+                endpoint.WithInt64("successes", static_cast<int64_t>(entry.second.Successes));
+                endpoint.WithInt64("failures", static_cast<int64_t>(entry.second.ConsecutiveFailures));
+                document.WithObject(entry.first, std::move(endpoint));
+            }
+            Crt::String serialized = document.View().WriteCompact();
+
+            /* Write a sibling file and rename it over the old one, so a crash never leaves a torn history. */
+            Crt::String tempPath = m_config.PersistPath + ".tmp";
+            {
+                std::ofstream file(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!file)
+                {
+                    return;
+                }
+                file.write(serialized.data(), static_cast<std::streamsize>(serialized.size()));
+                if (!file)
+                {
+                    return;
+                }
+            }
+            std::rename(tempPath.c_str(), m_config.PersistPath.c_str());
+        }
+    } // namespace Discovery
+} // namespace Aws
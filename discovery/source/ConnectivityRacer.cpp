@@ -0,0 +1,353 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/ConnectivityRacer.h>
+
+#include <aws/crt/http/HttpConnection.h>
+
+#include <aws/common/clock.h>
+#include <aws/io/event_loop.h>
+
+#include <mutex>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        namespace
+        {
+            struct RaceContext
+            {
+                RaceContext(
+                    const ConnectivityRacerConfig &config,
+                    const OnConnectivityRaceComplete &onComplete,
+                    Crt::Allocator *allocator)
+                    : Config(config), OnComplete(onComplete), Allocator(allocator)
+                {
+                }
+
+                ConnectivityRacerConfig Config;
+                OnConnectivityRaceComplete OnComplete;
+                Crt::Allocator *Allocator;
+                Crt::Vector<ConnectivityInfo> Candidates;
+                /* High-res clock ticks at which each candidate's probe started, for the history. */
+                Crt::Vector<uint64_t> StartedAt;
+
+                std::mutex Lock;
+                size_t PendingProbes = 0;
+                /* Candidates before this index have been probed; the rest wait out the head start. */
+                size_t Launched = 0;
+                bool Decided = false;
+                int LastError = AWS_ERROR_SUCCESS;
+
+                std::shared_ptr<Crt::Mqtt::MqttConnection> Connection;
+                bool Completed = false;
+            };
+
+            struct HeadStartTask
+            {
+                aws_task Task;
+                std::shared_ptr<RaceContext> Context;
+                Crt::Allocator *Allocator;
+            };
+
+            void s_launchRemaining(const std::shared_ptr<RaceContext> &context);
+
+            void s_fail(const std::shared_ptr<RaceContext> &context, int errorCode)
+            {
+                context->OnComplete(nullptr, nullptr, errorCode, AWS_MQTT_CONNECT_ACCEPTED);
+            }
+
+            /* Connects over the probes' TLS context rather than a freshly loaded one. */
+            Iot::MqttClientConnectionConfig s_sharedTlsConnectionConfig(
+                const ConnectivityRacerConfig &config,
+                const ConnectivityInfo &connectivityInfo)
+            {
+                Crt::Io::TlsContext tlsContext(*config.TlsContext);
+                return Iot::MqttClientConnectionConfig(
+                    *connectivityInfo.HostAddress, *connectivityInfo.Port, config.SocketOptions, std::move(tlsContext));
+            }
+
+            void s_connectToWinner(const std::shared_ptr<RaceContext> &context, size_t winner)
+            {
+                const ConnectivityInfo &connectivityInfo = context->Candidates[winner];
+
+                Iot::MqttClientConnectionConfig connectionConfig =
+                    context->Config.ConnectionConfig ? context->Config.ConnectionConfig(connectivityInfo)
+                                                     : s_sharedTlsConnectionConfig(context->Config, connectivityInfo);
+                if (!connectionConfig)
+                {
+                    s_fail(context, connectionConfig.LastError());
+                    return;
+                }
+
+                std::shared_ptr<Crt::Mqtt::MqttConnection> connection =
+                    context->Config.MqttClient->NewConnection(connectionConfig);
+                if (!connection)
+                {
+                    s_fail(context, context->Config.MqttClient->LastError());
+                    return;
+                }
+
+                /* The connection holds this handler, so the context must not hold the connection once it is
+                 * handed over, or neither would ever be freed. */
+                context->Connection = connection;
+                connection->OnConnectionCompleted = [context, winner](
+                                                        Crt::Mqtt::MqttConnection &,
+                                                        int errorCode,
+                                                        Crt::Mqtt::ReturnCode returnCode,
+                                                        bool) {
+                    std::shared_ptr<Crt::Mqtt::MqttConnection> winningConnection;
+                    {
+                        std::lock_guard<std::mutex> guard(context->Lock);
+                        if (context->Completed)
+                        {
+                            return;
+                        }
+                        context->Completed = true;
+                        winningConnection = std::move(context->Connection);
+                    }
+
+                    context->OnComplete(winningConnection, &context->Candidates[winner], errorCode, returnCode);
+                };
+
+                if (!connection->Connect(
+                        context->Config.ClientId.c_str(),
+                        context->Config.CleanSession,
+                        context->Config.KeepAliveTimeSecs))
+                {
+                    int errorCode = Crt::LastErrorOrUnknown();
+                    connection->OnConnectionCompleted = nullptr;
+                    context->Connection = nullptr;
+                    s_fail(context, errorCode);
+                }
+            }
+
+            void s_onProbeSetup(
+                const std::shared_ptr<RaceContext> &context,
+                size_t candidate,
+                const std::shared_ptr<Crt::Http::HttpClientConnection> &probe,
+                int errorCode)
+            {
+                bool won = false;
+                bool allFailed = false;
+                bool launchRemaining = false;
+                {
+                    std::lock_guard<std::mutex> guard(context->Lock);
+                    --context->PendingProbes;
+                    if (!context->Decided)
+                    {
+                        if (!errorCode)
+                        {
+                            context->Decided = won = true;
+                        }
+                        else
+                        {
+                            context->LastError = errorCode;
+                            context->Decided = allFailed = context->PendingProbes == 0;
+                            /* A failed head start hands over to the other candidates straight away. */
+                            launchRemaining = !allFailed && context->Launched < context->Candidates.size();
+                        }
+                    }
+                }
+
+                /* A probe only proves the endpoint is reachable; the MQTT connection is made separately. */
+                if (!errorCode && probe)
+                {
+                    probe->Close();
+                }
+
+                if (context->Config.History)
+                {
+                    /* Probes that lose the race still tell us how fast their endpoint is. */
+                    const ConnectivityInfo &connectivityInfo = context->Candidates[candidate];
+                    if (!errorCode)
+                    {
+                        uint64_t now = 0;
+                        aws_high_res_clock_get_ticks(&now);
+                        uint64_t latencyMs = aws_timestamp_convert(
+                            now - context->StartedAt[candidate], AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, nullptr);
+                        context->Config.History->RecordSuccess(connectivityInfo, latencyMs);
+                    }
+                    else
+                    {
+                        context->Config.History->RecordFailure(connectivityInfo);
+                    }
+                }
+
+                if (launchRemaining)
+                {
+                    s_launchRemaining(context);
+                }
+
+                if (won)
+                {
+                    s_connectToWinner(context, candidate);
+                }
+                else if (allFailed)
+                {
+                    s_fail(context, context->LastError);
+                }
+            }
+
+            void s_startProbe(const std::shared_ptr<RaceContext> &context, size_t candidate)
+            {
+                const ConnectivityRacerConfig &config = context->Config;
+                const ConnectivityInfo &connectivityInfo = context->Candidates[candidate];
+
+                Crt::Http::HttpClientConnectionOptions probeOptions;
+                probeOptions.Bootstrap = config.Bootstrap;
+                probeOptions.SocketOptions = config.SocketOptions;
+                probeOptions.HostName = *connectivityInfo.HostAddress;
+                probeOptions.Port = *connectivityInfo.Port;
+                if (config.TlsContext)
+                {
+                    Crt::Io::TlsConnectionOptions tlsConnectionOptions = config.TlsContext->NewConnectionOptions();
+                    Crt::ByteCursor serverName = Crt::ByteCursorFromCString(connectivityInfo.HostAddress->c_str());
+                    tlsConnectionOptions.SetServerName(serverName);
+                    probeOptions.TlsOptions = tlsConnectionOptions;
+                }
+                probeOptions.OnConnectionSetupCallback =
+                    [context, candidate](const std::shared_ptr<Crt::Http::HttpClientConnection> &probe, int errorCode) {
+                        s_onProbeSetup(context, candidate, probe, errorCode);
+                    };
+                probeOptions.OnConnectionShutdownCallback = [](Crt::Http::HttpClientConnection &, int) {};
+
+                aws_high_res_clock_get_ticks(&context->StartedAt[candidate]);
+                if (!Crt::Http::HttpClientConnection::CreateConnection(probeOptions, context->Allocator))
+                {
+                    s_onProbeSetup(context, candidate, nullptr, Crt::LastErrorOrUnknown());
+                }
+            }
+
+            /* Probes candidates [from, to). */
+            void s_launch(const std::shared_ptr<RaceContext> &context, size_t from, size_t to)
+            {
+                for (size_t i = from; i < to; ++i)
+                {
+                    s_startProbe(context, i);
+                }
+            }
+
+            void s_launchRemaining(const std::shared_ptr<RaceContext> &context)
+            {
+                size_t from = 0;
+                size_t to = 0;
+                {
+                    std::lock_guard<std::mutex> guard(context->Lock);
+                    if (context->Decided)
+                    {
+                        return;
+                    }
+                    from = context->Launched;
+                    to = context->Launched = context->Candidates.size();
+                }
+
+                s_launch(context, from, to);
+            }
+
+            void s_onHeadStartTask(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *headStartTask = static_cast<HeadStartTask *>(arg);
+                if (status == AWS_TASK_STATUS_RUN_READY)
+                {
+                    s_launchRemaining(headStartTask->Context);
+                }
+
+                Crt::Delete(headStartTask, headStartTask->Allocator);
+            }
+
+            /* Schedules the remaining candidates to be probed once the head start runs out. */
+            bool s_scheduleHeadStart(const std::shared_ptr<RaceContext> &context)
+            {
+                aws_event_loop *eventLoop =
+                    aws_event_loop_group_get_next_loop(context->Config.EventLoopGroup->GetUnderlyingHandle());
+                auto *headStartTask = eventLoop ? Crt::New<HeadStartTask>(context->Allocator) : nullptr;
+                if (!headStartTask)
+                {
+                    return false;
+                }
+
+                headStartTask->Context = context;
+                headStartTask->Allocator = context->Allocator;
+                aws_task_init(&headStartTask->Task, s_onHeadStartTask, headStartTask, "ConnectivityRacerHeadStart");
+
+                uint64_t now = 0;
+                aws_event_loop_current_clock_time(eventLoop, &now);
+                uint64_t headStart = aws_timestamp_convert(
+                    context->Config.PreferredHeadStartMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, nullptr);
+                aws_event_loop_schedule_task_future(eventLoop, &headStartTask->Task, now + headStart);
+                return true;
+            }
+        } // namespace
+
+        ConnectivityRacerConfig::ConnectivityRacerConfig() noexcept
+            : Bootstrap(nullptr), SocketOptions(), TlsContext(), MqttClient(nullptr), ConnectionConfig(), ClientId(),
+              CleanSession(false), KeepAliveTimeSecs(0), History(), EventLoopGroup(nullptr), PreferredHeadStartMs(250)
+        {
+        }
+
+        ConnectivityRacer::ConnectivityRacer(const ConnectivityRacerConfig &config, Crt::Allocator *allocator) noexcept
+            : m_config(config), m_allocator(allocator)
+        {
+            AWS_FATAL_ASSERT(m_config.Bootstrap);
+            AWS_FATAL_ASSERT(m_config.MqttClient);
+            AWS_FATAL_ASSERT(m_config.ConnectionConfig || m_config.TlsContext);
+        }
+
+        std::shared_ptr<ConnectivityRacer> ConnectivityRacer::Create(
+            const ConnectivityRacerConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<ConnectivityRacer *>(aws_mem_acquire(allocator, sizeof(ConnectivityRacer)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ConnectivityRacer(config, allocator);
+                return std::shared_ptr<ConnectivityRacer>(
+                    toSeat, [allocator](ConnectivityRacer *racer) { Crt::Delete(racer, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool ConnectivityRacer::Race(
+            const Crt::Vector<ConnectivityInfo> &candidates,
+            const OnConnectivityRaceComplete &onComplete) noexcept
+        {
+            auto context = Crt::MakeShared<RaceContext>(m_allocator, m_config, onComplete, m_allocator);
+            context->Candidates.reserve(candidates.size());
+            for (const ConnectivityInfo &candidate : candidates)
+            {
+                if (candidate.HostAddress && candidate.Port)
+                {
+                    context->Candidates.push_back(candidate);
+                }
+            }
+
+            if (context->Candidates.empty())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            size_t preferred = m_config.History ? m_config.History->Rank(context->Candidates) : 0;
+            context->StartedAt.resize(context->Candidates.size(), 0);
+
+            /* Counted up front, so an early failure cannot look like the last outstanding probe. */
+            context->PendingProbes = context->Candidates.size();
+            bool headStart = preferred > 0 && context->Candidates.size() > 1 && m_config.EventLoopGroup &&
+                             m_config.PreferredHeadStartMs > 0;
+            size_t launched = headStart ? 1 : context->Candidates.size();
+            context->Launched = launched;
+            if (headStart && !s_scheduleHeadStart(context))
+            {
+                launched = context->Launched = context->Candidates.size();
+            }
+
+            /* The head start task may already be probing the rest, so only the local count is safe here. */
+            s_launch(context, 0, launched);
+            return true;
+        }
+    } // namespace Discovery
+} // namespace Aws
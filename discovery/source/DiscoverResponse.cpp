@@ -14,10 +14,11 @@ namespace Aws
             {
                 auto ggGroupsArray = doc.GetArray("GGGroups");
                 obj.GGGroups = Aws::Crt::Vector<GGGroup>();
+                obj.GGGroups->reserve(ggGroupsArray.size());
 
                 for (auto &ggGroup : ggGroupsArray)
                 {
-                    obj.GGGroups->push_back(ggGroup);
+                    obj.GGGroups->emplace_back(ggGroup);
                 }
             }
         }
@@ -0,0 +1,208 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/DiscoveryCache.h>
+
+#include <aws/crt/JsonObject.h>
+
+#include <aws/common/clock.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        namespace
+        {
+            uint64_t s_nowSeconds()
+            {
+                uint64_t now = 0;
+                aws_sys_clock_get_ticks(&now);
+                return aws_timestamp_convert(now, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, nullptr);
+            }
+        } // namespace
+
+        DiscoveryCacheConfig::DiscoveryCacheConfig() noexcept : TtlSeconds(3600), PersistPath() {}
+
+        DiscoveryCache::DiscoveryCache(const DiscoveryCacheConfig &config, Crt::Allocator *allocator) noexcept
+            : m_config(config), m_allocator(allocator)
+        {
+        }
+
+        std::shared_ptr<DiscoveryCache> DiscoveryCache::Create(
+            const DiscoveryCacheConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<DiscoveryCache *>(aws_mem_acquire(allocator, sizeof(DiscoveryCache)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) DiscoveryCache(config, allocator);
+                std::shared_ptr<DiscoveryCache> cache(
+                    toSeat, [allocator](DiscoveryCache *doomed) { Crt::Delete(doomed, allocator); });
+                cache->Load();
+                return cache;
+            }
+
+            return nullptr;
+        }
+
+        bool DiscoveryCache::Lookup(const Crt::String &thingName, Crt::String &responseBody, bool &stale) const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto entry = m_entries.find(thingName);
+            if (entry == m_entries.end())
+            {
+                return false;
+            }
+
+            uint64_t now = s_nowSeconds();
+            /* A clock that has gone backwards also makes the entry stale. */
+            uint64_t storedAt = entry->second.StoredAtSeconds;
+            stale = now < storedAt || now - storedAt >= m_config.TtlSeconds;
+            responseBody = entry->second.ResponseBody;
+            return true;
+        }
+
+        void DiscoveryCache::Store(
+            const Crt::String &thingName,
+            const Crt::String &responseBody,
+            const Crt::String &eTag,
+            const Crt::String &lastModified)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            Entry &entry = m_entries[thingName];
+            entry.ResponseBody = responseBody;
+            entry.ETag = eTag;
+            entry.LastModified = lastModified;
+            entry.StoredAtSeconds = s_nowSeconds();
+            Save();
+        }
+
+        bool DiscoveryCache::LookupValidators(
+            const Crt::String &thingName,
+            Crt::String &eTag,
+            Crt::String &lastModified) const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto entry = m_entries.find(thingName);
+            if (entry == m_entries.end() || (entry->second.ETag.empty() && entry->second.LastModified.empty()))
+            {
+                return false;
+            }
+
+            eTag = entry->second.ETag;
+            lastModified = entry->second.LastModified;
+            return true;
+        }
+
+        void DiscoveryCache::Touch(const Crt::String &thingName)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto entry = m_entries.find(thingName);
+            if (entry != m_entries.end())
+            {
+                entry->second.StoredAtSeconds = s_nowSeconds();
+                Save();
+            }
+        }
+
+        void DiscoveryCache::Remove(const Crt::String &thingName)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_entries.erase(thingName) > 0)
+            {
+                Save();
+            }
+        }
+
+        void DiscoveryCache::Load()
+        {
+            if (m_config.PersistPath.empty())
+            {
+                return;
+            }
+
+            std::ifstream file(m_config.PersistPath.c_str(), std::ios::in | std::ios::binary);
+            if (!file)
+            {
+                return;
+            }
+
+            std::stringstream contents;
+            contents << file.rdbuf();
+            Crt::JsonObject document(Crt::String(contents.str().c_str()));
+            if (!document.WasParseSuccessful())
+            {
+                /* A corrupt cache is not fatal; it is rewritten on the next Store. */
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            for (const auto &thing : document.View().GetAllObjects())
+            {
+                if (!thing.second.ValueExists("response") || !thing.second.ValueExists("storedAt"))
+                {
+                    continue;
+                }
+
+                Entry &entry = m_entries[thing.first];
+                entry.ResponseBody = thing.second.GetString("response");
+                entry.StoredAtSeconds = static_cast<uint64_t>(thing.second.GetInt64("storedAt"));
+                if (thing.second.ValueExists("eTag"))
+                {
+                    entry.ETag = thing.second.GetString("eTag");
+                }
+                if (thing.second.ValueExists("lastModified"))
+                {
+                    entry.LastModified = thing.second.GetString("lastModified");
+                }
+            }
+        }
+
+        void DiscoveryCache::Save() const
+        {
+            if (m_config.PersistPath.empty())
+            {
+                return;
+            }
+
+            Crt::JsonObject document;
+            for (const auto &entry : m_entries)
+            {
+                Crt::JsonObject thing;
+                thing.WithString("response", entry.second.ResponseBody);
+                thing.WithInt64("storedAt", static_cast<int64_t>(entry.second.StoredAtSeconds));
+                if (!entry.second.ETag.empty())
+                {
+                    thing.WithString("eTag", entry.second.ETag);
+                }
+                if (!entry.second.LastModified.empty())
+                {
+                    thing.WithString("lastModified", entry.second.LastModified);
+                }
+                document.WithObject(entry.first, std::move(thing));
+            }
+            Crt::String serialized = document.View().WriteCompact();
+
+            /* Write a sibling file and rename it over the old one, so a crash never leaves a torn cache. */
+            Crt::String tempPath = m_config.PersistPath + ".tmp";
+            {
+                std::ofstream file(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!file)
+                {
+                    return;
+                }
+                file.write(serialized.data(), static_cast<std::streamsize>(serialized.size()));
+                if (!file)
+                {
+                    return;
+                }
+            }
+            std::rename(tempPath.c_str(), m_config.PersistPath.c_str());
+        }
+    } // namespace Discovery
+} // namespace Aws
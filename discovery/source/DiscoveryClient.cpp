@@ -10,15 +10,173 @@
 #include <aws/crt/io/TlsOptions.h>
 #include <aws/crt/io/Uri.h>
 
+#include <aws/iotdevicecommon/ServiceLog.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/hash_table.h>
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/event_loop.h>
+
+#include <algorithm>
+#include <mutex>
+
 namespace Aws
 {
     namespace Discovery
     {
         DiscoveryClientConfig::DiscoveryClientConfig() noexcept
-            : Bootstrap(nullptr), TlsContext(), SocketOptions(), Region(), MaxConnections(2), ProxyOptions()
+            : Bootstrap(nullptr), TlsContext(), SocketOptions(), Region(), MaxConnections(2), ProxyOptions(),
+              Cache(), ResolutionCache(), OnTimings(), Timeouts()
         {
         }
 
+        struct ClientCallbackContext
+        {
+            Crt::String body;
+            int responseCode;
+            Crt::String eTag;
+            Crt::String lastModified;
+            DiscoverTimings timings;
+            uint64_t phaseStartNs;
+
+            /* The time since the last phase ended, which is now. */
+            uint64_t Lap()
+            {
+                uint64_t now = 0;
+                aws_high_res_clock_get_ticks(&now);
+                uint64_t elapsed = now - phaseStartNs;
+                phaseStartNs = now;
+                return elapsed;
+            }
+        };
+
+        struct DiscoveryClient::KnownResponses
+        {
+            struct Known
+            {
+                uint64_t BodyHash = 0;
+                size_t BodyLength = 0;
+                Crt::String ETag;
+                Crt::String LastModified;
+                DiscoverResponse Response;
+            };
+
+            static uint64_t s_hashBody(const Crt::String &body)
+            {
+                Crt::ByteCursor cursor =
+                    Crt::ByteCursorFromArray(reinterpret_cast<const uint8_t *>(body.data()), body.length());
+                return aws_hash_byte_cursor_ptr(&cursor);
+            }
+
+            bool Validators(const Crt::String &thingName, Crt::String &eTag, Crt::String &lastModified)
+            {
+                std::lock_guard<std::mutex> guard(Lock);
+                auto known = ByThing.find(thingName);
+                if (known == ByThing.end())
+                {
+                    return false;
+                }
+
+                eTag = known->second.ETag;
+                lastModified = known->second.LastModified;
+                return true;
+            }
+
+            void Remember(
+                const Crt::String &thingName,
+                const Crt::String &body,
+                const Crt::String &eTag,
+                const Crt::String &lastModified,
+                const DiscoverResponse &response)
+            {
+                uint64_t bodyHash = s_hashBody(body);
+                std::lock_guard<std::mutex> guard(Lock);
+                Known &known = ByThing[thingName];
+                known.BodyHash = bodyHash;
+                known.BodyLength = body.length();
+                known.ETag = eTag;
+                known.LastModified = lastModified;
+                known.Response = response;
+            }
+
+            /* Handles a 200 or 304 to a discover of thingName. */
+            void Complete(
+                const Crt::String &thingName,
+                ClientCallbackContext &context,
+                const std::shared_ptr<DiscoveryCache> &cache,
+                const OnDiscoverResponse &onDiscoverResponse)
+            {
+                bool notModified = context.responseCode == 304;
+                uint64_t bodyHash = notModified ? 0 : s_hashBody(context.body);
+
+                Crt::Optional<DiscoverResponse> unchanged;
+                {
+                    std::lock_guard<std::mutex> guard(Lock);
+                    auto known = ByThing.find(thingName);
+                    if (known != ByThing.end() &&
+                        (notModified ||
+                         (known->second.BodyLength == context.body.length() && known->second.BodyHash == bodyHash)))
+                    {
+                        if (!context.eTag.empty() || !context.lastModified.empty())
+                        {
+                            known->second.ETag = context.eTag;
+                            known->second.LastModified = context.lastModified;
+                        }
+                        unchanged = known->second.Response;
+                    }
+                }
+
+                if (unchanged)
+                {
+                    if (cache)
+                    {
+                        cache->Touch(thingName);
+                    }
+                    onDiscoverResponse(&*unchanged, AWS_ERROR_SUCCESS, 304);
+                    return;
+                }
+
+                /* A 304 this client has not seen the body for, e.g. after a restart, is served from the cache. */
+                Crt::String body;
+                Crt::String eTag = context.eTag;
+                Crt::String lastModified = context.lastModified;
+                if (notModified)
+                {
+                    bool stale = false;
+                    if (!cache || !cache->Lookup(thingName, body, stale))
+                    {
+                        onDiscoverResponse(nullptr, AWS_ERROR_UNKNOWN, context.responseCode);
+                        return;
+                    }
+                    cache->LookupValidators(thingName, eTag, lastModified);
+                }
+                const Crt::String &responseBody = notModified ? body : context.body;
+
+                Crt::JsonObject jsonObject(responseBody);
+                DiscoverResponse response(jsonObject.View());
+                context.timings.ParseCompleteNs = context.Lap();
+                if (jsonObject.WasParseSuccessful())
+                {
+                    if (cache)
+                    {
+                        if (notModified)
+                        {
+                            cache->Touch(thingName);
+                        }
+                        else
+                        {
+                            cache->Store(thingName, responseBody, eTag, lastModified);
+                        }
+                    }
+                    Remember(thingName, responseBody, eTag, lastModified, response);
+                }
+                onDiscoverResponse(&response, AWS_ERROR_SUCCESS, 200);
+            }
+
+            std::mutex Lock;
+            Crt::Map<Crt::String, Known> ByThing;
+        };
+
         DiscoveryClient::DiscoveryClient(
             const Aws::Discovery::DiscoveryClientConfig &clientConfig,
             Crt::Allocator *allocator) noexcept
@@ -27,9 +185,19 @@ namespace Aws
             AWS_FATAL_ASSERT(clientConfig.Bootstrap);
 
             m_allocator = allocator;
+            m_cache = clientConfig.Cache;
+            m_onTimings = clientConfig.OnTimings;
+            m_timeouts = clientConfig.Timeouts;
+            m_maxConnections = clientConfig.MaxConnections;
+            m_eventLoopGroup = clientConfig.Bootstrap->GetUnderlyingHandle()->event_loop_group;
+            m_known = Crt::MakeShared<KnownResponses>(allocator);
 
-            Crt::StringStream ss;
-            ss << "greengrass-ats.iot." << clientConfig.Region << ".amazonaws.com";
+            m_hostName = "greengrass-ats.iot.";
+            m_hostName.append(clientConfig.Region).append(".amazonaws.com");
+            if (clientConfig.ResolutionCache)
+            {
+                clientConfig.ResolutionCache->Prefetch(m_hostName);
+            }
 
             Crt::Io::TlsConnectionOptions tlsConnectionOptions = clientConfig.TlsContext->NewConnectionOptions();
             uint16_t port = 443;
@@ -43,7 +211,6 @@ namespace Aws
                 port = 8883;
             }
 
-            m_hostName = ss.str();
             Crt::ByteCursor serverName = Crt::ByteCursorFromCString(m_hostName.c_str());
             tlsConnectionOptions.SetServerName(serverName);
 
@@ -81,15 +248,202 @@ namespace Aws
             return nullptr;
         }
 
-        struct ClientCallbackContext
+        namespace
         {
-            Crt::StringStream ss;
-            int responseCode;
+            /* Upper bound on the up-front reservation, so a bogus Content-Length cannot force a huge allocation. */
+            const size_t s_maxBodyReservation = 1024 * 1024;
+
+            void s_captureHeader(const Crt::Http::HttpHeader &header, const char *name, Crt::String &value)
+            {
+                if (aws_byte_cursor_eq_c_str_ignore_case(&header.name, name))
+                {
+                    value.assign(reinterpret_cast<const char *>(header.value.ptr), header.value.len);
+                }
+            }
+
+            bool s_addHeader(Crt::Http::HttpRequest &request, const char *name, const Crt::String &value)
+            {
+                if (value.empty())
+                {
+                    return true;
+                }
+
+                Crt::Http::HttpHeader header;
+                header.name = Crt::ByteCursorFromCString(name);
+                header.value = Crt::ByteCursorFromCString(value.c_str());
+                return request.AddHeader(header);
+            }
+
+            void s_reserveForContentLength(Crt::String &body, const Crt::Http::HttpHeader &header)
+            {
+                if (!aws_byte_cursor_eq_c_str_ignore_case(&header.name, "content-length"))
+                {
+                    return;
+                }
+
+                size_t contentLength = 0;
+                for (size_t i = 0; i < header.value.len; ++i)
+                {
+                    uint8_t digit = header.value.ptr[i];
+                    if (digit < '0' || digit > '9')
+                    {
+                        return;
+                    }
+                    contentLength = std::min(contentLength * 10 + (digit - '0'), s_maxBodyReservation);
+                }
+
+                body.reserve(contentLength);
+            }
+
+            struct TimerTask
+            {
+                aws_task Task;
+                std::function<void()> Fire;
+                Crt::Allocator *Allocator;
+            };
+
+            void s_onTimer(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *timer = static_cast<TimerTask *>(arg);
+                if (status == AWS_TASK_STATUS_RUN_READY)
+                {
+                    timer->Fire();
+                }
+                Crt::Delete(timer, timer->Allocator);
+            }
+
+            void s_scheduleTimer(
+                aws_event_loop_group *eventLoopGroup,
+                uint32_t delayMs,
+                std::function<void()> &&fire,
+                Crt::Allocator *allocator)
+            {
+                auto *timer = Crt::New<TimerTask>(allocator);
+                if (!timer)
+                {
+                    return;
+                }
+
+                timer->Fire = std::move(fire);
+                timer->Allocator = allocator;
+                aws_task_init(&timer->Task, s_onTimer, timer, "DiscoverTimer");
+
+                aws_event_loop *eventLoop = aws_event_loop_group_get_next_loop(eventLoopGroup);
+                uint64_t now = 0;
+                aws_event_loop_current_clock_time(eventLoop, &now);
+                uint64_t delay = aws_timestamp_convert(delayMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+                aws_event_loop_schedule_task_future(eventLoop, &timer->Task, now + delay);
+            }
+        } // namespace
+
+        /* The requests of one bounded Discover; the first to finish it delivers. */
+        struct DiscoverRace
+        {
+            std::mutex Lock;
+            bool Done = false;
+            bool Hedged = false;
+            size_t Outstanding = 0;
+            OnDiscoverResponse OnResponse;
         };
 
         bool DiscoveryClient::Discover(
             const Crt::String &thingName,
             const OnDiscoverResponse &onDiscoverResponse) noexcept
+        {
+            return Discover(thingName, m_timeouts, onDiscoverResponse);
+        }
+
+        bool DiscoveryClient::Discover(
+            const Crt::String &thingName,
+            const DiscoverTimeouts &timeouts,
+            const OnDiscoverResponse &onDiscoverResponse) noexcept
+        {
+            bool hedge = timeouts.HedgeAfterMs > 0 && m_maxConnections > 1 &&
+                         (timeouts.TimeoutMs == 0 || timeouts.HedgeAfterMs < timeouts.TimeoutMs);
+            if (timeouts.TimeoutMs == 0 && !hedge)
+            {
+                return StartAttempt(thingName, onDiscoverResponse);
+            }
+
+            auto race = Crt::MakeShared<DiscoverRace>(m_allocator);
+            if (!race)
+            {
+                return false;
+            }
+            race->Outstanding = 1;
+            race->OnResponse = onDiscoverResponse;
+
+            /* A failure only finishes the Discover once no other request can still succeed. */
+            OnDiscoverResponse onAttempt = [race](DiscoverResponse *response, int errorCode, int httpResponseCode) {
+                {
+                    std::lock_guard<std::mutex> guard(race->Lock);
+                    --race->Outstanding;
+                    if (race->Done || (errorCode != AWS_ERROR_SUCCESS && race->Outstanding > 0))
+                    {
+                        return;
+                    }
+                    race->Done = true;
+                }
+                race->OnResponse(response, errorCode, httpResponseCode);
+            };
+
+            if (!StartAttempt(thingName, onAttempt))
+            {
+                return false;
+            }
+
+            if (hedge)
+            {
+                s_scheduleTimer(
+                    m_eventLoopGroup,
+                    timeouts.HedgeAfterMs,
+                    [this, race, thingName, onAttempt]() {
+                        {
+                            std::lock_guard<std::mutex> guard(race->Lock);
+                            if (race->Done || race->Hedged)
+                            {
+                                return;
+                            }
+                            race->Hedged = true;
+                            ++race->Outstanding;
+                        }
+                        AWS_IOTDEVICE_LOG_DEBUG(
+                            Iotdevicecommon::LogSubsystem::Discovery, "discover hedged", {{"thing", thingName}});
+                        if (!StartAttempt(thingName, onAttempt))
+                        {
+                            onAttempt(nullptr, Crt::LastErrorOrUnknown(), 0);
+                        }
+                    },
+                    m_allocator);
+            }
+
+            if (timeouts.TimeoutMs > 0)
+            {
+                s_scheduleTimer(
+                    m_eventLoopGroup,
+                    timeouts.TimeoutMs,
+                    [race, thingName]() {
+                        {
+                            std::lock_guard<std::mutex> guard(race->Lock);
+                            if (race->Done)
+                            {
+                                return;
+                            }
+                            race->Done = true;
+                        }
+                        AWS_IOTDEVICE_LOG_WARN(
+                            Iotdevicecommon::LogSubsystem::Discovery, "discover timed out", {{"thing", thingName}});
+                        race->OnResponse(nullptr, AWS_IO_SOCKET_TIMEOUT, 0);
+                    },
+                    m_allocator);
+            }
+
+            return true;
+        }
+
+        bool DiscoveryClient::StartAttempt(
+            const Crt::String &thingName,
+            const OnDiscoverResponse &onDiscoverResponse) noexcept
         {
             auto callbackContext = Crt::MakeShared<ClientCallbackContext>(m_allocator);
             if (!callbackContext)
@@ -98,13 +452,30 @@ namespace Aws
             }
 
             callbackContext->responseCode = 0;
+            callbackContext->phaseStartNs = 0;
+            callbackContext->Lap();
 
+            std::shared_ptr<KnownResponses> known = m_known;
+            OnDiscoverTimings onTimings = m_onTimings;
+            AWS_IOTDEVICE_LOG_DEBUG(
+                Iotdevicecommon::LogSubsystem::Discovery,
+                "discover",
+                {{"thing", thingName}, {"conditional", known != nullptr}});
             bool res = m_connectionManager->AcquireConnection(
-                [this, callbackContext, thingName, onDiscoverResponse](
+                [this, callbackContext, known, thingName, onDiscoverResponse, onTimings](
                     std::shared_ptr<Crt::Http::HttpClientConnection> connection, int errorCode) {
+                    callbackContext->timings.ConnectionAcquireNs = callbackContext->Lap();
                     if (errorCode)
                     {
+                        AWS_IOTDEVICE_LOG_WARN(
+                            Iotdevicecommon::LogSubsystem::Discovery,
+                            "connection failed",
+                            {{"thing", thingName}, {"error", aws_error_name(errorCode)}});
                         onDiscoverResponse(nullptr, errorCode, 0);
+                        if (onTimings)
+                        {
+                            onTimings(thingName, callbackContext->timings);
+                        }
                         return;
                     }
 
@@ -115,9 +486,8 @@ namespace Aws
                         return;
                     }
 
-                    Crt::StringStream ss;
-                    ss << "/greengrass/discover/thing/" << thingName;
-                    Crt::String uriStr = ss.str();
+                    Crt::String uriStr("/greengrass/discover/thing/");
+                    uriStr.append(thingName);
                     if (!request->SetMethod(Crt::ByteCursorFromCString("GET")))
                     {
                         onDiscoverResponse(nullptr, Crt::LastErrorOrUnknown(), 0);
@@ -140,43 +510,87 @@ namespace Aws
                         return;
                     }
 
+                    Crt::String eTag;
+                    Crt::String lastModified;
+                    if (known && !known->Validators(thingName, eTag, lastModified) && m_cache)
+                    {
+                        m_cache->LookupValidators(thingName, eTag, lastModified);
+                    }
+                    if (!s_addHeader(*request, "if-none-match", eTag) ||
+                        !s_addHeader(*request, "if-modified-since", lastModified))
+                    {
+                        onDiscoverResponse(nullptr, Crt::LastErrorOrUnknown(), 0);
+                        return;
+                    }
+
                     Crt::Http::HttpRequestOptions requestOptions;
                     requestOptions.request = request.get();
-                    requestOptions.onIncomingHeaders =
-                        [](Crt::Http::HttpStream &, aws_http_header_block, const Crt::Http::HttpHeader *, std::size_t) {
-                        };
+                    requestOptions.onIncomingHeaders = [callbackContext](
+                                                           Crt::Http::HttpStream &,
+                                                           aws_http_header_block,
+                                                           const Crt::Http::HttpHeader *headers,
+                                                           std::size_t headersCount) {
+                        for (std::size_t i = 0; i < headersCount; ++i)
+                        {
+                            s_reserveForContentLength(callbackContext->body, headers[i]);
+                            s_captureHeader(headers[i], "etag", callbackContext->eTag);
+                            s_captureHeader(headers[i], "last-modified", callbackContext->lastModified);
+                        }
+                    };
                     requestOptions.onIncomingHeadersBlockDone =
-                        [callbackContext](Crt::Http::HttpStream &stream, aws_http_header_block) {
+                        [callbackContext](Crt::Http::HttpStream &stream, aws_http_header_block block) {
                             callbackContext->responseCode = stream.GetResponseStatusCode();
+                            if (block == AWS_HTTP_HEADER_BLOCK_MAIN)
+                            {
+                                callbackContext->timings.HeadersReceivedNs = callbackContext->Lap();
+                            }
                         };
                     requestOptions.onIncomingBody =
                         [callbackContext](Crt::Http::HttpStream &, const Crt::ByteCursor &data) {
-                            callbackContext->ss.write(reinterpret_cast<const char *>(data.ptr), data.len);
+                            callbackContext->body.append(reinterpret_cast<const char *>(data.ptr), data.len);
                         };
-                    requestOptions.onStreamComplete = [request, connection, callbackContext, onDiscoverResponse](
-                                                          Crt::Http::HttpStream &, int errorCode) {
-                        if (!errorCode && callbackContext->responseCode == 200)
-                        {
-                            Crt::JsonObject jsonObject(callbackContext->ss.str());
-                            DiscoverResponse response(jsonObject.View());
-                            onDiscoverResponse(&response, AWS_ERROR_SUCCESS, callbackContext->responseCode);
-                        }
-                        else
-                        {
-                            if (!errorCode)
+                    std::shared_ptr<DiscoveryCache> cache = m_cache;
+                    requestOptions.onStreamComplete =
+                        [request, connection, callbackContext, onDiscoverResponse, cache, known, thingName, onTimings](
+                            Crt::Http::HttpStream &, int errorCode) {
+                            callbackContext->timings.BodyCompleteNs = callbackContext->Lap();
+                            int responseCode = callbackContext->responseCode;
+                            AWS_IOTDEVICE_LOG(
+                                errorCode || (responseCode != 200 && responseCode != 304) ? Crt::LogLevel::Warn
+                                                                                           : Crt::LogLevel::Debug,
+                                Iotdevicecommon::LogSubsystem::Discovery,
+                                "discover complete",
+                                {{"thing", thingName},
+                                 {"status", responseCode},
+                                 {"bytes", callbackContext->body.size()},
+                                 {"error", aws_error_name(errorCode)}});
+                            if (!errorCode && known && (responseCode == 200 || responseCode == 304))
                             {
-                                errorCode = AWS_ERROR_UNKNOWN;
+                                known->Complete(thingName, *callbackContext, cache, onDiscoverResponse);
                             }
-                            onDiscoverResponse(nullptr, errorCode, callbackContext->responseCode);
-                        }
-                    };
+                            else
+                            {
+                                if (!errorCode)
+                                {
+                                    errorCode = AWS_ERROR_UNKNOWN;
+                                }
+                                onDiscoverResponse(nullptr, errorCode, callbackContext->responseCode);
+                            }
+                            if (onTimings)
+                            {
+                                onTimings(thingName, callbackContext->timings);
+                            }
+                        };
 
                     auto stream = connection->NewClientStream(requestOptions);
                     if (!stream)
                     {
                         onDiscoverResponse(nullptr, Crt::LastErrorOrUnknown(), 0);
+                        return;
                     }
 
+                    /* Laps before activating, since the response can complete on another thread straight away. */
+                    callbackContext->timings.RequestSentNs = callbackContext->Lap();
                     if (!stream->Activate())
                     {
                         onDiscoverResponse(nullptr, Crt::LastErrorOrUnknown(), 0);
@@ -190,5 +604,121 @@ namespace Aws
 
             return true;
         }
+
+        struct DiscoverManyContext
+        {
+            std::mutex lock;
+            Crt::Map<Crt::String, DiscoverResult> results;
+            size_t remaining;
+            OnDiscoverManyComplete onComplete;
+        };
+
+        bool DiscoveryClient::DiscoverMany(
+            const Crt::Vector<Crt::String> &thingNames,
+            const OnDiscoverManyComplete &onComplete) noexcept
+        {
+            auto context = Crt::MakeShared<DiscoverManyContext>(m_allocator);
+            if (!context)
+            {
+                return false;
+            }
+
+            for (const Crt::String &thingName : thingNames)
+            {
+                context->results[thingName];
+            }
+            context->remaining = context->results.size();
+            context->onComplete = onComplete;
+
+            if (context->remaining == 0)
+            {
+                onComplete(context->results);
+                return true;
+            }
+
+            auto record = [context](const Crt::String &thingName, DiscoverResponse *response, int errorCode, int code) {
+                bool done = false;
+                {
+                    std::lock_guard<std::mutex> lock(context->lock);
+                    DiscoverResult &result = context->results[thingName];
+                    if (response)
+                    {
+                        result.Response = *response;
+                    }
+                    result.ErrorCode = errorCode;
+                    result.HttpResponseCode = code;
+                    done = --context->remaining == 0;
+                }
+
+                if (done)
+                {
+                    context->onComplete(context->results);
+                }
+            };
+
+            /* Iterate a copy: results is written by completions that may already be running. */
+            Crt::Vector<Crt::String> distinctNames;
+            for (const auto &entry : context->results)
+            {
+                distinctNames.push_back(entry.first);
+            }
+
+            for (const Crt::String &thingName : distinctNames)
+            {
+                auto onDiscoverResponse = [record, thingName](DiscoverResponse *response, int errorCode, int code) {
+                    record(thingName, response, errorCode, code);
+                };
+                if (!Discover(thingName, onDiscoverResponse))
+                {
+                    record(thingName, nullptr, Crt::LastErrorOrUnknown(), 0);
+                }
+            }
+
+            return true;
+        }
+
+        bool DiscoveryClient::DiscoverCached(
+            const Crt::String &thingName,
+            const OnDiscoverResponse &onDiscoverResponse,
+            const OnDiscoverResponse &onRefreshed) noexcept
+        {
+            Crt::String cachedBody;
+            bool stale = false;
+            if (!m_cache || !m_cache->Lookup(thingName, cachedBody, stale))
+            {
+                return Discover(thingName, onDiscoverResponse);
+            }
+
+            Crt::JsonObject jsonObject(cachedBody);
+            if (!jsonObject.WasParseSuccessful())
+            {
+                m_cache->Remove(thingName);
+                return Discover(thingName, onDiscoverResponse);
+            }
+
+            DiscoverResponse response(jsonObject.View());
+            if (m_known)
+            {
+                /* So that a refresh confirming this response reports it unchanged. */
+                Crt::String eTag;
+                Crt::String lastModified;
+                m_cache->LookupValidators(thingName, eTag, lastModified);
+                m_known->Remember(thingName, cachedBody, eTag, lastModified, response);
+            }
+            onDiscoverResponse(&response, AWS_ERROR_SUCCESS, 0);
+
+            if (stale)
+            {
+                OnDiscoverResponse onRefreshComplete = onRefreshed;
+                if (!onRefreshComplete)
+                {
+                    onRefreshComplete = [](DiscoverResponse *, int, int) {};
+                }
+                /* A failed refresh keeps the stale entry, which is still the best guess. */
+                Discover(thingName, onRefreshComplete);
+            }
+
+            return true;
+        }
     } // namespace Discovery
 } // namespace Aws
@@ -0,0 +1,254 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/EndpointResolutionCache.h>
+
+#include <aws/common/array_list.h>
+#include <aws/common/clock.h>
+#include <aws/common/string.h>
+#include <aws/common/task_scheduler.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        struct EndpointResolutionCache::Callbacks
+        {
+            struct ResolveRequest
+            {
+                std::weak_ptr<EndpointResolutionCache> Cache;
+                Crt::Allocator *Allocator;
+            };
+
+            struct RefreshTask
+            {
+                aws_task Task;
+                std::weak_ptr<EndpointResolutionCache> Cache;
+                Crt::Allocator *Allocator;
+            };
+
+            static void s_onResolved(
+                aws_host_resolver *,
+                const aws_string *hostName,
+                int errorCode,
+                const aws_array_list *hostAddresses,
+                void *userData)
+            {
+                auto *request = static_cast<ResolveRequest *>(userData);
+                auto cache = request->Cache.lock();
+                Crt::Delete(request, request->Allocator);
+                if (!cache)
+                {
+                    return;
+                }
+
+                Crt::Vector<Crt::String> addresses;
+                if (errorCode == AWS_ERROR_SUCCESS && hostAddresses)
+                {
+                    size_t count = aws_array_list_length(hostAddresses);
+                    addresses.reserve(count);
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        aws_host_address *address = nullptr;
+                        aws_array_list_get_at_ptr(hostAddresses, reinterpret_cast<void **>(&address), i);
+                        addresses.emplace_back(aws_string_c_str(address->address), address->address->len);
+                    }
+                }
+
+                cache->OnResolved(
+                    Crt::String(aws_string_c_str(hostName), hostName->len), errorCode, std::move(addresses));
+            }
+
+            static void s_onRefreshTask(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *refreshTask = static_cast<RefreshTask *>(arg);
+                auto cache = refreshTask->Cache.lock();
+                Crt::Delete(refreshTask, refreshTask->Allocator);
+
+                /* A cancelled task means the event loop is shutting down, so refreshing stops with it. */
+                if (cache && status == AWS_TASK_STATUS_RUN_READY)
+                {
+                    cache->Refresh();
+                }
+            }
+        };
+
+        EndpointResolutionCacheConfig::EndpointResolutionCacheConfig() noexcept
+            : HostResolver(nullptr), EventLoopGroup(nullptr), RefreshIntervalMs(30000), TtlSeconds(3600)
+        {
+        }
+
+        EndpointResolutionCache::EndpointResolutionCache(
+            const EndpointResolutionCacheConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_config(config), m_allocator(allocator), m_refreshScheduled(false), m_failedResolutions(0)
+        {
+        }
+
+        std::shared_ptr<EndpointResolutionCache> EndpointResolutionCache::Create(
+            const EndpointResolutionCacheConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (!config.HostResolver || !config.EventLoopGroup)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat =
+                static_cast<EndpointResolutionCache *>(aws_mem_acquire(allocator, sizeof(EndpointResolutionCache)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) EndpointResolutionCache(config, allocator);
+                return std::shared_ptr<EndpointResolutionCache>(
+                    toSeat, [allocator](EndpointResolutionCache *cache) { Crt::Delete(cache, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool EndpointResolutionCache::Prefetch(const Crt::String &host)
+        {
+            bool startRefreshing = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_entries.emplace(host, Entry());
+                startRefreshing = !m_refreshScheduled;
+                m_refreshScheduled = true;
+            }
+
+            if (startRefreshing && !ScheduleRefresh())
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_refreshScheduled = false;
+            }
+
+            return Resolve(host);
+        }
+
+        bool EndpointResolutionCache::Lookup(
+            const Crt::String &host,
+            Crt::Vector<Crt::String> &addresses,
+            bool &stale) const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto entry = m_entries.find(host);
+            if (entry == m_entries.end() || entry->second.ResolvedAtNs == 0)
+            {
+                return false;
+            }
+
+            uint64_t now = 0;
+            aws_high_res_clock_get_ticks(&now);
+            uint64_t ttlNs =
+                aws_timestamp_convert(m_config.TtlSeconds, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, nullptr);
+            addresses = entry->second.Addresses;
+            stale = now - entry->second.ResolvedAtNs > ttlNs;
+            return true;
+        }
+
+        uint64_t EndpointResolutionCache::GetFailedResolutionCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_failedResolutions;
+        }
+
+        bool EndpointResolutionCache::Resolve(const Crt::String &host)
+        {
+            /* The resolver copies the host name, so it can go as soon as the request is queued. */
+            aws_string *hostName = aws_string_new_from_c_str(m_allocator, host.c_str());
+            auto *request = hostName ? Crt::New<Callbacks::ResolveRequest>(m_allocator) : nullptr;
+            if (!request)
+            {
+                aws_string_destroy(hostName);
+                return false;
+            }
+
+            request->Cache = shared_from_this();
+            request->Allocator = m_allocator;
+            int result = aws_host_resolver_resolve_host(
+                m_config.HostResolver->GetUnderlyingHandle(),
+                hostName,
+                Callbacks::s_onResolved,
+                m_config.HostResolver->GetConfig(),
+                request);
+            aws_string_destroy(hostName);
+
+            if (result != AWS_OP_SUCCESS)
+            {
+                Crt::Delete(request, m_allocator);
+                return false;
+            }
+            return true;
+        }
+
+        void EndpointResolutionCache::OnResolved(
+            const Crt::String &host,
+            int errorCode,
+            Crt::Vector<Crt::String> &&addresses)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (errorCode != AWS_ERROR_SUCCESS || addresses.empty())
+            {
+                /* Whatever resolved last stays in place as the last-known-good addresses. */
+                ++m_failedResolutions;
+                return;
+            }
+
+            Entry &entry = m_entries[host];
+            entry.Addresses = std::move(addresses);
+            aws_high_res_clock_get_ticks(&entry.ResolvedAtNs);
+        }
+
+        bool EndpointResolutionCache::ScheduleRefresh()
+        {
+            aws_event_loop *eventLoop =
+                aws_event_loop_group_get_next_loop(m_config.EventLoopGroup->GetUnderlyingHandle());
+            auto *refreshTask = eventLoop ? Crt::New<Callbacks::RefreshTask>(m_allocator) : nullptr;
+            if (!refreshTask)
+            {
+                return false;
+            }
+
+            refreshTask->Cache = shared_from_this();
+            refreshTask->Allocator = m_allocator;
+            aws_task_init(&refreshTask->Task, Callbacks::s_onRefreshTask, refreshTask, "EndpointResolutionRefresh");
+
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(eventLoop, &now);
+            uint64_t interval =
+                aws_timestamp_convert(m_config.RefreshIntervalMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, nullptr);
+            aws_event_loop_schedule_task_future(eventLoop, &refreshTask->Task, now + interval);
+            return true;
+        }
+
+        void EndpointResolutionCache::Refresh()
+        {
+            Crt::Vector<Crt::String> hosts;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                hosts.reserve(m_entries.size());
+                for (const auto &entry : m_entries)
+                {
+                    hosts.push_back(entry.first);
+                }
+            }
+
+            for (const Crt::String &host : hosts)
+            {
+                if (!Resolve(host))
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    ++m_failedResolutions;
+                }
+            }
+
+            bool scheduled = ScheduleRefresh();
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_refreshScheduled = scheduled;
+        }
+    } // namespace Discovery
+} // namespace Aws
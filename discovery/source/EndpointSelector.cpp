@@ -0,0 +1,420 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/EndpointSelector.h>
+
+#include <aws/crt/http/HttpConnection.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/task_scheduler.h>
+#include <aws/io/event_loop.h>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        namespace
+        {
+            const uint64_t s_noAnswer = UINT64_MAX;
+
+            bool s_sameEndpoint(const ConnectivityInfo &lhs, const ConnectivityInfo &rhs)
+            {
+                return *lhs.HostAddress == *rhs.HostAddress && *lhs.Port == *rhs.Port;
+            }
+        } // namespace
+
+        struct EndpointSelector::Evaluation
+        {
+            explicit Evaluation(Crt::Allocator *allocator) : Allocator(allocator) {}
+
+            Crt::Allocator *Allocator;
+            std::shared_ptr<EndpointSelector> Selector;
+            Crt::Vector<ConnectivityInfo> Candidates;
+            /* High-res clock ticks at which each candidate's probe started. */
+            Crt::Vector<uint64_t> StartedAt;
+            /* Each candidate's connect latency, or s_noAnswer. */
+            Crt::Vector<uint64_t> LatencyMs;
+
+            std::mutex Lock;
+            size_t PendingProbes = 0;
+            int LastError = AWS_ERROR_SUCCESS;
+        };
+
+        struct EndpointSelector::ReevaluateTask
+        {
+            aws_task Task;
+            std::weak_ptr<EndpointSelector> Selector;
+            uint64_t Generation;
+            Crt::Allocator *Allocator;
+
+            static void s_run(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *reevaluateTask = static_cast<ReevaluateTask *>(arg);
+                auto selector = reevaluateTask->Selector.lock();
+                uint64_t generation = reevaluateTask->Generation;
+                Crt::Delete(reevaluateTask, reevaluateTask->Allocator);
+
+                if (selector && status == AWS_TASK_STATUS_RUN_READY)
+                {
+                    selector->OnReevaluate(generation);
+                }
+            }
+        };
+
+        EndpointSelectorConfig::EndpointSelectorConfig() noexcept
+            : Candidates(), Bootstrap(nullptr), SocketOptions(), TlsContext(), History(), EventLoopGroup(nullptr),
+              ReevaluateIntervalMs(300000), SwitchMarginMs(20), OnSelected()
+        {
+        }
+
+        EndpointSelector::EndpointSelector(const EndpointSelectorConfig &config, Crt::Allocator *allocator) noexcept
+            : m_config(config), m_allocator(allocator), m_candidates(config.Candidates), m_selected(),
+              m_evaluating(false), m_running(false), m_generation(0)
+        {
+            AWS_FATAL_ASSERT(m_config.Bootstrap);
+        }
+
+        std::shared_ptr<EndpointSelector> EndpointSelector::Create(
+            const EndpointSelectorConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<EndpointSelector *>(aws_mem_acquire(allocator, sizeof(EndpointSelector)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) EndpointSelector(config, allocator);
+                return std::shared_ptr<EndpointSelector>(
+                    toSeat, [allocator](EndpointSelector *selector) { Crt::Delete(selector, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        Crt::Vector<ConnectivityInfo> EndpointSelector::CandidatesOf(
+            const Crt::Vector<Crt::String> &endpoints,
+            uint16_t port)
+        {
+            Crt::Vector<ConnectivityInfo> candidates;
+            candidates.reserve(endpoints.size());
+            for (const Crt::String &endpoint : endpoints)
+            {
+                ConnectivityInfo candidate;
+                candidate.ID = endpoint;
+                candidate.HostAddress = endpoint;
+                candidate.Port = port;
+                candidates.push_back(std::move(candidate));
+            }
+            return candidates;
+        }
+
+        Crt::Vector<ConnectivityInfo> EndpointSelector::CandidatesOf(const DiscoverResponse &response)
+        {
+            Crt::Vector<ConnectivityInfo> candidates;
+            if (!response.GGGroups)
+            {
+                return candidates;
+            }
+
+            for (const GGGroup &group : *response.GGGroups)
+            {
+                if (!group.Cores)
+                {
+                    continue;
+                }
+                for (const GGCore &core : *group.Cores)
+                {
+                    if (core.Connectivity)
+                    {
+                        candidates.insert(candidates.end(), core.Connectivity->begin(), core.Connectivity->end());
+                    }
+                }
+            }
+            return candidates;
+        }
+
+        void EndpointSelector::SetCandidates(const Crt::Vector<ConnectivityInfo> &candidates)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_candidates = candidates;
+        }
+
+        Crt::Optional<ConnectivityInfo> EndpointSelector::GetSelected() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_selected;
+        }
+
+        bool EndpointSelector::ApplyTo(Iot::MqttClientConnectionConfigBuilder &builder) const
+        {
+            Crt::Optional<ConnectivityInfo> selected = GetSelected();
+            if (!selected)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return false;
+            }
+
+            builder.WithEndpoint(*selected->HostAddress);
+            builder.WithPortOverride(*selected->Port);
+            return true;
+        }
+
+        bool EndpointSelector::Evaluate() noexcept
+        {
+            auto evaluation = Crt::MakeShared<Evaluation>(m_allocator, m_allocator);
+            if (!evaluation)
+            {
+                return false;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_evaluating)
+                {
+                    return true;
+                }
+
+                for (const ConnectivityInfo &candidate : m_candidates)
+                {
+                    if (candidate.HostAddress && candidate.Port)
+                    {
+                        evaluation->Candidates.push_back(candidate);
+                    }
+                }
+                if (evaluation->Candidates.empty())
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                    return false;
+                }
+                m_evaluating = true;
+            }
+
+            evaluation->Selector = shared_from_this();
+            evaluation->StartedAt.resize(evaluation->Candidates.size(), 0);
+            evaluation->LatencyMs.resize(evaluation->Candidates.size(), s_noAnswer);
+            /* Counted up front, so an early failure cannot look like the last outstanding probe. */
+            evaluation->PendingProbes = evaluation->Candidates.size();
+            for (size_t i = 0; i < evaluation->Candidates.size(); ++i)
+            {
+                StartProbe(evaluation, i);
+            }
+            return true;
+        }
+
+        void EndpointSelector::StartProbe(const std::shared_ptr<Evaluation> &evaluation, size_t candidate)
+        {
+            const ConnectivityInfo &connectivityInfo = evaluation->Candidates[candidate];
+
+            Crt::Http::HttpClientConnectionOptions probeOptions;
+            probeOptions.Bootstrap = m_config.Bootstrap;
+            probeOptions.SocketOptions = m_config.SocketOptions;
+            probeOptions.HostName = *connectivityInfo.HostAddress;
+            probeOptions.Port = *connectivityInfo.Port;
+            if (m_config.TlsContext)
+            {
+                Crt::Io::TlsConnectionOptions tlsConnectionOptions = m_config.TlsContext->NewConnectionOptions();
+                Crt::ByteCursor serverName = Crt::ByteCursorFromCString(connectivityInfo.HostAddress->c_str());
+                tlsConnectionOptions.SetServerName(serverName);
+                probeOptions.TlsOptions = tlsConnectionOptions;
+            }
+            probeOptions.OnConnectionSetupCallback =
+                [evaluation, candidate](const std::shared_ptr<Crt::Http::HttpClientConnection> &probe, int errorCode) {
+                    /* A probe only measures the connect; nothing is sent over it. */
+                    if (!errorCode && probe)
+                    {
+                        probe->Close();
+                    }
+                    evaluation->Selector->OnProbeDone(evaluation, candidate, errorCode);
+                };
+            probeOptions.OnConnectionShutdownCallback = [](Crt::Http::HttpClientConnection &, int) {};
+
+            aws_high_res_clock_get_ticks(&evaluation->StartedAt[candidate]);
+            if (!Crt::Http::HttpClientConnection::CreateConnection(probeOptions, m_allocator))
+            {
+                OnProbeDone(evaluation, candidate, Crt::LastErrorOrUnknown());
+            }
+        }
+
+        void EndpointSelector::OnProbeDone(
+            const std::shared_ptr<Evaluation> &evaluation,
+            size_t candidate,
+            int errorCode)
+        {
+            const ConnectivityInfo &connectivityInfo = evaluation->Candidates[candidate];
+            uint64_t latencyMs = 0;
+            if (!errorCode)
+            {
+                uint64_t now = 0;
+                aws_high_res_clock_get_ticks(&now);
+                latencyMs = aws_timestamp_convert(
+                    now - evaluation->StartedAt[candidate], AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, nullptr);
+            }
+
+            if (m_config.History)
+            {
+                if (!errorCode)
+                {
+                    m_config.History->RecordSuccess(connectivityInfo, latencyMs);
+                }
+                else
+                {
+                    m_config.History->RecordFailure(connectivityInfo);
+                }
+            }
+
+            bool last = false;
+            {
+                std::lock_guard<std::mutex> guard(evaluation->Lock);
+                if (!errorCode)
+                {
+                    evaluation->LatencyMs[candidate] = latencyMs;
+                }
+                else
+                {
+                    evaluation->LastError = errorCode;
+                }
+                last = --evaluation->PendingProbes == 0;
+            }
+
+            if (last)
+            {
+                Complete(*evaluation);
+                /* Breaks the cycle through the probes' callbacks. */
+                evaluation->Selector = nullptr;
+            }
+        }
+
+        void EndpointSelector::Complete(const Evaluation &evaluation)
+        {
+            size_t fastest = evaluation.Candidates.size();
+            for (size_t i = 0; i < evaluation.Candidates.size(); ++i)
+            {
+                bool faster = fastest == evaluation.Candidates.size() ||
+                              evaluation.LatencyMs[i] < evaluation.LatencyMs[fastest];
+                if (evaluation.LatencyMs[i] != s_noAnswer && faster)
+                {
+                    fastest = i;
+                }
+            }
+
+            ConnectivityInfo selected;
+            bool hasSelected = false;
+            bool changed = false;
+            int errorCode = AWS_ERROR_SUCCESS;
+            uint64_t generation = 0;
+            bool scheduleNext = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_evaluating = false;
+                if (fastest == evaluation.Candidates.size())
+                {
+                    errorCode = evaluation.LastError;
+                }
+                else
+                {
+                    /* The selected endpoint keeps its place while it answers within the margin of the best. */
+                    uint64_t selectedLatencyMs = s_noAnswer;
+                    for (size_t i = 0; m_selected && i < evaluation.Candidates.size(); ++i)
+                    {
+                        if (s_sameEndpoint(evaluation.Candidates[i], *m_selected))
+                        {
+                            selectedLatencyMs = evaluation.LatencyMs[i];
+                        }
+                    }
+
+                    if (selectedLatencyMs == s_noAnswer ||
+                        selectedLatencyMs > evaluation.LatencyMs[fastest] + m_config.SwitchMarginMs)
+                    {
+                        changed = !m_selected || !s_sameEndpoint(evaluation.Candidates[fastest], *m_selected);
+                        m_selected = evaluation.Candidates[fastest];
+                    }
+                }
+                if (m_selected)
+                {
+                    selected = *m_selected;
+                    hasSelected = true;
+                }
+                generation = m_generation;
+                scheduleNext = m_running;
+            }
+
+            if (m_config.OnSelected)
+            {
+                m_config.OnSelected(hasSelected ? &selected : nullptr, changed, errorCode);
+            }
+
+            if (scheduleNext)
+            {
+                ScheduleNext(generation);
+            }
+        }
+
+        bool EndpointSelector::Start() noexcept
+        {
+            if (!m_config.EventLoopGroup)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_running = true;
+                ++m_generation;
+            }
+
+            if (!Evaluate())
+            {
+                Stop();
+                return false;
+            }
+            return true;
+        }
+
+        void EndpointSelector::Stop() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_running = false;
+            ++m_generation;
+        }
+
+        bool EndpointSelector::ScheduleNext(uint64_t generation)
+        {
+            aws_event_loop *eventLoop =
+                aws_event_loop_group_get_next_loop(m_config.EventLoopGroup->GetUnderlyingHandle());
+            auto *reevaluateTask = eventLoop ? Crt::New<ReevaluateTask>(m_allocator) : nullptr;
+            if (!reevaluateTask)
+            {
+                return false;
+            }
+
+            reevaluateTask->Selector = shared_from_this();
+            reevaluateTask->Generation = generation;
+            reevaluateTask->Allocator = m_allocator;
+            aws_task_init(&reevaluateTask->Task, ReevaluateTask::s_run, reevaluateTask, "EndpointSelectorReevaluate");
+
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(eventLoop, &now);
+            uint64_t interval = aws_timestamp_convert(
+                m_config.ReevaluateIntervalMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, nullptr);
+            aws_event_loop_schedule_task_future(eventLoop, &reevaluateTask->Task, now + interval);
+            return true;
+        }
+
+        void EndpointSelector::OnReevaluate(uint64_t generation)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_running || m_generation != generation)
+                {
+                    return;
+                }
+            }
+
+            /* Candidates may come back through SetCandidates, so a run without any keeps waking up. */
+            if (!Evaluate())
+            {
+                ScheduleNext(generation);
+            }
+        }
+    } // namespace Discovery
+} // namespace Aws
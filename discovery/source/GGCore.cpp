@@ -23,8 +23,7 @@ namespace Aws
 
                 for (auto &connectivity : connectivityArray)
                 {
-                    ConnectivityInfo connectivityInfo(connectivity.AsObject());
-                    obj.Connectivity->push_back(std::move(connectivity));
+                    obj.Connectivity->emplace_back(connectivity);
                 }
             }
         }
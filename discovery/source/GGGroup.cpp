@@ -19,10 +19,11 @@ namespace Aws
             {
                 auto coresArray = doc.GetArray("Cores");
                 obj.Cores = Aws::Crt::Vector<GGCore>();
+                obj.Cores->reserve(coresArray.size());
 
                 for (auto &core : coresArray)
                 {
-                    obj.Cores->push_back(core);
+                    obj.Cores->emplace_back(core);
                 }
             }
 
@@ -30,10 +31,11 @@ namespace Aws
             {
                 auto caArray = doc.GetArray("CAs");
                 obj.CAs = Aws::Crt::Vector<Aws::Crt::String>();
+                obj.CAs->reserve(caArray.size());
 
                 for (auto &ca : caArray)
                 {
-                    obj.CAs->push_back(ca.AsString());
+                    obj.CAs->emplace_back(ca.AsString());
                 }
             }
         }
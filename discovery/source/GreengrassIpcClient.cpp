@@ -0,0 +1,832 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/GreengrassIpcClient.h>
+
+#include <aws/crt/JsonObject.h>
+
+#include <aws/common/encoding.h>
+#include <aws/io/io.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#    include <sys/socket.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+
+#    include <cerrno>
+#endif
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        namespace
+        {
+            /* The event stream RPC message types and flags the client uses. */
+            const int32_t s_applicationMessage = 0;
+            const int32_t s_applicationError = 1;
+            const int32_t s_ping = 2;
+            const int32_t s_pingResponse = 3;
+            const int32_t s_connect = 4;
+            const int32_t s_connectAck = 5;
+            const int32_t s_connectionAccepted = 1;
+            const int32_t s_terminateStream = 2;
+
+            /* Header value types of the event stream framing. */
+            const uint8_t s_int32Header = 4;
+            const uint8_t s_stringHeader = 7;
+
+            /* Prelude (total length, headers length, prelude CRC) and trailing message CRC. */
+            const size_t s_preludeSize = 12;
+            const size_t s_crcSize = 4;
+            /* The largest message the core sends: its default payload limit, with room for the headers. */
+            const size_t s_maxFrameSize = 16 * 1024 * 1024;
+
+            const char *s_subscriptionMessageModel = "aws.greengrass#SubscriptionResponseMessage";
+            const char *s_iotCoreMessageModel = "aws.greengrass#IoTCoreMessage";
+
+            /* CRC-32 (IEEE 802.3), which frames the event stream prelude and message. */
+            struct Crc32Table
+            {
+                Crc32Table() noexcept
+                {
+                    for (uint32_t i = 0; i < 256; ++i)
+                    {
+                        uint32_t crc = i;
+                        for (int bit = 0; bit < 8; ++bit)
+                        {
+                            crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+                        }
+                        Entries[i] = crc;
+                    }
+                }
+
+                uint32_t Entries[256];
+            };
+
+            uint32_t s_crc32(const char *data, size_t length)
+            {
+                static const Crc32Table s_table;
+                uint32_t crc = 0xFFFFFFFFu;
+                for (size_t i = 0; i < length; ++i)
+                {
+                    crc = s_table.Entries[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+                }
+                return crc ^ 0xFFFFFFFFu;
+            }
+
+            void s_appendU32(Crt::String &out, uint32_t value)
+            {
+                out.push_back(static_cast<char>((value >> 24) & 0xFF));
+                out.push_back(static_cast<char>((value >> 16) & 0xFF));
+                out.push_back(static_cast<char>((value >> 8) & 0xFF));
+                out.push_back(static_cast<char>(value & 0xFF));
+            }
+
+            uint32_t s_readU32(const char *data)
+            {
+                return static_cast<uint32_t>(static_cast<uint8_t>(data[0])) << 24 |
+                       static_cast<uint32_t>(static_cast<uint8_t>(data[1])) << 16 |
+                       static_cast<uint32_t>(static_cast<uint8_t>(data[2])) << 8 |
+                       static_cast<uint32_t>(static_cast<uint8_t>(data[3]));
+            }
+
+            void s_appendInt32Header(Crt::String &headers, const char *name, int32_t value)
+            {
+                headers.push_back(static_cast<char>(strlen(name)));
+                headers.append(name);
+                headers.push_back(static_cast<char>(s_int32Header));
+                s_appendU32(headers, static_cast<uint32_t>(value));
+            }
+
+            void s_appendStringHeader(Crt::String &headers, const char *name, const char *value)
+            {
+                size_t length = strlen(value);
+                headers.push_back(static_cast<char>(strlen(name)));
+                headers.append(name);
+                headers.push_back(static_cast<char>(s_stringHeader));
+                headers.push_back(static_cast<char>((length >> 8) & 0xFF));
+                headers.push_back(static_cast<char>(length & 0xFF));
+                headers.append(value, length);
+            }
+
+            /* The headers every message on a stream carries. */
+            Crt::String s_streamHeaders(int32_t messageType, int32_t flags, int32_t streamId)
+            {
+                Crt::String headers;
+                s_appendInt32Header(headers, ":message-type", messageType);
+                s_appendInt32Header(headers, ":message-flags", flags);
+                s_appendInt32Header(headers, ":stream-id", streamId);
+                return headers;
+            }
+
+            Crt::String s_frame(const Crt::String &headers, const Crt::String &payload)
+            {
+                size_t total = s_preludeSize + headers.size() + payload.size() + s_crcSize;
+                Crt::String frame;
+                frame.reserve(total);
+                s_appendU32(frame, static_cast<uint32_t>(total));
+                s_appendU32(frame, static_cast<uint32_t>(headers.size()));
+                s_appendU32(frame, s_crc32(frame.data(), 8));
+                frame.append(headers).append(payload);
+                s_appendU32(frame, s_crc32(frame.data(), frame.size()));
+                return frame;
+            }
+
+            void s_appendJsonString(Crt::String &out, const Crt::String &value)
+            {
+                static const char s_hex[] = "0123456789abcdef";
+                out.push_back('"');
+                for (char c : value)
+                {
+                    if (c == '"' || c == '\\')
+                    {
+                        out.push_back('\\');
+                        out.push_back(c);
+                    }
+                    else if (static_cast<uint8_t>(c) < 0x20)
+                    {
+                        out.append("\\u00");
+                        out.push_back(s_hex[(c >> 4) & 0xF]);
+                        out.push_back(s_hex[c & 0xF]);
+                    }
+                    else
+                    {
+                        out.push_back(c);
+                    }
+                }
+                out.push_back('"');
+            }
+
+            void s_appendBase64(Crt::String &out, const Crt::ByteCursor &data)
+            {
+                static const char s_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+                out.push_back('"');
+                size_t i = 0;
+                for (; i + 3 <= data.len; i += 3)
+                {
+                    uint32_t triple = static_cast<uint32_t>(data.ptr[i]) << 16 |
+                                      static_cast<uint32_t>(data.ptr[i + 1]) << 8 | data.ptr[i + 2];
+                    out.push_back(s_alphabet[(triple >> 18) & 0x3F]);
+                    out.push_back(s_alphabet[(triple >> 12) & 0x3F]);
+                    out.push_back(s_alphabet[(triple >> 6) & 0x3F]);
+                    out.push_back(s_alphabet[triple & 0x3F]);
+                }
+                if (i < data.len)
+                {
+                    uint32_t triple = static_cast<uint32_t>(data.ptr[i]) << 16;
+                    if (i + 1 < data.len)
+                    {
+                        triple |= static_cast<uint32_t>(data.ptr[i + 1]) << 8;
+                    }
+                    out.push_back(s_alphabet[(triple >> 18) & 0x3F]);
+                    out.push_back(s_alphabet[(triple >> 12) & 0x3F]);
+                    out.push_back(i + 1 < data.len ? s_alphabet[(triple >> 6) & 0x3F] : '=');
+                    out.push_back('=');
+                }
+                out.push_back('"');
+            }
+
+            Crt::String s_qos(Crt::Mqtt::QOS qos) { return qos == AWS_MQTT_QOS_AT_MOST_ONCE ? "0" : "1"; }
+
+            /* What Dispatch needs of a received message. */
+            struct ParsedFrame
+            {
+                int32_t MessageType = -1;
+                int32_t Flags = 0;
+                int32_t StreamId = 0;
+                Crt::String ServiceModelType;
+                const char *Payload = nullptr;
+                size_t PayloadLength = 0;
+            };
+
+            bool s_parse(const Crt::String &frame, ParsedFrame &parsed)
+            {
+                if (frame.size() < s_preludeSize + s_crcSize)
+                {
+                    return false;
+                }
+                size_t headersLength = s_readU32(frame.data() + 4);
+                if (s_readU32(frame.data() + 8) != s_crc32(frame.data(), 8) ||
+                    s_readU32(frame.data() + frame.size() - s_crcSize) !=
+                        s_crc32(frame.data(), frame.size() - s_crcSize) ||
+                    headersLength > frame.size() - s_preludeSize - s_crcSize)
+                {
+                    return false;
+                }
+
+                const char *position = frame.data() + s_preludeSize;
+                const char *headersEnd = position + headersLength;
+                while (position < headersEnd)
+                {
+                    size_t nameLength = static_cast<uint8_t>(*position++);
+                    if (static_cast<size_t>(headersEnd - position) < nameLength + 1)
+                    {
+                        return false;
+                    }
+                    Crt::String name(position, nameLength);
+                    position += nameLength;
+                    uint8_t type = static_cast<uint8_t>(*position++);
+
+                    /* Value sizes by type; only int32 and string values are read, the rest skipped. */
+                    size_t valueLength = 0;
+                    size_t lengthPrefix = 0;
+                    switch (type)
+                    {
+                        case 0:
+                        case 1:
+                            break;
+                        case 2:
+                            valueLength = 1;
+                            break;
+                        case 3:
+                            valueLength = 2;
+                            break;
+                        case 4:
+                            valueLength = 4;
+                            break;
+                        case 5:
+                        case 8:
+                            valueLength = 8;
+                            break;
+                        case 6:
+                        case 7:
+                            lengthPrefix = 2;
+                            break;
+                        case 9:
+                            valueLength = 16;
+                            break;
+                        default:
+                            return false;
+                    }
+                    if (lengthPrefix)
+                    {
+                        if (headersEnd - position < 2)
+                        {
+                            return false;
+                        }
+                        valueLength = static_cast<size_t>(static_cast<uint8_t>(position[0])) << 8 |
+                                      static_cast<uint8_t>(position[1]);
+                        position += 2;
+                    }
+                    if (static_cast<size_t>(headersEnd - position) < valueLength)
+                    {
+                        return false;
+                    }
+
+                    if (type == s_int32Header)
+                    {
+                        int32_t value = static_cast<int32_t>(s_readU32(position));
+                        if (name == ":message-type")
+                        {
+                            parsed.MessageType = value;
+                        }
+                        else if (name == ":message-flags")
+                        {
+                            parsed.Flags = value;
+                        }
+                        else if (name == ":stream-id")
+                        {
+                            parsed.StreamId = value;
+                        }
+                    }
+                    else if (type == s_stringHeader && name == "service-model-type")
+                    {
+                        parsed.ServiceModelType.assign(position, valueLength);
+                    }
+                    position += valueLength;
+                }
+
+                parsed.Payload = headersEnd;
+                parsed.PayloadLength = frame.size() - s_preludeSize - headersLength - s_crcSize;
+                return true;
+            }
+
+            const char *s_environment(const char *name)
+            {
+                const char *value = getenv(name);
+                return value ? value : "";
+            }
+
+#ifndef _WIN32
+            bool s_readFull(int fd, char *buffer, size_t length)
+            {
+                while (length)
+                {
+                    ssize_t received = recv(fd, buffer, length, 0);
+                    if (received <= 0)
+                    {
+                        if (received < 0 && errno == EINTR)
+                        {
+                            continue;
+                        }
+                        return false;
+                    }
+                    buffer += received;
+                    length -= static_cast<size_t>(received);
+                }
+                return true;
+            }
+
+            /* Reads one whole message into `frame`, reusing its storage. */
+            bool s_readFrame(int fd, Crt::String &frame)
+            {
+                char prelude[s_preludeSize];
+                if (!s_readFull(fd, prelude, sizeof(prelude)))
+                {
+                    return false;
+                }
+                size_t total = s_readU32(prelude);
+                if (total < s_preludeSize + s_crcSize || total > s_maxFrameSize)
+                {
+                    return false;
+                }
+                frame.assign(prelude, sizeof(prelude));
+                frame.resize(total);
+                return s_readFull(fd, &frame[s_preludeSize], total - s_preludeSize);
+            }
+#endif
+        } // namespace
+
+        GreengrassIpcClientConfig::GreengrassIpcClientConfig() noexcept
+            : SocketPath(s_environment("AWS_GG_NUCLEUS_DOMAIN_SOCKET_FILEPATH_FOR_COMPONENT")),
+              AuthToken(s_environment("SVCUID"))
+        {
+        }
+
+        GreengrassIpcClient::GreengrassIpcClient(
+            const GreengrassIpcClientConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_config(config), m_allocator(allocator), m_fd(-1), m_closing(false), m_nextStreamId(1)
+        {
+        }
+
+        GreengrassIpcClient::~GreengrassIpcClient()
+        {
+            Close();
+#ifndef _WIN32
+            /*
+             * Released by the reader itself, the last reference having been a handler's: the reader touches
+             * nothing of the client once its own reference is gone, so it only remains to let it end.
+             */
+            if (m_reader.joinable())
+            {
+                m_reader.detach();
+                close(m_fd);
+            }
+#endif
+        }
+
+        std::shared_ptr<GreengrassIpcClient> GreengrassIpcClient::Create(
+            const GreengrassIpcClientConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<GreengrassIpcClient *>(aws_mem_acquire(allocator, sizeof(GreengrassIpcClient)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) GreengrassIpcClient(config, allocator);
+                return std::shared_ptr<GreengrassIpcClient>(
+                    toSeat, [allocator](GreengrassIpcClient *client) { Crt::Delete(client, allocator); });
+            }
+
+            return nullptr;
+        }
+
+#ifndef _WIN32
+        bool GreengrassIpcClient::Connect()
+        {
+            if (m_fd >= 0 || m_reader.joinable())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return false;
+            }
+
+            sockaddr_un address;
+            memset(&address, 0, sizeof(address));
+            if (m_config.SocketPath.empty() || m_config.SocketPath.size() >= sizeof(address.sun_path))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+            address.sun_family = AF_UNIX;
+            memcpy(address.sun_path, m_config.SocketPath.c_str(), m_config.SocketPath.size());
+
+            m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (m_fd < 0 || connect(m_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+            {
+                Close();
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+#    ifdef SO_NOSIGPIPE
+            int noSigPipe = 1;
+            setsockopt(m_fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#    endif
+
+            Crt::String headers = s_streamHeaders(s_connect, 0, 0);
+            s_appendStringHeader(headers, ":version", "0.1.0");
+            s_appendStringHeader(headers, ":content-type", "application/json");
+            Crt::String payload("{\"authToken\":");
+            s_appendJsonString(payload, m_config.AuthToken);
+            payload.push_back('}');
+
+            /* The handshake is read here, before the reader thread takes the socket over. */
+            Crt::String ack;
+            ParsedFrame parsed;
+            if (!Send(s_frame(headers, payload)) || !s_readFrame(m_fd, ack) || !s_parse(ack, parsed))
+            {
+                Close();
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+            if (parsed.MessageType != s_connectAck || !(parsed.Flags & s_connectionAccepted))
+            {
+                Close();
+                aws_raise_error(AWS_ERROR_NO_PERMISSION);
+                return false;
+            }
+
+            m_closing = false;
+            std::weak_ptr<GreengrassIpcClient> weakClient = shared_from_this();
+            int fd = m_fd;
+            m_reader = std::thread([weakClient, fd]() { ReadLoop(weakClient, fd); });
+            return true;
+        }
+
+        void GreengrassIpcClient::Close()
+        {
+            m_closing = true;
+            if (m_fd >= 0)
+            {
+                shutdown(m_fd, SHUT_RDWR);
+            }
+            if (m_reader.joinable())
+            {
+                /* Closed from a handler: the reader ends once the handler returns, and is joined later. */
+                if (m_reader.get_id() == std::this_thread::get_id())
+                {
+                    FailAll(AWS_IO_SOCKET_CLOSED);
+                    return;
+                }
+                m_reader.join();
+            }
+            if (m_fd >= 0)
+            {
+                close(m_fd);
+                m_fd = -1;
+            }
+            FailAll(AWS_IO_SOCKET_CLOSED);
+        }
+
+        bool GreengrassIpcClient::Send(const Crt::String &frame)
+        {
+            std::lock_guard<std::mutex> lock(m_writeLock);
+            const char *position = frame.data();
+            size_t remaining = frame.size();
+            while (remaining)
+            {
+#    ifdef MSG_NOSIGNAL
+                ssize_t sent = send(m_fd, position, remaining, MSG_NOSIGNAL);
+#    else
+                ssize_t sent = send(m_fd, position, remaining, 0);
+#    endif
+                if (sent < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    aws_raise_error(AWS_IO_SOCKET_CLOSED);
+                    return false;
+                }
+                position += sent;
+                remaining -= static_cast<size_t>(sent);
+            }
+            return true;
+        }
+
+        void GreengrassIpcClient::ReadLoop(const std::weak_ptr<GreengrassIpcClient> &weakClient, int fd)
+        {
+            /*
+             * The socket is only closed once this thread is joined, or once the client is gone, which is
+             * checked before every read; the client itself is held only while a message is dispatched.
+             */
+            Crt::String frame;
+            while (s_readFrame(fd, frame))
+            {
+                {
+                    std::shared_ptr<GreengrassIpcClient> client = weakClient.lock();
+                    if (!client || client->m_closing)
+                    {
+                        return;
+                    }
+                    client->Dispatch(frame);
+                }
+                if (weakClient.expired())
+                {
+                    return;
+                }
+            }
+
+            if (std::shared_ptr<GreengrassIpcClient> client = weakClient.lock())
+            {
+                client->FailAll(AWS_IO_SOCKET_CLOSED);
+            }
+        }
+#else
+        bool GreengrassIpcClient::Connect()
+        {
+            aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+            return false;
+        }
+
+        void GreengrassIpcClient::Close() { FailAll(AWS_IO_SOCKET_CLOSED); }
+
+        bool GreengrassIpcClient::Send(const Crt::String &)
+        {
+            aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+            return false;
+        }
+
+        void GreengrassIpcClient::ReadLoop(const std::weak_ptr<GreengrassIpcClient> &, int) {}
+#endif
+
+        void GreengrassIpcClient::FailAll(int errorCode)
+        {
+            Crt::Map<int32_t, Stream> failed;
+            {
+                std::lock_guard<std::mutex> lock(m_streamsLock);
+                failed.swap(m_streams);
+            }
+
+            for (auto &entry : failed)
+            {
+                if (!entry.second.Responded && entry.second.OnResponse)
+                {
+                    entry.second.OnResponse(errorCode, Crt::String());
+                }
+            }
+        }
+
+        int32_t GreengrassIpcClient::StartStream(
+            const char *operation,
+            const char *requestModel,
+            const Crt::String &request,
+            Stream &&stream)
+        {
+            if (m_fd < 0)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return 0;
+            }
+
+            int32_t streamId = 0;
+            {
+                /* Registered before it is sent, so the core's answer always finds it. */
+                std::lock_guard<std::mutex> lock(m_streamsLock);
+                streamId = m_nextStreamId++;
+                if (m_nextStreamId <= 0)
+                {
+                    m_nextStreamId = 1;
+                }
+                m_streams[streamId] = std::move(stream);
+            }
+
+            Crt::String headers = s_streamHeaders(s_applicationMessage, 0, streamId);
+            s_appendStringHeader(headers, "operation", operation);
+            s_appendStringHeader(headers, "service-model-type", requestModel);
+            s_appendStringHeader(headers, ":content-type", "application/json");
+            if (!Send(s_frame(headers, request)))
+            {
+                std::lock_guard<std::mutex> lock(m_streamsLock);
+                m_streams.erase(streamId);
+                return 0;
+            }
+            return streamId;
+        }
+
+        bool GreengrassIpcClient::Publish(
+            const Crt::String &topic,
+            const Crt::ByteCursor &payload,
+            const OnIpcOperationComplete &onComplete)
+        {
+            Crt::String request("{\"topic\":");
+            request.reserve(request.size() + topic.size() + payload.len * 4 / 3 + 64);
+            s_appendJsonString(request, topic);
+            request.append(",\"publishMessage\":{\"binaryMessage\":{\"message\":");
+            s_appendBase64(request, payload);
+            request.append("}}}");
+
+            Stream stream;
+            stream.OnResponse = onComplete;
+            return StartStream(
+                       "aws.greengrass#PublishToTopic",
+                       "aws.greengrass#PublishToTopicRequest",
+                       request,
+                       std::move(stream)) != 0;
+        }
+
+        int32_t GreengrassIpcClient::Subscribe(
+            const Crt::String &topic,
+            const OnIpcMessage &onMessage,
+            const OnIpcOperationComplete &onSubAck)
+        {
+            Crt::String request("{\"topic\":");
+            s_appendJsonString(request, topic);
+            request.push_back('}');
+
+            Stream stream;
+            stream.OnResponse = onSubAck;
+            stream.OnMessage = std::make_shared<OnIpcMessage>(onMessage);
+            return StartStream(
+                "aws.greengrass#SubscribeToTopic",
+                "aws.greengrass#SubscribeToTopicRequest",
+                request,
+                std::move(stream));
+        }
+
+        bool GreengrassIpcClient::PublishToIotCore(
+            const Crt::String &topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteCursor &payload,
+            const OnIpcOperationComplete &onComplete)
+        {
+            Crt::String request("{\"topicName\":");
+            request.reserve(request.size() + topic.size() + payload.len * 4 / 3 + 64);
+            s_appendJsonString(request, topic);
+            request.append(",\"qos\":");
+            s_appendJsonString(request, s_qos(qos));
+            request.append(",\"payload\":");
+            s_appendBase64(request, payload);
+            request.push_back('}');
+
+            Stream stream;
+            stream.OnResponse = onComplete;
+            return StartStream(
+                       "aws.greengrass#PublishToIoTCore",
+                       "aws.greengrass#PublishToIoTCoreRequest",
+                       request,
+                       std::move(stream)) != 0;
+        }
+
+        int32_t GreengrassIpcClient::SubscribeToIotCore(
+            const Crt::String &topic,
+            Crt::Mqtt::QOS qos,
+            const OnIpcMessage &onMessage,
+            const OnIpcOperationComplete &onSubAck)
+        {
+            Crt::String request("{\"topicName\":");
+            s_appendJsonString(request, topic);
+            request.append(",\"qos\":");
+            s_appendJsonString(request, s_qos(qos));
+            request.push_back('}');
+
+            Stream stream;
+            stream.OnResponse = onSubAck;
+            stream.OnMessage = std::make_shared<OnIpcMessage>(onMessage);
+            stream.IotCore = true;
+            return StartStream(
+                "aws.greengrass#SubscribeToIoTCore",
+                "aws.greengrass#SubscribeToIoTCoreRequest",
+                request,
+                std::move(stream));
+        }
+
+        bool GreengrassIpcClient::Unsubscribe(int32_t subscriptionId)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_streamsLock);
+                if (m_streams.erase(subscriptionId) == 0)
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                    return false;
+                }
+            }
+
+            return Send(s_frame(s_streamHeaders(s_applicationMessage, s_terminateStream, subscriptionId), "{}"));
+        }
+
+        void GreengrassIpcClient::Dispatch(const Crt::String &frame)
+        {
+            ParsedFrame parsed;
+            if (!s_parse(frame, parsed))
+            {
+                return;
+            }
+
+            if (parsed.StreamId == 0)
+            {
+                if (parsed.MessageType == s_ping)
+                {
+                    Send(s_frame(s_streamHeaders(s_pingResponse, 0, 0), Crt::String()));
+                }
+                return;
+            }
+
+            bool isEvent = parsed.ServiceModelType == s_subscriptionMessageModel ||
+                           parsed.ServiceModelType == s_iotCoreMessageModel;
+            bool terminated = (parsed.Flags & s_terminateStream) != 0;
+
+            OnIpcOperationComplete onResponse;
+            std::shared_ptr<OnIpcMessage> onMessage;
+            bool iotCore = false;
+            {
+                std::lock_guard<std::mutex> lock(m_streamsLock);
+                auto found = m_streams.find(parsed.StreamId);
+                if (found == m_streams.end())
+                {
+                    return;
+                }
+
+                Stream &stream = found->second;
+                if (!stream.Responded && (!isEvent || parsed.MessageType != s_applicationMessage))
+                {
+                    stream.Responded = true;
+                    onResponse = std::move(stream.OnResponse);
+                }
+                if (isEvent && parsed.MessageType == s_applicationMessage)
+                {
+                    onMessage = stream.OnMessage;
+                    iotCore = stream.IotCore;
+                }
+                /* A rejected request, a completed publish, or a subscription the core ended. */
+                if (terminated || parsed.MessageType != s_applicationMessage || !stream.OnMessage)
+                {
+                    m_streams.erase(found);
+                }
+            }
+
+            if (onResponse)
+            {
+                if (parsed.MessageType == s_applicationMessage)
+                {
+                    onResponse(AWS_ERROR_SUCCESS, Crt::String());
+                }
+                else
+                {
+                    onResponse(AWS_ERROR_UNKNOWN, parsed.ServiceModelType);
+                }
+            }
+
+            if (!onMessage)
+            {
+                return;
+            }
+
+            Crt::JsonObject document(Crt::String(parsed.Payload, parsed.PayloadLength));
+            if (!document.WasParseSuccessful())
+            {
+                return;
+            }
+
+            Crt::JsonView view = document.View();
+            Crt::String topic;
+            Crt::ByteCursor payload = aws_byte_cursor_from_array(nullptr, 0);
+            Crt::String encoded;
+            if (iotCore)
+            {
+                Crt::JsonView message = view.GetJsonObject("message");
+                topic = message.GetString("topicName");
+                encoded = message.GetString("payload");
+            }
+            else if (view.ValueExists("binaryMessage"))
+            {
+                Crt::JsonView message = view.GetJsonObject("binaryMessage");
+                topic = message.GetJsonObject("context").GetString("topic");
+                encoded = message.GetString("message");
+            }
+            else
+            {
+                /* JSON messages other components publish are handed over serialized. */
+                Crt::JsonView message = view.GetJsonObject("jsonMessage");
+                topic = message.GetJsonObject("context").GetString("topic");
+                m_decoded = message.GetJsonObject("message").WriteCompact();
+                payload = aws_byte_cursor_from_array(m_decoded.data(), m_decoded.size());
+            }
+
+            if (!encoded.empty())
+            {
+                Crt::ByteCursor toDecode = aws_byte_cursor_from_array(encoded.data(), encoded.size());
+                size_t decodedLength = 0;
+                if (aws_base64_compute_decoded_len(&toDecode, &decodedLength) != AWS_OP_SUCCESS)
+                {
+                    return;
+                }
+                m_decoded.resize(decodedLength);
+                Crt::ByteBuf output =
+                    aws_byte_buf_from_empty_array(reinterpret_cast<uint8_t *>(&m_decoded[0]), decodedLength);
+                if (decodedLength && aws_base64_decode(&toDecode, &output) != AWS_OP_SUCCESS)
+                {
+                    return;
+                }
+                payload = aws_byte_cursor_from_array(m_decoded.data(), output.len);
+            }
+
+            (*onMessage)(topic, payload);
+        }
+    } // namespace Discovery
+} // namespace Aws
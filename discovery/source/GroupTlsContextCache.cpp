@@ -0,0 +1,151 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/discovery/GroupTlsContextCache.h>
+
+#include <algorithm>
+
+namespace Aws
+{
+    namespace Discovery
+    {
+        namespace
+        {
+            /* FNV-1a over each CA and its length, so ("ab", "c") and ("a", "bc") differ. */
+            uint64_t s_hashCas(const Crt::Vector<Crt::String> &sortedCas)
+            {
+                uint64_t hash = 14695981039346656037ULL;
+                auto mix = [&hash](const uint8_t *bytes, size_t length) {
+                    for (size_t i = 0; i < length; ++i)
+                    {
+                        hash ^= bytes[i];
+                        hash *= 1099511628211ULL;
+                    }
+                };
+
+                for (const Crt::String &ca : sortedCas)
+                {
+                    uint64_t length = ca.length();
+                    mix(reinterpret_cast<const uint8_t *>(&length), sizeof(length));
+                    mix(reinterpret_cast<const uint8_t *>(ca.data()), ca.length());
+                }
+                return hash;
+            }
+        } // namespace
+
+        GroupTlsContextCacheConfig::GroupTlsContextCacheConfig() noexcept
+            : CertificatePath(), PrivateKeyPath(), MaxContexts(4)
+        {
+        }
+
+        GroupTlsContextCache::GroupTlsContextCache(const GroupTlsContextCacheConfig &config, Crt::Allocator *allocator)
+            noexcept
+            : m_config(config), m_allocator(allocator)
+        {
+        }
+
+        std::shared_ptr<GroupTlsContextCache> GroupTlsContextCache::Create(
+            const GroupTlsContextCacheConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (config.CertificatePath.empty() || config.PrivateKeyPath.empty())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat =
+                static_cast<GroupTlsContextCache *>(aws_mem_acquire(allocator, sizeof(GroupTlsContextCache)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) GroupTlsContextCache(config, allocator);
+                return std::shared_ptr<GroupTlsContextCache>(
+                    toSeat, [allocator](GroupTlsContextCache *cache) { Crt::Delete(cache, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool GroupTlsContextCache::Find(
+            uint64_t hash,
+            const Crt::Vector<Crt::String> &sortedCas,
+            Crt::Io::TlsContext &context)
+        {
+            for (auto entry = m_entries.begin(); entry != m_entries.end(); ++entry)
+            {
+                if (entry->Hash == hash && entry->Cas == sortedCas)
+                {
+                    m_entries.splice(m_entries.begin(), m_entries, entry);
+                    context = m_entries.front().Context;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool GroupTlsContextCache::GetContext(const Crt::Vector<Crt::String> &cas, Crt::Io::TlsContext &context)
+        {
+            Crt::Vector<Crt::String> sortedCas(cas);
+            std::sort(sortedCas.begin(), sortedCas.end());
+            uint64_t hash = s_hashCas(sortedCas);
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (Find(hash, sortedCas, context))
+                {
+                    return true;
+                }
+            }
+
+            /* Built without the lock held; a concurrent build of the same set is resolved on insertion. */
+            Crt::Io::TlsContextOptions options = Crt::Io::TlsContextOptions::InitClientWithMtls(
+                m_config.CertificatePath.c_str(), m_config.PrivateKeyPath.c_str(), m_allocator);
+            if (!options)
+            {
+                return false;
+            }
+
+            Crt::String trustStore;
+            for (const Crt::String &ca : sortedCas)
+            {
+                trustStore.append(ca).append("\n");
+            }
+            if (!options.OverrideDefaultTrustStore(Crt::ByteCursorFromCString(trustStore.c_str())))
+            {
+                return false;
+            }
+
+            Crt::Io::TlsContext built(options, Crt::Io::TlsMode::CLIENT, m_allocator);
+            if (!built)
+            {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (Find(hash, sortedCas, context))
+            {
+                return true;
+            }
+
+            Entry entry;
+            entry.Hash = hash;
+            entry.Cas = std::move(sortedCas);
+            entry.Context = built;
+            m_entries.push_front(std::move(entry));
+            while (m_config.MaxContexts && m_entries.size() > m_config.MaxContexts)
+            {
+                m_entries.pop_back();
+            }
+
+            context = std::move(built);
+            return true;
+        }
+
+        size_t GroupTlsContextCache::GetCachedCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_entries.size();
+        }
+    } // namespace Discovery
+} // namespace Aws
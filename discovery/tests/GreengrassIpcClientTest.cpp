@@ -0,0 +1,608 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/discovery/GreengrassIpcClient.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <aws/io/io.h>
+
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    /* Relative, like the other tests' scratch files, so it stays well inside sun_path. */
+    const char *s_socketPath = "GreengrassIpcClientTest.sock";
+    const char *s_authToken = "test-token";
+
+    /* The event stream framing, written out independently of the client's so each checks the other. */
+    const int32_t s_applicationMessage = 0;
+    const int32_t s_applicationError = 1;
+    const int32_t s_ping = 2;
+    const int32_t s_pingResponse = 3;
+    const int32_t s_connect = 4;
+    const int32_t s_connectAck = 5;
+    const int32_t s_terminateStream = 2;
+
+    uint32_t s_crc32(const char *data, size_t length)
+    {
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < length; ++i)
+        {
+            crc ^= static_cast<uint8_t>(data[i]);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+            }
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    void s_appendU32(Aws::Crt::String &out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            out.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    uint32_t s_readU32(const char *data)
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            value = value << 8 | static_cast<uint8_t>(data[i]);
+        }
+        return value;
+    }
+
+    void s_appendHeader(Aws::Crt::String &headers, const char *name, uint8_t type)
+    {
+        headers.push_back(static_cast<char>(strlen(name)));
+        headers.append(name);
+        headers.push_back(static_cast<char>(type));
+    }
+
+    /* The headers of a message from the core: type, flags, stream and, if set, the service model. */
+    Aws::Crt::String s_headers(int32_t messageType, int32_t flags, int32_t streamId, const char *model = nullptr)
+    {
+        Aws::Crt::String headers;
+        const char *names[] = {":message-type", ":message-flags", ":stream-id"};
+        const int32_t values[] = {messageType, flags, streamId};
+        for (size_t i = 0; i < 3; ++i)
+        {
+            s_appendHeader(headers, names[i], 4);
+            s_appendU32(headers, static_cast<uint32_t>(values[i]));
+        }
+        if (model)
+        {
+            size_t length = strlen(model);
+            s_appendHeader(headers, "service-model-type", 7);
+            headers.push_back(static_cast<char>((length >> 8) & 0xFF));
+            headers.push_back(static_cast<char>(length & 0xFF));
+            headers.append(model);
+        }
+        return headers;
+    }
+
+    Aws::Crt::String s_frame(const Aws::Crt::String &headers, const Aws::Crt::String &payload)
+    {
+        Aws::Crt::String frame;
+        s_appendU32(frame, static_cast<uint32_t>(12 + headers.size() + payload.size() + 4));
+        s_appendU32(frame, static_cast<uint32_t>(headers.size()));
+        s_appendU32(frame, s_crc32(frame.data(), 8));
+        frame.append(headers).append(payload);
+        s_appendU32(frame, s_crc32(frame.data(), frame.size()));
+        return frame;
+    }
+
+    /* A message from the client, with the headers it sends. */
+    struct Frame
+    {
+        int32_t MessageType = -1;
+        int32_t Flags = -1;
+        int32_t StreamId = -1;
+        Aws::Crt::String Operation;
+        Aws::Crt::String ServiceModelType;
+        Aws::Crt::String Payload;
+    };
+
+    bool s_readFull(int fd, char *buffer, size_t length)
+    {
+        while (length)
+        {
+            ssize_t received = recv(fd, buffer, length, 0);
+            if (received <= 0)
+            {
+                return false;
+            }
+            buffer += received;
+            length -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    bool s_parseHeaders(const char *position, const char *end, Frame &frame)
+    {
+        while (position < end)
+        {
+            size_t nameLength = static_cast<uint8_t>(*position++);
+            Aws::Crt::String name(position, nameLength);
+            position += nameLength;
+            uint8_t type = static_cast<uint8_t>(*position++);
+            if (type == 4)
+            {
+                int32_t value = static_cast<int32_t>(s_readU32(position));
+                position += 4;
+                if (name == ":message-type")
+                {
+                    frame.MessageType = value;
+                }
+                else if (name == ":message-flags")
+                {
+                    frame.Flags = value;
+                }
+                else if (name == ":stream-id")
+                {
+                    frame.StreamId = value;
+                }
+            }
+            else if (type == 7)
+            {
+                size_t length = static_cast<size_t>(static_cast<uint8_t>(position[0])) << 8 |
+                                static_cast<uint8_t>(position[1]);
+                Aws::Crt::String value(position + 2, length);
+                position += 2 + length;
+                if (name == "operation")
+                {
+                    frame.Operation = value;
+                }
+                else if (name == "service-model-type")
+                {
+                    frame.ServiceModelType = value;
+                }
+            }
+            else
+            {
+                /* The client only ever writes int32 and string headers. */
+                return false;
+            }
+        }
+        return position == end;
+    }
+
+    bool s_readFrame(int fd, Frame &frame)
+    {
+        char prelude[12];
+        if (!s_readFull(fd, prelude, sizeof(prelude)) || s_readU32(prelude + 8) != s_crc32(prelude, 8))
+        {
+            return false;
+        }
+        size_t total = s_readU32(prelude);
+        size_t headersLength = s_readU32(prelude + 4);
+        if (total < 16 + headersLength)
+        {
+            return false;
+        }
+        Aws::Crt::String message(prelude, sizeof(prelude));
+        message.resize(total);
+        if (!s_readFull(fd, &message[12], total - 12) ||
+            s_readU32(message.data() + total - 4) != s_crc32(message.data(), total - 4))
+        {
+            return false;
+        }
+
+        frame = Frame();
+        frame.Payload.assign(message.data() + 12 + headersLength, total - 16 - headersLength);
+        return s_parseHeaders(message.data() + 12, message.data() + 12 + headersLength, frame);
+    }
+
+    void s_setTimeout(int fd)
+    {
+        timeval timeout;
+        timeout.tv_sec = 30;
+        timeout.tv_usec = 0;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    /*
+     * The core's end of the connection. Connect blocks on the handshake, so it is answered on a thread; after
+     * that the test reads and writes the accepted socket itself.
+     */
+    struct FakeCore
+    {
+        FakeCore()
+        {
+            sockaddr_un address;
+            memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            strncpy(address.sun_path, s_socketPath, sizeof(address.sun_path) - 1);
+            unlink(s_socketPath);
+            ListenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (ListenFd >= 0 && (bind(ListenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+                                  listen(ListenFd, 1) != 0))
+            {
+                close(ListenFd);
+                ListenFd = -1;
+            }
+            if (ListenFd >= 0)
+            {
+                s_setTimeout(ListenFd);
+            }
+        }
+
+        ~FakeCore()
+        {
+            ClosePeer();
+            if (ListenFd >= 0)
+            {
+                close(ListenFd);
+            }
+            unlink(s_socketPath);
+        }
+
+        /* Accepts the next connection and answers its connect, accepting the token or not. */
+        void AcceptAsync(bool acceptToken)
+        {
+            ClosePeer();
+            Handshake = std::thread([this, acceptToken]() {
+                HandshakeRead = false;
+                PeerFd = accept(ListenFd, nullptr, nullptr);
+                if (PeerFd < 0)
+                {
+                    return;
+                }
+                s_setTimeout(PeerFd);
+                Frame connect;
+                HandshakeRead = s_readFrame(PeerFd, connect) && connect.MessageType == s_connect &&
+                                connect.StreamId == 0 && connect.Payload.find(s_authToken) != Aws::Crt::String::npos;
+                Send(s_headers(s_connectAck, acceptToken ? 1 : 0, 0), Aws::Crt::String());
+            });
+        }
+
+        /* @return whether the client's connect message was well formed. */
+        bool FinishAccept()
+        {
+            Handshake.join();
+            return HandshakeRead;
+        }
+
+        bool Send(const Aws::Crt::String &headers, const Aws::Crt::String &payload)
+        {
+            Aws::Crt::String frame = s_frame(headers, payload);
+            return send(PeerFd, frame.data(), frame.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(frame.size());
+        }
+
+        /* Answers the request on `streamId`, ending the stream unless it is a subscription. */
+        bool Respond(int32_t streamId, const char *model, bool terminate = true)
+        {
+            return Send(s_headers(s_applicationMessage, terminate ? s_terminateStream : 0, streamId, model), "{}");
+        }
+
+        bool Read(Frame &frame) { return s_readFrame(PeerFd, frame); }
+
+        /* Pings the client and waits for its answer, by when it has handled everything sent before. */
+        bool Ping()
+        {
+            Frame pong;
+            return Send(s_headers(s_ping, 0, 0), Aws::Crt::String()) && Read(pong) &&
+                   pong.MessageType == s_pingResponse && pong.StreamId == 0;
+        }
+
+        /* @return whether the client has closed its end. */
+        bool SawClose()
+        {
+            char byte;
+            return recv(PeerFd, &byte, 1, 0) == 0;
+        }
+
+        void ClosePeer()
+        {
+            if (PeerFd >= 0)
+            {
+                close(PeerFd);
+                PeerFd = -1;
+            }
+        }
+
+        int ListenFd = -1;
+        int PeerFd = -1;
+        std::thread Handshake;
+        bool HandshakeRead = false;
+    };
+
+    /* What each completion and message saw, in the order they arrived. */
+    struct Outcomes
+    {
+        void Add(const Aws::Crt::String &outcome)
+        {
+            std::lock_guard<std::mutex> guard(Lock);
+            Order.push_back(outcome);
+            Signal.notify_all();
+        }
+
+        Aws::Discovery::OnIpcOperationComplete Record(const char *name)
+        {
+            Aws::Crt::String label(name);
+            return [this, label](int errorCode, const Aws::Crt::String &errorModel) {
+                Aws::Crt::String outcome(label);
+                if (errorCode == AWS_ERROR_SUCCESS)
+                {
+                    outcome.append(":ok");
+                }
+                else
+                {
+                    outcome.append(errorCode == AWS_IO_SOCKET_CLOSED ? ":closed" : ":error");
+                }
+                if (!errorModel.empty())
+                {
+                    outcome.append(":").append(errorModel);
+                }
+                Add(outcome);
+            };
+        }
+
+        Aws::Discovery::OnIpcMessage RecordMessage()
+        {
+            return [this](const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) {
+                Aws::Crt::String outcome("message:");
+                outcome.append(topic).append(":").append(reinterpret_cast<const char *>(payload.ptr), payload.len);
+                Add(outcome);
+            };
+        }
+
+        bool WaitFor(size_t count)
+        {
+            std::unique_lock<std::mutex> guard(Lock);
+            return Signal.wait_for(guard, std::chrono::seconds(30), [this, count]() { return Order.size() >= count; });
+        }
+
+        bool Is(size_t index, const char *outcome)
+        {
+            std::lock_guard<std::mutex> guard(Lock);
+            return index < Order.size() && Order[index] == outcome;
+        }
+
+        size_t Count()
+        {
+            std::lock_guard<std::mutex> guard(Lock);
+            return Order.size();
+        }
+
+        std::mutex Lock;
+        std::condition_variable Signal;
+        Aws::Crt::Vector<Aws::Crt::String> Order;
+    };
+
+    std::shared_ptr<Aws::Discovery::GreengrassIpcClient> s_newClient(Aws::Crt::Allocator *allocator)
+    {
+        Aws::Discovery::GreengrassIpcClientConfig config;
+        config.SocketPath = s_socketPath;
+        config.AuthToken = s_authToken;
+        return Aws::Discovery::GreengrassIpcClient::Create(config, allocator);
+    }
+
+    bool s_connectTo(FakeCore &core, Aws::Discovery::GreengrassIpcClient &client)
+    {
+        core.AcceptAsync(true);
+        bool connected = client.Connect();
+        return core.FinishAccept() && connected;
+    }
+
+    Aws::Crt::ByteCursor s_cursor(const char *text)
+    {
+        return aws_byte_cursor_from_array(text, strlen(text));
+    }
+} // namespace
+
+static int s_TestGreengrassIpcClientFrameRoundTrip(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        FakeCore core;
+        ASSERT_TRUE(core.ListenFd >= 0);
+        auto client = s_newClient(allocator);
+        ASSERT_NOT_NULL(client.get());
+
+        /* A refused token fails the connect, and leaves the client free to connect again. */
+        core.AcceptAsync(false);
+        ASSERT_FALSE(client->Connect());
+        ASSERT_INT_EQUALS(AWS_ERROR_NO_PERMISSION, aws_last_error());
+        ASSERT_TRUE(core.FinishAccept());
+        ASSERT_TRUE(s_connectTo(core, *client));
+
+        /* A publish goes out as one request on its own stream, and completes with the core's answer. */
+        Outcomes outcomes;
+        ASSERT_TRUE(client->Publish("local/topic", s_cursor("hello"), outcomes.Record("publish")));
+        Frame request;
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_INT_EQUALS(s_applicationMessage, request.MessageType);
+        ASSERT_INT_EQUALS(0, request.Flags);
+        ASSERT_INT_EQUALS(1, request.StreamId);
+        ASSERT_TRUE(request.Operation == "aws.greengrass#PublishToTopic");
+        ASSERT_TRUE(request.ServiceModelType == "aws.greengrass#PublishToTopicRequest");
+        ASSERT_TRUE(request.Payload.find("\"topic\":\"local/topic\"") != Aws::Crt::String::npos);
+        ASSERT_TRUE(request.Payload.find("\"message\":\"aGVsbG8=\"") != Aws::Crt::String::npos);
+        ASSERT_TRUE(core.Respond(1, "aws.greengrass#PublishToTopicResponse"));
+        ASSERT_TRUE(outcomes.WaitFor(1));
+        ASSERT_TRUE(outcomes.Is(0, "publish:ok"));
+
+        /* A subscription is acknowledged once, then delivers each event on its stream. */
+        int32_t subscriptionId = client->Subscribe("local/#", outcomes.RecordMessage(), outcomes.Record("subscribe"));
+        ASSERT_INT_EQUALS(2, subscriptionId);
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_INT_EQUALS(2, request.StreamId);
+        ASSERT_TRUE(request.Operation == "aws.greengrass#SubscribeToTopic");
+        ASSERT_TRUE(core.Respond(2, "aws.greengrass#SubscribeToTopicResponse", false));
+
+        const char *event = "{\"binaryMessage\":{\"message\":\"d29ybGQ=\",\"context\":{\"topic\":\"local/a\"}}}";
+        Aws::Crt::String eventHeaders =
+            s_headers(s_applicationMessage, 0, 2, "aws.greengrass#SubscriptionResponseMessage");
+        Aws::Crt::String corrupt = s_frame(eventHeaders, event);
+        corrupt.back() = static_cast<char>(~corrupt.back());
+        ASSERT_TRUE(send(core.PeerFd, corrupt.data(), corrupt.size(), MSG_NOSIGNAL) > 0);
+        ASSERT_TRUE(core.Send(eventHeaders, event));
+        ASSERT_TRUE(core.Ping());
+        ASSERT_UINT_EQUALS(3, outcomes.Count());
+        ASSERT_TRUE(outcomes.Is(1, "subscribe:ok"));
+        /* The message with a bad checksum was dropped; the one after it still arrived. */
+        ASSERT_TRUE(outcomes.Is(2, "message:local/a:world"));
+
+        /* A rejection carries the core's error model. */
+        ASSERT_TRUE(client->Publish("local/denied", s_cursor("no"), outcomes.Record("denied")));
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_INT_EQUALS(3, request.StreamId);
+        ASSERT_TRUE(core.Send(
+            s_headers(s_applicationError, s_terminateStream, 3, "aws.greengrass#UnauthorizedError"),
+            "{\"message\":\"denied\"}"));
+        ASSERT_TRUE(outcomes.WaitFor(4));
+        ASSERT_TRUE(outcomes.Is(3, "denied:error:aws.greengrass#UnauthorizedError"));
+
+        /* Unsubscribing ends the stream on the core's side, and later events on it are ignored. */
+        ASSERT_TRUE(client->Unsubscribe(subscriptionId));
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_INT_EQUALS(s_applicationMessage, request.MessageType);
+        ASSERT_INT_EQUALS(s_terminateStream, request.Flags);
+        ASSERT_INT_EQUALS(2, request.StreamId);
+        ASSERT_FALSE(client->Unsubscribe(subscriptionId));
+        ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+        ASSERT_TRUE(core.Send(eventHeaders, event));
+        ASSERT_TRUE(core.Ping());
+        ASSERT_UINT_EQUALS(4, outcomes.Count());
+
+        client->Close();
+        ASSERT_TRUE(core.SawClose());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(GreengrassIpcClientFrameRoundTrip, s_TestGreengrassIpcClientFrameRoundTrip)
+
+static int s_TestGreengrassIpcClientPeerClose(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        FakeCore core;
+        ASSERT_TRUE(core.ListenFd >= 0);
+        auto client = s_newClient(allocator);
+        ASSERT_NOT_NULL(client.get());
+        ASSERT_TRUE(s_connectTo(core, *client));
+
+        Outcomes outcomes;
+        Frame request;
+        ASSERT_TRUE(client->Subscribe("local/#", outcomes.RecordMessage(), outcomes.Record("subscribe")) != 0);
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_TRUE(core.Respond(request.StreamId, "aws.greengrass#SubscribeToTopicResponse", false));
+        ASSERT_TRUE(outcomes.WaitFor(1));
+        ASSERT_TRUE(client->Publish("local/topic", s_cursor("a"), outcomes.Record("publish")));
+        ASSERT_TRUE(client->PublishToIotCore(
+            "things/a", AWS_MQTT_QOS_AT_LEAST_ONCE, s_cursor("b"), outcomes.Record("iot")));
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_TRUE(request.Operation == "aws.greengrass#PublishToIoTCore");
+
+        /* The core going away fails whatever still awaits an answer; the acknowledged subscription has had its. */
+        core.ClosePeer();
+        ASSERT_TRUE(outcomes.WaitFor(3));
+        ASSERT_UINT_EQUALS(3, outcomes.Count());
+        ASSERT_TRUE(outcomes.Is(0, "subscribe:ok"));
+        ASSERT_TRUE(outcomes.Is(1, "publish:closed"));
+        ASSERT_TRUE(outcomes.Is(2, "iot:closed"));
+        ASSERT_FALSE(client->Publish("local/topic", s_cursor("c"), outcomes.Record("late")));
+
+        /* The dead connection has to be closed before the client connects again. */
+        ASSERT_FALSE(client->Connect());
+        ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, aws_last_error());
+        client->Close();
+        ASSERT_TRUE(s_connectTo(core, *client));
+        ASSERT_TRUE(client->Publish("local/topic", s_cursor("d"), outcomes.Record("again")));
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_TRUE(core.Respond(request.StreamId, "aws.greengrass#PublishToTopicResponse"));
+        ASSERT_TRUE(outcomes.WaitFor(4));
+        ASSERT_TRUE(outcomes.Is(3, "again:ok"));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(GreengrassIpcClientPeerClose, s_TestGreengrassIpcClientPeerClose)
+
+static int s_TestGreengrassIpcClientCloseFromHandler(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        FakeCore core;
+        ASSERT_TRUE(core.ListenFd >= 0);
+        auto client = s_newClient(allocator);
+        ASSERT_NOT_NULL(client.get());
+        ASSERT_TRUE(s_connectTo(core, *client));
+
+        /* Closed from its own reader: what is outstanding fails, and the reader cannot be restarted from there. */
+        Outcomes outcomes;
+        Frame request;
+        Aws::Discovery::GreengrassIpcClient *raw = client.get();
+        auto recordFirst = outcomes.Record("first");
+        ASSERT_TRUE(client->Publish(
+            "local/topic", s_cursor("a"), [raw, &outcomes, recordFirst](int errorCode, const Aws::Crt::String &model) {
+                recordFirst(errorCode, model);
+                raw->Close();
+                bool reconnected = raw->Connect();
+                outcomes.Add(
+                    !reconnected && aws_last_error() == AWS_ERROR_INVALID_STATE ? "reconnect:refused"
+                                                                                : "reconnect:allowed");
+            }));
+        ASSERT_TRUE(client->Publish("local/topic", s_cursor("b"), outcomes.Record("second")));
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_TRUE(core.Respond(1, "aws.greengrass#PublishToTopicResponse"));
+        ASSERT_TRUE(outcomes.WaitFor(3));
+        ASSERT_TRUE(outcomes.Is(0, "first:ok"));
+        ASSERT_TRUE(outcomes.Is(1, "second:closed"));
+        ASSERT_TRUE(outcomes.Is(2, "reconnect:refused"));
+        ASSERT_TRUE(core.SawClose());
+
+        /* Closed again from outside, the reader is joined and the client connects as new. */
+        client->Close();
+        ASSERT_TRUE(s_connectTo(core, *client));
+        ASSERT_TRUE(client->Publish("local/topic", s_cursor("c"), outcomes.Record("again")));
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_TRUE(core.Respond(request.StreamId, "aws.greengrass#PublishToTopicResponse"));
+        ASSERT_TRUE(outcomes.WaitFor(4));
+        ASSERT_TRUE(outcomes.Is(3, "again:ok"));
+
+        /* A handler may drop the last reference: the client is destroyed on the reader, failing what is left. */
+        std::shared_ptr<Aws::Discovery::GreengrassIpcClient> holder = client;
+        client.reset();
+        ASSERT_TRUE(holder->Publish("local/topic", s_cursor("d"), [&holder, &outcomes](int, const Aws::Crt::String &) {
+            holder.reset();
+            outcomes.Add("released");
+        }));
+        ASSERT_TRUE(holder->Publish("local/topic", s_cursor("e"), outcomes.Record("pending")));
+        ASSERT_TRUE(core.Read(request));
+        int32_t releasingStream = request.StreamId;
+        ASSERT_TRUE(core.Read(request));
+        ASSERT_TRUE(core.Respond(releasingStream, "aws.greengrass#PublishToTopicResponse"));
+        ASSERT_TRUE(outcomes.WaitFor(6));
+        ASSERT_TRUE(outcomes.Is(4, "released"));
+        ASSERT_TRUE(outcomes.Is(5, "pending:closed"));
+        ASSERT_TRUE(core.SawClose());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(GreengrassIpcClientCloseFromHandler, s_TestGreengrassIpcClientCloseFromHandler)
@@ -0,0 +1,182 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/IdentityRequestClient.h>
+
+#include <aws/iotdevicecommon/SessionSubscriptions.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+
+        struct CertificateRotationResult
+        {
+            Crt::String CertificateId;
+            Crt::String CertificatePem;
+            /* Set when the certificate was registered with a template. */
+            Crt::String ThingName;
+            /* The connection authenticated with the new certificate. */
+            std::shared_ptr<Crt::Mqtt::MqttConnection> Connection;
+        };
+
+        /**
+         * Builds, without connecting it, a connection authenticated with the new certificate and the private
+         * key of the CSR. Only the certificate fields of `result` are set. Returns null to abort the rotation.
+         */
+        using CreateRotatedConnection =
+            std::function<std::shared_ptr<Crt::Mqtt::MqttConnection>(const CertificateRotationResult &result)>;
+
+        /**
+         * Invoked once the subscriptions are live on the new connection and before the previous one is
+         * disconnected: the place to move service clients and publishers over to `connection`.
+         */
+        using OnConnectionCutOver = std::function<void(const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection)>;
+
+        /**
+         * Completion callback of a rotation. `result` is set once the previous connection was handed over;
+         * `error` is set when a stage was rejected; both are null when the rotation failed locally with ioErr.
+         * On failure the previous connection is left untouched.
+         */
+        using OnCertificateRotationComplete =
+            std::function<void(CertificateRotationResult *result, Aws::Iotidentity::ErrorResponse *error, int ioErr)>;
+
+        class AWS_IOTIDENTITY_API CertificateRotationConfig final
+        {
+          public:
+            CertificateRotationConfig() noexcept;
+            CertificateRotationConfig(const CertificateRotationConfig &rhs) = default;
+            CertificateRotationConfig(CertificateRotationConfig &&rhs) = default;
+
+            CertificateRotationConfig &operator=(const CertificateRotationConfig &rhs) = default;
+            CertificateRotationConfig &operator=(CertificateRotationConfig &&rhs) = default;
+
+            ~CertificateRotationConfig() = default;
+
+            /**
+             * The CSR the new certificate is signed from. Required.
+             */
+            Crt::String CertificateSigningRequest;
+
+            /**
+             * The fleet provisioning template to register the new certificate with, e.g. to attach the thing's
+             * policy to it. The certificate is not registered when empty.
+             */
+            Crt::String TemplateName;
+            Crt::Map<Crt::String, Crt::String> TemplateParameters;
+
+            /**
+             * Builds the new connection. Required.
+             */
+            CreateRotatedConnection CreateConnection;
+
+            /**
+             * Client id the new connection connects with. AWS IoT disconnects an existing connection with the
+             * same client id, so this must differ from the previous connection's for the two to overlap.
+             * Required.
+             */
+            Crt::String ClientId;
+            uint16_t KeepAliveTimeSecs;
+
+            /**
+             * The subscriptions of the service clients on the previous connection, restored on the new one
+             * before the cut-over. Optional.
+             */
+            std::shared_ptr<Iotdevicecommon::SessionSubscriptions> Session;
+
+            /**
+             * Optional.
+             */
+            OnConnectionCutOver OnCutOver;
+
+            /**
+             * Whether the previous connection is disconnected after the cut-over. Defaults to true.
+             */
+            bool DisconnectPrevious;
+
+            /**
+             * The QoS used for the identity requests.
+             */
+            Crt::Mqtt::QOS Qos;
+
+            /**
+             * Time, in milliseconds, to wait for each identity response before failing the rotation with
+             * AWS_ERROR_MQTT_TIMEOUT. Zero disables the timeout.
+             */
+            uint32_t RequestTimeoutMs;
+        };
+
+        /**
+         * Rotates a device's certificate without dropping its connection: CreateCertificateFromCsr, optionally
+         * RegisterThing, then a second connection with the new certificate is opened next to the previous
+         * one, the recorded SessionSubscriptions are restored on it, and only then are the service clients
+         * handed over and the previous connection disconnected.
+         *
+         * Messages published while both connections are subscribed may be delivered on each. The new
+         * connection's OnConnectionResumed should Resume() the session, as for the previous one.
+         *
+         * One rotation per instance; keep it alive until the rotation completes.
+         */
+        class AWS_IOTIDENTITY_API CertificateRotation final : public std::enable_shared_from_this<CertificateRotation>
+        {
+          public:
+            CertificateRotation(const CertificateRotation &) = delete;
+            CertificateRotation(CertificateRotation &&) = delete;
+            CertificateRotation &operator=(const CertificateRotation &) = delete;
+            CertificateRotation &operator=(CertificateRotation &&) = delete;
+
+            ~CertificateRotation() = default;
+
+            /**
+             * Starts the rotation. onComplete is invoked exactly once if this returns true.
+             *
+             * @return false, with AWS_ERROR_INVALID_STATE raised, if the rotation was started already.
+             */
+            bool Start(const OnCertificateRotationComplete &onComplete);
+
+            /**
+             * @param client identity client on the previous connection.
+             * @param eventLoopGroup runs the identity request timeouts.
+             * @param previousConnection the connection being replaced.
+             */
+            static std::shared_ptr<CertificateRotation> Create(
+                const IotIdentityClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &previousConnection,
+                const CertificateRotationConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            CertificateRotation(
+                const std::shared_ptr<IdentityRequestClient> &requests,
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &previousConnection,
+                const CertificateRotationConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            void OnCertificateCreated(CreateCertificateFromCsrResponse *response, ErrorResponse *error, int ioErr);
+            void OnThingRegistered(RegisterThingResponse *response, ErrorResponse *error, int ioErr);
+            void Connect();
+            void OnConnected(int errorCode, Crt::Mqtt::ReturnCode returnCode, bool sessionPresent);
+            void OnMigrated(int errorCode);
+            void Finish(CertificateRotationResult *result, ErrorResponse *error, int ioErr);
+
+            std::shared_ptr<IdentityRequestClient> m_requests;
+            std::shared_ptr<Crt::Mqtt::MqttConnection> m_previousConnection;
+            CertificateRotationConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            std::mutex m_lock;
+            bool m_started;
+            bool m_connecting;
+            OnCertificateRotationComplete m_onComplete;
+            CertificateRotationResult m_result;
+        };
+
+    } // namespace Iotidentity
+
+} // namespace Aws
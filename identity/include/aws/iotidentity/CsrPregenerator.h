@@ -0,0 +1,138 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/Exports.h>
+
+#include <aws/crt/Types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+
+        /**
+         * A freshly generated key pair and the certificate signing request for it.
+         */
+        struct CsrMaterial
+        {
+            Crt::String CertificateSigningRequest;
+            Crt::String PrivateKeyPem;
+        };
+
+        /**
+         * Generates one key pair and CSR into `material`. Called concurrently from the worker threads.
+         *
+         * @return false if generation failed.
+         */
+        using CsrGenerator = std::function<bool(CsrMaterial &material)>;
+
+        class AWS_IOTIDENTITY_API CsrPregeneratorConfig final
+        {
+          public:
+            CsrPregeneratorConfig() noexcept;
+            CsrPregeneratorConfig(const CsrPregeneratorConfig &rhs) = default;
+            CsrPregeneratorConfig(CsrPregeneratorConfig &&rhs) = default;
+
+            CsrPregeneratorConfig &operator=(const CsrPregeneratorConfig &rhs) = default;
+            CsrPregeneratorConfig &operator=(CsrPregeneratorConfig &&rhs) = default;
+
+            ~CsrPregeneratorConfig() = default;
+
+            /**
+             * Produces the keys and CSRs, e.g. with OpenSSL or a PKCS#11 token. Required.
+             */
+            CsrGenerator Generator;
+
+            /**
+             * Most CSRs held ready at once. Workers pause while the queue is full.
+             */
+            size_t Capacity;
+
+            /**
+             * Number of worker threads. Zero uses one per hardware thread.
+             */
+            size_t ThreadCount;
+
+            /**
+             * Time, in milliseconds, a worker waits after a failed generation before retrying.
+             */
+            uint32_t FailureBackoffMs;
+        };
+
+        /**
+         * Keeps a bounded queue of pre-generated key pairs and CSRs topped up on background threads, so
+         * CreateCertificateFromCsr requests can be issued back-to-back without waiting on key generation.
+         *
+         * The SDK does not link a crypto library, so the generation itself is supplied through
+         * CsrPregeneratorConfig::Generator. Queued private keys are held in process memory until taken.
+         */
+        class AWS_IOTIDENTITY_API CsrPregenerator final
+        {
+          public:
+            CsrPregenerator(const CsrPregenerator &) = delete;
+            CsrPregenerator(CsrPregenerator &&) = delete;
+            CsrPregenerator &operator=(const CsrPregenerator &) = delete;
+            CsrPregenerator &operator=(CsrPregenerator &&) = delete;
+
+            /**
+             * Stops and joins the workers, discarding any queued material.
+             */
+            ~CsrPregenerator();
+
+            /**
+             * Takes the oldest ready CSR without waiting.
+             *
+             * @return false if none is ready.
+             */
+            bool TryTake(CsrMaterial &material);
+
+            /**
+             * Takes the oldest ready CSR, waiting up to timeoutMs for one to be generated.
+             *
+             * @return false if none became ready in time.
+             */
+            bool Take(CsrMaterial &material, uint32_t timeoutMs);
+
+            size_t GetReadyCount() const;
+
+            /**
+             * @return the number of generation attempts that failed.
+             */
+            uint64_t GetFailedCount() const noexcept { return m_failedCount.load(); }
+
+            static std::shared_ptr<CsrPregenerator> Create(
+                const CsrPregeneratorConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            CsrPregenerator(const CsrPregeneratorConfig &config, size_t threadCount) noexcept;
+
+            void RunWorker();
+
+            CsrPregeneratorConfig m_config;
+
+            mutable std::mutex m_lock;
+            std::condition_variable m_spaceAvailable;
+            std::condition_variable m_materialReady;
+            std::deque<CsrMaterial> m_ready;
+            /* Generations under way, counted against Capacity so workers do not overshoot it. */
+            size_t m_generating;
+            bool m_stopping;
+
+            std::atomic<uint64_t> m_failedCount;
+            Crt::Vector<std::thread> m_workers;
+        };
+
+    } // namespace Iotidentity
+
+} // namespace Aws
@@ -0,0 +1,107 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/Exports.h>
+
+#include <aws/crt/Types.h>
+#include <aws/crt/io/TlsOptions.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        class CreateKeysAndCertificateResponse;
+        class RegisterThingResponse;
+
+        /**
+         * What a device keeps of its provisioning.
+         */
+        struct DeviceCredentials
+        {
+            Crt::String CertificateId;
+            Crt::String CertificatePem;
+            Crt::String PrivateKey;
+            Crt::String ThingName;
+            Crt::Map<Crt::String, Crt::String> DeviceConfiguration;
+        };
+
+        /**
+         * Persists a device's certificate, private key and registration in one file, and loads them back with a
+         * single read into one buffer that the accessors and NewTlsContextOptions() point into, without
+         * parsing or copying.
+         *
+         * Save() writes a complete new file next to the store and renames it over the old one, so a device
+         * powered off mid-save boots with either the previous credentials or the new ones. Load() rejects a
+         * truncated or corrupted file by its checksum. The file holds the private key in the clear: keep it in
+         * a directory only the device's process can read.
+         */
+        class AWS_IOTIDENTITY_API DeviceCredentialStore final
+        {
+          public:
+            explicit DeviceCredentialStore(const char *path, Crt::Allocator *allocator = Crt::DefaultAllocator());
+            DeviceCredentialStore(const DeviceCredentialStore &) = delete;
+            DeviceCredentialStore(DeviceCredentialStore &&) = delete;
+            DeviceCredentialStore &operator=(const DeviceCredentialStore &) = delete;
+            DeviceCredentialStore &operator=(DeviceCredentialStore &&) = delete;
+
+            ~DeviceCredentialStore() = default;
+
+            /**
+             * Atomically replaces the stored credentials, and the loaded ones with them.
+             *
+             * @return false, with AWS_ERROR_SYS_CALL_FAILURE raised, if the file could not be written; the
+             * stored credentials are then unchanged.
+             */
+            bool Save(const DeviceCredentials &credentials);
+
+            /**
+             * Saves the outcome of a fleet provisioning CreateKeysAndCertificate -> RegisterThing flow.
+             */
+            bool Save(const CreateKeysAndCertificateResponse &keys, const RegisterThingResponse &registration);
+
+            /**
+             * Loads the stored credentials.
+             *
+             * @return false if there are none, or, with AWS_ERROR_INVALID_ARGUMENT raised, if the file is damaged.
+             */
+            bool Load();
+
+            bool IsLoaded() const noexcept { return m_loaded; }
+
+            /**
+             * Valid until the next Save() or Load().
+             */
+            Crt::ByteCursor GetCertificateId() const noexcept { return m_certificateId; }
+            Crt::ByteCursor GetCertificatePem() const noexcept { return m_certificatePem; }
+            Crt::ByteCursor GetPrivateKey() const noexcept { return m_privateKey; }
+            Crt::ByteCursor GetThingName() const noexcept { return m_thingName; }
+
+            /**
+             * Decodes the stored device configuration.
+             */
+            Crt::Map<Crt::String, Crt::String> GetDeviceConfiguration() const;
+
+            /**
+             * @return mutual TLS options for the loaded certificate and key, straight from the loaded buffer.
+             */
+            Crt::Io::TlsContextOptions NewTlsContextOptions() const noexcept;
+
+          private:
+            bool Index();
+
+            Crt::String m_path;
+            Crt::Allocator *m_allocator;
+            Crt::String m_contents;
+            bool m_loaded;
+            Crt::ByteCursor m_certificateId;
+            Crt::ByteCursor m_certificatePem;
+            Crt::ByteCursor m_privateKey;
+            Crt::ByteCursor m_thingName;
+            Crt::ByteCursor m_deviceConfiguration;
+        };
+
+    } // namespace Iotidentity
+
+} // namespace Aws
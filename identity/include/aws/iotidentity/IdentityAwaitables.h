@@ -0,0 +1,34 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/Awaitable.h>
+
+#ifdef AWS_IOTDEVICECOMMON_COROUTINES
+
+#    include <aws/iotidentity/ErrorResponse.h>
+#    include <aws/iotidentity/ProvisioningPipeline.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+
+        /**
+         * co_await-able form of ProvisioningPipeline::Provision (C++20 only). See Iotdevicecommon Awaitable.h for
+         * where the coroutine resumes.
+         */
+        inline Iotdevicecommon::OperationAwaiter<Iotdevicecommon::ResponseResult<ProvisioningResult, ErrorResponse>>
+            AwaitProvision(const std::shared_ptr<ProvisioningPipeline> &pipeline, const ProvisioningRequest &request)
+        {
+            return Iotdevicecommon::AwaitResponse<ProvisioningResult, ErrorResponse>(
+                [pipeline, request](OnProvisioningComplete &&onComplete) {
+                    return pipeline->Provision(request, onComplete);
+                });
+        }
+
+    } // namespace Iotidentity
+} // namespace Aws
+
+#endif // AWS_IOTDEVICECOMMON_COROUTINES
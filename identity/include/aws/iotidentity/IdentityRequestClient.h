@@ -0,0 +1,225 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/IotIdentityClient.h>
+
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/iotdevicecommon/TimerWheel.h>
+
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+
+        /**
+         * Completion callbacks for identity requests. Exactly one of `response` (accepted) or `error`
+         * (rejected) is set on success; both are null when the request failed locally or timed out, with the
+         * reason in ioErr.
+         */
+        using OnCreateKeysAndCertificateComplete = std::function<
+            void(Aws::Iotidentity::CreateKeysAndCertificateResponse *, Aws::Iotidentity::ErrorResponse *, int ioErr)>;
+        using OnCreateCertificateFromCsrComplete = std::function<
+            void(Aws::Iotidentity::CreateCertificateFromCsrResponse *, Aws::Iotidentity::ErrorResponse *, int ioErr)>;
+        using OnRegisterThingComplete = std::function<
+            void(Aws::Iotidentity::RegisterThingResponse *, Aws::Iotidentity::ErrorResponse *, int ioErr)>;
+
+        class AWS_IOTIDENTITY_API IdentityRequestClientConfig final
+        {
+          public:
+            IdentityRequestClientConfig() noexcept;
+            IdentityRequestClientConfig(const IdentityRequestClientConfig &rhs) = default;
+            IdentityRequestClientConfig(IdentityRequestClientConfig &&rhs) = default;
+
+            IdentityRequestClientConfig &operator=(const IdentityRequestClientConfig &rhs) = default;
+            IdentityRequestClientConfig &operator=(IdentityRequestClientConfig &&rhs) = default;
+
+            ~IdentityRequestClientConfig() = default;
+
+            /**
+             * The QoS used for subscriptions and request publishes.
+             */
+            Crt::Mqtt::QOS Qos;
+
+            /**
+             * Time, in milliseconds, to wait for an accepted/rejected response before completing the request
+             * with AWS_ERROR_MQTT_TIMEOUT. Zero disables the timeout.
+             */
+            uint32_t RequestTimeoutMs;
+
+            /**
+             * If set, the request timeouts are kept in this wheel, shared with the client's other components,
+             * instead of scheduling a task per request.
+             */
+            std::shared_ptr<Iotdevicecommon::TimerWheel> Timers;
+        };
+
+        /**
+         * Asynchronous request/response API over IotIdentityClient with long-lived subscriptions.
+         *
+         * The accepted and rejected topics of an operation (and, for RegisterThing, of a template) are
+         * subscribed to by its first request and reused by every later one, so after warm-up each request
+         * costs one publish and one response rather than two extra SUBACK round-trips. Requests issued while
+         * the subscriptions are pending are published once they complete.
+         *
+         * The fleet provisioning API carries no request identifier, so each operation (each template, for
+         * RegisterThing) has at most one request awaiting a response; later ones wait their turn in order. An
+         * accepted CreateCertificateFromCsr response is also only taken if its certificate carries the public
+         * key of the request's CSR. When a request's PUBACK fails, it times out, or it is cancelled, its
+         * response may still be on the way, so its operation publishes nothing further for RequestTimeoutMs
+         * and drops the responses received meanwhile. Nothing else on the connection may issue provisioning
+         * requests.
+         */
+        class AWS_IOTIDENTITY_API IdentityRequestClient final
+            : public std::enable_shared_from_this<IdentityRequestClient>
+        {
+          public:
+            IdentityRequestClient(const IdentityRequestClient &) = delete;
+            IdentityRequestClient(IdentityRequestClient &&) = delete;
+            IdentityRequestClient &operator=(const IdentityRequestClient &) = delete;
+            IdentityRequestClient &operator=(IdentityRequestClient &&) = delete;
+
+            ~IdentityRequestClient() = default;
+
+            /**
+             * Subscribes ahead of the first request to the accepted and rejected topics of
+             * CreateCertificateFromCsr and, unless templateName is empty, of RegisterThing for that template.
+             * onSubAck is invoked once, after all subscriptions complete, with the first error encountered (if
+             * any). Requests subscribe on their own otherwise.
+             */
+            bool Subscribe(const Crt::String &templateName, const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Each returns false, with AWS_ERROR_LIST_EXCEEDS_MAX_SIZE raised, when the client's MemoryBudget has
+             * no room for another pending request.
+             */
+            bool CreateKeysAndCertificateAsync(
+                const CreateKeysAndCertificateRequest &request,
+                const OnCreateKeysAndCertificateComplete &onComplete);
+            bool CreateCertificateFromCsrAsync(
+                const CreateCertificateFromCsrRequest &request,
+                const OnCreateCertificateFromCsrComplete &onComplete);
+
+            /**
+             * request.TemplateName is required.
+             */
+            bool RegisterThingAsync(const RegisterThingRequest &request, const OnRegisterThingComplete &onComplete);
+
+            /**
+             * Completes every pending request with errorCode, e.g. after the connection was lost. The
+             * subscriptions are kept.
+             */
+            void CancelAll(int errorCode);
+
+            /**
+             * @param eventLoopGroup runs the request timeouts when no TimerWheel is configured.
+             */
+            static std::shared_ptr<IdentityRequestClient> Create(
+                const IotIdentityClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const IdentityRequestClientConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            using PublishRequest = std::function<bool(const OnPublishComplete &onPubAck)>;
+            using CompleteRequest = std::function<void(void *response, ErrorResponse *error, int ioErr)>;
+
+            struct PendingRequest
+            {
+                PublishRequest Publish;
+                CompleteRequest OnComplete;
+                /* The CSR's public key, which an accepted response's certificate must carry; empty if unchecked. */
+                Crt::Vector<uint8_t> PublicKey;
+                /* Pending-request share of the client's MemoryBudget, released with the request. */
+                Iotdevicecommon::MemoryBudget::Slot BudgetSlot;
+            };
+
+            enum class Operation
+            {
+                CreateKeysAndCertificate,
+                CreateCertificateFromCsr,
+                RegisterThing,
+            };
+
+            /**
+             * The accepted/rejected subscription pair of one operation and the requests using it.
+             */
+            struct Channel
+            {
+                enum class State
+                {
+                    Unsubscribed,
+                    Subscribing,
+                    Subscribed,
+                };
+
+                Channel(Operation kind, const Crt::String &templateName) : Kind(kind), TemplateName(templateName) {}
+
+                Operation Kind;
+                Crt::String TemplateName;
+
+                State SubscriptionState = State::Unsubscribed;
+                int RemainingSubAcks = 0;
+                int SubscribeError = AWS_ERROR_SUCCESS;
+                /* Invoked once the subscriptions in progress complete. */
+                Crt::Vector<OnSubscribeComplete> SubAckWaiters;
+
+                /* Waiting, in order, for the subscriptions or for the outstanding request. */
+                Crt::List<std::shared_ptr<PendingRequest>> Unpublished;
+                /* Published and waiting for its response. */
+                std::shared_ptr<PendingRequest> Outstanding;
+                /* Holding back publishes until a response to an abandoned request can no longer arrive. */
+                bool Quarantined = false;
+                /* Identifies the current outstanding request or quarantine to its timer and PUBACK. */
+                uint64_t Generation = 0;
+                /* The current timer in the config's Timers, or 0. */
+                uint64_t TimerId = 0;
+            };
+
+            IdentityRequestClient(
+                const IotIdentityClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const IdentityRequestClientConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            std::shared_ptr<Channel> GetRegisterChannel(const Crt::String &templateName);
+            bool BeginSubscribing(Channel &channel);
+            void StartSubscribing(const std::shared_ptr<Channel> &channel);
+            int SubscribeChannel(const std::shared_ptr<Channel> &channel, const OnSubscribeComplete &onSubAck);
+            void OnChannelSubAck(const std::shared_ptr<Channel> &channel, int ioErr);
+
+            bool Submit(const std::shared_ptr<Channel> &channel, PendingRequest &&request);
+            void PublishNext(const std::shared_ptr<Channel> &channel);
+            void Complete(
+                const std::shared_ptr<Channel> &channel,
+                void *response,
+                ErrorResponse *error,
+                const Crt::Vector<uint8_t> *certificateKey);
+            void Abandon(const std::shared_ptr<Channel> &channel, uint64_t generation, int errorCode);
+            void ScheduleTimer(const std::shared_ptr<Channel> &channel, uint64_t generation);
+            void CancelTimer(uint64_t timerId);
+
+            template <typename Response>
+            std::function<void(Response *, int)> MakeAcceptedHandler(const std::shared_ptr<Channel> &channel);
+            std::function<void(ErrorResponse *, int)> MakeRejectedHandler(const std::shared_ptr<Channel> &channel);
+
+            IotIdentityClient m_client;
+            IdentityRequestClientConfig m_config;
+            Crt::Allocator *m_allocator;
+            aws_event_loop *m_eventLoop;
+
+            std::mutex m_lock;
+            std::shared_ptr<Channel> m_keysChannel;
+            std::shared_ptr<Channel> m_csrChannel;
+            Crt::Map<Crt::String, std::shared_ptr<Channel>> m_registerChannels;
+        };
+
+    } // namespace Iotidentity
+
+} // namespace Aws
@@ -10,6 +10,9 @@
 
 #include <aws/crt/mqtt/MqttClient.h>
 
+#include <aws/iotdevicecommon/InlineFunction.h>
+#include <aws/iotdevicecommon/ServiceClientConfig.h>
+
 namespace Aws
 {
     namespace Iotidentity
@@ -26,8 +29,17 @@ namespace Aws
         class RegisterThingResponse;
         class RegisterThingSubscriptionRequest;
 
-        using OnSubscribeComplete = std::function<void(int ioErr)>;
-        using OnPublishComplete = std::function<void(int ioErr)>;
+        /*
+         * Completions are copied into every request, so they hold small callables in place rather than on the
+         * heap; any callable a std::function accepts converts to them.
+         */
+        using OnSubscribeComplete = Aws::Iotdevicecommon::InlineFunction<void(int ioErr)>;
+        using OnPublishComplete = Aws::Iotdevicecommon::InlineFunction<void(int ioErr)>;
+
+        /*
+         * Subscription handlers are passed a model that the client does not use again once they return, so they
+         * may move out of it; Iotdevicecommon::TakeResponse adapts a handler that takes ownership instead.
+         */
 
         using OnSubscribeToCreateCertificateFromCsrAcceptedResponse =
             std::function<void(Aws::Iotidentity::CreateCertificateFromCsrResponse *, int ioErr)>;
@@ -47,49 +59,100 @@ namespace Aws
         using OnSubscribeToCreateCertificateFromCsrRejectedResponse =
             std::function<void(Aws::Iotidentity::ErrorResponse *, int ioErr)>;
 
+        /**
+         * Publish* and Subscribe* may be called concurrently from any number of threads. Each publish
+         * serializes into its own pooled buffer and goes straight to the connection, whose publish is
+         * thread-safe; metrics, tracing and the buffer pool are internally synchronized and shared across
+         * calls. Response handlers run on the event loop thread, or the handler executor when one is set.
+         */
         class AWS_IOTIDENTITY_API IotIdentityClient final
         {
           public:
-            IotIdentityClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection);
+            IotIdentityClient(
+                const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+                Aws::Crt::Allocator *allocator = Aws::Crt::DefaultAllocator());
+            IotIdentityClient(
+                const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+                const Aws::Iotdevicecommon::ServiceClientConfig &config,
+                Aws::Crt::Allocator *allocator = Aws::Crt::DefaultAllocator());
 
             operator bool() const noexcept;
             int GetLastError() const noexcept;
 
+            /**
+             * @return the budget from the client's ServiceClientConfig, which helpers issuing requests through
+             * the client consult for their pending requests; null if none.
+             */
+            const std::shared_ptr<Aws::Iotdevicecommon::MemoryBudget> &GetMemoryBudget() const noexcept
+            {
+                return m_memoryBudget;
+            }
+
             bool SubscribeToCreateCertificateFromCsrAccepted(
                 const Aws::Iotidentity::CreateCertificateFromCsrSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToCreateCertificateFromCsrAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToCreateCertificateFromCsrAccepted(
+                const Aws::Iotidentity::CreateCertificateFromCsrSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToCreateCertificateFromCsrAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToCreateKeysAndCertificateRejected(
                 const Aws::Iotidentity::CreateKeysAndCertificateSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToCreateKeysAndCertificateRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToCreateKeysAndCertificateRejected(
+                const Aws::Iotidentity::CreateKeysAndCertificateSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToCreateKeysAndCertificateRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToRegisterThingAccepted(
                 const Aws::Iotidentity::RegisterThingSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToRegisterThingAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToRegisterThingAccepted(
+                const Aws::Iotidentity::RegisterThingSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToRegisterThingAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToRegisterThingRejected(
                 const Aws::Iotidentity::RegisterThingSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToRegisterThingRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToRegisterThingRejected(
+                const Aws::Iotidentity::RegisterThingSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToRegisterThingRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToCreateKeysAndCertificateAccepted(
                 const Aws::Iotidentity::CreateKeysAndCertificateSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToCreateKeysAndCertificateAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToCreateKeysAndCertificateAccepted(
+                const Aws::Iotidentity::CreateKeysAndCertificateSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToCreateKeysAndCertificateAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToCreateCertificateFromCsrRejected(
                 const Aws::Iotidentity::CreateCertificateFromCsrSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToCreateCertificateFromCsrRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToCreateCertificateFromCsrRejected(
+                const Aws::Iotidentity::CreateCertificateFromCsrSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToCreateCertificateFromCsrRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool PublishCreateCertificateFromCsr(
                 const Aws::Iotidentity::CreateCertificateFromCsrRequest &request,
@@ -107,7 +170,22 @@ namespace Aws
                 const OnPublishComplete &onPubAck);
 
           private:
+            Aws::Crt::Allocator *m_allocator;
+            Aws::Crt::StlAllocator<char> m_stringAllocator;
             std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> m_connection;
+            std::shared_ptr<Aws::Iotdevicecommon::PayloadBufferPool> m_payloadBufferPool;
+            Aws::Iotdevicecommon::PayloadFormat m_payloadFormat;
+            /* Shared by every subscription's publish handler. */
+            std::shared_ptr<const Aws::Iotdevicecommon::HandlerContext> m_handlerContext;
+            std::shared_ptr<Aws::Iotdevicecommon::ServiceMetrics> m_metrics;
+            std::shared_ptr<Aws::Iotdevicecommon::RequestTracer> m_tracer;
+            std::shared_ptr<Aws::Iotdevicecommon::SessionSubscriptions> m_session;
+            std::shared_ptr<Aws::Iotdevicecommon::MemoryBudget> m_memoryBudget;
+            std::shared_ptr<Aws::Iotdevicecommon::PublishCompletionBatcher> m_completionBatcher;
+            std::shared_ptr<Aws::Iotdevicecommon::PublishLanes> m_publishLanes;
+            std::shared_ptr<Aws::Iotdevicecommon::RequestRateLimiter> m_rateLimiter;
+            std::shared_ptr<Aws::Iotdevicecommon::HotStandby> m_hotStandby;
+            Aws::Iotdevicecommon::QosPolicy m_qosPolicy;
         };
 
     } // namespace Iotidentity
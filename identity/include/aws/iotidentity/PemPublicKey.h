@@ -0,0 +1,26 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/Exports.h>
+
+#include <aws/crt/Types.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+
+        /**
+         * Reads the public key out of a PEM certificate ("CERTIFICATE") or certificate signing request
+         * ("CERTIFICATE REQUEST"), without verifying either. The fleet provisioning responses carry no request
+         * identifier, so this is how a certificate is matched to the CSR it was signed from.
+         *
+         * @return the DER SubjectPublicKeyInfo, or an empty vector if `pem` is neither.
+         */
+        AWS_IOTIDENTITY_API Crt::Vector<uint8_t> PublicKeyOfPem(const Crt::String &pem);
+
+    } // namespace Iotidentity
+
+} // namespace Aws
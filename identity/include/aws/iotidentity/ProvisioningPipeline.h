@@ -0,0 +1,186 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/IdentityRequestClient.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+
+        /**
+         * One device to provision: a CSR to sign and the template parameters to register it with.
+         */
+        struct ProvisioningRequest
+        {
+            Crt::String CertificateSigningRequest;
+            Crt::Map<Crt::String, Crt::String> Parameters;
+        };
+
+        struct ProvisioningResult
+        {
+            Crt::String CertificateId;
+            Crt::String CertificatePem;
+            Crt::String ThingName;
+            Crt::Map<Crt::String, Crt::String> DeviceConfiguration;
+        };
+
+        /**
+         * Completion callback of one provisioning flow. `result` is set once the thing is registered; `error` is
+         * set when either stage was rejected; both are null when the flow failed locally with ioErr.
+         */
+        using OnProvisioningComplete =
+            std::function<void(ProvisioningResult *result, Aws::Iotidentity::ErrorResponse *error, int ioErr)>;
+
+        /**
+         * Time from submitting a stage's request to receiving its accepted or rejected response, including the
+         * wait behind the stage's previous request.
+         */
+        struct ProvisioningStageStats
+        {
+            uint64_t Count = 0;
+            uint64_t TotalNs = 0;
+            uint64_t MaxNs = 0;
+        };
+
+        struct ProvisioningStats
+        {
+            uint64_t Succeeded = 0;
+            uint64_t Failed = 0;
+            ProvisioningStageStats CreateCertificate;
+            ProvisioningStageStats RegisterThing;
+        };
+
+        class AWS_IOTIDENTITY_API ProvisioningPipelineConfig final
+        {
+          public:
+            ProvisioningPipelineConfig() noexcept;
+            ProvisioningPipelineConfig(const ProvisioningPipelineConfig &rhs) = default;
+            ProvisioningPipelineConfig(ProvisioningPipelineConfig &&rhs) = default;
+
+            ProvisioningPipelineConfig &operator=(const ProvisioningPipelineConfig &rhs) = default;
+            ProvisioningPipelineConfig &operator=(ProvisioningPipelineConfig &&rhs) = default;
+
+            ~ProvisioningPipelineConfig() = default;
+
+            /**
+             * The fleet provisioning template devices are registered with.
+             */
+            Crt::String TemplateName;
+
+            /**
+             * Maximum number of devices being provisioned at once. Further devices are queued in order.
+             */
+            size_t MaxInFlight;
+
+            /**
+             * The QoS used for subscriptions and request publishes.
+             */
+            Crt::Mqtt::QOS Qos;
+
+            /**
+             * Time, in milliseconds, to wait for each stage's response before failing the flow with
+             * AWS_ERROR_MQTT_TIMEOUT. Zero disables the timeout.
+             */
+            uint32_t StageTimeoutMs;
+
+            /**
+             * If set, the stage timeouts are kept in this wheel instead of scheduling a task per request.
+             */
+            std::shared_ptr<Iotdevicecommon::TimerWheel> Timers;
+        };
+
+        /**
+         * Runs many CreateCertificateFromCsr -> RegisterThing flows concurrently over one IotIdentityClient,
+         * with a bounded number in flight and per-stage latency statistics.
+         *
+         * The fleet provisioning API carries no request identifier, so the requests go through an
+         * IdentityRequestClient: each stage has one request awaiting a response at a time, certificates are
+         * checked against the flow's CSR, and a stage that times out holds back its next request for
+         * StageTimeoutMs. Flows therefore overlap one stage with the other rather than running MaxInFlight
+         * requests at once; MaxInFlight bounds how many have started. Nothing else on the connection may issue
+         * provisioning requests. Call Subscribe() once before provisioning.
+         */
+        class AWS_IOTIDENTITY_API ProvisioningPipeline final : public std::enable_shared_from_this<ProvisioningPipeline>
+        {
+          public:
+            ProvisioningPipeline(const ProvisioningPipeline &) = delete;
+            ProvisioningPipeline(ProvisioningPipeline &&) = delete;
+            ProvisioningPipeline &operator=(const ProvisioningPipeline &) = delete;
+            ProvisioningPipeline &operator=(ProvisioningPipeline &&) = delete;
+
+            ~ProvisioningPipeline() = default;
+
+            /**
+             * Subscribes to the accepted and rejected topics of both stages. onSubAck is invoked once, after
+             * all subscriptions complete, with the first error encountered (if any).
+             */
+            bool Subscribe(const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Queues one device. onComplete is invoked exactly once.
+             */
+            bool Provision(const ProvisioningRequest &request, const OnProvisioningComplete &onComplete);
+
+            /**
+             * Completes every queued and in-flight flow with errorCode, e.g. after the connection was lost.
+             */
+            void CancelAll(int errorCode);
+
+            ProvisioningStats GetStats() const;
+            size_t GetInFlightCount() const;
+            size_t GetQueuedCount() const;
+
+            /**
+             * @param eventLoopGroup runs the stage timeouts when no TimerWheel is configured.
+             */
+            static std::shared_ptr<ProvisioningPipeline> Create(
+                const IotIdentityClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const ProvisioningPipelineConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Flow
+            {
+                ProvisioningRequest Request;
+                OnProvisioningComplete OnComplete;
+                uint64_t StageStartNs = 0;
+                ProvisioningResult Result;
+            };
+
+            using FlowQueue = Crt::List<std::shared_ptr<Flow>>;
+
+            ProvisioningPipeline(
+                const std::shared_ptr<IdentityRequestClient> &requests,
+                const ProvisioningPipelineConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            void Pump();
+            void StartCreateCertificate(const std::shared_ptr<Flow> &flow);
+            void StartRegisterThing(const std::shared_ptr<Flow> &flow, const Crt::String &ownershipToken);
+            void RecordStage(ProvisioningStageStats &stats, const Flow &flow);
+            void Finish(
+                const std::shared_ptr<Flow> &flow,
+                ProvisioningResult *result,
+                ErrorResponse *error,
+                int ioErr);
+
+            std::shared_ptr<IdentityRequestClient> m_requests;
+            ProvisioningPipelineConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            FlowQueue m_queued;
+            size_t m_inFlight;
+            ProvisioningStats m_stats;
+        };
+
+    } // namespace Iotidentity
+
+} // namespace Aws
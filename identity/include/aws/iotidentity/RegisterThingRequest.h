@@ -8,6 +8,7 @@
 
 #include <aws/crt/JsonObject.h>
 #include <aws/crt/StlAllocator.h>
+#include <aws/iotdevicecommon/PayloadWriter.h>
 
 namespace Aws
 {
@@ -24,6 +25,11 @@ namespace Aws
 
             void SerializeToObject(Crt::JsonObject &doc) const;
 
+            /**
+             * Streams this object into a payload encoder, without building an intermediate JsonObject.
+             */
+            void SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const;
+
             Aws::Crt::Optional<Aws::Crt::String> TemplateName;
             Aws::Crt::Optional<Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>> Parameters;
             Aws::Crt::Optional<Aws::Crt::String> CertificateOwnershipToken;
@@ -0,0 +1,287 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/CertificateRotation.h>
+
+#include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
+#include <aws/iotidentity/CreateCertificateFromCsrResponse.h>
+#include <aws/iotidentity/ErrorResponse.h>
+#include <aws/iotidentity/RegisterThingRequest.h>
+#include <aws/iotidentity/RegisterThingResponse.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        CertificateRotationConfig::CertificateRotationConfig() noexcept
+            : CertificateSigningRequest(), TemplateName(), TemplateParameters(), CreateConnection(), ClientId(),
+              KeepAliveTimeSecs(0), Session(), OnCutOver(), DisconnectPrevious(true), Qos(AWS_MQTT_QOS_AT_LEAST_ONCE),
+              RequestTimeoutMs(30000)
+        {
+        }
+
+        CertificateRotation::CertificateRotation(
+            const std::shared_ptr<IdentityRequestClient> &requests,
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &previousConnection,
+            const CertificateRotationConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_requests(requests), m_previousConnection(previousConnection), m_config(config),
+              m_allocator(allocator), m_started(false), m_connecting(false)
+        {
+        }
+
+        std::shared_ptr<CertificateRotation> CertificateRotation::Create(
+            const IotIdentityClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &previousConnection,
+            const CertificateRotationConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (config.CertificateSigningRequest.empty() || !config.CreateConnection || config.ClientId.empty())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            IdentityRequestClientConfig requestConfig;
+            requestConfig.Qos = config.Qos;
+            requestConfig.RequestTimeoutMs = config.RequestTimeoutMs;
+            auto requests = IdentityRequestClient::Create(client, eventLoopGroup, requestConfig, allocator);
+            if (!requests)
+            {
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<CertificateRotation *>(aws_mem_acquire(allocator, sizeof(CertificateRotation)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) CertificateRotation(requests, previousConnection, config, allocator);
+                return std::shared_ptr<CertificateRotation>(
+                    toSeat, [allocator](CertificateRotation *rotation) { Crt::Delete(rotation, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool CertificateRotation::Start(const OnCertificateRotationComplete &onComplete)
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (m_started)
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_STATE);
+                    return false;
+                }
+                m_started = true;
+                m_onComplete = onComplete;
+            }
+
+            CreateCertificateFromCsrRequest request;
+            request.CertificateSigningRequest = m_config.CertificateSigningRequest;
+
+            std::weak_ptr<CertificateRotation> weakSelf = shared_from_this();
+            bool submitted = m_requests->CreateCertificateFromCsrAsync(
+                request, [weakSelf](CreateCertificateFromCsrResponse *response, ErrorResponse *error, int ioErr) {
+                    if (auto self = weakSelf.lock())
+                    {
+                        self->OnCertificateCreated(response, error, ioErr);
+                    }
+                });
+            if (!submitted)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_started = false;
+                m_onComplete = nullptr;
+                return false;
+            }
+
+            return true;
+        }
+
+        void CertificateRotation::OnCertificateCreated(
+            CreateCertificateFromCsrResponse *response,
+            ErrorResponse *error,
+            int ioErr)
+        {
+            if (!response)
+            {
+                Finish(nullptr, error, ioErr);
+                return;
+            }
+
+            if (response->CertificateId)
+            {
+                m_result.CertificateId = *response->CertificateId;
+            }
+            if (response->CertificatePem)
+            {
+                m_result.CertificatePem = *response->CertificatePem;
+            }
+
+            if (m_config.TemplateName.empty())
+            {
+                Connect();
+                return;
+            }
+
+            if (!response->CertificateOwnershipToken)
+            {
+                Finish(nullptr, nullptr, AWS_ERROR_INVALID_ARGUMENT);
+                return;
+            }
+
+            RegisterThingRequest request;
+            request.TemplateName = m_config.TemplateName;
+            request.Parameters = m_config.TemplateParameters;
+            request.CertificateOwnershipToken = *response->CertificateOwnershipToken;
+
+            std::weak_ptr<CertificateRotation> weakSelf = shared_from_this();
+            bool submitted = m_requests->RegisterThingAsync(
+                request, [weakSelf](RegisterThingResponse *registered, ErrorResponse *rejected, int registerErr) {
+                    if (auto self = weakSelf.lock())
+                    {
+                        self->OnThingRegistered(registered, rejected, registerErr);
+                    }
+                });
+            if (!submitted)
+            {
+                Finish(nullptr, nullptr, aws_last_error());
+            }
+        }
+
+        void CertificateRotation::OnThingRegistered(RegisterThingResponse *response, ErrorResponse *error, int ioErr)
+        {
+            if (!response)
+            {
+                Finish(nullptr, error, ioErr);
+                return;
+            }
+
+            if (response->ThingName)
+            {
+                m_result.ThingName = *response->ThingName;
+            }
+            Connect();
+        }
+
+        void CertificateRotation::Connect()
+        {
+            std::shared_ptr<Crt::Mqtt::MqttConnection> connection = m_config.CreateConnection(m_result);
+            if (!connection)
+            {
+                Finish(nullptr, nullptr, AWS_ERROR_INVALID_ARGUMENT);
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_result.Connection = connection;
+                m_connecting = true;
+            }
+
+            /* Chained, so that the application's own handler still runs. */
+            std::weak_ptr<CertificateRotation> weakSelf = shared_from_this();
+            Crt::Mqtt::OnConnectionCompletedHandler previous = connection->OnConnectionCompleted;
+            connection->OnConnectionCompleted = [weakSelf, previous](
+                                                    Crt::Mqtt::MqttConnection &completed,
+                                                    int errorCode,
+                                                    Crt::Mqtt::ReturnCode returnCode,
+                                                    bool sessionPresent) {
+                if (previous)
+                {
+                    previous(completed, errorCode, returnCode, sessionPresent);
+                }
+                if (auto self = weakSelf.lock())
+                {
+                    self->OnConnected(errorCode, returnCode, sessionPresent);
+                }
+            };
+
+            if (!connection->Connect(m_config.ClientId.c_str(), true, m_config.KeepAliveTimeSecs))
+            {
+                Finish(nullptr, nullptr, aws_last_error());
+            }
+        }
+
+        void CertificateRotation::OnConnected(int errorCode, Crt::Mqtt::ReturnCode returnCode, bool sessionPresent)
+        {
+            {
+                /* Only the first completion belongs to the rotation. */
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (!m_connecting)
+                {
+                    return;
+                }
+                m_connecting = false;
+            }
+
+            if (errorCode != AWS_ERROR_SUCCESS || returnCode != AWS_MQTT_CONNECT_ACCEPTED)
+            {
+                Finish(nullptr, nullptr, errorCode != AWS_ERROR_SUCCESS ? errorCode : AWS_ERROR_MQTT_NOT_CONNECTED);
+                return;
+            }
+
+            if (!m_config.Session)
+            {
+                OnMigrated(AWS_ERROR_SUCCESS);
+                return;
+            }
+
+            std::weak_ptr<CertificateRotation> weakSelf = shared_from_this();
+            m_config.Session->Resume(m_result.Connection, sessionPresent, [weakSelf](int resumeErr) {
+                if (auto self = weakSelf.lock())
+                {
+                    self->OnMigrated(resumeErr);
+                }
+            });
+        }
+
+        void CertificateRotation::OnMigrated(int errorCode)
+        {
+            if (errorCode != AWS_ERROR_SUCCESS)
+            {
+                Finish(nullptr, nullptr, errorCode);
+                return;
+            }
+
+            if (m_config.OnCutOver)
+            {
+                m_config.OnCutOver(m_result.Connection);
+            }
+            if (m_config.DisconnectPrevious && m_previousConnection)
+            {
+                m_previousConnection->Disconnect();
+            }
+            Finish(&m_result, nullptr, AWS_ERROR_SUCCESS);
+        }
+
+        void CertificateRotation::Finish(CertificateRotationResult *result, ErrorResponse *error, int ioErr)
+        {
+            OnCertificateRotationComplete onComplete;
+            std::shared_ptr<Crt::Mqtt::MqttConnection> abandoned;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                onComplete = std::move(m_onComplete);
+                m_onComplete = nullptr;
+                m_connecting = false;
+                if (!result)
+                {
+                    abandoned = std::move(m_result.Connection);
+                    m_result.Connection = nullptr;
+                }
+            }
+
+            if (abandoned)
+            {
+                abandoned->Disconnect();
+            }
+            if (onComplete)
+            {
+                onComplete(result, error, ioErr);
+            }
+        }
+
+    } // namespace Iotidentity
+
+} // namespace Aws
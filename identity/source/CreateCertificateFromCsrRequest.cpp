@@ -4,32 +4,37 @@
  */
 #include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotidentity
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<CreateCertificateFromCsrRequest, true>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<CreateCertificateFromCsrRequest> s_fields[] = {
+                Fields::Field<Crt::String, &CreateCertificateFromCsrRequest::CertificateSigningRequest>(
+                    "certificateSigningRequest"),
+            };
+        } // namespace
 
         void CreateCertificateFromCsrRequest::LoadFromObject(
             CreateCertificateFromCsrRequest &val,
             const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("certificateSigningRequest"))
-            {
-                val.CertificateSigningRequest = doc.GetString("certificateSigningRequest");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void CreateCertificateFromCsrRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (CertificateSigningRequest)
-            {
-                object.WithString("certificateSigningRequest", *CertificateSigningRequest);
-            }
+        void CreateCertificateFromCsrRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         CreateCertificateFromCsrRequest::CreateCertificateFromCsrRequest(const Crt::JsonView &doc)
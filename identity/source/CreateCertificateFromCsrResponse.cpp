@@ -4,52 +4,34 @@
  */
 #include <aws/iotidentity/CreateCertificateFromCsrResponse.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotidentity
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<CreateCertificateFromCsrResponse>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<CreateCertificateFromCsrResponse> s_fields[] = {
+                Fields::Field<Crt::String, &CreateCertificateFromCsrResponse::CertificateId>("certificateId"),
+                Fields::Field<Crt::String, &CreateCertificateFromCsrResponse::CertificateOwnershipToken>(
+                    "certificateOwnershipToken"),
+                Fields::Field<Crt::String, &CreateCertificateFromCsrResponse::CertificatePem>("certificatePem"),
+            };
+        } // namespace
 
         void CreateCertificateFromCsrResponse::LoadFromObject(
             CreateCertificateFromCsrResponse &val,
             const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("certificateId"))
-            {
-                val.CertificateId = doc.GetString("certificateId");
-            }
-
-            if (doc.ValueExists("certificateOwnershipToken"))
-            {
-                val.CertificateOwnershipToken = doc.GetString("certificateOwnershipToken");
-            }
-
-            if (doc.ValueExists("certificatePem"))
-            {
-                val.CertificatePem = doc.GetString("certificatePem");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void CreateCertificateFromCsrResponse::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (CertificateId)
-            {
-                object.WithString("certificateId", *CertificateId);
-            }
-
-            if (CertificateOwnershipToken)
-            {
-                object.WithString("certificateOwnershipToken", *CertificateOwnershipToken);
-            }
-
-            if (CertificatePem)
-            {
-                object.WithString("certificatePem", *CertificatePem);
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         CreateCertificateFromCsrResponse::CreateCertificateFromCsrResponse(const Crt::JsonView &doc)
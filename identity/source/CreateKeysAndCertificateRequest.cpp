@@ -19,6 +19,12 @@ namespace Aws
 
         void CreateKeysAndCertificateRequest::SerializeToObject(Aws::Crt::JsonObject &object) const { (void)object; }
 
+        void CreateKeysAndCertificateRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            writer.BeginObject();
+            writer.EndObject();
+        }
+
         CreateKeysAndCertificateRequest::CreateKeysAndCertificateRequest(const Crt::JsonView &doc)
         {
             LoadFromObject(*this, doc);
@@ -4,62 +4,35 @@
  */
 #include <aws/iotidentity/CreateKeysAndCertificateResponse.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotidentity
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<CreateKeysAndCertificateResponse>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<CreateKeysAndCertificateResponse> s_fields[] = {
+                Fields::Field<Crt::String, &CreateKeysAndCertificateResponse::CertificateId>("certificateId"),
+                Fields::Field<Crt::String, &CreateKeysAndCertificateResponse::CertificateOwnershipToken>(
+                    "certificateOwnershipToken"),
+                Fields::Field<Crt::String, &CreateKeysAndCertificateResponse::CertificatePem>("certificatePem"),
+                Fields::Field<Crt::String, &CreateKeysAndCertificateResponse::PrivateKey>("privateKey"),
+            };
+        } // namespace
 
         void CreateKeysAndCertificateResponse::LoadFromObject(
             CreateKeysAndCertificateResponse &val,
             const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("certificateId"))
-            {
-                val.CertificateId = doc.GetString("certificateId");
-            }
-
-            if (doc.ValueExists("certificateOwnershipToken"))
-            {
-                val.CertificateOwnershipToken = doc.GetString("certificateOwnershipToken");
-            }
-
-            if (doc.ValueExists("certificatePem"))
-            {
-                val.CertificatePem = doc.GetString("certificatePem");
-            }
-
-            if (doc.ValueExists("privateKey"))
-            {
-                val.PrivateKey = doc.GetString("privateKey");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void CreateKeysAndCertificateResponse::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (CertificateId)
-            {
-                object.WithString("certificateId", *CertificateId);
-            }
-
-            if (CertificateOwnershipToken)
-            {
-                object.WithString("certificateOwnershipToken", *CertificateOwnershipToken);
-            }
-
-            if (CertificatePem)
-            {
-                object.WithString("certificatePem", *CertificatePem);
-            }
-
-            if (PrivateKey)
-            {
-                object.WithString("privateKey", *PrivateKey);
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         CreateKeysAndCertificateResponse::CreateKeysAndCertificateResponse(const Crt::JsonView &doc)
@@ -0,0 +1,160 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/CsrPregenerator.h>
+
+#include <chrono>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+
+        CsrPregeneratorConfig::CsrPregeneratorConfig() noexcept
+            : Generator(), Capacity(16), ThreadCount(1), FailureBackoffMs(100)
+        {
+        }
+
+        CsrPregenerator::CsrPregenerator(const CsrPregeneratorConfig &config, size_t threadCount) noexcept
+            : m_config(config), m_generating(0), m_stopping(false), m_failedCount(0)
+        {
+            if (m_config.Capacity == 0)
+            {
+                m_config.Capacity = 1;
+            }
+
+            m_workers.reserve(threadCount);
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                m_workers.emplace_back([this]() { RunWorker(); });
+            }
+        }
+
+        CsrPregenerator::~CsrPregenerator()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_stopping = true;
+            }
+            m_spaceAvailable.notify_all();
+            m_materialReady.notify_all();
+
+            for (std::thread &worker : m_workers)
+            {
+                if (worker.joinable())
+                {
+                    worker.join();
+                }
+            }
+        }
+
+        std::shared_ptr<CsrPregenerator> CsrPregenerator::Create(
+            const CsrPregeneratorConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (!config.Generator)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            size_t threadCount = config.ThreadCount;
+            if (threadCount == 0)
+            {
+                threadCount = std::thread::hardware_concurrency();
+                if (threadCount == 0)
+                {
+                    threadCount = 1;
+                }
+            }
+
+            auto *toSeat = static_cast<CsrPregenerator *>(aws_mem_acquire(allocator, sizeof(CsrPregenerator)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) CsrPregenerator(config, threadCount);
+                return std::shared_ptr<CsrPregenerator>(
+                    toSeat, [allocator](CsrPregenerator *pregenerator) { Crt::Delete(pregenerator, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        void CsrPregenerator::RunWorker()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            while (true)
+            {
+                m_spaceAvailable.wait(
+                    lock, [this]() { return m_stopping || m_ready.size() + m_generating < m_config.Capacity; });
+                if (m_stopping)
+                {
+                    return;
+                }
+
+                ++m_generating;
+                lock.unlock();
+
+                CsrMaterial material;
+                bool generated = m_config.Generator(material);
+
+                lock.lock();
+                --m_generating;
+                if (generated)
+                {
+                    m_ready.push_back(std::move(material));
+                    m_materialReady.notify_one();
+                    continue;
+                }
+
+                ++m_failedCount;
+                m_spaceAvailable.wait_for(lock, std::chrono::milliseconds(m_config.FailureBackoffMs), [this]() {
+                    return m_stopping;
+                });
+            }
+        }
+
+        bool CsrPregenerator::TryTake(CsrMaterial &material)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_ready.empty())
+                {
+                    return false;
+                }
+                material = std::move(m_ready.front());
+                m_ready.pop_front();
+            }
+
+            m_spaceAvailable.notify_one();
+            return true;
+        }
+
+        bool CsrPregenerator::Take(CsrMaterial &material, uint32_t timeoutMs)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+                if (!m_materialReady.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() {
+                        return m_stopping || !m_ready.empty();
+                    }) ||
+                    m_ready.empty())
+                {
+                    return false;
+                }
+                material = std::move(m_ready.front());
+                m_ready.pop_front();
+            }
+
+            m_spaceAvailable.notify_one();
+            return true;
+        }
+
+        size_t CsrPregenerator::GetReadyCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_ready.size();
+        }
+
+    } // namespace Iotidentity
+
+} // namespace Aws
@@ -0,0 +1,267 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/DeviceCredentialStore.h>
+
+#include <aws/iotidentity/CreateKeysAndCertificateResponse.h>
+#include <aws/iotidentity/RegisterThingResponse.h>
+
+#include <aws/checksums/crc.h>
+#include <aws/common/file.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        namespace
+        {
+            static const uint32_t s_storeMagic = 0x44524344;
+            static const uint8_t s_storeVersion = 1;
+            /* magic, version */
+            static const size_t s_headerSize = 4 + 1;
+            static const size_t s_checksumSize = 4;
+
+            void s_putInteger(Crt::String &out, uint64_t value, size_t bytes)
+            {
+                for (size_t i = 0; i < bytes; ++i)
+                {
+                    out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+                }
+            }
+
+            void s_putString(Crt::String &out, const Crt::String &value)
+            {
+                s_putInteger(out, value.size(), 4);
+                out.append(value);
+            }
+
+            /* Bounds-checked little-endian reads over a loaded file. */
+            struct FieldReader
+            {
+                const uint8_t *Position;
+                size_t Remaining;
+
+                bool Integer(uint64_t &value, size_t bytes)
+                {
+                    if (Remaining < bytes)
+                    {
+                        return false;
+                    }
+                    value = 0;
+                    for (size_t i = 0; i < bytes; ++i)
+                    {
+                        value |= static_cast<uint64_t>(Position[i]) << (8 * i);
+                    }
+                    Position += bytes;
+                    Remaining -= bytes;
+                    return true;
+                }
+
+                bool Field(Crt::ByteCursor &value)
+                {
+                    uint64_t length = 0;
+                    if (!Integer(length, 4) || Remaining < length)
+                    {
+                        return false;
+                    }
+                    value = Crt::ByteCursorFromArray(Position, static_cast<size_t>(length));
+                    Position += length;
+                    Remaining -= static_cast<size_t>(length);
+                    return true;
+                }
+            };
+
+            Crt::String s_cursorString(const Crt::ByteCursor &cursor)
+            {
+                return Crt::String(reinterpret_cast<const char *>(cursor.ptr), cursor.len);
+            }
+        } // namespace
+
+        DeviceCredentialStore::DeviceCredentialStore(const char *path, Crt::Allocator *allocator)
+            : m_path(path), m_allocator(allocator), m_contents(), m_loaded(false),
+              m_certificateId(Crt::ByteCursorFromArray(nullptr, 0)),
+              m_certificatePem(Crt::ByteCursorFromArray(nullptr, 0)),
+              m_privateKey(Crt::ByteCursorFromArray(nullptr, 0)), m_thingName(Crt::ByteCursorFromArray(nullptr, 0)),
+              m_deviceConfiguration(Crt::ByteCursorFromArray(nullptr, 0))
+        {
+        }
+
+        bool DeviceCredentialStore::Save(const DeviceCredentials &credentials)
+        {
+            Crt::String contents;
+            s_putInteger(contents, s_storeMagic, 4);
+            s_putInteger(contents, s_storeVersion, 1);
+            s_putString(contents, credentials.CertificateId);
+            s_putString(contents, credentials.CertificatePem);
+            s_putString(contents, credentials.PrivateKey);
+            s_putString(contents, credentials.ThingName);
+
+            Crt::String configuration;
+            s_putInteger(configuration, credentials.DeviceConfiguration.size(), 4);
+            for (const auto &entry : credentials.DeviceConfiguration)
+            {
+                s_putString(configuration, entry.first);
+                s_putString(configuration, entry.second);
+            }
+            s_putString(contents, configuration);
+
+            uint32_t crc = aws_checksums_crc32(
+                reinterpret_cast<const uint8_t *>(contents.data()), static_cast<int>(contents.size()), 0);
+            s_putInteger(contents, crc, 4);
+
+            Crt::String savingPath(m_path);
+            savingPath.append(".tmp");
+            FILE *saving = aws_fopen(savingPath.c_str(), "wb");
+            if (!saving)
+            {
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+
+            bool written = fwrite(contents.data(), 1, contents.size(), saving) == contents.size();
+            written = fflush(saving) == 0 && written;
+            written = fclose(saving) == 0 && written;
+
+            /* Windows will not rename over an existing file. */
+            if (!written || (rename(savingPath.c_str(), m_path.c_str()) != 0 &&
+                             (remove(m_path.c_str()) != 0 || rename(savingPath.c_str(), m_path.c_str()) != 0)))
+            {
+                remove(savingPath.c_str());
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+
+            m_contents = std::move(contents);
+            return Index();
+        }
+
+        bool DeviceCredentialStore::Save(
+            const CreateKeysAndCertificateResponse &keys,
+            const RegisterThingResponse &registration)
+        {
+            DeviceCredentials credentials;
+            if (keys.CertificateId)
+            {
+                credentials.CertificateId = *keys.CertificateId;
+            }
+            if (keys.CertificatePem)
+            {
+                credentials.CertificatePem = *keys.CertificatePem;
+            }
+            if (keys.PrivateKey)
+            {
+                credentials.PrivateKey = *keys.PrivateKey;
+            }
+            if (registration.ThingName)
+            {
+                credentials.ThingName = *registration.ThingName;
+            }
+            if (registration.DeviceConfiguration)
+            {
+                credentials.DeviceConfiguration = *registration.DeviceConfiguration;
+            }
+            return Save(credentials);
+        }
+
+        bool DeviceCredentialStore::Load()
+        {
+            m_loaded = false;
+            m_contents.clear();
+
+            FILE *stored = aws_fopen(m_path.c_str(), "rb");
+            if (!stored)
+            {
+                return false;
+            }
+
+            /* One read of the whole file, sized up front. */
+            long size = -1;
+            if (fseek(stored, 0, SEEK_END) == 0)
+            {
+                size = ftell(stored);
+            }
+            bool read = size >= 0 && fseek(stored, 0, SEEK_SET) == 0;
+            if (read)
+            {
+                m_contents.resize(static_cast<size_t>(size));
+                read = fread(&m_contents[0], 1, m_contents.size(), stored) == m_contents.size();
+            }
+            fclose(stored);
+            if (!read)
+            {
+                m_contents.clear();
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+
+            return Index();
+        }
+
+        bool DeviceCredentialStore::Index()
+        {
+            m_loaded = false;
+            const uint8_t *bytes = reinterpret_cast<const uint8_t *>(m_contents.data());
+            bool valid = m_contents.size() >= s_headerSize + s_checksumSize;
+            if (valid)
+            {
+                size_t checkedSize = m_contents.size() - s_checksumSize;
+                FieldReader trailer{bytes + checkedSize, s_checksumSize};
+                FieldReader header{bytes, s_headerSize};
+                uint64_t crc = 0;
+                uint64_t magic = 0;
+                uint64_t version = 0;
+                valid = trailer.Integer(crc, 4) &&
+                        crc == aws_checksums_crc32(bytes, static_cast<int>(checkedSize), 0) &&
+                        header.Integer(magic, 4) && magic == s_storeMagic && header.Integer(version, 1) &&
+                        version == s_storeVersion;
+
+                FieldReader fields{bytes + s_headerSize, checkedSize - s_headerSize};
+                valid = valid && fields.Field(m_certificateId) && fields.Field(m_certificatePem) &&
+                        fields.Field(m_privateKey) && fields.Field(m_thingName) &&
+                        fields.Field(m_deviceConfiguration) && fields.Remaining == 0;
+            }
+
+            if (!valid)
+            {
+                m_contents.clear();
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            m_loaded = true;
+            return true;
+        }
+
+        Crt::Map<Crt::String, Crt::String> DeviceCredentialStore::GetDeviceConfiguration() const
+        {
+            Crt::Map<Crt::String, Crt::String> configuration;
+            if (!m_loaded)
+            {
+                return configuration;
+            }
+
+            FieldReader reader{m_deviceConfiguration.ptr, m_deviceConfiguration.len};
+            uint64_t count = 0;
+            reader.Integer(count, 4);
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                Crt::ByteCursor key;
+                Crt::ByteCursor value;
+                if (!reader.Field(key) || !reader.Field(value))
+                {
+                    break;
+                }
+                configuration[s_cursorString(key)] = s_cursorString(value);
+            }
+            return configuration;
+        }
+
+        Crt::Io::TlsContextOptions DeviceCredentialStore::NewTlsContextOptions() const noexcept
+        {
+            return Crt::Io::TlsContextOptions::InitClientWithMtls(m_certificatePem, m_privateKey, m_allocator);
+        }
+
+    } // namespace Iotidentity
+
+} // namespace Aws
@@ -4,50 +4,31 @@
  */
 #include <aws/iotidentity/ErrorResponse.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotidentity
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<ErrorResponse>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<ErrorResponse> s_fields[] = {
+                Fields::Field<int32_t, &ErrorResponse::StatusCode>("statusCode"),
+                Fields::Field<Crt::String, &ErrorResponse::ErrorMessage>("errorMessage"),
+                Fields::Field<Crt::String, &ErrorResponse::ErrorCode>("errorCode"),
+            };
+        } // namespace
 
         void ErrorResponse::LoadFromObject(ErrorResponse &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("statusCode"))
-            {
-                val.StatusCode = doc.GetInteger("statusCode");
-            }
-
-            if (doc.ValueExists("errorMessage"))
-            {
-                val.ErrorMessage = doc.GetString("errorMessage");
-            }
-
-            if (doc.ValueExists("errorCode"))
-            {
-                val.ErrorCode = doc.GetString("errorCode");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void ErrorResponse::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (StatusCode)
-            {
-                object.WithInteger("statusCode", *StatusCode);
-            }
-
-            if (ErrorMessage)
-            {
-                object.WithString("errorMessage", *ErrorMessage);
-            }
-
-            if (ErrorCode)
-            {
-                object.WithString("errorCode", *ErrorCode);
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         ErrorResponse::ErrorResponse(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
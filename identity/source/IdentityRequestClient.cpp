@@ -0,0 +1,709 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/IdentityRequestClient.h>
+
+#include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
+#include <aws/iotidentity/CreateCertificateFromCsrResponse.h>
+#include <aws/iotidentity/CreateCertificateFromCsrSubscriptionRequest.h>
+#include <aws/iotidentity/CreateKeysAndCertificateRequest.h>
+#include <aws/iotidentity/CreateKeysAndCertificateResponse.h>
+#include <aws/iotidentity/CreateKeysAndCertificateSubscriptionRequest.h>
+#include <aws/iotidentity/ErrorResponse.h>
+#include <aws/iotidentity/PemPublicKey.h>
+#include <aws/iotidentity/RegisterThingRequest.h>
+#include <aws/iotidentity/RegisterThingResponse.h>
+#include <aws/iotidentity/RegisterThingSubscriptionRequest.h>
+
+#include <aws/common/clock.h>
+#include <aws/io/event_loop.h>
+#include <aws/mqtt/mqtt.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        namespace
+        {
+            struct SubscribeContext
+            {
+                SubscribeContext(const OnSubscribeComplete &onSubAck, int remaining)
+                    : OnSubAck(onSubAck), Remaining(remaining), FirstError(AWS_ERROR_SUCCESS)
+                {
+                }
+
+                std::mutex Lock;
+                OnSubscribeComplete OnSubAck;
+                int Remaining;
+                int FirstError;
+            };
+
+            struct TimeoutTask
+            {
+                aws_task Task;
+                Iotdevicecommon::TimerWheel::OnExpired OnExpired;
+                Crt::Allocator *Allocator;
+            };
+
+            void s_onTimeoutTask(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *timeoutTask = static_cast<TimeoutTask *>(arg);
+                if (status == AWS_TASK_STATUS_RUN_READY)
+                {
+                    timeoutTask->OnExpired();
+                }
+
+                Crt::Delete(timeoutTask, timeoutTask->Allocator);
+            }
+
+            template <typename Response, typename Callback>
+            std::function<void(void *, ErrorResponse *, int)> s_eraseResponseType(const Callback &onComplete)
+            {
+                return [onComplete](void *response, ErrorResponse *error, int ioErr) {
+                    if (onComplete)
+                    {
+                        onComplete(static_cast<Response *>(response), error, ioErr);
+                    }
+                };
+            }
+
+            /* Sets `key` to the public key of the response's certificate; false if the response has none to check. */
+            template <typename Response> bool s_certificateKey(const Response &, Crt::Vector<uint8_t> &)
+            {
+                return false;
+            }
+
+            bool s_certificateKey(const CreateCertificateFromCsrResponse &response, Crt::Vector<uint8_t> &key)
+            {
+                if (response.CertificatePem)
+                {
+                    key = PublicKeyOfPem(*response.CertificatePem);
+                }
+                return true;
+            }
+        } // namespace
+
+        IdentityRequestClientConfig::IdentityRequestClientConfig() noexcept
+            : Qos(AWS_MQTT_QOS_AT_LEAST_ONCE), RequestTimeoutMs(30000), Timers()
+        {
+        }
+
+        IdentityRequestClient::IdentityRequestClient(
+            const IotIdentityClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const IdentityRequestClientConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_client(client), m_config(config), m_allocator(allocator),
+              m_eventLoop(aws_event_loop_group_get_next_loop(eventLoopGroup.GetUnderlyingHandle())),
+              m_keysChannel(Crt::MakeShared<Channel>(allocator, Operation::CreateKeysAndCertificate, Crt::String())),
+              m_csrChannel(Crt::MakeShared<Channel>(allocator, Operation::CreateCertificateFromCsr, Crt::String()))
+        {
+        }
+
+        std::shared_ptr<IdentityRequestClient> IdentityRequestClient::Create(
+            const IotIdentityClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const IdentityRequestClientConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat =
+                static_cast<IdentityRequestClient *>(aws_mem_acquire(allocator, sizeof(IdentityRequestClient)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) IdentityRequestClient(client, eventLoopGroup, config, allocator);
+                std::shared_ptr<IdentityRequestClient> requestClient(
+                    toSeat, [allocator](IdentityRequestClient *self) { Crt::Delete(self, allocator); });
+                if (requestClient->m_keysChannel && requestClient->m_csrChannel)
+                {
+                    return requestClient;
+                }
+            }
+
+            return nullptr;
+        }
+
+        template <typename Response>
+        std::function<void(Response *, int)> IdentityRequestClient::MakeAcceptedHandler(
+            const std::shared_ptr<Channel> &channel)
+        {
+            std::weak_ptr<IdentityRequestClient> weakSelf = shared_from_this();
+            return [weakSelf, channel](Response *response, int) {
+                auto self = weakSelf.lock();
+                if (self && response)
+                {
+                    Crt::Vector<uint8_t> certificateKey;
+                    bool checked = s_certificateKey(*response, certificateKey);
+                    self->Complete(channel, response, nullptr, checked ? &certificateKey : nullptr);
+                }
+            };
+        }
+
+        std::function<void(ErrorResponse *, int)> IdentityRequestClient::MakeRejectedHandler(
+            const std::shared_ptr<Channel> &channel)
+        {
+            std::weak_ptr<IdentityRequestClient> weakSelf = shared_from_this();
+            return [weakSelf, channel](ErrorResponse *error, int) {
+                auto self = weakSelf.lock();
+                if (self && error)
+                {
+                    self->Complete(channel, nullptr, error, nullptr);
+                }
+            };
+        }
+
+        std::shared_ptr<IdentityRequestClient::Channel> IdentityRequestClient::GetRegisterChannel(
+            const Crt::String &templateName)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            std::shared_ptr<Channel> &registered = m_registerChannels[templateName];
+            if (!registered)
+            {
+                registered = Crt::MakeShared<Channel>(m_allocator, Operation::RegisterThing, templateName);
+            }
+            return registered;
+        }
+
+        bool IdentityRequestClient::Subscribe(const Crt::String &templateName, const OnSubscribeComplete &onSubAck)
+        {
+            Crt::Vector<std::shared_ptr<Channel>> channels;
+            channels.push_back(m_csrChannel);
+            if (!templateName.empty())
+            {
+                std::shared_ptr<Channel> registerChannel = GetRegisterChannel(templateName);
+                if (!registerChannel)
+                {
+                    return false;
+                }
+                channels.push_back(std::move(registerChannel));
+            }
+
+            auto context = Crt::MakeShared<SubscribeContext>(m_allocator, onSubAck, static_cast<int>(channels.size()));
+            if (!context)
+            {
+                return false;
+            }
+
+            OnSubscribeComplete onEachSubAck = [context](int ioErr) {
+                OnSubscribeComplete onAllSubAcked;
+                int result = AWS_ERROR_SUCCESS;
+                {
+                    std::lock_guard<std::mutex> lock(context->Lock);
+                    if (ioErr != AWS_ERROR_SUCCESS && context->FirstError == AWS_ERROR_SUCCESS)
+                    {
+                        context->FirstError = ioErr;
+                    }
+                    if (--context->Remaining == 0)
+                    {
+                        onAllSubAcked = context->OnSubAck;
+                        result = context->FirstError;
+                    }
+                }
+
+                if (onAllSubAcked)
+                {
+                    onAllSubAcked(result);
+                }
+            };
+
+            for (const auto &channel : channels)
+            {
+                bool subscribed = false;
+                bool startSubscribing = false;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    subscribed = channel->SubscriptionState == Channel::State::Subscribed;
+                    if (!subscribed)
+                    {
+                        channel->SubAckWaiters.push_back(onEachSubAck);
+                        startSubscribing = BeginSubscribing(*channel);
+                    }
+                }
+
+                if (subscribed)
+                {
+                    onEachSubAck(AWS_ERROR_SUCCESS);
+                }
+                else if (startSubscribing)
+                {
+                    StartSubscribing(channel);
+                }
+            }
+            return true;
+        }
+
+        bool IdentityRequestClient::CreateKeysAndCertificateAsync(
+            const CreateKeysAndCertificateRequest &request,
+            const OnCreateKeysAndCertificateComplete &onComplete)
+        {
+            PendingRequest pending;
+            pending.Publish = [this, request](const OnPublishComplete &onPubAck) {
+                return m_client.PublishCreateKeysAndCertificate(request, m_config.Qos, onPubAck);
+            };
+            pending.OnComplete = s_eraseResponseType<CreateKeysAndCertificateResponse>(onComplete);
+
+            return Submit(m_keysChannel, std::move(pending));
+        }
+
+        bool IdentityRequestClient::CreateCertificateFromCsrAsync(
+            const CreateCertificateFromCsrRequest &request,
+            const OnCreateCertificateFromCsrComplete &onComplete)
+        {
+            PendingRequest pending;
+            pending.Publish = [this, request](const OnPublishComplete &onPubAck) {
+                return m_client.PublishCreateCertificateFromCsr(request, m_config.Qos, onPubAck);
+            };
+            pending.OnComplete = s_eraseResponseType<CreateCertificateFromCsrResponse>(onComplete);
+            if (request.CertificateSigningRequest)
+            {
+                pending.PublicKey = PublicKeyOfPem(*request.CertificateSigningRequest);
+            }
+
+            return Submit(m_csrChannel, std::move(pending));
+        }
+
+        bool IdentityRequestClient::RegisterThingAsync(
+            const RegisterThingRequest &request,
+            const OnRegisterThingComplete &onComplete)
+        {
+            if (!request.TemplateName || request.TemplateName->empty())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            std::shared_ptr<Channel> channel = GetRegisterChannel(*request.TemplateName);
+            if (!channel)
+            {
+                return false;
+            }
+
+            PendingRequest pending;
+            pending.Publish = [this, request](const OnPublishComplete &onPubAck) {
+                return m_client.PublishRegisterThing(request, m_config.Qos, onPubAck);
+            };
+            pending.OnComplete = s_eraseResponseType<RegisterThingResponse>(onComplete);
+
+            return Submit(channel, std::move(pending));
+        }
+
+        bool IdentityRequestClient::BeginSubscribing(Channel &channel)
+        {
+            if (channel.SubscriptionState != Channel::State::Unsubscribed)
+            {
+                return false;
+            }
+
+            channel.SubscriptionState = Channel::State::Subscribing;
+            channel.RemainingSubAcks = 2;
+            channel.SubscribeError = AWS_ERROR_SUCCESS;
+            return true;
+        }
+
+        void IdentityRequestClient::StartSubscribing(const std::shared_ptr<Channel> &channel)
+        {
+            std::weak_ptr<IdentityRequestClient> weakSelf = shared_from_this();
+            auto onSubAck = [weakSelf, channel](int ioErr) {
+                auto self = weakSelf.lock();
+                if (self)
+                {
+                    self->OnChannelSubAck(channel, ioErr);
+                }
+            };
+
+            int issued = SubscribeChannel(channel, onSubAck);
+            if (issued < 2)
+            {
+                /* The subscriptions that were not issued will never acknowledge. */
+                int errorCode = Crt::LastErrorOrUnknown();
+                for (; issued < 2; ++issued)
+                {
+                    OnChannelSubAck(channel, errorCode);
+                }
+            }
+        }
+
+        int IdentityRequestClient::SubscribeChannel(
+            const std::shared_ptr<Channel> &channel,
+            const OnSubscribeComplete &onSubAck)
+        {
+            const Crt::Mqtt::QOS qos = m_config.Qos;
+            switch (channel->Kind)
+            {
+                case Operation::CreateKeysAndCertificate:
+                {
+                    CreateKeysAndCertificateSubscriptionRequest subscriptionRequest;
+                    if (!m_client.SubscribeToCreateKeysAndCertificateAccepted(
+                            subscriptionRequest,
+                            qos,
+                            MakeAcceptedHandler<CreateKeysAndCertificateResponse>(channel),
+                            onSubAck))
+                    {
+                        return 0;
+                    }
+                    return m_client.SubscribeToCreateKeysAndCertificateRejected(
+                               subscriptionRequest, qos, MakeRejectedHandler(channel), onSubAck)
+                               ? 2
+                               : 1;
+                }
+                case Operation::CreateCertificateFromCsr:
+                {
+                    CreateCertificateFromCsrSubscriptionRequest subscriptionRequest;
+                    if (!m_client.SubscribeToCreateCertificateFromCsrAccepted(
+                            subscriptionRequest,
+                            qos,
+                            MakeAcceptedHandler<CreateCertificateFromCsrResponse>(channel),
+                            onSubAck))
+                    {
+                        return 0;
+                    }
+                    return m_client.SubscribeToCreateCertificateFromCsrRejected(
+                               subscriptionRequest, qos, MakeRejectedHandler(channel), onSubAck)
+                               ? 2
+                               : 1;
+                }
+                case Operation::RegisterThing:
+                {
+                    RegisterThingSubscriptionRequest subscriptionRequest;
+                    subscriptionRequest.TemplateName = channel->TemplateName;
+                    if (!m_client.SubscribeToRegisterThingAccepted(
+                            subscriptionRequest, qos, MakeAcceptedHandler<RegisterThingResponse>(channel), onSubAck))
+                    {
+                        return 0;
+                    }
+                    return m_client.SubscribeToRegisterThingRejected(
+                               subscriptionRequest, qos, MakeRejectedHandler(channel), onSubAck)
+                               ? 2
+                               : 1;
+                }
+            }
+            return 0;
+        }
+
+        void IdentityRequestClient::OnChannelSubAck(const std::shared_ptr<Channel> &channel, int ioErr)
+        {
+            Crt::List<std::shared_ptr<PendingRequest>> failed;
+            Crt::Vector<OnSubscribeComplete> waiters;
+            int subscribeError = AWS_ERROR_SUCCESS;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (channel->SubscriptionState != Channel::State::Subscribing)
+                {
+                    return;
+                }
+                if (ioErr != AWS_ERROR_SUCCESS && channel->SubscribeError == AWS_ERROR_SUCCESS)
+                {
+                    channel->SubscribeError = ioErr;
+                }
+                if (--channel->RemainingSubAcks > 0)
+                {
+                    return;
+                }
+
+                subscribeError = channel->SubscribeError;
+                /* A failed channel is subscribed again by its next request. */
+                channel->SubscriptionState = subscribeError == AWS_ERROR_SUCCESS ? Channel::State::Subscribed
+                                                                                 : Channel::State::Unsubscribed;
+                waiters.swap(channel->SubAckWaiters);
+                if (subscribeError != AWS_ERROR_SUCCESS)
+                {
+                    failed.swap(channel->Unpublished);
+                }
+            }
+
+            for (const auto &pending : failed)
+            {
+                pending->OnComplete(nullptr, nullptr, subscribeError);
+            }
+            for (const auto &waiter : waiters)
+            {
+                waiter(subscribeError);
+            }
+            if (subscribeError == AWS_ERROR_SUCCESS)
+            {
+                PublishNext(channel);
+            }
+        }
+
+        bool IdentityRequestClient::Submit(const std::shared_ptr<Channel> &channel, PendingRequest &&request)
+        {
+            if (!Iotdevicecommon::AcquireRequestSlot(m_client.GetMemoryBudget(), request.BudgetSlot))
+            {
+                return false;
+            }
+
+            auto pending = Crt::MakeShared<PendingRequest>(m_allocator);
+            if (!pending)
+            {
+                request.OnComplete(nullptr, nullptr, Crt::LastErrorOrUnknown());
+                return true;
+            }
+            *pending = std::move(request);
+
+            bool startSubscribing = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                channel->Unpublished.push_back(std::move(pending));
+                startSubscribing = BeginSubscribing(*channel);
+            }
+
+            if (startSubscribing)
+            {
+                StartSubscribing(channel);
+            }
+            else
+            {
+                PublishNext(channel);
+            }
+            return true;
+        }
+
+        void IdentityRequestClient::PublishNext(const std::shared_ptr<Channel> &channel)
+        {
+            while (true)
+            {
+                std::shared_ptr<PendingRequest> request;
+                uint64_t generation = 0;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (channel->SubscriptionState != Channel::State::Subscribed || channel->Outstanding ||
+                        channel->Quarantined || channel->Unpublished.empty())
+                    {
+                        return;
+                    }
+                    request = std::move(channel->Unpublished.front());
+                    channel->Unpublished.pop_front();
+                    channel->Outstanding = request;
+                    generation = ++channel->Generation;
+                }
+
+                std::weak_ptr<IdentityRequestClient> weakSelf = shared_from_this();
+                auto onPubAck = [weakSelf, channel, generation](int ioErr) {
+                    auto self = weakSelf.lock();
+                    if (self && ioErr != AWS_ERROR_SUCCESS)
+                    {
+                        self->Abandon(channel, generation, ioErr);
+                    }
+                };
+
+                if (request->Publish(onPubAck))
+                {
+                    ScheduleTimer(channel, generation);
+                    return;
+                }
+
+                /* Nothing was sent, so nothing can answer it: the next request may go right away. */
+                int errorCode = Crt::LastErrorOrUnknown();
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (channel->Outstanding != request || channel->Generation != generation)
+                    {
+                        return;
+                    }
+                    channel->Outstanding = nullptr;
+                    ++channel->Generation;
+                }
+                request->OnComplete(nullptr, nullptr, errorCode);
+            }
+        }
+
+        void IdentityRequestClient::Complete(
+            const std::shared_ptr<Channel> &channel,
+            void *response,
+            ErrorResponse *error,
+            const Crt::Vector<uint8_t> *certificateKey)
+        {
+            std::shared_ptr<PendingRequest> request;
+            uint64_t timerId = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (channel->Quarantined || !channel->Outstanding)
+                {
+                    /* A response to an abandoned request, or to one this client did not publish. */
+                    return;
+                }
+                if (certificateKey && !channel->Outstanding->PublicKey.empty() &&
+                    *certificateKey != channel->Outstanding->PublicKey)
+                {
+                    /* A certificate signed from another CSR. */
+                    return;
+                }
+                request = std::move(channel->Outstanding);
+                channel->Outstanding = nullptr;
+                ++channel->Generation;
+                timerId = channel->TimerId;
+                channel->TimerId = 0;
+            }
+
+            CancelTimer(timerId);
+            request->OnComplete(response, error, AWS_ERROR_SUCCESS);
+            PublishNext(channel);
+        }
+
+        void IdentityRequestClient::Abandon(const std::shared_ptr<Channel> &channel, uint64_t generation, int errorCode)
+        {
+            std::shared_ptr<PendingRequest> abandoned;
+            uint64_t timerId = 0;
+            uint64_t quarantine = 0;
+            bool resume = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (channel->Generation != generation)
+                {
+                    /* Answered, or abandoned already. */
+                    return;
+                }
+                timerId = channel->TimerId;
+                channel->TimerId = 0;
+
+                if (channel->Outstanding)
+                {
+                    abandoned = std::move(channel->Outstanding);
+                    channel->Outstanding = nullptr;
+                    if (m_config.RequestTimeoutMs != 0)
+                    {
+                        channel->Quarantined = true;
+                        quarantine = ++channel->Generation;
+                    }
+                    else
+                    {
+                        ++channel->Generation;
+                        resume = true;
+                    }
+                }
+                else if (channel->Quarantined)
+                {
+                    channel->Quarantined = false;
+                    ++channel->Generation;
+                    resume = true;
+                }
+            }
+
+            CancelTimer(timerId);
+            if (quarantine != 0)
+            {
+                ScheduleTimer(channel, quarantine);
+            }
+            if (abandoned)
+            {
+                abandoned->OnComplete(nullptr, nullptr, errorCode);
+            }
+            if (resume)
+            {
+                PublishNext(channel);
+            }
+        }
+
+        void IdentityRequestClient::ScheduleTimer(const std::shared_ptr<Channel> &channel, uint64_t generation)
+        {
+            if (m_config.RequestTimeoutMs == 0)
+            {
+                return;
+            }
+
+            std::weak_ptr<IdentityRequestClient> weakSelf = shared_from_this();
+            Iotdevicecommon::TimerWheel::OnExpired onExpired = [weakSelf, channel, generation]() {
+                auto self = weakSelf.lock();
+                if (self)
+                {
+                    self->Abandon(channel, generation, AWS_ERROR_MQTT_TIMEOUT);
+                }
+            };
+
+            if (m_config.Timers)
+            {
+                uint64_t timerId = m_config.Timers->Schedule(m_config.RequestTimeoutMs, std::move(onExpired));
+                if (timerId != 0)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m_lock);
+                        if (channel->Generation == generation)
+                        {
+                            channel->TimerId = timerId;
+                            return;
+                        }
+                    }
+
+                    /* Answered while the timer was being scheduled. */
+                    m_config.Timers->Cancel(timerId);
+                    return;
+                }
+            }
+
+            auto *timeoutTask = Crt::New<TimeoutTask>(m_allocator);
+            if (!timeoutTask)
+            {
+                return;
+            }
+
+            timeoutTask->OnExpired = std::move(onExpired);
+            timeoutTask->Allocator = m_allocator;
+            aws_task_init(&timeoutTask->Task, s_onTimeoutTask, timeoutTask, "IdentityRequestClientTimeout");
+
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &now);
+            uint64_t timeout =
+                aws_timestamp_convert(m_config.RequestTimeoutMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+            aws_event_loop_schedule_task_future(m_eventLoop, &timeoutTask->Task, now + timeout);
+        }
+
+        void IdentityRequestClient::CancelTimer(uint64_t timerId)
+        {
+            if (timerId != 0 && m_config.Timers)
+            {
+                m_config.Timers->Cancel(timerId);
+            }
+        }
+
+        void IdentityRequestClient::CancelAll(int errorCode)
+        {
+            Crt::List<std::shared_ptr<PendingRequest>> cancelled;
+            Crt::Vector<uint64_t> timerIds;
+            Crt::Vector<std::pair<std::shared_ptr<Channel>, uint64_t>> quarantines;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto drain = [this, &cancelled, &timerIds, &quarantines](const std::shared_ptr<Channel> &channel) {
+                    if (channel->Outstanding)
+                    {
+                        /* Its response may still arrive; treat it as abandoned. */
+                        cancelled.push_back(std::move(channel->Outstanding));
+                        channel->Outstanding = nullptr;
+                        timerIds.push_back(channel->TimerId);
+                        channel->TimerId = 0;
+                        ++channel->Generation;
+                        if (m_config.RequestTimeoutMs != 0)
+                        {
+                            channel->Quarantined = true;
+                            quarantines.emplace_back(channel, channel->Generation);
+                        }
+                    }
+                    cancelled.splice(cancelled.end(), channel->Unpublished);
+                };
+                drain(m_keysChannel);
+                drain(m_csrChannel);
+                for (auto &entry : m_registerChannels)
+                {
+                    if (entry.second)
+                    {
+                        drain(entry.second);
+                    }
+                }
+            }
+
+            for (uint64_t timerId : timerIds)
+            {
+                CancelTimer(timerId);
+            }
+            for (const auto &quarantine : quarantines)
+            {
+                ScheduleTimer(quarantine.first, quarantine.second);
+            }
+            for (const auto &request : cancelled)
+            {
+                request->OnComplete(nullptr, nullptr, errorCode);
+            }
+        }
+
+    } // namespace Iotidentity
+
+} // namespace Aws
@@ -4,6 +4,10 @@
  */
 #include <aws/iotidentity/IotIdentityClient.h>
 
+#include <aws/iotdevicecommon/PayloadCodec.h>
+#include <aws/iotdevicecommon/ServiceOperations.h>
+#include <aws/iotdevicecommon/TopicBuilder.h>
+
 #include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
 #include <aws/iotidentity/CreateCertificateFromCsrResponse.h>
 #include <aws/iotidentity/CreateCertificateFromCsrSubscriptionRequest.h>
@@ -20,9 +24,40 @@ namespace Aws
     namespace Iotidentity
     {
 
-        IotIdentityClient::IotIdentityClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection)
-            : m_connection(connection)
+        IotIdentityClient::IotIdentityClient(
+            const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+            Aws::Crt::Allocator *allocator)
+            : IotIdentityClient(connection, Aws::Iotdevicecommon::ServiceClientConfig(), allocator)
+        {
+        }
+
+        IotIdentityClient::IotIdentityClient(
+            const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+            const Aws::Iotdevicecommon::ServiceClientConfig &config,
+            Aws::Crt::Allocator *allocator)
+            : m_allocator(allocator), m_stringAllocator(allocator), m_connection(connection),
+              m_payloadBufferPool(config.PayloadBufferPool), m_payloadFormat(config.PayloadFormat),
+              m_handlerContext(), m_metrics(config.Metrics), m_tracer(config.Tracer), m_session(config.Session),
+              m_memoryBudget(config.MemoryBudget), m_completionBatcher(config.CompletionBatcher),
+              m_publishLanes(config.PublishLanes), m_rateLimiter(config.RateLimiter), m_hotStandby(config.HotStandby),
+              m_qosPolicy(config.QosPolicy)
         {
+            if (!m_payloadBufferPool)
+            {
+                m_payloadBufferPool =
+                    Aws::Crt::MakeShared<Aws::Iotdevicecommon::PayloadBufferPool>(m_allocator, 0, 0, m_allocator);
+            }
+
+            auto handlerContext = Aws::Crt::MakeShared<Aws::Iotdevicecommon::HandlerContext>(m_allocator);
+            handlerContext->Executor = config.HandlerExecutor;
+            handlerContext->Pool = m_payloadBufferPool;
+            handlerContext->Metrics = config.Metrics;
+            handlerContext->Tracer = config.Tracer;
+            handlerContext->Watchdog = config.HandlerWatchdog;
+            handlerContext->LoopMonitor = config.EventLoopMonitor;
+            handlerContext->Budget = config.MemoryBudget;
+            handlerContext->Standby = config.HotStandby;
+            m_handlerContext = std::move(handlerContext);
         }
 
         IotIdentityClient::operator bool() const noexcept { return *m_connection; }
@@ -35,50 +70,39 @@ namespace Aws
             const OnSubscribeToCreateCertificateFromCsrAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
+            return SubscribeToCreateCertificateFromCsrAccepted(
+                request, qos, OnSubscribeToCreateCertificateFromCsrAcceptedResponse(handler), onSubAck);
+        }
+
+        bool IotIdentityClient::SubscribeToCreateCertificateFromCsrAccepted(
+            const Aws::Iotidentity::CreateCertificateFromCsrSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToCreateCertificateFromCsrAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::Provisioning, qos);
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::CreateCertificateFromCsrResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "certificates"
-                               << "/"
-                               << "create-from-csr"
-                               << "/"
-                               << "json"
-                               << "/"
-                               << "accepted";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "certificates"
+                           << "/"
+                           << "create-from-csr"
+                           << "/"
+                           << "json"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotidentity::CreateCertificateFromCsrResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotIdentityClient::SubscribeToCreateKeysAndCertificateRejected(
@@ -87,50 +111,39 @@ namespace Aws
             const OnSubscribeToCreateKeysAndCertificateRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
+            return SubscribeToCreateKeysAndCertificateRejected(
+                request, qos, OnSubscribeToCreateKeysAndCertificateRejectedResponse(handler), onSubAck);
+        }
+
+        bool IotIdentityClient::SubscribeToCreateKeysAndCertificateRejected(
+            const Aws::Iotidentity::CreateKeysAndCertificateSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToCreateKeysAndCertificateRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::Provisioning, qos);
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "certificates"
-                               << "/"
-                               << "create"
-                               << "/"
-                               << "json"
-                               << "/"
-                               << "rejected";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "certificates"
+                           << "/"
+                           << "create"
+                           << "/"
+                           << "json"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotidentity::ErrorResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotIdentityClient::SubscribeToRegisterThingAccepted(
@@ -139,50 +152,38 @@ namespace Aws
             const OnSubscribeToRegisterThingAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::RegisterThingResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "provisioning-templates"
-                               << "/" << *request.TemplateName << "/"
-                               << "provision"
-                               << "/"
-                               << "json"
-                               << "/"
-                               << "accepted";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return SubscribeToRegisterThingAccepted(
+                request, qos, OnSubscribeToRegisterThingAcceptedResponse(handler), onSubAck);
+        }
+
+        bool IotIdentityClient::SubscribeToRegisterThingAccepted(
+            const Aws::Iotidentity::RegisterThingSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToRegisterThingAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::Provisioning, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "provisioning-templates"
+                           << "/" << *request.TemplateName << "/"
+                           << "provision"
+                           << "/"
+                           << "json"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotidentity::RegisterThingResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotIdentityClient::SubscribeToRegisterThingRejected(
@@ -191,50 +192,38 @@ namespace Aws
             const OnSubscribeToRegisterThingRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "provisioning-templates"
-                               << "/" << *request.TemplateName << "/"
-                               << "provision"
-                               << "/"
-                               << "json"
-                               << "/"
-                               << "rejected";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return SubscribeToRegisterThingRejected(
+                request, qos, OnSubscribeToRegisterThingRejectedResponse(handler), onSubAck);
+        }
+
+        bool IotIdentityClient::SubscribeToRegisterThingRejected(
+            const Aws::Iotidentity::RegisterThingSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToRegisterThingRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::Provisioning, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "provisioning-templates"
+                           << "/" << *request.TemplateName << "/"
+                           << "provision"
+                           << "/"
+                           << "json"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotidentity::ErrorResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotIdentityClient::SubscribeToCreateKeysAndCertificateAccepted(
@@ -243,50 +232,39 @@ namespace Aws
             const OnSubscribeToCreateKeysAndCertificateAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
+            return SubscribeToCreateKeysAndCertificateAccepted(
+                request, qos, OnSubscribeToCreateKeysAndCertificateAcceptedResponse(handler), onSubAck);
+        }
+
+        bool IotIdentityClient::SubscribeToCreateKeysAndCertificateAccepted(
+            const Aws::Iotidentity::CreateKeysAndCertificateSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToCreateKeysAndCertificateAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::Provisioning, qos);
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::CreateKeysAndCertificateResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "certificates"
-                               << "/"
-                               << "create"
-                               << "/"
-                               << "json"
-                               << "/"
-                               << "accepted";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "certificates"
+                           << "/"
+                           << "create"
+                           << "/"
+                           << "json"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotidentity::CreateKeysAndCertificateResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotIdentityClient::SubscribeToCreateCertificateFromCsrRejected(
@@ -295,50 +273,39 @@ namespace Aws
             const OnSubscribeToCreateCertificateFromCsrRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
+            return SubscribeToCreateCertificateFromCsrRejected(
+                request, qos, OnSubscribeToCreateCertificateFromCsrRejectedResponse(handler), onSubAck);
+        }
+
+        bool IotIdentityClient::SubscribeToCreateCertificateFromCsrRejected(
+            const Aws::Iotidentity::CreateCertificateFromCsrSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToCreateCertificateFromCsrRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::Provisioning, qos);
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "certificates"
-                               << "/"
-                               << "create-from-csr"
-                               << "/"
-                               << "json"
-                               << "/"
-                               << "rejected";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "certificates"
+                           << "/"
+                           << "create-from-csr"
+                           << "/"
+                           << "json"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotidentity::ErrorResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotIdentityClient::PublishCreateCertificateFromCsr(
@@ -346,28 +313,59 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "certificates"
-                             << "/"
-                             << "create-from-csr"
-                             << "/"
-                             << "json";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::Provisioning, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "certificates"
+                         << "/"
+                         << "create-from-csr"
+                         << "/"
+                         << "json";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Provisioning,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
         bool IotIdentityClient::PublishCreateKeysAndCertificate(
@@ -375,28 +373,59 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "certificates"
-                             << "/"
-                             << "create"
-                             << "/"
-                             << "json";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::Provisioning, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "certificates"
+                         << "/"
+                         << "create"
+                         << "/"
+                         << "json";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Provisioning,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
         bool IotIdentityClient::PublishRegisterThing(
@@ -404,28 +433,59 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "provisioning-templates"
-                             << "/" << *request.TemplateName << "/"
-                             << "provision"
-                             << "/"
-                             << "json";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::Provisioning, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "provisioning-templates"
+                         << "/" << *request.TemplateName << "/"
+                         << "provision"
+                         << "/"
+                         << "json";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Provisioning,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
     } // namespace Iotidentity
@@ -0,0 +1,156 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/PemPublicKey.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        namespace
+        {
+            const uint8_t s_sequenceTag = 0x30;
+            const uint8_t s_explicitVersionTag = 0xa0;
+
+            /* One DER element: its tag, its contents, and the whole encoding. */
+            struct DerElement
+            {
+                uint8_t Tag = 0;
+                const uint8_t *Contents = nullptr;
+                size_t ContentsLength = 0;
+                const uint8_t *Encoding = nullptr;
+                size_t EncodingLength = 0;
+            };
+
+            /* Reads the element at `position`, moving it past the element. */
+            bool s_readElement(const uint8_t *&position, const uint8_t *end, DerElement &element)
+            {
+                const uint8_t *start = position;
+                if (end - position < 2)
+                {
+                    return false;
+                }
+                element.Tag = *position++;
+
+                size_t length = *position++;
+                if (length & 0x80)
+                {
+                    size_t lengthBytes = length & 0x7f;
+                    if (lengthBytes == 0 || lengthBytes > 4 || static_cast<size_t>(end - position) < lengthBytes)
+                    {
+                        return false;
+                    }
+                    length = 0;
+                    for (size_t i = 0; i < lengthBytes; ++i)
+                    {
+                        length = (length << 8) | *position++;
+                    }
+                }
+                if (static_cast<size_t>(end - position) < length)
+                {
+                    return false;
+                }
+
+                element.Contents = position;
+                element.ContentsLength = length;
+                position += length;
+                element.Encoding = start;
+                element.EncodingLength = static_cast<size_t>(position - start);
+                return true;
+            }
+
+            /* @return the DER between the BEGIN and END lines of the first PEM block labelled `label`. */
+            Crt::Vector<uint8_t> s_decodePem(const Crt::String &pem, const char *label)
+            {
+                Crt::String begin = Crt::String("-----BEGIN ") + label + "-----";
+                Crt::String end = Crt::String("-----END ") + label + "-----";
+                size_t bodyStart = pem.find(begin);
+                if (bodyStart == Crt::String::npos)
+                {
+                    return Crt::Vector<uint8_t>();
+                }
+                bodyStart += begin.size();
+                size_t bodyEnd = pem.find(end, bodyStart);
+                if (bodyEnd == Crt::String::npos)
+                {
+                    return Crt::Vector<uint8_t>();
+                }
+
+                Crt::String base64;
+                base64.reserve(bodyEnd - bodyStart);
+                for (size_t i = bodyStart; i < bodyEnd; ++i)
+                {
+                    char c = pem[i];
+                    if (c != '\r' && c != '\n' && c != ' ' && c != '\t')
+                    {
+                        base64.push_back(c);
+                    }
+                }
+                return base64.empty() ? Crt::Vector<uint8_t>() : Crt::Base64Decode(base64);
+            }
+
+            /*
+             * Finds the SubjectPublicKeyInfo in the to-be-signed part of a certificate or CSR: the element after
+             * `skipped` others of the inner SEQUENCE, not counting a certificate's explicit version.
+             */
+            Crt::Vector<uint8_t> s_publicKeyOf(const Crt::Vector<uint8_t> &der, size_t skipped)
+            {
+                const uint8_t *position = der.data();
+                const uint8_t *end = position + der.size();
+                DerElement outer;
+                DerElement signedPart;
+                if (!s_readElement(position, end, outer) || outer.Tag != s_sequenceTag)
+                {
+                    return Crt::Vector<uint8_t>();
+                }
+                position = outer.Contents;
+                end = outer.Contents + outer.ContentsLength;
+                if (!s_readElement(position, end, signedPart) || signedPart.Tag != s_sequenceTag)
+                {
+                    return Crt::Vector<uint8_t>();
+                }
+
+                position = signedPart.Contents;
+                end = signedPart.Contents + signedPart.ContentsLength;
+                DerElement element;
+                for (size_t index = 0; s_readElement(position, end, element);)
+                {
+                    if (index == 0 && element.Tag == s_explicitVersionTag)
+                    {
+                        continue;
+                    }
+                    if (index++ == skipped)
+                    {
+                        if (element.Tag != s_sequenceTag)
+                        {
+                            break;
+                        }
+                        return Crt::Vector<uint8_t>(element.Encoding, element.Encoding + element.EncodingLength);
+                    }
+                }
+                return Crt::Vector<uint8_t>();
+            }
+        } // namespace
+
+        Crt::Vector<uint8_t> PublicKeyOfPem(const Crt::String &pem)
+        {
+            /* CertificationRequestInfo: version, subject, subjectPKInfo, ... (RFC 2986) */
+            Crt::Vector<uint8_t> der = s_decodePem(pem, "CERTIFICATE REQUEST");
+            if (!der.empty())
+            {
+                return s_publicKeyOf(der, 2);
+            }
+
+            /* TBSCertificate: [0] version, serialNumber, signature, issuer, validity, subject, ... (RFC 5280) */
+            der = s_decodePem(pem, "CERTIFICATE");
+            if (!der.empty())
+            {
+                return s_publicKeyOf(der, 5);
+            }
+            return Crt::Vector<uint8_t>();
+        }
+
+    } // namespace Iotidentity
+
+} // namespace Aws
@@ -0,0 +1,296 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/ProvisioningPipeline.h>
+
+#include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
+#include <aws/iotidentity/CreateCertificateFromCsrResponse.h>
+#include <aws/iotidentity/ErrorResponse.h>
+#include <aws/iotidentity/RegisterThingRequest.h>
+#include <aws/iotidentity/RegisterThingResponse.h>
+
+#include <aws/common/clock.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        namespace
+        {
+            uint64_t s_nowNs()
+            {
+                uint64_t now = 0;
+                aws_high_res_clock_get_ticks(&now);
+                return now;
+            }
+        } // namespace
+
+        ProvisioningPipelineConfig::ProvisioningPipelineConfig() noexcept
+            : TemplateName(), MaxInFlight(8), Qos(AWS_MQTT_QOS_AT_LEAST_ONCE), StageTimeoutMs(30000), Timers()
+        {
+        }
+
+        ProvisioningPipeline::ProvisioningPipeline(
+            const std::shared_ptr<IdentityRequestClient> &requests,
+            const ProvisioningPipelineConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_requests(requests), m_config(config), m_allocator(allocator), m_inFlight(0)
+        {
+            if (m_config.MaxInFlight == 0)
+            {
+                m_config.MaxInFlight = 1;
+            }
+        }
+
+        std::shared_ptr<ProvisioningPipeline> ProvisioningPipeline::Create(
+            const IotIdentityClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const ProvisioningPipelineConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (config.TemplateName.empty())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            IdentityRequestClientConfig requestConfig;
+            requestConfig.Qos = config.Qos;
+            requestConfig.RequestTimeoutMs = config.StageTimeoutMs;
+            requestConfig.Timers = config.Timers;
+            auto requests = IdentityRequestClient::Create(client, eventLoopGroup, requestConfig, allocator);
+            if (!requests)
+            {
+                return nullptr;
+            }
+
+            auto *toSeat =
+                static_cast<ProvisioningPipeline *>(aws_mem_acquire(allocator, sizeof(ProvisioningPipeline)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ProvisioningPipeline(requests, config, allocator);
+                return std::shared_ptr<ProvisioningPipeline>(
+                    toSeat, [allocator](ProvisioningPipeline *pipeline) { Crt::Delete(pipeline, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool ProvisioningPipeline::Subscribe(const OnSubscribeComplete &onSubAck)
+        {
+            return m_requests->Subscribe(m_config.TemplateName, onSubAck);
+        }
+
+        bool ProvisioningPipeline::Provision(
+            const ProvisioningRequest &request,
+            const OnProvisioningComplete &onComplete)
+        {
+            auto flow = Crt::MakeShared<Flow>(m_allocator);
+            if (!flow)
+            {
+                return false;
+            }
+            flow->Request = request;
+            flow->OnComplete = onComplete;
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_queued.push_back(std::move(flow));
+            }
+
+            Pump();
+            return true;
+        }
+
+        void ProvisioningPipeline::Pump()
+        {
+            while (true)
+            {
+                std::shared_ptr<Flow> flow;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (m_queued.empty() || m_inFlight >= m_config.MaxInFlight)
+                    {
+                        return;
+                    }
+                    flow = std::move(m_queued.front());
+                    m_queued.pop_front();
+                    ++m_inFlight;
+                }
+
+                StartCreateCertificate(flow);
+            }
+        }
+
+        void ProvisioningPipeline::StartCreateCertificate(const std::shared_ptr<Flow> &flow)
+        {
+            CreateCertificateFromCsrRequest request;
+            request.CertificateSigningRequest = flow->Request.CertificateSigningRequest;
+
+            std::weak_ptr<ProvisioningPipeline> weakPipeline = shared_from_this();
+            auto onComplete =
+                [weakPipeline, flow](CreateCertificateFromCsrResponse *response, ErrorResponse *error, int ioErr) {
+                    auto pipeline = weakPipeline.lock();
+                    if (!pipeline)
+                    {
+                        return;
+                    }
+                    if (response || error)
+                    {
+                        pipeline->RecordStage(pipeline->m_stats.CreateCertificate, *flow);
+                    }
+                    if (!response)
+                    {
+                        pipeline->Finish(flow, nullptr, error, ioErr);
+                        return;
+                    }
+
+                    if (!response->CertificateOwnershipToken)
+                    {
+                        pipeline->Finish(flow, nullptr, nullptr, AWS_ERROR_INVALID_ARGUMENT);
+                        return;
+                    }
+                    if (response->CertificateId)
+                    {
+                        flow->Result.CertificateId = *response->CertificateId;
+                    }
+                    if (response->CertificatePem)
+                    {
+                        flow->Result.CertificatePem = *response->CertificatePem;
+                    }
+                    pipeline->StartRegisterThing(flow, *response->CertificateOwnershipToken);
+                };
+
+            flow->StageStartNs = s_nowNs();
+            if (!m_requests->CreateCertificateFromCsrAsync(request, onComplete))
+            {
+                Finish(flow, nullptr, nullptr, Crt::LastErrorOrUnknown());
+            }
+        }
+
+        void ProvisioningPipeline::StartRegisterThing(
+            const std::shared_ptr<Flow> &flow,
+            const Crt::String &ownershipToken)
+        {
+            RegisterThingRequest request;
+            request.TemplateName = m_config.TemplateName;
+            request.CertificateOwnershipToken = ownershipToken;
+            request.Parameters = flow->Request.Parameters;
+
+            std::weak_ptr<ProvisioningPipeline> weakPipeline = shared_from_this();
+            auto onComplete = [weakPipeline, flow](RegisterThingResponse *response, ErrorResponse *error, int ioErr) {
+                auto pipeline = weakPipeline.lock();
+                if (!pipeline)
+                {
+                    return;
+                }
+                if (response || error)
+                {
+                    pipeline->RecordStage(pipeline->m_stats.RegisterThing, *flow);
+                }
+                if (!response)
+                {
+                    pipeline->Finish(flow, nullptr, error, ioErr);
+                    return;
+                }
+
+                if (response->ThingName)
+                {
+                    flow->Result.ThingName = *response->ThingName;
+                }
+                if (response->DeviceConfiguration)
+                {
+                    flow->Result.DeviceConfiguration = *response->DeviceConfiguration;
+                }
+                pipeline->Finish(flow, &flow->Result, nullptr, AWS_ERROR_SUCCESS);
+            };
+
+            flow->StageStartNs = s_nowNs();
+            if (!m_requests->RegisterThingAsync(request, onComplete))
+            {
+                Finish(flow, nullptr, nullptr, Crt::LastErrorOrUnknown());
+            }
+        }
+
+        void ProvisioningPipeline::RecordStage(ProvisioningStageStats &stats, const Flow &flow)
+        {
+            uint64_t elapsed = s_nowNs() - flow.StageStartNs;
+            std::lock_guard<std::mutex> lock(m_lock);
+            ++stats.Count;
+            stats.TotalNs += elapsed;
+            if (elapsed > stats.MaxNs)
+            {
+                stats.MaxNs = elapsed;
+            }
+        }
+
+        void ProvisioningPipeline::Finish(
+            const std::shared_ptr<Flow> &flow,
+            ProvisioningResult *result,
+            ErrorResponse *error,
+            int ioErr)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                --m_inFlight;
+                if (result)
+                {
+                    ++m_stats.Succeeded;
+                }
+                else
+                {
+                    ++m_stats.Failed;
+                }
+            }
+
+            if (flow->OnComplete)
+            {
+                flow->OnComplete(result, error, ioErr);
+            }
+
+            Pump();
+        }
+
+        void ProvisioningPipeline::CancelAll(int errorCode)
+        {
+            /* Taken first so the started flows finishing below do not start the queued ones. */
+            FlowQueue cancelled;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                cancelled.swap(m_queued);
+                m_stats.Failed += cancelled.size();
+            }
+
+            m_requests->CancelAll(errorCode);
+
+            for (const auto &flow : cancelled)
+            {
+                if (flow->OnComplete)
+                {
+                    flow->OnComplete(nullptr, nullptr, errorCode);
+                }
+            }
+        }
+
+        ProvisioningStats ProvisioningPipeline::GetStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_stats;
+        }
+
+        size_t ProvisioningPipeline::GetInFlightCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_inFlight;
+        }
+
+        size_t ProvisioningPipeline::GetQueuedCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_queued.size();
+        }
+
+    } // namespace Iotidentity
+
+} // namespace Aws
@@ -4,54 +4,36 @@
  */
 #include <aws/iotidentity/RegisterThingRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotidentity
     {
-
-        void RegisterThingRequest::LoadFromObject(RegisterThingRequest &val, const Aws::Crt::JsonView &doc)
+        namespace
         {
-            (void)val;
-            (void)doc;
+            using Fields = Aws::Iotdevicecommon::ModelFields<RegisterThingRequest, true>;
 
-            if (doc.ValueExists("parameters"))
-            {
-                auto parametersMap = doc.GetJsonObject("parameters");
-                val.Parameters = Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
-                for (auto &parametersMapMember : parametersMap.GetAllObjects())
-                {
-                    Aws::Crt::String parametersMapValMember;
-                    parametersMapValMember = parametersMapMember.second.AsString();
-                    val.Parameters->emplace(parametersMapMember.first, std::move(parametersMapValMember));
-                }
-            }
+            constexpr Aws::Iotdevicecommon::ModelField<RegisterThingRequest> s_fields[] = {
+                Fields::Field<Crt::Map<Crt::String, Crt::String>, &RegisterThingRequest::Parameters>("parameters"),
+                Fields::Field<Crt::String, &RegisterThingRequest::CertificateOwnershipToken>(
+                    "certificateOwnershipToken"),
+            };
+        } // namespace
 
-            if (doc.ValueExists("certificateOwnershipToken"))
-            {
-                val.CertificateOwnershipToken = doc.GetString("certificateOwnershipToken");
-            }
+        void RegisterThingRequest::LoadFromObject(RegisterThingRequest &val, const Aws::Crt::JsonView &doc)
+        {
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void RegisterThingRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (Parameters)
-            {
-                Aws::Crt::JsonObject parametersMap;
-                for (auto &parametersMapMember : *Parameters)
-                {
-                    Aws::Crt::JsonObject parametersMapValMember;
-                    parametersMapValMember.AsString(parametersMapMember.second);
-                    parametersMap.WithObject(parametersMapMember.first, std::move(parametersMapValMember));
-                }
-                object.WithObject("parameters", std::move(parametersMap));
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (CertificateOwnershipToken)
-            {
-                object.WithString("certificateOwnershipToken", *CertificateOwnershipToken);
-            }
+        void RegisterThingRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         RegisterThingRequest::RegisterThingRequest(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
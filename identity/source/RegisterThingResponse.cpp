@@ -4,56 +4,31 @@
  */
 #include <aws/iotidentity/RegisterThingResponse.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotidentity
     {
-
-        void RegisterThingResponse::LoadFromObject(RegisterThingResponse &val, const Aws::Crt::JsonView &doc)
+        namespace
         {
-            (void)val;
-            (void)doc;
+            using Fields = Aws::Iotdevicecommon::ModelFields<RegisterThingResponse>;
 
-            if (doc.ValueExists("thingName"))
-            {
-                val.ThingName = doc.GetString("thingName");
-            }
+            constexpr Aws::Iotdevicecommon::ModelField<RegisterThingResponse> s_fields[] = {
+                Fields::Field<Crt::String, &RegisterThingResponse::ThingName>("thingName"),
+                Fields::Field<Crt::Map<Crt::String, Crt::String>, &RegisterThingResponse::DeviceConfiguration>(
+                    "deviceConfiguration"),
+            };
+        } // namespace
 
-            if (doc.ValueExists("deviceConfiguration"))
-            {
-                auto deviceConfigurationMap = doc.GetJsonObject("deviceConfiguration");
-                val.DeviceConfiguration = Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
-                for (auto &deviceConfigurationMapMember : deviceConfigurationMap.GetAllObjects())
-                {
-                    Aws::Crt::String deviceConfigurationMapValMember;
-                    deviceConfigurationMapValMember = deviceConfigurationMapMember.second.AsString();
-                    val.DeviceConfiguration->emplace(
-                        deviceConfigurationMapMember.first, std::move(deviceConfigurationMapValMember));
-                }
-            }
+        void RegisterThingResponse::LoadFromObject(RegisterThingResponse &val, const Aws::Crt::JsonView &doc)
+        {
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void RegisterThingResponse::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (ThingName)
-            {
-                object.WithString("thingName", *ThingName);
-            }
-
-            if (DeviceConfiguration)
-            {
-                Aws::Crt::JsonObject deviceConfigurationMap;
-                for (auto &deviceConfigurationMapMember : *DeviceConfiguration)
-                {
-                    Aws::Crt::JsonObject deviceConfigurationMapValMember;
-                    deviceConfigurationMapValMember.AsString(deviceConfigurationMapMember.second);
-                    deviceConfigurationMap.WithObject(
-                        deviceConfigurationMapMember.first, std::move(deviceConfigurationMapValMember));
-                }
-                object.WithObject("deviceConfiguration", std::move(deviceConfigurationMap));
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         RegisterThingResponse::RegisterThingResponse(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
@@ -1,7 +1,9 @@
 include(CMakeFindDependencyMacro)
 
 find_dependency(aws-crt-cpp)
-find_dependency(aws-c-iot)
+if (NOT @IOTDEVICECOMMON_WITHOUT_AWS_C_IOT@)
+    find_dependency(aws-c-iot)
+endif()
 
 if (BUILD_SHARED_LIBS)
     include(${CMAKE_CURRENT_LIST_DIR}/shared/@PROJECT_NAME@-targets.cmake)
@@ -0,0 +1,163 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+/**
+ * co_await-able wrappers for the callback-based service client operations. Header-only and compiled only when
+ * the including translation unit is C++20 with coroutine support, so the SDK libraries themselves still build as
+ * C++11. AWS_IOTDEVICECOMMON_COROUTINES is defined to 1 when they are available.
+ *
+ * An awaiting coroutine is resumed directly on the thread that completes the operation, usually the
+ * connection's event loop (or the client's handler executor), with no extra thread hop. Like any callback it
+ * must not block there.
+ */
+
+#if (__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)) && defined(__has_include)
+#    if __has_include(<coroutine>)
+#        define AWS_IOTDEVICECOMMON_COROUTINES 1
+#    endif
+#endif
+
+#ifdef AWS_IOTDEVICECOMMON_COROUTINES
+
+#    include <aws/crt/Optional.h>
+#    include <aws/crt/Types.h>
+
+#    include <atomic>
+#    include <coroutine>
+#    include <functional>
+#    include <memory>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Outcome of an operation that completes with an error code alone, e.g. a Publish* or Subscribe*.
+         */
+        struct OperationResult
+        {
+            int ErrorCode = AWS_ERROR_SUCCESS;
+        };
+
+        /**
+         * Outcome of a correlated request: the accepted response or the rejection the service sent, or
+         * neither when the request failed locally with ErrorCode.
+         */
+        template <typename ResponseType, typename ErrorType> struct ResponseResult
+        {
+            Crt::Optional<ResponseType> Response;
+            Crt::Optional<ErrorType> Error;
+            int ErrorCode = AWS_ERROR_SUCCESS;
+        };
+
+        /**
+         * Awaiter that starts an operation when awaited and resumes the coroutine with its Result. `start`
+         * receives the completion to pass to the operation, and returns false if the operation could not be
+         * started, in which case the completion must not be invoked and the result's ErrorCode is
+         * aws_last_error().
+         */
+        template <typename Result> class OperationAwaiter final
+        {
+          public:
+            using OnComplete = std::function<void(Result &&result)>;
+            using Start = std::function<bool(OnComplete &&onComplete)>;
+
+            explicit OperationAwaiter(Start &&start) : m_start(std::move(start)), m_state(std::make_shared<State>())
+            {
+            }
+
+            bool await_ready() const noexcept { return false; }
+
+            bool await_suspend(std::coroutine_handle<> awaiting)
+            {
+                m_state->Awaiting = awaiting;
+                std::shared_ptr<State> state = m_state;
+                bool started = m_start([state](Result &&result) {
+                    state->Value = std::move(result);
+                    /* Resume only if await_suspend has already returned true. */
+                    if (state->Completed.exchange(true))
+                    {
+                        state->Awaiting.resume();
+                    }
+                });
+
+                if (!started)
+                {
+                    m_state->Value.ErrorCode = aws_last_error();
+                    return false;
+                }
+
+                /* Completed before we got here: carry on without suspending. */
+                return !m_state->Completed.exchange(true);
+            }
+
+            Result await_resume() { return std::move(m_state->Value); }
+
+          private:
+            struct State
+            {
+                std::coroutine_handle<> Awaiting;
+                std::atomic<bool> Completed{false};
+                Result Value;
+            };
+
+            Start m_start;
+            std::shared_ptr<State> m_state;
+        };
+
+        /**
+         * Awaits an operation completing with `void(int errorCode)`:
+         *
+         *     auto result = co_await Iotdevicecommon::AwaitOperation([&](std::function<void(int)> &&done) {
+         *         return shadowClient.PublishUpdateShadow(request, AWS_MQTT_QOS_AT_LEAST_ONCE, std::move(done));
+         *     });
+         */
+        inline OperationAwaiter<OperationResult> AwaitOperation(
+            std::function<bool(std::function<void(int errorCode)> &&onComplete)> &&start)
+        {
+            return OperationAwaiter<OperationResult>(
+                [start](typename OperationAwaiter<OperationResult>::OnComplete &&onComplete) {
+                    auto complete = std::move(onComplete);
+                    return start([complete](int errorCode) {
+                        OperationResult result;
+                        result.ErrorCode = errorCode;
+                        complete(std::move(result));
+                    });
+                });
+        }
+
+        /**
+         * Awaits a correlated request completing with `void(ResponseType *, ErrorType *, int errorCode)`,
+         * copying the response or rejection out of the callback.
+         */
+        template <typename ResponseType, typename ErrorType>
+        OperationAwaiter<ResponseResult<ResponseType, ErrorType>> AwaitResponse(
+            std::function<bool(std::function<void(ResponseType *, ErrorType *, int errorCode)> &&onComplete)> &&start)
+        {
+            using Result = ResponseResult<ResponseType, ErrorType>;
+            return OperationAwaiter<Result>([start](typename OperationAwaiter<Result>::OnComplete &&onComplete) {
+                auto complete = std::move(onComplete);
+                return start([complete](ResponseType *response, ErrorType *error, int errorCode) {
+                    Result result;
+                    if (response)
+                    {
+                        result.Response = *response;
+                    }
+                    if (error)
+                    {
+                        result.Error = *error;
+                    }
+                    result.ErrorCode = errorCode;
+                    complete(std::move(result));
+                });
+            });
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
+
+#endif // AWS_IOTDEVICECOMMON_COROUTINES
@@ -0,0 +1,34 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Decodes CBOR payloads into the JSON document type the generated response models load from, so every
+         * model can be read from either encoding.
+         */
+        namespace CborReader
+        {
+            /**
+             * Decodes a single CBOR data item spanning all of `payload` into `document`.
+             *
+             * Tags are skipped, undefined decodes as null, and map keys must be text strings. Byte strings
+             * have no JSON equivalent and are rejected. Returns false and raises AWS_ERROR_INVALID_ARGUMENT on
+             * malformed, unsupported or overly nested input.
+             */
+            bool AWS_IOTDEVICECOMMON_API
+                ToJsonObject(const Crt::ByteCursor &payload, Crt::JsonObject &document) noexcept;
+        } // namespace CborReader
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
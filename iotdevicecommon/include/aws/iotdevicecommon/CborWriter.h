@@ -0,0 +1,69 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/PayloadWriter.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Appends CBOR (RFC 8949) directly to a ByteBuf, growing it as needed.
+         *
+         * Objects and arrays are written with indefinite length so members can be streamed without counting
+         * them first. Integers use the shortest encoding, and doubles that survive the round trip are
+         * narrowed to single precision.
+         */
+        class AWS_IOTDEVICECOMMON_API CborWriter final : public PayloadWriter
+        {
+          public:
+            /**
+             * @param buffer an initialized buffer with an allocator; output is appended after its contents.
+             */
+            explicit CborWriter(Crt::ByteBuf &buffer) noexcept;
+            CborWriter(const CborWriter &) = delete;
+            CborWriter(CborWriter &&) = delete;
+            CborWriter &operator=(const CborWriter &) = delete;
+            CborWriter &operator=(CborWriter &&) = delete;
+            ~CborWriter() override = default;
+
+            CborWriter &BeginObject() noexcept override;
+            CborWriter &EndObject() noexcept override;
+            CborWriter &BeginArray() noexcept override;
+            CborWriter &EndArray() noexcept override;
+
+            CborWriter &Key(const char *key) noexcept override;
+            CborWriter &Key(const Crt::String &key) noexcept override;
+
+            CborWriter &String(const char *value) noexcept override;
+            CborWriter &String(const Crt::String &value) noexcept override;
+            CborWriter &String(const Crt::ByteCursor &value) noexcept override;
+            CborWriter &Bool(bool value) noexcept override;
+            CborWriter &Integer(int32_t value) noexcept override;
+            CborWriter &Int64(int64_t value) noexcept override;
+            CborWriter &Double(double value) noexcept override;
+            CborWriter &Null() noexcept override;
+
+            /**
+             * Transcodes the JSON value item by item.
+             */
+            CborWriter &Value(const Crt::JsonView &value) noexcept override;
+
+            operator bool() const noexcept override;
+
+          private:
+            void AppendHead(uint8_t majorType, uint64_t argument) noexcept;
+            void AppendText(const char *value, size_t length) noexcept;
+            void Append(const uint8_t *bytes, size_t length) noexcept;
+            void AppendValue(const Crt::JsonView &value, size_t depth) noexcept;
+
+            Crt::ByteBuf &m_buffer;
+            bool m_failed;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
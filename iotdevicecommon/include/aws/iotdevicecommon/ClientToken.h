@@ -0,0 +1,35 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Length of the tokens GenerateClientToken produces, chosen to fit the short-string buffer of the
+         * standard libraries so a token held in a Crt::String does not allocate either.
+         */
+        static const size_t ClientTokenLength = 15;
+
+        /**
+         * Writes a new request client token and its terminator into `token`, without allocating.
+         *
+         * Tokens are a random per-process prefix followed by a counter, in lower-case base 32, so they are
+         * unique within a process and collide between processes with negligible probability. They are not
+         * secret or unpredictable, and are meant only for correlating responses with requests.
+         */
+        AWS_IOTDEVICECOMMON_API void GenerateClientToken(char (&token)[ClientTokenLength + 1]) noexcept;
+
+        /**
+         * As above, returning the token as a string.
+         */
+        AWS_IOTDEVICECOMMON_API Crt::String GenerateClientToken();
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
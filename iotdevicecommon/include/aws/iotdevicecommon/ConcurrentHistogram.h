@@ -0,0 +1,101 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        /**
+         * Durations in log-linear buckets, HDR histogram style: every power of two of nanoseconds is split into
+         * SubBucketCount equal buckets, so a bucket's bounds are within 1/SubBucketCount of any value in it.
+         * Durations from 0 to 2^MaxExponent ns (about 18 minutes) are resolved; longer ones fall into the last
+         * bucket. Fixed size, and cheap to copy and merge.
+         */
+        struct AWS_IOTDEVICECOMMON_API LogLinearHistogram
+        {
+            static const size_t SubBucketBits = 3;
+            static const size_t SubBucketCount = size_t(1) << SubBucketBits;
+            static const size_t MaxExponent = 40;
+            static const size_t BucketCount = (MaxExponent - SubBucketBits + 1) * SubBucketCount;
+
+            LogLinearHistogram() noexcept;
+
+            void Record(uint64_t durationNs) noexcept;
+
+            /**
+             * Adds every duration recorded in `other`.
+             */
+            void Merge(const LogLinearHistogram &other) noexcept;
+
+            /**
+             * @return the upper bound of the bucket holding the `percentile` (0 to 1) duration, or 0 if
+             * nothing was recorded.
+             */
+            uint64_t ValueAtPercentile(double percentile) const noexcept;
+
+            static size_t BucketOf(uint64_t durationNs) noexcept;
+
+            /**
+             * @return the largest duration that falls into `bucket`.
+             */
+            static uint64_t BucketUpperBoundNs(size_t bucket) noexcept;
+
+            uint64_t Buckets[BucketCount];
+            uint64_t Count;
+            uint64_t TotalNs;
+            uint64_t MaxNs;
+        };
+
+        /**
+         * A LogLinearHistogram that any number of threads record into without locking. Each thread records into
+         * one of StripeCount stripes with relaxed atomic adds, so threads rarely share a cache line, and
+         * GetSnapshot merges the stripes into a plain histogram. Memory is fixed at construction.
+         *
+         * A snapshot taken while threads are recording may miss their latest durations, or count one in Count
+         * before its bucket; it never loses a duration for later snapshots.
+         */
+        class AWS_IOTDEVICECOMMON_API ConcurrentHistogram final
+        {
+          public:
+            static const size_t StripeCount = 8;
+
+            ConcurrentHistogram() noexcept;
+            ConcurrentHistogram(const ConcurrentHistogram &) = delete;
+            ConcurrentHistogram(ConcurrentHistogram &&) = delete;
+            ConcurrentHistogram &operator=(const ConcurrentHistogram &) = delete;
+            ConcurrentHistogram &operator=(ConcurrentHistogram &&) = delete;
+
+            void Record(uint64_t durationNs) noexcept;
+
+            /**
+             * @return every duration recorded so far, merged over the stripes.
+             */
+            LogLinearHistogram GetSnapshot() const noexcept;
+
+            /**
+             * Forgets every duration. Durations recorded concurrently may survive it.
+             */
+            void Reset() noexcept;
+
+          private:
+            struct Stripe
+            {
+                std::atomic<uint64_t> Buckets[LogLinearHistogram::BucketCount];
+                std::atomic<uint64_t> Count;
+                std::atomic<uint64_t> TotalNs;
+                std::atomic<uint64_t> MaxNs;
+            };
+
+            Stripe m_stripes[StripeCount];
+        };
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,55 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * A consistent hash ring mapping keys (thing names) onto a fixed number of shards. Each shard owns
+         * several points on the ring, so keys spread evenly and a ring built with one more or one fewer shard
+         * moves only about 1/N of the keys.
+         *
+         * The hash is FNV-1a, so a key maps to the same shard in every process and on every platform.
+         */
+        class AWS_IOTDEVICECOMMON_API ConnectionShardRing final
+        {
+          public:
+            /**
+             * @param shardCount number of shards; a ring with no shards maps every key to shard 0.
+             * @param pointsPerShard ring points per shard. More points give a more even spread.
+             * @param allocator allocator used for the ring.
+             */
+            ConnectionShardRing(
+                size_t shardCount,
+                size_t pointsPerShard = 64,
+                Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+
+            /**
+             * @return the shard, in [0, GetShardCount()), that owns `key`.
+             */
+            size_t ShardFor(const Crt::ByteCursor &key) const noexcept;
+            size_t ShardFor(const Crt::String &key) const noexcept;
+
+            size_t GetShardCount() const noexcept { return m_shardCount; }
+
+          private:
+            struct Point
+            {
+                uint64_t hash;
+                size_t shard;
+            };
+
+            size_t m_shardCount;
+            Crt::Vector<Point> m_points;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
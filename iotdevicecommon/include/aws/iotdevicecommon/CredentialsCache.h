@@ -0,0 +1,64 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/auth/Credentials.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <memory>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        class AWS_IOTDEVICECOMMON_API CredentialsCacheConfig final
+        {
+          public:
+            CredentialsCacheConfig() noexcept;
+            CredentialsCacheConfig(const CredentialsCacheConfig &rhs) = default;
+            CredentialsCacheConfig(CredentialsCacheConfig &&rhs) = default;
+
+            CredentialsCacheConfig &operator=(const CredentialsCacheConfig &rhs) = default;
+            CredentialsCacheConfig &operator=(CredentialsCacheConfig &&rhs) = default;
+
+            ~CredentialsCacheConfig() = default;
+
+            /**
+             * The provider credentials are fetched from when none are cached, e.g. the X.509 provider.
+             * Required.
+             */
+            std::shared_ptr<Crt::Auth::ICredentialsProvider> Provider;
+
+            /**
+             * The longest credentials are reused for. Credentials that expire sooner are fetched again at
+             * their expiration. Defaults to 900000 (15 minutes).
+             */
+            uint32_t MaxCacheTimeMs;
+
+            /**
+             * Whether Create fetches credentials right away, so the first connect does not wait for them.
+             * Defaults to true.
+             */
+            bool Prefetch;
+        };
+
+        /**
+         * Creates a credentials provider for the Iot::WebsocketConfig of a connection that reconnects often,
+         * which reuses the credentials it fetched until they expire. Every websocket handshake is signed
+         * afresh, as a SigV4 signature is bound to its time, but a reconnect then signs with cached
+         * credentials instead of fetching new ones; connects made while a fetch is under way all wait for that
+         * one fetch. The default provider chain caches already; wrap the X.509 provider and custom providers,
+         * which fetch on every call otherwise.
+         *
+         * Share one between the connections of a process, so a reconnect storm costs one fetch.
+         *
+         * @return the provider, or null if it could not be created.
+         */
+        AWS_IOTDEVICECOMMON_API std::shared_ptr<Crt::Auth::ICredentialsProvider> CreateCachedCredentialsProvider(
+            const CredentialsCacheConfig &config,
+            Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
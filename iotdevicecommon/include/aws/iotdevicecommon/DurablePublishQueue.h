@@ -0,0 +1,157 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        class AWS_IOTDEVICECOMMON_API DurablePublishQueueConfig final
+        {
+          public:
+            DurablePublishQueueConfig() noexcept;
+            DurablePublishQueueConfig(const DurablePublishQueueConfig &rhs) = default;
+            DurablePublishQueueConfig(DurablePublishQueueConfig &&rhs) = default;
+
+            DurablePublishQueueConfig &operator=(const DurablePublishQueueConfig &rhs) = default;
+            DurablePublishQueueConfig &operator=(DurablePublishQueueConfig &&rhs) = default;
+
+            ~DurablePublishQueueConfig() = default;
+
+            /**
+             * How many queued publishes may await their completion at once while draining.
+             */
+            size_t MaxInFlight;
+
+            /**
+             * The most topic and payload bytes kept queued; publishes beyond it are refused. Zero means no cap.
+             */
+            uint64_t MaxQueuedBytes;
+        };
+
+        /**
+         * An outbound publish queue kept in a file, so that updates made while the device is offline survive both
+         * the outage and a restart, and are delivered in order once it reconnects.
+         *
+         * Service clients given one in ServiceClientConfig::OfflineQueue hand their shadow and job execution
+         * updates to it instead of the connection. Call Drain() with the connection once it is connected or
+         * resumed, and Pause() when it is interrupted: publishes are then sent oldest first with at most
+         * MaxInFlight awaiting completion, and each is removed from the file when it completes. One that fails
+         * stays queued and pauses draining until the next Drain(). Completion handlers are only kept in memory;
+         * after a restart the recovered publishes are delivered without them.
+         *
+         * Publishes given the same coalescing key replace one another while still queued, so hours of offline
+         * shadow updates flush as one. The file is an append-only log of CRC-checked records, compacted on
+         * Open and whenever removed records outnumber queued ones; a torn record from a crash ends recovery.
+         */
+        class AWS_IOTDEVICECOMMON_API DurablePublishQueue final
+            : public std::enable_shared_from_this<DurablePublishQueue>
+        {
+          public:
+            using OnDelivered = std::function<void(int errorCode)>;
+
+            /**
+             * Combines the payload of a queued publish with the payload that supersedes it.
+             *
+             * @return false to queue `newer` as is.
+             */
+            using MergePayloads =
+                std::function<bool(const Crt::ByteCursor &older, const Crt::ByteCursor &newer, Crt::String &merged)>;
+
+            ~DurablePublishQueue();
+            DurablePublishQueue(const DurablePublishQueue &) = delete;
+            DurablePublishQueue(DurablePublishQueue &&) = delete;
+            DurablePublishQueue &operator=(const DurablePublishQueue &) = delete;
+            DurablePublishQueue &operator=(DurablePublishQueue &&) = delete;
+
+            /**
+             * Opens the queue at `path`, creating it if it does not exist and recovering what it holds otherwise.
+             *
+             * @return null, with the error raised, if the file cannot be opened.
+             */
+            static std::shared_ptr<DurablePublishQueue> Open(
+                const char *path,
+                const DurablePublishQueueConfig &config = DurablePublishQueueConfig(),
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+            /**
+             * Writes a publish to the queue, sending it straight away if the queue is draining. A non-empty
+             * `coalesceKey` replaces the queued publish with the same key, unless it is already being sent,
+             * with `merge` deciding the payload (by default the newer one). The replacement takes the place of
+             * the newest publish in the queue, and both handlers are invoked when it completes.
+             *
+             * @return false, with the error raised, if the publish could not be written to the file or the
+             * queue is full.
+             */
+            bool Enqueue(
+                const char *topic,
+                Crt::Mqtt::QOS qos,
+                const Crt::ByteBuf &payload,
+                OnDelivered &&onDelivered,
+                const Crt::String &coalesceKey = Crt::String(),
+                const MergePayloads &merge = MergePayloads());
+
+            /**
+             * Starts sending queued publishes on `connection`, which must be connected.
+             */
+            void Drain(const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection);
+
+            /**
+             * Stops sending further publishes. Those already sent still complete.
+             */
+            void Pause();
+
+            size_t GetQueuedCount() const;
+            uint64_t GetQueuedBytes() const;
+
+          private:
+            struct Entry
+            {
+                Crt::String Topic;
+                Crt::Mqtt::QOS Qos;
+                Crt::String Payload;
+                Crt::String CoalesceKey;
+                bool InFlight = false;
+                Crt::Vector<OnDelivered> Handlers;
+            };
+
+            DurablePublishQueue(const char *path, const DurablePublishQueueConfig &config) noexcept;
+
+            bool Load();
+            bool AppendPublish(uint64_t sequence, const Entry &entry);
+            bool AppendRemoval(uint64_t sequence);
+            bool CompactLocked();
+            void CompactIfBloated();
+            void Pump();
+            void OnPublishComplete(uint64_t sequence, int errorCode);
+
+            static uint64_t s_entryBytes(const Entry &entry) noexcept;
+
+            Crt::String m_path;
+            DurablePublishQueueConfig m_config;
+
+            mutable std::mutex m_lock;
+            FILE *m_file;
+            size_t m_recordCount;
+            uint64_t m_nextSequence;
+            uint64_t m_queuedBytes;
+            Crt::Map<uint64_t, Entry> m_entries;
+            Crt::Map<Crt::String, uint64_t> m_coalesced;
+            std::shared_ptr<Crt::Mqtt::MqttConnection> m_connection;
+            size_t m_inFlight;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,62 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <cstddef>
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * One slot of a string enum's perfect-hash table; unused slots have a null Name.
+         */
+        template <typename Enum> struct EnumTableEntry
+        {
+            const char *Name;
+            size_t Length;
+            Enum Value;
+        };
+
+        /**
+         * The slot a name hashes to in a table of `SlotCount` (a power of two) slots. The marshallers pick
+         * `Multiplier` so that every value of the enum lands in its own slot.
+         */
+        template <size_t Multiplier, size_t SlotCount> size_t EnumTableSlot(const char *str, size_t length) noexcept
+        {
+            static_assert((SlotCount & (SlotCount - 1)) == 0, "slot count must be a power of two");
+            size_t hash = length * Multiplier + static_cast<unsigned char>(str[length - 1]) +
+                          static_cast<unsigned char>(str[length / 2]);
+            return hash & (SlotCount - 1);
+        }
+
+        /**
+         * Decodes a string enum value with one hash and one comparison, without allocating.
+         *
+         * @return false if `str` names none of the table's values.
+         */
+        template <size_t Multiplier, typename Enum, size_t SlotCount>
+        bool LookupEnum(const EnumTableEntry<Enum> (&slots)[SlotCount], const char *str, size_t length, Enum &value)
+            noexcept
+        {
+            if (length == 0)
+            {
+                return false;
+            }
+
+            const EnumTableEntry<Enum> &entry = slots[EnumTableSlot<Multiplier, SlotCount>(str, length)];
+            if (entry.Length != length || memcmp(entry.Name, str, length) != 0)
+            {
+                return false;
+            }
+
+            value = entry.Value;
+            return true;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
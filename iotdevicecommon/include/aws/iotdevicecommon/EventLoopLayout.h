@@ -0,0 +1,166 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/io/Bootstrap.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/crt/io/HostResolver.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/HandlerExecutor.h>
+
+#include <memory>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        /**
+         * The kinds of work an EventLoopLayout sets loops aside for.
+         */
+        enum class EventLoopRole
+        {
+            /* MQTT connections, and the service clients' handlers unless they have loops of their own. */
+            Mqtt,
+            /* Secure tunnel websockets and their local proxies. */
+            SecureTunnel,
+            /* Device Defender report tasks, which are light and share loops. */
+            DeviceDefender,
+            /* Service client handlers, run through GetHandlerExecutor off the connections' loops. */
+            Handlers,
+        };
+
+        class AWS_IOTDEVICECOMMON_API EventLoopLayoutConfig final
+        {
+          public:
+            EventLoopLayoutConfig() noexcept;
+            EventLoopLayoutConfig(const EventLoopLayoutConfig &rhs) = default;
+            EventLoopLayoutConfig(EventLoopLayoutConfig &&rhs) = default;
+
+            EventLoopLayoutConfig &operator=(const EventLoopLayoutConfig &rhs) = default;
+            EventLoopLayoutConfig &operator=(EventLoopLayoutConfig &&rhs) = default;
+
+            ~EventLoopLayoutConfig() = default;
+
+            /**
+             * MQTT connections the process keeps open; each gets a loop of its own while cores allow.
+             * Defaults to 1.
+             */
+            uint16_t MqttConnections;
+
+            /**
+             * Secure tunnels open at once; each gets a loop of its own while cores allow. Defaults to 0.
+             */
+            uint16_t SecureTunnels;
+
+            /**
+             * Device Defender report tasks; up to 64 share a loop. Defaults to 0.
+             */
+            uint16_t ReportTasks;
+
+            /**
+             * Loops set aside for service client handlers. Zero, the default, leaves handlers on the
+             * connections' loops.
+             */
+            uint16_t HandlerLoops;
+
+            /**
+             * The most loops created across every role. Roles are cut back, the largest first, to fit, but
+             * keep at least one loop each. Zero, the default, allows one per processor.
+             */
+            uint16_t MaxLoops;
+
+            /**
+             * Whether each loop's thread is pinned to its own core, assigned in order from FirstCore and
+             * wrapping around the processors. Only supported on Linux; elsewhere loops are left unpinned.
+             * Defaults to true.
+             */
+            bool PinToCores;
+
+            /**
+             * The core the first loop is pinned to, e.g. to leave the lower cores to the application.
+             * Defaults to 0.
+             */
+            uint16_t FirstCore;
+        };
+
+        /**
+         * Event loop groups sized from the process's workload, one per role, with each loop pinned to its own
+         * core, so MQTT connections, tunnels and Device Defender reports do not land on, and contend for,
+         * the same loops, and each loop keeps its cache warm on one core.
+         *
+         * Connections and tunnels are placed on a role's loops by creating them with that role's bootstrap;
+         * report tasks and tunnels can further be given one of its loops with
+         * ReportTaskBuilder::WithEventLoop and SecureTunnel::SetEventLoop, and service clients can have their
+         * handlers run on a loop of the Handlers role by setting ServiceClientConfig::HandlerExecutor to
+         * GetHandlerExecutor.
+         */
+        class AWS_IOTDEVICECOMMON_API EventLoopLayout final
+        {
+          public:
+            EventLoopLayout(const EventLoopLayout &) = delete;
+            EventLoopLayout(EventLoopLayout &&) = delete;
+            EventLoopLayout &operator=(const EventLoopLayout &) = delete;
+            EventLoopLayout &operator=(EventLoopLayout &&) = delete;
+
+            ~EventLoopLayout() = default;
+
+            /**
+             * @return how many loops `config` gives `role`, after fitting every role into MaxLoops.
+             */
+            static uint16_t LoopsFor(const EventLoopLayoutConfig &config, EventLoopRole role);
+
+            /**
+             * @return the group of `role`'s loops. A role given no loops shares the Mqtt group.
+             */
+            Crt::Io::EventLoopGroup &GetEventLoopGroup(EventLoopRole role) noexcept;
+
+            /**
+             * @return a bootstrap over `role`'s group, to create the role's connections with.
+             */
+            Crt::Io::ClientBootstrap &GetBootstrap(EventLoopRole role) noexcept;
+
+            /**
+             * @return loop `index` of `role`, wrapping around its loop count, e.g. the loop of the index-th
+             * tunnel.
+             */
+            aws_event_loop *GetLoop(EventLoopRole role, size_t index) noexcept;
+
+            /**
+             * @return an executor that runs every task it is given on loop `index` of the Handlers role, in
+             * order. The layout must outlive its use.
+             */
+            HandlerExecutor GetHandlerExecutor(size_t index) noexcept;
+
+            /**
+             * @return the core loop `index` of `role` is pinned to, or -1 if it is not pinned.
+             */
+            int GetCore(EventLoopRole role, size_t index) const noexcept;
+
+            /**
+             * @return the layout, or null with the error raised if a group or bootstrap could not be created. A
+             * loop that could not be pinned does not fail Create; GetCore reports it unpinned.
+             */
+            static std::shared_ptr<EventLoopLayout> Create(
+                const EventLoopLayoutConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Role;
+            struct HandlerTask;
+
+            explicit EventLoopLayout(Crt::Allocator *allocator) noexcept;
+
+            bool Build(const EventLoopLayoutConfig &config);
+            Role &RoleOf(EventLoopRole role) const noexcept;
+
+            Crt::Allocator *m_allocator;
+            /* Indexed by EventLoopRole; a role without loops has no group of its own. */
+            Crt::Vector<std::shared_ptr<Role>> m_roles;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,130 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/ServiceMetrics.h>
+
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        /**
+         * How busy one event loop of the monitored group is.
+         */
+        struct AWS_IOTDEVICECOMMON_API EventLoopStats
+        {
+            EventLoopStats() noexcept;
+
+            /** The loop's index in its group. */
+            size_t LoopIndex;
+
+            /**
+             * Time the loop spent processing I/O events and tasks over its last complete second, as aws-c-io
+             * reports it for load balancing. The loop was idle for the rest of that second.
+             */
+            uint64_t BusyNsPerSecond;
+
+            /** Service client handlers that ran on this loop, and the time they took. */
+            uint64_t Callbacks;
+            uint64_t CallbackNs;
+
+            /**
+             * How late each probe task ran after it was due. This is the wait a task queued on the loop would
+             * see, and stands in for the loop's queue depth, which aws-c-io does not expose.
+             */
+            LatencyHistogram SchedulingLag;
+            uint64_t LastLagNs;
+            uint64_t MaxLagNs;
+        };
+
+        class AWS_IOTDEVICECOMMON_API EventLoopMonitorConfig final
+        {
+          public:
+            EventLoopMonitorConfig() noexcept;
+            EventLoopMonitorConfig(const EventLoopMonitorConfig &rhs) = default;
+            EventLoopMonitorConfig(EventLoopMonitorConfig &&rhs) = default;
+
+            EventLoopMonitorConfig &operator=(const EventLoopMonitorConfig &rhs) = default;
+            EventLoopMonitorConfig &operator=(EventLoopMonitorConfig &&rhs) = default;
+
+            ~EventLoopMonitorConfig() = default;
+
+            /**
+             * The group whose loops are monitored. Must outlive the monitor.
+             * Required.
+             */
+            Crt::Io::EventLoopGroup *EventLoopGroup;
+
+            /**
+             * How often each loop is probed for its load and scheduling lag. Defaults to 1000.
+             */
+            uint32_t SampleIntervalMs;
+        };
+
+        /**
+         * Per-loop utilization of an event loop group: busy time, scheduling lag and the service client
+         * handlers each loop ran. Use it to decide when to grow the group, or to move handler work off the
+         * loops with a HandlerExecutor.
+         *
+         * Each loop runs a small probe task every SampleIntervalMs. Service clients given the monitor in
+         * ServiceClientConfig::EventLoopMonitor report each handler they run; handlers that ran on an
+         * executor thread rather than a loop are counted separately.
+         */
+        class AWS_IOTDEVICECOMMON_API EventLoopMonitor final : public std::enable_shared_from_this<EventLoopMonitor>
+        {
+          public:
+            EventLoopMonitor(const EventLoopMonitor &) = delete;
+            EventLoopMonitor(EventLoopMonitor &&) = delete;
+            EventLoopMonitor &operator=(const EventLoopMonitor &) = delete;
+            EventLoopMonitor &operator=(EventLoopMonitor &&) = delete;
+
+            ~EventLoopMonitor() = default;
+
+            /**
+             * Records a handler that took `durationNs` against the loop it ran on, which must be the calling
+             * thread.
+             */
+            void RecordCallback(uint64_t durationNs);
+
+            /**
+             * @return each loop's stats, in group order.
+             */
+            Crt::Vector<EventLoopStats> GetSnapshot() const;
+
+            /**
+             * @return the number of handlers recorded that ran outside the group's loops.
+             */
+            uint64_t GetOffLoopCallbackCount() const;
+
+            static std::shared_ptr<EventLoopMonitor> Create(
+                const EventLoopMonitorConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            /* One loop's recurring probe, defined with the implementation. */
+            struct ProbeTask;
+
+            EventLoopMonitor(const EventLoopMonitorConfig &config, Crt::Allocator *allocator) noexcept;
+
+            void Schedule(ProbeTask *probe);
+            void OnProbe(ProbeTask *probe, uint64_t nowNs);
+
+            EventLoopMonitorConfig m_config;
+            Crt::Allocator *m_allocator;
+            Crt::Vector<aws_event_loop *> m_loops;
+
+            mutable std::mutex m_lock;
+            Crt::Vector<EventLoopStats> m_stats;
+            uint64_t m_offLoopCallbacks;
+        };
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,112 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/StlAllocator.h>
+#include <aws/crt/Types.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * A string-to-string map kept as one sorted vector, for the handful of short members a job's status
+         * details usually hold. Lookups and inserts are a binary search over contiguous storage, and short keys
+         * and values stay in the strings' inline buffers, so a map of a few entries costs one allocation where
+         * Crt::Map costs a node per entry.
+         *
+         * The interface follows Crt::Map closely enough for existing callers, and converts from one implicitly.
+         * Iteration is ordered by key. Modifying a key through an iterator breaks that order; erase and
+         * re-insert instead.
+         */
+        class FlatStringMap final
+        {
+          public:
+            using value_type = std::pair<Crt::String, Crt::String>;
+            using iterator = Crt::Vector<value_type>::iterator;
+            using const_iterator = Crt::Vector<value_type>::const_iterator;
+            using size_type = size_t;
+
+            FlatStringMap() = default;
+            FlatStringMap(const Crt::Map<Crt::String, Crt::String> &map) : m_entries(map.begin(), map.end()) {}
+
+            iterator begin() noexcept { return m_entries.begin(); }
+            iterator end() noexcept { return m_entries.end(); }
+            const_iterator begin() const noexcept { return m_entries.begin(); }
+            const_iterator end() const noexcept { return m_entries.end(); }
+
+            size_type size() const noexcept { return m_entries.size(); }
+            bool empty() const noexcept { return m_entries.empty(); }
+            void clear() noexcept { m_entries.clear(); }
+            void reserve(size_type count) { m_entries.reserve(count); }
+
+            iterator find(const Crt::String &key)
+            {
+                iterator entry = LowerBound(key);
+                return entry != m_entries.end() && entry->first == key ? entry : m_entries.end();
+            }
+            const_iterator find(const Crt::String &key) const
+            {
+                return const_cast<FlatStringMap *>(this)->find(key);
+            }
+
+            size_type count(const Crt::String &key) const { return find(key) != end() ? 1 : 0; }
+
+            /**
+             * Inserts (key, value) unless the key is already present.
+             *
+             * @return the entry for the key, and whether it was inserted.
+             */
+            template <typename Key, typename Value> std::pair<iterator, bool> emplace(Key &&key, Value &&value)
+            {
+                Crt::String keyString(std::forward<Key>(key));
+                iterator entry = LowerBound(keyString);
+                if (entry != m_entries.end() && entry->first == keyString)
+                {
+                    return std::make_pair(entry, false);
+                }
+                entry = m_entries.emplace(entry, std::move(keyString), Crt::String(std::forward<Value>(value)));
+                return std::make_pair(entry, true);
+            }
+
+            Crt::String &operator[](const Crt::String &key) { return emplace(key, Crt::String()).first->second; }
+
+            size_type erase(const Crt::String &key)
+            {
+                iterator entry = find(key);
+                if (entry == m_entries.end())
+                {
+                    return 0;
+                }
+                m_entries.erase(entry);
+                return 1;
+            }
+
+            Crt::Map<Crt::String, Crt::String> ToMap() const
+            {
+                return Crt::Map<Crt::String, Crt::String>(m_entries.begin(), m_entries.end());
+            }
+
+            bool operator==(const FlatStringMap &other) const { return m_entries == other.m_entries; }
+            bool operator!=(const FlatStringMap &other) const { return m_entries != other.m_entries; }
+
+          private:
+            iterator LowerBound(const Crt::String &key)
+            {
+                return std::lower_bound(
+                    m_entries.begin(), m_entries.end(), key, [](const value_type &entry, const Crt::String &probe) {
+                        return entry.first < probe;
+                    });
+            }
+
+            Crt::Vector<value_type> m_entries;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
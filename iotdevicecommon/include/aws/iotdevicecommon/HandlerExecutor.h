@@ -0,0 +1,341 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/clock.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/EventLoopMonitor.h>
+#include <aws/iotdevicecommon/HandlerWatchdog.h>
+#include <aws/iotdevicecommon/HotStandby.h>
+#include <aws/iotdevicecommon/MemoryBudget.h>
+#include <aws/iotdevicecommon/MessageContext.h>
+#include <aws/iotdevicecommon/PayloadBufferPool.h>
+#include <aws/iotdevicecommon/RequestTracer.h>
+#include <aws/iotdevicecommon/ServiceMetrics.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Runs a unit of work on a thread of the caller's choosing, e.g. by queueing it to a thread pool or
+         * scheduling it on a dedicated event loop. The executor must eventually run every task it accepts.
+         *
+         * `orderingKey` names the thing a message belongs to (see OrderingKeyForTopic). Executors that run tasks
+         * in parallel should run tasks with equal keys one at a time, in submission order, as
+         * WorkStealingExecutor does.
+         */
+        using HandlerExecutor = std::function<void(const Crt::String &orderingKey, std::function<void()> &&task)>;
+
+        /**
+         * @return the thing name of a "$aws/things/<thing>/..." topic, the template name of a
+         * "$aws/provisioning-templates/<template>/..." topic, or the whole topic for anything else.
+         */
+        AWS_IOTDEVICECOMMON_API Crt::String OrderingKeyForTopic(const Crt::String &topic);
+
+        /**
+         * Runs a publish handler inside a MessageTopicScope for the message's topic.
+         */
+        template <typename HandlerType> struct TopicScopedHandler
+        {
+            void operator()(
+                Crt::Mqtt::MqttConnection &connection,
+                const Crt::String &topic,
+                const Crt::ByteBuf &payload)
+            {
+                MessageTopicScope scope(topic);
+                handler(connection, topic, payload);
+            }
+
+            HandlerType handler;
+        };
+
+        /**
+         * Idle copies of a publish handler, so that tasks running concurrently on an executor each get their
+         * own while parse scratch storage is still recycled between messages.
+         */
+        template <typename HandlerType> struct HandlerCopies
+        {
+            explicit HandlerCopies(HandlerType &&handler) : prototype(std::move(handler)) {}
+
+            std::unique_ptr<HandlerType> Take()
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (idle.empty())
+                {
+                    return std::unique_ptr<HandlerType>(new HandlerType(prototype));
+                }
+                std::unique_ptr<HandlerType> handler = std::move(idle.back());
+                idle.pop_back();
+                return handler;
+            }
+
+            void Return(std::unique_ptr<HandlerType> &&handler)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                idle.push_back(std::move(handler));
+            }
+
+            void HandleInline(
+                Crt::Mqtt::MqttConnection &connection,
+                const Crt::String &topic,
+                const Crt::ByteBuf &payload)
+            {
+                MessageTopicScope scope(topic);
+                auto handler = Take();
+                (*handler)(connection, topic, payload);
+                Return(std::move(handler));
+            }
+
+            /**
+             * Copies the payload into a buffer from `pool` and runs a copy of the handler on it from `executor`,
+             * unless `budget` is set and its inbound queue is full.
+             */
+            static void Dispatch(
+                const std::shared_ptr<HandlerCopies> &copies,
+                const HandlerExecutor &executor,
+                const std::shared_ptr<PayloadBufferPool> &pool,
+                MemoryBudget *budget,
+                Crt::Mqtt::MqttConnection &connection,
+                const Crt::String &topic,
+                const Crt::ByteBuf &payload)
+            {
+                MemoryBudget::Slot queuedSlot;
+                if (budget)
+                {
+                    bool handleInline = false;
+                    queuedSlot = budget->AcquireInbound(handleInline);
+                    if (!queuedSlot)
+                    {
+                        if (handleInline)
+                        {
+                            copies->HandleInline(connection, topic, payload);
+                        }
+                        return;
+                    }
+                }
+
+                auto payloadCopy = std::make_shared<Crt::ByteBuf>(pool->NewCopy(Crt::ByteCursorFromByteBuf(payload)));
+                if (!payloadCopy->buffer && payload.len)
+                {
+                    /* Out of memory: handle inline rather than drop the message. */
+                    copies->HandleInline(connection, topic, payload);
+                    return;
+                }
+
+                std::shared_ptr<HandlerCopies> taskCopies(copies);
+                std::shared_ptr<PayloadBufferPool> payloadPool(pool);
+                Crt::Mqtt::MqttConnection *connectionPtr = &connection;
+                Crt::String topicCopy(topic);
+                executor(
+                    OrderingKeyForTopic(topic),
+                    [taskCopies, payloadPool, payloadCopy, connectionPtr, topicCopy, queuedSlot]() mutable {
+                        auto handler = taskCopies->Take();
+                        {
+                            MessageTopicScope scope(topicCopy);
+                            (*handler)(*connectionPtr, topicCopy, *payloadCopy);
+                        }
+                        taskCopies->Return(std::move(handler));
+                        payloadPool->Release(*payloadCopy);
+                        queuedSlot.reset();
+                    });
+            }
+
+            std::mutex lock;
+            HandlerType prototype;
+            Crt::Vector<std::unique_ptr<HandlerType>> idle;
+        };
+
+        /**
+         * Wraps a service client's MQTT publish handler so that payload parsing and the user handler run on
+         * `executor` instead of the connection's event loop. The network thread only copies the topic and the
+         * payload (into a buffer drawn from `pool`) and hands the task over, keyed by OrderingKeyForTopic.
+         *
+         * Concurrent tasks each use their own copy of `onPublish`; copies are kept for reuse, so a handler's
+         * parse scratch storage is still recycled between messages. The connection must outlive tasks still
+         * queued on the executor.
+         *
+         * Either way the handler runs inside a MessageTopicScope, so it can ask CurrentThingName() which thing
+         * the message is for. An empty executor handles messages inline as before.
+         */
+        template <typename Handler>
+        Crt::Mqtt::OnMessageReceivedHandler OffloadPublishHandler(
+            Handler &&onPublish,
+            const HandlerExecutor &executor,
+            const std::shared_ptr<PayloadBufferPool> &pool)
+        {
+            using HandlerType = typename std::decay<Handler>::type;
+
+            if (!executor)
+            {
+                return Crt::Mqtt::OnMessageReceivedHandler(
+                    TopicScopedHandler<HandlerType>{HandlerType(std::forward<Handler>(onPublish))});
+            }
+
+            auto copies = std::make_shared<HandlerCopies<HandlerType>>(HandlerType(std::forward<Handler>(onPublish)));
+            HandlerExecutor taskExecutor(executor);
+            std::shared_ptr<PayloadBufferPool> payloadPool(pool);
+            return [copies, taskExecutor, payloadPool](
+                       Crt::Mqtt::MqttConnection &connection,
+                       const Crt::String &topic,
+                       const Crt::ByteBuf &payload) {
+                HandlerCopies<HandlerType>::Dispatch(
+                    copies, taskExecutor, payloadPool, nullptr, connection, topic, payload);
+            };
+        }
+
+        /**
+         * What a service client's publish handlers run with. A client builds one from its ServiceClientConfig
+         * and every subscription it makes shares it, so a subscription holds one pointer to it rather than its
+         * own copies of the executor and of each of the shared components.
+         */
+        struct HandlerContext
+        {
+            HandlerExecutor Executor;
+            std::shared_ptr<PayloadBufferPool> Pool;
+            /** The remaining members may be null. */
+            std::shared_ptr<ServiceMetrics> Metrics;
+            std::shared_ptr<RequestTracer> Tracer;
+            std::shared_ptr<HandlerWatchdog> Watchdog;
+            std::shared_ptr<EventLoopMonitor> LoopMonitor;
+            /** Bounds the messages queued on the executor. */
+            std::shared_ptr<MemoryBudget> Budget;
+            /** The pair every subscription is made on both connections of. */
+            std::shared_ptr<HotStandby> Standby;
+        };
+
+        /**
+         * Runs a publish handler inside a MessageTopicScope, timing, tracing and watching it as its context
+         * asks.
+         */
+        template <typename HandlerType> struct ContextScopedHandler
+        {
+            void operator()(
+                Crt::Mqtt::MqttConnection &connection,
+                const Crt::String &topic,
+                const Crt::ByteBuf &payload)
+            {
+                MessageTopicScope scope(topic);
+                if (!context->Metrics && !context->Tracer && !context->Watchdog && !context->LoopMonitor)
+                {
+                    handler(connection, topic, payload);
+                    return;
+                }
+
+                bool timed = context->Watchdog || context->LoopMonitor;
+                uint64_t startNs = 0;
+                if (timed)
+                {
+                    aws_high_res_clock_get_ticks(&startNs);
+                }
+
+                {
+                    RequestTracer::ResponseScope trace(context->Tracer.get(), topic, payload);
+                    if (context->Metrics)
+                    {
+                        ServiceMetrics::HandlerScope handlerScope(*context->Metrics, topic, payload.len);
+                        handler(connection, topic, payload);
+                    }
+                    else
+                    {
+                        handler(connection, topic, payload);
+                    }
+                }
+
+                if (timed)
+                {
+                    uint64_t endNs = 0;
+                    aws_high_res_clock_get_ticks(&endNs);
+                    if (context->Watchdog)
+                    {
+                        context->Watchdog->Check(topic, endNs - startNs);
+                    }
+                    if (context->LoopMonitor)
+                    {
+                        context->LoopMonitor->RecordCallback(endNs - startNs);
+                    }
+                }
+            }
+
+            HandlerType handler;
+            std::shared_ptr<const HandlerContext> context;
+        };
+
+        /**
+         * As above, additionally timing the handler and its payload parsing into the context's metrics, tracing
+         * it as the response to a request pending in its tracer, and reporting it to its watchdog if it is slow,
+         * on the thread the handler runs on.
+         *
+         * The returned handler holds `onPublish` and one reference to `context`, or with an executor one
+         * reference to a block holding both.
+         */
+        template <typename Handler>
+        Crt::Mqtt::OnMessageReceivedHandler OffloadPublishHandler(
+            Handler &&onPublish,
+            const std::shared_ptr<const HandlerContext> &context)
+        {
+            using HandlerType = ContextScopedHandler<typename std::decay<Handler>::type>;
+
+            HandlerType scoped{typename std::decay<Handler>::type(std::forward<Handler>(onPublish)), context};
+            if (!context->Executor)
+            {
+                return Crt::Mqtt::OnMessageReceivedHandler(std::move(scoped));
+            }
+
+            /* The inner scope is redundant with the one Dispatch opens, and harmless. */
+            auto copies = std::make_shared<HandlerCopies<HandlerType>>(std::move(scoped));
+            return [copies](
+                       Crt::Mqtt::MqttConnection &connection,
+                       const Crt::String &topic,
+                       const Crt::ByteBuf &payload) {
+                const HandlerContext &handlerContext = *copies->prototype.context;
+                HandlerCopies<HandlerType>::Dispatch(
+                    copies,
+                    handlerContext.Executor,
+                    handlerContext.Pool,
+                    handlerContext.Budget.get(),
+                    connection,
+                    topic,
+                    payload);
+            };
+        }
+
+        /**
+         * As OffloadPublishHandler(onPublish, executor, pool), additionally instrumented as the HandlerContext
+         * overload is. Any of `metrics`, `tracer` and `watchdog` may be null; with all of them null this adds
+         * nothing.
+         */
+        template <typename Handler>
+        Crt::Mqtt::OnMessageReceivedHandler OffloadPublishHandler(
+            Handler &&onPublish,
+            const HandlerExecutor &executor,
+            const std::shared_ptr<PayloadBufferPool> &pool,
+            const std::shared_ptr<ServiceMetrics> &metrics,
+            const std::shared_ptr<RequestTracer> &tracer,
+            const std::shared_ptr<HandlerWatchdog> &watchdog)
+        {
+            if (!metrics && !tracer && !watchdog)
+            {
+                return OffloadPublishHandler(std::forward<Handler>(onPublish), executor, pool);
+            }
+
+            auto context = std::make_shared<HandlerContext>();
+            context->Executor = executor;
+            context->Pool = pool;
+            context->Metrics = metrics;
+            context->Tracer = tracer;
+            context->Watchdog = watchdog;
+            return OffloadPublishHandler(
+                std::forward<Handler>(onPublish), std::shared_ptr<const HandlerContext>(std::move(context)));
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,71 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <atomic>
+#include <functional>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Invoked, on the thread that ran the handler, after a subscription handler took longer than the
+         * watchdog's threshold. `thingName` is the thing the topic belongs to, or the whole topic for topics
+         * outside "$aws/things/" (see OrderingKeyForTopic).
+         */
+        using OnSlowHandler =
+            std::function<void(const Crt::String &topic, const Crt::String &thingName, uint64_t durationNs)>;
+
+        /**
+         * Times every subscription handler the service clients run and reports those slower than a threshold.
+         * Handlers run on the connection's event loop unless a HandlerExecutor is configured, so a slow one
+         * stalls all I/O on that connection, and this is how to find which.
+         *
+         * Handlers are reported once they return; one that never returns is not reported.
+         */
+        class AWS_IOTDEVICECOMMON_API HandlerWatchdog final
+        {
+          public:
+            /**
+             * @param thresholdNs handlers taking longer than this are reported.
+             * @param onSlowHandler optional; without it slow handlers are only counted.
+             */
+            HandlerWatchdog(uint64_t thresholdNs, OnSlowHandler &&onSlowHandler) noexcept;
+            HandlerWatchdog(const HandlerWatchdog &) = delete;
+            HandlerWatchdog(HandlerWatchdog &&) = delete;
+            HandlerWatchdog &operator=(const HandlerWatchdog &) = delete;
+            HandlerWatchdog &operator=(HandlerWatchdog &&) = delete;
+
+            /**
+             * Records a handler invocation on `topic` that took `durationNs`.
+             */
+            void Check(const Crt::String &topic, uint64_t durationNs);
+
+            uint64_t GetThresholdNs() const noexcept { return m_thresholdNs; }
+
+            /**
+             * @return the number of handlers reported as slow so far.
+             */
+            uint64_t GetSlowHandlerCount() const noexcept { return m_slowHandlerCount.load(); }
+
+            /**
+             * @return the longest handler invocation seen so far, slow or not.
+             */
+            uint64_t GetMaxDurationNs() const noexcept { return m_maxDurationNs.load(); }
+
+          private:
+            uint64_t m_thresholdNs;
+            OnSlowHandler m_onSlowHandler;
+            std::atomic<uint64_t> m_slowHandlerCount;
+            std::atomic<uint64_t> m_maxDurationNs;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,136 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        /**
+         * Invoked when service traffic moves over to `active`, after the other connection dropped with
+         * `errorCode`.
+         */
+        using OnFailover = std::function<void(Crt::Mqtt::MqttConnection &active, int errorCode)>;
+
+        class AWS_IOTDEVICECOMMON_API HotStandbyConfig final
+        {
+          public:
+            HotStandbyConfig() noexcept;
+            HotStandbyConfig(const HotStandbyConfig &rhs) = default;
+            HotStandbyConfig(HotStandbyConfig &&rhs) = default;
+
+            HotStandbyConfig &operator=(const HotStandbyConfig &rhs) = default;
+            HotStandbyConfig &operator=(HotStandbyConfig &&rhs) = default;
+
+            ~HotStandbyConfig() = default;
+
+            /**
+             * The connection the service clients are created on, and active first. Required.
+             */
+            std::shared_ptr<Crt::Mqtt::MqttConnection> Primary;
+
+            /**
+             * A second connection to the same endpoint, with its own client id, kept connected alongside the
+             * primary. Required.
+             */
+            std::shared_ptr<Crt::Mqtt::MqttConnection> Standby;
+
+            /**
+             * Invoked on each failover. Optional.
+             */
+            Iotdevicecommon::OnFailover OnFailover;
+        };
+
+        /**
+         * A pair of connections of which one carries the service clients' traffic at a time. Every
+         * subscription a service client makes is made on both, so the standby is subscribed already when the
+         * active connection drops: the clients publish through the standby from then on, without waiting for
+         * a reconnect or a resubscribe. Messages arriving on the inactive connection, including the service's
+         * second copy of every response while both are subscribed, are dropped.
+         *
+         * The active connection stays active until it drops; the other one takes over then if it is up, or
+         * else whichever comes back first. Set a ServiceClientConfig's HotStandby to the pair and create the
+         * clients on the primary.
+         *
+         * Create chains into the connections' OnConnectionCompleted, OnConnectionInterrupted,
+         * OnConnectionResumed and OnDisconnect handlers, so set those before, and connect both connections
+         * before, creating the pair.
+         */
+        class AWS_IOTDEVICECOMMON_API HotStandby final : public std::enable_shared_from_this<HotStandby>
+        {
+          public:
+            HotStandby(const HotStandby &) = delete;
+            HotStandby(HotStandby &&) = delete;
+            HotStandby &operator=(const HotStandby &) = delete;
+            HotStandby &operator=(HotStandby &&) = delete;
+
+            ~HotStandby() = default;
+
+            /**
+             * @return the connection carrying the service clients' traffic.
+             */
+            std::shared_ptr<Crt::Mqtt::MqttConnection> GetActive() const noexcept;
+
+            /**
+             * @return whether `connection` is the active one; the clients' publish handlers ask this for each
+             * message.
+             */
+            bool IsActive(const Crt::Mqtt::MqttConnection &connection) const noexcept;
+
+            /**
+             * @return the other connection of the pair, or null if `connection` is not one of it.
+             */
+            std::shared_ptr<Crt::Mqtt::MqttConnection> GetPeer(
+                const Crt::Mqtt::MqttConnection &connection) const noexcept;
+
+            /**
+             * @return how many times traffic moved from one connection to the other.
+             */
+            uint64_t GetFailoverCount() const noexcept;
+
+            /**
+             * @return the pair, or null with AWS_ERROR_INVALID_ARGUMENT raised if either connection is missing
+             * or both are the same.
+             */
+            static std::shared_ptr<HotStandby> Create(
+                const HotStandbyConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            explicit HotStandby(const HotStandbyConfig &config) noexcept;
+
+            void Chain(size_t index);
+            void OnUp(size_t index);
+            void OnDown(size_t index, int errorCode);
+
+            std::shared_ptr<Crt::Mqtt::MqttConnection> m_connections[2];
+            OnFailover m_onFailover;
+
+            /* Read by every message and publish without the lock; changed under it. */
+            std::atomic<size_t> m_active;
+            std::atomic<uint64_t> m_failoverCount;
+
+            std::mutex m_lock;
+            bool m_up[2];
+        };
+
+        /**
+         * @return the connection a service client created on `connection` publishes through: the active one of
+         * `standby` if `connection` belongs to it, else `connection`.
+         */
+        AWS_IOTDEVICECOMMON_API std::shared_ptr<Crt::Mqtt::MqttConnection> ActiveConnection(
+            const std::shared_ptr<HotStandby> &standby,
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection) noexcept;
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,205 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/StlAllocator.h>
+#include <aws/crt/Types.h>
+
+#include <utility>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * A hash map from 64-bit keys, such as a ThingRegistry NameId or ThingRegistry::PairKey, to `Value`,
+         * kept in one open-addressed array. A lookup hashes an integer and probes neighbouring slots, with no
+         * string compare and no node per entry as Crt::Map has.
+         *
+         * `Value` must be default-constructible and movable. Pointers returned by Find and GetOrAdd stay valid
+         * only until the next GetOrAdd or Erase. Not thread-safe; callers guard it with their own lock.
+         */
+        template <typename Value> class IdHashMap final
+        {
+          public:
+            explicit IdHashMap(Crt::Allocator *allocator = Crt::DefaultAllocator())
+                : m_slots(Crt::StlAllocator<Slot>(allocator)), m_count(0)
+            {
+            }
+
+            IdHashMap(const IdHashMap &) = default;
+            IdHashMap(IdHashMap &&) = default;
+            IdHashMap &operator=(const IdHashMap &) = default;
+            IdHashMap &operator=(IdHashMap &&) = default;
+            ~IdHashMap() = default;
+
+            /**
+             * @return the value for `key`, or nullptr if there is none.
+             */
+            Value *Find(uint64_t key) noexcept
+            {
+                size_t slot = 0;
+                return Locate(key, slot) ? &m_slots[slot].Entry : nullptr;
+            }
+            const Value *Find(uint64_t key) const noexcept { return const_cast<IdHashMap *>(this)->Find(key); }
+
+            /**
+             * @return the value for `key`, default-constructing it first if there is none.
+             */
+            Value &GetOrAdd(uint64_t key)
+            {
+                size_t slot = 0;
+                if (Locate(key, slot))
+                {
+                    return m_slots[slot].Entry;
+                }
+
+                /* Kept at most three quarters full so probe runs stay short. */
+                if ((m_count + 1) * 4 > m_slots.size() * 3)
+                {
+                    Rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+                    Locate(key, slot);
+                }
+
+                m_slots[slot].Key = key;
+                m_slots[slot].Used = true;
+                ++m_count;
+                return m_slots[slot].Entry;
+            }
+
+            /**
+             * Removes the value for `key`, if any.
+             *
+             * @return whether there was one.
+             */
+            bool Erase(uint64_t key)
+            {
+                size_t hole = 0;
+                if (!Locate(key, hole))
+                {
+                    return false;
+                }
+
+                /* Backward-shift deletion: pull later members of the probe run into the hole, so no tombstones. */
+                const size_t mask = m_slots.size() - 1;
+                for (size_t next = (hole + 1) & mask; m_slots[next].Used; next = (next + 1) & mask)
+                {
+                    const size_t home = Hash(m_slots[next].Key) & mask;
+                    /* The entry at `next` may move back only if its home is not between the hole and it. */
+                    if (((next - home) & mask) >= ((next - hole) & mask))
+                    {
+                        m_slots[hole].Key = m_slots[next].Key;
+                        m_slots[hole].Entry = std::move(m_slots[next].Entry);
+                        hole = next;
+                    }
+                }
+
+                m_slots[hole].Used = false;
+                m_slots[hole].Entry = Value();
+                --m_count;
+                return true;
+            }
+
+            /**
+             * Calls `visitor(key, value)` for every entry, in no particular order. `visitor` must not add or
+             * erase entries.
+             */
+            template <typename Visitor> void ForEach(Visitor &&visitor)
+            {
+                for (Slot &slot : m_slots)
+                {
+                    if (slot.Used)
+                    {
+                        visitor(slot.Key, slot.Entry);
+                    }
+                }
+            }
+
+            size_t GetSize() const noexcept { return m_count; }
+            bool IsEmpty() const noexcept { return m_count == 0; }
+
+            /**
+             * Removes every entry and releases the slots.
+             */
+            void Clear()
+            {
+                Crt::Vector<Slot> empty(m_slots.get_allocator());
+                m_slots.swap(empty);
+                m_count = 0;
+            }
+
+            void Swap(IdHashMap &other) noexcept
+            {
+                m_slots.swap(other.m_slots);
+                std::swap(m_count, other.m_count);
+            }
+
+          private:
+            struct Slot
+            {
+                uint64_t Key = 0;
+                bool Used = false;
+                Value Entry;
+            };
+
+            static size_t Hash(uint64_t key) noexcept
+            {
+                /* The splitmix64 finalizer: ids are small and sequential, so their low bits need mixing. */
+                key ^= key >> 30;
+                key *= 0xbf58476d1ce4e5b9ULL;
+                key ^= key >> 27;
+                key *= 0x94d049bb133111ebULL;
+                key ^= key >> 31;
+                return static_cast<size_t>(key);
+            }
+
+            /* Sets `slot` to the key's slot and returns true, or to the empty slot it would go in. */
+            bool Locate(uint64_t key, size_t &slot) const noexcept
+            {
+                if (m_slots.empty())
+                {
+                    return false;
+                }
+
+                const size_t mask = m_slots.size() - 1;
+                for (slot = Hash(key) & mask; m_slots[slot].Used; slot = (slot + 1) & mask)
+                {
+                    if (m_slots[slot].Key == key)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void Rehash(size_t slotCount)
+            {
+                Crt::Vector<Slot> slots(slotCount, Slot(), m_slots.get_allocator());
+                slots.swap(m_slots);
+
+                const size_t mask = slotCount - 1;
+                for (Slot &old : slots)
+                {
+                    if (old.Used)
+                    {
+                        size_t slot = Hash(old.Key) & mask;
+                        while (m_slots[slot].Used)
+                        {
+                            slot = (slot + 1) & mask;
+                        }
+                        m_slots[slot].Key = old.Key;
+                        m_slots[slot].Used = true;
+                        m_slots[slot].Entry = std::move(old.Entry);
+                    }
+                }
+            }
+
+            Crt::Vector<Slot> m_slots;
+            size_t m_count;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,257 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        template <typename Signature, size_t InlineBytes = 48> class InlineFunction;
+
+        /**
+         * A drop-in for std::function holding callables of up to `InlineBytes` in place. std::function only
+         * keeps a pointer or two inline, so a callback capturing a shared_ptr and a buffer, or wrapping another
+         * std::function, costs an allocation on every copy; the completion callbacks the clients copy into
+         * each publish stay clear of the heap here. Larger callables, and ones that may throw when moved, are
+         * held on the heap as std::function would.
+         *
+         * Stored callables must be copyable, as with std::function. Calling an empty function is a fatal
+         * assert rather than a std::bad_function_call, since the SDK does not rely on exceptions: test
+         * optional callbacks with operator bool before calling them.
+         */
+        template <typename R, typename... Args, size_t InlineBytes>
+        class InlineFunction<R(Args...), InlineBytes> final
+        {
+            template <typename F> using Callable = typename std::decay<F>::type;
+
+            /* What calling F with Args returns; std::result_of is gone from C++20. */
+            template <typename F>
+            using ResultOf = decltype(std::declval<Callable<F> &>()(std::declval<Args>()...));
+
+            template <typename F>
+            using EnableIfCallable = typename std::enable_if<
+                !std::is_same<Callable<F>, InlineFunction>::value &&
+                !std::is_same<Callable<F>, std::nullptr_t>::value &&
+                (std::is_void<R>::value || std::is_convertible<ResultOf<F>, R>::value)>::type;
+
+          public:
+            InlineFunction() noexcept : m_ops(nullptr) {}
+            InlineFunction(std::nullptr_t) noexcept : m_ops(nullptr) {}
+
+            template <typename F, typename = EnableIfCallable<F>> InlineFunction(F &&function) : m_ops(nullptr)
+            {
+                if (!s_isEmpty(function))
+                {
+                    Emplace<Callable<F>>(std::forward<F>(function));
+                }
+            }
+
+            InlineFunction(const InlineFunction &other) : m_ops(other.m_ops)
+            {
+                if (m_ops)
+                {
+                    m_ops->Copy(&other.m_storage, &m_storage);
+                }
+            }
+
+            InlineFunction(InlineFunction &&other) noexcept : m_ops(other.m_ops)
+            {
+                if (m_ops)
+                {
+                    m_ops->Move(&other.m_storage, &m_storage);
+                    other.m_ops = nullptr;
+                }
+            }
+
+            ~InlineFunction() { Reset(); }
+
+            InlineFunction &operator=(const InlineFunction &other)
+            {
+                if (this != &other)
+                {
+                    InlineFunction copy(other);
+                    *this = std::move(copy);
+                }
+                return *this;
+            }
+
+            InlineFunction &operator=(InlineFunction &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    Reset();
+                    m_ops = other.m_ops;
+                    if (m_ops)
+                    {
+                        m_ops->Move(&other.m_storage, &m_storage);
+                        other.m_ops = nullptr;
+                    }
+                }
+                return *this;
+            }
+
+            InlineFunction &operator=(std::nullptr_t) noexcept
+            {
+                Reset();
+                return *this;
+            }
+
+            template <typename F, typename = EnableIfCallable<F>> InlineFunction &operator=(F &&function)
+            {
+                return *this = InlineFunction(std::forward<F>(function));
+            }
+
+            explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+            R operator()(Args... args) const
+            {
+                AWS_FATAL_ASSERT(m_ops != nullptr);
+                return m_ops->Invoke(const_cast<Storage *>(&m_storage), std::forward<Args>(args)...);
+            }
+
+            friend bool operator==(const InlineFunction &function, std::nullptr_t) noexcept { return !function; }
+            friend bool operator==(std::nullptr_t, const InlineFunction &function) noexcept { return !function; }
+            friend bool operator!=(const InlineFunction &function, std::nullptr_t) noexcept
+            {
+                return static_cast<bool>(function);
+            }
+            friend bool operator!=(std::nullptr_t, const InlineFunction &function) noexcept
+            {
+                return static_cast<bool>(function);
+            }
+
+          private:
+            using Storage = typename std::aligned_storage<InlineBytes, alignof(std::max_align_t)>::type;
+
+            struct Ops
+            {
+                R (*Invoke)(Storage *storage, Args &&...args);
+                void (*Copy)(const Storage *from, Storage *to);
+                void (*Move)(Storage *from, Storage *to) noexcept;
+                void (*Destroy)(Storage *storage) noexcept;
+            };
+
+            template <typename F> struct InlineOps
+            {
+                static F *Target(Storage *storage) noexcept { return reinterpret_cast<F *>(storage); }
+                static R Invoke(Storage *storage, Args &&...args)
+                {
+                    return (*Target(storage))(std::forward<Args>(args)...);
+                }
+                static void Copy(const Storage *from, Storage *to)
+                {
+                    new (to) F(*Target(const_cast<Storage *>(from)));
+                }
+                static void Move(Storage *from, Storage *to) noexcept
+                {
+                    new (to) F(std::move(*Target(from)));
+                    Target(from)->~F();
+                }
+                static void Destroy(Storage *storage) noexcept { Target(storage)->~F(); }
+
+                static const Ops Table;
+            };
+
+            template <typename F> struct HeapOps
+            {
+                static F *&Target(Storage *storage) noexcept { return *reinterpret_cast<F **>(storage); }
+                static R Invoke(Storage *storage, Args &&...args)
+                {
+                    return (*Target(storage))(std::forward<Args>(args)...);
+                }
+                static void Copy(const Storage *from, Storage *to)
+                {
+                    F *target = Crt::New<F>(Crt::DefaultAllocator(), *Target(const_cast<Storage *>(from)));
+                    AWS_FATAL_ASSERT(target != nullptr);
+                    new (to) F *(target);
+                }
+                static void Move(Storage *from, Storage *to) noexcept { new (to) F *(Target(from)); }
+                static void Destroy(Storage *storage) noexcept
+                {
+                    Crt::Delete(Target(storage), Crt::DefaultAllocator());
+                }
+
+                static const Ops Table;
+            };
+
+            template <typename F>
+            using FitsInline = std::integral_constant<
+                bool,
+                sizeof(F) <= sizeof(Storage) && alignof(std::max_align_t) % alignof(F) == 0 &&
+                    std::is_nothrow_move_constructible<F>::value>;
+
+            template <typename F, typename G> void Emplace(G &&function)
+            {
+                Emplace<F>(std::forward<G>(function), FitsInline<F>());
+            }
+
+            template <typename F, typename G> void Emplace(G &&function, std::true_type)
+            {
+                new (&m_storage) F(std::forward<G>(function));
+                m_ops = &InlineOps<F>::Table;
+            }
+
+            template <typename F, typename G> void Emplace(G &&function, std::false_type)
+            {
+                F *target = Crt::New<F>(Crt::DefaultAllocator(), std::forward<G>(function));
+                AWS_FATAL_ASSERT(target != nullptr);
+                new (&m_storage) F *(target);
+                m_ops = &HeapOps<F>::Table;
+            }
+
+            void Reset() noexcept
+            {
+                if (m_ops)
+                {
+                    m_ops->Destroy(&m_storage);
+                    m_ops = nullptr;
+                }
+            }
+
+            /* Empty function pointers and std::functions make an empty function, as with std::function. */
+            template <typename F> static bool s_isEmpty(const F &) noexcept { return false; }
+            template <typename F> static bool s_isEmpty(F *function) noexcept { return function == nullptr; }
+            template <typename S> static bool s_isEmpty(const std::function<S> &function) noexcept
+            {
+                return !function;
+            }
+            template <typename S, size_t N> static bool s_isEmpty(const InlineFunction<S, N> &function) noexcept
+            {
+                return !function;
+            }
+
+            const Ops *m_ops;
+            Storage m_storage;
+        };
+
+        template <typename R, typename... Args, size_t InlineBytes>
+        template <typename F>
+        const typename InlineFunction<R(Args...), InlineBytes>::Ops
+            InlineFunction<R(Args...), InlineBytes>::InlineOps<F>::Table = {
+                &InlineOps<F>::Invoke,
+                &InlineOps<F>::Copy,
+                &InlineOps<F>::Move,
+                &InlineOps<F>::Destroy};
+
+        template <typename R, typename... Args, size_t InlineBytes>
+        template <typename F>
+        const typename InlineFunction<R(Args...), InlineBytes>::Ops
+            InlineFunction<R(Args...), InlineBytes>::HeapOps<F>::Table = {
+                &HeapOps<F>::Invoke,
+                &HeapOps<F>::Copy,
+                &HeapOps<F>::Move,
+                &HeapOps<F>::Destroy};
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
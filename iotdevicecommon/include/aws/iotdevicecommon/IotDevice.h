@@ -18,15 +18,58 @@ namespace Aws
     namespace Iotdevicecommon
     {
 
+        /**
+         * When a DeviceApiHandle initializes aws-c-iot and the libraries beneath it.
+         */
+        enum class DeviceApiInit
+        {
+            /**
+             * In the constructor.
+             */
+            Eager,
+
+            /**
+             * The first time Device Defender or Secure Tunneling is used. A process that only runs discovery,
+             * provisioning or the shadow and jobs clients then never pays for it.
+             */
+            Lazy,
+        };
+
+        /**
+         * How long one step of initializing or cleaning up the device libraries took.
+         */
+        struct StartupPhase
+        {
+            const char *Name;
+            uint64_t DurationNs;
+        };
+
         class AWS_IOTDEVICECOMMON_API DeviceApiHandle final
         {
           public:
             DeviceApiHandle(Crt::Allocator *allocator) noexcept;
+            DeviceApiHandle(Crt::Allocator *allocator, DeviceApiInit init) noexcept;
             ~DeviceApiHandle();
             DeviceApiHandle(const DeviceApiHandle &) = delete;
             DeviceApiHandle(DeviceApiHandle &&) = delete;
             DeviceApiHandle &operator=(const DeviceApiHandle &) = delete;
             DeviceApiHandle &operator=(DeviceApiHandle &&) = delete;
+
+            /**
+             * Initializes the device libraries now if a lazy handle has not yet. The clients that need them
+             * call this before first use; it does nothing when no DeviceApiHandle exists.
+             */
+            static void EnsureInitialized() noexcept;
+
+            /**
+             * @return the phases of the latest initialization, then of the latest clean up, in the order
+             * they ran. Libraries already initialized by Crt::ApiHandle show as near-zero phases.
+             */
+            static Crt::Vector<StartupPhase> GetStartupProfile();
+
+          private:
+            Crt::Allocator *m_allocator;
+            bool m_initialized;
         };
 
     } // namespace Iotdevicecommon
@@ -0,0 +1,86 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <functional>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Locates members of a raw JSON payload without parsing it into a document, so a client can look at
+         * one field (a version, a job document) before deciding whether to decode the rest.
+         *
+         * The returned cursors point into the scanned payload and span the member's encoded JSON value,
+         * so they are only valid for as long as that payload is. Keys are compared byte-for-byte against
+         * their encoded form.
+         *
+         * Configuring with USE_SIMD_JSON skips over nested values 64 bytes at a time with SSE2 on x86-64 or NEON
+         * on AArch64. Results for well-formed payloads are the same either way.
+         */
+        namespace JsonPayloadScanner
+        {
+            /**
+             * Finds the member named `key` in the JSON object in `object`. Returns false if `object` is
+             * not a well-formed object or has no such member.
+             */
+            bool AWS_IOTDEVICECOMMON_API
+                FindMember(const Crt::ByteCursor &object, const char *key, Crt::ByteCursor &value) noexcept;
+
+            /**
+             * Reads a JSON value found by FindMember as a signed 64-bit integer. Returns false for any other
+             * value, including numbers with a fraction or exponent and integers out of range.
+             */
+            bool AWS_IOTDEVICECOMMON_API ReadInteger(const Crt::ByteCursor &value, int64_t &integer) noexcept;
+
+            using OnMember = std::function<bool(const Crt::ByteCursor &key, const Crt::ByteCursor &value)>;
+            using OnElement = std::function<bool(const Crt::ByteCursor &value)>;
+
+            /**
+             * Calls `onMember` with each member of the JSON object in `object` in order, passing the key in its
+             * encoded form without the quotes. Stops early, returning false, if `onMember` does.
+             *
+             * @return false if `object` is not a well-formed object.
+             */
+            bool AWS_IOTDEVICECOMMON_API ForEachMember(const Crt::ByteCursor &object, const OnMember &onMember);
+
+            /**
+             * As ForEachMember, for the elements of the JSON array in `array`.
+             */
+            bool AWS_IOTDEVICECOMMON_API ForEachElement(const Crt::ByteCursor &array, const OnElement &onElement);
+
+            /**
+             * Reads a JSON value as true or false. Returns false for any other value.
+             */
+            bool AWS_IOTDEVICECOMMON_API ReadBool(const Crt::ByteCursor &value, bool &boolean) noexcept;
+
+            /**
+             * Reads any JSON number. Returns false for any other value.
+             */
+            bool AWS_IOTDEVICECOMMON_API ReadDouble(const Crt::ByteCursor &value, double &number) noexcept;
+
+            /**
+             * Reads a JSON string, resolving its escapes into UTF-8. Returns false for any other value.
+             */
+            bool AWS_IOTDEVICECOMMON_API ReadString(const Crt::ByteCursor &value, Crt::String &string);
+
+            /**
+             * @return whether the JSON value is null.
+             */
+            bool AWS_IOTDEVICECOMMON_API IsNull(const Crt::ByteCursor &value) noexcept;
+
+            /**
+             * @return the scanning the library was built with: "sse2", "neon" or "scalar".
+             */
+            const char *AWS_IOTDEVICECOMMON_API Backend() noexcept;
+        } // namespace JsonPayloadScanner
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,61 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Types.h>
+
+#include <aws/iotdevicecommon/Exports.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * A set of dot-separated member paths, such as "state.desired.color", that selects the parts of a
+         * JSON document worth copying. Applying it to a parsed payload before building a model object means
+         * only the selected subtrees are copied into the model, instead of every nested object.
+         *
+         * Top-level members that are not objects (version, timestamp, clientToken) are always kept. Nested
+         * objects are kept only along a path; the object a path ends at is kept whole. A path that names a
+         * member the document lacks is ignored.
+         */
+        class AWS_IOTDEVICECOMMON_API JsonProjection final
+        {
+          public:
+            explicit JsonProjection(
+                const Crt::Vector<Crt::String> &paths,
+                Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+
+            JsonProjection(const JsonProjection &) = default;
+            JsonProjection(JsonProjection &&) = default;
+            JsonProjection &operator=(const JsonProjection &) = default;
+            JsonProjection &operator=(JsonProjection &&) = default;
+            ~JsonProjection() = default;
+
+            /**
+             * Copies the projected members of `doc` into `out`, which is reset first.
+             */
+            void Apply(const Crt::JsonView &doc, Crt::JsonObject &out) const;
+
+          private:
+            struct Node
+            {
+                Crt::String Name;
+                /* True once some path ends at this node, so its whole subtree is kept. */
+                bool Whole = false;
+                Crt::Vector<size_t> Children;
+            };
+
+            size_t ChildNamed(size_t parent, const Crt::String &name);
+            void ApplyNode(size_t node, const Crt::JsonView &doc, Crt::JsonObject &out) const;
+
+            Crt::Allocator *m_allocator;
+            /* m_nodes[0] is the document root. */
+            Crt::Vector<Node> m_nodes;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,99 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * A number written into a JsonTemplate slot: integers are written exactly, doubles as JsonWriter does.
+         */
+        struct AWS_IOTDEVICECOMMON_API TemplateNumber
+        {
+            TemplateNumber(int32_t value) noexcept : IsInteger(true), Integer(value), Real(0) {}
+            TemplateNumber(int64_t value) noexcept : IsInteger(true), Integer(value), Real(0) {}
+            TemplateNumber(double value) noexcept : IsInteger(false), Integer(0), Real(value) {}
+
+            bool IsInteger;
+            int64_t Integer;
+            double Real;
+        };
+
+        /**
+         * A JSON payload of fixed layout in which only numbers change, e.g. a metrics report with the same keys
+         * each time.
+         *
+         * The template is built once, as literal text with numbered slots in it; Render() then copies the text
+         * around the slots and writes each number in place, into a buffer grown once up front. No document tree
+         * is built and no key is escaped again. Literals passed as arrays have their length taken at compile
+         * time. A built template may be rendered from any number of threads.
+         *
+         *     JsonTemplate reported;
+         *     reported.Literal("{\"temp\":").Slot().Literal(",\"fan\":").Slot().Literal("}");
+         *     TemplateNumber values[] = {21.5, 3};
+         *     reported.Render(values, 2, buf);
+         */
+        class AWS_IOTDEVICECOMMON_API JsonTemplate final
+        {
+          public:
+            explicit JsonTemplate(Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+            JsonTemplate(const JsonTemplate &rhs) = default;
+            JsonTemplate(JsonTemplate &&rhs) = default;
+
+            JsonTemplate &operator=(const JsonTemplate &rhs) = default;
+            JsonTemplate &operator=(JsonTemplate &&rhs) = default;
+
+            ~JsonTemplate() = default;
+
+            /**
+             * Appends JSON text as is.
+             */
+            template <size_t N> JsonTemplate &Literal(const char (&text)[N]) noexcept
+            {
+                return Literal(text, N - 1);
+            }
+
+            JsonTemplate &Literal(const char *text, size_t length) noexcept;
+
+            /**
+             * Appends `value` as a quoted, escaped JSON string, e.g. a key chosen at run time.
+             */
+            JsonTemplate &Quoted(const Crt::String &value) noexcept;
+
+            /**
+             * Appends the next slot; Render() fills slots in the order they were appended.
+             */
+            JsonTemplate &Slot() noexcept;
+
+            size_t GetSlotCount() const noexcept { return m_slots.size(); }
+
+            /**
+             * Appends the template to `out`, an initialized buffer with an allocator, with `values[i]` in slot i.
+             *
+             * @return false if the buffer could not grow, or, with AWS_ERROR_INVALID_ARGUMENT raised, if count is
+             * not the slot count or the template failed to build.
+             */
+            bool Render(const TemplateNumber *values, size_t count, Crt::ByteBuf &out) const noexcept;
+
+            /**
+             * @return false if appending to the template failed.
+             */
+            explicit operator bool() const noexcept { return !m_failed; }
+
+          private:
+            Crt::Allocator *m_allocator;
+            Crt::String m_text;
+            /* The offset into m_text of each slot. */
+            Crt::Vector<size_t> m_slots;
+            bool m_failed;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,69 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/PayloadWriter.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Appends compact JSON directly to a ByteBuf, growing it as needed.
+         *
+         * The service clients use this to serialize request models into a pooled publish buffer without
+         * building a JsonObject tree first. Separators are inserted automatically.
+         */
+        class AWS_IOTDEVICECOMMON_API JsonWriter final : public PayloadWriter
+        {
+          public:
+            /**
+             * @param buffer an initialized buffer with an allocator; output is appended after its contents.
+             */
+            explicit JsonWriter(Crt::ByteBuf &buffer) noexcept;
+            JsonWriter(const JsonWriter &) = delete;
+            JsonWriter(JsonWriter &&) = delete;
+            JsonWriter &operator=(const JsonWriter &) = delete;
+            JsonWriter &operator=(JsonWriter &&) = delete;
+            ~JsonWriter() override = default;
+
+            JsonWriter &BeginObject() noexcept override;
+            JsonWriter &EndObject() noexcept override;
+            JsonWriter &BeginArray() noexcept override;
+            JsonWriter &EndArray() noexcept override;
+
+            JsonWriter &Key(const char *key) noexcept override;
+            JsonWriter &Key(const Crt::String &key) noexcept override;
+
+            JsonWriter &String(const char *value) noexcept override;
+            JsonWriter &String(const Crt::String &value) noexcept override;
+            JsonWriter &String(const Crt::ByteCursor &value) noexcept override;
+            JsonWriter &Bool(bool value) noexcept override;
+            JsonWriter &Integer(int32_t value) noexcept override;
+            JsonWriter &Int64(int64_t value) noexcept override;
+            JsonWriter &Double(double value) noexcept override;
+            JsonWriter &Null() noexcept override;
+
+            /**
+             * Goes through the value's compact encoding, so it still costs one copy of the embedded document.
+             */
+            JsonWriter &Value(const Crt::JsonView &value) noexcept override;
+
+            operator bool() const noexcept override;
+
+          private:
+            void BeginValue() noexcept;
+            void Append(const uint8_t *bytes, size_t length) noexcept;
+            void AppendLiteral(const char *literal) noexcept;
+            void AppendQuoted(const char *value, size_t length) noexcept;
+
+            Crt::ByteBuf &m_buffer;
+            bool m_needsSeparator;
+            bool m_failed;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
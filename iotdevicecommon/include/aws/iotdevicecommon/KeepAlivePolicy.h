@@ -0,0 +1,150 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        class AWS_IOTDEVICECOMMON_API KeepAlivePolicyConfig final
+        {
+          public:
+            KeepAlivePolicyConfig() noexcept;
+            KeepAlivePolicyConfig(const KeepAlivePolicyConfig &rhs) = default;
+            KeepAlivePolicyConfig(KeepAlivePolicyConfig &&rhs) = default;
+
+            KeepAlivePolicyConfig &operator=(const KeepAlivePolicyConfig &rhs) = default;
+            KeepAlivePolicyConfig &operator=(KeepAlivePolicyConfig &&rhs) = default;
+
+            ~KeepAlivePolicyConfig() = default;
+
+            /**
+             * The keep-alive, in seconds, of the first connection.
+             */
+            uint16_t InitialKeepAliveSecs;
+
+            /**
+             * The keep-alive is never tuned below this many seconds.
+             */
+            uint16_t MinKeepAliveSecs;
+
+            /**
+             * The keep-alive is never tuned above this many seconds. AWS IoT Core accepts at most 1200.
+             */
+            uint16_t MaxKeepAliveSecs;
+
+            /**
+             * How many seconds each probe adds to a keep-alive that has been confirmed to work.
+             */
+            uint16_t ProbeStepSecs;
+
+            /**
+             * A connection confirms its keep-alive once it has stayed up this many keep-alive intervals.
+             */
+            uint32_t ConfirmIntervals;
+
+            /**
+             * After a connection is lost to what looks like a NAT timeout, the keep-alive is kept this many
+             * percent below the interval that failed.
+             */
+            uint32_t MarginPercent;
+        };
+
+        /**
+         * Chooses the keep-alive to pass to MqttConnection::Connect, learning across connections how long the
+         * network path (typically a cellular carrier's NAT) lets a connection sit idle. A short keep-alive wakes
+         * the radio for pings that are not needed; one longer than the NAT's idle timeout lets the mapping
+         * expire, and the connection is then only found dead a ping timeout later.
+         *
+         * The policy probes upward, ProbeStepSecs at a time, while connections survive ConfirmIntervals
+         * intervals. A connection lost after being idle for at least a keep-alive interval is treated as a
+         * NAT timeout: that interval becomes a ceiling and the keep-alive drops MarginPercent below it. Report
+         * acknowledged traffic with OnTrafficAcked: a connection lost soon after traffic got through was not
+         * an idle mapping expiring, so, piggybacking on the application's own publishes, such a loss does not
+         * lower the keep-alive.
+         *
+         * The MQTT connection sends its own PINGREQs on the interval it was connected with, and automatic
+         * reconnects reuse it, so a new keep-alive takes effect at the next Connect. Compare GetKeepAliveSecs
+         * to the interval in use to decide when reconnecting is worthwhile. Call Reset after moving to a
+         * different network. Thread-safe.
+         */
+        class AWS_IOTDEVICECOMMON_API KeepAlivePolicy final
+        {
+          public:
+            explicit KeepAlivePolicy(const KeepAlivePolicyConfig &config = KeepAlivePolicyConfig()) noexcept;
+            KeepAlivePolicy(const KeepAlivePolicy &) = delete;
+            KeepAlivePolicy(KeepAlivePolicy &&) = delete;
+            KeepAlivePolicy &operator=(const KeepAlivePolicy &) = delete;
+            KeepAlivePolicy &operator=(KeepAlivePolicy &&) = delete;
+
+            /**
+             * @return the keep-alive, in seconds, to connect with next.
+             */
+            uint16_t GetKeepAliveSecs() const noexcept;
+
+            /**
+             * Call from OnConnectionCompleted (on success) or OnConnectionResumed, with the keep-alive the
+             * connection is using.
+             */
+            void OnConnected(uint16_t keepAliveSecs) noexcept;
+
+            /**
+             * Call when an operation round trip completed, e.g. a QoS 1 publish was acknowledged or a
+             * subscription message arrived.
+             */
+            void OnTrafficAcked() noexcept;
+
+            /**
+             * Call from OnConnectionInterrupted.
+             */
+            void OnInterrupted() noexcept;
+
+            /**
+             * Call before a deliberate Disconnect; the connection's uptime still confirms its keep-alive.
+             */
+            void OnDisconnecting() noexcept;
+
+            /**
+             * Forgets everything learnt and returns to InitialKeepAliveSecs.
+             */
+            void Reset() noexcept;
+
+            /**
+             * @return the smallest keep-alive, in seconds, seen to fail through a NAT timeout, or 0 if none has.
+             */
+            uint16_t GetCeilingSecs() const noexcept;
+
+            /**
+             * @return the number of connection losses attributed to a NAT timeout.
+             */
+            uint64_t GetNatTimeoutCount() const noexcept;
+
+          private:
+            /* Confirms `keepAliveSecs` and probes past it if its connection stayed up long enough. */
+            void ConfirmLocked(uint64_t nowNs, uint16_t keepAliveSecs) noexcept;
+            uint16_t ClampLocked(uint32_t keepAliveSecs) const noexcept;
+
+            KeepAlivePolicyConfig m_config;
+            mutable std::mutex m_lock;
+
+            uint16_t m_keepAliveSecs;
+            /* The keep-alive of the current connection, 0 while not connected. */
+            uint16_t m_connectedKeepAliveSecs;
+            /* The largest keep-alive confirmed to work, and the smallest seen to fail; 0 for none. */
+            uint16_t m_floorSecs;
+            uint16_t m_ceilingSecs;
+            uint64_t m_connectedNs;
+            uint64_t m_lastTrafficNs;
+            uint64_t m_natTimeoutCount;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,391 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/common/clock.h>
+#include <aws/crt/Api.h>
+#include <aws/crt/Types.h>
+#include <aws/io/io.h>
+#include <aws/iotdevicecommon/SubscriptionHandle.h>
+#include <aws/iotdevicecommon/TimerWheel.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * The per-thing state of a gateway, such as a request correlator per child device, created and
+         * subscribed on a thing's first use and unsubscribed and dropped once it has been idle for a TTL. So
+         * a gateway fronting thousands of things, few of them active at once, holds broker subscriptions and
+         * memory only for the active ones.
+         *
+         * Every Subscribe* call SubscribeThing makes is owned by the thing's entry, as by a SubscriptionHandle,
+         * and unsubscribed on eviction. A thing that IsBusy, e.g. with requests in flight, is kept for another
+         * TTL. Without a TimerWheel or with a TTL of 0, things are only evicted by Evict().
+         */
+        template <typename Thing>
+        class LazySubscriptions final : public std::enable_shared_from_this<LazySubscriptions<Thing>>
+        {
+          public:
+            using OnSubscribed = std::function<void(int errorCode)>;
+
+            /**
+             * Creates a thing's state. Returns null, with the error raised, on failure.
+             */
+            using CreateThing = std::function<std::shared_ptr<Thing>(const Crt::String &thingName)>;
+
+            /**
+             * Subscribes to a thing's topics, invoking `onSubscribed` once with the first error of their SUBACKs.
+             */
+            using SubscribeThing = std::function<bool(Thing &thing, const OnSubscribed &onSubscribed)>;
+
+            using IsBusy = std::function<bool(const Thing &thing)>;
+
+            /**
+             * Invoked with the thing once subscribed, or with null and the error if it could not be.
+             */
+            using OnReady = std::function<void(const std::shared_ptr<Thing> &thing, int errorCode)>;
+
+            LazySubscriptions(const LazySubscriptions &) = delete;
+            LazySubscriptions(LazySubscriptions &&) = delete;
+            LazySubscriptions &operator=(const LazySubscriptions &) = delete;
+            LazySubscriptions &operator=(LazySubscriptions &&) = delete;
+
+            ~LazySubscriptions() = default;
+
+            /**
+             * Hands `onReady` the thing, creating and subscribing it first if it is not active. Each call
+             * restarts the thing's idle TTL. A thing already subscribed is handed over within the call, and a
+             * subscribe that fails, even to start, completes `onReady` with its error.
+             *
+             * @return false, with the error raised, if the thing could not be created.
+             */
+            bool Acquire(const Crt::String &thingName, OnReady &&onReady)
+            {
+                std::shared_ptr<Thing> ready;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    auto iter = m_things.find(thingName);
+                    if (iter != m_things.end())
+                    {
+                        Entry &entry = iter->second;
+                        entry.LastUseNs = s_nowNs();
+                        if (!entry.Subscribed)
+                        {
+                            entry.Waiters.push_back(std::move(onReady));
+                            return true;
+                        }
+                        ready = entry.Value;
+                    }
+                }
+
+                if (ready)
+                {
+                    onReady(ready, AWS_ERROR_SUCCESS);
+                    return true;
+                }
+
+                std::shared_ptr<Thing> created = m_create(thingName);
+                if (!created)
+                {
+                    return false;
+                }
+
+                uint64_t generation = 0;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    auto iter = m_things.find(thingName);
+                    if (iter != m_things.end())
+                    {
+                        /* Another call created the thing meanwhile; wait on its subscribe instead. */
+                        if (!iter->second.Subscribed)
+                        {
+                            iter->second.Waiters.push_back(std::move(onReady));
+                            return true;
+                        }
+                        ready = iter->second.Value;
+                    }
+                    else
+                    {
+                        generation = ++m_nextGeneration;
+                        Entry &entry = m_things[thingName];
+                        entry.Value = created;
+                        entry.Subscribed = false;
+                        entry.Waiters.push_back(std::move(onReady));
+                        entry.LastUseNs = s_nowNs();
+                        entry.TimerId = 0;
+                        entry.Generation = generation;
+                    }
+                }
+
+                if (ready)
+                {
+                    onReady(ready, AWS_ERROR_SUCCESS);
+                    return true;
+                }
+
+                std::weak_ptr<LazySubscriptions> weakSelf = this->shared_from_this();
+                OnSubscribed onSubscribed = [weakSelf, thingName, generation](int errorCode) {
+                    auto self = weakSelf.lock();
+                    if (self)
+                    {
+                        self->Subscribed(thingName, generation, errorCode);
+                    }
+                };
+
+                SubscriptionHandle subscriptions;
+                bool subscribing = false;
+                {
+                    SubscriptionHandle::Capture capture(subscriptions);
+                    subscribing = m_subscribe(*created, onSubscribed);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    auto iter = m_things.find(thingName);
+                    if (iter != m_things.end() && iter->second.Generation == generation)
+                    {
+                        iter->second.Subscriptions = std::move(subscriptions);
+                    }
+                }
+
+                if (!subscribing)
+                {
+                    Subscribed(thingName, generation, Crt::LastErrorOrUnknown());
+                }
+                return true;
+            }
+
+            /**
+             * Unsubscribes from `thingName`'s topics and drops its state now, busy or not. Acquires still
+             * waiting on its subscribe complete with AWS_IO_OPERATION_CANCELLED.
+             *
+             * @return false if the thing is not active.
+             */
+            bool Evict(const Crt::String &thingName)
+            {
+                Entry evicted;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    auto iter = m_things.find(thingName);
+                    if (iter == m_things.end())
+                    {
+                        return false;
+                    }
+                    CancelIdleCheck(iter->second);
+                    TakeEntry(iter, evicted);
+                    ++m_evictionCount;
+                }
+
+                for (OnReady &onReady : evicted.Waiters)
+                {
+                    onReady(nullptr, AWS_IO_OPERATION_CANCELLED);
+                }
+                return true;
+            }
+
+            /**
+             * @return the number of things active, or being subscribed.
+             */
+            size_t GetThingCount() const
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                return m_things.size();
+            }
+
+            uint64_t GetEvictionCount() const
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                return m_evictionCount;
+            }
+
+            static std::shared_ptr<LazySubscriptions> Create(
+                CreateThing &&create,
+                SubscribeThing &&subscribe,
+                IsBusy &&isBusy,
+                const std::shared_ptr<TimerWheel> &timers,
+                uint32_t idleTtlMs,
+                Crt::Allocator *allocator = Crt::DefaultAllocator())
+            {
+                auto *toSeat =
+                    static_cast<LazySubscriptions *>(aws_mem_acquire(allocator, sizeof(LazySubscriptions)));
+                if (toSeat)
+                {
+                    toSeat = new (toSeat) LazySubscriptions(
+                        std::move(create), std::move(subscribe), std::move(isBusy), timers, idleTtlMs);
+                    return std::shared_ptr<LazySubscriptions>(
+                        toSeat, [allocator](LazySubscriptions *things) { Crt::Delete(things, allocator); });
+                }
+
+                return nullptr;
+            }
+
+          private:
+            struct Entry
+            {
+                std::shared_ptr<Thing> Value;
+                SubscriptionHandle Subscriptions;
+                bool Subscribed = false;
+                Crt::Vector<OnReady> Waiters;
+                uint64_t LastUseNs = 0;
+                uint64_t TimerId = 0;
+                /* Tells the thing's callbacks apart from those of an earlier entry of the same name. */
+                uint64_t Generation = 0;
+            };
+
+            LazySubscriptions(
+                CreateThing &&create,
+                SubscribeThing &&subscribe,
+                IsBusy &&isBusy,
+                const std::shared_ptr<TimerWheel> &timers,
+                uint32_t idleTtlMs) noexcept
+                : m_create(std::move(create)), m_subscribe(std::move(subscribe)), m_isBusy(std::move(isBusy)),
+                  m_timers(timers), m_idleTtlMs(idleTtlMs), m_nextGeneration(0), m_evictionCount(0)
+            {
+            }
+
+            /* Moves the entry out of the map, so the thing and its subscriptions are released unlocked. */
+            void TakeEntry(typename Crt::Map<Crt::String, Entry>::iterator iter, Entry &taken)
+            {
+                taken.Value = std::move(iter->second.Value);
+                taken.Subscriptions = std::move(iter->second.Subscriptions);
+                taken.Waiters.swap(iter->second.Waiters);
+                m_things.erase(iter);
+            }
+
+            static uint64_t s_nowNs() noexcept
+            {
+                uint64_t nowNs = 0;
+                aws_high_res_clock_get_ticks(&nowNs);
+                return nowNs;
+            }
+
+            void Subscribed(const Crt::String &thingName, uint64_t generation, int errorCode)
+            {
+                Crt::Vector<OnReady> waiters;
+                std::shared_ptr<Thing> ready;
+                Entry dropped;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    auto iter = m_things.find(thingName);
+                    if (iter == m_things.end() || iter->second.Generation != generation || iter->second.Subscribed)
+                    {
+                        return;
+                    }
+
+                    Entry &entry = iter->second;
+                    waiters.swap(entry.Waiters);
+                    if (errorCode != AWS_ERROR_SUCCESS)
+                    {
+                        /* Whatever did subscribe is unsubscribed, so the next use starts over. */
+                        TakeEntry(iter, dropped);
+                    }
+                    else
+                    {
+                        entry.Subscribed = true;
+                        ready = entry.Value;
+                        ScheduleIdleCheck(thingName, entry, m_idleTtlMs);
+                    }
+                }
+
+                for (OnReady &onReady : waiters)
+                {
+                    onReady(ready, errorCode);
+                }
+            }
+
+            void ScheduleIdleCheck(const Crt::String &thingName, Entry &entry, uint64_t delayMs)
+            {
+                if (!m_timers || m_idleTtlMs == 0)
+                {
+                    return;
+                }
+
+                std::weak_ptr<LazySubscriptions> weakSelf = this->shared_from_this();
+                uint64_t generation = entry.Generation;
+                entry.TimerId = m_timers->Schedule(delayMs, [weakSelf, thingName, generation]() {
+                    auto self = weakSelf.lock();
+                    if (self)
+                    {
+                        self->CheckIdle(thingName, generation);
+                    }
+                });
+            }
+
+            void CancelIdleCheck(Entry &entry)
+            {
+                if (entry.TimerId != 0 && m_timers)
+                {
+                    m_timers->Cancel(entry.TimerId);
+                    entry.TimerId = 0;
+                }
+            }
+
+            void CheckIdle(const Crt::String &thingName, uint64_t generation)
+            {
+                std::shared_ptr<Thing> thing;
+                uint64_t lastUseNs = 0;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    auto iter = m_things.find(thingName);
+                    if (iter == m_things.end() || iter->second.Generation != generation)
+                    {
+                        return;
+                    }
+
+                    Entry &entry = iter->second;
+                    entry.TimerId = 0;
+                    uint64_t idleMs = aws_timestamp_convert(
+                        s_nowNs() - entry.LastUseNs, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL);
+                    if (idleMs < m_idleTtlMs)
+                    {
+                        /* Used since the check was scheduled; check again once the TTL runs out from then. */
+                        ScheduleIdleCheck(thingName, entry, m_idleTtlMs - idleMs);
+                        return;
+                    }
+                    thing = entry.Value;
+                    lastUseNs = entry.LastUseNs;
+                }
+
+                bool busy = m_isBusy && m_isBusy(*thing);
+
+                Entry evicted;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    auto iter = m_things.find(thingName);
+                    if (iter == m_things.end() || iter->second.Generation != generation)
+                    {
+                        return;
+                    }
+
+                    Entry &entry = iter->second;
+                    if (busy || entry.LastUseNs != lastUseNs)
+                    {
+                        ScheduleIdleCheck(thingName, entry, m_idleTtlMs);
+                        return;
+                    }
+                    TakeEntry(iter, evicted);
+                    ++m_evictionCount;
+                }
+            }
+
+            CreateThing m_create;
+            SubscribeThing m_subscribe;
+            IsBusy m_isBusy;
+            std::shared_ptr<TimerWheel> m_timers;
+            uint32_t m_idleTtlMs;
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, Entry> m_things;
+            uint64_t m_nextGeneration;
+            uint64_t m_evictionCount;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,159 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <atomic>
+#include <memory>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * What happens to a message arriving while the executor queue is full.
+         */
+        enum class InboundOverflowPolicy
+        {
+            /** Discard it, counted in DroppedInboundMessages. */
+            Drop,
+            /** Handle it on the connection's event loop, which stops reading until the handler returns. */
+            HandleInline,
+        };
+
+        /**
+         * Caps on the memory the service clients may hold on behalf of work that has not finished. A limit of
+         * 0 is unlimited.
+         */
+        class AWS_IOTDEVICECOMMON_API MemoryBudgetConfig
+        {
+          public:
+            MemoryBudgetConfig() noexcept;
+            MemoryBudgetConfig(const MemoryBudgetConfig &rhs) = default;
+            MemoryBudgetConfig(MemoryBudgetConfig &&rhs) = default;
+
+            MemoryBudgetConfig &operator=(const MemoryBudgetConfig &rhs) = default;
+            MemoryBudgetConfig &operator=(MemoryBudgetConfig &&rhs) = default;
+
+            ~MemoryBudgetConfig() = default;
+
+            /**
+             * Publishes handed to the connection and not yet completed, including QoS 1 publishes the
+             * connection holds while offline. Publish* calls beyond it fail with
+             * AWS_ERROR_LIST_EXCEEDS_MAX_SIZE.
+             */
+            size_t MaxInFlightPublishes;
+
+            /**
+             * Correlated requests (ShadowRequestCorrelator, JobsRequestCorrelator, IdentityRequestClient)
+             * waiting for their response. Requests beyond it are refused with AWS_ERROR_LIST_EXCEEDS_MAX_SIZE.
+             */
+            size_t MaxPendingRequests;
+
+            /**
+             * Received messages copied for the handler executor and not yet handled. Applies only to clients
+             * with a HandlerExecutor.
+             */
+            size_t MaxQueuedInboundMessages;
+
+            /**
+             * Defaults to Drop.
+             */
+            InboundOverflowPolicy InboundOverflow;
+        };
+
+        /**
+         * How a MemoryBudget has been used. The first three are current values, the rest totals.
+         */
+        struct AWS_IOTDEVICECOMMON_API MemoryBudgetCounters
+        {
+            size_t InFlightPublishes;
+            size_t PendingRequests;
+            size_t QueuedInboundMessages;
+
+            uint64_t RejectedPublishes;
+            uint64_t RejectedRequests;
+            uint64_t DroppedInboundMessages;
+            uint64_t InlineInboundMessages;
+        };
+
+        /**
+         * A memory budget the service clients consult before taking on more queued work, set through
+         * ServiceClientConfig::MemoryBudget. Share one instance between every client in the process for a
+         * process-wide bound.
+         *
+         * Work admitted under the budget holds a Slot, which gives its share back when destroyed.
+         */
+        class AWS_IOTDEVICECOMMON_API MemoryBudget final : public std::enable_shared_from_this<MemoryBudget>
+        {
+          public:
+            /**
+             * Held while admitted work is outstanding; null when the work was refused. Copies share one
+             * share of the budget.
+             */
+            using Slot = std::shared_ptr<void>;
+
+            MemoryBudget(const MemoryBudget &) = delete;
+            MemoryBudget(MemoryBudget &&) = delete;
+            MemoryBudget &operator=(const MemoryBudget &) = delete;
+            MemoryBudget &operator=(MemoryBudget &&) = delete;
+
+            /**
+             * @return a slot for one more in-flight publish, or null with AWS_ERROR_LIST_EXCEEDS_MAX_SIZE
+             * raised.
+             */
+            Slot AcquirePublish();
+
+            /**
+             * @return a slot for one more pending request, or null with AWS_ERROR_LIST_EXCEEDS_MAX_SIZE raised.
+             */
+            Slot AcquireRequest();
+
+            /**
+             * @return a slot for one more queued inbound message, or null if the message should not be queued;
+             * `handleInline` then says whether to handle it on the calling thread instead of dropping it.
+             */
+            Slot AcquireInbound(bool &handleInline);
+
+            MemoryBudgetCounters GetCounters() const noexcept;
+
+            const MemoryBudgetConfig &GetConfig() const noexcept { return m_config; }
+
+            static std::shared_ptr<MemoryBudget> Create(
+                const MemoryBudgetConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            MemoryBudget(const MemoryBudgetConfig &config, Crt::Allocator *allocator) noexcept;
+
+            Slot Acquire(std::atomic<size_t> &inUse, size_t limit, std::atomic<uint64_t> &refused);
+
+            MemoryBudgetConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            std::atomic<size_t> m_inFlightPublishes;
+            std::atomic<size_t> m_pendingRequests;
+            std::atomic<size_t> m_queuedInboundMessages;
+
+            std::atomic<uint64_t> m_rejectedPublishes;
+            std::atomic<uint64_t> m_rejectedRequests;
+            std::atomic<uint64_t> m_droppedInboundMessages;
+            std::atomic<uint64_t> m_inlineInboundMessages;
+        };
+
+        /**
+         * Takes a pending-request slot from `budget` into `slot`; succeeds without one when `budget` is null.
+         *
+         * @return false, with AWS_ERROR_LIST_EXCEEDS_MAX_SIZE raised, when the budget is exhausted.
+         */
+        AWS_IOTDEVICECOMMON_API bool AcquireRequestSlot(
+            const std::shared_ptr<MemoryBudget> &budget,
+            MemoryBudget::Slot &slot);
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
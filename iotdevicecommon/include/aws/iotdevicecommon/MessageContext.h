@@ -0,0 +1,78 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <functional>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Makes `topic` the current message topic on the calling thread for as long as it is in scope. The
+         * service clients open one around every subscription handler, so a single handler registered with a
+         * "+" thing name can tell which thing each message is for.
+         */
+        class AWS_IOTDEVICECOMMON_API MessageTopicScope final
+        {
+          public:
+            explicit MessageTopicScope(const Crt::String &topic) noexcept;
+            ~MessageTopicScope();
+            MessageTopicScope(const MessageTopicScope &) = delete;
+            MessageTopicScope &operator=(const MessageTopicScope &) = delete;
+
+          private:
+            const Crt::String *m_outer;
+        };
+
+        /**
+         * @return the topic of the message whose handler is running on the calling thread, or null outside a
+         * handler.
+         */
+        AWS_IOTDEVICECOMMON_API const Crt::String *CurrentMessageTopic() noexcept;
+
+        /**
+         * @return the thing name of the "$aws/things/<thing>/..." message whose handler is running on the
+         * calling thread, or an empty string outside a handler or for other topics.
+         */
+        AWS_IOTDEVICECOMMON_API Crt::String CurrentThingName();
+
+        /**
+         * Finds the `index`th '/'-separated segment of `topic`, counting from zero.
+         *
+         * @return false if the topic has fewer segments.
+         */
+        AWS_IOTDEVICECOMMON_API bool TopicSegment(const Crt::String &topic, size_t index, Crt::String &segment);
+
+        /**
+         * A message handed over without any decoding by the raw subscribe calls of the service clients. The
+         * cursors point into the message as received and are only valid for the duration of the handler call.
+         */
+        struct AWS_IOTDEVICECOMMON_API RawMessage
+        {
+            Crt::ByteCursor Topic;
+            /** The thing segment of a "$aws/things/<thing>/..." topic; empty for other topics. */
+            Crt::ByteCursor ThingName;
+            Crt::ByteCursor Payload;
+        };
+
+        /**
+         * Handler of the raw subscribe calls. `message` is null when the subscription failed, with the reason in
+         * ioErr.
+         */
+        using OnRawMessageReceived = std::function<void(const RawMessage *message, int ioErr)>;
+
+        /**
+         * @return the thing segment of a "$aws/things/<thing>/..." topic, pointing into `topic`, or an empty
+         * cursor for other topics.
+         */
+        AWS_IOTDEVICECOMMON_API Crt::ByteCursor ThingNameOfTopic(Crt::ByteCursor topic) noexcept;
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
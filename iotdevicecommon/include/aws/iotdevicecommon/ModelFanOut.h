@@ -0,0 +1,125 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * The local listeners of one subscription, each handed the same parsed Model by Dispatch(), for letting
+         * several components share one broker subscription and one parse.
+         *
+         * The listener list is copied on Add() and Remove() and shared on Dispatch(), so dispatching takes the
+         * lock only to pick up the current list, and a listener may add or remove listeners, itself included.
+         * A listener removed while a dispatch runs may still be invoked by that dispatch.
+         */
+        template <typename Model> class ModelFanOut final
+        {
+          public:
+            using Listener = std::function<void(const Model *model, int errorCode)>;
+
+            explicit ModelFanOut(Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept
+                : m_allocator(allocator), m_nextId(1)
+            {
+            }
+
+            ModelFanOut(const ModelFanOut &) = delete;
+            ModelFanOut(ModelFanOut &&) = delete;
+            ModelFanOut &operator=(const ModelFanOut &) = delete;
+            ModelFanOut &operator=(ModelFanOut &&) = delete;
+
+            /**
+             * @return the id to remove the listener by, never 0.
+             */
+            uint64_t Add(Listener &&listener)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                auto listeners = Crt::MakeShared<Listeners>(m_allocator, Crt::StlAllocator<Entry>(m_allocator));
+                if (m_listeners)
+                {
+                    *listeners = *m_listeners;
+                }
+                uint64_t id = m_nextId++;
+                listeners->emplace_back(id, std::move(listener));
+                m_listeners = std::move(listeners);
+                return id;
+            }
+
+            /**
+             * @return false if no listener has that id.
+             */
+            bool Remove(uint64_t id)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (!m_listeners)
+                {
+                    return false;
+                }
+
+                auto listeners = Crt::MakeShared<Listeners>(m_allocator, Crt::StlAllocator<Entry>(m_allocator));
+                for (const Entry &entry : *m_listeners)
+                {
+                    if (entry.first != id)
+                    {
+                        listeners->push_back(entry);
+                    }
+                }
+                if (listeners->size() == m_listeners->size())
+                {
+                    return false;
+                }
+                m_listeners = std::move(listeners);
+                return true;
+            }
+
+            size_t GetListenerCount() const
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                return m_listeners ? m_listeners->size() : 0;
+            }
+
+            /**
+             * Invokes every listener, in the order they were added, with `model`, which is null on errors.
+             */
+            void Dispatch(const Model *model, int errorCode) const
+            {
+                std::shared_ptr<const Listeners> listeners;
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    listeners = m_listeners;
+                }
+
+                if (!listeners)
+                {
+                    return;
+                }
+
+                for (const Entry &entry : *listeners)
+                {
+                    entry.second(model, errorCode);
+                }
+            }
+
+          private:
+            using Entry = std::pair<uint64_t, Listener>;
+            using Listeners = Crt::Vector<Entry>;
+
+            Crt::Allocator *m_allocator;
+            mutable std::mutex m_lock;
+            std::shared_ptr<const Listeners> m_listeners;
+            uint64_t m_nextId;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,425 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Optional.h>
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/FlatStringMap.h>
+#include <aws/iotdevicecommon/PackedDateTime.h>
+#include <aws/iotdevicecommon/PayloadWriter.h>
+
+#include <cstddef>
+#include <utility>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * One member of a service model's payload: its JSON name and how to load, save and stream it. A model
+         * lists its members in a constexpr table of these, and LoadFields, SaveFields and WriteFields do the
+         * work its hand-expanded LoadFromObject, SerializeToObject and SerializeTo used to.
+         */
+        template <typename Model> struct ModelField
+        {
+            const char *Name;
+
+            /* Sets the member from `member`, the value under Name; leaves it unset if absent or of the wrong kind. */
+            void (*Load)(Model &model, const Crt::JsonView &member);
+            void (*Save)(const Model &model, const char *name, Crt::JsonObject &object);
+
+            /* Null in the tables of models that are only ever received. */
+            void (*Write)(const Model &model, const char *name, PayloadWriter &writer);
+        };
+
+        /**
+         * How a member of type `Value` is read from and written to JSON. Specialized for the scalar, document
+         * and map member types the service models use; enums and nested models use EnumCodec and ModelCodec,
+         * and timestamps ModelFields::Timestamp.
+         */
+        template <typename Value> struct FieldCodec;
+
+        template <> struct FieldCodec<Crt::String>
+        {
+            static void Load(const Crt::JsonView &member, Crt::Optional<Crt::String> &value)
+            {
+                if (member.IsString())
+                {
+                    value = member.AsString();
+                }
+            }
+
+            static void Save(const char *name, const Crt::String &value, Crt::JsonObject &object)
+            {
+                object.WithString(name, value);
+            }
+
+            static void Write(const Crt::String &value, PayloadWriter &writer) { writer.String(value); }
+        };
+
+        template <> struct FieldCodec<bool>
+        {
+            static void Load(const Crt::JsonView &member, Crt::Optional<bool> &value)
+            {
+                if (member.IsBool())
+                {
+                    value = member.AsBool();
+                }
+            }
+
+            static void Save(const char *name, bool value, Crt::JsonObject &object) { object.WithBool(name, value); }
+
+            static void Write(bool value, PayloadWriter &writer) { writer.Bool(value); }
+        };
+
+        template <> struct FieldCodec<int32_t>
+        {
+            static void Load(const Crt::JsonView &member, Crt::Optional<int32_t> &value)
+            {
+                if (member.IsIntegerType() || member.IsFloatingPointType())
+                {
+                    value = member.AsInteger();
+                }
+            }
+
+            static void Save(const char *name, int32_t value, Crt::JsonObject &object)
+            {
+                object.WithInteger(name, value);
+            }
+
+            static void Write(int32_t value, PayloadWriter &writer) { writer.Integer(value); }
+        };
+
+        template <> struct FieldCodec<int64_t>
+        {
+            static void Load(const Crt::JsonView &member, Crt::Optional<int64_t> &value)
+            {
+                if (member.IsIntegerType() || member.IsFloatingPointType())
+                {
+                    value = member.AsInt64();
+                }
+            }
+
+            static void Save(const char *name, int64_t value, Crt::JsonObject &object)
+            {
+                object.WithInt64(name, value);
+            }
+
+            static void Write(int64_t value, PayloadWriter &writer) { writer.Int64(value); }
+        };
+
+        /* Free-form documents, such as a job document or a shadow's desired state, of any kind but null. */
+        template <> struct FieldCodec<Crt::JsonObject>
+        {
+            static void Load(const Crt::JsonView &member, Crt::Optional<Crt::JsonObject> &value)
+            {
+                if (member.IsObject() || member.IsListType() || member.IsString() || member.IsBool() ||
+                    member.IsIntegerType() || member.IsFloatingPointType())
+                {
+                    value = member.Materialize();
+                }
+            }
+
+            static void Save(const char *name, const Crt::JsonObject &value, Crt::JsonObject &object)
+            {
+                object.WithObject(name, value);
+            }
+
+            static void Write(const Crt::JsonObject &value, PayloadWriter &writer) { writer.Value(value.View()); }
+        };
+
+        template <> struct FieldCodec<FlatStringMap>
+        {
+            static void Load(const Crt::JsonView &member, Crt::Optional<FlatStringMap> &value)
+            {
+                if (!member.IsObject())
+                {
+                    return;
+                }
+                auto members = member.GetAllObjects();
+                value.emplace();
+                value->reserve(members.size());
+                for (auto &entry : members)
+                {
+                    value->emplace(entry.first, entry.second.AsString());
+                }
+            }
+
+            static void Save(const char *name, const FlatStringMap &value, Crt::JsonObject &object)
+            {
+                Crt::JsonObject map;
+                for (auto &entry : value)
+                {
+                    Crt::JsonObject entryValue;
+                    entryValue.AsString(entry.second);
+                    map.WithObject(entry.first, std::move(entryValue));
+                }
+                object.WithObject(name, std::move(map));
+            }
+
+            static void Write(const FlatStringMap &value, PayloadWriter &writer) { writer.StringMap(value); }
+        };
+
+        template <> struct FieldCodec<Crt::Map<Crt::String, Crt::String>>
+        {
+            static void Load(const Crt::JsonView &member, Crt::Optional<Crt::Map<Crt::String, Crt::String>> &value)
+            {
+                if (!member.IsObject())
+                {
+                    return;
+                }
+                value.emplace();
+                for (auto &entry : member.GetAllObjects())
+                {
+                    value->emplace(entry.first, entry.second.AsString());
+                }
+            }
+
+            static void Save(const char *name, const Crt::Map<Crt::String, Crt::String> &value, Crt::JsonObject &object)
+            {
+                Crt::JsonObject map;
+                for (auto &entry : value)
+                {
+                    Crt::JsonObject entryValue;
+                    entryValue.AsString(entry.second);
+                    map.WithObject(entry.first, std::move(entryValue));
+                }
+                object.WithObject(name, std::move(map));
+            }
+
+            static void Write(const Crt::Map<Crt::String, Crt::String> &value, PayloadWriter &writer)
+            {
+                writer.StringMap(value);
+            }
+        };
+
+        /**
+         * A string enum member, converted by its marshaller's FromString and ToString.
+         */
+        template <typename Enum, Enum (*FromString)(const Crt::String &), const char *(*ToString)(Enum)>
+        struct EnumCodec
+        {
+            static void Load(const Crt::JsonView &member, Crt::Optional<Enum> &value)
+            {
+                if (member.IsString())
+                {
+                    value = FromString(member.AsString());
+                }
+            }
+
+            static void Save(const char *name, Enum value, Crt::JsonObject &object)
+            {
+                object.WithString(name, ToString(value));
+            }
+
+            static void Write(Enum value, PayloadWriter &writer) { writer.String(ToString(value)); }
+        };
+
+        /**
+         * A nested model member, loaded through the model's JsonView constructor. Write needs the nested model
+         * to have SerializeTo, so only request models' tables use it.
+         */
+        template <typename Nested> struct ModelCodec
+        {
+            static void Load(const Crt::JsonView &member, Crt::Optional<Nested> &value)
+            {
+                if (member.IsObject())
+                {
+                    value = Nested(member);
+                }
+            }
+
+            static void Save(const char *name, const Nested &value, Crt::JsonObject &object)
+            {
+                Crt::JsonObject nested;
+                value.SerializeToObject(nested);
+                object.WithObject(name, std::move(nested));
+            }
+
+            static void Write(const Nested &value, PayloadWriter &writer) { value.SerializeTo(writer); }
+        };
+
+        /**
+         * An array of nested models.
+         */
+        template <typename Nested> struct ModelListCodec
+        {
+            static void Load(const Crt::JsonView &member, Crt::Optional<Crt::Vector<Nested>> &value)
+            {
+                if (!member.IsListType())
+                {
+                    return;
+                }
+                auto elements = member.AsArray();
+                value.emplace();
+                value->reserve(elements.size());
+                for (auto &element : elements)
+                {
+                    value->push_back(Nested(element));
+                }
+            }
+
+            static void Save(const char *name, const Crt::Vector<Nested> &value, Crt::JsonObject &object)
+            {
+                Crt::Vector<Crt::JsonObject> list;
+                list.reserve(value.size());
+                for (auto &element : value)
+                {
+                    Crt::JsonObject elementObject;
+                    Crt::JsonObject nested;
+                    element.SerializeToObject(nested);
+                    elementObject.AsObject(std::move(nested));
+                    list.push_back(std::move(elementObject));
+                }
+                object.WithArray(name, std::move(list));
+            }
+
+            static void Write(const Crt::Vector<Nested> &value, PayloadWriter &writer)
+            {
+                writer.BeginArray();
+                for (auto &element : value)
+                {
+                    element.SerializeTo(writer);
+                }
+                writer.EndArray();
+            }
+        };
+
+        /**
+         * Builds the ModelField entries of `Model`'s table. `Streamed` models, the requests, also get a Write
+         * for SerializeTo; the others leave it null so that their codecs' Write is never instantiated.
+         */
+        template <typename Model, bool Streamed = false> struct ModelFields
+        {
+            template <typename Value, Crt::Optional<Value> Model::*Member, typename Codec = FieldCodec<Value>>
+            struct OptionalField
+            {
+                static void Load(Model &model, const Crt::JsonView &member) { Codec::Load(member, model.*Member); }
+
+                static void Save(const Model &model, const char *name, Crt::JsonObject &object)
+                {
+                    if (model.*Member)
+                    {
+                        Codec::Save(name, *(model.*Member), object);
+                    }
+                }
+
+                static void Write(const Model &model, const char *name, PayloadWriter &writer)
+                {
+                    if (model.*Member)
+                    {
+                        writer.Key(name);
+                        Codec::Write(*(model.*Member), writer);
+                    }
+                }
+            };
+
+            /* A timestamp member, sent as seconds since the epoch and kept packed. */
+            template <PackedDateTime Model::*Member> struct TimestampField
+            {
+                static void Load(Model &model, const Crt::JsonView &member)
+                {
+                    if (member.IsIntegerType() || member.IsFloatingPointType())
+                    {
+                        model.*Member = PackedDateTime::FromSeconds(member.AsDouble());
+                    }
+                }
+
+                static void Save(const Model &model, const char *name, Crt::JsonObject &object)
+                {
+                    if (model.*Member)
+                    {
+                        object.WithDouble(name, (model.*Member).Seconds());
+                    }
+                }
+
+                static void Write(const Model &model, const char *name, PayloadWriter &writer)
+                {
+                    if (model.*Member)
+                    {
+                        writer.Key(name).Double((model.*Member).Seconds());
+                    }
+                }
+            };
+
+            using WriteFunction = void (*)(const Model &model, const char *name, PayloadWriter &writer);
+
+            template <bool WithWrite, typename Entry> struct WriteOf
+            {
+                static constexpr WriteFunction Get() { return nullptr; }
+            };
+
+            template <typename Entry> struct WriteOf<true, Entry>
+            {
+                static constexpr WriteFunction Get() { return &Entry::Write; }
+            };
+
+            template <typename Value, Crt::Optional<Value> Model::*Member, typename Codec = FieldCodec<Value>>
+            static constexpr ModelField<Model> Field(const char *name)
+            {
+                return {
+                    name,
+                    &OptionalField<Value, Member, Codec>::Load,
+                    &OptionalField<Value, Member, Codec>::Save,
+                    WriteOf<Streamed, OptionalField<Value, Member, Codec>>::Get(),
+                };
+            }
+
+            template <PackedDateTime Model::*Member> static constexpr ModelField<Model> Timestamp(const char *name)
+            {
+                return {
+                    name,
+                    &TimestampField<Member>::Load,
+                    &TimestampField<Member>::Save,
+                    WriteOf<Streamed, TimestampField<Member>>::Get(),
+                };
+            }
+        };
+
+        /**
+         * Loads every field of `fields` from `doc`, looking each name up once.
+         */
+        template <typename Model, size_t Count>
+        void LoadFields(Model &model, const ModelField<Model> (&fields)[Count], const Crt::JsonView &doc)
+        {
+            for (const ModelField<Model> &field : fields)
+            {
+                field.Load(model, doc.GetJsonObject(field.Name));
+            }
+        }
+
+        /**
+         * Adds every set field of `fields` to `object`.
+         */
+        template <typename Model, size_t Count>
+        void SaveFields(const Model &model, const ModelField<Model> (&fields)[Count], Crt::JsonObject &object)
+        {
+            for (const ModelField<Model> &field : fields)
+            {
+                field.Save(model, field.Name, object);
+            }
+        }
+
+        /**
+         * Writes `model` to `writer` as an object of its set fields.
+         */
+        template <typename Model, size_t Count>
+        void WriteFields(const Model &model, const ModelField<Model> (&fields)[Count], PayloadWriter &writer)
+        {
+            writer.BeginObject();
+            for (const ModelField<Model> &field : fields)
+            {
+                if (field.Write)
+                {
+                    field.Write(model, field.Name, writer);
+                }
+            }
+            writer.EndObject();
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
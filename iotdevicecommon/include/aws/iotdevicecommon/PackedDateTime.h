@@ -0,0 +1,113 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/DateTime.h>
+#include <aws/crt/Optional.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * An optional timestamp of the service models, kept as milliseconds since the epoch in one int64_t.
+         *
+         * A Crt::DateTime carries its broken-down UTC and local times, so building one from each received
+         * timestamp costs a gmtime and a localtime conversion and well over a hundred bytes per field. A
+         * PackedDateTime is set from the payload's seconds with one multiply and builds the DateTime only when
+         * dereferenced. It reads like the Optional<DateTime> it replaces: test it, then use * or ->.
+         */
+        class PackedDateTime final
+        {
+          public:
+            PackedDateTime() noexcept : m_milliseconds(s_unset) {}
+            PackedDateTime(const Crt::DateTime &value) noexcept : m_milliseconds(Pack(value.SecondsWithMSPrecision()))
+            {
+            }
+            PackedDateTime(const PackedDateTime &) = default;
+            PackedDateTime(PackedDateTime &&) = default;
+            PackedDateTime &operator=(const PackedDateTime &) = default;
+            PackedDateTime &operator=(PackedDateTime &&) = default;
+            ~PackedDateTime() = default;
+
+            /**
+             * @return a timestamp of `seconds` since the epoch, the form the service payloads carry, rounded to
+             * the millisecond.
+             */
+            static PackedDateTime FromSeconds(double seconds) noexcept
+            {
+                PackedDateTime packed;
+                packed.m_milliseconds = Pack(seconds);
+                return packed;
+            }
+
+            static PackedDateTime FromMilliseconds(int64_t milliseconds) noexcept
+            {
+                PackedDateTime packed;
+                packed.m_milliseconds = milliseconds;
+                return packed;
+            }
+
+            explicit operator bool() const noexcept { return m_milliseconds != s_unset; }
+            bool has_value() const noexcept { return m_milliseconds != s_unset; }
+            void reset() noexcept { m_milliseconds = s_unset; }
+
+            /**
+             * Builds the DateTime. Only valid if set.
+             */
+            Crt::DateTime operator*() const noexcept { return Crt::DateTime(Seconds()); }
+            Crt::DateTime value() const noexcept { return **this; }
+
+            /**
+             * Holds the DateTime built for one member access, such as Timestamp->ToGmtString().
+             */
+            class Arrow final
+            {
+              public:
+                explicit Arrow(const Crt::DateTime &value) noexcept : m_value(value) {}
+                const Crt::DateTime *operator->() const noexcept { return &m_value; }
+
+              private:
+                Crt::DateTime m_value;
+            };
+
+            Arrow operator->() const noexcept { return Arrow(**this); }
+
+            /**
+             * For code written against Optional<DateTime>.
+             */
+            operator Crt::Optional<Crt::DateTime>() const
+            {
+                return *this ? Crt::Optional<Crt::DateTime>(**this) : Crt::Optional<Crt::DateTime>();
+            }
+
+            /**
+             * @return the timestamp, without building a DateTime. Only valid if set.
+             */
+            int64_t Milliseconds() const noexcept { return m_milliseconds; }
+            double Seconds() const noexcept { return static_cast<double>(m_milliseconds) / 1000.0; }
+
+            bool operator==(const PackedDateTime &rhs) const noexcept { return m_milliseconds == rhs.m_milliseconds; }
+            bool operator!=(const PackedDateTime &rhs) const noexcept { return m_milliseconds != rhs.m_milliseconds; }
+
+          private:
+            /* No payload timestamp is this far before the epoch. */
+            static constexpr int64_t s_unset = (std::numeric_limits<int64_t>::min)();
+
+            static int64_t Pack(double seconds) noexcept
+            {
+                return static_cast<int64_t>(std::llround(seconds * 1000.0));
+            }
+
+            int64_t m_milliseconds;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
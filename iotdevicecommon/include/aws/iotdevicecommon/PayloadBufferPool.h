@@ -0,0 +1,101 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <functional>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Invoked once the SDK no longer reads a caller-owned payload handed to a Publish*Raw call.
+         */
+        using OnPayloadReleased = std::function<void()>;
+
+        /**
+         * A thread-safe free list of payload buffers. Service clients draw outgoing publish payloads from a pool
+         * and return them when the publish completes, so steady-state publishing reuses buffers instead of
+         * allocating and freeing one per message.
+         *
+         * Idle buffers are spread over independently locked stripes, and each thread draws from its own stripe
+         * first, so producer threads publishing concurrently rarely wait on one another.
+         */
+        class AWS_IOTDEVICECOMMON_API PayloadBufferPool final
+        {
+          public:
+            /**
+             * @param maxPooledBuffers the maximum number of idle buffers kept for reuse. Zero disables pooling.
+             * @param maxPooledCapacity buffers that grew beyond this capacity are freed rather than pooled, so a
+             * single oversized payload does not pin memory.
+             * @param allocator allocator used for the buffers; it must outlive the pool.
+             */
+            PayloadBufferPool(
+                size_t maxPooledBuffers,
+                size_t maxPooledCapacity,
+                Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+            ~PayloadBufferPool();
+            PayloadBufferPool(const PayloadBufferPool &) = delete;
+            PayloadBufferPool(PayloadBufferPool &&) = delete;
+            PayloadBufferPool &operator=(const PayloadBufferPool &) = delete;
+            PayloadBufferPool &operator=(PayloadBufferPool &&) = delete;
+
+            /**
+             * Returns a buffer holding a copy of `payload`. On allocation failure the returned buffer has a null
+             * `buffer` pointer.
+             */
+            Crt::ByteBuf NewCopy(const Crt::ByteCursor &payload) noexcept;
+
+            /**
+             * Returns an empty buffer, reused from the pool when possible, for the caller to fill in place (e.g.
+             * with a JsonWriter). On allocation failure the returned buffer has a null `allocator`.
+             */
+            Crt::ByteBuf Acquire(size_t capacityHint = 256) noexcept;
+
+            /**
+             * Returns a buffer obtained from NewCopy or Acquire to the pool, or frees it if the pool is full.
+             */
+            void Release(Crt::ByteBuf &buffer) noexcept;
+
+            /**
+             * Releases `count` buffers at once, taking each stripe lock at most once, e.g. for a batch of
+             * completed publishes.
+             */
+            void Release(Crt::ByteBuf *buffers, size_t count) noexcept;
+
+            /**
+             * @return the number of idle buffers currently held for reuse.
+             */
+            size_t GetPooledCount() const noexcept;
+
+          private:
+            static const size_t MaxStripes = 8;
+
+            struct Stripe
+            {
+                std::mutex Lock;
+                Crt::ByteBuf *FreeBuffers = nullptr;
+                size_t Count = 0;
+                size_t Capacity = 0;
+            };
+
+            bool TakeFrom(Stripe &stripe, bool wait, Crt::ByteBuf &buffer) noexcept;
+            Crt::ByteBuf TakeAny() noexcept;
+
+            Crt::Allocator *m_allocator;
+            size_t m_maxPooledBuffers;
+            size_t m_maxPooledCapacity;
+
+            size_t m_stripeCount;
+            Stripe m_stripes[MaxStripes];
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
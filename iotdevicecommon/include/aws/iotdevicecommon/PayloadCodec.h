@@ -0,0 +1,49 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/CborReader.h>
+#include <aws/iotdevicecommon/CborWriter.h>
+#include <aws/iotdevicecommon/JsonWriter.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Serializes a generated request model into `buffer` using the given encoding.
+         *
+         * @return false if the buffer could not be grown.
+         */
+        template <typename Model>
+        bool SerializePayload(const Model &model, PayloadFormat format, Crt::ByteBuf &buffer) noexcept
+        {
+            if (format == PayloadFormat::Cbor)
+            {
+                CborWriter writer(buffer);
+                model.SerializeTo(writer);
+                return static_cast<bool>(writer);
+            }
+
+            JsonWriter writer(buffer);
+            model.SerializeTo(writer);
+            return static_cast<bool>(writer);
+        }
+
+        /**
+         * Decodes an incoming payload into the document type the generated response models load from.
+         * JSON payloads are staged in `scratch`, which callers keep across messages to reuse its storage.
+         *
+         * @return false if the payload could not be decoded.
+         */
+        bool AWS_IOTDEVICECOMMON_API ParsePayload(
+            const Crt::ByteBuf &payload,
+            PayloadFormat format,
+            Crt::String &scratch,
+            Crt::JsonObject &document);
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
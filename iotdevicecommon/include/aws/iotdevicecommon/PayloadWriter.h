@@ -0,0 +1,83 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/FlatStringMap.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Wire encoding of service client payloads.
+         */
+        enum class PayloadFormat
+        {
+            /**
+             * UTF-8 JSON. The only encoding accepted by the AWS IoT service topics.
+             */
+            Json,
+
+            /**
+             * CBOR (RFC 8949), for topics bridged to a peer that accepts binary payloads.
+             */
+            Cbor,
+        };
+
+        /**
+         * Streaming encoder that request models serialize themselves into, without building a document tree.
+         *
+         * Callers are responsible for balancing Begin/End calls and for writing a key before each object
+         * member. The first failure is sticky: later writes are ignored and operator bool returns false.
+         */
+        class AWS_IOTDEVICECOMMON_API PayloadWriter
+        {
+          public:
+            virtual ~PayloadWriter() = default;
+
+            virtual PayloadWriter &BeginObject() noexcept = 0;
+            virtual PayloadWriter &EndObject() noexcept = 0;
+            virtual PayloadWriter &BeginArray() noexcept = 0;
+            virtual PayloadWriter &EndArray() noexcept = 0;
+
+            virtual PayloadWriter &Key(const char *key) noexcept = 0;
+            virtual PayloadWriter &Key(const Crt::String &key) noexcept = 0;
+
+            virtual PayloadWriter &String(const char *value) noexcept = 0;
+            virtual PayloadWriter &String(const Crt::String &value) noexcept = 0;
+            /* For the caller-owned strings of the request views. */
+            virtual PayloadWriter &String(const Crt::ByteCursor &value) noexcept = 0;
+            virtual PayloadWriter &Bool(bool value) noexcept = 0;
+            virtual PayloadWriter &Integer(int32_t value) noexcept = 0;
+            virtual PayloadWriter &Int64(int64_t value) noexcept = 0;
+            virtual PayloadWriter &Double(double value) noexcept = 0;
+            virtual PayloadWriter &Null() noexcept = 0;
+
+            /**
+             * Writes a caller-owned JSON value, e.g. the desired/reported documents of a shadow state.
+             */
+            virtual PayloadWriter &Value(const Crt::JsonView &value) noexcept = 0;
+
+            /**
+             * Writes a string map as an object of string members.
+             */
+            PayloadWriter &StringMap(const Crt::Map<Crt::String, Crt::String> &value) noexcept;
+            PayloadWriter &StringMap(const FlatStringMap &value) noexcept;
+
+            /**
+             * @return false if any write failed.
+             */
+            virtual operator bool() const noexcept = 0;
+
+          protected:
+            PayloadWriter() = default;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
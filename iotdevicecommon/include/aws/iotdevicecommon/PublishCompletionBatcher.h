@@ -0,0 +1,146 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/InlineFunction.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        class PayloadBufferPool;
+
+        /**
+         * The outcome of one publish delivered in a batch.
+         */
+        struct PublishResult
+        {
+            uint16_t PacketId;
+            int ErrorCode;
+        };
+
+        /**
+         * Receives every publish completed in one batch, after their own completions ran.
+         */
+        using OnPublishBatchComplete = std::function<void(const PublishResult *results, size_t count)>;
+
+        class AWS_IOTDEVICECOMMON_API PublishCompletionBatcherConfig final
+        {
+          public:
+            PublishCompletionBatcherConfig() noexcept;
+            PublishCompletionBatcherConfig(const PublishCompletionBatcherConfig &rhs) = default;
+            PublishCompletionBatcherConfig(PublishCompletionBatcherConfig &&rhs) = default;
+
+            PublishCompletionBatcherConfig &operator=(const PublishCompletionBatcherConfig &rhs) = default;
+            PublishCompletionBatcherConfig &operator=(PublishCompletionBatcherConfig &&rhs) = default;
+
+            ~PublishCompletionBatcherConfig() = default;
+
+            /**
+             * Event loop group the batches are delivered on. Use the connection's, with a single loop, to batch
+             * exactly the completions of one event loop tick.
+             * Required.
+             */
+            Crt::Io::EventLoopGroup *EventLoopGroup;
+
+            /**
+             * Invoked with each batch. Optional.
+             */
+            OnPublishBatchComplete OnBatchComplete;
+        };
+
+        /**
+         * Collects the PUBACK completions of the service clients' publishes and delivers them together, from one
+         * task run at the end of the event loop tick they arrived in, instead of each completion returning its
+         * buffer to the pool and invoking its OnPublishComplete in the connection's callback.
+         *
+         * A batch first returns all its buffers to their pool at once, taking each pool stripe lock once rather
+         * than once per buffer, then invokes each publish's completion in the order they arrived, then
+         * OnBatchComplete with the results of the whole batch.
+         *
+         * Service clients given one in ServiceClientConfig::CompletionBatcher route their publish completions
+         * through it. May be shared between clients and connections.
+         */
+        class AWS_IOTDEVICECOMMON_API PublishCompletionBatcher final
+            : public std::enable_shared_from_this<PublishCompletionBatcher>
+        {
+          public:
+            using OnCompletion = InlineFunction<void(int errorCode)>;
+
+            PublishCompletionBatcher(const PublishCompletionBatcher &) = delete;
+            PublishCompletionBatcher(PublishCompletionBatcher &&) = delete;
+            PublishCompletionBatcher &operator=(const PublishCompletionBatcher &) = delete;
+            PublishCompletionBatcher &operator=(PublishCompletionBatcher &&) = delete;
+
+            ~PublishCompletionBatcher();
+
+            /**
+             * Adds a completed publish to the current batch: `payload`, if it has an allocator, goes back to
+             * `pool`, and `onCompletion`, if set, is invoked with `errorCode` when the batch is delivered. Should
+             * no batch task be scheduled, the completion is delivered at once as a batch of its own.
+             */
+            void Add(
+                uint16_t packetId,
+                int errorCode,
+                const std::shared_ptr<PayloadBufferPool> &pool,
+                const Crt::ByteBuf &payload,
+                const OnCompletion &onCompletion);
+
+            /**
+             * Delivers the current batch now.
+             */
+            void Flush();
+
+            /**
+             * @return the number of batches delivered so far.
+             */
+            uint64_t GetBatchCount() const;
+
+            /**
+             * @return the number of completions delivered so far, over all batches.
+             */
+            uint64_t GetCompletionCount() const;
+
+            static std::shared_ptr<PublishCompletionBatcher> Create(
+                const PublishCompletionBatcherConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Completion
+            {
+                std::shared_ptr<PayloadBufferPool> Pool;
+                Crt::ByteBuf Payload;
+                OnCompletion Handler;
+            };
+
+            /* The flush task, defined with the implementation. */
+            struct FlushTask;
+
+            PublishCompletionBatcher(
+                const PublishCompletionBatcherConfig &config,
+                aws_event_loop *eventLoop,
+                Crt::Allocator *allocator) noexcept;
+
+            PublishCompletionBatcherConfig m_config;
+            aws_event_loop *m_eventLoop;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Vector<Completion> m_completions;
+            Crt::Vector<PublishResult> m_results;
+            bool m_flushScheduled;
+            uint64_t m_batchCount;
+            uint64_t m_completionCount;
+        };
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,136 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        /**
+         * The lane a service client publish travels in.
+         */
+        enum class PublishPriority
+        {
+            /** Job execution updates, provisioning requests, shadow gets and deletes: never held back. */
+            Control,
+            /** Shadow updates: held back while the connection has MaxInFlight publishes outstanding. */
+            Telemetry,
+        };
+
+        class AWS_IOTDEVICECOMMON_API PublishLanesConfig final
+        {
+          public:
+            PublishLanesConfig() noexcept;
+            PublishLanesConfig(const PublishLanesConfig &rhs) = default;
+            PublishLanesConfig(PublishLanesConfig &&rhs) = default;
+
+            PublishLanesConfig &operator=(const PublishLanesConfig &rhs) = default;
+            PublishLanesConfig &operator=(PublishLanesConfig &&rhs) = default;
+
+            ~PublishLanesConfig() = default;
+
+            /**
+             * The connection the lanes admit publishes to; held weakly. Every client given the lanes must
+             * publish on it.
+             * Required.
+             */
+            std::shared_ptr<Crt::Mqtt::MqttConnection> Connection;
+
+            /**
+             * Outstanding publishes, of both lanes, above which telemetry publishes are held back. Defaults to 8.
+             */
+            size_t MaxInFlight;
+
+            /**
+             * The most telemetry publishes held back at once; publishes beyond it are refused. Zero, the
+             * default, means no cap.
+             */
+            size_t MaxQueued;
+        };
+
+        /**
+         * Admission of the service clients' publishes to one connection in two priority classes, so control
+         * plane publishes do not queue behind bulk telemetry when the connection is congested.
+         *
+         * The MQTT client sends publishes in the order it was given them. The lanes count every publish handed
+         * to it that has not completed yet, and once MaxInFlight are outstanding, hold telemetry publishes back
+         * in order, sending the oldest as each outstanding publish completes. Control publishes are always
+         * handed over at once, so at most MaxInFlight telemetry publishes are ever queued ahead of one.
+         *
+         * Service clients given one in ServiceClientConfig::PublishLanes route their publishes through it.
+         * Share one instance between every client on the connection.
+         */
+        class AWS_IOTDEVICECOMMON_API PublishLanes final
+        {
+          public:
+            /**
+             * Sends a held back publish on `connection`, or fails it if the connection is gone (null).
+             */
+            using DeferredPublish = std::function<void(Crt::Mqtt::MqttConnection *connection)>;
+
+            PublishLanes(const PublishLanes &) = delete;
+            PublishLanes(PublishLanes &&) = delete;
+            PublishLanes &operator=(const PublishLanes &) = delete;
+            PublishLanes &operator=(PublishLanes &&) = delete;
+
+            /**
+             * Fails every held back publish.
+             */
+            ~PublishLanes();
+
+            /**
+             * Counts a publish of `priority` as outstanding if it may be sent now. Each successful call must be
+             * matched by a Release once the publish completes or is refused.
+             *
+             * @return false if a telemetry publish must be deferred instead.
+             */
+            bool TryAcquire(PublishPriority priority);
+
+            /**
+             * Holds a telemetry publish back until there is room, or runs it at once if room has freed up since
+             * TryAcquire. Either way it is counted as outstanding when it runs, and must Release then.
+             *
+             * @return false, with AWS_ERROR_LIST_EXCEEDS_MAX_SIZE raised, if MaxQueued publishes are held.
+             */
+            bool Defer(DeferredPublish &&publish);
+
+            /**
+             * Ends an outstanding publish, sending held back telemetry into the room it leaves.
+             */
+            void Release();
+
+            size_t GetInFlightCount() const;
+            size_t GetQueuedCount() const;
+
+            /**
+             * @return the number of telemetry publishes held back so far.
+             */
+            uint64_t GetDeferredCount() const;
+
+            static std::shared_ptr<PublishLanes> Create(
+                const PublishLanesConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            PublishLanes(const PublishLanesConfig &config, Crt::Allocator *allocator) noexcept;
+
+            std::weak_ptr<Crt::Mqtt::MqttConnection> m_connection;
+            size_t m_maxInFlight;
+            size_t m_maxQueued;
+
+            mutable std::mutex m_lock;
+            Crt::List<DeferredPublish> m_queued;
+            size_t m_inFlight;
+            uint64_t m_deferredCount;
+        };
+    } // namespace Iotdevicecommon
+} // namespace Aws
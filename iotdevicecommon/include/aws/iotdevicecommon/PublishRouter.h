@@ -0,0 +1,176 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/DurablePublishQueue.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        enum class PublishRoute
+        {
+            Cloud,
+            LocalCore,
+            /* Neither connection is up: publishes go to the offline queue. */
+            Offline,
+        };
+
+        /**
+         * Invoked when publishes start taking `route`. `errorCode` is why the previous route was left, or
+         * AWS_ERROR_SUCCESS if `route` was chosen for being faster or for coming back up.
+         */
+        using OnRouteChanged = std::function<void(PublishRoute route, int errorCode)>;
+
+        class AWS_IOTDEVICECOMMON_API PublishRouterConfig final
+        {
+          public:
+            PublishRouterConfig() noexcept;
+            PublishRouterConfig(const PublishRouterConfig &rhs) = default;
+            PublishRouterConfig(PublishRouterConfig &&rhs) = default;
+
+            PublishRouterConfig &operator=(const PublishRouterConfig &rhs) = default;
+            PublishRouterConfig &operator=(PublishRouterConfig &&rhs) = default;
+
+            ~PublishRouterConfig() = default;
+
+            /**
+             * The connection to AWS IoT Core. Required.
+             */
+            std::shared_ptr<Crt::Mqtt::MqttConnection> Cloud;
+
+            /**
+             * The connection to the Greengrass core, e.g. to an endpoint of a DiscoverResponse. Required.
+             */
+            std::shared_ptr<Crt::Mqtt::MqttConnection> LocalCore;
+
+            /**
+             * Where publishes wait while neither connection is up, and drain from once one is. Optional. When
+             * unset, a publish made while both are down fails with AWS_ERROR_MQTT_NOT_CONNECTED.
+             */
+            std::shared_ptr<DurablePublishQueue> OfflineQueue;
+
+            /**
+             * How much faster, in milliseconds, the other route must complete publishes than the current one
+             * for traffic to move to it while both are up, so jitter does not move it back and forth.
+             * Defaults to 20.
+             */
+            uint32_t SwitchMarginMs;
+
+            /**
+             * While both routes are up, every ProbeInterval-th publish takes the other route, so its latency
+             * stays measured. Zero disables probing, which leaves traffic on the current route while it is up.
+             * Defaults to 32.
+             */
+            uint32_t ProbeInterval;
+
+            /**
+             * Invoked on every change of route. Optional.
+             */
+            Iotdevicecommon::OnRouteChanged OnRouteChanged;
+        };
+
+        /**
+         * Routes publishes between a connection to AWS IoT Core and one to a Greengrass core, for devices
+         * that reach both: publishes take whichever connection is up, and the faster one, by the time each
+         * takes to complete publishes, while both are. A publish that fails on one connection is sent again
+         * on the other, or queued in the offline queue if that is down too, so connection failures lose none.
+         *
+         * While the offline queue holds publishes, new ones are queued behind them, so they are delivered in
+         * order; the queue drains on the current route and follows it when the route changes.
+         *
+         * Messages are routed, not deduplicated: a publish whose completion was lost with a connection may
+         * arrive twice, once per route, so subscribers must tolerate duplicates, as with any QoS 1 publish.
+         *
+         * Create chains into the connections' OnConnectionCompleted, OnConnectionInterrupted,
+         * OnConnectionResumed and OnDisconnect handlers, so set those before creating the router. Both
+         * connections are taken to be up when it is created, with the local core's, the nearer one, carrying
+         * traffic first; one that is not up is marked down by its first failed publish, and up again once it
+         * reports connecting or resuming.
+         */
+        class AWS_IOTDEVICECOMMON_API PublishRouter final : public std::enable_shared_from_this<PublishRouter>
+        {
+          public:
+            PublishRouter(const PublishRouter &) = delete;
+            PublishRouter(PublishRouter &&) = delete;
+            PublishRouter &operator=(const PublishRouter &) = delete;
+            PublishRouter &operator=(PublishRouter &&) = delete;
+
+            ~PublishRouter() = default;
+
+            /**
+             * Publishes `payload` on the current route. `onComplete` is invoked once, when the publish
+             * completed on either connection, was queued and delivered, or failed everywhere it could go.
+             *
+             * @return false, with the error raised, if the publish could neither be sent nor queued.
+             */
+            bool Publish(
+                const char *topic,
+                Crt::Mqtt::QOS qos,
+                const Crt::ByteBuf &payload,
+                DurablePublishQueue::OnDelivered &&onComplete = DurablePublishQueue::OnDelivered());
+
+            PublishRoute GetRoute() const;
+
+            /**
+             * @return the smoothed time publishes on `route` took to complete, in milliseconds, or 0 if none
+             * has yet.
+             */
+            double GetLatencyMs(PublishRoute route) const;
+
+            /**
+             * @return the router, or null with AWS_ERROR_INVALID_ARGUMENT raised if either connection is missing
+             * or both are the same.
+             */
+            static std::shared_ptr<PublishRouter> Create(
+                const PublishRouterConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Attempt;
+
+            PublishRouter(const PublishRouterConfig &config, Crt::Allocator *allocator) noexcept;
+
+            void Chain(size_t index);
+            void OnUp(size_t index);
+            void OnDown(size_t index, int errorCode);
+
+            /* Requires m_lock. Picks the route from what is up and how fast, and notes a change in `changed`. */
+            PublishRoute ChooseLocked(bool &changed);
+            /* Points the offline queue at `route`, and reports it if `changed`; called without m_lock. */
+            void Follow(PublishRoute route, bool changed, int errorCode);
+
+            /* Sends on `route`, falling back to the other connection and then the queue if it is refused. */
+            bool Send(const std::shared_ptr<Attempt> &attempt, PublishRoute route);
+            void OnAttemptComplete(
+                const std::shared_ptr<Attempt> &attempt,
+                size_t index,
+                uint64_t startNs,
+                int errorCode);
+            bool Queue(const std::shared_ptr<Attempt> &attempt);
+
+            Crt::Allocator *m_allocator;
+            std::shared_ptr<Crt::Mqtt::MqttConnection> m_connections[2];
+            std::shared_ptr<DurablePublishQueue> m_offlineQueue;
+            uint64_t m_switchMarginNs;
+            uint32_t m_probeInterval;
+            Iotdevicecommon::OnRouteChanged m_onRouteChanged;
+
+            mutable std::mutex m_lock;
+            bool m_up[2];
+            /* Smoothed publish completion time of each connection, in nanoseconds; 0 until measured. */
+            double m_latencyNs[2];
+            PublishRoute m_route;
+            uint64_t m_publishCount;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,135 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        class AWS_IOTDEVICECOMMON_API PublishSchedulerConfig final
+        {
+          public:
+            PublishSchedulerConfig() noexcept;
+            PublishSchedulerConfig(const PublishSchedulerConfig &rhs) = default;
+            PublishSchedulerConfig(PublishSchedulerConfig &&rhs) = default;
+
+            PublishSchedulerConfig &operator=(const PublishSchedulerConfig &rhs) = default;
+            PublishSchedulerConfig &operator=(PublishSchedulerConfig &&rhs) = default;
+
+            ~PublishSchedulerConfig() = default;
+
+            /**
+             * Event loop group the transmission windows are timed on.
+             * Required.
+             */
+            Crt::Io::EventLoopGroup *EventLoopGroup;
+
+            /**
+             * Length, in milliseconds, of the transmission window. Held publishes are sent together at the
+             * next multiple of it on the monotonic clock, so every scheduler in the process with the same
+             * window wakes the radio at the same moments.
+             */
+            uint32_t WindowMs;
+
+            /**
+             * The most publishes held at once; publishes beyond it are refused. Zero means no cap.
+             */
+            size_t MaxQueued;
+        };
+
+        /**
+         * Holds non-urgent publishes and sends them in batches, so a battery-powered device wakes its radio
+         * once per window rather than once per publish. A publish may carry a deadline, in which case the
+         * batch goes out early enough to meet it; whatever else is held goes with it, since the radio is
+         * awake by then anyway. Flush does the same on demand, e.g. just after an urgent publish.
+         *
+         * Service clients given one in ServiceClientConfig::PublishScheduler route their shadow update and
+         * job execution update publishes through it. May be shared between clients and connections.
+         */
+        class AWS_IOTDEVICECOMMON_API PublishScheduler final : public std::enable_shared_from_this<PublishScheduler>
+        {
+          public:
+            using OnPublished = std::function<void(int errorCode)>;
+
+            PublishScheduler(const PublishScheduler &) = delete;
+            PublishScheduler(PublishScheduler &&) = delete;
+            PublishScheduler &operator=(const PublishScheduler &) = delete;
+            PublishScheduler &operator=(PublishScheduler &&) = delete;
+
+            ~PublishScheduler() = default;
+
+            /**
+             * Holds a copy of the publish until the next window, or until `deadlineMs` from now if that is
+             * sooner. A `deadlineMs` of 0 means no deadline. `onPublished` is invoked when the publish
+             * completes.
+             *
+             * @return false, with AWS_ERROR_LIST_EXCEEDS_MAX_SIZE raised, if MaxQueued publishes are held.
+             */
+            bool Schedule(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                const char *topic,
+                Crt::Mqtt::QOS qos,
+                const Crt::ByteBuf &payload,
+                OnPublished &&onPublished,
+                uint32_t deadlineMs = 0);
+
+            /**
+             * Sends everything held now.
+             */
+            void Flush();
+
+            size_t GetQueuedCount() const;
+
+            /**
+             * @return the number of batches sent so far.
+             */
+            uint64_t GetBatchCount() const;
+
+            static std::shared_ptr<PublishScheduler> Create(
+                const PublishSchedulerConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Held
+            {
+                std::shared_ptr<Crt::Mqtt::MqttConnection> Connection;
+                Crt::String Topic;
+                Crt::Mqtt::QOS Qos;
+                Crt::String Payload;
+                OnPublished Handler;
+            };
+
+            /* The timer task, defined with the implementation. */
+            struct WakeTask;
+
+            PublishScheduler(const PublishSchedulerConfig &config, aws_event_loop *eventLoop, Crt::Allocator *allocator)
+                noexcept;
+
+            /* Requires m_lock. Arms a wake-up at `wakeAtNs` unless one is armed no later; false if it cannot. */
+            bool ArmLocked(uint64_t wakeAtNs);
+            void OnWake(uint64_t wakeAtNs);
+
+            PublishSchedulerConfig m_config;
+            aws_event_loop *m_eventLoop;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Vector<std::shared_ptr<Held>> m_held;
+            /* Event loop clock time the next batch goes out at; 0 while nothing is held. */
+            uint64_t m_wakeAtNs;
+            uint64_t m_batchCount;
+        };
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,97 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        /**
+         * The classes of service client operation a QosPolicy sets the QoS of. Named shadow operations share
+         * the class of their classic counterparts.
+         */
+        enum class QosOperation
+        {
+            /* Shadow update publishes, typically reported state sent at a high rate. */
+            ShadowUpdate,
+            /* Subscriptions to the update accepted and rejected responses. */
+            ShadowUpdateResponses,
+            /* Shadow get and delete publishes. */
+            ShadowRequest,
+            /* Subscriptions to the get and delete accepted and rejected responses. */
+            ShadowRequestResponses,
+            /* Subscriptions to the delta and updated events, and to raw shadow topics. */
+            ShadowEvents,
+            /* Job execution update publishes, which report job status. */
+            JobsUpdate,
+            /* Get pending, describe and start next publishes. */
+            JobsRequest,
+            /* Subscriptions to the jobs accepted and rejected responses. */
+            JobsResponses,
+            /* Subscriptions to the job executions changed and next job execution changed events, and to raw
+             * jobs topics. */
+            JobsEvents,
+            /* Every fleet provisioning publish and subscription. */
+            Provisioning,
+        };
+
+        /**
+         * The QoS each class of service client operation is sent or subscribed with, configured once in
+         * ServiceClientConfig rather than at every call. An operation class the policy sets overrides the QoS
+         * passed to the Publish* or Subscribe* call; one it leaves unset keeps the QoS of the call.
+         *
+         * QoS 0 spares the PUBACK of every message, which for frequent reported telemetry is most of the
+         * acknowledgement traffic, at the cost of losing the messages sent while a connection drops; keep
+         * QoS 1 for what must arrive, such as job status and provisioning.
+         */
+        class AWS_IOTDEVICECOMMON_API QosPolicy final
+        {
+          public:
+            static const size_t OperationCount = 10;
+
+            /**
+             * A policy that sets no operation class, so every call keeps its own QoS.
+             */
+            QosPolicy() noexcept;
+            QosPolicy(const QosPolicy &rhs) = default;
+            QosPolicy(QosPolicy &&rhs) = default;
+
+            QosPolicy &operator=(const QosPolicy &rhs) = default;
+            QosPolicy &operator=(QosPolicy &&rhs) = default;
+
+            ~QosPolicy() = default;
+
+            /**
+             * QoS 0 for shadow updates and their responses; QoS 1 for every jobs and provisioning operation.
+             * Other shadow operations keep the QoS of the call.
+             */
+            static QosPolicy Recommended() noexcept;
+
+            /**
+             * Sends or subscribes every operation of class `operation` with `qos`. QoS 2 is not supported by
+             * AWS IoT Core and is sent as QoS 1.
+             */
+            QosPolicy &Set(QosOperation operation, Crt::Mqtt::QOS qos) noexcept;
+
+            /**
+             * Makes operations of class `operation` keep the QoS of the call again.
+             */
+            QosPolicy &Clear(QosOperation operation) noexcept;
+
+            /**
+             * @return the QoS an operation of class `operation` called with `requested` goes out with.
+             */
+            Crt::Mqtt::QOS Resolve(QosOperation operation, Crt::Mqtt::QOS requested) const noexcept;
+
+          private:
+            /* Indexed by QosOperation; -1 where the call's QoS stands. */
+            int8_t m_qos[OperationCount];
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,194 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        /**
+         * The service APIs a RequestRateLimiter paces, each against its own rate.
+         */
+        enum class RateLimitedApi
+        {
+            /** Shadow get, update and delete requests, paced per thing. */
+            Shadow,
+            /** Jobs API requests, paced per thing. */
+            Jobs,
+            /** Fleet provisioning requests, paced across the account. */
+            Provisioning,
+        };
+
+        /**
+         * A token bucket: requests are let through at PerSecond on average, in bursts of up to Burst.
+         */
+        struct AWS_IOTDEVICECOMMON_API RequestRate
+        {
+            double PerSecond;
+            uint32_t Burst;
+        };
+
+        class AWS_IOTDEVICECOMMON_API RequestRateLimiterConfig final
+        {
+          public:
+            RequestRateLimiterConfig() noexcept;
+            RequestRateLimiterConfig(const RequestRateLimiterConfig &rhs) = default;
+            RequestRateLimiterConfig(RequestRateLimiterConfig &&rhs) = default;
+
+            RequestRateLimiterConfig &operator=(const RequestRateLimiterConfig &rhs) = default;
+            RequestRateLimiterConfig &operator=(RequestRateLimiterConfig &&rhs) = default;
+
+            ~RequestRateLimiterConfig() = default;
+
+            /**
+             * Event loop group the queued requests are released on.
+             * Required.
+             */
+            Crt::Io::EventLoopGroup *EventLoopGroup;
+
+            /**
+             * Rate of shadow requests to each thing. Defaults to 10 per second in bursts of 10.
+             */
+            RequestRate Shadow;
+
+            /**
+             * Rate of jobs requests for each thing. Defaults to 10 per second in bursts of 10.
+             */
+            RequestRate Jobs;
+
+            /**
+             * Rate of fleet provisioning requests overall. Defaults to 10 per second in bursts of 10.
+             */
+            RequestRate Provisioning;
+
+            /**
+             * The most requests queued at once, over every bucket; requests beyond it are refused. Zero, the
+             * default, means no cap.
+             */
+            size_t MaxQueued;
+
+            /**
+             * Whether a request queued behind another to the same topic replaces its payload instead of
+             * queueing after it; the replaced request then completes with the outcome of the one that
+             * replaced it. Suits shadow updates that each carry the whole reported state. Defaults to false.
+             */
+            bool CoalesceByTopic;
+        };
+
+        /**
+         * Paces the service clients' requests to stay within the AWS IoT service limits, rather than relying
+         * on the service to throttle them: a token bucket per API and thing, for the provisioning API one for
+         * the account. A request without a token left is queued, with a copy of its payload, and published in
+         * order as the bucket refills.
+         *
+         * Set the rates from the account's service quotas, below them by the margin other clients of the
+         * account need. Service clients given one in ServiceClientConfig::RateLimiter pace every publish
+         * through it. Share one instance between every client in the process.
+         */
+        class AWS_IOTDEVICECOMMON_API RequestRateLimiter final : public std::enable_shared_from_this<RequestRateLimiter>
+        {
+          public:
+            using OnPublished = std::function<void(int errorCode)>;
+
+            RequestRateLimiter(const RequestRateLimiter &) = delete;
+            RequestRateLimiter(RequestRateLimiter &&) = delete;
+            RequestRateLimiter &operator=(const RequestRateLimiter &) = delete;
+            RequestRateLimiter &operator=(RequestRateLimiter &&) = delete;
+
+            ~RequestRateLimiter() = default;
+
+            /**
+             * Takes a token for a request of `api` to `topic`, whose thing picks the bucket.
+             *
+             * @return false if the bucket is spent or has requests queued; the request must be queued instead.
+             */
+            bool TryAcquire(RateLimitedApi api, const char *topic);
+
+            /**
+             * Queues a copy of the publish until its bucket has a token for it. `onPublished` is invoked when the
+             * publish completes.
+             *
+             * @return false, with AWS_ERROR_LIST_EXCEEDS_MAX_SIZE raised, if MaxQueued requests are queued.
+             */
+            bool Enqueue(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                RateLimitedApi api,
+                const char *topic,
+                Crt::Mqtt::QOS qos,
+                const Crt::ByteBuf &payload,
+                OnPublished &&onPublished);
+
+            size_t GetQueuedCount() const;
+
+            /**
+             * @return the number of requests queued so far, including coalesced ones.
+             */
+            uint64_t GetDelayedCount() const;
+
+            /**
+             * @return the number of queued requests replaced by a later one to the same topic.
+             */
+            uint64_t GetCoalescedCount() const;
+
+            static std::shared_ptr<RequestRateLimiter> Create(
+                const RequestRateLimiterConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Held
+            {
+                std::shared_ptr<Crt::Mqtt::MqttConnection> Connection;
+                Crt::String Topic;
+                Crt::Mqtt::QOS Qos;
+                Crt::String Payload;
+                OnPublished Handler;
+            };
+
+            struct Bucket
+            {
+                RequestRate Rate;
+                double Tokens;
+                uint64_t RefilledAtNs;
+                Crt::List<std::shared_ptr<Held>> Queued;
+            };
+
+            /* The timer task, defined with the implementation. */
+            struct WakeTask;
+
+            RequestRateLimiter(
+                const RequestRateLimiterConfig &config,
+                aws_event_loop *eventLoop,
+                Crt::Allocator *allocator) noexcept;
+
+            /* Requires m_lock. The bucket of `topic` for `api`, refilled up to `nowNs`. */
+            Bucket &BucketLocked(RateLimitedApi api, const char *topic, uint64_t nowNs);
+            /* Requires m_lock. Arms a wake-up at `wakeAtNs` unless one is armed no later; false if it cannot. */
+            bool ArmLocked(uint64_t wakeAtNs);
+            void OnWake(uint64_t wakeAtNs);
+
+            RequestRateLimiterConfig m_config;
+            aws_event_loop *m_eventLoop;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, Bucket> m_buckets;
+            size_t m_queued;
+            /* Event loop clock time of the next release; 0 while nothing is queued. */
+            uint64_t m_wakeAtNs;
+            uint64_t m_delayedCount;
+            uint64_t m_coalescedCount;
+        };
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,218 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Optional.h>
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/ServiceMetrics.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * The spans a traced request is split into. Request spans the others.
+         */
+        enum class RequestStage
+        {
+            /** From the Publish* call until the response handler returns, or the request fails. */
+            Request,
+            /** Encoding the request payload. */
+            Serialize,
+            /** From handing the publish to the connection until its PUBACK: client queueing and the network. */
+            Publish,
+            /** From the PUBACK until the accepted or rejected response arrives. */
+            Service,
+            /** Decoding the response payload. */
+            Parse,
+            /** The response handler, parsing included. */
+            Handler,
+        };
+
+        /**
+         * Span hooks around the requests the service clients publish, for feeding a tracing pipeline such as
+         * OpenTelemetry. Every callback for one request carries the same trace id, and `topic` is always the
+         * request's publish topic. Callbacks run on whichever thread reached that point (the caller's, the
+         * event loop's or the handler executor's) and must not block.
+         *
+         * A response is matched to its request by topic and, where the request had one, client token; requests
+         * without a token (identity) are matched oldest first. Requests whose response never arrives, e.g.
+         * because nothing subscribed to it, are ended with AWS_ERROR_MQTT_TIMEOUT once `maxPendingRequests`
+         * newer ones are waiting.
+         *
+         * The time from each Publish* call to the arrival of its response is also recorded, without locking,
+         * into GetResponseLatency's histogram; with both callbacks empty the tracer records only that.
+         */
+        class AWS_IOTDEVICECOMMON_API RequestTracer final
+        {
+          public:
+            using OnSpanStart = std::function<void(uint64_t traceId, RequestStage stage, const Crt::String &topic)>;
+            using OnSpanEnd =
+                std::function<void(uint64_t traceId, RequestStage stage, const Crt::String &topic, int errorCode)>;
+
+            RequestTracer(OnSpanStart &&onSpanStart, OnSpanEnd &&onSpanEnd, size_t maxPendingRequests = 256) noexcept;
+            RequestTracer(const RequestTracer &) = delete;
+            RequestTracer(RequestTracer &&) = delete;
+            RequestTracer &operator=(const RequestTracer &) = delete;
+            RequestTracer &operator=(RequestTracer &&) = delete;
+
+            /**
+             * Traces a response handler on the calling thread, if the message is the response to a pending
+             * request. Inert when `tracer` is null.
+             */
+            class AWS_IOTDEVICECOMMON_API ResponseScope final
+            {
+              public:
+                ResponseScope(RequestTracer *tracer, const Crt::String &topic, const Crt::ByteBuf &payload);
+                ~ResponseScope();
+                ResponseScope(const ResponseScope &) = delete;
+                ResponseScope &operator=(const ResponseScope &) = delete;
+
+                void StartParse();
+                void EndParse(int errorCode);
+
+                /**
+                 * @return the innermost active scope on the calling thread, or null.
+                 */
+                static ResponseScope *Current() noexcept;
+
+              private:
+                RequestTracer *m_tracer;
+                uint64_t m_traceId;
+                Crt::String m_requestTopic;
+                ResponseScope *m_outer;
+            };
+
+            /**
+             * @return the time from each matched request's Publish* call to its response's arrival.
+             */
+            LogLinearHistogram GetResponseLatency() const noexcept { return m_responseLatency.GetSnapshot(); }
+
+          private:
+            friend class RequestTrace;
+
+            enum class PendingStage
+            {
+                Serializing,
+                Publishing,
+                AwaitingResponse,
+            };
+
+            struct PendingRequest
+            {
+                uint64_t TraceId;
+                Crt::String Topic;
+                Crt::Optional<Crt::String> ClientToken;
+                PendingStage Stage;
+                uint64_t StartNs = 0;
+            };
+
+            uint64_t StartRequest(const Crt::String &topic, const Crt::Optional<Crt::String> *clientToken);
+            void EndSerialize(uint64_t traceId, const Crt::String &topic, int errorCode);
+            void EndPublish(uint64_t traceId, const Crt::String &topic, int errorCode);
+            uint64_t MatchResponse(const Crt::String &requestTopic, const Crt::ByteBuf &payload);
+
+            OnSpanStart m_onSpanStart;
+            OnSpanEnd m_onSpanEnd;
+            size_t m_maxPendingRequests;
+
+            std::mutex m_lock;
+            uint64_t m_nextTraceId;
+            /* In start order, so the first match on a topic is the oldest. */
+            Crt::Vector<PendingRequest> m_pending;
+            ConcurrentHistogram m_responseLatency;
+        };
+
+        /**
+         * The trace of one Publish* call; inert when the client has no tracer. Construct it just before
+         * serializing the request.
+         */
+        class AWS_IOTDEVICECOMMON_API RequestTrace final
+        {
+          public:
+            template <typename Model>
+            RequestTrace(const std::shared_ptr<RequestTracer> &tracer, const char *topic, const Model &request)
+                : RequestTrace(tracer, topic, s_clientTokenOf(request, 0))
+            {
+            }
+            RequestTrace(
+                const std::shared_ptr<RequestTracer> &tracer,
+                const char *topic,
+                const Crt::Optional<Crt::String> *clientToken);
+            RequestTrace(const RequestTrace &) = delete;
+            RequestTrace &operator=(const RequestTrace &) = delete;
+
+            /**
+             * Ends the Serialize span, and the whole request if serialization failed.
+             *
+             * @return `serialized`.
+             */
+            bool EndSerialize(bool serialized);
+
+            /**
+             * The open Publish span of a request, ended from the publish's completion.
+             */
+            class AWS_IOTDEVICECOMMON_API PublishSpan final
+            {
+              public:
+                void End(int errorCode) const;
+
+              private:
+                friend class RequestTrace;
+
+                std::shared_ptr<RequestTracer> m_tracer;
+                uint64_t m_traceId;
+                Crt::String m_topic;
+            };
+
+            /**
+             * Starts the Publish span.
+             */
+            PublishSpan StartPublish();
+
+            /**
+             * Ends the Publish span, and the request if the publish failed or the connection refused it.
+             */
+            void EndPublish(int errorCode);
+
+            bool IsActive() const noexcept { return m_traceId != 0; }
+
+          private:
+            template <typename Model>
+            static auto s_clientTokenOf(const Model &request, int) -> decltype(&request.ClientToken)
+            {
+                return &request.ClientToken;
+            }
+            template <typename Model> static const Crt::Optional<Crt::String> *s_clientTokenOf(const Model &, long)
+            {
+                return nullptr;
+            }
+
+            std::shared_ptr<RequestTracer> m_tracer;
+            uint64_t m_traceId;
+            Crt::String m_topic;
+        };
+
+        /**
+         * As PublishWithMetrics above, also tracing the Publish span and starting the Service span on PUBACK.
+         */
+        AWS_IOTDEVICECOMMON_API uint16_t PublishWithMetrics(
+            Crt::Mqtt::MqttConnection &connection,
+            const std::shared_ptr<ServiceMetrics> &metrics,
+            const std::shared_ptr<MemoryBudget> &budget,
+            RequestTrace &trace,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteBuf &payload,
+            OnPublishOperationComplete &&onOpComplete);
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
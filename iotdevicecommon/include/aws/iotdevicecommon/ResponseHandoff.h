@@ -0,0 +1,74 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Adapts a handler that takes ownership of the decoded model to the `void(Model *, int ioErr)` form the
+         * service client Subscribe* calls accept, so the model can be queued to another thread without a deep
+         * copy:
+         *
+         *     shadowClient.SubscribeToGetShadowAccepted(
+         *         request,
+         *         AWS_MQTT_QOS_AT_LEAST_ONCE,
+         *         Iotdevicecommon::TakeResponse<Iotshadow::GetShadowResponse>(
+         *             [&](std::unique_ptr<Iotshadow::GetShadowResponse> response, int ioErr) {
+         *                 workQueue.Push(std::move(response));
+         *             }),
+         *         onSubAck);
+         *
+         * The clients decode each message into an object that is not used again once the handler returns, so
+         * the adapter moves out of it: strings and JSON documents change hands without being copied. `response`
+         * is null where the pointer form would have been.
+         */
+        template <typename Model>
+        std::function<void(Model *, int)> TakeResponse(std::function<void(std::unique_ptr<Model>, int)> &&handler)
+        {
+            auto sharedHandler = std::make_shared<std::function<void(std::unique_ptr<Model>, int)>>(std::move(handler));
+            return [sharedHandler](Model *response, int ioErr) {
+                std::unique_ptr<Model> owned;
+                if (response)
+                {
+                    owned.reset(new Model(std::move(*response)));
+                }
+                (*sharedHandler)(std::move(owned), ioErr);
+            };
+        }
+
+        /**
+         * As above, for the `void(Response *, Error *, int ioErr)` completions of the request correlators.
+         */
+        template <typename Response, typename Error>
+        std::function<void(Response *, Error *, int)> TakeResponse(
+            std::function<void(std::unique_ptr<Response>, std::unique_ptr<Error>, int)> &&handler)
+        {
+            auto sharedHandler =
+                std::make_shared<std::function<void(std::unique_ptr<Response>, std::unique_ptr<Error>, int)>>(
+                    std::move(handler));
+            return [sharedHandler](Response *response, Error *error, int ioErr) {
+                std::unique_ptr<Response> ownedResponse;
+                std::unique_ptr<Error> ownedError;
+                if (response)
+                {
+                    ownedResponse.reset(new Response(std::move(*response)));
+                }
+                if (error)
+                {
+                    ownedError.reset(new Error(std::move(*error)));
+                }
+                (*sharedHandler)(std::move(ownedResponse), std::move(ownedError), ioErr);
+            };
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
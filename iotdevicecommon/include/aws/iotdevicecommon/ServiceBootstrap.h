@@ -0,0 +1,145 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * When one step of a ServiceBootstrap ran, in nanoseconds since the bootstrap started.
+         */
+        struct BootstrapStep
+        {
+            const char *Name;
+            uint64_t StartNs;
+            uint64_t DurationNs;
+            /* The step's error, or that of the step it waited on for a step never started. */
+            int ErrorCode;
+            bool Started;
+        };
+
+        /**
+         * The single ready event of a ServiceBootstrap.
+         */
+        struct BootstrapReport
+        {
+            /* The first error any step completed with, or AWS_ERROR_SUCCESS. */
+            int ErrorCode;
+            uint64_t DurationNs;
+            /* In the order they were added. */
+            Crt::Vector<BootstrapStep> Steps;
+        };
+
+        /**
+         * Brings a device's services up after CONNACK with every step started as soon as the steps it depends
+         * on are done, instead of each waiting on the previous one through a promise:
+         *
+         *     auto bootstrap = Iotdevicecommon::ServiceBootstrap::Create();
+         *     size_t accepted = bootstrap->AddStep("get accepted", [&](const OnStepComplete &done) {
+         *         return shadowClient.SubscribeToGetShadowAccepted(request, qos, onAccepted, done);
+         *     });
+         *     size_t rejected = bootstrap->AddStep("get rejected", ...);
+         *     bootstrap->AddStep("initial get", [&](const OnStepComplete &done) { ... }, {accepted, rejected});
+         *     bootstrap->AddStep("defender", [&](const OnStepComplete &done) { ... });
+         *     bootstrap->Start([](const BootstrapReport &report) { ... });
+         *
+         * So the subscriptions of the shadow, jobs and tunnel notifications are all in flight at once, each
+         * initial request goes out on the SUBACKs of its own responses, and a ReportTask starts right away.
+         * A step whose dependency failed is not started, and the ready event still comes once every other
+         * step is done.
+         */
+        class AWS_IOTDEVICECOMMON_API ServiceBootstrap final : public std::enable_shared_from_this<ServiceBootstrap>
+        {
+          public:
+            /**
+             * Completes a step; a Subscribe* onSubAck or a Publish* onComplete fits as is. Only the first
+             * call counts.
+             */
+            using OnStepComplete = std::function<void(int errorCode)>;
+
+            /**
+             * Starts a step. A step that is done at once may complete within the call.
+             *
+             * @return false, with the error raised, if the step could not start.
+             */
+            using StartStep = std::function<bool(const OnStepComplete &onComplete)>;
+
+            /**
+             * Invoked once every step is done, on the thread that completed the last one.
+             */
+            using OnReady = std::function<void(const BootstrapReport &report)>;
+
+            ServiceBootstrap(const ServiceBootstrap &) = delete;
+            ServiceBootstrap(ServiceBootstrap &&) = delete;
+            ServiceBootstrap &operator=(const ServiceBootstrap &) = delete;
+            ServiceBootstrap &operator=(ServiceBootstrap &&) = delete;
+
+            ~ServiceBootstrap() = default;
+
+            /**
+             * Adds a step, to start once every step in `after` has completed successfully.
+             *
+             * @return the step's id, or 0, with the error raised, if the bootstrap has started or `after`
+             * names a step not yet added.
+             */
+            size_t AddStep(const char *name, StartStep &&start, std::initializer_list<size_t> after = {});
+
+            /**
+             * Starts every step without dependencies. `onReady` is invoked even when no step was added.
+             *
+             * @return false, with AWS_ERROR_INVALID_STATE raised, if already started.
+             */
+            bool Start(OnReady &&onReady);
+
+            static std::shared_ptr<ServiceBootstrap> Create(Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            enum class StepState
+            {
+                Waiting,
+                Running,
+                Done,
+            };
+
+            struct Step
+            {
+                const char *Name;
+                StartStep Start;
+                Crt::Vector<size_t> After;
+                StepState State;
+                bool Started;
+                uint64_t StartNs;
+                uint64_t DurationNs;
+                int ErrorCode;
+            };
+
+            ServiceBootstrap() noexcept;
+
+            /* Starts each of `indices`, completing those that fail to. */
+            void Launch(Crt::Vector<size_t> &&indices);
+            void Complete(size_t index, int errorCode);
+            /* Moves the waiting steps that can start into `ready`, and drops those that never will. */
+            void Advance(uint64_t nowNs, Crt::Vector<size_t> &ready);
+
+            std::mutex m_lock;
+            Crt::Vector<Step> m_steps;
+            bool m_started;
+            uint64_t m_startNs;
+            size_t m_doneCount;
+            int m_errorCode;
+            OnReady m_onReady;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,176 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/DurablePublishQueue.h>
+#include <aws/iotdevicecommon/EventLoopMonitor.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/HandlerExecutor.h>
+#include <aws/iotdevicecommon/HandlerWatchdog.h>
+#include <aws/iotdevicecommon/HotStandby.h>
+#include <aws/iotdevicecommon/MemoryBudget.h>
+#include <aws/iotdevicecommon/PayloadBufferPool.h>
+#include <aws/iotdevicecommon/PayloadWriter.h>
+#include <aws/iotdevicecommon/PublishCompletionBatcher.h>
+#include <aws/iotdevicecommon/PublishLanes.h>
+#include <aws/iotdevicecommon/PublishScheduler.h>
+#include <aws/iotdevicecommon/QosPolicy.h>
+#include <aws/iotdevicecommon/RequestRateLimiter.h>
+#include <aws/iotdevicecommon/RequestTracer.h>
+#include <aws/iotdevicecommon/ServiceMetrics.h>
+#include <aws/iotdevicecommon/SessionSubscriptions.h>
+#include <aws/iotdevicecommon/ThrottleBreaker.h>
+
+#include <memory>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Optional behavior shared by the generated MQTT service clients (shadow, jobs, identity).
+         */
+        class AWS_IOTDEVICECOMMON_API ServiceClientConfig
+        {
+          public:
+            ServiceClientConfig() noexcept;
+            ServiceClientConfig(const ServiceClientConfig &rhs) = default;
+            ServiceClientConfig(ServiceClientConfig &&rhs) = default;
+
+            ServiceClientConfig &operator=(const ServiceClientConfig &rhs) = default;
+            ServiceClientConfig &operator=(ServiceClientConfig &&rhs) = default;
+
+            ~ServiceClientConfig() = default;
+
+            /**
+             * Pool that outgoing publish payloads are drawn from. May be shared between clients.
+             * Optional. When unset, each publish allocates and frees its own payload buffer.
+             */
+            std::shared_ptr<Iotdevicecommon::PayloadBufferPool> PayloadBufferPool;
+
+            /**
+             * Encoding of request and response payloads. Defaults to JSON; the AWS IoT service topics do not
+             * accept CBOR, so only use it on topics bridged to a peer that does.
+             */
+            Iotdevicecommon::PayloadFormat PayloadFormat;
+
+            /**
+             * Executor that subscription payload parsing and handlers are run on.
+             * Optional. When unset, handlers run on the connection's event loop, which stalls I/O on that
+             * connection while a large payload is parsed.
+             */
+            Iotdevicecommon::HandlerExecutor HandlerExecutor;
+
+            /**
+             * Watchdog every subscription handler's run time is checked against. May be shared between clients.
+             * Optional.
+             */
+            std::shared_ptr<Iotdevicecommon::HandlerWatchdog> HandlerWatchdog;
+
+            /**
+             * Monitor every subscription handler is recorded against, by the event loop it ran on. May be shared
+             * between clients. Optional.
+             */
+            std::shared_ptr<Iotdevicecommon::EventLoopMonitor> EventLoopMonitor;
+
+            /**
+             * Metrics the client records its publishes and received messages into. May be shared between
+             * clients. Optional. When unset, nothing is measured.
+             */
+            std::shared_ptr<Iotdevicecommon::ServiceMetrics> Metrics;
+
+            /**
+             * Span hooks called through the lifecycle of each request the client publishes. May be shared
+             * between clients. Optional. When unset, nothing is traced.
+             */
+            std::shared_ptr<Iotdevicecommon::RequestTracer> Tracer;
+
+            /**
+             * Record of the subscriptions made on the client's connection, for restoring them after a
+             * reconnect. Share one instance between every client on a connection. Optional.
+             */
+            std::shared_ptr<Iotdevicecommon::SessionSubscriptions> Session;
+
+            /**
+             * Whether high-frequency event subscriptions (shadow delta, jobs notify and notify-next) decode each
+             * message into one model instance kept per subscription, reusing its container storage, instead of
+             * a fresh one. The handler is then passed the same object every time, and the last message stays
+             * in memory until the next. Defaults to false.
+             */
+            bool ReuseInboundModels;
+
+            /**
+             * Queue that shadow update and job execution update publishes are written to instead of being
+             * published directly, so they survive a disconnect or restart. The application calls Drain on it
+             * once connected. May be shared between clients. Optional.
+             */
+            std::shared_ptr<Iotdevicecommon::DurablePublishQueue> OfflineQueue;
+
+            /**
+             * Caps on the publishes, correlated requests and received messages the client holds at once. Share
+             * one instance between every client for a process-wide bound. Optional. When unset, nothing is
+             * capped.
+             */
+            std::shared_ptr<Iotdevicecommon::MemoryBudget> MemoryBudget;
+
+            /**
+             * Scheduler that shadow update and job execution update publishes are batched through when there
+             * is no OfflineQueue, so they go out in the scheduler's transmission windows. May be shared between
+             * clients. Optional. When unset, they are published straight away.
+             */
+            std::shared_ptr<Iotdevicecommon::PublishScheduler> PublishScheduler;
+
+            /**
+             * Deadline, in milliseconds, each publish handed to the PublishScheduler is sent within. Zero, the
+             * default, waits for the next window.
+             */
+            uint32_t ScheduledPublishDeadlineMs;
+
+            /**
+             * Batcher the client's publish completions are delivered through, once per event loop tick, with
+             * their buffers returned to the pool together. May be shared between clients. Optional. When unset,
+             * each completion runs in the connection's callback.
+             */
+            std::shared_ptr<Iotdevicecommon::PublishCompletionBatcher> CompletionBatcher;
+
+            /**
+             * Lanes the client's publishes are admitted to the connection through, shadow updates as telemetry
+             * and every other publish as control, so job and provisioning requests are not held up behind bulk
+             * shadow traffic. Share one instance between every client on the connection. Optional.
+             */
+            std::shared_ptr<Iotdevicecommon::PublishLanes> PublishLanes;
+
+            /**
+             * Breaker the shadow and jobs clients report throttling rejections to, and whose backoff their
+             * publishes of the throttled operation are refused during. Share one instance between every
+             * client. Optional.
+             */
+            std::shared_ptr<Iotdevicecommon::ThrottleBreaker> ThrottleBreaker;
+
+            /**
+             * Limiter every publish of the client is paced through, queued while its API's rate for the thing
+             * is spent. Share one instance between every client. Optional. When unset, requests go out as
+             * fast as they are made.
+             */
+            std::shared_ptr<Iotdevicecommon::RequestRateLimiter> RateLimiter;
+
+            /**
+             * Pair of connections, the client's connection its primary, whose standby every subscription of the
+             * client is also made on and whose active connection the client publishes through, so the client
+             * carries on over the standby as soon as the primary drops. Optional.
+             */
+            std::shared_ptr<Iotdevicecommon::HotStandby> HotStandby;
+
+            /**
+             * QoS the client's publishes and subscriptions go out with by operation class, in place of the QoS
+             * passed to each call, e.g. QosPolicy::Recommended(). Defaults to a policy that sets none, so every
+             * call keeps its own QoS.
+             */
+            Iotdevicecommon::QosPolicy QosPolicy;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,183 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <atomic>
+#include <initializer_list>
+#include <type_traits>
+
+/**
+ * The most verbose level, as an aws_log_level value, that service logging is compiled in at; statements above
+ * it are removed by the compiler, arguments and all. Set through the SERVICE_LOG_LEVEL CMake cache variable.
+ * Defaults to 6, Trace, leaving every statement to the runtime level.
+ */
+#ifndef AWS_IOTDEVICECOMMON_STATIC_LOG_LEVEL
+#    define AWS_IOTDEVICECOMMON_STATIC_LOG_LEVEL 6
+#endif
+
+/**
+ * Logs `event`, and optionally a braced list of LogFields, for `subsystem` at `level`. The fields are neither
+ * built nor formatted unless the level is compiled in and enabled for the subsystem, so a disabled statement
+ * costs one relaxed load and a compare, and one compiled out costs nothing.
+ *
+ *     AWS_IOTDEVICE_LOG_DEBUG(LogSubsystem::Shadow, "publish", {{"topic", topic}, {"bytes", payload.len}});
+ */
+#define AWS_IOTDEVICE_LOG(level, subsystem, ...)                                                                       \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (static_cast<int>(level) <= AWS_IOTDEVICECOMMON_STATIC_LOG_LEVEL &&                                         \
+            Aws::Iotdevicecommon::ServiceLog::IsEnabled(subsystem, level))                                             \
+        {                                                                                                              \
+            Aws::Iotdevicecommon::ServiceLog::Write(subsystem, level, __VA_ARGS__);                                    \
+        }                                                                                                              \
+    } while (0)
+
+#define AWS_IOTDEVICE_LOG_ERROR(subsystem, ...) AWS_IOTDEVICE_LOG(Aws::Crt::LogLevel::Error, subsystem, __VA_ARGS__)
+#define AWS_IOTDEVICE_LOG_WARN(subsystem, ...) AWS_IOTDEVICE_LOG(Aws::Crt::LogLevel::Warn, subsystem, __VA_ARGS__)
+#define AWS_IOTDEVICE_LOG_INFO(subsystem, ...) AWS_IOTDEVICE_LOG(Aws::Crt::LogLevel::Info, subsystem, __VA_ARGS__)
+#define AWS_IOTDEVICE_LOG_DEBUG(subsystem, ...) AWS_IOTDEVICE_LOG(Aws::Crt::LogLevel::Debug, subsystem, __VA_ARGS__)
+#define AWS_IOTDEVICE_LOG_TRACE(subsystem, ...) AWS_IOTDEVICE_LOG(Aws::Crt::LogLevel::Trace, subsystem, __VA_ARGS__)
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        /**
+         * The parts of the SDK whose logging is enabled separately.
+         */
+        enum class LogSubsystem
+        {
+            Shadow,
+            Jobs,
+            Identity,
+            Discovery,
+            SecureTunneling,
+            DeviceDefender,
+            /* Publishes and subscriptions on topics of no service, and the shared building blocks. */
+            Common,
+        };
+
+        /**
+         * One key=value pair of a structured log line. Holds its value by reference where it is a string, so
+         * it is only valid for the statement it is written in; the value is formatted only when written.
+         */
+        class AWS_IOTDEVICECOMMON_API LogField final
+        {
+          public:
+            LogField(const char *key, const char *value) noexcept;
+            LogField(const char *key, const Crt::String &value) noexcept;
+            LogField(const char *key, Crt::ByteCursor value) noexcept;
+            LogField(const char *key, bool value) noexcept;
+            LogField(const char *key, double value) noexcept;
+
+            template <
+                typename Integer,
+                typename std::enable_if<std::is_integral<Integer>::value && std::is_signed<Integer>::value, int>::
+                    type = 0>
+            LogField(const char *key, Integer value) noexcept
+                : m_key(key), m_type(Type::Signed), m_signed(static_cast<int64_t>(value))
+            {
+            }
+
+            template <
+                typename Integer,
+                typename std::enable_if<std::is_integral<Integer>::value && !std::is_signed<Integer>::value, int>::
+                    type = 0>
+            LogField(const char *key, Integer value) noexcept
+                : m_key(key), m_type(Type::Unsigned), m_unsigned(static_cast<uint64_t>(value))
+            {
+            }
+
+            /* Enums, such as a QoS or a connection state, are logged by their value. */
+            template <typename Enum, typename std::enable_if<std::is_enum<Enum>::value, int>::type = 0>
+            LogField(const char *key, Enum value) noexcept
+                : m_key(key), m_type(Type::Signed), m_signed(static_cast<int64_t>(value))
+            {
+            }
+
+            /**
+             * Appends " key=value" to `line`, quoting the value if it has spaces, quotes or '=' in it. Stops at
+             * `capacity`, leaving `line` terminated.
+             */
+            void AppendTo(char *line, size_t &length, size_t capacity) const noexcept;
+
+          private:
+            enum class Type
+            {
+                String,
+                Signed,
+                Unsigned,
+                Boolean,
+                Double,
+            };
+
+            const char *m_key;
+            Type m_type;
+            union
+            {
+                Crt::ByteCursor m_string;
+                int64_t m_signed;
+                uint64_t m_unsigned;
+                bool m_boolean;
+                double m_double;
+            };
+        };
+
+        /**
+         * Per-subsystem logging for the service clients, discovery and secure tunneling, written through the
+         * CRT's logger (see Crt::ApiHandle::InitializeLogging) as "[subsystem] event key=value ...". The
+         * subsystems' levels are independent of the CRT's, so debug logging can be enabled for one of them
+         * without the cost of CRT trace logging everywhere. Every subsystem is off, AWS_LL_NONE, until set.
+         */
+        class AWS_IOTDEVICECOMMON_API ServiceLog final
+        {
+          public:
+            static const size_t SubsystemCount = 7;
+
+            ServiceLog() = delete;
+
+            /**
+             * Enables logging of `subsystem` at `level` and below. Thread-safe; takes effect for statements
+             * reached after it.
+             */
+            static void SetLevel(LogSubsystem subsystem, Crt::LogLevel level) noexcept;
+
+            /**
+             * Enables logging of every subsystem at `level` and below.
+             */
+            static void SetLevel(Crt::LogLevel level) noexcept;
+
+            static Crt::LogLevel GetLevel(LogSubsystem subsystem) noexcept;
+
+            static bool IsEnabled(LogSubsystem subsystem, Crt::LogLevel level) noexcept
+            {
+                return static_cast<int>(level) <=
+                       s_levels[static_cast<size_t>(subsystem)].load(std::memory_order_relaxed);
+            }
+
+            /**
+             * Formats and writes one line. Use the AWS_IOTDEVICE_LOG_* macros, which check the level first.
+             */
+            static void Write(
+                LogSubsystem subsystem,
+                Crt::LogLevel level,
+                const char *event,
+                std::initializer_list<LogField> fields = {}) noexcept;
+
+            /**
+             * @return the subsystem publishes and subscriptions on `topic` are logged under: Shadow, Jobs,
+             * SecureTunneling or Identity for their reserved topics, Common for every other.
+             */
+            static LogSubsystem SubsystemOfTopic(const char *topic) noexcept;
+
+          private:
+            static std::atomic<int> s_levels[SubsystemCount];
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,230 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/ConcurrentHistogram.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/InlineFunction.h>
+#include <aws/iotdevicecommon/MemoryBudget.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Durations bucketed by powers of two: bucket i counts durations under 2^i microseconds, and the last
+         * bucket everything longer.
+         */
+        struct AWS_IOTDEVICECOMMON_API LatencyHistogram
+        {
+            static const size_t BucketCount = 24;
+
+            LatencyHistogram() noexcept;
+
+            void Record(uint64_t durationNs) noexcept;
+
+            uint64_t Buckets[BucketCount];
+            uint64_t Count;
+            uint64_t TotalNs;
+        };
+
+        /**
+         * What the service clients have seen on one topic.
+         */
+        struct AWS_IOTDEVICECOMMON_API TopicMetrics
+        {
+            TopicMetrics() noexcept;
+
+            Crt::String Topic;
+
+            uint64_t PublishCount;
+            uint64_t PublishBytes;
+            /** Publishes sent but not yet completed, i.e. still awaiting their PUBACK at QoS 1. */
+            int64_t InFlightPublishes;
+
+            uint64_t ReceiveCount;
+            uint64_t ReceiveBytes;
+
+            /** Time spent in subscription handlers, parsing included. */
+            LatencyHistogram HandlerLatency;
+            /** Time spent decoding payloads alone. */
+            LatencyHistogram ParseTime;
+        };
+
+        /**
+         * What the service clients have seen on every topic of one pattern, e.g. the shadow deltas of every
+         * thing, as reported by ServiceMetrics::GetProfile.
+         */
+        struct AWS_IOTDEVICECOMMON_API TopicPatternProfile
+        {
+            TopicPatternProfile() noexcept;
+
+            /** The topics with thing, shadow, job and template names replaced by "+". */
+            Crt::String Pattern;
+            /** Distinct topics seen of the pattern. */
+            uint64_t TopicCount;
+
+            uint64_t PublishCount;
+            uint64_t PublishBytes;
+            uint64_t ReceiveCount;
+            uint64_t ReceiveBytes;
+
+            /** Time spent in subscription handlers, parsing included. */
+            uint64_t HandlerNs;
+            /** Time spent decoding payloads alone. */
+            uint64_t ParseNs;
+        };
+
+        /**
+         * Latencies across every topic, at finer resolution than the per-topic histograms.
+         */
+        struct AWS_IOTDEVICECOMMON_API ServiceLatencies
+        {
+            /** From handing a publish to the connection until it completed, i.e. its PUBACK at QoS 1. */
+            LogLinearHistogram PublishToPuback;
+            /** Subscription handlers, parsing included. */
+            LogLinearHistogram HandlerExecution;
+        };
+
+        /**
+         * Per-topic publish, receive, handler and parse metrics that the service clients report into when
+         * ServiceClientConfig::Metrics is set. One instance may be shared by every client on a device, so a
+         * single export shows which service is using the CPU and bandwidth. Clients without it skip every
+         * measurement.
+         *
+         * Topics are recorded exactly, thing names included, so expect one series per thing on a gateway.
+         * Publish and handler latencies are also recorded across all topics into ConcurrentHistograms,
+         * without taking the lock; request-to-response latency is recorded by the RequestTracer.
+         */
+        class AWS_IOTDEVICECOMMON_API ServiceMetrics final
+        {
+          public:
+            ServiceMetrics() noexcept;
+            ServiceMetrics(const ServiceMetrics &) = delete;
+            ServiceMetrics(ServiceMetrics &&) = delete;
+            ServiceMetrics &operator=(const ServiceMetrics &) = delete;
+            ServiceMetrics &operator=(ServiceMetrics &&) = delete;
+
+            /**
+             * Times a subscription handler on the calling thread, then records the message it handled.
+             * ParsePayload calls made while it is in scope are timed as parse time.
+             */
+            class AWS_IOTDEVICECOMMON_API HandlerScope final
+            {
+              public:
+                HandlerScope(ServiceMetrics &metrics, const Crt::String &topic, size_t payloadBytes) noexcept;
+                ~HandlerScope();
+                HandlerScope(const HandlerScope &) = delete;
+                HandlerScope &operator=(const HandlerScope &) = delete;
+
+                void AddParseTime(uint64_t durationNs) noexcept { m_parseNs += durationNs; }
+
+                /**
+                 * @return the innermost scope open on the calling thread, or null.
+                 */
+                static HandlerScope *Current() noexcept;
+
+              private:
+                ServiceMetrics &m_metrics;
+                const Crt::String &m_topic;
+                size_t m_payloadBytes;
+                uint64_t m_startNs;
+                uint64_t m_parseNs;
+                HandlerScope *m_outer;
+            };
+
+            void RecordPublish(const Crt::String &topic, size_t payloadBytes);
+            void RecordPublishComplete(const Crt::String &topic);
+            void RecordReceive(const Crt::String &topic, size_t payloadBytes, uint64_t handlerNs, uint64_t parseNs);
+
+            /**
+             * Records the time from a publish to its successful completion. Lock-free.
+             */
+            void RecordPublishLatency(uint64_t durationNs) noexcept { m_publishLatency.Record(durationNs); }
+
+            /**
+             * @return the latencies recorded across all topics.
+             */
+            ServiceLatencies GetLatencies() const noexcept;
+
+            /**
+             * @return a copy of every topic's metrics, ordered by topic.
+             */
+            Crt::Vector<TopicMetrics> GetSnapshot() const;
+
+            /**
+             * Invokes `visitor` with each topic's metrics, ordered by topic, without holding the lock.
+             */
+            void Export(const std::function<void(const TopicMetrics &)> &visitor) const;
+
+            /**
+             * @return the metrics in the Prometheus text exposition format, labelled by topic and by the
+             * service ("shadow", "jobs", "identity" or "other") the topic belongs to.
+             */
+            Crt::String ToPrometheusText() const;
+
+            /**
+             * @return the topics' metrics summed by TopicPattern, the patterns that took the most handler time
+             * first, then those that moved the most bytes. Built from a snapshot, so profiling costs nothing
+             * over keeping the metrics until a report is asked for.
+             */
+            Crt::Vector<TopicPatternProfile> GetProfile() const;
+
+            /**
+             * @return GetProfile as a plain text table, one pattern per line, to dump when the CPU spikes.
+             */
+            Crt::String ToProfileReport() const;
+
+            /**
+             * @return `topic` with the segments that name a thing, shadow, job or provisioning template replaced
+             * by "+", e.g. "$aws/things/+/shadow/update/delta". Topics outside "$aws/" are returned as they are.
+             */
+            static Crt::String TopicPattern(const Crt::String &topic);
+
+            /**
+             * Forgets every topic and latency. Publishes still in flight are no longer counted as such.
+             */
+            void Reset();
+
+          private:
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, TopicMetrics> m_topics;
+            ConcurrentHistogram m_publishLatency;
+            ConcurrentHistogram m_handlerLatency;
+        };
+
+        /**
+         * Completion of a publish handed to PublishWithMetrics. Roomy enough for the clients' completions,
+         * which capture the payload buffer, its pool and the caller's own callback, so wrapping them costs
+         * nothing until the single conversion to the connection's handler type.
+         */
+        using OnPublishOperationComplete =
+            InlineFunction<void(Crt::Mqtt::MqttConnection &connection, uint16_t packetId, int errorCode), 128>;
+
+        /**
+         * Publishes through `connection`, recording the publish and its completion in `metrics` when it is not
+         * null, and holding one of the in-flight publishes `budget` allows, when it is set, until the publish
+         * completes. Used by the service clients in place of MqttConnection::Publish.
+         *
+         * @return the packet id, or 0 if the publish could not be queued or the budget is exhausted.
+         */
+        AWS_IOTDEVICECOMMON_API uint16_t PublishWithMetrics(
+            Crt::Mqtt::MqttConnection &connection,
+            const std::shared_ptr<ServiceMetrics> &metrics,
+            const std::shared_ptr<MemoryBudget> &budget,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteBuf &payload,
+            OnPublishOperationComplete &&onOpComplete);
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,206 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/HandlerExecutor.h>
+#include <aws/iotdevicecommon/InlineFunction.h>
+#include <aws/iotdevicecommon/MessageContext.h>
+#include <aws/iotdevicecommon/PayloadCodec.h>
+#include <aws/iotdevicecommon/PublishLanes.h>
+#include <aws/iotdevicecommon/RequestRateLimiter.h>
+#include <aws/iotdevicecommon/TopicBuilder.h>
+
+#include <functional>
+#include <memory>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        class PublishCompletionBatcher;
+        class SessionSubscriptions;
+
+        /**
+         * Completion of a service client operation, the type of every client's OnSubscribeComplete and
+         * OnPublishComplete.
+         */
+        using OnOperationComplete = InlineFunction<void(int ioErr)>;
+
+        /**
+         * The part every Subscribe* operation of the service clients shares: rejects a topic that overflowed its
+         * builder with AWS_ERROR_INVALID_ARGUMENT, subscribes through SubscribeWithHandle, and on SUBACK passes
+         * a failure to onSubscribeFailed before invoking onSubAck.
+         *
+         * With a `standby` pair `connection` belongs to, subscribes on both of its connections and hands over
+         * only the messages of the active one; onSubAck is invoked once both SUBACKs arrived, with the first
+         * failure.
+         */
+        AWS_IOTDEVICECOMMON_API bool SubscribeToTopic(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const TopicBuilder &topic,
+            Crt::Mqtt::QOS qos,
+            Crt::Mqtt::OnMessageReceivedHandler &&onMessage,
+            std::function<void(int errorCode)> &&onSubscribeFailed,
+            const OnOperationComplete &onSubAck,
+            const std::shared_ptr<SessionSubscriptions> &session,
+            const std::shared_ptr<HotStandby> &standby = nullptr);
+
+        /**
+         * Parses each message of a subscription into a Model and hands it to the subscriber.
+         */
+        template <typename Model> class ModelPublishHandler final
+        {
+          public:
+            using Handler = std::function<void(Model *, int)>;
+
+            ModelPublishHandler(
+                const std::shared_ptr<Handler> &handler,
+                PayloadFormat format,
+                Crt::Allocator *allocator)
+                : m_handler(handler), m_format(format), m_scratch(Crt::StlAllocator<char>(allocator))
+            {
+            }
+
+            void operator()(Crt::Mqtt::MqttConnection &, const Crt::String &, const Crt::ByteBuf &payload)
+            {
+                Crt::JsonObject jsonObject;
+                ParsePayload(payload, m_format, m_scratch, jsonObject);
+                Model model(jsonObject);
+                (*m_handler)(&model, AWS_ERROR_SUCCESS);
+            }
+
+          private:
+            std::shared_ptr<Handler> m_handler;
+            PayloadFormat m_format;
+            Crt::String m_scratch;
+        };
+
+        /**
+         * Subscribes `handler` to `topic`, each of whose messages carries one Model. The clients use it for
+         * every subscription without extra processing of its own, so the code behind those is instantiated once
+         * per model type instead of once per operation; the many rejected topics of a service all share one.
+         */
+        template <typename Model>
+        bool SubscribeToModel(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const TopicBuilder &topic,
+            Crt::Mqtt::QOS qos,
+            std::function<void(Model *, int)> &&handler,
+            const OnOperationComplete &onSubAck,
+            const std::shared_ptr<const HandlerContext> &context,
+            const std::shared_ptr<SessionSubscriptions> &session,
+            PayloadFormat format,
+            Crt::Allocator *allocator)
+        {
+            auto sharedHandler = Crt::MakeShared<std::function<void(Model *, int)>>(allocator, std::move(handler));
+            return SubscribeToTopic(
+                connection,
+                topic,
+                qos,
+                OffloadPublishHandler(ModelPublishHandler<Model>(sharedHandler, format, allocator), context),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                session,
+                context->Standby);
+        }
+
+        /**
+         * Subscribes `handler` to `topic`, which may contain wildcards, handing each message over as received:
+         * no payload copy beyond what a handler executor needs, and no JSON work. For bridges that forward
+         * service messages unchanged.
+         */
+        AWS_IOTDEVICECOMMON_API bool SubscribeToRawMessages(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const TopicBuilder &topic,
+            Crt::Mqtt::QOS qos,
+            OnRawMessageReceived &&handler,
+            const OnOperationComplete &onSubAck,
+            const std::shared_ptr<const HandlerContext> &context,
+            const std::shared_ptr<SessionSubscriptions> &session,
+            Crt::Allocator *allocator);
+
+        /**
+         * The part every Publish* operation of the service clients shares once the request is serialized into
+         * `payload`, a buffer of `pool`: publishes it through PublishWithMetrics, invokes onPubAck on completion
+         * and returns the buffer to the pool then, or at once if the publish is refused. With a `batcher`, both
+         * happen in its next batch instead.
+         *
+         * With `lanes`, the publish is admitted in the lane of `priority` first. A telemetry publish held back
+         * there is accepted: it is sent once the lanes make room, and fails through onPubAck if it cannot be.
+         */
+        AWS_IOTDEVICECOMMON_API bool PublishPooledPayload(
+            Crt::Mqtt::MqttConnection &connection,
+            const std::shared_ptr<ServiceMetrics> &metrics,
+            const std::shared_ptr<MemoryBudget> &budget,
+            RequestTrace &trace,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const std::shared_ptr<PayloadBufferPool> &pool,
+            const Crt::ByteBuf &payload,
+            const OnOperationComplete &onPubAck,
+            const std::shared_ptr<PublishCompletionBatcher> &batcher = nullptr,
+            const std::shared_ptr<PublishLanes> &lanes = nullptr,
+            PublishPriority priority = PublishPriority::Control);
+
+        /**
+         * As PublishPooledPayload for a payload the caller owns and serialized already: publishes `payload` as is,
+         * without copying it, and invokes onRelease once the publish completed, or at once if it is refused. With a
+         * `batcher`, onPubAck and onRelease run in its next batch. `lanes` and `priority` are as for
+         * PublishPooledPayload; the caller's payload stays in use while a publish is held back.
+         */
+        AWS_IOTDEVICECOMMON_API bool PublishCallerPayload(
+            Crt::Mqtt::MqttConnection &connection,
+            const std::shared_ptr<ServiceMetrics> &metrics,
+            const std::shared_ptr<MemoryBudget> &budget,
+            RequestTrace &trace,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteCursor &payload,
+            const OnPayloadReleased &onRelease,
+            const OnOperationComplete &onPubAck,
+            const std::shared_ptr<PublishCompletionBatcher> &batcher = nullptr,
+            const std::shared_ptr<PublishLanes> &lanes = nullptr,
+            PublishPriority priority = PublishPriority::Control);
+
+        /**
+         * The rate limited branch of every Publish* operation, taken before PublishPooledPayload: if `limiter`
+         * has no token left for the request of `api` to `topic`, queues a copy of `payload` in it, ends the
+         * trace's Publish span and returns the buffer to `pool`.
+         *
+         * @return true if the limiter took the publish over, with `queued` set to whether it was accepted.
+         */
+        AWS_IOTDEVICECOMMON_API bool QueueIfRateLimited(
+            const std::shared_ptr<RequestRateLimiter> &limiter,
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            RateLimitedApi api,
+            RequestTrace &trace,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const std::shared_ptr<PayloadBufferPool> &pool,
+            Crt::ByteBuf &payload,
+            const OnOperationComplete &onPubAck,
+            bool &queued);
+
+        /**
+         * As QueueIfRateLimited before PublishCallerPayload: the limiter copies the caller's payload, so
+         * onRelease is invoked at once if it takes the publish over.
+         */
+        AWS_IOTDEVICECOMMON_API bool QueueIfRateLimited(
+            const std::shared_ptr<RequestRateLimiter> &limiter,
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            RateLimitedApi api,
+            RequestTrace &trace,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteCursor &payload,
+            const OnPayloadReleased &onRelease,
+            const OnOperationComplete &onPubAck,
+            bool &queued);
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,88 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * The subscriptions the service clients sharing it (via ServiceClientConfig::Session) have made on one
+         * connection, for restoring them after a reconnect without re-issuing every Subscribe* call. Call
+         * Resume() from the connection's OnConnectionResumed handler instead of resubscribing by hand:
+         *
+         *     connection->OnConnectionResumed = [session, connection](
+         *         Mqtt::MqttConnection &, Mqtt::ReturnCode, bool sessionPresent) {
+         *         session->Resume(connection, sessionPresent);
+         *     };
+         *
+         * With cleanSession=false and the session still present, the broker kept the subscriptions and nothing
+         * is sent. Otherwise every recorded subscription is restored in one multi-topic SUBSCRIBE per QoS.
+         *
+         * A subscription is recorded once its SUBACK succeeds and forgotten when a SubscriptionHandle owning it
+         * unsubscribes.
+         */
+        class AWS_IOTDEVICECOMMON_API SessionSubscriptions final
+        {
+          public:
+            /**
+             * Invoked once the resubscribe completes, with the first error seen, if any.
+             */
+            using OnResumeComplete = std::function<void(int errorCode)>;
+
+            SessionSubscriptions() noexcept;
+            SessionSubscriptions(const SessionSubscriptions &) = delete;
+            SessionSubscriptions(SessionSubscriptions &&) = delete;
+            SessionSubscriptions &operator=(const SessionSubscriptions &) = delete;
+            SessionSubscriptions &operator=(SessionSubscriptions &&) = delete;
+
+            void Record(
+                const Crt::String &topicFilter,
+                Crt::Mqtt::QOS qos,
+                const Crt::Mqtt::OnMessageReceivedHandler &onMessage);
+            void Forget(const Crt::String &topicFilter);
+
+            /**
+             * Restores the recorded subscriptions on `connection` unless `sessionPresent`. `onComplete` runs
+             * either way.
+             *
+             * @return false if a SUBSCRIBE could not be queued.
+             */
+            bool Resume(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                bool sessionPresent,
+                OnResumeComplete &&onComplete = nullptr);
+
+            size_t GetSubscriptionCount() const;
+
+            /**
+             * @return the number of subscriptions not re-sent because the session was present, over all
+             * Resume() calls.
+             */
+            uint64_t GetSkippedResubscribeCount() const;
+
+          private:
+            struct Subscription
+            {
+                Crt::Mqtt::QOS Qos;
+                Crt::Mqtt::OnMessageReceivedHandler OnMessage;
+            };
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, Subscription> m_subscriptions;
+            uint64_t m_skippedResubscribes;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
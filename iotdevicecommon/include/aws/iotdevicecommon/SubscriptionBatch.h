@@ -0,0 +1,106 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <functional>
+#include <memory>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Gathers the subscriptions made by the service client Subscribe* calls issued while one of its Capture
+         * scopes is open on the calling thread, and sends them as a single multi-topic SUBSCRIBE per connection
+         * and QoS when submitted, so setting up a device costs one SUBACK round trip instead of one per topic:
+         *
+         *     Iotdevicecommon::SubscriptionBatch batch;
+         *     {
+         *         Iotdevicecommon::SubscriptionBatch::Capture capture(batch);
+         *         shadowClient.SubscribeToShadowDeltaUpdatedEvents(...);
+         *         shadowClient.SubscribeToUpdateShadowAccepted(...);
+         *         jobsClient.SubscribeToNextJobExecutionChangedEvents(...);
+         *     }
+         *     batch.Submit([](int errorCode) { ... });
+         *
+         * Each Subscribe* call's own completion still runs, when its SUBSCRIBE is acknowledged. Subscriptions
+         * still queued when the batch is destroyed are failed with AWS_ERROR_INVALID_STATE.
+         */
+        class AWS_IOTDEVICECOMMON_API SubscriptionBatch final
+        {
+          public:
+            /**
+             * Invoked once every SUBSCRIBE in the batch has completed, with the first error seen, if any.
+             */
+            using OnBatchComplete = std::function<void(int errorCode)>;
+
+            SubscriptionBatch() noexcept;
+            ~SubscriptionBatch();
+            SubscriptionBatch(const SubscriptionBatch &) = delete;
+            SubscriptionBatch(SubscriptionBatch &&) = delete;
+            SubscriptionBatch &operator=(const SubscriptionBatch &) = delete;
+            SubscriptionBatch &operator=(SubscriptionBatch &&) = delete;
+
+            /**
+             * Queues every subscription made on the calling thread while in scope into `batch`.
+             */
+            class AWS_IOTDEVICECOMMON_API Capture final
+            {
+              public:
+                explicit Capture(SubscriptionBatch &batch) noexcept;
+                ~Capture();
+                Capture(const Capture &) = delete;
+                Capture &operator=(const Capture &) = delete;
+
+              private:
+                SubscriptionBatch *m_outer;
+            };
+
+            /**
+             * Sends the queued subscriptions and empties the batch. `onComplete` is invoked even when nothing
+             * was queued.
+             *
+             * @return false if a SUBSCRIBE could not be queued on its connection. Its subscriptions are failed
+             * through their completions, and `onComplete` still runs once the rest complete.
+             */
+            bool Submit(OnBatchComplete &&onComplete = nullptr);
+
+            size_t GetPendingCount() const noexcept { return m_entries.size(); }
+
+            /**
+             * Queues a subscription to `topicFilter` on `connection`.
+             */
+            void Add(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                const char *topicFilter,
+                Crt::Mqtt::QOS qos,
+                Crt::Mqtt::OnMessageReceivedHandler &&onMessage,
+                Crt::Mqtt::OnSubAckHandler &&onSubAck);
+
+            /**
+             * @return the batch capturing subscriptions on the calling thread, or null.
+             */
+            static SubscriptionBatch *Current() noexcept;
+
+          private:
+            struct Entry
+            {
+                std::shared_ptr<Crt::Mqtt::MqttConnection> Connection;
+                Crt::String TopicFilter;
+                Crt::Mqtt::QOS Qos;
+                Crt::Mqtt::OnMessageReceivedHandler OnMessage;
+                Crt::Mqtt::OnSubAckHandler OnSubAck;
+            };
+
+            Crt::Vector<Entry> m_entries;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
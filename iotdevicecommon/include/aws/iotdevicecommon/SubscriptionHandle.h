@@ -0,0 +1,122 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <memory>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        class SessionSubscriptions;
+
+        /**
+         * Owns the subscriptions made by the service client Subscribe* calls issued while one of its Capture
+         * scopes was open on the calling thread, and unsubscribes from all of them when destroyed. Unsubscribing
+         * also frees the handlers the subscriptions captured, so a gateway can keep one handle per child device
+         * and drop it when the device goes away:
+         *
+         *     Iotdevicecommon::SubscriptionHandle subscriptions;
+         *     {
+         *         Iotdevicecommon::SubscriptionHandle::Capture capture(subscriptions);
+         *         shadowClient.SubscribeToShadowDeltaUpdatedEvents(...);
+         *         jobsClient.SubscribeToNextJobExecutionChangedEvents(...);
+         *     }
+         *
+         * Subscribe* calls made outside a Capture scope are unaffected and last as long as the connection.
+         * Subscriptions whose connection has been destroyed are skipped.
+         */
+        class AWS_IOTDEVICECOMMON_API SubscriptionHandle final
+        {
+          public:
+            SubscriptionHandle() noexcept;
+            ~SubscriptionHandle();
+            SubscriptionHandle(const SubscriptionHandle &) = delete;
+            SubscriptionHandle(SubscriptionHandle &&) noexcept;
+            SubscriptionHandle &operator=(const SubscriptionHandle &) = delete;
+            SubscriptionHandle &operator=(SubscriptionHandle &&) noexcept;
+
+            /**
+             * Records every subscription made on the calling thread while in scope into `handle`, which must
+             * not be moved from until the scope closes.
+             */
+            class AWS_IOTDEVICECOMMON_API Capture final
+            {
+              public:
+                explicit Capture(SubscriptionHandle &handle) noexcept;
+                ~Capture();
+                Capture(const Capture &) = delete;
+                Capture &operator=(const Capture &) = delete;
+
+              private:
+                SubscriptionHandle *m_outer;
+            };
+
+            /**
+             * Unsubscribes from every owned topic now. `onUnsubAck`, if set, is invoked once per unsubscribe
+             * issued.
+             */
+            void Unsubscribe(const Crt::Mqtt::OnOperationCompleteHandler &onUnsubAck = nullptr);
+
+            /**
+             * Gives up ownership without unsubscribing, so the subscriptions last as long as the connection.
+             */
+            void Release() noexcept;
+
+            /**
+             * Hands every owned subscription over to `owner`, which unsubscribes from them in turn.
+             */
+            void MoveTo(SubscriptionHandle &owner);
+
+            size_t GetSubscriptionCount() const noexcept { return m_subscriptions.size(); }
+
+            /**
+             * Takes ownership of a subscription to `topicFilter` on `connection`, forgetting it in `session` too
+             * on unsubscribe.
+             */
+            void Add(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                const char *topicFilter,
+                const std::shared_ptr<SessionSubscriptions> &session = nullptr);
+
+            /**
+             * @return the handle capturing subscriptions on the calling thread, or null.
+             */
+            static SubscriptionHandle *Current() noexcept;
+
+          private:
+            struct Subscription
+            {
+                std::weak_ptr<Crt::Mqtt::MqttConnection> Connection;
+                Crt::String TopicFilter;
+                std::weak_ptr<SessionSubscriptions> Session;
+            };
+
+            Crt::Vector<Subscription> m_subscriptions;
+        };
+
+        /**
+         * Subscribes through `connection`, handing the subscription to the capturing SubscriptionHandle if there
+         * is one, or queues it into the capturing SubscriptionBatch if there is one. Once acknowledged, the
+         * subscription is recorded in `session` when that is set. Used by the service clients in place of
+         * MqttConnection::Subscribe.
+         *
+         * @return the packet id (a nonzero placeholder when queued into a batch), or 0 if the subscribe could not
+         * be queued.
+         */
+        AWS_IOTDEVICECOMMON_API uint16_t SubscribeWithHandle(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const char *topicFilter,
+            Crt::Mqtt::QOS qos,
+            Crt::Mqtt::OnMessageReceivedHandler &&onMessage,
+            Crt::Mqtt::OnSubAckHandler &&onSubAck,
+            const std::shared_ptr<SessionSubscriptions> &session = nullptr);
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,110 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * A small integer standing for a name interned in a ThingRegistry.
+         */
+        using NameId = uint32_t;
+
+        /**
+         * Never assigned to a name. Helpers use it for "no name", such as the classic shadow's.
+         */
+        static const NameId InvalidNameId = UINT32_MAX;
+
+        /**
+         * Interns thing, shadow and job names into stable NameIds, so per-thing state can be keyed by integers
+         * (see IdHashMap) rather than by a copy of the name in every structure. Each name is stored once, packed
+         * into large blocks, and looking one up hashes it once and allocates nothing.
+         *
+         * Names are never removed: an id and the name it stands for stay valid for the registry's lifetime.
+         * That suits names there is a bounded set of, like a gateway's things and their shadows; do not intern
+         * client tokens or other names made up per request.
+         *
+         * Thread-safe. One registry may be shared by any number of clients and helpers through a shared_ptr,
+         * and ids from it may then be used as keys by all of them.
+         */
+        class AWS_IOTDEVICECOMMON_API ThingRegistry final
+        {
+          public:
+            explicit ThingRegistry(Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+            ~ThingRegistry();
+
+            ThingRegistry(const ThingRegistry &) = delete;
+            ThingRegistry(ThingRegistry &&) = delete;
+            ThingRegistry &operator=(const ThingRegistry &) = delete;
+            ThingRegistry &operator=(ThingRegistry &&) = delete;
+
+            /**
+             * @return the id of `name`, interning it first if needed, or InvalidNameId if memory for it
+             * could not be allocated.
+             */
+            NameId Intern(Crt::ByteCursor name);
+            NameId Intern(const Crt::String &name) { return Intern(Crt::ByteCursorFromString(name)); }
+
+            /**
+             * @return the id of `name` if it has been interned, and InvalidNameId otherwise.
+             */
+            NameId Find(Crt::ByteCursor name) const noexcept;
+            NameId Find(const Crt::String &name) const noexcept { return Find(Crt::ByteCursorFromString(name)); }
+
+            /**
+             * @return the interned name for `id`, or an empty cursor for an id this registry did not assign.
+             * The bytes are those of the name as interned, without a terminator, and never move.
+             */
+            Crt::ByteCursor GetName(NameId id) const noexcept;
+
+            /**
+             * @return the number of names interned.
+             */
+            size_t GetCount() const noexcept;
+
+            /**
+             * @return a single key for a pair of ids, e.g. a thing and one of its shadows, for an IdHashMap.
+             */
+            static uint64_t PairKey(NameId first, NameId second) noexcept
+            {
+                return (static_cast<uint64_t>(first) << 32) | second;
+            }
+
+          private:
+            struct Entry
+            {
+                const uint8_t *Name;
+                uint32_t Length;
+                uint32_t Hash;
+            };
+
+            NameId FindLocked(Crt::ByteCursor name, uint32_t hash) const noexcept;
+            const uint8_t *Store(Crt::ByteCursor name);
+            void Grow();
+
+            Crt::Allocator *m_allocator;
+            mutable std::mutex m_lock;
+
+            /* Indexed by NameId. */
+            Crt::Vector<Entry> m_entries;
+            /* Open-addressed with linear probing; InvalidNameId marks an empty slot. Power-of-two sized. */
+            Crt::Vector<NameId> m_index;
+
+            /* Every block names are stored in; a name too long to pack with others gets a block of its own. */
+            Crt::Vector<uint8_t *> m_blocks;
+            /* The block new names are packed into, and how much of it is used. */
+            uint8_t *m_block;
+            size_t m_blockUsed;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,191 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        class SessionSubscriptions;
+
+        /**
+         * Takes over the subscriptions the service clients make on one connection to topics of a named thing,
+         * "$aws/things/<thing>/...": the shadow, jobs and tunnel notify topics. Each thing gets a single
+         * "$aws/things/<thing>/#" subscription, and its messages are routed through one topic trie shared by
+         * every client, instead of the connection matching each message against a subscription per topic:
+         *
+         *     auto dispatcher = Iotdevicecommon::ThingTopicDispatcher::Create(connection);
+         *     Iotshadow::IotShadowClient shadowClient(connection);
+         *     Iotjobs::IotJobsClient jobsClient(connection);
+         *
+         * Once created, every Subscribe* call of a client on the connection that names a thing is routed, and
+         * completes on the SUBACK of that thing's subscription, at once if the thing is already subscribed.
+         * Unsubscribing through a SubscriptionHandle removes the route, and the thing's subscription goes with
+         * its last route. Topics not under a named thing, such as those of identity or a "+" thing filter, are
+         * subscribed to as before. Create the dispatcher before the clients subscribe: a topic subscribed to
+         * before it exists receives each message through both subscriptions.
+         *
+         * The thing subscriptions are recorded in the SessionSubscriptions of the first route for the thing,
+         * so they are restored with the others. Routing a topic that is already routed replaces its handler,
+         * as resubscribing does.
+         *
+         * A thing's subscription is made with the highest QoS its routes asked for, and made again when a
+         * route asks for more, so a route at QoS 0 (a shadow client's QosPolicy, say) keeps its responses at
+         * QoS 0 only while no route of the same thing needs QoS 1. A SUBACK refusing the subscription fails the
+         * routes waiting on it, which are removed.
+         *
+         * The "#" filter also matches the request topics the clients publish to, so the broker sends every
+         * request back to the device: a shadow update costs its payload twice, once out and once in. The
+         * echoes match no route and are dropped.
+         */
+        class AWS_IOTDEVICECOMMON_API ThingTopicDispatcher final
+            : public std::enable_shared_from_this<ThingTopicDispatcher>
+        {
+          public:
+            ThingTopicDispatcher(const ThingTopicDispatcher &) = delete;
+            ThingTopicDispatcher(ThingTopicDispatcher &&) = delete;
+            ThingTopicDispatcher &operator=(const ThingTopicDispatcher &) = delete;
+            ThingTopicDispatcher &operator=(ThingTopicDispatcher &&) = delete;
+
+            ~ThingTopicDispatcher();
+
+            /**
+             * Routes `topicFilter`'s messages to `onMessage`, subscribing to its thing's topics first unless
+             * already subscribed with at least `qos`. `onSubAck` is invoked with the outcome of that subscription.
+             *
+             * @return a nonzero placeholder packet id, or 0, with the error raised, if the filter is not
+             * covered or the subscription could not be queued.
+             */
+            uint16_t Route(
+                const char *topicFilter,
+                Crt::Mqtt::QOS qos,
+                Crt::Mqtt::OnMessageReceivedHandler &&onMessage,
+                Crt::Mqtt::OnSubAckHandler &&onSubAck,
+                const std::shared_ptr<SessionSubscriptions> &session = nullptr);
+
+            /**
+             * Stops routing `topicFilter`. `onUnsubAck`, if set, is invoked with the UNSUBACK of the thing's
+             * subscription if this was its last route, and at once otherwise.
+             *
+             * @return false if the filter is not routed.
+             */
+            bool Unroute(const char *topicFilter, const Crt::Mqtt::OnOperationCompleteHandler &onUnsubAck = nullptr);
+
+            /**
+             * Invokes the handler of every routed filter `topic` matches. The thing subscriptions dispatch each
+             * message received; exposed for messages received another way.
+             */
+            void Dispatch(
+                Crt::Mqtt::MqttConnection &connection,
+                const Crt::String &topic,
+                const Crt::ByteBuf &payload) const;
+
+            size_t GetRouteCount() const;
+            size_t GetThingCount() const;
+
+            /**
+             * @return whether `topicFilter` is under a named thing, and so can be routed.
+             */
+            static bool Covers(const char *topicFilter) noexcept;
+
+            /**
+             * @return the dispatcher of `connection`, or null.
+             */
+            static std::shared_ptr<ThingTopicDispatcher> Find(const Crt::Mqtt::MqttConnection &connection);
+
+            /**
+             * Creates the dispatcher of `connection`.
+             *
+             * @return null, with AWS_ERROR_INVALID_STATE raised, if the connection already has one.
+             */
+            static std::shared_ptr<ThingTopicDispatcher> Create(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Node
+            {
+                Node() noexcept;
+
+                Crt::Map<Crt::String, size_t> Children;
+                size_t SingleLevelChild;
+                size_t MultiLevelChild;
+                std::shared_ptr<Crt::Mqtt::OnMessageReceivedHandler> Handler;
+            };
+
+            struct Waiter
+            {
+                uint64_t Id;
+                Crt::String TopicFilter;
+                Crt::Mqtt::QOS Qos;
+                Crt::Mqtt::OnSubAckHandler OnSubAck;
+            };
+
+            struct Thing
+            {
+                /* Whether a subscription was acknowledged, at SubscribedQos. */
+                bool Subscribed = false;
+                Crt::Mqtt::QOS SubscribedQos = AWS_MQTT_QOS_AT_MOST_ONCE;
+                Crt::Mqtt::QOS GrantedQos = AWS_MQTT_QOS_AT_MOST_ONCE;
+                /* The QoS of the latest subscription made, acknowledged or not. */
+                Crt::Mqtt::QOS RequestedQos = AWS_MQTT_QOS_AT_MOST_ONCE;
+                size_t SubscribesInFlight = 0;
+                size_t RouteCount = 0;
+                /* The routes waiting on a SUBACK of the thing's subscription at their QoS or above. */
+                Crt::Vector<Waiter> Waiters;
+                std::weak_ptr<SessionSubscriptions> Session;
+            };
+
+            ThingTopicDispatcher(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                Crt::Allocator *allocator) noexcept;
+
+            bool SubscribeThing(const Crt::String &thingName, Crt::Mqtt::QOS qos);
+            void Subscribed(
+                const Crt::String &thingName,
+                Crt::Mqtt::QOS requestedQos,
+                Crt::Mqtt::QOS grantedQos,
+                int errorCode);
+            void UnsubscribeThing(
+                const Crt::String &thingName,
+                const std::shared_ptr<SessionSubscriptions> &session,
+                const Crt::Mqtt::OnOperationCompleteHandler &onUnsubAck);
+
+            /* @return the filter's leaf, adding the nodes on its path. */
+            size_t InsertLocked(const Crt::Vector<Crt::String> &segments);
+            /* Removes the filter's handler and the nodes left empty. @return false if it had none. */
+            bool RemoveLocked(const Crt::Vector<Crt::String> &segments);
+            /* Removes every route of the thing from the trie. */
+            void RemoveThingLocked(const Crt::String &thingName);
+            size_t AllocateNodeLocked();
+            void Match(
+                size_t node,
+                const Crt::Vector<Crt::ByteCursor> &segments,
+                size_t depth,
+                Crt::Vector<std::shared_ptr<Crt::Mqtt::OnMessageReceivedHandler>> &matches) const;
+
+            Crt::Mqtt::OnMessageReceivedHandler MakeThingHandler();
+            static Crt::String ThingTopicOf(const Crt::String &thingName);
+
+            std::shared_ptr<Crt::Mqtt::MqttConnection> m_connection;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            /* m_nodes[0] is the root; nodes pruned away are reused through m_freeNodes. */
+            Crt::Vector<Node> m_nodes;
+            Crt::Vector<size_t> m_freeNodes;
+            Crt::Map<Crt::String, Thing> m_things;
+            size_t m_routeCount;
+            uint64_t m_nextWaiterId;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,61 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * An allocator that keeps freed small blocks (up to 512 bytes) in a per-thread cache and serves later
+         * allocations of the same size class from it, on the way to another allocator. Decoding an inbound
+         * message makes dozens of such allocations (cJSON nodes, model strings, map nodes) that are freed when
+         * its handler returns, so in steady state each event loop thread recycles its own blocks instead of
+         * contending on the wrapped allocator's lock.
+         *
+         * Pass GetAllocator() to the ApiHandle, so JSON parsing uses it, and to the service clients. Blocks
+         * may be freed on any thread; they join the freeing thread's cache. Each allocation costs 16 extra
+         * bytes for its header. Both this allocator and the wrapped one must outlive every allocation made
+         * through it. Destroying it hands the blocks cached on every thread back to the wrapped allocator and
+         * frees those threads' caches for another instance.
+         *
+         * Each thread cache has a lock of its own, only ever contended while the allocator is destroyed.
+         */
+        class AWS_IOTDEVICECOMMON_API ThreadCachingAllocator final
+        {
+          public:
+            explicit ThreadCachingAllocator(
+                Crt::Allocator *wrapped = Crt::DefaultAllocator(),
+                size_t maxCachedPerSizeClass = 64) noexcept;
+            ~ThreadCachingAllocator();
+            ThreadCachingAllocator(const ThreadCachingAllocator &) = delete;
+            ThreadCachingAllocator(ThreadCachingAllocator &&) = delete;
+            ThreadCachingAllocator &operator=(const ThreadCachingAllocator &) = delete;
+            ThreadCachingAllocator &operator=(ThreadCachingAllocator &&) = delete;
+
+            Crt::Allocator *GetAllocator() noexcept { return &m_allocator; }
+
+            /**
+             * Hands the calling thread's cached blocks back to the wrapped allocator.
+             */
+            void TrimThreadCache() noexcept;
+
+          private:
+            static void *s_acquire(Crt::Allocator *allocator, size_t size);
+            static void s_release(Crt::Allocator *allocator, void *ptr);
+
+            Crt::Allocator m_allocator;
+            Crt::Allocator *m_wrapped;
+            size_t m_maxCachedPerSizeClass;
+            /* Tells this instance's blocks from those of one that used to live at the same address. */
+            uint64_t m_id;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
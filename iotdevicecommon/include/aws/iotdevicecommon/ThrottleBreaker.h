@@ -0,0 +1,130 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        /**
+         * The service operations AWS IoT throttles separately. Named shadow operations share the class of
+         * their classic counterparts.
+         */
+        enum class ThrottledOperation
+        {
+            ShadowGet,
+            ShadowUpdate,
+            ShadowDelete,
+            JobsGetPending,
+            JobsDescribe,
+            JobsUpdate,
+            JobsStartNext,
+        };
+
+        class AWS_IOTDEVICECOMMON_API ThrottleBreakerConfig final
+        {
+          public:
+            ThrottleBreakerConfig() noexcept;
+            ThrottleBreakerConfig(const ThrottleBreakerConfig &rhs) = default;
+            ThrottleBreakerConfig(ThrottleBreakerConfig &&rhs) = default;
+
+            ThrottleBreakerConfig &operator=(const ThrottleBreakerConfig &rhs) = default;
+            ThrottleBreakerConfig &operator=(ThrottleBreakerConfig &&rhs) = default;
+
+            ~ThrottleBreakerConfig() = default;
+
+            /**
+             * How long publishes of an operation are refused after its first throttling rejection.
+             * Defaults to 1000.
+             */
+            uint32_t InitialBackoffMs;
+
+            /**
+             * The longest backoff; each throttling rejection within ResetAfterMs of the previous one doubles it
+             * up to this. Defaults to 30000.
+             */
+            uint32_t MaxBackoffMs;
+
+            /**
+             * Quiet period after which an operation's backoff starts over from InitialBackoffMs. Defaults to
+             * 60000.
+             */
+            uint32_t ResetAfterMs;
+        };
+
+        /**
+         * What a ThrottleBreaker has seen of one operation class.
+         */
+        struct AWS_IOTDEVICECOMMON_API ThrottleBreakerCounters
+        {
+            /** Throttling rejections received. */
+            uint64_t Throttled;
+            /** Publishes refused while backing off. */
+            uint64_t Refused;
+            /** Nanoseconds, on the high resolution clock, until which publishes are refused; 0 if never. */
+            uint64_t OpenUntilNs;
+        };
+
+        /**
+         * A circuit breaker over the service operations, shared between the service clients. The clients
+         * report each throttling rejection they receive (a shadow ErrorResponse with code 429, a jobs
+         * RejectedError with code RequestThrottled), and the breaker then refuses further publishes of that
+         * operation class for a backoff that doubles with each throttling rejection in a row, with jitter so
+         * a fleet throttled together does not retry together. Publishes are refused before they are
+         * serialized, so nothing is sent only to be rejected again.
+         *
+         * Share one instance between every client publishing under the same account's limits.
+         */
+        class AWS_IOTDEVICECOMMON_API ThrottleBreaker final
+        {
+          public:
+            static const size_t OperationCount = 7;
+
+            ThrottleBreaker(const ThrottleBreaker &) = delete;
+            ThrottleBreaker(ThrottleBreaker &&) = delete;
+            ThrottleBreaker &operator=(const ThrottleBreaker &) = delete;
+            ThrottleBreaker &operator=(ThrottleBreaker &&) = delete;
+            ~ThrottleBreaker() = default;
+
+            /**
+             * @return true if a publish of `operation` may go out; false, with AWS_ERROR_INVALID_STATE raised,
+             * while the operation is backing off.
+             */
+            bool Allow(ThrottledOperation operation);
+
+            /**
+             * Opens the breaker for `operation` after a throttling rejection.
+             */
+            void RecordThrottled(ThrottledOperation operation);
+
+            ThrottleBreakerCounters GetCounters(ThrottledOperation operation) const;
+
+            static std::shared_ptr<ThrottleBreaker> Create(
+                const ThrottleBreakerConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct OperationState
+            {
+                uint64_t OpenUntilNs;
+                uint64_t LastThrottledNs;
+                uint32_t Streak;
+                uint64_t Throttled;
+                uint64_t Refused;
+            };
+
+            explicit ThrottleBreaker(const ThrottleBreakerConfig &config) noexcept;
+
+            ThrottleBreakerConfig m_config;
+            mutable std::mutex m_lock;
+            OperationState m_operations[OperationCount];
+        };
+    } // namespace Iotdevicecommon
+} // namespace Aws
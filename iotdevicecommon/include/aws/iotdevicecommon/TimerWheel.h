@@ -0,0 +1,122 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/common/task_scheduler.h>
+#include <aws/crt/Types.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/IdHashMap.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Timers for the timeouts, windows and backoffs of many components, kept in one hierarchical timing
+         * wheel on one event loop instead of an aws_task each.
+         *
+         * The wheel has four levels of 64 slots, the first one tick apart and each next 64 times coarser, so a
+         * timer is filed into a slot by its expiry in constant time and moves down a level at most three times
+         * before it fires. Cancelling unlinks it in constant time. A single task advances the wheel once a
+         * tick while any timer is pending, so an idle wheel costs nothing. Timers fire on the event loop's
+         * thread, rounded up to the next tick.
+         */
+        class AWS_IOTDEVICECOMMON_API TimerWheel final : public std::enable_shared_from_this<TimerWheel>
+        {
+          public:
+            using OnExpired = std::function<void()>;
+
+            TimerWheel(const TimerWheel &) = delete;
+            TimerWheel(TimerWheel &&) = delete;
+            TimerWheel &operator=(const TimerWheel &) = delete;
+            TimerWheel &operator=(TimerWheel &&) = delete;
+
+            ~TimerWheel() = default;
+
+            /**
+             * Invokes `onExpired` once, `delayMs` from now. May be called from any thread.
+             *
+             * @return the timer's id to cancel it by, or 0, with the error raised, if the wheel's task could
+             * not be scheduled.
+             */
+            uint64_t Schedule(uint64_t delayMs, OnExpired &&onExpired);
+
+            /**
+             * @return false if no timer has that id, e.g. because it fired already.
+             */
+            bool Cancel(uint64_t timerId);
+
+            size_t GetTimerCount() const;
+
+            uint32_t GetTickMs() const noexcept { return m_tickMs; }
+
+            /**
+             * @param tickMs the resolution of the wheel; timers beyond 64^4 ticks are refiled after that long.
+             */
+            static std::shared_ptr<TimerWheel> Create(
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                uint32_t tickMs = 10,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            static constexpr size_t s_levelCount = 4;
+            static constexpr size_t s_slotBits = 6;
+            static constexpr size_t s_slotCount = size_t(1) << s_slotBits;
+
+            struct Timer
+            {
+                uint64_t Id;
+                uint64_t ExpiryTick;
+                OnExpired Callback;
+            };
+
+            using Slot = Crt::List<Timer>;
+
+            struct Location
+            {
+                size_t Level = 0;
+                size_t Index = 0;
+                Slot::iterator Position;
+            };
+
+            struct TickTask;
+
+            TimerWheel(Crt::Io::EventLoopGroup &eventLoopGroup, uint32_t tickMs, Crt::Allocator *allocator) noexcept;
+
+            uint64_t NowNs() const noexcept;
+            /* Moves the timer at `position` of `from` into the slot its expiry falls in. */
+            void File(Slot &from, Slot::iterator position);
+            /* Advances one tick, cascading the coarser levels down and moving what expires into `expired`. */
+            void Advance(Crt::Vector<OnExpired> &expired);
+            void ScheduleTick(TickTask *tickTask);
+            /* @return whether the task was scheduled again. */
+            bool Tick(TickTask *tickTask);
+
+            static void s_onTickTask(aws_task *task, void *arg, aws_task_status status);
+
+            aws_event_loop *m_eventLoop;
+            uint32_t m_tickMs;
+            uint64_t m_tickNs;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Slot m_slots[s_levelCount][s_slotCount];
+            IdHashMap<Location> m_timers;
+            uint64_t m_nextTimerId;
+            uint64_t m_originNs;
+            /* The last tick advanced to, in ticks since m_originNs. */
+            uint64_t m_currentTick;
+            bool m_tickScheduled;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
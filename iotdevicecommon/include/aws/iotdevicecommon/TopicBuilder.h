@@ -0,0 +1,77 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * Fixed-capacity string builder used in place of a StringStream, so building a topic neither touches
+         * the heap nor pulls in iostream and locale machinery. Appends that do not fit mark the builder as
+         * overflowed instead of truncating.
+         */
+        template <size_t Capacity> class FixedStringBuilder final
+        {
+          public:
+            FixedStringBuilder() noexcept : m_length(0), m_overflow(false) { m_buffer[0] = '\0'; }
+
+            template <size_t N> FixedStringBuilder &operator<<(const char (&segment)[N]) noexcept
+            {
+                return Append(segment, N - 1);
+            }
+
+            FixedStringBuilder &operator<<(const Crt::String &segment) noexcept
+            {
+                return Append(segment.data(), segment.length());
+            }
+
+            FixedStringBuilder &operator<<(const Crt::ByteCursor &segment) noexcept
+            {
+                return Append(reinterpret_cast<const char *>(segment.ptr), segment.len);
+            }
+
+            FixedStringBuilder &Append(const char *segment, size_t length) noexcept
+            {
+                if (m_overflow || length >= Capacity - m_length)
+                {
+                    m_overflow = true;
+                    return *this;
+                }
+
+                memcpy(m_buffer + m_length, segment, length);
+                m_length += length;
+                m_buffer[m_length] = '\0';
+                return *this;
+            }
+
+            const char *c_str() const noexcept { return m_buffer; }
+
+            size_t length() const noexcept { return m_length; }
+
+            /**
+             * @return false if something appended did not fit.
+             */
+            explicit operator bool() const noexcept { return !m_overflow; }
+
+          private:
+            char m_buffer[Capacity];
+            size_t m_length;
+            bool m_overflow;
+        };
+
+        /**
+         * Thing names are limited to 128 bytes, and shadow names, job ids and template names to 64, so every
+         * MQTT service topic fits well within this builder.
+         */
+        using TopicBuilder = FixedStringBuilder<256>;
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
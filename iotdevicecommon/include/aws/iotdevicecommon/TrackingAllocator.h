@@ -0,0 +1,76 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <atomic>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * An allocator that counts what passes through it on the way to another one. Give each component its
+         * own, e.g. one for the shadow client and one for the secure tunnel, by passing GetAllocator() as the
+         * component's allocator argument, and each reports the memory it holds.
+         *
+         * Only allocations made through the given allocator are counted; memory the MQTT connection or the
+         * CRT allocates on the component's behalf with their own allocator is not. Each allocation costs 16
+         * extra bytes for its size header. The tracker must outlive every allocation made through it.
+         */
+        class AWS_IOTDEVICECOMMON_API TrackingAllocator final
+        {
+          public:
+            explicit TrackingAllocator(Crt::Allocator *wrapped = Crt::DefaultAllocator()) noexcept;
+            TrackingAllocator(const TrackingAllocator &) = delete;
+            TrackingAllocator(TrackingAllocator &&) = delete;
+            TrackingAllocator &operator=(const TrackingAllocator &) = delete;
+            TrackingAllocator &operator=(TrackingAllocator &&) = delete;
+
+            Crt::Allocator *GetAllocator() noexcept { return &m_allocator; }
+
+            /**
+             * @return the bytes currently allocated, excluding size headers.
+             */
+            size_t GetCurrentBytes() const noexcept { return m_currentBytes.load(); }
+
+            /**
+             * @return the most bytes allocated at once since construction or the last ResetPeak.
+             */
+            size_t GetPeakBytes() const noexcept { return m_peakBytes.load(); }
+
+            /**
+             * @return the number of allocations currently live.
+             */
+            size_t GetLiveAllocationCount() const noexcept { return m_liveAllocations.load(); }
+
+            /**
+             * @return the number of allocations made since construction, freed or not.
+             */
+            uint64_t GetTotalAllocationCount() const noexcept { return m_totalAllocations.load(); }
+
+            /**
+             * Restarts peak tracking from the current usage, e.g. to measure one phase of operation.
+             */
+            void ResetPeak() noexcept { m_peakBytes.store(m_currentBytes.load()); }
+
+          private:
+            static void *s_acquire(Crt::Allocator *allocator, size_t size);
+            static void s_release(Crt::Allocator *allocator, void *ptr);
+
+            Crt::Allocator m_allocator;
+            Crt::Allocator *m_wrapped;
+
+            std::atomic<size_t> m_currentBytes;
+            std::atomic<size_t> m_peakBytes;
+            std::atomic<size_t> m_liveAllocations;
+            std::atomic<uint64_t> m_totalAllocations;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
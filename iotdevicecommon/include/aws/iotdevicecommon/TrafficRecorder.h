@@ -0,0 +1,167 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        enum class TrafficDirection : uint8_t
+        {
+            /** A message a subscription received. */
+            Inbound = 0,
+            /** A message a service client published. */
+            Outbound = 1,
+        };
+
+        /**
+         * One message of a trace. Topic and Payload point into the TrafficTrace it was read from.
+         */
+        struct TrafficRecord
+        {
+            TrafficDirection Direction;
+            /* Since the recorder was created. */
+            uint64_t TimestampNs;
+            Crt::ByteCursor Topic;
+            Crt::ByteCursor Payload;
+        };
+
+        /**
+         * Writes the service client traffic of one connection to a trace file, for replaying a production
+         * payload mix against the clients later (see benchmarks, "replay"). Once created, the messages the
+         * clients publish on the connection and those their subscriptions receive are recorded, tunnel notify
+         * subscriptions included; the messages of subscriptions made before the recorder existed are not.
+         *
+         * The file is a 16-byte header, "IOTTRACE" and a little-endian uint32 version and flags, followed by
+         * one record per message: a 24-byte header of the uint64 timestamp, the uint32 topic and payload
+         * lengths and the direction byte, then the topic and the payload, zero-padded to 8 bytes. Records are
+         * buffered and written in blocks as the buffer fills, on the thread that recorded the message, so
+         * only record on a disk that keeps up with the traffic. Messages past `maxBytes` of trace are
+         * counted as dropped rather than written.
+         */
+        class AWS_IOTDEVICECOMMON_API TrafficRecorder final : public std::enable_shared_from_this<TrafficRecorder>
+        {
+          public:
+            TrafficRecorder(const TrafficRecorder &) = delete;
+            TrafficRecorder(TrafficRecorder &&) = delete;
+            TrafficRecorder &operator=(const TrafficRecorder &) = delete;
+            TrafficRecorder &operator=(TrafficRecorder &&) = delete;
+
+            /**
+             * Writes what is still buffered and closes the file.
+             */
+            ~TrafficRecorder();
+
+            void Record(TrafficDirection direction, Crt::ByteCursor topic, Crt::ByteCursor payload);
+
+            /**
+             * Writes every buffered record to the file.
+             *
+             * @return false, with the error raised, if the write failed.
+             */
+            bool Flush();
+
+            /**
+             * @return `onMessage`, recording each message before handing it over.
+             */
+            Crt::Mqtt::OnMessageReceivedHandler Recording(Crt::Mqtt::OnMessageReceivedHandler &&onMessage);
+
+            uint64_t GetRecordCount() const;
+            uint64_t GetDroppedCount() const;
+
+            /**
+             * @return the recorder of `connection`, or null.
+             */
+            static std::shared_ptr<TrafficRecorder> Find(const Crt::Mqtt::MqttConnection &connection);
+
+            /**
+             * Starts recording `connection`'s traffic into a new file at `path`. A `maxBytes` of 0 does not
+             * bound the file.
+             *
+             * @return null, with the error raised, if the file could not be created, or with
+             * AWS_ERROR_INVALID_STATE if the connection is already being recorded.
+             */
+            static std::shared_ptr<TrafficRecorder> Create(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                const char *path,
+                uint64_t maxBytes = 0,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            TrafficRecorder(FILE *file, uint64_t maxBytes, Crt::Allocator *allocator) noexcept;
+
+            bool FlushLocked();
+
+            Crt::Allocator *m_allocator;
+            uint64_t m_maxBytes;
+            uint64_t m_startNs;
+
+            mutable std::mutex m_lock;
+            FILE *m_file;
+            Crt::Vector<uint8_t> m_buffer;
+            uint64_t m_bytes;
+            uint64_t m_recordCount;
+            uint64_t m_droppedCount;
+        };
+
+        /**
+         * A trace file written by a TrafficRecorder, memory-mapped for reading where the platform allows and
+         * read into memory otherwise. A record cut short by the recording process stopping mid-write ends the
+         * trace.
+         *
+         *     size_t offset = 0;
+         *     Iotdevicecommon::TrafficRecord record;
+         *     while (trace->Next(offset, record)) { ... }
+         */
+        class AWS_IOTDEVICECOMMON_API TrafficTrace final
+        {
+          public:
+            TrafficTrace(const TrafficTrace &) = delete;
+            TrafficTrace(TrafficTrace &&) = delete;
+            TrafficTrace &operator=(const TrafficTrace &) = delete;
+            TrafficTrace &operator=(TrafficTrace &&) = delete;
+
+            ~TrafficTrace();
+
+            /**
+             * Reads the record at `offset`, starting from 0, and moves `offset` past it.
+             *
+             * @return false at the end of the trace.
+             */
+            bool Next(size_t &offset, TrafficRecord &record) const noexcept;
+
+            size_t GetRecordCount() const noexcept { return m_recordCount; }
+
+            /**
+             * @return null, with the error raised, if the file could not be read or is not a trace.
+             */
+            static std::shared_ptr<TrafficTrace> Open(
+                const char *path,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            explicit TrafficTrace(Crt::Allocator *allocator) noexcept;
+
+            bool Load(const char *path);
+
+            Crt::Allocator *m_allocator;
+            const uint8_t *m_data;
+            size_t m_size;
+            bool m_mapped;
+            /* The records are those before m_end; the rest, if any, is a record cut short. */
+            size_t m_end;
+            size_t m_recordCount;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
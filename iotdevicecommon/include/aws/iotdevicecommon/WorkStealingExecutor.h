@@ -0,0 +1,110 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+#include <aws/iotdevicecommon/HandlerExecutor.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        /**
+         * A fixed-size thread pool for service client handlers. Tasks are grouped by ordering key (the thing
+         * name): tasks with the same key run one at a time in submission order, while different keys run in
+         * parallel. Each worker has its own run queue, and an idle worker steals keys from the others, so a burst
+         * for a few busy things does not leave cores idle.
+         *
+         * Pass AsHandlerExecutor() as ServiceClientConfig::HandlerExecutor. The executor must outlive the
+         * clients using it; tasks submitted after it is destroyed run inline on the caller's thread.
+         */
+        class AWS_IOTDEVICECOMMON_API WorkStealingExecutor final
+            : public std::enable_shared_from_this<WorkStealingExecutor>
+        {
+          public:
+            WorkStealingExecutor(const WorkStealingExecutor &) = delete;
+            WorkStealingExecutor(WorkStealingExecutor &&) = delete;
+            WorkStealingExecutor &operator=(const WorkStealingExecutor &) = delete;
+            WorkStealingExecutor &operator=(WorkStealingExecutor &&) = delete;
+
+            /**
+             * Runs every task already submitted, then joins the worker threads. Must not be called from a task.
+             */
+            ~WorkStealingExecutor();
+
+            /**
+             * Queues `task` behind any pending tasks with the same `orderingKey`.
+             *
+             * @return false if the executor is shutting down and the task was not queued.
+             */
+            bool Submit(const Crt::String &orderingKey, std::function<void()> &&task);
+
+            /**
+             * @return an executor for ServiceClientConfig::HandlerExecutor that submits to this pool. It holds a
+             * weak reference, so it does not keep the pool alive.
+             */
+            HandlerExecutor AsHandlerExecutor();
+
+            size_t GetThreadCount() const noexcept { return m_workers.size(); }
+
+            /**
+             * @param threadCount number of worker threads. Zero uses one per hardware thread.
+             * @return nullptr, with AWS_ERROR_SYS_CALL_FAILURE raised, if a worker thread could not be started.
+             */
+            static std::shared_ptr<WorkStealingExecutor> Create(
+                size_t threadCount = 0,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            /**
+             * The pending tasks of one ordering key. A strand is on at most one run queue at a time, which is
+             * what keeps its tasks serialized.
+             */
+            struct Strand
+            {
+                Crt::String key;
+                std::deque<std::function<void()>> tasks;
+                bool scheduled = false;
+            };
+
+            struct Worker
+            {
+                std::mutex lock;
+                std::deque<std::shared_ptr<Strand>> runQueue;
+                std::thread thread;
+            };
+
+            WorkStealingExecutor(size_t threadCount, Crt::Allocator *allocator);
+
+            bool Start();
+
+            void Schedule(const std::shared_ptr<Strand> &strand, size_t worker);
+            std::shared_ptr<Strand> NextStrand(size_t worker);
+            void RunWorker(size_t worker);
+
+            Crt::Allocator *m_allocator;
+            Crt::Vector<std::unique_ptr<Worker>> m_workers;
+
+            std::mutex m_strandsLock;
+            Crt::Map<Crt::String, std::shared_ptr<Strand>> m_strands;
+
+            std::mutex m_wakeLock;
+            std::condition_variable m_wake;
+            std::atomic<size_t> m_runnable;
+            bool m_stopping;
+        };
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,296 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/CborReader.h>
+
+#include <cmath>
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            const uint8_t s_majorUnsigned = 0;
+            const uint8_t s_majorNegative = 1;
+            const uint8_t s_majorBytes = 2;
+            const uint8_t s_majorText = 3;
+            const uint8_t s_majorArray = 4;
+            const uint8_t s_majorMap = 5;
+            const uint8_t s_majorTag = 6;
+
+            const uint8_t s_indefinite = 31;
+            const uint8_t s_break = 0xff;
+
+            /* Bounds recursion so a hostile payload cannot exhaust the stack. */
+            const size_t s_maxDepth = 128;
+
+            struct Head
+            {
+                uint8_t Major;
+                uint8_t Additional;
+                uint64_t Argument;
+            };
+
+            bool s_readHead(const uint8_t *&pos, const uint8_t *end, Head &head) noexcept
+            {
+                if (pos >= end)
+                {
+                    return false;
+                }
+
+                head.Major = static_cast<uint8_t>(*pos >> 5);
+                head.Additional = static_cast<uint8_t>(*pos & 0x1f);
+                head.Argument = head.Additional;
+                ++pos;
+
+                if (head.Additional < 24 || head.Additional == s_indefinite)
+                {
+                    return true;
+                }
+
+                if (head.Additional > 27)
+                {
+                    return false;
+                }
+
+                size_t argumentLength = static_cast<size_t>(1) << (head.Additional - 24);
+                if (static_cast<size_t>(end - pos) < argumentLength)
+                {
+                    return false;
+                }
+
+                head.Argument = 0;
+                for (size_t i = 0; i < argumentLength; ++i)
+                {
+                    head.Argument = head.Argument << 8 | *pos++;
+                }
+                return true;
+            }
+
+            bool s_atBreak(const uint8_t *&pos, const uint8_t *end) noexcept
+            {
+                if (pos < end && *pos == s_break)
+                {
+                    ++pos;
+                    return true;
+                }
+                return false;
+            }
+
+            bool s_readText(const uint8_t *&pos, const uint8_t *end, const Head &head, Crt::String &text)
+            {
+                if (head.Additional != s_indefinite)
+                {
+                    if (head.Argument > static_cast<uint64_t>(end - pos))
+                    {
+                        return false;
+                    }
+                    text.append(reinterpret_cast<const char *>(pos), static_cast<size_t>(head.Argument));
+                    pos += head.Argument;
+                    return true;
+                }
+
+                /* Indefinite-length text is a sequence of definite-length text chunks. */
+                while (!s_atBreak(pos, end))
+                {
+                    Head chunk;
+                    if (!s_readHead(pos, end, chunk) || chunk.Major != s_majorText ||
+                        chunk.Additional == s_indefinite || !s_readText(pos, end, chunk, text))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            double s_halfToDouble(uint16_t half) noexcept
+            {
+                int exponent = (half >> 10) & 0x1f;
+                int mantissa = half & 0x3ff;
+                double value = 0;
+
+                if (exponent == 0)
+                {
+                    value = std::ldexp(mantissa, -24);
+                }
+                else if (exponent != 31)
+                {
+                    value = std::ldexp(mantissa + 1024, exponent - 25);
+                }
+                else
+                {
+                    value = mantissa == 0 ? INFINITY : NAN;
+                }
+
+                return (half & 0x8000) ? -value : value;
+            }
+
+            bool s_readItem(const uint8_t *&pos, const uint8_t *end, Crt::JsonObject &item, size_t depth)
+            {
+                Head head;
+                if (depth > s_maxDepth || !s_readHead(pos, end, head))
+                {
+                    return false;
+                }
+
+                switch (head.Major)
+                {
+                    case s_majorUnsigned:
+                        if (head.Additional == s_indefinite)
+                        {
+                            return false;
+                        }
+                        if (head.Argument > static_cast<uint64_t>(INT64_MAX))
+                        {
+                            item.AsDouble(static_cast<double>(head.Argument));
+                        }
+                        else
+                        {
+                            item.AsInt64(static_cast<int64_t>(head.Argument));
+                        }
+                        return true;
+
+                    case s_majorNegative:
+                        if (head.Additional == s_indefinite)
+                        {
+                            return false;
+                        }
+                        if (head.Argument > static_cast<uint64_t>(INT64_MAX))
+                        {
+                            item.AsDouble(-1.0 - static_cast<double>(head.Argument));
+                        }
+                        else
+                        {
+                            item.AsInt64(-1 - static_cast<int64_t>(head.Argument));
+                        }
+                        return true;
+
+                    case s_majorBytes:
+                        return false;
+
+                    case s_majorText:
+                    {
+                        Crt::String text;
+                        if (!s_readText(pos, end, head, text))
+                        {
+                            return false;
+                        }
+                        item.AsString(text);
+                        return true;
+                    }
+
+                    case s_majorArray:
+                    {
+                        Crt::Vector<Crt::JsonObject> elements;
+                        for (uint64_t i = 0; head.Additional == s_indefinite || i < head.Argument; ++i)
+                        {
+                            if (head.Additional == s_indefinite && s_atBreak(pos, end))
+                            {
+                                break;
+                            }
+
+                            Crt::JsonObject element;
+                            if (!s_readItem(pos, end, element, depth + 1))
+                            {
+                                return false;
+                            }
+                            elements.push_back(std::move(element));
+                        }
+                        item.AsArray(std::move(elements));
+                        return true;
+                    }
+
+                    case s_majorMap:
+                    {
+                        Crt::JsonObject members;
+                        for (uint64_t i = 0; head.Additional == s_indefinite || i < head.Argument; ++i)
+                        {
+                            if (head.Additional == s_indefinite && s_atBreak(pos, end))
+                            {
+                                break;
+                            }
+
+                            Head keyHead;
+                            Crt::String key;
+                            Crt::JsonObject member;
+                            if (!s_readHead(pos, end, keyHead) || keyHead.Major != s_majorText ||
+                                !s_readText(pos, end, keyHead, key) || !s_readItem(pos, end, member, depth + 1))
+                            {
+                                return false;
+                            }
+                            members.WithObject(key, std::move(member));
+                        }
+                        item.AsObject(std::move(members));
+                        return true;
+                    }
+
+                    case s_majorTag:
+                        /* Tagged items carry semantics JSON cannot express; keep the content. */
+                        return head.Additional != s_indefinite && s_readItem(pos, end, item, depth + 1);
+
+                    default:
+                        break;
+                }
+
+                /* Major type 7: simple values and floats. */
+                switch (head.Additional)
+                {
+                    case 20:
+                        item.AsBool(false);
+                        return true;
+                    case 21:
+                        item.AsBool(true);
+                        return true;
+                    case 22:
+                    case 23:
+                        item.AsNull();
+                        return true;
+                    case 25:
+                        item.AsDouble(s_halfToDouble(static_cast<uint16_t>(head.Argument)));
+                        return true;
+                    case 26:
+                    {
+                        uint32_t bits = static_cast<uint32_t>(head.Argument);
+                        float value = 0;
+                        memcpy(&value, &bits, sizeof(value));
+                        item.AsDouble(value);
+                        return true;
+                    }
+                    case 27:
+                    {
+                        double value = 0;
+                        memcpy(&value, &head.Argument, sizeof(value));
+                        item.AsDouble(value);
+                        return true;
+                    }
+                    default:
+                        return false;
+                }
+            }
+        } // namespace
+
+        namespace CborReader
+        {
+            bool ToJsonObject(const Crt::ByteCursor &payload, Crt::JsonObject &document) noexcept
+            {
+                const uint8_t *pos = payload.ptr;
+                const uint8_t *end = payload.ptr + payload.len;
+
+                Crt::JsonObject decoded;
+                if (!s_readItem(pos, end, decoded, 0) || pos != end)
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                    return false;
+                }
+
+                document = std::move(decoded);
+                return true;
+            }
+        } // namespace CborReader
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
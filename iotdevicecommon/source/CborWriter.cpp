@@ -0,0 +1,271 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/CborWriter.h>
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            const uint8_t s_majorUnsigned = 0;
+            const uint8_t s_majorNegative = 1;
+            const uint8_t s_majorText = 3;
+            const uint8_t s_majorArray = 4;
+            const uint8_t s_majorMap = 5;
+
+            const uint8_t s_false = 0xf4;
+            const uint8_t s_true = 0xf5;
+            const uint8_t s_null = 0xf6;
+            const uint8_t s_float32 = 0xfa;
+            const uint8_t s_float64 = 0xfb;
+            const uint8_t s_break = 0xff;
+            const uint8_t s_indefiniteArray = 0x9f;
+            const uint8_t s_indefiniteMap = 0xbf;
+
+            /* Nesting limit for transcoded JSON values, matching the decoder. */
+            const size_t s_maxDepth = 128;
+        } // namespace
+
+        CborWriter::CborWriter(Crt::ByteBuf &buffer) noexcept
+            : m_buffer(buffer), m_failed(buffer.allocator == nullptr)
+        {
+        }
+
+        CborWriter &CborWriter::BeginObject() noexcept
+        {
+            Append(&s_indefiniteMap, 1);
+            return *this;
+        }
+
+        CborWriter &CborWriter::EndObject() noexcept
+        {
+            Append(&s_break, 1);
+            return *this;
+        }
+
+        CborWriter &CborWriter::BeginArray() noexcept
+        {
+            Append(&s_indefiniteArray, 1);
+            return *this;
+        }
+
+        CborWriter &CborWriter::EndArray() noexcept
+        {
+            Append(&s_break, 1);
+            return *this;
+        }
+
+        CborWriter &CborWriter::Key(const char *key) noexcept
+        {
+            AppendText(key, strlen(key));
+            return *this;
+        }
+
+        CborWriter &CborWriter::Key(const Crt::String &key) noexcept
+        {
+            AppendText(key.data(), key.size());
+            return *this;
+        }
+
+        CborWriter &CborWriter::String(const char *value) noexcept
+        {
+            AppendText(value, strlen(value));
+            return *this;
+        }
+
+        CborWriter &CborWriter::String(const Crt::String &value) noexcept
+        {
+            AppendText(value.data(), value.size());
+            return *this;
+        }
+
+        CborWriter &CborWriter::String(const Crt::ByteCursor &value) noexcept
+        {
+            AppendText(reinterpret_cast<const char *>(value.ptr), value.len);
+            return *this;
+        }
+
+        CborWriter &CborWriter::Bool(bool value) noexcept
+        {
+            Append(value ? &s_true : &s_false, 1);
+            return *this;
+        }
+
+        CborWriter &CborWriter::Integer(int32_t value) noexcept { return Int64(value); }
+
+        CborWriter &CborWriter::Int64(int64_t value) noexcept
+        {
+            if (value >= 0)
+            {
+                AppendHead(s_majorUnsigned, static_cast<uint64_t>(value));
+            }
+            else
+            {
+                /* Negative integers encode -1 - value, which is the bitwise complement. */
+                AppendHead(s_majorNegative, ~static_cast<uint64_t>(value));
+            }
+            return *this;
+        }
+
+        CborWriter &CborWriter::Double(double value) noexcept
+        {
+            uint8_t bytes[9];
+            if (std::isnan(value) || std::isinf(value) ||
+                (std::fabs(value) <= FLT_MAX && static_cast<double>(static_cast<float>(value)) == value))
+            {
+                float narrowed = static_cast<float>(value);
+                uint32_t bits = 0;
+                memcpy(&bits, &narrowed, sizeof(bits));
+                bytes[0] = s_float32;
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    bytes[1 + i] = static_cast<uint8_t>(bits >> (24 - 8 * i));
+                }
+                Append(bytes, 5);
+                return *this;
+            }
+
+            uint64_t bits = 0;
+            memcpy(&bits, &value, sizeof(bits));
+            bytes[0] = s_float64;
+            for (size_t i = 0; i < 8; ++i)
+            {
+                bytes[1 + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+            }
+            Append(bytes, 9);
+            return *this;
+        }
+
+        CborWriter &CborWriter::Null() noexcept
+        {
+            Append(&s_null, 1);
+            return *this;
+        }
+
+        CborWriter &CborWriter::Value(const Crt::JsonView &value) noexcept
+        {
+            AppendValue(value, 0);
+            return *this;
+        }
+
+        CborWriter::operator bool() const noexcept { return !m_failed; }
+
+        void CborWriter::AppendHead(uint8_t majorType, uint64_t argument) noexcept
+        {
+            uint8_t head[9];
+            size_t argumentLength = 0;
+            uint8_t additional = static_cast<uint8_t>(argument);
+
+            if (argument >= 24)
+            {
+                if (argument <= UINT8_MAX)
+                {
+                    additional = 24;
+                    argumentLength = 1;
+                }
+                else if (argument <= UINT16_MAX)
+                {
+                    additional = 25;
+                    argumentLength = 2;
+                }
+                else if (argument <= UINT32_MAX)
+                {
+                    additional = 26;
+                    argumentLength = 4;
+                }
+                else
+                {
+                    additional = 27;
+                    argumentLength = 8;
+                }
+            }
+
+            head[0] = static_cast<uint8_t>(majorType << 5 | additional);
+            for (size_t i = 0; i < argumentLength; ++i)
+            {
+                head[1 + i] = static_cast<uint8_t>(argument >> (8 * (argumentLength - 1 - i)));
+            }
+            Append(head, 1 + argumentLength);
+        }
+
+        void CborWriter::AppendText(const char *value, size_t length) noexcept
+        {
+            AppendHead(s_majorText, length);
+            Append(reinterpret_cast<const uint8_t *>(value), length);
+        }
+
+        void CborWriter::Append(const uint8_t *bytes, size_t length) noexcept
+        {
+            if (m_failed)
+            {
+                return;
+            }
+
+            Crt::ByteCursor cursor = aws_byte_cursor_from_array(bytes, length);
+            if (aws_byte_buf_append_dynamic(&m_buffer, &cursor))
+            {
+                m_failed = true;
+            }
+        }
+
+        void CborWriter::AppendValue(const Crt::JsonView &value, size_t depth) noexcept
+        {
+            if (depth > s_maxDepth)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                m_failed = true;
+                return;
+            }
+
+            if (value.IsObject())
+            {
+                auto members = value.GetAllObjects();
+                AppendHead(s_majorMap, members.size());
+                for (auto &member : members)
+                {
+                    AppendText(member.first.data(), member.first.size());
+                    AppendValue(member.second, depth + 1);
+                }
+            }
+            else if (value.IsListType())
+            {
+                auto elements = value.AsArray();
+                AppendHead(s_majorArray, elements.size());
+                for (auto &element : elements)
+                {
+                    AppendValue(element, depth + 1);
+                }
+            }
+            else if (value.IsString())
+            {
+                Crt::String text = value.AsString();
+                AppendText(text.data(), text.size());
+            }
+            else if (value.IsBool())
+            {
+                Bool(value.AsBool());
+            }
+            else if (value.IsIntegerType())
+            {
+                Int64(value.AsInt64());
+            }
+            else if (value.IsFloatingPointType())
+            {
+                Double(value.AsDouble());
+            }
+            else
+            {
+                Null();
+            }
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
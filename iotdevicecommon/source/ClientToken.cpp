@@ -0,0 +1,65 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/ClientToken.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/device_random.h>
+
+#include <atomic>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            /* Crockford's base 32, which leaves out the letters easily mistaken for digits. */
+            static const char s_alphabet[] = "0123456789abcdefghjkmnpqrstvwxyz";
+            static const size_t s_prefixLength = 7;
+            static const size_t s_counterLength = ClientTokenLength - s_prefixLength;
+
+            std::atomic<uint64_t> s_counter(0);
+
+            uint64_t s_processPrefix() noexcept
+            {
+                uint64_t prefix = 0;
+                if (aws_device_random_u64(&prefix) != AWS_OP_SUCCESS)
+                {
+                    /* No entropy source: the clock and an address still separate most processes. */
+                    aws_high_res_clock_get_ticks(&prefix);
+                    prefix ^= reinterpret_cast<uintptr_t>(&s_counter) * 0x9e3779b97f4a7c15ULL;
+                }
+                return prefix;
+            }
+
+            void s_encode(uint64_t value, char *out, size_t length) noexcept
+            {
+                for (size_t i = length; i > 0; --i)
+                {
+                    out[i - 1] = s_alphabet[value & 0x1f];
+                    value >>= 5;
+                }
+            }
+        } // namespace
+
+        void GenerateClientToken(char (&token)[ClientTokenLength + 1]) noexcept
+        {
+            static const uint64_t prefix = s_processPrefix();
+            uint64_t count = s_counter.fetch_add(1, std::memory_order_relaxed);
+
+            s_encode(prefix, token, s_prefixLength);
+            s_encode(count, token + s_prefixLength, s_counterLength);
+            token[ClientTokenLength] = '\0';
+        }
+
+        Crt::String GenerateClientToken()
+        {
+            char token[ClientTokenLength + 1];
+            GenerateClientToken(token);
+            return Crt::String(token, ClientTokenLength);
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
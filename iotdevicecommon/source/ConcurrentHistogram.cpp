@@ -0,0 +1,168 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/ConcurrentHistogram.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        const size_t LogLinearHistogram::SubBucketBits;
+        const size_t LogLinearHistogram::SubBucketCount;
+        const size_t LogLinearHistogram::MaxExponent;
+        const size_t LogLinearHistogram::BucketCount;
+        const size_t ConcurrentHistogram::StripeCount;
+
+        namespace
+        {
+            std::atomic<size_t> s_nextStripe(0);
+
+            /* Threads take stripes round-robin on their first record, which spreads them better than a hash. */
+            size_t s_threadStripe() noexcept
+            {
+                thread_local size_t stripe = s_nextStripe.fetch_add(1, std::memory_order_relaxed);
+                return stripe % ConcurrentHistogram::StripeCount;
+            }
+
+            void s_raiseMax(std::atomic<uint64_t> &max, uint64_t value) noexcept
+            {
+                uint64_t current = max.load(std::memory_order_relaxed);
+                while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+                {
+                }
+            }
+        } // namespace
+
+        LogLinearHistogram::LogLinearHistogram() noexcept : Buckets(), Count(0), TotalNs(0), MaxNs(0) {}
+
+        size_t LogLinearHistogram::BucketOf(uint64_t durationNs) noexcept
+        {
+            if (durationNs < SubBucketCount)
+            {
+                return static_cast<size_t>(durationNs);
+            }
+
+            size_t exponent = 0;
+            for (uint64_t value = durationNs; value >>= 1;)
+            {
+                ++exponent;
+            }
+            if (exponent >= MaxExponent)
+            {
+                return BucketCount - 1;
+            }
+
+            /* The top SubBucketBits bits below the leading one pick the sub-bucket. */
+            size_t shift = exponent - SubBucketBits;
+            return (shift + 1) * SubBucketCount + static_cast<size_t>((durationNs >> shift) - SubBucketCount);
+        }
+
+        uint64_t LogLinearHistogram::BucketUpperBoundNs(size_t bucket) noexcept
+        {
+            if (bucket < SubBucketCount)
+            {
+                return bucket;
+            }
+            if (bucket >= BucketCount - 1)
+            {
+                return UINT64_MAX;
+            }
+
+            size_t shift = bucket / SubBucketCount - 1;
+            uint64_t subBucket = SubBucketCount + bucket % SubBucketCount;
+            return ((subBucket + 1) << shift) - 1;
+        }
+
+        void LogLinearHistogram::Record(uint64_t durationNs) noexcept
+        {
+            ++Buckets[BucketOf(durationNs)];
+            ++Count;
+            TotalNs += durationNs;
+            if (durationNs > MaxNs)
+            {
+                MaxNs = durationNs;
+            }
+        }
+
+        void LogLinearHistogram::Merge(const LogLinearHistogram &other) noexcept
+        {
+            for (size_t i = 0; i < BucketCount; ++i)
+            {
+                Buckets[i] += other.Buckets[i];
+            }
+            Count += other.Count;
+            TotalNs += other.TotalNs;
+            if (other.MaxNs > MaxNs)
+            {
+                MaxNs = other.MaxNs;
+            }
+        }
+
+        uint64_t LogLinearHistogram::ValueAtPercentile(double percentile) const noexcept
+        {
+            if (Count == 0)
+            {
+                return 0;
+            }
+
+            /* nearest rank */
+            uint64_t rank = static_cast<uint64_t>(percentile * static_cast<double>(Count) + 0.5);
+            rank = rank ? rank : 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BucketCount; ++i)
+            {
+                seen += Buckets[i];
+                if (seen >= rank)
+                {
+                    uint64_t bound = BucketUpperBoundNs(i);
+                    return bound < MaxNs ? bound : MaxNs;
+                }
+            }
+            return MaxNs;
+        }
+
+        ConcurrentHistogram::ConcurrentHistogram() noexcept { Reset(); }
+
+        void ConcurrentHistogram::Record(uint64_t durationNs) noexcept
+        {
+            Stripe &stripe = m_stripes[s_threadStripe()];
+            stripe.Buckets[LogLinearHistogram::BucketOf(durationNs)].fetch_add(1, std::memory_order_relaxed);
+            stripe.TotalNs.fetch_add(durationNs, std::memory_order_relaxed);
+            stripe.Count.fetch_add(1, std::memory_order_relaxed);
+            s_raiseMax(stripe.MaxNs, durationNs);
+        }
+
+        LogLinearHistogram ConcurrentHistogram::GetSnapshot() const noexcept
+        {
+            LogLinearHistogram snapshot;
+            for (const Stripe &stripe : m_stripes)
+            {
+                for (size_t i = 0; i < LogLinearHistogram::BucketCount; ++i)
+                {
+                    snapshot.Buckets[i] += stripe.Buckets[i].load(std::memory_order_relaxed);
+                }
+                snapshot.Count += stripe.Count.load(std::memory_order_relaxed);
+                snapshot.TotalNs += stripe.TotalNs.load(std::memory_order_relaxed);
+                uint64_t maxNs = stripe.MaxNs.load(std::memory_order_relaxed);
+                snapshot.MaxNs = maxNs > snapshot.MaxNs ? maxNs : snapshot.MaxNs;
+            }
+            return snapshot;
+        }
+
+        void ConcurrentHistogram::Reset() noexcept
+        {
+            for (Stripe &stripe : m_stripes)
+            {
+                for (std::atomic<uint64_t> &bucket : stripe.Buckets)
+                {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+                stripe.Count.store(0, std::memory_order_relaxed);
+                stripe.TotalNs.store(0, std::memory_order_relaxed);
+                stripe.MaxNs.store(0, std::memory_order_relaxed);
+            }
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,83 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/ConnectionShardRing.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        namespace
+        {
+            uint64_t s_fnv1a(const uint8_t *data, size_t length) noexcept
+            {
+                uint64_t hash = 14695981039346656037ULL;
+                for (size_t i = 0; i < length; ++i)
+                {
+                    hash ^= data[i];
+                    hash *= 1099511628211ULL;
+                }
+                return hash;
+            }
+        } // namespace
+
+        ConnectionShardRing::ConnectionShardRing(
+            size_t shardCount,
+            size_t pointsPerShard,
+            Crt::Allocator *allocator) noexcept
+            : m_shardCount(shardCount), m_points(allocator)
+        {
+            if (pointsPerShard == 0)
+            {
+                pointsPerShard = 1;
+            }
+
+            m_points.reserve(shardCount * pointsPerShard);
+            char pointName[48];
+            for (size_t shard = 0; shard < shardCount; ++shard)
+            {
+                for (size_t point = 0; point < pointsPerShard; ++point)
+                {
+                    int length = snprintf(pointName, sizeof(pointName), "shard-%zu-%zu", shard, point);
+                    m_points.push_back(
+                        {s_fnv1a(reinterpret_cast<const uint8_t *>(pointName), static_cast<size_t>(length)), shard});
+                }
+            }
+
+            std::sort(m_points.begin(), m_points.end(), [](const Point &lhs, const Point &rhs) {
+                return lhs.hash < rhs.hash || (lhs.hash == rhs.hash && lhs.shard < rhs.shard);
+            });
+        }
+
+        size_t ConnectionShardRing::ShardFor(const Crt::ByteCursor &key) const noexcept
+        {
+            if (m_points.empty())
+            {
+                return 0;
+            }
+
+            uint64_t hash = s_fnv1a(key.ptr, key.len);
+            auto owner = std::lower_bound(
+                m_points.begin(), m_points.end(), hash, [](const Point &point, uint64_t value) {
+                    return point.hash < value;
+                });
+            if (owner == m_points.end())
+            {
+                owner = m_points.begin();
+            }
+            return owner->shard;
+        }
+
+        size_t ConnectionShardRing::ShardFor(const Crt::String &key) const noexcept
+        {
+            return ShardFor(Crt::ByteCursorFromArray(reinterpret_cast<const uint8_t *>(key.data()), key.length()));
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
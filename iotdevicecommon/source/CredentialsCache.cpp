@@ -0,0 +1,43 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/CredentialsCache.h>
+
+#include <chrono>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        CredentialsCacheConfig::CredentialsCacheConfig() noexcept
+            : Provider(), MaxCacheTimeMs(15 * 60 * 1000), Prefetch(true)
+        {
+        }
+
+        std::shared_ptr<Crt::Auth::ICredentialsProvider> CreateCachedCredentialsProvider(
+            const CredentialsCacheConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (!config.Provider || config.MaxCacheTimeMs == 0)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            /* The cached provider honors the credentials' expiration, and queues callers behind one fetch. */
+            Crt::Auth::CredentialsProviderCachedConfig cachedConfig;
+            cachedConfig.Provider = config.Provider;
+            cachedConfig.CachedCredentialTTL = std::chrono::milliseconds(config.MaxCacheTimeMs);
+            std::shared_ptr<Crt::Auth::ICredentialsProvider> cached =
+                Crt::Auth::CredentialsProvider::CreateCredentialsProviderCached(cachedConfig, allocator);
+
+            if (cached && config.Prefetch)
+            {
+                cached->GetCredentials([](std::shared_ptr<Crt::Auth::Credentials>, int) {});
+            }
+            return cached;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,549 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/DurablePublishQueue.h>
+
+#include <aws/checksums/crc.h>
+#include <aws/common/file.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            static const uint32_t s_recordMagic = 0x514f4944;
+            static const uint8_t s_publishRecord = 1;
+            static const uint8_t s_removalRecord = 2;
+            /* magic, type, sequence, body length, crc */
+            static const size_t s_recordHeaderSize = 4 + 1 + 8 + 4 + 4;
+            static const size_t s_compactionSlack = 64;
+
+            void s_putInteger(Crt::String &out, uint64_t value, size_t bytes)
+            {
+                for (size_t i = 0; i < bytes; ++i)
+                {
+                    out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+                }
+            }
+
+            void s_putString(Crt::String &out, const Crt::String &value)
+            {
+                s_putInteger(out, value.size(), 4);
+                out.append(value);
+            }
+
+            /* Bounds-checked little-endian reads over a recovered file. */
+            struct RecordReader
+            {
+                const uint8_t *Position;
+                size_t Remaining;
+
+                bool Integer(uint64_t &value, size_t bytes)
+                {
+                    if (Remaining < bytes)
+                    {
+                        return false;
+                    }
+                    value = 0;
+                    for (size_t i = 0; i < bytes; ++i)
+                    {
+                        value |= static_cast<uint64_t>(Position[i]) << (8 * i);
+                    }
+                    Position += bytes;
+                    Remaining -= bytes;
+                    return true;
+                }
+
+                bool String(Crt::String &value)
+                {
+                    uint64_t length = 0;
+                    if (!Integer(length, 4) || Remaining < length)
+                    {
+                        return false;
+                    }
+                    value.assign(reinterpret_cast<const char *>(Position), static_cast<size_t>(length));
+                    Position += length;
+                    Remaining -= static_cast<size_t>(length);
+                    return true;
+                }
+            };
+
+            Crt::String s_record(uint8_t type, uint64_t sequence, const Crt::String &body)
+            {
+                Crt::String record;
+                record.reserve(s_recordHeaderSize + body.size());
+                s_putInteger(record, s_recordMagic, 4);
+                s_putInteger(record, type, 1);
+                s_putInteger(record, sequence, 8);
+                s_putInteger(record, body.size(), 4);
+
+                /* The checksum covers the type, sequence and length as well as the body. */
+                uint32_t crc = aws_checksums_crc32(reinterpret_cast<const uint8_t *>(record.data() + 4), 13, 0);
+                crc = aws_checksums_crc32(
+                    reinterpret_cast<const uint8_t *>(body.data()), static_cast<int>(body.size()), crc);
+                s_putInteger(record, crc, 4);
+                record.append(body);
+                return record;
+            }
+
+            bool s_write(FILE *file, const Crt::String &record)
+            {
+                if (!file)
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_STATE);
+                    return false;
+                }
+                if (fwrite(record.data(), 1, record.size(), file) != record.size() || fflush(file) != 0)
+                {
+                    aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                    return false;
+                }
+                return true;
+            }
+        } // namespace
+
+        DurablePublishQueueConfig::DurablePublishQueueConfig() noexcept : MaxInFlight(8), MaxQueuedBytes(1024 * 1024)
+        {
+        }
+
+        DurablePublishQueue::DurablePublishQueue(const char *path, const DurablePublishQueueConfig &config) noexcept
+            : m_path(path), m_config(config), m_lock(), m_file(nullptr), m_recordCount(0), m_nextSequence(1),
+              m_queuedBytes(0), m_entries(), m_coalesced(), m_connection(), m_inFlight(0)
+        {
+            if (m_config.MaxInFlight == 0)
+            {
+                m_config.MaxInFlight = 1;
+            }
+        }
+
+        DurablePublishQueue::~DurablePublishQueue()
+        {
+            if (m_file)
+            {
+                fclose(m_file);
+            }
+        }
+
+        std::shared_ptr<DurablePublishQueue> DurablePublishQueue::Open(
+            const char *path,
+            const DurablePublishQueueConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<DurablePublishQueue *>(aws_mem_acquire(allocator, sizeof(DurablePublishQueue)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) DurablePublishQueue(path, config);
+            std::shared_ptr<DurablePublishQueue> queue(
+                toSeat, [allocator](DurablePublishQueue *publishQueue) { Crt::Delete(publishQueue, allocator); });
+
+            std::lock_guard<std::mutex> lock(queue->m_lock);
+            if (!queue->Load())
+            {
+                return nullptr;
+            }
+            return queue;
+        }
+
+        bool DurablePublishQueue::Load()
+        {
+            Crt::String contents;
+            FILE *existing = aws_fopen(m_path.c_str(), "rb");
+            if (existing)
+            {
+                char chunk[4096];
+                size_t read = 0;
+                while ((read = fread(chunk, 1, sizeof(chunk), existing)) > 0)
+                {
+                    contents.append(chunk, read);
+                }
+                fclose(existing);
+            }
+
+            RecordReader reader{reinterpret_cast<const uint8_t *>(contents.data()), contents.size()};
+            bool damaged = false;
+            while (reader.Remaining > 0)
+            {
+                const uint8_t *recordStart = reader.Position;
+                uint64_t magic = 0;
+                uint64_t type = 0;
+                uint64_t sequence = 0;
+                uint64_t bodyLength = 0;
+                uint64_t crc = 0;
+                if (!reader.Integer(magic, 4) || magic != s_recordMagic || !reader.Integer(type, 1) ||
+                    !reader.Integer(sequence, 8) || !reader.Integer(bodyLength, 4) || !reader.Integer(crc, 4) ||
+                    reader.Remaining < bodyLength)
+                {
+                    damaged = true;
+                    break;
+                }
+
+                uint32_t expected = aws_checksums_crc32(recordStart + 4, 13, 0);
+                expected = aws_checksums_crc32(reader.Position, static_cast<int>(bodyLength), expected);
+                if (expected != crc)
+                {
+                    damaged = true;
+                    break;
+                }
+
+                RecordReader body{reader.Position, static_cast<size_t>(bodyLength)};
+                reader.Position += bodyLength;
+                reader.Remaining -= static_cast<size_t>(bodyLength);
+                ++m_recordCount;
+                m_nextSequence = sequence >= m_nextSequence ? sequence + 1 : m_nextSequence;
+
+                auto existingEntry = m_entries.find(sequence);
+                if (existingEntry != m_entries.end())
+                {
+                    m_queuedBytes -= s_entryBytes(existingEntry->second);
+                    m_entries.erase(existingEntry);
+                }
+                if (type != s_publishRecord)
+                {
+                    continue;
+                }
+
+                Entry entry;
+                uint64_t qos = 0;
+                if (!body.Integer(qos, 1) || !body.String(entry.Topic) || !body.String(entry.CoalesceKey) ||
+                    !body.String(entry.Payload))
+                {
+                    damaged = true;
+                    continue;
+                }
+                entry.Qos = static_cast<Crt::Mqtt::QOS>(qos);
+                m_queuedBytes += s_entryBytes(entry);
+                if (!entry.CoalesceKey.empty())
+                {
+                    m_coalesced[entry.CoalesceKey] = sequence;
+                }
+                m_entries.emplace(sequence, std::move(entry));
+            }
+
+            /* Keys only point at publishes that are still queued. */
+            for (auto coalesced = m_coalesced.begin(); coalesced != m_coalesced.end();)
+            {
+                coalesced = m_entries.count(coalesced->second) ? std::next(coalesced) : m_coalesced.erase(coalesced);
+            }
+
+            if (damaged || m_recordCount > 2 * m_entries.size() + s_compactionSlack)
+            {
+                return CompactLocked();
+            }
+
+            m_file = aws_fopen(m_path.c_str(), "ab");
+            return m_file != nullptr;
+        }
+
+        bool DurablePublishQueue::Enqueue(
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteBuf &payload,
+            OnDelivered &&onDelivered,
+            const Crt::String &coalesceKey,
+            const MergePayloads &merge)
+        {
+            if (!topic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Entry entry;
+            entry.Topic = topic;
+            entry.Qos = qos;
+            entry.Payload.assign(reinterpret_cast<const char *>(payload.buffer), payload.len);
+            entry.CoalesceKey = coalesceKey;
+            entry.Handlers.push_back(std::move(onDelivered));
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+
+                auto superseded = m_entries.end();
+                if (!coalesceKey.empty())
+                {
+                    auto coalesced = m_coalesced.find(coalesceKey);
+                    if (coalesced != m_coalesced.end())
+                    {
+                        superseded = m_entries.find(coalesced->second);
+                    }
+                    if (superseded != m_entries.end() && superseded->second.InFlight)
+                    {
+                        superseded = m_entries.end();
+                    }
+                }
+
+                uint64_t supersededBytes = 0;
+                if (superseded != m_entries.end())
+                {
+                    Entry &older = superseded->second;
+                    supersededBytes = s_entryBytes(older);
+                    Crt::String merged;
+                    if (merge &&
+                        merge(
+                            aws_byte_cursor_from_array(older.Payload.data(), older.Payload.size()),
+                            aws_byte_cursor_from_array(entry.Payload.data(), entry.Payload.size()),
+                            merged))
+                    {
+                        entry.Payload = std::move(merged);
+                    }
+                }
+
+                uint64_t queuedBytes = m_queuedBytes - supersededBytes + s_entryBytes(entry);
+                if (m_config.MaxQueuedBytes && queuedBytes > m_config.MaxQueuedBytes)
+                {
+                    aws_raise_error(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE);
+                    return false;
+                }
+
+                uint64_t sequence = m_nextSequence++;
+                if (!AppendPublish(sequence, entry))
+                {
+                    return false;
+                }
+
+                if (superseded != m_entries.end())
+                {
+                    /* Should this record be lost, the superseded publish is simply sent before its replacement. */
+                    AppendRemoval(superseded->first);
+                    Crt::Vector<OnDelivered> handlers(std::move(superseded->second.Handlers));
+                    handlers.push_back(std::move(entry.Handlers.back()));
+                    entry.Handlers = std::move(handlers);
+                    m_entries.erase(superseded);
+                }
+
+                m_queuedBytes = queuedBytes;
+                if (!coalesceKey.empty())
+                {
+                    m_coalesced[coalesceKey] = sequence;
+                }
+                m_entries.emplace(sequence, std::move(entry));
+                CompactIfBloated();
+            }
+
+            Pump();
+            return true;
+        }
+
+        void DurablePublishQueue::Drain(const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_connection = connection;
+            }
+            Pump();
+        }
+
+        void DurablePublishQueue::Pause()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_connection.reset();
+        }
+
+        size_t DurablePublishQueue::GetQueuedCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_entries.size();
+        }
+
+        uint64_t DurablePublishQueue::GetQueuedBytes() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_queuedBytes;
+        }
+
+        void DurablePublishQueue::Pump()
+        {
+            std::weak_ptr<DurablePublishQueue> weakSelf = shared_from_this();
+            while (true)
+            {
+                std::shared_ptr<Crt::Mqtt::MqttConnection> connection;
+                uint64_t sequence = 0;
+                const Entry *next = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (!m_connection || m_inFlight >= m_config.MaxInFlight)
+                    {
+                        return;
+                    }
+
+                    for (auto &entry : m_entries)
+                    {
+                        if (!entry.second.InFlight)
+                        {
+                            entry.second.InFlight = true;
+                            sequence = entry.first;
+                            next = &entry.second;
+                            break;
+                        }
+                    }
+                    if (!next)
+                    {
+                        return;
+                    }
+
+                    ++m_inFlight;
+                    connection = m_connection;
+                }
+
+                /* In-flight entries are neither coalesced nor removed, so `next` outlives the publish. */
+                Crt::ByteBuf payload = aws_byte_buf_from_array(next->Payload.data(), next->Payload.size());
+                uint16_t packetId = connection->Publish(
+                    next->Topic.c_str(),
+                    next->Qos,
+                    false,
+                    payload,
+                    [weakSelf, sequence](Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                        auto self = weakSelf.lock();
+                        if (self)
+                        {
+                            self->OnPublishComplete(sequence, errorCode);
+                        }
+                    });
+                if (packetId == 0)
+                {
+                    OnPublishComplete(sequence, Crt::LastErrorOrUnknown());
+                    return;
+                }
+            }
+        }
+
+        void DurablePublishQueue::OnPublishComplete(uint64_t sequence, int errorCode)
+        {
+            Crt::Vector<OnDelivered> handlers;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto entry = m_entries.find(sequence);
+                if (entry == m_entries.end())
+                {
+                    return;
+                }
+
+                --m_inFlight;
+                if (errorCode)
+                {
+                    /* Keep it for the next Drain rather than spin on a connection that is failing. */
+                    entry->second.InFlight = false;
+                    m_connection.reset();
+                    return;
+                }
+
+                AppendRemoval(sequence);
+                handlers = std::move(entry->second.Handlers);
+                auto coalesced = m_coalesced.find(entry->second.CoalesceKey);
+                if (coalesced != m_coalesced.end() && coalesced->second == sequence)
+                {
+                    m_coalesced.erase(coalesced);
+                }
+                m_queuedBytes -= s_entryBytes(entry->second);
+                m_entries.erase(entry);
+                CompactIfBloated();
+            }
+
+            for (const OnDelivered &handler : handlers)
+            {
+                if (handler)
+                {
+                    handler(AWS_ERROR_SUCCESS);
+                }
+            }
+
+            Pump();
+        }
+
+        bool DurablePublishQueue::AppendPublish(uint64_t sequence, const Entry &entry)
+        {
+            Crt::String body;
+            body.reserve(1 + 12 + entry.Topic.size() + entry.CoalesceKey.size() + entry.Payload.size());
+            s_putInteger(body, static_cast<uint64_t>(entry.Qos), 1);
+            s_putString(body, entry.Topic);
+            s_putString(body, entry.CoalesceKey);
+            s_putString(body, entry.Payload);
+            if (!s_write(m_file, s_record(s_publishRecord, sequence, body)))
+            {
+                return false;
+            }
+            ++m_recordCount;
+            return true;
+        }
+
+        bool DurablePublishQueue::AppendRemoval(uint64_t sequence)
+        {
+            if (!s_write(m_file, s_record(s_removalRecord, sequence, Crt::String())))
+            {
+                return false;
+            }
+            ++m_recordCount;
+            return true;
+        }
+
+        void DurablePublishQueue::CompactIfBloated()
+        {
+            if (m_recordCount > 2 * m_entries.size() + s_compactionSlack)
+            {
+                /* A failed compaction leaves the complete log in place; carry on appending to it. */
+                CompactLocked();
+            }
+        }
+
+        bool DurablePublishQueue::CompactLocked()
+        {
+            Crt::String compactedPath(m_path);
+            compactedPath.append(".tmp");
+
+            FILE *compacted = aws_fopen(compactedPath.c_str(), "wb");
+            if (!compacted)
+            {
+                return false;
+            }
+
+            FILE *current = m_file;
+            m_file = compacted;
+            size_t recordCount = m_recordCount;
+            m_recordCount = 0;
+            bool written = true;
+            for (const auto &entry : m_entries)
+            {
+                written = written && AppendPublish(entry.first, entry.second);
+            }
+            fclose(compacted);
+            m_file = current;
+            if (!written)
+            {
+                m_recordCount = recordCount;
+                remove(compactedPath.c_str());
+                return false;
+            }
+
+            if (m_file)
+            {
+                fclose(m_file);
+                m_file = nullptr;
+            }
+
+            /* Windows will not rename over an existing file. */
+            if (rename(compactedPath.c_str(), m_path.c_str()) != 0 &&
+                (remove(m_path.c_str()) != 0 || rename(compactedPath.c_str(), m_path.c_str()) != 0))
+            {
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                m_recordCount = recordCount;
+                m_file = aws_fopen(m_path.c_str(), "ab");
+                return false;
+            }
+
+            m_file = aws_fopen(m_path.c_str(), "ab");
+            return m_file != nullptr;
+        }
+
+        uint64_t DurablePublishQueue::s_entryBytes(const Entry &entry) noexcept
+        {
+            return entry.Topic.size() + entry.Payload.size();
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
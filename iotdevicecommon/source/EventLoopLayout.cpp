@@ -0,0 +1,255 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/EventLoopLayout.h>
+
+#include <aws/common/system_info.h>
+#include <aws/common/task_scheduler.h>
+#include <aws/io/event_loop.h>
+
+#include <future>
+
+#ifdef __linux__
+#    include <pthread.h>
+#    include <sched.h>
+#endif
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            const size_t s_roleCount = 4;
+            const uint16_t s_reportTasksPerLoop = 64;
+
+            /* Enough for the handful of endpoints one role's connections resolve. */
+            const size_t s_maxResolvedHosts = 8;
+            const size_t s_maxResolvedTtlSeconds = 30;
+
+            struct PinTask
+            {
+                aws_task Task;
+                int Core;
+                std::promise<bool> Pinned;
+
+                static void s_run(aws_task *, void *arg, aws_task_status status)
+                {
+                    auto *pin = static_cast<PinTask *>(arg);
+                    bool pinned = false;
+#ifdef __linux__
+                    if (status == AWS_TASK_STATUS_RUN_READY)
+                    {
+                        cpu_set_t cores;
+                        CPU_ZERO(&cores);
+                        CPU_SET(pin->Core, &cores);
+                        pinned = pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores) == 0;
+                    }
+#else
+                    (void)status;
+#endif
+                    pin->Pinned.set_value(pinned);
+                }
+            };
+
+            void s_loopCounts(const EventLoopLayoutConfig &config, uint16_t (&counts)[s_roleCount])
+            {
+                counts[static_cast<size_t>(EventLoopRole::Mqtt)] = config.MqttConnections ? config.MqttConnections : 1;
+                counts[static_cast<size_t>(EventLoopRole::SecureTunnel)] = config.SecureTunnels;
+                counts[static_cast<size_t>(EventLoopRole::DeviceDefender)] =
+                    static_cast<uint16_t>((config.ReportTasks + s_reportTasksPerLoop - 1) / s_reportTasksPerLoop);
+                counts[static_cast<size_t>(EventLoopRole::Handlers)] = config.HandlerLoops;
+
+                size_t maxLoops = config.MaxLoops ? config.MaxLoops : aws_system_info_processor_count();
+                size_t total = 0;
+                for (uint16_t count : counts)
+                {
+                    total += count;
+                }
+
+                /* Cut the largest role back first; every role that asked for loops keeps one. */
+                while (total > maxLoops)
+                {
+                    size_t largest = 0;
+                    for (size_t i = 1; i < s_roleCount; ++i)
+                    {
+                        if (counts[i] > counts[largest])
+                        {
+                            largest = i;
+                        }
+                    }
+                    if (counts[largest] <= 1)
+                    {
+                        break;
+                    }
+                    --counts[largest];
+                    --total;
+                }
+            }
+        } // namespace
+
+        struct EventLoopLayout::Role
+        {
+            Role(uint16_t loopCount, Crt::Allocator *allocator)
+                : Group(loopCount, allocator),
+                  Resolver(Group, s_maxResolvedHosts, s_maxResolvedTtlSeconds, allocator),
+                  Bootstrap(Group, Resolver, allocator), Cores(Crt::StlAllocator<int>(allocator))
+            {
+            }
+
+            Crt::Io::EventLoopGroup Group;
+            Crt::Io::DefaultHostResolver Resolver;
+            Crt::Io::ClientBootstrap Bootstrap;
+            /* The core each loop is pinned to, or -1. */
+            Crt::Vector<int> Cores;
+        };
+
+        struct EventLoopLayout::HandlerTask
+        {
+            aws_task Task;
+            std::function<void()> Work;
+            Crt::Allocator *Allocator;
+
+            static void s_run(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *handlerTask = static_cast<HandlerTask *>(arg);
+                if (status == AWS_TASK_STATUS_RUN_READY)
+                {
+                    handlerTask->Work();
+                }
+                Crt::Delete(handlerTask, handlerTask->Allocator);
+            }
+        };
+
+        EventLoopLayoutConfig::EventLoopLayoutConfig() noexcept
+            : MqttConnections(1), SecureTunnels(0), ReportTasks(0), HandlerLoops(0), MaxLoops(0), PinToCores(true),
+              FirstCore(0)
+        {
+        }
+
+        EventLoopLayout::EventLoopLayout(Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_roles(Crt::StlAllocator<std::shared_ptr<Role>>(allocator))
+        {
+        }
+
+        uint16_t EventLoopLayout::LoopsFor(const EventLoopLayoutConfig &config, EventLoopRole role)
+        {
+            uint16_t counts[s_roleCount];
+            s_loopCounts(config, counts);
+            return counts[static_cast<size_t>(role)];
+        }
+
+        std::shared_ptr<EventLoopLayout> EventLoopLayout::Create(
+            const EventLoopLayoutConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<EventLoopLayout *>(aws_mem_acquire(allocator, sizeof(EventLoopLayout)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) EventLoopLayout(allocator);
+            std::shared_ptr<EventLoopLayout> layout(
+                toSeat, [allocator](EventLoopLayout *eventLoopLayout) { Crt::Delete(eventLoopLayout, allocator); });
+            if (!layout->Build(config))
+            {
+                return nullptr;
+            }
+            return layout;
+        }
+
+        bool EventLoopLayout::Build(const EventLoopLayoutConfig &config)
+        {
+            uint16_t counts[s_roleCount];
+            s_loopCounts(config, counts);
+            size_t processors = aws_system_info_processor_count();
+
+            size_t nextCore = config.FirstCore;
+            for (size_t i = 0; i < s_roleCount; ++i)
+            {
+                if (counts[i] == 0)
+                {
+                    m_roles.push_back(nullptr);
+                    continue;
+                }
+
+                auto role = Crt::MakeShared<Role>(m_allocator, counts[i], m_allocator);
+                if (!role || !role->Group || !role->Resolver || !role->Bootstrap)
+                {
+                    return false;
+                }
+
+                aws_event_loop_group *group = role->Group.GetUnderlyingHandle();
+                size_t loopCount = aws_event_loop_group_get_loop_count(group);
+                role->Cores.assign(loopCount, -1);
+                if (config.PinToCores && processors > 0)
+                {
+                    /* Pinned from each loop's own thread, which is the only way aws-c-io exposes it. */
+                    for (size_t loop = 0; loop < loopCount; ++loop, ++nextCore)
+                    {
+                        PinTask pin;
+                        pin.Core = static_cast<int>(nextCore % processors);
+                        aws_task_init(&pin.Task, PinTask::s_run, &pin, "EventLoopLayoutPin");
+                        std::future<bool> pinned = pin.Pinned.get_future();
+                        aws_event_loop_schedule_task_now(aws_event_loop_group_get_loop_at(group, loop), &pin.Task);
+                        if (pinned.get())
+                        {
+                            role->Cores[loop] = pin.Core;
+                        }
+                    }
+                }
+                m_roles.push_back(role);
+            }
+            return true;
+        }
+
+        EventLoopLayout::Role &EventLoopLayout::RoleOf(EventLoopRole role) const noexcept
+        {
+            const auto &found = m_roles[static_cast<size_t>(role)];
+            return found ? *found : *m_roles[static_cast<size_t>(EventLoopRole::Mqtt)];
+        }
+
+        Crt::Io::EventLoopGroup &EventLoopLayout::GetEventLoopGroup(EventLoopRole role) noexcept
+        {
+            return RoleOf(role).Group;
+        }
+
+        Crt::Io::ClientBootstrap &EventLoopLayout::GetBootstrap(EventLoopRole role) noexcept
+        {
+            return RoleOf(role).Bootstrap;
+        }
+
+        aws_event_loop *EventLoopLayout::GetLoop(EventLoopRole role, size_t index) noexcept
+        {
+            aws_event_loop_group *group = RoleOf(role).Group.GetUnderlyingHandle();
+            return aws_event_loop_group_get_loop_at(group, index % aws_event_loop_group_get_loop_count(group));
+        }
+
+        int EventLoopLayout::GetCore(EventLoopRole role, size_t index) const noexcept
+        {
+            const Role &found = RoleOf(role);
+            return found.Cores.empty() ? -1 : found.Cores[index % found.Cores.size()];
+        }
+
+        HandlerExecutor EventLoopLayout::GetHandlerExecutor(size_t index) noexcept
+        {
+            aws_event_loop *loop = GetLoop(EventLoopRole::Handlers, index);
+            Crt::Allocator *allocator = m_allocator;
+            /* Tasks scheduled now run in the order they were scheduled, so one loop keeps every key in order. */
+            return [loop, allocator](const Crt::String &, std::function<void()> &&task) {
+                auto *handlerTask = Crt::New<HandlerTask>(allocator);
+                if (!handlerTask)
+                {
+                    task();
+                    return;
+                }
+                handlerTask->Work = std::move(task);
+                handlerTask->Allocator = allocator;
+                aws_task_init(&handlerTask->Task, HandlerTask::s_run, handlerTask, "EventLoopLayoutHandler");
+                aws_event_loop_schedule_task_now(loop, &handlerTask->Task);
+            };
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,164 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/EventLoopMonitor.h>
+
+#include <aws/common/task_scheduler.h>
+#include <aws/io/event_loop.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        struct EventLoopMonitor::ProbeTask
+        {
+            aws_task Task;
+            std::weak_ptr<EventLoopMonitor> Monitor;
+            Crt::Allocator *Allocator;
+            size_t LoopIndex;
+            uint64_t DueNs;
+
+            static void s_run(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *probe = static_cast<ProbeTask *>(arg);
+                auto monitor = probe->Monitor.lock();
+                uint64_t nowNs = 0;
+                if (!monitor || status != AWS_TASK_STATUS_RUN_READY ||
+                    aws_event_loop_current_clock_time(monitor->m_loops[probe->LoopIndex], &nowNs) != AWS_OP_SUCCESS)
+                {
+                    Crt::Delete(probe, probe->Allocator);
+                    return;
+                }
+
+                monitor->OnProbe(probe, nowNs);
+                monitor->Schedule(probe);
+            }
+        };
+
+        EventLoopStats::EventLoopStats() noexcept
+            : LoopIndex(0), BusyNsPerSecond(0), Callbacks(0), CallbackNs(0), SchedulingLag(), LastLagNs(0),
+              MaxLagNs(0)
+        {
+        }
+
+        EventLoopMonitorConfig::EventLoopMonitorConfig() noexcept : EventLoopGroup(nullptr), SampleIntervalMs(1000)
+        {
+        }
+
+        EventLoopMonitor::EventLoopMonitor(const EventLoopMonitorConfig &config, Crt::Allocator *allocator) noexcept
+            : m_config(config), m_allocator(allocator), m_loops(Crt::StlAllocator<aws_event_loop *>(allocator)),
+              m_stats(Crt::StlAllocator<EventLoopStats>(allocator)), m_offLoopCallbacks(0)
+        {
+            aws_event_loop_group *group = config.EventLoopGroup->GetUnderlyingHandle();
+            size_t loopCount = aws_event_loop_group_get_loop_count(group);
+            for (size_t i = 0; i < loopCount; ++i)
+            {
+                m_loops.push_back(aws_event_loop_group_get_loop_at(group, i));
+            }
+            m_stats.resize(loopCount);
+            for (size_t i = 0; i < loopCount; ++i)
+            {
+                m_stats[i].LoopIndex = i;
+            }
+        }
+
+        std::shared_ptr<EventLoopMonitor> EventLoopMonitor::Create(
+            const EventLoopMonitorConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (!config.EventLoopGroup || !*config.EventLoopGroup || config.SampleIntervalMs == 0)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<EventLoopMonitor *>(aws_mem_acquire(allocator, sizeof(EventLoopMonitor)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) EventLoopMonitor(config, allocator);
+            std::shared_ptr<EventLoopMonitor> monitor(
+                toSeat, [allocator](EventLoopMonitor *eventLoopMonitor) { Crt::Delete(eventLoopMonitor, allocator); });
+
+            for (size_t i = 0; i < monitor->m_loops.size(); ++i)
+            {
+                auto *probe = Crt::New<ProbeTask>(allocator);
+                if (!probe)
+                {
+                    return nullptr;
+                }
+                probe->Monitor = monitor;
+                probe->Allocator = allocator;
+                probe->LoopIndex = i;
+                probe->DueNs = 0;
+                aws_task_init(&probe->Task, ProbeTask::s_run, probe, "EventLoopMonitorProbe");
+                monitor->Schedule(probe);
+            }
+            return monitor;
+        }
+
+        void EventLoopMonitor::Schedule(ProbeTask *probe)
+        {
+            aws_event_loop *loop = m_loops[probe->LoopIndex];
+            uint64_t nowNs = 0;
+            if (aws_event_loop_current_clock_time(loop, &nowNs) != AWS_OP_SUCCESS)
+            {
+                Crt::Delete(probe, probe->Allocator);
+                return;
+            }
+            probe->DueNs = nowNs + static_cast<uint64_t>(m_config.SampleIntervalMs) * 1000000;
+            aws_event_loop_schedule_task_future(loop, &probe->Task, probe->DueNs);
+        }
+
+        void EventLoopMonitor::OnProbe(ProbeTask *probe, uint64_t nowNs)
+        {
+            uint64_t lagNs = nowNs > probe->DueNs ? nowNs - probe->DueNs : 0;
+            size_t busyNs = aws_event_loop_get_load_factor(m_loops[probe->LoopIndex]);
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            EventLoopStats &stats = m_stats[probe->LoopIndex];
+            stats.BusyNsPerSecond = busyNs;
+            stats.SchedulingLag.Record(lagNs);
+            stats.LastLagNs = lagNs;
+            if (lagNs > stats.MaxLagNs)
+            {
+                stats.MaxLagNs = lagNs;
+            }
+        }
+
+        void EventLoopMonitor::RecordCallback(uint64_t durationNs)
+        {
+            /* Groups are a handful of loops, so a scan is cheaper than a thread-local lookup table. */
+            size_t loopIndex = 0;
+            while (loopIndex < m_loops.size() && !aws_event_loop_thread_is_callers_thread(m_loops[loopIndex]))
+            {
+                ++loopIndex;
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (loopIndex == m_loops.size())
+            {
+                ++m_offLoopCallbacks;
+                return;
+            }
+            EventLoopStats &stats = m_stats[loopIndex];
+            ++stats.Callbacks;
+            stats.CallbackNs += durationNs;
+        }
+
+        Crt::Vector<EventLoopStats> EventLoopMonitor::GetSnapshot() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_stats;
+        }
+
+        uint64_t EventLoopMonitor::GetOffLoopCallbackCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_offLoopCallbacks;
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
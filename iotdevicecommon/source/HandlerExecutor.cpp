@@ -0,0 +1,53 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/HandlerExecutor.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        namespace
+        {
+            bool s_segmentAfterPrefix(
+                const Crt::String &topic,
+                const char *prefix,
+                size_t prefixLength,
+                Crt::String &out)
+            {
+                if (topic.compare(0, prefixLength, prefix) != 0)
+                {
+                    return false;
+                }
+
+                size_t end = topic.find('/', prefixLength);
+                if (end == Crt::String::npos || end == prefixLength)
+                {
+                    return false;
+                }
+
+                out = topic.substr(prefixLength, end - prefixLength);
+                return true;
+            }
+        } // namespace
+
+        Crt::String OrderingKeyForTopic(const Crt::String &topic)
+        {
+            static const char s_thingsPrefix[] = "$aws/things/";
+            static const char s_templatesPrefix[] = "$aws/provisioning-templates/";
+
+            Crt::String key(topic.get_allocator());
+            if (s_segmentAfterPrefix(topic, s_thingsPrefix, sizeof(s_thingsPrefix) - 1, key) ||
+                s_segmentAfterPrefix(topic, s_templatesPrefix, sizeof(s_templatesPrefix) - 1, key))
+            {
+                return key;
+            }
+
+            return topic;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
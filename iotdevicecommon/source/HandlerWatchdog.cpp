@@ -0,0 +1,41 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/HandlerWatchdog.h>
+
+#include <aws/iotdevicecommon/HandlerExecutor.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        HandlerWatchdog::HandlerWatchdog(uint64_t thresholdNs, OnSlowHandler &&onSlowHandler) noexcept
+            : m_thresholdNs(thresholdNs), m_onSlowHandler(std::move(onSlowHandler)), m_slowHandlerCount(0),
+              m_maxDurationNs(0)
+        {
+        }
+
+        void HandlerWatchdog::Check(const Crt::String &topic, uint64_t durationNs)
+        {
+            uint64_t maxDuration = m_maxDurationNs.load();
+            while (durationNs > maxDuration && !m_maxDurationNs.compare_exchange_weak(maxDuration, durationNs))
+            {
+            }
+
+            if (durationNs <= m_thresholdNs)
+            {
+                return;
+            }
+
+            ++m_slowHandlerCount;
+            if (m_onSlowHandler)
+            {
+                m_onSlowHandler(topic, OrderingKeyForTopic(topic), durationNs);
+            }
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
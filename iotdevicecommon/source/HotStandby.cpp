@@ -0,0 +1,185 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/HotStandby.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        HotStandbyConfig::HotStandbyConfig() noexcept : Primary(), Standby(), OnFailover() {}
+
+        HotStandby::HotStandby(const HotStandbyConfig &config) noexcept
+            : m_connections{config.Primary, config.Standby}, m_onFailover(config.OnFailover), m_active(0),
+              m_failoverCount(0), m_up{true, true}
+        {
+        }
+
+        std::shared_ptr<HotStandby> HotStandby::Create(const HotStandbyConfig &config, Crt::Allocator *allocator)
+        {
+            if (!config.Primary || !config.Standby || config.Primary == config.Standby)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<HotStandby *>(aws_mem_acquire(allocator, sizeof(HotStandby)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) HotStandby(config);
+            std::shared_ptr<HotStandby> standby(
+                toSeat, [allocator](HotStandby *pair) { Crt::Delete(pair, allocator); });
+            standby->Chain(0);
+            standby->Chain(1);
+            return standby;
+        }
+
+        void HotStandby::Chain(size_t index)
+        {
+            /* The connections outlive their handlers' use of the pair only weakly, or neither would be freed. */
+            std::weak_ptr<HotStandby> weakPair = shared_from_this();
+            Crt::Mqtt::MqttConnection &connection = *m_connections[index];
+
+            auto onCompleted = std::move(connection.OnConnectionCompleted);
+            connection.OnConnectionCompleted = [weakPair, index, onCompleted](
+                                                   Crt::Mqtt::MqttConnection &completed,
+                                                   int errorCode,
+                                                   Crt::Mqtt::ReturnCode returnCode,
+                                                   bool sessionPresent) {
+                auto pair = weakPair.lock();
+                if (pair && errorCode == AWS_ERROR_SUCCESS)
+                {
+                    pair->OnUp(index);
+                }
+                if (onCompleted)
+                {
+                    onCompleted(completed, errorCode, returnCode, sessionPresent);
+                }
+            };
+
+            auto onInterrupted = std::move(connection.OnConnectionInterrupted);
+            connection.OnConnectionInterrupted =
+                [weakPair, index, onInterrupted](Crt::Mqtt::MqttConnection &interrupted, int errorCode) {
+                    if (auto pair = weakPair.lock())
+                    {
+                        pair->OnDown(index, errorCode);
+                    }
+                    if (onInterrupted)
+                    {
+                        onInterrupted(interrupted, errorCode);
+                    }
+                };
+
+            auto onResumed = std::move(connection.OnConnectionResumed);
+            connection.OnConnectionResumed = [weakPair, index, onResumed](
+                                                 Crt::Mqtt::MqttConnection &resumed,
+                                                 Crt::Mqtt::ReturnCode returnCode,
+                                                 bool sessionPresent) {
+                if (auto pair = weakPair.lock())
+                {
+                    pair->OnUp(index);
+                }
+                if (onResumed)
+                {
+                    onResumed(resumed, returnCode, sessionPresent);
+                }
+            };
+
+            auto onDisconnect = std::move(connection.OnDisconnect);
+            connection.OnDisconnect = [weakPair, index, onDisconnect](Crt::Mqtt::MqttConnection &disconnected) {
+                if (auto pair = weakPair.lock())
+                {
+                    pair->OnDown(index, AWS_ERROR_MQTT_NOT_CONNECTED);
+                }
+                if (onDisconnect)
+                {
+                    onDisconnect(disconnected);
+                }
+            };
+        }
+
+        void HotStandby::OnUp(size_t index)
+        {
+            bool tookOver = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_up[index] = true;
+                size_t active = m_active.load();
+                /* Sticky: a connection coming back takes over only from one that is down too. */
+                if (active != index && !m_up[active])
+                {
+                    m_active.store(index);
+                    ++m_failoverCount;
+                    tookOver = true;
+                }
+            }
+
+            if (tookOver && m_onFailover)
+            {
+                m_onFailover(*m_connections[index], AWS_ERROR_MQTT_NOT_CONNECTED);
+            }
+        }
+
+        void HotStandby::OnDown(size_t index, int errorCode)
+        {
+            size_t other = 1 - index;
+            bool tookOver = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_up[index] = false;
+                if (m_active.load() == index && m_up[other])
+                {
+                    m_active.store(other);
+                    ++m_failoverCount;
+                    tookOver = true;
+                }
+            }
+
+            if (tookOver && m_onFailover)
+            {
+                m_onFailover(*m_connections[other], errorCode);
+            }
+        }
+
+        std::shared_ptr<Crt::Mqtt::MqttConnection> HotStandby::GetActive() const noexcept
+        {
+            return m_connections[m_active.load()];
+        }
+
+        bool HotStandby::IsActive(const Crt::Mqtt::MqttConnection &connection) const noexcept
+        {
+            return m_connections[m_active.load()].get() == &connection;
+        }
+
+        std::shared_ptr<Crt::Mqtt::MqttConnection> HotStandby::GetPeer(
+            const Crt::Mqtt::MqttConnection &connection) const noexcept
+        {
+            if (m_connections[0].get() == &connection)
+            {
+                return m_connections[1];
+            }
+            if (m_connections[1].get() == &connection)
+            {
+                return m_connections[0];
+            }
+            return nullptr;
+        }
+
+        uint64_t HotStandby::GetFailoverCount() const noexcept { return m_failoverCount.load(); }
+
+        std::shared_ptr<Crt::Mqtt::MqttConnection> ActiveConnection(
+            const std::shared_ptr<HotStandby> &standby,
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection) noexcept
+        {
+            if (standby && connection && standby->GetPeer(*connection))
+            {
+                return standby->GetActive();
+            }
+            return connection;
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
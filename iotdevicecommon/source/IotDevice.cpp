@@ -6,6 +6,13 @@
 #include <aws/iotdevice/iotdevice.h>
 #include <aws/iotdevicecommon/IotDevice.h>
 
+#include <aws/common/clock.h>
+#include <aws/http/http.h>
+#include <aws/io/io.h>
+#include <aws/mqtt/mqtt.h>
+
+#include <mutex>
+
 namespace Aws
 {
 
@@ -16,10 +23,96 @@ namespace Aws
 
     namespace Iotdevicecommon
     {
+        namespace
+        {
+            /* Four init phases and one clean up phase. */
+            static const size_t s_maxPhases = 8;
+
+            std::mutex s_lock;
+            DeviceApiHandle *s_handle = nullptr;
+            StartupPhase s_phases[s_maxPhases];
+            size_t s_phaseCount = 0;
+
+            template <typename Step> void s_timePhase(const char *name, Step &&step)
+            {
+                uint64_t start = 0;
+                aws_high_res_clock_get_ticks(&start);
+                step();
+                uint64_t end = 0;
+                aws_high_res_clock_get_ticks(&end);
+
+                if (s_phaseCount < s_maxPhases)
+                {
+                    s_phases[s_phaseCount].Name = name;
+                    s_phases[s_phaseCount].DurationNs = end - start;
+                    ++s_phaseCount;
+                }
+            }
+
+            void s_initLibraries(Crt::Allocator *allocator)
+            {
+                /*
+                 * aws_iotdevice_library_init would initialize these itself; doing it one at a time first is
+                 * what lets each be timed. A library that is already initialized returns at once.
+                 */
+                s_phaseCount = 0;
+                s_timePhase("aws-c-io init", [allocator]() { aws_io_library_init(allocator); });
+                s_timePhase("aws-c-http init", [allocator]() { aws_http_library_init(allocator); });
+                s_timePhase("aws-c-mqtt init", [allocator]() { aws_mqtt_library_init(allocator); });
+                s_timePhase("aws-c-iot init", [allocator]() { aws_iotdevice_library_init(allocator); });
+            }
+        } // namespace
+
+        DeviceApiHandle::DeviceApiHandle(Crt::Allocator *allocator) noexcept
+            : DeviceApiHandle(allocator, DeviceApiInit::Eager)
+        {
+        }
+
+        DeviceApiHandle::DeviceApiHandle(Crt::Allocator *allocator, DeviceApiInit init) noexcept
+            : m_allocator(allocator), m_initialized(false)
+        {
+            std::lock_guard<std::mutex> lock(s_lock);
+            if (!s_handle)
+            {
+                s_handle = this;
+            }
+
+            if (init == DeviceApiInit::Eager)
+            {
+                s_initLibraries(m_allocator);
+                m_initialized = true;
+            }
+        }
+
+        DeviceApiHandle::~DeviceApiHandle()
+        {
+            std::lock_guard<std::mutex> lock(s_lock);
+            if (s_handle == this)
+            {
+                s_handle = nullptr;
+            }
+
+            if (m_initialized)
+            {
+                s_timePhase("aws-c-iot clean up", []() { aws_iotdevice_library_clean_up(); });
+            }
+        }
 
-        DeviceApiHandle::DeviceApiHandle(Crt::Allocator *allocator) noexcept { aws_iotdevice_library_init(allocator); }
+        void DeviceApiHandle::EnsureInitialized() noexcept
+        {
+            std::lock_guard<std::mutex> lock(s_lock);
+            if (s_handle && !s_handle->m_initialized)
+            {
+                s_initLibraries(s_handle->m_allocator);
+                s_handle->m_initialized = true;
+            }
+        }
 
-        DeviceApiHandle::~DeviceApiHandle() { aws_iotdevice_library_clean_up(); }
+        Crt::Vector<StartupPhase> DeviceApiHandle::GetStartupProfile()
+        {
+            std::lock_guard<std::mutex> lock(s_lock);
+            return Crt::Vector<StartupPhase>(s_phases, s_phases + s_phaseCount);
+        }
     } // namespace Iotdevicecommon
 
 } // namespace Aws
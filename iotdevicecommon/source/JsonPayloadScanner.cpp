@@ -0,0 +1,684 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/JsonPayloadScanner.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(AWS_IOTDEVICECOMMON_SIMD_JSON) && (defined(__SSE2__) || defined(_M_X64))
+#    define AWS_JSON_SCAN_SSE2
+#    include <emmintrin.h>
+#elif defined(AWS_IOTDEVICECOMMON_SIMD_JSON) && (defined(__aarch64__) || defined(_M_ARM64))
+#    define AWS_JSON_SCAN_NEON
+#    include <arm_neon.h>
+#endif
+
+#if (defined(AWS_JSON_SCAN_SSE2) || defined(AWS_JSON_SCAN_NEON)) && defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            /* Bounds nesting so a hostile payload cannot make the scan degrade; deeper values are rejected. */
+            static const size_t s_maxDepth = 128;
+
+            void s_skipWhitespace(const uint8_t *&pos, const uint8_t *end) noexcept
+            {
+                while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n'))
+                {
+                    ++pos;
+                }
+            }
+
+            /* Expects pos at the opening quote; leaves it one past the closing quote. */
+            bool s_skipString(const uint8_t *&pos, const uint8_t *end) noexcept
+            {
+                if (pos >= end || *pos != '"')
+                {
+                    return false;
+                }
+
+                for (++pos; pos < end; ++pos)
+                {
+                    if (*pos == '\\')
+                    {
+                        if (++pos >= end)
+                        {
+                            return false;
+                        }
+                    }
+                    else if (*pos == '"')
+                    {
+                        ++pos;
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+#if defined(AWS_JSON_SCAN_SSE2) || defined(AWS_JSON_SCAN_NEON)
+            /*
+             * Skipping a nested value is most of the work of a scan: FindMember passes over every member ahead of
+             * the one it wants, and the state, metadata and jobDocument members dwarf the rest. With
+             * AWS_IOTDEVICECOMMON_SIMD_JSON that is done the way simdjson's first stage does it: each 64-byte block
+             * is classified into one bit per byte, escapes and string interiors are resolved with integer
+             * arithmetic on those masks, and only the brackets left over are visited one by one.
+             */
+            struct BlockMasks
+            {
+                uint64_t Quote;
+                uint64_t Backslash;
+                uint64_t Open;
+                uint64_t Close;
+            };
+
+#    if defined(AWS_JSON_SCAN_NEON)
+            uint64_t s_moveMask(uint8x16_t matches) noexcept
+            {
+                static const uint8_t s_bitWeights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+                uint8x16_t bits = vandq_u8(matches, vld1q_u8(s_bitWeights));
+                return static_cast<uint64_t>(vaddv_u8(vget_low_u8(bits))) |
+                       static_cast<uint64_t>(vaddv_u8(vget_high_u8(bits))) << 8;
+            }
+#    endif
+
+            /* Bit i of each mask is set when byte i of the 64-byte block is that character. */
+            void s_classify(const uint8_t *block, BlockMasks &masks) noexcept
+            {
+                AWS_ZERO_STRUCT(masks);
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    const int shift = lane * 16;
+#    if defined(AWS_JSON_SCAN_SSE2)
+                    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + shift));
+                    /* Setting bit 5 maps '[' onto '{' and ']' onto '}', and no other byte onto either. */
+                    __m128i folded = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+                    auto mask = [](__m128i matches) {
+                        return static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(matches)));
+                    };
+                    masks.Quote |= mask(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('"'))) << shift;
+                    masks.Backslash |= mask(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\'))) << shift;
+                    masks.Open |= mask(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{'))) << shift;
+                    masks.Close |= mask(_mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))) << shift;
+#    else
+                    uint8x16_t bytes = vld1q_u8(block + shift);
+                    uint8x16_t folded = vorrq_u8(bytes, vdupq_n_u8(0x20));
+                    masks.Quote |= s_moveMask(vceqq_u8(bytes, vdupq_n_u8('"'))) << shift;
+                    masks.Backslash |= s_moveMask(vceqq_u8(bytes, vdupq_n_u8('\\'))) << shift;
+                    masks.Open |= s_moveMask(vceqq_u8(folded, vdupq_n_u8('{'))) << shift;
+                    masks.Close |= s_moveMask(vceqq_u8(folded, vdupq_n_u8('}'))) << shift;
+#    endif
+                }
+            }
+
+            /*
+             * The bytes escaped by a backslash: those after an odd-length run of backslashes. `carry` says
+             * whether the first byte of this block is escaped by the end of the last one, and is updated.
+             */
+            uint64_t s_escapedBytes(uint64_t backslash, uint64_t &carry) noexcept
+            {
+                const uint64_t evenBits = 0x5555555555555555ULL;
+                backslash &= ~carry;
+                uint64_t followsEscape = backslash << 1 | carry;
+                uint64_t oddSequenceStarts = backslash & ~evenBits & ~followsEscape;
+                uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+                carry = sequencesStartingOnEvenBits < oddSequenceStarts ? 1 : 0;
+                uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+                return (evenBits ^ invertMask) & followsEscape;
+            }
+
+            /* Bit i is the parity of bits 0 through i: set from an opening quote up to its closing one. */
+            uint64_t s_prefixXor(uint64_t bits) noexcept
+            {
+                bits ^= bits << 1;
+                bits ^= bits << 2;
+                bits ^= bits << 4;
+                bits ^= bits << 8;
+                bits ^= bits << 16;
+                bits ^= bits << 32;
+                return bits;
+            }
+
+            size_t s_lowestSet(uint64_t bits) noexcept
+            {
+#    ifdef _MSC_VER
+                unsigned long index = 0;
+                _BitScanForward64(&index, bits);
+                return static_cast<size_t>(index);
+#    else
+                return static_cast<size_t>(__builtin_ctzll(bits));
+#    endif
+            }
+
+            /* Expects pos at '{' or '['; leaves it one past the bracket that closes it. */
+            bool s_skipContainer(const uint8_t *&pos, const uint8_t *end) noexcept
+            {
+                uint64_t escapeCarry = 0;
+                uint64_t inStringCarry = 0;
+                size_t depth = 0;
+                uint8_t padded[64];
+
+                for (const uint8_t *block = pos; block < end; block += 64)
+                {
+                    const size_t available = static_cast<size_t>(end - block);
+                    const uint8_t *bytes = block;
+                    if (available < 64)
+                    {
+                        /* Spaces classify as nothing, so the padding cannot close a value. */
+                        memset(padded, ' ', sizeof(padded));
+                        memcpy(padded, block, available);
+                        bytes = padded;
+                    }
+
+                    BlockMasks masks;
+                    s_classify(bytes, masks);
+                    uint64_t quotes = masks.Quote & ~s_escapedBytes(masks.Backslash, escapeCarry);
+                    uint64_t inString = s_prefixXor(quotes) ^ inStringCarry;
+                    inStringCarry = (inString >> 63) ? ~0ULL : 0;
+
+                    for (uint64_t brackets = (masks.Open | masks.Close) & ~inString; brackets; brackets &= brackets - 1)
+                    {
+                        const size_t index = s_lowestSet(brackets);
+                        if ((masks.Open >> index) & 1)
+                        {
+                            if (++depth > s_maxDepth)
+                            {
+                                return false;
+                            }
+                        }
+                        else if (--depth == 0)
+                        {
+                            pos = block + index + 1;
+                            return true;
+                        }
+                    }
+
+                    if (available <= 64)
+                    {
+                        break;
+                    }
+                }
+
+                return false;
+            }
+#endif
+
+            bool s_skipValue(const uint8_t *&pos, const uint8_t *end) noexcept
+            {
+                if (pos >= end)
+                {
+                    return false;
+                }
+
+                if (*pos == '"')
+                {
+                    return s_skipString(pos, end);
+                }
+
+                if (*pos != '{' && *pos != '[')
+                {
+                    const uint8_t *start = pos;
+                    while (pos < end && *pos != ',' && *pos != '}' && *pos != ']' && *pos != ' ' && *pos != '\t' &&
+                           *pos != '\r' && *pos != '\n')
+                    {
+                        ++pos;
+                    }
+                    return pos != start;
+                }
+
+#if defined(AWS_JSON_SCAN_SSE2) || defined(AWS_JSON_SCAN_NEON)
+                return s_skipContainer(pos, end);
+#else
+                size_t depth = 0;
+                while (pos < end)
+                {
+                    if (*pos == '"')
+                    {
+                        if (!s_skipString(pos, end))
+                        {
+                            return false;
+                        }
+                        continue;
+                    }
+
+                    if (*pos == '{' || *pos == '[')
+                    {
+                        if (++depth > s_maxDepth)
+                        {
+                            return false;
+                        }
+                    }
+                    else if (*pos == '}' || *pos == ']')
+                    {
+                        if (--depth == 0)
+                        {
+                            ++pos;
+                            return true;
+                        }
+                    }
+                    ++pos;
+                }
+
+                return false;
+#endif
+            }
+
+            void s_trim(const uint8_t *&pos, const uint8_t *&end) noexcept
+            {
+                s_skipWhitespace(pos, end);
+                while (end > pos && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n'))
+                {
+                    --end;
+                }
+            }
+
+            bool s_readHex4(const uint8_t *&pos, const uint8_t *end, uint32_t &codeUnit) noexcept
+            {
+                if (end - pos < 4)
+                {
+                    return false;
+                }
+
+                codeUnit = 0;
+                for (int i = 0; i < 4; ++i, ++pos)
+                {
+                    uint8_t c = *pos;
+                    uint32_t digit = 0;
+                    if (c >= '0' && c <= '9')
+                    {
+                        digit = static_cast<uint32_t>(c - '0');
+                    }
+                    else if (c >= 'a' && c <= 'f')
+                    {
+                        digit = static_cast<uint32_t>(c - 'a' + 10);
+                    }
+                    else if (c >= 'A' && c <= 'F')
+                    {
+                        digit = static_cast<uint32_t>(c - 'A' + 10);
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                    codeUnit = (codeUnit << 4) | digit;
+                }
+                return true;
+            }
+
+            void s_appendUtf8(Crt::String &out, uint32_t codePoint)
+            {
+                if (codePoint < 0x80)
+                {
+                    out.push_back(static_cast<char>(codePoint));
+                }
+                else if (codePoint < 0x800)
+                {
+                    out.push_back(static_cast<char>(0xc0 | (codePoint >> 6)));
+                    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+                }
+                else if (codePoint < 0x10000)
+                {
+                    out.push_back(static_cast<char>(0xe0 | (codePoint >> 12)));
+                    out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(0xf0 | (codePoint >> 18)));
+                    out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
+                    out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+                }
+            }
+
+            /* Walks the values of an object (hasKeys) or array between its brackets. */
+            bool s_forEach(
+                const Crt::ByteCursor &container,
+                bool hasKeys,
+                const std::function<bool(const Crt::ByteCursor &key, const Crt::ByteCursor &value)> &onValue)
+            {
+                const uint8_t *pos = container.ptr;
+                const uint8_t *end = container.ptr + container.len;
+                const uint8_t open = hasKeys ? '{' : '[';
+                const uint8_t close = hasKeys ? '}' : ']';
+
+                s_skipWhitespace(pos, end);
+                if (pos >= end || *pos != open)
+                {
+                    return false;
+                }
+                ++pos;
+
+                s_skipWhitespace(pos, end);
+                if (pos < end && *pos == close)
+                {
+                    return true;
+                }
+
+                while (true)
+                {
+                    Crt::ByteCursor key;
+                    AWS_ZERO_STRUCT(key);
+                    if (hasKeys)
+                    {
+                        const uint8_t *keyStart = pos + 1;
+                        if (!s_skipString(pos, end))
+                        {
+                            return false;
+                        }
+                        key.ptr = const_cast<uint8_t *>(keyStart);
+                        key.len = static_cast<size_t>(pos - keyStart) - 1;
+
+                        s_skipWhitespace(pos, end);
+                        if (pos >= end || *pos != ':')
+                        {
+                            return false;
+                        }
+                        ++pos;
+                        s_skipWhitespace(pos, end);
+                    }
+
+                    const uint8_t *valueStart = pos;
+                    if (!s_skipValue(pos, end))
+                    {
+                        return false;
+                    }
+
+                    Crt::ByteCursor value;
+                    value.ptr = const_cast<uint8_t *>(valueStart);
+                    value.len = static_cast<size_t>(pos - valueStart);
+                    if (!onValue(key, value))
+                    {
+                        return false;
+                    }
+
+                    s_skipWhitespace(pos, end);
+                    if (pos < end && *pos == close)
+                    {
+                        return true;
+                    }
+                    if (pos >= end || *pos != ',')
+                    {
+                        return false;
+                    }
+                    ++pos;
+                    s_skipWhitespace(pos, end);
+                }
+            }
+        } // namespace
+
+        namespace JsonPayloadScanner
+        {
+            bool FindMember(const Crt::ByteCursor &object, const char *key, Crt::ByteCursor &value) noexcept
+            {
+                const uint8_t *pos = object.ptr;
+                const uint8_t *end = object.ptr + object.len;
+                const size_t keyLength = strlen(key);
+
+                s_skipWhitespace(pos, end);
+                if (pos >= end || *pos != '{')
+                {
+                    return false;
+                }
+                ++pos;
+
+                while (true)
+                {
+                    s_skipWhitespace(pos, end);
+                    if (pos < end && *pos == '}')
+                    {
+                        return false;
+                    }
+
+                    const uint8_t *keyStart = pos + 1;
+                    if (!s_skipString(pos, end))
+                    {
+                        return false;
+                    }
+                    const size_t encodedKeyLength = static_cast<size_t>(pos - keyStart) - 1;
+
+                    s_skipWhitespace(pos, end);
+                    if (pos >= end || *pos != ':')
+                    {
+                        return false;
+                    }
+                    ++pos;
+                    s_skipWhitespace(pos, end);
+
+                    const uint8_t *valueStart = pos;
+                    if (!s_skipValue(pos, end))
+                    {
+                        return false;
+                    }
+
+                    if (encodedKeyLength == keyLength && memcmp(keyStart, key, keyLength) == 0)
+                    {
+                        value.ptr = const_cast<uint8_t *>(valueStart);
+                        value.len = static_cast<size_t>(pos - valueStart);
+                        return true;
+                    }
+
+                    s_skipWhitespace(pos, end);
+                    if (pos >= end || *pos != ',')
+                    {
+                        return false;
+                    }
+                    ++pos;
+                }
+            }
+
+            bool ReadInteger(const Crt::ByteCursor &value, int64_t &integer) noexcept
+            {
+                const uint8_t *pos = value.ptr;
+                const uint8_t *end = value.ptr + value.len;
+                s_skipWhitespace(pos, end);
+
+                bool negative = pos < end && *pos == '-';
+                if (negative)
+                {
+                    ++pos;
+                }
+                if (pos >= end || *pos < '0' || *pos > '9')
+                {
+                    return false;
+                }
+
+                uint64_t magnitude = 0;
+                for (; pos < end && *pos >= '0' && *pos <= '9'; ++pos)
+                {
+                    uint64_t digit = static_cast<uint64_t>(*pos - '0');
+                    if (magnitude > (static_cast<uint64_t>(INT64_MAX) + 1 - digit) / 10)
+                    {
+                        return false;
+                    }
+                    magnitude = magnitude * 10 + digit;
+                }
+
+                s_skipWhitespace(pos, end);
+                if (pos != end || (!negative && magnitude > static_cast<uint64_t>(INT64_MAX)))
+                {
+                    /* Fractions, exponents and trailing bytes are not integers. */
+                    return false;
+                }
+
+                integer = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+                return true;
+            }
+
+            bool ForEachMember(const Crt::ByteCursor &object, const OnMember &onMember)
+            {
+                return s_forEach(object, true, onMember);
+            }
+
+            bool ForEachElement(const Crt::ByteCursor &array, const OnElement &onElement)
+            {
+                return s_forEach(
+                    array, false, [&onElement](const Crt::ByteCursor &, const Crt::ByteCursor &value) {
+                        return onElement(value);
+                    });
+            }
+
+            bool ReadBool(const Crt::ByteCursor &value, bool &boolean) noexcept
+            {
+                const uint8_t *pos = value.ptr;
+                const uint8_t *end = value.ptr + value.len;
+                s_trim(pos, end);
+
+                const size_t length = static_cast<size_t>(end - pos);
+                if (length == 4 && memcmp(pos, "true", 4) == 0)
+                {
+                    boolean = true;
+                    return true;
+                }
+                if (length == 5 && memcmp(pos, "false", 5) == 0)
+                {
+                    boolean = false;
+                    return true;
+                }
+                return false;
+            }
+
+            bool ReadDouble(const Crt::ByteCursor &value, double &number) noexcept
+            {
+                const uint8_t *pos = value.ptr;
+                const uint8_t *end = value.ptr + value.len;
+                s_trim(pos, end);
+
+                /* strtod needs a terminator, and would also accept hex, infinities and leading '+'. */
+                char digits[64];
+                const size_t length = static_cast<size_t>(end - pos);
+                if (length == 0 || length >= sizeof(digits) || (*pos != '-' && (*pos < '0' || *pos > '9')))
+                {
+                    return false;
+                }
+                for (const uint8_t *c = pos; c < end; ++c)
+                {
+                    if (!((*c >= '0' && *c <= '9') || *c == '-' || *c == '+' || *c == '.' || *c == 'e' || *c == 'E'))
+                    {
+                        return false;
+                    }
+                }
+
+                memcpy(digits, pos, length);
+                digits[length] = '\0';
+                char *parsedEnd = nullptr;
+                number = strtod(digits, &parsedEnd);
+                return parsedEnd == digits + length;
+            }
+
+            bool ReadString(const Crt::ByteCursor &value, Crt::String &string)
+            {
+                const uint8_t *pos = value.ptr;
+                const uint8_t *end = value.ptr + value.len;
+                s_trim(pos, end);
+                if (end - pos < 2 || *pos != '"' || end[-1] != '"')
+                {
+                    return false;
+                }
+                ++pos;
+                --end;
+
+                string.clear();
+                string.reserve(static_cast<size_t>(end - pos));
+                while (pos < end)
+                {
+                    if (*pos != '\\')
+                    {
+                        string.push_back(static_cast<char>(*pos++));
+                        continue;
+                    }
+
+                    if (++pos >= end)
+                    {
+                        return false;
+                    }
+                    switch (*pos++)
+                    {
+                        case '"':
+                            string.push_back('"');
+                            break;
+                        case '\\':
+                            string.push_back('\\');
+                            break;
+                        case '/':
+                            string.push_back('/');
+                            break;
+                        case 'b':
+                            string.push_back('\b');
+                            break;
+                        case 'f':
+                            string.push_back('\f');
+                            break;
+                        case 'n':
+                            string.push_back('\n');
+                            break;
+                        case 'r':
+                            string.push_back('\r');
+                            break;
+                        case 't':
+                            string.push_back('\t');
+                            break;
+                        case 'u':
+                        {
+                            uint32_t codePoint = 0;
+                            if (!s_readHex4(pos, end, codePoint))
+                            {
+                                return false;
+                            }
+                            if (codePoint >= 0xd800 && codePoint < 0xdc00)
+                            {
+                                uint32_t low = 0;
+                                if (end - pos < 6 || pos[0] != '\\' || pos[1] != 'u')
+                                {
+                                    return false;
+                                }
+                                pos += 2;
+                                if (!s_readHex4(pos, end, low) || low < 0xdc00 || low >= 0xe000)
+                                {
+                                    return false;
+                                }
+                                codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+                            }
+                            else if (codePoint >= 0xdc00 && codePoint < 0xe000)
+                            {
+                                return false;
+                            }
+                            s_appendUtf8(string, codePoint);
+                            break;
+                        }
+                        default:
+                            return false;
+                    }
+                }
+                return true;
+            }
+
+            const char *Backend() noexcept
+            {
+#if defined(AWS_JSON_SCAN_SSE2)
+                return "sse2";
+#elif defined(AWS_JSON_SCAN_NEON)
+                return "neon";
+#else
+                return "scalar";
+#endif
+            }
+
+            bool IsNull(const Crt::ByteCursor &value) noexcept
+            {
+                const uint8_t *pos = value.ptr;
+                const uint8_t *end = value.ptr + value.len;
+                s_trim(pos, end);
+                return end - pos == 4 && memcmp(pos, "null", 4) == 0;
+            }
+        } // namespace JsonPayloadScanner
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
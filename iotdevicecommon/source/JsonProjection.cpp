@@ -0,0 +1,112 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/JsonProjection.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        JsonProjection::JsonProjection(const Crt::Vector<Crt::String> &paths, Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_nodes(1)
+        {
+            for (const Crt::String &path : paths)
+            {
+                size_t node = 0;
+                size_t start = 0;
+                while (start <= path.size())
+                {
+                    size_t end = path.find('.', start);
+                    if (end == Crt::String::npos)
+                    {
+                        end = path.size();
+                    }
+                    if (end > start)
+                    {
+                        node = ChildNamed(node, path.substr(start, end - start));
+                    }
+                    start = end + 1;
+                }
+
+                /* An empty path selects nothing rather than the whole document. */
+                if (node != 0)
+                {
+                    m_nodes[node].Whole = true;
+                }
+            }
+        }
+
+        size_t JsonProjection::ChildNamed(size_t parent, const Crt::String &name)
+        {
+            for (size_t child : m_nodes[parent].Children)
+            {
+                if (m_nodes[child].Name == name)
+                {
+                    return child;
+                }
+            }
+
+            Node node;
+            node.Name = Crt::String(name.c_str(), Crt::StlAllocator<char>(m_allocator));
+            m_nodes.push_back(std::move(node));
+            m_nodes[parent].Children.push_back(m_nodes.size() - 1);
+            return m_nodes.size() - 1;
+        }
+
+        void JsonProjection::Apply(const Crt::JsonView &doc, Crt::JsonObject &out) const
+        {
+            out = Crt::JsonObject();
+            if (!doc.IsObject())
+            {
+                return;
+            }
+
+            for (const auto &member : doc.GetAllObjects())
+            {
+                if (!member.second.IsObject())
+                {
+                    out.WithObject(member.first, member.second.Materialize());
+                }
+            }
+
+            ApplyNode(0, doc, out);
+        }
+
+        void JsonProjection::ApplyNode(size_t node, const Crt::JsonView &doc, Crt::JsonObject &out) const
+        {
+            for (size_t childIndex : m_nodes[node].Children)
+            {
+                const Node &child = m_nodes[childIndex];
+                if (!doc.ValueExists(child.Name))
+                {
+                    continue;
+                }
+
+                Crt::JsonView value = doc.GetJsonObject(child.Name);
+                if (!value.IsObject())
+                {
+                    /* Top-level scalars were already copied by Apply. */
+                    if (node != 0)
+                    {
+                        out.WithObject(child.Name, value.Materialize());
+                    }
+                    continue;
+                }
+
+                if (child.Whole)
+                {
+                    out.WithObject(child.Name, value.Materialize());
+                    continue;
+                }
+
+                Crt::JsonObject projected;
+                ApplyNode(childIndex, value, projected);
+                out.WithObject(child.Name, std::move(projected));
+            }
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
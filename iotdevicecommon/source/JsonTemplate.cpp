@@ -0,0 +1,138 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/JsonTemplate.h>
+
+#include <aws/iotdevicecommon/JsonWriter.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            /* Room for the longest number either kind of value is written as. */
+            const size_t s_maxNumberLength = 32;
+
+            /* Writes the decimal digits of value, without snprintf, and returns their count. */
+            size_t s_formatInteger(int64_t value, char *out)
+            {
+                char digits[24];
+                size_t count = 0;
+                /* Unsigned, so that INT64_MIN negates. */
+                uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+                do
+                {
+                    digits[count++] = static_cast<char>('0' + magnitude % 10);
+                    magnitude /= 10;
+                } while (magnitude != 0);
+
+                size_t length = 0;
+                if (value < 0)
+                {
+                    out[length++] = '-';
+                }
+                while (count > 0)
+                {
+                    out[length++] = digits[--count];
+                }
+                return length;
+            }
+
+            /* Same encoding as JsonWriter::Double(). */
+            size_t s_formatReal(double value, char *out)
+            {
+                if (value * 0 != 0)
+                {
+                    memcpy(out, "null", 4);
+                    return 4;
+                }
+
+                int length = snprintf(out, s_maxNumberLength, "%1.15g", value);
+                if (strtod(out, nullptr) != value)
+                {
+                    length = snprintf(out, s_maxNumberLength, "%1.17g", value);
+                }
+                return static_cast<size_t>(length);
+            }
+        } // namespace
+
+        JsonTemplate::JsonTemplate(Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_text(Crt::StlAllocator<char>(allocator)),
+              m_slots(Crt::StlAllocator<size_t>(allocator)), m_failed(false)
+        {
+        }
+
+        JsonTemplate &JsonTemplate::Literal(const char *text, size_t length) noexcept
+        {
+            m_text.append(text, length);
+            return *this;
+        }
+
+        JsonTemplate &JsonTemplate::Quoted(const Crt::String &value) noexcept
+        {
+            Crt::ByteBuf quoted;
+            if (aws_byte_buf_init(&quoted, m_allocator, value.size() + 2))
+            {
+                m_failed = true;
+                return *this;
+            }
+
+            JsonWriter writer(quoted);
+            writer.String(value);
+            if (writer)
+            {
+                m_text.append(reinterpret_cast<const char *>(quoted.buffer), quoted.len);
+            }
+            else
+            {
+                m_failed = true;
+            }
+            aws_byte_buf_clean_up(&quoted);
+            return *this;
+        }
+
+        JsonTemplate &JsonTemplate::Slot() noexcept
+        {
+            m_slots.push_back(m_text.size());
+            return *this;
+        }
+
+        bool JsonTemplate::Render(const TemplateNumber *values, size_t count, Crt::ByteBuf &out) const noexcept
+        {
+            if (m_failed || count != m_slots.size() || (count > 0 && values == nullptr))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (aws_byte_buf_reserve_relative(&out, m_text.size() + count * s_maxNumberLength))
+            {
+                return false;
+            }
+
+            /* The buffer holds the longest rendering, so the appends below cannot fail. */
+            const char *text = m_text.data();
+            size_t copied = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                aws_byte_buf_write(&out, reinterpret_cast<const uint8_t *>(text + copied), m_slots[i] - copied);
+                copied = m_slots[i];
+
+                char number[s_maxNumberLength];
+                size_t length = values[i].IsInteger ? s_formatInteger(values[i].Integer, number)
+                                                    : s_formatReal(values[i].Real, number);
+                aws_byte_buf_write(&out, reinterpret_cast<const uint8_t *>(number), length);
+            }
+            aws_byte_buf_write(&out, reinterpret_cast<const uint8_t *>(text + copied), m_text.size() - copied);
+            return true;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
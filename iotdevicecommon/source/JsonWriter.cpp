@@ -0,0 +1,241 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/JsonWriter.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        JsonWriter::JsonWriter(Crt::ByteBuf &buffer) noexcept
+            : m_buffer(buffer), m_needsSeparator(false), m_failed(buffer.allocator == nullptr)
+        {
+        }
+
+        JsonWriter &JsonWriter::BeginObject() noexcept
+        {
+            BeginValue();
+            AppendLiteral("{");
+            m_needsSeparator = false;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::EndObject() noexcept
+        {
+            AppendLiteral("}");
+            m_needsSeparator = true;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::BeginArray() noexcept
+        {
+            BeginValue();
+            AppendLiteral("[");
+            m_needsSeparator = false;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::EndArray() noexcept
+        {
+            AppendLiteral("]");
+            m_needsSeparator = true;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::Key(const char *key) noexcept
+        {
+            BeginValue();
+            AppendQuoted(key, strlen(key));
+            AppendLiteral(":");
+            m_needsSeparator = false;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::Key(const Crt::String &key) noexcept
+        {
+            BeginValue();
+            AppendQuoted(key.data(), key.size());
+            AppendLiteral(":");
+            m_needsSeparator = false;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::String(const char *value) noexcept
+        {
+            BeginValue();
+            AppendQuoted(value, strlen(value));
+            m_needsSeparator = true;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::String(const Crt::String &value) noexcept
+        {
+            BeginValue();
+            AppendQuoted(value.data(), value.size());
+            m_needsSeparator = true;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::String(const Crt::ByteCursor &value) noexcept
+        {
+            BeginValue();
+            AppendQuoted(reinterpret_cast<const char *>(value.ptr), value.len);
+            m_needsSeparator = true;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::Bool(bool value) noexcept
+        {
+            BeginValue();
+            AppendLiteral(value ? "true" : "false");
+            m_needsSeparator = true;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::Integer(int32_t value) noexcept { return Int64(value); }
+
+        JsonWriter &JsonWriter::Int64(int64_t value) noexcept
+        {
+            char digits[24];
+            int length = snprintf(digits, sizeof(digits), "%" PRId64, value);
+
+            BeginValue();
+            Append(reinterpret_cast<const uint8_t *>(digits), static_cast<size_t>(length));
+            m_needsSeparator = true;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::Double(double value) noexcept
+        {
+            /* Same encoding as cJSON: non-finite values become null, and 17 digits are only used when 15 do
+             * not round-trip. */
+            if (value * 0 != 0)
+            {
+                return Null();
+            }
+
+            char digits[32];
+            int length = snprintf(digits, sizeof(digits), "%1.15g", value);
+            if (strtod(digits, nullptr) != value)
+            {
+                length = snprintf(digits, sizeof(digits), "%1.17g", value);
+            }
+
+            BeginValue();
+            Append(reinterpret_cast<const uint8_t *>(digits), static_cast<size_t>(length));
+            m_needsSeparator = true;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::Null() noexcept
+        {
+            BeginValue();
+            AppendLiteral("null");
+            m_needsSeparator = true;
+            return *this;
+        }
+
+        JsonWriter &JsonWriter::Value(const Crt::JsonView &value) noexcept
+        {
+            Crt::String encoded = value.WriteCompact(false);
+
+            BeginValue();
+            Append(reinterpret_cast<const uint8_t *>(encoded.data()), encoded.size());
+            m_needsSeparator = true;
+            return *this;
+        }
+
+        JsonWriter::operator bool() const noexcept { return !m_failed; }
+
+        void JsonWriter::BeginValue() noexcept
+        {
+            if (m_needsSeparator)
+            {
+                AppendLiteral(",");
+            }
+        }
+
+        void JsonWriter::Append(const uint8_t *bytes, size_t length) noexcept
+        {
+            if (m_failed)
+            {
+                return;
+            }
+
+            Crt::ByteCursor cursor = aws_byte_cursor_from_array(bytes, length);
+            if (aws_byte_buf_append_dynamic(&m_buffer, &cursor))
+            {
+                m_failed = true;
+            }
+        }
+
+        void JsonWriter::AppendLiteral(const char *literal) noexcept
+        {
+            Append(reinterpret_cast<const uint8_t *>(literal), strlen(literal));
+        }
+
+        void JsonWriter::AppendQuoted(const char *value, size_t length) noexcept
+        {
+            static const char s_hexDigits[] = "0123456789abcdef";
+
+            AppendLiteral("\"");
+
+            /* Copy runs of characters that need no escaping in one append. */
+            size_t runStart = 0;
+            for (size_t i = 0; i < length; ++i)
+            {
+                unsigned char c = static_cast<unsigned char>(value[i]);
+                if (c >= 0x20 && c != '"' && c != '\\')
+                {
+                    continue;
+                }
+
+                Append(reinterpret_cast<const uint8_t *>(value + runStart), i - runStart);
+                runStart = i + 1;
+
+                switch (c)
+                {
+                    case '"':
+                        AppendLiteral("\\\"");
+                        break;
+                    case '\\':
+                        AppendLiteral("\\\\");
+                        break;
+                    case '\b':
+                        AppendLiteral("\\b");
+                        break;
+                    case '\f':
+                        AppendLiteral("\\f");
+                        break;
+                    case '\n':
+                        AppendLiteral("\\n");
+                        break;
+                    case '\r':
+                        AppendLiteral("\\r");
+                        break;
+                    case '\t':
+                        AppendLiteral("\\t");
+                        break;
+                    default:
+                    {
+                        char escaped[] = {'\\', 'u', '0', '0', s_hexDigits[c >> 4], s_hexDigits[c & 0xf]};
+                        Append(reinterpret_cast<const uint8_t *>(escaped), sizeof(escaped));
+                        break;
+                    }
+                }
+            }
+            Append(reinterpret_cast<const uint8_t *>(value + runStart), length - runStart);
+
+            AppendLiteral("\"");
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
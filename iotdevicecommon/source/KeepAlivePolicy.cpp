@@ -0,0 +1,163 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/KeepAlivePolicy.h>
+
+#include <aws/common/clock.h>
+
+#include <algorithm>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            uint64_t s_now() noexcept
+            {
+                uint64_t now = 0;
+                aws_high_res_clock_get_ticks(&now);
+                return now;
+            }
+
+            uint64_t s_secsToNs(uint64_t secs) noexcept
+            {
+                return aws_timestamp_convert(secs, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+            }
+        } // namespace
+
+        KeepAlivePolicyConfig::KeepAlivePolicyConfig() noexcept
+            : InitialKeepAliveSecs(60), MinKeepAliveSecs(30), MaxKeepAliveSecs(1200), ProbeStepSecs(60),
+              ConfirmIntervals(3), MarginPercent(10)
+        {
+        }
+
+        KeepAlivePolicy::KeepAlivePolicy(const KeepAlivePolicyConfig &config) noexcept
+            : m_config(config), m_keepAliveSecs(0), m_connectedKeepAliveSecs(0), m_floorSecs(0), m_ceilingSecs(0),
+              m_connectedNs(0), m_lastTrafficNs(0), m_natTimeoutCount(0)
+        {
+            m_keepAliveSecs = ClampLocked(m_config.InitialKeepAliveSecs);
+        }
+
+        uint16_t KeepAlivePolicy::ClampLocked(uint32_t keepAliveSecs) const noexcept
+        {
+            uint32_t clamped = std::min<uint32_t>(keepAliveSecs, m_config.MaxKeepAliveSecs);
+            clamped = std::max<uint32_t>(clamped, m_config.MinKeepAliveSecs);
+            return static_cast<uint16_t>(std::max<uint32_t>(clamped, 1));
+        }
+
+        uint16_t KeepAlivePolicy::GetKeepAliveSecs() const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_keepAliveSecs;
+        }
+
+        void KeepAlivePolicy::OnConnected(uint16_t keepAliveSecs) noexcept
+        {
+            const uint64_t now = s_now();
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_connectedKeepAliveSecs = keepAliveSecs;
+            m_connectedNs = now;
+            m_lastTrafficNs = now;
+        }
+
+        void KeepAlivePolicy::OnTrafficAcked() noexcept
+        {
+            const uint64_t now = s_now();
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_lastTrafficNs = now;
+        }
+
+        void KeepAlivePolicy::OnInterrupted() noexcept
+        {
+            const uint64_t now = s_now();
+            std::lock_guard<std::mutex> lock(m_lock);
+            const uint16_t failed = m_connectedKeepAliveSecs;
+            if (failed == 0)
+            {
+                return;
+            }
+            m_connectedKeepAliveSecs = 0;
+
+            /*
+             * Idle for less than an interval means no ping was due yet, or traffic got through moments
+             * before: whatever dropped the connection, it was not an idle mapping expiring.
+             */
+            if (now - m_lastTrafficNs < s_secsToNs(failed))
+            {
+                ConfirmLocked(now, failed);
+                return;
+            }
+
+            ++m_natTimeoutCount;
+            m_ceilingSecs = m_ceilingSecs ? std::min(m_ceilingSecs, failed) : failed;
+            if (m_floorSecs >= failed)
+            {
+                /* What used to work no longer does; the path has changed, so nothing below is known good. */
+                m_floorSecs = 0;
+            }
+
+            const uint32_t margin = std::max<uint32_t>(1, failed * m_config.MarginPercent / 100);
+            const uint32_t next = failed > margin ? failed - margin : 1;
+            m_keepAliveSecs = ClampLocked(std::max<uint32_t>(next, m_floorSecs));
+        }
+
+        void KeepAlivePolicy::OnDisconnecting() noexcept
+        {
+            const uint64_t now = s_now();
+            std::lock_guard<std::mutex> lock(m_lock);
+            const uint16_t keepAliveSecs = m_connectedKeepAliveSecs;
+            if (keepAliveSecs == 0)
+            {
+                return;
+            }
+            m_connectedKeepAliveSecs = 0;
+            ConfirmLocked(now, keepAliveSecs);
+        }
+
+        void KeepAlivePolicy::ConfirmLocked(uint64_t nowNs, uint16_t keepAliveSecs) noexcept
+        {
+            const uint64_t intervals = std::max<uint32_t>(m_config.ConfirmIntervals, 1);
+            if (nowNs - m_connectedNs < s_secsToNs(keepAliveSecs) * intervals)
+            {
+                return;
+            }
+
+            m_floorSecs = std::max(m_floorSecs, keepAliveSecs);
+
+            uint32_t next = static_cast<uint32_t>(keepAliveSecs) + m_config.ProbeStepSecs;
+            if (m_ceilingSecs)
+            {
+                const uint32_t margin = std::max<uint32_t>(1, m_ceilingSecs * m_config.MarginPercent / 100);
+                const uint32_t limit = m_ceilingSecs > margin ? m_ceilingSecs - margin : 1;
+                next = std::min(next, std::max<uint32_t>(limit, m_floorSecs));
+            }
+
+            m_keepAliveSecs = ClampLocked(std::max<uint32_t>(next, m_keepAliveSecs));
+        }
+
+        void KeepAlivePolicy::Reset() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_keepAliveSecs = ClampLocked(m_config.InitialKeepAliveSecs);
+            m_floorSecs = 0;
+            m_ceilingSecs = 0;
+            m_natTimeoutCount = 0;
+        }
+
+        uint16_t KeepAlivePolicy::GetCeilingSecs() const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_ceilingSecs;
+        }
+
+        uint64_t KeepAlivePolicy::GetNatTimeoutCount() const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_natTimeoutCount;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
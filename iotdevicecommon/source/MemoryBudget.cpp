@@ -0,0 +1,123 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/MemoryBudget.h>
+
+#include <aws/crt/StlAllocator.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            /* Gives a slot's share back; holds the budget so the counter outlives every slot. */
+            struct SlotRelease
+            {
+                std::shared_ptr<MemoryBudget> Budget;
+
+                void operator()(std::atomic<size_t> *inUse) const noexcept
+                {
+                    inUse->fetch_sub(1, std::memory_order_relaxed);
+                }
+            };
+        } // namespace
+
+        MemoryBudgetConfig::MemoryBudgetConfig() noexcept
+            : MaxInFlightPublishes(0), MaxPendingRequests(0), MaxQueuedInboundMessages(0),
+              InboundOverflow(InboundOverflowPolicy::Drop)
+        {
+        }
+
+        MemoryBudget::MemoryBudget(const MemoryBudgetConfig &config, Crt::Allocator *allocator) noexcept
+            : m_config(config), m_allocator(allocator), m_inFlightPublishes(0), m_pendingRequests(0),
+              m_queuedInboundMessages(0), m_rejectedPublishes(0), m_rejectedRequests(0), m_droppedInboundMessages(0),
+              m_inlineInboundMessages(0)
+        {
+        }
+
+        std::shared_ptr<MemoryBudget> MemoryBudget::Create(const MemoryBudgetConfig &config, Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<MemoryBudget *>(aws_mem_acquire(allocator, sizeof(MemoryBudget)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) MemoryBudget(config, allocator);
+                return std::shared_ptr<MemoryBudget>(
+                    toSeat, [allocator](MemoryBudget *budget) { Crt::Delete(budget, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        MemoryBudget::Slot MemoryBudget::Acquire(
+            std::atomic<size_t> &inUse,
+            size_t limit,
+            std::atomic<uint64_t> &refused)
+        {
+            size_t current = inUse.load(std::memory_order_relaxed);
+            do
+            {
+                if (limit && current >= limit)
+                {
+                    refused.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+            } while (!inUse.compare_exchange_weak(current, current + 1, std::memory_order_relaxed));
+
+            return Slot(&inUse, SlotRelease{shared_from_this()}, Crt::StlAllocator<char>(m_allocator));
+        }
+
+        MemoryBudget::Slot MemoryBudget::AcquirePublish()
+        {
+            Slot slot = Acquire(m_inFlightPublishes, m_config.MaxInFlightPublishes, m_rejectedPublishes);
+            if (!slot)
+            {
+                aws_raise_error(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE);
+            }
+            return slot;
+        }
+
+        MemoryBudget::Slot MemoryBudget::AcquireRequest()
+        {
+            Slot slot = Acquire(m_pendingRequests, m_config.MaxPendingRequests, m_rejectedRequests);
+            if (!slot)
+            {
+                aws_raise_error(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE);
+            }
+            return slot;
+        }
+
+        MemoryBudget::Slot MemoryBudget::AcquireInbound(bool &handleInline)
+        {
+            handleInline = m_config.InboundOverflow == InboundOverflowPolicy::HandleInline;
+            std::atomic<uint64_t> &refused = handleInline ? m_inlineInboundMessages : m_droppedInboundMessages;
+            return Acquire(m_queuedInboundMessages, m_config.MaxQueuedInboundMessages, refused);
+        }
+
+        MemoryBudgetCounters MemoryBudget::GetCounters() const noexcept
+        {
+            MemoryBudgetCounters counters;
+            counters.InFlightPublishes = m_inFlightPublishes.load(std::memory_order_relaxed);
+            counters.PendingRequests = m_pendingRequests.load(std::memory_order_relaxed);
+            counters.QueuedInboundMessages = m_queuedInboundMessages.load(std::memory_order_relaxed);
+            counters.RejectedPublishes = m_rejectedPublishes.load(std::memory_order_relaxed);
+            counters.RejectedRequests = m_rejectedRequests.load(std::memory_order_relaxed);
+            counters.DroppedInboundMessages = m_droppedInboundMessages.load(std::memory_order_relaxed);
+            counters.InlineInboundMessages = m_inlineInboundMessages.load(std::memory_order_relaxed);
+            return counters;
+        }
+
+        bool AcquireRequestSlot(const std::shared_ptr<MemoryBudget> &budget, MemoryBudget::Slot &slot)
+        {
+            if (!budget)
+            {
+                return true;
+            }
+            slot = budget->AcquireRequest();
+            return slot != nullptr;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,78 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/MessageContext.h>
+
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            thread_local const Crt::String *s_currentTopic = nullptr;
+        } // namespace
+
+        MessageTopicScope::MessageTopicScope(const Crt::String &topic) noexcept : m_outer(s_currentTopic)
+        {
+            s_currentTopic = &topic;
+        }
+
+        MessageTopicScope::~MessageTopicScope() { s_currentTopic = m_outer; }
+
+        const Crt::String *CurrentMessageTopic() noexcept { return s_currentTopic; }
+
+        Crt::String CurrentThingName()
+        {
+            static const char thingsPrefix[] = "$aws/things/";
+
+            Crt::String thingName;
+            const Crt::String *topic = s_currentTopic;
+            if (topic && topic->compare(0, sizeof(thingsPrefix) - 1, thingsPrefix) == 0)
+            {
+                TopicSegment(*topic, 2, thingName);
+            }
+            return thingName;
+        }
+
+        bool TopicSegment(const Crt::String &topic, size_t index, Crt::String &segment)
+        {
+            size_t start = 0;
+            for (size_t i = 0; i < index; ++i)
+            {
+                start = topic.find('/', start);
+                if (start == Crt::String::npos)
+                {
+                    return false;
+                }
+                ++start;
+            }
+
+            size_t end = topic.find('/', start);
+            segment = topic.substr(start, end == Crt::String::npos ? Crt::String::npos : end - start);
+            return true;
+        }
+
+        Crt::ByteCursor ThingNameOfTopic(Crt::ByteCursor topic) noexcept
+        {
+            static const char thingsPrefix[] = "$aws/things/";
+            const size_t prefixLength = sizeof(thingsPrefix) - 1;
+
+            Crt::ByteCursor thingName = {0, nullptr};
+            if (topic.len <= prefixLength || memcmp(topic.ptr, thingsPrefix, prefixLength) != 0)
+            {
+                return thingName;
+            }
+
+            thingName.ptr = topic.ptr + prefixLength;
+            const void *slash = memchr(thingName.ptr, '/', topic.len - prefixLength);
+            thingName.len = slash ? static_cast<size_t>(static_cast<const uint8_t *>(slash) - thingName.ptr)
+                                  : topic.len - prefixLength;
+            return thingName;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
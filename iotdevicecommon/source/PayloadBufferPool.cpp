@@ -0,0 +1,229 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/PayloadBufferPool.h>
+
+#include <atomic>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        namespace
+        {
+            std::atomic<size_t> s_nextThreadStripe(0);
+            thread_local size_t s_threadStripe = s_nextThreadStripe.fetch_add(1, std::memory_order_relaxed);
+        } // namespace
+
+        PayloadBufferPool::PayloadBufferPool(
+            size_t maxPooledBuffers,
+            size_t maxPooledCapacity,
+            Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_maxPooledBuffers(maxPooledBuffers), m_maxPooledCapacity(maxPooledCapacity),
+              m_stripeCount(maxPooledBuffers < MaxStripes ? (maxPooledBuffers ? maxPooledBuffers : 1) : MaxStripes)
+        {
+            /* Stripes share the limit; the first ones take the remainder. */
+            for (size_t i = 0; i < m_stripeCount; ++i)
+            {
+                Stripe &stripe = m_stripes[i];
+                size_t capacity = maxPooledBuffers / m_stripeCount + (i < maxPooledBuffers % m_stripeCount ? 1 : 0);
+                if (capacity == 0)
+                {
+                    continue;
+                }
+                stripe.FreeBuffers =
+                    static_cast<Crt::ByteBuf *>(aws_mem_calloc(m_allocator, capacity, sizeof(Crt::ByteBuf)));
+                stripe.Capacity = stripe.FreeBuffers ? capacity : 0;
+            }
+        }
+
+        PayloadBufferPool::~PayloadBufferPool()
+        {
+            for (size_t i = 0; i < m_stripeCount; ++i)
+            {
+                Stripe &stripe = m_stripes[i];
+                for (size_t j = 0; j < stripe.Count; ++j)
+                {
+                    aws_byte_buf_clean_up(&stripe.FreeBuffers[j]);
+                }
+                aws_mem_release(m_allocator, stripe.FreeBuffers);
+            }
+        }
+
+        bool PayloadBufferPool::TakeFrom(Stripe &stripe, bool wait, Crt::ByteBuf &buffer) noexcept
+        {
+            std::unique_lock<std::mutex> lock(stripe.Lock, std::defer_lock);
+            if (wait)
+            {
+                lock.lock();
+            }
+            else if (!lock.try_lock())
+            {
+                return false;
+            }
+
+            if (stripe.Count == 0)
+            {
+                return false;
+            }
+            buffer = stripe.FreeBuffers[--stripe.Count];
+            return true;
+        }
+
+        Crt::ByteBuf PayloadBufferPool::TakeAny() noexcept
+        {
+            Crt::ByteBuf buffer;
+            AWS_ZERO_STRUCT(buffer);
+
+            /* The thread's own stripe first, then any other that is not busy, before waiting on one. */
+            size_t home = s_threadStripe % m_stripeCount;
+            if (TakeFrom(m_stripes[home], true, buffer))
+            {
+                return buffer;
+            }
+            for (size_t pass = 0; pass < 2; ++pass)
+            {
+                for (size_t i = 1; i < m_stripeCount; ++i)
+                {
+                    if (TakeFrom(m_stripes[(home + i) % m_stripeCount], pass == 1, buffer))
+                    {
+                        return buffer;
+                    }
+                }
+            }
+            return buffer;
+        }
+
+        Crt::ByteBuf PayloadBufferPool::NewCopy(const Crt::ByteCursor &payload) noexcept
+        {
+            Crt::ByteBuf buffer = TakeAny();
+
+            if (buffer.allocator == nullptr)
+            {
+                if (aws_byte_buf_init_copy_from_cursor(&buffer, m_allocator, payload))
+                {
+                    AWS_ZERO_STRUCT(buffer);
+                }
+                return buffer;
+            }
+
+            aws_byte_buf_reset(&buffer, false);
+            if (aws_byte_buf_append_dynamic(&buffer, &payload))
+            {
+                aws_byte_buf_clean_up(&buffer);
+                AWS_ZERO_STRUCT(buffer);
+            }
+
+            return buffer;
+        }
+
+        Crt::ByteBuf PayloadBufferPool::Acquire(size_t capacityHint) noexcept
+        {
+            Crt::ByteBuf buffer = TakeAny();
+
+            if (buffer.allocator != nullptr)
+            {
+                aws_byte_buf_reset(&buffer, false);
+                return buffer;
+            }
+
+            if (aws_byte_buf_init(&buffer, m_allocator, capacityHint))
+            {
+                AWS_ZERO_STRUCT(buffer);
+            }
+
+            return buffer;
+        }
+
+        void PayloadBufferPool::Release(Crt::ByteBuf &buffer) noexcept
+        {
+            if (buffer.allocator == nullptr)
+            {
+                return;
+            }
+
+            if (buffer.capacity <= m_maxPooledCapacity)
+            {
+                /*
+                 * Publishes complete on the event loop thread, so returning a buffer to the releasing thread's
+                 * stripe would gather them all in one. Hashing the storage address spreads them instead.
+                 */
+                size_t hash = static_cast<size_t>(reinterpret_cast<uintptr_t>(buffer.buffer) >> 4);
+                hash ^= hash >> 7;
+                size_t first = hash % m_stripeCount;
+                for (size_t i = 0; i < m_stripeCount; ++i)
+                {
+                    Stripe &stripe = m_stripes[(first + i) % m_stripeCount];
+                    std::lock_guard<std::mutex> lock(stripe.Lock);
+                    if (stripe.Count < stripe.Capacity)
+                    {
+                        stripe.FreeBuffers[stripe.Count++] = buffer;
+                        AWS_ZERO_STRUCT(buffer);
+                        return;
+                    }
+                }
+            }
+
+            aws_byte_buf_clean_up(&buffer);
+        }
+
+        void PayloadBufferPool::Release(Crt::ByteBuf *buffers, size_t count) noexcept
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            /* Start from the stripe the first buffer hashes to and give each stripe an even share. */
+            size_t hash = static_cast<size_t>(reinterpret_cast<uintptr_t>(buffers[0].buffer) >> 4);
+            hash ^= hash >> 7;
+            size_t first = hash % m_stripeCount;
+            size_t next = 0;
+            for (size_t i = 0; i < m_stripeCount && next < count; ++i)
+            {
+                size_t share = (count - next + (m_stripeCount - i) - 1) / (m_stripeCount - i);
+                Stripe &stripe = m_stripes[(first + i) % m_stripeCount];
+                std::lock_guard<std::mutex> lock(stripe.Lock);
+                for (size_t end = next + share; next < end; ++next)
+                {
+                    Crt::ByteBuf &buffer = buffers[next];
+                    if (buffer.allocator == nullptr)
+                    {
+                        continue;
+                    }
+
+                    if (buffer.capacity <= m_maxPooledCapacity && stripe.Count < stripe.Capacity)
+                    {
+                        stripe.FreeBuffers[stripe.Count++] = buffer;
+                        AWS_ZERO_STRUCT(buffer);
+                    }
+                }
+            }
+
+            /* Whatever did not fit is freed, outside the locks. */
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (buffers[i].allocator != nullptr)
+                {
+                    aws_byte_buf_clean_up(&buffers[i]);
+                }
+            }
+        }
+
+        size_t PayloadBufferPool::GetPooledCount() const noexcept
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < m_stripeCount; ++i)
+            {
+                Stripe &stripe = const_cast<Stripe &>(m_stripes[i]);
+                std::lock_guard<std::mutex> lock(stripe.Lock);
+                count += stripe.Count;
+            }
+            return count;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
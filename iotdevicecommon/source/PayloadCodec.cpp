@@ -0,0 +1,61 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/PayloadCodec.h>
+
+#include <aws/common/clock.h>
+#include <aws/iotdevicecommon/RequestTracer.h>
+#include <aws/iotdevicecommon/ServiceMetrics.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        bool ParsePayload(
+            const Crt::ByteBuf &payload,
+            PayloadFormat format,
+            Crt::String &scratch,
+            Crt::JsonObject &document)
+        {
+            ServiceMetrics::HandlerScope *scope = ServiceMetrics::HandlerScope::Current();
+            uint64_t startNs = 0;
+            if (scope)
+            {
+                aws_high_res_clock_get_ticks(&startNs);
+            }
+            RequestTracer::ResponseScope *trace = RequestTracer::ResponseScope::Current();
+            if (trace)
+            {
+                trace->StartParse();
+            }
+
+            bool parsed = false;
+            if (format == PayloadFormat::Cbor)
+            {
+                parsed = CborReader::ToJsonObject(Crt::ByteCursorFromByteBuf(payload), document);
+            }
+            else
+            {
+                scratch.assign(reinterpret_cast<char *>(payload.buffer), payload.len);
+                document = scratch;
+                parsed = document.WasParseSuccessful();
+            }
+
+            if (scope)
+            {
+                uint64_t endNs = 0;
+                aws_high_res_clock_get_ticks(&endNs);
+                scope->AddParseTime(endNs - startNs);
+            }
+            if (trace)
+            {
+                trace->EndParse(parsed ? AWS_ERROR_SUCCESS : AWS_ERROR_INVALID_ARGUMENT);
+            }
+            return parsed;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,34 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/PayloadWriter.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        PayloadWriter &PayloadWriter::StringMap(const Crt::Map<Crt::String, Crt::String> &value) noexcept
+        {
+            BeginObject();
+            for (auto &member : value)
+            {
+                Key(member.first).String(member.second);
+            }
+            return EndObject();
+        }
+
+        PayloadWriter &PayloadWriter::StringMap(const FlatStringMap &value) noexcept
+        {
+            BeginObject();
+            for (auto &member : value)
+            {
+                Key(member.first).String(member.second);
+            }
+            return EndObject();
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,196 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/PublishCompletionBatcher.h>
+
+#include <aws/common/task_scheduler.h>
+#include <aws/io/event_loop.h>
+#include <aws/iotdevicecommon/PayloadBufferPool.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        struct PublishCompletionBatcher::FlushTask
+        {
+            aws_task Task;
+            std::weak_ptr<PublishCompletionBatcher> Batcher;
+            Crt::Allocator *Allocator;
+
+            static void s_run(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *flushTask = static_cast<FlushTask *>(arg);
+                auto batcher = flushTask->Batcher.lock();
+                Crt::Delete(flushTask, flushTask->Allocator);
+
+                /* A cancelled task still delivers, so that no buffer or completion is lost at shutdown. */
+                (void)status;
+                if (batcher)
+                {
+                    batcher->Flush();
+                }
+            }
+        };
+
+        PublishCompletionBatcherConfig::PublishCompletionBatcherConfig() noexcept
+            : EventLoopGroup(nullptr), OnBatchComplete()
+        {
+        }
+
+        PublishCompletionBatcher::PublishCompletionBatcher(
+            const PublishCompletionBatcherConfig &config,
+            aws_event_loop *eventLoop,
+            Crt::Allocator *allocator) noexcept
+            : m_config(config), m_eventLoop(eventLoop), m_allocator(allocator),
+              m_completions(Crt::StlAllocator<Completion>(allocator)),
+              m_results(Crt::StlAllocator<PublishResult>(allocator)), m_flushScheduled(false), m_batchCount(0),
+              m_completionCount(0)
+        {
+        }
+
+        PublishCompletionBatcher::~PublishCompletionBatcher() { Flush(); }
+
+        std::shared_ptr<PublishCompletionBatcher> PublishCompletionBatcher::Create(
+            const PublishCompletionBatcherConfig &config,
+            Crt::Allocator *allocator)
+        {
+            aws_event_loop *eventLoop = nullptr;
+            if (config.EventLoopGroup)
+            {
+                eventLoop = aws_event_loop_group_get_next_loop(config.EventLoopGroup->GetUnderlyingHandle());
+            }
+            if (!eventLoop)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat =
+                static_cast<PublishCompletionBatcher *>(aws_mem_acquire(allocator, sizeof(PublishCompletionBatcher)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) PublishCompletionBatcher(config, eventLoop, allocator);
+                return std::shared_ptr<PublishCompletionBatcher>(
+                    toSeat, [allocator](PublishCompletionBatcher *batcher) { Crt::Delete(batcher, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        void PublishCompletionBatcher::Add(
+            uint16_t packetId,
+            int errorCode,
+            const std::shared_ptr<PayloadBufferPool> &pool,
+            const Crt::ByteBuf &payload,
+            const OnCompletion &onCompletion)
+        {
+            bool flushNow = false;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_completions.push_back(Completion{pool, payload, onCompletion});
+                m_results.push_back(PublishResult{packetId, errorCode});
+                if (!m_flushScheduled)
+                {
+                    auto *flushTask = Crt::New<FlushTask>(m_allocator);
+                    if (flushTask)
+                    {
+                        flushTask->Batcher = shared_from_this();
+                        flushTask->Allocator = m_allocator;
+                        aws_task_init(&flushTask->Task, FlushTask::s_run, flushTask, "PublishCompletionBatch");
+                        aws_event_loop_schedule_task_now(m_eventLoop, &flushTask->Task);
+                        m_flushScheduled = true;
+                    }
+                    else
+                    {
+                        flushNow = true;
+                    }
+                }
+            }
+
+            if (flushNow)
+            {
+                Flush();
+            }
+        }
+
+        void PublishCompletionBatcher::Flush()
+        {
+            Crt::Vector<Completion> completions{Crt::StlAllocator<Completion>(m_allocator)};
+            Crt::Vector<PublishResult> results{Crt::StlAllocator<PublishResult>(m_allocator)};
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                completions.swap(m_completions);
+                results.swap(m_results);
+                m_flushScheduled = false;
+                if (!completions.empty())
+                {
+                    ++m_batchCount;
+                    m_completionCount += completions.size();
+                }
+            }
+
+            if (completions.empty())
+            {
+                return;
+            }
+
+            /* Hand runs of buffers from the same pool back in one call each. */
+            Crt::Vector<Crt::ByteBuf> buffers{Crt::StlAllocator<Crt::ByteBuf>(m_allocator)};
+            buffers.reserve(completions.size());
+            for (size_t i = 0; i < completions.size(); ++i)
+            {
+                if (completions[i].Pool && completions[i].Payload.allocator)
+                {
+                    buffers.push_back(completions[i].Payload);
+                }
+                else if (completions[i].Payload.allocator)
+                {
+                    aws_byte_buf_clean_up(&completions[i].Payload);
+                }
+
+                bool runEnds = i + 1 == completions.size() || completions[i + 1].Pool != completions[i].Pool;
+                if (runEnds && !buffers.empty())
+                {
+                    completions[i].Pool->Release(buffers.data(), buffers.size());
+                    buffers.clear();
+                }
+            }
+
+            for (size_t i = 0; i < completions.size(); ++i)
+            {
+                if (completions[i].Handler)
+                {
+                    completions[i].Handler(results[i].ErrorCode);
+                }
+            }
+
+            if (m_config.OnBatchComplete)
+            {
+                m_config.OnBatchComplete(results.data(), results.size());
+            }
+
+            /* Keep the storage for the next batch, unless another one started meanwhile. */
+            completions.clear();
+            results.clear();
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_completions.empty())
+            {
+                completions.swap(m_completions);
+                results.swap(m_results);
+            }
+        }
+
+        uint64_t PublishCompletionBatcher::GetBatchCount() const
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_batchCount;
+        }
+
+        uint64_t PublishCompletionBatcher::GetCompletionCount() const
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_completionCount;
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,129 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/PublishLanes.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        PublishLanesConfig::PublishLanesConfig() noexcept : Connection(), MaxInFlight(8), MaxQueued(0) {}
+
+        PublishLanes::PublishLanes(const PublishLanesConfig &config, Crt::Allocator *allocator) noexcept
+            : m_connection(config.Connection), m_maxInFlight(config.MaxInFlight), m_maxQueued(config.MaxQueued),
+              m_queued(Crt::StlAllocator<DeferredPublish>(allocator)), m_inFlight(0), m_deferredCount(0)
+        {
+        }
+
+        PublishLanes::~PublishLanes()
+        {
+            Crt::List<DeferredPublish> queued(std::move(m_queued));
+            for (DeferredPublish &publish : queued)
+            {
+                publish(nullptr);
+            }
+        }
+
+        std::shared_ptr<PublishLanes> PublishLanes::Create(const PublishLanesConfig &config, Crt::Allocator *allocator)
+        {
+            if (!config.Connection || config.MaxInFlight == 0)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<PublishLanes *>(aws_mem_acquire(allocator, sizeof(PublishLanes)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) PublishLanes(config, allocator);
+                return std::shared_ptr<PublishLanes>(
+                    toSeat, [allocator](PublishLanes *lanes) { Crt::Delete(lanes, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool PublishLanes::TryAcquire(PublishPriority priority)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            /* Telemetry also waits while older telemetry is held, so the lane stays in order. */
+            if (priority == PublishPriority::Telemetry && (m_inFlight >= m_maxInFlight || !m_queued.empty()))
+            {
+                return false;
+            }
+            ++m_inFlight;
+            return true;
+        }
+
+        bool PublishLanes::Defer(DeferredPublish &&publish)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_inFlight >= m_maxInFlight || !m_queued.empty())
+                {
+                    if (m_maxQueued && m_queued.size() >= m_maxQueued)
+                    {
+                        aws_raise_error(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE);
+                        return false;
+                    }
+                    m_queued.push_back(std::move(publish));
+                    ++m_deferredCount;
+                    return true;
+                }
+                ++m_inFlight;
+            }
+
+            auto connection = m_connection.lock();
+            publish(connection.get());
+            return true;
+        }
+
+        void PublishLanes::Release()
+        {
+            Crt::List<DeferredPublish> ready;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_inFlight > 0)
+                {
+                    --m_inFlight;
+                }
+                while (m_inFlight < m_maxInFlight && !m_queued.empty())
+                {
+                    ready.splice(ready.end(), m_queued, m_queued.begin());
+                    ++m_inFlight;
+                }
+            }
+
+            if (ready.empty())
+            {
+                return;
+            }
+
+            /* Outside the lock: a publish refused on the spot releases, and so reenters, straight away. */
+            auto connection = m_connection.lock();
+            for (DeferredPublish &publish : ready)
+            {
+                publish(connection.get());
+            }
+        }
+
+        size_t PublishLanes::GetInFlightCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_inFlight;
+        }
+
+        size_t PublishLanes::GetQueuedCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_queued.size();
+        }
+
+        uint64_t PublishLanes::GetDeferredCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_deferredCount;
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,368 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/PublishRouter.h>
+
+#include <aws/common/clock.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            const size_t s_cloud = static_cast<size_t>(PublishRoute::Cloud);
+            const size_t s_localCore = static_cast<size_t>(PublishRoute::LocalCore);
+
+            uint64_t s_now()
+            {
+                uint64_t now = 0;
+                aws_high_res_clock_get_ticks(&now);
+                return now;
+            }
+        } // namespace
+
+        /* A publish on its way; the payload is kept so it can be sent again on the other route or queued. */
+        struct PublishRouter::Attempt
+        {
+            Crt::String Topic;
+            Crt::Mqtt::QOS Qos;
+            Crt::String Payload;
+            DurablePublishQueue::OnDelivered OnComplete;
+            /* Set once it went to the second connection, after which only the queue is left. */
+            bool Rerouted = false;
+        };
+
+        PublishRouterConfig::PublishRouterConfig() noexcept
+            : Cloud(), LocalCore(), OfflineQueue(), SwitchMarginMs(20), ProbeInterval(32), OnRouteChanged()
+        {
+        }
+
+        PublishRouter::PublishRouter(const PublishRouterConfig &config, Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_connections{config.Cloud, config.LocalCore},
+              m_offlineQueue(config.OfflineQueue),
+              m_switchMarginNs(
+                  static_cast<uint64_t>(config.SwitchMarginMs) * (AWS_TIMESTAMP_NANOS / AWS_TIMESTAMP_MILLIS)),
+              m_probeInterval(config.ProbeInterval), m_onRouteChanged(config.OnRouteChanged), m_up{true, true},
+              m_latencyNs{0, 0}, m_route(PublishRoute::LocalCore), m_publishCount(0)
+        {
+        }
+
+        std::shared_ptr<PublishRouter> PublishRouter::Create(
+            const PublishRouterConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (!config.Cloud || !config.LocalCore || config.Cloud == config.LocalCore)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<PublishRouter *>(aws_mem_acquire(allocator, sizeof(PublishRouter)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) PublishRouter(config, allocator);
+            std::shared_ptr<PublishRouter> router(
+                toSeat, [allocator](PublishRouter *routing) { Crt::Delete(routing, allocator); });
+            router->Chain(s_cloud);
+            router->Chain(s_localCore);
+            return router;
+        }
+
+        void PublishRouter::Chain(size_t index)
+        {
+            /* As with HotStandby, the connections only hold the router weakly, or neither would be freed. */
+            std::weak_ptr<PublishRouter> weakRouter = shared_from_this();
+            Crt::Mqtt::MqttConnection &connection = *m_connections[index];
+
+            auto onCompleted = std::move(connection.OnConnectionCompleted);
+            connection.OnConnectionCompleted = [weakRouter, index, onCompleted](
+                                                   Crt::Mqtt::MqttConnection &completed,
+                                                   int errorCode,
+                                                   Crt::Mqtt::ReturnCode returnCode,
+                                                   bool sessionPresent) {
+                auto router = weakRouter.lock();
+                if (router && errorCode == AWS_ERROR_SUCCESS)
+                {
+                    router->OnUp(index);
+                }
+                if (onCompleted)
+                {
+                    onCompleted(completed, errorCode, returnCode, sessionPresent);
+                }
+            };
+
+            auto onInterrupted = std::move(connection.OnConnectionInterrupted);
+            connection.OnConnectionInterrupted =
+                [weakRouter, index, onInterrupted](Crt::Mqtt::MqttConnection &interrupted, int errorCode) {
+                    if (auto router = weakRouter.lock())
+                    {
+                        router->OnDown(index, errorCode);
+                    }
+                    if (onInterrupted)
+                    {
+                        onInterrupted(interrupted, errorCode);
+                    }
+                };
+
+            auto onResumed = std::move(connection.OnConnectionResumed);
+            connection.OnConnectionResumed = [weakRouter, index, onResumed](
+                                                 Crt::Mqtt::MqttConnection &resumed,
+                                                 Crt::Mqtt::ReturnCode returnCode,
+                                                 bool sessionPresent) {
+                if (auto router = weakRouter.lock())
+                {
+                    router->OnUp(index);
+                }
+                if (onResumed)
+                {
+                    onResumed(resumed, returnCode, sessionPresent);
+                }
+            };
+
+            auto onDisconnect = std::move(connection.OnDisconnect);
+            connection.OnDisconnect = [weakRouter, index, onDisconnect](Crt::Mqtt::MqttConnection &disconnected) {
+                if (auto router = weakRouter.lock())
+                {
+                    router->OnDown(index, AWS_ERROR_MQTT_NOT_CONNECTED);
+                }
+                if (onDisconnect)
+                {
+                    onDisconnect(disconnected);
+                }
+            };
+        }
+
+        void PublishRouter::OnUp(size_t index)
+        {
+            PublishRoute route;
+            bool changed = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_up[index] = true;
+                route = ChooseLocked(changed);
+            }
+            /* Even if the route stands, the queue may have paused on a failed publish and can resume now. */
+            Follow(route, changed, AWS_ERROR_SUCCESS);
+        }
+
+        void PublishRouter::OnDown(size_t index, int errorCode)
+        {
+            PublishRoute route;
+            bool changed = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_up[index])
+                {
+                    return;
+                }
+                m_up[index] = false;
+                route = ChooseLocked(changed);
+            }
+            Follow(route, changed, errorCode);
+        }
+
+        PublishRoute PublishRouter::ChooseLocked(bool &changed)
+        {
+            PublishRoute chosen = PublishRoute::Offline;
+            if (m_up[s_cloud] && m_up[s_localCore])
+            {
+                size_t current = m_route == PublishRoute::Offline ? s_localCore : static_cast<size_t>(m_route);
+                size_t other = 1 - current;
+                bool otherFaster = m_latencyNs[current] > 0 && m_latencyNs[other] > 0 &&
+                                   m_latencyNs[other] + static_cast<double>(m_switchMarginNs) < m_latencyNs[current];
+                chosen = static_cast<PublishRoute>(otherFaster ? other : current);
+            }
+            else if (m_up[s_cloud])
+            {
+                chosen = PublishRoute::Cloud;
+            }
+            else if (m_up[s_localCore])
+            {
+                chosen = PublishRoute::LocalCore;
+            }
+
+            changed = chosen != m_route;
+            m_route = chosen;
+            return chosen;
+        }
+
+        void PublishRouter::Follow(PublishRoute route, bool changed, int errorCode)
+        {
+            if (m_offlineQueue)
+            {
+                if (route == PublishRoute::Offline)
+                {
+                    m_offlineQueue->Pause();
+                }
+                else
+                {
+                    m_offlineQueue->Drain(m_connections[static_cast<size_t>(route)]);
+                }
+            }
+
+            if (changed && m_onRouteChanged && GetRoute() == route)
+            {
+                m_onRouteChanged(route, errorCode);
+            }
+        }
+
+        bool PublishRouter::Publish(
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteBuf &payload,
+            DurablePublishQueue::OnDelivered &&onComplete)
+        {
+            auto attempt = Crt::MakeShared<Attempt>(m_allocator);
+            attempt->Topic = topic;
+            attempt->Qos = qos;
+            attempt->Payload.assign(reinterpret_cast<const char *>(payload.buffer), payload.len);
+            attempt->OnComplete = std::move(onComplete);
+
+            PublishRoute route;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                route = m_route;
+                /* Probes keep the other route's latency current, so traffic can move to it when it gets faster. */
+                if (route != PublishRoute::Offline && m_up[s_cloud] && m_up[s_localCore] && m_probeInterval &&
+                    ++m_publishCount % m_probeInterval == 0)
+                {
+                    route = static_cast<PublishRoute>(1 - static_cast<size_t>(route));
+                }
+            }
+
+            /* Behind queued publishes, so they keep their order. */
+            if (m_offlineQueue && m_offlineQueue->GetQueuedCount() > 0)
+            {
+                route = PublishRoute::Offline;
+            }
+            return Send(attempt, route);
+        }
+
+        bool PublishRouter::Send(const std::shared_ptr<Attempt> &attempt, PublishRoute route)
+        {
+            std::weak_ptr<PublishRouter> weakRouter = shared_from_this();
+            while (route != PublishRoute::Offline)
+            {
+                size_t index = static_cast<size_t>(route);
+                uint64_t startNs = s_now();
+                Crt::ByteBuf payload = aws_byte_buf_from_array(attempt->Payload.data(), attempt->Payload.size());
+                uint16_t packetId = m_connections[index]->Publish(
+                    attempt->Topic.c_str(),
+                    attempt->Qos,
+                    false,
+                    payload,
+                    [weakRouter, attempt, index, startNs](Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                        if (auto router = weakRouter.lock())
+                        {
+                            router->OnAttemptComplete(attempt, index, startNs, errorCode);
+                        }
+                        else if (attempt->OnComplete)
+                        {
+                            attempt->OnComplete(errorCode);
+                        }
+                    });
+                if (packetId != 0)
+                {
+                    return true;
+                }
+
+                /* Refused outright: the connection is not usable, so take it out of rotation until it is back. */
+                OnDown(index, Crt::LastErrorOrUnknown());
+                if (attempt->Rerouted)
+                {
+                    break;
+                }
+                attempt->Rerouted = true;
+                route = GetRoute();
+            }
+            return Queue(attempt);
+        }
+
+        void PublishRouter::OnAttemptComplete(
+            const std::shared_ptr<Attempt> &attempt,
+            size_t index,
+            uint64_t startNs,
+            int errorCode)
+        {
+            if (errorCode == AWS_ERROR_SUCCESS)
+            {
+                PublishRoute route;
+                bool changed = false;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    double sample = static_cast<double>(s_now() - startNs);
+                    double &latency = m_latencyNs[index];
+                    latency = latency > 0 ? latency + (sample - latency) / 8 : sample;
+                    route = ChooseLocked(changed);
+                }
+                if (changed)
+                {
+                    Follow(route, changed, AWS_ERROR_SUCCESS);
+                }
+
+                if (attempt->OnComplete)
+                {
+                    attempt->OnComplete(AWS_ERROR_SUCCESS);
+                }
+                return;
+            }
+
+            /* The connection handlers say whether it is down; this publish only moves on. */
+            PublishRoute route = PublishRoute::Offline;
+            if (!attempt->Rerouted)
+            {
+                attempt->Rerouted = true;
+                std::lock_guard<std::mutex> lock(m_lock);
+                size_t other = 1 - index;
+                if (m_up[other])
+                {
+                    route = static_cast<PublishRoute>(other);
+                }
+            }
+            if (!Send(attempt, route) && attempt->OnComplete)
+            {
+                attempt->OnComplete(errorCode);
+            }
+        }
+
+        bool PublishRouter::Queue(const std::shared_ptr<Attempt> &attempt)
+        {
+            if (!m_offlineQueue)
+            {
+                aws_raise_error(AWS_ERROR_MQTT_NOT_CONNECTED);
+                return false;
+            }
+
+            /* Copied, so the caller can still report a publish the queue refused. */
+            Crt::ByteBuf payload = aws_byte_buf_from_array(attempt->Payload.data(), attempt->Payload.size());
+            DurablePublishQueue::OnDelivered onDelivered(attempt->OnComplete);
+            if (!m_offlineQueue->Enqueue(attempt->Topic.c_str(), attempt->Qos, payload, std::move(onDelivered)))
+            {
+                return false;
+            }
+            attempt->OnComplete = nullptr;
+            return true;
+        }
+
+        PublishRoute PublishRouter::GetRoute() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_route;
+        }
+
+        double PublishRouter::GetLatencyMs(PublishRoute route) const
+        {
+            if (route == PublishRoute::Offline)
+            {
+                return 0;
+            }
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_latencyNs[static_cast<size_t>(route)] / 1e6;
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,208 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/PublishScheduler.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/task_scheduler.h>
+#include <aws/io/event_loop.h>
+
+#include <algorithm>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        struct PublishScheduler::WakeTask
+        {
+            aws_task Task;
+            std::weak_ptr<PublishScheduler> Scheduler;
+            uint64_t WakeAtNs;
+            Crt::Allocator *Allocator;
+
+            static void s_run(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *wakeTask = static_cast<WakeTask *>(arg);
+                auto scheduler = wakeTask->Scheduler.lock();
+                uint64_t wakeAtNs = wakeTask->WakeAtNs;
+                Crt::Delete(wakeTask, wakeTask->Allocator);
+
+                if (scheduler && status == AWS_TASK_STATUS_RUN_READY)
+                {
+                    scheduler->OnWake(wakeAtNs);
+                }
+            }
+        };
+
+        PublishSchedulerConfig::PublishSchedulerConfig() noexcept
+            : EventLoopGroup(nullptr), WindowMs(60000), MaxQueued(0)
+        {
+        }
+
+        PublishScheduler::PublishScheduler(
+            const PublishSchedulerConfig &config,
+            aws_event_loop *eventLoop,
+            Crt::Allocator *allocator) noexcept
+            : m_config(config), m_eventLoop(eventLoop), m_allocator(allocator), m_wakeAtNs(0), m_batchCount(0)
+        {
+        }
+
+        std::shared_ptr<PublishScheduler> PublishScheduler::Create(
+            const PublishSchedulerConfig &config,
+            Crt::Allocator *allocator)
+        {
+            aws_event_loop *eventLoop = nullptr;
+            if (config.EventLoopGroup)
+            {
+                eventLoop = aws_event_loop_group_get_next_loop(config.EventLoopGroup->GetUnderlyingHandle());
+            }
+            if (!eventLoop)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<PublishScheduler *>(aws_mem_acquire(allocator, sizeof(PublishScheduler)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) PublishScheduler(config, eventLoop, allocator);
+                return std::shared_ptr<PublishScheduler>(
+                    toSeat, [allocator](PublishScheduler *scheduler) { Crt::Delete(scheduler, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool PublishScheduler::Schedule(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteBuf &payload,
+            OnPublished &&onPublished,
+            uint32_t deadlineMs)
+        {
+            auto held = Crt::MakeShared<Held>(m_allocator);
+            if (!held)
+            {
+                return false;
+            }
+
+            held->Connection = connection;
+            held->Topic = topic;
+            held->Qos = qos;
+            held->Payload.assign(reinterpret_cast<const char *>(payload.buffer), payload.len);
+            held->Handler = std::move(onPublished);
+
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &now);
+            uint64_t windowNs =
+                aws_timestamp_convert(m_config.WindowMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, nullptr);
+            uint64_t wakeAtNs = windowNs ? (now / windowNs + 1) * windowNs : now;
+            if (deadlineMs)
+            {
+                uint64_t deadlineNs =
+                    aws_timestamp_convert(deadlineMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, nullptr);
+                wakeAtNs = std::min(wakeAtNs, now + deadlineNs);
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_config.MaxQueued && m_held.size() >= m_config.MaxQueued)
+            {
+                aws_raise_error(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE);
+                return false;
+            }
+            if (!ArmLocked(wakeAtNs))
+            {
+                return false;
+            }
+
+            m_held.push_back(std::move(held));
+            return true;
+        }
+
+        bool PublishScheduler::ArmLocked(uint64_t wakeAtNs)
+        {
+            if (m_wakeAtNs != 0 && m_wakeAtNs <= wakeAtNs)
+            {
+                return true;
+            }
+
+            auto *wakeTask = Crt::New<WakeTask>(m_allocator);
+            if (!wakeTask)
+            {
+                return false;
+            }
+
+            /* A later wake-up already armed finds m_wakeAtNs changed and does nothing. */
+            wakeTask->Scheduler = shared_from_this();
+            wakeTask->WakeAtNs = wakeAtNs;
+            wakeTask->Allocator = m_allocator;
+            aws_task_init(&wakeTask->Task, WakeTask::s_run, wakeTask, "PublishSchedulerWake");
+            aws_event_loop_schedule_task_future(m_eventLoop, &wakeTask->Task, wakeAtNs);
+            m_wakeAtNs = wakeAtNs;
+            return true;
+        }
+
+        void PublishScheduler::OnWake(uint64_t wakeAtNs)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_wakeAtNs != wakeAtNs)
+                {
+                    return;
+                }
+            }
+
+            Flush();
+        }
+
+        void PublishScheduler::Flush()
+        {
+            Crt::Vector<std::shared_ptr<Held>> batch;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_held.empty())
+                {
+                    return;
+                }
+                batch.swap(m_held);
+                m_wakeAtNs = 0;
+                ++m_batchCount;
+            }
+
+            for (const std::shared_ptr<Held> &held : batch)
+            {
+                /* The completion holds the copy, so the payload outlives the publish. */
+                Crt::ByteBuf payload = aws_byte_buf_from_array(held->Payload.data(), held->Payload.size());
+                uint16_t packetId = held->Connection->Publish(
+                    held->Topic.c_str(),
+                    held->Qos,
+                    false,
+                    payload,
+                    [held](Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                        if (held->Handler)
+                        {
+                            held->Handler(errorCode);
+                        }
+                    });
+                if (packetId == 0 && held->Handler)
+                {
+                    held->Handler(Crt::LastErrorOrUnknown());
+                }
+            }
+        }
+
+        size_t PublishScheduler::GetQueuedCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_held.size();
+        }
+
+        uint64_t PublishScheduler::GetBatchCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_batchCount;
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
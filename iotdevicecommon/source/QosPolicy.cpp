@@ -0,0 +1,59 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/QosPolicy.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            const int8_t s_unset = -1;
+        } // namespace
+
+        QosPolicy::QosPolicy() noexcept
+        {
+            for (int8_t &qos : m_qos)
+            {
+                qos = s_unset;
+            }
+        }
+
+        QosPolicy QosPolicy::Recommended() noexcept
+        {
+            QosPolicy policy;
+            policy.Set(QosOperation::ShadowUpdate, AWS_MQTT_QOS_AT_MOST_ONCE)
+                .Set(QosOperation::ShadowUpdateResponses, AWS_MQTT_QOS_AT_MOST_ONCE)
+                .Set(QosOperation::JobsUpdate, AWS_MQTT_QOS_AT_LEAST_ONCE)
+                .Set(QosOperation::JobsRequest, AWS_MQTT_QOS_AT_LEAST_ONCE)
+                .Set(QosOperation::JobsResponses, AWS_MQTT_QOS_AT_LEAST_ONCE)
+                .Set(QosOperation::JobsEvents, AWS_MQTT_QOS_AT_LEAST_ONCE)
+                .Set(QosOperation::Provisioning, AWS_MQTT_QOS_AT_LEAST_ONCE);
+            return policy;
+        }
+
+        QosPolicy &QosPolicy::Set(QosOperation operation, Crt::Mqtt::QOS qos) noexcept
+        {
+            if (qos == AWS_MQTT_QOS_EXACTLY_ONCE)
+            {
+                qos = AWS_MQTT_QOS_AT_LEAST_ONCE;
+            }
+            m_qos[static_cast<size_t>(operation)] = static_cast<int8_t>(qos);
+            return *this;
+        }
+
+        QosPolicy &QosPolicy::Clear(QosOperation operation) noexcept
+        {
+            m_qos[static_cast<size_t>(operation)] = s_unset;
+            return *this;
+        }
+
+        Crt::Mqtt::QOS QosPolicy::Resolve(QosOperation operation, Crt::Mqtt::QOS requested) const noexcept
+        {
+            int8_t qos = m_qos[static_cast<size_t>(operation)];
+            return qos == s_unset ? requested : static_cast<Crt::Mqtt::QOS>(qos);
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
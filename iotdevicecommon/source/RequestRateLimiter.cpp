@@ -0,0 +1,339 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/RequestRateLimiter.h>
+
+#include <aws/iotdevicecommon/MessageContext.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/task_scheduler.h>
+#include <aws/io/event_loop.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            const double s_nsPerSecond = 1e9;
+
+            bool s_isValidRate(const RequestRate &rate) noexcept { return rate.PerSecond > 0 && rate.Burst > 0; }
+
+            /* Adds the tokens earned since `refilledAtNs`, up to the burst. */
+            void s_refill(const RequestRate &rate, double &tokens, uint64_t &refilledAtNs, uint64_t nowNs) noexcept
+            {
+                if (nowNs > refilledAtNs)
+                {
+                    tokens += static_cast<double>(nowNs - refilledAtNs) * rate.PerSecond / s_nsPerSecond;
+                    tokens = tokens < rate.Burst ? tokens : rate.Burst;
+                    refilledAtNs = nowNs;
+                }
+            }
+        } // namespace
+
+        struct RequestRateLimiter::WakeTask
+        {
+            aws_task Task;
+            std::weak_ptr<RequestRateLimiter> Limiter;
+            uint64_t WakeAtNs;
+            Crt::Allocator *Allocator;
+
+            static void s_run(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *wakeTask = static_cast<WakeTask *>(arg);
+                auto limiter = wakeTask->Limiter.lock();
+                uint64_t wakeAtNs = wakeTask->WakeAtNs;
+                Crt::Delete(wakeTask, wakeTask->Allocator);
+
+                if (limiter && status == AWS_TASK_STATUS_RUN_READY)
+                {
+                    limiter->OnWake(wakeAtNs);
+                }
+            }
+        };
+
+        RequestRateLimiterConfig::RequestRateLimiterConfig() noexcept
+            : EventLoopGroup(nullptr), Shadow{10, 10}, Jobs{10, 10}, Provisioning{10, 10}, MaxQueued(0),
+              CoalesceByTopic(false)
+        {
+        }
+
+        RequestRateLimiter::RequestRateLimiter(
+            const RequestRateLimiterConfig &config,
+            aws_event_loop *eventLoop,
+            Crt::Allocator *allocator) noexcept
+            : m_config(config), m_eventLoop(eventLoop), m_allocator(allocator),
+              m_buckets(Crt::StlAllocator<std::pair<const Crt::String, Bucket>>(allocator)), m_queued(0),
+              m_wakeAtNs(0), m_delayedCount(0), m_coalescedCount(0)
+        {
+        }
+
+        std::shared_ptr<RequestRateLimiter> RequestRateLimiter::Create(
+            const RequestRateLimiterConfig &config,
+            Crt::Allocator *allocator)
+        {
+            aws_event_loop *eventLoop = nullptr;
+            if (config.EventLoopGroup)
+            {
+                eventLoop = aws_event_loop_group_get_next_loop(config.EventLoopGroup->GetUnderlyingHandle());
+            }
+            if (!eventLoop || !s_isValidRate(config.Shadow) || !s_isValidRate(config.Jobs) ||
+                !s_isValidRate(config.Provisioning))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<RequestRateLimiter *>(aws_mem_acquire(allocator, sizeof(RequestRateLimiter)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) RequestRateLimiter(config, eventLoop, allocator);
+                return std::shared_ptr<RequestRateLimiter>(
+                    toSeat, [allocator](RequestRateLimiter *limiter) { Crt::Delete(limiter, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        RequestRateLimiter::Bucket &RequestRateLimiter::BucketLocked(
+            RateLimitedApi api,
+            const char *topic,
+            uint64_t nowNs)
+        {
+            /* One bucket per API and thing; provisioning is limited per account, so it has only one. */
+            Crt::String key(1, static_cast<char>('0' + static_cast<int>(api)), Crt::StlAllocator<char>(m_allocator));
+            const RequestRate *rate = &m_config.Provisioning;
+            if (api != RateLimitedApi::Provisioning)
+            {
+                Crt::ByteCursor thingName = ThingNameOfTopic(aws_byte_cursor_from_c_str(topic));
+                key.append(reinterpret_cast<const char *>(thingName.ptr), thingName.len);
+                rate = api == RateLimitedApi::Shadow ? &m_config.Shadow : &m_config.Jobs;
+            }
+
+            auto inserted = m_buckets.emplace(std::move(key), Bucket());
+            Bucket &bucket = inserted.first->second;
+            if (inserted.second)
+            {
+                /* A new bucket starts full. */
+                bucket.Rate = *rate;
+                bucket.Tokens = rate->Burst;
+                bucket.RefilledAtNs = nowNs;
+            }
+            s_refill(bucket.Rate, bucket.Tokens, bucket.RefilledAtNs, nowNs);
+            return bucket;
+        }
+
+        bool RequestRateLimiter::TryAcquire(RateLimitedApi api, const char *topic)
+        {
+            uint64_t nowNs = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &nowNs);
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            Bucket &bucket = BucketLocked(api, topic, nowNs);
+            /* Queued requests go first, so a bucket's requests are published in order. */
+            if (!bucket.Queued.empty() || bucket.Tokens < 1)
+            {
+                return false;
+            }
+            bucket.Tokens -= 1;
+            return true;
+        }
+
+        bool RequestRateLimiter::Enqueue(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            RateLimitedApi api,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteBuf &payload,
+            OnPublished &&onPublished)
+        {
+            uint64_t nowNs = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &nowNs);
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            Bucket &bucket = BucketLocked(api, topic, nowNs);
+            ++m_delayedCount;
+
+            if (m_config.CoalesceByTopic)
+            {
+                for (const std::shared_ptr<Held> &queued : bucket.Queued)
+                {
+                    if (queued->Topic != topic)
+                    {
+                        continue;
+                    }
+
+                    queued->Connection = connection;
+                    queued->Qos = qos;
+                    queued->Payload.assign(reinterpret_cast<const char *>(payload.buffer), payload.len);
+                    OnPublished replaced = std::move(queued->Handler);
+                    OnPublished replacing = std::move(onPublished);
+                    queued->Handler = [replaced, replacing](int errorCode) {
+                        if (replaced)
+                        {
+                            replaced(errorCode);
+                        }
+                        if (replacing)
+                        {
+                            replacing(errorCode);
+                        }
+                    };
+                    ++m_coalescedCount;
+                    return true;
+                }
+            }
+
+            if (m_config.MaxQueued && m_queued >= m_config.MaxQueued)
+            {
+                --m_delayedCount;
+                aws_raise_error(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE);
+                return false;
+            }
+
+            auto held = Crt::MakeShared<Held>(m_allocator);
+            if (!held)
+            {
+                --m_delayedCount;
+                return false;
+            }
+            held->Connection = connection;
+            held->Topic = topic;
+            held->Qos = qos;
+            held->Payload.assign(reinterpret_cast<const char *>(payload.buffer), payload.len);
+            held->Handler = std::move(onPublished);
+
+            /* The head of the queue goes out when the bucket next holds a whole token; behind it, the wake-up
+             * releasing the head is armed already. */
+            if (bucket.Queued.empty())
+            {
+                double missing = bucket.Tokens < 1 ? 1 - bucket.Tokens : 0;
+                uint64_t wakeAtNs = nowNs + static_cast<uint64_t>(missing * s_nsPerSecond / bucket.Rate.PerSecond);
+                if (!ArmLocked(wakeAtNs))
+                {
+                    --m_delayedCount;
+                    return false;
+                }
+            }
+
+            bucket.Queued.push_back(std::move(held));
+            ++m_queued;
+            return true;
+        }
+
+        bool RequestRateLimiter::ArmLocked(uint64_t wakeAtNs)
+        {
+            if (m_wakeAtNs != 0 && m_wakeAtNs <= wakeAtNs)
+            {
+                return true;
+            }
+
+            auto *wakeTask = Crt::New<WakeTask>(m_allocator);
+            if (!wakeTask)
+            {
+                return false;
+            }
+
+            /* A later wake-up already armed finds m_wakeAtNs changed and does nothing. */
+            wakeTask->Limiter = shared_from_this();
+            wakeTask->WakeAtNs = wakeAtNs;
+            wakeTask->Allocator = m_allocator;
+            aws_task_init(&wakeTask->Task, WakeTask::s_run, wakeTask, "RequestRateLimiterWake");
+            aws_event_loop_schedule_task_future(m_eventLoop, &wakeTask->Task, wakeAtNs);
+            m_wakeAtNs = wakeAtNs;
+            return true;
+        }
+
+        void RequestRateLimiter::OnWake(uint64_t wakeAtNs)
+        {
+            uint64_t nowNs = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &nowNs);
+
+            Crt::Vector<std::shared_ptr<Held>> ready{Crt::StlAllocator<std::shared_ptr<Held>>(m_allocator)};
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_wakeAtNs != wakeAtNs)
+                {
+                    return;
+                }
+                m_wakeAtNs = 0;
+
+                uint64_t nextWakeNs = 0;
+                for (auto it = m_buckets.begin(); it != m_buckets.end();)
+                {
+                    Bucket &bucket = it->second;
+                    s_refill(bucket.Rate, bucket.Tokens, bucket.RefilledAtNs, nowNs);
+
+                    while (!bucket.Queued.empty() && bucket.Tokens >= 1)
+                    {
+                        bucket.Tokens -= 1;
+                        ready.push_back(std::move(bucket.Queued.front()));
+                        bucket.Queued.pop_front();
+                        --m_queued;
+                    }
+
+                    if (!bucket.Queued.empty())
+                    {
+                        uint64_t dueNs = nowNs + static_cast<uint64_t>(
+                                                     (1 - bucket.Tokens) * s_nsPerSecond / bucket.Rate.PerSecond);
+                        nextWakeNs = nextWakeNs == 0 || dueNs < nextWakeNs ? dueNs : nextWakeNs;
+                        ++it;
+                    }
+                    else if (bucket.Tokens >= bucket.Rate.Burst)
+                    {
+                        /* A full, idle bucket is the same as none, so things that went quiet cost nothing. */
+                        it = m_buckets.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+
+                if (nextWakeNs)
+                {
+                    ArmLocked(nextWakeNs);
+                }
+            }
+
+            for (const std::shared_ptr<Held> &held : ready)
+            {
+                /* The completion holds the copy, so the payload outlives the publish. */
+                Crt::ByteBuf payload = aws_byte_buf_from_array(held->Payload.data(), held->Payload.size());
+                uint16_t packetId = held->Connection->Publish(
+                    held->Topic.c_str(),
+                    held->Qos,
+                    false,
+                    payload,
+                    [held](Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                        if (held->Handler)
+                        {
+                            held->Handler(errorCode);
+                        }
+                    });
+                if (packetId == 0 && held->Handler)
+                {
+                    held->Handler(Crt::LastErrorOrUnknown());
+                }
+            }
+        }
+
+        size_t RequestRateLimiter::GetQueuedCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_queued;
+        }
+
+        uint64_t RequestRateLimiter::GetDelayedCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_delayedCount;
+        }
+
+        uint64_t RequestRateLimiter::GetCoalescedCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_coalescedCount;
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,428 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/RequestTracer.h>
+
+#include <aws/iotdevicecommon/JsonPayloadScanner.h>
+
+#include <aws/common/clock.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            thread_local RequestTracer::ResponseScope *s_currentScope = nullptr;
+
+            /* Response topics are the request topic followed by /accepted or /rejected. */
+            bool s_requestTopicOf(const Crt::String &responseTopic, Crt::String &requestTopic)
+            {
+                static const char accepted[] = "/accepted";
+                static const char rejected[] = "/rejected";
+                for (const char *suffix : {accepted, rejected})
+                {
+                    size_t suffixLength = sizeof(accepted) - 1;
+                    if (responseTopic.size() > suffixLength &&
+                        responseTopic.compare(responseTopic.size() - suffixLength, suffixLength, suffix) == 0)
+                    {
+                        requestTopic = responseTopic.substr(0, responseTopic.size() - suffixLength);
+                        return true;
+                    }
+                }
+                return false;
+            }
+        } // namespace
+
+        RequestTracer::RequestTracer(OnSpanStart &&onSpanStart, OnSpanEnd &&onSpanEnd, size_t maxPendingRequests)
+            noexcept
+            : m_onSpanStart(std::move(onSpanStart)), m_onSpanEnd(std::move(onSpanEnd)),
+              m_maxPendingRequests(maxPendingRequests ? maxPendingRequests : 1), m_nextTraceId(1),
+              m_responseLatency()
+        {
+        }
+
+        uint64_t RequestTracer::StartRequest(const Crt::String &topic, const Crt::Optional<Crt::String> *clientToken)
+        {
+            PendingRequest request;
+            request.Topic = topic;
+            if (clientToken)
+            {
+                request.ClientToken = *clientToken;
+            }
+            request.Stage = PendingStage::Serializing;
+            aws_high_res_clock_get_ticks(&request.StartNs);
+
+            PendingRequest evicted;
+            evicted.TraceId = 0;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                request.TraceId = m_nextTraceId++;
+
+                size_t awaiting = 0;
+                for (const PendingRequest &pending : m_pending)
+                {
+                    awaiting += pending.Stage == PendingStage::AwaitingResponse;
+                }
+                if (awaiting >= m_maxPendingRequests)
+                {
+                    for (size_t i = 0; i < m_pending.size(); ++i)
+                    {
+                        if (m_pending[i].Stage == PendingStage::AwaitingResponse)
+                        {
+                            evicted = std::move(m_pending[i]);
+                            m_pending.erase(m_pending.begin() + static_cast<std::ptrdiff_t>(i));
+                            break;
+                        }
+                    }
+                }
+
+                m_pending.push_back(request);
+            }
+
+            if (evicted.TraceId && m_onSpanEnd)
+            {
+                m_onSpanEnd(evicted.TraceId, RequestStage::Service, evicted.Topic, AWS_ERROR_MQTT_TIMEOUT);
+                m_onSpanEnd(evicted.TraceId, RequestStage::Request, evicted.Topic, AWS_ERROR_MQTT_TIMEOUT);
+            }
+
+            if (m_onSpanStart)
+            {
+                m_onSpanStart(request.TraceId, RequestStage::Request, topic);
+                m_onSpanStart(request.TraceId, RequestStage::Serialize, topic);
+            }
+            return request.TraceId;
+        }
+
+        void RequestTracer::EndSerialize(uint64_t traceId, const Crt::String &topic, int errorCode)
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                for (size_t i = 0; i < m_pending.size(); ++i)
+                {
+                    if (m_pending[i].TraceId == traceId)
+                    {
+                        if (errorCode)
+                        {
+                            m_pending.erase(m_pending.begin() + static_cast<std::ptrdiff_t>(i));
+                        }
+                        else
+                        {
+                            m_pending[i].Stage = PendingStage::Publishing;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            if (m_onSpanEnd)
+            {
+                m_onSpanEnd(traceId, RequestStage::Serialize, topic, errorCode);
+                if (errorCode)
+                {
+                    m_onSpanEnd(traceId, RequestStage::Request, topic, errorCode);
+                }
+            }
+        }
+
+        void RequestTracer::EndPublish(uint64_t traceId, const Crt::String &topic, int errorCode)
+        {
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                for (size_t i = 0; i < m_pending.size(); ++i)
+                {
+                    if (m_pending[i].TraceId == traceId && m_pending[i].Stage == PendingStage::Publishing)
+                    {
+                        found = true;
+                        if (errorCode)
+                        {
+                            m_pending.erase(m_pending.begin() + static_cast<std::ptrdiff_t>(i));
+                        }
+                        else
+                        {
+                            m_pending[i].Stage = PendingStage::AwaitingResponse;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            /* Not found: the response overtook the PUBACK and already closed the span. */
+            if (!found)
+            {
+                return;
+            }
+
+            if (errorCode)
+            {
+                if (m_onSpanEnd)
+                {
+                    m_onSpanEnd(traceId, RequestStage::Publish, topic, errorCode);
+                    m_onSpanEnd(traceId, RequestStage::Request, topic, errorCode);
+                }
+                return;
+            }
+
+            if (m_onSpanEnd)
+            {
+                m_onSpanEnd(traceId, RequestStage::Publish, topic, AWS_ERROR_SUCCESS);
+            }
+            if (m_onSpanStart)
+            {
+                m_onSpanStart(traceId, RequestStage::Service, topic);
+            }
+        }
+
+        uint64_t RequestTracer::MatchResponse(const Crt::String &requestTopic, const Crt::ByteBuf &payload)
+        {
+            Crt::ByteCursor tokenValue;
+            AWS_ZERO_STRUCT(tokenValue);
+            bool hasToken =
+                JsonPayloadScanner::FindMember(Crt::ByteCursorFromByteBuf(payload), "clientToken", tokenValue) &&
+                tokenValue.len >= 2 && tokenValue.ptr[0] == '"';
+            if (hasToken)
+            {
+                /* Drop the quotes. Tokens needing escapes are compared escaped, and simply never match. */
+                aws_byte_cursor_advance(&tokenValue, 1);
+                --tokenValue.len;
+            }
+
+            PendingRequest matched;
+            matched.TraceId = 0;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                for (size_t i = 0; i < m_pending.size(); ++i)
+                {
+                    const PendingRequest &pending = m_pending[i];
+                    if (pending.Stage == PendingStage::Serializing || pending.Topic != requestTopic)
+                    {
+                        continue;
+                    }
+                    if (hasToken &&
+                        (!pending.ClientToken ||
+                         !aws_byte_cursor_eq_c_str(&tokenValue, pending.ClientToken->c_str())))
+                    {
+                        continue;
+                    }
+
+                    matched = std::move(m_pending[i]);
+                    m_pending.erase(m_pending.begin() + static_cast<std::ptrdiff_t>(i));
+                    break;
+                }
+            }
+
+            if (!matched.TraceId)
+            {
+                return 0;
+            }
+
+            uint64_t nowNs = 0;
+            aws_high_res_clock_get_ticks(&nowNs);
+            m_responseLatency.Record(nowNs - matched.StartNs);
+
+            if (matched.Stage == PendingStage::Publishing)
+            {
+                if (m_onSpanEnd)
+                {
+                    m_onSpanEnd(matched.TraceId, RequestStage::Publish, requestTopic, AWS_ERROR_SUCCESS);
+                }
+                if (m_onSpanStart)
+                {
+                    m_onSpanStart(matched.TraceId, RequestStage::Service, requestTopic);
+                }
+            }
+            if (m_onSpanEnd)
+            {
+                m_onSpanEnd(matched.TraceId, RequestStage::Service, requestTopic, AWS_ERROR_SUCCESS);
+            }
+            return matched.TraceId;
+        }
+
+        RequestTracer::ResponseScope::ResponseScope(
+            RequestTracer *tracer,
+            const Crt::String &topic,
+            const Crt::ByteBuf &payload)
+            : m_tracer(nullptr), m_traceId(0), m_requestTopic(), m_outer(nullptr)
+        {
+            if (!tracer || !s_requestTopicOf(topic, m_requestTopic))
+            {
+                return;
+            }
+
+            m_traceId = tracer->MatchResponse(m_requestTopic, payload);
+            if (!m_traceId)
+            {
+                return;
+            }
+
+            m_tracer = tracer;
+            m_outer = s_currentScope;
+            s_currentScope = this;
+            if (m_tracer->m_onSpanStart)
+            {
+                m_tracer->m_onSpanStart(m_traceId, RequestStage::Handler, m_requestTopic);
+            }
+        }
+
+        RequestTracer::ResponseScope::~ResponseScope()
+        {
+            if (!m_tracer)
+            {
+                return;
+            }
+
+            s_currentScope = m_outer;
+            if (m_tracer->m_onSpanEnd)
+            {
+                m_tracer->m_onSpanEnd(m_traceId, RequestStage::Handler, m_requestTopic, AWS_ERROR_SUCCESS);
+                m_tracer->m_onSpanEnd(m_traceId, RequestStage::Request, m_requestTopic, AWS_ERROR_SUCCESS);
+            }
+        }
+
+        void RequestTracer::ResponseScope::StartParse()
+        {
+            if (m_tracer->m_onSpanStart)
+            {
+                m_tracer->m_onSpanStart(m_traceId, RequestStage::Parse, m_requestTopic);
+            }
+        }
+
+        void RequestTracer::ResponseScope::EndParse(int errorCode)
+        {
+            if (m_tracer->m_onSpanEnd)
+            {
+                m_tracer->m_onSpanEnd(m_traceId, RequestStage::Parse, m_requestTopic, errorCode);
+            }
+        }
+
+        RequestTracer::ResponseScope *RequestTracer::ResponseScope::Current() noexcept { return s_currentScope; }
+
+        RequestTrace::RequestTrace(
+            const std::shared_ptr<RequestTracer> &tracer,
+            const char *topic,
+            const Crt::Optional<Crt::String> *clientToken)
+            : m_tracer(), m_traceId(0), m_topic()
+        {
+            if (tracer)
+            {
+                m_tracer = tracer;
+                m_topic = topic;
+                m_traceId = m_tracer->StartRequest(m_topic, clientToken && *clientToken ? clientToken : nullptr);
+            }
+        }
+
+        bool RequestTrace::EndSerialize(bool serialized)
+        {
+            if (m_traceId)
+            {
+                m_tracer->EndSerialize(m_traceId, m_topic, serialized ? AWS_ERROR_SUCCESS : aws_last_error());
+            }
+            return serialized;
+        }
+
+        RequestTrace::PublishSpan RequestTrace::StartPublish()
+        {
+            if (m_tracer->m_onSpanStart)
+            {
+                m_tracer->m_onSpanStart(m_traceId, RequestStage::Publish, m_topic);
+            }
+
+            PublishSpan span;
+            span.m_tracer = m_tracer;
+            span.m_traceId = m_traceId;
+            span.m_topic = m_topic;
+            return span;
+        }
+
+        void RequestTrace::PublishSpan::End(int errorCode) const
+        {
+            m_tracer->EndPublish(m_traceId, m_topic, errorCode);
+        }
+
+        void RequestTrace::EndPublish(int errorCode)
+        {
+            if (m_traceId)
+            {
+                m_tracer->EndPublish(m_traceId, m_topic, errorCode);
+            }
+        }
+
+        uint16_t PublishWithMetrics(
+            Crt::Mqtt::MqttConnection &connection,
+            const std::shared_ptr<ServiceMetrics> &metrics,
+            const std::shared_ptr<MemoryBudget> &budget,
+            RequestTrace &trace,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteBuf &payload,
+            OnPublishOperationComplete &&onOpComplete)
+        {
+            if (!trace.IsActive())
+            {
+                return PublishWithMetrics(connection, metrics, budget, topic, qos, payload, std::move(onOpComplete));
+            }
+
+            RequestTrace::PublishSpan span = trace.StartPublish();
+            MemoryBudget::Slot publishSlot;
+            if (budget)
+            {
+                publishSlot = budget->AcquirePublish();
+                if (!publishSlot)
+                {
+                    span.End(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE);
+                    aws_raise_error(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE);
+                    return 0;
+                }
+            }
+
+            /*
+             * Metrics are recorded here rather than by wrapping the untraced overload, so the publish's
+             * completion reaches the connection as one handler instead of a chain of them.
+             */
+            Crt::String metricsTopic;
+            uint64_t startNs = 0;
+            if (metrics)
+            {
+                metricsTopic = topic;
+                metrics->RecordPublish(metricsTopic, payload.len);
+                aws_high_res_clock_get_ticks(&startNs);
+            }
+
+            auto onComplete = [metrics, metricsTopic, startNs, span, publishSlot, onOpComplete](
+                                  Crt::Mqtt::MqttConnection &completedConnection, uint16_t packetId, int errorCode) {
+                if (metrics)
+                {
+                    metrics->RecordPublishComplete(metricsTopic);
+                    if (!errorCode)
+                    {
+                        uint64_t endNs = 0;
+                        aws_high_res_clock_get_ticks(&endNs);
+                        metrics->RecordPublishLatency(endNs - startNs);
+                    }
+                }
+                span.End(errorCode);
+                if (onOpComplete)
+                {
+                    onOpComplete(completedConnection, packetId, errorCode);
+                }
+            };
+
+            uint16_t packetId = connection.Publish(topic, qos, false, payload, std::move(onComplete));
+            if (packetId == 0)
+            {
+                int errorCode = aws_last_error();
+                if (metrics)
+                {
+                    metrics->RecordPublishComplete(metricsTopic);
+                }
+                span.End(errorCode);
+                aws_raise_error(errorCode);
+            }
+            return packetId;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,207 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/ServiceBootstrap.h>
+
+#include <aws/common/clock.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            uint64_t s_nowNs() noexcept
+            {
+                uint64_t nowNs = 0;
+                aws_high_res_clock_get_ticks(&nowNs);
+                return nowNs;
+            }
+        } // namespace
+
+        ServiceBootstrap::ServiceBootstrap() noexcept
+            : m_started(false), m_startNs(0), m_doneCount(0), m_errorCode(AWS_ERROR_SUCCESS)
+        {
+        }
+
+        std::shared_ptr<ServiceBootstrap> ServiceBootstrap::Create(Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<ServiceBootstrap *>(aws_mem_acquire(allocator, sizeof(ServiceBootstrap)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ServiceBootstrap();
+                return std::shared_ptr<ServiceBootstrap>(
+                    toSeat, [allocator](ServiceBootstrap *bootstrap) { Crt::Delete(bootstrap, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        size_t ServiceBootstrap::AddStep(const char *name, StartStep &&start, std::initializer_list<size_t> after)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_started)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return 0;
+            }
+
+            /* Only earlier steps can be waited on, so the steps can never wait on each other in a cycle. */
+            for (size_t id : after)
+            {
+                if (id == 0 || id > m_steps.size())
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                    return 0;
+                }
+            }
+
+            Step step;
+            step.Name = name;
+            step.Start = std::move(start);
+            for (size_t id : after)
+            {
+                step.After.push_back(id - 1);
+            }
+            step.State = StepState::Waiting;
+            step.Started = false;
+            step.StartNs = 0;
+            step.DurationNs = 0;
+            step.ErrorCode = AWS_ERROR_SUCCESS;
+            m_steps.push_back(std::move(step));
+            return m_steps.size();
+        }
+
+        bool ServiceBootstrap::Start(OnReady &&onReady)
+        {
+            Crt::Vector<size_t> ready;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_started)
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_STATE);
+                    return false;
+                }
+                m_started = true;
+                m_onReady = std::move(onReady);
+                m_startNs = s_nowNs();
+                Advance(m_startNs, ready);
+            }
+
+            if (m_steps.empty())
+            {
+                Complete(0, AWS_ERROR_SUCCESS);
+                return true;
+            }
+
+            Launch(std::move(ready));
+            return true;
+        }
+
+        void ServiceBootstrap::Launch(Crt::Vector<size_t> &&indices)
+        {
+            std::shared_ptr<ServiceBootstrap> self = shared_from_this();
+            for (size_t index : indices)
+            {
+                /* The steps are fixed once started, so the start function is safe to call unlocked. */
+                OnStepComplete onComplete = [self, index](int errorCode) { self->Complete(index, errorCode); };
+
+                if (!m_steps[index].Start(onComplete))
+                {
+                    onComplete(aws_last_error());
+                }
+            }
+        }
+
+        void ServiceBootstrap::Complete(size_t index, int errorCode)
+        {
+            Crt::Vector<size_t> ready;
+            OnReady onReady;
+            BootstrapReport report;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                uint64_t nowNs = s_nowNs();
+                if (index < m_steps.size())
+                {
+                    Step &step = m_steps[index];
+                    if (step.State != StepState::Running)
+                    {
+                        return;
+                    }
+                    step.State = StepState::Done;
+                    step.DurationNs = nowNs - m_startNs - step.StartNs;
+                    step.ErrorCode = errorCode;
+                    ++m_doneCount;
+                    if (errorCode != AWS_ERROR_SUCCESS && m_errorCode == AWS_ERROR_SUCCESS)
+                    {
+                        m_errorCode = errorCode;
+                    }
+                    Advance(nowNs, ready);
+                }
+
+                if (m_doneCount == m_steps.size() && m_onReady)
+                {
+                    onReady = std::move(m_onReady);
+                    m_onReady = nullptr;
+                    report.ErrorCode = m_errorCode;
+                    report.DurationNs = nowNs - m_startNs;
+                    for (const Step &step : m_steps)
+                    {
+                        report.Steps.push_back(BootstrapStep{
+                            step.Name, step.StartNs, step.DurationNs, step.ErrorCode, step.Started});
+                    }
+                }
+            }
+
+            Launch(std::move(ready));
+            if (onReady)
+            {
+                onReady(report);
+            }
+        }
+
+        void ServiceBootstrap::Advance(uint64_t nowNs, Crt::Vector<size_t> &ready)
+        {
+            /* Dependencies come earlier, so one pass in order settles drops that cascade. */
+            for (size_t index = 0; index < m_steps.size(); ++index)
+            {
+                Step &step = m_steps[index];
+                if (step.State != StepState::Waiting)
+                {
+                    continue;
+                }
+
+                bool waiting = false;
+                int failed = AWS_ERROR_SUCCESS;
+                for (size_t dependency : step.After)
+                {
+                    const Step &before = m_steps[dependency];
+                    if (before.State != StepState::Done)
+                    {
+                        waiting = true;
+                    }
+                    else if (before.ErrorCode != AWS_ERROR_SUCCESS && failed == AWS_ERROR_SUCCESS)
+                    {
+                        failed = before.ErrorCode;
+                    }
+                }
+
+                if (failed != AWS_ERROR_SUCCESS)
+                {
+                    step.State = StepState::Done;
+                    step.ErrorCode = failed;
+                    ++m_doneCount;
+                }
+                else if (!waiting)
+                {
+                    step.State = StepState::Running;
+                    step.Started = true;
+                    step.StartNs = nowNs - m_startNs;
+                    ready.push_back(index);
+                }
+            }
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,23 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/ServiceClientConfig.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        ServiceClientConfig::ServiceClientConfig() noexcept
+            : PayloadBufferPool(), PayloadFormat(Iotdevicecommon::PayloadFormat::Json), HandlerExecutor(),
+              HandlerWatchdog(), EventLoopMonitor(), Metrics(), Tracer(), Session(), ReuseInboundModels(false),
+              OfflineQueue(), MemoryBudget(), PublishScheduler(), ScheduledPublishDeadlineMs(0),
+              CompletionBatcher(), PublishLanes(), ThrottleBreaker(), RateLimiter(),
+              HotStandby(), QosPolicy()
+        {
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,214 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/ServiceLog.h>
+
+#include <aws/common/logging.h>
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            /* Longer lines are cut short; one line is formatted on the stack, never allocated. */
+            const size_t s_lineCapacity = 512;
+
+            const char *s_subsystemNames[ServiceLog::SubsystemCount] = {
+                "shadow",
+                "jobs",
+                "identity",
+                "discovery",
+                "tunneling",
+                "defender",
+                "common",
+            };
+
+            void s_append(char *line, size_t &length, size_t capacity, const char *bytes, size_t count) noexcept
+            {
+                size_t room = capacity - 1 - length;
+                if (count > room)
+                {
+                    count = room;
+                }
+                memcpy(line + length, bytes, count);
+                length += count;
+                line[length] = '\0';
+            }
+
+            void s_appendFormatted(char *line, size_t &length, size_t capacity, const char *format, ...) noexcept
+            {
+                va_list args;
+                va_start(args, format);
+                int written = vsnprintf(line + length, capacity - length, format, args);
+                va_end(args);
+                if (written > 0)
+                {
+                    length += static_cast<size_t>(written) < capacity - length ? static_cast<size_t>(written)
+                                                                               : capacity - 1 - length;
+                }
+            }
+        } // namespace
+
+        std::atomic<int> ServiceLog::s_levels[ServiceLog::SubsystemCount];
+
+        LogField::LogField(const char *key, const char *value) noexcept
+            : m_key(key), m_type(Type::String), m_string(Crt::ByteCursorFromCString(value ? value : ""))
+        {
+        }
+
+        LogField::LogField(const char *key, const Crt::String &value) noexcept
+            : m_key(key), m_type(Type::String), m_string(Crt::ByteCursorFromString(value))
+        {
+        }
+
+        LogField::LogField(const char *key, Crt::ByteCursor value) noexcept
+            : m_key(key), m_type(Type::String), m_string(value)
+        {
+        }
+
+        LogField::LogField(const char *key, bool value) noexcept
+            : m_key(key), m_type(Type::Boolean), m_boolean(value)
+        {
+        }
+
+        LogField::LogField(const char *key, double value) noexcept
+            : m_key(key), m_type(Type::Double), m_double(value)
+        {
+        }
+
+        void LogField::AppendTo(char *line, size_t &length, size_t capacity) const noexcept
+        {
+            s_append(line, length, capacity, " ", 1);
+            s_append(line, length, capacity, m_key, strlen(m_key));
+            s_append(line, length, capacity, "=", 1);
+            switch (m_type)
+            {
+                case Type::String:
+                {
+                    const char *bytes = reinterpret_cast<const char *>(m_string.ptr);
+                    bool quoted = m_string.len == 0;
+                    for (size_t i = 0; i < m_string.len && !quoted; ++i)
+                    {
+                        quoted = bytes[i] == ' ' || bytes[i] == '"' || bytes[i] == '=';
+                    }
+                    if (!quoted)
+                    {
+                        s_append(line, length, capacity, bytes, m_string.len);
+                        break;
+                    }
+                    s_append(line, length, capacity, "\"", 1);
+                    for (size_t i = 0; i < m_string.len; ++i)
+                    {
+                        if (bytes[i] == '"' || bytes[i] == '\\')
+                        {
+                            s_append(line, length, capacity, "\\", 1);
+                        }
+                        s_append(line, length, capacity, bytes + i, 1);
+                    }
+                    s_append(line, length, capacity, "\"", 1);
+                    break;
+                }
+                case Type::Signed:
+                    s_appendFormatted(line, length, capacity, "%" PRId64, m_signed);
+                    break;
+                case Type::Unsigned:
+                    s_appendFormatted(line, length, capacity, "%" PRIu64, m_unsigned);
+                    break;
+                case Type::Boolean:
+                    s_append(line, length, capacity, m_boolean ? "true" : "false", m_boolean ? 4 : 5);
+                    break;
+                case Type::Double:
+                    s_appendFormatted(line, length, capacity, "%g", m_double);
+                    break;
+            }
+        }
+
+        void ServiceLog::SetLevel(LogSubsystem subsystem, Crt::LogLevel level) noexcept
+        {
+            s_levels[static_cast<size_t>(subsystem)].store(static_cast<int>(level), std::memory_order_relaxed);
+        }
+
+        void ServiceLog::SetLevel(Crt::LogLevel level) noexcept
+        {
+            for (std::atomic<int> &subsystemLevel : s_levels)
+            {
+                subsystemLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+            }
+        }
+
+        Crt::LogLevel ServiceLog::GetLevel(LogSubsystem subsystem) noexcept
+        {
+            return static_cast<Crt::LogLevel>(s_levels[static_cast<size_t>(subsystem)].load(std::memory_order_relaxed));
+        }
+
+        void ServiceLog::Write(
+            LogSubsystem subsystem,
+            Crt::LogLevel level,
+            const char *event,
+            std::initializer_list<LogField> fields) noexcept
+        {
+            aws_logger *logger = aws_logger_get();
+            if (!logger)
+            {
+                return;
+            }
+
+            char line[s_lineCapacity];
+            size_t length = 0;
+            line[0] = '\0';
+            const char *name = s_subsystemNames[static_cast<size_t>(subsystem)];
+            s_appendFormatted(line, length, sizeof(line), "[%s] %s", name, event);
+            for (const LogField &field : fields)
+            {
+                field.AppendTo(line, length, sizeof(line));
+            }
+
+            /* Straight to the logger: the subsystem's own level has been checked, not the CRT's. */
+            logger->vtable->log(logger, static_cast<aws_log_level>(level), AWS_LS_COMMON_GENERAL, "%s", line);
+        }
+
+        LogSubsystem ServiceLog::SubsystemOfTopic(const char *topic) noexcept
+        {
+            static const char thingsPrefix[] = "$aws/things/";
+            if (strncmp(topic, thingsPrefix, sizeof(thingsPrefix) - 1) == 0)
+            {
+                const char *service = strchr(topic + sizeof(thingsPrefix) - 1, '/');
+                if (service)
+                {
+                    ++service;
+                    if (strncmp(service, "shadow/", 7) == 0)
+                    {
+                        return LogSubsystem::Shadow;
+                    }
+                    if (strncmp(service, "jobs/", 5) == 0)
+                    {
+                        return LogSubsystem::Jobs;
+                    }
+                    if (strncmp(service, "tunnels/", 8) == 0)
+                    {
+                        return LogSubsystem::SecureTunneling;
+                    }
+                    if (strncmp(service, "defender/", 9) == 0)
+                    {
+                        return LogSubsystem::DeviceDefender;
+                    }
+                }
+                return LogSubsystem::Common;
+            }
+
+            if (strncmp(topic, "$aws/certificates/", 18) == 0 ||
+                strncmp(topic, "$aws/provisioning-templates/", 28) == 0)
+            {
+                return LogSubsystem::Identity;
+            }
+            return LogSubsystem::Common;
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
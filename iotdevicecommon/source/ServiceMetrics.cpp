@@ -0,0 +1,525 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/ServiceMetrics.h>
+
+#include <aws/iotdevicecommon/TrafficRecorder.h>
+
+#include <aws/common/clock.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            thread_local ServiceMetrics::HandlerScope *s_currentScope = nullptr;
+
+            /* Width of the pattern column of ToProfileReport, wide enough for most "$aws/" patterns. */
+            const size_t s_patternColumn = 48;
+
+            const char *s_serviceForTopic(const Crt::String &topic)
+            {
+                static const char thingsPrefix[] = "$aws/things/";
+                if (topic.compare(0, sizeof(thingsPrefix) - 1, thingsPrefix) == 0)
+                {
+                    size_t serviceStart = topic.find('/', sizeof(thingsPrefix) - 1);
+                    if (serviceStart != Crt::String::npos)
+                    {
+                        if (topic.compare(serviceStart + 1, 7, "shadow/") == 0)
+                        {
+                            return "shadow";
+                        }
+                        if (topic.compare(serviceStart + 1, 5, "jobs/") == 0)
+                        {
+                            return "jobs";
+                        }
+                    }
+                    return "other";
+                }
+
+                if (topic.compare(0, 18, "$aws/certificates/") == 0 ||
+                    topic.compare(0, 28, "$aws/provisioning-templates/") == 0)
+                {
+                    return "identity";
+                }
+                return "other";
+            }
+
+            void s_appendLabels(Crt::String &text, const TopicMetrics &metrics)
+            {
+                text.append("{service=\"").append(s_serviceForTopic(metrics.Topic)).append("\",topic=\"");
+                for (char c : metrics.Topic)
+                {
+                    if (c == '\\' || c == '"')
+                    {
+                        text.push_back('\\');
+                        text.push_back(c);
+                    }
+                    else if (c == '\n')
+                    {
+                        text.append("\\n");
+                    }
+                    else
+                    {
+                        text.push_back(c);
+                    }
+                }
+                text.push_back('"');
+            }
+
+            void s_appendCounter(
+                Crt::String &text,
+                const Crt::Vector<TopicMetrics> &topics,
+                const char *name,
+                const char *type,
+                int64_t (*value)(const TopicMetrics &))
+            {
+                char line[64];
+                text.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+                for (const TopicMetrics &metrics : topics)
+                {
+                    text.append(name);
+                    s_appendLabels(text, metrics);
+                    snprintf(line, sizeof(line), "} %" PRId64 "\n", value(metrics));
+                    text.append(line);
+                }
+            }
+
+            void s_appendHistogram(
+                Crt::String &text,
+                const Crt::Vector<TopicMetrics> &topics,
+                const char *name,
+                const LatencyHistogram TopicMetrics::*histogram)
+            {
+                char line[64];
+                text.append("# TYPE ").append(name).append(" histogram\n");
+                for (const TopicMetrics &metrics : topics)
+                {
+                    const LatencyHistogram &latencies = metrics.*histogram;
+                    uint64_t cumulative = 0;
+                    for (size_t i = 0; i < LatencyHistogram::BucketCount; ++i)
+                    {
+                        cumulative += latencies.Buckets[i];
+                        text.append(name).append("_bucket");
+                        s_appendLabels(text, metrics);
+                        if (i + 1 < LatencyHistogram::BucketCount)
+                        {
+                            snprintf(
+                                line,
+                                sizeof(line),
+                                ",le=\"%g\"} %" PRIu64 "\n",
+                                static_cast<double>(uint64_t(1) << i) / 1e6,
+                                cumulative);
+                        }
+                        else
+                        {
+                            snprintf(line, sizeof(line), ",le=\"+Inf\"} %" PRIu64 "\n", cumulative);
+                        }
+                        text.append(line);
+                    }
+
+                    text.append(name).append("_sum");
+                    s_appendLabels(text, metrics);
+                    snprintf(line, sizeof(line), "} %g\n", static_cast<double>(latencies.TotalNs) / 1e9);
+                    text.append(line);
+
+                    text.append(name).append("_count");
+                    s_appendLabels(text, metrics);
+                    snprintf(line, sizeof(line), "} %" PRIu64 "\n", latencies.Count);
+                    text.append(line);
+                }
+            }
+
+            void s_appendSummary(Crt::String &text, const char *name, const LogLinearHistogram &latencies)
+            {
+                char line[96];
+                text.append("# TYPE ").append(name).append(" summary\n");
+                for (double quantile : {0.5, 0.9, 0.99, 0.999})
+                {
+                    snprintf(
+                        line,
+                        sizeof(line),
+                        "%s{quantile=\"%g\"} %g\n",
+                        name,
+                        quantile,
+                        static_cast<double>(latencies.ValueAtPercentile(quantile)) / 1e9);
+                    text.append(line);
+                }
+                snprintf(line, sizeof(line), "%s_sum %g\n", name, static_cast<double>(latencies.TotalNs) / 1e9);
+                text.append(line);
+                snprintf(line, sizeof(line), "%s_count %" PRIu64 "\n", name, latencies.Count);
+                text.append(line);
+            }
+
+            /* The jobs topics whose segment after "jobs/" is an operation rather than a job id. */
+            bool s_isJobsOperation(const Crt::String &segment)
+            {
+                return segment == "notify" || segment == "notify-next" || segment == "get" ||
+                       segment == "start-next";
+            }
+        } // namespace
+
+        LatencyHistogram::LatencyHistogram() noexcept : Buckets(), Count(0), TotalNs(0) {}
+
+        void LatencyHistogram::Record(uint64_t durationNs) noexcept
+        {
+            uint64_t durationUs = durationNs / 1000;
+            size_t bucket = 0;
+            while (durationUs && bucket + 1 < BucketCount)
+            {
+                durationUs >>= 1;
+                ++bucket;
+            }
+
+            ++Buckets[bucket];
+            ++Count;
+            TotalNs += durationNs;
+        }
+
+        TopicMetrics::TopicMetrics() noexcept
+            : Topic(), PublishCount(0), PublishBytes(0), InFlightPublishes(0), ReceiveCount(0), ReceiveBytes(0),
+              HandlerLatency(), ParseTime()
+        {
+        }
+
+        TopicPatternProfile::TopicPatternProfile() noexcept
+            : Pattern(), TopicCount(0), PublishCount(0), PublishBytes(0), ReceiveCount(0), ReceiveBytes(0),
+              HandlerNs(0), ParseNs(0)
+        {
+        }
+
+        ServiceMetrics::ServiceMetrics() noexcept : m_lock(), m_topics(), m_publishLatency(), m_handlerLatency() {}
+
+        ServiceMetrics::HandlerScope::HandlerScope(
+            ServiceMetrics &metrics,
+            const Crt::String &topic,
+            size_t payloadBytes) noexcept
+            : m_metrics(metrics), m_topic(topic), m_payloadBytes(payloadBytes), m_startNs(0), m_parseNs(0),
+              m_outer(s_currentScope)
+        {
+            aws_high_res_clock_get_ticks(&m_startNs);
+            s_currentScope = this;
+        }
+
+        ServiceMetrics::HandlerScope::~HandlerScope()
+        {
+            s_currentScope = m_outer;
+
+            uint64_t endNs = 0;
+            aws_high_res_clock_get_ticks(&endNs);
+            m_metrics.m_handlerLatency.Record(endNs - m_startNs);
+            m_metrics.RecordReceive(m_topic, m_payloadBytes, endNs - m_startNs, m_parseNs);
+        }
+
+        ServiceMetrics::HandlerScope *ServiceMetrics::HandlerScope::Current() noexcept { return s_currentScope; }
+
+        void ServiceMetrics::RecordPublish(const Crt::String &topic, size_t payloadBytes)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            TopicMetrics &metrics = m_topics[topic];
+            ++metrics.PublishCount;
+            metrics.PublishBytes += payloadBytes;
+            ++metrics.InFlightPublishes;
+        }
+
+        void ServiceMetrics::RecordPublishComplete(const Crt::String &topic)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            auto metrics = m_topics.find(topic);
+            if (metrics != m_topics.end() && metrics->second.InFlightPublishes > 0)
+            {
+                --metrics->second.InFlightPublishes;
+            }
+        }
+
+        void ServiceMetrics::RecordReceive(
+            const Crt::String &topic,
+            size_t payloadBytes,
+            uint64_t handlerNs,
+            uint64_t parseNs)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            TopicMetrics &metrics = m_topics[topic];
+            ++metrics.ReceiveCount;
+            metrics.ReceiveBytes += payloadBytes;
+            metrics.HandlerLatency.Record(handlerNs);
+            if (parseNs)
+            {
+                metrics.ParseTime.Record(parseNs);
+            }
+        }
+
+        ServiceLatencies ServiceMetrics::GetLatencies() const noexcept
+        {
+            ServiceLatencies latencies;
+            latencies.PublishToPuback = m_publishLatency.GetSnapshot();
+            latencies.HandlerExecution = m_handlerLatency.GetSnapshot();
+            return latencies;
+        }
+
+        Crt::Vector<TopicMetrics> ServiceMetrics::GetSnapshot() const
+        {
+            Crt::Vector<TopicMetrics> snapshot;
+            std::lock_guard<std::mutex> guard(m_lock);
+            snapshot.reserve(m_topics.size());
+            for (const auto &topic : m_topics)
+            {
+                snapshot.push_back(topic.second);
+                snapshot.back().Topic = topic.first;
+            }
+            return snapshot;
+        }
+
+        void ServiceMetrics::Export(const std::function<void(const TopicMetrics &)> &visitor) const
+        {
+            for (const TopicMetrics &metrics : GetSnapshot())
+            {
+                visitor(metrics);
+            }
+        }
+
+        Crt::String ServiceMetrics::ToPrometheusText() const
+        {
+            Crt::Vector<TopicMetrics> topics = GetSnapshot();
+
+            Crt::String text;
+            s_appendCounter(text, topics, "aws_iot_publish_total", "counter", [](const TopicMetrics &metrics) {
+                return static_cast<int64_t>(metrics.PublishCount);
+            });
+            s_appendCounter(text, topics, "aws_iot_publish_bytes_total", "counter", [](const TopicMetrics &metrics) {
+                return static_cast<int64_t>(metrics.PublishBytes);
+            });
+            s_appendCounter(text, topics, "aws_iot_in_flight_publishes", "gauge", [](const TopicMetrics &metrics) {
+                return metrics.InFlightPublishes;
+            });
+            s_appendCounter(text, topics, "aws_iot_receive_total", "counter", [](const TopicMetrics &metrics) {
+                return static_cast<int64_t>(metrics.ReceiveCount);
+            });
+            s_appendCounter(text, topics, "aws_iot_receive_bytes_total", "counter", [](const TopicMetrics &metrics) {
+                return static_cast<int64_t>(metrics.ReceiveBytes);
+            });
+            s_appendHistogram(text, topics, "aws_iot_handler_seconds", &TopicMetrics::HandlerLatency);
+            s_appendHistogram(text, topics, "aws_iot_parse_seconds", &TopicMetrics::ParseTime);
+
+            ServiceLatencies latencies = GetLatencies();
+            s_appendSummary(text, "aws_iot_publish_to_puback_seconds", latencies.PublishToPuback);
+            s_appendSummary(text, "aws_iot_handler_execution_seconds", latencies.HandlerExecution);
+            return text;
+        }
+
+        Crt::String ServiceMetrics::TopicPattern(const Crt::String &topic)
+        {
+            if (topic.compare(0, 5, "$aws/") != 0)
+            {
+                return topic;
+            }
+
+            Crt::Vector<Crt::String> segments;
+            size_t start = 0;
+            for (;;)
+            {
+                size_t end = topic.find('/', start);
+                segments.push_back(topic.substr(start, end == Crt::String::npos ? Crt::String::npos : end - start));
+                if (end == Crt::String::npos)
+                {
+                    break;
+                }
+                start = end + 1;
+            }
+
+            /* $aws/things/<thing>/shadow/name/<shadow>/..., $aws/things/<thing>/jobs/<jobId>/... */
+            if (segments.size() > 2 && segments[1] == "things")
+            {
+                segments[2] = "+";
+                if (segments.size() > 5 && segments[3] == "shadow" && segments[4] == "name")
+                {
+                    segments[5] = "+";
+                }
+                else if (segments.size() > 4 && segments[3] == "jobs" && !s_isJobsOperation(segments[4]))
+                {
+                    segments[4] = "+";
+                }
+            }
+            else if (segments.size() > 2 && segments[1] == "provisioning-templates")
+            {
+                segments[2] = "+";
+            }
+
+            Crt::String pattern;
+            pattern.reserve(topic.size());
+            for (size_t i = 0; i < segments.size(); ++i)
+            {
+                if (i)
+                {
+                    pattern.push_back('/');
+                }
+                pattern.append(segments[i]);
+            }
+            return pattern;
+        }
+
+        Crt::Vector<TopicPatternProfile> ServiceMetrics::GetProfile() const
+        {
+            Crt::Map<Crt::String, TopicPatternProfile> patterns;
+            for (const TopicMetrics &metrics : GetSnapshot())
+            {
+                TopicPatternProfile &profile = patterns[TopicPattern(metrics.Topic)];
+                ++profile.TopicCount;
+                profile.PublishCount += metrics.PublishCount;
+                profile.PublishBytes += metrics.PublishBytes;
+                profile.ReceiveCount += metrics.ReceiveCount;
+                profile.ReceiveBytes += metrics.ReceiveBytes;
+                profile.HandlerNs += metrics.HandlerLatency.TotalNs;
+                profile.ParseNs += metrics.ParseTime.TotalNs;
+            }
+
+            Crt::Vector<TopicPatternProfile> profile;
+            profile.reserve(patterns.size());
+            for (auto &pattern : patterns)
+            {
+                profile.push_back(std::move(pattern.second));
+                profile.back().Pattern = pattern.first;
+            }
+            std::sort(
+                profile.begin(), profile.end(), [](const TopicPatternProfile &lhs, const TopicPatternProfile &rhs) {
+                    if (lhs.HandlerNs != rhs.HandlerNs)
+                    {
+                        return lhs.HandlerNs > rhs.HandlerNs;
+                    }
+                    return lhs.ReceiveBytes + lhs.PublishBytes > rhs.ReceiveBytes + rhs.PublishBytes;
+                });
+            return profile;
+        }
+
+        Crt::String ServiceMetrics::ToProfileReport() const
+        {
+            char line[256];
+            Crt::String text;
+            snprintf(
+                line,
+                sizeof(line),
+                "%-*s %7s %10s %12s %10s %12s %12s %12s %10s\n",
+                static_cast<int>(s_patternColumn),
+                "pattern",
+                "topics",
+                "received",
+                "bytes in",
+                "published",
+                "bytes out",
+                "handler ms",
+                "parse ms",
+                "us/msg");
+            text.append(line);
+
+            for (const TopicPatternProfile &profile : GetProfile())
+            {
+                /* Appended on its own, so a long application topic cannot truncate the numbers. */
+                text.append(profile.Pattern);
+                if (profile.Pattern.size() < s_patternColumn)
+                {
+                    text.append(s_patternColumn - profile.Pattern.size(), ' ');
+                }
+                snprintf(
+                    line,
+                    sizeof(line),
+                    " %7" PRIu64 " %10" PRIu64 " %12" PRIu64 " %10" PRIu64 " %12" PRIu64 " %12.3f %12.3f %10.1f\n",
+                    profile.TopicCount,
+                    profile.ReceiveCount,
+                    profile.ReceiveBytes,
+                    profile.PublishCount,
+                    profile.PublishBytes,
+                    static_cast<double>(profile.HandlerNs) / 1e6,
+                    static_cast<double>(profile.ParseNs) / 1e6,
+                    profile.ReceiveCount ? static_cast<double>(profile.HandlerNs) / 1e3 / profile.ReceiveCount : 0.0);
+                text.append(line);
+            }
+            return text;
+        }
+
+        void ServiceMetrics::Reset()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_topics.clear();
+            }
+            m_publishLatency.Reset();
+            m_handlerLatency.Reset();
+        }
+
+        uint16_t PublishWithMetrics(
+            Crt::Mqtt::MqttConnection &connection,
+            const std::shared_ptr<ServiceMetrics> &metrics,
+            const std::shared_ptr<MemoryBudget> &budget,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteBuf &payload,
+            OnPublishOperationComplete &&onOpComplete)
+        {
+            MemoryBudget::Slot publishSlot;
+            if (budget)
+            {
+                publishSlot = budget->AcquirePublish();
+                if (!publishSlot)
+                {
+                    return 0;
+                }
+            }
+
+            std::shared_ptr<TrafficRecorder> recorder = TrafficRecorder::Find(connection);
+            if (recorder)
+            {
+                recorder->Record(
+                    TrafficDirection::Outbound, Crt::ByteCursorFromCString(topic), Crt::ByteCursorFromByteBuf(payload));
+            }
+
+            if (!metrics && !publishSlot)
+            {
+                return connection.Publish(
+                    topic, qos, false, payload, Crt::Mqtt::OnOperationCompleteHandler(std::move(onOpComplete)));
+            }
+
+            Crt::String topicName;
+            uint64_t startNs = 0;
+            if (metrics)
+            {
+                topicName = topic;
+                metrics->RecordPublish(topicName, payload.len);
+                aws_high_res_clock_get_ticks(&startNs);
+            }
+
+            /* The slot goes back when the connection drops this handler, whether or not it was called. */
+            auto onComplete = [metrics, topicName, startNs, publishSlot, onOpComplete](
+                                  Crt::Mqtt::MqttConnection &completedConnection, uint16_t packetId, int errorCode) {
+                if (metrics)
+                {
+                    metrics->RecordPublishComplete(topicName);
+                    if (!errorCode)
+                    {
+                        uint64_t endNs = 0;
+                        aws_high_res_clock_get_ticks(&endNs);
+                        metrics->RecordPublishLatency(endNs - startNs);
+                    }
+                }
+                if (onOpComplete)
+                {
+                    onOpComplete(completedConnection, packetId, errorCode);
+                }
+            };
+
+            uint16_t packetId = connection.Publish(topic, qos, false, payload, std::move(onComplete));
+            if (packetId == 0 && metrics)
+            {
+                metrics->RecordPublishComplete(topicName);
+            }
+            return packetId;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,453 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/ServiceOperations.h>
+
+#include <aws/iotdevicecommon/PublishCompletionBatcher.h>
+#include <aws/iotdevicecommon/ServiceLog.h>
+#include <aws/iotdevicecommon/SubscriptionHandle.h>
+
+#include <atomic>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            /* Ends the publish's turn in the lanes before completing it. Held weakly: queued publishes carry it. */
+            OnOperationComplete s_releaseLaneOnComplete(
+                const std::shared_ptr<PublishLanes> &lanes,
+                const OnOperationComplete &onPubAck)
+            {
+                std::weak_ptr<PublishLanes> weakLanes = lanes;
+                return [weakLanes, onPubAck](int errorCode) {
+                    if (auto strongLanes = weakLanes.lock())
+                    {
+                        strongLanes->Release();
+                    }
+                    if (onPubAck)
+                    {
+                        onPubAck(errorCode);
+                    }
+                };
+            }
+
+            void s_logPublish(const char *topic, Crt::Mqtt::QOS qos, size_t payloadBytes, uint16_t packetId)
+            {
+                if (packetId == 0)
+                {
+                    AWS_IOTDEVICE_LOG_WARN(
+                        ServiceLog::SubsystemOfTopic(topic),
+                        "publish refused",
+                        {{"topic", topic}, {"qos", qos}, {"error", aws_error_name(aws_last_error())}});
+                    return;
+                }
+                AWS_IOTDEVICE_LOG_DEBUG(
+                    ServiceLog::SubsystemOfTopic(topic),
+                    "publish",
+                    {{"topic", topic}, {"qos", qos}, {"bytes", payloadBytes}, {"packet_id", packetId}});
+            }
+        } // namespace
+
+        bool SubscribeToTopic(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const TopicBuilder &topic,
+            Crt::Mqtt::QOS qos,
+            Crt::Mqtt::OnMessageReceivedHandler &&onMessage,
+            std::function<void(int errorCode)> &&onSubscribeFailed,
+            const OnOperationComplete &onSubAck,
+            const std::shared_ptr<SessionSubscriptions> &session,
+            const std::shared_ptr<HotStandby> &standby)
+        {
+            if (!topic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            std::shared_ptr<Crt::Mqtt::MqttConnection> peer = standby ? standby->GetPeer(*connection) : nullptr;
+            AWS_IOTDEVICE_LOG_DEBUG(
+                ServiceLog::SubsystemOfTopic(topic.c_str()),
+                "subscribe",
+                {{"topic", topic.c_str()}, {"qos", qos}, {"standby", peer != nullptr}});
+            if (!peer)
+            {
+                auto onSubscribeComplete = [onSubscribeFailed, onSubAck](
+                                               Crt::Mqtt::MqttConnection &,
+                                               uint16_t,
+                                               const Crt::String &subscribedTopic,
+                                               Crt::Mqtt::QOS,
+                                               int errorCode) {
+                    if (errorCode)
+                    {
+                        AWS_IOTDEVICE_LOG_WARN(
+                            ServiceLog::SubsystemOfTopic(subscribedTopic.c_str()),
+                            "subscribe failed",
+                            {{"topic", subscribedTopic}, {"error", aws_error_name(errorCode)}});
+                        onSubscribeFailed(errorCode);
+                    }
+
+                    if (onSubAck)
+                    {
+                        onSubAck(errorCode);
+                    }
+                };
+
+                return SubscribeWithHandle(
+                           connection,
+                           topic.c_str(),
+                           qos,
+                           std::move(onMessage),
+                           std::move(onSubscribeComplete),
+                           session) != 0;
+            }
+
+            /* Both subscriptions share the one handler; held weakly, as the connections hold the handler. */
+            auto sharedMessage = std::make_shared<Crt::Mqtt::OnMessageReceivedHandler>(std::move(onMessage));
+            std::weak_ptr<HotStandby> weakPair = standby;
+            auto onActiveMessage = [sharedMessage, weakPair](
+                                       Crt::Mqtt::MqttConnection &received,
+                                       const Crt::String &receivedTopic,
+                                       const Crt::ByteBuf &payload) {
+                auto pair = weakPair.lock();
+                if (!pair || pair->IsActive(received))
+                {
+                    (*sharedMessage)(received, receivedTopic, payload);
+                }
+            };
+
+            struct PendingAcks
+            {
+                std::atomic<int> Remaining{2};
+                std::atomic<int> ErrorCode{AWS_ERROR_SUCCESS};
+            };
+            auto pending = std::make_shared<PendingAcks>();
+            auto onAck = [pending, onSubscribeFailed, onSubAck](int errorCode) {
+                int expected = AWS_ERROR_SUCCESS;
+                if (errorCode)
+                {
+                    pending->ErrorCode.compare_exchange_strong(expected, errorCode);
+                }
+                if (--pending->Remaining != 0)
+                {
+                    return;
+                }
+
+                int firstError = pending->ErrorCode.load();
+                if (firstError)
+                {
+                    onSubscribeFailed(firstError);
+                }
+                if (onSubAck)
+                {
+                    onSubAck(firstError);
+                }
+            };
+            auto onSubscribeComplete =
+                [onAck](Crt::Mqtt::MqttConnection &, uint16_t, const Crt::String &, Crt::Mqtt::QOS, int errorCode) {
+                    onAck(errorCode);
+                };
+
+            if (SubscribeWithHandle(connection, topic.c_str(), qos, onActiveMessage, onSubscribeComplete, session) == 0)
+            {
+                return false;
+            }
+
+            /* The first subscribe is under way: a failure to queue the second is reported through its ack. */
+            if (SubscribeWithHandle(peer, topic.c_str(), qos, onActiveMessage, onSubscribeComplete, session) == 0)
+            {
+                onAck(Crt::LastErrorOrUnknown());
+            }
+            return true;
+        }
+
+        bool SubscribeToRawMessages(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const TopicBuilder &topic,
+            Crt::Mqtt::QOS qos,
+            OnRawMessageReceived &&handler,
+            const OnOperationComplete &onSubAck,
+            const std::shared_ptr<const HandlerContext> &context,
+            const std::shared_ptr<SessionSubscriptions> &session,
+            Crt::Allocator *allocator)
+        {
+            auto sharedHandler = Crt::MakeShared<OnRawMessageReceived>(allocator, std::move(handler));
+            auto onPublish = [sharedHandler](
+                                 Crt::Mqtt::MqttConnection &, const Crt::String &topic, const Crt::ByteBuf &payload) {
+                RawMessage message;
+                message.Topic = Crt::ByteCursorFromString(topic);
+                message.ThingName = ThingNameOfTopic(message.Topic);
+                message.Payload = Crt::ByteCursorFromByteBuf(payload);
+                (*sharedHandler)(&message, AWS_ERROR_SUCCESS);
+            };
+
+            return SubscribeToTopic(
+                connection,
+                topic,
+                qos,
+                OffloadPublishHandler(std::move(onPublish), context),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                session,
+                context->Standby);
+        }
+
+        bool PublishPooledPayload(
+            Crt::Mqtt::MqttConnection &connection,
+            const std::shared_ptr<ServiceMetrics> &metrics,
+            const std::shared_ptr<MemoryBudget> &budget,
+            RequestTrace &trace,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const std::shared_ptr<PayloadBufferPool> &pool,
+            const Crt::ByteBuf &payload,
+            const OnOperationComplete &onPubAck,
+            const std::shared_ptr<PublishCompletionBatcher> &batcher,
+            const std::shared_ptr<PublishLanes> &lanes,
+            PublishPriority priority)
+        {
+            if (lanes)
+            {
+                OnOperationComplete onLaneComplete = s_releaseLaneOnComplete(lanes, onPubAck);
+                if (lanes->TryAcquire(priority))
+                {
+                    bool published = PublishPooledPayload(
+                        connection, metrics, budget, trace, topic, qos, pool, payload, onLaneComplete, batcher);
+                    if (!published)
+                    {
+                        lanes->Release();
+                    }
+                    return published;
+                }
+
+                /* Held back like a scheduled publish: the trace ends here, the send itself goes untraced. */
+                Crt::String deferredTopic(topic);
+                bool accepted = lanes->Defer(
+                    [metrics, budget, deferredTopic, qos, pool, payload, onLaneComplete, batcher](
+                        Crt::Mqtt::MqttConnection *deferredConnection) {
+                        if (!deferredConnection)
+                        {
+                            Crt::ByteBuf dropped = payload;
+                            pool->Release(dropped);
+                            onLaneComplete(AWS_ERROR_MQTT_NOT_CONNECTED);
+                            return;
+                        }
+
+                        RequestTrace untraced(nullptr, deferredTopic.c_str(), nullptr);
+                        if (!PublishPooledPayload(
+                                *deferredConnection,
+                                metrics,
+                                budget,
+                                untraced,
+                                deferredTopic.c_str(),
+                                qos,
+                                pool,
+                                payload,
+                                onLaneComplete,
+                                batcher))
+                        {
+                            onLaneComplete(aws_last_error());
+                        }
+                    });
+                trace.EndPublish(accepted ? AWS_ERROR_SUCCESS : aws_last_error());
+                if (!accepted)
+                {
+                    Crt::ByteBuf refused = payload;
+                    pool->Release(refused);
+                }
+                return accepted;
+            }
+
+            auto payloadBufferPool = pool;
+            auto onPublishComplete = [payload, payloadBufferPool, onPubAck, batcher](
+                                         Crt::Mqtt::MqttConnection &, uint16_t packetId, int errorCode) {
+                if (batcher)
+                {
+                    batcher->Add(packetId, errorCode, payloadBufferPool, payload, onPubAck);
+                    return;
+                }
+
+                if (onPubAck)
+                {
+                    onPubAck(errorCode);
+                }
+                payloadBufferPool->Release(const_cast<Crt::ByteBuf &>(payload));
+            };
+
+            uint16_t packetId = PublishWithMetrics(
+                connection, metrics, budget, trace, topic, qos, payload, std::move(onPublishComplete));
+            s_logPublish(topic, qos, payload.len, packetId);
+            if (packetId == 0)
+            {
+                Crt::ByteBuf refused = payload;
+                pool->Release(refused);
+            }
+
+            return packetId != 0;
+        }
+
+        bool PublishCallerPayload(
+            Crt::Mqtt::MqttConnection &connection,
+            const std::shared_ptr<ServiceMetrics> &metrics,
+            const std::shared_ptr<MemoryBudget> &budget,
+            RequestTrace &trace,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteCursor &payload,
+            const OnPayloadReleased &onRelease,
+            const OnOperationComplete &onPubAck,
+            const std::shared_ptr<PublishCompletionBatcher> &batcher,
+            const std::shared_ptr<PublishLanes> &lanes,
+            PublishPriority priority)
+        {
+            if (lanes)
+            {
+                OnOperationComplete onLaneComplete = s_releaseLaneOnComplete(lanes, onPubAck);
+                if (lanes->TryAcquire(priority))
+                {
+                    bool published = PublishCallerPayload(
+                        connection, metrics, budget, trace, topic, qos, payload, onRelease, onLaneComplete, batcher);
+                    if (!published)
+                    {
+                        lanes->Release();
+                    }
+                    return published;
+                }
+
+                Crt::String deferredTopic(topic);
+                bool accepted = lanes->Defer(
+                    [metrics, budget, deferredTopic, qos, payload, onRelease, onLaneComplete, batcher](
+                        Crt::Mqtt::MqttConnection *deferredConnection) {
+                        if (!deferredConnection)
+                        {
+                            onLaneComplete(AWS_ERROR_MQTT_NOT_CONNECTED);
+                            if (onRelease)
+                            {
+                                onRelease();
+                            }
+                            return;
+                        }
+
+                        RequestTrace untraced(nullptr, deferredTopic.c_str(), nullptr);
+                        if (!PublishCallerPayload(
+                                *deferredConnection,
+                                metrics,
+                                budget,
+                                untraced,
+                                deferredTopic.c_str(),
+                                qos,
+                                payload,
+                                onRelease,
+                                onLaneComplete,
+                                batcher))
+                        {
+                            onLaneComplete(aws_last_error());
+                        }
+                    });
+                trace.EndPublish(accepted ? AWS_ERROR_SUCCESS : aws_last_error());
+                if (!accepted && onRelease)
+                {
+                    onRelease();
+                }
+                return accepted;
+            }
+
+            /* A non-owning view: the connection reads the caller's bytes until the publish completes. */
+            Crt::ByteBuf view = aws_byte_buf_from_array(payload.ptr, payload.len);
+            auto onPublishComplete = [onRelease, onPubAck, batcher](
+                                         Crt::Mqtt::MqttConnection &, uint16_t packetId, int errorCode) {
+                if (batcher)
+                {
+                    /* The view has no allocator, so the batch leaves it alone. */
+                    batcher->Add(
+                        packetId,
+                        errorCode,
+                        nullptr,
+                        aws_byte_buf_from_array(nullptr, 0),
+                        [onRelease, onPubAck](int batchedErrorCode) {
+                            if (onPubAck)
+                            {
+                                onPubAck(batchedErrorCode);
+                            }
+                            if (onRelease)
+                            {
+                                onRelease();
+                            }
+                        });
+                    return;
+                }
+
+                if (onPubAck)
+                {
+                    onPubAck(errorCode);
+                }
+                if (onRelease)
+                {
+                    onRelease();
+                }
+            };
+
+            uint16_t packetId =
+                PublishWithMetrics(connection, metrics, budget, trace, topic, qos, view, std::move(onPublishComplete));
+            s_logPublish(topic, qos, payload.len, packetId);
+            if (packetId == 0 && onRelease)
+            {
+                onRelease();
+            }
+
+            return packetId != 0;
+        }
+        bool QueueIfRateLimited(
+            const std::shared_ptr<RequestRateLimiter> &limiter,
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            RateLimitedApi api,
+            RequestTrace &trace,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const std::shared_ptr<PayloadBufferPool> &pool,
+            Crt::ByteBuf &payload,
+            const OnOperationComplete &onPubAck,
+            bool &queued)
+        {
+            if (!limiter || limiter->TryAcquire(api, topic))
+            {
+                return false;
+            }
+
+            queued = limiter->Enqueue(connection, api, topic, qos, payload, RequestRateLimiter::OnPublished(onPubAck));
+            trace.EndPublish(queued ? AWS_ERROR_SUCCESS : aws_last_error());
+            pool->Release(payload);
+            return true;
+        }
+
+        bool QueueIfRateLimited(
+            const std::shared_ptr<RequestRateLimiter> &limiter,
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            RateLimitedApi api,
+            RequestTrace &trace,
+            const char *topic,
+            Crt::Mqtt::QOS qos,
+            const Crt::ByteCursor &payload,
+            const OnPayloadReleased &onRelease,
+            const OnOperationComplete &onPubAck,
+            bool &queued)
+        {
+            if (!limiter || limiter->TryAcquire(api, topic))
+            {
+                return false;
+            }
+
+            Crt::ByteBuf view = aws_byte_buf_from_array(payload.ptr, payload.len);
+            queued = limiter->Enqueue(connection, api, topic, qos, view, RequestRateLimiter::OnPublished(onPubAck));
+            trace.EndPublish(queued ? AWS_ERROR_SUCCESS : aws_last_error());
+            if (onRelease)
+            {
+                onRelease();
+            }
+            return true;
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
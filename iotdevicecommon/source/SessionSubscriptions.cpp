@@ -0,0 +1,79 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/SessionSubscriptions.h>
+
+#include <aws/iotdevicecommon/SubscriptionBatch.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        SessionSubscriptions::SessionSubscriptions() noexcept
+            : m_lock(), m_subscriptions(), m_skippedResubscribes(0)
+        {
+        }
+
+        void SessionSubscriptions::Record(
+            const Crt::String &topicFilter,
+            Crt::Mqtt::QOS qos,
+            const Crt::Mqtt::OnMessageReceivedHandler &onMessage)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            Subscription &subscription = m_subscriptions[topicFilter];
+            subscription.Qos = qos;
+            subscription.OnMessage = onMessage;
+        }
+
+        void SessionSubscriptions::Forget(const Crt::String &topicFilter)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_subscriptions.erase(topicFilter);
+        }
+
+        bool SessionSubscriptions::Resume(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            bool sessionPresent,
+            OnResumeComplete &&onComplete)
+        {
+            SubscriptionBatch batch;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (sessionPresent)
+                {
+                    m_skippedResubscribes += m_subscriptions.size();
+                }
+                else
+                {
+                    for (const auto &subscription : m_subscriptions)
+                    {
+                        batch.Add(
+                            connection,
+                            subscription.first.c_str(),
+                            subscription.second.Qos,
+                            Crt::Mqtt::OnMessageReceivedHandler(subscription.second.OnMessage),
+                            nullptr);
+                    }
+                }
+            }
+
+            return batch.Submit(std::move(onComplete));
+        }
+
+        size_t SessionSubscriptions::GetSubscriptionCount() const
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_subscriptions.size();
+        }
+
+        uint64_t SessionSubscriptions::GetSkippedResubscribeCount() const
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_skippedResubscribes;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
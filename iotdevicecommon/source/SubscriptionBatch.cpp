@@ -0,0 +1,171 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/SubscriptionBatch.h>
+
+#include <atomic>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            thread_local SubscriptionBatch *s_capturingBatch = nullptr;
+
+            struct BatchCompletion
+            {
+                BatchCompletion(size_t packets, SubscriptionBatch::OnBatchComplete &&onComplete)
+                    : Remaining(packets), ErrorCode(AWS_ERROR_SUCCESS), OnComplete(std::move(onComplete))
+                {
+                }
+
+                void PacketComplete(int errorCode)
+                {
+                    if (errorCode)
+                    {
+                        int expected = AWS_ERROR_SUCCESS;
+                        ErrorCode.compare_exchange_strong(expected, errorCode);
+                    }
+                    if (--Remaining == 0 && OnComplete)
+                    {
+                        OnComplete(ErrorCode.load());
+                    }
+                }
+
+                std::atomic<size_t> Remaining;
+                std::atomic<int> ErrorCode;
+                SubscriptionBatch::OnBatchComplete OnComplete;
+            };
+        } // namespace
+
+        SubscriptionBatch::SubscriptionBatch() noexcept : m_entries() {}
+
+        SubscriptionBatch::~SubscriptionBatch()
+        {
+            for (Entry &entry : m_entries)
+            {
+                if (entry.OnSubAck)
+                {
+                    entry.OnSubAck(*entry.Connection, 0, entry.TopicFilter, entry.Qos, AWS_ERROR_INVALID_STATE);
+                }
+            }
+        }
+
+        SubscriptionBatch::Capture::Capture(SubscriptionBatch &batch) noexcept : m_outer(s_capturingBatch)
+        {
+            s_capturingBatch = &batch;
+        }
+
+        SubscriptionBatch::Capture::~Capture() { s_capturingBatch = m_outer; }
+
+        void SubscriptionBatch::Add(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const char *topicFilter,
+            Crt::Mqtt::QOS qos,
+            Crt::Mqtt::OnMessageReceivedHandler &&onMessage,
+            Crt::Mqtt::OnSubAckHandler &&onSubAck)
+        {
+            Entry entry;
+            entry.Connection = connection;
+            entry.TopicFilter = topicFilter;
+            entry.Qos = qos;
+            entry.OnMessage = std::move(onMessage);
+            entry.OnSubAck = std::move(onSubAck);
+            m_entries.push_back(std::move(entry));
+        }
+
+        bool SubscriptionBatch::Submit(OnBatchComplete &&onComplete)
+        {
+            Crt::Vector<Entry> entries;
+            entries.swap(m_entries);
+
+            /* One SUBSCRIBE per connection and QoS, keeping the order the subscriptions were made in. */
+            Crt::Vector<Crt::Vector<Entry>> packets;
+            for (Entry &entry : entries)
+            {
+                Crt::Vector<Entry> *packet = nullptr;
+                for (Crt::Vector<Entry> &existing : packets)
+                {
+                    if (existing.front().Connection == entry.Connection && existing.front().Qos == entry.Qos)
+                    {
+                        packet = &existing;
+                        break;
+                    }
+                }
+                if (!packet)
+                {
+                    packets.emplace_back();
+                    packet = &packets.back();
+                }
+                packet->push_back(std::move(entry));
+            }
+
+            if (packets.empty())
+            {
+                if (onComplete)
+                {
+                    onComplete(AWS_ERROR_SUCCESS);
+                }
+                return true;
+            }
+
+            auto completion = std::make_shared<BatchCompletion>(packets.size(), std::move(onComplete));
+            bool submitted = true;
+            for (Crt::Vector<Entry> &packet : packets)
+            {
+                auto subAcks = std::make_shared<Crt::Vector<Entry>>();
+                Crt::Vector<std::pair<const char *, Crt::Mqtt::OnMessageReceivedHandler>> topicFilters;
+                topicFilters.reserve(packet.size());
+                subAcks->reserve(packet.size());
+                for (Entry &entry : packet)
+                {
+                    subAcks->push_back(Entry());
+                    Entry &subAck = subAcks->back();
+                    subAck.TopicFilter = std::move(entry.TopicFilter);
+                    subAck.Qos = entry.Qos;
+                    subAck.OnSubAck = std::move(entry.OnSubAck);
+                    topicFilters.emplace_back(subAck.TopicFilter.c_str(), std::move(entry.OnMessage));
+                }
+
+                auto onMultiSubAck = [subAcks, completion](
+                                         Crt::Mqtt::MqttConnection &connection,
+                                         uint16_t packetId,
+                                         const Crt::Vector<Crt::String> &,
+                                         Crt::Mqtt::QOS,
+                                         int errorCode) {
+                    for (const Entry &subAck : *subAcks)
+                    {
+                        if (subAck.OnSubAck)
+                        {
+                            subAck.OnSubAck(connection, packetId, subAck.TopicFilter, subAck.Qos, errorCode);
+                        }
+                    }
+                    completion->PacketComplete(errorCode);
+                };
+
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection = packet.front().Connection;
+                Crt::Mqtt::QOS qos = packet.front().Qos;
+                if (connection->Subscribe(topicFilters, qos, std::move(onMultiSubAck)) == 0)
+                {
+                    int errorCode = aws_last_error();
+                    for (const Entry &subAck : *subAcks)
+                    {
+                        if (subAck.OnSubAck)
+                        {
+                            subAck.OnSubAck(*connection, 0, subAck.TopicFilter, subAck.Qos, errorCode);
+                        }
+                    }
+                    completion->PacketComplete(errorCode);
+                    submitted = false;
+                }
+            }
+            return submitted;
+        }
+
+        SubscriptionBatch *SubscriptionBatch::Current() noexcept { return s_capturingBatch; }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,188 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/SubscriptionHandle.h>
+
+#include <aws/iotdevicecommon/SessionSubscriptions.h>
+#include <aws/iotdevicecommon/SubscriptionBatch.h>
+#include <aws/iotdevicecommon/ThingTopicDispatcher.h>
+#include <aws/iotdevicecommon/TrafficRecorder.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            thread_local SubscriptionHandle *s_capturingHandle = nullptr;
+
+            /* Stands in for the packet id of a subscription queued into a SubscriptionBatch. */
+            const uint16_t s_queuedPacketId = UINT16_MAX;
+        } // namespace
+
+        SubscriptionHandle::SubscriptionHandle() noexcept : m_subscriptions() {}
+
+        SubscriptionHandle::~SubscriptionHandle() { Unsubscribe(); }
+
+        SubscriptionHandle::SubscriptionHandle(SubscriptionHandle &&toMove) noexcept
+            : m_subscriptions(std::move(toMove.m_subscriptions))
+        {
+            toMove.m_subscriptions.clear();
+        }
+
+        SubscriptionHandle &SubscriptionHandle::operator=(SubscriptionHandle &&toMove) noexcept
+        {
+            if (this != &toMove)
+            {
+                Unsubscribe();
+                m_subscriptions = std::move(toMove.m_subscriptions);
+                toMove.m_subscriptions.clear();
+            }
+            return *this;
+        }
+
+        SubscriptionHandle::Capture::Capture(SubscriptionHandle &handle) noexcept : m_outer(s_capturingHandle)
+        {
+            s_capturingHandle = &handle;
+        }
+
+        SubscriptionHandle::Capture::~Capture() { s_capturingHandle = m_outer; }
+
+        void SubscriptionHandle::Unsubscribe(const Crt::Mqtt::OnOperationCompleteHandler &onUnsubAck)
+        {
+            Crt::Vector<Subscription> subscriptions;
+            subscriptions.swap(m_subscriptions);
+            for (const Subscription &subscription : subscriptions)
+            {
+                std::shared_ptr<SessionSubscriptions> session = subscription.Session.lock();
+                if (session)
+                {
+                    session->Forget(subscription.TopicFilter);
+                }
+
+                std::shared_ptr<Crt::Mqtt::MqttConnection> connection = subscription.Connection.lock();
+                if (connection)
+                {
+                    std::shared_ptr<ThingTopicDispatcher> dispatcher = ThingTopicDispatcher::Find(*connection);
+                    if (!dispatcher || !dispatcher->Unroute(subscription.TopicFilter.c_str(), onUnsubAck))
+                    {
+                        connection->Unsubscribe(
+                            subscription.TopicFilter.c_str(), Crt::Mqtt::OnOperationCompleteHandler(onUnsubAck));
+                    }
+                }
+            }
+        }
+
+        void SubscriptionHandle::Release() noexcept { m_subscriptions.clear(); }
+
+        void SubscriptionHandle::MoveTo(SubscriptionHandle &owner)
+        {
+            for (Subscription &subscription : m_subscriptions)
+            {
+                owner.m_subscriptions.push_back(std::move(subscription));
+            }
+            m_subscriptions.clear();
+        }
+
+        void SubscriptionHandle::Add(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const char *topicFilter,
+            const std::shared_ptr<SessionSubscriptions> &session)
+        {
+            Subscription subscription;
+            subscription.Connection = connection;
+            subscription.TopicFilter = topicFilter;
+            subscription.Session = session;
+            m_subscriptions.push_back(std::move(subscription));
+        }
+
+        SubscriptionHandle *SubscriptionHandle::Current() noexcept { return s_capturingHandle; }
+
+        uint16_t SubscribeWithHandle(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const char *topicFilter,
+            Crt::Mqtt::QOS qos,
+            Crt::Mqtt::OnMessageReceivedHandler &&onMessage,
+            Crt::Mqtt::OnSubAckHandler &&onSubAck,
+            const std::shared_ptr<SessionSubscriptions> &session)
+        {
+            /* The thing's subscription stands in for this one, and is what the session records. */
+            if (ThingTopicDispatcher::Covers(topicFilter))
+            {
+                std::shared_ptr<ThingTopicDispatcher> dispatcher = ThingTopicDispatcher::Find(*connection);
+                if (dispatcher)
+                {
+                    uint16_t routedId =
+                        dispatcher->Route(topicFilter, qos, std::move(onMessage), std::move(onSubAck), session);
+                    SubscriptionHandle *handle = s_capturingHandle;
+                    if (routedId != 0 && handle)
+                    {
+                        handle->Add(connection, topicFilter);
+                    }
+                    return routedId;
+                }
+            }
+
+            std::shared_ptr<TrafficRecorder> recorder = TrafficRecorder::Find(*connection);
+            if (recorder)
+            {
+                onMessage = recorder->Recording(std::move(onMessage));
+            }
+
+            if (session)
+            {
+                /*
+                 * The connection and the session hold the same handler, so both refer to one shared copy of it
+                 * rather than the session keeping its own.
+                 */
+                auto sharedOnMessage = std::make_shared<Crt::Mqtt::OnMessageReceivedHandler>(std::move(onMessage));
+                onMessage = [sharedOnMessage](
+                                Crt::Mqtt::MqttConnection &connection,
+                                const Crt::String &topic,
+                                const Crt::ByteBuf &payload) { (*sharedOnMessage)(connection, topic, payload); };
+
+                std::weak_ptr<SessionSubscriptions> weakSession = session;
+                Crt::Mqtt::OnMessageReceivedHandler recorded(onMessage);
+                Crt::Mqtt::OnSubAckHandler userSubAck(std::move(onSubAck));
+                onSubAck = [weakSession, recorded, userSubAck](
+                               Crt::Mqtt::MqttConnection &connection,
+                               uint16_t packetId,
+                               const Crt::String &topic,
+                               Crt::Mqtt::QOS qos,
+                               int errorCode) {
+                    std::shared_ptr<SessionSubscriptions> recordingSession = weakSession.lock();
+                    if (!errorCode && recordingSession)
+                    {
+                        recordingSession->Record(topic, qos, recorded);
+                    }
+                    if (userSubAck)
+                    {
+                        userSubAck(connection, packetId, topic, qos, errorCode);
+                    }
+                };
+            }
+
+            uint16_t packetId = 0;
+            SubscriptionBatch *batch = SubscriptionBatch::Current();
+            if (batch)
+            {
+                batch->Add(connection, topicFilter, qos, std::move(onMessage), std::move(onSubAck));
+                packetId = s_queuedPacketId;
+            }
+            else
+            {
+                packetId = connection->Subscribe(topicFilter, qos, std::move(onMessage), std::move(onSubAck));
+            }
+
+            SubscriptionHandle *handle = s_capturingHandle;
+            if (packetId != 0 && handle)
+            {
+                handle->Add(connection, topicFilter, session);
+            }
+            return packetId;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,190 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/ThingRegistry.h>
+
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            /* Thing names are at most 128 bytes, so a block holds a few hundred of them. */
+            static const size_t s_blockSize = 16 * 1024;
+            static const size_t s_initialIndexSize = 64;
+
+            uint32_t s_hash(Crt::ByteCursor name) noexcept
+            {
+                /* FNV-1a. */
+                uint32_t hash = 2166136261u;
+                for (size_t i = 0; i < name.len; ++i)
+                {
+                    hash ^= name.ptr[i];
+                    hash *= 16777619u;
+                }
+                return hash;
+            }
+        } // namespace
+
+        ThingRegistry::ThingRegistry(Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_entries(Crt::StlAllocator<Entry>(allocator)),
+              m_index(Crt::StlAllocator<NameId>(allocator)), m_blocks(Crt::StlAllocator<uint8_t *>(allocator)),
+              m_block(nullptr), m_blockUsed(s_blockSize)
+        {
+        }
+
+        ThingRegistry::~ThingRegistry()
+        {
+            for (uint8_t *block : m_blocks)
+            {
+                aws_mem_release(m_allocator, block);
+            }
+        }
+
+        NameId ThingRegistry::FindLocked(Crt::ByteCursor name, uint32_t hash) const noexcept
+        {
+            if (m_index.empty())
+            {
+                return InvalidNameId;
+            }
+
+            const size_t mask = m_index.size() - 1;
+            for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+            {
+                NameId id = m_index[slot];
+                if (id == InvalidNameId)
+                {
+                    return InvalidNameId;
+                }
+
+                const Entry &entry = m_entries[id];
+                if (entry.Hash == hash && entry.Length == name.len &&
+                    (name.len == 0 || memcmp(entry.Name, name.ptr, name.len) == 0))
+                {
+                    return id;
+                }
+            }
+        }
+
+        const uint8_t *ThingRegistry::Store(Crt::ByteCursor name)
+        {
+            const bool ownBlock = name.len > s_blockSize / 4;
+            if (ownBlock || m_blockUsed + name.len > s_blockSize)
+            {
+                const size_t size = ownBlock ? name.len : s_blockSize;
+                auto *block = static_cast<uint8_t *>(aws_mem_acquire(m_allocator, size));
+                if (!block)
+                {
+                    return nullptr;
+                }
+                m_blocks.push_back(block);
+
+                if (ownBlock)
+                {
+                    memcpy(block, name.ptr, name.len);
+                    return block;
+                }
+                m_block = block;
+                m_blockUsed = 0;
+            }
+
+            uint8_t *stored = m_block + m_blockUsed;
+            memcpy(stored, name.ptr, name.len);
+            m_blockUsed += name.len;
+            return stored;
+        }
+
+        void ThingRegistry::Grow()
+        {
+            Crt::Vector<NameId> index(
+                m_index.empty() ? s_initialIndexSize : m_index.size() * 2,
+                InvalidNameId,
+                Crt::StlAllocator<NameId>(m_allocator));
+
+            const size_t mask = index.size() - 1;
+            for (NameId id = 0; id < m_entries.size(); ++id)
+            {
+                size_t slot = m_entries[id].Hash & mask;
+                while (index[slot] != InvalidNameId)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                index[slot] = id;
+            }
+
+            m_index.swap(index);
+        }
+
+        NameId ThingRegistry::Intern(Crt::ByteCursor name)
+        {
+            const uint32_t hash = s_hash(name);
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            NameId existing = FindLocked(name, hash);
+            if (existing != InvalidNameId)
+            {
+                return existing;
+            }
+
+            if (m_entries.size() >= InvalidNameId)
+            {
+                return InvalidNameId;
+            }
+
+            /* Kept at most three quarters full so probe runs stay short. */
+            if ((m_entries.size() + 1) * 4 > m_index.size() * 3)
+            {
+                Grow();
+            }
+
+            const uint8_t *stored = name.len ? Store(name) : nullptr;
+            if (name.len && !stored)
+            {
+                return InvalidNameId;
+            }
+
+            const NameId id = static_cast<NameId>(m_entries.size());
+            Entry entry;
+            entry.Name = stored;
+            entry.Length = static_cast<uint32_t>(name.len);
+            entry.Hash = hash;
+            m_entries.push_back(entry);
+
+            const size_t mask = m_index.size() - 1;
+            size_t slot = hash & mask;
+            while (m_index[slot] != InvalidNameId)
+            {
+                slot = (slot + 1) & mask;
+            }
+            m_index[slot] = id;
+            return id;
+        }
+
+        NameId ThingRegistry::Find(Crt::ByteCursor name) const noexcept
+        {
+            const uint32_t hash = s_hash(name);
+            std::lock_guard<std::mutex> lock(m_lock);
+            return FindLocked(name, hash);
+        }
+
+        Crt::ByteCursor ThingRegistry::GetName(NameId id) const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (id >= m_entries.size())
+            {
+                return Crt::ByteCursorFromArray(nullptr, 0);
+            }
+            return Crt::ByteCursorFromArray(m_entries[id].Name, m_entries[id].Length);
+        }
+
+        size_t ThingRegistry::GetCount() const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_entries.size();
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,730 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/ThingTopicDispatcher.h>
+
+#include <aws/iotdevicecommon/ServiceLog.h>
+#include <aws/iotdevicecommon/SessionSubscriptions.h>
+#include <aws/iotdevicecommon/TrafficRecorder.h>
+
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            const size_t s_noChild = SIZE_MAX;
+
+            /* Stands in for the packet id of a routed subscription, as for one queued into a batch. */
+            const uint16_t s_routedPacketId = UINT16_MAX;
+
+            /* The segments before a thing's own: "$aws/things/<thing>/...". */
+            const size_t s_thingSegment = 2;
+
+            void s_split(const char *topic, Crt::Vector<Crt::String> &segments)
+            {
+                const char *segmentStart = topic;
+                for (const char *cursor = topic;; ++cursor)
+                {
+                    if (*cursor == '\0' || *cursor == '/')
+                    {
+                        segments.emplace_back(segmentStart, static_cast<size_t>(cursor - segmentStart));
+                        if (*cursor == '\0')
+                        {
+                            break;
+                        }
+                        segmentStart = cursor + 1;
+                    }
+                }
+            }
+
+            struct Registration
+            {
+                const Crt::Mqtt::MqttConnection *Connection;
+                const ThingTopicDispatcher *Dispatcher;
+                std::weak_ptr<ThingTopicDispatcher> Weak;
+            };
+
+            /* The dispatcher of each connection, looked up on every subscribe rather than per message. */
+            std::mutex &s_registryLock()
+            {
+                static std::mutex lock;
+                return lock;
+            }
+
+            Crt::Vector<Registration> &s_registry()
+            {
+                static Crt::Vector<Registration> registry;
+                return registry;
+            }
+        } // namespace
+
+        ThingTopicDispatcher::Node::Node() noexcept : SingleLevelChild(s_noChild), MultiLevelChild(s_noChild) {}
+
+        ThingTopicDispatcher::ThingTopicDispatcher(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            Crt::Allocator *allocator) noexcept
+            : m_connection(connection), m_allocator(allocator), m_routeCount(0), m_nextWaiterId(0)
+        {
+            m_nodes.emplace_back();
+        }
+
+        ThingTopicDispatcher::~ThingTopicDispatcher()
+        {
+            std::lock_guard<std::mutex> lock(s_registryLock());
+            Crt::Vector<Registration> &registry = s_registry();
+            for (size_t i = 0; i < registry.size(); ++i)
+            {
+                if (registry[i].Dispatcher == this)
+                {
+                    registry[i] = std::move(registry.back());
+                    registry.pop_back();
+                    break;
+                }
+            }
+        }
+
+        std::shared_ptr<ThingTopicDispatcher> ThingTopicDispatcher::Create(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            Crt::Allocator *allocator)
+        {
+            if (!connection)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(s_registryLock());
+            for (const Registration &registration : s_registry())
+            {
+                if (registration.Connection == connection.get() && !registration.Weak.expired())
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_STATE);
+                    return nullptr;
+                }
+            }
+
+            auto *toSeat =
+                static_cast<ThingTopicDispatcher *>(aws_mem_acquire(allocator, sizeof(ThingTopicDispatcher)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) ThingTopicDispatcher(connection, allocator);
+            std::shared_ptr<ThingTopicDispatcher> dispatcher(
+                toSeat, [allocator](ThingTopicDispatcher *toDelete) { Crt::Delete(toDelete, allocator); });
+            s_registry().push_back(Registration{connection.get(), toSeat, dispatcher});
+            return dispatcher;
+        }
+
+        std::shared_ptr<ThingTopicDispatcher> ThingTopicDispatcher::Find(const Crt::Mqtt::MqttConnection &connection)
+        {
+            std::lock_guard<std::mutex> lock(s_registryLock());
+            for (const Registration &registration : s_registry())
+            {
+                if (registration.Connection == &connection)
+                {
+                    return registration.Weak.lock();
+                }
+            }
+            return nullptr;
+        }
+
+        bool ThingTopicDispatcher::Covers(const char *topicFilter) noexcept
+        {
+            static const char s_prefix[] = "$aws/things/";
+            const size_t prefixLength = sizeof(s_prefix) - 1;
+            if (strncmp(topicFilter, s_prefix, prefixLength) != 0)
+            {
+                return false;
+            }
+
+            /* The thing must be named, and followed by a topic of its own. */
+            const char *thingName = topicFilter + prefixLength;
+            const char *cursor = thingName;
+            for (; *cursor != '\0' && *cursor != '/'; ++cursor)
+            {
+                if (*cursor == '+' || *cursor == '#')
+                {
+                    return false;
+                }
+            }
+            return cursor != thingName && *cursor == '/' && cursor[1] != '\0';
+        }
+
+        Crt::String ThingTopicDispatcher::ThingTopicOf(const Crt::String &thingName)
+        {
+            Crt::String topic("$aws/things/");
+            topic.append(thingName);
+            topic.append("/#");
+            return topic;
+        }
+
+        uint16_t ThingTopicDispatcher::Route(
+            const char *topicFilter,
+            Crt::Mqtt::QOS qos,
+            Crt::Mqtt::OnMessageReceivedHandler &&onMessage,
+            Crt::Mqtt::OnSubAckHandler &&onSubAck,
+            const std::shared_ptr<SessionSubscriptions> &session)
+        {
+            if (!Covers(topicFilter))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return 0;
+            }
+
+            auto handler = Crt::MakeShared<Crt::Mqtt::OnMessageReceivedHandler>(m_allocator, std::move(onMessage));
+            if (!handler)
+            {
+                return 0;
+            }
+
+            Crt::Vector<Crt::String> segments;
+            s_split(topicFilter, segments);
+            const Crt::String &thingName = segments[s_thingSegment];
+
+            bool subscribed = false;
+            bool subscribe = false;
+            Crt::Mqtt::QOS grantedQos = qos;
+            uint64_t waiterId = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto existing = m_things.find(thingName);
+                bool created = existing == m_things.end();
+                Thing &thing = created ? m_things[thingName] : existing->second;
+
+                size_t leaf = InsertLocked(segments);
+                if (!m_nodes[leaf].Handler)
+                {
+                    ++thing.RouteCount;
+                    ++m_routeCount;
+                }
+                m_nodes[leaf].Handler = std::move(handler);
+
+                subscribed = thing.Subscribed && qos <= thing.SubscribedQos;
+                grantedQos = thing.GrantedQos;
+                if (!subscribed)
+                {
+                    waiterId = ++m_nextWaiterId;
+                    thing.Waiters.push_back(Waiter{waiterId, Crt::String(topicFilter), qos, std::move(onSubAck)});
+                    /* A subscription already on its way at this QoS or above covers the route. */
+                    if (created || qos > thing.RequestedQos)
+                    {
+                        thing.RequestedQos = qos;
+                        ++thing.SubscribesInFlight;
+                        subscribe = true;
+                    }
+                }
+                if (created)
+                {
+                    thing.Session = session;
+                }
+            }
+
+            if (subscribed)
+            {
+                if (onSubAck)
+                {
+                    onSubAck(*m_connection, s_routedPacketId, Crt::String(topicFilter), grantedQos, AWS_ERROR_SUCCESS);
+                }
+                return s_routedPacketId;
+            }
+
+            if (subscribe && !SubscribeThing(thingName, qos))
+            {
+                /* The caller's route is failed by the return value; the others waiting on this subscription by
+                 * their SUBACK handlers. */
+                int errorCode = aws_last_error();
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    auto thing = m_things.find(thingName);
+                    if (thing != m_things.end())
+                    {
+                        Crt::Vector<Waiter> &waiters = thing->second.Waiters;
+                        for (auto waiter = waiters.begin(); waiter != waiters.end(); ++waiter)
+                        {
+                            if (waiter->Id == waiterId)
+                            {
+                                waiters.erase(waiter);
+                                break;
+                            }
+                        }
+                        if (RemoveLocked(segments))
+                        {
+                            --thing->second.RouteCount;
+                            --m_routeCount;
+                        }
+                    }
+                }
+                Subscribed(thingName, qos, AWS_MQTT_QOS_FAILURE, errorCode);
+                aws_raise_error(errorCode);
+                return 0;
+            }
+            return s_routedPacketId;
+        }
+
+        bool ThingTopicDispatcher::SubscribeThing(const Crt::String &thingName, Crt::Mqtt::QOS qos)
+        {
+            Crt::String thingTopic = ThingTopicOf(thingName);
+            AWS_IOTDEVICE_LOG_DEBUG(
+                ServiceLog::SubsystemOfTopic(thingTopic.c_str()),
+                "dispatch subscribe",
+                {{"topic", thingTopic.c_str()}, {"qos", qos}});
+
+            std::weak_ptr<ThingTopicDispatcher> weakSelf = shared_from_this();
+            auto onSubAck = [weakSelf, thingName, qos](
+                                Crt::Mqtt::MqttConnection &,
+                                uint16_t,
+                                const Crt::String &,
+                                Crt::Mqtt::QOS grantedQos,
+                                int errorCode) {
+                if (auto self = weakSelf.lock())
+                {
+                    self->Subscribed(thingName, qos, grantedQos, errorCode);
+                }
+            };
+
+            /* Directly on the connection: the thing's subscription belongs to no SubscriptionHandle or batch. */
+            return m_connection->Subscribe(thingTopic.c_str(), qos, MakeThingHandler(), std::move(onSubAck)) != 0;
+        }
+
+        void ThingTopicDispatcher::Subscribed(
+            const Crt::String &thingName,
+            Crt::Mqtt::QOS requestedQos,
+            Crt::Mqtt::QOS grantedQos,
+            int errorCode)
+        {
+            /* A refusal is acknowledged without an error, with the failure QoS in its place. */
+            if (!errorCode && grantedQos == AWS_MQTT_QOS_FAILURE)
+            {
+                errorCode = AWS_ERROR_INVALID_ARGUMENT;
+            }
+
+            Crt::Vector<Waiter> answered;
+            std::shared_ptr<SessionSubscriptions> session;
+            bool record = false;
+            bool unused = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto found = m_things.find(thingName);
+                if (found == m_things.end())
+                {
+                    return;
+                }
+                Thing &thing = found->second;
+                if (thing.SubscribesInFlight > 0)
+                {
+                    --thing.SubscribesInFlight;
+                }
+
+                /* The routes this subscription was made for; those needing more wait for a later one. */
+                Crt::Vector<Waiter> waiting;
+                for (Waiter &waiter : thing.Waiters)
+                {
+                    (waiter.Qos <= requestedQos ? answered : waiting).push_back(std::move(waiter));
+                }
+                thing.Waiters = std::move(waiting);
+
+                if (errorCode)
+                {
+                    for (const Waiter &waiter : answered)
+                    {
+                        Crt::Vector<Crt::String> segments;
+                        s_split(waiter.TopicFilter.c_str(), segments);
+                        if (RemoveLocked(segments))
+                        {
+                            --thing.RouteCount;
+                            --m_routeCount;
+                        }
+                    }
+                    if (thing.SubscribesInFlight == 0)
+                    {
+                        /* Whatever is acknowledged stays; a later route may ask for more again. */
+                        thing.RequestedQos = thing.SubscribedQos;
+                    }
+                }
+                else if (!thing.Subscribed || requestedQos >= thing.SubscribedQos)
+                {
+                    thing.Subscribed = true;
+                    thing.SubscribedQos = requestedQos;
+                    thing.GrantedQos = grantedQos;
+                    record = true;
+                }
+
+                if (thing.SubscribesInFlight == 0 && (thing.RouteCount == 0 || !thing.Subscribed))
+                {
+                    /* Every route was removed or failed before the SUBACK came. */
+                    for (Waiter &waiter : thing.Waiters)
+                    {
+                        answered.push_back(std::move(waiter));
+                    }
+                    unused = thing.Subscribed;
+                    session = thing.Session.lock();
+                    m_things.erase(found);
+                    RemoveThingLocked(thingName);
+                    record = false;
+                }
+                else if (record)
+                {
+                    session = thing.Session.lock();
+                }
+            }
+
+            Crt::String thingTopic = ThingTopicOf(thingName);
+            if (errorCode)
+            {
+                AWS_IOTDEVICE_LOG_WARN(
+                    ServiceLog::SubsystemOfTopic(thingTopic.c_str()),
+                    "dispatch subscribe failed",
+                    {{"topic", thingTopic}, {"qos", requestedQos}, {"error", aws_error_name(errorCode)}});
+            }
+            if (unused)
+            {
+                UnsubscribeThing(thingName, session, nullptr);
+            }
+            else if (record && session)
+            {
+                session->Record(thingTopic, requestedQos, MakeThingHandler());
+            }
+
+            for (Waiter &waiter : answered)
+            {
+                if (waiter.OnSubAck)
+                {
+                    waiter.OnSubAck(*m_connection, s_routedPacketId, waiter.TopicFilter, grantedQos, errorCode);
+                }
+            }
+        }
+
+        bool ThingTopicDispatcher::Unroute(
+            const char *topicFilter,
+            const Crt::Mqtt::OnOperationCompleteHandler &onUnsubAck)
+        {
+            if (!Covers(topicFilter))
+            {
+                return false;
+            }
+
+            Crt::Vector<Crt::String> segments;
+            s_split(topicFilter, segments);
+            const Crt::String &thingName = segments[s_thingSegment];
+
+            bool last = false;
+            std::shared_ptr<SessionSubscriptions> session;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto thing = m_things.find(thingName);
+                if (thing == m_things.end() || !RemoveLocked(segments))
+                {
+                    return false;
+                }
+
+                --thing->second.RouteCount;
+                --m_routeCount;
+                /* A thing still subscribing is unsubscribed on its SUBACK instead. */
+                if (thing->second.RouteCount == 0 && thing->second.Subscribed && thing->second.SubscribesInFlight == 0)
+                {
+                    last = true;
+                    session = thing->second.Session.lock();
+                    m_things.erase(thing);
+                }
+            }
+
+            if (last)
+            {
+                UnsubscribeThing(thingName, session, onUnsubAck);
+            }
+            else if (onUnsubAck)
+            {
+                onUnsubAck(*m_connection, 0, AWS_ERROR_SUCCESS);
+            }
+            return true;
+        }
+
+        void ThingTopicDispatcher::UnsubscribeThing(
+            const Crt::String &thingName,
+            const std::shared_ptr<SessionSubscriptions> &session,
+            const Crt::Mqtt::OnOperationCompleteHandler &onUnsubAck)
+        {
+            Crt::String thingTopic = ThingTopicOf(thingName);
+            if (session)
+            {
+                session->Forget(thingTopic);
+            }
+            m_connection->Unsubscribe(thingTopic.c_str(), Crt::Mqtt::OnOperationCompleteHandler(onUnsubAck));
+        }
+
+        Crt::Mqtt::OnMessageReceivedHandler ThingTopicDispatcher::MakeThingHandler()
+        {
+            std::weak_ptr<ThingTopicDispatcher> weakSelf = shared_from_this();
+            Crt::Mqtt::OnMessageReceivedHandler onMessage =
+                [weakSelf](
+                    Crt::Mqtt::MqttConnection &connection, const Crt::String &topic, const Crt::ByteBuf &payload) {
+                    if (auto self = weakSelf.lock())
+                    {
+                        self->Dispatch(connection, topic, payload);
+                    }
+                };
+
+            /* Recorded here rather than per route, so each message is recorded once. */
+            std::shared_ptr<TrafficRecorder> recorder = TrafficRecorder::Find(*m_connection);
+            if (recorder)
+            {
+                return recorder->Recording(std::move(onMessage));
+            }
+            return onMessage;
+        }
+
+        size_t ThingTopicDispatcher::AllocateNodeLocked()
+        {
+            if (!m_freeNodes.empty())
+            {
+                size_t node = m_freeNodes.back();
+                m_freeNodes.pop_back();
+                return node;
+            }
+
+            m_nodes.emplace_back();
+            return m_nodes.size() - 1;
+        }
+
+        size_t ThingTopicDispatcher::InsertLocked(const Crt::Vector<Crt::String> &segments)
+        {
+            size_t node = 0;
+            for (const Crt::String &segment : segments)
+            {
+                size_t child = s_noChild;
+                if (segment == "+" || segment == "#")
+                {
+                    child = segment == "+" ? m_nodes[node].SingleLevelChild : m_nodes[node].MultiLevelChild;
+                    if (child == s_noChild)
+                    {
+                        child = AllocateNodeLocked();
+                        (segment == "+" ? m_nodes[node].SingleLevelChild : m_nodes[node].MultiLevelChild) = child;
+                    }
+                }
+                else
+                {
+                    auto existing = m_nodes[node].Children.find(segment);
+                    if (existing != m_nodes[node].Children.end())
+                    {
+                        child = existing->second;
+                    }
+                    else
+                    {
+                        child = AllocateNodeLocked();
+                        m_nodes[node].Children.emplace(segment, child);
+                    }
+                }
+                node = child;
+            }
+            return node;
+        }
+
+        bool ThingTopicDispatcher::RemoveLocked(const Crt::Vector<Crt::String> &segments)
+        {
+            Crt::Vector<size_t> path;
+            path.push_back(0);
+            for (const Crt::String &segment : segments)
+            {
+                const Node &node = m_nodes[path.back()];
+                size_t child = s_noChild;
+                if (segment == "+")
+                {
+                    child = node.SingleLevelChild;
+                }
+                else if (segment == "#")
+                {
+                    child = node.MultiLevelChild;
+                }
+                else
+                {
+                    auto existing = node.Children.find(segment);
+                    child = existing != node.Children.end() ? existing->second : s_noChild;
+                }
+
+                if (child == s_noChild)
+                {
+                    return false;
+                }
+                path.push_back(child);
+            }
+
+            if (!m_nodes[path.back()].Handler)
+            {
+                return false;
+            }
+            m_nodes[path.back()].Handler = nullptr;
+
+            /* Prunes the nodes left with nothing below them, from the leaf up; the root is always kept. */
+            for (size_t depth = segments.size(); depth > 0; --depth)
+            {
+                Node &node = m_nodes[path[depth]];
+                if (node.Handler || !node.Children.empty() || node.SingleLevelChild != s_noChild ||
+                    node.MultiLevelChild != s_noChild)
+                {
+                    break;
+                }
+
+                Node &parent = m_nodes[path[depth - 1]];
+                const Crt::String &segment = segments[depth - 1];
+                if (segment == "+")
+                {
+                    parent.SingleLevelChild = s_noChild;
+                }
+                else if (segment == "#")
+                {
+                    parent.MultiLevelChild = s_noChild;
+                }
+                else
+                {
+                    parent.Children.erase(segment);
+                }
+                m_freeNodes.push_back(path[depth]);
+            }
+            return true;
+        }
+
+        void ThingTopicDispatcher::RemoveThingLocked(const Crt::String &thingName)
+        {
+            Crt::Vector<size_t> path;
+            path.push_back(0);
+            const Crt::String prefix[] = {"$aws", "things", thingName};
+            for (const Crt::String &segment : prefix)
+            {
+                auto child = m_nodes[path.back()].Children.find(segment);
+                if (child == m_nodes[path.back()].Children.end())
+                {
+                    return;
+                }
+                path.push_back(child->second);
+            }
+
+            Crt::Vector<size_t> subtree;
+            subtree.push_back(path.back());
+            while (!subtree.empty())
+            {
+                size_t index = subtree.back();
+                subtree.pop_back();
+
+                Node &node = m_nodes[index];
+                if (node.Handler)
+                {
+                    --m_routeCount;
+                }
+                for (const auto &child : node.Children)
+                {
+                    subtree.push_back(child.second);
+                }
+                if (node.SingleLevelChild != s_noChild)
+                {
+                    subtree.push_back(node.SingleLevelChild);
+                }
+                if (node.MultiLevelChild != s_noChild)
+                {
+                    subtree.push_back(node.MultiLevelChild);
+                }
+                node = Node();
+                m_freeNodes.push_back(index);
+            }
+
+            for (size_t depth = s_thingSegment + 1; depth > 0; --depth)
+            {
+                m_nodes[path[depth - 1]].Children.erase(prefix[depth - 1]);
+                const Node &parent = m_nodes[path[depth - 1]];
+                if (depth == 1 || parent.Handler || !parent.Children.empty() ||
+                    parent.SingleLevelChild != s_noChild || parent.MultiLevelChild != s_noChild)
+                {
+                    break;
+                }
+                m_freeNodes.push_back(path[depth - 1]);
+            }
+        }
+
+        void ThingTopicDispatcher::Match(
+            size_t node,
+            const Crt::Vector<Crt::ByteCursor> &segments,
+            size_t depth,
+            Crt::Vector<std::shared_ptr<Crt::Mqtt::OnMessageReceivedHandler>> &matches) const
+        {
+            const Node &current = m_nodes[node];
+            /* "a/#" matches "a" as well as everything below it. */
+            if (current.MultiLevelChild != s_noChild && m_nodes[current.MultiLevelChild].Handler)
+            {
+                matches.push_back(m_nodes[current.MultiLevelChild].Handler);
+            }
+
+            if (depth == segments.size())
+            {
+                if (current.Handler)
+                {
+                    matches.push_back(current.Handler);
+                }
+                return;
+            }
+
+            const Crt::ByteCursor &segment = segments[depth];
+            auto exact = current.Children.find(Crt::String(reinterpret_cast<const char *>(segment.ptr), segment.len));
+            if (exact != current.Children.end())
+            {
+                Match(exact->second, segments, depth + 1, matches);
+            }
+
+            if (current.SingleLevelChild != s_noChild)
+            {
+                Match(current.SingleLevelChild, segments, depth + 1, matches);
+            }
+        }
+
+        void ThingTopicDispatcher::Dispatch(
+            Crt::Mqtt::MqttConnection &connection,
+            const Crt::String &topic,
+            const Crt::ByteBuf &payload) const
+        {
+            Crt::Vector<Crt::ByteCursor> segments;
+            const char *segmentStart = topic.c_str();
+            const char *topicEnd = segmentStart + topic.length();
+            for (const char *cursor = segmentStart;; ++cursor)
+            {
+                if (cursor == topicEnd || *cursor == '/')
+                {
+                    segments.push_back(Crt::ByteCursorFromArray(
+                        reinterpret_cast<const uint8_t *>(segmentStart), static_cast<size_t>(cursor - segmentStart)));
+                    if (cursor == topicEnd)
+                    {
+                        break;
+                    }
+                    segmentStart = cursor + 1;
+                }
+            }
+
+            Crt::Vector<std::shared_ptr<Crt::Mqtt::OnMessageReceivedHandler>> matches;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                Match(0, segments, 0, matches);
+            }
+
+            for (const auto &handler : matches)
+            {
+                (*handler)(connection, topic, payload);
+            }
+        }
+
+        size_t ThingTopicDispatcher::GetRouteCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_routeCount;
+        }
+
+        size_t ThingTopicDispatcher::GetThingCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_things.size();
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
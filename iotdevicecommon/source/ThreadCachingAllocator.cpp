@@ -0,0 +1,222 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/ThreadCachingAllocator.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            /* Keeps the returned memory as aligned as the wrapped allocator's. */
+            static const size_t s_headerSize = 16;
+
+            /* Size classes 16, 32, ... 512 bytes; anything larger goes straight to the wrapped allocator. */
+            static const uint32_t s_sizeClassCount = 6;
+            static const uint32_t s_uncached = s_sizeClassCount;
+
+            std::atomic<uint64_t> s_nextId(1);
+
+            struct BlockHeader
+            {
+                uint64_t OwnerId;
+                uint32_t SizeClass;
+            };
+
+            uint32_t s_sizeClassFor(size_t size)
+            {
+                size_t classSize = 16;
+                for (uint32_t sizeClass = 0; sizeClass < s_sizeClassCount; ++sizeClass, classSize <<= 1)
+                {
+                    if (size <= classSize)
+                    {
+                        return sizeClass;
+                    }
+                }
+                return s_uncached;
+            }
+
+            size_t s_classSize(uint32_t sizeClass) { return size_t(16) << sizeClass; }
+
+            struct ThreadCache;
+
+            /* Every live thread cache, so a destroyed allocator can reclaim its blocks from all of them. */
+            std::mutex s_registryLock;
+            ThreadCache *s_registry = nullptr;
+
+            /*
+             * One per thread, serving the first ThreadCachingAllocator to free a block on that thread until that
+             * allocator is destroyed. Lock is taken by the owning thread on each use, and by the allocator's
+             * destructor on another thread.
+             */
+            struct ThreadCache
+            {
+                ThreadCache() : OwnerId(0), Wrapped(nullptr), FreeLists(), Counts(), Previous(nullptr), Next(nullptr)
+                {
+                    std::lock_guard<std::mutex> registryLock(s_registryLock);
+                    Next = s_registry;
+                    if (Next)
+                    {
+                        Next->Previous = this;
+                    }
+                    s_registry = this;
+                }
+
+                ~ThreadCache()
+                {
+                    {
+                        std::lock_guard<std::mutex> registryLock(s_registryLock);
+                        if (Previous)
+                        {
+                            Previous->Next = Next;
+                        }
+                        else
+                        {
+                            s_registry = Next;
+                        }
+                        if (Next)
+                        {
+                            Next->Previous = Previous;
+                        }
+                    }
+
+                    std::lock_guard<std::mutex> lock(Lock);
+                    Flush();
+                }
+
+                /* Requires Lock. */
+                void Flush()
+                {
+                    for (uint32_t sizeClass = 0; sizeClass < s_sizeClassCount; ++sizeClass)
+                    {
+                        uint8_t *block = FreeLists[sizeClass];
+                        while (block)
+                        {
+                            uint8_t *next = *reinterpret_cast<uint8_t **>(block + s_headerSize);
+                            aws_mem_release(Wrapped, block);
+                            block = next;
+                        }
+                        FreeLists[sizeClass] = nullptr;
+                        Counts[sizeClass] = 0;
+                    }
+                }
+
+                std::mutex Lock;
+                uint64_t OwnerId;
+                Crt::Allocator *Wrapped;
+                uint8_t *FreeLists[s_sizeClassCount];
+                size_t Counts[s_sizeClassCount];
+                /* Links in s_registry, guarded by s_registryLock. */
+                ThreadCache *Previous;
+                ThreadCache *Next;
+            };
+
+            thread_local ThreadCache s_threadCache;
+        } // namespace
+
+        static_assert(sizeof(BlockHeader) <= s_headerSize, "block header must fit in the header space");
+
+        ThreadCachingAllocator::ThreadCachingAllocator(Crt::Allocator *wrapped, size_t maxCachedPerSizeClass) noexcept
+            : m_allocator(), m_wrapped(wrapped), m_maxCachedPerSizeClass(maxCachedPerSizeClass),
+              m_id(s_nextId.fetch_add(1))
+        {
+            m_allocator.mem_acquire = s_acquire;
+            m_allocator.mem_release = s_release;
+            /* Left null, aws_mem_realloc and aws_mem_calloc fall back to acquire and release. */
+            m_allocator.mem_realloc = nullptr;
+            m_allocator.mem_calloc = nullptr;
+            m_allocator.impl = this;
+        }
+
+        ThreadCachingAllocator::~ThreadCachingAllocator()
+        {
+            std::lock_guard<std::mutex> registryLock(s_registryLock);
+            for (ThreadCache *cache = s_registry; cache; cache = cache->Next)
+            {
+                std::lock_guard<std::mutex> lock(cache->Lock);
+                if (cache->OwnerId == m_id)
+                {
+                    cache->Flush();
+                    cache->OwnerId = 0;
+                    cache->Wrapped = nullptr;
+                }
+            }
+        }
+
+        void ThreadCachingAllocator::TrimThreadCache() noexcept
+        {
+            ThreadCache &cache = s_threadCache;
+            std::lock_guard<std::mutex> lock(cache.Lock);
+            if (cache.OwnerId == m_id)
+            {
+                cache.Flush();
+            }
+        }
+
+        void *ThreadCachingAllocator::s_acquire(Crt::Allocator *allocator, size_t size)
+        {
+            auto *caching = static_cast<ThreadCachingAllocator *>(allocator->impl);
+            uint32_t sizeClass = s_sizeClassFor(size);
+
+            if (sizeClass != s_uncached)
+            {
+                ThreadCache &cache = s_threadCache;
+                std::lock_guard<std::mutex> lock(cache.Lock);
+                if (cache.OwnerId == caching->m_id && cache.FreeLists[sizeClass])
+                {
+                    uint8_t *block = cache.FreeLists[sizeClass];
+                    cache.FreeLists[sizeClass] = *reinterpret_cast<uint8_t **>(block + s_headerSize);
+                    --cache.Counts[sizeClass];
+                    return block + s_headerSize;
+                }
+            }
+
+            size_t blockSize = (sizeClass == s_uncached ? size : s_classSize(sizeClass)) + s_headerSize;
+            auto *block = static_cast<uint8_t *>(aws_mem_acquire(caching->m_wrapped, blockSize));
+            if (!block)
+            {
+                return nullptr;
+            }
+
+            auto *header = reinterpret_cast<BlockHeader *>(block);
+            header->OwnerId = caching->m_id;
+            header->SizeClass = sizeClass;
+            return block + s_headerSize;
+        }
+
+        void ThreadCachingAllocator::s_release(Crt::Allocator *allocator, void *ptr)
+        {
+            auto *caching = static_cast<ThreadCachingAllocator *>(allocator->impl);
+            uint8_t *block = static_cast<uint8_t *>(ptr) - s_headerSize;
+            uint32_t sizeClass = reinterpret_cast<BlockHeader *>(block)->SizeClass;
+
+            if (sizeClass != s_uncached)
+            {
+                ThreadCache &cache = s_threadCache;
+                std::lock_guard<std::mutex> lock(cache.Lock);
+                if (cache.OwnerId == 0)
+                {
+                    cache.OwnerId = caching->m_id;
+                    cache.Wrapped = caching->m_wrapped;
+                }
+
+                if (cache.OwnerId == caching->m_id && cache.Counts[sizeClass] < caching->m_maxCachedPerSizeClass)
+                {
+                    *reinterpret_cast<uint8_t **>(block + s_headerSize) = cache.FreeLists[sizeClass];
+                    cache.FreeLists[sizeClass] = block;
+                    ++cache.Counts[sizeClass];
+                    return;
+                }
+            }
+
+            aws_mem_release(caching->m_wrapped, block);
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
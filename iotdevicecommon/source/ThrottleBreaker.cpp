@@ -0,0 +1,125 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/ThrottleBreaker.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/device_random.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        const size_t ThrottleBreaker::OperationCount;
+
+        namespace
+        {
+            const uint64_t s_nsPerMs = 1000000;
+
+            uint64_t s_nowNs() noexcept
+            {
+                uint64_t nowNs = 0;
+                aws_high_res_clock_get_ticks(&nowNs);
+                return nowNs;
+            }
+        } // namespace
+
+        ThrottleBreakerConfig::ThrottleBreakerConfig() noexcept
+            : InitialBackoffMs(1000), MaxBackoffMs(30000), ResetAfterMs(60000)
+        {
+        }
+
+        ThrottleBreaker::ThrottleBreaker(const ThrottleBreakerConfig &config) noexcept : m_config(config)
+        {
+            for (OperationState &state : m_operations)
+            {
+                state = OperationState();
+            }
+        }
+
+        std::shared_ptr<ThrottleBreaker> ThrottleBreaker::Create(
+            const ThrottleBreakerConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (config.InitialBackoffMs == 0 || config.MaxBackoffMs < config.InitialBackoffMs)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<ThrottleBreaker *>(aws_mem_acquire(allocator, sizeof(ThrottleBreaker)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ThrottleBreaker(config);
+                return std::shared_ptr<ThrottleBreaker>(
+                    toSeat, [allocator](ThrottleBreaker *breaker) { Crt::Delete(breaker, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool ThrottleBreaker::Allow(ThrottledOperation operation)
+        {
+            uint64_t nowNs = s_nowNs();
+            std::lock_guard<std::mutex> lock(m_lock);
+            OperationState &state = m_operations[static_cast<size_t>(operation)];
+            if (nowNs < state.OpenUntilNs)
+            {
+                ++state.Refused;
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return false;
+            }
+            return true;
+        }
+
+        void ThrottleBreaker::RecordThrottled(ThrottledOperation operation)
+        {
+            uint64_t jitter = 0;
+            if (aws_device_random_u64(&jitter) != AWS_OP_SUCCESS)
+            {
+                jitter = 0;
+            }
+
+            uint64_t nowNs = s_nowNs();
+            std::lock_guard<std::mutex> lock(m_lock);
+            OperationState &state = m_operations[static_cast<size_t>(operation)];
+            ++state.Throttled;
+            if (state.Streak && nowNs - state.LastThrottledNs > m_config.ResetAfterMs * s_nsPerMs)
+            {
+                state.Streak = 0;
+            }
+            state.LastThrottledNs = nowNs;
+
+            /* Rejections of publishes already in flight keep arriving after the breaker opens; only the first
+             * of them past the current backoff doubles it. */
+            if (nowNs < state.OpenUntilNs)
+            {
+                return;
+            }
+
+            uint64_t backoffMs = m_config.InitialBackoffMs;
+            for (uint32_t i = 0; i < state.Streak && backoffMs < m_config.MaxBackoffMs; ++i)
+            {
+                backoffMs *= 2;
+            }
+            backoffMs = backoffMs < m_config.MaxBackoffMs ? backoffMs : m_config.MaxBackoffMs;
+            ++state.Streak;
+
+            /* Equal jitter: at least half the backoff, so a throttled operation always pauses. */
+            uint64_t backoffNs = backoffMs * s_nsPerMs;
+            state.OpenUntilNs = nowNs + backoffNs / 2 + jitter % (backoffNs / 2 + 1);
+        }
+
+        ThrottleBreakerCounters ThrottleBreaker::GetCounters(ThrottledOperation operation) const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            const OperationState &state = m_operations[static_cast<size_t>(operation)];
+            ThrottleBreakerCounters counters;
+            counters.Throttled = state.Throttled;
+            counters.Refused = state.Refused;
+            counters.OpenUntilNs = state.OpenUntilNs;
+            return counters;
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
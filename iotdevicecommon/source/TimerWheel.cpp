@@ -0,0 +1,234 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/TimerWheel.h>
+
+#include <aws/common/clock.h>
+#include <aws/io/event_loop.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        struct TimerWheel::TickTask
+        {
+            aws_task Task;
+            std::weak_ptr<TimerWheel> Owner;
+            Crt::Allocator *Allocator;
+        };
+
+        TimerWheel::TimerWheel(
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            uint32_t tickMs,
+            Crt::Allocator *allocator) noexcept
+            : m_eventLoop(aws_event_loop_group_get_next_loop(eventLoopGroup.GetUnderlyingHandle())),
+              m_tickMs(tickMs > 0 ? tickMs : 1),
+              m_tickNs(aws_timestamp_convert(m_tickMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL)),
+              m_allocator(allocator), m_timers(allocator), m_nextTimerId(1), m_originNs(NowNs()),
+              m_currentTick(0), m_tickScheduled(false)
+        {
+        }
+
+        std::shared_ptr<TimerWheel> TimerWheel::Create(
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            uint32_t tickMs,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<TimerWheel *>(aws_mem_acquire(allocator, sizeof(TimerWheel)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) TimerWheel(eventLoopGroup, tickMs, allocator);
+                return std::shared_ptr<TimerWheel>(
+                    toSeat, [allocator](TimerWheel *wheel) { Crt::Delete(wheel, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        uint64_t TimerWheel::NowNs() const noexcept
+        {
+            uint64_t nowNs = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &nowNs);
+            return nowNs;
+        }
+
+        uint64_t TimerWheel::Schedule(uint64_t delayMs, OnExpired &&onExpired)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            uint64_t nowNs = NowNs();
+            if (m_timers.IsEmpty() && !m_tickScheduled)
+            {
+                /* The wheel stood still while idle; skip the ticks it missed rather than advancing through each. */
+                m_currentTick = (nowNs - m_originNs) / m_tickNs;
+            }
+
+            uint64_t delayNs = aws_timestamp_convert(delayMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+            uint64_t expiryTick = (nowNs - m_originNs + delayNs + m_tickNs - 1) / m_tickNs;
+            if (expiryTick <= m_currentTick)
+            {
+                expiryTick = m_currentTick + 1;
+            }
+
+            if (!m_tickScheduled)
+            {
+                auto *tickTask = Crt::New<TickTask>(m_allocator);
+                if (!tickTask)
+                {
+                    return 0;
+                }
+                tickTask->Owner = shared_from_this();
+                tickTask->Allocator = m_allocator;
+                aws_task_init(&tickTask->Task, s_onTickTask, tickTask, "TimerWheelTick");
+                ScheduleTick(tickTask);
+            }
+
+            /* Staged in a list of its own, then spliced into its slot, so filing never copies the callback. */
+            uint64_t timerId = m_nextTimerId++;
+            Slot staged;
+            staged.push_back(Timer{timerId, expiryTick, std::move(onExpired)});
+            File(staged, staged.begin());
+            return timerId;
+        }
+
+        bool TimerWheel::Cancel(uint64_t timerId)
+        {
+            OnExpired callback;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                Location *location = m_timers.Find(timerId);
+                if (!location)
+                {
+                    return false;
+                }
+
+                /* Destroyed unlocked, in case it holds the last reference to something that cancels a timer. */
+                Slot &slot = m_slots[location->Level][location->Index];
+                callback = std::move(location->Position->Callback);
+                slot.erase(location->Position);
+                m_timers.Erase(timerId);
+            }
+            return true;
+        }
+
+        size_t TimerWheel::GetTimerCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_timers.GetSize();
+        }
+
+        void TimerWheel::File(Slot &from, Slot::iterator position)
+        {
+            uint64_t expiryTick = position->ExpiryTick;
+            uint64_t delta = expiryTick > m_currentTick ? expiryTick - m_currentTick : 0;
+
+            size_t level = 0;
+            while (level + 1 < s_levelCount && delta >= (uint64_t(1) << (s_slotBits * (level + 1))))
+            {
+                ++level;
+            }
+
+            /* Past the top level's reach, it waits in the farthest slot and is refiled from there. */
+            uint64_t horizon = uint64_t(1) << (s_slotBits * s_levelCount);
+            uint64_t filedTick = delta < horizon ? expiryTick : m_currentTick + horizon - 1;
+            size_t index = static_cast<size_t>((filedTick >> (s_slotBits * level)) & (s_slotCount - 1));
+
+            Slot &to = m_slots[level][index];
+            to.splice(to.end(), from, position);
+
+            Location &location = m_timers.GetOrAdd(position->Id);
+            location.Level = level;
+            location.Index = index;
+            location.Position = position;
+        }
+
+        void TimerWheel::Advance(Crt::Vector<OnExpired> &expired)
+        {
+            ++m_currentTick;
+
+            /* Each level's slot is emptied into the finer levels as the levels below it wrap around. */
+            for (size_t level = 1; level < s_levelCount; ++level)
+            {
+                if ((m_currentTick & ((uint64_t(1) << (s_slotBits * level)) - 1)) != 0)
+                {
+                    break;
+                }
+
+                size_t index = static_cast<size_t>((m_currentTick >> (s_slotBits * level)) & (s_slotCount - 1));
+                Slot cascading;
+                cascading.splice(cascading.end(), m_slots[level][index]);
+                while (!cascading.empty())
+                {
+                    File(cascading, cascading.begin());
+                }
+            }
+
+            Slot &due = m_slots[0][m_currentTick & (s_slotCount - 1)];
+            for (Timer &timer : due)
+            {
+                m_timers.Erase(timer.Id);
+                expired.push_back(std::move(timer.Callback));
+            }
+            due.clear();
+        }
+
+        void TimerWheel::ScheduleTick(TickTask *tickTask)
+        {
+            m_tickScheduled = true;
+            uint64_t nextTickNs = m_originNs + (m_currentTick + 1) * m_tickNs;
+            aws_event_loop_schedule_task_future(m_eventLoop, &tickTask->Task, nextTickNs);
+        }
+
+        bool TimerWheel::Tick(TickTask *tickTask)
+        {
+            Crt::Vector<OnExpired> expired;
+            bool rescheduled = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                uint64_t nowNs = NowNs();
+                while (m_originNs + (m_currentTick + 1) * m_tickNs <= nowNs)
+                {
+                    Advance(expired);
+                }
+
+                if (m_timers.IsEmpty())
+                {
+                    m_tickScheduled = false;
+                }
+                else
+                {
+                    ScheduleTick(tickTask);
+                    rescheduled = true;
+                }
+            }
+
+            for (OnExpired &onExpired : expired)
+            {
+                onExpired();
+            }
+            return rescheduled;
+        }
+
+        void TimerWheel::s_onTickTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *tickTask = static_cast<TickTask *>(arg);
+            auto wheel = tickTask->Owner.lock();
+            if (wheel && status == AWS_TASK_STATUS_RUN_READY)
+            {
+                if (wheel->Tick(tickTask))
+                {
+                    return;
+                }
+            }
+            else if (wheel)
+            {
+                std::lock_guard<std::mutex> lock(wheel->m_lock);
+                wheel->m_tickScheduled = false;
+            }
+
+            Crt::Delete(tickTask, tickTask->Allocator);
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,64 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/TrackingAllocator.h>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            /* Keeps the returned memory as aligned as the wrapped allocator's. */
+            static const size_t s_headerSize = 16;
+        } // namespace
+
+        TrackingAllocator::TrackingAllocator(Crt::Allocator *wrapped) noexcept
+            : m_allocator(), m_wrapped(wrapped), m_currentBytes(0), m_peakBytes(0), m_liveAllocations(0),
+              m_totalAllocations(0)
+        {
+            m_allocator.mem_acquire = s_acquire;
+            m_allocator.mem_release = s_release;
+            /* Left null, aws_mem_realloc and aws_mem_calloc fall back to acquire and release. */
+            m_allocator.mem_realloc = nullptr;
+            m_allocator.mem_calloc = nullptr;
+            m_allocator.impl = this;
+        }
+
+        void *TrackingAllocator::s_acquire(Crt::Allocator *allocator, size_t size)
+        {
+            auto *tracker = static_cast<TrackingAllocator *>(allocator->impl);
+            auto *block = static_cast<uint8_t *>(aws_mem_acquire(tracker->m_wrapped, size + s_headerSize));
+            if (!block)
+            {
+                return nullptr;
+            }
+
+            *reinterpret_cast<size_t *>(block) = size;
+
+            size_t current = tracker->m_currentBytes.fetch_add(size) + size;
+            size_t peak = tracker->m_peakBytes.load();
+            while (current > peak && !tracker->m_peakBytes.compare_exchange_weak(peak, current))
+            {
+            }
+            ++tracker->m_liveAllocations;
+            ++tracker->m_totalAllocations;
+
+            return block + s_headerSize;
+        }
+
+        void TrackingAllocator::s_release(Crt::Allocator *allocator, void *ptr)
+        {
+            auto *tracker = static_cast<TrackingAllocator *>(allocator->impl);
+            uint8_t *block = static_cast<uint8_t *>(ptr) - s_headerSize;
+
+            tracker->m_currentBytes -= *reinterpret_cast<size_t *>(block);
+            --tracker->m_liveAllocations;
+
+            aws_mem_release(tracker->m_wrapped, block);
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
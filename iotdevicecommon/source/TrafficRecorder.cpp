@@ -0,0 +1,417 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/TrafficRecorder.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/file.h>
+
+#include <atomic>
+#include <cstring>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        namespace
+        {
+            const uint8_t s_magic[8] = {'I', 'O', 'T', 'T', 'R', 'A', 'C', 'E'};
+            const uint32_t s_version = 1;
+            const size_t s_fileHeaderSize = 16;
+            /* timestamp, topic length, payload length, direction, padding */
+            const size_t s_recordHeaderSize = 24;
+            const size_t s_recordAlignment = 8;
+            /* The buffer is written out once it holds this much. */
+            const size_t s_flushBytes = 64 * 1024;
+
+            uint64_t s_nowNs() noexcept
+            {
+                uint64_t nowNs = 0;
+                aws_high_res_clock_get_ticks(&nowNs);
+                return nowNs;
+            }
+
+            size_t s_padded(size_t bytes) noexcept
+            {
+                return (bytes + s_recordAlignment - 1) & ~(s_recordAlignment - 1);
+            }
+
+            void s_putInteger(uint8_t *out, uint64_t value, size_t bytes) noexcept
+            {
+                for (size_t i = 0; i < bytes; ++i)
+                {
+                    out[i] = static_cast<uint8_t>((value >> (8 * i)) & 0xff);
+                }
+            }
+
+            uint64_t s_getInteger(const uint8_t *in, size_t bytes) noexcept
+            {
+                uint64_t value = 0;
+                for (size_t i = 0; i < bytes; ++i)
+                {
+                    value |= static_cast<uint64_t>(in[i]) << (8 * i);
+                }
+                return value;
+            }
+
+            struct Registration
+            {
+                const Crt::Mqtt::MqttConnection *Connection;
+                const TrafficRecorder *Recorder;
+                std::weak_ptr<TrafficRecorder> Weak;
+            };
+
+            /* The recorder of each connection, looked up on every subscribe and publish while any exists. */
+            std::mutex &s_registryLock()
+            {
+                static std::mutex lock;
+                return lock;
+            }
+
+            Crt::Vector<Registration> &s_registry()
+            {
+                static Crt::Vector<Registration> registry;
+                return registry;
+            }
+
+            std::atomic<size_t> s_recorderCount(0);
+        } // namespace
+
+        TrafficRecorder::TrafficRecorder(FILE *file, uint64_t maxBytes, Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_maxBytes(maxBytes), m_startNs(s_nowNs()), m_file(file), m_bytes(0),
+              m_recordCount(0), m_droppedCount(0)
+        {
+            m_buffer.reserve(s_flushBytes);
+            m_buffer.resize(s_fileHeaderSize);
+            memcpy(m_buffer.data(), s_magic, sizeof(s_magic));
+            s_putInteger(m_buffer.data() + 8, s_version, 4);
+            s_putInteger(m_buffer.data() + 12, 0, 4);
+            m_bytes = s_fileHeaderSize;
+        }
+
+        TrafficRecorder::~TrafficRecorder()
+        {
+            {
+                std::lock_guard<std::mutex> lock(s_registryLock());
+                Crt::Vector<Registration> &registry = s_registry();
+                for (size_t i = 0; i < registry.size(); ++i)
+                {
+                    if (registry[i].Recorder == this)
+                    {
+                        registry[i] = std::move(registry.back());
+                        registry.pop_back();
+                        --s_recorderCount;
+                        break;
+                    }
+                }
+            }
+
+            FlushLocked();
+            fclose(m_file);
+        }
+
+        std::shared_ptr<TrafficRecorder> TrafficRecorder::Create(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const char *path,
+            uint64_t maxBytes,
+            Crt::Allocator *allocator)
+        {
+            if (!connection || !path)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(s_registryLock());
+            for (const Registration &registration : s_registry())
+            {
+                if (registration.Connection == connection.get() && !registration.Weak.expired())
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_STATE);
+                    return nullptr;
+                }
+            }
+
+            FILE *file = aws_fopen(path, "wb");
+            if (!file)
+            {
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<TrafficRecorder *>(aws_mem_acquire(allocator, sizeof(TrafficRecorder)));
+            if (!toSeat)
+            {
+                fclose(file);
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) TrafficRecorder(file, maxBytes, allocator);
+            std::shared_ptr<TrafficRecorder> recorder(
+                toSeat, [allocator](TrafficRecorder *toDelete) { Crt::Delete(toDelete, allocator); });
+            s_registry().push_back(Registration{connection.get(), toSeat, recorder});
+            ++s_recorderCount;
+            return recorder;
+        }
+
+        std::shared_ptr<TrafficRecorder> TrafficRecorder::Find(const Crt::Mqtt::MqttConnection &connection)
+        {
+            /* Recording is rare, so traffic without it pays one relaxed load rather than the registry lock. */
+            if (s_recorderCount.load(std::memory_order_relaxed) == 0)
+            {
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(s_registryLock());
+            for (const Registration &registration : s_registry())
+            {
+                if (registration.Connection == &connection)
+                {
+                    return registration.Weak.lock();
+                }
+            }
+            return nullptr;
+        }
+
+        void TrafficRecorder::Record(TrafficDirection direction, Crt::ByteCursor topic, Crt::ByteCursor payload)
+        {
+            size_t recordBytes = s_padded(s_recordHeaderSize + topic.len + payload.len);
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_maxBytes != 0 && m_bytes + recordBytes > m_maxBytes)
+            {
+                ++m_droppedCount;
+                return;
+            }
+
+            /* Stamped under the lock, so the records are in time order. */
+            uint64_t timestampNs = s_nowNs() - m_startNs;
+            size_t start = m_buffer.size();
+            m_buffer.resize(start + recordBytes);
+            uint8_t *record = m_buffer.data() + start;
+            memset(record, 0, recordBytes);
+            s_putInteger(record, timestampNs, 8);
+            s_putInteger(record + 8, topic.len, 4);
+            s_putInteger(record + 12, payload.len, 4);
+            record[16] = static_cast<uint8_t>(direction);
+            if (topic.len)
+            {
+                memcpy(record + s_recordHeaderSize, topic.ptr, topic.len);
+            }
+            if (payload.len)
+            {
+                memcpy(record + s_recordHeaderSize + topic.len, payload.ptr, payload.len);
+            }
+
+            m_bytes += recordBytes;
+            ++m_recordCount;
+            if (m_buffer.size() >= s_flushBytes)
+            {
+                FlushLocked();
+            }
+        }
+
+        bool TrafficRecorder::Flush()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return FlushLocked();
+        }
+
+        bool TrafficRecorder::FlushLocked()
+        {
+            if (m_buffer.empty())
+            {
+                return true;
+            }
+
+            bool written = fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) == m_buffer.size();
+            m_buffer.clear();
+            if (!written || fflush(m_file) != 0)
+            {
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+            return true;
+        }
+
+        Crt::Mqtt::OnMessageReceivedHandler TrafficRecorder::Recording(Crt::Mqtt::OnMessageReceivedHandler &&onMessage)
+        {
+            std::weak_ptr<TrafficRecorder> weakSelf = shared_from_this();
+            auto sharedMessage = std::make_shared<Crt::Mqtt::OnMessageReceivedHandler>(std::move(onMessage));
+            return [weakSelf, sharedMessage](
+                       Crt::Mqtt::MqttConnection &connection, const Crt::String &topic, const Crt::ByteBuf &payload) {
+                if (auto self = weakSelf.lock())
+                {
+                    self->Record(
+                        TrafficDirection::Inbound,
+                        Crt::ByteCursorFromCString(topic.c_str()),
+                        Crt::ByteCursorFromByteBuf(payload));
+                }
+                (*sharedMessage)(connection, topic, payload);
+            };
+        }
+
+        uint64_t TrafficRecorder::GetRecordCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_recordCount;
+        }
+
+        uint64_t TrafficRecorder::GetDroppedCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_droppedCount;
+        }
+
+        TrafficTrace::TrafficTrace(Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_data(nullptr), m_size(0), m_mapped(false), m_end(0), m_recordCount(0)
+        {
+        }
+
+        TrafficTrace::~TrafficTrace()
+        {
+            if (!m_data)
+            {
+                return;
+            }
+#ifndef _WIN32
+            if (m_mapped)
+            {
+                munmap(const_cast<uint8_t *>(m_data), m_size);
+                return;
+            }
+#endif
+            aws_mem_release(m_allocator, const_cast<uint8_t *>(m_data));
+        }
+
+        std::shared_ptr<TrafficTrace> TrafficTrace::Open(const char *path, Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<TrafficTrace *>(aws_mem_acquire(allocator, sizeof(TrafficTrace)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) TrafficTrace(allocator);
+            std::shared_ptr<TrafficTrace> trace(
+                toSeat, [allocator](TrafficTrace *toDelete) { Crt::Delete(toDelete, allocator); });
+            if (!path || !trace->Load(path))
+            {
+                return nullptr;
+            }
+            return trace;
+        }
+
+        bool TrafficTrace::Load(const char *path)
+        {
+#ifndef _WIN32
+            int fd = open(path, O_RDONLY);
+            if (fd < 0)
+            {
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+
+            struct stat status;
+            void *region = MAP_FAILED;
+            if (fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) >= s_fileHeaderSize)
+            {
+                m_size = static_cast<size_t>(status.st_size);
+                region = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            /* The mapping keeps the file open. */
+            close(fd);
+            if (region == MAP_FAILED)
+            {
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+            m_data = static_cast<const uint8_t *>(region);
+            m_mapped = true;
+#else
+            FILE *file = aws_fopen(path, "rb");
+            if (!file)
+            {
+                return false;
+            }
+
+            int64_t length = 0;
+            bool sized = aws_file_get_length(file, &length) == AWS_OP_SUCCESS &&
+                         static_cast<size_t>(length) >= s_fileHeaderSize;
+            uint8_t *data = nullptr;
+            if (sized)
+            {
+                m_size = static_cast<size_t>(length);
+                data = static_cast<uint8_t *>(aws_mem_acquire(m_allocator, m_size));
+            }
+            bool read = data && fread(data, 1, m_size, file) == m_size;
+            fclose(file);
+            if (!read)
+            {
+                if (data)
+                {
+                    aws_mem_release(m_allocator, data);
+                }
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+            m_data = data;
+#endif
+
+            if (memcmp(m_data, s_magic, sizeof(s_magic)) != 0 || s_getInteger(m_data + 8, 4) != s_version)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            /* Checks every record's bounds once, so Next need not. */
+            size_t offset = s_fileHeaderSize;
+            while (m_size - offset >= s_recordHeaderSize)
+            {
+                uint64_t bodyBytes = s_getInteger(m_data + offset + 8, 4) + s_getInteger(m_data + offset + 12, 4);
+                if (bodyBytes > m_size - offset - s_recordHeaderSize)
+                {
+                    break;
+                }
+                offset += s_recordHeaderSize + static_cast<size_t>(bodyBytes);
+                /* The padding of the last record may be cut short too. */
+                offset = s_padded(offset) < m_size ? s_padded(offset) : m_size;
+                ++m_recordCount;
+            }
+            m_end = offset;
+            return true;
+        }
+
+        bool TrafficTrace::Next(size_t &offset, TrafficRecord &record) const noexcept
+        {
+            if (offset < s_fileHeaderSize)
+            {
+                offset = s_fileHeaderSize;
+            }
+            if (offset >= m_end)
+            {
+                return false;
+            }
+
+            const uint8_t *header = m_data + offset;
+            size_t topicBytes = static_cast<size_t>(s_getInteger(header + 8, 4));
+            size_t payloadBytes = static_cast<size_t>(s_getInteger(header + 12, 4));
+            record.TimestampNs = s_getInteger(header, 8);
+            record.Direction = static_cast<TrafficDirection>(header[16]);
+            record.Topic = Crt::ByteCursorFromArray(header + s_recordHeaderSize, topicBytes);
+            record.Payload = Crt::ByteCursorFromArray(header + s_recordHeaderSize + topicBytes, payloadBytes);
+
+            size_t next = offset + s_recordHeaderSize + topicBytes + payloadBytes;
+            offset = s_padded(next) < m_end ? s_padded(next) : m_end;
+            return true;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
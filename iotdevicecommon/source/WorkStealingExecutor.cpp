@@ -0,0 +1,242 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/WorkStealingExecutor.h>
+
+#include <system_error>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+
+        namespace
+        {
+            size_t s_homeWorker(const Crt::String &orderingKey, size_t workerCount) noexcept
+            {
+                uint64_t hash = 14695981039346656037ULL;
+                for (char c : orderingKey)
+                {
+                    hash ^= static_cast<uint8_t>(c);
+                    hash *= 1099511628211ULL;
+                }
+                return static_cast<size_t>(hash % workerCount);
+            }
+        } // namespace
+
+        WorkStealingExecutor::WorkStealingExecutor(size_t threadCount, Crt::Allocator *allocator)
+            : m_allocator(allocator), m_workers(allocator), m_strands(allocator), m_runnable(0), m_stopping(false)
+        {
+            m_workers.reserve(threadCount);
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                m_workers.push_back(std::unique_ptr<Worker>(new Worker()));
+            }
+        }
+
+        bool WorkStealingExecutor::Start()
+        {
+            /* Start the threads only once every run queue exists, since workers steal from each other. */
+            for (size_t i = 0; i < m_workers.size(); ++i)
+            {
+                try
+                {
+                    m_workers[i]->thread = std::thread([this, i]() { RunWorker(i); });
+                }
+                catch (const std::system_error &)
+                {
+                    /* The destructor joins the workers already started. */
+                    aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        WorkStealingExecutor::~WorkStealingExecutor()
+        {
+            {
+                std::lock_guard<std::mutex> strandsGuard(m_strandsLock);
+                std::lock_guard<std::mutex> wakeGuard(m_wakeLock);
+                m_stopping = true;
+            }
+            m_wake.notify_all();
+
+            for (auto &worker : m_workers)
+            {
+                if (worker->thread.joinable())
+                {
+                    worker->thread.join();
+                }
+            }
+        }
+
+        bool WorkStealingExecutor::Submit(const Crt::String &orderingKey, std::function<void()> &&task)
+        {
+            std::shared_ptr<Strand> toSchedule;
+            {
+                std::lock_guard<std::mutex> guard(m_strandsLock);
+                if (m_stopping || m_workers.empty())
+                {
+                    return false;
+                }
+
+                auto &strand = m_strands[orderingKey];
+                if (!strand)
+                {
+                    strand = Crt::MakeShared<Strand>(m_allocator);
+                    strand->key = orderingKey;
+                }
+
+                strand->tasks.push_back(std::move(task));
+                if (!strand->scheduled)
+                {
+                    strand->scheduled = true;
+                    toSchedule = strand;
+                }
+            }
+
+            if (toSchedule)
+            {
+                /* Start each key on a fixed worker so a thing's messages tend to stay on one core. */
+                Schedule(toSchedule, s_homeWorker(orderingKey, m_workers.size()));
+            }
+            return true;
+        }
+
+        HandlerExecutor WorkStealingExecutor::AsHandlerExecutor()
+        {
+            std::weak_ptr<WorkStealingExecutor> weakSelf = shared_from_this();
+            return [weakSelf](const Crt::String &orderingKey, std::function<void()> &&task) {
+                auto self = weakSelf.lock();
+                if (!self || !self->Submit(orderingKey, std::move(task)))
+                {
+                    task();
+                }
+            };
+        }
+
+        void WorkStealingExecutor::Schedule(const std::shared_ptr<Strand> &strand, size_t worker)
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_workers[worker]->lock);
+                m_workers[worker]->runQueue.push_back(strand);
+                ++m_runnable;
+            }
+
+            {
+                /* Taking the lock orders the increment before a sleeping worker's predicate check. */
+                std::lock_guard<std::mutex> guard(m_wakeLock);
+            }
+            m_wake.notify_one();
+        }
+
+        std::shared_ptr<WorkStealingExecutor::Strand> WorkStealingExecutor::NextStrand(size_t worker)
+        {
+            std::shared_ptr<Strand> strand;
+            {
+                Worker &own = *m_workers[worker];
+                std::lock_guard<std::mutex> guard(own.lock);
+                if (!own.runQueue.empty())
+                {
+                    strand = std::move(own.runQueue.front());
+                    own.runQueue.pop_front();
+                    --m_runnable;
+                    return strand;
+                }
+            }
+
+            /* Steal from the back of the other queues, the end their owners reach last. */
+            for (size_t offset = 1; offset < m_workers.size(); ++offset)
+            {
+                Worker &victim = *m_workers[(worker + offset) % m_workers.size()];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                if (!victim.runQueue.empty())
+                {
+                    strand = std::move(victim.runQueue.back());
+                    victim.runQueue.pop_back();
+                    --m_runnable;
+                    return strand;
+                }
+            }
+
+            return strand;
+        }
+
+        void WorkStealingExecutor::RunWorker(size_t worker)
+        {
+            while (true)
+            {
+                std::shared_ptr<Strand> strand = NextStrand(worker);
+                if (!strand)
+                {
+                    std::unique_lock<std::mutex> wakeLock(m_wakeLock);
+                    m_wake.wait(wakeLock, [this]() { return m_runnable.load() > 0 || m_stopping; });
+                    if (m_stopping && m_runnable.load() == 0)
+                    {
+                        return;
+                    }
+                    continue;
+                }
+
+                std::function<void()> task;
+                {
+                    std::lock_guard<std::mutex> guard(m_strandsLock);
+                    task = std::move(strand->tasks.front());
+                    strand->tasks.pop_front();
+                }
+
+                task();
+
+                bool reschedule = false;
+                {
+                    std::lock_guard<std::mutex> guard(m_strandsLock);
+                    if (strand->tasks.empty())
+                    {
+                        strand->scheduled = false;
+                        m_strands.erase(strand->key);
+                    }
+                    else
+                    {
+                        reschedule = true;
+                    }
+                }
+
+                /* One task per turn, then requeue behind other keys so a busy thing cannot starve the rest. */
+                if (reschedule)
+                {
+                    Schedule(strand, worker);
+                }
+            }
+        }
+
+        std::shared_ptr<WorkStealingExecutor> WorkStealingExecutor::Create(
+            size_t threadCount,
+            Crt::Allocator *allocator)
+        {
+            if (threadCount == 0)
+            {
+                threadCount = std::thread::hardware_concurrency();
+                if (threadCount == 0)
+                {
+                    threadCount = 1;
+                }
+            }
+
+            auto *toSeat =
+                static_cast<WorkStealingExecutor *>(aws_mem_acquire(allocator, sizeof(WorkStealingExecutor)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) WorkStealingExecutor(threadCount, allocator);
+                std::shared_ptr<WorkStealingExecutor> executor(
+                    toSeat, [allocator](WorkStealingExecutor *toDelete) { Crt::Delete(toDelete, allocator); });
+                return executor->Start() ? executor : nullptr;
+            }
+
+            return nullptr;
+        }
+
+    } // namespace Iotdevicecommon
+} // namespace Aws
@@ -0,0 +1,142 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotdevicecommon/CborReader.h>
+#include <aws/iotdevicecommon/CborWriter.h>
+#include <aws/testing/aws_test_harness.h>
+
+static int s_TestCborWriterEncoding(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+
+        Aws::Crt::ByteBuf buffer;
+        ASSERT_SUCCESS(aws_byte_buf_init(&buffer, allocator, 4));
+
+        Aws::Iotdevicecommon::CborWriter writer(buffer);
+        writer.BeginObject();
+        writer.Key("a").Integer(23);
+        writer.Key("b").BeginArray().Bool(true).Null().Integer(-500).EndArray();
+        writer.Key("c").String("x");
+        writer.Key("d").Double(1.5);
+        writer.Key("e").Int64(4294967296LL);
+        writer.Key("f").Double(0.1);
+        writer.EndObject();
+        ASSERT_TRUE(writer);
+
+        const uint8_t expected[] = {
+            0xBF,                                                             /* map(*) */
+            0x61, 'a',  0x17,                                                 /* "a": 23 */
+            0x61, 'b',  0x9F, 0xF5, 0xF6, 0x39, 0x01, 0xF3, 0xFF,             /* "b": [* true, null, -500] */
+            0x61, 'c',  0x61, 'x',                                            /* "c": "x" */
+            0x61, 'd',  0xFA, 0x3F, 0xC0, 0x00, 0x00,                         /* "d": float32 1.5 */
+            0x61, 'e',  0x1B, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, /* "e": uint64 2^32 */
+            0x61, 'f',  0xFB, 0x3F, 0xB9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A, /* "f": float64 0.1 */
+            0xFF,                                                             /* break */
+        };
+        ASSERT_BIN_ARRAYS_EQUALS(expected, sizeof(expected), buffer.buffer, buffer.len);
+
+        aws_byte_buf_clean_up(&buffer);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(CborWriterEncoding, s_TestCborWriterEncoding)
+
+static int s_TestCborRoundTrip(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+
+        Aws::Crt::JsonObject source(Aws::Crt::String(
+            "{\"state\":{\"desired\":{\"color\":\"red\",\"on\":true,\"level\":-12}},\"version\":42,"
+            "\"ratio\":0.25,\"tags\":[\"a\",null,\"\\u00e9\"],\"empty\":{}}"));
+        ASSERT_TRUE(source.WasParseSuccessful());
+
+        Aws::Crt::ByteBuf buffer;
+        ASSERT_SUCCESS(aws_byte_buf_init(&buffer, allocator, 64));
+        Aws::Iotdevicecommon::CborWriter writer(buffer);
+        writer.Value(source.View());
+        ASSERT_TRUE(writer);
+
+        Aws::Crt::JsonObject decoded;
+        ASSERT_TRUE(Aws::Iotdevicecommon::CborReader::ToJsonObject(aws_byte_cursor_from_buf(&buffer), decoded));
+        aws_byte_buf_clean_up(&buffer);
+
+        Aws::Crt::JsonView view = decoded.View();
+        Aws::Crt::JsonView desired = view.GetJsonObject("state").GetJsonObject("desired");
+        ASSERT_TRUE(desired.GetString("color") == "red");
+        ASSERT_TRUE(desired.GetBool("on"));
+        ASSERT_INT_EQUALS(-12, desired.GetInteger("level"));
+        ASSERT_INT_EQUALS(42, view.GetInteger("version"));
+        ASSERT_TRUE(view.GetDouble("ratio") == 0.25);
+        auto tags = view.GetArray("tags");
+        ASSERT_UINT_EQUALS(3, tags.size());
+        ASSERT_TRUE(tags[0].AsString() == "a");
+        ASSERT_TRUE(tags[1].IsNull());
+        ASSERT_TRUE(tags[2].AsString() == "\xc3\xa9");
+        ASSERT_TRUE(view.GetJsonObject("empty").IsObject());
+        ASSERT_UINT_EQUALS(0, view.GetJsonObject("empty").GetAllObjects().size());
+
+        /* Definite lengths, tags and half floats, none of which CborWriter writes, decode as well. */
+        const uint8_t definite[] = {
+            0xA2,                              /* map(2) */
+            0x61, 'v', 0xC1, 0x19, 0x01, 0x00, /* "v": tag(1) 256 */
+            0x61, 'h', 0xF9, 0x3E, 0x00,       /* "h": float16 1.5 */
+        };
+        Aws::Crt::JsonObject definiteDecoded;
+        ASSERT_TRUE(Aws::Iotdevicecommon::CborReader::ToJsonObject(
+            aws_byte_cursor_from_array(definite, sizeof(definite)), definiteDecoded));
+        ASSERT_INT_EQUALS(256, definiteDecoded.View().GetInteger("v"));
+        ASSERT_TRUE(definiteDecoded.View().GetDouble("h") == 1.5);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(CborRoundTrip, s_TestCborRoundTrip)
+
+static int s_TestCborReaderRejectsMalformed(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+
+        const uint8_t byteString[] = {0xA1, 0x61, 'a', 0x41, 'x'};
+        const uint8_t truncated[] = {0xA1, 0x61, 'a', 0x19, 0x01};
+        const uint8_t integerKey[] = {0xA1, 0x01, 0x02};
+        const uint8_t trailing[] = {0x01, 0x02};
+        const uint8_t unterminated[] = {0xBF, 0x61, 'a', 0x01};
+
+        struct Case
+        {
+            const uint8_t *Payload;
+            size_t Length;
+        };
+        const Case cases[] = {
+            {byteString, sizeof(byteString)},
+            {truncated, sizeof(truncated)},
+            {integerKey, sizeof(integerKey)},
+            {trailing, sizeof(trailing)},
+            {unterminated, sizeof(unterminated)},
+        };
+        for (const Case &malformed : cases)
+        {
+            Aws::Crt::JsonObject document;
+            aws_reset_error();
+            ASSERT_FALSE(Aws::Iotdevicecommon::CborReader::ToJsonObject(
+                aws_byte_cursor_from_array(malformed.Payload, malformed.Length), document));
+            ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(CborReaderRejectsMalformed, s_TestCborReaderRejectsMalformed)
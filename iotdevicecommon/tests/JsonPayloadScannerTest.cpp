@@ -0,0 +1,138 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+
+#include <aws/iotdevicecommon/JsonPayloadScanner.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <cstring>
+
+using namespace Aws::Iotdevicecommon;
+
+static Aws::Crt::ByteCursor s_cursorOf(const Aws::Crt::String &value)
+{
+    return aws_byte_cursor_from_array(value.data(), value.size());
+}
+
+static bool s_equals(const Aws::Crt::ByteCursor &cursor, const Aws::Crt::String &expected)
+{
+    return cursor.len == expected.size() && memcmp(cursor.ptr, expected.data(), cursor.len) == 0;
+}
+
+static int s_TestJsonPayloadScannerReadValues(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+
+        const Aws::Crt::String payload(
+            " { \"version\" : 42, \"big\":-9007199254740993, \"ratio\":2.5e-1, \"on\":true, \"none\":null,"
+            " \"name\":\"a\\\"b\\u00e9\\ud83d\\ude00\", \"list\":[1, \"x\", {}] } ");
+        Aws::Crt::ByteCursor value;
+
+        int64_t integer = 0;
+        ASSERT_TRUE(JsonPayloadScanner::FindMember(s_cursorOf(payload), "version", value));
+        ASSERT_TRUE(JsonPayloadScanner::ReadInteger(value, integer));
+        ASSERT_INT_EQUALS(42, integer);
+        ASSERT_TRUE(JsonPayloadScanner::FindMember(s_cursorOf(payload), "big", value));
+        ASSERT_TRUE(JsonPayloadScanner::ReadInteger(value, integer));
+        ASSERT_TRUE(integer == -9007199254740993LL);
+
+        double number = 0;
+        ASSERT_TRUE(JsonPayloadScanner::FindMember(s_cursorOf(payload), "ratio", value));
+        ASSERT_FALSE(JsonPayloadScanner::ReadInteger(value, integer));
+        ASSERT_TRUE(JsonPayloadScanner::ReadDouble(value, number));
+        ASSERT_TRUE(number == 0.25);
+
+        bool boolean = false;
+        ASSERT_TRUE(JsonPayloadScanner::FindMember(s_cursorOf(payload), "on", value));
+        ASSERT_TRUE(JsonPayloadScanner::ReadBool(value, boolean));
+        ASSERT_TRUE(boolean);
+        ASSERT_TRUE(JsonPayloadScanner::FindMember(s_cursorOf(payload), "none", value));
+        ASSERT_TRUE(JsonPayloadScanner::IsNull(value));
+
+        Aws::Crt::String string;
+        ASSERT_TRUE(JsonPayloadScanner::FindMember(s_cursorOf(payload), "name", value));
+        ASSERT_TRUE(JsonPayloadScanner::ReadString(value, string));
+        ASSERT_TRUE(string == "a\"b\xc3\xa9\xf0\x9f\x98\x80");
+
+        size_t elements = 0;
+        ASSERT_TRUE(JsonPayloadScanner::FindMember(s_cursorOf(payload), "list", value));
+        ASSERT_TRUE(JsonPayloadScanner::ForEachElement(value, [&elements](const Aws::Crt::ByteCursor &) {
+            ++elements;
+            return true;
+        }));
+        ASSERT_UINT_EQUALS(3, elements);
+
+        ASSERT_FALSE(JsonPayloadScanner::FindMember(s_cursorOf(payload), "missing", value));
+        ASSERT_FALSE(JsonPayloadScanner::FindMember(s_cursorOf(Aws::Crt::String("[1]")), "version", value));
+        ASSERT_FALSE(JsonPayloadScanner::FindMember(s_cursorOf(Aws::Crt::String("{\"a\" 1}")), "a", value));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(JsonPayloadScannerReadValues, s_TestJsonPayloadScannerReadValues)
+
+/*
+ * With USE_SIMD_JSON, nested values are skipped 64 bytes at a time, carrying string and escape state from one
+ * block to the next. Sliding an escaped quote, a run of backslashes and brackets within strings across every
+ * offset of the first blocks checks that result against JsonObject's parse; run in both configurations, the
+ * same expectations hold the SSE2 or NEON scan to the scalar one.
+ */
+static int s_TestJsonPayloadScannerBlockBoundaries(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        printf("JsonPayloadScanner backend: %s\n", JsonPayloadScanner::Backend());
+
+        for (size_t padding = 0; padding < 140; ++padding)
+        {
+            Aws::Crt::String nested("{\"p\":\"");
+            nested.append(padding, 'x');
+            nested.append("\",\"s\":\"a\\\"}]\\\\\\\\\\\\\\\"{[\",\"arr\":[1,[2,{\"k\":\"v}\"}]]}");
+
+            Aws::Crt::String payload("{\"nested\":");
+            payload.append(nested).append(",\"after\":7}");
+
+            Aws::Crt::JsonObject parsed(payload);
+            ASSERT_TRUE(parsed.WasParseSuccessful());
+
+            Aws::Crt::ByteCursor value;
+            ASSERT_TRUE(JsonPayloadScanner::FindMember(s_cursorOf(payload), "nested", value));
+            ASSERT_TRUE(s_equals(value, nested));
+
+            Aws::Crt::ByteCursor after;
+            int64_t integer = 0;
+            ASSERT_TRUE(JsonPayloadScanner::FindMember(s_cursorOf(payload), "after", after));
+            ASSERT_TRUE(JsonPayloadScanner::ReadInteger(after, integer));
+            ASSERT_INT_EQUALS(parsed.View().GetInteger("after"), integer);
+
+            Aws::Crt::ByteCursor escaped;
+            Aws::Crt::String string;
+            ASSERT_TRUE(JsonPayloadScanner::FindMember(value, "s", escaped));
+            ASSERT_TRUE(JsonPayloadScanner::ReadString(escaped, string));
+            ASSERT_TRUE(string == parsed.View().GetJsonObject("nested").GetString("s"));
+
+            size_t members = 0;
+            ASSERT_TRUE(JsonPayloadScanner::ForEachMember(
+                value, [&members](const Aws::Crt::ByteCursor &, const Aws::Crt::ByteCursor &) {
+                    ++members;
+                    return true;
+                }));
+            ASSERT_UINT_EQUALS(parsed.View().GetJsonObject("nested").GetAllObjects().size(), members);
+
+            /* Cut short of its closing brace, the nested value never ends, so nothing after it is found. */
+            Aws::Crt::String truncated = payload.substr(0, payload.size() - 12);
+            ASSERT_FALSE(JsonPayloadScanner::FindMember(s_cursorOf(truncated), "after", after));
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(JsonPayloadScannerBlockBoundaries, s_TestJsonPayloadScannerBlockBoundaries)
@@ -0,0 +1,234 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotdevicecommon/CborReader.h>
+#include <aws/iotdevicecommon/CborWriter.h>
+#include <aws/iotdevicecommon/JsonWriter.h>
+#include <aws/iotdevicecommon/ModelFields.h>
+#include <aws/testing/aws_test_harness.h>
+
+namespace
+{
+    enum class Shade
+    {
+        Light,
+        Dark,
+        Unknown,
+    };
+
+    Shade s_shadeFromString(const Aws::Crt::String &value)
+    {
+        return value == "LIGHT" ? Shade::Light : value == "DARK" ? Shade::Dark : Shade::Unknown;
+    }
+
+    const char *s_shadeToString(Shade value)
+    {
+        return value == Shade::Light ? "LIGHT" : value == Shade::Dark ? "DARK" : "UNKNOWN";
+    }
+
+    /* Shaped like the generated models: optional members, a field table, and the three conversions. */
+    struct Child
+    {
+        Child() = default;
+        Child(const Aws::Crt::JsonView &doc);
+
+        void SerializeToObject(Aws::Crt::JsonObject &object) const;
+        void SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const;
+
+        Aws::Crt::Optional<Aws::Crt::String> Name;
+    };
+
+    struct Model
+    {
+        Aws::Crt::Optional<Aws::Crt::String> Text;
+        Aws::Crt::Optional<bool> Flag;
+        Aws::Crt::Optional<int32_t> Small;
+        Aws::Crt::Optional<int64_t> Large;
+        Aws::Crt::Optional<Aws::Crt::JsonObject> Document;
+        Aws::Crt::Optional<Aws::Iotdevicecommon::FlatStringMap> Details;
+        Aws::Crt::Optional<Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>> Attributes;
+        Aws::Crt::Optional<Shade> Tint;
+        Aws::Crt::Optional<Child> Only;
+        Aws::Crt::Optional<Aws::Crt::Vector<Child>> Children;
+        Aws::Iotdevicecommon::PackedDateTime At;
+    };
+
+    using ChildFields = Aws::Iotdevicecommon::ModelFields<Child, true>;
+    using Fields = Aws::Iotdevicecommon::ModelFields<Model, true>;
+    using ShadeCodec = Aws::Iotdevicecommon::EnumCodec<Shade, s_shadeFromString, s_shadeToString>;
+
+    constexpr Aws::Iotdevicecommon::ModelField<Child> s_childFields[] = {
+        ChildFields::Field<Aws::Crt::String, &Child::Name>("name"),
+    };
+
+    constexpr Aws::Iotdevicecommon::ModelField<Model> s_fields[] = {
+        Fields::Field<Aws::Crt::String, &Model::Text>("text"),
+        Fields::Field<bool, &Model::Flag>("flag"),
+        Fields::Field<int32_t, &Model::Small>("small"),
+        Fields::Field<int64_t, &Model::Large>("large"),
+        Fields::Field<Aws::Crt::JsonObject, &Model::Document>("document"),
+        Fields::Field<Aws::Iotdevicecommon::FlatStringMap, &Model::Details>("details"),
+        Fields::Field<Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>, &Model::Attributes>("attributes"),
+        Fields::Field<Shade, &Model::Tint, ShadeCodec>("tint"),
+        Fields::Field<Child, &Model::Only, Aws::Iotdevicecommon::ModelCodec<Child>>("only"),
+        Fields::Field<Aws::Crt::Vector<Child>, &Model::Children, Aws::Iotdevicecommon::ModelListCodec<Child>>(
+            "children"),
+        Fields::Timestamp<&Model::At>("at"),
+    };
+
+    Child::Child(const Aws::Crt::JsonView &doc) { Aws::Iotdevicecommon::LoadFields(*this, s_childFields, doc); }
+
+    void Child::SerializeToObject(Aws::Crt::JsonObject &object) const
+    {
+        Aws::Iotdevicecommon::SaveFields(*this, s_childFields, object);
+    }
+
+    void Child::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+    {
+        Aws::Iotdevicecommon::WriteFields(*this, s_childFields, writer);
+    }
+
+    Model s_makeModel()
+    {
+        Model model;
+        model.Text = Aws::Crt::String("caf\xc3\xa9 \"quoted\"");
+        model.Flag = false;
+        model.Small = -7;
+        model.Large = 4102444800123LL;
+        model.Document = Aws::Crt::JsonObject(Aws::Crt::String("{\"color\":\"red\",\"levels\":[1,2,3]}"));
+        model.Details.emplace();
+        model.Details->emplace("b", "2");
+        model.Details->emplace("a", "1");
+        model.Attributes.emplace();
+        model.Attributes->emplace("zone", "eu");
+        model.Tint = Shade::Dark;
+        model.Only = Child();
+        model.Only->Name = Aws::Crt::String("only");
+        model.Children.emplace();
+        model.Children->push_back(Child());
+        model.Children->back().Name = Aws::Crt::String("first");
+        model.Children->push_back(Child());
+        model.At = Aws::Iotdevicecommon::PackedDateTime::FromSeconds(1600000000.25);
+        return model;
+    }
+
+    int s_checkModel(const Model &expected, const Model &actual)
+    {
+        ASSERT_TRUE(actual.Text.has_value() && *actual.Text == *expected.Text);
+        ASSERT_TRUE(actual.Flag.has_value() && *actual.Flag == *expected.Flag);
+        ASSERT_TRUE(actual.Small.has_value() && *actual.Small == *expected.Small);
+        ASSERT_TRUE(actual.Large.has_value() && *actual.Large == *expected.Large);
+        ASSERT_TRUE(actual.Document.has_value() && *actual.Document == *expected.Document);
+        ASSERT_TRUE(actual.Details.has_value() && *actual.Details == *expected.Details);
+        ASSERT_TRUE(actual.Attributes.has_value() && *actual.Attributes == *expected.Attributes);
+        ASSERT_TRUE(actual.Tint.has_value() && *actual.Tint == *expected.Tint);
+        ASSERT_TRUE(actual.Only.has_value() && actual.Only->Name.has_value() && *actual.Only->Name == "only");
+        ASSERT_TRUE(actual.Children.has_value());
+        ASSERT_UINT_EQUALS(2, actual.Children->size());
+        ASSERT_TRUE((*actual.Children)[0].Name.has_value() && *(*actual.Children)[0].Name == "first");
+        ASSERT_FALSE((*actual.Children)[1].Name.has_value());
+        ASSERT_TRUE(actual.At == expected.At);
+        return AWS_OP_SUCCESS;
+    }
+} // namespace
+
+static int s_TestModelFieldsRoundTrip(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        const Model model = s_makeModel();
+
+        /* SaveFields to a document and back. */
+        Aws::Crt::JsonObject saved;
+        Aws::Iotdevicecommon::SaveFields(model, s_fields, saved);
+        Model fromSaved;
+        Aws::Iotdevicecommon::LoadFields(fromSaved, s_fields, saved.View());
+        ASSERT_SUCCESS(s_checkModel(model, fromSaved));
+
+        /* WriteFields streams the same members, so its JSON loads into the same model. */
+        Aws::Crt::ByteBuf json;
+        ASSERT_SUCCESS(aws_byte_buf_init(&json, allocator, 64));
+        Aws::Iotdevicecommon::JsonWriter jsonWriter(json);
+        Aws::Iotdevicecommon::WriteFields(model, s_fields, jsonWriter);
+        ASSERT_TRUE(jsonWriter);
+        Aws::Crt::JsonObject written(Aws::Crt::String(reinterpret_cast<const char *>(json.buffer), json.len));
+        aws_byte_buf_clean_up(&json);
+        ASSERT_TRUE(written.WasParseSuccessful());
+        Model fromJson;
+        Aws::Iotdevicecommon::LoadFields(fromJson, s_fields, written.View());
+        ASSERT_SUCCESS(s_checkModel(model, fromJson));
+
+        /* And so does its CBOR, decoded into the document type the models load from. */
+        Aws::Crt::ByteBuf cbor;
+        ASSERT_SUCCESS(aws_byte_buf_init(&cbor, allocator, 64));
+        Aws::Iotdevicecommon::CborWriter cborWriter(cbor);
+        Aws::Iotdevicecommon::WriteFields(model, s_fields, cborWriter);
+        ASSERT_TRUE(cborWriter);
+        Aws::Crt::JsonObject decoded;
+        ASSERT_TRUE(Aws::Iotdevicecommon::CborReader::ToJsonObject(aws_byte_cursor_from_buf(&cbor), decoded));
+        aws_byte_buf_clean_up(&cbor);
+        Model fromCbor;
+        Aws::Iotdevicecommon::LoadFields(fromCbor, s_fields, decoded.View());
+        ASSERT_SUCCESS(s_checkModel(model, fromCbor));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ModelFieldsRoundTrip, s_TestModelFieldsRoundTrip)
+
+static int s_TestModelFieldsUnsetAndMistyped(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+
+        /* Unset members are left out of both the document and the stream. */
+        Model empty;
+        Aws::Crt::JsonObject saved;
+        Aws::Iotdevicecommon::SaveFields(empty, s_fields, saved);
+        ASSERT_UINT_EQUALS(0, saved.View().GetAllObjects().size());
+
+        Aws::Crt::ByteBuf json;
+        ASSERT_SUCCESS(aws_byte_buf_init(&json, allocator, 16));
+        Aws::Iotdevicecommon::JsonWriter writer(json);
+        Aws::Iotdevicecommon::WriteFields(empty, s_fields, writer);
+        ASSERT_BIN_ARRAYS_EQUALS("{}", 2, json.buffer, json.len);
+        aws_byte_buf_clean_up(&json);
+
+        /* Members of the wrong kind, and null documents, are left unset rather than half-read. */
+        Aws::Crt::JsonObject mistyped(Aws::Crt::String(
+            "{\"text\":5,\"flag\":\"true\",\"small\":\"1\",\"large\":[],\"document\":null,\"details\":[1],"
+            "\"attributes\":\"a\",\"tint\":1,\"only\":[],\"children\":{},\"at\":\"2020-09-13\"}"));
+        ASSERT_TRUE(mistyped.WasParseSuccessful());
+        Model loaded;
+        Aws::Iotdevicecommon::LoadFields(loaded, s_fields, mistyped.View());
+        ASSERT_FALSE(loaded.Text.has_value());
+        ASSERT_FALSE(loaded.Flag.has_value());
+        ASSERT_FALSE(loaded.Small.has_value());
+        ASSERT_FALSE(loaded.Large.has_value());
+        ASSERT_FALSE(loaded.Document.has_value());
+        ASSERT_FALSE(loaded.Details.has_value());
+        ASSERT_FALSE(loaded.Attributes.has_value());
+        ASSERT_FALSE(loaded.Tint.has_value());
+        ASSERT_FALSE(loaded.Only.has_value());
+        ASSERT_FALSE(loaded.Children.has_value());
+        ASSERT_FALSE(static_cast<bool>(loaded.At));
+
+        /* Numbers load into integer members whether or not they were written with a fraction. */
+        Aws::Crt::JsonObject numbers(Aws::Crt::String("{\"small\":3.0,\"large\":1e3,\"tint\":\"LIGHT\"}"));
+        Model fromNumbers;
+        Aws::Iotdevicecommon::LoadFields(fromNumbers, s_fields, numbers.View());
+        ASSERT_TRUE(fromNumbers.Small.has_value() && *fromNumbers.Small == 3);
+        ASSERT_TRUE(fromNumbers.Large.has_value() && *fromNumbers.Large == 1000);
+        ASSERT_TRUE(fromNumbers.Tint.has_value() && *fromNumbers.Tint == Shade::Light);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ModelFieldsUnsetAndMistyped, s_TestModelFieldsUnsetAndMistyped)
@@ -0,0 +1,107 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotdevicecommon/TimerWheel.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <condition_variable>
+#include <mutex>
+
+static int s_TestTimerWheelExpiryOrder(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        Aws::Crt::Io::EventLoopGroup eventLoopGroup(1, allocator);
+        ASSERT_TRUE(eventLoopGroup);
+
+        auto timers = Aws::Iotdevicecommon::TimerWheel::Create(eventLoopGroup, 1, allocator);
+        ASSERT_NOT_NULL(timers.get());
+
+        std::mutex lock;
+        std::condition_variable fired;
+        Aws::Crt::Vector<int> order;
+        auto record = [&lock, &fired, &order](int which) {
+            return [&lock, &fired, &order, which]() {
+                std::lock_guard<std::mutex> guard(lock);
+                order.push_back(which);
+                fired.notify_all();
+            };
+        };
+
+        /* 5 ticks is in the first level, 100 in the second and 5000 in the third, so the last two cascade. */
+        uint64_t third = timers->Schedule(5000, record(3));
+        uint64_t first = timers->Schedule(5, record(1));
+        uint64_t second = timers->Schedule(100, record(2));
+        uint64_t cancelled = timers->Schedule(50, record(0));
+        ASSERT_TRUE(first != 0 && second != 0 && third != 0 && cancelled != 0);
+        ASSERT_UINT_EQUALS(4, timers->GetTimerCount());
+
+        ASSERT_TRUE(timers->Cancel(cancelled));
+        ASSERT_FALSE(timers->Cancel(cancelled));
+        ASSERT_UINT_EQUALS(3, timers->GetTimerCount());
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ASSERT_TRUE(fired.wait_for(guard, std::chrono::seconds(30), [&order]() { return order.size() == 3; }));
+            ASSERT_INT_EQUALS(1, order[0]);
+            ASSERT_INT_EQUALS(2, order[1]);
+            ASSERT_INT_EQUALS(3, order[2]);
+        }
+
+        ASSERT_UINT_EQUALS(0, timers->GetTimerCount());
+        ASSERT_FALSE(timers->Cancel(first));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(TimerWheelExpiryOrder, s_TestTimerWheelExpiryOrder)
+
+static int s_TestTimerWheelCancelFromCallback(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        Aws::Crt::Io::EventLoopGroup eventLoopGroup(1, allocator);
+        ASSERT_TRUE(eventLoopGroup);
+
+        auto timers = Aws::Iotdevicecommon::TimerWheel::Create(eventLoopGroup, 10, allocator);
+        ASSERT_NOT_NULL(timers.get());
+
+        std::mutex lock;
+        std::condition_variable fired;
+        bool done = false;
+        bool cancelledFired = false;
+
+        /* A callback may cancel and schedule timers; the wheel's lock is not held while it runs. */
+        uint64_t later = timers->Schedule(200, [&lock, &cancelledFired]() {
+            std::lock_guard<std::mutex> guard(lock);
+            cancelledFired = true;
+        });
+        std::weak_ptr<Aws::Iotdevicecommon::TimerWheel> weakTimers = timers;
+        ASSERT_TRUE(timers->Schedule(10, [&lock, &fired, &done, later, weakTimers]() {
+            auto wheel = weakTimers.lock();
+            wheel->Cancel(later);
+            wheel->Schedule(10, [&lock, &fired, &done]() {
+                std::lock_guard<std::mutex> guard(lock);
+                done = true;
+                fired.notify_all();
+            });
+        }) != 0);
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ASSERT_TRUE(fired.wait_for(guard, std::chrono::seconds(30), [&done]() { return done; }));
+            ASSERT_FALSE(cancelledFired);
+        }
+        ASSERT_UINT_EQUALS(0, timers->GetTimerCount());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(TimerWheelCancelFromCallback, s_TestTimerWheelCancelFromCallback)
@@ -0,0 +1,173 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotdevicecommon/WorkStealingExecutor.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    /* Open once, and never closed again. */
+    struct Gate
+    {
+        void Open()
+        {
+            std::lock_guard<std::mutex> guard(Lock);
+            IsOpen = true;
+            Signal.notify_all();
+        }
+
+        bool Wait()
+        {
+            std::unique_lock<std::mutex> guard(Lock);
+            return Signal.wait_for(guard, std::chrono::seconds(30), [this]() { return IsOpen; });
+        }
+
+        std::mutex Lock;
+        std::condition_variable Signal;
+        bool IsOpen = false;
+    };
+} // namespace
+
+static int s_TestWorkStealingExecutorKeyOrder(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        auto executor = Aws::Iotdevicecommon::WorkStealingExecutor::Create(4, allocator);
+        ASSERT_NOT_NULL(executor.get());
+        ASSERT_UINT_EQUALS(4, executor->GetThreadCount());
+
+        const size_t keyCount = 3;
+        const size_t taskCount = 300;
+        const char *keys[keyCount] = {"thing-a", "thing-b", "thing-c"};
+        std::mutex lock;
+        Aws::Crt::Vector<size_t> ran[keyCount];
+        std::atomic<int> running[keyCount];
+        std::atomic<bool> overlapped(false);
+        for (size_t key = 0; key < keyCount; ++key)
+        {
+            running[key] = 0;
+        }
+
+        /* Interleaved across keys, so each worker has several strands to run and others to steal. */
+        for (size_t i = 0; i < taskCount; ++i)
+        {
+            for (size_t key = 0; key < keyCount; ++key)
+            {
+                ASSERT_TRUE(executor->Submit(keys[key], [&lock, &ran, &running, &overlapped, key, i]() {
+                    if (++running[key] > 1)
+                    {
+                        overlapped = true;
+                    }
+                    std::this_thread::yield();
+                    {
+                        std::lock_guard<std::mutex> guard(lock);
+                        ran[key].push_back(i);
+                    }
+                    --running[key];
+                }));
+            }
+        }
+
+        /* Destroying the pool runs everything already submitted. */
+        executor.reset();
+
+        ASSERT_FALSE(overlapped.load());
+        for (size_t key = 0; key < keyCount; ++key)
+        {
+            ASSERT_UINT_EQUALS(taskCount, ran[key].size());
+            for (size_t i = 0; i < taskCount; ++i)
+            {
+                ASSERT_UINT_EQUALS(i, ran[key][i]);
+            }
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(WorkStealingExecutorKeyOrder, s_TestWorkStealingExecutorKeyOrder)
+
+/*
+ * Whichever worker the keys start on, the task for "b" has to run while the one for "a" is still waiting for it,
+ * which takes either two home workers or a steal.
+ */
+static int s_TestWorkStealingExecutorKeysRunInParallel(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        auto executor = Aws::Iotdevicecommon::WorkStealingExecutor::Create(2, allocator);
+        ASSERT_NOT_NULL(executor.get());
+
+        Gate bStarted;
+        Gate aDone;
+        bool sawB = false;
+        ASSERT_TRUE(executor->Submit("a", [&bStarted, &aDone, &sawB]() {
+            sawB = bStarted.Wait();
+            aDone.Open();
+        }));
+        ASSERT_TRUE(executor->Submit("b", [&bStarted]() { bStarted.Open(); }));
+
+        ASSERT_TRUE(aDone.Wait());
+        ASSERT_TRUE(sawB);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(WorkStealingExecutorKeysRunInParallel, s_TestWorkStealingExecutorKeysRunInParallel)
+
+static int s_TestWorkStealingExecutorDrainOnShutdown(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        auto executor = Aws::Iotdevicecommon::WorkStealingExecutor::Create(1, allocator);
+        ASSERT_NOT_NULL(executor.get());
+        Aws::Iotdevicecommon::HandlerExecutor handlerExecutor = executor->AsHandlerExecutor();
+
+        /* The only worker is held up, so everything submitted behind it is still queued at shutdown. */
+        Gate release;
+        std::atomic<size_t> ran(0);
+        std::atomic<bool> onCaller(false);
+        const std::thread::id caller = std::this_thread::get_id();
+        handlerExecutor("held", [&release, &ran, &onCaller, caller]() {
+            release.Wait();
+            onCaller = onCaller || std::this_thread::get_id() == caller;
+            ++ran;
+        });
+        for (size_t i = 0; i < 50; ++i)
+        {
+            Aws::Crt::String key("thing-");
+            key.append(1, static_cast<char>('a' + i % 5));
+            handlerExecutor(key, [&ran, &onCaller, caller]() {
+                onCaller = onCaller || std::this_thread::get_id() == caller;
+                ++ran;
+            });
+        }
+        ASSERT_UINT_EQUALS(0, ran.load());
+
+        release.Open();
+        executor.reset();
+        ASSERT_UINT_EQUALS(51, ran.load());
+        ASSERT_FALSE(onCaller.load());
+
+        /* With the pool gone, the executor it handed out runs tasks inline instead of dropping them. */
+        bool ranInline = false;
+        handlerExecutor("late", [&ranInline, caller]() { ranInline = std::this_thread::get_id() == caller; });
+        ASSERT_TRUE(ranInline);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(WorkStealingExecutorDrainOnShutdown, s_TestWorkStealingExecutorDrainOnShutdown)
@@ -8,6 +8,7 @@
 
 #include <aws/crt/JsonObject.h>
 #include <aws/crt/StlAllocator.h>
+#include <aws/iotdevicecommon/PayloadWriter.h>
 
 namespace Aws
 {
@@ -24,6 +25,11 @@ namespace Aws
 
             void SerializeToObject(Crt::JsonObject &doc) const;
 
+            /**
+             * Streams this object into a payload encoder, without building an intermediate JsonObject.
+             */
+            void SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const;
+
             Aws::Crt::Optional<int64_t> ExecutionNumber;
             Aws::Crt::Optional<Aws::Crt::String> ThingName;
             Aws::Crt::Optional<bool> IncludeJobDocument;
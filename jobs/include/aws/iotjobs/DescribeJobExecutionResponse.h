@@ -3,7 +3,7 @@
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0.
  */
-#include <aws/crt/DateTime.h>
+#include <aws/iotdevicecommon/PackedDateTime.h>
 #include <aws/iotjobs/JobExecutionData.h>
 
 #include <aws/iotjobs/Exports.h>
@@ -28,7 +28,7 @@ namespace Aws
 
             Aws::Crt::Optional<Aws::Iotjobs::JobExecutionData> Execution;
             Aws::Crt::Optional<Aws::Crt::String> ClientToken;
-            Aws::Crt::Optional<Aws::Crt::DateTime> Timestamp;
+            Aws::Iotdevicecommon::PackedDateTime Timestamp;
 
           private:
             static void LoadFromObject(DescribeJobExecutionResponse &obj, const Crt::JsonView &doc);
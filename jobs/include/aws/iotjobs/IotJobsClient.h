@@ -10,19 +10,28 @@
 
 #include <aws/crt/mqtt/MqttClient.h>
 
+#include <aws/iotdevicecommon/InlineFunction.h>
+#include <aws/iotdevicecommon/MessageContext.h>
+#include <aws/iotdevicecommon/ServiceClientConfig.h>
+#include <aws/iotdevicecommon/TopicBuilder.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
 
         class DescribeJobExecutionRequest;
+        struct DescribeJobExecutionRequestView;
         class DescribeJobExecutionResponse;
         class DescribeJobExecutionSubscriptionRequest;
         class GetPendingJobExecutionsRequest;
+        struct GetPendingJobExecutionsRequestView;
         class GetPendingJobExecutionsResponse;
         class GetPendingJobExecutionsSubscriptionRequest;
+        class JobExecutionDataView;
         class JobExecutionsChangedEvent;
         class JobExecutionsChangedSubscriptionRequest;
+        class PendingJobSummaries;
         class NextJobExecutionChangedEvent;
         class NextJobExecutionChangedSubscriptionRequest;
         class RejectedError;
@@ -33,8 +42,17 @@ namespace Aws
         class UpdateJobExecutionResponse;
         class UpdateJobExecutionSubscriptionRequest;
 
-        using OnSubscribeComplete = std::function<void(int ioErr)>;
-        using OnPublishComplete = std::function<void(int ioErr)>;
+        /*
+         * Completions are copied into every request, so they hold small callables in place rather than on the
+         * heap; any callable a std::function accepts converts to them.
+         */
+        using OnSubscribeComplete = Aws::Iotdevicecommon::InlineFunction<void(int ioErr)>;
+        using OnPublishComplete = Aws::Iotdevicecommon::InlineFunction<void(int ioErr)>;
+
+        /*
+         * Subscription handlers are passed a model that the client does not use again once they return, so they
+         * may move out of it; Iotdevicecommon::TakeResponse adapts a handler that takes ownership instead.
+         */
 
         using OnSubscribeToUpdateJobExecutionAcceptedResponse =
             std::function<void(Aws::Iotjobs::UpdateJobExecutionResponse *, int ioErr)>;
@@ -66,73 +84,292 @@ namespace Aws
         using OnSubscribeToStartNextPendingJobExecutionAcceptedResponse =
             std::function<void(Aws::Iotjobs::StartNextJobExecutionResponse *, int ioErr)>;
 
+        /**
+         * Handler for the lazily decoded variants of the subscribe calls that carry a job execution.
+         */
+        using OnSubscribeToJobExecutionDataViewResponse =
+            std::function<void(Aws::Iotjobs::JobExecutionDataView *, int ioErr)>;
+
+        /**
+         * Handler for SubscribeToGetPendingJobExecutionsAcceptedCompact. Null when the payload does not parse.
+         */
+        using OnSubscribeToPendingJobSummariesResponse =
+            std::function<void(Aws::Iotjobs::PendingJobSummaries *, int ioErr)>;
+
+        /**
+         * Handler for the raw variants of the subscribe calls. The cursor spans the MQTT payload as received
+         * and is only valid for the duration of the call.
+         */
+        using OnSubscribeToRawPayloadResponse = std::function<void(const Aws::Crt::ByteCursor *payload, int ioErr)>;
+
+        /**
+         * Called from a subscription handler, so that one handler subscribed with a "+" thing name or job id
+         * can serve many jobs. Iotdevicecommon::CurrentThingName() gives the thing name.
+         *
+         * @return the job id of the "$aws/things/<thing>/jobs/<jobId>/..." message being handled on the calling
+         * thread, or an empty string for other jobs topics and outside a handler.
+         */
+        AWS_IOTJOBS_API Crt::String CurrentJobId();
+
+        /**
+         * Publish* and Subscribe* may be called concurrently from any number of threads. Each publish
+         * serializes into its own pooled buffer and goes straight to the connection, whose publish is
+         * thread-safe; metrics, tracing and the buffer pool are internally synchronized and shared across
+         * calls. Response handlers run on the event loop thread, or the handler executor when one is set.
+         */
         class AWS_IOTJOBS_API IotJobsClient final
         {
           public:
-            IotJobsClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection);
+            IotJobsClient(
+                const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+                Aws::Crt::Allocator *allocator = Aws::Crt::DefaultAllocator());
+            IotJobsClient(
+                const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+                const Aws::Iotdevicecommon::ServiceClientConfig &config,
+                Aws::Crt::Allocator *allocator = Aws::Crt::DefaultAllocator());
 
             operator bool() const noexcept;
             int GetLastError() const noexcept;
 
+            /**
+             * @return the budget from the client's ServiceClientConfig, which helpers issuing requests through
+             * the client consult for their pending requests; null if none.
+             */
+            const std::shared_ptr<Aws::Iotdevicecommon::MemoryBudget> &GetMemoryBudget() const noexcept
+            {
+                return m_memoryBudget;
+            }
+
             bool SubscribeToUpdateJobExecutionAccepted(
                 const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateJobExecutionAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateJobExecutionAccepted(
+                const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateJobExecutionAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToGetPendingJobExecutionsRejected(
                 const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetPendingJobExecutionsRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetPendingJobExecutionsRejected(
+                const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetPendingJobExecutionsRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToDescribeJobExecutionAccepted(
                 const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDescribeJobExecutionAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDescribeJobExecutionAccepted(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDescribeJobExecutionAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToDescribeJobExecutionAccepted, but delivers a JobExecutionDataView over the
+             * parsed message: fields are decoded on access and the job document is not copied.
+             */
+            bool SubscribeToDescribeJobExecutionAcceptedLazy(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToJobExecutionDataViewResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDescribeJobExecutionAcceptedLazy(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToJobExecutionDataViewResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToDescribeJobExecutionAccepted, but hands over the payload without copying or
+             * parsing it. Use JobPayloadScanner::FindJobDocument to locate the job document in it.
+             */
+            bool SubscribeToDescribeJobExecutionAcceptedRaw(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToRawPayloadResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDescribeJobExecutionAcceptedRaw(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToRawPayloadResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToDescribeJobExecutionRejected(
                 const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDescribeJobExecutionRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDescribeJobExecutionRejected(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDescribeJobExecutionRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToUpdateJobExecutionRejected(
                 const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateJobExecutionRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateJobExecutionRejected(
+                const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateJobExecutionRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToJobExecutionsChangedEvents(
                 const Aws::Iotjobs::JobExecutionsChangedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToJobExecutionsChangedEventsResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToJobExecutionsChangedEvents(
+                const Aws::Iotjobs::JobExecutionsChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToJobExecutionsChangedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToStartNextPendingJobExecutionRejected(
                 const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToStartNextPendingJobExecutionRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToStartNextPendingJobExecutionRejected(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToStartNextPendingJobExecutionRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToNextJobExecutionChangedEvents(
                 const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToNextJobExecutionChangedEventsResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToNextJobExecutionChangedEvents(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToNextJobExecutionChangedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToNextJobExecutionChangedEvents, but delivers a JobExecutionDataView over the
+             * parsed message: fields are decoded on access and the job document is not copied.
+             */
+            bool SubscribeToNextJobExecutionChangedEventsLazy(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToJobExecutionDataViewResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToNextJobExecutionChangedEventsLazy(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToJobExecutionDataViewResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToNextJobExecutionChangedEvents, but hands over the payload without copying or
+             * parsing it. Use JobPayloadScanner::FindJobDocument to locate the job document in it.
+             */
+            bool SubscribeToNextJobExecutionChangedEventsRaw(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToRawPayloadResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToNextJobExecutionChangedEventsRaw(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToRawPayloadResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToGetPendingJobExecutionsAccepted(
                 const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetPendingJobExecutionsAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetPendingJobExecutionsAccepted(
+                const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetPendingJobExecutionsAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToGetPendingJobExecutionsAccepted, but decodes the job lists into a
+             * PendingJobSummaries, flat records with interned job ids, rather than a vector of models per list.
+             */
+            bool SubscribeToGetPendingJobExecutionsAcceptedCompact(
+                const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToPendingJobSummariesResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetPendingJobExecutionsAcceptedCompact(
+                const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToPendingJobSummariesResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToStartNextPendingJobExecutionAccepted(
                 const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToStartNextPendingJobExecutionAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToStartNextPendingJobExecutionAccepted(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToStartNextPendingJobExecutionAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToStartNextPendingJobExecutionAccepted, but delivers a JobExecutionDataView
+             * over the parsed message: fields are decoded on access and the job document is not copied.
+             */
+            bool SubscribeToStartNextPendingJobExecutionAcceptedLazy(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToJobExecutionDataViewResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToStartNextPendingJobExecutionAcceptedLazy(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToJobExecutionDataViewResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToStartNextPendingJobExecutionAccepted, but hands over the payload without
+             * copying or parsing it. Use JobPayloadScanner::FindJobDocument to locate the job document in it.
+             */
+            bool SubscribeToStartNextPendingJobExecutionAcceptedRaw(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToRawPayloadResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToStartNextPendingJobExecutionAcceptedRaw(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToRawPayloadResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Subscribes to every jobs topic of `thingName`, responses and events alike, and hands each message
+             * over without parsing it; for bridges forwarding them unchanged. `thingName` may be "+" to cover
+             * every thing.
+             */
+            bool SubscribeToJobsTopicsRaw(
+                const Aws::Crt::String &thingName,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnRawMessageReceived &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToJobsTopicsRaw(
+                const Aws::Crt::String &thingName,
+                Aws::Crt::Mqtt::QOS qos,
+                Aws::Iotdevicecommon::OnRawMessageReceived &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool PublishDescribeJobExecution(
                 const Aws::Iotjobs::DescribeJobExecutionRequest &request,
@@ -154,8 +391,98 @@ namespace Aws
                 Aws::Crt::Mqtt::QOS qos,
                 const OnPublishComplete &onPubAck);
 
+            /**
+             * View variants of the describe and get-pending publishes: the names and client token are
+             * referenced, not copied into a request model, and only need to stay valid for the call. Include
+             * <aws/iotjobs/JobsRequestView.h> to use them.
+             */
+            bool PublishDescribeJobExecution(
+                const Aws::Iotjobs::DescribeJobExecutionRequestView &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishGetPendingJobExecutions(
+                const Aws::Iotjobs::GetPendingJobExecutionsRequestView &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            /**
+             * Raw variants of the Publish* calls, for payloads serialized already, e.g. from a template or an
+             * upstream system: `payload`, in the client's payload format, is published as is, without being
+             * parsed, serialized or copied. It must stay valid until onRelease is invoked, which happens once the
+             * publish completed, or on return if the call fails. An offline queue or publish scheduler keeps a
+             * copy of the updates it holds back instead, releasing the payload at once.
+             */
+            bool PublishDescribeJobExecutionRaw(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::String &jobId,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishGetPendingJobExecutionsRaw(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishUpdateJobExecutionRaw(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::String &jobId,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishStartNextPendingJobExecutionRaw(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
           private:
+            /* The shared tail of the view publishes. */
+            template <typename View>
+            bool PublishView(
+                const View &request,
+                const Aws::Iotdevicecommon::TopicBuilder &topic,
+                Aws::Iotdevicecommon::ThrottledOperation operation,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishRaw(
+                const Aws::Iotdevicecommon::TopicBuilder &topic,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                bool deferrable,
+                Aws::Iotdevicecommon::ThrottledOperation operation,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
+            Aws::Crt::Allocator *m_allocator;
+            Aws::Crt::StlAllocator<char> m_stringAllocator;
             std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> m_connection;
+            std::shared_ptr<Aws::Iotdevicecommon::PayloadBufferPool> m_payloadBufferPool;
+            Aws::Iotdevicecommon::PayloadFormat m_payloadFormat;
+            /* Shared by every subscription's publish handler. */
+            std::shared_ptr<const Aws::Iotdevicecommon::HandlerContext> m_handlerContext;
+            std::shared_ptr<Aws::Iotdevicecommon::ServiceMetrics> m_metrics;
+            std::shared_ptr<Aws::Iotdevicecommon::RequestTracer> m_tracer;
+            std::shared_ptr<Aws::Iotdevicecommon::SessionSubscriptions> m_session;
+            bool m_reuseInboundModels;
+            std::shared_ptr<Aws::Iotdevicecommon::DurablePublishQueue> m_offlineQueue;
+            std::shared_ptr<Aws::Iotdevicecommon::MemoryBudget> m_memoryBudget;
+            std::shared_ptr<Aws::Iotdevicecommon::PublishScheduler> m_publishScheduler;
+            uint32_t m_scheduledPublishDeadlineMs;
+            std::shared_ptr<Aws::Iotdevicecommon::PublishCompletionBatcher> m_completionBatcher;
+            std::shared_ptr<Aws::Iotdevicecommon::PublishLanes> m_publishLanes;
+            std::shared_ptr<Aws::Iotdevicecommon::ThrottleBreaker> m_throttleBreaker;
+            std::shared_ptr<Aws::Iotdevicecommon::RequestRateLimiter> m_rateLimiter;
+            std::shared_ptr<Aws::Iotdevicecommon::HotStandby> m_hotStandby;
+            Aws::Iotdevicecommon::QosPolicy m_qosPolicy;
         };
 
     } // namespace Iotjobs
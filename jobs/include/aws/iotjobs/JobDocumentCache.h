@@ -0,0 +1,98 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/DescribeJobExecutionRequest.h>
+#include <aws/iotjobs/JobExecutionData.h>
+#include <aws/iotjobs/JobExecutionDataView.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+
+#include <aws/iotjobs/Exports.h>
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/StlAllocator.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * Keeps the job documents of recently seen jobs so that notify-next events, StartNext and Describe
+         * responses delivering the same document again reuse the one already decoded, and so that later
+         * requests can leave the document out altogether.
+         *
+         * Documents are keyed by job id alone: a job's document cannot change once the job is created,
+         * while the execution's versionNumber moves with every status update. The least recently used jobs
+         * are evicted beyond `maxEntries`. Safe to share between threads.
+         */
+        class AWS_IOTJOBS_API JobDocumentCache final
+        {
+          public:
+            explicit JobDocumentCache(
+                size_t maxEntries = 16,
+                Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+            JobDocumentCache(const JobDocumentCache &) = delete;
+            JobDocumentCache(JobDocumentCache &&) = delete;
+            JobDocumentCache &operator=(const JobDocumentCache &) = delete;
+            JobDocumentCache &operator=(JobDocumentCache &&) = delete;
+
+            /**
+             * Takes the job document out of `execution`, caching it if the job is new, and returns the
+             * cached document. Executions that arrived without a document, e.g. because the request set
+             * includeJobDocument to false, get the cached one.
+             *
+             * @return the job's document, or null if it has not been seen.
+             */
+            std::shared_ptr<const Crt::JsonObject> Resolve(JobExecutionData &execution);
+
+            /**
+             * As above for a lazily decoded execution, whose document is only materialized if the job has
+             * not been seen.
+             */
+            std::shared_ptr<const Crt::JsonObject> Resolve(const JobExecutionDataView &execution);
+
+            /**
+             * @return the cached document of `jobId`, or null.
+             */
+            std::shared_ptr<const Crt::JsonObject> Find(const Crt::String &jobId);
+
+            /**
+             * Asks the service to leave the document out of the response when it is already cached.
+             */
+            void Prepare(DescribeJobExecutionRequest &request);
+            void Prepare(UpdateJobExecutionRequest &request);
+
+            /**
+             * Forgets `jobId`, e.g. once its execution reached a terminal status.
+             */
+            void Erase(const Crt::String &jobId);
+
+            void Clear();
+
+            size_t GetSize() const;
+
+          private:
+            struct Entry
+            {
+                Crt::String JobId;
+                std::shared_ptr<const Crt::JsonObject> Document;
+            };
+
+            std::shared_ptr<const Crt::JsonObject> Store(const Crt::String &jobId, Crt::JsonObject &&document);
+            Crt::List<Entry>::iterator Lookup(const Crt::String &jobId);
+
+            size_t m_maxEntries;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            /* Most recently used first. */
+            Crt::List<Entry> m_entries;
+        };
+
+    } // namespace Iotjobs
+} // namespace Aws
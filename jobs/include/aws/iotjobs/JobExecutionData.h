@@ -3,7 +3,7 @@
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0.
  */
-#include <aws/crt/DateTime.h>
+#include <aws/iotdevicecommon/PackedDateTime.h>
 #include <aws/crt/JsonObject.h>
 #include <aws/iotjobs/JobStatus.h>
 
@@ -11,6 +11,7 @@
 
 #include <aws/crt/JsonObject.h>
 #include <aws/crt/StlAllocator.h>
+#include <aws/iotdevicecommon/FlatStringMap.h>
 
 namespace Aws
 {
@@ -31,12 +32,12 @@ namespace Aws
             Aws::Crt::Optional<Aws::Crt::JsonObject> JobDocument;
             Aws::Crt::Optional<Aws::Iotjobs::JobStatus> Status;
             Aws::Crt::Optional<int32_t> VersionNumber;
-            Aws::Crt::Optional<Aws::Crt::DateTime> QueuedAt;
+            Aws::Iotdevicecommon::PackedDateTime QueuedAt;
             Aws::Crt::Optional<Aws::Crt::String> ThingName;
             Aws::Crt::Optional<int64_t> ExecutionNumber;
-            Aws::Crt::Optional<Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>> StatusDetails;
-            Aws::Crt::Optional<Aws::Crt::DateTime> LastUpdatedAt;
-            Aws::Crt::Optional<Aws::Crt::DateTime> StartedAt;
+            Aws::Crt::Optional<Aws::Iotdevicecommon::FlatStringMap> StatusDetails;
+            Aws::Iotdevicecommon::PackedDateTime LastUpdatedAt;
+            Aws::Iotdevicecommon::PackedDateTime StartedAt;
 
           private:
             static void LoadFromObject(JobExecutionData &obj, const Crt::JsonView &doc);
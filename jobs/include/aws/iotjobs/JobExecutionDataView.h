@@ -0,0 +1,73 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/DateTime.h>
+#include <aws/crt/JsonObject.h>
+#include <aws/iotjobs/JobExecutionData.h>
+#include <aws/iotjobs/JobStatus.h>
+
+#include <aws/iotjobs/Exports.h>
+
+#include <memory>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * Read-only, lazily decoded view of a job execution message.
+         *
+         * The view shares ownership of the parsed message, so it can be copied cheaply and kept past the
+         * callback that delivered it. Fields are decoded on access; the job document is exposed as a
+         * JsonView into the parsed message instead of being deep-copied. ClientToken and Timestamp come from
+         * the enclosing response/event, the rest from its "execution" member.
+         */
+        class AWS_IOTJOBS_API JobExecutionDataView final
+        {
+          public:
+            JobExecutionDataView() = default;
+            explicit JobExecutionDataView(const std::shared_ptr<const Crt::JsonObject> &message);
+
+            /**
+             * False when the message carries no execution, e.g. a notify-next event with no pending job.
+             */
+            bool HasExecution() const noexcept;
+
+            Crt::Optional<Crt::String> GetJobId() const;
+            Crt::Optional<JobStatus> GetStatus() const;
+            Crt::Optional<int32_t> GetVersionNumber() const;
+            Crt::Optional<int64_t> GetExecutionNumber() const;
+            Crt::Optional<Crt::String> GetThingName() const;
+            Crt::Optional<Crt::DateTime> GetQueuedAt() const;
+            Crt::Optional<Crt::DateTime> GetStartedAt() const;
+            Crt::Optional<Crt::DateTime> GetLastUpdatedAt() const;
+
+            /**
+             * The job document without copying it. Valid as long as this view (or a copy) is alive.
+             */
+            Crt::Optional<Crt::JsonView> GetJobDocument() const;
+
+            /**
+             * Decoded on first access and cached.
+             */
+            const Crt::Optional<Iotdevicecommon::FlatStringMap> &GetStatusDetails() const;
+
+            Crt::Optional<Crt::String> GetClientToken() const;
+            Crt::Optional<Crt::DateTime> GetTimestamp() const;
+
+            /**
+             * Decodes every field into the eager model type.
+             */
+            JobExecutionData Materialize() const;
+
+          private:
+            std::shared_ptr<const Crt::JsonObject> m_message;
+            Crt::JsonView m_execution;
+            mutable bool m_statusDetailsDecoded = false;
+            mutable Crt::Optional<Iotdevicecommon::FlatStringMap> m_statusDetails;
+        };
+    } // namespace Iotjobs
+} // namespace Aws
@@ -9,6 +9,7 @@
 
 #include <aws/crt/JsonObject.h>
 #include <aws/crt/StlAllocator.h>
+#include <aws/iotdevicecommon/FlatStringMap.h>
 
 namespace Aws
 {
@@ -25,7 +26,7 @@ namespace Aws
 
             void SerializeToObject(Crt::JsonObject &doc) const;
 
-            Aws::Crt::Optional<Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>> StatusDetails;
+            Aws::Crt::Optional<Aws::Iotdevicecommon::FlatStringMap> StatusDetails;
             Aws::Crt::Optional<int32_t> VersionNumber;
             Aws::Crt::Optional<Aws::Iotjobs::JobStatus> Status;
 
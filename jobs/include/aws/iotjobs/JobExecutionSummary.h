@@ -3,7 +3,7 @@
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0.
  */
-#include <aws/crt/DateTime.h>
+#include <aws/iotdevicecommon/PackedDateTime.h>
 
 #include <aws/iotjobs/Exports.h>
 
@@ -25,12 +25,12 @@ namespace Aws
 
             void SerializeToObject(Crt::JsonObject &doc) const;
 
-            Aws::Crt::Optional<Aws::Crt::DateTime> LastUpdatedAt;
+            Aws::Iotdevicecommon::PackedDateTime LastUpdatedAt;
             Aws::Crt::Optional<int64_t> ExecutionNumber;
-            Aws::Crt::Optional<Aws::Crt::DateTime> StartedAt;
+            Aws::Iotdevicecommon::PackedDateTime StartedAt;
             Aws::Crt::Optional<int32_t> VersionNumber;
             Aws::Crt::Optional<Aws::Crt::String> JobId;
-            Aws::Crt::Optional<Aws::Crt::DateTime> QueuedAt;
+            Aws::Iotdevicecommon::PackedDateTime QueuedAt;
 
           private:
             static void LoadFromObject(JobExecutionSummary &obj, const Crt::JsonView &doc);
@@ -0,0 +1,111 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/IotJobsClient.h>
+#include <aws/iotjobs/JobExecutionSummary.h>
+#include <aws/iotjobs/JobExecutionsChangedEvent.h>
+#include <aws/iotjobs/JobStatus.h>
+
+#include <aws/iotjobs/Exports.h>
+
+#include <aws/crt/StlAllocator.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * One difference between two consecutive JobExecutionsChangedEvents.
+         */
+        struct AWS_IOTJOBS_API JobExecutionChange
+        {
+            enum class Kind
+            {
+                /** The execution was not in the previous event. */
+                Added,
+                /** The execution is no longer listed, e.g. because it reached a terminal status. */
+                Removed,
+                /** The execution's status, version or execution number changed. */
+                Changed,
+            };
+
+            Kind Type;
+            Crt::String JobId;
+            /** The current status; for Removed, the last one known. */
+            JobStatus Status;
+            /** The status before a Changed. */
+            Crt::Optional<JobStatus> PreviousStatus;
+            /** The current summary; for Removed, the last one known. */
+            JobExecutionSummary Summary;
+        };
+
+        using OnJobExecutionChanges =
+            std::function<void(const Crt::Vector<JobExecutionChange> &changes, int ioErr)>;
+
+        /**
+         * Keeps the device's job table as of the last JobExecutionsChangedEvent and reduces each new event to
+         * what changed since, so handlers do work proportional to the changes rather than to every job listed.
+         *
+         * Events older (by timestamp) than the last one applied are ignored, since QoS 1 delivery may reorder
+         * them. Thread-safe.
+         */
+        class AWS_IOTJOBS_API JobExecutionsTracker final
+        {
+          public:
+            JobExecutionsTracker() noexcept;
+            JobExecutionsTracker(const JobExecutionsTracker &) = delete;
+            JobExecutionsTracker(JobExecutionsTracker &&) = delete;
+            JobExecutionsTracker &operator=(const JobExecutionsTracker &) = delete;
+            JobExecutionsTracker &operator=(JobExecutionsTracker &&) = delete;
+
+            /**
+             * Replaces the tracked table with the one in `event`.
+             *
+             * @return how the table changed; empty for a stale or unchanged event.
+             */
+            Crt::Vector<JobExecutionChange> Apply(const JobExecutionsChangedEvent &event);
+
+            /**
+             * @return the tracked summary of `jobId`, and its status in `status`, or null if it is not listed.
+             * The pointer is valid until the next Apply or Reset.
+             */
+            const JobExecutionSummary *Find(const Crt::String &jobId, JobStatus &status) const;
+
+            size_t GetExecutionCount() const;
+
+            /**
+             * Forgets the table, e.g. before seeding it again from a GetPendingJobExecutions response.
+             */
+            void Reset();
+
+            /**
+             * Adapts `onChanges` into a JobExecutionsChanged subscription handler that applies every event
+             * to `tracker`. Errors are forwarded with no changes; stale and unchanged events are not.
+             */
+            static OnSubscribeToJobExecutionsChangedEventsResponse Adapt(
+                const std::shared_ptr<JobExecutionsTracker> &tracker,
+                OnJobExecutionChanges &&onChanges);
+
+          private:
+            struct Tracked
+            {
+                JobStatus Status;
+                JobExecutionSummary Summary;
+                uint64_t Generation;
+            };
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, Tracked> m_executions;
+            uint64_t m_generation;
+            Iotdevicecommon::PackedDateTime m_lastTimestamp;
+        };
+
+    } // namespace Iotjobs
+} // namespace Aws
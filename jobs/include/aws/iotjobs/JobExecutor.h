@@ -0,0 +1,260 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobExecutionData.h>
+#include <aws/iotjobs/JobStatus.h>
+#include <aws/iotjobs/JobsRequestCorrelator.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+
+#include <aws/iotdevicecommon/FlatStringMap.h>
+#include <aws/iotdevicecommon/HandlerExecutor.h>
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        class WorkStealingExecutor;
+    }
+
+    namespace Iotjobs
+    {
+        class JobExecutor;
+
+        class AWS_IOTJOBS_API JobExecutorConfig final
+        {
+          public:
+            JobExecutorConfig() noexcept;
+            JobExecutorConfig(const JobExecutorConfig &rhs) = default;
+            JobExecutorConfig(JobExecutorConfig &&rhs) = default;
+
+            JobExecutorConfig &operator=(const JobExecutorConfig &rhs) = default;
+            JobExecutorConfig &operator=(JobExecutorConfig &&rhs) = default;
+
+            ~JobExecutorConfig() = default;
+
+            /**
+             * The most job executions run at once.
+             */
+            size_t MaxConcurrentJobs;
+
+            /**
+             * The top-level string field of a job document that names the job's type, e.g. "operation".
+             */
+            Crt::String JobTypeField;
+
+            /**
+             * The priority of each job type; higher runs first. Jobs of equal priority run in queue order.
+             */
+            Crt::Map<Crt::String, int32_t> PriorityByJobType;
+
+            /**
+             * The priority of job types not in PriorityByJobType, and of documents without a type.
+             */
+            int32_t DefaultPriority;
+
+            /**
+             * Runs the job handlers, with the job id as ordering key. Null gives the executor a
+             * WorkStealingExecutor of its own with MaxConcurrentJobs threads.
+             */
+            Iotdevicecommon::HandlerExecutor Executor;
+
+            /**
+             * The QoS used for the JobExecutionsChanged subscription.
+             */
+            Crt::Mqtt::QOS Qos;
+        };
+
+        /**
+         * One job execution being run by a JobExecutor. Status updates are published strictly one after
+         * another, in the order they were made, whichever threads make them.
+         */
+        class AWS_IOTJOBS_API JobRun final : public std::enable_shared_from_this<JobRun>
+        {
+          public:
+            JobRun(const JobRun &) = delete;
+            JobRun(JobRun &&) = delete;
+            JobRun &operator=(const JobRun &) = delete;
+            JobRun &operator=(JobRun &&) = delete;
+
+            ~JobRun() = default;
+
+            const Crt::String &GetJobId() const noexcept { return m_jobId; }
+            const Crt::String &GetJobType() const noexcept { return m_jobType; }
+
+            /**
+             * @return the execution as described when it was taken from the queue, without its document.
+             */
+            const JobExecutionData &GetExecution() const noexcept { return m_execution; }
+            const std::shared_ptr<const Crt::JsonObject> &GetDocument() const noexcept { return m_document; }
+
+            /**
+             * Publishes an IN_PROGRESS update with `statusDetails` once the updates before it completed.
+             *
+             * @return false, with AWS_ERROR_INVALID_STATE raised, once Complete() was called.
+             */
+            bool ReportProgress(
+                const Iotdevicecommon::FlatStringMap &statusDetails,
+                const OnUpdateJobExecutionComplete &onComplete = nullptr);
+
+            /**
+             * Publishes the terminal `status` once the updates before it completed, then frees the run's slot.
+             * If the update fails locally, e.g. on a timeout, the slot stays taken and Complete() may be called
+             * again; a rejection by the service ends the run all the same.
+             *
+             * @return false, with AWS_ERROR_INVALID_STATE raised, if Complete() was called already.
+             */
+            bool Complete(
+                JobStatus status,
+                const Iotdevicecommon::FlatStringMap &statusDetails,
+                const OnUpdateJobExecutionComplete &onComplete = nullptr);
+
+          private:
+            friend class JobExecutor;
+
+            enum class UpdateKind
+            {
+                Start,
+                Progress,
+                Terminal,
+            };
+
+            struct Update
+            {
+                UpdateKind Kind;
+                UpdateJobExecutionRequest Request;
+                OnUpdateJobExecutionComplete OnComplete;
+            };
+
+            JobRun(
+                const std::shared_ptr<JobExecutor> &executor,
+                const std::shared_ptr<JobsRequestCorrelator> &correlator,
+                JobExecutionData &&execution,
+                const std::shared_ptr<const Crt::JsonObject> &document,
+                const Crt::String &jobType,
+                Crt::Allocator *allocator) noexcept;
+
+            bool Enqueue(
+                UpdateKind kind,
+                JobStatus status,
+                const Iotdevicecommon::FlatStringMap *statusDetails,
+                const OnUpdateJobExecutionComplete &onComplete);
+            void SendFront();
+            void OnUpdated(UpdateJobExecutionResponse *response, RejectedError *error, int ioErr);
+
+            std::weak_ptr<JobExecutor> m_executor;
+            std::shared_ptr<JobsRequestCorrelator> m_correlator;
+            JobExecutionData m_execution;
+            Crt::String m_jobId;
+            Crt::String m_jobType;
+            std::shared_ptr<const Crt::JsonObject> m_document;
+            Crt::Allocator *m_allocator;
+
+            std::mutex m_lock;
+            /* The front update is in flight while m_sending is set. */
+            Crt::List<Update> m_updates;
+            bool m_sending;
+            bool m_completed;
+        };
+
+        /**
+         * Invoked on the executor for every job run. The handler may finish the job before it returns or
+         * later from any thread, but must eventually call JobRun::Complete().
+         */
+        using OnRunJob = std::function<void(const std::shared_ptr<JobRun> &run)>;
+
+        /**
+         * Runs the pending job executions of a thing several at a time.
+         *
+         * Poll() lists the pending executions and describes each one not yet known, with its document. The
+         * described jobs wait in a ready list ordered by the priority of their type and then by queue order;
+         * while fewer than MaxConcurrentJobs run, the first is moved to IN_PROGRESS and, once the service
+         * accepted that, handed to onRunJob on the executor. Executions already IN_PROGRESS when listed, e.g.
+         * after a restart, are resumed without that update. Each completed run polls again, as does every
+         * JobExecutionsChanged event once Subscribe() was called.
+         *
+         * Requests go through a correlator that has been subscribed already.
+         */
+        class AWS_IOTJOBS_API JobExecutor final : public std::enable_shared_from_this<JobExecutor>
+        {
+          public:
+            JobExecutor(const JobExecutor &) = delete;
+            JobExecutor(JobExecutor &&) = delete;
+            JobExecutor &operator=(const JobExecutor &) = delete;
+            JobExecutor &operator=(JobExecutor &&) = delete;
+
+            ~JobExecutor() = default;
+
+            /**
+             * Subscribes to the thing's JobExecutionsChanged events, polling on each.
+             */
+            bool Subscribe(const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Requests the pending executions and queues those not yet known.
+             */
+            bool Poll();
+
+            size_t GetRunningCount() const;
+            size_t GetReadyCount() const;
+
+            static std::shared_ptr<JobExecutor> Create(
+                const IotJobsClient &client,
+                const std::shared_ptr<JobsRequestCorrelator> &correlator,
+                const Crt::String &thingName,
+                const JobExecutorConfig &config,
+                const OnRunJob &onRunJob,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            friend class JobRun;
+
+            /* Higher priorities first, then queue order. */
+            using ReadyKey = std::pair<int32_t, uint64_t>;
+
+            struct ReadyJob
+            {
+                JobExecutionData Execution;
+                std::shared_ptr<const Crt::JsonObject> Document;
+                Crt::String JobType;
+                bool Resumed;
+            };
+
+            JobExecutor(
+                const IotJobsClient &client,
+                const std::shared_ptr<JobsRequestCorrelator> &correlator,
+                const Crt::String &thingName,
+                const JobExecutorConfig &config,
+                const OnRunJob &onRunJob,
+                Crt::Allocator *allocator) noexcept;
+
+            void Describe(const Crt::String &jobId, uint64_t sequence, bool resumed);
+            void Pump();
+            void Run(const std::shared_ptr<JobRun> &run);
+            void Finish(const Crt::String &jobId, bool poll);
+            int32_t PriorityOf(const Crt::String &jobType) const;
+
+            IotJobsClient m_client;
+            std::shared_ptr<JobsRequestCorrelator> m_correlator;
+            Crt::String m_thingName;
+            JobExecutorConfig m_config;
+            OnRunJob m_onRunJob;
+            Crt::Allocator *m_allocator;
+            std::shared_ptr<Iotdevicecommon::WorkStealingExecutor> m_ownedPool;
+
+            mutable std::mutex m_lock;
+            /* Every job id being described, ready or running, so that a poll queues each job once. */
+            Crt::Map<Crt::String, bool> m_known;
+            Crt::Map<ReadyKey, ReadyJob> m_ready;
+            Crt::Map<Crt::String, std::shared_ptr<JobRun>> m_running;
+            uint64_t m_nextSequence;
+        };
+
+    } // namespace Iotjobs
+
+} // namespace Aws
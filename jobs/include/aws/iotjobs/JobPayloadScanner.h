@@ -0,0 +1,34 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Types.h>
+
+#include <aws/iotjobs/Exports.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * Locates members of a raw JSON jobs payload without parsing it into a document. See
+         * Iotdevicecommon::JsonPayloadScanner, which does the scanning, for the lifetime of the returned cursors.
+         */
+        namespace JobPayloadScanner
+        {
+            /**
+             * Same as Iotdevicecommon::JsonPayloadScanner::FindMember.
+             */
+            bool AWS_IOTJOBS_API
+                FindMember(const Crt::ByteCursor &object, const char *key, Crt::ByteCursor &value) noexcept;
+
+            /**
+             * Finds `execution.jobDocument` in a notify-next event or a describe/start-next accepted response.
+             */
+            bool AWS_IOTJOBS_API FindJobDocument(const Crt::ByteCursor &payload, Crt::ByteCursor &jobDocument) noexcept;
+        } // namespace JobPayloadScanner
+
+    } // namespace Iotjobs
+} // namespace Aws
@@ -0,0 +1,123 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobDocumentCache.h>
+#include <aws/iotjobs/JobsRequestCorrelator.h>
+#include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * Hands the next job to the agent: `execution` carries its id, version and status details, `document`
+         * the job document already decoded.
+         */
+        using OnNextJobReady = std::function<
+            void(const JobExecutionData &execution, const std::shared_ptr<const Crt::JsonObject> &document)>;
+
+        /**
+         * Fetches the next job while the current one still runs, so that it can start the moment the current
+         * one completes.
+         *
+         * PrefetchNext(), called once the current job started, lists the thing's pending executions and
+         * describes the one StartNextPendingJobExecution would return next, with its document, into the
+         * JobDocumentCache. StartNext(), called once the current job reached its terminal status, then hands
+         * that job to onReady at once and starts it on the service in the background, instead of leaving the
+         * agent idle for the StartNext round trip. Without a prefetched job, onReady is invoked when the
+         * StartNext response arrives.
+         *
+         * The queue may change between the two calls, e.g. when the prefetched job is cancelled. If the
+         * StartNext response names another job than the one handed out early, onReady is invoked again with
+         * the job actually started; abandon the first one then. Requests go through a correlator that has
+         * been subscribed already.
+         */
+        class AWS_IOTJOBS_API JobPrefetcher final : public std::enable_shared_from_this<JobPrefetcher>
+        {
+          public:
+            JobPrefetcher(const JobPrefetcher &) = delete;
+            JobPrefetcher(JobPrefetcher &&) = delete;
+            JobPrefetcher &operator=(const JobPrefetcher &) = delete;
+            JobPrefetcher &operator=(JobPrefetcher &&) = delete;
+
+            ~JobPrefetcher() = default;
+
+            /**
+             * Prefetches the job to run after `currentJobId`, replacing any earlier prefetch. Finding no other
+             * pending job, or failing to fetch it, only means StartNext() waits for the service as usual.
+             *
+             * @return false if the pending executions could not be requested.
+             */
+            bool PrefetchNext(const Crt::String &currentJobId);
+
+            /**
+             * Starts the next pending job execution, handing it to onReady as described above. onComplete, if
+             * set, receives the StartNext outcome as from JobsRequestCorrelator; onReady is not invoked for a
+             * response without an execution, i.e. when no job is pending.
+             *
+             * @return false if the request could not be issued. A job handed out early stays valid then; retry
+             * StartNext(), which does not hand it out again, to move it to IN_PROGRESS on the service. The same
+             * holds when onComplete reports a local failure or timeout.
+             */
+            bool StartNext(
+                const StartNextPendingJobExecutionRequest &request,
+                const OnNextJobReady &onReady,
+                const OnStartNextPendingJobExecutionComplete &onComplete = nullptr);
+
+            /**
+             * @return the id of the job currently prefetched, if any.
+             */
+            Crt::Optional<Crt::String> GetPrefetchedJobId() const;
+
+            /**
+             * @return how many StartNext() calls handed out a prefetched job that the service then started.
+             */
+            uint64_t GetHitCount() const noexcept { return m_hitCount.load(); }
+
+            /**
+             * @return how many StartNext() calls found no prefetched job, or one other than the job started.
+             */
+            uint64_t GetMissCount() const noexcept { return m_missCount.load(); }
+
+            /**
+             * @param cache the cache documents are decoded into; null gives the prefetcher one of its own.
+             */
+            static std::shared_ptr<JobPrefetcher> Create(
+                const std::shared_ptr<JobsRequestCorrelator> &correlator,
+                const std::shared_ptr<JobDocumentCache> &cache = nullptr,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            JobPrefetcher(
+                const std::shared_ptr<JobsRequestCorrelator> &correlator,
+                const std::shared_ptr<JobDocumentCache> &cache,
+                Crt::Allocator *allocator) noexcept;
+
+            void Describe(const Crt::String &jobId, uint64_t generation);
+
+            std::shared_ptr<JobsRequestCorrelator> m_correlator;
+            std::shared_ptr<JobDocumentCache> m_cache;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            /* Bumped by every PrefetchNext() and StartNext(), so that responses to an older prefetch are dropped. */
+            uint64_t m_generation;
+            Crt::Optional<JobExecutionData> m_prefetched;
+            std::shared_ptr<const Crt::JsonObject> m_prefetchedDocument;
+            /* The job given to onReady ahead of the StartNext response that has not arrived yet. */
+            Crt::Optional<Crt::String> m_handedOut;
+
+            std::atomic<uint64_t> m_hitCount;
+            std::atomic<uint64_t> m_missCount;
+        };
+
+    } // namespace Iotjobs
+
+} // namespace Aws
@@ -0,0 +1,133 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/IotJobsClient.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/iotdevicecommon/IdHashMap.h>
+#include <aws/iotdevicecommon/ThingRegistry.h>
+
+#include <aws/common/task_scheduler.h>
+
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        class AWS_IOTJOBS_API JobProgressReporterConfig final
+        {
+          public:
+            JobProgressReporterConfig() noexcept;
+            JobProgressReporterConfig(const JobProgressReporterConfig &rhs) = default;
+            JobProgressReporterConfig(JobProgressReporterConfig &&rhs) = default;
+
+            JobProgressReporterConfig &operator=(const JobProgressReporterConfig &rhs) = default;
+            JobProgressReporterConfig &operator=(JobProgressReporterConfig &&rhs) = default;
+
+            ~JobProgressReporterConfig() = default;
+
+            /**
+             * The least time, in milliseconds, between two progress updates published for one job execution.
+             */
+            uint32_t MinReportIntervalMs;
+
+            /**
+             * The QoS used for the update publishes.
+             */
+            Crt::Mqtt::QOS Qos;
+
+            /**
+             * Interns the thing names and job ids executions are keyed by. A job targets many things, so a
+             * gateway stores each job id once however many of its things run it. Null gives the reporter a
+             * registry of its own.
+             */
+            std::shared_ptr<Iotdevicecommon::ThingRegistry> Registry;
+        };
+
+        /**
+         * Opt-in layer over IotJobsClient::PublishUpdateJobExecution that limits how often progress is
+         * reported for each job execution.
+         *
+         * Progress updates (status IN_PROGRESS, or none) published within MinReportIntervalMs of the previous
+         * update for the same thing and job are held back, each replacing the one before it, and the latest is
+         * published once the interval has passed. Any other status is terminal or otherwise significant and is
+         * published at once, replacing whatever progress was still held back. Every caller's completion
+         * handler is invoked with the result of the publish that superseded or carried its update.
+         *
+         * A held-back update never reached the service, so the execution's version did not move: an update that
+         * replaces it is published with the ExpectedVersion of the oldest update it replaced, when that one had
+         * an ExpectedVersion. Anything still held back when the reporter is destroyed is published immediately.
+         */
+        class AWS_IOTJOBS_API JobProgressReporter final : public std::enable_shared_from_this<JobProgressReporter>
+        {
+          public:
+            ~JobProgressReporter();
+
+            JobProgressReporter(const JobProgressReporter &) = delete;
+            JobProgressReporter(JobProgressReporter &&) = delete;
+            JobProgressReporter &operator=(const JobProgressReporter &) = delete;
+            JobProgressReporter &operator=(JobProgressReporter &&) = delete;
+
+            /**
+             * Publishes or holds back an update. ThingName and JobId must be set. Publish failures are reported
+             * through `onPubAck`.
+             *
+             * @return false, with AWS_ERROR_INVALID_ARGUMENT raised, if the request lacks a thing name or job id.
+             */
+            bool ReportProgress(const UpdateJobExecutionRequest &request, const OnPublishComplete &onPubAck);
+
+            /**
+             * Publishes every held-back update now.
+             */
+            void Flush();
+
+            static std::shared_ptr<JobProgressReporter> Create(
+                const IotJobsClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const JobProgressReporterConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Execution
+            {
+                uint64_t LastPublishNs = 0;
+                bool FlushScheduled = false;
+                Crt::Optional<UpdateJobExecutionRequest> Pending;
+                Crt::Vector<OnPublishComplete> Callbacks;
+            };
+
+            JobProgressReporter(
+                const IotJobsClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const JobProgressReporterConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            uint64_t Now() const;
+            void ScheduleFlush(uint64_t key, uint64_t dueNs);
+            void FlushExecution(uint64_t key);
+            void Publish(const UpdateJobExecutionRequest &request, Crt::Vector<OnPublishComplete> &&callbacks);
+
+            static void s_onFlushTask(aws_task *task, void *arg, aws_task_status status);
+
+            IotJobsClient m_client;
+            JobProgressReporterConfig m_config;
+            Crt::Allocator *m_allocator;
+            aws_event_loop *m_eventLoop;
+
+            std::mutex m_lock;
+            std::shared_ptr<Iotdevicecommon::ThingRegistry> m_registry;
+            /* Keyed by ThingRegistry::PairKey of the thing and job ids. */
+            Iotdevicecommon::IdHashMap<Execution> m_executions;
+        };
+
+    } // namespace Iotjobs
+
+} // namespace Aws
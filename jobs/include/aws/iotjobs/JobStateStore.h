@@ -0,0 +1,128 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/GetPendingJobExecutionsResponse.h>
+#include <aws/iotjobs/JobExecutionData.h>
+#include <aws/iotjobs/JobExecutionState.h>
+#include <aws/iotjobs/JobStatus.h>
+
+#include <aws/iotjobs/Exports.h>
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/StlAllocator.h>
+#include <aws/iotdevicecommon/FlatStringMap.h>
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * Optional on-disk record of a job agent's executions, so that a restarted agent resumes from its last
+         * known state straight away and reconciles with the service (GetPendingJobExecutions, then Describe
+         * where versions differ) in the background, instead of before doing any work.
+         *
+         * The file is an append-only log of one compact JSON record per line. Each change appends a record and
+         * flushes it; a torn last line from a crash is skipped on the next Open, which also compacts the log
+         * once superseded records outnumber live ones. Executions that reach a terminal status are forgotten.
+         * Thread-safe.
+         */
+        class AWS_IOTJOBS_API JobStateStore final
+        {
+          public:
+            /**
+             * What is kept of one execution.
+             */
+            struct AWS_IOTJOBS_API Execution
+            {
+                Crt::String ThingName;
+                Crt::String JobId;
+                JobStatus Status = JobStatus::QUEUED;
+                Crt::Optional<int32_t> VersionNumber;
+                Crt::Optional<int64_t> ExecutionNumber;
+                Crt::Optional<Iotdevicecommon::FlatStringMap> StatusDetails;
+            };
+
+            ~JobStateStore();
+            JobStateStore(const JobStateStore &) = delete;
+            JobStateStore(JobStateStore &&) = delete;
+            JobStateStore &operator=(const JobStateStore &) = delete;
+            JobStateStore &operator=(JobStateStore &&) = delete;
+
+            /**
+             * Loads the store at `path`, creating it if it does not exist.
+             *
+             * @return null, with the error raised, if the file cannot be opened.
+             */
+            static std::shared_ptr<JobStateStore> Open(
+                const char *path,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+            /**
+             * Records an execution's state, or forgets it if the status is terminal.
+             *
+             * @return false, with the error raised, if the record could not be written.
+             */
+            bool Record(const Execution &execution);
+
+            /**
+             * Records an execution from a Describe or StartNext response, or a notify-next event.
+             */
+            bool Record(const JobExecutionData &execution);
+
+            /**
+             * Records the execution state returned by an update of `jobId`.
+             */
+            bool Record(const Crt::String &thingName, const Crt::String &jobId, const JobExecutionState &state);
+
+            bool Remove(const Crt::String &thingName, const Crt::String &jobId);
+
+            /**
+             * @return every recorded execution, ordered by thing name and job id.
+             */
+            Crt::Vector<Execution> GetExecutions() const;
+
+            /**
+             * Brings `thingName`'s executions in line with a GetPendingJobExecutions response: executions it
+             * no longer lists are forgotten, and listed ones take its status, version and execution number.
+             * Status details are kept, since the response does not carry them.
+             *
+             * @return the ids of listed jobs whose recorded version differed, which need describing.
+             */
+            Crt::Vector<Crt::String> Reconcile(
+                const Crt::String &thingName,
+                const GetPendingJobExecutionsResponse &response);
+
+            /**
+             * Rewrites the log with only the live records.
+             */
+            bool Compact();
+
+          private:
+            explicit JobStateStore(const char *path) noexcept;
+
+            bool Load();
+            bool Append(const Crt::JsonObject &record);
+            bool RecordLocked(const Execution &execution);
+            bool RemoveLocked(const Crt::String &thingName, const Crt::String &jobId);
+            bool CompactLocked();
+            void CompactIfBloated();
+
+            static Crt::String s_key(const Crt::String &thingName, const Crt::String &jobId);
+
+            Crt::String m_path;
+
+            mutable std::mutex m_lock;
+            FILE *m_file;
+            size_t m_recordCount;
+            Crt::Map<Crt::String, Execution> m_executions;
+        };
+
+    } // namespace Iotjobs
+} // namespace Aws
@@ -0,0 +1,81 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/Awaitable.h>
+
+#ifdef AWS_IOTDEVICECOMMON_COROUTINES
+
+#    include <aws/iotjobs/DescribeJobExecutionRequest.h>
+#    include <aws/iotjobs/DescribeJobExecutionResponse.h>
+#    include <aws/iotjobs/GetPendingJobExecutionsRequest.h>
+#    include <aws/iotjobs/GetPendingJobExecutionsResponse.h>
+#    include <aws/iotjobs/JobsRequestCorrelator.h>
+#    include <aws/iotjobs/RejectedError.h>
+#    include <aws/iotjobs/StartNextJobExecutionResponse.h>
+#    include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
+#    include <aws/iotjobs/UpdateJobExecutionRequest.h>
+#    include <aws/iotjobs/UpdateJobExecutionResponse.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * co_await-able forms of the JobsRequestCorrelator requests (C++20 only). See Iotdevicecommon
+         * Awaitable.h for where the coroutine resumes.
+         */
+        inline Iotdevicecommon::OperationAwaiter<
+            Iotdevicecommon::ResponseResult<UpdateJobExecutionResponse, RejectedError>>
+            AwaitUpdateJobExecution(
+                const std::shared_ptr<JobsRequestCorrelator> &correlator,
+                const UpdateJobExecutionRequest &request)
+        {
+            return Iotdevicecommon::AwaitResponse<UpdateJobExecutionResponse, RejectedError>(
+                [correlator, request](OnUpdateJobExecutionComplete &&onComplete) {
+                    return correlator->UpdateJobExecutionAsync(request, onComplete);
+                });
+        }
+
+        inline Iotdevicecommon::OperationAwaiter<
+            Iotdevicecommon::ResponseResult<DescribeJobExecutionResponse, RejectedError>>
+            AwaitDescribeJobExecution(
+                const std::shared_ptr<JobsRequestCorrelator> &correlator,
+                const DescribeJobExecutionRequest &request)
+        {
+            return Iotdevicecommon::AwaitResponse<DescribeJobExecutionResponse, RejectedError>(
+                [correlator, request](OnDescribeJobExecutionComplete &&onComplete) {
+                    return correlator->DescribeJobExecutionAsync(request, onComplete);
+                });
+        }
+
+        inline Iotdevicecommon::OperationAwaiter<
+            Iotdevicecommon::ResponseResult<GetPendingJobExecutionsResponse, RejectedError>>
+            AwaitGetPendingJobExecutions(
+                const std::shared_ptr<JobsRequestCorrelator> &correlator,
+                const GetPendingJobExecutionsRequest &request)
+        {
+            return Iotdevicecommon::AwaitResponse<GetPendingJobExecutionsResponse, RejectedError>(
+                [correlator, request](OnGetPendingJobExecutionsComplete &&onComplete) {
+                    return correlator->GetPendingJobExecutionsAsync(request, onComplete);
+                });
+        }
+
+        inline Iotdevicecommon::OperationAwaiter<
+            Iotdevicecommon::ResponseResult<StartNextJobExecutionResponse, RejectedError>>
+            AwaitStartNextPendingJobExecution(
+                const std::shared_ptr<JobsRequestCorrelator> &correlator,
+                const StartNextPendingJobExecutionRequest &request)
+        {
+            return Iotdevicecommon::AwaitResponse<StartNextJobExecutionResponse, RejectedError>(
+                [correlator, request](OnStartNextPendingJobExecutionComplete &&onComplete) {
+                    return correlator->StartNextPendingJobExecutionAsync(request, onComplete);
+                });
+        }
+
+    } // namespace Iotjobs
+} // namespace Aws
+
+#endif // AWS_IOTDEVICECOMMON_COROUTINES
@@ -0,0 +1,31 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobsRequestCorrelator.h>
+
+#include <aws/iotdevicecommon/LazySubscriptions.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * The jobs correlators of a gateway's things, each subscribed to its request responses on first use and
+         * unsubscribed once idle with nothing queued or in flight. `config.Timers`, if unset, is set to `timers`,
+         * so the request timeouts share the wheel.
+         */
+        using JobsCorrelatorPool = Iotdevicecommon::LazySubscriptions<JobsRequestCorrelator>;
+
+        AWS_IOTJOBS_API std::shared_ptr<JobsCorrelatorPool> CreateJobsCorrelatorPool(
+            const IotJobsClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const JobsRequestCorrelatorConfig &config,
+            const std::shared_ptr<Iotdevicecommon::TimerWheel> &timers,
+            uint32_t idleTtlMs,
+            Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+    } // namespace Iotjobs
+} // namespace Aws
@@ -0,0 +1,213 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/IotJobsClient.h>
+
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/iotdevicecommon/TimerWheel.h>
+
+#include <aws/common/task_scheduler.h>
+
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * Completion callbacks for correlated jobs requests. Exactly one of `response` (accepted) or `error`
+         * (rejected) is set on success; both are null when the request failed locally or timed out, with
+         * the reason in ioErr.
+         */
+        using OnUpdateJobExecutionComplete =
+            std::function<void(Aws::Iotjobs::UpdateJobExecutionResponse *, Aws::Iotjobs::RejectedError *, int ioErr)>;
+        using OnDescribeJobExecutionComplete =
+            std::function<void(Aws::Iotjobs::DescribeJobExecutionResponse *, Aws::Iotjobs::RejectedError *, int ioErr)>;
+        using OnGetPendingJobExecutionsComplete = std::function<
+            void(Aws::Iotjobs::GetPendingJobExecutionsResponse *, Aws::Iotjobs::RejectedError *, int ioErr)>;
+        using OnStartNextPendingJobExecutionComplete = std::function<
+            void(Aws::Iotjobs::StartNextJobExecutionResponse *, Aws::Iotjobs::RejectedError *, int ioErr)>;
+
+        class AWS_IOTJOBS_API JobsRequestCorrelatorConfig final
+        {
+          public:
+            JobsRequestCorrelatorConfig() noexcept;
+            JobsRequestCorrelatorConfig(const JobsRequestCorrelatorConfig &rhs) = default;
+            JobsRequestCorrelatorConfig(JobsRequestCorrelatorConfig &&rhs) = default;
+
+            JobsRequestCorrelatorConfig &operator=(const JobsRequestCorrelatorConfig &rhs) = default;
+            JobsRequestCorrelatorConfig &operator=(JobsRequestCorrelatorConfig &&rhs) = default;
+
+            ~JobsRequestCorrelatorConfig() = default;
+
+            /**
+             * Maximum number of requests awaiting a response at once. Further requests are queued in order.
+             */
+            size_t MaxInFlight;
+
+            /**
+             * Time, in milliseconds, to wait for an accepted/rejected response before completing the request
+             * with AWS_ERROR_MQTT_TIMEOUT. Zero disables the timeout.
+             */
+            uint32_t RequestTimeoutMs;
+
+            /**
+             * The QoS used for subscriptions and request publishes.
+             */
+            Crt::Mqtt::QOS Qos;
+
+            /**
+             * Whether a describe or get-pending request identical to one already queued or in flight joins it
+             * instead of being sent, completing with a copy of its response. Only requests without a
+             * caller-set ClientToken are shared. Defaults to true.
+             */
+            bool ShareIdenticalRequests;
+
+            /**
+             * If set, the request timeouts are kept in this wheel, shared with the client's other components,
+             * and cancelled as responses arrive, instead of scheduling a task per request.
+             */
+            std::shared_ptr<Iotdevicecommon::TimerWheel> Timers;
+        };
+
+        /**
+         * Asynchronous, ClientToken-correlated request API over IotJobsClient for one thing.
+         *
+         * Responses for every job are received through wildcard ("+" job id) subscriptions, so progress for
+         * several job executions can be reported concurrently without waiting on each other.
+         * Call Subscribe() once before issuing requests.
+         */
+        class AWS_IOTJOBS_API JobsRequestCorrelator final : public std::enable_shared_from_this<JobsRequestCorrelator>
+        {
+          public:
+            JobsRequestCorrelator(const JobsRequestCorrelator &) = delete;
+            JobsRequestCorrelator(JobsRequestCorrelator &&) = delete;
+            JobsRequestCorrelator &operator=(const JobsRequestCorrelator &) = delete;
+            JobsRequestCorrelator &operator=(JobsRequestCorrelator &&) = delete;
+
+            ~JobsRequestCorrelator() = default;
+
+            /**
+             * Subscribes to the accepted and rejected topics of all four request types. onSubAck is invoked
+             * once, after all subscriptions complete, with the first error encountered (if any).
+             */
+            bool Subscribe(const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Each request gets a generated ClientToken unless one is already set. ThingName defaults to
+             * the correlator's thing. Returns false, with AWS_ERROR_LIST_EXCEEDS_MAX_SIZE raised, when the
+             * client's MemoryBudget has no room for another pending request.
+             *
+             * With ShareIdenticalRequests, describe and get-pending requests are single-flight: one for the
+             * same job execution, or for the thing's pending list, issued while another is queued or in flight
+             * sends nothing and takes no budget, and completes along with it.
+             */
+            bool UpdateJobExecutionAsync(
+                const UpdateJobExecutionRequest &request,
+                const OnUpdateJobExecutionComplete &onComplete);
+            bool DescribeJobExecutionAsync(
+                const DescribeJobExecutionRequest &request,
+                const OnDescribeJobExecutionComplete &onComplete);
+            bool GetPendingJobExecutionsAsync(
+                const GetPendingJobExecutionsRequest &request,
+                const OnGetPendingJobExecutionsComplete &onComplete);
+            bool StartNextPendingJobExecutionAsync(
+                const StartNextPendingJobExecutionRequest &request,
+                const OnStartNextPendingJobExecutionComplete &onComplete);
+
+            /**
+             * Completes every queued and in-flight request with errorCode, e.g. after the connection was lost.
+             */
+            void CancelAll(int errorCode);
+
+            size_t GetInFlightCount() const;
+            size_t GetQueuedCount() const;
+
+            static std::shared_ptr<JobsRequestCorrelator> Create(
+                const IotJobsClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const JobsRequestCorrelatorConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            enum class RequestKind
+            {
+                UpdateJobExecution,
+                DescribeJobExecution,
+                GetPendingJobExecutions,
+                StartNextPendingJobExecution,
+            };
+
+            using PublishRequest = std::function<bool(const OnPublishComplete &onPubAck)>;
+            using CompleteRequest = std::function<void(void *response, RejectedError *error, int ioErr)>;
+
+            struct PendingRequest
+            {
+                Crt::String ClientToken;
+                RequestKind Kind;
+                PublishRequest Publish;
+                CompleteRequest OnComplete;
+                /* What identical requests share this one by, or empty if it is not shared. */
+                Crt::String FlightKey;
+                /* OnComplete for a request joining another, handing it copies of the shared response. */
+                CompleteRequest OnJoinedComplete;
+                /* The OnJoinedComplete of each request that joined this one. */
+                Crt::Vector<CompleteRequest> Joined;
+                /* Pending-request share of the client's MemoryBudget, released with the request. */
+                Iotdevicecommon::MemoryBudget::Slot BudgetSlot;
+                /* The request's timer in the config's Timers, or 0. */
+                uint64_t TimeoutId = 0;
+            };
+
+            JobsRequestCorrelator(
+                const IotJobsClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const JobsRequestCorrelatorConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            template <typename Response>
+            std::function<void(Response *, int)> MakeAcceptedHandler(RequestKind kind);
+            std::function<void(RejectedError *, int)> MakeRejectedHandler(RequestKind kind);
+
+            bool Submit(PendingRequest &&request);
+            void Pump();
+            bool Take(const Crt::String &clientToken, const RequestKind *kind, PendingRequest &request);
+            void Complete(
+                const Crt::String &clientToken,
+                RequestKind kind,
+                void *response,
+                RejectedError *error,
+                int ioErr);
+            void Fail(const Crt::String &clientToken, int ioErr);
+            bool Join(PendingRequest &request);
+            void ScheduleTimeout(const Crt::String &clientToken);
+            void CancelTimeout(const PendingRequest &request);
+
+            static void s_onTimeoutTask(aws_task *task, void *arg, aws_task_status status);
+            /* Completes the request and every request that joined it. */
+            static void s_completeRequest(PendingRequest &request, void *response, RejectedError *error, int ioErr);
+
+            IotJobsClient m_client;
+            Crt::String m_thingName;
+            JobsRequestCorrelatorConfig m_config;
+            Crt::Allocator *m_allocator;
+            aws_event_loop *m_eventLoop;
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, PendingRequest> m_inFlight;
+            Crt::List<PendingRequest> m_queued;
+            /* The ClientToken of the queued or in-flight request of each FlightKey. */
+            Crt::Map<Crt::String, Crt::String> m_flights;
+        };
+
+    } // namespace Iotjobs
+
+} // namespace Aws
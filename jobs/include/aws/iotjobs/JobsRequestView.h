@@ -0,0 +1,46 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotjobs/Exports.h>
+
+#include <aws/crt/Optional.h>
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/PayloadWriter.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * A DescribeJobExecutionRequest that references the caller's strings instead of copying them, for the
+         * PublishDescribeJobExecution overload. The strings only need to stay valid for the call; an empty
+         * ClientToken is left out of the payload.
+         */
+        struct AWS_IOTJOBS_API DescribeJobExecutionRequestView
+        {
+            Crt::ByteCursor ThingName;
+            Crt::ByteCursor JobId;
+            Crt::ByteCursor ClientToken;
+            Aws::Crt::Optional<int64_t> ExecutionNumber;
+            Aws::Crt::Optional<bool> IncludeJobDocument;
+
+            void SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const;
+        };
+
+        /**
+         * The same view of a GetPendingJobExecutionsRequest, for the PublishGetPendingJobExecutions overload.
+         */
+        struct AWS_IOTJOBS_API GetPendingJobExecutionsRequestView
+        {
+            Crt::ByteCursor ThingName;
+            Crt::ByteCursor ClientToken;
+
+            void SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const;
+        };
+
+    } // namespace Iotjobs
+} // namespace Aws
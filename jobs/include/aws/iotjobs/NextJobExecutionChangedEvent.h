@@ -3,7 +3,7 @@
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0.
  */
-#include <aws/crt/DateTime.h>
+#include <aws/iotdevicecommon/PackedDateTime.h>
 #include <aws/iotjobs/JobExecutionData.h>
 
 #include <aws/iotjobs/Exports.h>
@@ -24,10 +24,16 @@ namespace Aws
             NextJobExecutionChangedEvent(const Crt::JsonView &doc);
             NextJobExecutionChangedEvent &operator=(const Crt::JsonView &doc);
 
+            /**
+             * Decodes `doc` into this object in place, as a reusable per-subscription instance: fields absent
+             * from `doc` are reset, and containers keep the capacity they already hold.
+             */
+            void Reload(const Crt::JsonView &doc);
+
             void SerializeToObject(Crt::JsonObject &doc) const;
 
             Aws::Crt::Optional<Aws::Iotjobs::JobExecutionData> Execution;
-            Aws::Crt::Optional<Aws::Crt::DateTime> Timestamp;
+            Aws::Iotdevicecommon::PackedDateTime Timestamp;
 
           private:
             static void LoadFromObject(NextJobExecutionChangedEvent &obj, const Crt::JsonView &doc);
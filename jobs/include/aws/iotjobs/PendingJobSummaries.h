@@ -0,0 +1,126 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/GetPendingJobExecutionsResponse.h>
+
+#include <aws/iotjobs/Exports.h>
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Types.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * One job execution summary of a PendingJobSummaries, its optional members flagged in `Present`.
+         * Timestamps are the epoch seconds the service sent, packed as milliseconds.
+         */
+        struct PackedJobSummary
+        {
+            static const uint8_t HasJobId = 1 << 0;
+            static const uint8_t HasExecutionNumber = 1 << 1;
+            static const uint8_t HasVersionNumber = 1 << 2;
+            static const uint8_t HasQueuedAt = 1 << 3;
+            static const uint8_t HasStartedAt = 1 << 4;
+            static const uint8_t HasLastUpdatedAt = 1 << 5;
+
+            int64_t ExecutionNumber;
+            int64_t QueuedAtMs;
+            int64_t StartedAtMs;
+            int64_t LastUpdatedAtMs;
+            int32_t VersionNumber;
+            /* The job id's bytes in the container's id storage. */
+            uint32_t JobIdOffset;
+            uint32_t JobIdLength;
+            uint8_t Present;
+        };
+
+        /**
+         * The job execution summaries of a GetPendingJobExecutionsResponse in two flat arrays, for devices with
+         * long job queues.
+         *
+         * The eager model holds each summary as a class of Optional members, its job id in a string of its own,
+         * inside an Optional vector per list. Here every summary is one fixed-size record, every job id is kept
+         * once in a single buffer, an id listed twice included, and Parse() reads the payload with
+         * Iotdevicecommon::JsonPayloadScanner without building a document. Parsing into the same container
+         * again reuses its storage.
+         */
+        class AWS_IOTJOBS_API PendingJobSummaries final
+        {
+          public:
+            explicit PendingJobSummaries(Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+            PendingJobSummaries(const PendingJobSummaries &rhs) = default;
+            PendingJobSummaries(PendingJobSummaries &&rhs) = default;
+
+            PendingJobSummaries &operator=(const PendingJobSummaries &rhs) = default;
+            PendingJobSummaries &operator=(PendingJobSummaries &&rhs) = default;
+
+            ~PendingJobSummaries() = default;
+
+            /**
+             * Replaces the contents with those of a JSON GetPendingJobExecutions accepted payload.
+             *
+             * @return false, with AWS_ERROR_INVALID_ARGUMENT raised and the container left empty, if the payload
+             * is not a JSON object or a job list is malformed.
+             */
+            bool Parse(const Crt::ByteCursor &payload);
+
+            /**
+             * As Parse(), from a document parsed already, e.g. a CBOR payload.
+             */
+            bool Load(const Crt::JsonView &doc);
+
+            void Clear() noexcept;
+
+            const PackedJobSummary *GetInProgressJobs() const noexcept { return m_summaries.data(); }
+            size_t GetInProgressCount() const noexcept { return m_inProgressCount; }
+
+            const PackedJobSummary *GetQueuedJobs() const noexcept { return m_summaries.data() + m_inProgressCount; }
+            size_t GetQueuedCount() const noexcept { return m_summaries.size() - m_inProgressCount; }
+
+            /**
+             * @return the job id of a summary of this container, valid until it is next parsed into.
+             */
+            Crt::ByteCursor GetJobId(const PackedJobSummary &summary) const noexcept;
+
+            /**
+             * @return the summary of `jobId`, in progress ones first, or null.
+             */
+            const PackedJobSummary *Find(const Crt::ByteCursor &jobId) const noexcept;
+
+            const Crt::Optional<Crt::String> &GetClientToken() const noexcept { return m_clientToken; }
+            const Iotdevicecommon::PackedDateTime &GetTimestamp() const noexcept { return m_timestamp; }
+
+            /**
+             * Decodes a summary into the eager model type.
+             */
+            JobExecutionSummary Materialize(const PackedJobSummary &summary) const;
+
+            /**
+             * Decodes everything into the eager model type.
+             */
+            GetPendingJobExecutionsResponse Materialize() const;
+
+          private:
+            /* Appends `summary`, with its job id interned when it has one. */
+            void Append(PackedJobSummary &summary, const Crt::String &jobId);
+            void Rehash(size_t capacity);
+
+            Crt::Allocator *m_allocator;
+            /* The in progress summaries, then the queued ones. */
+            Crt::Vector<PackedJobSummary> m_summaries;
+            size_t m_inProgressCount;
+            Crt::String m_jobIds;
+            /* Open-addressed by job id hash: the index + 1 of a summary holding each interned id, or 0. */
+            Crt::Vector<uint32_t> m_internTable;
+            size_t m_internedCount;
+            Crt::Optional<Crt::String> m_clientToken;
+            Iotdevicecommon::PackedDateTime m_timestamp;
+        };
+
+    } // namespace Iotjobs
+} // namespace Aws
@@ -0,0 +1,281 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/IotJobsClient.h>
+
+#include <aws/iotdevicecommon/ConnectionShardRing.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * A IotJobsClient spread over several MQTT connections. Each request is routed to the connection that owns
+         * its ThingName on a consistent hash ring, so a process serving many things can use several TLS
+         * streams and event loops while keeping the IotJobsClient API. All traffic for one thing stays on one
+         * connection, which keeps its responses ordered and its subscriptions and publishes together.
+         *
+         * Requests without a ThingName, and wildcard subscriptions ("+"), go to the connection that owns
+         * that literal value, so a wildcard subscription is made once rather than on every connection.
+         */
+        class AWS_IOTJOBS_API ShardedIotJobsClient final
+        {
+          public:
+            ShardedIotJobsClient(
+                const Aws::Crt::Vector<std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>> &connections,
+                Aws::Crt::Allocator *allocator = Aws::Crt::DefaultAllocator());
+            ShardedIotJobsClient(
+                const Aws::Crt::Vector<std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>> &connections,
+                const Aws::Iotdevicecommon::ServiceClientConfig &config,
+                Aws::Crt::Allocator *allocator = Aws::Crt::DefaultAllocator());
+
+            /**
+             * @return true if there is at least one connection and every connection is valid.
+             */
+            operator bool() const noexcept;
+            int GetLastError() const noexcept;
+
+            /**
+             * @return the number of connections requests are spread over.
+             */
+            size_t GetShardCount() const noexcept;
+
+            /**
+             * @return the client for the connection that owns `thingName`, for use with other per-connection
+             * helpers. Must not be called on a client with no connections.
+             */
+            IotJobsClient &GetClientForThing(const Aws::Crt::String &thingName) noexcept;
+
+            bool SubscribeToUpdateJobExecutionAccepted(
+                const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToUpdateJobExecutionAcceptedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateJobExecutionAccepted(
+                const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateJobExecutionAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToGetPendingJobExecutionsRejected(
+                const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToGetPendingJobExecutionsRejectedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetPendingJobExecutionsRejected(
+                const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetPendingJobExecutionsRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToDescribeJobExecutionAccepted(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToDescribeJobExecutionAcceptedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDescribeJobExecutionAccepted(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDescribeJobExecutionAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToDescribeJobExecutionAccepted, but delivers a JobExecutionDataView over the
+             * parsed message: fields are decoded on access and the job document is not copied.
+             */
+            bool SubscribeToDescribeJobExecutionAcceptedLazy(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToJobExecutionDataViewResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDescribeJobExecutionAcceptedLazy(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToJobExecutionDataViewResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToDescribeJobExecutionAccepted, but hands over the payload without copying or
+             * parsing it. Use JobPayloadScanner::FindJobDocument to locate the job document in it.
+             */
+            bool SubscribeToDescribeJobExecutionAcceptedRaw(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToRawPayloadResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDescribeJobExecutionAcceptedRaw(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToRawPayloadResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToDescribeJobExecutionRejected(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToDescribeJobExecutionRejectedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDescribeJobExecutionRejected(
+                const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDescribeJobExecutionRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToUpdateJobExecutionRejected(
+                const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToUpdateJobExecutionRejectedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateJobExecutionRejected(
+                const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateJobExecutionRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToJobExecutionsChangedEvents(
+                const Aws::Iotjobs::JobExecutionsChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToJobExecutionsChangedEventsResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToJobExecutionsChangedEvents(
+                const Aws::Iotjobs::JobExecutionsChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToJobExecutionsChangedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToStartNextPendingJobExecutionRejected(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToStartNextPendingJobExecutionRejectedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToStartNextPendingJobExecutionRejected(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToStartNextPendingJobExecutionRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToNextJobExecutionChangedEvents(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToNextJobExecutionChangedEventsResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToNextJobExecutionChangedEvents(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToNextJobExecutionChangedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToNextJobExecutionChangedEvents, but delivers a JobExecutionDataView over the
+             * parsed message: fields are decoded on access and the job document is not copied.
+             */
+            bool SubscribeToNextJobExecutionChangedEventsLazy(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToJobExecutionDataViewResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToNextJobExecutionChangedEventsLazy(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToJobExecutionDataViewResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToNextJobExecutionChangedEvents, but hands over the payload without copying or
+             * parsing it. Use JobPayloadScanner::FindJobDocument to locate the job document in it.
+             */
+            bool SubscribeToNextJobExecutionChangedEventsRaw(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToRawPayloadResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToNextJobExecutionChangedEventsRaw(
+                const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToRawPayloadResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToGetPendingJobExecutionsAccepted(
+                const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToGetPendingJobExecutionsAcceptedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetPendingJobExecutionsAccepted(
+                const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetPendingJobExecutionsAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToStartNextPendingJobExecutionAccepted(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToStartNextPendingJobExecutionAcceptedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToStartNextPendingJobExecutionAccepted(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToStartNextPendingJobExecutionAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToStartNextPendingJobExecutionAccepted, but delivers a JobExecutionDataView
+             * over the parsed message: fields are decoded on access and the job document is not copied.
+             */
+            bool SubscribeToStartNextPendingJobExecutionAcceptedLazy(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToJobExecutionDataViewResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToStartNextPendingJobExecutionAcceptedLazy(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToJobExecutionDataViewResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Same topic as SubscribeToStartNextPendingJobExecutionAccepted, but hands over the payload without
+             * copying or parsing it. Use JobPayloadScanner::FindJobDocument to locate the job document in it.
+             */
+            bool SubscribeToStartNextPendingJobExecutionAcceptedRaw(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToRawPayloadResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToStartNextPendingJobExecutionAcceptedRaw(
+                const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToRawPayloadResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool PublishDescribeJobExecution(
+                const Aws::Iotjobs::DescribeJobExecutionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishGetPendingJobExecutions(
+                const Aws::Iotjobs::GetPendingJobExecutionsRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishUpdateJobExecution(
+                const Aws::Iotjobs::UpdateJobExecutionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishStartNextPendingJobExecution(
+                const Aws::Iotjobs::StartNextPendingJobExecutionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+          private:
+            IotJobsClient *ShardFor(const Aws::Crt::Optional<Aws::Crt::String> &thingName) noexcept;
+
+            Aws::Iotdevicecommon::ConnectionShardRing m_ring;
+            Aws::Crt::Vector<IotJobsClient> m_shards;
+        };
+
+    } // namespace Iotjobs
+
+} // namespace Aws
@@ -8,6 +8,8 @@
 
 #include <aws/crt/JsonObject.h>
 #include <aws/crt/StlAllocator.h>
+#include <aws/iotdevicecommon/FlatStringMap.h>
+#include <aws/iotdevicecommon/PayloadWriter.h>
 
 namespace Aws
 {
@@ -24,10 +26,15 @@ namespace Aws
 
             void SerializeToObject(Crt::JsonObject &doc) const;
 
+            /**
+             * Streams this object into a payload encoder, without building an intermediate JsonObject.
+             */
+            void SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const;
+
             Aws::Crt::Optional<Aws::Crt::String> ThingName;
             Aws::Crt::Optional<int64_t> StepTimeoutInMinutes;
             Aws::Crt::Optional<Aws::Crt::String> ClientToken;
-            Aws::Crt::Optional<Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>> StatusDetails;
+            Aws::Crt::Optional<Aws::Iotdevicecommon::FlatStringMap> StatusDetails;
 
           private:
             static void LoadFromObject(StartNextPendingJobExecutionRequest &obj, const Crt::JsonView &doc);
@@ -0,0 +1,241 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/Exports.h>
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/StlAllocator.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/crt/mqtt/MqttClient.h>
+
+#include <aws/common/task_scheduler.h>
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        /**
+         * One file of an MQTT-based file delivery stream.
+         */
+        struct AWS_IOTJOBS_API StreamFileInfo
+        {
+            Crt::String StreamId;
+            int32_t FileId = 0;
+            uint64_t FileSize = 0;
+            /** Where the job asks for the file to go, if it says. */
+            Crt::String FilePath;
+
+            /**
+             * Reads the `fileIndex`th file of an OTA job document, i.e. one holding
+             * `{"afr_ota": {"streamname": ..., "files": [{"fileid": ..., "filesize": ..., "filepath": ...}]}}`.
+             *
+             * @return false if the document does not describe such a file.
+             */
+            static bool FromJobDocument(const Crt::JsonView &jobDocument, size_t fileIndex, StreamFileInfo &info);
+        };
+
+        class AWS_IOTJOBS_API StreamDownloaderConfig final
+        {
+          public:
+            StreamDownloaderConfig() noexcept;
+            StreamDownloaderConfig(const StreamDownloaderConfig &rhs) = default;
+            StreamDownloaderConfig(StreamDownloaderConfig &&rhs) = default;
+
+            StreamDownloaderConfig &operator=(const StreamDownloaderConfig &rhs) = default;
+            StreamDownloaderConfig &operator=(StreamDownloaderConfig &&rhs) = default;
+
+            ~StreamDownloaderConfig() = default;
+
+            /**
+             * Bytes per block, between 256 and 131072 as the service allows.
+             */
+            uint32_t BlockSize;
+
+            /**
+             * How many block requests may be awaiting their data at once.
+             */
+            size_t MaxBlocksInFlight;
+
+            /**
+             * How long, in milliseconds, to wait for a block before requesting it again.
+             */
+            uint32_t BlockTimeoutMs;
+
+            /**
+             * How many times one block is requested again before the download fails.
+             */
+            uint32_t MaxBlockRetries;
+
+            /**
+             * The QoS used for the stream subscriptions and block requests.
+             */
+            Crt::Mqtt::QOS Qos;
+        };
+
+        /**
+         * Throughput counters for a download.
+         */
+        struct AWS_IOTJOBS_API StreamDownloadStats
+        {
+            uint64_t BlocksReceived = 0;
+            uint64_t BytesReceived = 0;
+            /** Block requests sent again after timing out. */
+            uint64_t BlockRetries = 0;
+            /** Blocks that arrived more than once, e.g. after a retry. */
+            uint64_t DuplicateBlocks = 0;
+            uint64_t ElapsedNs = 0;
+
+            double GetBytesPerSecond() const noexcept
+            {
+                return ElapsedNs ? static_cast<double>(BytesReceived) * 1e9 / static_cast<double>(ElapsedNs) : 0.0;
+            }
+        };
+
+        /**
+         * Downloads one file of an MQTT-based file delivery (OTA) stream, as named by a job document, keeping up
+         * to MaxBlocksInFlight block requests outstanding and requesting blocks again when they time out.
+         *
+         * Blocks arrive in any order and are handed to the sink with their offset. Received blocks are kept in a
+         * bitmap: save GetBlockBitmap() to resume an interrupted download later with Start(bitmap). The
+         * completion handler is invoked exactly once, with AWS_ERROR_SUCCESS once every block is in the sink.
+         */
+        class AWS_IOTJOBS_API StreamDownloader final : public std::enable_shared_from_this<StreamDownloader>
+        {
+          public:
+            /**
+             * Stores one block. Returning false fails the download with the error raised.
+             */
+            using OnBlock = std::function<bool(uint64_t offset, const Crt::ByteCursor &data)>;
+            using OnDownloadComplete = std::function<void(int errorCode)>;
+
+            ~StreamDownloader();
+
+            StreamDownloader(const StreamDownloader &) = delete;
+            StreamDownloader(StreamDownloader &&) = delete;
+            StreamDownloader &operator=(const StreamDownloader &) = delete;
+            StreamDownloader &operator=(StreamDownloader &&) = delete;
+
+            /**
+             * Subscribes to the stream's topics and starts requesting the blocks not set in `receivedBlocks`,
+             * a bitmap from GetBlockBitmap(), or every block if it is empty.
+             *
+             * @return false, with the error raised, if the download is already started or the subscribes fail
+             * to queue.
+             */
+            bool Start(const Crt::Vector<uint8_t> &receivedBlocks = Crt::Vector<uint8_t>());
+
+            /**
+             * Stops requesting blocks and completes the download with AWS_IO_OPERATION_CANCELLED unless it
+             * already completed. The bitmap still says which blocks arrived.
+             */
+            void Cancel();
+
+            /**
+             * @return the service's reason, as "code: message", if it rejected a block request. The download
+             * then completes with AWS_ERROR_INVALID_ARGUMENT.
+             */
+            Crt::String GetRejection() const;
+
+            /**
+             * @return one bit per block, least significant bit first, set for blocks already in the sink.
+             */
+            Crt::Vector<uint8_t> GetBlockBitmap() const;
+
+            StreamDownloadStats GetStats() const;
+
+            /**
+             * @return a sink writing blocks at their offset into the file at `path`, which is created if it
+             * does not exist and otherwise kept, so that a resumed download fills in the rest. The sink holds
+             * the file open until it is destroyed. Null if the file cannot be opened.
+             */
+            static OnBlock CreateFileSink(const char *path);
+
+            static std::shared_ptr<StreamDownloader> Create(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const StreamFileInfo &file,
+                OnBlock &&onBlock,
+                OnDownloadComplete &&onComplete,
+                const StreamDownloaderConfig &config = StreamDownloaderConfig(),
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            StreamDownloader(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const StreamFileInfo &file,
+                OnBlock &&onBlock,
+                OnDownloadComplete &&onComplete,
+                const StreamDownloaderConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            struct InFlightBlock
+            {
+                uint32_t Block;
+                uint64_t DeadlineNs;
+                uint32_t Retries;
+            };
+
+            uint64_t Now() const;
+            bool IsReceived(uint32_t block) const noexcept;
+            void OnSubscribed(int errorCode);
+            void Unsubscribe();
+            void OnData(const Crt::ByteBuf &payload);
+            void OnRejected(const Crt::ByteBuf &payload);
+            void RequestBlocks();
+            bool PublishRequest(uint32_t block);
+            void ScheduleTimeoutCheck();
+            void CheckTimeouts();
+            void Finish(int errorCode);
+
+            static void s_onTimeoutTask(aws_task *task, void *arg, aws_task_status status);
+
+            std::shared_ptr<Crt::Mqtt::MqttConnection> m_connection;
+            aws_event_loop *m_eventLoop;
+            StreamFileInfo m_file;
+            StreamDownloaderConfig m_config;
+            Crt::Allocator *m_allocator;
+            OnBlock m_onBlock;
+            OnDownloadComplete m_onComplete;
+
+            Crt::String m_clientToken;
+            Crt::String m_requestTopic;
+            Crt::String m_dataTopic;
+            Crt::String m_rejectedTopic;
+            uint32_t m_blockCount;
+
+            mutable std::mutex m_lock;
+            bool m_started;
+            bool m_finished;
+            size_t m_pendingSubAcks;
+            Crt::Vector<uint8_t> m_bitmap;
+            uint32_t m_blocksRemaining;
+            /* Every block below this has been requested at least once. */
+            uint32_t m_nextBlock;
+            Crt::Vector<InFlightBlock> m_inFlight;
+            /* Timed-out requests, to be sent again before any new block. */
+            Crt::Vector<InFlightBlock> m_retryQueue;
+            bool m_timeoutCheckScheduled;
+            uint64_t m_startNs;
+            StreamDownloadStats m_stats;
+            Crt::String m_rejection;
+
+            /* Serializes the sink, and guards the buffer blocks are decoded into for it. */
+            std::mutex m_sinkLock;
+            Crt::ByteBuf m_decodeBuffer;
+        };
+
+    } // namespace Iotjobs
+} // namespace Aws
@@ -9,6 +9,8 @@
 
 #include <aws/crt/JsonObject.h>
 #include <aws/crt/StlAllocator.h>
+#include <aws/iotdevicecommon/FlatStringMap.h>
+#include <aws/iotdevicecommon/PayloadWriter.h>
 
 namespace Aws
 {
@@ -25,9 +27,14 @@ namespace Aws
 
             void SerializeToObject(Crt::JsonObject &doc) const;
 
+            /**
+             * Streams this object into a payload encoder, without building an intermediate JsonObject.
+             */
+            void SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const;
+
             Aws::Crt::Optional<Aws::Crt::String> ThingName;
             Aws::Crt::Optional<int64_t> ExecutionNumber;
-            Aws::Crt::Optional<Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>> StatusDetails;
+            Aws::Crt::Optional<Aws::Iotdevicecommon::FlatStringMap> StatusDetails;
             Aws::Crt::Optional<bool> IncludeJobExecutionState;
             Aws::Crt::Optional<Aws::Crt::String> JobId;
             Aws::Crt::Optional<int32_t> ExpectedVersion;
@@ -3,7 +3,7 @@
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0.
  */
-#include <aws/crt/DateTime.h>
+#include <aws/iotdevicecommon/PackedDateTime.h>
 #include <aws/crt/JsonObject.h>
 #include <aws/iotjobs/JobExecutionState.h>
 
@@ -28,7 +28,7 @@ namespace Aws
             void SerializeToObject(Crt::JsonObject &doc) const;
 
             Aws::Crt::Optional<Aws::Crt::String> ClientToken;
-            Aws::Crt::Optional<Aws::Crt::DateTime> Timestamp;
+            Aws::Iotdevicecommon::PackedDateTime Timestamp;
             Aws::Crt::Optional<Aws::Crt::JsonObject> JobDocument;
             Aws::Crt::Optional<Aws::Iotjobs::JobExecutionState> ExecutionState;
 
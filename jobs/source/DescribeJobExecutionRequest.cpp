@@ -4,52 +4,38 @@
  */
 #include <aws/iotjobs/DescribeJobExecutionRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<DescribeJobExecutionRequest, true>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<DescribeJobExecutionRequest> s_fields[] = {
+                Fields::Field<int64_t, &DescribeJobExecutionRequest::ExecutionNumber>("executionNumber"),
+                Fields::Field<bool, &DescribeJobExecutionRequest::IncludeJobDocument>("includeJobDocument"),
+                Fields::Field<Crt::String, &DescribeJobExecutionRequest::ClientToken>("clientToken"),
+            };
+        } // namespace
 
         void DescribeJobExecutionRequest::LoadFromObject(
             DescribeJobExecutionRequest &val,
             const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("executionNumber"))
-            {
-                val.ExecutionNumber = doc.GetInt64("executionNumber");
-            }
-
-            if (doc.ValueExists("includeJobDocument"))
-            {
-                val.IncludeJobDocument = doc.GetBool("includeJobDocument");
-            }
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void DescribeJobExecutionRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (ExecutionNumber)
-            {
-                object.WithInt64("executionNumber", *ExecutionNumber);
-            }
-
-            if (IncludeJobDocument)
-            {
-                object.WithBool("includeJobDocument", *IncludeJobDocument);
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
+        void DescribeJobExecutionRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         DescribeJobExecutionRequest::DescribeJobExecutionRequest(const Crt::JsonView &doc)
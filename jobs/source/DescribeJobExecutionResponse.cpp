@@ -4,54 +4,35 @@
  */
 #include <aws/iotjobs/DescribeJobExecutionResponse.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<DescribeJobExecutionResponse>;
+            using JobExecutionDataCodec = Aws::Iotdevicecommon::ModelCodec<JobExecutionData>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<DescribeJobExecutionResponse> s_fields[] = {
+                Fields::Field<JobExecutionData, &DescribeJobExecutionResponse::Execution, JobExecutionDataCodec>(
+                    "execution"),
+                Fields::Field<Crt::String, &DescribeJobExecutionResponse::ClientToken>("clientToken"),
+                Fields::Timestamp<&DescribeJobExecutionResponse::Timestamp>("timestamp"),
+            };
+        } // namespace
 
         void DescribeJobExecutionResponse::LoadFromObject(
             DescribeJobExecutionResponse &val,
             const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("execution"))
-            {
-                val.Execution = doc.GetJsonObject("execution");
-            }
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
-
-            if (doc.ValueExists("timestamp"))
-            {
-                val.Timestamp = doc.GetDouble("timestamp");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void DescribeJobExecutionResponse::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (Execution)
-            {
-                Aws::Crt::JsonObject jsonObject;
-                Execution->SerializeToObject(jsonObject);
-                object.WithObject("execution", std::move(jsonObject));
-            }
-
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
-
-            if (Timestamp)
-            {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         DescribeJobExecutionResponse::DescribeJobExecutionResponse(const Crt::JsonView &doc)
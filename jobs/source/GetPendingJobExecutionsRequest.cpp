@@ -4,32 +4,36 @@
  */
 #include <aws/iotjobs/GetPendingJobExecutionsRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<GetPendingJobExecutionsRequest, true>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<GetPendingJobExecutionsRequest> s_fields[] = {
+                Fields::Field<Crt::String, &GetPendingJobExecutionsRequest::ClientToken>("clientToken"),
+            };
+        } // namespace
 
         void GetPendingJobExecutionsRequest::LoadFromObject(
             GetPendingJobExecutionsRequest &val,
             const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void GetPendingJobExecutionsRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
+        void GetPendingJobExecutionsRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         GetPendingJobExecutionsRequest::GetPendingJobExecutionsRequest(const Crt::JsonView &doc)
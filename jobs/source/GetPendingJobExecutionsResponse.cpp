@@ -4,98 +4,41 @@
  */
 #include <aws/iotjobs/GetPendingJobExecutionsResponse.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<GetPendingJobExecutionsResponse>;
+            using JobExecutionSummaryListCodec = Aws::Iotdevicecommon::ModelListCodec<JobExecutionSummary>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<GetPendingJobExecutionsResponse> s_fields[] = {
+                Fields::Field<
+                    Crt::Vector<JobExecutionSummary>,
+                    &GetPendingJobExecutionsResponse::QueuedJobs,
+                    JobExecutionSummaryListCodec>("queuedJobs"),
+                Fields::Timestamp<&GetPendingJobExecutionsResponse::Timestamp>("timestamp"),
+                Fields::Field<Crt::String, &GetPendingJobExecutionsResponse::ClientToken>("clientToken"),
+                Fields::Field<
+                    Crt::Vector<JobExecutionSummary>,
+                    &GetPendingJobExecutionsResponse::InProgressJobs,
+                    JobExecutionSummaryListCodec>("inProgressJobs"),
+            };
+        } // namespace
 
         void GetPendingJobExecutionsResponse::LoadFromObject(
             GetPendingJobExecutionsResponse &val,
             const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("queuedJobs"))
-            {
-                auto queuedJobsList = doc.GetArray("queuedJobs");
-                val.QueuedJobs = Aws::Crt::Vector<Aws::Iotjobs::JobExecutionSummary>();
-                val.QueuedJobs->reserve(queuedJobsList.size());
-                for (auto &queuedJobsListMember : queuedJobsList)
-                {
-                    Aws::Iotjobs::JobExecutionSummary queuedJobsListValMember;
-                    queuedJobsListValMember = queuedJobsListMember.AsObject();
-                    val.QueuedJobs->push_back(std::move(queuedJobsListValMember));
-                }
-            }
-
-            if (doc.ValueExists("timestamp"))
-            {
-                val.Timestamp = doc.GetDouble("timestamp");
-            }
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
-
-            if (doc.ValueExists("inProgressJobs"))
-            {
-                auto inProgressJobsList = doc.GetArray("inProgressJobs");
-                val.InProgressJobs = Aws::Crt::Vector<Aws::Iotjobs::JobExecutionSummary>();
-                val.InProgressJobs->reserve(inProgressJobsList.size());
-                for (auto &inProgressJobsListMember : inProgressJobsList)
-                {
-                    Aws::Iotjobs::JobExecutionSummary inProgressJobsListValMember;
-                    inProgressJobsListValMember = inProgressJobsListMember.AsObject();
-                    val.InProgressJobs->push_back(std::move(inProgressJobsListValMember));
-                }
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void GetPendingJobExecutionsResponse::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (QueuedJobs)
-            {
-                Aws::Crt::Vector<Aws::Crt::JsonObject> queuedJobsList;
-                queuedJobsList.reserve(QueuedJobs->size());
-                for (auto &queuedJobsListMember : *QueuedJobs)
-                {
-                    Aws::Crt::JsonObject queuedJobsListValMember;
-                    Aws::Crt::JsonObject jsonObject;
-                    queuedJobsListMember.SerializeToObject(jsonObject);
-                    queuedJobsListValMember.AsObject(std::move(jsonObject));
-                    queuedJobsList.push_back(queuedJobsListValMember);
-                }
-                object.WithArray("queuedJobs", std::move(queuedJobsList));
-            }
-
-            if (Timestamp)
-            {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
-            }
-
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
-
-            if (InProgressJobs)
-            {
-                Aws::Crt::Vector<Aws::Crt::JsonObject> inProgressJobsList;
-                inProgressJobsList.reserve(InProgressJobs->size());
-                for (auto &inProgressJobsListMember : *InProgressJobs)
-                {
-                    Aws::Crt::JsonObject inProgressJobsListValMember;
-                    Aws::Crt::JsonObject jsonObject;
-                    inProgressJobsListMember.SerializeToObject(jsonObject);
-                    inProgressJobsListValMember.AsObject(std::move(jsonObject));
-                    inProgressJobsList.push_back(inProgressJobsListValMember);
-                }
-                object.WithArray("inProgressJobs", std::move(inProgressJobsList));
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         GetPendingJobExecutionsResponse::GetPendingJobExecutionsResponse(const Crt::JsonView &doc)
@@ -4,16 +4,24 @@
  */
 #include <aws/iotjobs/IotJobsClient.h>
 
+#include <aws/iotdevicecommon/MessageContext.h>
+#include <aws/iotdevicecommon/PayloadCodec.h>
+#include <aws/iotdevicecommon/ServiceOperations.h>
+#include <aws/iotdevicecommon/TopicBuilder.h>
+
 #include <aws/iotjobs/DescribeJobExecutionRequest.h>
 #include <aws/iotjobs/DescribeJobExecutionResponse.h>
 #include <aws/iotjobs/DescribeJobExecutionSubscriptionRequest.h>
 #include <aws/iotjobs/GetPendingJobExecutionsRequest.h>
 #include <aws/iotjobs/GetPendingJobExecutionsResponse.h>
 #include <aws/iotjobs/GetPendingJobExecutionsSubscriptionRequest.h>
+#include <aws/iotjobs/JobExecutionDataView.h>
 #include <aws/iotjobs/JobExecutionsChangedEvent.h>
 #include <aws/iotjobs/JobExecutionsChangedSubscriptionRequest.h>
+#include <aws/iotjobs/JobsRequestView.h>
 #include <aws/iotjobs/NextJobExecutionChangedEvent.h>
 #include <aws/iotjobs/NextJobExecutionChangedSubscriptionRequest.h>
+#include <aws/iotjobs/PendingJobSummaries.h>
 #include <aws/iotjobs/RejectedError.h>
 #include <aws/iotjobs/StartNextJobExecutionResponse.h>
 #include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
@@ -26,10 +34,81 @@ namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            /* Reports the RequestThrottled rejections among a rejected topic's messages to the breaker. */
+            std::function<void(RejectedError *, int)> s_reportThrottling(
+                const std::shared_ptr<Aws::Iotdevicecommon::ThrottleBreaker> &breaker,
+                Aws::Iotdevicecommon::ThrottledOperation operation,
+                std::function<void(RejectedError *, int)> &&handler)
+            {
+                if (!breaker)
+                {
+                    return std::move(handler);
+                }
+
+                return [breaker, operation, handler](RejectedError *error, int ioErr) {
+                    if (error && error->Code && *error->Code == RejectedErrorCode::RequestThrottled)
+                    {
+                        breaker->RecordThrottled(operation);
+                    }
+                    handler(error, ioErr);
+                };
+            }
+        } // namespace
 
-        IotJobsClient::IotJobsClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection)
-            : m_connection(connection)
+        Crt::String CurrentJobId()
         {
+            /* $aws/things/<thing>/jobs/<jobId>/<get|update>/<accepted|rejected>; topics without a job id have
+             * fewer segments. */
+            Crt::String jobId;
+            const Crt::String *topic = Iotdevicecommon::CurrentMessageTopic();
+            Crt::String segment;
+            if (topic && Iotdevicecommon::TopicSegment(*topic, 3, segment) && segment == "jobs" &&
+                Iotdevicecommon::TopicSegment(*topic, 6, segment))
+            {
+                Iotdevicecommon::TopicSegment(*topic, 4, jobId);
+            }
+            return jobId;
+        }
+
+        IotJobsClient::IotJobsClient(
+            const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+            Aws::Crt::Allocator *allocator)
+            : IotJobsClient(connection, Aws::Iotdevicecommon::ServiceClientConfig(), allocator)
+        {
+        }
+
+        IotJobsClient::IotJobsClient(
+            const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+            const Aws::Iotdevicecommon::ServiceClientConfig &config,
+            Aws::Crt::Allocator *allocator)
+            : m_allocator(allocator), m_stringAllocator(allocator), m_connection(connection),
+              m_payloadBufferPool(config.PayloadBufferPool), m_payloadFormat(config.PayloadFormat),
+              m_handlerContext(), m_metrics(config.Metrics), m_tracer(config.Tracer), m_session(config.Session),
+              m_reuseInboundModels(config.ReuseInboundModels), m_offlineQueue(config.OfflineQueue),
+              m_memoryBudget(config.MemoryBudget), m_publishScheduler(config.PublishScheduler),
+              m_scheduledPublishDeadlineMs(config.ScheduledPublishDeadlineMs),
+              m_completionBatcher(config.CompletionBatcher), m_publishLanes(config.PublishLanes),
+              m_throttleBreaker(config.ThrottleBreaker), m_rateLimiter(config.RateLimiter),
+              m_hotStandby(config.HotStandby), m_qosPolicy(config.QosPolicy)
+        {
+            if (!m_payloadBufferPool)
+            {
+                m_payloadBufferPool =
+                    Aws::Crt::MakeShared<Aws::Iotdevicecommon::PayloadBufferPool>(m_allocator, 0, 0, m_allocator);
+            }
+
+            auto handlerContext = Aws::Crt::MakeShared<Aws::Iotdevicecommon::HandlerContext>(m_allocator);
+            handlerContext->Executor = config.HandlerExecutor;
+            handlerContext->Pool = m_payloadBufferPool;
+            handlerContext->Metrics = config.Metrics;
+            handlerContext->Tracer = config.Tracer;
+            handlerContext->Watchdog = config.HandlerWatchdog;
+            handlerContext->LoopMonitor = config.EventLoopMonitor;
+            handlerContext->Budget = config.MemoryBudget;
+            handlerContext->Standby = config.HotStandby;
+            m_handlerContext = std::move(handlerContext);
         }
 
         IotJobsClient::operator bool() const noexcept { return *m_connection; }
@@ -42,50 +121,38 @@ namespace Aws
             const OnSubscribeToUpdateJobExecutionAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::UpdateJobExecutionResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "jobs"
-                               << "/" << *request.JobId << "/"
-                               << "update"
-                               << "/"
-                               << "accepted";
+            return SubscribeToUpdateJobExecutionAccepted(
+                request, qos, OnSubscribeToUpdateJobExecutionAcceptedResponse(handler), onSubAck);
+        }
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotJobsClient::SubscribeToUpdateJobExecutionAccepted(
+            const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateJobExecutionAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/" << *request.JobId << "/"
+                           << "update"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotjobs::UpdateJobExecutionResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotJobsClient::SubscribeToGetPendingJobExecutionsRejected(
@@ -94,50 +161,39 @@ namespace Aws
             const OnSubscribeToGetPendingJobExecutionsRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::RejectedError response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "jobs"
-                               << "/"
-                               << "get"
-                               << "/"
-                               << "rejected";
+            return SubscribeToGetPendingJobExecutionsRejected(
+                request, qos, OnSubscribeToGetPendingJobExecutionsRejectedResponse(handler), onSubAck);
+        }
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotJobsClient::SubscribeToGetPendingJobExecutionsRejected(
+            const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetPendingJobExecutionsRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "get"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotjobs::RejectedError>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                s_reportThrottling(
+                    m_throttleBreaker, Aws::Iotdevicecommon::ThrottledOperation::JobsGetPending, std::move(handler)),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotJobsClient::SubscribeToDescribeJobExecutionAccepted(
@@ -146,102 +202,181 @@ namespace Aws
             const OnSubscribeToDescribeJobExecutionAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
+            return SubscribeToDescribeJobExecutionAccepted(
+                request, qos, OnSubscribeToDescribeJobExecutionAcceptedResponse(handler), onSubAck);
+        }
 
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
+        bool IotJobsClient::SubscribeToDescribeJobExecutionAccepted(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDescribeJobExecutionAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/" << *request.JobId << "/"
+                           << "get"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotjobs::DescribeJobExecutionResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
+        }
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::DescribeJobExecutionResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+        bool IotJobsClient::SubscribeToDescribeJobExecutionAcceptedLazy(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToJobExecutionDataViewResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToDescribeJobExecutionAcceptedLazy(
+                request, qos, OnSubscribeToJobExecutionDataViewResponse(handler), onSubAck);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "jobs"
-                               << "/" << *request.JobId << "/"
-                               << "get"
-                               << "/"
-                               << "accepted";
+        bool IotJobsClient::SubscribeToDescribeJobExecutionAcceptedLazy(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToJobExecutionDataViewResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToJobExecutionDataViewResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            Aws::Crt::Allocator *allocator = m_allocator;
+            auto onSubscribePublish = [sharedHandler, payloadScratch, payloadFormat, allocator](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) mutable {
+                auto message = Aws::Crt::MakeShared<Aws::Crt::JsonObject>(allocator);
+                Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, *message);
+                Aws::Iotjobs::JobExecutionDataView view(message);
+                (*sharedHandler)(&view, AWS_ERROR_SUCCESS);
+            };
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/" << *request.JobId << "/"
+                           << "get"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
-        bool IotJobsClient::SubscribeToDescribeJobExecutionRejected(
+        bool IotJobsClient::SubscribeToDescribeJobExecutionAcceptedRaw(
             const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
-            const OnSubscribeToDescribeJobExecutionRejectedResponse &handler,
+            const OnSubscribeToRawPayloadResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
+            return SubscribeToDescribeJobExecutionAcceptedRaw(
+                request, qos, OnSubscribeToRawPayloadResponse(handler), onSubAck);
+        }
 
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
+        bool IotJobsClient::SubscribeToDescribeJobExecutionAcceptedRaw(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToRawPayloadResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToRawPayloadResponse>(m_allocator, std::move(handler));
+            auto onSubscribePublish = [sharedHandler](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) {
+                Aws::Crt::ByteCursor payloadCursor = Aws::Crt::ByteCursorFromByteBuf(payload);
+                (*sharedHandler)(&payloadCursor, AWS_ERROR_SUCCESS);
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::RejectedError response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/" << *request.JobId << "/"
+                           << "get"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "jobs"
-                               << "/" << *request.JobId << "/"
-                               << "get"
-                               << "/"
-                               << "rejected";
+        bool IotJobsClient::SubscribeToDescribeJobExecutionRejected(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToDescribeJobExecutionRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToDescribeJobExecutionRejected(
+                request, qos, OnSubscribeToDescribeJobExecutionRejectedResponse(handler), onSubAck);
+        }
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotJobsClient::SubscribeToDescribeJobExecutionRejected(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDescribeJobExecutionRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/" << *request.JobId << "/"
+                           << "get"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotjobs::RejectedError>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                s_reportThrottling(
+                    m_throttleBreaker, Aws::Iotdevicecommon::ThrottledOperation::JobsDescribe, std::move(handler)),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotJobsClient::SubscribeToUpdateJobExecutionRejected(
@@ -250,50 +385,39 @@ namespace Aws
             const OnSubscribeToUpdateJobExecutionRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::RejectedError response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "jobs"
-                               << "/" << *request.JobId << "/"
-                               << "update"
-                               << "/"
-                               << "rejected";
+            return SubscribeToUpdateJobExecutionRejected(
+                request, qos, OnSubscribeToUpdateJobExecutionRejectedResponse(handler), onSubAck);
+        }
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotJobsClient::SubscribeToUpdateJobExecutionRejected(
+            const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateJobExecutionRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/" << *request.JobId << "/"
+                           << "update"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotjobs::RejectedError>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                s_reportThrottling(
+                    m_throttleBreaker, Aws::Iotdevicecommon::ThrottledOperation::JobsUpdate, std::move(handler)),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotJobsClient::SubscribeToJobExecutionsChangedEvents(
@@ -302,48 +426,57 @@ namespace Aws
             const OnSubscribeToJobExecutionsChangedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
+            return SubscribeToJobExecutionsChangedEvents(
+                request, qos, OnSubscribeToJobExecutionsChangedEventsResponse(handler), onSubAck);
+        }
 
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
+        bool IotJobsClient::SubscribeToJobExecutionsChangedEvents(
+            const Aws::Iotjobs::JobExecutionsChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToJobExecutionsChangedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsEvents, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToJobExecutionsChangedEventsResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            Aws::Crt::Optional<Aws::Iotjobs::JobExecutionsChangedEvent> reusableResponse;
+            if (m_reuseInboundModels)
+            {
+                reusableResponse.emplace();
+            }
+            auto onSubscribePublish = [sharedHandler, payloadScratch, payloadFormat, reusableResponse](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) mutable {
+                Aws::Crt::JsonObject jsonObject;
+                Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                Aws::Iotjobs::JobExecutionsChangedEvent freshResponse;
+                Aws::Iotjobs::JobExecutionsChangedEvent &response =
+                    reusableResponse ? *reusableResponse : freshResponse;
+                response.Reload(jsonObject);
+                (*sharedHandler)(&response, AWS_ERROR_SUCCESS);
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::JobExecutionsChangedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "jobs"
-                               << "/"
-                               << "notify";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "notify";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotJobsClient::SubscribeToStartNextPendingJobExecutionRejected(
@@ -352,100 +485,196 @@ namespace Aws
             const OnSubscribeToStartNextPendingJobExecutionRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
+            return SubscribeToStartNextPendingJobExecutionRejected(
+                request, qos, OnSubscribeToStartNextPendingJobExecutionRejectedResponse(handler), onSubAck);
+        }
 
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
+        bool IotJobsClient::SubscribeToStartNextPendingJobExecutionRejected(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToStartNextPendingJobExecutionRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "start-next"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotjobs::RejectedError>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                s_reportThrottling(
+                    m_throttleBreaker, Aws::Iotdevicecommon::ThrottledOperation::JobsStartNext, std::move(handler)),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
+        }
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::RejectedError response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+        bool IotJobsClient::SubscribeToNextJobExecutionChangedEvents(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToNextJobExecutionChangedEventsResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToNextJobExecutionChangedEvents(
+                request, qos, OnSubscribeToNextJobExecutionChangedEventsResponse(handler), onSubAck);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "jobs"
-                               << "/"
-                               << "start-next"
-                               << "/"
-                               << "rejected";
+        bool IotJobsClient::SubscribeToNextJobExecutionChangedEvents(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToNextJobExecutionChangedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsEvents, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToNextJobExecutionChangedEventsResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            Aws::Crt::Optional<Aws::Iotjobs::NextJobExecutionChangedEvent> reusableResponse;
+            if (m_reuseInboundModels)
+            {
+                reusableResponse.emplace();
+            }
+            auto onSubscribePublish = [sharedHandler, payloadScratch, payloadFormat, reusableResponse](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) mutable {
+                Aws::Crt::JsonObject jsonObject;
+                Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                Aws::Iotjobs::NextJobExecutionChangedEvent freshResponse;
+                Aws::Iotjobs::NextJobExecutionChangedEvent &response =
+                    reusableResponse ? *reusableResponse : freshResponse;
+                response.Reload(jsonObject);
+                (*sharedHandler)(&response, AWS_ERROR_SUCCESS);
+            };
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "notify-next";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
-        bool IotJobsClient::SubscribeToNextJobExecutionChangedEvents(
+        bool IotJobsClient::SubscribeToNextJobExecutionChangedEventsLazy(
             const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
-            const OnSubscribeToNextJobExecutionChangedEventsResponse &handler,
+            const OnSubscribeToJobExecutionDataViewResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
+            return SubscribeToNextJobExecutionChangedEventsLazy(
+                request, qos, OnSubscribeToJobExecutionDataViewResponse(handler), onSubAck);
+        }
 
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
+        bool IotJobsClient::SubscribeToNextJobExecutionChangedEventsLazy(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToJobExecutionDataViewResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsEvents, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToJobExecutionDataViewResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            Aws::Crt::Allocator *allocator = m_allocator;
+            auto onSubscribePublish = [sharedHandler, payloadScratch, payloadFormat, allocator](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) mutable {
+                auto message = Aws::Crt::MakeShared<Aws::Crt::JsonObject>(allocator);
+                Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, *message);
+                Aws::Iotjobs::JobExecutionDataView view(message);
+                (*sharedHandler)(&view, AWS_ERROR_SUCCESS);
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::NextJobExecutionChangedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "notify-next";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "jobs"
-                               << "/"
-                               << "notify-next";
+        bool IotJobsClient::SubscribeToNextJobExecutionChangedEventsRaw(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToRawPayloadResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToNextJobExecutionChangedEventsRaw(
+                request, qos, OnSubscribeToRawPayloadResponse(handler), onSubAck);
+        }
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotJobsClient::SubscribeToNextJobExecutionChangedEventsRaw(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToRawPayloadResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsEvents, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToRawPayloadResponse>(m_allocator, std::move(handler));
+            auto onSubscribePublish = [sharedHandler](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) {
+                Aws::Crt::ByteCursor payloadCursor = Aws::Crt::ByteCursorFromByteBuf(payload);
+                (*sharedHandler)(&payloadCursor, AWS_ERROR_SUCCESS);
+            };
+
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "notify-next";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotJobsClient::SubscribeToGetPendingJobExecutionsAccepted(
@@ -454,50 +683,115 @@ namespace Aws
             const OnSubscribeToGetPendingJobExecutionsAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
+            return SubscribeToGetPendingJobExecutionsAccepted(
+                request, qos, OnSubscribeToGetPendingJobExecutionsAcceptedResponse(handler), onSubAck);
+        }
+
+        bool IotJobsClient::SubscribeToGetPendingJobExecutionsAccepted(
+            const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetPendingJobExecutionsAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "get"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotjobs::GetPendingJobExecutionsResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
+        }
+
+        bool IotJobsClient::SubscribeToGetPendingJobExecutionsAcceptedCompact(
+            const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToPendingJobSummariesResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToGetPendingJobExecutionsAcceptedCompact(
+                request, qos, OnSubscribeToPendingJobSummariesResponse(handler), onSubAck);
+        }
+
+        bool IotJobsClient::SubscribeToGetPendingJobExecutionsAcceptedCompact(
+            const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToPendingJobSummariesResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            auto sharedHandler =
+                Aws::Crt::MakeShared<OnSubscribeToPendingJobSummariesResponse>(m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            Aws::Crt::Allocator *allocator = m_allocator;
+            Aws::Crt::Optional<Aws::Iotjobs::PendingJobSummaries> reusableSummaries;
+            if (m_reuseInboundModels)
+            {
+                reusableSummaries.emplace(allocator);
+            }
+            auto onSubscribePublish = [sharedHandler, payloadScratch, payloadFormat, allocator, reusableSummaries](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) mutable {
+                Aws::Iotjobs::PendingJobSummaries freshSummaries(allocator);
+                Aws::Iotjobs::PendingJobSummaries &summaries = reusableSummaries ? *reusableSummaries : freshSummaries;
+                bool parsed = false;
+                if (payloadFormat == Aws::Iotdevicecommon::PayloadFormat::Json)
+                {
+                    parsed = summaries.Parse(Aws::Crt::ByteCursorFromByteBuf(payload));
+                }
+                else
                 {
-                    handler(nullptr, errorCode);
+                    Aws::Crt::JsonObject jsonObject;
+                    Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                    parsed = summaries.Load(jsonObject.View());
                 }
 
-                if (onSubAck)
+                if (parsed)
                 {
-                    onSubAck(errorCode);
+                    (*sharedHandler)(&summaries, AWS_ERROR_SUCCESS);
+                }
+                else
+                {
+                    (*sharedHandler)(nullptr, aws_last_error());
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::GetPendingJobExecutionsResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "jobs"
-                               << "/"
-                               << "get"
-                               << "/"
-                               << "accepted";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "get"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotJobsClient::SubscribeToStartNextPendingJobExecutionAccepted(
@@ -506,50 +800,177 @@ namespace Aws
             const OnSubscribeToStartNextPendingJobExecutionAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
+            return SubscribeToStartNextPendingJobExecutionAccepted(
+                request, qos, OnSubscribeToStartNextPendingJobExecutionAcceptedResponse(handler), onSubAck);
+        }
 
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
+        bool IotJobsClient::SubscribeToStartNextPendingJobExecutionAccepted(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToStartNextPendingJobExecutionAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "start-next"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotjobs::StartNextJobExecutionResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
+        }
+
+        bool IotJobsClient::SubscribeToStartNextPendingJobExecutionAcceptedLazy(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToJobExecutionDataViewResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToStartNextPendingJobExecutionAcceptedLazy(
+                request, qos, OnSubscribeToJobExecutionDataViewResponse(handler), onSubAck);
+        }
+
+        bool IotJobsClient::SubscribeToStartNextPendingJobExecutionAcceptedLazy(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToJobExecutionDataViewResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToJobExecutionDataViewResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            Aws::Crt::Allocator *allocator = m_allocator;
+            auto onSubscribePublish = [sharedHandler, payloadScratch, payloadFormat, allocator](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) mutable {
+                auto message = Aws::Crt::MakeShared<Aws::Crt::JsonObject>(allocator);
+                Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, *message);
+                Aws::Iotjobs::JobExecutionDataView view(message);
+                (*sharedHandler)(&view, AWS_ERROR_SUCCESS);
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::StartNextJobExecutionResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "start-next"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "jobs"
-                               << "/"
-                               << "start-next"
-                               << "/"
-                               << "accepted";
+        bool IotJobsClient::SubscribeToStartNextPendingJobExecutionAcceptedRaw(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToRawPayloadResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToStartNextPendingJobExecutionAcceptedRaw(
+                request, qos, OnSubscribeToRawPayloadResponse(handler), onSubAck);
+        }
+
+        bool IotJobsClient::SubscribeToStartNextPendingJobExecutionAcceptedRaw(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToRawPayloadResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsResponses, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToRawPayloadResponse>(m_allocator, std::move(handler));
+            auto onSubscribePublish = [sharedHandler](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) {
+                Aws::Crt::ByteCursor payloadCursor = Aws::Crt::ByteCursorFromByteBuf(payload);
+                (*sharedHandler)(&payloadCursor, AWS_ERROR_SUCCESS);
+            };
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "start-next"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
+        }
+
+        bool IotJobsClient::SubscribeToJobsTopicsRaw(
+            const Aws::Crt::String &thingName,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnRawMessageReceived &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToJobsTopicsRaw(
+                thingName, qos, Aws::Iotdevicecommon::OnRawMessageReceived(handler), onSubAck);
+        }
+
+        bool IotJobsClient::SubscribeToJobsTopicsRaw(
+            const Aws::Crt::String &thingName,
+            Aws::Crt::Mqtt::QOS qos,
+            Aws::Iotdevicecommon::OnRawMessageReceived &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsEvents, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << thingName << "/"
+                           << "jobs"
+                           << "/"
+                           << "#";
+
+            return Aws::Iotdevicecommon::SubscribeToRawMessages(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_allocator);
         }
 
         bool IotJobsClient::PublishDescribeJobExecution(
@@ -557,28 +978,64 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "things"
-                             << "/" << *request.ThingName << "/"
-                             << "jobs"
-                             << "/" << *request.JobId << "/"
-                             << "get";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << *request.ThingName << "/"
+                         << "jobs"
+                         << "/" << *request.JobId << "/"
+                         << "get";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(Aws::Iotdevicecommon::ThrottledOperation::JobsDescribe))
+            {
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Jobs,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
         bool IotJobsClient::PublishGetPendingJobExecutions(
@@ -586,28 +1043,65 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "things"
-                             << "/" << *request.ThingName << "/"
-                             << "jobs"
-                             << "/"
-                             << "get";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << *request.ThingName << "/"
+                         << "jobs"
+                         << "/"
+                         << "get";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker &&
+                !m_throttleBreaker->Allow(Aws::Iotdevicecommon::ThrottledOperation::JobsGetPending))
+            {
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Jobs,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
         bool IotJobsClient::PublishUpdateJobExecution(
@@ -615,28 +1109,87 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "things"
-                             << "/" << *request.ThingName << "/"
-                             << "jobs"
-                             << "/" << *request.JobId << "/"
-                             << "update";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsUpdate, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << *request.ThingName << "/"
+                         << "jobs"
+                         << "/" << *request.JobId << "/"
+                         << "update";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(Aws::Iotdevicecommon::ThrottledOperation::JobsUpdate))
+            {
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            if (m_offlineQueue)
+            {
+                bool queued = m_offlineQueue->Enqueue(
+                    publishTopic.c_str(), qos, buf, Aws::Iotdevicecommon::DurablePublishQueue::OnDelivered(onPubAck));
+                trace.EndPublish(queued ? AWS_ERROR_SUCCESS : aws_last_error());
+                m_payloadBufferPool->Release(buf);
+                return queued;
+            }
+
+            if (m_publishScheduler)
+            {
+                bool scheduled = m_publishScheduler->Schedule(
+                    m_connection,
+                    publishTopic.c_str(),
+                    qos,
+                    buf,
+                    Aws::Iotdevicecommon::PublishScheduler::OnPublished(onPubAck),
+                    m_scheduledPublishDeadlineMs);
+                trace.EndPublish(scheduled ? AWS_ERROR_SUCCESS : aws_last_error());
+                m_payloadBufferPool->Release(buf);
+                return scheduled;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Jobs,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
         bool IotJobsClient::PublishStartNextPendingJobExecution(
@@ -644,28 +1197,349 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "things"
-                             << "/" << *request.ThingName << "/"
-                             << "jobs"
-                             << "/"
-                             << "start-next";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << *request.ThingName << "/"
+                         << "jobs"
+                         << "/"
+                         << "start-next";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(Aws::Iotdevicecommon::ThrottledOperation::JobsStartNext))
+            {
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Jobs,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
+        }
+
+        bool IotJobsClient::PublishDescribeJobExecutionRaw(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::String &jobId,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "jobs"
+                         << "/" << jobId << "/"
+                         << "get";
+
+            return PublishRaw(
+                publishTopic,
+                payload,
+                qos,
+                false,
+                Aws::Iotdevicecommon::ThrottledOperation::JobsDescribe,
+                onRelease,
+                onPubAck);
+        }
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+        bool IotJobsClient::PublishGetPendingJobExecutionsRaw(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "jobs"
+                         << "/"
+                         << "get";
+
+            return PublishRaw(
+                publishTopic,
+                payload,
+                qos,
+                false,
+                Aws::Iotdevicecommon::ThrottledOperation::JobsGetPending,
+                onRelease,
+                onPubAck);
+        }
+
+        bool IotJobsClient::PublishUpdateJobExecutionRaw(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::String &jobId,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsUpdate, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "jobs"
+                         << "/" << jobId << "/"
+                         << "update";
+
+            return PublishRaw(
+                publishTopic,
+                payload,
+                qos,
+                true,
+                Aws::Iotdevicecommon::ThrottledOperation::JobsUpdate,
+                onRelease,
+                onPubAck);
+        }
+
+        bool IotJobsClient::PublishStartNextPendingJobExecutionRaw(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "jobs"
+                         << "/"
+                         << "start-next";
+
+            return PublishRaw(
+                publishTopic,
+                payload,
+                qos,
+                false,
+                Aws::Iotdevicecommon::ThrottledOperation::JobsStartNext,
+                onRelease,
+                onPubAck);
+        }
+
+        template <typename View>
+        bool IotJobsClient::PublishView(
+            const View &request,
+            const Aws::Iotdevicecommon::TopicBuilder &topic,
+            Aws::Iotdevicecommon::ThrottledOperation operation,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::JobsRequest, qos);
+            if (!topic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(operation))
+            {
+                return false;
+            }
+
+            /* The token is only copied for a tracer to match the response by. */
+            Aws::Crt::Optional<Aws::Crt::String> clientToken;
+            if (m_tracer && request.ClientToken.len > 0)
+            {
+                clientToken = Aws::Crt::String(
+                    reinterpret_cast<const char *>(request.ClientToken.ptr), request.ClientToken.len);
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, topic.c_str(), &clientToken);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Jobs,
+                    trace,
+                    topic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                topic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
+        }
+
+        bool IotJobsClient::PublishDescribeJobExecution(
+            const Aws::Iotjobs::DescribeJobExecutionRequestView &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws/things/" << request.ThingName << "/jobs/" << request.JobId << "/get";
+            return PublishView(
+                request, publishTopic, Aws::Iotdevicecommon::ThrottledOperation::JobsDescribe, qos, onPubAck);
+        }
+
+        bool IotJobsClient::PublishGetPendingJobExecutions(
+            const Aws::Iotjobs::GetPendingJobExecutionsRequestView &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws/things/" << request.ThingName << "/jobs/get";
+            return PublishView(
+                request, publishTopic, Aws::Iotdevicecommon::ThrottledOperation::JobsGetPending, qos, onPubAck);
+        }
+
+        bool IotJobsClient::PublishRaw(
+            const Aws::Iotdevicecommon::TopicBuilder &topic,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            bool deferrable,
+            Aws::Iotdevicecommon::ThrottledOperation operation,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            if (!topic)
+            {
+                if (onRelease)
+                {
+                    onRelease();
+                }
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(operation))
+            {
+                if (onRelease)
+                {
+                    onRelease();
+                }
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, topic.c_str(), nullptr);
+            trace.EndSerialize(true);
+            if (deferrable && (m_offlineQueue || m_publishScheduler))
+            {
+                /* Both keep a copy of what they hold back, so the caller's payload is released right away. */
+                Aws::Crt::ByteBuf view = aws_byte_buf_from_array(payload.ptr, payload.len);
+                bool accepted = m_offlineQueue
+                                    ? m_offlineQueue->Enqueue(
+                                          topic.c_str(),
+                                          qos,
+                                          view,
+                                          Aws::Iotdevicecommon::DurablePublishQueue::OnDelivered(onPubAck))
+                                    : m_publishScheduler->Schedule(
+                                          m_connection,
+                                          topic.c_str(),
+                                          qos,
+                                          view,
+                                          Aws::Iotdevicecommon::PublishScheduler::OnPublished(onPubAck),
+                                          m_scheduledPublishDeadlineMs);
+                trace.EndPublish(accepted ? AWS_ERROR_SUCCESS : aws_last_error());
+                if (onRelease)
+                {
+                    onRelease();
+                }
+                return accepted;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Jobs,
+                    trace,
+                    topic.c_str(),
+                    qos,
+                    payload,
+                    onRelease,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishCallerPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                topic.c_str(),
+                qos,
+                payload,
+                onRelease,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
     } // namespace Iotjobs
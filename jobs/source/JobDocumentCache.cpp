@@ -0,0 +1,142 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobDocumentCache.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        JobDocumentCache::JobDocumentCache(size_t maxEntries, Crt::Allocator *allocator) noexcept
+            : m_maxEntries(maxEntries ? maxEntries : 1), m_allocator(allocator), m_lock(), m_entries()
+        {
+        }
+
+        std::shared_ptr<const Crt::JsonObject> JobDocumentCache::Resolve(JobExecutionData &execution)
+        {
+            if (!execution.JobId)
+            {
+                return nullptr;
+            }
+
+            if (!execution.JobDocument)
+            {
+                return Find(*execution.JobId);
+            }
+
+            Crt::JsonObject document(std::move(*execution.JobDocument));
+            execution.JobDocument.reset();
+            return Store(*execution.JobId, std::move(document));
+        }
+
+        std::shared_ptr<const Crt::JsonObject> JobDocumentCache::Resolve(const JobExecutionDataView &execution)
+        {
+            Crt::Optional<Crt::String> jobId = execution.GetJobId();
+            if (!jobId)
+            {
+                return nullptr;
+            }
+
+            std::shared_ptr<const Crt::JsonObject> cached = Find(*jobId);
+            if (cached)
+            {
+                return cached;
+            }
+
+            Crt::Optional<Crt::JsonView> document = execution.GetJobDocument();
+            if (!document)
+            {
+                return nullptr;
+            }
+            return Store(*jobId, document->Materialize());
+        }
+
+        std::shared_ptr<const Crt::JsonObject> JobDocumentCache::Find(const Crt::String &jobId)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto entry = Lookup(jobId);
+            return entry != m_entries.end() ? entry->Document : nullptr;
+        }
+
+        void JobDocumentCache::Prepare(DescribeJobExecutionRequest &request)
+        {
+            if (request.JobId && Find(*request.JobId))
+            {
+                request.IncludeJobDocument = false;
+            }
+        }
+
+        void JobDocumentCache::Prepare(UpdateJobExecutionRequest &request)
+        {
+            if (request.JobId && Find(*request.JobId))
+            {
+                request.IncludeJobDocument = false;
+            }
+        }
+
+        void JobDocumentCache::Erase(const Crt::String &jobId)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto entry = Lookup(jobId);
+            if (entry != m_entries.end())
+            {
+                m_entries.erase(entry);
+            }
+        }
+
+        void JobDocumentCache::Clear()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_entries.clear();
+        }
+
+        size_t JobDocumentCache::GetSize() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_entries.size();
+        }
+
+        std::shared_ptr<const Crt::JsonObject> JobDocumentCache::Store(
+            const Crt::String &jobId,
+            Crt::JsonObject &&document)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto entry = Lookup(jobId);
+            if (entry != m_entries.end())
+            {
+                /* Already decoded once; the duplicate is simply dropped. */
+                return entry->Document;
+            }
+
+            Entry added;
+            added.JobId = jobId;
+            added.Document = Crt::MakeShared<Crt::JsonObject>(m_allocator, std::move(document));
+            if (!added.Document)
+            {
+                return nullptr;
+            }
+            m_entries.push_front(std::move(added));
+            while (m_entries.size() > m_maxEntries)
+            {
+                m_entries.pop_back();
+            }
+            return m_entries.front().Document;
+        }
+
+        Crt::List<JobDocumentCache::Entry>::iterator JobDocumentCache::Lookup(const Crt::String &jobId)
+        {
+            for (auto entry = m_entries.begin(); entry != m_entries.end(); ++entry)
+            {
+                if (entry->JobId == jobId)
+                {
+                    m_entries.splice(m_entries.begin(), m_entries, entry);
+                    return m_entries.begin();
+                }
+            }
+            return m_entries.end();
+        }
+
+    } // namespace Iotjobs
+} // namespace Aws
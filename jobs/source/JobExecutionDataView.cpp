@@ -0,0 +1,169 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobExecutionDataView.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        JobExecutionDataView::JobExecutionDataView(const std::shared_ptr<const Crt::JsonObject> &message)
+            : m_message(message)
+        {
+            if (m_message)
+            {
+                Crt::JsonView root = m_message->View();
+                if (root.ValueExists("execution"))
+                {
+                    m_execution = root.GetJsonObject("execution");
+                }
+            }
+        }
+
+        bool JobExecutionDataView::HasExecution() const noexcept { return m_execution.IsObject(); }
+
+        Crt::Optional<Crt::String> JobExecutionDataView::GetJobId() const
+        {
+            if (!HasExecution() || !m_execution.ValueExists("jobId"))
+            {
+                return Crt::Optional<Crt::String>();
+            }
+
+            return Crt::Optional<Crt::String>(m_execution.GetString("jobId"));
+        }
+
+        Crt::Optional<JobStatus> JobExecutionDataView::GetStatus() const
+        {
+            if (!HasExecution() || !m_execution.ValueExists("status"))
+            {
+                return Crt::Optional<JobStatus>();
+            }
+
+            return Crt::Optional<JobStatus>(JobStatusMarshaller::FromString(m_execution.GetString("status")));
+        }
+
+        Crt::Optional<int32_t> JobExecutionDataView::GetVersionNumber() const
+        {
+            if (!HasExecution() || !m_execution.ValueExists("versionNumber"))
+            {
+                return Crt::Optional<int32_t>();
+            }
+
+            return Crt::Optional<int32_t>(m_execution.GetInteger("versionNumber"));
+        }
+
+        Crt::Optional<int64_t> JobExecutionDataView::GetExecutionNumber() const
+        {
+            if (!HasExecution() || !m_execution.ValueExists("executionNumber"))
+            {
+                return Crt::Optional<int64_t>();
+            }
+
+            return Crt::Optional<int64_t>(m_execution.GetInt64("executionNumber"));
+        }
+
+        Crt::Optional<Crt::String> JobExecutionDataView::GetThingName() const
+        {
+            if (!HasExecution() || !m_execution.ValueExists("thingName"))
+            {
+                return Crt::Optional<Crt::String>();
+            }
+
+            return Crt::Optional<Crt::String>(m_execution.GetString("thingName"));
+        }
+
+        Crt::Optional<Crt::DateTime> JobExecutionDataView::GetQueuedAt() const
+        {
+            if (!HasExecution() || !m_execution.ValueExists("queuedAt"))
+            {
+                return Crt::Optional<Crt::DateTime>();
+            }
+
+            return Crt::Optional<Crt::DateTime>(Crt::DateTime(m_execution.GetDouble("queuedAt")));
+        }
+
+        Crt::Optional<Crt::DateTime> JobExecutionDataView::GetStartedAt() const
+        {
+            if (!HasExecution() || !m_execution.ValueExists("startedAt"))
+            {
+                return Crt::Optional<Crt::DateTime>();
+            }
+
+            return Crt::Optional<Crt::DateTime>(Crt::DateTime(m_execution.GetDouble("startedAt")));
+        }
+
+        Crt::Optional<Crt::DateTime> JobExecutionDataView::GetLastUpdatedAt() const
+        {
+            if (!HasExecution() || !m_execution.ValueExists("lastUpdatedAt"))
+            {
+                return Crt::Optional<Crt::DateTime>();
+            }
+
+            return Crt::Optional<Crt::DateTime>(Crt::DateTime(m_execution.GetDouble("lastUpdatedAt")));
+        }
+
+        Crt::Optional<Crt::JsonView> JobExecutionDataView::GetJobDocument() const
+        {
+            if (!HasExecution() || !m_execution.ValueExists("jobDocument"))
+            {
+                return Crt::Optional<Crt::JsonView>();
+            }
+
+            return Crt::Optional<Crt::JsonView>(m_execution.GetJsonObject("jobDocument"));
+        }
+
+        const Crt::Optional<Iotdevicecommon::FlatStringMap> &JobExecutionDataView::GetStatusDetails() const
+        {
+            if (!m_statusDetailsDecoded)
+            {
+                m_statusDetailsDecoded = true;
+                if (HasExecution() && m_execution.ValueExists("statusDetails"))
+                {
+                    auto statusDetailsMap = m_execution.GetJsonObject("statusDetails").GetAllObjects();
+                    m_statusDetails = Iotdevicecommon::FlatStringMap();
+                    m_statusDetails->reserve(statusDetailsMap.size());
+                    for (auto &statusDetailsMapMember : statusDetailsMap)
+                    {
+                        m_statusDetails->emplace(
+                            statusDetailsMapMember.first, statusDetailsMapMember.second.AsString());
+                    }
+                }
+            }
+
+            return m_statusDetails;
+        }
+
+        Crt::Optional<Crt::String> JobExecutionDataView::GetClientToken() const
+        {
+            if (!m_message || !m_message->View().ValueExists("clientToken"))
+            {
+                return Crt::Optional<Crt::String>();
+            }
+
+            return Crt::Optional<Crt::String>(m_message->View().GetString("clientToken"));
+        }
+
+        Crt::Optional<Crt::DateTime> JobExecutionDataView::GetTimestamp() const
+        {
+            if (!m_message || !m_message->View().ValueExists("timestamp"))
+            {
+                return Crt::Optional<Crt::DateTime>();
+            }
+
+            return Crt::Optional<Crt::DateTime>(Crt::DateTime(m_message->View().GetDouble("timestamp")));
+        }
+
+        JobExecutionData JobExecutionDataView::Materialize() const
+        {
+            if (!HasExecution())
+            {
+                return JobExecutionData();
+            }
+
+            return JobExecutionData(m_execution);
+        }
+
+    } // namespace Iotjobs
+} // namespace Aws
@@ -4,64 +4,35 @@
  */
 #include <aws/iotjobs/JobExecutionState.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<JobExecutionState>;
+            using JobStatusCodec = Aws::Iotdevicecommon::EnumCodec<
+                JobStatus,
+                JobStatusMarshaller::FromString,
+                JobStatusMarshaller::ToString>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<JobExecutionState> s_fields[] = {
+                Fields::Field<Aws::Iotdevicecommon::FlatStringMap, &JobExecutionState::StatusDetails>("statusDetails"),
+                Fields::Field<int32_t, &JobExecutionState::VersionNumber>("versionNumber"),
+                Fields::Field<JobStatus, &JobExecutionState::Status, JobStatusCodec>("status"),
+            };
+        } // namespace
 
         void JobExecutionState::LoadFromObject(JobExecutionState &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("statusDetails"))
-            {
-                auto statusDetailsMap = doc.GetJsonObject("statusDetails");
-                val.StatusDetails = Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
-                for (auto &statusDetailsMapMember : statusDetailsMap.GetAllObjects())
-                {
-                    Aws::Crt::String statusDetailsMapValMember;
-                    statusDetailsMapValMember = statusDetailsMapMember.second.AsString();
-                    val.StatusDetails->emplace(statusDetailsMapMember.first, std::move(statusDetailsMapValMember));
-                }
-            }
-
-            if (doc.ValueExists("versionNumber"))
-            {
-                val.VersionNumber = doc.GetInteger("versionNumber");
-            }
-
-            if (doc.ValueExists("status"))
-            {
-                val.Status = JobStatusMarshaller::FromString(doc.GetString("status"));
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void JobExecutionState::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (StatusDetails)
-            {
-                Aws::Crt::JsonObject statusDetailsMap;
-                for (auto &statusDetailsMapMember : *StatusDetails)
-                {
-                    Aws::Crt::JsonObject statusDetailsMapValMember;
-                    statusDetailsMapValMember.AsString(statusDetailsMapMember.second);
-                    statusDetailsMap.WithObject(statusDetailsMapMember.first, std::move(statusDetailsMapValMember));
-                }
-                object.WithObject("statusDetails", std::move(statusDetailsMap));
-            }
-
-            if (VersionNumber)
-            {
-                object.WithInteger("versionNumber", *VersionNumber);
-            }
-
-            if (Status)
-            {
-                object.WithString("status", JobStatusMarshaller::ToString(*Status));
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         JobExecutionState::JobExecutionState(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
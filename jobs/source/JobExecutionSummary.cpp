@@ -4,80 +4,34 @@
  */
 #include <aws/iotjobs/JobExecutionSummary.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<JobExecutionSummary>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<JobExecutionSummary> s_fields[] = {
+                Fields::Timestamp<&JobExecutionSummary::LastUpdatedAt>("lastUpdatedAt"),
+                Fields::Field<int64_t, &JobExecutionSummary::ExecutionNumber>("executionNumber"),
+                Fields::Timestamp<&JobExecutionSummary::StartedAt>("startedAt"),
+                Fields::Field<int32_t, &JobExecutionSummary::VersionNumber>("versionNumber"),
+                Fields::Field<Crt::String, &JobExecutionSummary::JobId>("jobId"),
+                Fields::Timestamp<&JobExecutionSummary::QueuedAt>("queuedAt"),
+            };
+        } // namespace
 
         void JobExecutionSummary::LoadFromObject(JobExecutionSummary &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("lastUpdatedAt"))
-            {
-                val.LastUpdatedAt = doc.GetDouble("lastUpdatedAt");
-            }
-
-            if (doc.ValueExists("executionNumber"))
-            {
-                val.ExecutionNumber = doc.GetInt64("executionNumber");
-            }
-
-            if (doc.ValueExists("startedAt"))
-            {
-                val.StartedAt = doc.GetDouble("startedAt");
-            }
-
-            if (doc.ValueExists("versionNumber"))
-            {
-                val.VersionNumber = doc.GetInteger("versionNumber");
-            }
-
-            if (doc.ValueExists("jobId"))
-            {
-                val.JobId = doc.GetString("jobId");
-            }
-
-            if (doc.ValueExists("queuedAt"))
-            {
-                val.QueuedAt = doc.GetDouble("queuedAt");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void JobExecutionSummary::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (LastUpdatedAt)
-            {
-                object.WithDouble("lastUpdatedAt", LastUpdatedAt->SecondsWithMSPrecision());
-            }
-
-            if (ExecutionNumber)
-            {
-                object.WithInt64("executionNumber", *ExecutionNumber);
-            }
-
-            if (StartedAt)
-            {
-                object.WithDouble("startedAt", StartedAt->SecondsWithMSPrecision());
-            }
-
-            if (VersionNumber)
-            {
-                object.WithInteger("versionNumber", *VersionNumber);
-            }
-
-            if (JobId)
-            {
-                object.WithString("jobId", *JobId);
-            }
-
-            if (QueuedAt)
-            {
-                object.WithDouble("queuedAt", QueuedAt->SecondsWithMSPrecision());
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         JobExecutionSummary::JobExecutionSummary(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
@@ -36,7 +36,7 @@ namespace Aws
 
             if (doc.ValueExists("timestamp"))
             {
-                val.Timestamp = doc.GetDouble("timestamp");
+                val.Timestamp = Aws::Iotdevicecommon::PackedDateTime::FromSeconds(doc.GetDouble("timestamp"));
             }
         }
 
@@ -68,7 +68,7 @@ namespace Aws
 
             if (Timestamp)
             {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
+                object.WithDouble("timestamp", Timestamp.Seconds());
             }
         }
 
@@ -80,5 +80,56 @@ namespace Aws
             return *this;
         }
 
+        void JobExecutionsChangedEvent::Reload(const Crt::JsonView &doc)
+        {
+            if (doc.ValueExists("jobs"))
+            {
+                if (!Jobs)
+                {
+                    Jobs.emplace();
+                }
+
+                /* Keep each status's vector, and with it its capacity, for statuses still listed. */
+                for (auto &jobsMapMember : *Jobs)
+                {
+                    jobsMapMember.second.clear();
+                }
+                auto jobsMap = doc.GetJsonObject("jobs");
+                for (auto &jobsMapMember : jobsMap.GetAllObjects())
+                {
+                    auto &jobsMapValMember = (*Jobs)[JobStatusMarshaller::FromString(jobsMapMember.first)];
+                    auto valueList = jobsMapMember.second.AsArray();
+                    for (auto &valueListMember : valueList)
+                    {
+                        Aws::Iotjobs::JobExecutionSummary valueListValMember;
+                        valueListValMember = valueListMember.AsObject();
+                        jobsMapValMember.push_back(std::move(valueListValMember));
+                    }
+                }
+                for (auto jobsMapMember = Jobs->begin(); jobsMapMember != Jobs->end();)
+                {
+                    if (jobsMapMember->second.empty() &&
+                        !jobsMap.ValueExists(JobStatusMarshaller::ToString(jobsMapMember->first)))
+                    {
+                        jobsMapMember = Jobs->erase(jobsMapMember);
+                    }
+                    else
+                    {
+                        ++jobsMapMember;
+                    }
+                }
+            }
+            else
+            {
+                Jobs.reset();
+            }
+
+            Timestamp.reset();
+            if (doc.ValueExists("timestamp"))
+            {
+                Timestamp = Aws::Iotdevicecommon::PackedDateTime::FromSeconds(doc.GetDouble("timestamp"));
+            }
+        }
+
     } // namespace Iotjobs
 } // namespace Aws
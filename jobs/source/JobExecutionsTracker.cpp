@@ -0,0 +1,161 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobExecutionsTracker.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        namespace
+        {
+            template <typename T> bool s_differs(const Crt::Optional<T> &previous, const Crt::Optional<T> &current)
+            {
+                return previous.has_value() != current.has_value() || (previous && *previous != *current);
+            }
+
+            bool s_summaryChanged(const JobExecutionSummary &previous, const JobExecutionSummary &current)
+            {
+                return s_differs(previous.VersionNumber, current.VersionNumber) ||
+                       s_differs(previous.ExecutionNumber, current.ExecutionNumber);
+            }
+
+            JobExecutionChange s_change(
+                JobExecutionChange::Kind type,
+                const Crt::String &jobId,
+                JobStatus status,
+                const JobExecutionSummary &summary)
+            {
+                JobExecutionChange change;
+                change.Type = type;
+                change.JobId = jobId;
+                change.Status = status;
+                change.Summary = summary;
+                return change;
+            }
+        } // namespace
+
+        JobExecutionsTracker::JobExecutionsTracker() noexcept : m_lock(), m_executions(), m_generation(0) {}
+
+        Crt::Vector<JobExecutionChange> JobExecutionsTracker::Apply(const JobExecutionsChangedEvent &event)
+        {
+            Crt::Vector<JobExecutionChange> changes;
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (event.Timestamp && m_lastTimestamp && event.Timestamp.Milliseconds() < m_lastTimestamp.Milliseconds())
+            {
+                return changes;
+            }
+            if (event.Timestamp)
+            {
+                m_lastTimestamp = event.Timestamp;
+            }
+
+            uint64_t generation = ++m_generation;
+            if (event.Jobs)
+            {
+                for (const auto &statusJobs : *event.Jobs)
+                {
+                    for (const JobExecutionSummary &summary : statusJobs.second)
+                    {
+                        if (!summary.JobId)
+                        {
+                            continue;
+                        }
+
+                        auto tracked = m_executions.find(*summary.JobId);
+                        if (tracked == m_executions.end())
+                        {
+                            Tracked added;
+                            added.Status = statusJobs.first;
+                            added.Summary = summary;
+                            added.Generation = generation;
+                            m_executions.emplace(*summary.JobId, std::move(added));
+                            changes.push_back(
+                                s_change(JobExecutionChange::Kind::Added, *summary.JobId, statusJobs.first, summary));
+                            continue;
+                        }
+
+                        Tracked &current = tracked->second;
+                        current.Generation = generation;
+                        if (current.Status != statusJobs.first || s_summaryChanged(current.Summary, summary))
+                        {
+                            JobExecutionChange change = s_change(
+                                JobExecutionChange::Kind::Changed, *summary.JobId, statusJobs.first, summary);
+                            change.PreviousStatus = current.Status;
+                            changes.push_back(std::move(change));
+                            current.Status = statusJobs.first;
+                        }
+                        current.Summary = summary;
+                    }
+                }
+            }
+
+            for (auto tracked = m_executions.begin(); tracked != m_executions.end();)
+            {
+                if (tracked->second.Generation == generation)
+                {
+                    ++tracked;
+                    continue;
+                }
+
+                changes.push_back(s_change(
+                    JobExecutionChange::Kind::Removed,
+                    tracked->first,
+                    tracked->second.Status,
+                    tracked->second.Summary));
+                tracked = m_executions.erase(tracked);
+            }
+
+            return changes;
+        }
+
+        const JobExecutionSummary *JobExecutionsTracker::Find(const Crt::String &jobId, JobStatus &status) const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto tracked = m_executions.find(jobId);
+            if (tracked == m_executions.end())
+            {
+                return nullptr;
+            }
+
+            status = tracked->second.Status;
+            return &tracked->second.Summary;
+        }
+
+        size_t JobExecutionsTracker::GetExecutionCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_executions.size();
+        }
+
+        void JobExecutionsTracker::Reset()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_executions.clear();
+            m_lastTimestamp.reset();
+        }
+
+        OnSubscribeToJobExecutionsChangedEventsResponse JobExecutionsTracker::Adapt(
+            const std::shared_ptr<JobExecutionsTracker> &tracker,
+            OnJobExecutionChanges &&onChanges)
+        {
+            OnJobExecutionChanges handler(std::move(onChanges));
+            return [tracker, handler](JobExecutionsChangedEvent *event, int ioErr) {
+                if (ioErr || !event)
+                {
+                    handler(Crt::Vector<JobExecutionChange>(), ioErr ? ioErr : AWS_ERROR_UNKNOWN);
+                    return;
+                }
+
+                Crt::Vector<JobExecutionChange> changes = tracker->Apply(*event);
+                if (!changes.empty())
+                {
+                    handler(changes, AWS_ERROR_SUCCESS);
+                }
+            };
+        }
+
+    } // namespace Iotjobs
+} // namespace Aws
@@ -0,0 +1,428 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobExecutor.h>
+
+#include <aws/iotjobs/DescribeJobExecutionRequest.h>
+#include <aws/iotjobs/DescribeJobExecutionResponse.h>
+#include <aws/iotjobs/GetPendingJobExecutionsRequest.h>
+#include <aws/iotjobs/GetPendingJobExecutionsResponse.h>
+#include <aws/iotjobs/JobExecutionSummary.h>
+#include <aws/iotjobs/JobExecutionsChangedEvent.h>
+#include <aws/iotjobs/JobExecutionsChangedSubscriptionRequest.h>
+#include <aws/iotjobs/RejectedError.h>
+#include <aws/iotjobs/UpdateJobExecutionResponse.h>
+
+#include <aws/iotdevicecommon/WorkStealingExecutor.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        JobExecutorConfig::JobExecutorConfig() noexcept
+            : MaxConcurrentJobs(2), JobTypeField("operation"), DefaultPriority(0), Qos(AWS_MQTT_QOS_AT_LEAST_ONCE)
+        {
+        }
+
+        JobRun::JobRun(
+            const std::shared_ptr<JobExecutor> &executor,
+            const std::shared_ptr<JobsRequestCorrelator> &correlator,
+            JobExecutionData &&execution,
+            const std::shared_ptr<const Crt::JsonObject> &document,
+            const Crt::String &jobType,
+            Crt::Allocator *allocator) noexcept
+            : m_executor(executor), m_correlator(correlator), m_execution(std::move(execution)),
+              m_jobId(m_execution.JobId.has_value() ? *m_execution.JobId : Crt::String()), m_jobType(jobType),
+              m_document(document), m_allocator(allocator), m_sending(false), m_completed(false)
+        {
+        }
+
+        bool JobRun::ReportProgress(
+            const Iotdevicecommon::FlatStringMap &statusDetails,
+            const OnUpdateJobExecutionComplete &onComplete)
+        {
+            return Enqueue(UpdateKind::Progress, JobStatus::IN_PROGRESS, &statusDetails, onComplete);
+        }
+
+        bool JobRun::Complete(
+            JobStatus status,
+            const Iotdevicecommon::FlatStringMap &statusDetails,
+            const OnUpdateJobExecutionComplete &onComplete)
+        {
+            return Enqueue(UpdateKind::Terminal, status, &statusDetails, onComplete);
+        }
+
+        bool JobRun::Enqueue(
+            UpdateKind kind,
+            JobStatus status,
+            const Iotdevicecommon::FlatStringMap *statusDetails,
+            const OnUpdateJobExecutionComplete &onComplete)
+        {
+            Update update;
+            update.Kind = kind;
+            update.Request.JobId = m_jobId;
+            update.Request.Status = status;
+            if (statusDetails)
+            {
+                update.Request.StatusDetails = *statusDetails;
+            }
+            update.Request.IncludeJobDocument = false;
+            update.OnComplete = onComplete;
+
+            bool send = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_completed)
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_STATE);
+                    return false;
+                }
+                if (kind == UpdateKind::Terminal)
+                {
+                    m_completed = true;
+                }
+
+                m_updates.push_back(std::move(update));
+                if (!m_sending)
+                {
+                    m_sending = true;
+                    send = true;
+                }
+            }
+
+            if (send)
+            {
+                SendFront();
+            }
+            return true;
+        }
+
+        void JobRun::SendFront()
+        {
+            UpdateJobExecutionRequest request;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                request = m_updates.front().Request;
+            }
+
+            std::weak_ptr<JobRun> weakRun = shared_from_this();
+            auto onUpdated = [weakRun](UpdateJobExecutionResponse *response, RejectedError *error, int ioErr) {
+                auto run = weakRun.lock();
+                if (run)
+                {
+                    run->OnUpdated(response, error, ioErr);
+                }
+            };
+
+            if (!m_correlator->UpdateJobExecutionAsync(request, onUpdated))
+            {
+                OnUpdated(nullptr, nullptr, Crt::LastErrorOrUnknown());
+            }
+        }
+
+        void JobRun::OnUpdated(UpdateJobExecutionResponse *response, RejectedError *error, int ioErr)
+        {
+            Update update;
+            bool sendNext = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                update = std::move(m_updates.front());
+                m_updates.pop_front();
+                if (update.Kind == UpdateKind::Terminal && !response && !error)
+                {
+                    /* Never reached the service, so the job is still ours to finish. */
+                    m_completed = false;
+                }
+                sendNext = !m_updates.empty();
+                m_sending = sendNext;
+            }
+
+            if (update.OnComplete)
+            {
+                update.OnComplete(response, error, ioErr);
+            }
+
+            auto executor = m_executor.lock();
+            if (executor)
+            {
+                if (update.Kind == UpdateKind::Start)
+                {
+                    if (response)
+                    {
+                        executor->Run(shared_from_this());
+                    }
+                    else
+                    {
+                        /* Cancelled meanwhile, or unreachable: leave it to a later poll. */
+                        executor->Finish(m_jobId, false);
+                    }
+                }
+                else if (update.Kind == UpdateKind::Terminal && (response || error))
+                {
+                    executor->Finish(m_jobId, true);
+                }
+            }
+
+            if (sendNext)
+            {
+                SendFront();
+            }
+        }
+
+        JobExecutor::JobExecutor(
+            const IotJobsClient &client,
+            const std::shared_ptr<JobsRequestCorrelator> &correlator,
+            const Crt::String &thingName,
+            const JobExecutorConfig &config,
+            const OnRunJob &onRunJob,
+            Crt::Allocator *allocator) noexcept
+            : m_client(client), m_correlator(correlator), m_thingName(thingName), m_config(config),
+              m_onRunJob(onRunJob), m_allocator(allocator), m_nextSequence(0)
+        {
+            if (m_config.MaxConcurrentJobs == 0)
+            {
+                m_config.MaxConcurrentJobs = 1;
+            }
+        }
+
+        std::shared_ptr<JobExecutor> JobExecutor::Create(
+            const IotJobsClient &client,
+            const std::shared_ptr<JobsRequestCorrelator> &correlator,
+            const Crt::String &thingName,
+            const JobExecutorConfig &config,
+            const OnRunJob &onRunJob,
+            Crt::Allocator *allocator)
+        {
+            if (!correlator || !onRunJob)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<JobExecutor *>(aws_mem_acquire(allocator, sizeof(JobExecutor)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) JobExecutor(client, correlator, thingName, config, onRunJob, allocator);
+            std::shared_ptr<JobExecutor> executor(
+                toSeat, [allocator](JobExecutor *executor) { Crt::Delete(executor, allocator); });
+
+            if (!executor->m_config.Executor)
+            {
+                executor->m_ownedPool =
+                    Iotdevicecommon::WorkStealingExecutor::Create(executor->m_config.MaxConcurrentJobs, allocator);
+                if (!executor->m_ownedPool)
+                {
+                    return nullptr;
+                }
+                executor->m_config.Executor = executor->m_ownedPool->AsHandlerExecutor();
+            }
+
+            return executor;
+        }
+
+        bool JobExecutor::Subscribe(const OnSubscribeComplete &onSubAck)
+        {
+            std::weak_ptr<JobExecutor> weakExecutor = shared_from_this();
+            auto onChanged = [weakExecutor](JobExecutionsChangedEvent *event, int ioErr) {
+                auto executor = weakExecutor.lock();
+                if (executor && event && ioErr == AWS_ERROR_SUCCESS)
+                {
+                    executor->Poll();
+                }
+            };
+
+            JobExecutionsChangedSubscriptionRequest request;
+            request.ThingName = m_thingName;
+            return m_client.SubscribeToJobExecutionsChangedEvents(request, m_config.Qos, onChanged, onSubAck);
+        }
+
+        bool JobExecutor::Poll()
+        {
+            std::weak_ptr<JobExecutor> weakExecutor = shared_from_this();
+            auto onPending = [weakExecutor](GetPendingJobExecutionsResponse *response, RejectedError *, int ioErr) {
+                auto executor = weakExecutor.lock();
+                if (!executor || !response || ioErr != AWS_ERROR_SUCCESS)
+                {
+                    return;
+                }
+
+                struct NewJob
+                {
+                    Crt::String JobId;
+                    uint64_t Sequence;
+                    bool Resumed;
+                };
+                Crt::Vector<NewJob> newJobs;
+                {
+                    std::lock_guard<std::mutex> lock(executor->m_lock);
+                    auto collect = [&](const Crt::Optional<Crt::Vector<JobExecutionSummary>> &jobs, bool resumed) {
+                        if (!jobs.has_value())
+                        {
+                            return;
+                        }
+                        for (const auto &summary : *jobs)
+                        {
+                            if (summary.JobId.has_value() && executor->m_known.emplace(*summary.JobId, true).second)
+                            {
+                                newJobs.push_back({*summary.JobId, executor->m_nextSequence++, resumed});
+                            }
+                        }
+                    };
+
+                    /* The lists come in queue order; executions already in progress were queued before. */
+                    collect(response->InProgressJobs, true);
+                    collect(response->QueuedJobs, false);
+                }
+
+                for (const auto &job : newJobs)
+                {
+                    executor->Describe(job.JobId, job.Sequence, job.Resumed);
+                }
+            };
+
+            return m_correlator->GetPendingJobExecutionsAsync(GetPendingJobExecutionsRequest(), onPending);
+        }
+
+        void JobExecutor::Describe(const Crt::String &jobId, uint64_t sequence, bool resumed)
+        {
+            std::weak_ptr<JobExecutor> weakExecutor = shared_from_this();
+            auto onDescribed = [weakExecutor, jobId, sequence, resumed](
+                                   DescribeJobExecutionResponse *response, RejectedError *, int ioErr) {
+                auto executor = weakExecutor.lock();
+                if (!executor)
+                {
+                    return;
+                }
+
+                if (!response || !response->Execution.has_value() || ioErr != AWS_ERROR_SUCCESS)
+                {
+                    /* Gone from the queue, or to be retried by the next poll. */
+                    executor->Finish(jobId, false);
+                    return;
+                }
+
+                ReadyJob ready;
+                ready.Execution = std::move(*response->Execution);
+                ready.Execution.JobId = jobId;
+                ready.Resumed = resumed;
+                if (ready.Execution.JobDocument.has_value())
+                {
+                    Crt::JsonView document = ready.Execution.JobDocument->View();
+                    const Crt::String &field = executor->m_config.JobTypeField;
+                    if (document.ValueExists(field) && document.GetJsonObject(field).IsString())
+                    {
+                        ready.JobType = document.GetString(field);
+                    }
+                    ready.Document = Crt::MakeShared<Crt::JsonObject>(
+                        executor->m_allocator, std::move(*ready.Execution.JobDocument));
+                    ready.Execution.JobDocument.reset();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(executor->m_lock);
+                    ReadyKey key(-executor->PriorityOf(ready.JobType), sequence);
+                    executor->m_ready.emplace(key, std::move(ready));
+                }
+                executor->Pump();
+            };
+
+            DescribeJobExecutionRequest request;
+            request.JobId = jobId;
+            request.IncludeJobDocument = true;
+            if (!m_correlator->DescribeJobExecutionAsync(request, onDescribed))
+            {
+                Finish(jobId, false);
+            }
+        }
+
+        void JobExecutor::Pump()
+        {
+            Crt::Vector<std::shared_ptr<JobRun>> toStart;
+            Crt::Vector<std::shared_ptr<JobRun>> toResume;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                while (!m_ready.empty() && m_running.size() < m_config.MaxConcurrentJobs)
+                {
+                    ReadyJob ready = std::move(m_ready.begin()->second);
+                    m_ready.erase(m_ready.begin());
+
+                    auto *toSeat = static_cast<JobRun *>(aws_mem_acquire(m_allocator, sizeof(JobRun)));
+                    if (!toSeat)
+                    {
+                        m_known.erase(*ready.Execution.JobId);
+                        continue;
+                    }
+
+                    Crt::Allocator *allocator = m_allocator;
+                    toSeat = new (toSeat) JobRun(
+                        shared_from_this(),
+                        m_correlator,
+                        std::move(ready.Execution),
+                        ready.Document,
+                        ready.JobType,
+                        allocator);
+                    std::shared_ptr<JobRun> run(toSeat, [allocator](JobRun *run) { Crt::Delete(run, allocator); });
+                    m_running.emplace(run->GetJobId(), run);
+                    (ready.Resumed ? toResume : toStart).push_back(std::move(run));
+                }
+            }
+
+            for (const auto &run : toStart)
+            {
+                run->Enqueue(JobRun::UpdateKind::Start, JobStatus::IN_PROGRESS, nullptr, nullptr);
+            }
+            for (const auto &run : toResume)
+            {
+                Run(run);
+            }
+        }
+
+        void JobExecutor::Run(const std::shared_ptr<JobRun> &run)
+        {
+            /* The task holds no reference to the executor, so a pool it owns is never destroyed from a task. */
+            OnRunJob onRunJob = m_onRunJob;
+            m_config.Executor(run->GetJobId(), [run, onRunJob]() { onRunJob(run); });
+        }
+
+        void JobExecutor::Finish(const Crt::String &jobId, bool poll)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_running.erase(jobId);
+                m_known.erase(jobId);
+                /* The ready list still has work; completions only poll to refill it. */
+                poll = poll && m_ready.empty();
+            }
+
+            Pump();
+            if (poll)
+            {
+                Poll();
+            }
+        }
+
+        int32_t JobExecutor::PriorityOf(const Crt::String &jobType) const
+        {
+            auto priority = m_config.PriorityByJobType.find(jobType);
+            return priority != m_config.PriorityByJobType.end() ? priority->second : m_config.DefaultPriority;
+        }
+
+        size_t JobExecutor::GetRunningCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_running.size();
+        }
+
+        size_t JobExecutor::GetReadyCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_ready.size();
+        }
+
+    } // namespace Iotjobs
+
+} // namespace Aws
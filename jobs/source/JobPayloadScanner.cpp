@@ -0,0 +1,30 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobPayloadScanner.h>
+
+#include <aws/iotdevicecommon/JsonPayloadScanner.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        namespace JobPayloadScanner
+        {
+            bool FindMember(const Crt::ByteCursor &object, const char *key, Crt::ByteCursor &value) noexcept
+            {
+                return Iotdevicecommon::JsonPayloadScanner::FindMember(object, key, value);
+            }
+
+            bool FindJobDocument(const Crt::ByteCursor &payload, Crt::ByteCursor &jobDocument) noexcept
+            {
+                Crt::ByteCursor execution;
+                return FindMember(payload, "execution", execution) &&
+                       FindMember(execution, "jobDocument", jobDocument);
+            }
+        } // namespace JobPayloadScanner
+
+    } // namespace Iotjobs
+} // namespace Aws
@@ -0,0 +1,240 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobPrefetcher.h>
+
+#include <aws/iotjobs/DescribeJobExecutionResponse.h>
+#include <aws/iotjobs/GetPendingJobExecutionsRequest.h>
+#include <aws/iotjobs/GetPendingJobExecutionsResponse.h>
+#include <aws/iotjobs/JobExecutionSummary.h>
+#include <aws/iotjobs/StartNextJobExecutionResponse.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        namespace
+        {
+            const JobExecutionSummary *s_firstOther(
+                const Crt::Optional<Crt::Vector<JobExecutionSummary>> &jobs,
+                const Crt::String &currentJobId)
+            {
+                if (!jobs.has_value())
+                {
+                    return nullptr;
+                }
+
+                for (const auto &summary : *jobs)
+                {
+                    if (summary.JobId.has_value() && *summary.JobId != currentJobId)
+                    {
+                        return &summary;
+                    }
+                }
+
+                return nullptr;
+            }
+        } // namespace
+
+        JobPrefetcher::JobPrefetcher(
+            const std::shared_ptr<JobsRequestCorrelator> &correlator,
+            const std::shared_ptr<JobDocumentCache> &cache,
+            Crt::Allocator *allocator) noexcept
+            : m_correlator(correlator), m_cache(cache), m_allocator(allocator), m_generation(0), m_hitCount(0),
+              m_missCount(0)
+        {
+            if (!m_cache)
+            {
+                m_cache = Crt::MakeShared<JobDocumentCache>(allocator, 16, allocator);
+            }
+        }
+
+        std::shared_ptr<JobPrefetcher> JobPrefetcher::Create(
+            const std::shared_ptr<JobsRequestCorrelator> &correlator,
+            const std::shared_ptr<JobDocumentCache> &cache,
+            Crt::Allocator *allocator)
+        {
+            if (!correlator)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<JobPrefetcher *>(aws_mem_acquire(allocator, sizeof(JobPrefetcher)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) JobPrefetcher(correlator, cache, allocator);
+                std::shared_ptr<JobPrefetcher> prefetcher(
+                    toSeat, [allocator](JobPrefetcher *prefetcher) { Crt::Delete(prefetcher, allocator); });
+                if (!prefetcher->m_cache)
+                {
+                    aws_raise_error(AWS_ERROR_OOM);
+                    return nullptr;
+                }
+                return prefetcher;
+            }
+
+            return nullptr;
+        }
+
+        bool JobPrefetcher::PrefetchNext(const Crt::String &currentJobId)
+        {
+            uint64_t generation = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                generation = ++m_generation;
+                m_prefetched.reset();
+                m_prefetchedDocument.reset();
+            }
+
+            std::weak_ptr<JobPrefetcher> weakPrefetcher = shared_from_this();
+            auto onPending = [weakPrefetcher, currentJobId, generation](
+                                 GetPendingJobExecutionsResponse *response, RejectedError *, int ioErr) {
+                auto prefetcher = weakPrefetcher.lock();
+                if (!prefetcher || !response || ioErr != AWS_ERROR_SUCCESS)
+                {
+                    return;
+                }
+
+                /* StartNext resumes executions already in progress before it starts a queued one. */
+                const JobExecutionSummary *next = s_firstOther(response->InProgressJobs, currentJobId);
+                if (!next)
+                {
+                    next = s_firstOther(response->QueuedJobs, currentJobId);
+                }
+                if (next)
+                {
+                    prefetcher->Describe(*next->JobId, generation);
+                }
+            };
+
+            return m_correlator->GetPendingJobExecutionsAsync(GetPendingJobExecutionsRequest(), onPending);
+        }
+
+        void JobPrefetcher::Describe(const Crt::String &jobId, uint64_t generation)
+        {
+            std::weak_ptr<JobPrefetcher> weakPrefetcher = shared_from_this();
+            auto onDescribed = [weakPrefetcher, generation](
+                                   DescribeJobExecutionResponse *response, RejectedError *, int ioErr) {
+                auto prefetcher = weakPrefetcher.lock();
+                if (!prefetcher || !response || !response->Execution.has_value() || ioErr != AWS_ERROR_SUCCESS)
+                {
+                    return;
+                }
+
+                /* Decoding into the cache happens here, off the agent's critical path. */
+                auto document = prefetcher->m_cache->Resolve(*response->Execution);
+                if (!document)
+                {
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lock(prefetcher->m_lock);
+                if (generation == prefetcher->m_generation)
+                {
+                    prefetcher->m_prefetched = std::move(*response->Execution);
+                    prefetcher->m_prefetchedDocument = std::move(document);
+                }
+            };
+
+            DescribeJobExecutionRequest request;
+            request.JobId = jobId;
+            request.IncludeJobDocument = true;
+            m_cache->Prepare(request);
+            m_correlator->DescribeJobExecutionAsync(request, onDescribed);
+        }
+
+        bool JobPrefetcher::StartNext(
+            const StartNextPendingJobExecutionRequest &request,
+            const OnNextJobReady &onReady,
+            const OnStartNextPendingJobExecutionComplete &onComplete)
+        {
+            if (!onReady)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Crt::Optional<JobExecutionData> prefetched;
+            std::shared_ptr<const Crt::JsonObject> prefetchedDocument;
+            Crt::Optional<Crt::String> handedOut;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                ++m_generation;
+                if (m_handedOut.has_value())
+                {
+                    /* A retry after the StartNext carrying this job failed; the agent already runs it. */
+                    handedOut = *m_handedOut;
+                }
+                else if (m_prefetched.has_value())
+                {
+                    prefetched = std::move(m_prefetched);
+                    prefetchedDocument = std::move(m_prefetchedDocument);
+                    if (prefetched->JobId.has_value())
+                    {
+                        handedOut = *prefetched->JobId;
+                        m_handedOut = *prefetched->JobId;
+                    }
+                }
+                m_prefetched.reset();
+                m_prefetchedDocument.reset();
+            }
+
+            if (prefetched.has_value())
+            {
+                onReady(*prefetched, prefetchedDocument);
+            }
+
+            std::weak_ptr<JobPrefetcher> weakPrefetcher = shared_from_this();
+            auto onStarted = [weakPrefetcher, handedOut, onReady, onComplete](
+                                 StartNextJobExecutionResponse *response, RejectedError *error, int ioErr) {
+                auto prefetcher = weakPrefetcher.lock();
+                if (prefetcher && ioErr == AWS_ERROR_SUCCESS)
+                {
+                    std::lock_guard<std::mutex> lock(prefetcher->m_lock);
+                    prefetcher->m_handedOut.reset();
+                }
+
+                if (prefetcher && response && response->Execution.has_value() && ioErr == AWS_ERROR_SUCCESS)
+                {
+                    JobExecutionData &execution = *response->Execution;
+                    auto document = prefetcher->m_cache->Resolve(execution);
+                    if (handedOut.has_value() && execution.JobId.has_value() && *execution.JobId == *handedOut)
+                    {
+                        ++prefetcher->m_hitCount;
+                    }
+                    else
+                    {
+                        ++prefetcher->m_missCount;
+                        onReady(execution, document);
+                    }
+                }
+                else if (prefetcher && ioErr == AWS_ERROR_SUCCESS)
+                {
+                    ++prefetcher->m_missCount;
+                }
+
+                if (onComplete)
+                {
+                    onComplete(response, error, ioErr);
+                }
+            };
+
+            return m_correlator->StartNextPendingJobExecutionAsync(request, onStarted);
+        }
+
+        Crt::Optional<Crt::String> JobPrefetcher::GetPrefetchedJobId() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_prefetched.has_value() || !m_prefetched->JobId.has_value())
+            {
+                return Crt::Optional<Crt::String>();
+            }
+
+            return Crt::Optional<Crt::String>(*m_prefetched->JobId);
+        }
+
+    } // namespace Iotjobs
+
+} // namespace Aws
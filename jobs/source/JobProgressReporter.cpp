@@ -0,0 +1,264 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobProgressReporter.h>
+
+#include <aws/common/clock.h>
+#include <aws/io/event_loop.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        namespace
+        {
+            struct FlushTask
+            {
+                aws_task Task;
+                std::weak_ptr<JobProgressReporter> Owner;
+                uint64_t Key;
+                Crt::Allocator *Allocator;
+            };
+
+            /* The replacement never saw the version bump its predecessor would have caused, so reuse the oldest. */
+            void s_supersede(UpdateJobExecutionRequest &replacement, const UpdateJobExecutionRequest &superseded)
+            {
+                if (superseded.ExpectedVersion)
+                {
+                    replacement.ExpectedVersion = superseded.ExpectedVersion;
+                }
+            }
+        } // namespace
+
+        JobProgressReporterConfig::JobProgressReporterConfig() noexcept
+            : MinReportIntervalMs(1000), Qos(AWS_MQTT_QOS_AT_LEAST_ONCE)
+        {
+        }
+
+        JobProgressReporter::JobProgressReporter(
+            const IotJobsClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const JobProgressReporterConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_client(client), m_config(config), m_allocator(allocator),
+              m_eventLoop(aws_event_loop_group_get_next_loop(eventLoopGroup.GetUnderlyingHandle())),
+              m_registry(config.Registry), m_executions(allocator)
+        {
+            if (!m_registry)
+            {
+                m_registry = Crt::MakeShared<Iotdevicecommon::ThingRegistry>(allocator, allocator);
+            }
+        }
+
+        JobProgressReporter::~JobProgressReporter() { Flush(); }
+
+        std::shared_ptr<JobProgressReporter> JobProgressReporter::Create(
+            const IotJobsClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const JobProgressReporterConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<JobProgressReporter *>(aws_mem_acquire(allocator, sizeof(JobProgressReporter)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) JobProgressReporter(client, eventLoopGroup, config, allocator);
+                std::shared_ptr<JobProgressReporter> reporter(
+                    toSeat, [allocator](JobProgressReporter *reporter) { Crt::Delete(reporter, allocator); });
+                if (!reporter->m_registry)
+                {
+                    aws_raise_error(AWS_ERROR_OOM);
+                    return nullptr;
+                }
+                return reporter;
+            }
+
+            return nullptr;
+        }
+
+        bool JobProgressReporter::ReportProgress(
+            const UpdateJobExecutionRequest &request,
+            const OnPublishComplete &onPubAck)
+        {
+            if (!request.ThingName || !request.JobId)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            const Iotdevicecommon::NameId thingId = m_registry->Intern(*request.ThingName);
+            const Iotdevicecommon::NameId jobId = m_registry->Intern(*request.JobId);
+            if (thingId == Iotdevicecommon::InvalidNameId || jobId == Iotdevicecommon::InvalidNameId)
+            {
+                aws_raise_error(AWS_ERROR_OOM);
+                return false;
+            }
+
+            const uint64_t key = Iotdevicecommon::ThingRegistry::PairKey(thingId, jobId);
+            bool isProgress = !request.Status || *request.Status == JobStatus::IN_PROGRESS;
+            uint64_t now = Now();
+            uint64_t interval =
+                aws_timestamp_convert(m_config.MinReportIntervalMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+
+            UpdateJobExecutionRequest toPublish(request);
+            Crt::Vector<OnPublishComplete> callbacks;
+            bool scheduleFlush = false;
+            uint64_t dueNs = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                Execution &execution = m_executions.GetOrAdd(key);
+
+                if (execution.Pending)
+                {
+                    s_supersede(toPublish, *execution.Pending);
+                }
+
+                if (!isProgress)
+                {
+                    /* Nothing more is expected after a terminal status, so forget the execution. */
+                    callbacks = std::move(execution.Callbacks);
+                    callbacks.push_back(onPubAck);
+                    m_executions.Erase(key);
+                }
+                else if (execution.Pending || (execution.LastPublishNs && now - execution.LastPublishNs < interval))
+                {
+                    execution.Pending = std::move(toPublish);
+                    execution.Callbacks.push_back(onPubAck);
+                    if (!execution.FlushScheduled)
+                    {
+                        execution.FlushScheduled = true;
+                        scheduleFlush = true;
+                        dueNs = execution.LastPublishNs + interval;
+                    }
+                }
+                else
+                {
+                    execution.LastPublishNs = now;
+                    callbacks.push_back(onPubAck);
+                }
+            }
+
+            if (scheduleFlush)
+            {
+                ScheduleFlush(key, dueNs);
+            }
+            else if (!callbacks.empty())
+            {
+                Publish(toPublish, std::move(callbacks));
+            }
+
+            return true;
+        }
+
+        void JobProgressReporter::Flush()
+        {
+            Crt::Vector<std::pair<UpdateJobExecutionRequest, Crt::Vector<OnPublishComplete>>> ready;
+            uint64_t now = Now();
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_executions.ForEach([&ready, now](uint64_t, Execution &execution) {
+                    if (execution.Pending)
+                    {
+                        ready.emplace_back(std::move(*execution.Pending), std::move(execution.Callbacks));
+                        execution.Pending.reset();
+                        execution.Callbacks.clear();
+                        execution.LastPublishNs = now;
+                    }
+                });
+            }
+
+            for (auto &update : ready)
+            {
+                Publish(update.first, std::move(update.second));
+            }
+        }
+
+        uint64_t JobProgressReporter::Now() const
+        {
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &now);
+            return now;
+        }
+
+        void JobProgressReporter::ScheduleFlush(uint64_t key, uint64_t dueNs)
+        {
+            auto *flushTask = Crt::New<FlushTask>(m_allocator);
+            if (!flushTask)
+            {
+                FlushExecution(key);
+                return;
+            }
+
+            flushTask->Owner = shared_from_this();
+            flushTask->Key = key;
+            flushTask->Allocator = m_allocator;
+            aws_task_init(&flushTask->Task, s_onFlushTask, flushTask, "JobProgressReporterFlush");
+            aws_event_loop_schedule_task_future(m_eventLoop, &flushTask->Task, dueNs);
+        }
+
+        void JobProgressReporter::FlushExecution(uint64_t key)
+        {
+            Crt::Optional<UpdateJobExecutionRequest> pending;
+            Crt::Vector<OnPublishComplete> callbacks;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                Execution *execution = m_executions.Find(key);
+                if (!execution)
+                {
+                    return;
+                }
+
+                execution->FlushScheduled = false;
+                if (!execution->Pending)
+                {
+                    return;
+                }
+
+                pending = std::move(execution->Pending);
+                execution->Pending.reset();
+                callbacks = std::move(execution->Callbacks);
+                execution->Callbacks.clear();
+                execution->LastPublishNs = Now();
+            }
+
+            Publish(*pending, std::move(callbacks));
+        }
+
+        void JobProgressReporter::s_onFlushTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *flushTask = static_cast<FlushTask *>(arg);
+            if (status == AWS_TASK_STATUS_RUN_READY)
+            {
+                auto owner = flushTask->Owner.lock();
+                if (owner)
+                {
+                    owner->FlushExecution(flushTask->Key);
+                }
+            }
+
+            Crt::Delete(flushTask, flushTask->Allocator);
+        }
+
+        void JobProgressReporter::Publish(
+            const UpdateJobExecutionRequest &request,
+            Crt::Vector<OnPublishComplete> &&callbacks)
+        {
+            auto onPubAck = [callbacks](int ioErr) {
+                for (const auto &callback : callbacks)
+                {
+                    if (callback)
+                    {
+                        callback(ioErr);
+                    }
+                }
+            };
+
+            if (!m_client.PublishUpdateJobExecution(request, m_config.Qos, onPubAck))
+            {
+                onPubAck(Crt::LastErrorOrUnknown());
+            }
+        }
+
+    } // namespace Iotjobs
+
+} // namespace Aws
@@ -0,0 +1,443 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobStateStore.h>
+
+#include <aws/common/file.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        namespace
+        {
+            /* Compact once the log holds this many more records than it needs, and twice as many. */
+            static const size_t s_compactionSlack = 16;
+
+            bool s_isTerminal(JobStatus status)
+            {
+                return status != JobStatus::QUEUED && status != JobStatus::IN_PROGRESS;
+            }
+
+            Crt::JsonObject s_toRecord(const JobStateStore::Execution &execution)
+            {
+                Crt::JsonObject record;
+                record.WithString("thingName", execution.ThingName);
+                record.WithString("jobId", execution.JobId);
+                record.WithString("status", JobStatusMarshaller::ToString(execution.Status));
+                if (execution.VersionNumber)
+                {
+                    record.WithInteger("versionNumber", *execution.VersionNumber);
+                }
+                if (execution.ExecutionNumber)
+                {
+                    record.WithInt64("executionNumber", *execution.ExecutionNumber);
+                }
+                if (execution.StatusDetails)
+                {
+                    Crt::JsonObject statusDetails;
+                    for (const auto &member : *execution.StatusDetails)
+                    {
+                        statusDetails.WithString(member.first, member.second);
+                    }
+                    record.WithObject("statusDetails", std::move(statusDetails));
+                }
+                return record;
+            }
+
+            void s_fromRecord(const Crt::JsonView &record, JobStateStore::Execution &execution)
+            {
+                execution.ThingName = record.GetString("thingName");
+                execution.JobId = record.GetString("jobId");
+                execution.Status = JobStatusMarshaller::FromString(record.GetString("status"));
+                if (record.ValueExists("versionNumber"))
+                {
+                    execution.VersionNumber = record.GetInteger("versionNumber");
+                }
+                if (record.ValueExists("executionNumber"))
+                {
+                    execution.ExecutionNumber = record.GetInt64("executionNumber");
+                }
+                if (record.ValueExists("statusDetails"))
+                {
+                    auto statusDetails = record.GetJsonObject("statusDetails").GetAllObjects();
+                    execution.StatusDetails = Iotdevicecommon::FlatStringMap();
+                    execution.StatusDetails->reserve(statusDetails.size());
+                    for (auto &member : statusDetails)
+                    {
+                        execution.StatusDetails->emplace(member.first, member.second.AsString());
+                    }
+                }
+            }
+
+            bool s_writeRecord(FILE *file, const Crt::JsonObject &record)
+            {
+                Crt::String line = record.View().WriteCompact(true);
+                line.push_back('\n');
+                if (fwrite(line.data(), 1, line.size(), file) != line.size() || fflush(file) != 0)
+                {
+                    aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                    return false;
+                }
+                return true;
+            }
+        } // namespace
+
+        JobStateStore::JobStateStore(const char *path) noexcept
+            : m_path(path), m_lock(), m_file(nullptr), m_recordCount(0), m_executions()
+        {
+        }
+
+        JobStateStore::~JobStateStore()
+        {
+            if (m_file)
+            {
+                fclose(m_file);
+            }
+        }
+
+        std::shared_ptr<JobStateStore> JobStateStore::Open(const char *path, Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<JobStateStore *>(aws_mem_acquire(allocator, sizeof(JobStateStore)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) JobStateStore(path);
+            std::shared_ptr<JobStateStore> store(
+                toSeat, [allocator](JobStateStore *jobStateStore) { Crt::Delete(jobStateStore, allocator); });
+
+            std::lock_guard<std::mutex> lock(store->m_lock);
+            if (!store->Load())
+            {
+                return nullptr;
+            }
+            return store;
+        }
+
+        bool JobStateStore::Load()
+        {
+            Crt::String contents;
+            FILE *existing = aws_fopen(m_path.c_str(), "rb");
+            if (existing)
+            {
+                char chunk[4096];
+                size_t read = 0;
+                while ((read = fread(chunk, 1, sizeof(chunk), existing)) > 0)
+                {
+                    contents.append(chunk, read);
+                }
+                fclose(existing);
+            }
+
+            /* Only newline-terminated records were completely written. */
+            bool damaged = !contents.empty() && contents.back() != '\n';
+            size_t lineStart = 0;
+            for (size_t lineEnd = contents.find('\n'); lineEnd != Crt::String::npos;
+                 lineStart = lineEnd + 1, lineEnd = contents.find('\n', lineStart))
+            {
+                Crt::JsonObject record(contents.substr(lineStart, lineEnd - lineStart));
+                Crt::JsonView view = record.View();
+                if (!record.WasParseSuccessful() || !view.ValueExists("thingName") || !view.ValueExists("jobId"))
+                {
+                    damaged = true;
+                    continue;
+                }
+
+                ++m_recordCount;
+                Crt::String key = s_key(view.GetString("thingName"), view.GetString("jobId"));
+                if (view.ValueExists("removed"))
+                {
+                    m_executions.erase(key);
+                    continue;
+                }
+
+                Execution execution;
+                s_fromRecord(view, execution);
+                m_executions[key] = std::move(execution);
+            }
+
+            if (damaged || m_recordCount > 2 * m_executions.size() + s_compactionSlack)
+            {
+                return CompactLocked();
+            }
+
+            m_file = aws_fopen(m_path.c_str(), "ab");
+            return m_file != nullptr;
+        }
+
+        bool JobStateStore::Record(const Execution &execution)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return RecordLocked(execution);
+        }
+
+        bool JobStateStore::Record(const JobExecutionData &execution)
+        {
+            if (!execution.ThingName || !execution.JobId || !execution.Status)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Execution recorded;
+            recorded.ThingName = *execution.ThingName;
+            recorded.JobId = *execution.JobId;
+            recorded.Status = *execution.Status;
+            recorded.VersionNumber = execution.VersionNumber;
+            recorded.ExecutionNumber = execution.ExecutionNumber;
+            recorded.StatusDetails = execution.StatusDetails;
+            return Record(recorded);
+        }
+
+        bool JobStateStore::Record(
+            const Crt::String &thingName,
+            const Crt::String &jobId,
+            const JobExecutionState &state)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            Execution recorded;
+            auto existing = m_executions.find(s_key(thingName, jobId));
+            if (existing != m_executions.end())
+            {
+                recorded = existing->second;
+            }
+            else if (!state.Status)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            recorded.ThingName = thingName;
+            recorded.JobId = jobId;
+            if (state.Status)
+            {
+                recorded.Status = *state.Status;
+            }
+            if (state.VersionNumber)
+            {
+                recorded.VersionNumber = state.VersionNumber;
+            }
+            if (state.StatusDetails)
+            {
+                recorded.StatusDetails = state.StatusDetails;
+            }
+            return RecordLocked(recorded);
+        }
+
+        bool JobStateStore::Remove(const Crt::String &thingName, const Crt::String &jobId)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return RemoveLocked(thingName, jobId);
+        }
+
+        Crt::Vector<JobStateStore::Execution> JobStateStore::GetExecutions() const
+        {
+            Crt::Vector<Execution> executions;
+            std::lock_guard<std::mutex> lock(m_lock);
+            executions.reserve(m_executions.size());
+            for (const auto &entry : m_executions)
+            {
+                executions.push_back(entry.second);
+            }
+            return executions;
+        }
+
+        Crt::Vector<Crt::String> JobStateStore::Reconcile(
+            const Crt::String &thingName,
+            const GetPendingJobExecutionsResponse &response)
+        {
+            Crt::Vector<Crt::String> stale;
+            Crt::Map<Crt::String, std::pair<JobStatus, const JobExecutionSummary *>> listed;
+            if (response.InProgressJobs)
+            {
+                for (const JobExecutionSummary &summary : *response.InProgressJobs)
+                {
+                    if (summary.JobId)
+                    {
+                        listed[*summary.JobId] = std::make_pair(JobStatus::IN_PROGRESS, &summary);
+                    }
+                }
+            }
+            if (response.QueuedJobs)
+            {
+                for (const JobExecutionSummary &summary : *response.QueuedJobs)
+                {
+                    if (summary.JobId)
+                    {
+                        listed[*summary.JobId] = std::make_pair(JobStatus::QUEUED, &summary);
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            Crt::Vector<Crt::String> gone;
+            for (const auto &entry : m_executions)
+            {
+                if (entry.second.ThingName == thingName && listed.find(entry.second.JobId) == listed.end())
+                {
+                    gone.push_back(entry.second.JobId);
+                }
+            }
+            for (const Crt::String &jobId : gone)
+            {
+                RemoveLocked(thingName, jobId);
+            }
+
+            for (const auto &entry : listed)
+            {
+                const JobExecutionSummary &summary = *entry.second.second;
+                Execution recorded;
+                auto existing = m_executions.find(s_key(thingName, entry.first));
+                bool known = existing != m_executions.end();
+                if (known)
+                {
+                    recorded = existing->second;
+                }
+
+                bool versionDiffers = !known || !recorded.VersionNumber || !summary.VersionNumber ||
+                                      *recorded.VersionNumber != *summary.VersionNumber;
+                if (versionDiffers)
+                {
+                    stale.push_back(entry.first);
+                }
+                if (known && !versionDiffers && recorded.Status == entry.second.first)
+                {
+                    continue;
+                }
+
+                recorded.ThingName = thingName;
+                recorded.JobId = entry.first;
+                recorded.Status = entry.second.first;
+                recorded.VersionNumber = summary.VersionNumber;
+                recorded.ExecutionNumber = summary.ExecutionNumber;
+                RecordLocked(recorded);
+            }
+
+            return stale;
+        }
+
+        bool JobStateStore::Compact()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return CompactLocked();
+        }
+
+        bool JobStateStore::RecordLocked(const Execution &execution)
+        {
+            if (s_isTerminal(execution.Status))
+            {
+                return RemoveLocked(execution.ThingName, execution.JobId);
+            }
+
+            if (!Append(s_toRecord(execution)))
+            {
+                return false;
+            }
+            m_executions[s_key(execution.ThingName, execution.JobId)] = execution;
+            CompactIfBloated();
+            return true;
+        }
+
+        bool JobStateStore::RemoveLocked(const Crt::String &thingName, const Crt::String &jobId)
+        {
+            auto existing = m_executions.find(s_key(thingName, jobId));
+            if (existing == m_executions.end())
+            {
+                return true;
+            }
+
+            Crt::JsonObject tombstone;
+            tombstone.WithString("thingName", thingName);
+            tombstone.WithString("jobId", jobId);
+            tombstone.WithBool("removed", true);
+            if (!Append(tombstone))
+            {
+                return false;
+            }
+            m_executions.erase(existing);
+            CompactIfBloated();
+            return true;
+        }
+
+        bool JobStateStore::Append(const Crt::JsonObject &record)
+        {
+            if (!m_file)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return false;
+            }
+
+            if (!s_writeRecord(m_file, record))
+            {
+                return false;
+            }
+
+            ++m_recordCount;
+            return true;
+        }
+
+        void JobStateStore::CompactIfBloated()
+        {
+            if (m_recordCount > 2 * m_executions.size() + s_compactionSlack)
+            {
+                /* A failed compaction leaves the complete log in place; carry on appending to it. */
+                CompactLocked();
+            }
+        }
+
+        bool JobStateStore::CompactLocked()
+        {
+            Crt::String compactedPath(m_path);
+            compactedPath.append(".tmp");
+
+            FILE *compacted = aws_fopen(compactedPath.c_str(), "wb");
+            if (!compacted)
+            {
+                return false;
+            }
+
+            bool written = true;
+            for (const auto &entry : m_executions)
+            {
+                written = written && s_writeRecord(compacted, s_toRecord(entry.second));
+            }
+            fclose(compacted);
+            if (!written)
+            {
+                remove(compactedPath.c_str());
+                return false;
+            }
+
+            if (m_file)
+            {
+                fclose(m_file);
+                m_file = nullptr;
+            }
+
+            /* Windows will not rename over an existing file. */
+            if (rename(compactedPath.c_str(), m_path.c_str()) != 0 &&
+                (remove(m_path.c_str()) != 0 || rename(compactedPath.c_str(), m_path.c_str()) != 0))
+            {
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                m_file = aws_fopen(m_path.c_str(), "ab");
+                return false;
+            }
+
+            m_recordCount = m_executions.size();
+            m_file = aws_fopen(m_path.c_str(), "ab");
+            return m_file != nullptr;
+        }
+
+        Crt::String JobStateStore::s_key(const Crt::String &thingName, const Crt::String &jobId)
+        {
+            Crt::String key(thingName);
+            key.push_back('/');
+            key.append(jobId);
+            return key;
+        }
+
+    } // namespace Iotjobs
+} // namespace Aws
@@ -5,24 +5,38 @@
 #include <aws/iotjobs/JobStatus.h>
 
 #include <aws/crt/StlAllocator.h>
-#include <aws/crt/StringUtils.h>
+#include <aws/iotdevicecommon/EnumTable.h>
 
 #include <assert.h>
 
-static const size_t QUEUED_HASH = Aws::Crt::HashString("QUEUED");
-static const size_t IN_PROGRESS_HASH = Aws::Crt::HashString("IN_PROGRESS");
-static const size_t TIMED_OUT_HASH = Aws::Crt::HashString("TIMED_OUT");
-static const size_t FAILED_HASH = Aws::Crt::HashString("FAILED");
-static const size_t SUCCEEDED_HASH = Aws::Crt::HashString("SUCCEEDED");
-static const size_t CANCELED_HASH = Aws::Crt::HashString("CANCELED");
-static const size_t REJECTED_HASH = Aws::Crt::HashString("REJECTED");
-static const size_t REMOVED_HASH = Aws::Crt::HashString("REMOVED");
-
 namespace Aws
 {
     namespace Iotjobs
     {
 
+        namespace
+        {
+            /* Slot (length * 2 + middle character + last character) % 16; see EnumTableSlot. */
+            constexpr Iotdevicecommon::EnumTableEntry<JobStatus> s_slots[16] = {
+                {nullptr, 0, JobStatus()},
+                {"REMOVED", 7, JobStatus::REMOVED},
+                {nullptr, 0, JobStatus()},
+                {nullptr, 0, JobStatus()},
+                {nullptr, 0, JobStatus()},
+                {"QUEUED", 6, JobStatus::QUEUED},
+                {nullptr, 0, JobStatus()},
+                {"REJECTED", 8, JobStatus::REJECTED},
+                {"IN_PROGRESS", 11, JobStatus::IN_PROGRESS},
+                {"CANCELED", 8, JobStatus::CANCELED},
+                {"TIMED_OUT", 9, JobStatus::TIMED_OUT},
+                {"SUCCEEDED", 9, JobStatus::SUCCEEDED},
+                {"FAILED", 6, JobStatus::FAILED},
+                {nullptr, 0, JobStatus()},
+                {nullptr, 0, JobStatus()},
+                {nullptr, 0, JobStatus()},
+            };
+        } // namespace
+
         namespace JobStatusMarshaller
         {
             const char *ToString(JobStatus status)
@@ -53,46 +67,10 @@ namespace Aws
 
             JobStatus FromString(const Crt::String &str)
             {
-                size_t hash = Crt::HashString(str.c_str());
-
-                if (hash == QUEUED_HASH)
-                {
-                    return JobStatus::QUEUED;
-                }
-
-                if (hash == IN_PROGRESS_HASH)
-                {
-                    return JobStatus::IN_PROGRESS;
-                }
-
-                if (hash == TIMED_OUT_HASH)
-                {
-                    return JobStatus::TIMED_OUT;
-                }
-
-                if (hash == FAILED_HASH)
-                {
-                    return JobStatus::FAILED;
-                }
-
-                if (hash == SUCCEEDED_HASH)
-                {
-                    return JobStatus::SUCCEEDED;
-                }
-
-                if (hash == CANCELED_HASH)
-                {
-                    return JobStatus::CANCELED;
-                }
-
-                if (hash == REJECTED_HASH)
-                {
-                    return JobStatus::REJECTED;
-                }
-
-                if (hash == REMOVED_HASH)
+                JobStatus value;
+                if (Iotdevicecommon::LookupEnum<2>(s_slots, str.data(), str.length(), value))
                 {
-                    return JobStatus::REMOVED;
+                    return value;
                 }
 
                 assert(0);
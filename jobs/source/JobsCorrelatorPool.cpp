@@ -0,0 +1,45 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobsCorrelatorPool.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        std::shared_ptr<JobsCorrelatorPool> CreateJobsCorrelatorPool(
+            const IotJobsClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const JobsRequestCorrelatorConfig &config,
+            const std::shared_ptr<Iotdevicecommon::TimerWheel> &timers,
+            uint32_t idleTtlMs,
+            Crt::Allocator *allocator)
+        {
+            IotJobsClient jobsClient = client;
+            JobsRequestCorrelatorConfig correlatorConfig = config;
+            if (!correlatorConfig.Timers)
+            {
+                correlatorConfig.Timers = timers;
+            }
+
+            /* The group outlives the pool, as it does the client's connection. */
+            Crt::Io::EventLoopGroup *group = &eventLoopGroup;
+            return JobsCorrelatorPool::Create(
+                [jobsClient, group, correlatorConfig, allocator](const Crt::String &thingName) {
+                    return JobsRequestCorrelator::Create(jobsClient, *group, thingName, correlatorConfig, allocator);
+                },
+                [](JobsRequestCorrelator &correlator, const JobsCorrelatorPool::OnSubscribed &onSubscribed) {
+                    return correlator.Subscribe(onSubscribed);
+                },
+                [](const JobsRequestCorrelator &correlator) {
+                    return correlator.GetInFlightCount() + correlator.GetQueuedCount() > 0;
+                },
+                timers,
+                idleTtlMs,
+                allocator);
+        }
+
+    } // namespace Iotjobs
+} // namespace Aws
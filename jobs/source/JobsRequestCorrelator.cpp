@@ -0,0 +1,640 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobsRequestCorrelator.h>
+
+#include <aws/iotjobs/DescribeJobExecutionRequest.h>
+#include <aws/iotjobs/DescribeJobExecutionResponse.h>
+#include <aws/iotjobs/DescribeJobExecutionSubscriptionRequest.h>
+#include <aws/iotjobs/GetPendingJobExecutionsRequest.h>
+#include <aws/iotjobs/GetPendingJobExecutionsResponse.h>
+#include <aws/iotjobs/GetPendingJobExecutionsSubscriptionRequest.h>
+#include <aws/iotjobs/RejectedError.h>
+#include <aws/iotjobs/StartNextJobExecutionResponse.h>
+#include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
+#include <aws/iotjobs/StartNextPendingJobExecutionSubscriptionRequest.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+#include <aws/iotjobs/UpdateJobExecutionResponse.h>
+#include <aws/iotjobs/UpdateJobExecutionSubscriptionRequest.h>
+
+#include <aws/iotdevicecommon/ClientToken.h>
+
+#include <aws/common/clock.h>
+#include <aws/io/event_loop.h>
+#include <aws/mqtt/mqtt.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        namespace
+        {
+            struct SubscribeContext
+            {
+                SubscribeContext(const OnSubscribeComplete &onSubAck, int remaining)
+                    : OnSubAck(onSubAck), Remaining(remaining), FirstError(AWS_ERROR_SUCCESS)
+                {
+                }
+
+                std::mutex Lock;
+                OnSubscribeComplete OnSubAck;
+                int Remaining;
+                int FirstError;
+            };
+
+            struct TimeoutTask
+            {
+                aws_task Task;
+                std::weak_ptr<JobsRequestCorrelator> Owner;
+                Crt::String ClientToken;
+                Crt::Allocator *Allocator;
+            };
+
+            template <typename Response>
+            std::function<void(void *, RejectedError *, int)> s_eraseResponseType(
+                const std::function<void(Response *, RejectedError *, int)> &onComplete)
+            {
+                return [onComplete](void *response, RejectedError *error, int ioErr) {
+                    if (onComplete)
+                    {
+                        onComplete(static_cast<Response *>(response), error, ioErr);
+                    }
+                };
+            }
+
+            /* As s_eraseResponseType, for a request sharing another's response: it gets copies to keep. */
+            template <typename Response>
+            std::function<void(void *, RejectedError *, int)> s_eraseSharedResponseType(
+                const std::function<void(Response *, RejectedError *, int)> &onComplete)
+            {
+                return [onComplete](void *response, RejectedError *error, int ioErr) {
+                    if (!onComplete)
+                    {
+                        return;
+                    }
+                    Crt::Optional<Response> responseCopy;
+                    Crt::Optional<RejectedError> errorCopy;
+                    if (response)
+                    {
+                        responseCopy = *static_cast<Response *>(response);
+                    }
+                    if (error)
+                    {
+                        errorCopy = *error;
+                    }
+                    onComplete(responseCopy ? &*responseCopy : nullptr, errorCopy ? &*errorCopy : nullptr, ioErr);
+                };
+            }
+        } // namespace
+
+        JobsRequestCorrelatorConfig::JobsRequestCorrelatorConfig() noexcept
+            : MaxInFlight(8), RequestTimeoutMs(30000), Qos(AWS_MQTT_QOS_AT_LEAST_ONCE), ShareIdenticalRequests(true),
+              Timers()
+        {
+        }
+
+        JobsRequestCorrelator::JobsRequestCorrelator(
+            const IotJobsClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const JobsRequestCorrelatorConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_client(client), m_thingName(thingName), m_config(config), m_allocator(allocator),
+              m_eventLoop(aws_event_loop_group_get_next_loop(eventLoopGroup.GetUnderlyingHandle()))
+        {
+        }
+
+        std::shared_ptr<JobsRequestCorrelator> JobsRequestCorrelator::Create(
+            const IotJobsClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const JobsRequestCorrelatorConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat =
+                static_cast<JobsRequestCorrelator *>(aws_mem_acquire(allocator, sizeof(JobsRequestCorrelator)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) JobsRequestCorrelator(client, eventLoopGroup, thingName, config, allocator);
+                return std::shared_ptr<JobsRequestCorrelator>(
+                    toSeat, [allocator](JobsRequestCorrelator *correlator) { Crt::Delete(correlator, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        template <typename Response>
+        std::function<void(Response *, int)> JobsRequestCorrelator::MakeAcceptedHandler(RequestKind kind)
+        {
+            std::weak_ptr<JobsRequestCorrelator> weakCorrelator = shared_from_this();
+            return [weakCorrelator, kind](Response *response, int) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && response && response->ClientToken.has_value())
+                {
+                    correlator->Complete(*response->ClientToken, kind, response, nullptr, AWS_ERROR_SUCCESS);
+                }
+            };
+        }
+
+        std::function<void(RejectedError *, int)> JobsRequestCorrelator::MakeRejectedHandler(RequestKind kind)
+        {
+            std::weak_ptr<JobsRequestCorrelator> weakCorrelator = shared_from_this();
+            return [weakCorrelator, kind](RejectedError *error, int) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && error && error->ClientToken.has_value())
+                {
+                    correlator->Complete(*error->ClientToken, kind, nullptr, error, AWS_ERROR_SUCCESS);
+                }
+            };
+        }
+
+        bool JobsRequestCorrelator::Subscribe(const OnSubscribeComplete &onSubAck)
+        {
+            auto context = Crt::MakeShared<SubscribeContext>(m_allocator, onSubAck, 8);
+            if (!context)
+            {
+                return false;
+            }
+
+            auto onEachSubAck = [context](int ioErr) {
+                OnSubscribeComplete onAllSubAcked;
+                int result = AWS_ERROR_SUCCESS;
+                {
+                    std::lock_guard<std::mutex> lock(context->Lock);
+                    if (ioErr != AWS_ERROR_SUCCESS && context->FirstError == AWS_ERROR_SUCCESS)
+                    {
+                        context->FirstError = ioErr;
+                    }
+                    if (--context->Remaining == 0)
+                    {
+                        onAllSubAcked = context->OnSubAck;
+                        result = context->FirstError;
+                    }
+                }
+
+                if (onAllSubAcked)
+                {
+                    onAllSubAcked(result);
+                }
+            };
+
+            UpdateJobExecutionSubscriptionRequest updateRequest;
+            updateRequest.ThingName = m_thingName;
+            updateRequest.JobId = Crt::String("+");
+
+            DescribeJobExecutionSubscriptionRequest describeRequest;
+            describeRequest.ThingName = m_thingName;
+            describeRequest.JobId = Crt::String("+");
+
+            GetPendingJobExecutionsSubscriptionRequest getPendingRequest;
+            getPendingRequest.ThingName = m_thingName;
+
+            StartNextPendingJobExecutionSubscriptionRequest startNextRequest;
+            startNextRequest.ThingName = m_thingName;
+
+            const Crt::Mqtt::QOS qos = m_config.Qos;
+            return m_client.SubscribeToUpdateJobExecutionAccepted(
+                       updateRequest,
+                       qos,
+                       MakeAcceptedHandler<UpdateJobExecutionResponse>(RequestKind::UpdateJobExecution),
+                       onEachSubAck) &&
+                   m_client.SubscribeToUpdateJobExecutionRejected(
+                       updateRequest, qos, MakeRejectedHandler(RequestKind::UpdateJobExecution), onEachSubAck) &&
+                   m_client.SubscribeToDescribeJobExecutionAccepted(
+                       describeRequest,
+                       qos,
+                       MakeAcceptedHandler<DescribeJobExecutionResponse>(RequestKind::DescribeJobExecution),
+                       onEachSubAck) &&
+                   m_client.SubscribeToDescribeJobExecutionRejected(
+                       describeRequest, qos, MakeRejectedHandler(RequestKind::DescribeJobExecution), onEachSubAck) &&
+                   m_client.SubscribeToGetPendingJobExecutionsAccepted(
+                       getPendingRequest,
+                       qos,
+                       MakeAcceptedHandler<GetPendingJobExecutionsResponse>(RequestKind::GetPendingJobExecutions),
+                       onEachSubAck) &&
+                   m_client.SubscribeToGetPendingJobExecutionsRejected(
+                       getPendingRequest,
+                       qos,
+                       MakeRejectedHandler(RequestKind::GetPendingJobExecutions),
+                       onEachSubAck) &&
+                   m_client.SubscribeToStartNextPendingJobExecutionAccepted(
+                       startNextRequest,
+                       qos,
+                       MakeAcceptedHandler<StartNextJobExecutionResponse>(RequestKind::StartNextPendingJobExecution),
+                       onEachSubAck) &&
+                   m_client.SubscribeToStartNextPendingJobExecutionRejected(
+                       startNextRequest,
+                       qos,
+                       MakeRejectedHandler(RequestKind::StartNextPendingJobExecution),
+                       onEachSubAck);
+        }
+
+        bool JobsRequestCorrelator::UpdateJobExecutionAsync(
+            const UpdateJobExecutionRequest &request,
+            const OnUpdateJobExecutionComplete &onComplete)
+        {
+            if (!request.JobId.has_value())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            UpdateJobExecutionRequest toSend(request);
+            if (!toSend.ThingName.has_value())
+            {
+                toSend.ThingName = m_thingName;
+            }
+            if (!toSend.ClientToken.has_value())
+            {
+                toSend.ClientToken = Iotdevicecommon::GenerateClientToken();
+            }
+
+            PendingRequest pending;
+            pending.ClientToken = *toSend.ClientToken;
+            pending.Kind = RequestKind::UpdateJobExecution;
+            pending.Publish = [this, toSend](const OnPublishComplete &onPubAck) {
+                return m_client.PublishUpdateJobExecution(toSend, m_config.Qos, onPubAck);
+            };
+            pending.OnComplete = s_eraseResponseType<UpdateJobExecutionResponse>(onComplete);
+
+            return Submit(std::move(pending));
+        }
+
+        bool JobsRequestCorrelator::DescribeJobExecutionAsync(
+            const DescribeJobExecutionRequest &request,
+            const OnDescribeJobExecutionComplete &onComplete)
+        {
+            if (!request.JobId.has_value())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            DescribeJobExecutionRequest toSend(request);
+            if (!toSend.ThingName.has_value())
+            {
+                toSend.ThingName = m_thingName;
+            }
+
+            PendingRequest pending;
+            if (m_config.ShareIdenticalRequests && !toSend.ClientToken.has_value())
+            {
+                pending.FlightKey = "describe/";
+                pending.FlightKey.append(*toSend.ThingName).append("/").append(*toSend.JobId).append("/");
+                if (toSend.ExecutionNumber)
+                {
+                    pending.FlightKey.append(std::to_string(*toSend.ExecutionNumber).c_str());
+                }
+                pending.FlightKey.append(toSend.IncludeJobDocument && !*toSend.IncludeJobDocument ? "/-" : "/+");
+                pending.OnJoinedComplete = s_eraseSharedResponseType<DescribeJobExecutionResponse>(onComplete);
+            }
+            if (!toSend.ClientToken.has_value())
+            {
+                toSend.ClientToken = Iotdevicecommon::GenerateClientToken();
+            }
+
+            pending.ClientToken = *toSend.ClientToken;
+            pending.Kind = RequestKind::DescribeJobExecution;
+            pending.Publish = [this, toSend](const OnPublishComplete &onPubAck) {
+                return m_client.PublishDescribeJobExecution(toSend, m_config.Qos, onPubAck);
+            };
+            pending.OnComplete = s_eraseResponseType<DescribeJobExecutionResponse>(onComplete);
+
+            return Submit(std::move(pending));
+        }
+
+        bool JobsRequestCorrelator::GetPendingJobExecutionsAsync(
+            const GetPendingJobExecutionsRequest &request,
+            const OnGetPendingJobExecutionsComplete &onComplete)
+        {
+            GetPendingJobExecutionsRequest toSend(request);
+            if (!toSend.ThingName.has_value())
+            {
+                toSend.ThingName = m_thingName;
+            }
+
+            PendingRequest pending;
+            if (m_config.ShareIdenticalRequests && !toSend.ClientToken.has_value())
+            {
+                pending.FlightKey = "pending/";
+                pending.FlightKey.append(*toSend.ThingName);
+                pending.OnJoinedComplete = s_eraseSharedResponseType<GetPendingJobExecutionsResponse>(onComplete);
+            }
+            if (!toSend.ClientToken.has_value())
+            {
+                toSend.ClientToken = Iotdevicecommon::GenerateClientToken();
+            }
+
+            pending.ClientToken = *toSend.ClientToken;
+            pending.Kind = RequestKind::GetPendingJobExecutions;
+            pending.Publish = [this, toSend](const OnPublishComplete &onPubAck) {
+                return m_client.PublishGetPendingJobExecutions(toSend, m_config.Qos, onPubAck);
+            };
+            pending.OnComplete = s_eraseResponseType<GetPendingJobExecutionsResponse>(onComplete);
+
+            return Submit(std::move(pending));
+        }
+
+        bool JobsRequestCorrelator::StartNextPendingJobExecutionAsync(
+            const StartNextPendingJobExecutionRequest &request,
+            const OnStartNextPendingJobExecutionComplete &onComplete)
+        {
+            StartNextPendingJobExecutionRequest toSend(request);
+            if (!toSend.ThingName.has_value())
+            {
+                toSend.ThingName = m_thingName;
+            }
+            if (!toSend.ClientToken.has_value())
+            {
+                toSend.ClientToken = Iotdevicecommon::GenerateClientToken();
+            }
+
+            PendingRequest pending;
+            pending.ClientToken = *toSend.ClientToken;
+            pending.Kind = RequestKind::StartNextPendingJobExecution;
+            pending.Publish = [this, toSend](const OnPublishComplete &onPubAck) {
+                return m_client.PublishStartNextPendingJobExecution(toSend, m_config.Qos, onPubAck);
+            };
+            pending.OnComplete = s_eraseResponseType<StartNextJobExecutionResponse>(onComplete);
+
+            return Submit(std::move(pending));
+        }
+
+        bool JobsRequestCorrelator::Submit(PendingRequest &&request)
+        {
+            if (Join(request))
+            {
+                return true;
+            }
+
+            if (!Iotdevicecommon::AcquireRequestSlot(m_client.GetMemoryBudget(), request.BudgetSlot))
+            {
+                return false;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!request.FlightKey.empty())
+                {
+                    m_flights[request.FlightKey] = request.ClientToken;
+                }
+                m_queued.push_back(std::move(request));
+            }
+
+            Pump();
+            return true;
+        }
+
+        bool JobsRequestCorrelator::Join(PendingRequest &request)
+        {
+            if (request.FlightKey.empty())
+            {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto flight = m_flights.find(request.FlightKey);
+            if (flight == m_flights.end())
+            {
+                return false;
+            }
+
+            auto inFlight = m_inFlight.find(flight->second);
+            if (inFlight != m_inFlight.end())
+            {
+                inFlight->second.Joined.push_back(std::move(request.OnJoinedComplete));
+                return true;
+            }
+            for (PendingRequest &queued : m_queued)
+            {
+                if (queued.ClientToken == flight->second)
+                {
+                    queued.Joined.push_back(std::move(request.OnJoinedComplete));
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void JobsRequestCorrelator::Pump()
+        {
+            std::weak_ptr<JobsRequestCorrelator> weakCorrelator = shared_from_this();
+            for (;;)
+            {
+                Crt::String clientToken;
+                PublishRequest publish;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (m_queued.empty() || (m_config.MaxInFlight != 0 && m_inFlight.size() >= m_config.MaxInFlight))
+                    {
+                        return;
+                    }
+
+                    PendingRequest &next = m_queued.front();
+                    clientToken = next.ClientToken;
+                    publish = next.Publish;
+                    m_inFlight[clientToken] = std::move(next);
+                    m_queued.pop_front();
+                }
+
+                auto onPubAck = [weakCorrelator, clientToken](int ioErr) {
+                    auto correlator = weakCorrelator.lock();
+                    if (correlator && ioErr != AWS_ERROR_SUCCESS)
+                    {
+                        correlator->Fail(clientToken, ioErr);
+                    }
+                };
+
+                if (!publish(onPubAck))
+                {
+                    Fail(clientToken, Crt::LastErrorOrUnknown());
+                    continue;
+                }
+
+                ScheduleTimeout(clientToken);
+            }
+        }
+
+        bool JobsRequestCorrelator::Take(
+            const Crt::String &clientToken,
+            const RequestKind *kind,
+            PendingRequest &request)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto iter = m_inFlight.find(clientToken);
+            if (iter == m_inFlight.end() || (kind && iter->second.Kind != *kind))
+            {
+                return false;
+            }
+
+            request = std::move(iter->second);
+            m_inFlight.erase(iter);
+            if (!request.FlightKey.empty())
+            {
+                /* Identical requests from here on are sent anew, rather than handed this response. */
+                m_flights.erase(request.FlightKey);
+            }
+            return true;
+        }
+
+        void JobsRequestCorrelator::Complete(
+            const Crt::String &clientToken,
+            RequestKind kind,
+            void *response,
+            RejectedError *error,
+            int ioErr)
+        {
+            PendingRequest request;
+            if (!Take(clientToken, &kind, request))
+            {
+                return;
+            }
+
+            CancelTimeout(request);
+            s_completeRequest(request, response, error, ioErr);
+            Pump();
+        }
+
+        void JobsRequestCorrelator::Fail(const Crt::String &clientToken, int ioErr)
+        {
+            PendingRequest request;
+            if (!Take(clientToken, nullptr, request))
+            {
+                return;
+            }
+
+            CancelTimeout(request);
+            s_completeRequest(request, nullptr, nullptr, ioErr);
+            Pump();
+        }
+
+        void JobsRequestCorrelator::s_completeRequest(
+            PendingRequest &request,
+            void *response,
+            RejectedError *error,
+            int ioErr)
+        {
+            /* The requests that joined go first, as each copies the response before the sender may modify it. */
+            for (CompleteRequest &joined : request.Joined)
+            {
+                joined(response, error, ioErr);
+            }
+            request.OnComplete(response, error, ioErr);
+        }
+
+        void JobsRequestCorrelator::ScheduleTimeout(const Crt::String &clientToken)
+        {
+            if (m_config.RequestTimeoutMs == 0)
+            {
+                return;
+            }
+
+            if (m_config.Timers)
+            {
+                std::weak_ptr<JobsRequestCorrelator> weakCorrelator = shared_from_this();
+                Iotdevicecommon::TimerWheel::OnExpired onTimeout = [weakCorrelator, clientToken]() {
+                    auto correlator = weakCorrelator.lock();
+                    if (correlator)
+                    {
+                        correlator->Fail(clientToken, AWS_ERROR_MQTT_TIMEOUT);
+                    }
+                };
+                uint64_t timeoutId = m_config.Timers->Schedule(m_config.RequestTimeoutMs, std::move(onTimeout));
+                if (timeoutId != 0)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m_lock);
+                        auto iter = m_inFlight.find(clientToken);
+                        if (iter != m_inFlight.end())
+                        {
+                            iter->second.TimeoutId = timeoutId;
+                            return;
+                        }
+                    }
+
+                    /* Completed while the timer was being scheduled. */
+                    m_config.Timers->Cancel(timeoutId);
+                    return;
+                }
+            }
+
+            auto *timeoutTask = Crt::New<TimeoutTask>(m_allocator);
+            if (!timeoutTask)
+            {
+                return;
+            }
+
+            timeoutTask->Owner = shared_from_this();
+            timeoutTask->ClientToken = clientToken;
+            timeoutTask->Allocator = m_allocator;
+            aws_task_init(&timeoutTask->Task, s_onTimeoutTask, timeoutTask, "JobsRequestCorrelatorTimeout");
+
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &now);
+            uint64_t timeout =
+                aws_timestamp_convert(m_config.RequestTimeoutMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+            aws_event_loop_schedule_task_future(m_eventLoop, &timeoutTask->Task, now + timeout);
+        }
+
+        void JobsRequestCorrelator::CancelTimeout(const PendingRequest &request)
+        {
+            if (request.TimeoutId != 0 && m_config.Timers)
+            {
+                m_config.Timers->Cancel(request.TimeoutId);
+            }
+        }
+
+        void JobsRequestCorrelator::s_onTimeoutTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *timeoutTask = static_cast<TimeoutTask *>(arg);
+            if (status == AWS_TASK_STATUS_RUN_READY)
+            {
+                auto owner = timeoutTask->Owner.lock();
+                if (owner)
+                {
+                    owner->Fail(timeoutTask->ClientToken, AWS_ERROR_MQTT_TIMEOUT);
+                }
+            }
+
+            Crt::Delete(timeoutTask, timeoutTask->Allocator);
+        }
+
+        void JobsRequestCorrelator::CancelAll(int errorCode)
+        {
+            Crt::Map<Crt::String, PendingRequest> inFlight;
+            Crt::List<PendingRequest> queued;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                inFlight.swap(m_inFlight);
+                queued.swap(m_queued);
+                m_flights.clear();
+            }
+
+            for (auto &entry : inFlight)
+            {
+                CancelTimeout(entry.second);
+                s_completeRequest(entry.second, nullptr, nullptr, errorCode);
+            }
+
+            for (auto &request : queued)
+            {
+                s_completeRequest(request, nullptr, nullptr, errorCode);
+            }
+        }
+
+        size_t JobsRequestCorrelator::GetInFlightCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_inFlight.size();
+        }
+
+        size_t JobsRequestCorrelator::GetQueuedCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_queued.size();
+        }
+
+    } // namespace Iotjobs
+
+} // namespace Aws
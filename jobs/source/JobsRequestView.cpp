@@ -0,0 +1,41 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobsRequestView.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        void DescribeJobExecutionRequestView::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            writer.BeginObject();
+            if (ExecutionNumber)
+            {
+                writer.Key("executionNumber").Int64(*ExecutionNumber);
+            }
+            if (IncludeJobDocument)
+            {
+                writer.Key("includeJobDocument").Bool(*IncludeJobDocument);
+            }
+            if (ClientToken.len > 0)
+            {
+                writer.Key("clientToken").String(ClientToken);
+            }
+            writer.EndObject();
+        }
+
+        void GetPendingJobExecutionsRequestView::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            writer.BeginObject();
+            if (ClientToken.len > 0)
+            {
+                writer.Key("clientToken").String(ClientToken);
+            }
+            writer.EndObject();
+        }
+
+    } // namespace Iotjobs
+} // namespace Aws
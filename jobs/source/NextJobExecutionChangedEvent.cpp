@@ -23,7 +23,7 @@ namespace Aws
 
             if (doc.ValueExists("timestamp"))
             {
-                val.Timestamp = doc.GetDouble("timestamp");
+                val.Timestamp = Aws::Iotdevicecommon::PackedDateTime::FromSeconds(doc.GetDouble("timestamp"));
             }
         }
 
@@ -40,7 +40,7 @@ namespace Aws
 
             if (Timestamp)
             {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
+                object.WithDouble("timestamp", Timestamp.Seconds());
             }
         }
 
@@ -55,5 +55,23 @@ namespace Aws
             return *this;
         }
 
+        void NextJobExecutionChangedEvent::Reload(const Crt::JsonView &doc)
+        {
+            if (doc.ValueExists("execution"))
+            {
+                Execution = doc.GetJsonObject("execution");
+            }
+            else
+            {
+                Execution.reset();
+            }
+
+            Timestamp.reset();
+            if (doc.ValueExists("timestamp"))
+            {
+                Timestamp = Aws::Iotdevicecommon::PackedDateTime::FromSeconds(doc.GetDouble("timestamp"));
+            }
+        }
+
     } // namespace Iotjobs
 } // namespace Aws
@@ -0,0 +1,425 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/PendingJobSummaries.h>
+
+#include <aws/iotdevicecommon/JsonPayloadScanner.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        namespace Scanner = Iotdevicecommon::JsonPayloadScanner;
+
+        namespace
+        {
+            uint64_t s_hashJobId(const uint8_t *bytes, size_t length)
+            {
+                /* FNV-1a; job ids are short. */
+                uint64_t hash = 14695981039346656037ULL;
+                for (size_t i = 0; i < length; ++i)
+                {
+                    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+                }
+                return hash;
+            }
+
+            bool s_keyIs(const Crt::ByteCursor &key, const char *name)
+            {
+                size_t length = strlen(name);
+                return key.len == length && memcmp(key.ptr, name, length) == 0;
+            }
+
+            int64_t s_packSeconds(double seconds) { return static_cast<int64_t>(std::llround(seconds * 1000.0)); }
+
+            PackedJobSummary s_emptySummary()
+            {
+                PackedJobSummary summary;
+                memset(&summary, 0, sizeof(summary));
+                return summary;
+            }
+
+            /* Reads one summary object of a raw payload; members that are null or of another type are left out. */
+            bool s_scanSummary(const Crt::ByteCursor &object, PackedJobSummary &summary, Crt::String &jobId)
+            {
+                summary = s_emptySummary();
+                return Scanner::ForEachMember(
+                    object, [&summary, &jobId](const Crt::ByteCursor &key, const Crt::ByteCursor &value) {
+                        int64_t integer = 0;
+                        double number = 0;
+                        if (s_keyIs(key, "jobId"))
+                        {
+                            if (Scanner::ReadString(value, jobId))
+                            {
+                                summary.Present |= PackedJobSummary::HasJobId;
+                            }
+                        }
+                        else if (s_keyIs(key, "executionNumber"))
+                        {
+                            if (Scanner::ReadInteger(value, integer))
+                            {
+                                summary.ExecutionNumber = integer;
+                                summary.Present |= PackedJobSummary::HasExecutionNumber;
+                            }
+                        }
+                        else if (s_keyIs(key, "versionNumber"))
+                        {
+                            if (Scanner::ReadInteger(value, integer))
+                            {
+                                summary.VersionNumber = static_cast<int32_t>(integer);
+                                summary.Present |= PackedJobSummary::HasVersionNumber;
+                            }
+                        }
+                        else if (s_keyIs(key, "queuedAt"))
+                        {
+                            if (Scanner::ReadDouble(value, number))
+                            {
+                                summary.QueuedAtMs = s_packSeconds(number);
+                                summary.Present |= PackedJobSummary::HasQueuedAt;
+                            }
+                        }
+                        else if (s_keyIs(key, "startedAt"))
+                        {
+                            if (Scanner::ReadDouble(value, number))
+                            {
+                                summary.StartedAtMs = s_packSeconds(number);
+                                summary.Present |= PackedJobSummary::HasStartedAt;
+                            }
+                        }
+                        else if (s_keyIs(key, "lastUpdatedAt"))
+                        {
+                            if (Scanner::ReadDouble(value, number))
+                            {
+                                summary.LastUpdatedAtMs = s_packSeconds(number);
+                                summary.Present |= PackedJobSummary::HasLastUpdatedAt;
+                            }
+                        }
+                        return true;
+                    });
+            }
+
+            void s_loadSummary(const Crt::JsonView &object, PackedJobSummary &summary, Crt::String &jobId)
+            {
+                summary = s_emptySummary();
+                if (object.ValueExists("jobId"))
+                {
+                    jobId = object.GetString("jobId");
+                    summary.Present |= PackedJobSummary::HasJobId;
+                }
+                if (object.ValueExists("executionNumber"))
+                {
+                    summary.ExecutionNumber = object.GetInt64("executionNumber");
+                    summary.Present |= PackedJobSummary::HasExecutionNumber;
+                }
+                if (object.ValueExists("versionNumber"))
+                {
+                    summary.VersionNumber = object.GetInteger("versionNumber");
+                    summary.Present |= PackedJobSummary::HasVersionNumber;
+                }
+                if (object.ValueExists("queuedAt"))
+                {
+                    summary.QueuedAtMs = s_packSeconds(object.GetDouble("queuedAt"));
+                    summary.Present |= PackedJobSummary::HasQueuedAt;
+                }
+                if (object.ValueExists("startedAt"))
+                {
+                    summary.StartedAtMs = s_packSeconds(object.GetDouble("startedAt"));
+                    summary.Present |= PackedJobSummary::HasStartedAt;
+                }
+                if (object.ValueExists("lastUpdatedAt"))
+                {
+                    summary.LastUpdatedAtMs = s_packSeconds(object.GetDouble("lastUpdatedAt"));
+                    summary.Present |= PackedJobSummary::HasLastUpdatedAt;
+                }
+            }
+        } // namespace
+
+        PendingJobSummaries::PendingJobSummaries(Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_summaries(Crt::StlAllocator<PackedJobSummary>(allocator)),
+              m_inProgressCount(0), m_jobIds(Crt::StlAllocator<char>(allocator)),
+              m_internTable(Crt::StlAllocator<uint32_t>(allocator)), m_internedCount(0)
+        {
+        }
+
+        void PendingJobSummaries::Clear() noexcept
+        {
+            m_summaries.clear();
+            m_inProgressCount = 0;
+            m_jobIds.clear();
+            std::fill(m_internTable.begin(), m_internTable.end(), 0);
+            m_internedCount = 0;
+            m_clientToken.reset();
+            m_timestamp.reset();
+        }
+
+        bool PendingJobSummaries::Parse(const Crt::ByteCursor &payload)
+        {
+            Clear();
+
+            /* One pass for the top-level members, so the lists can be read in progress first. */
+            Crt::ByteCursor inProgressJobs;
+            Crt::ByteCursor queuedJobs;
+            bool hasInProgress = false;
+            bool hasQueued = false;
+            Crt::String clientToken{Crt::StlAllocator<char>(m_allocator)};
+            double timestamp = 0;
+            bool hasClientToken = false;
+            bool hasTimestamp = false;
+            bool ok = Scanner::ForEachMember(payload, [&](const Crt::ByteCursor &key, const Crt::ByteCursor &value) {
+                if (s_keyIs(key, "inProgressJobs"))
+                {
+                    inProgressJobs = value;
+                    hasInProgress = !Scanner::IsNull(value);
+                }
+                else if (s_keyIs(key, "queuedJobs"))
+                {
+                    queuedJobs = value;
+                    hasQueued = !Scanner::IsNull(value);
+                }
+                else if (s_keyIs(key, "clientToken"))
+                {
+                    hasClientToken = Scanner::ReadString(value, clientToken);
+                }
+                else if (s_keyIs(key, "timestamp"))
+                {
+                    hasTimestamp = Scanner::ReadDouble(value, timestamp);
+                }
+                return true;
+            });
+
+            Crt::String jobId{Crt::StlAllocator<char>(m_allocator)};
+            PackedJobSummary summary = s_emptySummary();
+            auto onElement = [this, &summary, &jobId](const Crt::ByteCursor &element) {
+                if (!s_scanSummary(element, summary, jobId))
+                {
+                    return false;
+                }
+                Append(summary, jobId);
+                return true;
+            };
+
+            ok = ok && (!hasInProgress || Scanner::ForEachElement(inProgressJobs, onElement));
+            m_inProgressCount = m_summaries.size();
+            ok = ok && (!hasQueued || Scanner::ForEachElement(queuedJobs, onElement));
+            if (!ok)
+            {
+                Clear();
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (hasClientToken)
+            {
+                m_clientToken = std::move(clientToken);
+            }
+            if (hasTimestamp)
+            {
+                m_timestamp = Iotdevicecommon::PackedDateTime::FromSeconds(timestamp);
+            }
+            return true;
+        }
+
+        bool PendingJobSummaries::Load(const Crt::JsonView &doc)
+        {
+            Clear();
+            if (!doc.IsObject())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Crt::String jobId{Crt::StlAllocator<char>(m_allocator)};
+            PackedJobSummary summary = s_emptySummary();
+            const char *lists[] = {"inProgressJobs", "queuedJobs"};
+            for (const char *list : lists)
+            {
+                if (doc.ValueExists(list))
+                {
+                    for (const auto &element : doc.GetArray(list))
+                    {
+                        s_loadSummary(element, summary, jobId);
+                        Append(summary, jobId);
+                    }
+                }
+                if (list == lists[0])
+                {
+                    m_inProgressCount = m_summaries.size();
+                }
+            }
+
+            if (doc.ValueExists("clientToken"))
+            {
+                m_clientToken = doc.GetString("clientToken");
+            }
+            if (doc.ValueExists("timestamp"))
+            {
+                m_timestamp = Iotdevicecommon::PackedDateTime::FromSeconds(doc.GetDouble("timestamp"));
+            }
+            return true;
+        }
+
+        void PendingJobSummaries::Append(PackedJobSummary &summary, const Crt::String &jobId)
+        {
+            if (summary.Present & PackedJobSummary::HasJobId)
+            {
+                if ((m_internedCount + 1) * 2 > m_internTable.size())
+                {
+                    Rehash(std::max<size_t>(16, m_internTable.size() * 2));
+                }
+
+                const uint8_t *bytes = reinterpret_cast<const uint8_t *>(jobId.data());
+                size_t mask = m_internTable.size() - 1;
+                size_t slot = static_cast<size_t>(s_hashJobId(bytes, jobId.size())) & mask;
+                bool interned = false;
+                while (m_internTable[slot] != 0)
+                {
+                    const PackedJobSummary &holder = m_summaries[m_internTable[slot] - 1];
+                    if (holder.JobIdLength == jobId.size() &&
+                        memcmp(m_jobIds.data() + holder.JobIdOffset, bytes, jobId.size()) == 0)
+                    {
+                        summary.JobIdOffset = holder.JobIdOffset;
+                        summary.JobIdLength = holder.JobIdLength;
+                        interned = true;
+                        break;
+                    }
+                    slot = (slot + 1) & mask;
+                }
+
+                if (!interned)
+                {
+                    summary.JobIdOffset = static_cast<uint32_t>(m_jobIds.size());
+                    summary.JobIdLength = static_cast<uint32_t>(jobId.size());
+                    m_jobIds.append(jobId);
+                    m_internTable[slot] = static_cast<uint32_t>(m_summaries.size() + 1);
+                    ++m_internedCount;
+                }
+            }
+
+            m_summaries.push_back(summary);
+        }
+
+        void PendingJobSummaries::Rehash(size_t capacity)
+        {
+            m_internTable.assign(capacity, 0);
+            size_t mask = capacity - 1;
+            for (size_t i = 0; i < m_summaries.size(); ++i)
+            {
+                const PackedJobSummary &summary = m_summaries[i];
+                if (!(summary.Present & PackedJobSummary::HasJobId))
+                {
+                    continue;
+                }
+
+                const uint8_t *bytes = reinterpret_cast<const uint8_t *>(m_jobIds.data()) + summary.JobIdOffset;
+                size_t slot = static_cast<size_t>(s_hashJobId(bytes, summary.JobIdLength)) & mask;
+                bool seen = false;
+                while (m_internTable[slot] != 0)
+                {
+                    seen |= m_summaries[m_internTable[slot] - 1].JobIdOffset == summary.JobIdOffset;
+                    slot = (slot + 1) & mask;
+                }
+                if (!seen)
+                {
+                    m_internTable[slot] = static_cast<uint32_t>(i + 1);
+                }
+            }
+        }
+
+        Crt::ByteCursor PendingJobSummaries::GetJobId(const PackedJobSummary &summary) const noexcept
+        {
+            if (!(summary.Present & PackedJobSummary::HasJobId))
+            {
+                return Crt::ByteCursorFromArray(nullptr, 0);
+            }
+
+            return Crt::ByteCursorFromArray(
+                reinterpret_cast<const uint8_t *>(m_jobIds.data()) + summary.JobIdOffset, summary.JobIdLength);
+        }
+
+        const PackedJobSummary *PendingJobSummaries::Find(const Crt::ByteCursor &jobId) const noexcept
+        {
+            if (m_internTable.empty())
+            {
+                return nullptr;
+            }
+
+            size_t mask = m_internTable.size() - 1;
+            size_t slot = static_cast<size_t>(s_hashJobId(jobId.ptr, jobId.len)) & mask;
+            while (m_internTable[slot] != 0)
+            {
+                const PackedJobSummary &holder = m_summaries[m_internTable[slot] - 1];
+                if (holder.JobIdLength == jobId.len &&
+                    memcmp(m_jobIds.data() + holder.JobIdOffset, jobId.ptr, jobId.len) == 0)
+                {
+                    return &holder;
+                }
+                slot = (slot + 1) & mask;
+            }
+            return nullptr;
+        }
+
+        JobExecutionSummary PendingJobSummaries::Materialize(const PackedJobSummary &summary) const
+        {
+            JobExecutionSummary materialized;
+            if (summary.Present & PackedJobSummary::HasJobId)
+            {
+                materialized.JobId = Crt::String(m_jobIds.data() + summary.JobIdOffset, summary.JobIdLength);
+            }
+            if (summary.Present & PackedJobSummary::HasExecutionNumber)
+            {
+                materialized.ExecutionNumber = summary.ExecutionNumber;
+            }
+            if (summary.Present & PackedJobSummary::HasVersionNumber)
+            {
+                materialized.VersionNumber = summary.VersionNumber;
+            }
+            if (summary.Present & PackedJobSummary::HasQueuedAt)
+            {
+                materialized.QueuedAt = Iotdevicecommon::PackedDateTime::FromMilliseconds(summary.QueuedAtMs);
+            }
+            if (summary.Present & PackedJobSummary::HasStartedAt)
+            {
+                materialized.StartedAt = Iotdevicecommon::PackedDateTime::FromMilliseconds(summary.StartedAtMs);
+            }
+            if (summary.Present & PackedJobSummary::HasLastUpdatedAt)
+            {
+                materialized.LastUpdatedAt = Iotdevicecommon::PackedDateTime::FromMilliseconds(summary.LastUpdatedAtMs);
+            }
+            return materialized;
+        }
+
+        GetPendingJobExecutionsResponse PendingJobSummaries::Materialize() const
+        {
+            GetPendingJobExecutionsResponse response;
+            response.InProgressJobs = Crt::Vector<JobExecutionSummary>();
+            response.InProgressJobs->reserve(GetInProgressCount());
+            for (size_t i = 0; i < GetInProgressCount(); ++i)
+            {
+                response.InProgressJobs->push_back(Materialize(GetInProgressJobs()[i]));
+            }
+
+            response.QueuedJobs = Crt::Vector<JobExecutionSummary>();
+            response.QueuedJobs->reserve(GetQueuedCount());
+            for (size_t i = 0; i < GetQueuedCount(); ++i)
+            {
+                response.QueuedJobs->push_back(Materialize(GetQueuedJobs()[i]));
+            }
+
+            if (m_clientToken)
+            {
+                response.ClientToken = *m_clientToken;
+            }
+            if (m_timestamp)
+            {
+                response.Timestamp = m_timestamp;
+            }
+            return response;
+        }
+
+    } // namespace Iotjobs
+} // namespace Aws
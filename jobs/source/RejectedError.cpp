@@ -4,72 +4,39 @@
  */
 #include <aws/iotjobs/RejectedError.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<RejectedError>;
+            using RejectedErrorCodeCodec = Aws::Iotdevicecommon::EnumCodec<
+                RejectedErrorCode,
+                RejectedErrorCodeMarshaller::FromString,
+                RejectedErrorCodeMarshaller::ToString>;
+            using JobExecutionStateCodec = Aws::Iotdevicecommon::ModelCodec<JobExecutionState>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<RejectedError> s_fields[] = {
+                Fields::Timestamp<&RejectedError::Timestamp>("timestamp"),
+                Fields::Field<RejectedErrorCode, &RejectedError::Code, RejectedErrorCodeCodec>("code"),
+                Fields::Field<Crt::String, &RejectedError::Message>("message"),
+                Fields::Field<Crt::String, &RejectedError::ClientToken>("clientToken"),
+                Fields::Field<JobExecutionState, &RejectedError::ExecutionState, JobExecutionStateCodec>(
+                    "executionState"),
+            };
+        } // namespace
 
         void RejectedError::LoadFromObject(RejectedError &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("timestamp"))
-            {
-                val.Timestamp = doc.GetDouble("timestamp");
-            }
-
-            if (doc.ValueExists("code"))
-            {
-                val.Code = RejectedErrorCodeMarshaller::FromString(doc.GetString("code"));
-            }
-
-            if (doc.ValueExists("message"))
-            {
-                val.Message = doc.GetString("message");
-            }
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
-
-            if (doc.ValueExists("executionState"))
-            {
-                val.ExecutionState = doc.GetJsonObject("executionState");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void RejectedError::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (Timestamp)
-            {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
-            }
-
-            if (Code)
-            {
-                object.WithString("code", RejectedErrorCodeMarshaller::ToString(*Code));
-            }
-
-            if (Message)
-            {
-                object.WithString("message", *Message);
-            }
-
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
-
-            if (ExecutionState)
-            {
-                Aws::Crt::JsonObject jsonObject;
-                ExecutionState->SerializeToObject(jsonObject);
-                object.WithObject("executionState", std::move(jsonObject));
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         RejectedError::RejectedError(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
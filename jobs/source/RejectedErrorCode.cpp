@@ -5,25 +5,38 @@
 #include <aws/iotjobs/RejectedErrorCode.h>
 
 #include <aws/crt/StlAllocator.h>
-#include <aws/crt/StringUtils.h>
+#include <aws/iotdevicecommon/EnumTable.h>
 
 #include <assert.h>
 
-static const size_t INVALIDTOPIC_HASH = Aws::Crt::HashString("InvalidTopic");
-static const size_t INVALIDJSON_HASH = Aws::Crt::HashString("InvalidJson");
-static const size_t INVALIDREQUEST_HASH = Aws::Crt::HashString("InvalidRequest");
-static const size_t INVALIDSTATETRANSITION_HASH = Aws::Crt::HashString("InvalidStateTransition");
-static const size_t RESOURCENOTFOUND_HASH = Aws::Crt::HashString("ResourceNotFound");
-static const size_t VERSIONMISMATCH_HASH = Aws::Crt::HashString("VersionMismatch");
-static const size_t INTERNALERROR_HASH = Aws::Crt::HashString("InternalError");
-static const size_t REQUESTTHROTTLED_HASH = Aws::Crt::HashString("RequestThrottled");
-static const size_t TERMINALSTATEREACHED_HASH = Aws::Crt::HashString("TerminalStateReached");
-
 namespace Aws
 {
     namespace Iotjobs
     {
 
+        namespace
+        {
+            /* Slot (length * 8 + middle character + last character) % 16; see EnumTableSlot. */
+            constexpr Iotdevicecommon::EnumTableEntry<RejectedErrorCode> s_slots[16] = {
+                {nullptr, 0, RejectedErrorCode()},
+                {nullptr, 0, RejectedErrorCode()},
+                {"ResourceNotFound", 16, RejectedErrorCode::ResourceNotFound},
+                {"InvalidStateTransition", 22, RejectedErrorCode::InvalidStateTransition},
+                {nullptr, 0, RejectedErrorCode()},
+                {"TerminalStateReached", 20, RejectedErrorCode::TerminalStateReached},
+                {"InvalidRequest", 14, RejectedErrorCode::InvalidRequest},
+                {"InvalidTopic", 12, RejectedErrorCode::InvalidTopic},
+                {nullptr, 0, RejectedErrorCode()},
+                {nullptr, 0, RejectedErrorCode()},
+                {nullptr, 0, RejectedErrorCode()},
+                {"InternalError", 13, RejectedErrorCode::InternalError},
+                {"RequestThrottled", 16, RejectedErrorCode::RequestThrottled},
+                {"VersionMismatch", 15, RejectedErrorCode::VersionMismatch},
+                {nullptr, 0, RejectedErrorCode()},
+                {"InvalidJson", 11, RejectedErrorCode::InvalidJson},
+            };
+        } // namespace
+
         namespace RejectedErrorCodeMarshaller
         {
             const char *ToString(RejectedErrorCode status)
@@ -56,51 +69,10 @@ namespace Aws
 
             RejectedErrorCode FromString(const Crt::String &str)
             {
-                size_t hash = Crt::HashString(str.c_str());
-
-                if (hash == INVALIDTOPIC_HASH)
-                {
-                    return RejectedErrorCode::InvalidTopic;
-                }
-
-                if (hash == INVALIDJSON_HASH)
-                {
-                    return RejectedErrorCode::InvalidJson;
-                }
-
-                if (hash == INVALIDREQUEST_HASH)
-                {
-                    return RejectedErrorCode::InvalidRequest;
-                }
-
-                if (hash == INVALIDSTATETRANSITION_HASH)
-                {
-                    return RejectedErrorCode::InvalidStateTransition;
-                }
-
-                if (hash == RESOURCENOTFOUND_HASH)
-                {
-                    return RejectedErrorCode::ResourceNotFound;
-                }
-
-                if (hash == VERSIONMISMATCH_HASH)
-                {
-                    return RejectedErrorCode::VersionMismatch;
-                }
-
-                if (hash == INTERNALERROR_HASH)
-                {
-                    return RejectedErrorCode::InternalError;
-                }
-
-                if (hash == REQUESTTHROTTLED_HASH)
-                {
-                    return RejectedErrorCode::RequestThrottled;
-                }
-
-                if (hash == TERMINALSTATEREACHED_HASH)
+                RejectedErrorCode value;
+                if (Iotdevicecommon::LookupEnum<8>(s_slots, str.data(), str.length(), value))
                 {
-                    return RejectedErrorCode::TerminalStateReached;
+                    return value;
                 }
 
                 assert(0);
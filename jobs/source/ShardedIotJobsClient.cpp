@@ -0,0 +1,455 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/ShardedIotJobsClient.h>
+
+#include <aws/iotjobs/DescribeJobExecutionRequest.h>
+#include <aws/iotjobs/DescribeJobExecutionSubscriptionRequest.h>
+#include <aws/iotjobs/GetPendingJobExecutionsRequest.h>
+#include <aws/iotjobs/GetPendingJobExecutionsSubscriptionRequest.h>
+#include <aws/iotjobs/JobExecutionsChangedSubscriptionRequest.h>
+#include <aws/iotjobs/NextJobExecutionChangedSubscriptionRequest.h>
+#include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
+#include <aws/iotjobs/StartNextPendingJobExecutionSubscriptionRequest.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+#include <aws/iotjobs/UpdateJobExecutionSubscriptionRequest.h>
+namespace Aws
+{
+    namespace Iotjobs
+    {
+
+        ShardedIotJobsClient::ShardedIotJobsClient(
+            const Aws::Crt::Vector<std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>> &connections,
+            Aws::Crt::Allocator *allocator)
+            : ShardedIotJobsClient(connections, Aws::Iotdevicecommon::ServiceClientConfig(), allocator)
+        {
+        }
+
+        ShardedIotJobsClient::ShardedIotJobsClient(
+            const Aws::Crt::Vector<std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>> &connections,
+            const Aws::Iotdevicecommon::ServiceClientConfig &config,
+            Aws::Crt::Allocator *allocator)
+            : m_ring(connections.size(), 64, allocator), m_shards(allocator)
+        {
+            m_shards.reserve(connections.size());
+            for (const auto &connection : connections)
+            {
+                m_shards.emplace_back(connection, config, allocator);
+            }
+        }
+
+        ShardedIotJobsClient::operator bool() const noexcept
+        {
+            if (m_shards.empty())
+            {
+                return false;
+            }
+            for (const auto &shard : m_shards)
+            {
+                if (!shard)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        int ShardedIotJobsClient::GetLastError() const noexcept { return aws_last_error(); }
+
+        size_t ShardedIotJobsClient::GetShardCount() const noexcept { return m_shards.size(); }
+
+        IotJobsClient &ShardedIotJobsClient::GetClientForThing(const Aws::Crt::String &thingName) noexcept
+        {
+            return m_shards[m_ring.ShardFor(thingName)];
+        }
+
+        IotJobsClient *ShardedIotJobsClient::ShardFor(const Aws::Crt::Optional<Aws::Crt::String> &thingName) noexcept
+        {
+            if (m_shards.empty())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return nullptr;
+            }
+            if (!thingName)
+            {
+                return &m_shards[0];
+            }
+            return &m_shards[m_ring.ShardFor(*thingName)];
+        }
+
+        bool ShardedIotJobsClient::SubscribeToUpdateJobExecutionAccepted(
+            const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToUpdateJobExecutionAcceptedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateJobExecutionAccepted(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToUpdateJobExecutionAccepted(
+            const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateJobExecutionAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateJobExecutionAccepted(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToGetPendingJobExecutionsRejected(
+            const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToGetPendingJobExecutionsRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToGetPendingJobExecutionsRejected(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToGetPendingJobExecutionsRejected(
+            const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetPendingJobExecutionsRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard &&
+                   shard->SubscribeToGetPendingJobExecutionsRejected(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToDescribeJobExecutionAccepted(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToDescribeJobExecutionAcceptedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDescribeJobExecutionAccepted(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToDescribeJobExecutionAccepted(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDescribeJobExecutionAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDescribeJobExecutionAccepted(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToDescribeJobExecutionAcceptedLazy(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToJobExecutionDataViewResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDescribeJobExecutionAcceptedLazy(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToDescribeJobExecutionAcceptedLazy(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToJobExecutionDataViewResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard &&
+                   shard->SubscribeToDescribeJobExecutionAcceptedLazy(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToDescribeJobExecutionAcceptedRaw(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToRawPayloadResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDescribeJobExecutionAcceptedRaw(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToDescribeJobExecutionAcceptedRaw(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToRawPayloadResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard &&
+                   shard->SubscribeToDescribeJobExecutionAcceptedRaw(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToDescribeJobExecutionRejected(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToDescribeJobExecutionRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDescribeJobExecutionRejected(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToDescribeJobExecutionRejected(
+            const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDescribeJobExecutionRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDescribeJobExecutionRejected(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToUpdateJobExecutionRejected(
+            const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToUpdateJobExecutionRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateJobExecutionRejected(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToUpdateJobExecutionRejected(
+            const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateJobExecutionRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateJobExecutionRejected(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToJobExecutionsChangedEvents(
+            const Aws::Iotjobs::JobExecutionsChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToJobExecutionsChangedEventsResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToJobExecutionsChangedEvents(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToJobExecutionsChangedEvents(
+            const Aws::Iotjobs::JobExecutionsChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToJobExecutionsChangedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToJobExecutionsChangedEvents(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToStartNextPendingJobExecutionRejected(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToStartNextPendingJobExecutionRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToStartNextPendingJobExecutionRejected(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToStartNextPendingJobExecutionRejected(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToStartNextPendingJobExecutionRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard &&
+                   shard->SubscribeToStartNextPendingJobExecutionRejected(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToNextJobExecutionChangedEvents(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToNextJobExecutionChangedEventsResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToNextJobExecutionChangedEvents(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToNextJobExecutionChangedEvents(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToNextJobExecutionChangedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToNextJobExecutionChangedEvents(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToNextJobExecutionChangedEventsLazy(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToJobExecutionDataViewResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToNextJobExecutionChangedEventsLazy(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToNextJobExecutionChangedEventsLazy(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToJobExecutionDataViewResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard &&
+                   shard->SubscribeToNextJobExecutionChangedEventsLazy(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToNextJobExecutionChangedEventsRaw(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToRawPayloadResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToNextJobExecutionChangedEventsRaw(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToNextJobExecutionChangedEventsRaw(
+            const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToRawPayloadResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard &&
+                   shard->SubscribeToNextJobExecutionChangedEventsRaw(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToGetPendingJobExecutionsAccepted(
+            const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToGetPendingJobExecutionsAcceptedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToGetPendingJobExecutionsAccepted(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToGetPendingJobExecutionsAccepted(
+            const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetPendingJobExecutionsAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard &&
+                   shard->SubscribeToGetPendingJobExecutionsAccepted(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToStartNextPendingJobExecutionAccepted(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToStartNextPendingJobExecutionAcceptedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToStartNextPendingJobExecutionAccepted(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToStartNextPendingJobExecutionAccepted(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToStartNextPendingJobExecutionAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard &&
+                   shard->SubscribeToStartNextPendingJobExecutionAccepted(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToStartNextPendingJobExecutionAcceptedLazy(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToJobExecutionDataViewResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToStartNextPendingJobExecutionAcceptedLazy(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToStartNextPendingJobExecutionAcceptedLazy(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToJobExecutionDataViewResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToStartNextPendingJobExecutionAcceptedLazy(
+                                request,
+                                qos,
+                                std::move(handler),
+                                onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToStartNextPendingJobExecutionAcceptedRaw(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToRawPayloadResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToStartNextPendingJobExecutionAcceptedRaw(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotJobsClient::SubscribeToStartNextPendingJobExecutionAcceptedRaw(
+            const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToRawPayloadResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToStartNextPendingJobExecutionAcceptedRaw(
+                                request,
+                                qos,
+                                std::move(handler),
+                                onSubAck);
+        }
+
+        bool ShardedIotJobsClient::PublishDescribeJobExecution(
+            const Aws::Iotjobs::DescribeJobExecutionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->PublishDescribeJobExecution(request, qos, onPubAck);
+        }
+
+        bool ShardedIotJobsClient::PublishGetPendingJobExecutions(
+            const Aws::Iotjobs::GetPendingJobExecutionsRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->PublishGetPendingJobExecutions(request, qos, onPubAck);
+        }
+
+        bool ShardedIotJobsClient::PublishUpdateJobExecution(
+            const Aws::Iotjobs::UpdateJobExecutionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->PublishUpdateJobExecution(request, qos, onPubAck);
+        }
+
+        bool ShardedIotJobsClient::PublishStartNextPendingJobExecution(
+            const Aws::Iotjobs::StartNextPendingJobExecutionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->PublishStartNextPendingJobExecution(request, qos, onPubAck);
+        }
+
+    } // namespace Iotjobs
+
+} // namespace Aws
@@ -4,54 +4,35 @@
  */
 #include <aws/iotjobs/StartNextJobExecutionResponse.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<StartNextJobExecutionResponse>;
+            using JobExecutionDataCodec = Aws::Iotdevicecommon::ModelCodec<JobExecutionData>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<StartNextJobExecutionResponse> s_fields[] = {
+                Fields::Field<Crt::String, &StartNextJobExecutionResponse::ClientToken>("clientToken"),
+                Fields::Timestamp<&StartNextJobExecutionResponse::Timestamp>("timestamp"),
+                Fields::Field<JobExecutionData, &StartNextJobExecutionResponse::Execution, JobExecutionDataCodec>(
+                    "execution"),
+            };
+        } // namespace
 
         void StartNextJobExecutionResponse::LoadFromObject(
             StartNextJobExecutionResponse &val,
             const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
-
-            if (doc.ValueExists("timestamp"))
-            {
-                val.Timestamp = doc.GetDouble("timestamp");
-            }
-
-            if (doc.ValueExists("execution"))
-            {
-                val.Execution = doc.GetJsonObject("execution");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void StartNextJobExecutionResponse::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
-
-            if (Timestamp)
-            {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
-            }
-
-            if (Execution)
-            {
-                Aws::Crt::JsonObject jsonObject;
-                Execution->SerializeToObject(jsonObject);
-                object.WithObject("execution", std::move(jsonObject));
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         StartNextJobExecutionResponse::StartNextJobExecutionResponse(const Crt::JsonView &doc)
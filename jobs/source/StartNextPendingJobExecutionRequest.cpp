@@ -4,66 +4,40 @@
  */
 #include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<StartNextPendingJobExecutionRequest, true>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<StartNextPendingJobExecutionRequest> s_fields[] = {
+                Fields::Field<int64_t, &StartNextPendingJobExecutionRequest::StepTimeoutInMinutes>(
+                    "stepTimeoutInMinutes"),
+                Fields::Field<Crt::String, &StartNextPendingJobExecutionRequest::ClientToken>("clientToken"),
+                Fields::Field<Aws::Iotdevicecommon::FlatStringMap, &StartNextPendingJobExecutionRequest::StatusDetails>(
+                    "statusDetails"),
+            };
+        } // namespace
 
         void StartNextPendingJobExecutionRequest::LoadFromObject(
             StartNextPendingJobExecutionRequest &val,
             const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("stepTimeoutInMinutes"))
-            {
-                val.StepTimeoutInMinutes = doc.GetInt64("stepTimeoutInMinutes");
-            }
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
-
-            if (doc.ValueExists("statusDetails"))
-            {
-                auto statusDetailsMap = doc.GetJsonObject("statusDetails");
-                val.StatusDetails = Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
-                for (auto &statusDetailsMapMember : statusDetailsMap.GetAllObjects())
-                {
-                    Aws::Crt::String statusDetailsMapValMember;
-                    statusDetailsMapValMember = statusDetailsMapMember.second.AsString();
-                    val.StatusDetails->emplace(statusDetailsMapMember.first, std::move(statusDetailsMapValMember));
-                }
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void StartNextPendingJobExecutionRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (StepTimeoutInMinutes)
-            {
-                object.WithInt64("stepTimeoutInMinutes", *StepTimeoutInMinutes);
-            }
-
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (StatusDetails)
-            {
-                Aws::Crt::JsonObject statusDetailsMap;
-                for (auto &statusDetailsMapMember : *StatusDetails)
-                {
-                    Aws::Crt::JsonObject statusDetailsMapValMember;
-                    statusDetailsMapValMember.AsString(statusDetailsMapMember.second);
-                    statusDetailsMap.WithObject(statusDetailsMapMember.first, std::move(statusDetailsMapValMember));
-                }
-                object.WithObject("statusDetails", std::move(statusDetailsMap));
-            }
+        void StartNextPendingJobExecutionRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         StartNextPendingJobExecutionRequest::StartNextPendingJobExecutionRequest(const Crt::JsonView &doc)
@@ -0,0 +1,671 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/StreamDownloader.h>
+
+#include <aws/iotdevicecommon/ClientToken.h>
+#include <aws/iotdevicecommon/JsonPayloadScanner.h>
+#include <aws/iotdevicecommon/SubscriptionHandle.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/encoding.h>
+#include <aws/common/file.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/io.h>
+
+#include <cinttypes>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        namespace
+        {
+            static const uint32_t s_minBlockSize = 256;
+            static const uint32_t s_maxBlockSize = 128 * 1024;
+
+            struct TimeoutTask
+            {
+                aws_task Task;
+                std::weak_ptr<StreamDownloader> Owner;
+                Crt::Allocator *Allocator;
+            };
+
+            /* Finds a string member, without its quotes. Only escapes the value does not contain are handled. */
+            bool s_findString(const Crt::ByteCursor &payload, const char *key, Crt::ByteCursor &value)
+            {
+                if (!Iotdevicecommon::JsonPayloadScanner::FindMember(payload, key, value) || value.len < 2 ||
+                    value.ptr[0] != '"')
+                {
+                    return false;
+                }
+                aws_byte_cursor_advance(&value, 1);
+                --value.len;
+                return true;
+            }
+
+            struct FileSink
+            {
+                explicit FileSink(FILE *file) noexcept : File(file) {}
+                ~FileSink() { fclose(File); }
+
+                FILE *File;
+            };
+        } // namespace
+
+        bool StreamFileInfo::FromJobDocument(const Crt::JsonView &jobDocument, size_t fileIndex, StreamFileInfo &info)
+        {
+            if (!jobDocument.ValueExists("afr_ota"))
+            {
+                return false;
+            }
+
+            Crt::JsonView ota = jobDocument.GetJsonObject("afr_ota");
+            if (!ota.ValueExists("streamname") || !ota.ValueExists("files"))
+            {
+                return false;
+            }
+
+            Crt::Vector<Crt::JsonView> files = ota.GetArray("files");
+            if (fileIndex >= files.size() || !files[fileIndex].ValueExists("fileid") ||
+                !files[fileIndex].ValueExists("filesize"))
+            {
+                return false;
+            }
+
+            const Crt::JsonView &file = files[fileIndex];
+            info.StreamId = ota.GetString("streamname");
+            info.FileId = file.GetInteger("fileid");
+            info.FileSize = static_cast<uint64_t>(file.GetInt64("filesize"));
+            info.FilePath = file.ValueExists("filepath") ? file.GetString("filepath") : Crt::String();
+            return true;
+        }
+
+        StreamDownloaderConfig::StreamDownloaderConfig() noexcept
+            : BlockSize(4096), MaxBlocksInFlight(4), BlockTimeoutMs(5000), MaxBlockRetries(5),
+              Qos(AWS_MQTT_QOS_AT_LEAST_ONCE)
+        {
+        }
+
+        StreamDownloader::StreamDownloader(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const StreamFileInfo &file,
+            OnBlock &&onBlock,
+            OnDownloadComplete &&onComplete,
+            const StreamDownloaderConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_connection(connection),
+              m_eventLoop(aws_event_loop_group_get_next_loop(eventLoopGroup.GetUnderlyingHandle())), m_file(file),
+              m_config(config), m_allocator(allocator), m_onBlock(std::move(onBlock)),
+              m_onComplete(std::move(onComplete)), m_clientToken(Iotdevicecommon::GenerateClientToken()),
+              m_blockCount(0), m_started(false), m_finished(false), m_pendingSubAcks(0), m_blocksRemaining(0),
+              m_nextBlock(0), m_timeoutCheckScheduled(false), m_startNs(0)
+        {
+            Crt::String streamTopic("$aws/things/");
+            streamTopic.append(thingName).append("/streams/").append(m_file.StreamId);
+            m_requestTopic = streamTopic + "/get/json";
+            m_dataTopic = streamTopic + "/data/json";
+            m_rejectedTopic = streamTopic + "/rejected/json";
+
+            if (m_config.BlockSize)
+            {
+                m_blockCount = static_cast<uint32_t>((m_file.FileSize + m_config.BlockSize - 1) / m_config.BlockSize);
+            }
+            AWS_ZERO_STRUCT(m_decodeBuffer);
+        }
+
+        StreamDownloader::~StreamDownloader()
+        {
+            if (m_started && !m_finished)
+            {
+                Unsubscribe();
+            }
+            aws_byte_buf_clean_up(&m_decodeBuffer);
+        }
+
+        std::shared_ptr<StreamDownloader> StreamDownloader::Create(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const StreamFileInfo &file,
+            OnBlock &&onBlock,
+            OnDownloadComplete &&onComplete,
+            const StreamDownloaderConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<StreamDownloader *>(aws_mem_acquire(allocator, sizeof(StreamDownloader)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) StreamDownloader(
+                    connection,
+                    eventLoopGroup,
+                    thingName,
+                    file,
+                    std::move(onBlock),
+                    std::move(onComplete),
+                    config,
+                    allocator);
+                return std::shared_ptr<StreamDownloader>(
+                    toSeat, [allocator](StreamDownloader *downloader) { Crt::Delete(downloader, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool StreamDownloader::Start(const Crt::Vector<uint8_t> &receivedBlocks)
+        {
+            size_t bitmapSize = (m_blockCount + 7) / 8;
+            if (!m_onBlock || !m_connection || m_config.BlockSize < s_minBlockSize ||
+                m_config.BlockSize > s_maxBlockSize || m_config.MaxBlocksInFlight == 0 ||
+                (!receivedBlocks.empty() && receivedBlocks.size() != bitmapSize))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_started)
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_STATE);
+                    return false;
+                }
+
+                m_started = true;
+                m_startNs = Now();
+                m_bitmap = receivedBlocks.empty() ? Crt::Vector<uint8_t>(bitmapSize, 0) : receivedBlocks;
+                m_blocksRemaining = 0;
+                for (uint32_t block = 0; block < m_blockCount; ++block)
+                {
+                    m_blocksRemaining += IsReceived(block) ? 0 : 1;
+                }
+                m_pendingSubAcks = 2;
+            }
+
+            if (m_blocksRemaining == 0)
+            {
+                Finish(AWS_ERROR_SUCCESS);
+                return true;
+            }
+
+            std::weak_ptr<StreamDownloader> weakSelf = shared_from_this();
+            auto onSubAck = [weakSelf](
+                                Crt::Mqtt::MqttConnection &,
+                                uint16_t,
+                                const Crt::String &,
+                                Crt::Mqtt::QOS qos,
+                                int errorCode) {
+                auto self = weakSelf.lock();
+                if (self)
+                {
+                    bool refused = !errorCode && qos == AWS_MQTT_QOS_FAILURE;
+                    self->OnSubscribed(refused ? AWS_ERROR_INVALID_ARGUMENT : errorCode);
+                }
+            };
+
+            bool subscribed =
+                Iotdevicecommon::SubscribeWithHandle(
+                    m_connection,
+                    m_dataTopic.c_str(),
+                    m_config.Qos,
+                    [weakSelf](Crt::Mqtt::MqttConnection &, const Crt::String &, const Crt::ByteBuf &payload) {
+                        auto self = weakSelf.lock();
+                        if (self)
+                        {
+                            self->OnData(payload);
+                        }
+                    },
+                    onSubAck) != 0 &&
+                Iotdevicecommon::SubscribeWithHandle(
+                    m_connection,
+                    m_rejectedTopic.c_str(),
+                    m_config.Qos,
+                    [weakSelf](Crt::Mqtt::MqttConnection &, const Crt::String &, const Crt::ByteBuf &payload) {
+                        auto self = weakSelf.lock();
+                        if (self)
+                        {
+                            self->OnRejected(payload);
+                        }
+                    },
+                    onSubAck) != 0;
+
+            if (!subscribed)
+            {
+                int errorCode = Crt::LastErrorOrUnknown();
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_finished = true;
+                }
+                Unsubscribe();
+                aws_raise_error(errorCode);
+                return false;
+            }
+
+            return true;
+        }
+
+        void StreamDownloader::Cancel() { Finish(AWS_IO_OPERATION_CANCELLED); }
+
+        Crt::Vector<uint8_t> StreamDownloader::GetBlockBitmap() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_bitmap;
+        }
+
+        StreamDownloadStats StreamDownloader::GetStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            StreamDownloadStats stats = m_stats;
+            if (m_started && !m_finished)
+            {
+                stats.ElapsedNs = Now() - m_startNs;
+            }
+            return stats;
+        }
+
+        Crt::String StreamDownloader::GetRejection() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_rejection;
+        }
+
+        StreamDownloader::OnBlock StreamDownloader::CreateFileSink(const char *path)
+        {
+            FILE *file = aws_fopen(path, "r+b");
+            if (!file)
+            {
+                file = aws_fopen(path, "w+b");
+            }
+            if (!file)
+            {
+                return OnBlock();
+            }
+
+            auto sink = std::make_shared<FileSink>(file);
+            return [sink](uint64_t offset, const Crt::ByteCursor &data) {
+                if (fseek(sink->File, static_cast<long>(offset), SEEK_SET) != 0 ||
+                    fwrite(data.ptr, 1, data.len, sink->File) != data.len || fflush(sink->File) != 0)
+                {
+                    aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                    return false;
+                }
+                return true;
+            };
+        }
+
+        uint64_t StreamDownloader::Now() const
+        {
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &now);
+            return now;
+        }
+
+        bool StreamDownloader::IsReceived(uint32_t block) const noexcept
+        {
+            return (m_bitmap[block / 8] & (1u << (block % 8))) != 0;
+        }
+
+        void StreamDownloader::OnSubscribed(int errorCode)
+        {
+            if (errorCode)
+            {
+                Finish(errorCode);
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_finished || --m_pendingSubAcks > 0)
+                {
+                    return;
+                }
+            }
+
+            RequestBlocks();
+            ScheduleTimeoutCheck();
+        }
+
+        void StreamDownloader::OnData(const Crt::ByteBuf &payload)
+        {
+            Crt::ByteCursor message = Crt::ByteCursorFromByteBuf(payload);
+            Crt::ByteCursor token;
+            Crt::ByteCursor blockValue;
+            Crt::ByteCursor encoded;
+            int64_t blockId = 0;
+            if (!s_findString(message, "c", token) || !aws_byte_cursor_eq_c_str(&token, m_clientToken.c_str()) ||
+                !Iotdevicecommon::JsonPayloadScanner::FindMember(message, "i", blockValue) ||
+                !Iotdevicecommon::JsonPayloadScanner::ReadInteger(blockValue, blockId) ||
+                !s_findString(message, "p", encoded) || blockId < 0 || blockId >= m_blockCount)
+            {
+                return;
+            }
+
+            uint32_t block = static_cast<uint32_t>(blockId);
+            InFlightBlock request{block, 0, 0};
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_finished || m_pendingSubAcks > 0)
+                {
+                    return;
+                }
+                if (IsReceived(block))
+                {
+                    ++m_stats.DuplicateBlocks;
+                    return;
+                }
+
+                for (size_t i = 0; i < m_inFlight.size(); ++i)
+                {
+                    if (m_inFlight[i].Block == block)
+                    {
+                        request = m_inFlight[i];
+                        m_inFlight.erase(m_inFlight.begin() + static_cast<std::ptrdiff_t>(i));
+                        break;
+                    }
+                }
+            }
+
+            uint64_t offset = static_cast<uint64_t>(block) * m_config.BlockSize;
+            size_t expectedLength = static_cast<size_t>(
+                block + 1 < m_blockCount ? m_config.BlockSize : m_file.FileSize - offset);
+
+            bool stored = false;
+            bool corrupt = false;
+            {
+                std::lock_guard<std::mutex> sinkLock(m_sinkLock);
+
+                /* Some encoders escape the '/' of the base64 alphabet. */
+                Crt::String unescaped;
+                if (memchr(encoded.ptr, '\\', encoded.len))
+                {
+                    for (size_t i = 0; i < encoded.len; ++i)
+                    {
+                        if (encoded.ptr[i] != '\\')
+                        {
+                            unescaped.push_back(static_cast<char>(encoded.ptr[i]));
+                        }
+                    }
+                    encoded = aws_byte_cursor_from_array(unescaped.data(), unescaped.size());
+                }
+
+                size_t decodedLength = 0;
+                corrupt = aws_base64_compute_decoded_len(&encoded, &decodedLength) != AWS_OP_SUCCESS ||
+                          decodedLength != expectedLength;
+                if (!corrupt && m_decodeBuffer.capacity < decodedLength)
+                {
+                    aws_byte_buf_clean_up(&m_decodeBuffer);
+                    if (aws_byte_buf_init(&m_decodeBuffer, m_allocator, decodedLength) != AWS_OP_SUCCESS)
+                    {
+                        AWS_ZERO_STRUCT(m_decodeBuffer);
+                        corrupt = true;
+                    }
+                }
+
+                aws_byte_buf_reset(&m_decodeBuffer, false);
+                corrupt = corrupt || aws_base64_decode(&encoded, &m_decodeBuffer) != AWS_OP_SUCCESS;
+                if (!corrupt)
+                {
+                    stored = m_onBlock(offset, aws_byte_cursor_from_buf(&m_decodeBuffer));
+                }
+            }
+
+            if (corrupt)
+            {
+                /* Ask again rather than fail: the next copy may well be intact. */
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_retryQueue.push_back(request);
+                return;
+            }
+
+            if (!stored)
+            {
+                Finish(Crt::LastErrorOrUnknown());
+                return;
+            }
+
+            bool complete = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (IsReceived(block))
+                {
+                    ++m_stats.DuplicateBlocks;
+                    return;
+                }
+
+                m_bitmap[block / 8] |= static_cast<uint8_t>(1u << (block % 8));
+                ++m_stats.BlocksReceived;
+                m_stats.BytesReceived += expectedLength;
+                complete = --m_blocksRemaining == 0;
+            }
+
+            if (complete)
+            {
+                Finish(AWS_ERROR_SUCCESS);
+                return;
+            }
+
+            RequestBlocks();
+        }
+
+        void StreamDownloader::OnRejected(const Crt::ByteBuf &payload)
+        {
+            Crt::ByteCursor message = Crt::ByteCursorFromByteBuf(payload);
+            Crt::ByteCursor token;
+            if (!s_findString(message, "c", token) || !aws_byte_cursor_eq_c_str(&token, m_clientToken.c_str()))
+            {
+                return;
+            }
+
+            Crt::ByteCursor code;
+            Crt::ByteCursor reason;
+            Crt::String rejection;
+            if (s_findString(message, "o", code))
+            {
+                rejection.append(reinterpret_cast<const char *>(code.ptr), code.len);
+            }
+            if (s_findString(message, "m", reason))
+            {
+                rejection.append(": ").append(reinterpret_cast<const char *>(reason.ptr), reason.len);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_rejection = std::move(rejection);
+            }
+            Finish(AWS_ERROR_INVALID_ARGUMENT);
+        }
+
+        void StreamDownloader::RequestBlocks()
+        {
+            Crt::Vector<uint32_t> toRequest;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_finished)
+                {
+                    return;
+                }
+
+                uint64_t timeout =
+                    aws_timestamp_convert(m_config.BlockTimeoutMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+                uint64_t deadline = Now() + timeout;
+                while (m_inFlight.size() < m_config.MaxBlocksInFlight)
+                {
+                    InFlightBlock request{0, deadline, 0};
+                    if (!m_retryQueue.empty())
+                    {
+                        request.Block = m_retryQueue.front().Block;
+                        request.Retries = m_retryQueue.front().Retries;
+                        m_retryQueue.erase(m_retryQueue.begin());
+                    }
+                    else
+                    {
+                        while (m_nextBlock < m_blockCount && IsReceived(m_nextBlock))
+                        {
+                            ++m_nextBlock;
+                        }
+                        if (m_nextBlock == m_blockCount)
+                        {
+                            break;
+                        }
+                        request.Block = m_nextBlock++;
+                    }
+
+                    if (IsReceived(request.Block))
+                    {
+                        continue;
+                    }
+                    m_inFlight.push_back(request);
+                    toRequest.push_back(request.Block);
+                }
+            }
+
+            for (uint32_t block : toRequest)
+            {
+                if (!PublishRequest(block))
+                {
+                    Finish(Crt::LastErrorOrUnknown());
+                    return;
+                }
+            }
+        }
+
+        bool StreamDownloader::PublishRequest(uint32_t block)
+        {
+            char request[128];
+            int length = snprintf(
+                request,
+                sizeof(request),
+                "{\"c\":\"%s\",\"f\":%" PRId32 ",\"l\":%" PRIu32 ",\"o\":%" PRIu32 ",\"n\":1}",
+                m_clientToken.c_str(),
+                m_file.FileId,
+                m_config.BlockSize,
+                block);
+            if (length <= 0 || static_cast<size_t>(length) >= sizeof(request))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Crt::ByteBuf payload = aws_byte_buf_from_array(request, static_cast<size_t>(length));
+            return m_connection->Publish(m_requestTopic.c_str(), m_config.Qos, false, payload, nullptr) != 0;
+        }
+
+        void StreamDownloader::ScheduleTimeoutCheck()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_finished || m_timeoutCheckScheduled)
+                {
+                    return;
+                }
+                m_timeoutCheckScheduled = true;
+            }
+
+            auto *timeoutTask = Crt::New<TimeoutTask>(m_allocator);
+            if (!timeoutTask)
+            {
+                Finish(AWS_ERROR_OOM);
+                return;
+            }
+
+            timeoutTask->Owner = shared_from_this();
+            timeoutTask->Allocator = m_allocator;
+            aws_task_init(&timeoutTask->Task, s_onTimeoutTask, timeoutTask, "StreamDownloaderTimeout");
+
+            /* Checking twice per timeout keeps a late block's retry within 1.5 timeouts of its request. */
+            uint32_t timeoutMs = m_config.BlockTimeoutMs ? m_config.BlockTimeoutMs : 2;
+            uint64_t period = aws_timestamp_convert(timeoutMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+            aws_event_loop_schedule_task_future(m_eventLoop, &timeoutTask->Task, Now() + period / 2);
+        }
+
+        void StreamDownloader::s_onTimeoutTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *timeoutTask = static_cast<TimeoutTask *>(arg);
+            if (status == AWS_TASK_STATUS_RUN_READY)
+            {
+                auto owner = timeoutTask->Owner.lock();
+                if (owner)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(owner->m_lock);
+                        owner->m_timeoutCheckScheduled = false;
+                    }
+                    owner->CheckTimeouts();
+                    owner->ScheduleTimeoutCheck();
+                }
+            }
+
+            Crt::Delete(timeoutTask, timeoutTask->Allocator);
+        }
+
+        void StreamDownloader::CheckTimeouts()
+        {
+            bool exhausted = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                uint64_t now = Now();
+                for (size_t i = 0; i < m_inFlight.size();)
+                {
+                    InFlightBlock &request = m_inFlight[i];
+                    if (request.DeadlineNs > now)
+                    {
+                        ++i;
+                        continue;
+                    }
+
+                    if (request.Retries >= m_config.MaxBlockRetries)
+                    {
+                        exhausted = true;
+                        break;
+                    }
+                    ++request.Retries;
+                    ++m_stats.BlockRetries;
+                    m_retryQueue.push_back(request);
+                    m_inFlight.erase(m_inFlight.begin() + static_cast<std::ptrdiff_t>(i));
+                }
+            }
+
+            if (exhausted)
+            {
+                Finish(AWS_ERROR_MQTT_TIMEOUT);
+                return;
+            }
+
+            RequestBlocks();
+        }
+
+        void StreamDownloader::Unsubscribe()
+        {
+            m_connection->Unsubscribe(m_dataTopic.c_str(), nullptr);
+            m_connection->Unsubscribe(m_rejectedTopic.c_str(), nullptr);
+        }
+
+        void StreamDownloader::Finish(int errorCode)
+        {
+            OnDownloadComplete onComplete;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_started || m_finished)
+                {
+                    return;
+                }
+
+                m_finished = true;
+                m_stats.ElapsedNs = Now() - m_startNs;
+                m_inFlight.clear();
+                m_retryQueue.clear();
+                onComplete = std::move(m_onComplete);
+            }
+
+            Unsubscribe();
+            if (onComplete)
+            {
+                onComplete(errorCode);
+            }
+        }
+
+    } // namespace Iotjobs
+} // namespace Aws
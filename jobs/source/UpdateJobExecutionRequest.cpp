@@ -4,114 +4,46 @@
  */
 #include <aws/iotjobs/UpdateJobExecutionRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<UpdateJobExecutionRequest, true>;
+            using JobStatusCodec = Aws::Iotdevicecommon::EnumCodec<
+                JobStatus,
+                JobStatusMarshaller::FromString,
+                JobStatusMarshaller::ToString>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<UpdateJobExecutionRequest> s_fields[] = {
+                Fields::Field<int64_t, &UpdateJobExecutionRequest::ExecutionNumber>("executionNumber"),
+                Fields::Field<Aws::Iotdevicecommon::FlatStringMap, &UpdateJobExecutionRequest::StatusDetails>(
+                    "statusDetails"),
+                Fields::Field<bool, &UpdateJobExecutionRequest::IncludeJobExecutionState>("includeJobExecutionState"),
+                Fields::Field<int32_t, &UpdateJobExecutionRequest::ExpectedVersion>("expectedVersion"),
+                Fields::Field<bool, &UpdateJobExecutionRequest::IncludeJobDocument>("includeJobDocument"),
+                Fields::Field<JobStatus, &UpdateJobExecutionRequest::Status, JobStatusCodec>("status"),
+                Fields::Field<int64_t, &UpdateJobExecutionRequest::StepTimeoutInMinutes>("stepTimeoutInMinutes"),
+                Fields::Field<Crt::String, &UpdateJobExecutionRequest::ClientToken>("clientToken"),
+            };
+        } // namespace
 
         void UpdateJobExecutionRequest::LoadFromObject(UpdateJobExecutionRequest &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("executionNumber"))
-            {
-                val.ExecutionNumber = doc.GetInt64("executionNumber");
-            }
-
-            if (doc.ValueExists("statusDetails"))
-            {
-                auto statusDetailsMap = doc.GetJsonObject("statusDetails");
-                val.StatusDetails = Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
-                for (auto &statusDetailsMapMember : statusDetailsMap.GetAllObjects())
-                {
-                    Aws::Crt::String statusDetailsMapValMember;
-                    statusDetailsMapValMember = statusDetailsMapMember.second.AsString();
-                    val.StatusDetails->emplace(statusDetailsMapMember.first, std::move(statusDetailsMapValMember));
-                }
-            }
-
-            if (doc.ValueExists("includeJobExecutionState"))
-            {
-                val.IncludeJobExecutionState = doc.GetBool("includeJobExecutionState");
-            }
-
-            if (doc.ValueExists("expectedVersion"))
-            {
-                val.ExpectedVersion = doc.GetInteger("expectedVersion");
-            }
-
-            if (doc.ValueExists("includeJobDocument"))
-            {
-                val.IncludeJobDocument = doc.GetBool("includeJobDocument");
-            }
-
-            if (doc.ValueExists("status"))
-            {
-                val.Status = JobStatusMarshaller::FromString(doc.GetString("status"));
-            }
-
-            if (doc.ValueExists("stepTimeoutInMinutes"))
-            {
-                val.StepTimeoutInMinutes = doc.GetInt64("stepTimeoutInMinutes");
-            }
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void UpdateJobExecutionRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (ExecutionNumber)
-            {
-                object.WithInt64("executionNumber", *ExecutionNumber);
-            }
-
-            if (StatusDetails)
-            {
-                Aws::Crt::JsonObject statusDetailsMap;
-                for (auto &statusDetailsMapMember : *StatusDetails)
-                {
-                    Aws::Crt::JsonObject statusDetailsMapValMember;
-                    statusDetailsMapValMember.AsString(statusDetailsMapMember.second);
-                    statusDetailsMap.WithObject(statusDetailsMapMember.first, std::move(statusDetailsMapValMember));
-                }
-                object.WithObject("statusDetails", std::move(statusDetailsMap));
-            }
-
-            if (IncludeJobExecutionState)
-            {
-                object.WithBool("includeJobExecutionState", *IncludeJobExecutionState);
-            }
-
-            if (ExpectedVersion)
-            {
-                object.WithInteger("expectedVersion", *ExpectedVersion);
-            }
-
-            if (IncludeJobDocument)
-            {
-                object.WithBool("includeJobDocument", *IncludeJobDocument);
-            }
-
-            if (Status)
-            {
-                object.WithString("status", JobStatusMarshaller::ToString(*Status));
-            }
-
-            if (StepTimeoutInMinutes)
-            {
-                object.WithInt64("stepTimeoutInMinutes", *StepTimeoutInMinutes);
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
+        void UpdateJobExecutionRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         UpdateJobExecutionRequest::UpdateJobExecutionRequest(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
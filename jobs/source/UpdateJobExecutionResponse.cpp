@@ -4,62 +4,34 @@
  */
 #include <aws/iotjobs/UpdateJobExecutionResponse.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotjobs
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<UpdateJobExecutionResponse>;
+            using JobExecutionStateCodec = Aws::Iotdevicecommon::ModelCodec<JobExecutionState>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<UpdateJobExecutionResponse> s_fields[] = {
+                Fields::Field<Crt::String, &UpdateJobExecutionResponse::ClientToken>("clientToken"),
+                Fields::Timestamp<&UpdateJobExecutionResponse::Timestamp>("timestamp"),
+                Fields::Field<Crt::JsonObject, &UpdateJobExecutionResponse::JobDocument>("jobDocument"),
+                Fields::Field<JobExecutionState, &UpdateJobExecutionResponse::ExecutionState, JobExecutionStateCodec>(
+                    "executionState"),
+            };
+        } // namespace
 
         void UpdateJobExecutionResponse::LoadFromObject(UpdateJobExecutionResponse &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
-
-            if (doc.ValueExists("timestamp"))
-            {
-                val.Timestamp = doc.GetDouble("timestamp");
-            }
-
-            if (doc.ValueExists("jobDocument"))
-            {
-                val.JobDocument = doc.GetJsonObjectCopy("jobDocument");
-            }
-
-            if (doc.ValueExists("executionState"))
-            {
-                val.ExecutionState = doc.GetJsonObject("executionState");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void UpdateJobExecutionResponse::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
-
-            if (Timestamp)
-            {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
-            }
-
-            if (JobDocument)
-            {
-                object.WithObject("jobDocument", *JobDocument);
-            }
-
-            if (ExecutionState)
-            {
-                Aws::Crt::JsonObject jsonObject;
-                ExecutionState->SerializeToObject(jsonObject);
-                object.WithObject("executionState", std::move(jsonObject));
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         UpdateJobExecutionResponse::UpdateJobExecutionResponse(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
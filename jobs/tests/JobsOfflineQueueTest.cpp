@@ -0,0 +1,166 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotjobs/IotJobsClient.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <aws/mqtt/mqtt.h>
+
+#include <cstdio>
+
+namespace
+{
+    const char *s_queuePath = "JobsOfflineQueueTest.queue";
+
+    void s_removeQueue()
+    {
+        remove(s_queuePath);
+        remove("JobsOfflineQueueTest.queue.tmp");
+    }
+
+    /*
+     * A jobs client whose execution updates go to the offline queue at s_queuePath. Its connection is never
+     * connected, so nothing is ever drained and everything enqueued stays in the file.
+     */
+    struct OfflineFixture
+    {
+        explicit OfflineFixture(Aws::Crt::Allocator *allocator)
+            : EventLoopGroup(1, allocator), HostResolver(EventLoopGroup, 8, 30, allocator),
+              Bootstrap(EventLoopGroup, HostResolver, allocator), MqttClient(Bootstrap, allocator)
+        {
+            Bootstrap.EnableBlockingShutdown();
+            Connection = MqttClient.NewConnection("localhost", 1883, SocketOptions);
+        }
+
+        /* Opens the queue as a restarted process would, along with a client using it. */
+        bool Open(uint64_t maxQueuedBytes, Aws::Crt::Allocator *allocator)
+        {
+            Client.reset();
+            Aws::Iotdevicecommon::DurablePublishQueueConfig queueConfig;
+            queueConfig.MaxQueuedBytes = maxQueuedBytes;
+            Aws::Iotdevicecommon::ServiceClientConfig config;
+            config.OfflineQueue = Aws::Iotdevicecommon::DurablePublishQueue::Open(s_queuePath, queueConfig, allocator);
+            if (!Connection || !config.OfflineQueue)
+            {
+                return false;
+            }
+            Queue = config.OfflineQueue;
+            Client.emplace(Connection, config, allocator);
+            return true;
+        }
+
+        /* Drops the client and the queue, closing the file. */
+        void Close()
+        {
+            Client.reset();
+            Queue.reset();
+        }
+
+        bool Update(const char *jobId, const char *clientToken)
+        {
+            Aws::Iotjobs::UpdateJobExecutionRequest request;
+            request.ThingName = Aws::Crt::String("TestThing");
+            request.JobId = Aws::Crt::String(jobId);
+            request.Status = Aws::Iotjobs::JobStatus::IN_PROGRESS;
+            request.ClientToken = Aws::Crt::String(clientToken);
+            return Client->PublishUpdateJobExecution(request, AWS_MQTT_QOS_AT_LEAST_ONCE, nullptr);
+        }
+
+        Aws::Crt::Io::EventLoopGroup EventLoopGroup;
+        Aws::Crt::Io::DefaultHostResolver HostResolver;
+        Aws::Crt::Io::ClientBootstrap Bootstrap;
+        Aws::Crt::Io::SocketOptions SocketOptions;
+        Aws::Crt::Mqtt::MqttClient MqttClient;
+        std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> Connection;
+        std::shared_ptr<Aws::Iotdevicecommon::DurablePublishQueue> Queue;
+        Aws::Crt::Optional<Aws::Iotjobs::IotJobsClient> Client;
+    };
+} // namespace
+
+static int s_TestJobsOfflineQueueRecovery(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        s_removeQueue();
+        OfflineFixture fixture(allocator);
+        ASSERT_TRUE(fixture.Open(0, allocator));
+
+        /* Execution updates are never folded together, not even two to the same job. */
+        ASSERT_TRUE(fixture.Update("job1", "token-a"));
+        ASSERT_TRUE(fixture.Update("job1", "token-b"));
+        ASSERT_TRUE(fixture.Update("job2", "token-c"));
+        ASSERT_UINT_EQUALS(3, fixture.Queue->GetQueuedCount());
+        uint64_t queuedBytes = fixture.Queue->GetQueuedBytes();
+
+        /* All of them survive a restart, and the next one queued after it too. */
+        fixture.Close();
+        ASSERT_TRUE(fixture.Open(0, allocator));
+        ASSERT_UINT_EQUALS(3, fixture.Queue->GetQueuedCount());
+        ASSERT_UINT_EQUALS(queuedBytes, fixture.Queue->GetQueuedBytes());
+        ASSERT_TRUE(fixture.Update("job3", "token-d"));
+        fixture.Close();
+        ASSERT_TRUE(fixture.Open(0, allocator));
+        ASSERT_UINT_EQUALS(4, fixture.Queue->GetQueuedCount());
+
+        fixture.Close();
+        s_removeQueue();
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(JobsOfflineQueueRecovery, s_TestJobsOfflineQueueRecovery)
+
+static int s_TestJobsOfflineQueueSizeCap(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        s_removeQueue();
+        OfflineFixture fixture(allocator);
+
+        /* Every update below is the same size as this one. */
+        ASSERT_TRUE(fixture.Open(0, allocator));
+        ASSERT_TRUE(fixture.Update("job1", "token-a"));
+        uint64_t updateBytes = fixture.Queue->GetQueuedBytes();
+        ASSERT_TRUE(updateBytes > 0);
+        fixture.Close();
+        s_removeQueue();
+
+        /* Room for two and a half: the third is refused whole, and leaves the queue as it was. */
+        const uint64_t cap = 2 * updateBytes + updateBytes / 2;
+        ASSERT_TRUE(fixture.Open(cap, allocator));
+        ASSERT_TRUE(fixture.Update("job1", "token-a"));
+        ASSERT_TRUE(fixture.Update("job2", "token-b"));
+        ASSERT_FALSE(fixture.Update("job3", "token-c"));
+        ASSERT_INT_EQUALS(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE, aws_last_error());
+        ASSERT_UINT_EQUALS(2, fixture.Queue->GetQueuedCount());
+        ASSERT_UINT_EQUALS(2 * updateBytes, fixture.Queue->GetQueuedBytes());
+
+        /* The refused update was never written, and the recovered ones still count against the cap. */
+        fixture.Close();
+        ASSERT_TRUE(fixture.Open(cap, allocator));
+        ASSERT_UINT_EQUALS(2, fixture.Queue->GetQueuedCount());
+        ASSERT_UINT_EQUALS(2 * updateBytes, fixture.Queue->GetQueuedBytes());
+        ASSERT_FALSE(fixture.Update("job3", "token-c"));
+        ASSERT_INT_EQUALS(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE, aws_last_error());
+
+        /* A queue without a cap takes everything. */
+        fixture.Close();
+        ASSERT_TRUE(fixture.Open(0, allocator));
+        ASSERT_TRUE(fixture.Update("job3", "token-c"));
+        ASSERT_UINT_EQUALS(3, fixture.Queue->GetQueuedCount());
+
+        fixture.Close();
+        s_removeQueue();
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(JobsOfflineQueueSizeCap, s_TestJobsOfflineQueueSizeCap)
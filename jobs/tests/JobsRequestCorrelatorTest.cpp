@@ -0,0 +1,230 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotdevicecommon/ThingTopicDispatcher.h>
+#include <aws/iotjobs/JobsRequestCorrelator.h>
+#include <aws/iotjobs/RejectedError.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+#include <aws/iotjobs/UpdateJobExecutionResponse.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <aws/mqtt/mqtt.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    const char *s_thingName = "TestThing";
+
+    /*
+     * A correlator on a connection that is never connected: its subscriptions and publishes stay queued
+     * offline, and responses are handed to the thing topic dispatcher as if the broker had sent them.
+     */
+    struct CorrelatorFixture
+    {
+        explicit CorrelatorFixture(Aws::Crt::Allocator *allocator)
+            : EventLoopGroup(1, allocator), HostResolver(EventLoopGroup, 8, 30, allocator),
+              Bootstrap(EventLoopGroup, HostResolver, allocator), MqttClient(Bootstrap, allocator)
+        {
+            Bootstrap.EnableBlockingShutdown();
+            Connection = MqttClient.NewConnection("localhost", 1883, SocketOptions);
+            if (Connection)
+            {
+                Dispatcher = Aws::Iotdevicecommon::ThingTopicDispatcher::Create(Connection, allocator);
+            }
+        }
+
+        bool Init(const Aws::Iotjobs::JobsRequestCorrelatorConfig &config, Aws::Crt::Allocator *allocator)
+        {
+            if (!Dispatcher)
+            {
+                return false;
+            }
+            Aws::Iotjobs::IotJobsClient client(Connection, allocator);
+            Correlator =
+                Aws::Iotjobs::JobsRequestCorrelator::Create(client, EventLoopGroup, s_thingName, config, allocator);
+            return Correlator && Correlator->Subscribe(nullptr);
+        }
+
+        void Respond(const char *outcome, const char *clientToken)
+        {
+            Aws::Crt::String topic("$aws/things/");
+            topic.append(s_thingName).append("/jobs/job1/update/").append(outcome);
+            Aws::Crt::String payload("{\"clientToken\":\"");
+            payload.append(clientToken).append("\",\"timestamp\":1600000000,\"code\":\"VersionMismatch\"}");
+            Dispatcher->Dispatch(
+                *Connection,
+                topic,
+                Aws::Crt::ByteBufFromArray(reinterpret_cast<const uint8_t *>(payload.data()), payload.size()));
+        }
+
+        Aws::Crt::Io::EventLoopGroup EventLoopGroup;
+        Aws::Crt::Io::DefaultHostResolver HostResolver;
+        Aws::Crt::Io::ClientBootstrap Bootstrap;
+        Aws::Crt::Io::SocketOptions SocketOptions;
+        Aws::Crt::Mqtt::MqttClient MqttClient;
+        std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> Connection;
+        std::shared_ptr<Aws::Iotdevicecommon::ThingTopicDispatcher> Dispatcher;
+        std::shared_ptr<Aws::Iotjobs::JobsRequestCorrelator> Correlator;
+    };
+
+    /* What each completion saw, in the order they completed. */
+    struct Completions
+    {
+        using Response = Aws::Iotjobs::UpdateJobExecutionResponse;
+
+        Aws::Iotjobs::OnUpdateJobExecutionComplete Record(const char *name)
+        {
+            Aws::Crt::String label(name);
+            return [this, label](Response *response, Aws::Iotjobs::RejectedError *error, int ioErr) {
+                std::lock_guard<std::mutex> guard(Lock);
+                Aws::Crt::String outcome(label);
+                outcome.append(response ? ":accepted" : error ? ":rejected" : ":failed");
+                Order.push_back(outcome);
+                Errors.push_back(ioErr);
+                Signal.notify_all();
+            };
+        }
+
+        bool WaitFor(size_t count)
+        {
+            std::unique_lock<std::mutex> guard(Lock);
+            return Signal.wait_for(guard, std::chrono::seconds(30), [this, count]() { return Order.size() >= count; });
+        }
+
+        size_t Count()
+        {
+            std::lock_guard<std::mutex> guard(Lock);
+            return Order.size();
+        }
+
+        std::mutex Lock;
+        std::condition_variable Signal;
+        Aws::Crt::Vector<Aws::Crt::String> Order;
+        Aws::Crt::Vector<int> Errors;
+    };
+
+    Aws::Iotjobs::UpdateJobExecutionRequest s_updateRequest(const char *clientToken)
+    {
+        Aws::Iotjobs::UpdateJobExecutionRequest request;
+        request.JobId = Aws::Crt::String("job1");
+        request.Status = Aws::Iotjobs::JobStatus::IN_PROGRESS;
+        request.ClientToken = Aws::Crt::String(clientToken);
+        return request;
+    }
+} // namespace
+
+static int s_TestJobsRequestCorrelatorOrdering(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        CorrelatorFixture fixture(allocator);
+
+        Aws::Iotjobs::JobsRequestCorrelatorConfig config;
+        config.MaxInFlight = 2;
+        config.RequestTimeoutMs = 0;
+        ASSERT_TRUE(fixture.Init(config, allocator));
+
+        Completions completions;
+        ASSERT_TRUE(fixture.Correlator->UpdateJobExecutionAsync(s_updateRequest("a"), completions.Record("a")));
+        ASSERT_TRUE(fixture.Correlator->UpdateJobExecutionAsync(s_updateRequest("b"), completions.Record("b")));
+        ASSERT_TRUE(fixture.Correlator->UpdateJobExecutionAsync(s_updateRequest("c"), completions.Record("c")));
+        ASSERT_UINT_EQUALS(2, fixture.Correlator->GetInFlightCount());
+        ASSERT_UINT_EQUALS(1, fixture.Correlator->GetQueuedCount());
+
+        /* Neither queued nor unknown tokens complete anything. */
+        fixture.Respond("accepted", "c");
+        fixture.Respond("accepted", "unknown");
+        ASSERT_UINT_EQUALS(0, completions.Count());
+
+        /* Responses complete their own request whatever order they arrive in, and free a slot for "c". */
+        fixture.Respond("rejected", "b");
+        ASSERT_UINT_EQUALS(2, fixture.Correlator->GetInFlightCount());
+        ASSERT_UINT_EQUALS(0, fixture.Correlator->GetQueuedCount());
+        fixture.Respond("accepted", "a");
+        fixture.Respond("accepted", "c");
+        fixture.Respond("accepted", "a");
+        ASSERT_TRUE(completions.WaitFor(3));
+
+        ASSERT_UINT_EQUALS(3, completions.Order.size());
+        ASSERT_TRUE(completions.Order[0] == "b:rejected");
+        ASSERT_TRUE(completions.Order[1] == "a:accepted");
+        ASSERT_TRUE(completions.Order[2] == "c:accepted");
+        for (int ioErr : completions.Errors)
+        {
+            ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, ioErr);
+        }
+        ASSERT_UINT_EQUALS(0, fixture.Correlator->GetInFlightCount());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(JobsRequestCorrelatorOrdering, s_TestJobsRequestCorrelatorOrdering)
+
+static int s_TestJobsRequestCorrelatorTimeout(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+
+        /* Once with a task per request, once with the timeouts in a shared wheel. */
+        for (int useWheel = 0; useWheel < 2; ++useWheel)
+        {
+            CorrelatorFixture fixture(allocator);
+
+            Aws::Iotjobs::JobsRequestCorrelatorConfig config;
+            config.MaxInFlight = 1;
+            config.RequestTimeoutMs = 50;
+            if (useWheel)
+            {
+                config.Timers = Aws::Iotdevicecommon::TimerWheel::Create(fixture.EventLoopGroup, 10, allocator);
+                ASSERT_NOT_NULL(config.Timers.get());
+            }
+            ASSERT_TRUE(fixture.Init(config, allocator));
+
+            Completions completions;
+            ASSERT_TRUE(fixture.Correlator->UpdateJobExecutionAsync(s_updateRequest("a"), completions.Record("a")));
+            ASSERT_TRUE(fixture.Correlator->UpdateJobExecutionAsync(s_updateRequest("b"), completions.Record("b")));
+
+            /* "a" times out, which sends "b", the next in line; "b" then times out in turn. */
+            ASSERT_TRUE(completions.WaitFor(2));
+            {
+                std::lock_guard<std::mutex> guard(completions.Lock);
+                ASSERT_TRUE(completions.Order[0] == "a:failed");
+                ASSERT_TRUE(completions.Order[1] == "b:failed");
+                ASSERT_INT_EQUALS(AWS_ERROR_MQTT_TIMEOUT, completions.Errors[0]);
+                ASSERT_INT_EQUALS(AWS_ERROR_MQTT_TIMEOUT, completions.Errors[1]);
+            }
+
+            /* A response arriving after its request timed out completes nothing. */
+            fixture.Respond("accepted", "a");
+            ASSERT_UINT_EQUALS(2, completions.Count());
+            ASSERT_UINT_EQUALS(0, fixture.Correlator->GetInFlightCount());
+            ASSERT_UINT_EQUALS(0, fixture.Correlator->GetQueuedCount());
+
+            /* A response in time cancels the timeout. */
+            ASSERT_TRUE(fixture.Correlator->UpdateJobExecutionAsync(s_updateRequest("c"), completions.Record("c")));
+            fixture.Respond("accepted", "c");
+            ASSERT_TRUE(completions.WaitFor(3));
+            /* Long enough for the cancelled timeout to have fired, had it not been cancelled. */
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            ASSERT_UINT_EQUALS(3, completions.Count());
+            ASSERT_TRUE(completions.Order[2] == "c:accepted");
+            if (config.Timers)
+            {
+                ASSERT_UINT_EQUALS(0, config.Timers->GetTimerCount());
+            }
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(JobsRequestCorrelatorTimeout, s_TestJobsRequestCorrelatorTimeout)
@@ -0,0 +1,622 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/io/HostResolver.h>
+
+#include <aws/iot/MqttClient.h>
+
+#include <aws/iotdevicecommon/MemoryBudget.h>
+#include <aws/iotdevicecommon/PayloadBufferPool.h>
+#include <aws/iotdevicecommon/ServiceClientConfig.h>
+#include <aws/iotdevicecommon/SubscriptionBatch.h>
+#include <aws/iotdevicecommon/ThrottleBreaker.h>
+#include <aws/iotdevicecommon/TrackingAllocator.h>
+
+#include <aws/iotdevicedefender/MultiThingReporter.h>
+
+#include <aws/iotjobs/NextJobExecutionChangedEvent.h>
+#include <aws/iotjobs/NextJobExecutionChangedSubscriptionRequest.h>
+#include <aws/iotjobs/ShardedIotJobsClient.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/ShardedIotShadowClient.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowSubscriptionRequest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <future>
+#include <memory>
+#include <thread>
+
+using namespace Aws::Crt;
+
+static void s_printHelp()
+{
+    fprintf(stdout, "Usage:\n");
+    fprintf(
+        stdout,
+        "device-simulator --endpoint <endpoint> --cert <path to cert> --key <path to key>"
+        " --ca_file <optional: path to custom ca> --thing_name <thing name prefix> --devices <count>"
+        " --connections <count> --threads <count> --duration <seconds> --update_interval <seconds>"
+        " --jobs --defender_every <count> --defender_period <seconds> --max_in_flight <count>"
+        " --report_interval <seconds>\n\n");
+    fprintf(stdout, "endpoint: the endpoint of the mqtt server not including a port\n");
+    fprintf(stdout, "cert: path to your client certificate in PEM format\n");
+    fprintf(stdout, "key: path to your key in PEM format\n");
+    fprintf(
+        stdout,
+        "ca_file: Optional, if the mqtt server uses a certificate that's not already"
+        " in your trust store, set this.\n");
+    fprintf(stdout, "\tIt's the path to a CA file in PEM format\n");
+    fprintf(stdout, "thing_name: prefix of the simulated things, named <thing_name>-i\n");
+    fprintf(stdout, "devices: number of simulated things (optional, default 100)\n");
+    fprintf(stdout, "connections: number of MQTT connections the things share (optional, default 1)\n");
+    fprintf(stdout, "threads: number of event loop threads the connections share (optional, default 1)\n");
+    fprintf(stdout, "duration: seconds to run for (optional, default 60)\n");
+    fprintf(
+        stdout,
+        "update_interval: seconds between each thing's reported shadow updates (optional, default 10;"
+        " 0 disables them)\n");
+    fprintf(stdout, "jobs: have every thing complete the jobs it is sent (optional)\n");
+    fprintf(
+        stdout,
+        "defender_every: report device defender custom metrics for every n-th thing (optional, default 0:"
+        " none)\n");
+    fprintf(stdout, "defender_period: seconds between each thing's defender reports (optional, default 300)\n");
+    fprintf(
+        stdout,
+        "max_in_flight: limit of publishes awaiting their PUBACK over all things; updates over it are"
+        " refused and counted (optional, default 1000)\n");
+    fprintf(stdout, "report_interval: seconds between progress reports (optional, default 10)\n\n");
+}
+
+static bool s_cmdOptionExists(char **begin, char **end, const String &option)
+{
+    return std::find(begin, end, option) != end;
+}
+
+static char *s_getCmdOption(char **begin, char **end, const String &option)
+{
+    char **itr = std::find(begin, end, option);
+    if (itr != end && ++itr != end)
+    {
+        return *itr;
+    }
+    return 0;
+}
+
+static uint64_t s_nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+/*
+ * All a simulated thing keeps for itself. Everything else, from the TLS streams to the subscription
+ * dispatch, is shared, which is what keeps the cost per thing down.
+ */
+struct SimulatedDevice
+{
+    String thingName;
+    std::shared_ptr<Aws::Iotdevicedefenderv1::CustomMetric> updatesSent;
+    int64_t sequence;
+};
+
+struct SimulatorStats
+{
+    std::atomic<uint64_t> updatesSent{0};
+    std::atomic<uint64_t> updatesRefused{0};
+    std::atomic<uint64_t> updatesFailed{0};
+    std::atomic<uint64_t> updatesRejected{0};
+    std::atomic<uint64_t> jobsReceived{0};
+    std::atomic<uint64_t> jobsCompleted{0};
+    std::atomic<uint64_t> jobsFailed{0};
+};
+
+static void s_reportMemory(
+    const char *phase,
+    const Aws::Iotdevicecommon::TrackingAllocator &memory,
+    size_t sinceBytes,
+    size_t count,
+    const char *unit)
+{
+    size_t currentBytes = memory.GetCurrentBytes();
+    size_t addedBytes = currentBytes > sinceBytes ? currentBytes - sinceBytes : 0;
+    fprintf(
+        stdout,
+        "memory %-12s %zu bytes in %zu allocations, peak %zu bytes; %zu bytes per %s\n",
+        phase,
+        currentBytes,
+        memory.GetLiveAllocationCount(),
+        memory.GetPeakBytes(),
+        count ? addedBytes / count : 0,
+        unit);
+}
+
+int main(int argc, char *argv[])
+{
+    /************************ Setup the Lib ****************************/
+    /*
+     * Every allocation the SDK and the CRT make goes through the tracking allocator, so what the simulated
+     * things cost can be read off it at each phase of the setup and while they run.
+     */
+    Aws::Iotdevicecommon::TrackingAllocator memory(aws_default_allocator());
+    Allocator *allocator = memory.GetAllocator();
+    ApiHandle apiHandle(allocator);
+
+    String endpoint;
+    String certificatePath;
+    String keyPath;
+    String caFile;
+    String thingNamePrefix;
+    size_t deviceCount = 100;
+    size_t connectionCount = 1;
+    uint16_t threadCount = 1;
+    uint64_t durationSeconds = 60;
+    uint64_t updateIntervalSeconds = 10;
+    bool runJobs = false;
+    size_t defenderEvery = 0;
+    uint32_t defenderPeriodSeconds = 300;
+    size_t maxInFlight = 1000;
+    uint64_t reportIntervalSeconds = 10;
+
+    /*********************** Parse Arguments ***************************/
+    if (!(s_cmdOptionExists(argv, argv + argc, "--endpoint") && s_cmdOptionExists(argv, argv + argc, "--cert") &&
+          s_cmdOptionExists(argv, argv + argc, "--key") && s_cmdOptionExists(argv, argv + argc, "--thing_name")))
+    {
+        s_printHelp();
+        return 1;
+    }
+
+    endpoint = s_getCmdOption(argv, argv + argc, "--endpoint");
+    certificatePath = s_getCmdOption(argv, argv + argc, "--cert");
+    keyPath = s_getCmdOption(argv, argv + argc, "--key");
+    thingNamePrefix = s_getCmdOption(argv, argv + argc, "--thing_name");
+
+    if (s_cmdOptionExists(argv, argv + argc, "--ca_file"))
+    {
+        caFile = s_getCmdOption(argv, argv + argc, "--ca_file");
+    }
+    if (s_getCmdOption(argv, argv + argc, "--devices"))
+    {
+        deviceCount = static_cast<size_t>(atoi(s_getCmdOption(argv, argv + argc, "--devices")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--connections"))
+    {
+        connectionCount = static_cast<size_t>(atoi(s_getCmdOption(argv, argv + argc, "--connections")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--threads"))
+    {
+        threadCount = static_cast<uint16_t>(atoi(s_getCmdOption(argv, argv + argc, "--threads")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--duration"))
+    {
+        durationSeconds = static_cast<uint64_t>(atoll(s_getCmdOption(argv, argv + argc, "--duration")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--update_interval"))
+    {
+        updateIntervalSeconds = static_cast<uint64_t>(atoll(s_getCmdOption(argv, argv + argc, "--update_interval")));
+    }
+    runJobs = s_cmdOptionExists(argv, argv + argc, "--jobs");
+    if (s_getCmdOption(argv, argv + argc, "--defender_every"))
+    {
+        defenderEvery = static_cast<size_t>(atoi(s_getCmdOption(argv, argv + argc, "--defender_every")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--defender_period"))
+    {
+        defenderPeriodSeconds = static_cast<uint32_t>(atoi(s_getCmdOption(argv, argv + argc, "--defender_period")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--max_in_flight"))
+    {
+        maxInFlight = static_cast<size_t>(atoi(s_getCmdOption(argv, argv + argc, "--max_in_flight")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--report_interval"))
+    {
+        reportIntervalSeconds = static_cast<uint64_t>(atoll(s_getCmdOption(argv, argv + argc, "--report_interval")));
+    }
+
+    if (deviceCount == 0 || connectionCount == 0 || threadCount == 0 || durationSeconds == 0 || maxInFlight == 0 ||
+        reportIntervalSeconds == 0)
+    {
+        fprintf(
+            stdout, "devices, connections, threads, duration, max_in_flight and report_interval must be above zero.\n");
+        s_printHelp();
+        return 1;
+    }
+
+    /********************** Setup the Shared Infrastructure ******************/
+    Io::EventLoopGroup eventLoopGroup(threadCount, allocator);
+    if (!eventLoopGroup)
+    {
+        fprintf(
+            stderr, "Event Loop Group Creation failed with error %s\n", ErrorDebugString(eventLoopGroup.LastError()));
+        exit(-1);
+    }
+
+    Io::DefaultHostResolver hostResolver(eventLoopGroup, 8, 30, allocator);
+    Io::ClientBootstrap bootstrap(eventLoopGroup, hostResolver, allocator);
+
+    if (!bootstrap)
+    {
+        fprintf(stderr, "ClientBootstrap failed with error %s\n", ErrorDebugString(bootstrap.LastError()));
+        exit(-1);
+    }
+
+    auto clientConfigBuilder = Aws::Iot::MqttClientConnectionConfigBuilder(certificatePath.c_str(), keyPath.c_str());
+    clientConfigBuilder.WithEndpoint(endpoint);
+    if (!caFile.empty())
+    {
+        clientConfigBuilder.WithCertificateAuthority(caFile.c_str());
+    }
+    auto clientConfig = clientConfigBuilder.Build();
+
+    if (!clientConfig)
+    {
+        fprintf(
+            stderr,
+            "Client Configuration initialization failed with error %s\n",
+            ErrorDebugString(clientConfig.LastError()));
+        exit(-1);
+    }
+
+    Aws::Iot::MqttClient mqttClient(bootstrap, allocator);
+    if (!mqttClient)
+    {
+        fprintf(stderr, "MQTT Client Creation failed with error %s\n", ErrorDebugString(mqttClient.LastError()));
+        exit(-1);
+    }
+
+    const size_t baselineBytes = memory.GetCurrentBytes();
+    s_reportMemory("baseline", memory, 0, 0, "-");
+
+    /*********************** Connect ***************************/
+    Vector<std::shared_ptr<Mqtt::MqttConnection>> connections;
+    Vector<std::promise<bool>> connectionCompletedPromises(connectionCount);
+    Vector<std::promise<void>> connectionClosedPromises(connectionCount);
+
+    fprintf(stdout, "Connecting %zu connection(s) over %u event loop thread(s)...\n", connectionCount, threadCount);
+    for (size_t i = 0; i < connectionCount; ++i)
+    {
+        auto connection = mqttClient.NewConnection(clientConfig);
+        if (!*connection)
+        {
+            fprintf(
+                stderr, "MQTT Connection Creation failed with error %s\n", ErrorDebugString(connection->LastError()));
+            exit(-1);
+        }
+
+        std::promise<bool> *completed = &connectionCompletedPromises[i];
+        std::promise<void> *closed = &connectionClosedPromises[i];
+        connection->OnConnectionCompleted =
+            [completed](Mqtt::MqttConnection &, int errorCode, Mqtt::ReturnCode returnCode, bool) {
+                if (errorCode)
+                {
+                    fprintf(stdout, "Connection failed with error %s\n", ErrorDebugString(errorCode));
+                }
+                else if (returnCode != AWS_MQTT_CONNECT_ACCEPTED)
+                {
+                    fprintf(stdout, "Connection failed with mqtt return code %d\n", (int)returnCode);
+                }
+                completed->set_value(!errorCode && returnCode == AWS_MQTT_CONNECT_ACCEPTED);
+            };
+        connection->OnDisconnect = [closed](Mqtt::MqttConnection &) { closed->set_value(); };
+
+        String clientId = thingNamePrefix + "-connection-" + std::to_string(i).c_str();
+        if (!connection->Connect(clientId.c_str(), true, 0))
+        {
+            fprintf(stderr, "MQTT Connection failed with error %s\n", ErrorDebugString(connection->LastError()));
+            exit(-1);
+        }
+        connections.push_back(connection);
+    }
+
+    for (std::promise<bool> &completed : connectionCompletedPromises)
+    {
+        if (!completed.get_future().get())
+        {
+            exit(-1);
+        }
+    }
+
+    const size_t connectedBytes = memory.GetCurrentBytes();
+    s_reportMemory("connected", memory, baselineBytes, connectionCount, "connection");
+
+    /*********************** Simulate the Things ***************************/
+    /*
+     * One shadow and one jobs client serve every thing, each spreading the things over the connections,
+     * with pooled payload buffers and reused inbound models so that a thing costs its subscriptions and
+     * little else.
+     */
+    Aws::Iotdevicecommon::ServiceClientConfig serviceConfig;
+    serviceConfig.PayloadBufferPool =
+        MakeShared<Aws::Iotdevicecommon::PayloadBufferPool>(allocator, 256, 4096, allocator);
+    serviceConfig.ReuseInboundModels = true;
+    Aws::Iotdevicecommon::MemoryBudgetConfig budgetConfig;
+    budgetConfig.MaxInFlightPublishes = maxInFlight;
+    serviceConfig.MemoryBudget = Aws::Iotdevicecommon::MemoryBudget::Create(budgetConfig, allocator);
+    serviceConfig.ThrottleBreaker =
+        Aws::Iotdevicecommon::ThrottleBreaker::Create(Aws::Iotdevicecommon::ThrottleBreakerConfig(), allocator);
+    if (!serviceConfig.PayloadBufferPool || !serviceConfig.MemoryBudget || !serviceConfig.ThrottleBreaker)
+    {
+        fprintf(stderr, "Service client setup failed with error %s\n", ErrorDebugString(LastError()));
+        exit(-1);
+    }
+
+    Aws::Iotshadow::ShardedIotShadowClient shadowClient(connections, serviceConfig, allocator);
+    Aws::Iotjobs::ShardedIotJobsClient jobsClient(connections, serviceConfig, allocator);
+    if (!shadowClient || !jobsClient)
+    {
+        fprintf(
+            stderr, "Service client creation failed with error %s\n", ErrorDebugString(shadowClient.GetLastError()));
+        exit(-1);
+    }
+
+    SimulatorStats stats;
+    const Mqtt::QOS qos = AWS_MQTT_QOS_AT_LEAST_ONCE;
+
+    Vector<SimulatedDevice> devices;
+    devices.reserve(deviceCount);
+    for (size_t i = 0; i < deviceCount; ++i)
+    {
+        SimulatedDevice device;
+        device.thingName = thingNamePrefix + "-" + std::to_string(i).c_str();
+        device.updatesSent = MakeShared<Aws::Iotdevicedefenderv1::CustomMetric>(
+            allocator, Aws::Iotdevicedefenderv1::CustomMetric::Kind::Counter);
+        device.sequence = 0;
+        devices.push_back(std::move(device));
+    }
+
+    std::atomic<int> subscribeError{AWS_ERROR_SUCCESS};
+    auto onSubAck = [&subscribeError](int ioErr) {
+        if (ioErr)
+        {
+            subscribeError = ioErr;
+        }
+    };
+
+    /*
+     * Batch the subscriptions of every thing so they go out in as few SUBSCRIBE packets as possible.
+     */
+    Aws::Iotdevicecommon::SubscriptionBatch subscriptions;
+    {
+        Aws::Iotdevicecommon::SubscriptionBatch::Capture capture(subscriptions);
+        for (const SimulatedDevice &device : devices)
+        {
+            if (updateIntervalSeconds > 0)
+            {
+                Aws::Iotshadow::UpdateShadowSubscriptionRequest updateSubscription;
+                updateSubscription.ThingName = device.thingName;
+                shadowClient.SubscribeToUpdateShadowRejected(
+                    updateSubscription,
+                    qos,
+                    [&stats](Aws::Iotshadow::ErrorResponse *error, int ioErr) {
+                        if (error && !ioErr)
+                        {
+                            stats.updatesRejected++;
+                        }
+                    },
+                    onSubAck);
+            }
+
+            if (runJobs)
+            {
+                /* A job is done as soon as it arrives; the thing reports it succeeded. */
+                const String thingName = device.thingName;
+                Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest jobsSubscription;
+                jobsSubscription.ThingName = thingName;
+                jobsClient.SubscribeToNextJobExecutionChangedEvents(
+                    jobsSubscription,
+                    qos,
+                    [&stats, &jobsClient, qos, thingName](
+                        Aws::Iotjobs::NextJobExecutionChangedEvent *event, int ioErr) {
+                        if (!event || ioErr || !event->Execution || !event->Execution->JobId)
+                        {
+                            return;
+                        }
+                        stats.jobsReceived++;
+
+                        Aws::Iotjobs::UpdateJobExecutionRequest request;
+                        request.ThingName = thingName;
+                        request.JobId = *event->Execution->JobId;
+                        request.Status = Aws::Iotjobs::JobStatus::SUCCEEDED;
+                        bool sent = jobsClient.PublishUpdateJobExecution(request, qos, [&stats](int pubErr) {
+                            (pubErr ? stats.jobsFailed : stats.jobsCompleted)++;
+                        });
+                        if (!sent)
+                        {
+                            stats.jobsFailed++;
+                        }
+                    },
+                    onSubAck);
+            }
+        }
+    }
+
+    std::promise<void> subscribeCompletedPromise;
+    subscriptions.Submit([&](int) { subscribeCompletedPromise.set_value(); });
+    subscribeCompletedPromise.get_future().wait();
+    if (subscribeError != AWS_ERROR_SUCCESS)
+    {
+        fprintf(stderr, "Subscribing failed with error %s\n", ErrorDebugString(subscribeError));
+        exit(-1);
+    }
+
+    /*
+     * Defender reports for many things come from one timer per connection rather than a ReportTask each.
+     */
+    Vector<std::shared_ptr<Aws::Iotdevicedefenderv1::MultiThingReporter>> reporters;
+    if (defenderEvery > 0)
+    {
+        for (const auto &connection : connections)
+        {
+            Aws::Iotdevicedefenderv1::MultiThingReporterConfig reporterConfig;
+            reporterConfig.Connection = connection;
+            reporterConfig.EventLoopGroup = &eventLoopGroup;
+            reporterConfig.PeriodSeconds = defenderPeriodSeconds;
+            reporterConfig.PeriodJitter = 0.1;
+            auto reporter = Aws::Iotdevicedefenderv1::MultiThingReporter::Create(reporterConfig, allocator);
+            if (!reporter)
+            {
+                fprintf(stderr, "MultiThingReporter creation failed with error %s\n", ErrorDebugString(LastError()));
+                exit(-1);
+            }
+            reporters.push_back(reporter);
+        }
+
+        for (size_t i = 0; i < devices.size(); i += defenderEvery)
+        {
+            Aws::Iotdevicedefenderv1::CustomMetricList metrics;
+            metrics.emplace_back("updates_sent", devices[i].updatesSent);
+            reporters[i % reporters.size()]->AddThing(devices[i].thingName, metrics);
+        }
+
+        for (const auto &reporter : reporters)
+        {
+            if (reporter->Start() != AWS_OP_SUCCESS)
+            {
+                fprintf(stderr, "MultiThingReporter start failed with error %s\n", ErrorDebugString(LastError()));
+                exit(-1);
+            }
+        }
+    }
+
+    const size_t simulatingBytes = memory.GetCurrentBytes();
+    s_reportMemory("simulating", memory, connectedBytes, deviceCount, "device");
+
+    /*********************** Run ***************************/
+    fprintf(
+        stdout,
+        "Simulating %zu thing(s) for %" PRIu64 " s: shadow updates every %" PRIu64 " s, jobs %s, defender for"
+        " every %zu-th thing...\n",
+        deviceCount,
+        durationSeconds,
+        updateIntervalSeconds,
+        runJobs ? "on" : "off",
+        defenderEvery);
+
+    const uint64_t startNs = s_nowNs();
+    const uint64_t endNs = startNs + durationSeconds * 1000000000ULL;
+    const uint64_t reportIntervalNs = reportIntervalSeconds * 1000000000ULL;
+    /* Each thing updates once per interval; spreading them evenly keeps the broker's load flat. */
+    const uint64_t updateSpacingNs =
+        updateIntervalSeconds > 0 ? updateIntervalSeconds * 1000000000ULL / deviceCount : reportIntervalNs;
+    uint64_t nextUpdateNs = startNs;
+    uint64_t nextReportNs = startNs + reportIntervalNs;
+    size_t nextDevice = 0;
+
+    while (nextUpdateNs < endNs)
+    {
+        uint64_t nowNs = s_nowNs();
+        uint64_t wakeNs = std::min(nextUpdateNs, nextReportNs);
+        if (nowNs < wakeNs)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(wakeNs - nowNs));
+        }
+
+        if (s_nowNs() >= nextReportNs)
+        {
+            nextReportNs += reportIntervalNs;
+            s_reportMemory("steady", memory, connectedBytes, deviceCount, "device");
+            fprintf(
+                stdout,
+                "updates sent %" PRIu64 ", refused %" PRIu64 ", failed %" PRIu64 ", rejected %" PRIu64
+                "; jobs received %" PRIu64 ", completed %" PRIu64 ", failed %" PRIu64 "\n",
+                stats.updatesSent.load(),
+                stats.updatesRefused.load(),
+                stats.updatesFailed.load(),
+                stats.updatesRejected.load(),
+                stats.jobsReceived.load(),
+                stats.jobsCompleted.load(),
+                stats.jobsFailed.load());
+        }
+
+        if (updateIntervalSeconds == 0 || s_nowNs() < nextUpdateNs)
+        {
+            nextUpdateNs = updateIntervalSeconds == 0 ? nextReportNs : nextUpdateNs;
+            continue;
+        }
+        nextUpdateNs += updateSpacingNs;
+
+        SimulatedDevice &device = devices[nextDevice];
+        nextDevice = (nextDevice + 1) % devices.size();
+        ++device.sequence;
+
+        JsonObject reported;
+        reported.WithInt64("seq", device.sequence);
+        reported.WithInt64("temperature", 20 + device.sequence % 10);
+        Aws::Iotshadow::ShadowState shadowState;
+        shadowState.Reported = reported;
+        Aws::Iotshadow::UpdateShadowRequest request;
+        request.ThingName = device.thingName;
+        request.State = shadowState;
+
+        bool sent = shadowClient.PublishUpdateShadow(request, qos, [&stats](int ioErr) {
+            if (ioErr)
+            {
+                stats.updatesFailed++;
+            }
+        });
+        if (sent)
+        {
+            stats.updatesSent++;
+            device.updatesSent->Add(1);
+        }
+        else
+        {
+            /* Refused up front by the memory budget or the throttle breaker, rather than failed in flight. */
+            stats.updatesRefused++;
+        }
+    }
+
+    /*********************** Report ***************************/
+    for (int i = 0; i < 50 && serviceConfig.MemoryBudget->GetCounters().InFlightPublishes > 0; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    double elapsedSeconds = static_cast<double>(s_nowNs() - startNs) / 1e9;
+    fprintf(stdout, "things:      %zu over %zu connection(s)\n", deviceCount, connectionCount);
+    fprintf(
+        stdout,
+        "updates:     sent %" PRIu64 " (%.1f/s), refused %" PRIu64 ", failed %" PRIu64 ", rejected %" PRIu64 "\n",
+        stats.updatesSent.load(),
+        stats.updatesSent.load() / elapsedSeconds,
+        stats.updatesRefused.load(),
+        stats.updatesFailed.load(),
+        stats.updatesRejected.load());
+    fprintf(
+        stdout,
+        "jobs:        received %" PRIu64 ", completed %" PRIu64 ", failed %" PRIu64 "\n",
+        stats.jobsReceived.load(),
+        stats.jobsCompleted.load(),
+        stats.jobsFailed.load());
+    fprintf(
+        stdout,
+        "setup:       %zu bytes per connection, %zu bytes per device\n",
+        (connectedBytes - baselineBytes) / connectionCount,
+        simulatingBytes > connectedBytes ? (simulatingBytes - connectedBytes) / deviceCount : 0);
+    s_reportMemory("final", memory, connectedBytes, deviceCount, "device");
+
+    for (const auto &reporter : reporters)
+    {
+        reporter->Stop();
+    }
+
+    /* Disconnect */
+    for (size_t i = 0; i < connections.size(); ++i)
+    {
+        if (connections[i]->Disconnect())
+        {
+            connectionClosedPromises[i].get_future().wait();
+        }
+    }
+    return 0;
+}
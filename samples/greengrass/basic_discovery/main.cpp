@@ -5,7 +5,9 @@
 #include <aws/crt/Api.h>
 #include <aws/crt/io/HostResolver.h>
 
+#include <aws/discovery/ConnectivityRacer.h>
 #include <aws/discovery/DiscoveryClient.h>
+#include <aws/discovery/GroupTlsContextCache.h>
 
 #include <aws/iot/MqttClient.h>
 
@@ -193,47 +195,74 @@ int main(int argc, char *argv[])
     std::promise<void> connectionFinishedPromise;
     std::promise<void> shutdownCompletedPromise;
 
+    std::shared_ptr<ConnectivityRacer> connectivityRacer(nullptr);
+
+    GroupTlsContextCacheConfig groupTlsConfig;
+    groupTlsConfig.CertificatePath = certificatePath;
+    groupTlsConfig.PrivateKeyPath = keyPath;
+    auto groupTlsContexts = GroupTlsContextCache::Create(groupTlsConfig);
+
     discoveryClient->Discover(thingName, [&](DiscoverResponse *response, int error, int httpResponseCode) {
         if (!error && response->GGGroups)
         {
             auto groupToUse = std::move(response->GGGroups->at(0));
 
-            auto connectivityInfo = groupToUse.Cores->at(0).Connectivity->at(0);
+            /* Every address of every core in the group is probed at once, and the first to answer is used. */
+            Vector<ConnectivityInfo> candidates;
+            for (const auto &core : *groupToUse.Cores)
+            {
+                candidates.insert(candidates.end(), core.Connectivity->begin(), core.Connectivity->end());
+            }
 
             fprintf(
                 stdout,
-                "Connecting to group %s with thing arn %s, using endpoint %s:%d\n",
+                "Connecting to group %s with thing arn %s, racing %d endpoints\n",
                 groupToUse.GGGroupId->c_str(),
                 groupToUse.Cores->at(0).ThingArn->c_str(),
-                connectivityInfo.HostAddress->c_str(),
-                (int)connectivityInfo.Port.value());
-
-            connection = mqttClient.NewConnection(
-                Aws::Iot::MqttClientConnectionConfigBuilder(certificatePath.c_str(), keyPath.c_str())
-                    .WithCertificateAuthority(ByteCursorFromCString(groupToUse.CAs->at(0).c_str()))
-                    .WithPortOverride(connectivityInfo.Port.value())
-                    .WithEndpoint(connectivityInfo.HostAddress.value())
-                    .Build());
-
-            if (!connection)
+                (int)candidates.size());
+
+            ConnectivityRacerConfig racerConfig;
+            racerConfig.Bootstrap = &bootstrap;
+            racerConfig.SocketOptions = socketOptions;
+            racerConfig.MqttClient = &mqttClient;
+            racerConfig.ClientId = thingName;
+
+            /*
+             * One context, trusting the group CAs, serves the probes and the MQTT connection to the winner. The
+             * cache hands back the same context whenever the group is connected to again.
+             */
+            Io::TlsContext groupTlsCtx;
+            if (!groupTlsContexts || !groupTlsContexts->GetContext(*groupToUse.CAs, groupTlsCtx))
             {
-                fprintf(stderr, "Connection setup failed with error %s", ErrorDebugString(mqttClient.LastError()));
+                fprintf(
+                    stderr,
+                    "Group Tls Context creation failed with error %s\n",
+                    ErrorDebugString(LastErrorOrUnknown()));
                 exit(-1);
             }
+            racerConfig.TlsContext = groupTlsCtx;
+
+            connectivityRacer = ConnectivityRacer::Create(racerConfig);
+            auto onRaceComplete = [&, groupToUse](
+                                      const std::shared_ptr<Mqtt::MqttConnection> &conn,
+                                      const ConnectivityInfo *connectivityInfo,
+                                      int errorCode,
+                                      Mqtt::ReturnCode returnCode) {
+                if (!conn)
+                {
+                    fprintf(stderr, "Connection setup failed with error %s\n", aws_error_debug_str(errorCode));
+                    exit(-1);
+                }
 
-            connection->OnConnectionCompleted = [&, connectivityInfo, groupToUse](
-                                                    Mqtt::MqttConnection &conn,
-                                                    int errorCode,
-                                                    Mqtt::ReturnCode /*returnCode*/,
-                                                    bool /*sessionPresent*/) {
-                if (!errorCode)
+                connection = conn;
+                if (!errorCode && returnCode == AWS_MQTT_CONNECT_ACCEPTED)
                 {
                     fprintf(
                         stdout,
                         "Connected to group %s, using connection to %s:%d\n",
                         groupToUse.GGGroupId->c_str(),
-                        connectivityInfo.HostAddress->c_str(),
-                        (int)connectivityInfo.Port.value());
+                        connectivityInfo->HostAddress->c_str(),
+                        (int)connectivityInfo->Port.value());
 
                     if (mode == "both" || mode == "subscribe")
                     {
@@ -270,7 +299,7 @@ int main(int argc, char *argv[])
                             }
                         };
 
-                        conn.Subscribe(topic.c_str(), AWS_MQTT_QOS_AT_MOST_ONCE, onMessage, onSubAck);
+                        conn->Subscribe(topic.c_str(), AWS_MQTT_QOS_AT_MOST_ONCE, onMessage, onSubAck);
                     }
                     else
                     {
@@ -283,27 +312,27 @@ int main(int argc, char *argv[])
                         stderr,
                         "Error connecting to group %s, using connection to %s:%d\n",
                         groupToUse.GGGroupId->c_str(),
-                        connectivityInfo.HostAddress->c_str(),
-                        (int)connectivityInfo.Port.value());
+                        connectivityInfo->HostAddress->c_str(),
+                        (int)connectivityInfo->Port.value());
                     fprintf(stderr, "Error: %s\n", aws_error_debug_str(errorCode));
                     exit(-1);
                 }
-            };
 
-            connection->OnConnectionInterrupted = [](Mqtt::MqttConnection &, int errorCode) {
-                fprintf(stderr, "Connection interrupted with error %s\n", aws_error_debug_str(errorCode));
-            };
+                conn->OnConnectionInterrupted = [](Mqtt::MqttConnection &, int errorCode) {
+                    fprintf(stderr, "Connection interrupted with error %s\n", aws_error_debug_str(errorCode));
+                };
 
-            connection->OnConnectionResumed = [](Mqtt::MqttConnection & /*connection*/,
-                                                 Mqtt::ReturnCode /*connectCode*/,
-                                                 bool /*sessionPresent*/) { fprintf(stdout, "Connection resumed\n"); };
+                conn->OnConnectionResumed = [](Mqtt::MqttConnection & /*connection*/,
+                                               Mqtt::ReturnCode /*connectCode*/,
+                                               bool /*sessionPresent*/) { fprintf(stdout, "Connection resumed\n"); };
 
-            connection->OnDisconnect = [&](Mqtt::MqttConnection & /*connection*/) {
-                fprintf(stdout, "Connection disconnected. Shutting Down.....\n");
-                shutdownCompletedPromise.set_value();
+                conn->OnDisconnect = [&](Mqtt::MqttConnection & /*connection*/) {
+                    fprintf(stdout, "Connection disconnected. Shutting Down.....\n");
+                    shutdownCompletedPromise.set_value();
+                };
             };
 
-            if (!connection->Connect(thingName.c_str(), false))
+            if (!connectivityRacer->Race(candidates, onRaceComplete))
             {
                 fprintf(stderr, "Connect failed with error %s\n", aws_error_debug_str(aws_last_error()));
                 exit(-1);
@@ -0,0 +1,383 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/UUID.h>
+#include <aws/crt/io/HostResolver.h>
+
+#include <aws/iot/MqttClient.h>
+
+#include <aws/iotidentity/ErrorResponse.h>
+#include <aws/iotidentity/IotIdentityClient.h>
+#include <aws/iotidentity/ProvisioningPipeline.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <mutex>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotidentity;
+
+static void s_printHelp()
+{
+    fprintf(stdout, "Usage:\n");
+    fprintf(
+        stdout,
+        "provisioning-benchmark --endpoint <endpoint> --cert <path to claim cert> --key <path to claim key>"
+        " --ca_file <optional: path to custom ca> --template_name <template name> --csr <path to csr>"
+        " --template_parameters <optional: template parameters json> --devices <count>"
+        " --max_in_flight <count> --serial_prefix <prefix>\n\n");
+    fprintf(stdout, "endpoint: the endpoint of the mqtt server not including a port\n");
+    fprintf(stdout, "cert: path to your claim certificate in PEM format\n");
+    fprintf(stdout, "key: path to your claim key in PEM format\n");
+    fprintf(
+        stdout,
+        "ca_file: Optional, if the mqtt server uses a certificate that's not already"
+        " in your trust store, set this.\n");
+    fprintf(stdout, "\tIt's the path to a CA file in PEM format\n");
+    fprintf(stdout, "template_name: the fleet provisioning template devices are registered with\n");
+    fprintf(stdout, "csr: path to the CSR in PEM format, signed once per device\n");
+    fprintf(
+        stdout,
+        "template_parameters: parameters passed to RegisterThing for every device; SerialNumber is set per"
+        " device (optional)\n");
+    fprintf(stdout, "devices: number of devices to provision (optional, default 100)\n");
+    fprintf(stdout, "max_in_flight: devices being provisioned at once (optional, default 8)\n");
+    fprintf(
+        stdout,
+        "serial_prefix: device i is registered with SerialNumber <serial_prefix>-i (optional, default"
+        " provisioning-benchmark)\n\n");
+}
+
+static bool s_cmdOptionExists(char **begin, char **end, const String &option)
+{
+    return std::find(begin, end, option) != end;
+}
+
+static char *s_getCmdOption(char **begin, char **end, const String &option)
+{
+    char **itr = std::find(begin, end, option);
+    if (itr != end && ++itr != end)
+    {
+        return *itr;
+    }
+    return 0;
+}
+
+static std::string s_getFileData(std::string const &fileName)
+{
+    std::ifstream ifs(fileName);
+    std::string str;
+    getline(ifs, str, (char)ifs.eof());
+    return str;
+}
+
+static uint64_t s_nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+static double s_percentileMs(const Vector<uint64_t> &sortedNs, double percentile)
+{
+    if (sortedNs.empty())
+    {
+        return 0.0;
+    }
+    /* nearest rank */
+    size_t rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(sortedNs.size())));
+    size_t index = rank ? rank - 1 : 0;
+    return static_cast<double>(sortedNs[std::min(index, sortedNs.size() - 1)]) / 1e6;
+}
+
+static void s_reportStage(const char *name, const ProvisioningStageStats &stage)
+{
+    fprintf(
+        stdout,
+        "%-20s %" PRIu64 " responses, mean %.2f ms, max %.2f ms\n",
+        name,
+        stage.Count,
+        stage.Count ? static_cast<double>(stage.TotalNs) / static_cast<double>(stage.Count) / 1e6 : 0.0,
+        static_cast<double>(stage.MaxNs) / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+    /************************ Setup the Lib ****************************/
+    /*
+     * Do the global initialization for the API.
+     */
+    ApiHandle apiHandle;
+
+    String endpoint;
+    String certificatePath;
+    String keyPath;
+    String caFile;
+    String templateName;
+    String templateParameters;
+    String csr;
+    String serialPrefix("provisioning-benchmark");
+    String clientId(String("test-") + Aws::Crt::UUID().ToString());
+    size_t deviceCount = 100;
+    size_t maxInFlight = 8;
+
+    /*********************** Parse Arguments ***************************/
+    if (!(s_cmdOptionExists(argv, argv + argc, "--endpoint") && s_cmdOptionExists(argv, argv + argc, "--cert") &&
+          s_cmdOptionExists(argv, argv + argc, "--key") && s_cmdOptionExists(argv, argv + argc, "--template_name") &&
+          s_cmdOptionExists(argv, argv + argc, "--csr")))
+    {
+        s_printHelp();
+        return 1;
+    }
+
+    endpoint = s_getCmdOption(argv, argv + argc, "--endpoint");
+    certificatePath = s_getCmdOption(argv, argv + argc, "--cert");
+    keyPath = s_getCmdOption(argv, argv + argc, "--key");
+    templateName = s_getCmdOption(argv, argv + argc, "--template_name");
+    csr = s_getFileData(s_getCmdOption(argv, argv + argc, "--csr")).c_str();
+
+    if (s_cmdOptionExists(argv, argv + argc, "--ca_file"))
+    {
+        caFile = s_getCmdOption(argv, argv + argc, "--ca_file");
+    }
+    if (s_getCmdOption(argv, argv + argc, "--template_parameters"))
+    {
+        templateParameters = s_getCmdOption(argv, argv + argc, "--template_parameters");
+    }
+    if (s_getCmdOption(argv, argv + argc, "--devices"))
+    {
+        deviceCount = static_cast<size_t>(atoi(s_getCmdOption(argv, argv + argc, "--devices")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--max_in_flight"))
+    {
+        maxInFlight = static_cast<size_t>(atoi(s_getCmdOption(argv, argv + argc, "--max_in_flight")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--serial_prefix"))
+    {
+        serialPrefix = s_getCmdOption(argv, argv + argc, "--serial_prefix");
+    }
+
+    if (deviceCount == 0 || maxInFlight == 0 || csr.empty())
+    {
+        fprintf(stdout, "devices and max_in_flight must be greater than zero, and the CSR must not be empty.\n");
+        s_printHelp();
+        return 1;
+    }
+
+    Map<String, String> parameters;
+    if (!templateParameters.empty())
+    {
+        JsonObject value(templateParameters);
+        if (!value.WasParseSuccessful())
+        {
+            fprintf(stdout, "template_parameters is not valid JSON.\n");
+            return 1;
+        }
+        for (const auto &parameter : value.View().GetAllObjects())
+        {
+            parameters.emplace(parameter.first, parameter.second.AsString());
+        }
+    }
+
+    /********************** Now Setup an Mqtt Client ******************/
+    Io::EventLoopGroup eventLoopGroup(1);
+    if (!eventLoopGroup)
+    {
+        fprintf(
+            stderr, "Event Loop Group Creation failed with error %s\n", ErrorDebugString(eventLoopGroup.LastError()));
+        exit(-1);
+    }
+
+    Io::DefaultHostResolver hostResolver(eventLoopGroup, 2, 30);
+    Io::ClientBootstrap bootstrap(eventLoopGroup, hostResolver);
+
+    if (!bootstrap)
+    {
+        fprintf(stderr, "ClientBootstrap failed with error %s\n", ErrorDebugString(bootstrap.LastError()));
+        exit(-1);
+    }
+
+    auto clientConfigBuilder = Aws::Iot::MqttClientConnectionConfigBuilder(certificatePath.c_str(), keyPath.c_str());
+    clientConfigBuilder.WithEndpoint(endpoint);
+    if (!caFile.empty())
+    {
+        clientConfigBuilder.WithCertificateAuthority(caFile.c_str());
+    }
+    auto clientConfig = clientConfigBuilder.Build();
+
+    if (!clientConfig)
+    {
+        fprintf(
+            stderr,
+            "Client Configuration initialization failed with error %s\n",
+            ErrorDebugString(clientConfig.LastError()));
+        exit(-1);
+    }
+
+    Aws::Iot::MqttClient mqttClient(bootstrap);
+    if (!mqttClient)
+    {
+        fprintf(stderr, "MQTT Client Creation failed with error %s\n", ErrorDebugString(mqttClient.LastError()));
+        exit(-1);
+    }
+
+    auto connection = mqttClient.NewConnection(clientConfig);
+    if (!*connection)
+    {
+        fprintf(stderr, "MQTT Connection Creation failed with error %s\n", ErrorDebugString(connection->LastError()));
+        exit(-1);
+    }
+
+    std::promise<bool> connectionCompletedPromise;
+    std::promise<void> connectionClosedPromise;
+
+    connection->OnConnectionCompleted = [&](Mqtt::MqttConnection &, int errorCode, Mqtt::ReturnCode returnCode, bool) {
+        if (errorCode)
+        {
+            fprintf(stdout, "Connection failed with error %s\n", ErrorDebugString(errorCode));
+        }
+        else if (returnCode != AWS_MQTT_CONNECT_ACCEPTED)
+        {
+            fprintf(stdout, "Connection failed with mqtt return code %d\n", (int)returnCode);
+        }
+        connectionCompletedPromise.set_value(!errorCode && returnCode == AWS_MQTT_CONNECT_ACCEPTED);
+    };
+    connection->OnDisconnect = [&](Mqtt::MqttConnection &) { connectionClosedPromise.set_value(); };
+
+    fprintf(stdout, "Connecting...\n");
+    if (!connection->Connect(clientId.c_str(), true, 0))
+    {
+        fprintf(stderr, "MQTT Connection failed with error %s\n", ErrorDebugString(connection->LastError()));
+        exit(-1);
+    }
+
+    if (!connectionCompletedPromise.get_future().get())
+    {
+        exit(-1);
+    }
+
+    /*********************** Subscribe ***************************/
+    /*
+     * Provisioning responses carry no request identifier, so nothing else on this connection may issue
+     * provisioning requests while the pipeline runs.
+     */
+    IotIdentityClient identityClient(connection);
+    ProvisioningPipelineConfig pipelineConfig;
+    pipelineConfig.TemplateName = templateName;
+    pipelineConfig.MaxInFlight = maxInFlight;
+    auto pipeline = ProvisioningPipeline::Create(identityClient, eventLoopGroup, pipelineConfig);
+
+    std::promise<int> subscribedPromise;
+    if (!pipeline || !pipeline->Subscribe([&subscribedPromise](int ioErr) { subscribedPromise.set_value(ioErr); }))
+    {
+        fprintf(stderr, "ProvisioningPipeline setup failed with error %s\n", ErrorDebugString(LastError()));
+        exit(-1);
+    }
+    int subscribeError = subscribedPromise.get_future().get();
+    if (subscribeError != AWS_ERROR_SUCCESS)
+    {
+        fprintf(stderr, "Subscribing failed with error %s\n", ErrorDebugString(subscribeError));
+        exit(-1);
+    }
+
+    /*********************** Generate Load ***************************/
+    fprintf(
+        stdout,
+        "Provisioning %zu device(s) with template %s, %zu at a time...\n",
+        deviceCount,
+        templateName.c_str(),
+        maxInFlight);
+
+    std::mutex resultLock;
+    Vector<uint64_t> latenciesNs;
+    size_t completed = 0;
+    size_t rejected = 0;
+    size_t failed = 0;
+    std::promise<void> allCompletedPromise;
+
+    /* Every device is queued up front; the pipeline keeps max_in_flight of them going. */
+    const uint64_t startNs = s_nowNs();
+    for (size_t i = 0; i < deviceCount; ++i)
+    {
+        ProvisioningRequest request;
+        request.CertificateSigningRequest = csr;
+        request.Parameters = parameters;
+        request.Parameters["SerialNumber"] = serialPrefix + "-" + std::to_string(i).c_str();
+
+        uint64_t queuedNs = s_nowNs();
+        auto onComplete = [&, queuedNs](ProvisioningResult *result, ErrorResponse *error, int) {
+            std::lock_guard<std::mutex> lock(resultLock);
+            if (result)
+            {
+                latenciesNs.push_back(s_nowNs() - queuedNs);
+            }
+            else if (error)
+            {
+                if (rejected++ == 0)
+                {
+                    fprintf(
+                        stdout,
+                        "First rejection: %d %s\n",
+                        error->StatusCode ? *error->StatusCode : 0,
+                        error->ErrorMessage ? error->ErrorMessage->c_str() : "");
+                }
+            }
+            else
+            {
+                failed++;
+            }
+            if (++completed == deviceCount)
+            {
+                allCompletedPromise.set_value();
+            }
+        };
+        if (!pipeline->Provision(request, onComplete))
+        {
+            std::lock_guard<std::mutex> lock(resultLock);
+            failed++;
+            if (++completed == deviceCount)
+            {
+                allCompletedPromise.set_value();
+            }
+        }
+    }
+    allCompletedPromise.get_future().wait();
+    const uint64_t endNs = s_nowNs();
+
+    /*********************** Report ***************************/
+    double elapsedSeconds = static_cast<double>(endNs - startNs) / 1e9;
+    ProvisioningStats stats = pipeline->GetStats();
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+
+    fprintf(
+        stdout,
+        "devices:             %zu provisioned in %.1f s (%.1f/min), %zu rejected, %zu failed\n",
+        latenciesNs.size(),
+        elapsedSeconds,
+        static_cast<double>(latenciesNs.size()) * 60.0 / elapsedSeconds,
+        rejected,
+        failed);
+    fprintf(
+        stdout,
+        "per device:          p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms (including time queued)\n",
+        s_percentileMs(latenciesNs, 0.50),
+        s_percentileMs(latenciesNs, 0.90),
+        s_percentileMs(latenciesNs, 0.99),
+        latenciesNs.empty() ? 0.0 : static_cast<double>(latenciesNs.back()) / 1e6);
+    s_reportStage("CreateCertificate:", stats.CreateCertificate);
+    s_reportStage("RegisterThing:", stats.RegisterThing);
+
+    /* Disconnect */
+    if (connection->Disconnect())
+    {
+        connectionClosedPromise.get_future().wait();
+    }
+    return 0;
+}
@@ -8,6 +8,8 @@
 
 #include <aws/iot/MqttClient.h>
 
+#include <aws/iotdevicecommon/ServiceBootstrap.h>
+
 #include <aws/iotjobs/DescribeJobExecutionRequest.h>
 #include <aws/iotjobs/DescribeJobExecutionResponse.h>
 #include <aws/iotjobs/DescribeJobExecutionSubscriptionRequest.h>
@@ -215,13 +217,6 @@ int main(int argc, char *argv[])
         describeJobExecutionSubscriptionRequest.ThingName = thingName;
         describeJobExecutionSubscriptionRequest.JobId = jobId;
 
-        // This isn't absolutely necessary but since we're doing a publish almost immediately afterwards,
-        // to be cautious make sure the subscribe has finished before doing the publish.
-        std::promise<void> subAckedPromise;
-        auto subAckHandler = [&](int) {
-            /* if error code returns it will be recorded by the other callback */
-            subAckedPromise.set_value();
-        };
         auto subscriptionHandler = [&](DescribeJobExecutionResponse *response, int ioErr) {
             if (ioErr)
             {
@@ -235,11 +230,6 @@ int main(int argc, char *argv[])
             fprintf(stdout, "Execution Status: %s\n", JobStatusMarshaller::ToString(*response->Execution->Status));
         };
 
-        client.SubscribeToDescribeJobExecutionAccepted(
-            describeJobExecutionSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, subscriptionHandler, subAckHandler);
-        subAckedPromise.get_future().wait();
-
-        subAckedPromise = std::promise<void>();
         auto failureHandler = [&](RejectedError *rejectedError, int ioErr) {
             if (ioErr)
             {
@@ -254,29 +244,55 @@ int main(int argc, char *argv[])
             }
         };
 
-        client.SubscribeToDescribeJobExecutionRejected(
-            describeJobExecutionSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
-        subAckedPromise.get_future().wait();
-
-        DescribeJobExecutionRequest describeJobExecutionRequest;
-        describeJobExecutionRequest.ThingName = thingName;
-        describeJobExecutionRequest.JobId = jobId;
-        describeJobExecutionRequest.IncludeJobDocument = true;
-        Aws::Crt::UUID uuid;
-        describeJobExecutionRequest.ClientToken = uuid.ToString();
-        std::promise<void> publishDescribeJobExeCompletedPromise;
-
-        auto publishHandler = [&](int ioErr) {
-            if (ioErr)
+        /*
+         * Both subscriptions go out at once, and the describe request as soon as both are acknowledged, so
+         * its response cannot arrive before there is a subscription to receive it.
+         */
+        using Aws::Iotdevicecommon::ServiceBootstrap;
+        auto bootstrap = ServiceBootstrap::Create();
+        size_t accepted =
+            bootstrap->AddStep("describe accepted", [&](const ServiceBootstrap::OnStepComplete &onComplete) {
+                return client.SubscribeToDescribeJobExecutionAccepted(
+                    describeJobExecutionSubscriptionRequest,
+                    AWS_MQTT_QOS_AT_LEAST_ONCE,
+                    subscriptionHandler,
+                    onComplete);
+            });
+        size_t rejected =
+            bootstrap->AddStep("describe rejected", [&](const ServiceBootstrap::OnStepComplete &onComplete) {
+                return client.SubscribeToDescribeJobExecutionRejected(
+                    describeJobExecutionSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, onComplete);
+            });
+        bootstrap->AddStep(
+            "describe",
+            [&](const ServiceBootstrap::OnStepComplete &onComplete) {
+                DescribeJobExecutionRequest describeJobExecutionRequest;
+                describeJobExecutionRequest.ThingName = thingName;
+                describeJobExecutionRequest.JobId = jobId;
+                describeJobExecutionRequest.IncludeJobDocument = true;
+                Aws::Crt::UUID uuid;
+                describeJobExecutionRequest.ClientToken = uuid.ToString();
+                return client.PublishDescribeJobExecution(
+                    std::move(describeJobExecutionRequest), AWS_MQTT_QOS_AT_LEAST_ONCE, onComplete);
+            },
+            {accepted, rejected});
+
+        std::promise<void> readyPromise;
+        bootstrap->Start([&](const Aws::Iotdevicecommon::BootstrapReport &report) {
+            for (const Aws::Iotdevicecommon::BootstrapStep &step : report.Steps)
             {
-                fprintf(stderr, "Error %d occurred\n", ioErr);
+                fprintf(
+                    stdout,
+                    "%s: %s after %.1f ms, took %.1f ms\n",
+                    step.Name,
+                    step.ErrorCode ? ErrorDebugString(step.ErrorCode) : "done",
+                    step.StartNs / 1e6,
+                    step.DurationNs / 1e6);
             }
-            publishDescribeJobExeCompletedPromise.set_value();
-        };
-
-        client.PublishDescribeJobExecution(
-            std::move(describeJobExecutionRequest), AWS_MQTT_QOS_AT_LEAST_ONCE, publishHandler);
-        publishDescribeJobExeCompletedPromise.get_future().wait();
+            fprintf(stdout, "Ready in %.1f ms\n", report.DurationNs / 1e6);
+            readyPromise.set_value();
+        });
+        readyPromise.get_future().wait();
     }
 
     /* Disconnect */
@@ -6,12 +6,15 @@
 #include <aws/crt/StlAllocator.h>
 #include <aws/crt/auth/Credentials.h>
 #include <aws/crt/io/TlsOptions.h>
+#include <aws/discovery/EndpointSelector.h>
+#include <aws/iotdevicecommon/CredentialsCache.h>
 
 #include <aws/iot/MqttClient.h>
 
 #include <algorithm>
 #include <aws/crt/UUID.h>
 #include <condition_variable>
+#include <future>
 #include <iostream>
 #include <mutex>
 
@@ -26,8 +29,13 @@ static void s_printHelp()
         " --key <path to key> --topic <topic> --ca_file <optional: path to custom ca>"
         " --use_websocket --signing_region <region> --proxy_host <host> --proxy_port <port>"
         " --x509 --x509_role_alias <role_alias> --x509_endpoint <endpoint> --x509_thing <thing_name>"
-        " --x509_cert <path to cert> --x509_key <path to key> --x509_rootca <path to root ca>\n\n");
+        " --x509_cert <path to cert> --x509_key <path to key> --x509_rootca <path to root ca>"
+        " --alternate_endpoints <endpoint,endpoint,...>\n\n");
     fprintf(stdout, "endpoint: the endpoint of the mqtt server not including a port\n");
+    fprintf(
+        stdout,
+        "alternate_endpoints: comma separated endpoints to choose from along with endpoint, by connect latency"
+        " (optional)\n");
     fprintf(
         stdout,
         "cert: path to your client certificate in PEM format. If this is not set you must specify use_websocket\n");
@@ -103,6 +111,8 @@ int main(int argc, char *argv[])
     String x509KeyPath;
     String x509RootCAFile;
 
+    Vector<String> alternateEndpoints;
+
     bool useWebSocket = false;
     bool useX509 = false;
 
@@ -143,6 +153,20 @@ int main(int argc, char *argv[])
     {
         clientId = s_getCmdOption(argv, argv + argc, "--client_id");
     }
+    if (s_cmdOptionExists(argv, argv + argc, "--alternate_endpoints"))
+    {
+        String list(s_getCmdOption(argv, argv + argc, "--alternate_endpoints"));
+        size_t start = 0;
+        while (start <= list.size())
+        {
+            size_t comma = std::min(list.find(',', start), list.size());
+            if (comma > start)
+            {
+                alternateEndpoints.push_back(list.substr(start, comma - start));
+            }
+            start = comma + 1;
+        }
+    }
 
     if (s_cmdOptionExists(argv, argv + argc, "--use_websocket"))
     {
@@ -336,7 +360,13 @@ int main(int argc, char *argv[])
                 x509Config.ProxyOptions = proxyOptions;
             }
 
-            provider = Aws::Crt::Auth::CredentialsProvider::CreateCredentialsProviderX509(x509Config);
+            /* The X.509 provider fetches on every call; cache its credentials so reconnects sign with them. */
+            Aws::Iotdevicecommon::CredentialsCacheConfig cacheConfig;
+            cacheConfig.Provider = Aws::Crt::Auth::CredentialsProvider::CreateCredentialsProviderX509(x509Config);
+            if (cacheConfig.Provider)
+            {
+                provider = Aws::Iotdevicecommon::CreateCachedCredentialsProvider(cacheConfig);
+            }
         }
         else
         {
@@ -372,6 +402,43 @@ int main(int argc, char *argv[])
 
     builder.WithEndpoint(endpoint);
 
+    /*
+     * With alternate endpoints, probe them all along with the main one and connect to the one that answers
+     * fastest. A long lived application would Start the selector instead, to probe again periodically and move
+     * to a better endpoint when it next reconnects.
+     */
+    std::shared_ptr<Aws::Discovery::EndpointSelector> endpointSelector;
+    if (!alternateEndpoints.empty())
+    {
+        alternateEndpoints.insert(alternateEndpoints.begin(), endpoint);
+
+        std::promise<bool> selectionPromise;
+
+        Aws::Discovery::EndpointSelectorConfig selectorConfig;
+        selectorConfig.Candidates =
+            Aws::Discovery::EndpointSelector::CandidatesOf(alternateEndpoints, useWebSocket ? 443 : 8883);
+        selectorConfig.Bootstrap = &bootstrap;
+        selectorConfig.SocketOptions.SetConnectTimeoutMs(3000);
+        selectorConfig.OnSelected = [&](const Aws::Discovery::ConnectivityInfo *selected, bool changed, int errorCode) {
+            if (selected && changed)
+            {
+                fprintf(stdout, "Selected endpoint %s\n", selected->HostAddress->c_str());
+            }
+            else if (!selected)
+            {
+                fprintf(stderr, "No endpoint answered, error %s\n", ErrorDebugString(errorCode));
+            }
+            selectionPromise.set_value(selected != nullptr);
+        };
+
+        endpointSelector = Aws::Discovery::EndpointSelector::Create(selectorConfig);
+        if (!endpointSelector || !endpointSelector->Evaluate() || !selectionPromise.get_future().get())
+        {
+            exit(-1);
+        }
+        endpointSelector->ApplyTo(builder);
+    }
+
     auto clientConfig = builder.Build();
 
     if (!clientConfig)
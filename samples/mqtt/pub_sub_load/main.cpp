@@ -0,0 +1,474 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/StlAllocator.h>
+
+#include <aws/crt/mqtt/MqttClient.h>
+
+#include <algorithm>
+#include <atomic>
+#include <aws/crt/UUID.h>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace Aws::Crt;
+
+static void s_printHelp()
+{
+    fprintf(stdout, "Usage:\n");
+    fprintf(
+        stdout,
+        "pub-sub-load --endpoint <endpoint> --cert <path to cert> --key <path to key>"
+        " --ca_file <optional: path to custom ca> --topic <topic prefix> --client_id <client id prefix>"
+        " --connections <count> --rate <messages per second> --qos <0|1> --payload_size <bytes>"
+        " --duration <seconds> --max_in_flight <count> --threads <count>\n\n");
+    fprintf(stdout, "endpoint: the endpoint of the mqtt server not including a port\n");
+    fprintf(stdout, "cert: path to your client certificate in PEM format\n");
+    fprintf(stdout, "key: path to your key in PEM format\n");
+    fprintf(
+        stdout,
+        "ca_file: Optional, if the mqtt server uses a certificate that's not already"
+        " in your trust store, set this.\n");
+    fprintf(stdout, "\tIt's the path to a CA file in PEM format\n");
+    fprintf(stdout, "topic: topic prefix; connection i publishes to and subscribes to <topic>/i (optional)\n");
+    fprintf(stdout, "client_id: client id prefix; connection i uses <client_id>-i (optional)\n");
+    fprintf(stdout, "connections: number of mqtt connections to open (optional, default 1)\n");
+    fprintf(stdout, "rate: total messages per second across all connections (optional, default 100)\n");
+    fprintf(stdout, "qos: 0 or 1, used for both publish and subscribe (optional, default 1)\n");
+    fprintf(stdout, "payload_size: bytes per message, at least 8 (optional, default 256)\n");
+    fprintf(stdout, "duration: seconds to publish for (optional, default 30)\n");
+    fprintf(
+        stdout,
+        "max_in_flight: per connection limit of publishes awaiting completion; sends over the limit are"
+        " skipped and reported (optional, default 1000)\n");
+    fprintf(stdout, "threads: event loop threads shared by all connections (optional, default 1)\n\n");
+}
+
+bool s_cmdOptionExists(char **begin, char **end, const String &option)
+{
+    return std::find(begin, end, option) != end;
+}
+
+char *s_getCmdOption(char **begin, char **end, const String &option)
+{
+    char **itr = std::find(begin, end, option);
+    if (itr != end && ++itr != end)
+    {
+        return *itr;
+    }
+    return 0;
+}
+
+static uint64_t s_nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+/*
+ * Per connection state. Every message carries its send time in its first 8 bytes, so round trip latency
+ * is measured when the broker echoes it back on the connection's own subscription.
+ */
+struct LoadConnection
+{
+    std::shared_ptr<Mqtt::MqttConnection> connection;
+    String topic;
+    std::promise<bool> connectedPromise;
+    std::promise<void> closedPromise;
+
+    std::atomic<uint64_t> published{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> skipped{0};
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> inFlight{0};
+
+    std::mutex latencyLock;
+    Vector<uint64_t> latenciesNs;
+};
+
+static double s_percentileUs(const Vector<uint64_t> &sortedNs, double percentile)
+{
+    if (sortedNs.empty())
+    {
+        return 0.0;
+    }
+    /* nearest rank */
+    size_t rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(sortedNs.size())));
+    size_t index = rank ? rank - 1 : 0;
+    return static_cast<double>(sortedNs[std::min(index, sortedNs.size() - 1)]) / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+
+    /************************ Setup the Lib ****************************/
+    /*
+     * Do the global initialization for the API.
+     */
+    ApiHandle apiHandle;
+
+    String endpoint;
+    String certificatePath;
+    String keyPath;
+    String caFile;
+    String topicPrefix("test/load");
+    String clientIdPrefix(String("test-") + Aws::Crt::UUID().ToString());
+    size_t connectionCount = 1;
+    uint64_t rate = 100;
+    Mqtt::QOS qos = AWS_MQTT_QOS_AT_LEAST_ONCE;
+    size_t payloadSize = 256;
+    uint64_t durationSeconds = 30;
+    uint64_t maxInFlight = 1000;
+    uint16_t threadCount = 1;
+
+    /*********************** Parse Arguments ***************************/
+    if (!s_cmdOptionExists(argv, argv + argc, "--endpoint") || !s_cmdOptionExists(argv, argv + argc, "--cert") ||
+        !s_cmdOptionExists(argv, argv + argc, "--key"))
+    {
+        s_printHelp();
+        return 1;
+    }
+
+    endpoint = s_getCmdOption(argv, argv + argc, "--endpoint");
+    certificatePath = s_getCmdOption(argv, argv + argc, "--cert");
+    keyPath = s_getCmdOption(argv, argv + argc, "--key");
+
+    if (s_cmdOptionExists(argv, argv + argc, "--ca_file"))
+    {
+        caFile = s_getCmdOption(argv, argv + argc, "--ca_file");
+    }
+    if (s_getCmdOption(argv, argv + argc, "--topic"))
+    {
+        topicPrefix = s_getCmdOption(argv, argv + argc, "--topic");
+    }
+    if (s_getCmdOption(argv, argv + argc, "--client_id"))
+    {
+        clientIdPrefix = s_getCmdOption(argv, argv + argc, "--client_id");
+    }
+    if (s_getCmdOption(argv, argv + argc, "--connections"))
+    {
+        connectionCount = static_cast<size_t>(atoi(s_getCmdOption(argv, argv + argc, "--connections")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--rate"))
+    {
+        rate = static_cast<uint64_t>(atoll(s_getCmdOption(argv, argv + argc, "--rate")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--qos"))
+    {
+        int qosValue = atoi(s_getCmdOption(argv, argv + argc, "--qos"));
+        if (qosValue != 0 && qosValue != 1)
+        {
+            fprintf(stdout, "qos must be 0 or 1.\n");
+            s_printHelp();
+            return 1;
+        }
+        qos = qosValue ? AWS_MQTT_QOS_AT_LEAST_ONCE : AWS_MQTT_QOS_AT_MOST_ONCE;
+    }
+    if (s_getCmdOption(argv, argv + argc, "--payload_size"))
+    {
+        payloadSize = static_cast<size_t>(atoi(s_getCmdOption(argv, argv + argc, "--payload_size")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--duration"))
+    {
+        durationSeconds = static_cast<uint64_t>(atoll(s_getCmdOption(argv, argv + argc, "--duration")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--max_in_flight"))
+    {
+        maxInFlight = static_cast<uint64_t>(atoll(s_getCmdOption(argv, argv + argc, "--max_in_flight")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--threads"))
+    {
+        int threads = atoi(s_getCmdOption(argv, argv + argc, "--threads"));
+        if (threads > 0 && threads <= UINT16_MAX)
+        {
+            threadCount = static_cast<uint16_t>(threads);
+        }
+    }
+
+    if (connectionCount == 0 || rate == 0 || durationSeconds == 0 || maxInFlight == 0)
+    {
+        fprintf(stdout, "connections, rate, duration and max_in_flight must be greater than zero.\n");
+        s_printHelp();
+        return 1;
+    }
+    if (payloadSize < sizeof(uint64_t))
+    {
+        fprintf(stdout, "payload_size must be at least %zu bytes to carry the send timestamp.\n", sizeof(uint64_t));
+        s_printHelp();
+        return 1;
+    }
+
+    /********************** Now Setup the Mqtt Clients ******************/
+    Io::EventLoopGroup eventLoopGroup(threadCount);
+    if (!eventLoopGroup)
+    {
+        fprintf(
+            stderr, "Event Loop Group Creation failed with error %s\n", ErrorDebugString(eventLoopGroup.LastError()));
+        exit(-1);
+    }
+
+    Aws::Crt::Io::DefaultHostResolver defaultHostResolver(eventLoopGroup, 1, 5);
+    Io::ClientBootstrap bootstrap(eventLoopGroup, defaultHostResolver);
+
+    if (!bootstrap)
+    {
+        fprintf(stderr, "ClientBootstrap failed with error %s\n", ErrorDebugString(bootstrap.LastError()));
+        exit(-1);
+    }
+
+    Mqtt::MqttClient client(bootstrap);
+    Io::TlsContextOptions ctxOptions =
+        Io::TlsContextOptions::InitClientWithMtls(certificatePath.c_str(), keyPath.c_str());
+    if (!caFile.empty())
+    {
+        ctxOptions.OverrideDefaultTrustStore(nullptr, caFile.c_str());
+    }
+
+    uint16_t port = 8883;
+    if (Io::TlsContextOptions::IsAlpnSupported())
+    {
+        port = 443;
+        ctxOptions.SetAlpnList("x-amzn-mqtt-ca");
+    }
+
+    Io::SocketOptions socketOptions;
+    socketOptions.SetConnectTimeoutMs(3000);
+
+    Io::TlsContext tlsContext(ctxOptions, Io::TlsMode::CLIENT);
+    if (!tlsContext)
+    {
+        fprintf(
+            stderr, "Unable to create tls context, error: %s\n", ErrorDebugString(tlsContext.GetInitializationError()));
+        exit(-1);
+    }
+
+    Vector<std::unique_ptr<LoadConnection>> loadConnections;
+    for (size_t i = 0; i < connectionCount; ++i)
+    {
+        std::unique_ptr<LoadConnection> load(new LoadConnection());
+        load->topic = topicPrefix + "/" + std::to_string(i).c_str();
+        load->connection = client.NewConnection(endpoint.c_str(), port, socketOptions, tlsContext);
+        if (!load->connection)
+        {
+            fprintf(stderr, "MQTT Connection Creation failed with error %s\n", ErrorDebugString(client.LastError()));
+            exit(-1);
+        }
+
+        LoadConnection *state = load.get();
+        load->connection->OnConnectionCompleted =
+            [state](Mqtt::MqttConnection &, int errorCode, Mqtt::ReturnCode returnCode, bool) {
+                if (errorCode)
+                {
+                    fprintf(stdout, "Connection failed with error %s\n", ErrorDebugString(errorCode));
+                }
+                else if (returnCode != AWS_MQTT_CONNECT_ACCEPTED)
+                {
+                    fprintf(stdout, "Connection failed with mqtt return code %d\n", (int)returnCode);
+                }
+                state->connectedPromise.set_value(!errorCode && returnCode == AWS_MQTT_CONNECT_ACCEPTED);
+            };
+        load->connection->OnConnectionInterrupted = [](Mqtt::MqttConnection &, int error) {
+            fprintf(stdout, "Connection interrupted with error %s\n", ErrorDebugString(error));
+        };
+        load->connection->OnDisconnect = [state](Mqtt::MqttConnection &) { state->closedPromise.set_value(); };
+
+        String clientId = clientIdPrefix + "-" + std::to_string(i).c_str();
+        if (!load->connection->Connect(clientId.c_str(), true, 1000))
+        {
+            fprintf(stderr, "MQTT Connection failed with error %s\n", ErrorDebugString(load->connection->LastError()));
+            exit(-1);
+        }
+        loadConnections.push_back(std::move(load));
+    }
+
+    for (auto &load : loadConnections)
+    {
+        if (!load->connectedPromise.get_future().get())
+        {
+            exit(-1);
+        }
+    }
+    fprintf(stdout, "%zu connection(s) established.\n", loadConnections.size());
+
+    /*
+     * Subscribe each connection to its own topic, so every message it publishes comes back to it.
+     */
+    for (auto &load : loadConnections)
+    {
+        LoadConnection *state = load.get();
+        auto onMessage = [state](Mqtt::MqttConnection &,
+                                 const String &,
+                                 const ByteBuf &payload,
+                                 bool /*dup*/,
+                                 Mqtt::QOS /*qos*/,
+                                 bool /*retain*/) {
+            uint64_t receivedNs = s_nowNs();
+            if (payload.len < sizeof(uint64_t))
+            {
+                return;
+            }
+            uint64_t sentNs = 0;
+            memcpy(&sentNs, payload.buffer, sizeof(sentNs));
+            state->received++;
+            std::lock_guard<std::mutex> lock(state->latencyLock);
+            state->latenciesNs.push_back(receivedNs - sentNs);
+        };
+
+        std::promise<bool> subscribeFinishedPromise;
+        auto onSubAck =
+            [&](Mqtt::MqttConnection &, uint16_t packetId, const String &topic, Mqtt::QOS QoS, int errorCode) {
+                if (errorCode)
+                {
+                    fprintf(stderr, "Subscribe failed with error %s\n", aws_error_debug_str(errorCode));
+                }
+                else if (!packetId || QoS == AWS_MQTT_QOS_FAILURE)
+                {
+                    fprintf(stderr, "Subscribe on topic %s rejected by the broker.\n", topic.c_str());
+                }
+                subscribeFinishedPromise.set_value(!errorCode && packetId && QoS != AWS_MQTT_QOS_FAILURE);
+            };
+
+        load->connection->Subscribe(load->topic.c_str(), qos, onMessage, onSubAck);
+        if (!subscribeFinishedPromise.get_future().get())
+        {
+            exit(-1);
+        }
+    }
+
+    /*********************** Generate Load ***************************/
+    fprintf(
+        stdout,
+        "Publishing %" PRIu64 " msg/s of %zu bytes at qos %d for %" PRIu64 " s...\n",
+        rate,
+        payloadSize,
+        (int)qos,
+        durationSeconds);
+
+    const uint64_t intervalNs = 1000000000ULL / rate;
+    const uint64_t startNs = s_nowNs();
+    const uint64_t endNs = startNs + durationSeconds * 1000000000ULL;
+    uint64_t nextSendNs = startNs;
+    size_t next = 0;
+
+    while (nextSendNs < endNs)
+    {
+        uint64_t nowNs = s_nowNs();
+        if (nowNs < nextSendNs)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(nextSendNs - nowNs));
+        }
+        nextSendNs += intervalNs;
+
+        LoadConnection *state = loadConnections[next].get();
+        next = (next + 1) % loadConnections.size();
+
+        if (state->inFlight.load() >= maxInFlight)
+        {
+            state->skipped++;
+            continue;
+        }
+
+        /*
+         * The payload must stay valid until the publish completes, so each message owns its buffer and the
+         * completion callback keeps it alive.
+         */
+        auto payload = std::make_shared<Vector<uint8_t>>(payloadSize, static_cast<uint8_t>('x'));
+        uint64_t sentNs = s_nowNs();
+        memcpy(payload->data(), &sentNs, sizeof(sentNs));
+        ByteBuf payloadBuf = ByteBufFromArray(payload->data(), payload->size());
+
+        state->inFlight++;
+        state->published++;
+        auto onPublishComplete = [state, payload](Mqtt::MqttConnection &, uint16_t, int errorCode) {
+            if (errorCode)
+            {
+                state->failed++;
+            }
+            else
+            {
+                state->completed++;
+            }
+            state->inFlight--;
+        };
+        if (!state->connection->Publish(state->topic.c_str(), qos, false, payloadBuf, std::move(onPublishComplete)))
+        {
+            state->inFlight--;
+            state->failed++;
+        }
+    }
+    const uint64_t publishEndNs = s_nowNs();
+
+    /*
+     * Give outstanding messages up to five seconds to come back before tallying.
+     */
+    for (int i = 0; i < 50; ++i)
+    {
+        uint64_t outstanding = 0;
+        for (auto &load : loadConnections)
+        {
+            uint64_t completed = load->completed.load();
+            uint64_t received = load->received.load();
+            outstanding += load->inFlight.load() + (completed > received ? completed - received : 0);
+        }
+        if (!outstanding)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    /*********************** Report ***************************/
+    uint64_t published = 0;
+    uint64_t completed = 0;
+    uint64_t failed = 0;
+    uint64_t skipped = 0;
+    uint64_t received = 0;
+    Vector<uint64_t> latenciesNs;
+    for (auto &load : loadConnections)
+    {
+        published += load->published.load();
+        completed += load->completed.load();
+        failed += load->failed.load();
+        skipped += load->skipped.load();
+        received += load->received.load();
+        std::lock_guard<std::mutex> lock(load->latencyLock);
+        latenciesNs.insert(latenciesNs.end(), load->latenciesNs.begin(), load->latenciesNs.end());
+    }
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+
+    double elapsedSeconds = static_cast<double>(publishEndNs - startNs) / 1e9;
+    fprintf(stdout, "connections:     %zu\n", loadConnections.size());
+    fprintf(stdout, "published:       %" PRIu64 " (%.1f msg/s)\n", published, published / elapsedSeconds);
+    fprintf(stdout, "completed:       %" PRIu64 "\n", completed);
+    fprintf(stdout, "failed:          %" PRIu64 "\n", failed);
+    fprintf(stdout, "skipped:         %" PRIu64 " (max_in_flight reached)\n", skipped);
+    fprintf(stdout, "received:        %" PRIu64 " (%.1f msg/s)\n", received, received / elapsedSeconds);
+    fprintf(stdout, "round trip p50:  %.1f us\n", s_percentileUs(latenciesNs, 0.50));
+    fprintf(stdout, "round trip p99:  %.1f us\n", s_percentileUs(latenciesNs, 0.99));
+    fprintf(stdout, "round trip p999: %.1f us\n", s_percentileUs(latenciesNs, 0.999));
+    fprintf(
+        stdout,
+        "round trip max:  %.1f us\n",
+        latenciesNs.empty() ? 0.0 : static_cast<double>(latenciesNs.back()) / 1000.0);
+
+    /* Disconnect */
+    for (auto &load : loadConnections)
+    {
+        if (load->connection->Disconnect())
+        {
+            load->closedPromise.get_future().wait();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,742 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/UUID.h>
+#include <aws/crt/io/HostResolver.h>
+
+#include <aws/iot/MqttClient.h>
+
+#include <aws/iotdevicecommon/ServiceMetrics.h>
+#include <aws/iotdevicecommon/SubscriptionBatch.h>
+
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/GetShadowRequest.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/GetShadowSubscriptionRequest.h>
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowRequestCorrelator.h>
+#include <aws/iotshadow/ShadowUpdateCoalescer.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowResponse.h>
+#include <aws/iotshadow/UpdateShadowSubscriptionRequest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotshadow;
+
+static void s_printHelp()
+{
+    fprintf(stdout, "Usage:\n");
+    fprintf(
+        stdout,
+        "shadow-benchmark --endpoint <endpoint> --cert <path to cert> --key <path to key>"
+        " --ca_file <optional: path to custom ca> --thing_name <thing name prefix> --things <count>"
+        " --rate <operations per second> --payload_size <bytes> --duration <seconds> --get_percent <percent>"
+        " --delta_every <count> --max_in_flight <count> --correlate --coalesce_ms <milliseconds>\n\n");
+    fprintf(stdout, "endpoint: the endpoint of the mqtt server not including a port\n");
+    fprintf(stdout, "cert: path to your client certificate in PEM format\n");
+    fprintf(stdout, "key: path to your key in PEM format\n");
+    fprintf(
+        stdout,
+        "ca_file: Optional, if the mqtt server uses a certificate that's not already"
+        " in your trust store, set this.\n");
+    fprintf(stdout, "\tIt's the path to a CA file in PEM format\n");
+    fprintf(stdout, "thing_name: the thing, or with --things above 1 the prefix of things <thing_name>-i\n");
+    fprintf(stdout, "things: number of shadows to drive, round-robin (optional, default 1)\n");
+    fprintf(stdout, "rate: total shadow operations per second (optional, default 50)\n");
+    fprintf(stdout, "payload_size: bytes of filler in each update's state (optional, default 64)\n");
+    fprintf(stdout, "duration: seconds to run for (optional, default 30)\n");
+    fprintf(stdout, "get_percent: share of operations that are gets rather than updates (optional, default 10)\n");
+    fprintf(
+        stdout,
+        "delta_every: make every n-th update change the desired state, so the service sends a delta"
+        " (optional, default 0: never)\n");
+    fprintf(
+        stdout,
+        "max_in_flight: limit of operations awaiting their response; operations over the limit are skipped"
+        " and reported (optional, default 100)\n");
+    fprintf(stdout, "correlate: send gets and updates through ShadowRequestCorrelator (optional)\n");
+    fprintf(
+        stdout,
+        "coalesce_ms: send reported updates through ShadowUpdateCoalescer with this window; their latency is"
+        " then to the PUBACK of the merged update (optional)\n\n");
+}
+
+static bool s_cmdOptionExists(char **begin, char **end, const String &option)
+{
+    return std::find(begin, end, option) != end;
+}
+
+static char *s_getCmdOption(char **begin, char **end, const String &option)
+{
+    char **itr = std::find(begin, end, option);
+    if (itr != end && ++itr != end)
+    {
+        return *itr;
+    }
+    return 0;
+}
+
+static uint64_t s_nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+static double s_percentileMs(const Vector<uint64_t> &sortedNs, double percentile)
+{
+    if (sortedNs.empty())
+    {
+        return 0.0;
+    }
+    /* nearest rank */
+    size_t rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(sortedNs.size())));
+    size_t index = rank ? rank - 1 : 0;
+    return static_cast<double>(sortedNs[std::min(index, sortedNs.size() - 1)]) / 1e6;
+}
+
+/*
+ * Latency samples and outcome counts of one kind of operation.
+ */
+struct OperationStats
+{
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> failed{0};
+
+    std::mutex latencyLock;
+    Vector<uint64_t> latenciesNs;
+
+    void Complete(uint64_t sentNs, bool wasAccepted)
+    {
+        (wasAccepted ? accepted : rejected)++;
+        uint64_t latencyNs = s_nowNs() - sentNs;
+        std::lock_guard<std::mutex> lock(latencyLock);
+        latenciesNs.push_back(latencyNs);
+    }
+
+    void Report(const char *name, double elapsedSeconds)
+    {
+        std::lock_guard<std::mutex> lock(latencyLock);
+        std::sort(latenciesNs.begin(), latenciesNs.end());
+        fprintf(
+            stdout,
+            "%-8s sent %" PRIu64 ", accepted %" PRIu64 " (%.1f/s), rejected %" PRIu64 ", failed %" PRIu64 "\n",
+            name,
+            sent.load(),
+            accepted.load(),
+            accepted.load() / elapsedSeconds,
+            rejected.load(),
+            failed.load());
+        fprintf(
+            stdout,
+            "%-8s latency p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+            name,
+            s_percentileMs(latenciesNs, 0.50),
+            s_percentileMs(latenciesNs, 0.90),
+            s_percentileMs(latenciesNs, 0.99),
+            latenciesNs.empty() ? 0.0 : static_cast<double>(latenciesNs.back()) / 1e6);
+    }
+};
+
+/*
+ * Requests sent without the correlator, keyed by ClientToken, completed from the accepted and rejected
+ * subscriptions. This is the bookkeeping ShadowRequestCorrelator does for an application.
+ */
+struct PendingRequest
+{
+    uint64_t sentNs;
+    OperationStats *stats;
+};
+
+struct BenchmarkState
+{
+    OperationStats updates;
+    OperationStats gets;
+    OperationStats deltas;
+    std::atomic<uint64_t> inFlight{0};
+    std::atomic<uint64_t> skipped{0};
+
+    std::mutex pendingLock;
+    Map<String, PendingRequest> pending;
+    /* Send time of each desired change, keyed by "<thing>/<seq>", until its delta arrives. */
+    Map<String, uint64_t> pendingDeltas;
+
+    void CompletePending(const Optional<String> &clientToken, bool accepted)
+    {
+        if (!clientToken)
+        {
+            return;
+        }
+        PendingRequest request{0, nullptr};
+        {
+            std::lock_guard<std::mutex> lock(pendingLock);
+            auto found = pending.find(*clientToken);
+            if (found == pending.end())
+            {
+                return;
+            }
+            request = found->second;
+            pending.erase(found);
+        }
+        request.stats->Complete(request.sentNs, accepted);
+        inFlight--;
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    /************************ Setup the Lib ****************************/
+    /*
+     * Do the global initialization for the API.
+     */
+    ApiHandle apiHandle;
+
+    String endpoint;
+    String certificatePath;
+    String keyPath;
+    String caFile;
+    String thingNamePrefix;
+    String clientId(String("test-") + Aws::Crt::UUID().ToString());
+    size_t thingCount = 1;
+    uint64_t rate = 50;
+    size_t payloadSize = 64;
+    uint64_t durationSeconds = 30;
+    uint32_t getPercent = 10;
+    uint64_t deltaEvery = 0;
+    uint64_t maxInFlight = 100;
+    bool correlate = false;
+    uint32_t coalesceMs = 0;
+
+    /*********************** Parse Arguments ***************************/
+    if (!(s_cmdOptionExists(argv, argv + argc, "--endpoint") && s_cmdOptionExists(argv, argv + argc, "--cert") &&
+          s_cmdOptionExists(argv, argv + argc, "--key") && s_cmdOptionExists(argv, argv + argc, "--thing_name")))
+    {
+        s_printHelp();
+        return 1;
+    }
+
+    endpoint = s_getCmdOption(argv, argv + argc, "--endpoint");
+    certificatePath = s_getCmdOption(argv, argv + argc, "--cert");
+    keyPath = s_getCmdOption(argv, argv + argc, "--key");
+    thingNamePrefix = s_getCmdOption(argv, argv + argc, "--thing_name");
+
+    if (s_cmdOptionExists(argv, argv + argc, "--ca_file"))
+    {
+        caFile = s_getCmdOption(argv, argv + argc, "--ca_file");
+    }
+    if (s_getCmdOption(argv, argv + argc, "--things"))
+    {
+        thingCount = static_cast<size_t>(atoi(s_getCmdOption(argv, argv + argc, "--things")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--rate"))
+    {
+        rate = static_cast<uint64_t>(atoll(s_getCmdOption(argv, argv + argc, "--rate")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--payload_size"))
+    {
+        payloadSize = static_cast<size_t>(atoi(s_getCmdOption(argv, argv + argc, "--payload_size")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--duration"))
+    {
+        durationSeconds = static_cast<uint64_t>(atoll(s_getCmdOption(argv, argv + argc, "--duration")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--get_percent"))
+    {
+        getPercent = static_cast<uint32_t>(std::min(100, atoi(s_getCmdOption(argv, argv + argc, "--get_percent"))));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--delta_every"))
+    {
+        deltaEvery = static_cast<uint64_t>(atoll(s_getCmdOption(argv, argv + argc, "--delta_every")));
+    }
+    if (s_getCmdOption(argv, argv + argc, "--max_in_flight"))
+    {
+        maxInFlight = static_cast<uint64_t>(atoll(s_getCmdOption(argv, argv + argc, "--max_in_flight")));
+    }
+    correlate = s_cmdOptionExists(argv, argv + argc, "--correlate");
+    if (s_getCmdOption(argv, argv + argc, "--coalesce_ms"))
+    {
+        coalesceMs = static_cast<uint32_t>(atoi(s_getCmdOption(argv, argv + argc, "--coalesce_ms")));
+    }
+
+    if (thingCount == 0 || rate == 0 || durationSeconds == 0 || maxInFlight == 0)
+    {
+        fprintf(stdout, "things, rate, duration and max_in_flight must be greater than zero.\n");
+        s_printHelp();
+        return 1;
+    }
+
+    Vector<String> thingNames;
+    for (size_t i = 0; i < thingCount; ++i)
+    {
+        thingNames.push_back(
+            thingCount == 1 ? thingNamePrefix : thingNamePrefix + "-" + std::to_string(i).c_str());
+    }
+
+    /********************** Now Setup an Mqtt Client ******************/
+    Io::EventLoopGroup eventLoopGroup(1);
+    if (!eventLoopGroup)
+    {
+        fprintf(
+            stderr, "Event Loop Group Creation failed with error %s\n", ErrorDebugString(eventLoopGroup.LastError()));
+        exit(-1);
+    }
+
+    Io::DefaultHostResolver hostResolver(eventLoopGroup, 2, 30);
+    Io::ClientBootstrap bootstrap(eventLoopGroup, hostResolver);
+
+    if (!bootstrap)
+    {
+        fprintf(stderr, "ClientBootstrap failed with error %s\n", ErrorDebugString(bootstrap.LastError()));
+        exit(-1);
+    }
+
+    auto clientConfigBuilder = Aws::Iot::MqttClientConnectionConfigBuilder(certificatePath.c_str(), keyPath.c_str());
+    clientConfigBuilder.WithEndpoint(endpoint);
+    if (!caFile.empty())
+    {
+        clientConfigBuilder.WithCertificateAuthority(caFile.c_str());
+    }
+    auto clientConfig = clientConfigBuilder.Build();
+
+    if (!clientConfig)
+    {
+        fprintf(
+            stderr,
+            "Client Configuration initialization failed with error %s\n",
+            ErrorDebugString(clientConfig.LastError()));
+        exit(-1);
+    }
+
+    Aws::Iot::MqttClient mqttClient(bootstrap);
+    if (!mqttClient)
+    {
+        fprintf(stderr, "MQTT Client Creation failed with error %s\n", ErrorDebugString(mqttClient.LastError()));
+        exit(-1);
+    }
+
+    auto connection = mqttClient.NewConnection(clientConfig);
+    if (!*connection)
+    {
+        fprintf(stderr, "MQTT Connection Creation failed with error %s\n", ErrorDebugString(connection->LastError()));
+        exit(-1);
+    }
+
+    std::promise<bool> connectionCompletedPromise;
+    std::promise<void> connectionClosedPromise;
+
+    connection->OnConnectionCompleted = [&](Mqtt::MqttConnection &, int errorCode, Mqtt::ReturnCode returnCode, bool) {
+        if (errorCode)
+        {
+            fprintf(stdout, "Connection failed with error %s\n", ErrorDebugString(errorCode));
+        }
+        else if (returnCode != AWS_MQTT_CONNECT_ACCEPTED)
+        {
+            fprintf(stdout, "Connection failed with mqtt return code %d\n", (int)returnCode);
+        }
+        connectionCompletedPromise.set_value(!errorCode && returnCode == AWS_MQTT_CONNECT_ACCEPTED);
+    };
+    connection->OnDisconnect = [&](Mqtt::MqttConnection &) { connectionClosedPromise.set_value(); };
+
+    fprintf(stdout, "Connecting...\n");
+    if (!connection->Connect(clientId.c_str(), true, 0))
+    {
+        fprintf(stderr, "MQTT Connection failed with error %s\n", ErrorDebugString(connection->LastError()));
+        exit(-1);
+    }
+
+    if (!connectionCompletedPromise.get_future().get())
+    {
+        exit(-1);
+    }
+
+    /*
+     * The client records every publish and received message, so the report can show how many MQTT
+     * messages the operations cost, which is where coalescing pays off.
+     */
+    auto metrics = std::make_shared<Aws::Iotdevicecommon::ServiceMetrics>();
+    Aws::Iotdevicecommon::ServiceClientConfig serviceConfig;
+    serviceConfig.Metrics = metrics;
+    IotShadowClient shadowClient(connection, serviceConfig);
+
+    BenchmarkState state;
+    const Mqtt::QOS qos = AWS_MQTT_QOS_AT_LEAST_ONCE;
+
+    /*********************** Subscribe ***************************/
+    Vector<std::shared_ptr<ShadowRequestCorrelator>> correlators;
+    std::atomic<int> subscribeError{AWS_ERROR_SUCCESS};
+    auto onSubAck = [&subscribeError](int ioErr) {
+        if (ioErr)
+        {
+            subscribeError = ioErr;
+        }
+    };
+
+    /*
+     * Batch the subscriptions of every thing so they go out in as few SUBSCRIBE packets as possible.
+     */
+    Aws::Iotdevicecommon::SubscriptionBatch subscriptions;
+    {
+        Aws::Iotdevicecommon::SubscriptionBatch::Capture capture(subscriptions);
+        for (const String &thingName : thingNames)
+        {
+            if (correlate)
+            {
+                auto correlator = ShadowRequestCorrelator::Create(
+                    shadowClient, eventLoopGroup, thingName, ShadowRequestCorrelatorConfig());
+                if (!correlator || !correlator->Subscribe(qos, onSubAck))
+                {
+                    fprintf(
+                        stderr, "ShadowRequestCorrelator setup failed with error %s\n", ErrorDebugString(LastError()));
+                    exit(-1);
+                }
+                correlators.push_back(correlator);
+            }
+            else
+            {
+                UpdateShadowSubscriptionRequest updateSubscription;
+                updateSubscription.ThingName = thingName;
+                shadowClient.SubscribeToUpdateShadowAccepted(
+                    updateSubscription,
+                    qos,
+                    [&state](UpdateShadowResponse *response, int ioErr) {
+                        if (response && !ioErr)
+                        {
+                            state.CompletePending(response->ClientToken, true);
+                        }
+                    },
+                    onSubAck);
+                shadowClient.SubscribeToUpdateShadowRejected(
+                    updateSubscription,
+                    qos,
+                    [&state](ErrorResponse *error, int ioErr) {
+                        if (error && !ioErr)
+                        {
+                            state.CompletePending(error->ClientToken, false);
+                        }
+                    },
+                    onSubAck);
+
+                GetShadowSubscriptionRequest getSubscription;
+                getSubscription.ThingName = thingName;
+                shadowClient.SubscribeToGetShadowAccepted(
+                    getSubscription,
+                    qos,
+                    [&state](GetShadowResponse *response, int ioErr) {
+                        if (response && !ioErr)
+                        {
+                            state.CompletePending(response->ClientToken, true);
+                        }
+                    },
+                    onSubAck);
+                shadowClient.SubscribeToGetShadowRejected(
+                    getSubscription,
+                    qos,
+                    [&state](ErrorResponse *error, int ioErr) {
+                        if (error && !ioErr)
+                        {
+                            state.CompletePending(error->ClientToken, false);
+                        }
+                    },
+                    onSubAck);
+            }
+
+            if (deltaEvery > 0)
+            {
+                ShadowDeltaUpdatedSubscriptionRequest deltaSubscription;
+                deltaSubscription.ThingName = thingName;
+                shadowClient.SubscribeToShadowDeltaUpdatedEvents(
+                    deltaSubscription,
+                    qos,
+                    [&state, thingName](ShadowDeltaUpdatedEvent *event, int ioErr) {
+                        if (!event || ioErr || !event->State || !event->State->View().ValueExists("seq"))
+                        {
+                            return;
+                        }
+                        String key = thingName + "/" + std::to_string(event->State->View().GetInt64("seq")).c_str();
+                        uint64_t sentNs = 0;
+                        {
+                            std::lock_guard<std::mutex> lock(state.pendingLock);
+                            auto found = state.pendingDeltas.find(key);
+                            if (found == state.pendingDeltas.end())
+                            {
+                                return;
+                            }
+                            sentNs = found->second;
+                            state.pendingDeltas.erase(found);
+                        }
+                        state.deltas.Complete(sentNs, true);
+                    },
+                    onSubAck);
+            }
+        }
+    }
+
+    std::promise<void> subscribeCompletedPromise;
+    subscriptions.Submit([&](int) { subscribeCompletedPromise.set_value(); });
+    subscribeCompletedPromise.get_future().wait();
+    if (subscribeError != AWS_ERROR_SUCCESS)
+    {
+        fprintf(stderr, "Subscribing failed with error %s\n", ErrorDebugString(subscribeError));
+        exit(-1);
+    }
+
+    std::shared_ptr<ShadowUpdateCoalescer> coalescer;
+    if (coalesceMs > 0)
+    {
+        ShadowUpdateCoalescerConfig coalescerConfig;
+        coalescerConfig.CoalesceWindowMs = coalesceMs;
+        coalescerConfig.Qos = qos;
+        coalescer = ShadowUpdateCoalescer::Create(shadowClient, eventLoopGroup, coalescerConfig);
+        if (!coalescer)
+        {
+            fprintf(stderr, "ShadowUpdateCoalescer creation failed with error %s\n", ErrorDebugString(LastError()));
+            exit(-1);
+        }
+    }
+
+    /*********************** Generate Load ***************************/
+    fprintf(
+        stdout,
+        "Running %" PRIu64 " op/s over %zu shadow(s), %zu byte payloads, %u%% gets, for %" PRIu64 " s%s%s...\n",
+        rate,
+        thingNames.size(),
+        payloadSize,
+        getPercent,
+        durationSeconds,
+        correlate ? ", correlated" : "",
+        coalescer ? ", coalesced" : "");
+
+    const String filler(payloadSize, 'x');
+    const uint64_t intervalNs = 1000000000ULL / rate;
+    const uint64_t startNs = s_nowNs();
+    const uint64_t endNs = startNs + durationSeconds * 1000000000ULL;
+    uint64_t nextSendNs = startNs;
+    uint64_t sequence = 0;
+
+    while (nextSendNs < endNs)
+    {
+        uint64_t nowNs = s_nowNs();
+        if (nowNs < nextSendNs)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(nextSendNs - nowNs));
+        }
+        nextSendNs += intervalNs;
+
+        if (state.inFlight.load() >= maxInFlight)
+        {
+            state.skipped++;
+            continue;
+        }
+
+        ++sequence;
+        size_t thingIndex = static_cast<size_t>(sequence % thingNames.size());
+        const String &thingName = thingNames[thingIndex];
+        bool isGet = (sequence * 37) % 100 < getPercent;
+        bool isDelta = !isGet && deltaEvery > 0 && sequence % deltaEvery == 0;
+        OperationStats &stats = isGet ? state.gets : state.updates;
+        uint64_t sentNs = s_nowNs();
+        stats.sent++;
+        state.inFlight++;
+
+        JsonObject update;
+        update.WithInt64("seq", static_cast<int64_t>(sequence));
+        update.WithString("data", filler);
+        if (isDelta)
+        {
+            std::lock_guard<std::mutex> lock(state.pendingLock);
+            state.pendingDeltas[thingName + "/" + std::to_string(sequence).c_str()] = sentNs;
+        }
+
+        bool sent = false;
+        if (!isGet && !isDelta && coalescer)
+        {
+            sent = coalescer->UpdateReported(thingName, update.View(), [&state, &stats, sentNs](int ioErr) {
+                if (ioErr)
+                {
+                    stats.failed++;
+                }
+                else
+                {
+                    stats.Complete(sentNs, true);
+                }
+                state.inFlight--;
+            });
+        }
+        else if (correlate)
+        {
+            ShadowRequestCorrelator &correlator = *correlators[thingIndex];
+            if (isGet)
+            {
+                sent = correlator.GetShadowAsync(
+                    qos, [&state, &stats, sentNs](GetShadowResponse *response, ErrorResponse *error, int ioErr) {
+                        if (ioErr || (!response && !error))
+                        {
+                            stats.failed++;
+                        }
+                        else
+                        {
+                            stats.Complete(sentNs, response != nullptr);
+                        }
+                        state.inFlight--;
+                    });
+            }
+            else
+            {
+                ShadowState shadowState;
+                if (isDelta)
+                {
+                    shadowState.Desired = update;
+                }
+                else
+                {
+                    shadowState.Reported = update;
+                }
+                sent = correlator.UpdateShadowAsync(
+                    shadowState,
+                    Optional<int32_t>(),
+                    qos,
+                    [&state, &stats, sentNs](UpdateShadowResponse *response, ErrorResponse *error, int ioErr) {
+                        if (ioErr || (!response && !error))
+                        {
+                            stats.failed++;
+                        }
+                        else
+                        {
+                            stats.Complete(sentNs, response != nullptr);
+                        }
+                        state.inFlight--;
+                    });
+            }
+        }
+        else
+        {
+            String clientToken = Aws::Crt::UUID().ToString();
+            {
+                std::lock_guard<std::mutex> lock(state.pendingLock);
+                state.pending[clientToken] = PendingRequest{sentNs, &stats};
+            }
+            auto onPubAck = [&state, &stats, clientToken](int ioErr) {
+                if (!ioErr)
+                {
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(state.pendingLock);
+                    if (!state.pending.erase(clientToken))
+                    {
+                        return;
+                    }
+                }
+                stats.failed++;
+                state.inFlight--;
+            };
+
+            if (isGet)
+            {
+                GetShadowRequest request;
+                request.ThingName = thingName;
+                request.ClientToken = clientToken;
+                sent = shadowClient.PublishGetShadow(request, qos, std::move(onPubAck));
+            }
+            else
+            {
+                UpdateShadowRequest request;
+                request.ThingName = thingName;
+                request.ClientToken = clientToken;
+                ShadowState shadowState;
+                if (isDelta)
+                {
+                    shadowState.Desired = update;
+                }
+                else
+                {
+                    shadowState.Reported = update;
+                }
+                request.State = shadowState;
+                sent = shadowClient.PublishUpdateShadow(request, qos, std::move(onPubAck));
+            }
+            if (!sent)
+            {
+                std::lock_guard<std::mutex> lock(state.pendingLock);
+                state.pending.erase(clientToken);
+            }
+        }
+
+        if (!sent)
+        {
+            stats.failed++;
+            state.inFlight--;
+        }
+    }
+    if (coalescer)
+    {
+        coalescer->Flush();
+    }
+    const uint64_t loadEndNs = s_nowNs();
+
+    /*
+     * Give outstanding operations up to five seconds to complete before tallying.
+     */
+    for (int i = 0; i < 50 && state.inFlight.load() > 0; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    /*********************** Report ***************************/
+    double elapsedSeconds = static_cast<double>(loadEndNs - startNs) / 1e9;
+    uint64_t publishes = 0;
+    uint64_t publishBytes = 0;
+    uint64_t received = 0;
+    metrics->Export([&](const Aws::Iotdevicecommon::TopicMetrics &topic) {
+        publishes += topic.PublishCount;
+        publishBytes += topic.PublishBytes;
+        received += topic.ReceiveCount;
+    });
+
+    fprintf(stdout, "shadows:  %zu\n", thingNames.size());
+    state.updates.Report("updates", elapsedSeconds);
+    state.gets.Report("gets", elapsedSeconds);
+    if (deltaEvery > 0)
+    {
+        state.deltas.Report("deltas", elapsedSeconds);
+    }
+    fprintf(stdout, "skipped:  %" PRIu64 " (max_in_flight reached)\n", state.skipped.load());
+    fprintf(
+        stdout,
+        "mqtt:     %" PRIu64 " publishes (%.1f/s, %" PRIu64 " bytes), %" PRIu64 " messages received\n",
+        publishes,
+        publishes / elapsedSeconds,
+        publishBytes,
+        received);
+
+    /* Waits out completions still arriving before the state they refer to goes away. */
+    coalescer.reset();
+    for (auto &correlator : correlators)
+    {
+        correlator->CancelAll(AWS_ERROR_MQTT_NOT_CONNECTED);
+    }
+
+    /* Disconnect */
+    if (connection->Disconnect())
+    {
+        connectionClosedPromise.get_future().wait();
+    }
+    return 0;
+}
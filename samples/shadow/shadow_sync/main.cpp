@@ -9,6 +9,8 @@
 
 #include <aws/iot/MqttClient.h>
 
+#include <aws/iotdevicecommon/SubscriptionBatch.h>
+
 #include <aws/iotshadow/ErrorResponse.h>
 #include <aws/iotshadow/IotShadowClient.h>
 #include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
@@ -250,9 +252,7 @@ int main(int argc, char *argv[])
     {
         Aws::Iotshadow::IotShadowClient shadowClient(connection);
 
-        std::promise<void> subscribeDeltaCompletedPromise;
-        std::promise<void> subscribeDeltaAcceptedCompletedPromise;
-        std::promise<void> subscribeDeltaRejectedCompletedPromise;
+        std::promise<void> subscribeCompletedPromise;
 
         auto onDeltaUpdatedSubAck = [&](int ioErr) {
             if (ioErr != AWS_OP_SUCCESS)
@@ -260,7 +260,6 @@ int main(int argc, char *argv[])
                 fprintf(stderr, "Error subscribing to shadow delta: %s\n", ErrorDebugString(ioErr));
                 exit(-1);
             }
-            subscribeDeltaCompletedPromise.set_value();
         };
 
         auto onDeltaUpdatedAcceptedSubAck = [&](int ioErr) {
@@ -269,7 +268,6 @@ int main(int argc, char *argv[])
                 fprintf(stderr, "Error subscribing to shadow delta accepted: %s\n", ErrorDebugString(ioErr));
                 exit(-1);
             }
-            subscribeDeltaAcceptedCompletedPromise.set_value();
         };
 
         auto onDeltaUpdatedRejectedSubAck = [&](int ioErr) {
@@ -278,7 +276,6 @@ int main(int argc, char *argv[])
                 fprintf(stderr, "Error subscribing to shadow delta rejected: %s\n", ErrorDebugString(ioErr));
                 exit(-1);
             }
-            subscribeDeltaRejectedCompletedPromise.set_value();
         };
 
         auto onDeltaUpdated = [&](ShadowDeltaUpdatedEvent *event, int ioErr) {
@@ -356,27 +353,34 @@ int main(int argc, char *argv[])
         ShadowDeltaUpdatedSubscriptionRequest shadowDeltaUpdatedRequest;
         shadowDeltaUpdatedRequest.ThingName = thingName;
 
-        shadowClient.SubscribeToShadowDeltaUpdatedEvents(
-            shadowDeltaUpdatedRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onDeltaUpdated, onDeltaUpdatedSubAck);
-
         UpdateShadowSubscriptionRequest updateShadowSubscriptionRequest;
         updateShadowSubscriptionRequest.ThingName = thingName;
 
-        shadowClient.SubscribeToUpdateShadowAccepted(
-            updateShadowSubscriptionRequest,
-            AWS_MQTT_QOS_AT_LEAST_ONCE,
-            onUpdateShadowAccepted,
-            onDeltaUpdatedAcceptedSubAck);
-
-        shadowClient.SubscribeToUpdateShadowRejected(
-            updateShadowSubscriptionRequest,
-            AWS_MQTT_QOS_AT_LEAST_ONCE,
-            onUpdateShadowRejected,
-            onDeltaUpdatedRejectedSubAck);
-
-        subscribeDeltaCompletedPromise.get_future().wait();
-        subscribeDeltaAcceptedCompletedPromise.get_future().wait();
-        subscribeDeltaRejectedCompletedPromise.get_future().wait();
+        /*
+         * Batch the subscriptions so they go out as one SUBSCRIBE packet with a single SUBACK to wait for.
+         */
+        Aws::Iotdevicecommon::SubscriptionBatch subscriptions;
+        {
+            Aws::Iotdevicecommon::SubscriptionBatch::Capture capture(subscriptions);
+
+            shadowClient.SubscribeToShadowDeltaUpdatedEvents(
+                shadowDeltaUpdatedRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onDeltaUpdated, onDeltaUpdatedSubAck);
+
+            shadowClient.SubscribeToUpdateShadowAccepted(
+                updateShadowSubscriptionRequest,
+                AWS_MQTT_QOS_AT_LEAST_ONCE,
+                onUpdateShadowAccepted,
+                onDeltaUpdatedAcceptedSubAck);
+
+            shadowClient.SubscribeToUpdateShadowRejected(
+                updateShadowSubscriptionRequest,
+                AWS_MQTT_QOS_AT_LEAST_ONCE,
+                onUpdateShadowRejected,
+                onDeltaUpdatedRejectedSubAck);
+        }
+
+        subscriptions.Submit([&](int) { subscribeCompletedPromise.set_value(); });
+        subscribeCompletedPromise.get_future().wait();
 
         while (true)
         {
@@ -2,6 +2,9 @@ include(CMakeFindDependencyMacro)
 
 find_dependency(aws-crt-cpp)
 find_dependency(aws-c-iot)
+if (@AWS_SECURE_TUNNELING_ZLIB@)
+    find_dependency(ZLIB)
+endif()
 
 if (BUILD_SHARED_LIBS)
     include(${CMAKE_CURRENT_LIST_DIR}/shared/@PROJECT_NAME@-targets.cmake)
@@ -20,6 +20,7 @@
 #include <aws/crt/Types.h>
 
 #include <aws/crt/mqtt/MqttClient.h>
+#include <aws/iotdevicecommon/ServiceMetrics.h>
 
 namespace Aws
 {
@@ -48,9 +49,22 @@ namespace Aws
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToTunnelsNotifyResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToTunnelsNotify(
+                const Aws::Iotsecuretunneling::SubscribeToTunnelsNotifyRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToTunnelsNotifyResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Records the notifications of subscriptions made after this call into `metrics`, alongside the
+             * other service clients sharing it, so ServiceMetrics::GetProfile accounts for tunnel notifications
+             * too. Null, the default, records nothing.
+             */
+            void SetMetrics(const std::shared_ptr<Aws::Iotdevicecommon::ServiceMetrics> &metrics) noexcept;
 
           private:
             std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> m_connection;
+            std::shared_ptr<Aws::Iotdevicecommon::ServiceMetrics> m_metrics;
         };
 
     } // namespace Iotsecuretunneling
@@ -0,0 +1,201 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/LocalSocketRing.h>
+#include <aws/iotsecuretunneling/SecureTunnel.h>
+
+#include <aws/crt/io/EventLoopGroup.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+struct aws_socket;
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        class AWS_IOTSECURETUNNELING_API LocalProxyConfig final
+        {
+          public:
+            LocalProxyConfig() noexcept;
+            LocalProxyConfig(const LocalProxyConfig &rhs) = default;
+            LocalProxyConfig(LocalProxyConfig &&rhs) = default;
+
+            LocalProxyConfig &operator=(const LocalProxyConfig &rhs) = default;
+            LocalProxyConfig &operator=(LocalProxyConfig &&rhs) = default;
+
+            ~LocalProxyConfig() = default;
+
+            // Tunnel settings, as passed to SecureTunnel
+            Aws::Crt::Io::ClientBootstrap *ClientBootstrap;
+            Aws::Crt::Io::SocketOptions TunnelSocketOptions;
+            std::string AccessToken;
+            aws_secure_tunneling_local_proxy_mode LocalProxyMode;
+            std::string EndpointHost;
+            std::string RootCa;
+
+            /**
+             * Event loop group the local socket is driven from. Use the group behind ClientBootstrap, with a
+             * single thread, to keep the tunnel and the local socket on one event loop with no thread hops.
+             * Required.
+             */
+            Aws::Crt::Io::EventLoopGroup *EventLoopGroup;
+
+            /**
+             * One of EventLoopGroup's loops to pin the local socket to, for a host spreading many proxies over
+             * the group itself. Optional; by default the group hands out its next loop.
+             */
+            aws_event_loop *EventLoop;
+
+            /**
+             * The local endpoint. In destination mode the proxy connects to it when a stream starts; in source
+             * mode it listens on it and starts a stream for each accepted client.
+             */
+            Crt::String LocalHost;
+            uint16_t LocalPort;
+            Aws::Crt::Io::SocketOptions LocalSocketOptions;
+
+            /**
+             * Size of the buffer local reads are made into. Each read becomes one tunnel message.
+             */
+            size_t ReadBufferSize;
+
+            /**
+             * Local reads pause when this many bytes are queued towards the tunnel and resume once they drain
+             * to SendLowWatermark, so a fast local peer cannot grow the send queue without bound.
+             */
+            size_t SendHighWatermark;
+            size_t SendLowWatermark;
+
+            /**
+             * Drive the local socket through io_uring (see LocalSocketRing), which takes fewer system calls per
+             * megabyte on bulk transfers. Needs a build with USE_IO_URING on Linux; where io_uring is not
+             * available the regular socket path is used.
+             */
+            bool UseIoUring;
+
+            /**
+             * Tunes the proxy for interactive sessions such as SSH: TCP_NODELAY on the local connection, no send
+             * batching, and send watermarks capped at 64 KiB and 16 KiB. The tunnel carries one ordered byte
+             * stream, so a keystroke cannot overtake bulk data already queued; the small watermarks bound how
+             * much of it can be ahead. The tunnel's own socket belongs to the CRT websocket and keeps its options.
+             */
+            bool LowLatency;
+
+            /**
+             * Optional.
+             */
+            OnConnectionComplete OnTunnelConnectionComplete;
+            OnConnectionShutdown OnTunnelConnectionShutdown;
+        };
+
+        /**
+         * Bridges a local TCP port and a secure tunnel, so users do not have to write their own
+         * socket-to-tunnel pump. Local socket I/O runs on one CRT event loop; tunnel callbacks arriving on that
+         * loop are handled inline and the rest are handed over to it.
+         *
+         * Local reads are sent straight from the read buffer. Tunnel payloads are copied once, since the
+         * socket write outlives the OnDataReceive call. One stream is active at a time; in source mode
+         * further clients are refused while one is connected.
+         */
+        class AWS_IOTSECURETUNNELING_API LocalProxy final : public std::enable_shared_from_this<LocalProxy>
+        {
+          public:
+            LocalProxy(const LocalProxy &) = delete;
+            LocalProxy(LocalProxy &&) = delete;
+            LocalProxy &operator=(const LocalProxy &) = delete;
+            LocalProxy &operator=(LocalProxy &&) = delete;
+
+            ~LocalProxy();
+
+            /**
+             * Connects the tunnel and, in source mode, starts listening. The proxy keeps itself alive until
+             * Stop.
+             */
+            int Start();
+
+            /**
+             * Closes the tunnel and the local sockets.
+             */
+            void Stop();
+
+            SecureTunnel &GetTunnel() { return *m_tunnel; }
+
+            /**
+             * @return how long local data took to reach the tunnel service, from being sent on the tunnel to its
+             * OnSendDataComplete.
+             */
+            Iotdevicecommon::LatencyHistogram GetUpstreamLatency() const { return m_tunnel->GetSendLatency(); }
+
+            /**
+             * @return how long tunnel data took from arriving to being written to the local socket, or to being
+             * queued on the ring with UseIoUring.
+             */
+            Iotdevicecommon::LatencyHistogram GetDownstreamLatency() const;
+
+            static std::shared_ptr<LocalProxy> Create(
+                const LocalProxyConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct LocalWrite
+            {
+                Crt::Vector<uint8_t> Data;
+                /* When the tunnel delivered it, for the downstream latency. */
+                uint64_t ReceivedNs;
+            };
+
+            LocalProxy(const LocalProxyConfig &config, Crt::Allocator *allocator) noexcept;
+
+            /* Runs fn on the proxy's event loop, inline if already there. */
+            void Post(std::function<void()> &&fn);
+
+            // Everything below runs on m_eventLoop.
+            void OnStreamStart();
+            void OnStreamReset();
+            void OnDataReceive(Crt::Vector<uint8_t> &&data, uint64_t receivedNs);
+            void OnSendWatermark(bool aboveHighWatermark);
+
+            void ConnectLocal();
+            void AttachLocal(aws_socket *socket);
+            void CloseLocal(bool resetStream);
+            void ReadLocal();
+            void OnRingRead(int errorCode, const Crt::ByteCursor &data);
+            void WriteLocal(Crt::Vector<uint8_t> &&data, uint64_t receivedNs);
+            void RecordDownstream(uint64_t receivedNs);
+            void Shutdown();
+
+            static void s_onConnectResult(aws_socket *socket, int errorCode, void *userData);
+            static void s_onAcceptResult(aws_socket *listener, int errorCode, aws_socket *socket, void *userData);
+            static void s_onReadable(aws_socket *socket, int errorCode, void *userData);
+            static void s_onWriteComplete(aws_socket *socket, int errorCode, size_t bytesWritten, void *userData);
+
+            LocalProxyConfig m_config;
+            Crt::Allocator *m_allocator;
+            aws_event_loop *m_eventLoop;
+            std::shared_ptr<SecureTunnel> m_tunnel;
+            std::shared_ptr<LocalProxy> m_selfReference;
+
+            aws_socket *m_listener;
+            aws_socket *m_local;
+            bool m_localConnected;
+            bool m_readPaused;
+            Crt::ByteBuf m_readBuffer;
+            /* Set while the local connection is driven through io_uring, which then owns reads and writes. */
+            std::shared_ptr<LocalSocketRing> m_ring;
+            /* Written but not yet completed, oldest first; the socket reads straight from these. */
+            std::deque<LocalWrite> m_writes;
+            /* Tunnel data that arrived while the local connection was still being made. */
+            std::deque<LocalWrite> m_pendingWrites;
+
+            mutable std::mutex m_metricsLock;
+            Iotdevicecommon::LatencyHistogram m_downstreamLatency;
+        };
+    } // namespace Iotsecuretunneling
+} // namespace Aws
@@ -0,0 +1,167 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/Exports.h>
+
+#include <aws/common/task_scheduler.h>
+#include <aws/crt/Types.h>
+#include <aws/io/io.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+struct aws_event_loop;
+struct io_uring_cqe;
+struct io_uring_sqe;
+struct iovec;
+struct msghdr;
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        /**
+         * Invoked with each chunk read from the socket; the bytes are only valid during the call. `errorCode` is
+         * AWS_IO_SOCKET_CLOSED once the peer has closed its side.
+         */
+        using OnRingRead = std::function<void(int errorCode, const Crt::ByteCursor &data)>;
+
+        /**
+         * Invoked when a write fails; nothing more is written afterwards.
+         */
+        using OnRingWriteError = std::function<void(int errorCode)>;
+
+        /**
+         * Drives one connected local socket through io_uring, for LocalProxy on Linux. Reads go into a single
+         * buffer registered with the kernel, queued writes are gathered into one sendmsg, and everything queued
+         * during an event loop iteration is submitted with one system call. Completions are signalled through
+         * an eventfd watched by the CRT event loop, so the ring runs alongside the tunnel's own I/O.
+         *
+         * One read and one write are in flight at a time, which keeps the byte stream in order in both
+         * directions. Not thread-safe: create, use and release it on its event loop only.
+         *
+         * Available when built with USE_IO_URING on Linux and the kernel allows io_uring (containers often do
+         * not); see IsSupported.
+         */
+        class AWS_IOTSECURETUNNELING_API LocalSocketRing final : public std::enable_shared_from_this<LocalSocketRing>
+        {
+          public:
+            ~LocalSocketRing();
+
+            LocalSocketRing(const LocalSocketRing &) = delete;
+            LocalSocketRing(LocalSocketRing &&) = delete;
+            LocalSocketRing &operator=(const LocalSocketRing &) = delete;
+            LocalSocketRing &operator=(LocalSocketRing &&) = delete;
+
+            /**
+             * @return whether this build has io_uring support and the kernel lets the process set up a ring.
+             */
+            static bool IsSupported() noexcept;
+
+            /**
+             * Starts reading `fd`, a connected stream socket that stays owned by the caller. Call Close before
+             * closing it.
+             *
+             * @return the ring, or nullptr, with the error raised, if io_uring is unavailable or setting it up
+             * failed.
+             */
+            static std::shared_ptr<LocalSocketRing> Create(
+                aws_event_loop *eventLoop,
+                int fd,
+                size_t readBufferSize,
+                OnRingRead &&onRead,
+                OnRingWriteError &&onWriteError,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+            /**
+             * Stops reading from the socket until called again with false.
+             */
+            void SetReadPaused(bool paused);
+
+            /**
+             * Queues `data` to be written after everything queued before it.
+             */
+            void Write(Crt::Vector<uint8_t> &&data);
+
+            /**
+             * Shuts the socket down and drops whatever is still queued. No callback is invoked afterwards.
+             */
+            void Close();
+
+            /**
+             * @return the bytes queued for writing and not yet written.
+             */
+            size_t GetQueuedWriteBytes() const noexcept { return m_queuedWriteBytes; }
+
+          private:
+            LocalSocketRing(
+                aws_event_loop *eventLoop,
+                int fd,
+                OnRingRead &&onRead,
+                OnRingWriteError &&onWriteError,
+                Crt::Allocator *allocator) noexcept;
+
+            int Setup(size_t readBufferSize);
+            io_uring_sqe *NextSqe();
+            void ScheduleFlush();
+            void Flush();
+            void Reap();
+            void OnReadComplete(int result);
+            void OnWriteComplete(int result);
+
+            static void s_onFlushTask(aws_task *task, void *arg, aws_task_status status);
+            static void s_onEventFd(aws_event_loop *eventLoop, aws_io_handle *handle, int events, void *userData);
+
+            aws_event_loop *m_eventLoop;
+            Crt::Allocator *m_allocator;
+            int m_fd;
+            OnRingRead m_onRead;
+            OnRingWriteError m_onWriteError;
+
+            int m_ringFd;
+            int m_eventFd;
+            aws_io_handle m_eventHandle;
+            bool m_subscribed;
+
+            /* The shared submission and completion rings, mapped from the kernel. */
+            void *m_sqRing;
+            size_t m_sqRingSize;
+            void *m_cqRing;
+            size_t m_cqRingSize;
+            io_uring_sqe *m_sqes;
+            size_t m_sqesSize;
+            uint32_t *m_sqHead;
+            uint32_t *m_sqTail;
+            uint32_t *m_sqArray;
+            uint32_t m_sqMask;
+            uint32_t m_sqEntries;
+            uint32_t *m_cqHead;
+            uint32_t *m_cqTail;
+            io_uring_cqe *m_cqes;
+            uint32_t m_cqMask;
+            /* Submission entries queued but not yet passed to the kernel, and requests it has not completed. */
+            uint32_t m_unsubmitted;
+            uint32_t m_inFlight;
+
+            Crt::ByteBuf m_readBuffer;
+            bool m_readInFlight;
+            bool m_readPaused;
+
+            /* Oldest first. The front ones are being written; m_writeOffset bytes of the first already are. */
+            std::deque<Crt::Vector<uint8_t>> m_writes;
+            size_t m_writeOffset;
+            size_t m_queuedWriteBytes;
+            iovec *m_iovecs;
+            msghdr *m_message;
+            bool m_writeInFlight;
+
+            aws_task m_flushTask;
+            bool m_flushScheduled;
+            bool m_closed;
+        };
+    } // namespace Iotsecuretunneling
+} // namespace Aws
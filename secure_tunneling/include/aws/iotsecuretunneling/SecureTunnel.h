@@ -4,10 +4,20 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 
+#include <aws/common/task_scheduler.h>
 #include <aws/crt/io/Bootstrap.h>
 #include <aws/crt/io/SocketOptions.h>
 #include <aws/iotdevice/secure_tunneling.h>
+#include <aws/iotdevicecommon/ServiceMetrics.h>
 #include <aws/iotsecuretunneling/Exports.h>
+#include <aws/iotsecuretunneling/TunnelCompression.h>
+#include <aws/iotsecuretunneling/TunnelFrameBufferPool.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
 
 namespace Aws
 {
@@ -17,8 +27,18 @@ namespace Aws
         using OnConnectionComplete = std::function<void(void)>;
         using OnConnectionShutdown = std::function<void(void)>;
         using OnSendDataComplete = std::function<void(int errorCode)>;
+        /**
+         * `data` is the payload buffer of the tunnel message itself, lent for the duration of the call; no copy
+         * is made on the way to the handler. Forward it directly (e.g. write it to the local socket) and copy
+         * only what must outlive the call, since the buffer is released as soon as the handler returns.
+         */
         using OnDataReceive = std::function<void(const Crt::ByteBuf &data)>;
         using OnStreamStart = std::function<void()>;
+        /**
+         * Invoked with true when the queued send bytes reach the high watermark, so the producer should pause,
+         * and with false once they drain to the low watermark, so it can resume.
+         */
+        using OnSendWatermark = std::function<void(bool aboveHighWatermark)>;
         using OnStreamReset = std::function<void(void)>;
         using OnSessionReset = std::function<void(void)>;
 
@@ -57,13 +77,183 @@ namespace Aws
 
             int SendData(const Crt::ByteCursor &data);
 
+            /**
+             * Sends the cursors, in order, as a single tunnel message, so a burst of small packets costs one
+             * frame and one OnSendDataComplete instead of one per packet.
+             */
+            int SendData(const Crt::Vector<Crt::ByteCursor> &data);
+
+            /**
+             * Enables Nagle-like batching of SendData. While an earlier send is still waiting for its
+             * OnSendDataComplete, writes smaller than thresholdBytes are held back and coalesced; the batch
+             * is sent once a send completes or it grows to thresholdBytes. Data is never reordered. With
+             * batching on, several SendData calls may share one OnSendDataComplete. Zero, the default,
+             * disables batching, and any held-back data is sent straight away.
+             */
+            int SetSendBatchThreshold(size_t thresholdBytes);
+
+            /**
+             * @return the bytes accepted by SendData that have not completed yet, whether held back for
+             * batching or handed to the tunnel.
+             */
+            size_t GetQueuedBytes() const;
+
+            /**
+             * @return the tunnel frames sent that have not completed yet.
+             */
+            size_t GetInFlightFrames() const;
+
+            /**
+             * @return how long sent frames took from being handed to the tunnel to their OnSendDataComplete,
+             * one sample per frame that went out. Data held back for batching or replay is timed from when it
+             * actually goes out.
+             */
+            Iotdevicecommon::LatencyHistogram GetSendLatency() const;
+
+            /**
+             * @return the payload bytes sent and completed, and received, since the tunnel was created, as carried
+             * by the tunnel, i.e. after compression. Data the tunnel sends for its own framing is not counted.
+             */
+            uint64_t GetBytesSent() const;
+            uint64_t GetBytesReceived() const;
+
+            /**
+             * Reports, through onSendWatermark, when the queued bytes reach highWatermarkBytes and when
+             * they next fall to lowWatermarkBytes, so a reader forwarding into the tunnel can pause and resume
+             * without polling. Zero for highWatermarkBytes disables the notifications.
+             */
+            void SetSendWatermarks(
+                size_t highWatermarkBytes,
+                size_t lowWatermarkBytes,
+                const OnSendWatermark &onSendWatermark);
+
+            /**
+             * Reconnects the tunnel on its own when the websocket drops without Close() having been called.
+             * Attempts are spaced by a random delay of up to min(maxBackoffMs, minBackoffMs * 2^attempt), so
+             * a fleet losing the same cell does not reconnect in lockstep. OnConnectionShutdown and
+             * OnConnectionComplete are still invoked for every drop and reconnect.
+             *
+             * With replayBufferBytes nonzero, up to that many bytes of sent data are kept until they are
+             * written, and data that failed to go out when the connection dropped, or was sent while
+             * reconnecting, is sent again once reconnected; its failed OnSendDataComplete is not reported.
+             * The replay is dropped if the stream or session is reset in the meantime, since the peer has
+             * then discarded the stream it belonged to, and SendData fails once the buffer is full.
+             *
+             * A minBackoffMs of zero, the default, disables reconnecting. Requires the client bootstrap.
+             */
+            int SetReconnectPolicy(uint32_t minBackoffMs, uint32_t maxBackoffMs, size_t replayBufferBytes);
+
+            /**
+             * Detects a network path that died without a FIN or RST in seconds instead of at the end of TCP's
+             * own retransmission timeouts. The tunnel socket sends TCP keep-alives after intervalMs idle, every
+             * intervalMs, and gives up once timeoutMs of them went unanswered; while connected, a check every
+             * intervalMs closes the connection once sent data has made no progress for timeoutMs. Either
+             * drop is then handled like any other, so with a reconnect policy the tunnel comes back on its own.
+             *
+             * aws-c-iot owns the websocket and does not surface its pongs, hence TCP keep-alives rather than
+             * websocket pings. Keep-alives are rounded up to whole seconds, and take effect from the next
+             * connect. An intervalMs of zero, the default, disables both. Requires the client bootstrap.
+             */
+            int SetKeepAlive(uint32_t intervalMs, uint32_t timeoutMs);
+
+            /**
+             * Runs the tunnel's reconnect attempts on `eventLoop`, one of the client bootstrap's group, e.g. a
+             * loop an Iotdevicecommon::EventLoopLayout set aside for tunnels. The websocket itself is placed by
+             * the bootstrap, so create the tunnel with the layout's tunnel bootstrap to keep it on those loops.
+             * Null, the default, takes the group's next loop for each attempt.
+             */
+            int SetEventLoop(aws_event_loop *eventLoop);
+
+            /**
+             * Compresses the data of each stream with zlib at `level` (1 to 9, 0 turns compression off) and a
+             * deflate window of 2^windowBits bytes (9 to 15). Takes effect from the next stream start, on this
+             * end's SendStreamStart or the peer's.
+             *
+             * The stream is then framed so the two ends can agree on compression, which only a peer running this
+             * SDK with compression on understands: enable it at both ends or at neither. Each end deflates only
+             * once the other has said it can inflate, so a build without USE_TUNNEL_COMPRESSION still talks to
+             * one with it, uncompressed. Queued byte counts and watermarks then count the bytes after encoding.
+             */
+            int SetCompression(int level, int windowBits);
+
+            /**
+             * Sets how many bytes of idle buffers the tunnel keeps to copy sent data for replay into, so a
+             * steady stream of sends reuses them instead of allocating for each one. Defaults to 256 KiB;
+             * zero frees the buffers as soon as their data completes.
+             */
+            int SetFrameBufferPoolCapacity(size_t capacityBytes);
+
+            /**
+             * @return the number of replay buffers allocated since the tunnel was created; it stops growing once
+             * the pool has warmed up to the tunnel's send pattern.
+             */
+            uint64_t GetFrameBufferAllocationCount() const;
+
+            /**
+             * @return whether the current stream's outgoing data is being compressed.
+             */
+            bool IsSendCompressed() const;
+
+            /**
+             * Starts a new stream, replacing the current one. The tunnel protocol spoken by aws-c-iot carries a
+             * single stream id per tunnel, so concurrent forwarded connections each need their own tunnel.
+             */
             int SendStreamStart();
 
+            /**
+             * Resets the current stream.
+             */
             int SendStreamReset();
 
             aws_secure_tunnel *GetUnderlyingHandle();
 
           private:
+            struct InFlightSend
+            {
+                size_t Bytes;
+                size_t Frames;
+                /* Sent by the tunnel itself, so its completion is not reported. */
+                bool Internal;
+                uint64_t SentNs;
+                /* Copy of the payload, from DataOffset on not yet written, kept for replay when Retained. */
+                bool Retained;
+                /* From m_framePool, returned to it once the last frame completes. */
+                Crt::ByteBuf Data;
+                size_t DataOffset;
+            };
+
+            /* Outlives the tunnel, so reconnect and keep-alive tasks still queued can tell it is gone. */
+            struct ReconnectShared
+            {
+                std::mutex Lock;
+                SecureTunnel *Tunnel;
+            };
+            struct ReconnectTask;
+
+            /* Requires m_sendLock. Sends the held-back batch followed by data. */
+            int SendWithBatch(const Crt::ByteCursor *data, size_t count);
+            /* Requires m_sendLock. Encodes data for the stream if it is compressed. */
+            int SendEncoded(const Crt::ByteCursor &data);
+            /* Requires m_sendLock. */
+            int SendToTunnel(const Crt::ByteCursor &data, bool internal = false);
+            /* Requires m_sendLock. Sets up compression for a stream that just started and sends the offer. */
+            int StartCompressedStream();
+            /* Requires m_sendLock. Returns true if the queued bytes just crossed a watermark. */
+            bool UpdateWatermark();
+            void NotifyWatermark(bool aboveHighWatermark);
+            /* Requires m_sendLock. */
+            void ScheduleReconnect(uint64_t minDelayMs);
+            /* Requires m_sendLock. */
+            void DiscardReplay();
+            void Reconnect(uint64_t generation);
+            static void s_OnReconnectTask(aws_task *task, void *arg, aws_task_status status);
+            /* Requires m_sendLock. */
+            void ScheduleKeepAlive();
+            /* Requires m_sendLock. Picks the loop reconnects and keep-alive checks run on. */
+            aws_event_loop *GetTaskEventLoop();
+            void CheckKeepAlive(uint64_t generation);
+            static void s_OnKeepAliveTask(aws_task *task, void *arg, aws_task_status status);
+
             // aws-c-iot callbacks
             static void s_OnConnectionComplete(void *user_data);
             static void s_OnConnectionShutdown(void *user_data);
@@ -87,7 +277,60 @@ namespace Aws
             std::string m_endpointHost;
             std::string m_rootCa;
 
+            Crt::Allocator *m_allocator;
+            aws_client_bootstrap *m_bootstrap;
             aws_secure_tunnel *m_secure_tunnel;
+            aws_event_loop *m_eventLoop;
+
+            mutable std::mutex m_sendLock;
+            size_t m_sendBatchThreshold;
+            Crt::Vector<uint8_t> m_sendBatch;
+            std::deque<InFlightSend> m_inFlight;
+            size_t m_inFlightBytes;
+            size_t m_inFlightFrames;
+            Iotdevicecommon::LatencyHistogram m_sendLatency;
+            uint64_t m_bytesSent;
+            uint64_t m_bytesReceived;
+            std::shared_ptr<TunnelFrameBufferPool> m_framePool;
+
+            size_t m_highWatermark;
+            size_t m_lowWatermark;
+            bool m_aboveHighWatermark;
+            OnSendWatermark m_OnSendWatermark;
+
+            // Reconnect state, also guarded by m_sendLock
+            uint32_t m_reconnectMinBackoffMs;
+            uint32_t m_reconnectMaxBackoffMs;
+            uint32_t m_reconnectAttempts;
+            /* Bumped on every connect and drop, so retries queued for an earlier drop stand down. */
+            uint64_t m_reconnectGeneration;
+            bool m_connected;
+            bool m_closed;
+            bool m_reconnecting;
+            std::shared_ptr<ReconnectShared> m_reconnectShared;
+
+            // Keep-alive state, also guarded by m_sendLock
+            uint32_t m_keepAliveIntervalMs;
+            uint32_t m_keepAliveTimeoutMs;
+            bool m_keepAliveScheduled;
+            /* When sent data last made progress: went out with none in flight, or had a frame complete. */
+            uint64_t m_lastSendProgressNs;
+
+            size_t m_replayLimit;
+            /* Bytes held for replay, whether still in flight or in m_replay. */
+            size_t m_retainedBytes;
+            /* Data to send again once reconnected, oldest first. */
+            Crt::Vector<uint8_t> m_replay;
+            /* Set when unretained data failed to go out, which leaves a gap the replay cannot fill. */
+            bool m_replayBroken;
+
+            // Compression, also guarded by m_sendLock
+            int m_compressionLevel;
+            int m_compressionWindowBits;
+            /* Set for a stream started with compression on; the decoder is used outside the lock. */
+            std::shared_ptr<TunnelStreamEncoder> m_encoder;
+            std::shared_ptr<TunnelStreamDecoder> m_decoder;
+            Crt::Vector<uint8_t> m_encoded;
         };
     } // namespace Iotsecuretunneling
 } // namespace Aws
@@ -0,0 +1,122 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/LocalProxy.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        class AWS_IOTSECURETUNNELING_API SecureTunnelHostConfig final
+        {
+          public:
+            SecureTunnelHostConfig() noexcept;
+            SecureTunnelHostConfig(const SecureTunnelHostConfig &rhs) = default;
+            SecureTunnelHostConfig(SecureTunnelHostConfig &&rhs) = default;
+
+            SecureTunnelHostConfig &operator=(const SecureTunnelHostConfig &rhs) = default;
+            SecureTunnelHostConfig &operator=(SecureTunnelHostConfig &&rhs) = default;
+
+            ~SecureTunnelHostConfig() = default;
+
+            /**
+             * Shared by every tunnel the host opens, as in LocalProxyConfig.
+             * Required.
+             */
+            Aws::Crt::Io::ClientBootstrap *ClientBootstrap;
+            Aws::Crt::Io::EventLoopGroup *EventLoopGroup;
+            Aws::Crt::Io::SocketOptions TunnelSocketOptions;
+            std::string RootCa;
+        };
+
+        /**
+         * What the tunnels of a host have done, summed over the tunnels open when it was taken.
+         */
+        struct AWS_IOTSECURETUNNELING_API SecureTunnelHostMetrics
+        {
+            SecureTunnelHostMetrics() noexcept;
+
+            size_t Tunnels;
+            /** Tunnels pinned to each loop of the host's event loop group, by loop index. */
+            Crt::Vector<size_t> TunnelsPerLoop;
+
+            uint64_t BytesSent;
+            uint64_t BytesReceived;
+            size_t QueuedBytes;
+
+            Iotdevicecommon::LatencyHistogram UpstreamLatency;
+            Iotdevicecommon::LatencyHistogram DownstreamLatency;
+        };
+
+        /**
+         * Runs many tunnels side by side, e.g. on a gateway forwarding to several devices, from one bootstrap,
+         * socket options and root CA. Each tunnel opened is a LocalProxy pinned to the loop of the event loop
+         * group with the fewest of the host's tunnels, so local socket work spreads evenly however the tunnels
+         * come and go, and GetMetrics() reports them as one.
+         *
+         * The tunnel's websocket is placed by ClientBootstrap, which already picks the less loaded of the
+         * group's loops, and aws-c-iot sets up TLS for each tunnel on its own.
+         */
+        class AWS_IOTSECURETUNNELING_API SecureTunnelHost final
+        {
+          public:
+            SecureTunnelHost(const SecureTunnelHost &) = delete;
+            SecureTunnelHost(SecureTunnelHost &&) = delete;
+            SecureTunnelHost &operator=(const SecureTunnelHost &) = delete;
+            SecureTunnelHost &operator=(SecureTunnelHost &&) = delete;
+
+            /**
+             * Stops every open tunnel.
+             */
+            ~SecureTunnelHost();
+
+            /**
+             * Opens and starts a tunnel. ClientBootstrap, EventLoopGroup, EventLoop, TunnelSocketOptions and
+             * RootCa are the host's; everything else comes from config.
+             *
+             * @return the started proxy, or null with the error raised.
+             */
+            std::shared_ptr<LocalProxy> Open(const LocalProxyConfig &config);
+
+            /**
+             * Stops a tunnel opened by this host and frees its loop slot.
+             */
+            void Close(const std::shared_ptr<LocalProxy> &proxy);
+
+            /**
+             * Stops every open tunnel.
+             */
+            void CloseAll();
+
+            size_t GetTunnelCount() const;
+
+            SecureTunnelHostMetrics GetMetrics() const;
+
+            static std::shared_ptr<SecureTunnelHost> Create(
+                const SecureTunnelHostConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct HostedTunnel
+            {
+                std::shared_ptr<LocalProxy> Proxy;
+                size_t Loop;
+            };
+
+            SecureTunnelHost(const SecureTunnelHostConfig &config, Crt::Allocator *allocator) noexcept;
+
+            SecureTunnelHostConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Vector<HostedTunnel> m_tunnels;
+            Crt::Vector<size_t> m_tunnelsPerLoop;
+        };
+    } // namespace Iotsecuretunneling
+} // namespace Aws
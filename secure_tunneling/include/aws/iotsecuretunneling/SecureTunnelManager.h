@@ -0,0 +1,147 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/IotSecureTunnelingClient.h>
+#include <aws/iotsecuretunneling/LocalProxy.h>
+#include <aws/iotsecuretunneling/SecureTunnelingNotifyResponse.h>
+
+#include <aws/crt/io/HostResolver.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        /**
+         * Invoked once a tunnel has been opened for a notification, or with null and an error code if it could
+         * not be. `notification` is only valid during the call.
+         */
+        using OnTunnelOpenComplete = std::function<void(
+            const std::shared_ptr<LocalProxy> &proxy,
+            const SecureTunnelingNotifyResponse &notification,
+            int errorCode)>;
+
+        class AWS_IOTSECURETUNNELING_API SecureTunnelManagerConfig final
+        {
+          public:
+            SecureTunnelManagerConfig() noexcept;
+            SecureTunnelManagerConfig(const SecureTunnelManagerConfig &rhs) = default;
+            SecureTunnelManagerConfig(SecureTunnelManagerConfig &&rhs) = default;
+
+            SecureTunnelManagerConfig &operator=(const SecureTunnelManagerConfig &rhs) = default;
+            SecureTunnelManagerConfig &operator=(SecureTunnelManagerConfig &&rhs) = default;
+
+            ~SecureTunnelManagerConfig() = default;
+
+            /**
+             * The MQTT connection tunnel notifications are received on, and the thing they are addressed to.
+             * Required.
+             */
+            std::shared_ptr<Crt::Mqtt::MqttConnection> Connection;
+            Crt::String ThingName;
+
+            /**
+             * Tunnel and local socket settings, as in LocalProxyConfig.
+             * Required.
+             */
+            Aws::Crt::Io::ClientBootstrap *ClientBootstrap;
+            Aws::Crt::Io::EventLoopGroup *EventLoopGroup;
+            Aws::Crt::Io::SocketOptions TunnelSocketOptions;
+            std::string RootCa;
+            Crt::String LocalHost;
+            Aws::Crt::Io::SocketOptions LocalSocketOptions;
+
+            /**
+             * Local port each requested service is forwarded to, keyed by service name, e.g. "SSH" to 22.
+             * Notifications for other services are ignored.
+             */
+            Crt::Map<Crt::String, uint16_t> ServicePorts;
+
+            /**
+             * The resolver behind ClientBootstrap and the region tunnels are expected in. When both are set,
+             * Start resolves the tunnel endpoint ahead of the first notification so its connect skips the DNS
+             * lookup. Optional.
+             */
+            Aws::Crt::Io::HostResolver *HostResolver;
+            Crt::Optional<Crt::String> Region;
+
+            /**
+             * With HostResolver set, how often the tunnel endpoints are resolved again between notifications, so
+             * the resolver keeps them cached however long the device waits for an operator. Endpoints of regions
+             * named by notifications are kept warm too. Defaults to 60; zero resolves each endpoint only once.
+             */
+            uint32_t PrewarmRefreshSeconds;
+
+            /**
+             * Optional.
+             */
+            OnTunnelOpenComplete OnTunnelOpened;
+        };
+
+        /**
+         * Opens destination tunnels as soon as their notifications arrive, instead of leaving each
+         * application to parse the notification and build a SecureTunnel by hand. Each notification is
+         * turned straight into a started LocalProxy forwarding to the service's local port, from the MQTT
+         * callback itself. A new notification for a service replaces that service's previous tunnel, whose
+         * access token the service has already revoked.
+         */
+        class AWS_IOTSECURETUNNELING_API SecureTunnelManager final
+            : public std::enable_shared_from_this<SecureTunnelManager>
+        {
+          public:
+            SecureTunnelManager(const SecureTunnelManager &) = delete;
+            SecureTunnelManager(SecureTunnelManager &&) = delete;
+            SecureTunnelManager &operator=(const SecureTunnelManager &) = delete;
+            SecureTunnelManager &operator=(SecureTunnelManager &&) = delete;
+
+            ~SecureTunnelManager() = default;
+
+            /**
+             * Subscribes to the thing's tunnel notifications and pre-resolves the tunnel endpoint.
+             *
+             * @return false if the subscribe could not be sent.
+             */
+            bool Start(const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Stops every tunnel opened so far. Notifications still arriving are ignored.
+             */
+            void Stop();
+
+            /**
+             * @return the tunnel endpoint for region, e.g. data.tunneling.iot.us-east-1.amazonaws.com.
+             */
+            static Crt::String GetTunnelEndpoint(const Crt::String &region);
+
+            static std::shared_ptr<SecureTunnelManager> Create(
+                const SecureTunnelManagerConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct PrewarmTask;
+
+            SecureTunnelManager(const SecureTunnelManagerConfig &config, Crt::Allocator *allocator) noexcept;
+
+            void OnNotify(const SecureTunnelingNotifyResponse &notification);
+            /* Resolves host now and, with refreshing on, from then on. */
+            void AddPrewarmHost(const Crt::String &host);
+            void Prewarm(const Crt::String &host);
+            void SchedulePrewarm();
+            static void s_OnPrewarmTask(aws_task *task, void *arg, aws_task_status status);
+
+            SecureTunnelManagerConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            std::mutex m_lock;
+            bool m_stopped;
+            Crt::Map<Crt::String, std::shared_ptr<LocalProxy>> m_proxies;
+            Crt::Vector<Crt::String> m_prewarmHosts;
+            bool m_prewarmScheduled;
+        };
+    } // namespace Iotsecuretunneling
+} // namespace Aws
@@ -0,0 +1,147 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/Exports.h>
+
+#include <aws/crt/Types.h>
+
+#include <functional>
+
+struct z_stream_s;
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        /**
+         * Invoked with each piece of data a TunnelStreamDecoder decodes; the bytes are only valid during the call.
+         */
+        using OnDecodedData = std::function<void(const Crt::ByteCursor &data)>;
+
+        /**
+         * Encodes the data one end of a tunnel stream sends while SecureTunnel compression is on. The stream
+         * becomes a sequence of records, each a tag byte and a varint length followed by that many bytes, so a
+         * record may span tunnel messages: the split aws-c-iot applies to large payloads and the replay after a
+         * reconnect both keep working.
+         *
+         * Each end opens a stream with an offer record naming the largest deflate window it inflates, zero
+         * when built without zlib. Data is sent in raw records until the peer's offer arrives, and deflated after
+         * that, with one deflate history for the whole stream and a sync flush after every write. Writes shorter
+         * than minCompressBytes stay raw records, which both ends keep out of the deflate history.
+         */
+        class AWS_IOTSECURETUNNELING_API TunnelStreamEncoder final
+        {
+          public:
+            /**
+             * @param level zlib compression level, 1 (fastest) to 9 (smallest).
+             * @param windowBits log2 of the deflate window, 9 to 15; smaller windows use less memory at both ends.
+             * @param minCompressBytes writes shorter than this are sent uncompressed.
+             */
+            TunnelStreamEncoder(
+                int level,
+                int windowBits,
+                size_t minCompressBytes,
+                Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+            ~TunnelStreamEncoder();
+
+            TunnelStreamEncoder(const TunnelStreamEncoder &) = delete;
+            TunnelStreamEncoder(TunnelStreamEncoder &&) = delete;
+            TunnelStreamEncoder &operator=(const TunnelStreamEncoder &) = delete;
+            TunnelStreamEncoder &operator=(TunnelStreamEncoder &&) = delete;
+
+            /**
+             * @return whether this build can deflate and inflate, i.e. was built with USE_TUNNEL_COMPRESSION.
+             */
+            static bool IsDeflateSupported() noexcept;
+
+            /**
+             * Appends this end's offer to `out`. Send it before any data on a new stream.
+             */
+            void AppendOffer(Crt::Vector<uint8_t> &out) const;
+
+            /**
+             * Records the peer's offer; from now on data is deflated, with a window no larger than the peer
+             * inflates, if both ends can.
+             */
+            void OnPeerOffer(int peerWindowBits) noexcept;
+
+            /**
+             * Appends `data`, framed and compressed if negotiated, to `out`.
+             *
+             * @return AWS_OP_SUCCESS, or AWS_OP_ERR with AWS_ERROR_INVALID_STATE raised if deflating failed.
+             */
+            int Append(const Crt::ByteCursor &data, Crt::Vector<uint8_t> &out);
+
+            /**
+             * @return whether data is being deflated.
+             */
+            bool IsCompressing() const noexcept { return m_deflate != nullptr; }
+
+            /**
+             * @return the data bytes appended, and the bytes they were encoded to.
+             */
+            uint64_t GetBytesIn() const noexcept { return m_bytesIn; }
+            uint64_t GetBytesOut() const noexcept { return m_bytesOut; }
+
+          private:
+            Crt::Allocator *m_allocator;
+            int m_level;
+            int m_windowBits;
+            size_t m_minCompressBytes;
+            z_stream_s *m_deflate;
+            Crt::Vector<uint8_t> m_scratch;
+            uint64_t m_bytesIn;
+            uint64_t m_bytesOut;
+        };
+
+        /**
+         * Decodes what the peer's TunnelStreamEncoder produced, one tunnel message at a time, in the order the
+         * messages arrived. Raw records are lent straight from the message; deflated ones are inflated through a
+         * small buffer.
+         */
+        class AWS_IOTSECURETUNNELING_API TunnelStreamDecoder final
+        {
+          public:
+            /**
+             * @param windowBits the window this end offered, which bounds what the peer may deflate with.
+             */
+            explicit TunnelStreamDecoder(int windowBits, Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+            ~TunnelStreamDecoder();
+
+            TunnelStreamDecoder(const TunnelStreamDecoder &) = delete;
+            TunnelStreamDecoder(TunnelStreamDecoder &&) = delete;
+            TunnelStreamDecoder &operator=(const TunnelStreamDecoder &) = delete;
+            TunnelStreamDecoder &operator=(TunnelStreamDecoder &&) = delete;
+
+            /**
+             * Decodes `message`, calling onData with the stream data it carries.
+             *
+             * @param peerWindowBits set to the window of an offer found in the message, otherwise left unchanged.
+             * @return AWS_OP_SUCCESS, or AWS_OP_ERR with AWS_ERROR_INVALID_ARGUMENT raised if the stream is corrupt
+             * and AWS_ERROR_OOM if inflating could not start. Every later call then fails with
+             * AWS_ERROR_INVALID_STATE.
+             */
+            int Decode(const Crt::ByteCursor &message, int &peerWindowBits, const OnDecodedData &onData);
+
+          private:
+            int DecodeDeflated(const Crt::ByteCursor &data, const OnDecodedData &onData);
+
+            Crt::Allocator *m_allocator;
+            int m_windowBits;
+            z_stream_s *m_inflate;
+            Crt::Vector<uint8_t> m_output;
+
+            /* The record being decoded: its header while m_inHeader, then its payload. */
+            bool m_inHeader;
+            bool m_failed;
+            uint8_t m_tag;
+            uint32_t m_length;
+            uint32_t m_lengthShift;
+            size_t m_headerBytes;
+            uint32_t m_remaining;
+        };
+    } // namespace Iotsecuretunneling
+} // namespace Aws
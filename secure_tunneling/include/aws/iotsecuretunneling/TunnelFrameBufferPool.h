@@ -0,0 +1,84 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/Exports.h>
+
+#include <aws/crt/Types.h>
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        /**
+         * Free lists of frame buffers in power-of-two size classes, from MinClassBytes to MaxClassBytes, so a
+         * tunnel copying sent frames (e.g. to replay them after a reconnect) reuses a buffer of the right size
+         * for every frame once warmed up instead of allocating one.
+         *
+         * Idle buffers are kept up to a total capacity and freed beyond it; requests larger than MaxClassBytes
+         * are allocated to size and never pooled. Not synchronized: SecureTunnel uses its pool under its send
+         * lock.
+         */
+        class AWS_IOTSECURETUNNELING_API TunnelFrameBufferPool final
+        {
+          public:
+            static const size_t MinClassBytes = 1024;
+            static const size_t MaxClassBytes = 64 * 1024;
+
+            /**
+             * @param capacityBytes the most idle buffer bytes kept for reuse. Zero disables pooling.
+             */
+            explicit TunnelFrameBufferPool(
+                size_t capacityBytes,
+                Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+            ~TunnelFrameBufferPool();
+
+            TunnelFrameBufferPool(const TunnelFrameBufferPool &) = delete;
+            TunnelFrameBufferPool(TunnelFrameBufferPool &&) = delete;
+            TunnelFrameBufferPool &operator=(const TunnelFrameBufferPool &) = delete;
+            TunnelFrameBufferPool &operator=(TunnelFrameBufferPool &&) = delete;
+
+            /**
+             * Returns an empty buffer with room for at least `bytes`. On allocation failure the returned buffer
+             * has a null `allocator`.
+             */
+            Crt::ByteBuf Acquire(size_t bytes) noexcept;
+
+            /**
+             * Returns a buffer obtained from Acquire to its size class, or frees it if the pool is full. Leaves
+             * `buffer` empty.
+             */
+            void Release(Crt::ByteBuf &buffer) noexcept;
+
+            /**
+             * Changes the capacity, freeing idle buffers beyond it.
+             */
+            void SetCapacity(size_t capacityBytes) noexcept;
+
+            /**
+             * @return the bytes of the idle buffers held for reuse.
+             */
+            size_t GetPooledBytes() const noexcept { return m_pooledBytes; }
+
+            /**
+             * @return the number of buffers Acquire had to allocate, over the pool's life.
+             */
+            uint64_t GetAllocationCount() const noexcept { return m_allocations; }
+
+          private:
+            static const size_t ClassCount = 7;
+
+            /* The size class for `bytes`, or ClassCount if too large for any. */
+            static size_t ClassOf(size_t bytes) noexcept;
+            void Trim() noexcept;
+
+            Crt::Allocator *m_allocator;
+            size_t m_capacityBytes;
+            size_t m_pooledBytes;
+            uint64_t m_allocations;
+            Crt::Vector<Crt::ByteBuf> m_free[ClassCount];
+        };
+    } // namespace Iotsecuretunneling
+} // namespace Aws
@@ -15,6 +15,9 @@
 */
 #include <aws/iotsecuretunneling/IotSecureTunnelingClient.h>
 
+#include <aws/common/clock.h>
+#include <aws/iotdevicecommon/SubscriptionHandle.h>
+
 #include <aws/iotsecuretunneling/SecureTunnelingNotifyResponse.h>
 #include <aws/iotsecuretunneling/SubscribeToTunnelsNotifyRequest.h>
 
@@ -29,18 +32,64 @@ namespace Aws
         {
         }
 
+        namespace
+        {
+            void s_handleNotify(
+                const OnSubscribeToTunnelsNotifyResponse &handler,
+                Aws::Crt::String &payloadScratch,
+                const Aws::Crt::ByteBuf &payload)
+            {
+                Aws::Iotdevicecommon::ServiceMetrics::HandlerScope *scope =
+                    Aws::Iotdevicecommon::ServiceMetrics::HandlerScope::Current();
+                uint64_t parseStartNs = 0;
+                if (scope)
+                {
+                    aws_high_res_clock_get_ticks(&parseStartNs);
+                }
+
+                payloadScratch.assign(reinterpret_cast<char *>(payload.buffer), payload.len);
+                Aws::Crt::JsonObject jsonObject(payloadScratch);
+                Aws::Iotsecuretunneling::SecureTunnelingNotifyResponse response(jsonObject);
+
+                if (scope)
+                {
+                    uint64_t parseEndNs = 0;
+                    aws_high_res_clock_get_ticks(&parseEndNs);
+                    scope->AddParseTime(parseEndNs - parseStartNs);
+                }
+                handler(&response, AWS_ERROR_SUCCESS);
+            }
+        } // namespace
+
         IotSecureTunnelingClient::operator bool() const noexcept { return *m_connection; }
 
         int IotSecureTunnelingClient::GetLastError() const noexcept { return aws_last_error(); }
 
+        void IotSecureTunnelingClient::SetMetrics(
+            const std::shared_ptr<Aws::Iotdevicecommon::ServiceMetrics> &metrics) noexcept
+        {
+            m_metrics = metrics;
+        }
+
         bool IotSecureTunnelingClient::SubscribeToTunnelsNotify(
             const Aws::Iotsecuretunneling::SubscribeToTunnelsNotifyRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToTunnelsNotifyResponse &handler,
             const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToTunnelsNotify(request, qos, OnSubscribeToTunnelsNotifyResponse(handler), onSubAck);
+        }
+
+        bool IotSecureTunnelingClient::SubscribeToTunnelsNotify(
+            const Aws::Iotsecuretunneling::SubscribeToTunnelsNotifyRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToTunnelsNotifyResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToTunnelsNotifyResponse>(
+                Aws::Crt::DefaultAllocator(), std::move(handler));
+            auto onSubscribeComplete = [sharedHandler, onSubAck](
                                            Aws::Crt::Mqtt::MqttConnection &,
                                            uint16_t,
                                            const Aws::Crt::String &topic,
@@ -49,7 +98,7 @@ namespace Aws
                 (void)topic;
                 if (errorCode)
                 {
-                    handler(nullptr, errorCode);
+                    (*sharedHandler)(nullptr, errorCode);
                 }
 
                 if (onSubAck)
@@ -58,26 +107,29 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotsecuretunneling::SecureTunnelingNotifyResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "tunnels"
-                               << "/"
-                               << "notify";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
+            Aws::Crt::String payloadScratch;
+            std::shared_ptr<Aws::Iotdevicecommon::ServiceMetrics> metrics = m_metrics;
+            auto onSubscribePublish = [sharedHandler, payloadScratch, metrics](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &topic,
+                                          const Aws::Crt::ByteBuf &payload) mutable {
+                if (metrics)
+                {
+                    Aws::Iotdevicecommon::ServiceMetrics::HandlerScope handlerScope(*metrics, topic, payload.len);
+                    s_handleNotify(*sharedHandler, payloadScratch, payload);
+                }
+                else
+                {
+                    s_handleNotify(*sharedHandler, payloadScratch, payload);
+                }
+            };
+
+            Aws::Crt::String subscribeTopic("$aws/things/");
+            subscribeTopic.append(*request.ThingName).append("/tunnels/notify");
+
+            return Aws::Iotdevicecommon::SubscribeWithHandle(
+                       m_connection,
+                       subscribeTopic.c_str(),
                        qos,
                        std::move(onSubscribePublish),
                        std::move(onSubscribeComplete)) != 0;
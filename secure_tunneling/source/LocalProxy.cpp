@@ -0,0 +1,582 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/LocalProxy.h>
+
+#include <aws/common/clock.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/io.h>
+#include <aws/io/socket.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+#    include <winsock2.h>
+#else
+#    include <netinet/in.h>
+#    include <netinet/tcp.h>
+#    include <sys/socket.h>
+#endif
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        namespace
+        {
+            struct ProxyTask
+            {
+                aws_task Task;
+                std::function<void()> Fn;
+                Crt::Allocator *Allocator;
+            };
+
+            void s_runProxyTask(aws_task *, void *arg, aws_task_status status)
+            {
+                auto *proxyTask = static_cast<ProxyTask *>(arg);
+                if (status == AWS_TASK_STATUS_RUN_READY)
+                {
+                    proxyTask->Fn();
+                }
+
+                Crt::Delete(proxyTask, proxyTask->Allocator);
+            }
+
+            void s_releaseSocket(aws_socket *socket)
+            {
+                Crt::Allocator *allocator = socket->allocator;
+                aws_socket_clean_up(socket);
+                aws_mem_release(allocator, socket);
+            }
+
+            /* The latency profile caps the send queue at these, so bulk data cannot pile up ahead of a keystroke. */
+            const size_t s_lowLatencyHighWatermark = 64 * 1024;
+            const size_t s_lowLatencyLowWatermark = 16 * 1024;
+
+            void s_setNoDelay(aws_socket *socket)
+            {
+                if (socket->options.domain == AWS_SOCKET_LOCAL)
+                {
+                    return;
+                }
+
+                /* Best effort: without it the connection still works, just with Nagle's delay. */
+                int noDelay = 1;
+#ifdef _WIN32
+                setsockopt(
+                    reinterpret_cast<SOCKET>(socket->io_handle.data.handle),
+                    IPPROTO_TCP,
+                    TCP_NODELAY,
+                    reinterpret_cast<const char *>(&noDelay),
+                    sizeof(noDelay));
+#else
+                setsockopt(socket->io_handle.data.fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+#endif
+            }
+        } // namespace
+
+        LocalProxyConfig::LocalProxyConfig() noexcept
+            : ClientBootstrap(nullptr), TunnelSocketOptions(), AccessToken(),
+              LocalProxyMode(AWS_SECURE_TUNNELING_DESTINATION_MODE), EndpointHost(), RootCa(),
+              EventLoopGroup(nullptr), EventLoop(nullptr), LocalHost("127.0.0.1"), LocalPort(0), LocalSocketOptions(),
+              ReadBufferSize(16 * 1024), SendHighWatermark(1024 * 1024), SendLowWatermark(256 * 1024),
+              UseIoUring(false), LowLatency(false), OnTunnelConnectionComplete(), OnTunnelConnectionShutdown()
+        {
+        }
+
+        LocalProxy::LocalProxy(const LocalProxyConfig &config, Crt::Allocator *allocator) noexcept
+            : m_config(config), m_allocator(allocator), m_eventLoop(nullptr), m_listener(nullptr), m_local(nullptr),
+              m_localConnected(false), m_readPaused(false)
+        {
+            AWS_FATAL_ASSERT(m_config.EventLoopGroup);
+            AWS_ZERO_STRUCT(m_readBuffer);
+
+            m_eventLoop = m_config.EventLoop ? m_config.EventLoop
+                                             : aws_event_loop_group_get_next_loop(
+                                                   m_config.EventLoopGroup->GetUnderlyingHandle());
+            aws_byte_buf_init(&m_readBuffer, allocator, m_config.ReadBufferSize);
+        }
+
+        LocalProxy::~LocalProxy() { aws_byte_buf_clean_up(&m_readBuffer); }
+
+        std::shared_ptr<LocalProxy> LocalProxy::Create(const LocalProxyConfig &config, Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<LocalProxy *>(aws_mem_acquire(allocator, sizeof(LocalProxy)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) LocalProxy(config, allocator);
+            std::shared_ptr<LocalProxy> proxy(
+                toSeat, [allocator](LocalProxy *doomed) { Crt::Delete(doomed, allocator); });
+
+            /* The tunnel is owned by the proxy, so its callbacks only hold the proxy weakly. */
+            std::weak_ptr<LocalProxy> weakProxy = proxy;
+            OnConnectionComplete onConnectionComplete = config.OnTunnelConnectionComplete;
+            OnConnectionShutdown onConnectionShutdown = config.OnTunnelConnectionShutdown;
+            proxy->m_tunnel = Crt::MakeShared<SecureTunnel>(
+                allocator,
+                allocator,
+                config.ClientBootstrap,
+                config.TunnelSocketOptions,
+                config.AccessToken,
+                config.LocalProxyMode,
+                config.EndpointHost,
+                config.RootCa,
+                [onConnectionComplete]() {
+                    if (onConnectionComplete)
+                    {
+                        onConnectionComplete();
+                    }
+                },
+                [onConnectionShutdown]() {
+                    if (onConnectionShutdown)
+                    {
+                        onConnectionShutdown();
+                    }
+                },
+                [](int) {},
+                [weakProxy, allocator](const Crt::ByteBuf &data) {
+                    auto self = weakProxy.lock();
+                    if (!self)
+                    {
+                        return;
+                    }
+
+                    uint64_t receivedNs = 0;
+                    aws_high_res_clock_get_ticks(&receivedNs);
+
+                    /* The payload is only lent for this call, and the socket write completes later. */
+                    auto chunk = Crt::MakeShared<Crt::Vector<uint8_t>>(allocator, data.buffer, data.buffer + data.len);
+                    self->Post([self, chunk, receivedNs]() { self->OnDataReceive(std::move(*chunk), receivedNs); });
+                },
+                [weakProxy]() {
+                    auto self = weakProxy.lock();
+                    if (self)
+                    {
+                        self->Post([self]() { self->OnStreamStart(); });
+                    }
+                },
+                [weakProxy]() {
+                    auto self = weakProxy.lock();
+                    if (self)
+                    {
+                        self->Post([self]() { self->OnStreamReset(); });
+                    }
+                },
+                [weakProxy]() {
+                    auto self = weakProxy.lock();
+                    if (self)
+                    {
+                        self->Post([self]() { self->OnStreamReset(); });
+                    }
+                });
+            if (!proxy->m_tunnel || !proxy->m_tunnel->GetUnderlyingHandle())
+            {
+                return nullptr;
+            }
+
+            size_t highWatermark = config.SendHighWatermark;
+            size_t lowWatermark = config.SendLowWatermark;
+            if (config.LowLatency)
+            {
+                highWatermark = std::min(highWatermark, s_lowLatencyHighWatermark);
+                lowWatermark = std::min(lowWatermark, s_lowLatencyLowWatermark);
+                proxy->m_tunnel->SetSendBatchThreshold(0);
+            }
+            proxy->m_tunnel->SetSendWatermarks(
+                highWatermark, lowWatermark, [weakProxy](bool aboveHighWatermark) {
+                    auto self = weakProxy.lock();
+                    if (self)
+                    {
+                        self->Post([self, aboveHighWatermark]() { self->OnSendWatermark(aboveHighWatermark); });
+                    }
+                });
+
+            return proxy;
+        }
+
+        Iotdevicecommon::LatencyHistogram LocalProxy::GetDownstreamLatency() const
+        {
+            std::lock_guard<std::mutex> guard(m_metricsLock);
+            return m_downstreamLatency;
+        }
+
+        int LocalProxy::Start()
+        {
+            if (m_readBuffer.capacity == 0)
+            {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+
+            if (m_config.LocalProxyMode == AWS_SECURE_TUNNELING_SOURCE_MODE)
+            {
+                aws_socket_endpoint endpoint;
+                AWS_ZERO_STRUCT(endpoint);
+                snprintf(endpoint.address, sizeof(endpoint.address), "%s", m_config.LocalHost.c_str());
+                endpoint.port = m_config.LocalPort;
+
+                auto *listener = static_cast<aws_socket *>(aws_mem_acquire(m_allocator, sizeof(aws_socket)));
+                if (!listener)
+                {
+                    return AWS_OP_ERR;
+                }
+                if (aws_socket_init(listener, m_allocator, &m_config.LocalSocketOptions.GetImpl()))
+                {
+                    aws_mem_release(m_allocator, listener);
+                    return AWS_OP_ERR;
+                }
+                if (aws_socket_bind(listener, &endpoint) || aws_socket_listen(listener, 8) ||
+                    aws_socket_start_accept(listener, m_eventLoop, s_onAcceptResult, this))
+                {
+                    s_releaseSocket(listener);
+                    return AWS_OP_ERR;
+                }
+                m_listener = listener;
+            }
+
+            m_selfReference = shared_from_this();
+            if (m_tunnel->Connect())
+            {
+                int errorCode = aws_last_error();
+                Stop();
+                return aws_raise_error(errorCode);
+            }
+
+            return AWS_OP_SUCCESS;
+        }
+
+        void LocalProxy::Stop()
+        {
+            m_tunnel->Close();
+
+            auto self = shared_from_this();
+            Post([self]() { self->Shutdown(); });
+        }
+
+        void LocalProxy::Post(std::function<void()> &&fn)
+        {
+            if (aws_event_loop_thread_is_callers_thread(m_eventLoop))
+            {
+                fn();
+                return;
+            }
+
+            auto *proxyTask = Crt::New<ProxyTask>(m_allocator);
+            if (!proxyTask)
+            {
+                return;
+            }
+
+            proxyTask->Fn = std::move(fn);
+            proxyTask->Allocator = m_allocator;
+            aws_task_init(&proxyTask->Task, s_runProxyTask, proxyTask, "SecureTunnelLocalProxy");
+            aws_event_loop_schedule_task_now(m_eventLoop, &proxyTask->Task);
+        }
+
+        void LocalProxy::OnStreamStart()
+        {
+            if (m_config.LocalProxyMode == AWS_SECURE_TUNNELING_DESTINATION_MODE)
+            {
+                /* A new stream replaces the current one. */
+                CloseLocal(false);
+                ConnectLocal();
+            }
+        }
+
+        void LocalProxy::OnStreamReset() { CloseLocal(false); }
+
+        void LocalProxy::OnDataReceive(Crt::Vector<uint8_t> &&data, uint64_t receivedNs)
+        {
+            if (!m_local)
+            {
+                return;
+            }
+
+            if (!m_localConnected)
+            {
+                m_pendingWrites.push_back(LocalWrite{std::move(data), receivedNs});
+                return;
+            }
+
+            WriteLocal(std::move(data), receivedNs);
+        }
+
+        void LocalProxy::OnSendWatermark(bool aboveHighWatermark)
+        {
+            m_readPaused = aboveHighWatermark;
+            if (m_ring)
+            {
+                m_ring->SetReadPaused(aboveHighWatermark);
+            }
+            else if (!aboveHighWatermark)
+            {
+                /* Readable events are edge triggered, so data that arrived while paused must be read now. */
+                ReadLocal();
+            }
+        }
+
+        void LocalProxy::ConnectLocal()
+        {
+            aws_socket_endpoint endpoint;
+            AWS_ZERO_STRUCT(endpoint);
+            snprintf(endpoint.address, sizeof(endpoint.address), "%s", m_config.LocalHost.c_str());
+            endpoint.port = m_config.LocalPort;
+
+            auto *socket = static_cast<aws_socket *>(aws_mem_acquire(m_allocator, sizeof(aws_socket)));
+            if (!socket)
+            {
+                m_tunnel->SendStreamReset();
+                return;
+            }
+            if (aws_socket_init(socket, m_allocator, &m_config.LocalSocketOptions.GetImpl()))
+            {
+                aws_mem_release(m_allocator, socket);
+                m_tunnel->SendStreamReset();
+                return;
+            }
+            if (aws_socket_connect(socket, &endpoint, m_eventLoop, s_onConnectResult, this))
+            {
+                s_releaseSocket(socket);
+                m_tunnel->SendStreamReset();
+                return;
+            }
+
+            m_local = socket;
+            m_localConnected = false;
+        }
+
+        void LocalProxy::AttachLocal(aws_socket *socket)
+        {
+            m_local = socket;
+            m_localConnected = true;
+            if (m_config.LowLatency)
+            {
+                s_setNoDelay(socket);
+            }
+            if (m_config.UseIoUring && LocalSocketRing::IsSupported())
+            {
+                m_ring = LocalSocketRing::Create(
+                    m_eventLoop,
+                    socket->io_handle.data.fd,
+                    m_config.ReadBufferSize,
+                    [this](int errorCode, const Crt::ByteCursor &data) { OnRingRead(errorCode, data); },
+                    [this](int) { CloseLocal(true); },
+                    m_allocator);
+            }
+
+            if (m_ring)
+            {
+                m_ring->SetReadPaused(m_readPaused);
+            }
+            else if (aws_socket_subscribe_to_readable_events(socket, s_onReadable, this))
+            {
+                CloseLocal(true);
+                return;
+            }
+
+            while (m_local && !m_pendingWrites.empty())
+            {
+                LocalWrite write = std::move(m_pendingWrites.front());
+                m_pendingWrites.pop_front();
+                WriteLocal(std::move(write.Data), write.ReceivedNs);
+            }
+
+            ReadLocal();
+        }
+
+        void LocalProxy::CloseLocal(bool resetStream)
+        {
+            aws_socket *socket = m_local;
+            if (!socket)
+            {
+                return;
+            }
+
+            /* Cleared first, so callbacks the close triggers see a socket that is no longer ours. */
+            m_local = nullptr;
+            m_localConnected = false;
+            if (m_ring)
+            {
+                /* Before the socket closes: the ring waits for the kernel to finish with it. */
+                m_ring->Close();
+                m_ring.reset();
+            }
+            aws_socket_close(socket);
+            s_releaseSocket(socket);
+            m_writes.clear();
+            m_pendingWrites.clear();
+
+            if (resetStream)
+            {
+                m_tunnel->SendStreamReset();
+            }
+        }
+
+        void LocalProxy::ReadLocal()
+        {
+            while (m_local && m_localConnected && !m_readPaused && !m_ring)
+            {
+                m_readBuffer.len = 0;
+                size_t amountRead = 0;
+                if (aws_socket_read(m_local, &m_readBuffer, &amountRead))
+                {
+                    if (aws_last_error() != AWS_IO_READ_WOULD_BLOCK)
+                    {
+                        CloseLocal(true);
+                    }
+                    return;
+                }
+                if (amountRead == 0)
+                {
+                    return;
+                }
+
+                /* aws-c-iot serializes the payload before SendData returns, so the buffer is reused. */
+                Crt::ByteCursor data = aws_byte_cursor_from_buf(&m_readBuffer);
+                if (m_tunnel->SendData(data))
+                {
+                    CloseLocal(true);
+                    return;
+                }
+            }
+        }
+
+        void LocalProxy::OnRingRead(int errorCode, const Crt::ByteCursor &data)
+        {
+            /* As in ReadLocal, SendData has serialized the payload by the time it returns. */
+            if (errorCode || m_tunnel->SendData(data))
+            {
+                CloseLocal(true);
+            }
+        }
+
+        void LocalProxy::WriteLocal(Crt::Vector<uint8_t> &&data, uint64_t receivedNs)
+        {
+            if (m_ring)
+            {
+                m_ring->Write(std::move(data));
+                RecordDownstream(receivedNs);
+                return;
+            }
+
+            m_writes.push_back(LocalWrite{std::move(data), receivedNs});
+            /* Deque elements never move, so the cursor stays valid until the write completes. */
+            const Crt::Vector<uint8_t> &queued = m_writes.back().Data;
+            Crt::ByteCursor cursor = aws_byte_cursor_from_array(queued.data(), queued.size());
+            if (aws_socket_write(m_local, &cursor, s_onWriteComplete, this))
+            {
+                CloseLocal(true);
+            }
+        }
+
+        void LocalProxy::RecordDownstream(uint64_t receivedNs)
+        {
+            uint64_t nowNs = 0;
+            aws_high_res_clock_get_ticks(&nowNs);
+            std::lock_guard<std::mutex> guard(m_metricsLock);
+            m_downstreamLatency.Record(nowNs - receivedNs);
+        }
+
+        void LocalProxy::Shutdown()
+        {
+            CloseLocal(false);
+            if (m_listener)
+            {
+                aws_socket_stop_accept(m_listener);
+                aws_socket_close(m_listener);
+                s_releaseSocket(m_listener);
+                m_listener = nullptr;
+            }
+
+            m_selfReference.reset();
+        }
+
+        void LocalProxy::s_onConnectResult(aws_socket *socket, int errorCode, void *userData)
+        {
+            auto *proxy = static_cast<LocalProxy *>(userData);
+            if (socket != proxy->m_local)
+            {
+                return;
+            }
+
+            if (errorCode)
+            {
+                proxy->CloseLocal(true);
+                return;
+            }
+
+            proxy->AttachLocal(socket);
+        }
+
+        void LocalProxy::s_onAcceptResult(aws_socket *, int errorCode, aws_socket *socket, void *userData)
+        {
+            auto *proxy = static_cast<LocalProxy *>(userData);
+            if (errorCode || !socket)
+            {
+                return;
+            }
+
+            if (proxy->m_local || aws_socket_assign_to_event_loop(socket, proxy->m_eventLoop))
+            {
+                /* One stream at a time. */
+                aws_socket_close(socket);
+                s_releaseSocket(socket);
+                return;
+            }
+
+            if (proxy->m_tunnel->SendStreamStart())
+            {
+                aws_socket_close(socket);
+                s_releaseSocket(socket);
+                return;
+            }
+
+            proxy->AttachLocal(socket);
+        }
+
+        void LocalProxy::s_onReadable(aws_socket *socket, int errorCode, void *userData)
+        {
+            auto *proxy = static_cast<LocalProxy *>(userData);
+            if (socket != proxy->m_local)
+            {
+                return;
+            }
+
+            if (errorCode)
+            {
+                proxy->CloseLocal(true);
+                return;
+            }
+
+            proxy->ReadLocal();
+        }
+
+        void LocalProxy::s_onWriteComplete(aws_socket *socket, int errorCode, size_t, void *userData)
+        {
+            auto *proxy = static_cast<LocalProxy *>(userData);
+            if (socket != proxy->m_local)
+            {
+                return;
+            }
+
+            if (!proxy->m_writes.empty())
+            {
+                if (!errorCode)
+                {
+                    proxy->RecordDownstream(proxy->m_writes.front().ReceivedNs);
+                }
+                proxy->m_writes.pop_front();
+            }
+
+            if (errorCode)
+            {
+                proxy->CloseLocal(true);
+            }
+        }
+    } // namespace Iotsecuretunneling
+} // namespace Aws
@@ -0,0 +1,590 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/LocalSocketRing.h>
+
+#include <aws/io/event_loop.h>
+
+#ifdef AWS_SECURE_TUNNELING_IO_URING
+#    include <linux/io_uring.h>
+
+#    include <sys/eventfd.h>
+#    include <sys/mman.h>
+#    include <sys/socket.h>
+#    include <sys/syscall.h>
+#    include <sys/uio.h>
+#    include <unistd.h>
+
+#    include <algorithm>
+#    include <atomic>
+#    include <cerrno>
+#    include <cstring>
+#endif
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        LocalSocketRing::LocalSocketRing(
+            aws_event_loop *eventLoop,
+            int fd,
+            OnRingRead &&onRead,
+            OnRingWriteError &&onWriteError,
+            Crt::Allocator *allocator) noexcept
+            : m_eventLoop(eventLoop), m_allocator(allocator), m_fd(fd), m_onRead(std::move(onRead)),
+              m_onWriteError(std::move(onWriteError)), m_ringFd(-1), m_eventFd(-1), m_subscribed(false),
+              m_sqRing(nullptr), m_sqRingSize(0), m_cqRing(nullptr), m_cqRingSize(0), m_sqes(nullptr),
+              m_sqesSize(0), m_sqHead(nullptr), m_sqTail(nullptr), m_sqArray(nullptr), m_sqMask(0), m_sqEntries(0),
+              m_cqHead(nullptr), m_cqTail(nullptr), m_cqes(nullptr), m_cqMask(0), m_unsubmitted(0), m_inFlight(0),
+              m_readInFlight(false), m_readPaused(false), m_writeOffset(0), m_queuedWriteBytes(0), m_iovecs(nullptr),
+              m_message(nullptr), m_writeInFlight(false), m_flushScheduled(false), m_closed(false)
+        {
+            AWS_ZERO_STRUCT(m_eventHandle);
+            AWS_ZERO_STRUCT(m_readBuffer);
+            AWS_ZERO_STRUCT(m_flushTask);
+        }
+
+        std::shared_ptr<LocalSocketRing> LocalSocketRing::Create(
+            aws_event_loop *eventLoop,
+            int fd,
+            size_t readBufferSize,
+            OnRingRead &&onRead,
+            OnRingWriteError &&onWriteError,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<LocalSocketRing *>(aws_mem_acquire(allocator, sizeof(LocalSocketRing)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) LocalSocketRing(eventLoop, fd, std::move(onRead), std::move(onWriteError), allocator);
+            std::shared_ptr<LocalSocketRing> ring(
+                toSeat, [allocator](LocalSocketRing *doomed) { Crt::Delete(doomed, allocator); });
+            if (ring->Setup(readBufferSize))
+            {
+                return nullptr;
+            }
+
+            ring->ScheduleFlush();
+            return ring;
+        }
+
+#ifdef AWS_SECURE_TUNNELING_IO_URING
+        namespace
+        {
+            static const uint32_t s_ringEntries = 8;
+            /* Chunks gathered into one sendmsg; tunnel messages are at most 64 KB, so this is plenty per call. */
+            static const size_t s_maxIovecs = 64;
+            static const uint64_t s_readTag = 1;
+            static const uint64_t s_writeTag = 2;
+            /* Read and write at the socket's current position, i.e. as read(2) and write(2) do. */
+            static const uint64_t s_currentPosition = ~0ULL;
+
+            int s_ioUringSetup(uint32_t entries, io_uring_params *params)
+            {
+                return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+            }
+
+            int s_ioUringEnter(int ringFd, uint32_t toSubmit, uint32_t minComplete, uint32_t flags)
+            {
+                return static_cast<int>(
+                    syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, size_t(0)));
+            }
+
+            int s_ioUringRegister(int ringFd, unsigned opcode, const void *arg, unsigned count)
+            {
+                return static_cast<int>(syscall(__NR_io_uring_register, ringFd, opcode, arg, count));
+            }
+
+            int s_translateErrno(int error)
+            {
+                switch (error)
+                {
+                    case ECONNRESET:
+                    case ECONNABORTED:
+                    case EPIPE:
+                    case ENOTCONN:
+                        return AWS_IO_SOCKET_CLOSED;
+                    default:
+                        return AWS_ERROR_SYS_CALL_FAILURE;
+                }
+            }
+
+            bool s_isRetryable(int result) { return result == -EAGAIN || result == -EINTR; }
+        } // namespace
+
+        bool LocalSocketRing::IsSupported() noexcept
+        {
+            /* -1 until probed, then 0 or 1. Seccomp profiles and io_uring_disabled make this a run-time question. */
+            static std::atomic<int> s_supported(-1);
+            int supported = s_supported.load();
+            if (supported < 0)
+            {
+                io_uring_params params;
+                memset(&params, 0, sizeof(params));
+                int ringFd = s_ioUringSetup(1, &params);
+                supported = ringFd >= 0 ? 1 : 0;
+                if (ringFd >= 0)
+                {
+                    close(ringFd);
+                }
+                s_supported.store(supported);
+            }
+            return supported == 1;
+        }
+
+        int LocalSocketRing::Setup(size_t readBufferSize)
+        {
+            io_uring_params params;
+            memset(&params, 0, sizeof(params));
+            m_ringFd = s_ioUringSetup(s_ringEntries, &params);
+            if (m_ringFd < 0)
+            {
+                return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+            }
+
+            m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMmap)
+            {
+                m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+            }
+
+            void *sqRing = mmap(
+                nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED)
+            {
+                return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+            }
+            m_sqRing = sqRing;
+
+            if (!singleMmap)
+            {
+                void *cqRing = mmap(
+                    nullptr,
+                    m_cqRingSize,
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE,
+                    m_ringFd,
+                    IORING_OFF_CQ_RING);
+                if (cqRing == MAP_FAILED)
+                {
+                    return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                }
+                m_cqRing = cqRing;
+            }
+
+            m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            void *sqes =
+                mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+            if (sqes == MAP_FAILED)
+            {
+                return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+            }
+            m_sqes = static_cast<io_uring_sqe *>(sqes);
+
+            auto *sq = static_cast<uint8_t *>(m_sqRing);
+            auto *cq = static_cast<uint8_t *>(singleMmap ? m_sqRing : m_cqRing);
+            m_sqHead = reinterpret_cast<uint32_t *>(sq + params.sq_off.head);
+            m_sqTail = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+            m_sqArray = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+            m_sqMask = *reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+            m_sqEntries = params.sq_entries;
+            m_cqHead = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+            m_cqTail = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+            m_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+            m_cqMask = *reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+
+            /* Registered once, so the kernel does not pin and unpin the read buffer on every read. */
+            if (aws_byte_buf_init(&m_readBuffer, m_allocator, readBufferSize))
+            {
+                return AWS_OP_ERR;
+            }
+            iovec readVec;
+            readVec.iov_base = m_readBuffer.buffer;
+            readVec.iov_len = m_readBuffer.capacity;
+            if (s_ioUringRegister(m_ringFd, IORING_REGISTER_BUFFERS, &readVec, 1))
+            {
+                return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+            }
+
+            m_iovecs = static_cast<iovec *>(aws_mem_calloc(m_allocator, s_maxIovecs, sizeof(iovec)));
+            m_message = static_cast<msghdr *>(aws_mem_calloc(m_allocator, 1, sizeof(msghdr)));
+            if (!m_iovecs || !m_message)
+            {
+                return AWS_OP_ERR;
+            }
+
+            m_eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (m_eventFd < 0 || s_ioUringRegister(m_ringFd, IORING_REGISTER_EVENTFD, &m_eventFd, 1))
+            {
+                return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+            }
+
+            m_eventHandle.data.fd = m_eventFd;
+            if (aws_event_loop_subscribe_to_io_events(
+                    m_eventLoop, &m_eventHandle, AWS_IO_EVENT_TYPE_READABLE, s_onEventFd, this))
+            {
+                return AWS_OP_ERR;
+            }
+            m_subscribed = true;
+
+            aws_task_init(&m_flushTask, s_onFlushTask, this, "LocalSocketRingFlush");
+            return AWS_OP_SUCCESS;
+        }
+
+        LocalSocketRing::~LocalSocketRing()
+        {
+            if (m_flushScheduled)
+            {
+                aws_event_loop_cancel_task(m_eventLoop, &m_flushTask);
+            }
+
+            /* A ring that failed to set up never touched the socket, which stays the caller's to use. */
+            if (m_subscribed)
+            {
+                Close();
+            }
+
+            /*
+             * The kernel may still be reading into the registered buffer or from queued chunks. The socket has
+             * been shut down, so both complete promptly; wait for them before releasing the memory.
+             */
+            while (m_inFlight > 0 && m_ringFd >= 0)
+            {
+                int submitted = s_ioUringEnter(m_ringFd, m_unsubmitted, 1, IORING_ENTER_GETEVENTS);
+                if (submitted < 0 && errno != EINTR)
+                {
+                    break;
+                }
+                if (submitted > 0)
+                {
+                    m_unsubmitted -= std::min<uint32_t>(m_unsubmitted, static_cast<uint32_t>(submitted));
+                }
+                Reap();
+            }
+
+            if (m_subscribed)
+            {
+                aws_event_loop_unsubscribe_from_io_events(m_eventLoop, &m_eventHandle);
+            }
+            if (m_eventFd >= 0)
+            {
+                close(m_eventFd);
+            }
+            if (m_sqes)
+            {
+                munmap(m_sqes, m_sqesSize);
+            }
+            if (m_cqRing)
+            {
+                munmap(m_cqRing, m_cqRingSize);
+            }
+            if (m_sqRing)
+            {
+                munmap(m_sqRing, m_sqRingSize);
+            }
+            if (m_ringFd >= 0)
+            {
+                close(m_ringFd);
+            }
+
+            aws_byte_buf_clean_up(&m_readBuffer);
+            if (m_iovecs)
+            {
+                aws_mem_release(m_allocator, m_iovecs);
+            }
+            if (m_message)
+            {
+                aws_mem_release(m_allocator, m_message);
+            }
+        }
+
+        io_uring_sqe *LocalSocketRing::NextSqe()
+        {
+            const uint32_t head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+            const uint32_t tail = *m_sqTail;
+            if (tail - head >= m_sqEntries)
+            {
+                return nullptr;
+            }
+
+            /* Without SQPOLL the kernel only looks at the ring inside io_uring_enter, after the entry is filled. */
+            const uint32_t index = tail & m_sqMask;
+            io_uring_sqe *sqe = &m_sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            m_sqArray[index] = index;
+            __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+            ++m_unsubmitted;
+            ++m_inFlight;
+            return sqe;
+        }
+
+        void LocalSocketRing::ScheduleFlush()
+        {
+            if (m_flushScheduled || m_closed)
+            {
+                return;
+            }
+
+            /* Runs once this event loop iteration's I/O has been handled, so everything it queued goes at once. */
+            m_flushScheduled = true;
+            aws_event_loop_schedule_task_now(m_eventLoop, &m_flushTask);
+        }
+
+        void LocalSocketRing::Flush()
+        {
+            m_flushScheduled = false;
+            if (m_closed)
+            {
+                return;
+            }
+
+            if (!m_readInFlight && !m_readPaused)
+            {
+                io_uring_sqe *sqe = NextSqe();
+                if (sqe)
+                {
+                    sqe->opcode = IORING_OP_READ_FIXED;
+                    sqe->fd = m_fd;
+                    sqe->addr = reinterpret_cast<uint64_t>(m_readBuffer.buffer);
+                    sqe->len = static_cast<uint32_t>(m_readBuffer.capacity);
+                    sqe->off = s_currentPosition;
+                    sqe->buf_index = 0;
+                    sqe->user_data = s_readTag;
+                    m_readInFlight = true;
+                }
+            }
+
+            if (!m_writeInFlight && !m_writes.empty())
+            {
+                size_t count = 0;
+                for (auto chunk = m_writes.begin(); chunk != m_writes.end() && count < s_maxIovecs; ++chunk, ++count)
+                {
+                    const size_t skip = count == 0 ? m_writeOffset : 0;
+                    m_iovecs[count].iov_base = chunk->data() + skip;
+                    m_iovecs[count].iov_len = chunk->size() - skip;
+                }
+
+                m_message->msg_iov = m_iovecs;
+                m_message->msg_iovlen = count;
+
+                io_uring_sqe *sqe = NextSqe();
+                if (sqe)
+                {
+                    /* sendmsg rather than writev: a peer that went away fails the write instead of raising SIGPIPE. */
+                    sqe->opcode = IORING_OP_SENDMSG;
+                    sqe->fd = m_fd;
+                    sqe->addr = reinterpret_cast<uint64_t>(m_message);
+                    sqe->len = 1;
+                    sqe->msg_flags = MSG_NOSIGNAL;
+                    sqe->user_data = s_writeTag;
+                    m_writeInFlight = true;
+                }
+            }
+
+            if (m_unsubmitted == 0)
+            {
+                return;
+            }
+
+            int submitted = s_ioUringEnter(m_ringFd, m_unsubmitted, 0, 0);
+            if (submitted >= 0)
+            {
+                m_unsubmitted -= std::min<uint32_t>(m_unsubmitted, static_cast<uint32_t>(submitted));
+                return;
+            }
+
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+            {
+                /* Still queued in the ring; the next flush submits them. */
+                ScheduleFlush();
+                return;
+            }
+
+            int errorCode = s_translateErrno(errno);
+            OnRingRead onRead = m_onRead;
+            Close();
+            onRead(errorCode, Crt::ByteCursorFromArray(nullptr, 0));
+        }
+
+        void LocalSocketRing::Reap()
+        {
+            uint32_t head = *m_cqHead;
+            for (;;)
+            {
+                const uint32_t tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+                if (head == tail)
+                {
+                    return;
+                }
+
+                const io_uring_cqe &cqe = m_cqes[head & m_cqMask];
+                const uint64_t tag = cqe.user_data;
+                const int result = cqe.res;
+                /* Consumed before dispatching, since the callbacks may queue more work. */
+                __atomic_store_n(m_cqHead, ++head, __ATOMIC_RELEASE);
+                --m_inFlight;
+
+                if (tag == s_readTag)
+                {
+                    OnReadComplete(result);
+                }
+                else if (tag == s_writeTag)
+                {
+                    OnWriteComplete(result);
+                }
+            }
+        }
+
+        void LocalSocketRing::OnReadComplete(int result)
+        {
+            m_readInFlight = false;
+            if (m_closed)
+            {
+                return;
+            }
+
+            if (s_isRetryable(result))
+            {
+                ScheduleFlush();
+                return;
+            }
+
+            if (result <= 0)
+            {
+                int errorCode = result == 0 ? AWS_IO_SOCKET_CLOSED : s_translateErrno(-result);
+                m_onRead(errorCode, Crt::ByteCursorFromArray(nullptr, 0));
+                return;
+            }
+
+            m_onRead(AWS_ERROR_SUCCESS, Crt::ByteCursorFromArray(m_readBuffer.buffer, static_cast<size_t>(result)));
+            ScheduleFlush();
+        }
+
+        void LocalSocketRing::OnWriteComplete(int result)
+        {
+            m_writeInFlight = false;
+            if (m_closed)
+            {
+                return;
+            }
+
+            if (s_isRetryable(result))
+            {
+                ScheduleFlush();
+                return;
+            }
+
+            if (result < 0)
+            {
+                m_onWriteError(s_translateErrno(-result));
+                return;
+            }
+
+            /* A short write leaves the rest of a chunk, and the chunks after it, for the next sendmsg. */
+            size_t written = static_cast<size_t>(result);
+            m_queuedWriteBytes -= std::min(m_queuedWriteBytes, written);
+            while (written > 0 && !m_writes.empty())
+            {
+                const size_t remaining = m_writes.front().size() - m_writeOffset;
+                if (written < remaining)
+                {
+                    m_writeOffset += written;
+                    break;
+                }
+
+                written -= remaining;
+                m_writes.pop_front();
+                m_writeOffset = 0;
+            }
+
+            if (!m_writes.empty())
+            {
+                ScheduleFlush();
+            }
+        }
+
+        void LocalSocketRing::SetReadPaused(bool paused)
+        {
+            m_readPaused = paused;
+            if (!paused)
+            {
+                ScheduleFlush();
+            }
+        }
+
+        void LocalSocketRing::Write(Crt::Vector<uint8_t> &&data)
+        {
+            if (m_closed || data.empty())
+            {
+                return;
+            }
+
+            m_queuedWriteBytes += data.size();
+            m_writes.push_back(std::move(data));
+            ScheduleFlush();
+        }
+
+        void LocalSocketRing::Close()
+        {
+            if (m_closed)
+            {
+                return;
+            }
+
+            /* Wakes the read and write in flight, which the kernel otherwise holds until the peer acts. */
+            m_closed = true;
+            shutdown(m_fd, SHUT_RDWR);
+        }
+
+        void LocalSocketRing::s_onFlushTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *ring = static_cast<LocalSocketRing *>(arg);
+            if (status != AWS_TASK_STATUS_RUN_READY)
+            {
+                return;
+            }
+
+            /* A callback may release the owner's reference. */
+            auto keepAlive = ring->shared_from_this();
+            ring->Flush();
+        }
+
+        void LocalSocketRing::s_onEventFd(aws_event_loop *, aws_io_handle *, int, void *userData)
+        {
+            auto *ring = static_cast<LocalSocketRing *>(userData);
+            auto keepAlive = ring->shared_from_this();
+
+            uint64_t completions = 0;
+            if (read(ring->m_eventFd, &completions, sizeof(completions)) < 0 && errno != EAGAIN)
+            {
+                return;
+            }
+            ring->Reap();
+        }
+#else
+        bool LocalSocketRing::IsSupported() noexcept { return false; }
+
+        int LocalSocketRing::Setup(size_t) { return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION); }
+
+        LocalSocketRing::~LocalSocketRing() {}
+
+        io_uring_sqe *LocalSocketRing::NextSqe() { return nullptr; }
+        void LocalSocketRing::ScheduleFlush() {}
+        void LocalSocketRing::Flush() {}
+        void LocalSocketRing::Reap() {}
+        void LocalSocketRing::OnReadComplete(int) {}
+        void LocalSocketRing::OnWriteComplete(int) {}
+        void LocalSocketRing::SetReadPaused(bool) {}
+        void LocalSocketRing::Write(Crt::Vector<uint8_t> &&) {}
+        void LocalSocketRing::Close() {}
+        void LocalSocketRing::s_onFlushTask(aws_task *, void *, aws_task_status) {}
+        void LocalSocketRing::s_onEventFd(aws_event_loop *, aws_io_handle *, int, void *) {}
+#endif
+    } // namespace Iotsecuretunneling
+} // namespace Aws
@@ -5,10 +5,51 @@
 
 #include <aws/iotsecuretunneling/SecureTunnel.h>
 
+#include <aws/iotdevicecommon/IotDevice.h>
+#include <aws/iotdevicecommon/ServiceLog.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/device_random.h>
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/event_loop.h>
+
+#include <algorithm>
+
 namespace Aws
 {
     namespace Iotsecuretunneling
     {
+        namespace
+        {
+            /* aws-c-iot splits payloads larger than this into several frames, each completing on its own. */
+#ifdef AWS_IOT_ST_SPLIT_MESSAGE_SIZE
+            const size_t s_splitMessageSize = AWS_IOT_ST_SPLIT_MESSAGE_SIZE;
+#else
+            const size_t s_splitMessageSize = 15000;
+#endif
+
+            /* Caps the doubling of the reconnect backoff well before it could overflow. */
+            const uint32_t s_maxBackoffDoublings = 20;
+
+            /* Keystrokes and other small writes gain nothing from deflate, whose framing would only add bytes. */
+            const size_t s_minCompressBytes = 64;
+
+            /* Enough idle buffers for a few dozen frames in flight. */
+            const size_t s_defaultFramePoolCapacity = 256 * 1024;
+
+            const uint32_t s_msPerSec = 1000;
+            const uint64_t s_nsPerMs = 1000000;
+        } // namespace
+
+        /* Also queued for keep-alive checks, which carry the same state. */
+        struct SecureTunnel::ReconnectTask
+        {
+            aws_task Task;
+            std::shared_ptr<ReconnectShared> Shared;
+            uint64_t Generation;
+            Crt::Allocator *Allocator;
+        };
+
         SecureTunnel::SecureTunnel(
             Crt::Allocator *allocator,
             Aws::Crt::Io::ClientBootstrap *clientBootstrap,
@@ -26,7 +67,17 @@ namespace Aws
             OnStreamStart onStreamStart,
             OnStreamReset onStreamReset,
             OnSessionReset onSessionReset)
+            : m_allocator(allocator), m_sendBatchThreshold(0), m_inFlightBytes(0), m_inFlightFrames(0),
+              m_sendLatency(), m_bytesSent(0), m_bytesReceived(0),
+              m_framePool(Crt::MakeShared<TunnelFrameBufferPool>(allocator, s_defaultFramePoolCapacity, allocator)),
+              m_highWatermark(0), m_lowWatermark(0), m_aboveHighWatermark(false),
+              m_reconnectMinBackoffMs(0), m_reconnectMaxBackoffMs(0), m_reconnectAttempts(0), m_reconnectGeneration(0),
+              m_connected(false), m_closed(false), m_reconnecting(false), m_keepAliveIntervalMs(0),
+              m_keepAliveTimeoutMs(0), m_keepAliveScheduled(false), m_lastSendProgressNs(0), m_replayLimit(0),
+              m_retainedBytes(0), m_replayBroken(false), m_compressionLevel(0), m_compressionWindowBits(15)
         {
+            Iotdevicecommon::DeviceApiHandle::EnsureInitialized();
+
             // Client callbacks
             m_OnConnectionComplete = onConnectionComplete;
             m_OnConnectionShutdown = onConnectionShutdown;
@@ -64,11 +115,39 @@ namespace Aws
 
             config.user_data = this;
 
+            m_bootstrap = config.bootstrap;
+            m_eventLoop = nullptr;
+            m_reconnectShared = Crt::MakeShared<ReconnectShared>(allocator);
+            if (m_reconnectShared)
+            {
+                m_reconnectShared->Tunnel = this;
+            }
+
             // Create the secure tunnel
             m_secure_tunnel = aws_secure_tunnel_new(&config);
         }
 
         SecureTunnel::SecureTunnel(SecureTunnel &&other) noexcept
+            : m_sendBatchThreshold(other.m_sendBatchThreshold), m_sendBatch(std::move(other.m_sendBatch)),
+              m_inFlight(std::move(other.m_inFlight)), m_inFlightBytes(other.m_inFlightBytes),
+              m_inFlightFrames(other.m_inFlightFrames), m_sendLatency(other.m_sendLatency),
+              m_bytesSent(other.m_bytesSent), m_bytesReceived(other.m_bytesReceived),
+              m_framePool(std::move(other.m_framePool)),
+              m_highWatermark(other.m_highWatermark), m_lowWatermark(other.m_lowWatermark),
+              m_aboveHighWatermark(other.m_aboveHighWatermark),
+              m_OnSendWatermark(std::move(other.m_OnSendWatermark)),
+              m_reconnectMinBackoffMs(other.m_reconnectMinBackoffMs),
+              m_reconnectMaxBackoffMs(other.m_reconnectMaxBackoffMs), m_reconnectAttempts(other.m_reconnectAttempts),
+              m_reconnectGeneration(other.m_reconnectGeneration), m_connected(other.m_connected),
+              m_closed(other.m_closed), m_reconnecting(other.m_reconnecting),
+              m_reconnectShared(std::move(other.m_reconnectShared)),
+              m_keepAliveIntervalMs(other.m_keepAliveIntervalMs), m_keepAliveTimeoutMs(other.m_keepAliveTimeoutMs),
+              m_keepAliveScheduled(other.m_keepAliveScheduled), m_lastSendProgressNs(other.m_lastSendProgressNs),
+              m_replayLimit(other.m_replayLimit),
+              m_retainedBytes(other.m_retainedBytes), m_replay(std::move(other.m_replay)),
+              m_replayBroken(other.m_replayBroken), m_compressionLevel(other.m_compressionLevel),
+              m_compressionWindowBits(other.m_compressionWindowBits), m_encoder(std::move(other.m_encoder)),
+              m_decoder(std::move(other.m_decoder)), m_encoded(std::move(other.m_encoded))
         {
             m_OnConnectionComplete = other.m_OnConnectionComplete;
             m_OnConnectionShutdown = other.m_OnConnectionShutdown;
@@ -83,13 +162,35 @@ namespace Aws
             m_endpointHost = std::move(other.m_endpointHost);
             m_rootCa = std::move(other.m_rootCa);
 
+            m_allocator = other.m_allocator;
+            m_bootstrap = other.m_bootstrap;
             m_secure_tunnel = other.m_secure_tunnel;
+            m_eventLoop = other.m_eventLoop;
 
             other.m_secure_tunnel = nullptr;
+
+            if (m_reconnectShared)
+            {
+                std::lock_guard<std::mutex> guard(m_reconnectShared->Lock);
+                m_reconnectShared->Tunnel = this;
+            }
         }
 
         SecureTunnel::~SecureTunnel()
         {
+            if (m_reconnectShared)
+            {
+                /* Waits out a reconnect task already running on the event loop. */
+                std::lock_guard<std::mutex> guard(m_reconnectShared->Lock);
+                m_reconnectShared->Tunnel = nullptr;
+            }
+
+            for (InFlightSend &send : m_inFlight)
+            {
+                aws_byte_buf_clean_up(&send.Data);
+            }
+            m_inFlight.clear();
+
             if (m_secure_tunnel)
             {
                 aws_secure_tunnel_release(m_secure_tunnel);
@@ -115,68 +216,858 @@ namespace Aws
                 m_endpointHost = std::move(other.m_endpointHost);
                 m_rootCa = std::move(other.m_rootCa);
 
+                m_allocator = other.m_allocator;
+                m_bootstrap = other.m_bootstrap;
                 m_secure_tunnel = other.m_secure_tunnel;
+                m_eventLoop = other.m_eventLoop;
+
+                m_sendBatchThreshold = other.m_sendBatchThreshold;
+                m_sendBatch = std::move(other.m_sendBatch);
+                m_inFlight = std::move(other.m_inFlight);
+                m_inFlightBytes = other.m_inFlightBytes;
+                m_inFlightFrames = other.m_inFlightFrames;
+                m_sendLatency = other.m_sendLatency;
+                m_bytesSent = other.m_bytesSent;
+                m_bytesReceived = other.m_bytesReceived;
+                m_framePool = std::move(other.m_framePool);
+                m_highWatermark = other.m_highWatermark;
+                m_lowWatermark = other.m_lowWatermark;
+                m_aboveHighWatermark = other.m_aboveHighWatermark;
+                m_OnSendWatermark = std::move(other.m_OnSendWatermark);
+
+                m_reconnectMinBackoffMs = other.m_reconnectMinBackoffMs;
+                m_reconnectMaxBackoffMs = other.m_reconnectMaxBackoffMs;
+                m_reconnectAttempts = other.m_reconnectAttempts;
+                m_reconnectGeneration = other.m_reconnectGeneration;
+                m_connected = other.m_connected;
+                m_closed = other.m_closed;
+                m_reconnecting = other.m_reconnecting;
+                m_reconnectShared = std::move(other.m_reconnectShared);
+                m_keepAliveIntervalMs = other.m_keepAliveIntervalMs;
+                m_keepAliveTimeoutMs = other.m_keepAliveTimeoutMs;
+                m_keepAliveScheduled = other.m_keepAliveScheduled;
+                m_lastSendProgressNs = other.m_lastSendProgressNs;
+                m_replayLimit = other.m_replayLimit;
+                m_retainedBytes = other.m_retainedBytes;
+                m_replay = std::move(other.m_replay);
+                m_replayBroken = other.m_replayBroken;
+
+                m_compressionLevel = other.m_compressionLevel;
+                m_compressionWindowBits = other.m_compressionWindowBits;
+                m_encoder = std::move(other.m_encoder);
+                m_decoder = std::move(other.m_decoder);
+                m_encoded = std::move(other.m_encoded);
 
                 other.m_secure_tunnel = nullptr;
+
+                if (m_reconnectShared)
+                {
+                    std::lock_guard<std::mutex> guard(m_reconnectShared->Lock);
+                    m_reconnectShared->Tunnel = this;
+                }
             }
 
             return *this;
         }
 
-        int SecureTunnel::Connect() { return aws_secure_tunnel_connect(m_secure_tunnel); }
+        int SecureTunnel::Connect()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_sendLock);
+                m_closed = false;
+            }
+            return aws_secure_tunnel_connect(m_secure_tunnel);
+        }
 
-        int SecureTunnel::Close() { return aws_secure_tunnel_close(m_secure_tunnel); }
+        int SecureTunnel::Close()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_sendLock);
+                m_closed = true;
+                if (m_reconnecting)
+                {
+                    m_reconnecting = false;
+                    ++m_reconnectGeneration;
+                }
+                DiscardReplay();
+            }
+            return aws_secure_tunnel_close(m_secure_tunnel);
+        }
 
         int SecureTunnel::SendData(const Crt::ByteCursor &data)
         {
-            return aws_secure_tunnel_send_data(m_secure_tunnel, &data);
+            int result = AWS_OP_SUCCESS;
+            bool crossed = false;
+            bool above = false;
+            {
+                std::lock_guard<std::mutex> guard(m_sendLock);
+                result = SendWithBatch(&data, 1);
+                crossed = UpdateWatermark();
+                above = m_aboveHighWatermark;
+            }
+
+            if (crossed)
+            {
+                NotifyWatermark(above);
+            }
+            return result;
+        }
+
+        int SecureTunnel::SendData(const Crt::Vector<Crt::ByteCursor> &data)
+        {
+            int result = AWS_OP_SUCCESS;
+            bool crossed = false;
+            bool above = false;
+            {
+                std::lock_guard<std::mutex> guard(m_sendLock);
+                result = SendWithBatch(data.data(), data.size());
+                crossed = UpdateWatermark();
+                above = m_aboveHighWatermark;
+            }
+
+            if (crossed)
+            {
+                NotifyWatermark(above);
+            }
+            return result;
+        }
+
+        int SecureTunnel::SetSendBatchThreshold(size_t thresholdBytes)
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            m_sendBatchThreshold = thresholdBytes;
+            if (thresholdBytes == 0 && !m_sendBatch.empty())
+            {
+                return SendWithBatch(nullptr, 0);
+            }
+
+            return AWS_OP_SUCCESS;
+        }
+
+        size_t SecureTunnel::GetQueuedBytes() const
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            return m_sendBatch.size() + m_inFlightBytes + m_replay.size();
+        }
+
+        size_t SecureTunnel::GetInFlightFrames() const
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            return m_inFlightFrames;
+        }
+
+        Iotdevicecommon::LatencyHistogram SecureTunnel::GetSendLatency() const
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            return m_sendLatency;
+        }
+
+        uint64_t SecureTunnel::GetBytesSent() const
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            return m_bytesSent;
+        }
+
+        uint64_t SecureTunnel::GetBytesReceived() const
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            return m_bytesReceived;
+        }
+
+        void SecureTunnel::SetSendWatermarks(
+            size_t highWatermarkBytes,
+            size_t lowWatermarkBytes,
+            const OnSendWatermark &onSendWatermark)
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            m_highWatermark = highWatermarkBytes;
+            m_lowWatermark = std::min(lowWatermarkBytes, highWatermarkBytes);
+            m_OnSendWatermark = onSendWatermark;
+            m_aboveHighWatermark = false;
+        }
+
+        int SecureTunnel::SetReconnectPolicy(uint32_t minBackoffMs, uint32_t maxBackoffMs, size_t replayBufferBytes)
+        {
+            if (minBackoffMs > 0 && (!m_bootstrap || !m_bootstrap->event_loop_group || !m_reconnectShared))
+            {
+                return aws_raise_error(AWS_ERROR_INVALID_STATE);
+            }
+
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            m_reconnectMinBackoffMs = minBackoffMs;
+            m_reconnectMaxBackoffMs = std::max(minBackoffMs, maxBackoffMs);
+            m_replayLimit = minBackoffMs > 0 ? replayBufferBytes : 0;
+            if (m_replayLimit == 0)
+            {
+                DiscardReplay();
+            }
+            if (minBackoffMs == 0 && m_reconnecting)
+            {
+                m_reconnecting = false;
+                ++m_reconnectGeneration;
+            }
+
+            return AWS_OP_SUCCESS;
+        }
+
+        int SecureTunnel::SetKeepAlive(uint32_t intervalMs, uint32_t timeoutMs)
+        {
+            if (intervalMs > 0 && timeoutMs < intervalMs)
+            {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+            if (intervalMs > 0 && (!m_bootstrap || !m_bootstrap->event_loop_group || !m_reconnectShared))
+            {
+                return aws_raise_error(AWS_ERROR_INVALID_STATE);
+            }
+
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            m_keepAliveIntervalMs = intervalMs;
+            m_keepAliveTimeoutMs = intervalMs > 0 ? timeoutMs : 0;
+
+            /* aws-c-io sets TCP_KEEPIDLE from the interval and TCP_KEEPINTVL from the timeout. */
+            uint32_t intervalSec = (intervalMs + s_msPerSec - 1) / s_msPerSec;
+            uint32_t probes = intervalSec > 0 ? (timeoutMs + intervalMs - 1) / intervalMs : 0;
+            m_socketOptions.SetKeepAlive(intervalMs > 0);
+            m_socketOptions.SetKeepAliveIntervalSec(static_cast<uint16_t>(std::min<uint32_t>(intervalSec, UINT16_MAX)));
+            m_socketOptions.SetKeepAliveTimeoutSec(static_cast<uint16_t>(std::min<uint32_t>(intervalSec, UINT16_MAX)));
+            m_socketOptions.SetKeepAliveMaxFailedProbes(static_cast<uint16_t>(std::min<uint32_t>(probes, UINT16_MAX)));
+
+            if (m_connected)
+            {
+                ScheduleKeepAlive();
+            }
+            return AWS_OP_SUCCESS;
+        }
+
+        int SecureTunnel::SetEventLoop(aws_event_loop *eventLoop)
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            m_eventLoop = eventLoop;
+            return AWS_OP_SUCCESS;
+        }
+
+        int SecureTunnel::SetCompression(int level, int windowBits)
+        {
+            if (level < 0 || level > 9 || (level > 0 && (windowBits < 9 || windowBits > 15)))
+            {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            m_compressionLevel = level;
+            m_compressionWindowBits = windowBits;
+            return AWS_OP_SUCCESS;
+        }
+
+        int SecureTunnel::SetFrameBufferPoolCapacity(size_t capacityBytes)
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            if (!m_framePool)
+            {
+                return aws_raise_error(AWS_ERROR_INVALID_STATE);
+            }
+
+            m_framePool->SetCapacity(capacityBytes);
+            return AWS_OP_SUCCESS;
+        }
+
+        uint64_t SecureTunnel::GetFrameBufferAllocationCount() const
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            return m_framePool ? m_framePool->GetAllocationCount() : 0;
+        }
+
+        bool SecureTunnel::IsSendCompressed() const
+        {
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            return m_encoder && m_encoder->IsCompressing();
+        }
+
+        int SecureTunnel::SendWithBatch(const Crt::ByteCursor *data, size_t count)
+        {
+            size_t total = m_sendBatch.size();
+            for (size_t i = 0; i < count; ++i)
+            {
+                total += data[i].len;
+            }
+
+            if (total == 0 && count != 1)
+            {
+                return AWS_OP_SUCCESS;
+            }
+
+            /* Hold small writes back while a send is outstanding; its completion flushes them. */
+            bool hold = m_sendBatchThreshold > 0 && m_inFlightFrames > 0 && total < m_sendBatchThreshold;
+            if (!hold && m_sendBatch.empty() && count == 1)
+            {
+                /* Nothing to coalesce with, so skip the copy. */
+                return SendEncoded(*data);
+            }
+
+            m_sendBatch.reserve(total);
+            for (size_t i = 0; i < count; ++i)
+            {
+                m_sendBatch.insert(m_sendBatch.end(), data[i].ptr, data[i].ptr + data[i].len);
+            }
+            if (hold)
+            {
+                return AWS_OP_SUCCESS;
+            }
+
+            /* aws-c-iot serializes the payload before returning, so the batch storage can be reused. */
+            Crt::ByteCursor batch = aws_byte_cursor_from_array(m_sendBatch.data(), m_sendBatch.size());
+            int result = SendEncoded(batch);
+            m_sendBatch.clear();
+            return result;
+        }
+
+        int SecureTunnel::SendEncoded(const Crt::ByteCursor &data)
+        {
+            if (!m_encoder)
+            {
+                return SendToTunnel(data);
+            }
+
+            /* As with the batch, aws-c-iot is done with the encoded bytes once the send returns. */
+            m_encoded.clear();
+            if (m_encoder->Append(data, m_encoded) != AWS_OP_SUCCESS)
+            {
+                return AWS_OP_ERR;
+            }
+            return SendToTunnel(aws_byte_cursor_from_array(m_encoded.data(), m_encoded.size()));
+        }
+
+        int SecureTunnel::SendToTunnel(const Crt::ByteCursor &data, bool internal)
+        {
+            if (m_reconnecting && m_replayLimit > 0)
+            {
+                /* Nothing goes out until the tunnel is back, so queue the data behind the replay. */
+                if (m_replayBroken || m_retainedBytes + data.len > m_replayLimit)
+                {
+                    return aws_raise_error(AWS_ERROR_INVALID_STATE);
+                }
+
+                m_replay.insert(m_replay.end(), data.ptr, data.ptr + data.len);
+                m_retainedBytes += data.len;
+                return AWS_OP_SUCCESS;
+            }
+
+            if (aws_secure_tunnel_send_data(m_secure_tunnel, &data) != AWS_OP_SUCCESS)
+            {
+                return AWS_OP_ERR;
+            }
+
+            InFlightSend send;
+            send.Bytes = data.len;
+            send.Frames = std::max<size_t>(1, (data.len + s_splitMessageSize - 1) / s_splitMessageSize);
+            send.Internal = internal;
+            send.SentNs = 0;
+            aws_high_res_clock_get_ticks(&send.SentNs);
+            if (m_inFlightFrames == 0)
+            {
+                /* Nothing was waiting, so the stall clock starts with this send. */
+                m_lastSendProgressNs = send.SentNs;
+            }
+            send.Retained = m_replayLimit > 0 && m_retainedBytes + data.len <= m_replayLimit;
+            send.DataOffset = 0;
+            AWS_ZERO_STRUCT(send.Data);
+            if (send.Retained && m_framePool)
+            {
+                send.Data = m_framePool->Acquire(data.len);
+                send.Retained = aws_byte_buf_write_from_whole_cursor(&send.Data, data);
+            }
+            else
+            {
+                send.Retained = false;
+            }
+            if (send.Retained)
+            {
+                m_retainedBytes += data.len;
+            }
+            m_inFlight.push_back(std::move(send));
+            m_inFlightBytes += send.Bytes;
+            m_inFlightFrames += send.Frames;
+            return AWS_OP_SUCCESS;
         }
 
-        int SecureTunnel::SendStreamStart() { return aws_secure_tunnel_stream_start(m_secure_tunnel); }
+        bool SecureTunnel::UpdateWatermark()
+        {
+            if (m_highWatermark == 0 || !m_OnSendWatermark)
+            {
+                return false;
+            }
 
-        int SecureTunnel::SendStreamReset() { return aws_secure_tunnel_stream_reset(m_secure_tunnel); }
+            size_t queued = m_sendBatch.size() + m_inFlightBytes + m_replay.size();
+            bool above = m_aboveHighWatermark ? queued > m_lowWatermark : queued >= m_highWatermark;
+            if (above == m_aboveHighWatermark)
+            {
+                return false;
+            }
+
+            m_aboveHighWatermark = above;
+            return true;
+        }
+
+        void SecureTunnel::NotifyWatermark(bool aboveHighWatermark)
+        {
+            OnSendWatermark onSendWatermark;
+            {
+                std::lock_guard<std::mutex> guard(m_sendLock);
+                onSendWatermark = m_OnSendWatermark;
+            }
+
+            if (onSendWatermark)
+            {
+                onSendWatermark(aboveHighWatermark);
+            }
+        }
+
+        void SecureTunnel::DiscardReplay()
+        {
+            m_retainedBytes -= m_replay.size();
+            m_replay.clear();
+            m_replayBroken = false;
+        }
+
+        void SecureTunnel::ScheduleReconnect(uint64_t minDelayMs)
+        {
+            auto *reconnectTask = Crt::New<ReconnectTask>(m_allocator);
+            if (!reconnectTask)
+            {
+                return;
+            }
+
+            reconnectTask->Shared = m_reconnectShared;
+            reconnectTask->Generation = m_reconnectGeneration;
+            reconnectTask->Allocator = m_allocator;
+            aws_task_init(&reconnectTask->Task, s_OnReconnectTask, reconnectTask, "SecureTunnelReconnect");
+
+            /* Full jitter: anywhere from zero up to the exponential ceiling. */
+            uint64_t ceiling = std::min<uint64_t>(
+                m_reconnectMaxBackoffMs,
+                static_cast<uint64_t>(m_reconnectMinBackoffMs) << std::min(m_reconnectAttempts, s_maxBackoffDoublings));
+            uint32_t random = 0;
+            aws_device_random_u32(&random);
+            uint64_t delayMs = std::max<uint64_t>(minDelayMs, random % (ceiling + 1));
+            if (m_reconnectAttempts < s_maxBackoffDoublings)
+            {
+                ++m_reconnectAttempts;
+            }
+
+            aws_event_loop *eventLoop = GetTaskEventLoop();
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(eventLoop, &now);
+            uint64_t delay = aws_timestamp_convert(delayMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+            aws_event_loop_schedule_task_future(eventLoop, &reconnectTask->Task, now + delay);
+            AWS_IOTDEVICE_LOG_DEBUG(
+                Iotdevicecommon::LogSubsystem::SecureTunneling,
+                "reconnect scheduled",
+                {{"delay_ms", delayMs}, {"attempt", m_reconnectAttempts}});
+        }
+
+        void SecureTunnel::Reconnect(uint64_t generation)
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_sendLock);
+                if (!m_reconnecting || m_connected || generation != m_reconnectGeneration)
+                {
+                    return;
+                }
+            }
+
+            aws_secure_tunnel_connect(m_secure_tunnel);
+
+            /*
+             * A failed attempt is not reported back, so the next one is queued either way and stands down if
+             * this one connects. Waiting at least the connect timeout keeps attempts from overlapping.
+             */
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            if (m_reconnecting && !m_connected && generation == m_reconnectGeneration)
+            {
+                ScheduleReconnect(m_socketOptions.GetConnectTimeoutMs());
+            }
+        }
+
+        void SecureTunnel::s_OnReconnectTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *reconnectTask = static_cast<ReconnectTask *>(arg);
+            if (status == AWS_TASK_STATUS_RUN_READY)
+            {
+                std::lock_guard<std::mutex> guard(reconnectTask->Shared->Lock);
+                if (reconnectTask->Shared->Tunnel)
+                {
+                    reconnectTask->Shared->Tunnel->Reconnect(reconnectTask->Generation);
+                }
+            }
+
+            Crt::Delete(reconnectTask, reconnectTask->Allocator);
+        }
+
+        aws_event_loop *SecureTunnel::GetTaskEventLoop()
+        {
+            return m_eventLoop ? m_eventLoop : aws_event_loop_group_get_next_loop(m_bootstrap->event_loop_group);
+        }
+
+        void SecureTunnel::ScheduleKeepAlive()
+        {
+            if (m_keepAliveScheduled || m_keepAliveIntervalMs == 0)
+            {
+                return;
+            }
+
+            auto *keepAliveTask = Crt::New<ReconnectTask>(m_allocator);
+            if (!keepAliveTask)
+            {
+                return;
+            }
+
+            keepAliveTask->Shared = m_reconnectShared;
+            keepAliveTask->Generation = m_reconnectGeneration;
+            keepAliveTask->Allocator = m_allocator;
+            aws_task_init(&keepAliveTask->Task, s_OnKeepAliveTask, keepAliveTask, "SecureTunnelKeepAlive");
+            m_keepAliveScheduled = true;
+
+            aws_event_loop *eventLoop = GetTaskEventLoop();
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(eventLoop, &now);
+            uint64_t delay = m_keepAliveIntervalMs * s_nsPerMs;
+            aws_event_loop_schedule_task_future(eventLoop, &keepAliveTask->Task, now + delay);
+        }
+
+        void SecureTunnel::CheckKeepAlive(uint64_t generation)
+        {
+            uint64_t stalledMs = 0;
+            {
+                std::lock_guard<std::mutex> guard(m_sendLock);
+                m_keepAliveScheduled = false;
+                if (!m_connected || m_keepAliveIntervalMs == 0)
+                {
+                    /* The next connect starts the checks again. */
+                    return;
+                }
+
+                uint64_t nowNs = 0;
+                aws_high_res_clock_get_ticks(&nowNs);
+                if (generation == m_reconnectGeneration && m_inFlightFrames > 0 &&
+                    nowNs - m_lastSendProgressNs >= m_keepAliveTimeoutMs * s_nsPerMs)
+                {
+                    stalledMs = (nowNs - m_lastSendProgressNs) / s_nsPerMs;
+                }
+                else
+                {
+                    ScheduleKeepAlive();
+                }
+            }
+
+            if (stalledMs > 0)
+            {
+                /* Not Close(): the drop is left for the reconnect policy to recover from. */
+                AWS_IOTDEVICE_LOG_WARN(
+                    Iotdevicecommon::LogSubsystem::SecureTunneling, "keep-alive timeout", {{"stalled_ms", stalledMs}});
+                aws_secure_tunnel_close(m_secure_tunnel);
+            }
+        }
+
+        void SecureTunnel::s_OnKeepAliveTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *keepAliveTask = static_cast<ReconnectTask *>(arg);
+            if (status == AWS_TASK_STATUS_RUN_READY)
+            {
+                std::lock_guard<std::mutex> guard(keepAliveTask->Shared->Lock);
+                if (keepAliveTask->Shared->Tunnel)
+                {
+                    keepAliveTask->Shared->Tunnel->CheckKeepAlive(keepAliveTask->Generation);
+                }
+            }
+
+            Crt::Delete(keepAliveTask, keepAliveTask->Allocator);
+        }
+
+        int SecureTunnel::StartCompressedStream()
+        {
+            m_encoder.reset();
+            m_decoder.reset();
+            if (m_compressionLevel == 0)
+            {
+                return AWS_OP_SUCCESS;
+            }
+
+            m_encoder = Crt::MakeShared<TunnelStreamEncoder>(
+                m_allocator, m_compressionLevel, m_compressionWindowBits, s_minCompressBytes, m_allocator);
+            m_decoder = Crt::MakeShared<TunnelStreamDecoder>(m_allocator, m_compressionWindowBits, m_allocator);
+            if (!m_encoder || !m_decoder)
+            {
+                m_encoder.reset();
+                m_decoder.reset();
+                return aws_raise_error(AWS_ERROR_OOM);
+            }
+
+            /* An offer that fails to go out only leaves the peer sending uncompressed, which still decodes. */
+            m_encoded.clear();
+            m_encoder->AppendOffer(m_encoded);
+            SendToTunnel(aws_byte_cursor_from_array(m_encoded.data(), m_encoded.size()), true);
+            return AWS_OP_SUCCESS;
+        }
+
+        int SecureTunnel::SendStreamStart()
+        {
+            if (aws_secure_tunnel_stream_start(m_secure_tunnel) != AWS_OP_SUCCESS)
+            {
+                return AWS_OP_ERR;
+            }
+
+            std::lock_guard<std::mutex> guard(m_sendLock);
+            return StartCompressedStream();
+        }
+
+        int SecureTunnel::SendStreamReset()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_sendLock);
+                m_encoder.reset();
+                m_decoder.reset();
+            }
+            return aws_secure_tunnel_stream_reset(m_secure_tunnel);
+        }
 
         aws_secure_tunnel *SecureTunnel::GetUnderlyingHandle() { return m_secure_tunnel; }
 
         void SecureTunnel::s_OnConnectionComplete(void *user_data)
         {
             auto *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            int replayError = AWS_ERROR_SUCCESS;
+            {
+                std::lock_guard<std::mutex> guard(secureTunnel->m_sendLock);
+                bool resumed = secureTunnel->m_reconnecting;
+                secureTunnel->m_connected = true;
+                secureTunnel->m_reconnecting = false;
+                secureTunnel->m_reconnectAttempts = 0;
+                ++secureTunnel->m_reconnectGeneration;
+
+                /* Replay ahead of the handler, so anything it sends stays behind the data sent before the drop. */
+                if (resumed && !secureTunnel->m_replay.empty())
+                {
+                    Crt::Vector<uint8_t> replay(std::move(secureTunnel->m_replay));
+                    secureTunnel->m_replay.clear();
+                    secureTunnel->m_retainedBytes -= replay.size();
+                    if (secureTunnel->SendToTunnel(aws_byte_cursor_from_array(replay.data(), replay.size())) !=
+                        AWS_OP_SUCCESS)
+                    {
+                        replayError = aws_last_error();
+                    }
+                }
+                secureTunnel->m_replayBroken = false;
+                secureTunnel->ScheduleKeepAlive();
+                AWS_IOTDEVICE_LOG_INFO(
+                    Iotdevicecommon::LogSubsystem::SecureTunneling,
+                    "connected",
+                    {{"resumed", resumed}, {"replay_error", aws_error_name(replayError)}});
+            }
+
             secureTunnel->m_OnConnectionComplete();
+            if (replayError)
+            {
+                secureTunnel->m_OnSendDataComplete(replayError);
+            }
         }
 
         void SecureTunnel::s_OnConnectionShutdown(void *user_data)
         {
             auto *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            {
+                std::lock_guard<std::mutex> guard(secureTunnel->m_sendLock);
+                secureTunnel->m_connected = false;
+                ++secureTunnel->m_reconnectGeneration;
+                if (secureTunnel->m_reconnectMinBackoffMs > 0 && !secureTunnel->m_closed)
+                {
+                    secureTunnel->m_reconnecting = true;
+                    secureTunnel->ScheduleReconnect(0);
+                }
+                AWS_IOTDEVICE_LOG_INFO(
+                    Iotdevicecommon::LogSubsystem::SecureTunneling,
+                    "disconnected",
+                    {{"reconnecting", secureTunnel->m_reconnecting}});
+            }
+
             secureTunnel->m_OnConnectionShutdown();
         }
 
         void SecureTunnel::s_OnSendDataComplete(int error_code, void *user_data)
         {
             auto *secureTunnel = static_cast<SecureTunnel *>(user_data);
-            secureTunnel->m_OnSendDataComplete(error_code);
+            int flushError = AWS_ERROR_SUCCESS;
+            bool crossed = false;
+            bool above = false;
+            bool heldForReplay = false;
+            bool internal = false;
+            {
+                std::lock_guard<std::mutex> guard(secureTunnel->m_sendLock);
+                /* Frames complete in the order they were sent; each releases up to one frame of payload. */
+                if (!secureTunnel->m_inFlight.empty())
+                {
+                    InFlightSend &oldest = secureTunnel->m_inFlight.front();
+                    internal = oldest.Internal;
+                    aws_high_res_clock_get_ticks(&secureTunnel->m_lastSendProgressNs);
+                    if (error_code == AWS_ERROR_SUCCESS && !internal)
+                    {
+                        uint64_t nowNs = 0;
+                        aws_high_res_clock_get_ticks(&nowNs);
+                        secureTunnel->m_sendLatency.Record(nowNs - oldest.SentNs);
+                    }
+                    size_t released = oldest.Frames == 1 ? oldest.Bytes : std::min(oldest.Bytes, s_splitMessageSize);
+                    if (error_code == AWS_ERROR_SUCCESS && !internal)
+                    {
+                        secureTunnel->m_bytesSent += released;
+                    }
+                    if (oldest.Retained)
+                    {
+                        if (error_code != AWS_ERROR_SUCCESS && !secureTunnel->m_replayBroken)
+                        {
+                            /* Stays retained for the reconnect, whose send reports the outcome instead. */
+                            const uint8_t *first = oldest.Data.buffer + oldest.DataOffset;
+                            secureTunnel->m_replay.insert(secureTunnel->m_replay.end(), first, first + released);
+                            heldForReplay = true;
+                        }
+                        else
+                        {
+                            secureTunnel->m_retainedBytes -= released;
+                        }
+                        oldest.DataOffset += released;
+                    }
+                    else if (error_code != AWS_ERROR_SUCCESS && secureTunnel->m_replayLimit > 0)
+                    {
+                        secureTunnel->DiscardReplay();
+                        secureTunnel->m_replayBroken = true;
+                    }
+                    oldest.Bytes -= released;
+                    --oldest.Frames;
+                    secureTunnel->m_inFlightBytes -= released;
+                    --secureTunnel->m_inFlightFrames;
+                    if (oldest.Frames == 0)
+                    {
+                        if (secureTunnel->m_framePool)
+                        {
+                            secureTunnel->m_framePool->Release(oldest.Data);
+                        }
+                        aws_byte_buf_clean_up(&oldest.Data);
+                        secureTunnel->m_inFlight.pop_front();
+                    }
+                }
+
+                if (secureTunnel->m_inFlightFrames == 0 && !secureTunnel->m_sendBatch.empty() &&
+                    secureTunnel->SendWithBatch(nullptr, 0) != AWS_OP_SUCCESS)
+                {
+                    flushError = aws_last_error();
+                }
+                crossed = secureTunnel->UpdateWatermark();
+                above = secureTunnel->m_aboveHighWatermark;
+            }
+
+            if (!heldForReplay && !internal)
+            {
+                secureTunnel->m_OnSendDataComplete(error_code);
+            }
+            if (flushError)
+            {
+                secureTunnel->m_OnSendDataComplete(flushError);
+            }
+            if (crossed)
+            {
+                secureTunnel->NotifyWatermark(above);
+            }
         }
 
         void SecureTunnel::s_OnDataReceive(const struct aws_byte_buf *data, void *user_data)
         {
             auto *secureTunnel = static_cast<SecureTunnel *>(user_data);
-            secureTunnel->m_OnDataReceive(*data);
+            std::shared_ptr<TunnelStreamDecoder> decoder;
+            {
+                std::lock_guard<std::mutex> guard(secureTunnel->m_sendLock);
+                secureTunnel->m_bytesReceived += data->len;
+                decoder = secureTunnel->m_decoder;
+            }
+            if (!decoder)
+            {
+                secureTunnel->m_OnDataReceive(*data);
+                return;
+            }
+
+            int peerWindowBits = -1;
+            int result = decoder->Decode(
+                aws_byte_cursor_from_buf(data), peerWindowBits, [secureTunnel](const Crt::ByteCursor &decoded) {
+                    Crt::ByteBuf lent = aws_byte_buf_from_array(decoded.ptr, decoded.len);
+                    secureTunnel->m_OnDataReceive(lent);
+                });
+
+            {
+                std::lock_guard<std::mutex> guard(secureTunnel->m_sendLock);
+                if (result != AWS_OP_SUCCESS)
+                {
+                    /* The rest of the stream cannot be decoded, so end it at both ends. */
+                    secureTunnel->m_encoder.reset();
+                    secureTunnel->m_decoder.reset();
+                    secureTunnel->DiscardReplay();
+                }
+                else if (peerWindowBits >= 0 && secureTunnel->m_encoder && secureTunnel->m_decoder == decoder)
+                {
+                    secureTunnel->m_encoder->OnPeerOffer(peerWindowBits);
+                }
+            }
+
+            if (result != AWS_OP_SUCCESS)
+            {
+                aws_secure_tunnel_stream_reset(secureTunnel->m_secure_tunnel);
+                secureTunnel->m_OnStreamReset();
+            }
         }
 
         void SecureTunnel::s_OnStreamStart(void *user_data)
         {
             auto *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            int result = AWS_OP_SUCCESS;
+            {
+                std::lock_guard<std::mutex> guard(secureTunnel->m_sendLock);
+                result = secureTunnel->StartCompressedStream();
+            }
+
+            AWS_IOTDEVICE_LOG_DEBUG(
+                Iotdevicecommon::LogSubsystem::SecureTunneling,
+                "stream start",
+                {{"error", aws_error_name(result == AWS_OP_SUCCESS ? AWS_ERROR_SUCCESS : aws_last_error())}});
+            if (result != AWS_OP_SUCCESS)
+            {
+                /* The peer frames its data, so the stream is unusable without a decoder. */
+                aws_secure_tunnel_stream_reset(secureTunnel->m_secure_tunnel);
+                secureTunnel->m_OnStreamReset();
+                return;
+            }
             secureTunnel->m_OnStreamStart();
         }
 
         void SecureTunnel::s_OnStreamReset(void *user_data)
         {
             auto *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            {
+                std::lock_guard<std::mutex> guard(secureTunnel->m_sendLock);
+                secureTunnel->DiscardReplay();
+                secureTunnel->m_encoder.reset();
+                secureTunnel->m_decoder.reset();
+            }
+            AWS_IOTDEVICE_LOG_DEBUG(Iotdevicecommon::LogSubsystem::SecureTunneling, "stream reset");
             secureTunnel->m_OnStreamReset();
         }
 
         void SecureTunnel::s_OnSessionReset(void *user_data)
         {
             auto *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            {
+                std::lock_guard<std::mutex> guard(secureTunnel->m_sendLock);
+                secureTunnel->DiscardReplay();
+                secureTunnel->m_encoder.reset();
+                secureTunnel->m_decoder.reset();
+            }
+            AWS_IOTDEVICE_LOG_DEBUG(Iotdevicecommon::LogSubsystem::SecureTunneling, "session reset");
             secureTunnel->m_OnSessionReset();
         }
 
@@ -0,0 +1,182 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/SecureTunnelHost.h>
+
+#include <aws/io/event_loop.h>
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        namespace
+        {
+            void s_mergeLatency(Iotdevicecommon::LatencyHistogram &into, const Iotdevicecommon::LatencyHistogram &from)
+            {
+                for (size_t i = 0; i < Iotdevicecommon::LatencyHistogram::BucketCount; ++i)
+                {
+                    into.Buckets[i] += from.Buckets[i];
+                }
+                into.Count += from.Count;
+                into.TotalNs += from.TotalNs;
+            }
+        } // namespace
+
+        SecureTunnelHostConfig::SecureTunnelHostConfig() noexcept
+            : ClientBootstrap(nullptr), EventLoopGroup(nullptr), TunnelSocketOptions(), RootCa()
+        {
+        }
+
+        SecureTunnelHostMetrics::SecureTunnelHostMetrics() noexcept
+            : Tunnels(0), TunnelsPerLoop(), BytesSent(0), BytesReceived(0), QueuedBytes(0), UpstreamLatency(),
+              DownstreamLatency()
+        {
+        }
+
+        SecureTunnelHost::SecureTunnelHost(const SecureTunnelHostConfig &config, Crt::Allocator *allocator) noexcept
+            : m_config(config), m_allocator(allocator), m_tunnels(),
+              m_tunnelsPerLoop(aws_event_loop_group_get_loop_count(config.EventLoopGroup->GetUnderlyingHandle()), 0)
+        {
+        }
+
+        SecureTunnelHost::~SecureTunnelHost()
+        {
+            CloseAll();
+        }
+
+        std::shared_ptr<SecureTunnelHost> SecureTunnelHost::Create(
+            const SecureTunnelHostConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (!config.ClientBootstrap || !config.EventLoopGroup ||
+                aws_event_loop_group_get_loop_count(config.EventLoopGroup->GetUnderlyingHandle()) == 0)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<SecureTunnelHost *>(aws_mem_acquire(allocator, sizeof(SecureTunnelHost)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) SecureTunnelHost(config, allocator);
+            return std::shared_ptr<SecureTunnelHost>(
+                toSeat, [allocator](SecureTunnelHost *host) { Crt::Delete(host, allocator); });
+        }
+
+        std::shared_ptr<LocalProxy> SecureTunnelHost::Open(const LocalProxyConfig &config)
+        {
+            /* The slot is taken up front, so tunnels opened concurrently do not all land on the same loop. */
+            size_t loop = 0;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                for (size_t i = 1; i < m_tunnelsPerLoop.size(); ++i)
+                {
+                    if (m_tunnelsPerLoop[i] < m_tunnelsPerLoop[loop])
+                    {
+                        loop = i;
+                    }
+                }
+                ++m_tunnelsPerLoop[loop];
+            }
+
+            aws_event_loop_group *group = m_config.EventLoopGroup->GetUnderlyingHandle();
+            LocalProxyConfig proxyConfig(config);
+            proxyConfig.ClientBootstrap = m_config.ClientBootstrap;
+            proxyConfig.EventLoopGroup = m_config.EventLoopGroup;
+            proxyConfig.EventLoop = aws_event_loop_group_get_loop_at(group, loop);
+            proxyConfig.TunnelSocketOptions = m_config.TunnelSocketOptions;
+            proxyConfig.RootCa = m_config.RootCa;
+
+            auto proxy = LocalProxy::Create(proxyConfig, m_allocator);
+            if (!proxy || proxy->Start())
+            {
+                int errorCode = aws_last_error();
+                std::lock_guard<std::mutex> guard(m_lock);
+                --m_tunnelsPerLoop[loop];
+                aws_raise_error(errorCode);
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_tunnels.push_back({proxy, loop});
+            return proxy;
+        }
+
+        void SecureTunnelHost::Close(const std::shared_ptr<LocalProxy> &proxy)
+        {
+            bool hosted = false;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                for (size_t i = 0; i < m_tunnels.size(); ++i)
+                {
+                    if (m_tunnels[i].Proxy == proxy)
+                    {
+                        --m_tunnelsPerLoop[m_tunnels[i].Loop];
+                        m_tunnels[i] = std::move(m_tunnels.back());
+                        m_tunnels.pop_back();
+                        hosted = true;
+                        break;
+                    }
+                }
+            }
+
+            if (hosted)
+            {
+                proxy->Stop();
+            }
+        }
+
+        void SecureTunnelHost::CloseAll()
+        {
+            Crt::Vector<HostedTunnel> tunnels;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                tunnels.swap(m_tunnels);
+                for (size_t &count : m_tunnelsPerLoop)
+                {
+                    count = 0;
+                }
+            }
+
+            for (HostedTunnel &tunnel : tunnels)
+            {
+                tunnel.Proxy->Stop();
+            }
+        }
+
+        size_t SecureTunnelHost::GetTunnelCount() const
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            return m_tunnels.size();
+        }
+
+        SecureTunnelHostMetrics SecureTunnelHost::GetMetrics() const
+        {
+            /* Each tunnel takes its own locks, so they are read from a snapshot rather than under m_lock. */
+            Crt::Vector<HostedTunnel> tunnels;
+            SecureTunnelHostMetrics metrics;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                tunnels = m_tunnels;
+                metrics.TunnelsPerLoop = m_tunnelsPerLoop;
+            }
+
+            metrics.Tunnels = tunnels.size();
+            for (HostedTunnel &tunnel : tunnels)
+            {
+                SecureTunnel &secureTunnel = tunnel.Proxy->GetTunnel();
+                metrics.BytesSent += secureTunnel.GetBytesSent();
+                metrics.BytesReceived += secureTunnel.GetBytesReceived();
+                metrics.QueuedBytes += secureTunnel.GetQueuedBytes();
+                s_mergeLatency(metrics.UpstreamLatency, tunnel.Proxy->GetUpstreamLatency());
+                s_mergeLatency(metrics.DownstreamLatency, tunnel.Proxy->GetDownstreamLatency());
+            }
+            return metrics;
+        }
+    } // namespace Iotsecuretunneling
+} // namespace Aws
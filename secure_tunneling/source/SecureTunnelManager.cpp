@@ -0,0 +1,295 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/SecureTunnelManager.h>
+
+#include <aws/iotsecuretunneling/SubscribeToTunnelsNotifyRequest.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/string.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
+
+#include <algorithm>
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        namespace
+        {
+            void s_onPrewarmResolved(aws_host_resolver *, const aws_string *, int, const aws_array_list *, void *)
+            {
+                /* Nothing to do: resolving is what fills the resolver's cache. */
+            }
+        } // namespace
+
+        struct SecureTunnelManager::PrewarmTask
+        {
+            aws_task Task;
+            std::weak_ptr<SecureTunnelManager> Manager;
+            Crt::Allocator *Allocator;
+        };
+
+        SecureTunnelManagerConfig::SecureTunnelManagerConfig() noexcept
+            : Connection(), ThingName(), ClientBootstrap(nullptr), EventLoopGroup(nullptr), TunnelSocketOptions(),
+              RootCa(), LocalHost("127.0.0.1"), LocalSocketOptions(), ServicePorts(), HostResolver(nullptr), Region(),
+              PrewarmRefreshSeconds(60), OnTunnelOpened()
+        {
+        }
+
+        SecureTunnelManager::SecureTunnelManager(const SecureTunnelManagerConfig &config, Crt::Allocator *allocator)
+            noexcept
+            : m_config(config), m_allocator(allocator), m_stopped(false), m_prewarmScheduled(false)
+        {
+        }
+
+        std::shared_ptr<SecureTunnelManager> SecureTunnelManager::Create(
+            const SecureTunnelManagerConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (!config.Connection || config.ThingName.empty() || !config.EventLoopGroup)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<SecureTunnelManager *>(aws_mem_acquire(allocator, sizeof(SecureTunnelManager)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) SecureTunnelManager(config, allocator);
+            return std::shared_ptr<SecureTunnelManager>(
+                toSeat, [allocator](SecureTunnelManager *manager) { Crt::Delete(manager, allocator); });
+        }
+
+        Crt::String SecureTunnelManager::GetTunnelEndpoint(const Crt::String &region)
+        {
+            Crt::String endpoint("data.tunneling.iot.");
+            endpoint.append(region).append(".amazonaws.com");
+            return endpoint;
+        }
+
+        bool SecureTunnelManager::Start(const OnSubscribeComplete &onSubAck)
+        {
+            if (m_config.Region)
+            {
+                AddPrewarmHost(GetTunnelEndpoint(*m_config.Region));
+            }
+
+            SubscribeToTunnelsNotifyRequest request;
+            request.ThingName = m_config.ThingName;
+
+            std::weak_ptr<SecureTunnelManager> weakManager = shared_from_this();
+            IotSecureTunnelingClient client(m_config.Connection);
+            return client.SubscribeToTunnelsNotify(
+                request,
+                AWS_MQTT_QOS_AT_LEAST_ONCE,
+                [weakManager](SecureTunnelingNotifyResponse *response, int ioErr) {
+                    auto manager = weakManager.lock();
+                    if (manager && response && !ioErr)
+                    {
+                        manager->OnNotify(*response);
+                    }
+                },
+                onSubAck);
+        }
+
+        void SecureTunnelManager::Stop()
+        {
+            Crt::Map<Crt::String, std::shared_ptr<LocalProxy>> proxies;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_stopped = true;
+                proxies.swap(m_proxies);
+            }
+
+            for (auto &proxy : proxies)
+            {
+                proxy.second->Stop();
+            }
+        }
+
+        void SecureTunnelManager::AddPrewarmHost(const Crt::String &host)
+        {
+            if (!m_config.HostResolver)
+            {
+                return;
+            }
+
+            bool schedule = false;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (m_stopped ||
+                    std::find(m_prewarmHosts.begin(), m_prewarmHosts.end(), host) != m_prewarmHosts.end())
+                {
+                    return;
+                }
+                m_prewarmHosts.push_back(host);
+                schedule = m_config.PrewarmRefreshSeconds > 0 && !m_prewarmScheduled;
+                m_prewarmScheduled = m_prewarmScheduled || schedule;
+            }
+
+            Prewarm(host);
+            if (schedule)
+            {
+                SchedulePrewarm();
+            }
+        }
+
+        void SecureTunnelManager::SchedulePrewarm()
+        {
+            auto *prewarmTask = Crt::New<PrewarmTask>(m_allocator);
+            if (!prewarmTask)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_prewarmScheduled = false;
+                return;
+            }
+
+            prewarmTask->Manager = shared_from_this();
+            prewarmTask->Allocator = m_allocator;
+            aws_task_init(&prewarmTask->Task, s_OnPrewarmTask, prewarmTask, "SecureTunnelPrewarm");
+
+            aws_event_loop *eventLoop =
+                aws_event_loop_group_get_next_loop(m_config.EventLoopGroup->GetUnderlyingHandle());
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(eventLoop, &now);
+            uint64_t delay = aws_timestamp_convert(
+                m_config.PrewarmRefreshSeconds, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+            aws_event_loop_schedule_task_future(eventLoop, &prewarmTask->Task, now + delay);
+        }
+
+        void SecureTunnelManager::s_OnPrewarmTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *prewarmTask = static_cast<PrewarmTask *>(arg);
+            auto manager = prewarmTask->Manager.lock();
+            Crt::Delete(prewarmTask, prewarmTask->Allocator);
+            if (!manager)
+            {
+                return;
+            }
+
+            Crt::Vector<Crt::String> hosts;
+            {
+                std::lock_guard<std::mutex> guard(manager->m_lock);
+                if (status != AWS_TASK_STATUS_RUN_READY || manager->m_stopped)
+                {
+                    manager->m_prewarmScheduled = false;
+                    return;
+                }
+                hosts = manager->m_prewarmHosts;
+            }
+
+            for (const Crt::String &host : hosts)
+            {
+                manager->Prewarm(host);
+            }
+            manager->SchedulePrewarm();
+        }
+
+        void SecureTunnelManager::Prewarm(const Crt::String &host)
+        {
+            if (!m_config.HostResolver)
+            {
+                return;
+            }
+
+            /* The resolver copies the host name, so it can go as soon as the request is queued. */
+            aws_string *hostName = aws_string_new_from_c_str(m_allocator, host.c_str());
+            if (!hostName)
+            {
+                return;
+            }
+
+            aws_host_resolver_resolve_host(
+                m_config.HostResolver->GetUnderlyingHandle(),
+                hostName,
+                s_onPrewarmResolved,
+                m_config.HostResolver->GetConfig(),
+                nullptr);
+            aws_string_destroy(hostName);
+        }
+
+        void SecureTunnelManager::OnNotify(const SecureTunnelingNotifyResponse &notification)
+        {
+            /* Source tokens belong to the operator side; this device can only be the destination. */
+            if (!notification.ClientAccessToken || !notification.Region || !notification.ClientMode ||
+                *notification.ClientMode != "destination" || !notification.Services)
+            {
+                return;
+            }
+
+            const Crt::String *service = nullptr;
+            uint16_t localPort = 0;
+            for (const Crt::String &requested : *notification.Services)
+            {
+                auto port = m_config.ServicePorts.find(requested);
+                if (port != m_config.ServicePorts.end())
+                {
+                    service = &requested;
+                    localPort = port->second;
+                    break;
+                }
+            }
+            if (!service)
+            {
+                return;
+            }
+
+            Crt::String endpoint = GetTunnelEndpoint(*notification.Region);
+            AddPrewarmHost(endpoint);
+
+            LocalProxyConfig proxyConfig;
+            proxyConfig.ClientBootstrap = m_config.ClientBootstrap;
+            proxyConfig.TunnelSocketOptions = m_config.TunnelSocketOptions;
+            proxyConfig.AccessToken = notification.ClientAccessToken->c_str();
+            proxyConfig.LocalProxyMode = AWS_SECURE_TUNNELING_DESTINATION_MODE;
+            proxyConfig.EndpointHost = endpoint.c_str();
+            proxyConfig.RootCa = m_config.RootCa;
+            proxyConfig.EventLoopGroup = m_config.EventLoopGroup;
+            proxyConfig.LocalHost = m_config.LocalHost;
+            proxyConfig.LocalPort = localPort;
+            proxyConfig.LocalSocketOptions = m_config.LocalSocketOptions;
+
+            int errorCode = AWS_ERROR_SUCCESS;
+            auto proxy = LocalProxy::Create(proxyConfig, m_allocator);
+            if (!proxy || proxy->Start())
+            {
+                errorCode = aws_last_error();
+                proxy = nullptr;
+            }
+
+            std::shared_ptr<LocalProxy> replaced;
+            if (proxy)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (m_stopped)
+                {
+                    replaced = proxy;
+                    proxy = nullptr;
+                    errorCode = AWS_ERROR_INVALID_STATE;
+                }
+                else
+                {
+                    std::shared_ptr<LocalProxy> &slot = m_proxies[*service];
+                    replaced = slot;
+                    slot = proxy;
+                }
+            }
+            if (replaced)
+            {
+                replaced->Stop();
+            }
+
+            if (m_config.OnTunnelOpened)
+            {
+                m_config.OnTunnelOpened(proxy, notification, errorCode);
+            }
+        }
+    } // namespace Iotsecuretunneling
+} // namespace Aws
@@ -0,0 +1,344 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/TunnelCompression.h>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef AWS_SECURE_TUNNELING_ZLIB
+#    include <zlib.h>
+#endif
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        namespace
+        {
+            /* Record tags. Records with other tags are skipped, so later versions can add their own. */
+            const uint8_t s_rawTag = 0;
+            const uint8_t s_deflateTag = 1;
+            const uint8_t s_offerTag = 2;
+
+            /* A tag byte and up to five varint bytes for a 32 bit length. */
+            const size_t s_maxHeaderBytes = 6;
+            /* Larger writes are split into several records. */
+            const size_t s_maxRecordInput = 1 << 30;
+
+            const int s_minWindowBits = 9;
+            const int s_maxWindowBits = 15;
+            const size_t s_inflateChunkBytes = 16 * 1024;
+
+            int s_clampWindowBits(int windowBits)
+            {
+                return std::max(s_minWindowBits, std::min(s_maxWindowBits, windowBits));
+            }
+
+            void s_appendHeader(Crt::Vector<uint8_t> &out, uint8_t tag, size_t length)
+            {
+                out.push_back(tag);
+                do
+                {
+                    uint8_t bits = static_cast<uint8_t>(length & 0x7f);
+                    length >>= 7;
+                    out.push_back(length ? static_cast<uint8_t>(bits | 0x80) : bits);
+                } while (length);
+            }
+
+#ifdef AWS_SECURE_TUNNELING_ZLIB
+            void *s_zalloc(void *opaque, uInt items, uInt size)
+            {
+                return aws_mem_acquire(static_cast<Crt::Allocator *>(opaque), static_cast<size_t>(items) * size);
+            }
+
+            void s_zfree(void *opaque, void *address)
+            {
+                aws_mem_release(static_cast<Crt::Allocator *>(opaque), address);
+            }
+
+            z_stream *s_newStream(Crt::Allocator *allocator)
+            {
+                auto *stream = static_cast<z_stream *>(aws_mem_calloc(allocator, 1, sizeof(z_stream)));
+                if (stream)
+                {
+                    stream->zalloc = s_zalloc;
+                    stream->zfree = s_zfree;
+                    stream->opaque = allocator;
+                }
+                return stream;
+            }
+#endif
+        } // namespace
+
+        TunnelStreamEncoder::TunnelStreamEncoder(
+            int level,
+            int windowBits,
+            size_t minCompressBytes,
+            Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_level(std::max(1, std::min(9, level))),
+              m_windowBits(s_clampWindowBits(windowBits)), m_minCompressBytes(minCompressBytes), m_deflate(nullptr),
+              m_scratch(allocator), m_bytesIn(0), m_bytesOut(0)
+        {
+        }
+
+        TunnelStreamEncoder::~TunnelStreamEncoder()
+        {
+#ifdef AWS_SECURE_TUNNELING_ZLIB
+            if (m_deflate)
+            {
+                deflateEnd(m_deflate);
+                aws_mem_release(m_allocator, m_deflate);
+            }
+#endif
+        }
+
+        bool TunnelStreamEncoder::IsDeflateSupported() noexcept
+        {
+#ifdef AWS_SECURE_TUNNELING_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        void TunnelStreamEncoder::AppendOffer(Crt::Vector<uint8_t> &out) const
+        {
+            s_appendHeader(out, s_offerTag, 1);
+            out.push_back(static_cast<uint8_t>(IsDeflateSupported() ? m_windowBits : 0));
+        }
+
+        void TunnelStreamEncoder::OnPeerOffer(int peerWindowBits) noexcept
+        {
+#ifdef AWS_SECURE_TUNNELING_ZLIB
+            if (m_deflate || peerWindowBits < s_minWindowBits)
+            {
+                return;
+            }
+
+            z_stream *stream = s_newStream(m_allocator);
+            if (!stream)
+            {
+                return;
+            }
+
+            /* A deflate window wider than the peer inflates would reference bytes it no longer has. */
+            int windowBits = std::min(m_windowBits, s_clampWindowBits(peerWindowBits));
+            int memLevel = std::max(1, std::min(8, windowBits - 7));
+            if (deflateInit2(stream, m_level, Z_DEFLATED, -windowBits, memLevel, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                /* Raw records then carry the stream, which the peer decodes just the same. */
+                aws_mem_release(m_allocator, stream);
+                return;
+            }
+            m_deflate = stream;
+#else
+            (void)peerWindowBits;
+#endif
+        }
+
+        int TunnelStreamEncoder::Append(const Crt::ByteCursor &data, Crt::Vector<uint8_t> &out)
+        {
+            size_t start = out.size();
+            Crt::ByteCursor rest = data;
+            while (rest.len > 0)
+            {
+                Crt::ByteCursor chunk = aws_byte_cursor_advance(&rest, std::min(rest.len, s_maxRecordInput));
+                if (!m_deflate || chunk.len < m_minCompressBytes)
+                {
+                    s_appendHeader(out, s_rawTag, chunk.len);
+                    out.insert(out.end(), chunk.ptr, chunk.ptr + chunk.len);
+                    continue;
+                }
+
+#ifdef AWS_SECURE_TUNNELING_ZLIB
+                /* The sync flush ends the record on a byte boundary, so the peer can inflate all of it at once. */
+                size_t bound = deflateBound(m_deflate, static_cast<uLong>(chunk.len)) + 16;
+                if (m_scratch.size() < bound)
+                {
+                    m_scratch.resize(bound);
+                }
+
+                m_deflate->next_in = const_cast<Bytef *>(chunk.ptr);
+                m_deflate->avail_in = static_cast<uInt>(chunk.len);
+                size_t produced = 0;
+                do
+                {
+                    if (produced == m_scratch.size())
+                    {
+                        m_scratch.resize(m_scratch.size() * 2);
+                    }
+                    m_deflate->next_out = m_scratch.data() + produced;
+                    m_deflate->avail_out = static_cast<uInt>(m_scratch.size() - produced);
+                    int result = deflate(m_deflate, Z_SYNC_FLUSH);
+                    if (result != Z_OK && result != Z_BUF_ERROR)
+                    {
+                        out.resize(start);
+                        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+                    }
+                    produced = m_scratch.size() - m_deflate->avail_out;
+                } while (m_deflate->avail_out == 0);
+
+                s_appendHeader(out, s_deflateTag, produced);
+                out.insert(out.end(), m_scratch.data(), m_scratch.data() + produced);
+#endif
+            }
+
+            m_bytesIn += data.len;
+            m_bytesOut += out.size() - start;
+            return AWS_OP_SUCCESS;
+        }
+
+        TunnelStreamDecoder::TunnelStreamDecoder(int windowBits, Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator),
+              m_windowBits(TunnelStreamEncoder::IsDeflateSupported() ? s_clampWindowBits(windowBits) : 0),
+              m_inflate(nullptr), m_output(allocator), m_inHeader(true), m_failed(false), m_tag(0), m_length(0),
+              m_lengthShift(0), m_headerBytes(0), m_remaining(0)
+        {
+        }
+
+        TunnelStreamDecoder::~TunnelStreamDecoder()
+        {
+#ifdef AWS_SECURE_TUNNELING_ZLIB
+            if (m_inflate)
+            {
+                inflateEnd(m_inflate);
+                aws_mem_release(m_allocator, m_inflate);
+            }
+#endif
+        }
+
+        int TunnelStreamDecoder::Decode(
+            const Crt::ByteCursor &message,
+            int &peerWindowBits,
+            const OnDecodedData &onData)
+        {
+            if (m_failed)
+            {
+                return aws_raise_error(AWS_ERROR_INVALID_STATE);
+            }
+
+            Crt::ByteCursor data = message;
+            while (data.len > 0)
+            {
+                if (m_inHeader)
+                {
+                    uint8_t byte = *data.ptr;
+                    aws_byte_cursor_advance(&data, 1);
+                    if (m_headerBytes++ == 0)
+                    {
+                        m_tag = byte;
+                        m_length = 0;
+                        m_lengthShift = 0;
+                        continue;
+                    }
+
+                    /* The fifth length byte has room for the top four bits only. */
+                    if (m_headerBytes > s_maxHeaderBytes || (m_lengthShift == 28 && (byte & 0x70)))
+                    {
+                        m_failed = true;
+                        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                    }
+                    m_length |= static_cast<uint32_t>(byte & 0x7f) << m_lengthShift;
+                    m_lengthShift += 7;
+                    if (byte & 0x80)
+                    {
+                        continue;
+                    }
+
+                    m_headerBytes = 0;
+                    m_remaining = m_length;
+                    m_inHeader = m_remaining == 0;
+                    continue;
+                }
+
+                Crt::ByteCursor chunk = aws_byte_cursor_advance(&data, std::min<size_t>(m_remaining, data.len));
+                switch (m_tag)
+                {
+                    case s_rawTag:
+                        onData(chunk);
+                        break;
+                    case s_deflateTag:
+                        if (DecodeDeflated(chunk, onData) != AWS_OP_SUCCESS)
+                        {
+                            m_failed = true;
+                            return AWS_OP_ERR;
+                        }
+                        break;
+                    case s_offerTag:
+                        if (m_remaining == m_length)
+                        {
+                            peerWindowBits = chunk.ptr[0];
+                        }
+                        break;
+                    default:
+                        break;
+                }
+
+                m_remaining -= static_cast<uint32_t>(chunk.len);
+                m_inHeader = m_remaining == 0;
+            }
+
+            return AWS_OP_SUCCESS;
+        }
+
+        int TunnelStreamDecoder::DecodeDeflated(const Crt::ByteCursor &data, const OnDecodedData &onData)
+        {
+#ifdef AWS_SECURE_TUNNELING_ZLIB
+            /* Deflated data only arrives after this end offered a window, so without one the stream is corrupt. */
+            if (m_windowBits == 0)
+            {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+
+            if (!m_inflate)
+            {
+                z_stream *stream = s_newStream(m_allocator);
+                if (!stream)
+                {
+                    return aws_raise_error(AWS_ERROR_OOM);
+                }
+                if (inflateInit2(stream, -m_windowBits) != Z_OK)
+                {
+                    aws_mem_release(m_allocator, stream);
+                    return aws_raise_error(AWS_ERROR_OOM);
+                }
+                m_inflate = stream;
+                m_output.resize(s_inflateChunkBytes);
+            }
+
+            m_inflate->next_in = const_cast<Bytef *>(data.ptr);
+            m_inflate->avail_in = static_cast<uInt>(data.len);
+            do
+            {
+                m_inflate->next_out = m_output.data();
+                m_inflate->avail_out = static_cast<uInt>(m_output.size());
+                int result = inflate(m_inflate, Z_SYNC_FLUSH);
+                /* The encoder never ends its deflate stream, so an end marker is as corrupt as bad data. */
+                if (result != Z_OK && result != Z_BUF_ERROR)
+                {
+                    return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                }
+
+                size_t produced = m_output.size() - m_inflate->avail_out;
+                if (produced > 0)
+                {
+                    onData(aws_byte_cursor_from_array(m_output.data(), produced));
+                }
+                if (result == Z_BUF_ERROR)
+                {
+                    break;
+                }
+            } while (m_inflate->avail_in > 0 || m_inflate->avail_out == 0);
+
+            return AWS_OP_SUCCESS;
+#else
+            (void)data;
+            (void)onData;
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+#endif
+        }
+    } // namespace Iotsecuretunneling
+} // namespace Aws
@@ -0,0 +1,108 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/TunnelFrameBufferPool.h>
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        const size_t TunnelFrameBufferPool::MinClassBytes;
+        const size_t TunnelFrameBufferPool::MaxClassBytes;
+        const size_t TunnelFrameBufferPool::ClassCount;
+
+        TunnelFrameBufferPool::TunnelFrameBufferPool(size_t capacityBytes, Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_capacityBytes(capacityBytes), m_pooledBytes(0), m_allocations(0)
+        {
+        }
+
+        TunnelFrameBufferPool::~TunnelFrameBufferPool()
+        {
+            m_capacityBytes = 0;
+            Trim();
+        }
+
+        size_t TunnelFrameBufferPool::ClassOf(size_t bytes) noexcept
+        {
+            size_t classBytes = MinClassBytes;
+            for (size_t sizeClass = 0; sizeClass < ClassCount; ++sizeClass, classBytes <<= 1)
+            {
+                if (bytes <= classBytes)
+                {
+                    return sizeClass;
+                }
+            }
+            return ClassCount;
+        }
+
+        Crt::ByteBuf TunnelFrameBufferPool::Acquire(size_t bytes) noexcept
+        {
+            size_t sizeClass = ClassOf(bytes);
+            if (sizeClass < ClassCount && !m_free[sizeClass].empty())
+            {
+                Crt::ByteBuf buffer = m_free[sizeClass].back();
+                m_free[sizeClass].pop_back();
+                m_pooledBytes -= buffer.capacity;
+                buffer.len = 0;
+                return buffer;
+            }
+
+            Crt::ByteBuf buffer;
+            AWS_ZERO_STRUCT(buffer);
+            size_t capacity = sizeClass < ClassCount ? MinClassBytes << sizeClass : bytes;
+            if (aws_byte_buf_init(&buffer, m_allocator, capacity) != AWS_OP_SUCCESS)
+            {
+                AWS_ZERO_STRUCT(buffer);
+                return buffer;
+            }
+            ++m_allocations;
+            return buffer;
+        }
+
+        void TunnelFrameBufferPool::Release(Crt::ByteBuf &buffer) noexcept
+        {
+            if (!buffer.allocator)
+            {
+                return;
+            }
+
+            /* Only buffers of exactly a class size came from a class; anything else goes back to the allocator. */
+            size_t sizeClass = ClassOf(buffer.capacity);
+            bool pooled = sizeClass < ClassCount && buffer.capacity == (MinClassBytes << sizeClass) &&
+                          m_pooledBytes + buffer.capacity <= m_capacityBytes;
+            if (pooled)
+            {
+                m_free[sizeClass].push_back(buffer);
+                m_pooledBytes += buffer.capacity;
+            }
+            else
+            {
+                aws_byte_buf_clean_up(&buffer);
+            }
+            AWS_ZERO_STRUCT(buffer);
+        }
+
+        void TunnelFrameBufferPool::SetCapacity(size_t capacityBytes) noexcept
+        {
+            m_capacityBytes = capacityBytes;
+            Trim();
+        }
+
+        void TunnelFrameBufferPool::Trim() noexcept
+        {
+            /* Large buffers go first; they free the most for the fewest misses later. */
+            for (size_t sizeClass = ClassCount; sizeClass > 0 && m_pooledBytes > m_capacityBytes; --sizeClass)
+            {
+                Crt::Vector<Crt::ByteBuf> &free = m_free[sizeClass - 1];
+                while (!free.empty() && m_pooledBytes > m_capacityBytes)
+                {
+                    m_pooledBytes -= free.back().capacity;
+                    aws_byte_buf_clean_up(&free.back());
+                    free.pop_back();
+                }
+            }
+        }
+    } // namespace Iotsecuretunneling
+} // namespace Aws
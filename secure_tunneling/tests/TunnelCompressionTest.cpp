@@ -0,0 +1,129 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/byte_buf.h>
+#include <aws/iotsecuretunneling/TunnelCompression.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <cstdio>
+
+using namespace Aws::Iotsecuretunneling;
+
+#define COMPRESSION_WINDOW_BITS 10
+#define COMPRESSION_MIN_BYTES 64
+
+/* Log-like lines, mostly repeated structure with varying fields, the way tunneled shells and tails look. */
+static void s_appendLogLines(Aws::Crt::Vector<uint8_t> &corpus, size_t bytes)
+{
+    uint32_t state = 12345;
+    char line[160];
+    while (corpus.size() < bytes)
+    {
+        state = state * 1103515245 + 12345;
+        int written = snprintf(
+            line,
+            sizeof(line),
+            "2026-10-14T05:%02u:%02u.%03u INFO [worker-%u] GET /api/v1/items/%u status=200 bytes=%u\n",
+            (state >> 8) % 60,
+            (state >> 12) % 60,
+            (state >> 4) % 1000,
+            (state >> 20) % 8,
+            (state >> 6) % 5000,
+            (state >> 3) % 90000);
+        corpus.insert(corpus.end(), line, line + written);
+    }
+    corpus.resize(bytes);
+}
+
+/* Decodes `wire` in messages of messageSize bytes, the way the tunnel may deliver it after splitting. */
+static int s_decodeInMessages(
+    TunnelStreamDecoder &decoder,
+    const Aws::Crt::Vector<uint8_t> &wire,
+    size_t messageSize,
+    int &peerWindowBits,
+    Aws::Crt::Vector<uint8_t> &decoded)
+{
+    for (size_t offset = 0; offset < wire.size(); offset += messageSize)
+    {
+        size_t length = wire.size() - offset < messageSize ? wire.size() - offset : messageSize;
+        auto onData = [&decoded](const Aws::Crt::ByteCursor &data)
+        { decoded.insert(decoded.end(), data.ptr, data.ptr + data.len); };
+        int result = decoder.Decode(aws_byte_cursor_from_array(wire.data() + offset, length), peerWindowBits, onData);
+        if (result != AWS_OP_SUCCESS)
+        {
+            return result;
+        }
+    }
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(SecureTunnelingCompressionRoundTripTest, s_SecureTunnelingCompressionRoundTripTest);
+static int s_SecureTunnelingCompressionRoundTripTest(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+
+    Aws::Crt::Vector<uint8_t> corpus(allocator);
+    s_appendLogLines(corpus, 256 * 1024);
+
+    TunnelStreamEncoder encoder(6, COMPRESSION_WINDOW_BITS, COMPRESSION_MIN_BYTES, allocator);
+    TunnelStreamEncoder peerEncoder(6, COMPRESSION_WINDOW_BITS, COMPRESSION_MIN_BYTES, allocator);
+    Aws::Crt::Vector<uint8_t> wire(allocator);
+    encoder.AppendOffer(wire);
+
+    /* Writes of varying size, the first ones sent before the peer's offer arrives. */
+    size_t offset = 0;
+    size_t writes = 0;
+    while (offset < corpus.size())
+    {
+        if (writes == 16)
+        {
+            Aws::Crt::Vector<uint8_t> peerWire(allocator);
+            peerEncoder.AppendOffer(peerWire);
+            TunnelStreamDecoder offerDecoder(COMPRESSION_WINDOW_BITS, allocator);
+            int peerWindowBits = -1;
+            Aws::Crt::Vector<uint8_t> none(allocator);
+            ASSERT_SUCCESS(s_decodeInMessages(offerDecoder, peerWire, peerWire.size(), peerWindowBits, none));
+            ASSERT_UINT_EQUALS(0, none.size());
+            encoder.OnPeerOffer(peerWindowBits);
+        }
+
+        size_t length = (writes % 7 == 0) ? 1 : 1 + (writes * 997) % 20000;
+        length = length < corpus.size() - offset ? length : corpus.size() - offset;
+        ASSERT_SUCCESS(encoder.Append(aws_byte_cursor_from_array(corpus.data() + offset, length), wire));
+        offset += length;
+        ++writes;
+    }
+
+    ASSERT_UINT_EQUALS(corpus.size(), encoder.GetBytesIn());
+    ASSERT_TRUE(encoder.IsCompressing() == TunnelStreamEncoder::IsDeflateSupported());
+    if (encoder.IsCompressing())
+    {
+        ASSERT_TRUE(encoder.GetBytesOut() < encoder.GetBytesIn() / 2);
+    }
+
+    /* Record boundaries never line up with message boundaries, whatever size the messages are. */
+    const size_t messageSizes[] = {1, 7, 4096, 15000, 1 << 20};
+    for (size_t messageSize : messageSizes)
+    {
+        TunnelStreamDecoder decoder(COMPRESSION_WINDOW_BITS, allocator);
+        int peerWindowBits = -1;
+        Aws::Crt::Vector<uint8_t> decoded(allocator);
+        ASSERT_SUCCESS(s_decodeInMessages(decoder, wire, messageSize, peerWindowBits, decoded));
+        ASSERT_INT_EQUALS(TunnelStreamEncoder::IsDeflateSupported() ? COMPRESSION_WINDOW_BITS : 0, peerWindowBits);
+        ASSERT_BIN_ARRAYS_EQUALS(corpus.data(), corpus.size(), decoded.data(), decoded.size());
+    }
+
+    /* A decoder that offered a smaller window than the stream was deflated with must refuse it. */
+    if (encoder.IsCompressing())
+    {
+        TunnelStreamDecoder narrowDecoder(COMPRESSION_WINDOW_BITS - 1, allocator);
+        int peerWindowBits = -1;
+        Aws::Crt::Vector<uint8_t> decoded(allocator);
+        ASSERT_FAILS(s_decodeInMessages(narrowDecoder, wire, wire.size(), peerWindowBits, decoded));
+        ASSERT_FAILS(s_decodeInMessages(narrowDecoder, wire, wire.size(), peerWindowBits, decoded));
+    }
+
+    return AWS_OP_SUCCESS;
+}
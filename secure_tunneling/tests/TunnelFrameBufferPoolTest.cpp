@@ -0,0 +1,67 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/byte_buf.h>
+#include <aws/iotsecuretunneling/TunnelFrameBufferPool.h>
+#include <aws/testing/aws_test_harness.h>
+
+using namespace Aws::Iotsecuretunneling;
+
+AWS_TEST_CASE(SecureTunnelingFrameBufferPoolTest, s_SecureTunnelingFrameBufferPoolTest);
+static int s_SecureTunnelingFrameBufferPoolTest(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+
+    {
+        TunnelFrameBufferPool pool(64 * 1024, allocator);
+
+        /* Requests round up to their size class. */
+        Aws::Crt::ByteBuf small = pool.Acquire(100);
+        ASSERT_NOT_NULL(small.allocator);
+        ASSERT_UINT_EQUALS(TunnelFrameBufferPool::MinClassBytes, small.capacity);
+        ASSERT_UINT_EQUALS(0, small.len);
+        Aws::Crt::ByteBuf frame = pool.Acquire(15000);
+        ASSERT_UINT_EQUALS(16 * 1024, frame.capacity);
+        ASSERT_UINT_EQUALS(2, pool.GetAllocationCount());
+
+        /* A steady pattern of sends reuses the same buffers. */
+        pool.Release(small);
+        pool.Release(frame);
+        ASSERT_NULL(frame.allocator);
+        ASSERT_UINT_EQUALS(17 * 1024, pool.GetPooledBytes());
+        for (int i = 0; i < 100; ++i)
+        {
+            Aws::Crt::ByteBuf reused = pool.Acquire(12000);
+            ASSERT_UINT_EQUALS(16 * 1024, reused.capacity);
+            ASSERT_UINT_EQUALS(0, reused.len);
+            ASSERT_TRUE(aws_byte_buf_write_u8(&reused, 1));
+            pool.Release(reused);
+        }
+        ASSERT_UINT_EQUALS(2, pool.GetAllocationCount());
+
+        /* Larger than any class: allocated to size and freed on release. */
+        Aws::Crt::ByteBuf large = pool.Acquire(100 * 1024);
+        ASSERT_UINT_EQUALS(100 * 1024, large.capacity);
+        pool.Release(large);
+        ASSERT_UINT_EQUALS(17 * 1024, pool.GetPooledBytes());
+
+        /* Past capacity, released buffers are freed. */
+        Aws::Crt::ByteBuf held[5];
+        for (Aws::Crt::ByteBuf &buffer : held)
+        {
+            buffer = pool.Acquire(TunnelFrameBufferPool::MaxClassBytes / 4);
+        }
+        for (Aws::Crt::ByteBuf &buffer : held)
+        {
+            pool.Release(buffer);
+        }
+        ASSERT_TRUE(pool.GetPooledBytes() <= 64 * 1024);
+
+        pool.SetCapacity(0);
+        ASSERT_UINT_EQUALS(0, pool.GetPooledBytes());
+    }
+
+    return AWS_OP_SUCCESS;
+}
@@ -3,7 +3,7 @@
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0.
  */
-#include <aws/crt/DateTime.h>
+#include <aws/iotdevicecommon/PackedDateTime.h>
 
 #include <aws/iotshadow/Exports.h>
 
@@ -27,7 +27,7 @@ namespace Aws
 
             Aws::Crt::Optional<int32_t> Version;
             Aws::Crt::Optional<Aws::Crt::String> ClientToken;
-            Aws::Crt::Optional<Aws::Crt::DateTime> Timestamp;
+            Aws::Iotdevicecommon::PackedDateTime Timestamp;
 
           private:
             static void LoadFromObject(DeleteShadowResponse &obj, const Crt::JsonView &doc);
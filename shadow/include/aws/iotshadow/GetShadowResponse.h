@@ -3,7 +3,7 @@
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0.
  */
-#include <aws/crt/DateTime.h>
+#include <aws/iotdevicecommon/PackedDateTime.h>
 #include <aws/iotshadow/ShadowMetadata.h>
 #include <aws/iotshadow/ShadowStateWithDelta.h>
 
@@ -23,6 +23,11 @@ namespace Aws
             GetShadowResponse() = default;
 
             GetShadowResponse(const Crt::JsonView &doc);
+
+            /**
+             * Decodes `doc`, handling its shadow metadata as `metadataMode` says.
+             */
+            GetShadowResponse(const Crt::JsonView &doc, ShadowMetadataMode metadataMode);
             GetShadowResponse &operator=(const Crt::JsonView &doc);
 
             void SerializeToObject(Crt::JsonObject &doc) const;
@@ -31,10 +36,13 @@ namespace Aws
             Aws::Crt::Optional<Aws::Crt::String> ClientToken;
             Aws::Crt::Optional<Aws::Iotshadow::ShadowStateWithDelta> State;
             Aws::Crt::Optional<Aws::Iotshadow::ShadowMetadata> Metadata;
-            Aws::Crt::Optional<Aws::Crt::DateTime> Timestamp;
+            Aws::Iotdevicecommon::PackedDateTime Timestamp;
 
           private:
-            static void LoadFromObject(GetShadowResponse &obj, const Crt::JsonView &doc);
+            static void LoadFromObject(
+                GetShadowResponse &obj,
+                const Crt::JsonView &doc,
+                ShadowMetadataMode metadataMode);
         };
     } // namespace Iotshadow
 } // namespace Aws
@@ -26,6 +26,13 @@ namespace Aws
 
             Aws::Crt::Optional<Aws::Crt::String> ThingName;
 
+            /**
+             * Optional. Paths, relative to the received document, of the members to materialize, such as
+             * "state.desired.color"; see Iotdevicecommon::JsonProjection. Only accepted responses are
+             * projected. Not serialized.
+             */
+            Aws::Crt::Optional<Aws::Crt::Vector<Aws::Crt::String>> Projection;
+
           private:
             static void LoadFromObject(GetShadowSubscriptionRequest &obj, const Crt::JsonView &doc);
         };
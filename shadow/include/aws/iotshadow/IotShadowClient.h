@@ -10,6 +10,11 @@
 
 #include <aws/crt/mqtt/MqttClient.h>
 
+#include <aws/iotdevicecommon/InlineFunction.h>
+#include <aws/iotdevicecommon/MessageContext.h>
+#include <aws/iotdevicecommon/ServiceClientConfig.h>
+#include <aws/iotdevicecommon/TopicBuilder.h>
+
 namespace Aws
 {
     namespace Iotshadow
@@ -27,19 +32,33 @@ namespace Aws
         class GetShadowResponse;
         class GetShadowSubscriptionRequest;
         class NamedShadowDeltaUpdatedSubscriptionRequest;
+        struct NamedShadowRequestView;
         class NamedShadowUpdatedSubscriptionRequest;
         class ShadowDeltaUpdatedEvent;
         class ShadowDeltaUpdatedSubscriptionRequest;
+        struct ShadowRequestView;
         class ShadowUpdatedEvent;
         class ShadowUpdatedSubscriptionRequest;
+        class ShadowVersionTracker;
+        class PreparedShadowUpdate;
+        enum class ShadowMetadataMode;
         class UpdateNamedShadowRequest;
         class UpdateNamedShadowSubscriptionRequest;
         class UpdateShadowRequest;
         class UpdateShadowResponse;
         class UpdateShadowSubscriptionRequest;
 
-        using OnSubscribeComplete = std::function<void(int ioErr)>;
-        using OnPublishComplete = std::function<void(int ioErr)>;
+        /*
+         * Completions are copied into every request, so they hold small callables in place rather than on the
+         * heap; any callable a std::function accepts converts to them.
+         */
+        using OnSubscribeComplete = Aws::Iotdevicecommon::InlineFunction<void(int ioErr)>;
+        using OnPublishComplete = Aws::Iotdevicecommon::InlineFunction<void(int ioErr)>;
+
+        /*
+         * Subscription handlers are passed a model that the client does not use again once they return, so they
+         * may move out of it; Iotdevicecommon::TakeResponse adapts a handler that takes ownership instead.
+         */
 
         using OnSubscribeToDeleteNamedShadowRejectedResponse =
             std::function<void(Aws::Iotshadow::ErrorResponse *, int ioErr)>;
@@ -88,109 +107,252 @@ namespace Aws
 
         using OnSubscribeToGetShadowRejectedResponse = std::function<void(Aws::Iotshadow::ErrorResponse *, int ioErr)>;
 
+        /**
+         * Called from a subscription handler, so that one handler subscribed with a "+" thing or shadow name
+         * can serve many shadows. Iotdevicecommon::CurrentThingName() gives the thing name.
+         *
+         * @return the shadow name of the named shadow message being handled on the calling thread, or an empty
+         * string for the classic shadow and outside a handler.
+         */
+        AWS_IOTSHADOW_API Crt::String CurrentShadowName();
+
+        /**
+         * Publish* and Subscribe* may be called concurrently from any number of threads. Each publish
+         * serializes into its own pooled buffer and goes straight to the connection, whose publish is
+         * thread-safe; metrics, tracing and the buffer pool are internally synchronized and shared across
+         * calls. Response handlers run on the event loop thread, or the handler executor when one is set.
+         *
+         * SetMetadataMode and SetVersionTracker are not synchronized with publishing; call them before the
+         * client is shared between threads.
+         */
         class AWS_IOTSHADOW_API IotShadowClient final
         {
           public:
-            IotShadowClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection);
+            IotShadowClient(
+                const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+                Aws::Crt::Allocator *allocator = Aws::Crt::DefaultAllocator());
+            IotShadowClient(
+                const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+                const Aws::Iotdevicecommon::ServiceClientConfig &config,
+                Aws::Crt::Allocator *allocator = Aws::Crt::DefaultAllocator());
 
             operator bool() const noexcept;
             int GetLastError() const noexcept;
 
+            /**
+             * @return the budget from the client's ServiceClientConfig, which helpers issuing requests through
+             * the client consult for their pending requests; null if none.
+             */
+            const std::shared_ptr<Aws::Iotdevicecommon::MemoryBudget> &GetMemoryBudget() const noexcept
+            {
+                return m_memoryBudget;
+            }
+
+            /**
+             * Sets how GetShadow and UpdateShadow accepted responses and updated events decode their metadata.
+             * Applies to subscriptions made after the call.
+             */
+            void SetMetadataMode(ShadowMetadataMode mode) noexcept;
+
+            /**
+             * Drops delta and updated events whose version is not newer than one the tracker has already seen
+             * for that shadow, reading the version before the payload is parsed where possible. GetShadow
+             * accepted responses record their version. Applies to subscriptions made after the call; pass
+             * nullptr to stop tracking.
+             */
+            void SetVersionTracker(const std::shared_ptr<ShadowVersionTracker> &tracker) noexcept;
+
             bool SubscribeToDeleteNamedShadowRejected(
                 const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDeleteNamedShadowRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDeleteNamedShadowRejected(
+                const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDeleteNamedShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToGetNamedShadowAccepted(
                 const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetNamedShadowAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetNamedShadowAccepted(
+                const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetNamedShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToShadowDeltaUpdatedEvents(
                 const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToShadowDeltaUpdatedEvents(
+                const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToShadowDeltaUpdatedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToDeleteShadowAccepted(
                 const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDeleteShadowAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDeleteShadowAccepted(
+                const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDeleteShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToUpdateNamedShadowAccepted(
                 const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateNamedShadowAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateNamedShadowAccepted(
+                const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateNamedShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToDeleteNamedShadowAccepted(
                 const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDeleteNamedShadowAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDeleteNamedShadowAccepted(
+                const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDeleteNamedShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToUpdateShadowAccepted(
                 const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateShadowAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateShadowAccepted(
+                const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToUpdateShadowRejected(
                 const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateShadowRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateShadowRejected(
+                const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToDeleteShadowRejected(
                 const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDeleteShadowRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDeleteShadowRejected(
+                const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDeleteShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToUpdateNamedShadowRejected(
                 const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateNamedShadowRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateNamedShadowRejected(
+                const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateNamedShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToNamedShadowUpdatedEvents(
                 const Aws::Iotshadow::NamedShadowUpdatedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToNamedShadowUpdatedEventsResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToNamedShadowUpdatedEvents(
+                const Aws::Iotshadow::NamedShadowUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToNamedShadowUpdatedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToGetShadowAccepted(
                 const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetShadowAcceptedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetShadowAccepted(
+                const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToShadowUpdatedEvents(
                 const Aws::Iotshadow::ShadowUpdatedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToShadowUpdatedEventsResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToShadowUpdatedEvents(
+                const Aws::Iotshadow::ShadowUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToShadowUpdatedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToNamedShadowDeltaUpdatedEvents(
                 const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToNamedShadowDeltaUpdatedEvents(
+                const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToGetNamedShadowRejected(
                 const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetNamedShadowRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetNamedShadowRejected(
+                const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetNamedShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool SubscribeToGetShadowRejected(
                 const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetShadowRejectedResponse &handler,
                 const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetShadowRejected(
+                const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Subscribes to every shadow topic of `thingName`, classic and named, accepted, rejected and event
+             * topics alike, and hands each message over without parsing it; for bridges forwarding them unchanged.
+             * `thingName` may be "+" to cover every thing.
+             */
+            bool SubscribeToShadowTopicsRaw(
+                const Aws::Crt::String &thingName,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnRawMessageReceived &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToShadowTopicsRaw(
+                const Aws::Crt::String &thingName,
+                Aws::Crt::Mqtt::QOS qos,
+                Aws::Iotdevicecommon::OnRawMessageReceived &&handler,
+                const OnSubscribeComplete &onSubAck);
 
             bool PublishGetShadow(
                 const Aws::Iotshadow::GetShadowRequest &request,
@@ -222,8 +384,146 @@ namespace Aws
                 Aws::Crt::Mqtt::QOS qos,
                 const OnPublishComplete &onPubAck);
 
+            /**
+             * View variants of the get and delete publishes: the names and client token are referenced, not
+             * copied into a request model, and only need to stay valid for the call. Include
+             * <aws/iotshadow/ShadowRequestView.h> to use them.
+             */
+            bool PublishGetShadow(
+                const Aws::Iotshadow::ShadowRequestView &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishDeleteShadow(
+                const Aws::Iotshadow::ShadowRequestView &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishGetNamedShadow(
+                const Aws::Iotshadow::NamedShadowRequestView &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishDeleteNamedShadow(
+                const Aws::Iotshadow::NamedShadowRequestView &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            /**
+             * Binds an update of the reported state of `thingName`'s classic shadow, or of its `shadowName`
+             * shadow, to its topic and QoS once, for devices sending it many times. Include
+             * <aws/iotshadow/PreparedShadowUpdate.h> to use the result.
+             */
+            PreparedShadowUpdate PrepareUpdateShadow(const Aws::Crt::String &thingName, Aws::Crt::Mqtt::QOS qos) const;
+            PreparedShadowUpdate PrepareUpdateNamedShadow(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::String &shadowName,
+                Aws::Crt::Mqtt::QOS qos) const;
+
+            /**
+             * Raw variants of the Publish* calls, for payloads serialized already, e.g. from a template or an
+             * upstream system: `payload`, in the client's payload format, is published as is, without being
+             * parsed, serialized or copied. It must stay valid until onRelease is invoked, which happens once the
+             * publish completed, or on return if the call fails. An offline queue or publish scheduler keeps a
+             * copy of the updates it holds back instead, releasing the payload at once.
+             */
+            bool PublishGetShadowRaw(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishDeleteShadowRaw(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishUpdateShadowRaw(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishDeleteNamedShadowRaw(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::String &shadowName,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishGetNamedShadowRaw(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::String &shadowName,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishUpdateNamedShadowRaw(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::String &shadowName,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
           private:
+            friend class PreparedShadowUpdate;
+
+            /* The shared tail of the update publishes, taking a serialized payload drawn from the pool. */
+            bool PublishUpdatePayload(
+                const char *topic,
+                Aws::Crt::Mqtt::QOS qos,
+                Aws::Iotdevicecommon::RequestTrace &trace,
+                Aws::Crt::ByteBuf &buf,
+                const OnPublishComplete &onPubAck) const;
+
+            /* The shared tail of the view publishes. */
+            template <typename View>
+            bool PublishView(
+                const View &request,
+                const Aws::Iotdevicecommon::TopicBuilder &topic,
+                Aws::Iotdevicecommon::ThrottledOperation operation,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishRaw(
+                const Aws::Iotdevicecommon::TopicBuilder &topic,
+                const Aws::Crt::ByteCursor &payload,
+                Aws::Crt::Mqtt::QOS qos,
+                bool deferrable,
+                Aws::Iotdevicecommon::ThrottledOperation operation,
+                const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+                const OnPublishComplete &onPubAck);
+
+            Aws::Crt::Allocator *m_allocator;
+            Aws::Crt::StlAllocator<char> m_stringAllocator;
             std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> m_connection;
+            std::shared_ptr<Aws::Iotdevicecommon::PayloadBufferPool> m_payloadBufferPool;
+            Aws::Iotdevicecommon::PayloadFormat m_payloadFormat;
+            /* Shared by every subscription's publish handler. */
+            std::shared_ptr<const Aws::Iotdevicecommon::HandlerContext> m_handlerContext;
+            std::shared_ptr<Aws::Iotdevicecommon::ServiceMetrics> m_metrics;
+            std::shared_ptr<Aws::Iotdevicecommon::RequestTracer> m_tracer;
+            std::shared_ptr<Aws::Iotdevicecommon::SessionSubscriptions> m_session;
+            bool m_reuseInboundModels;
+            std::shared_ptr<Aws::Iotdevicecommon::DurablePublishQueue> m_offlineQueue;
+            std::shared_ptr<Aws::Iotdevicecommon::MemoryBudget> m_memoryBudget;
+            std::shared_ptr<Aws::Iotdevicecommon::PublishScheduler> m_publishScheduler;
+            uint32_t m_scheduledPublishDeadlineMs;
+            std::shared_ptr<Aws::Iotdevicecommon::PublishCompletionBatcher> m_completionBatcher;
+            std::shared_ptr<Aws::Iotdevicecommon::PublishLanes> m_publishLanes;
+            std::shared_ptr<Aws::Iotdevicecommon::ThrottleBreaker> m_throttleBreaker;
+            std::shared_ptr<Aws::Iotdevicecommon::RequestRateLimiter> m_rateLimiter;
+            std::shared_ptr<Aws::Iotdevicecommon::HotStandby> m_hotStandby;
+            Aws::Iotdevicecommon::QosPolicy m_qosPolicy;
+            std::shared_ptr<ShadowVersionTracker> m_versionTracker;
+            ShadowMetadataMode m_metadataMode;
         };
 
     } // namespace Iotshadow
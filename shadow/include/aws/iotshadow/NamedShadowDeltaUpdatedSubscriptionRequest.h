@@ -27,6 +27,12 @@ namespace Aws
             Aws::Crt::Optional<Aws::Crt::String> ThingName;
             Aws::Crt::Optional<Aws::Crt::String> ShadowName;
 
+            /**
+             * Optional. Paths, relative to the received document, of the members to materialize, such as
+             * "state.color"; see Iotdevicecommon::JsonProjection. Not serialized.
+             */
+            Aws::Crt::Optional<Aws::Crt::Vector<Aws::Crt::String>> Projection;
+
           private:
             static void LoadFromObject(NamedShadowDeltaUpdatedSubscriptionRequest &obj, const Crt::JsonView &doc);
         };
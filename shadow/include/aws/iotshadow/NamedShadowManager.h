@@ -0,0 +1,108 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/ShadowTopicDemultiplexer.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * Handlers for one named shadow. Any of them may be left empty.
+         */
+        struct NamedShadowHandlers
+        {
+            OnSubscribeToGetNamedShadowAcceptedResponse OnGetAccepted;
+            OnSubscribeToGetNamedShadowRejectedResponse OnGetRejected;
+            OnSubscribeToUpdateNamedShadowAcceptedResponse OnUpdateAccepted;
+            OnSubscribeToUpdateNamedShadowRejectedResponse OnUpdateRejected;
+            OnSubscribeToDeleteNamedShadowAcceptedResponse OnDeleteAccepted;
+            OnSubscribeToDeleteNamedShadowRejectedResponse OnDeleteRejected;
+            OnSubscribeToNamedShadowDeltaUpdatedEventsResponse OnDeltaUpdated;
+            OnSubscribeToNamedShadowUpdatedEventsResponse OnUpdated;
+        };
+
+        /**
+         * Invoked once every named shadow has answered an initial GetAllShadowsAsync fan-out. ioErr is the
+         * first publish error, if any; the responses themselves go to each shadow's get handlers.
+         */
+        using OnGetAllShadowsComplete = std::function<void(int ioErr)>;
+
+        /**
+         * Serves every named shadow of one thing over a fixed set of eight subscriptions,
+         * "$aws/things/<thing>/shadow/name/+/<operation>/<result>", instead of eight per shadow. Inbound
+         * messages are routed to the shadow's handlers by a ShadowTopicDemultiplexer, so the subscription
+         * count and connect time no longer grow with the number of named shadows.
+         *
+         * Messages for shadows that were never added are ignored.
+         */
+        class AWS_IOTSHADOW_API NamedShadowManager final : public std::enable_shared_from_this<NamedShadowManager>
+        {
+          public:
+            NamedShadowManager(const NamedShadowManager &) = delete;
+            NamedShadowManager(NamedShadowManager &&) = delete;
+            NamedShadowManager &operator=(const NamedShadowManager &) = delete;
+            NamedShadowManager &operator=(NamedShadowManager &&) = delete;
+
+            ~NamedShadowManager() = default;
+
+            /**
+             * Subscribes to the wildcard topics. onSubAck is invoked once, after all subscriptions complete,
+             * with the first error encountered (if any).
+             */
+            bool Subscribe(Crt::Mqtt::QOS qos, const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Registers the handlers of one named shadow. May be called before or after Subscribe.
+             */
+            bool AddShadow(const Crt::String &shadowName, const NamedShadowHandlers &handlers);
+
+            /**
+             * Publishes a GetNamedShadow request for every added shadow at once, rather than one after
+             * another, and invokes onComplete when each has been accepted or rejected. Fails with
+             * AWS_ERROR_INVALID_STATE while a previous fan-out is still outstanding.
+             */
+            bool GetAllShadowsAsync(Crt::Mqtt::QOS qos, const OnGetAllShadowsComplete &onComplete);
+
+            /**
+             * Publishes through the underlying client, e.g. to update or delete one of the shadows.
+             */
+            IotShadowClient &GetClient() noexcept { return m_client; }
+
+            static std::shared_ptr<NamedShadowManager> Create(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                const Crt::String &thingName,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            NamedShadowManager(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                const std::shared_ptr<ShadowTopicDemultiplexer> &demux,
+                const Crt::String &thingName,
+                Crt::Allocator *allocator) noexcept;
+
+            void CompleteInitialGet(const Crt::String &shadowName, int ioErr);
+
+            std::shared_ptr<Crt::Mqtt::MqttConnection> m_connection;
+            std::shared_ptr<ShadowTopicDemultiplexer> m_demux;
+            IotShadowClient m_client;
+            Crt::String m_thingName;
+            Crt::Allocator *m_allocator;
+
+            std::mutex m_lock;
+            Crt::Vector<Crt::String> m_shadowNames;
+            Crt::Map<Crt::String, bool> m_pendingGets;
+            OnGetAllShadowsComplete m_onGetAllComplete;
+            int m_getAllError;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -5,6 +5,7 @@
  */
 
 #include <aws/iotshadow/Exports.h>
+#include <aws/iotshadow/ShadowMetadata.h>
 
 #include <aws/crt/JsonObject.h>
 #include <aws/crt/StlAllocator.h>
@@ -27,6 +28,24 @@ namespace Aws
             Aws::Crt::Optional<Aws::Crt::String> ShadowName;
             Aws::Crt::Optional<Aws::Crt::String> ThingName;
 
+            /**
+             * Optional. Paths, relative to the received document, of the members to materialize, such as
+             * "current.state.desired.color"; see Iotdevicecommon::JsonProjection. Not serialized.
+             */
+            Aws::Crt::Optional<Aws::Crt::Vector<Aws::Crt::String>> Projection;
+
+            /**
+             * Optional. When true, only the event's Current snapshot and Timestamp are parsed, and Previous is
+             * left unset. Not serialized.
+             */
+            Aws::Crt::Optional<bool> CurrentOnly;
+
+            /**
+             * Optional. Overrides the client's metadata mode (see IotShadowClient::SetMetadataMode) for this
+             * subscription, e.g. ShadowMetadataMode::Skip. Not serialized.
+             */
+            Aws::Crt::Optional<Aws::Iotshadow::ShadowMetadataMode> MetadataMode;
+
           private:
             static void LoadFromObject(NamedShadowUpdatedSubscriptionRequest &obj, const Crt::JsonView &doc);
         };
@@ -0,0 +1,100 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+
+#include <aws/crt/JsonObject.h>
+#include <aws/iotdevicecommon/JsonTemplate.h>
+#include <aws/iotdevicecommon/PayloadWriter.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * Writes the members of the reported state of one update, e.g. `writer.Key("temp").Double(t)`.
+         */
+        using WriteReportedState = Iotdevicecommon::InlineFunction<void(Iotdevicecommon::PayloadWriter &writer)>;
+
+        /**
+         * An update of the reported state of one shadow, with its topic and QoS bound once by
+         * IotShadowClient::PrepareUpdateShadow or PrepareUpdateNamedShadow, for devices sending the same
+         * kind of update many times.
+         *
+         * Each Send() only writes the reported members and the version: the topic is built and validated once,
+         * and for JSON payloads the `{"state":{"reported":{` envelope is copied in as a whole. The payload
+         * then takes the same path as PublishUpdateShadow, offline queue and publish scheduler included.
+         * Copies are cheap, and Send() may be called from any number of threads.
+         */
+        class AWS_IOTSHADOW_API PreparedShadowUpdate final
+        {
+          public:
+            PreparedShadowUpdate(const PreparedShadowUpdate &rhs) = default;
+            PreparedShadowUpdate(PreparedShadowUpdate &&rhs) = default;
+
+            PreparedShadowUpdate &operator=(const PreparedShadowUpdate &rhs) = default;
+            PreparedShadowUpdate &operator=(PreparedShadowUpdate &&rhs) = default;
+
+            ~PreparedShadowUpdate() = default;
+
+            /**
+             * @return false if the names did not form a valid topic; Send() then fails with
+             * AWS_ERROR_INVALID_ARGUMENT.
+             */
+            explicit operator bool() const noexcept { return !m_topic.empty(); }
+
+            const Crt::String &GetTopic() const noexcept { return m_topic; }
+
+            /**
+             * Publishes `{"state":{"reported":{...}},"version":N}`, with the members written by writeReported
+             * and the version left out when it is not set.
+             */
+            bool Send(
+                const WriteReportedState &writeReported,
+                const Crt::Optional<int32_t> &version,
+                const OnPublishComplete &onPubAck) const;
+
+            /**
+             * As above, with each member of `reported`, which must be an object, as a reported member.
+             */
+            bool SendReported(
+                const Crt::JsonView &reported,
+                const Crt::Optional<int32_t> &version,
+                const OnPublishComplete &onPubAck) const;
+
+            /**
+             * As above, with the reported members rendered from `reported`, a template of the members only such as
+             * `"temp":<slot>,"fan":<slot>`, with `values` in its slots. The cheapest way to send updates of a
+             * fixed layout.
+             *
+             * @return false, with AWS_ERROR_INVALID_STATE raised, if the client encodes payloads as CBOR.
+             */
+            bool SendTemplate(
+                const Iotdevicecommon::JsonTemplate &reported,
+                const Iotdevicecommon::TemplateNumber *values,
+                size_t count,
+                const Crt::Optional<int32_t> &version,
+                const OnPublishComplete &onPubAck) const;
+
+          private:
+            friend class IotShadowClient;
+
+            bool SendPayload(
+                Iotdevicecommon::RequestTrace &trace,
+                Crt::ByteBuf &buf,
+                bool written,
+                const OnPublishComplete &onPubAck) const;
+
+            PreparedShadowUpdate(const IotShadowClient &client, Crt::String &&topic, Crt::Mqtt::QOS qos) noexcept;
+
+            IotShadowClient m_client;
+            Crt::String m_topic;
+            Crt::Mqtt::QOS m_qos;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -0,0 +1,59 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotdevicecommon/Awaitable.h>
+
+#ifdef AWS_IOTDEVICECOMMON_COROUTINES
+
+#    include <aws/iotshadow/DeleteShadowResponse.h>
+#    include <aws/iotshadow/ErrorResponse.h>
+#    include <aws/iotshadow/GetShadowResponse.h>
+#    include <aws/iotshadow/ShadowRequestCorrelator.h>
+#    include <aws/iotshadow/UpdateShadowResponse.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * co_await-able forms of the ShadowRequestCorrelator requests (C++20 only). See Iotdevicecommon
+         * Awaitable.h for where the coroutine resumes.
+         */
+        inline Iotdevicecommon::OperationAwaiter<Iotdevicecommon::ResponseResult<GetShadowResponse, ErrorResponse>>
+            AwaitGetShadow(const std::shared_ptr<ShadowRequestCorrelator> &correlator, Crt::Mqtt::QOS qos)
+        {
+            return Iotdevicecommon::AwaitResponse<GetShadowResponse, ErrorResponse>(
+                [correlator, qos](OnGetShadowComplete &&onComplete) {
+                    return correlator->GetShadowAsync(qos, onComplete);
+                });
+        }
+
+        inline Iotdevicecommon::OperationAwaiter<Iotdevicecommon::ResponseResult<UpdateShadowResponse, ErrorResponse>>
+            AwaitUpdateShadow(
+                const std::shared_ptr<ShadowRequestCorrelator> &correlator,
+                const ShadowState &state,
+                const Crt::Optional<int32_t> &version,
+                Crt::Mqtt::QOS qos)
+        {
+            return Iotdevicecommon::AwaitResponse<UpdateShadowResponse, ErrorResponse>(
+                [correlator, state, version, qos](OnUpdateShadowComplete &&onComplete) {
+                    return correlator->UpdateShadowAsync(state, version, qos, onComplete);
+                });
+        }
+
+        inline Iotdevicecommon::OperationAwaiter<Iotdevicecommon::ResponseResult<DeleteShadowResponse, ErrorResponse>>
+            AwaitDeleteShadow(const std::shared_ptr<ShadowRequestCorrelator> &correlator, Crt::Mqtt::QOS qos)
+        {
+            return Iotdevicecommon::AwaitResponse<DeleteShadowResponse, ErrorResponse>(
+                [correlator, qos](OnDeleteShadowComplete &&onComplete) {
+                    return correlator->DeleteShadowAsync(qos, onComplete);
+                });
+        }
+
+    } // namespace Iotshadow
+} // namespace Aws
+
+#endif // AWS_IOTDEVICECOMMON_COROUTINES
@@ -0,0 +1,374 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Optional.h>
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/JsonPayloadScanner.h>
+#include <aws/iotdevicecommon/JsonWriter.h>
+
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * Declares the shadow fields of a fixed-schema state struct, for ShadowBinding to decode into and
+         * encode from without building a JsonObject tree. Specialize it with a Visit function that names each
+         * field, taking the state by template so the one list serves both directions:
+         *
+         *     template <> struct ShadowFields<LampState>
+         *     {
+         *         template <typename State, typename Visitor> static void Visit(State &state, Visitor &visitor)
+         *         {
+         *             visitor("on", state.On);
+         *             visitor("color", state.Color);
+         *         }
+         *     };
+         *
+         * Fields may be bool, arithmetic, Crt::String, Crt::Vector of a supported type, another struct with
+         * ShadowFields, or Crt::Optional of any of these. Names are compared with the payload's keys as
+         * encoded, so they should not need JSON escapes.
+         */
+        template <typename State> struct ShadowFields;
+
+        /**
+         * Decodes shadow documents straight into, and encodes reported updates straight from, structs
+         * described by ShadowFields. Decoding only assigns the fields a payload carries, so a delta applies
+         * onto the state it is decoded into. An explicit null resets an Optional field and leaves any other
+         * alone. Unknown members are skipped. Decoding reads JSON only; encoding writes through any
+         * PayloadWriter.
+         */
+        namespace ShadowBinding
+        {
+            bool DecodeValue(const Crt::ByteCursor &value, bool &field);
+            bool DecodeValue(const Crt::ByteCursor &value, double &field);
+            bool DecodeValue(const Crt::ByteCursor &value, float &field);
+            bool DecodeValue(const Crt::ByteCursor &value, Crt::String &field);
+            template <typename T>
+            typename std::enable_if<std::is_integral<T>::value, bool>::type DecodeValue(
+                const Crt::ByteCursor &value,
+                T &field);
+            template <typename T> bool DecodeValue(const Crt::ByteCursor &value, Crt::Optional<T> &field);
+            template <typename T> bool DecodeValue(const Crt::ByteCursor &value, Crt::Vector<T> &field);
+            template <typename T>
+            typename std::enable_if<std::is_class<T>::value, bool>::type DecodeValue(
+                const Crt::ByteCursor &value,
+                T &field);
+
+            void EncodeValue(Iotdevicecommon::PayloadWriter &writer, bool field);
+            void EncodeValue(Iotdevicecommon::PayloadWriter &writer, double field);
+            void EncodeValue(Iotdevicecommon::PayloadWriter &writer, const Crt::String &field);
+            template <typename T>
+            typename std::enable_if<std::is_arithmetic<T>::value>::type EncodeValue(
+                Iotdevicecommon::PayloadWriter &writer,
+                T field);
+            template <typename T>
+            void EncodeValue(Iotdevicecommon::PayloadWriter &writer, const Crt::Optional<T> &field);
+            template <typename T> void EncodeValue(Iotdevicecommon::PayloadWriter &writer, const Crt::Vector<T> &field);
+            template <typename T>
+            typename std::enable_if<std::is_class<T>::value>::type EncodeValue(
+                Iotdevicecommon::PayloadWriter &writer,
+                const T &field);
+
+            /**
+             * Decodes the JSON object in `object` onto `state`.
+             *
+             * @return false if the object is malformed or a field's value has the wrong type; `state` may then
+             * be partly updated.
+             */
+            template <typename State> bool Decode(const Crt::ByteCursor &object, State &state)
+            {
+                return DecodeValue(object, state);
+            }
+
+            /**
+             * Writes `state` as an object. Unset Optional fields are left out.
+             */
+            template <typename State> void Encode(const State &state, Iotdevicecommon::PayloadWriter &writer)
+            {
+                EncodeValue(writer, state);
+            }
+
+            /**
+             * Applies the "state" of a shadow delta event payload onto `desired`, and reads its "version".
+             */
+            template <typename State>
+            bool DecodeDelta(const Crt::ByteBuf &payload, State &desired, Crt::Optional<int64_t> *version = nullptr)
+            {
+                Crt::ByteCursor document = Crt::ByteCursorFromByteBuf(payload);
+                Crt::ByteCursor member;
+                if (version && Iotdevicecommon::JsonPayloadScanner::FindMember(document, "version", member))
+                {
+                    int64_t documentVersion = 0;
+                    if (Iotdevicecommon::JsonPayloadScanner::ReadInteger(member, documentVersion))
+                    {
+                        *version = documentVersion;
+                    }
+                }
+                if (!Iotdevicecommon::JsonPayloadScanner::FindMember(document, "state", member))
+                {
+                    return true;
+                }
+                return Decode(member, desired);
+            }
+
+            /**
+             * Applies the "state"."desired" and "state"."reported" sections of a get or update accepted
+             * payload, or of the "current" or "previous" document of a shadow updated event, onto either
+             * struct given. Sections the document lacks are left alone.
+             */
+            template <typename Desired, typename Reported>
+            bool DecodeDocument(const Crt::ByteCursor &document, Desired *desired, Reported *reported)
+            {
+                Crt::ByteCursor state;
+                if (!Iotdevicecommon::JsonPayloadScanner::FindMember(document, "state", state))
+                {
+                    return true;
+                }
+
+                Crt::ByteCursor section;
+                if (desired && Iotdevicecommon::JsonPayloadScanner::FindMember(state, "desired", section) &&
+                    !Decode(section, *desired))
+                {
+                    return false;
+                }
+                if (reported && Iotdevicecommon::JsonPayloadScanner::FindMember(state, "reported", section) &&
+                    !Decode(section, *reported))
+                {
+                    return false;
+                }
+                return true;
+            }
+
+            /**
+             * Encodes an update publishing `reported`, for the shadow's ".../update" topic.
+             *
+             * @return false if the buffer could not be grown.
+             */
+            template <typename State>
+            bool EncodeReportedUpdate(
+                const State &reported,
+                Crt::ByteBuf &payload,
+                const Crt::Optional<Crt::String> &clientToken = Crt::Optional<Crt::String>(),
+                const Crt::Optional<int64_t> &version = Crt::Optional<int64_t>())
+            {
+                Iotdevicecommon::JsonWriter writer(payload);
+                writer.BeginObject().Key("state").BeginObject().Key("reported");
+                Encode(reported, writer);
+                writer.EndObject();
+                if (clientToken)
+                {
+                    writer.Key("clientToken").String(*clientToken);
+                }
+                if (version)
+                {
+                    writer.Key("version").Int64(*version);
+                }
+                writer.EndObject();
+                return static_cast<bool>(writer);
+            }
+
+            inline bool DecodeValue(const Crt::ByteCursor &value, bool &field)
+            {
+                return Iotdevicecommon::JsonPayloadScanner::ReadBool(value, field);
+            }
+
+            inline bool DecodeValue(const Crt::ByteCursor &value, double &field)
+            {
+                return Iotdevicecommon::JsonPayloadScanner::ReadDouble(value, field);
+            }
+
+            inline bool DecodeValue(const Crt::ByteCursor &value, float &field)
+            {
+                double number = 0;
+                if (!Iotdevicecommon::JsonPayloadScanner::ReadDouble(value, number))
+                {
+                    return false;
+                }
+                field = static_cast<float>(number);
+                return true;
+            }
+
+            inline bool DecodeValue(const Crt::ByteCursor &value, Crt::String &field)
+            {
+                return Iotdevicecommon::JsonPayloadScanner::ReadString(value, field);
+            }
+
+            template <typename T>
+            typename std::enable_if<std::is_integral<T>::value, bool>::type DecodeValue(
+                const Crt::ByteCursor &value,
+                T &field)
+            {
+                int64_t integer = 0;
+                if (!Iotdevicecommon::JsonPayloadScanner::ReadInteger(value, integer))
+                {
+                    return false;
+                }
+
+                /* Compared as long double so that neither signed nor unsigned bounds are converted lossily. */
+                long double wide = static_cast<long double>(integer);
+                if (wide < static_cast<long double>(std::numeric_limits<T>::lowest()) ||
+                    wide > static_cast<long double>(std::numeric_limits<T>::max()))
+                {
+                    return false;
+                }
+                field = static_cast<T>(integer);
+                return true;
+            }
+
+            template <typename T> bool DecodeValue(const Crt::ByteCursor &value, Crt::Optional<T> &field)
+            {
+                if (!field)
+                {
+                    field.emplace();
+                }
+                return DecodeValue(value, *field);
+            }
+
+            template <typename T> bool DecodeValue(const Crt::ByteCursor &value, Crt::Vector<T> &field)
+            {
+                /* Arrays replace rather than merge, as they do in the shadow document itself. */
+                field.clear();
+                return Iotdevicecommon::JsonPayloadScanner::ForEachElement(
+                    value, [&field](const Crt::ByteCursor &element) {
+                        field.emplace_back();
+                        return DecodeValue(element, field.back());
+                    });
+            }
+
+            namespace Detail
+            {
+                template <typename T> void ResetValue(T &) {}
+                template <typename T> void ResetValue(Crt::Optional<T> &field) { field.reset(); }
+
+                struct FieldDecoder
+                {
+                    const Crt::ByteCursor &Key;
+                    const Crt::ByteCursor &Value;
+                    bool Matched;
+                    bool Decoded;
+
+                    template <typename T> void operator()(const char *name, T &field)
+                    {
+                        if (Matched || strlen(name) != Key.len || memcmp(name, Key.ptr, Key.len) != 0)
+                        {
+                            return;
+                        }
+
+                        Matched = true;
+                        if (Iotdevicecommon::JsonPayloadScanner::IsNull(Value))
+                        {
+                            ResetValue(field);
+                            return;
+                        }
+                        Decoded = DecodeValue(Value, field);
+                    }
+                };
+
+                struct FieldEncoder
+                {
+                    Iotdevicecommon::PayloadWriter &Writer;
+
+                    template <typename T> void operator()(const char *name, const T &field)
+                    {
+                        Write(name, field);
+                    }
+
+                  private:
+                    template <typename T> void Write(const char *name, const T &field)
+                    {
+                        Writer.Key(name);
+                        EncodeValue(Writer, field);
+                    }
+                    template <typename T> void Write(const char *name, const Crt::Optional<T> &field)
+                    {
+                        if (field)
+                        {
+                            Writer.Key(name);
+                            EncodeValue(Writer, *field);
+                        }
+                    }
+                };
+            } // namespace Detail
+
+            template <typename T>
+            typename std::enable_if<std::is_class<T>::value, bool>::type DecodeValue(
+                const Crt::ByteCursor &value,
+                T &field)
+            {
+                return Iotdevicecommon::JsonPayloadScanner::ForEachMember(
+                    value, [&field](const Crt::ByteCursor &key, const Crt::ByteCursor &member) {
+                        Detail::FieldDecoder decoder{key, member, false, true};
+                        ShadowFields<T>::Visit(field, decoder);
+                        return decoder.Decoded;
+                    });
+            }
+
+            inline void EncodeValue(Iotdevicecommon::PayloadWriter &writer, bool field) { writer.Bool(field); }
+
+            inline void EncodeValue(Iotdevicecommon::PayloadWriter &writer, double field) { writer.Double(field); }
+
+            inline void EncodeValue(Iotdevicecommon::PayloadWriter &writer, const Crt::String &field)
+            {
+                writer.String(field);
+            }
+
+            template <typename T>
+            typename std::enable_if<std::is_arithmetic<T>::value>::type EncodeValue(
+                Iotdevicecommon::PayloadWriter &writer,
+                T field)
+            {
+                if (std::is_floating_point<T>::value)
+                {
+                    writer.Double(static_cast<double>(field));
+                }
+                else
+                {
+                    writer.Int64(static_cast<int64_t>(field));
+                }
+            }
+
+            template <typename T>
+            void EncodeValue(Iotdevicecommon::PayloadWriter &writer, const Crt::Optional<T> &field)
+            {
+                if (field)
+                {
+                    EncodeValue(writer, *field);
+                }
+                else
+                {
+                    writer.Null();
+                }
+            }
+
+            template <typename T> void EncodeValue(Iotdevicecommon::PayloadWriter &writer, const Crt::Vector<T> &field)
+            {
+                writer.BeginArray();
+                for (const T &element : field)
+                {
+                    EncodeValue(writer, element);
+                }
+                writer.EndArray();
+            }
+
+            template <typename T>
+            typename std::enable_if<std::is_class<T>::value>::type EncodeValue(
+                Iotdevicecommon::PayloadWriter &writer,
+                const T &field)
+            {
+                Detail::FieldEncoder encoder{writer};
+                writer.BeginObject();
+                ShadowFields<T>::Visit(field, encoder);
+                writer.EndObject();
+            }
+        } // namespace ShadowBinding
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -0,0 +1,155 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+
+#include <aws/crt/io/EventLoopGroup.h>
+
+#include <aws/common/task_scheduler.h>
+
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        class AWS_IOTSHADOW_API ShadowBulkFetcherConfig final
+        {
+          public:
+            ShadowBulkFetcherConfig() noexcept;
+            ShadowBulkFetcherConfig(const ShadowBulkFetcherConfig &rhs) = default;
+            ShadowBulkFetcherConfig(ShadowBulkFetcherConfig &&rhs) = default;
+
+            ShadowBulkFetcherConfig &operator=(const ShadowBulkFetcherConfig &rhs) = default;
+            ShadowBulkFetcherConfig &operator=(ShadowBulkFetcherConfig &&rhs) = default;
+
+            ~ShadowBulkFetcherConfig() = default;
+
+            /**
+             * How many gets may await a response at once.
+             */
+            size_t MaxInFlight;
+
+            /**
+             * How long, in milliseconds, a get waits for its response before it fails with
+             * AWS_ERROR_MQTT_TIMEOUT and frees its slot.
+             */
+            uint32_t TimeoutMs;
+
+            /**
+             * The QoS used for the subscriptions and the get publishes.
+             */
+            Crt::Mqtt::QOS Qos;
+        };
+
+        /**
+         * Called once per thing fetched. Exactly one of `response` (accepted) or `error` (rejected, e.g. 404 for a
+         * thing without a shadow) is set, unless the get failed locally or timed out with ioErr.
+         */
+        using OnShadowFetched = std::function<
+            void(const Crt::String &thingName, GetShadowResponse *response, ErrorResponse *error, int ioErr)>;
+
+        /**
+         * Called once every thing of a Fetch has been reported, with how many were accepted and how many not.
+         */
+        using OnBulkFetchComplete = std::function<void(size_t accepted, size_t failed)>;
+
+        /**
+         * Fetches the classic shadows of many things, as a gateway does for its child devices on startup.
+         *
+         * Responses arrive over one pair of get accepted/rejected subscriptions with a "+" thing name, and are
+         * matched to their request by client token, so up to MaxInFlight gets run at once instead of one per
+         * round trip. Things are fetched in the order given, each reported as its response arrives.
+         */
+        class AWS_IOTSHADOW_API ShadowBulkFetcher final : public std::enable_shared_from_this<ShadowBulkFetcher>
+        {
+          public:
+            ~ShadowBulkFetcher() = default;
+
+            ShadowBulkFetcher(const ShadowBulkFetcher &) = delete;
+            ShadowBulkFetcher(ShadowBulkFetcher &&) = delete;
+            ShadowBulkFetcher &operator=(const ShadowBulkFetcher &) = delete;
+            ShadowBulkFetcher &operator=(ShadowBulkFetcher &&) = delete;
+
+            /**
+             * Subscribes to the get accepted and rejected topics of every thing. onSubAck is invoked once both
+             * complete, with the first error encountered (if any). Call once before fetching.
+             */
+            bool Subscribe(const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Queues a get for each of `thingNames`. Batches queued by separate calls share the window and run in
+             * the order queued.
+             */
+            bool Fetch(
+                const Crt::Vector<Crt::String> &thingNames,
+                const OnShadowFetched &onFetched,
+                const OnBulkFetchComplete &onComplete = OnBulkFetchComplete());
+
+            /**
+             * Fails every queued and in-flight get with errorCode, e.g. after the connection was lost.
+             */
+            void CancelAll(int errorCode);
+
+            /**
+             * Number of gets queued or awaiting a response.
+             */
+            size_t GetPendingCount() const;
+
+            static std::shared_ptr<ShadowBulkFetcher> Create(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const ShadowBulkFetcherConfig &config = ShadowBulkFetcherConfig(),
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Batch
+            {
+                OnShadowFetched OnFetched;
+                OnBulkFetchComplete OnComplete;
+                size_t Remaining;
+                size_t Accepted;
+                size_t Failed;
+            };
+
+            struct Request
+            {
+                Crt::String ThingName;
+                std::shared_ptr<Batch> Owner;
+                uint64_t DeadlineNs;
+            };
+
+            ShadowBulkFetcher(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const ShadowBulkFetcherConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            void Pump();
+            bool Finish(const Crt::String &clientToken, GetShadowResponse *response, ErrorResponse *error, int ioErr);
+            void Report(Request &request, GetShadowResponse *response, ErrorResponse *error, int ioErr);
+            void ScheduleTimeoutCheck();
+            void ExpireRequests();
+
+            static void s_onTimeoutTask(aws_task *task, void *arg, aws_task_status status);
+
+            IotShadowClient m_client;
+            ShadowBulkFetcherConfig m_config;
+            Crt::Allocator *m_allocator;
+            aws_event_loop *m_eventLoop;
+
+            mutable std::mutex m_lock;
+            Crt::List<Request> m_queued;
+            Crt::Map<Crt::String, Request> m_inFlight;
+            bool m_timeoutScheduled;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
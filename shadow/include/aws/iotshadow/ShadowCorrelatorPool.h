@@ -0,0 +1,38 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowRequestCorrelator.h>
+
+#include <aws/iotdevicecommon/LazySubscriptions.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * The classic-shadow correlators of a gateway's things, each subscribed to its get, update and delete
+         * responses on first use and unsubscribed once idle with no request in flight. `config.Timers`, if
+         * unset, is set to `timers`, so the request timeouts share the wheel:
+         *
+         *     auto shadows = Iotshadow::CreateShadowCorrelatorPool(
+         *         shadowClient, eventLoopGroup, Iotshadow::ShadowRequestCorrelatorConfig(), timers, 600000, qos);
+         *     shadows->Acquire(childName, [](const std::shared_ptr<ShadowRequestCorrelator> &shadow, int err) {
+         *         if (shadow) { shadow->GetShadowAsync(qos, onGet); }
+         *     });
+         */
+        using ShadowCorrelatorPool = Iotdevicecommon::LazySubscriptions<ShadowRequestCorrelator>;
+
+        AWS_IOTSHADOW_API std::shared_ptr<ShadowCorrelatorPool> CreateShadowCorrelatorPool(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const ShadowRequestCorrelatorConfig &config,
+            const std::shared_ptr<Iotdevicecommon::TimerWheel> &timers,
+            uint32_t idleTtlMs,
+            Crt::Mqtt::QOS qos,
+            Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+    } // namespace Iotshadow
+} // namespace Aws
@@ -0,0 +1,123 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+
+#include <aws/iotdevicecommon/HandlerExecutor.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        class AWS_IOTSHADOW_API ShadowDeltaQueueConfig final
+        {
+          public:
+            ShadowDeltaQueueConfig() noexcept;
+            ShadowDeltaQueueConfig(const ShadowDeltaQueueConfig &rhs) = default;
+            ShadowDeltaQueueConfig(ShadowDeltaQueueConfig &&rhs) = default;
+
+            ShadowDeltaQueueConfig &operator=(const ShadowDeltaQueueConfig &rhs) = default;
+            ShadowDeltaQueueConfig &operator=(ShadowDeltaQueueConfig &&rhs) = default;
+
+            ~ShadowDeltaQueueConfig() = default;
+
+            /**
+             * The most deltas held for one shadow while its handler is busy. When a delta arrives for a full
+             * queue, the queued deltas are discarded and only the new one is kept. Zero is treated as one.
+             */
+            size_t MaxQueuedPerShadow;
+
+            /**
+             * Executor the handlers are run on, keyed by thing name.
+             * Optional. When unset, handlers run on the thread that delivered the delta, so deltas never
+             * queue up and nothing is coalesced.
+             */
+            Iotdevicecommon::HandlerExecutor Executor;
+        };
+
+        /**
+         * Opt-in layer over IotShadowClient that bounds the backlog of shadow delta events. Each subscribed
+         * shadow gets its own queue; at most one handler call per shadow runs at a time, in version order.
+         *
+         * Each delta carries the complete difference between desired and reported state at its version, so a
+         * newer delta supersedes older ones. When a shadow's queue is full the older deltas are dropped and only
+         * the newest is kept, and a delta whose version is not newer than one already queued or delivered is
+         * dropped on arrival. Memory therefore stays bounded during delta storms and handlers always see the
+         * freshest state.
+         *
+         * Wildcard thing and shadow names are rejected, since deltas would then share one queue.
+         */
+        class AWS_IOTSHADOW_API ShadowDeltaQueue final : public std::enable_shared_from_this<ShadowDeltaQueue>
+        {
+          public:
+            ShadowDeltaQueue(const ShadowDeltaQueue &) = delete;
+            ShadowDeltaQueue(ShadowDeltaQueue &&) = delete;
+            ShadowDeltaQueue &operator=(const ShadowDeltaQueue &) = delete;
+            ShadowDeltaQueue &operator=(ShadowDeltaQueue &&) = delete;
+
+            ~ShadowDeltaQueue() = default;
+
+            bool SubscribeToShadowDeltaUpdatedEvents(
+                const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToNamedShadowDeltaUpdatedEvents(
+                const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * @return the number of deltas dropped so far, either superseded in a full queue or stale on
+             * arrival.
+             */
+            uint64_t GetCoalescedCount() const noexcept { return m_coalescedCount.load(); }
+
+            static std::shared_ptr<ShadowDeltaQueue> Create(
+                const IotShadowClient &client,
+                const ShadowDeltaQueueConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct ShadowQueue
+            {
+                Crt::String ThingName;
+                OnSubscribeToShadowDeltaUpdatedEventsResponse Handler;
+
+                std::mutex Lock;
+                std::deque<ShadowDeltaUpdatedEvent> Queued;
+                Crt::Optional<int32_t> LatestVersion;
+                bool Draining = false;
+            };
+
+            ShadowDeltaQueue(
+                const IotShadowClient &client,
+                const ShadowDeltaQueueConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            OnSubscribeToShadowDeltaUpdatedEventsResponse MakeQueuedHandler(
+                const Crt::String &thingName,
+                const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler);
+            void Push(const std::shared_ptr<ShadowQueue> &queue, ShadowDeltaUpdatedEvent &&event);
+            void Drain(const std::shared_ptr<ShadowQueue> &queue);
+
+            IotShadowClient m_client;
+            ShadowDeltaQueueConfig m_config;
+            Crt::Allocator *m_allocator;
+            std::atomic<uint64_t> m_coalescedCount;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -0,0 +1,143 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * Receives the part of a delta under one routed path. `delta` is the member at `path` within the
+         * event's state, and is only valid for the call; copy out of it to keep any of it.
+         */
+        using OnShadowDeltaPathUpdated = std::function<
+            void(const Crt::String &path, const Crt::JsonView &delta, const ShadowDeltaUpdatedEvent &event)>;
+
+        /**
+         * Routes the delta events of one shadow to handlers registered for paths within its state, such as
+         * "lights.kitchen", so that each component of an agent sees only the subtree it owns instead of
+         * searching every delta for it.
+         *
+         * The routed paths form an index that each delta is walked along once: a handler is invoked only when
+         * the delta has a member at its path, and the walk never descends into members no path names.
+         * Subscribing through the router also sets the request's Projection to the routed paths, so only their
+         * subtrees of each delta are materialized. A path's handlers are invoked before those of the paths below
+         * it, and sibling paths in the order they were first routed.
+         *
+         * The route index is copied on Route() and Unroute() and shared by Dispatch(), so a handler may add or
+         * remove routes. Routing a new path once subscribed subscribes again, to widen the projection.
+         */
+        class AWS_IOTSHADOW_API ShadowDeltaRouter final : public std::enable_shared_from_this<ShadowDeltaRouter>
+        {
+          public:
+            ShadowDeltaRouter(const ShadowDeltaRouter &) = delete;
+            ShadowDeltaRouter(ShadowDeltaRouter &&) = delete;
+            ShadowDeltaRouter &operator=(const ShadowDeltaRouter &) = delete;
+            ShadowDeltaRouter &operator=(ShadowDeltaRouter &&) = delete;
+
+            ~ShadowDeltaRouter() = default;
+
+            /**
+             * Invokes `handler` for every delta with a member at `path`, dot-separated and relative to the
+             * state, e.g. "color" or "lights.kitchen".
+             *
+             * @return the id to unroute the handler by, or 0, with the error raised, if the path is empty or
+             * has an empty segment.
+             */
+            uint64_t Route(const Crt::String &path, OnShadowDeltaPathUpdated &&handler);
+
+            /**
+             * Stops invoking the handler. A delta being dispatched may still reach it once.
+             *
+             * @return false if no route has that id.
+             */
+            bool Unroute(uint64_t routeId);
+
+            size_t GetRouteCount() const;
+
+            /**
+             * Subscribes to the shadow's delta events and dispatches each of them. Paths already in the
+             * request's Projection are kept, alongside the routed ones.
+             */
+            bool SubscribeToShadowDeltaUpdatedEvents(
+                const ShadowDeltaUpdatedSubscriptionRequest &request,
+                Crt::Mqtt::QOS qos,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToNamedShadowDeltaUpdatedEvents(
+                const NamedShadowDeltaUpdatedSubscriptionRequest &request,
+                Crt::Mqtt::QOS qos,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Invokes the handlers of every routed path `event` has a member at. Subscribe*() dispatches each
+             * delta received; call it directly to route deltas received another way, e.g. from a
+             * ShadowEventFanOut listener, unprojected.
+             */
+            void Dispatch(const ShadowDeltaUpdatedEvent &event) const;
+
+            static std::shared_ptr<ShadowDeltaRouter> Create(
+                const IotShadowClient &client,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Handler
+            {
+                uint64_t Id;
+                std::shared_ptr<OnShadowDeltaPathUpdated> Invoke;
+            };
+
+            struct Node
+            {
+                Crt::String Name;
+                /* The path from the state down to this node, as routed. */
+                Crt::String Path;
+                Crt::Vector<size_t> Children;
+                Crt::Vector<Handler> Handlers;
+            };
+
+            /* Nodes[0] is the state itself. */
+            using Index = Crt::Vector<Node>;
+
+            /* Issues the subscription with the given projection. */
+            using Subscribe =
+                std::function<bool(Crt::Vector<Crt::String> &&projection, const OnSubscribeComplete &onSubAck)>;
+
+            ShadowDeltaRouter(const IotShadowClient &client, Crt::Allocator *allocator) noexcept;
+
+            bool SubscribeWith(
+                Subscribe &&subscribe,
+                const Crt::Optional<Crt::Vector<Crt::String>> &requestProjection,
+                const OnSubscribeComplete &onSubAck);
+            OnSubscribeToShadowDeltaUpdatedEventsResponse MakeDispatcher();
+            Crt::Vector<Crt::String> ProjectionOf(const Index &index) const;
+            void Walk(
+                const Index &index,
+                size_t node,
+                const Crt::JsonView &delta,
+                const ShadowDeltaUpdatedEvent &event) const;
+
+            IotShadowClient m_client;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            std::shared_ptr<const Index> m_index;
+            uint64_t m_nextRouteId;
+            /* Set once subscribed, to subscribe again when a new path widens the projection. */
+            Subscribe m_subscribe;
+            Crt::Vector<Crt::String> m_requestProjection;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
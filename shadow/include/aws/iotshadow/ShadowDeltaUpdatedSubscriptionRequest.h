@@ -26,6 +26,12 @@ namespace Aws
 
             Aws::Crt::Optional<Aws::Crt::String> ThingName;
 
+            /**
+             * Optional. Paths, relative to the received document, of the members to materialize, such as
+             * "state.color"; see Iotdevicecommon::JsonProjection. Not serialized.
+             */
+            Aws::Crt::Optional<Aws::Crt::Vector<Aws::Crt::String>> Projection;
+
           private:
             static void LoadFromObject(ShadowDeltaUpdatedSubscriptionRequest &obj, const Crt::JsonView &doc);
         };
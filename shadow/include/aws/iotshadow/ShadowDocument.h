@@ -0,0 +1,200 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/ShadowMetadata.h>
+
+#include <aws/crt/JsonObject.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * Local, thread-safe model of a single (optionally named) shadow.
+         *
+         * The document keeps the latest desired and reported state, their metadata and the shadow version,
+         * and applies GetShadow/UpdateShadow responses and updated/delta events incrementally. Anything
+         * older than the version already held is ignored, so events may arrive in any order.
+         *
+         * Reads never wait on an update being applied: each update publishes a new immutable Snapshot with an
+         * atomic pointer swap, and readers take whichever snapshot is current. Parts of the document an update
+         * leaves alone are shared between snapshots rather than copied.
+         */
+        class AWS_IOTSHADOW_API ShadowDocument final : public std::enable_shared_from_this<ShadowDocument>
+        {
+          public:
+            /**
+             * The document at one version. A snapshot is never changed once published, so it may be read
+             * from any thread for as long as it is held. Unset parts are null.
+             */
+            struct Snapshot
+            {
+                Crt::Optional<int32_t> Version;
+                std::shared_ptr<const Crt::JsonObject> Desired;
+                std::shared_ptr<const Crt::JsonObject> Reported;
+                std::shared_ptr<const Crt::JsonObject> DesiredMetadata;
+                std::shared_ptr<const Crt::JsonObject> ReportedMetadata;
+                /** Whether the state was restored from storage and the service has not confirmed it yet. */
+                bool Restored = false;
+            };
+
+            /**
+             * Invoked with each snapshot as it is published, in order, while further updates wait.
+             */
+            using OnSnapshotPublished =
+                std::function<void(const ShadowDocument &document, const std::shared_ptr<const Snapshot> &snapshot)>;
+
+            ShadowDocument(const ShadowDocument &) = delete;
+            ShadowDocument(ShadowDocument &&) = delete;
+            ShadowDocument &operator=(const ShadowDocument &) = delete;
+            ShadowDocument &operator=(ShadowDocument &&) = delete;
+
+            ~ShadowDocument() = default;
+
+            /**
+             * Subscribes to the accepted GetShadow/UpdateShadow responses and the updated/delta events of
+             * this shadow and keeps the document current from them. onSubAck is invoked once, after all
+             * subscriptions complete, with the first error encountered (if any).
+             */
+            bool Subscribe(IotShadowClient &client, Crt::Mqtt::QOS qos, const OnSubscribeComplete &onSubAck);
+
+            void Apply(const GetShadowResponse &response);
+            void Apply(const UpdateShadowResponse &response);
+            void Apply(const ShadowUpdatedEvent &event);
+            void Apply(const ShadowDeltaUpdatedEvent &event);
+
+            /**
+             * Forgets all cached state, e.g. after the shadow has been deleted.
+             */
+            void Clear();
+
+            /**
+             * Writes the current snapshot, as one line of compact JSON, to `path`, replacing the file whole so a
+             * crash leaves either the old snapshot or the new one.
+             *
+             * @return false, with the error raised, if the file could not be written.
+             */
+            bool Save(const char *path) const;
+
+            /**
+             * Loads a snapshot written by Save for this shadow, so a restarted device can act on its last-known
+             * state before it connects; a document already holding the same or a newer version is left alone.
+             * Restored state stands until the service answers: the next GetShadow response or updated event
+             * replaces it whatever its version, since the shadow may have been deleted and created again.
+             *
+             * @return false, with the error raised, if the file cannot be read or holds another shadow.
+             */
+            bool Restore(const char *path);
+
+            /**
+             * Sets the handler told of each new snapshot, e.g. to mirror the document elsewhere. It is invoked
+             * at once with the current snapshot, so nothing published meanwhile is missed.
+             */
+            void SetOnSnapshotPublished(OnSnapshotPublished &&onPublished) noexcept;
+
+            const Crt::String &GetThingName() const noexcept { return m_thingName; }
+            const Crt::Optional<Crt::String> &GetShadowName() const noexcept { return m_shadowName; }
+
+            /**
+             * @return the current snapshot; never null. Cheaper than the getters below, which copy out of it.
+             */
+            std::shared_ptr<const Snapshot> GetSnapshot() const;
+
+            Crt::Optional<int32_t> GetVersion() const;
+            Crt::Optional<Crt::JsonObject> GetDesired() const;
+            Crt::Optional<Crt::JsonObject> GetReported() const;
+            Crt::Optional<ShadowMetadata> GetMetadata() const;
+
+            /**
+             * Returns a copy of a single top-level desired (or reported) property, if present.
+             */
+            Crt::Optional<Crt::JsonObject> GetDesiredValue(const Crt::String &key) const;
+            Crt::Optional<Crt::JsonObject> GetReportedValue(const Crt::String &key) const;
+
+            /**
+             * Returns the merge patch that turns the cached desired (or reported) state into the given one,
+             * so an update only carries changed keys. Empty when nothing changed.
+             */
+            Crt::Optional<Crt::JsonObject> DiffDesired(const Crt::JsonView &desired) const;
+            Crt::Optional<Crt::JsonObject> DiffReported(const Crt::JsonView &reported) const;
+
+            /**
+             * Computes the JSON merge patch from `from` to `to`: added or changed keys carry their new value,
+             * nested objects are diffed recursively and removed keys are set to null. Empty when the two
+             * documents are equal.
+             */
+            static Crt::Optional<Crt::JsonObject> CreateMergePatch(const Crt::JsonView &from, const Crt::JsonView &to);
+
+            /**
+             * Encodes a snapshot of a shadow as one line of compact JSON laid out like a GetShadow response, the
+             * format Save writes.
+             */
+            static Crt::String EncodeSnapshot(
+                const Crt::String &thingName,
+                const Crt::Optional<Crt::String> &shadowName,
+                const Snapshot &snapshot);
+
+            /**
+             * Decodes what EncodeSnapshot wrote, along with the names of its shadow.
+             *
+             * @return false, with AWS_ERROR_INVALID_ARGUMENT raised, if `encoded` is not an encoded snapshot.
+             */
+            static bool DecodeSnapshot(
+                const Crt::String &encoded,
+                Crt::String &thingName,
+                Crt::Optional<Crt::String> &shadowName,
+                Snapshot &snapshot,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+            static std::shared_ptr<ShadowDocument> Create(
+                const Crt::String &thingName,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+            static std::shared_ptr<ShadowDocument> CreateNamed(
+                const Crt::String &thingName,
+                const Crt::String &shadowName,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            ShadowDocument(
+                const Crt::String &thingName,
+                const Crt::Optional<Crt::String> &shadowName,
+                Crt::Allocator *allocator) noexcept;
+
+            static std::shared_ptr<ShadowDocument> s_create(
+                const Crt::String &thingName,
+                const Crt::Optional<Crt::String> &shadowName,
+                Crt::Allocator *allocator);
+
+            /* Requires m_updateLock. A copy of the current snapshot to build the next one from, or null if the
+             * current one is at least as new as `version`. */
+            std::shared_ptr<Snapshot> BeginUpdateLocked(const Crt::Optional<int32_t> &version) const;
+            /* Requires m_updateLock. As BeginUpdateLocked, for an update carrying the whole document, which
+             * also supersedes restored state of any version. */
+            std::shared_ptr<Snapshot> BeginReplaceLocked(const Crt::Optional<int32_t> &version) const;
+            /* Requires m_updateLock. */
+            void PublishLocked(std::shared_ptr<const Snapshot> snapshot);
+
+            Crt::String m_thingName;
+            Crt::Optional<Crt::String> m_shadowName;
+            Crt::Allocator *m_allocator;
+
+            /* Serializes the updates; readers never take it. */
+            std::mutex m_updateLock;
+            /* Serializes Save, which writes through a temporary file. */
+            mutable std::mutex m_saveLock;
+            /* Read and replaced with std::atomic_load and std::atomic_store only. */
+            std::shared_ptr<const Snapshot> m_snapshot;
+            OnSnapshotPublished m_onSnapshotPublished;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
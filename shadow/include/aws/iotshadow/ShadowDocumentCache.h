@@ -0,0 +1,142 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowCorrelatorPool.h>
+#include <aws/iotshadow/ShadowDocument.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        class AWS_IOTSHADOW_API ShadowDocumentCacheConfig final
+        {
+          public:
+            ShadowDocumentCacheConfig() noexcept;
+            ShadowDocumentCacheConfig(const ShadowDocumentCacheConfig &rhs) = default;
+            ShadowDocumentCacheConfig(ShadowDocumentCacheConfig &&rhs) = default;
+
+            ShadowDocumentCacheConfig &operator=(const ShadowDocumentCacheConfig &rhs) = default;
+            ShadowDocumentCacheConfig &operator=(ShadowDocumentCacheConfig &&rhs) = default;
+
+            ~ShadowDocumentCacheConfig() = default;
+
+            /**
+             * The memory the cached documents may hold, by their parsed JSON. Least recently used documents
+             * are evicted beyond it. Defaults to 4 MiB.
+             */
+            size_t MaxBytes;
+
+            /**
+             * The QoS of the gets that fetch a document. Defaults to at least once.
+             */
+            Crt::Mqtt::QOS Qos;
+        };
+
+        /**
+         * Invoked with the document of a thing, or with the rejection or error of the get fetching it.
+         */
+        using OnShadowDocumentFetched = std::function<
+            void(const std::shared_ptr<ShadowDocument> &document, Aws::Iotshadow::ErrorResponse *error, int ioErr)>;
+
+        /**
+         * The classic shadow documents of a gateway's things, held within a byte budget.
+         *
+         * Each document is charged the memory of its parsed desired and reported state and their metadata,
+         * walked as it is fetched and again on each snapshot it publishes; parts a snapshot shares with the
+         * last one are not walked again. Past MaxBytes, the least recently used documents are evicted, and
+         * fetched again on their next Get through the pool's correlator, whose gets are single-flight. Gets of
+         * a document already being fetched wait on that fetch.
+         *
+         * Documents handed out keep working once evicted, but are no longer accounted for or kept current;
+         * apply events to the one Find returns. The cache sets each document's OnSnapshotPublished handler.
+         */
+        class AWS_IOTSHADOW_API ShadowDocumentCache final : public std::enable_shared_from_this<ShadowDocumentCache>
+        {
+          public:
+            ShadowDocumentCache(const ShadowDocumentCache &) = delete;
+            ShadowDocumentCache(ShadowDocumentCache &&) = delete;
+            ShadowDocumentCache &operator=(const ShadowDocumentCache &) = delete;
+            ShadowDocumentCache &operator=(ShadowDocumentCache &&) = delete;
+
+            ~ShadowDocumentCache() = default;
+
+            /**
+             * Hands `onFetched` the thing's document, fetching it first unless cached. A cached document is
+             * handed over within the call, and counts as used.
+             *
+             * @return false, with the error raised, if the fetch could not be started.
+             */
+            bool Get(const Crt::String &thingName, OnShadowDocumentFetched &&onFetched);
+
+            /**
+             * @return the thing's document if cached, counting it as used, or null.
+             */
+            std::shared_ptr<ShadowDocument> Find(const Crt::String &thingName);
+
+            /**
+             * @return false if the thing's document is not cached.
+             */
+            bool Evict(const Crt::String &thingName);
+
+            size_t GetDocumentCount() const;
+            size_t GetByteCount() const;
+            uint64_t GetEvictionCount() const;
+
+            static std::shared_ptr<ShadowDocumentCache> Create(
+                const std::shared_ptr<ShadowCorrelatorPool> &correlators,
+                const ShadowDocumentCacheConfig &config = ShadowDocumentCacheConfig(),
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            /* A part of a snapshot, by the object it was charged for. */
+            struct Part
+            {
+                const Crt::JsonObject *Object = nullptr;
+                size_t Bytes = 0;
+            };
+
+            struct Entry
+            {
+                std::shared_ptr<ShadowDocument> Document;
+                Crt::List<Crt::String>::iterator Recency;
+                Part Parts[4];
+                size_t Bytes = 0;
+            };
+
+            ShadowDocumentCache(
+                const std::shared_ptr<ShadowCorrelatorPool> &correlators,
+                const ShadowDocumentCacheConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            void Fetched(const Crt::String &thingName, GetShadowResponse *response, ErrorResponse *error, int ioErr);
+            /* Recharges the entry for `snapshot`. */
+            void Charge(Entry &entry, const ShadowDocument::Snapshot &snapshot);
+            void OnSnapshot(
+                const ShadowDocument &document,
+                const std::shared_ptr<const ShadowDocument::Snapshot> &snapshot);
+            /* Moves the least recently used documents but `keep` into `evicted` until within the budget. */
+            void EvictOverBudgetLocked(const Crt::String &keep, Crt::Vector<std::shared_ptr<ShadowDocument>> &evicted);
+
+            std::shared_ptr<ShadowCorrelatorPool> m_correlators;
+            ShadowDocumentCacheConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, Entry> m_entries;
+            /* Thing names, most recently used first. */
+            Crt::List<Crt::String> m_recency;
+            /* The gets waiting on each fetch in progress. */
+            Crt::Map<Crt::String, Crt::Vector<OnShadowDocumentFetched>> m_fetches;
+            size_t m_bytes;
+            uint64_t m_evictionCount;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -0,0 +1,126 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+
+#include <aws/iotdevicecommon/ModelFanOut.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * Receives every delta of one shadow, as parsed once for all the listeners of its topic. The event must
+         * not be modified; copy out of it to keep any of it.
+         */
+        using OnSharedShadowDeltaUpdated = std::function<void(const ShadowDeltaUpdatedEvent *event, int ioErr)>;
+
+        /**
+         * Lets several components of one agent listen to the delta events of the same shadow through a single
+         * broker subscription, instead of each subscribing, which replaces the handler of the one before, and
+         * parsing each delta again.
+         *
+         * The first Attach*() for a shadow subscribes through the client, with the projection of its request;
+         * later ones only add a listener and complete onSubAck once that subscription is acknowledged. Every
+         * delta is parsed once and handed, const, to each listener in turn. A failed subscription is reported
+         * to the listeners waiting for it and forgotten, so the next Attach*() subscribes again. Detaching the
+         * last listener of a shadow keeps the broker subscription for later listeners.
+         *
+         * Attach outside SubscriptionHandle::Capture scopes, as a capture would tie the shared subscription to
+         * whichever component attached first.
+         */
+        class AWS_IOTSHADOW_API ShadowEventFanOut final : public std::enable_shared_from_this<ShadowEventFanOut>
+        {
+          public:
+            ShadowEventFanOut(const ShadowEventFanOut &) = delete;
+            ShadowEventFanOut(ShadowEventFanOut &&) = delete;
+            ShadowEventFanOut &operator=(const ShadowEventFanOut &) = delete;
+            ShadowEventFanOut &operator=(ShadowEventFanOut &&) = delete;
+
+            ~ShadowEventFanOut() = default;
+
+            /**
+             * @return the id to detach the listener by, or 0, with the error raised, if the subscribe could not
+             * be issued.
+             */
+            uint64_t AttachToShadowDeltaUpdatedEvents(
+                const ShadowDeltaUpdatedSubscriptionRequest &request,
+                Crt::Mqtt::QOS qos,
+                OnSharedShadowDeltaUpdated &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            uint64_t AttachToNamedShadowDeltaUpdatedEvents(
+                const NamedShadowDeltaUpdatedSubscriptionRequest &request,
+                Crt::Mqtt::QOS qos,
+                OnSharedShadowDeltaUpdated &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Stops invoking the listener. A delta being dispatched may still reach it once.
+             *
+             * @return false if no listener has that id.
+             */
+            bool Detach(uint64_t listenerId);
+
+            /**
+             * @return the number of listeners attached to the shadow, named if `shadowName` is not empty.
+             */
+            size_t GetListenerCount(const Crt::String &thingName, const Crt::String &shadowName = "") const;
+
+            static std::shared_ptr<ShadowEventFanOut> Create(
+                const IotShadowClient &client,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            using DeltaFanOut = Iotdevicecommon::ModelFanOut<ShadowDeltaUpdatedEvent>;
+
+            struct ListenerRef
+            {
+                Crt::String Key;
+                uint64_t FanOutId;
+            };
+
+            struct Subscription
+            {
+                std::shared_ptr<DeltaFanOut> FanOut;
+                bool Acknowledged;
+                Crt::Vector<OnSubscribeComplete> PendingAcks;
+            };
+
+            ShadowEventFanOut(const IotShadowClient &client, Crt::Allocator *allocator) noexcept;
+
+            using Subscribe = std::function<bool(
+                OnSubscribeToShadowDeltaUpdatedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck)>;
+
+            /* Adds the listener under `key`, a shadow's delta topic, calling subscribe first if it is new. */
+            uint64_t Attach(
+                const Crt::String &key,
+                OnSharedShadowDeltaUpdated &&handler,
+                const OnSubscribeComplete &onSubAck,
+                const Subscribe &subscribe);
+            void OnSubAck(const Crt::String &key, const std::shared_ptr<DeltaFanOut> &fanOut, int errorCode);
+            void Forget(const Crt::String &key, const std::shared_ptr<DeltaFanOut> &fanOut);
+
+            IotShadowClient m_client;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, Subscription> m_subscriptions;
+            /* Where each listener is attached, by the id Attach*() returned. */
+            Crt::Map<uint64_t, ListenerRef> m_listeners;
+            uint64_t m_nextListenerId;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -15,12 +15,35 @@ namespace Aws
     namespace Iotshadow
     {
 
+        /**
+         * How shadow responses decode their metadata, which mirrors the desired and reported trees with a
+         * timestamp object per leaf.
+         */
+        enum class ShadowMetadataMode
+        {
+            /**
+             * Copy metadata.desired and metadata.reported as JsonObjects. The default.
+             */
+            Full,
+
+            /**
+             * Decode the leaf timestamps into ShadowMetadata::Timestamps; Desired and Reported stay unset.
+             */
+            Compact,
+
+            /**
+             * Leave the response's Metadata unset.
+             */
+            Skip,
+        };
+
         class AWS_IOTSHADOW_API ShadowMetadata final
         {
           public:
             ShadowMetadata() = default;
 
             ShadowMetadata(const Crt::JsonView &doc);
+            ShadowMetadata(const Crt::JsonView &doc, ShadowMetadataMode mode);
             ShadowMetadata &operator=(const Crt::JsonView &doc);
 
             void SerializeToObject(Crt::JsonObject &doc) const;
@@ -28,8 +51,14 @@ namespace Aws
             Aws::Crt::Optional<Aws::Crt::JsonObject> Desired;
             Aws::Crt::Optional<Aws::Crt::JsonObject> Reported;
 
+            /**
+             * Leaf timestamps keyed by dot-separated path, e.g. "desired.color" or "reported.list.0", set in
+             * ShadowMetadataMode::Compact. Not serialized.
+             */
+            Aws::Crt::Optional<Aws::Crt::Map<Aws::Crt::String, int64_t>> Timestamps;
+
           private:
-            static void LoadFromObject(ShadowMetadata &obj, const Crt::JsonView &doc);
+            static void LoadFromObject(ShadowMetadata &obj, const Crt::JsonView &doc, ShadowMetadataMode mode);
         };
     } // namespace Iotshadow
 } // namespace Aws
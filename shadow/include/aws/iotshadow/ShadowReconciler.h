@@ -0,0 +1,180 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/io/EventLoopGroup.h>
+
+#include <aws/common/task_scheduler.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        class AWS_IOTSHADOW_API ShadowReconcilerConfig final
+        {
+          public:
+            ShadowReconcilerConfig() noexcept;
+            ShadowReconcilerConfig(const ShadowReconcilerConfig &rhs) = default;
+            ShadowReconcilerConfig(ShadowReconcilerConfig &&rhs) = default;
+
+            ShadowReconcilerConfig &operator=(const ShadowReconcilerConfig &rhs) = default;
+            ShadowReconcilerConfig &operator=(ShadowReconcilerConfig &&rhs) = default;
+
+            ~ShadowReconcilerConfig() = default;
+
+            /**
+             * How long, in milliseconds, a desired key must go without changing before its value is applied.
+             */
+            uint32_t DebounceMs;
+
+            /**
+             * The longest, in milliseconds, a key may wait from its first pending change, however often it keeps
+             * changing. Zero means no cap.
+             */
+            uint32_t MaxDelayMs;
+
+            /**
+             * The QoS used for the delta subscription and the reported-state publishes.
+             */
+            Crt::Mqtt::QOS Qos;
+
+            /**
+             * Invoked with the outcome of each reported-state publish. Optional.
+             */
+            OnPublishComplete OnReported;
+        };
+
+        /**
+         * Applies settled desired values to the device. `reported` starts as a copy of `desired`; change it to
+         * what the device actually reached. Return false to report nothing, e.g. when the actuator failed.
+         */
+        using OnReconcileDesired = std::function<bool(const Crt::JsonView &desired, Crt::JsonObject &reported)>;
+
+        /**
+         * Debounced desired-state reconciliation for one (optionally named) shadow.
+         *
+         * Each top-level key of a delta waits until it has stopped changing for DebounceMs, or for MaxDelayMs
+         * since its first change, while later deltas replace its pending value. The keys that settle together
+         * are handed to the handler in one call, with their final values only, and what it reports goes back
+         * in one update. An operator sending a burst of changes thus moves the actuator once and gets one
+         * report, rather than a report and a fresh delta per change.
+         *
+         * Handler calls run on the event loop the reconciler was given, one at a time, except those of Flush().
+         */
+        class AWS_IOTSHADOW_API ShadowReconciler final : public std::enable_shared_from_this<ShadowReconciler>
+        {
+          public:
+            ShadowReconciler(const ShadowReconciler &) = delete;
+            ShadowReconciler(ShadowReconciler &&) = delete;
+            ShadowReconciler &operator=(const ShadowReconciler &) = delete;
+            ShadowReconciler &operator=(ShadowReconciler &&) = delete;
+
+            ~ShadowReconciler() = default;
+
+            /**
+             * Subscribes to the delta events of this shadow and reconciles them. Alternatively feed Apply()
+             * from a subscription made elsewhere, e.g. a ShadowTopicDemultiplexer.
+             */
+            bool Subscribe(const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Queues the keys of a delta. Deltas older than one already seen are ignored.
+             */
+            void Apply(const ShadowDeltaUpdatedEvent &event);
+
+            /**
+             * Applies and reports every pending key now, settled or not.
+             */
+            void Flush();
+
+            /**
+             * @return the number of pending values replaced by a later delta before they were applied.
+             */
+            uint64_t GetSupersededCount() const noexcept { return m_supersededCount.load(); }
+
+            /**
+             * @return the number of handler calls made so far.
+             */
+            uint64_t GetAppliedCount() const noexcept { return m_appliedCount.load(); }
+
+            static std::shared_ptr<ShadowReconciler> Create(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const ShadowReconcilerConfig &config,
+                const OnReconcileDesired &onReconcile,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+            static std::shared_ptr<ShadowReconciler> CreateNamed(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const Crt::String &shadowName,
+                const ShadowReconcilerConfig &config,
+                const OnReconcileDesired &onReconcile,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct PendingKey
+            {
+                Crt::JsonObject Value;
+                /* A new value moves the deadline, but never past MaxDelayMs from the first change. */
+                uint64_t FirstChangeNs;
+                uint64_t DeadlineNs;
+            };
+
+            ShadowReconciler(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const Crt::Optional<Crt::String> &shadowName,
+                const ShadowReconcilerConfig &config,
+                const OnReconcileDesired &onReconcile,
+                Crt::Allocator *allocator) noexcept;
+
+            static std::shared_ptr<ShadowReconciler> s_create(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const Crt::Optional<Crt::String> &shadowName,
+                const ShadowReconcilerConfig &config,
+                const OnReconcileDesired &onReconcile,
+                Crt::Allocator *allocator);
+
+            void Settle(bool all);
+            void Report(Crt::JsonObject &&reported);
+            void ScheduleSettle(uint64_t deadlineNs);
+
+            static void s_onSettleTask(aws_task *task, void *arg, aws_task_status status);
+
+            IotShadowClient m_client;
+            Crt::String m_thingName;
+            Crt::Optional<Crt::String> m_shadowName;
+            ShadowReconcilerConfig m_config;
+            OnReconcileDesired m_onReconcile;
+            Crt::Allocator *m_allocator;
+            aws_event_loop *m_eventLoop;
+
+            std::mutex m_lock;
+            Crt::Map<Crt::String, PendingKey> m_pending;
+            Crt::Optional<int32_t> m_version;
+            bool m_settleScheduled;
+
+            std::atomic<uint64_t> m_supersededCount;
+            std::atomic<uint64_t> m_appliedCount;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -0,0 +1,217 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/ShadowState.h>
+
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/iotdevicecommon/TimerWheel.h>
+
+#include <aws/common/task_scheduler.h>
+
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * Completion callbacks for correlated shadow requests. Exactly one of `response` (accepted) or `error`
+         * (rejected) is set on success; both are null when the request failed locally with ioErr.
+         */
+        using OnGetShadowComplete =
+            std::function<void(Aws::Iotshadow::GetShadowResponse *, Aws::Iotshadow::ErrorResponse *, int ioErr)>;
+        using OnUpdateShadowComplete =
+            std::function<void(Aws::Iotshadow::UpdateShadowResponse *, Aws::Iotshadow::ErrorResponse *, int ioErr)>;
+        using OnDeleteShadowComplete =
+            std::function<void(Aws::Iotshadow::DeleteShadowResponse *, Aws::Iotshadow::ErrorResponse *, int ioErr)>;
+
+        /**
+         * Rebuilds `state` after a version conflict, given the shadow as it is now. Return false to give up,
+         * completing the update with the conflict.
+         */
+        using OnShadowVersionConflict = std::function<bool(const Aws::Iotshadow::GetShadowResponse &, ShadowState &)>;
+
+        class AWS_IOTSHADOW_API ShadowRequestCorrelatorConfig final
+        {
+          public:
+            ShadowRequestCorrelatorConfig() noexcept;
+            ShadowRequestCorrelatorConfig(const ShadowRequestCorrelatorConfig &rhs) = default;
+            ShadowRequestCorrelatorConfig(ShadowRequestCorrelatorConfig &&rhs) = default;
+
+            ShadowRequestCorrelatorConfig &operator=(const ShadowRequestCorrelatorConfig &rhs) = default;
+            ShadowRequestCorrelatorConfig &operator=(ShadowRequestCorrelatorConfig &&rhs) = default;
+
+            ~ShadowRequestCorrelatorConfig() = default;
+
+            /**
+             * Time, in milliseconds, to wait for an accepted/rejected response before completing the request
+             * with AWS_ERROR_MQTT_TIMEOUT. Zero disables the timeout.
+             */
+            uint32_t RequestTimeoutMs;
+
+            /**
+             * If set, the request timeouts are kept in this wheel, shared with the client's other components,
+             * and cancelled as responses arrive, instead of scheduling a task per request.
+             */
+            std::shared_ptr<Iotdevicecommon::TimerWheel> Timers;
+        };
+
+        /**
+         * Asynchronous request/response API for one (optionally named) shadow.
+         *
+         * Each request is tagged with a generated ClientToken and completed from the shared accepted/rejected
+         * subscriptions, so any number of gets, updates and deletes can be in flight on one connection at a
+         * time. A request left unanswered for the config's RequestTimeoutMs completes with
+         * AWS_ERROR_MQTT_TIMEOUT, and a response arriving after that is dropped. Call Subscribe() once before
+         * issuing requests.
+         */
+        class AWS_IOTSHADOW_API ShadowRequestCorrelator final
+            : public std::enable_shared_from_this<ShadowRequestCorrelator>
+        {
+          public:
+            ShadowRequestCorrelator(const ShadowRequestCorrelator &) = delete;
+            ShadowRequestCorrelator(ShadowRequestCorrelator &&) = delete;
+            ShadowRequestCorrelator &operator=(const ShadowRequestCorrelator &) = delete;
+            ShadowRequestCorrelator &operator=(ShadowRequestCorrelator &&) = delete;
+
+            ~ShadowRequestCorrelator() = default;
+
+            /**
+             * Subscribes to the accepted and rejected topics of get, update and delete. onSubAck is invoked
+             * once, after all subscriptions complete, with the first error encountered (if any).
+             */
+            bool Subscribe(Crt::Mqtt::QOS qos, const OnSubscribeComplete &onSubAck);
+
+            /**
+             * The request functions return false, with AWS_ERROR_LIST_EXCEEDS_MAX_SIZE raised, when the
+             * client's MemoryBudget has no room for another pending request.
+             *
+             * Gets are single-flight: one issued while another is in flight sends nothing and takes no budget,
+             * and completes with a copy of that get's response, ahead of it. So components that all fetch the
+             * shadow after a reconnect cost one request between them.
+             */
+            bool GetShadowAsync(Crt::Mqtt::QOS qos, const OnGetShadowComplete &onComplete);
+
+            bool UpdateShadowAsync(
+                const ShadowState &state,
+                const Crt::Optional<int32_t> &version,
+                Crt::Mqtt::QOS qos,
+                const OnUpdateShadowComplete &onComplete);
+
+            /**
+             * As UpdateShadowAsync with a version, but an update rejected for a version conflict (code 409)
+             * fetches the shadow and is retried at its current version, up to `maxAttempts` updates in all.
+             * Each retry sends the same state, which suits reported patches, unless `onConflict` rebuilds it
+             * from the fetched document. Completes with the outcome of the last attempt.
+             */
+            bool UpdateShadowWithRetryAsync(
+                const ShadowState &state,
+                int32_t version,
+                uint32_t maxAttempts,
+                Crt::Mqtt::QOS qos,
+                const OnUpdateShadowComplete &onComplete,
+                const OnShadowVersionConflict &onConflict = OnShadowVersionConflict());
+
+            bool DeleteShadowAsync(Crt::Mqtt::QOS qos, const OnDeleteShadowComplete &onComplete);
+
+            /**
+             * Completes every in-flight request with errorCode, e.g. after the connection was lost.
+             */
+            void CancelAll(int errorCode);
+
+            /**
+             * Number of requests still waiting for a response.
+             */
+            size_t GetInFlightCount() const;
+
+            /**
+             * @param eventLoopGroup runs the request timeouts when no TimerWheel is configured.
+             */
+            static std::shared_ptr<ShadowRequestCorrelator> Create(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const ShadowRequestCorrelatorConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+            static std::shared_ptr<ShadowRequestCorrelator> CreateNamed(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const Crt::String &shadowName,
+                const ShadowRequestCorrelatorConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct VersionedUpdate;
+            struct TimeoutTask;
+
+            ShadowRequestCorrelator(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const Crt::Optional<Crt::String> &shadowName,
+                const ShadowRequestCorrelatorConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            static std::shared_ptr<ShadowRequestCorrelator> s_create(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const Crt::Optional<Crt::String> &shadowName,
+                const ShadowRequestCorrelatorConfig &config,
+                Crt::Allocator *allocator);
+
+            /* Removes the request of `clientToken` from `pending`, cancels its timer and completes it. */
+            template <typename Response, typename Callback>
+            void Complete(
+                Crt::Map<Crt::String, Callback> &pending,
+                const Crt::String &clientToken,
+                Response *response,
+                ErrorResponse *error,
+                int ioErr);
+            /* Completes the request of `clientToken`, whichever kind it is, with ioErr. */
+            void Fail(const Crt::String &clientToken, int ioErr);
+            void ScheduleTimeout(const Crt::String &clientToken);
+
+            /* Takes a claimed timeout task off the event loop. */
+            void CancelTimeoutTask(TimeoutTask *timeoutTask);
+
+            static void s_onTimeoutTask(aws_task *task, void *arg, aws_task_status status);
+            static void s_onCancelTimeoutTask(aws_task *task, void *arg, aws_task_status status);
+
+            /* Sends a get of its own, which later gets share. */
+            bool PublishGet(Crt::Mqtt::QOS qos, const OnGetShadowComplete &onComplete);
+            bool AttemptUpdate(const std::shared_ptr<VersionedUpdate> &update, int32_t version);
+            void ResolveConflict(const std::shared_ptr<VersionedUpdate> &update, const ErrorResponse &conflict);
+
+            IotShadowClient m_client;
+            Crt::String m_thingName;
+            Crt::Optional<Crt::String> m_shadowName;
+            ShadowRequestCorrelatorConfig m_config;
+            Crt::Allocator *m_allocator;
+            aws_event_loop *m_eventLoop;
+
+            mutable std::mutex m_lock;
+            Crt::Map<Crt::String, OnGetShadowComplete> m_pendingGets;
+            /* The ClientToken of the get later gets share while it is pending, and the gets sharing it. */
+            Crt::String m_sharedGetToken;
+            Crt::Vector<OnGetShadowComplete> m_getWaiters;
+            Crt::Map<Crt::String, OnUpdateShadowComplete> m_pendingUpdates;
+            Crt::Map<Crt::String, OnDeleteShadowComplete> m_pendingDeletes;
+            /* The timer in the config's Timers of each pending request that has one. */
+            Crt::Map<Crt::String, uint64_t> m_timeoutIds;
+            /* Otherwise, the event loop task of each pending request that has one. */
+            Crt::Map<Crt::String, TimeoutTask *> m_timeoutTasks;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
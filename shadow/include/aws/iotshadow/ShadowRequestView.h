@@ -0,0 +1,43 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotshadow/Exports.h>
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/PayloadWriter.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * A get or delete of a classic shadow that references the caller's strings instead of copying them,
+         * for the PublishGetShadow and PublishDeleteShadow overloads. The strings only need to stay valid for
+         * the call; an empty ClientToken is left out of the payload.
+         */
+        struct AWS_IOTSHADOW_API ShadowRequestView
+        {
+            Crt::ByteCursor ThingName;
+            Crt::ByteCursor ClientToken;
+
+            void SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const;
+        };
+
+        /**
+         * ShadowRequestView of a named shadow.
+         */
+        struct AWS_IOTSHADOW_API NamedShadowRequestView
+        {
+            Crt::ByteCursor ThingName;
+            Crt::ByteCursor ShadowName;
+            Crt::ByteCursor ClientToken;
+
+            void SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const;
+        };
+
+    } // namespace Iotshadow
+} // namespace Aws
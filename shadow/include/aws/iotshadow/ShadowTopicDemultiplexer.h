@@ -0,0 +1,137 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * Receives every shadow response and event for one thing (or all things via "+") through a single
+         * "$aws/things/<thing>/shadow/#" subscription and dispatches each message to the typed handler
+         * registered for its topic. Dispatch walks a topic-segment trie, so it costs O(topic length)
+         * regardless of how many things and shadows are registered.
+         *
+         * Handlers are registered with the same request types and handler signatures as the
+         * IotShadowClient Subscribe* calls; a request's ThingName or ShadowName may be "+" to match any.
+         * Such handlers can call Iotdevicecommon::CurrentThingName() and CurrentShadowName() to tell which
+         * shadow a message is for.
+         * Because the subscription also matches request topics, messages this connection publishes to its
+         * own shadows are echoed back and silently ignored.
+         */
+        class AWS_IOTSHADOW_API ShadowTopicDemultiplexer final
+            : public std::enable_shared_from_this<ShadowTopicDemultiplexer>
+        {
+          public:
+            ShadowTopicDemultiplexer(const ShadowTopicDemultiplexer &) = delete;
+            ShadowTopicDemultiplexer(ShadowTopicDemultiplexer &&) = delete;
+            ShadowTopicDemultiplexer &operator=(const ShadowTopicDemultiplexer &) = delete;
+            ShadowTopicDemultiplexer &operator=(ShadowTopicDemultiplexer &&) = delete;
+
+            ~ShadowTopicDemultiplexer() = default;
+
+            /**
+             * Subscribes to "$aws/things/<thingFilter>/shadow/#". thingFilter is a thing name or "+".
+             */
+            bool Subscribe(const Crt::String &thingFilter, Crt::Mqtt::QOS qos, const OnSubscribeComplete &onSubAck);
+
+            bool OnGetShadowAccepted(
+                const GetShadowSubscriptionRequest &request,
+                const OnSubscribeToGetShadowAcceptedResponse &handler);
+            bool OnGetShadowRejected(
+                const GetShadowSubscriptionRequest &request,
+                const OnSubscribeToGetShadowRejectedResponse &handler);
+            bool OnUpdateShadowAccepted(
+                const UpdateShadowSubscriptionRequest &request,
+                const OnSubscribeToUpdateShadowAcceptedResponse &handler);
+            bool OnUpdateShadowRejected(
+                const UpdateShadowSubscriptionRequest &request,
+                const OnSubscribeToUpdateShadowRejectedResponse &handler);
+            bool OnDeleteShadowAccepted(
+                const DeleteShadowSubscriptionRequest &request,
+                const OnSubscribeToDeleteShadowAcceptedResponse &handler);
+            bool OnDeleteShadowRejected(
+                const DeleteShadowSubscriptionRequest &request,
+                const OnSubscribeToDeleteShadowRejectedResponse &handler);
+            bool OnShadowDeltaUpdatedEvents(
+                const ShadowDeltaUpdatedSubscriptionRequest &request,
+                const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler);
+            bool OnShadowUpdatedEvents(
+                const ShadowUpdatedSubscriptionRequest &request,
+                const OnSubscribeToShadowUpdatedEventsResponse &handler);
+
+            bool OnGetNamedShadowAccepted(
+                const GetNamedShadowSubscriptionRequest &request,
+                const OnSubscribeToGetNamedShadowAcceptedResponse &handler);
+            bool OnGetNamedShadowRejected(
+                const GetNamedShadowSubscriptionRequest &request,
+                const OnSubscribeToGetNamedShadowRejectedResponse &handler);
+            bool OnUpdateNamedShadowAccepted(
+                const UpdateNamedShadowSubscriptionRequest &request,
+                const OnSubscribeToUpdateNamedShadowAcceptedResponse &handler);
+            bool OnUpdateNamedShadowRejected(
+                const UpdateNamedShadowSubscriptionRequest &request,
+                const OnSubscribeToUpdateNamedShadowRejectedResponse &handler);
+            bool OnDeleteNamedShadowAccepted(
+                const DeleteNamedShadowSubscriptionRequest &request,
+                const OnSubscribeToDeleteNamedShadowAcceptedResponse &handler);
+            bool OnDeleteNamedShadowRejected(
+                const DeleteNamedShadowSubscriptionRequest &request,
+                const OnSubscribeToDeleteNamedShadowRejectedResponse &handler);
+            bool OnNamedShadowDeltaUpdatedEvents(
+                const NamedShadowDeltaUpdatedSubscriptionRequest &request,
+                const OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &handler);
+            bool OnNamedShadowUpdatedEvents(
+                const NamedShadowUpdatedSubscriptionRequest &request,
+                const OnSubscribeToNamedShadowUpdatedEventsResponse &handler);
+
+            /**
+             * Routes one inbound message. Called by the subscription; exposed for connections whose
+             * messages arrive through a different subscription.
+             */
+            void Dispatch(const Crt::String &topic, const Crt::ByteBuf &payload);
+
+            static std::shared_ptr<ShadowTopicDemultiplexer> Create(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            using OnPayload = std::function<void(const Crt::ByteBuf &payload)>;
+
+            struct TopicNode
+            {
+                TopicNode() noexcept;
+
+                Crt::Map<Crt::String, size_t> Children;
+                size_t WildcardChild;
+                Crt::Vector<std::shared_ptr<OnPayload>> Handlers;
+            };
+
+            ShadowTopicDemultiplexer(
+                const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+                Crt::Allocator *allocator) noexcept;
+
+            bool Register(const Crt::String &topic, const OnPayload &handler);
+            void Match(
+                size_t node,
+                const Crt::Vector<Crt::ByteCursor> &segments,
+                size_t depth,
+                Crt::Vector<std::shared_ptr<OnPayload>> &matches) const;
+
+            std::shared_ptr<Crt::Mqtt::MqttConnection> m_connection;
+            Crt::Allocator *m_allocator;
+
+            mutable std::mutex m_lock;
+            Crt::Vector<TopicNode> m_nodes;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -0,0 +1,147 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/iotdevicecommon/IdHashMap.h>
+#include <aws/iotdevicecommon/ThingRegistry.h>
+
+#include <aws/common/task_scheduler.h>
+
+#include <memory>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        class AWS_IOTSHADOW_API ShadowUpdateCoalescerConfig final
+        {
+          public:
+            ShadowUpdateCoalescerConfig() noexcept;
+            ShadowUpdateCoalescerConfig(const ShadowUpdateCoalescerConfig &rhs) = default;
+            ShadowUpdateCoalescerConfig(ShadowUpdateCoalescerConfig &&rhs) = default;
+
+            ShadowUpdateCoalescerConfig &operator=(const ShadowUpdateCoalescerConfig &rhs) = default;
+            ShadowUpdateCoalescerConfig &operator=(ShadowUpdateCoalescerConfig &&rhs) = default;
+
+            ~ShadowUpdateCoalescerConfig() = default;
+
+            /**
+             * How long, in milliseconds, the first pending change waits for others to be merged into it
+             * before the combined update is published.
+             */
+            uint32_t CoalesceWindowMs;
+
+            /**
+             * Publish a shadow's merged update early once this many changes are pending for it.
+             * Zero means no cap.
+             */
+            size_t MaxPendingUpdates;
+
+            /**
+             * The QoS used for the merged update publishes.
+             */
+            Crt::Mqtt::QOS Qos;
+
+            /**
+             * Interns the thing and shadow names pending updates are keyed by. Share one with the other
+             * helpers of a gateway to store each name once; null gives the coalescer a registry of its own.
+             */
+            std::shared_ptr<Iotdevicecommon::ThingRegistry> Registry;
+        };
+
+        /**
+         * Opt-in layer over IotShadowClient that merges bursts of reported-state changes to the same
+         * (optionally named) shadow into a single update document.
+         *
+         * Changes are deep-merged key by key: nested objects are merged, any other value (including null)
+         * replaces what was pending. Every caller's completion handler is invoked with the result of the
+         * publish that carried its change. Any updates still pending when the coalescer is destroyed are
+         * published immediately.
+         */
+        class AWS_IOTSHADOW_API ShadowUpdateCoalescer final : public std::enable_shared_from_this<ShadowUpdateCoalescer>
+        {
+          public:
+            ~ShadowUpdateCoalescer();
+
+            ShadowUpdateCoalescer(const ShadowUpdateCoalescer &) = delete;
+            ShadowUpdateCoalescer(ShadowUpdateCoalescer &&) = delete;
+            ShadowUpdateCoalescer &operator=(const ShadowUpdateCoalescer &) = delete;
+            ShadowUpdateCoalescer &operator=(ShadowUpdateCoalescer &&) = delete;
+
+            /**
+             * Queues a change to the classic shadow's reported state. `reported` must be a JSON object.
+             */
+            bool UpdateReported(
+                const Crt::String &thingName,
+                const Crt::JsonView &reported,
+                const OnPublishComplete &onPubAck);
+
+            /**
+             * Queues a change to a named shadow's reported state. `reported` must be a JSON object.
+             */
+            bool UpdateNamedReported(
+                const Crt::String &thingName,
+                const Crt::String &shadowName,
+                const Crt::JsonView &reported,
+                const OnPublishComplete &onPubAck);
+
+            /**
+             * Publishes every pending merged update now.
+             */
+            void Flush();
+
+            static std::shared_ptr<ShadowUpdateCoalescer> Create(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const ShadowUpdateCoalescerConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct PendingUpdate
+            {
+                Crt::String ThingName;
+                Crt::Optional<Crt::String> ShadowName;
+                Crt::JsonObject Reported;
+                Crt::Vector<OnPublishComplete> Callbacks;
+            };
+
+            ShadowUpdateCoalescer(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const ShadowUpdateCoalescerConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            bool Enqueue(
+                const Crt::String &thingName,
+                const Crt::Optional<Crt::String> &shadowName,
+                const Crt::JsonView &reported,
+                const OnPublishComplete &onPubAck);
+            void ScheduleFlush();
+            void PublishPending(PendingUpdate &pending);
+
+            static void s_onFlushTask(aws_task *task, void *arg, aws_task_status status);
+
+            IotShadowClient m_client;
+            ShadowUpdateCoalescerConfig m_config;
+            Crt::Allocator *m_allocator;
+            aws_event_loop *m_eventLoop;
+
+            std::mutex m_lock;
+            std::shared_ptr<Iotdevicecommon::ThingRegistry> m_registry;
+            /* Keyed by ThingRegistry::PairKey of the thing and shadow ids; the classic shadow's is InvalidNameId. */
+            Iotdevicecommon::IdHashMap<PendingUpdate> m_pending;
+            bool m_flushScheduled;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -3,7 +3,7 @@
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0.
  */
-#include <aws/crt/DateTime.h>
+#include <aws/iotdevicecommon/PackedDateTime.h>
 #include <aws/iotshadow/ShadowUpdatedSnapshot.h>
 
 #include <aws/iotshadow/Exports.h>
@@ -22,16 +22,24 @@ namespace Aws
             ShadowUpdatedEvent() = default;
 
             ShadowUpdatedEvent(const Crt::JsonView &doc);
+
+            /**
+             * Decodes `doc`, handling its shadow metadata as `metadataMode` says.
+             */
+            ShadowUpdatedEvent(const Crt::JsonView &doc, ShadowMetadataMode metadataMode);
             ShadowUpdatedEvent &operator=(const Crt::JsonView &doc);
 
             void SerializeToObject(Crt::JsonObject &doc) const;
 
             Aws::Crt::Optional<Aws::Iotshadow::ShadowUpdatedSnapshot> Previous;
             Aws::Crt::Optional<Aws::Iotshadow::ShadowUpdatedSnapshot> Current;
-            Aws::Crt::Optional<Aws::Crt::DateTime> Timestamp;
+            Aws::Iotdevicecommon::PackedDateTime Timestamp;
 
           private:
-            static void LoadFromObject(ShadowUpdatedEvent &obj, const Crt::JsonView &doc);
+            static void LoadFromObject(
+                ShadowUpdatedEvent &obj,
+                const Crt::JsonView &doc,
+                ShadowMetadataMode metadataMode);
         };
     } // namespace Iotshadow
 } // namespace Aws
@@ -22,6 +22,11 @@ namespace Aws
             ShadowUpdatedSnapshot() = default;
 
             ShadowUpdatedSnapshot(const Crt::JsonView &doc);
+
+            /**
+             * Decodes `doc`, handling its shadow metadata as `metadataMode` says.
+             */
+            ShadowUpdatedSnapshot(const Crt::JsonView &doc, ShadowMetadataMode metadataMode);
             ShadowUpdatedSnapshot &operator=(const Crt::JsonView &doc);
 
             void SerializeToObject(Crt::JsonObject &doc) const;
@@ -31,7 +36,10 @@ namespace Aws
             Aws::Crt::Optional<int32_t> Version;
 
           private:
-            static void LoadFromObject(ShadowUpdatedSnapshot &obj, const Crt::JsonView &doc);
+            static void LoadFromObject(
+                ShadowUpdatedSnapshot &obj,
+                const Crt::JsonView &doc,
+                ShadowMetadataMode metadataMode);
         };
     } // namespace Iotshadow
 } // namespace Aws
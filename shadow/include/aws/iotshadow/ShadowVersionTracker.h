@@ -0,0 +1,99 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/Exports.h>
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/IdHashMap.h>
+#include <aws/iotdevicecommon/ThingRegistry.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * Tracks the highest shadow version seen per (thing, shadow) so stale events can be dropped. Attach one
+         * to an IotShadowClient with SetVersionTracker; it may be shared between clients and is thread-safe.
+         *
+         * Delta and updated events are tracked separately, since one update produces both at the same version.
+         * A GetShadow accepted response records its version for both, because its document already contains
+         * the state and delta of that version.
+         */
+        class AWS_IOTSHADOW_API ShadowVersionTracker final
+        {
+          public:
+            enum class EventStream
+            {
+                Delta,
+                Updated,
+            };
+
+            explicit ShadowVersionTracker(Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+
+            /**
+             * Keys shadows by ids from `registry`, which may be shared with other helpers tracking the same
+             * things so each name is stored once.
+             */
+            explicit ShadowVersionTracker(
+                std::shared_ptr<Iotdevicecommon::ThingRegistry> registry,
+                Crt::Allocator *allocator = Crt::DefaultAllocator()) noexcept;
+            ShadowVersionTracker(const ShadowVersionTracker &) = delete;
+            ShadowVersionTracker(ShadowVersionTracker &&) = delete;
+            ShadowVersionTracker &operator=(const ShadowVersionTracker &) = delete;
+            ShadowVersionTracker &operator=(ShadowVersionTracker &&) = delete;
+
+            /**
+             * Records `version` for an event on `stream`. `shadowName` is empty for the classic shadow.
+             *
+             * @return false, and counts the event as suppressed, if it is not newer than one already recorded.
+             */
+            bool Observe(
+                EventStream stream,
+                const Crt::String &thingName,
+                const Crt::String &shadowName,
+                int32_t version) noexcept;
+
+            /**
+             * Records a version learned from a full document (e.g. a GetShadow response) for both streams.
+             */
+            void RecordDocumentVersion(
+                const Crt::String &thingName,
+                const Crt::String &shadowName,
+                int32_t version) noexcept;
+
+            /**
+             * Forgets a shadow, e.g. after it was deleted and may restart at version 1.
+             */
+            void Forget(const Crt::String &thingName, const Crt::String &shadowName) noexcept;
+
+            /**
+             * @return the number of events dropped as stale.
+             */
+            uint64_t GetSuppressedCount() const noexcept { return m_suppressedCount.load(); }
+
+          private:
+            struct Versions
+            {
+                Crt::Optional<int32_t> Delta;
+                Crt::Optional<int32_t> Updated;
+            };
+
+            /* The classic shadow is keyed with InvalidNameId in place of a shadow id. */
+            uint64_t Key(const Crt::String &thingName, const Crt::String &shadowName);
+            bool FindKey(const Crt::String &thingName, const Crt::String &shadowName, uint64_t &key) const;
+
+            std::shared_ptr<Iotdevicecommon::ThingRegistry> m_registry;
+            std::mutex m_lock;
+            Iotdevicecommon::IdHashMap<Versions> m_versions;
+            std::atomic<uint64_t> m_suppressedCount;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
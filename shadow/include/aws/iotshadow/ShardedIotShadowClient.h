@@ -0,0 +1,267 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/IotShadowClient.h>
+
+#include <aws/iotdevicecommon/ConnectionShardRing.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        /**
+         * A IotShadowClient spread over several MQTT connections. Each request is routed to the connection that owns
+         * its ThingName on a consistent hash ring, so a process serving many things can use several TLS
+         * streams and event loops while keeping the IotShadowClient API. All traffic for one thing stays on one
+         * connection, which keeps its responses ordered and its subscriptions and publishes together.
+         *
+         * Requests without a ThingName, and wildcard subscriptions ("+"), go to the connection that owns
+         * that literal value, so a wildcard subscription is made once rather than on every connection.
+         */
+        class AWS_IOTSHADOW_API ShardedIotShadowClient final
+        {
+          public:
+            ShardedIotShadowClient(
+                const Aws::Crt::Vector<std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>> &connections,
+                Aws::Crt::Allocator *allocator = Aws::Crt::DefaultAllocator());
+            ShardedIotShadowClient(
+                const Aws::Crt::Vector<std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>> &connections,
+                const Aws::Iotdevicecommon::ServiceClientConfig &config,
+                Aws::Crt::Allocator *allocator = Aws::Crt::DefaultAllocator());
+
+            /**
+             * @return true if there is at least one connection and every connection is valid.
+             */
+            operator bool() const noexcept;
+            int GetLastError() const noexcept;
+
+            /**
+             * @return the number of connections requests are spread over.
+             */
+            size_t GetShardCount() const noexcept;
+
+            /**
+             * @return the client for the connection that owns `thingName`, for use with other per-connection
+             * helpers. Must not be called on a client with no connections.
+             */
+            IotShadowClient &GetClientForThing(const Aws::Crt::String &thingName) noexcept;
+
+            bool SubscribeToDeleteNamedShadowRejected(
+                const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToDeleteNamedShadowRejectedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDeleteNamedShadowRejected(
+                const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDeleteNamedShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToGetNamedShadowAccepted(
+                const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToGetNamedShadowAcceptedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetNamedShadowAccepted(
+                const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetNamedShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToShadowDeltaUpdatedEvents(
+                const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToShadowDeltaUpdatedEvents(
+                const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToShadowDeltaUpdatedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToDeleteShadowAccepted(
+                const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToDeleteShadowAcceptedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDeleteShadowAccepted(
+                const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDeleteShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToUpdateNamedShadowAccepted(
+                const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToUpdateNamedShadowAcceptedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateNamedShadowAccepted(
+                const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateNamedShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToDeleteNamedShadowAccepted(
+                const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToDeleteNamedShadowAcceptedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDeleteNamedShadowAccepted(
+                const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDeleteNamedShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToUpdateShadowAccepted(
+                const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToUpdateShadowAcceptedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateShadowAccepted(
+                const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToUpdateShadowRejected(
+                const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToUpdateShadowRejectedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateShadowRejected(
+                const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToDeleteShadowRejected(
+                const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToDeleteShadowRejectedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToDeleteShadowRejected(
+                const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToDeleteShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToUpdateNamedShadowRejected(
+                const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToUpdateNamedShadowRejectedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToUpdateNamedShadowRejected(
+                const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToUpdateNamedShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToNamedShadowUpdatedEvents(
+                const Aws::Iotshadow::NamedShadowUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToNamedShadowUpdatedEventsResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToNamedShadowUpdatedEvents(
+                const Aws::Iotshadow::NamedShadowUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToNamedShadowUpdatedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToGetShadowAccepted(
+                const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToGetShadowAcceptedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetShadowAccepted(
+                const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetShadowAcceptedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToShadowUpdatedEvents(
+                const Aws::Iotshadow::ShadowUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToShadowUpdatedEventsResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToShadowUpdatedEvents(
+                const Aws::Iotshadow::ShadowUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToShadowUpdatedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToNamedShadowDeltaUpdatedEvents(
+                const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToNamedShadowDeltaUpdatedEvents(
+                const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToGetNamedShadowRejected(
+                const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToGetNamedShadowRejectedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetNamedShadowRejected(
+                const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetNamedShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool SubscribeToGetShadowRejected(
+                const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnSubscribeToGetShadowRejectedResponse &handler,
+                const OnSubscribeComplete &onSubAck);
+            bool SubscribeToGetShadowRejected(
+                const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                OnSubscribeToGetShadowRejectedResponse &&handler,
+                const OnSubscribeComplete &onSubAck);
+
+            bool PublishGetShadow(
+                const Aws::Iotshadow::GetShadowRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishDeleteShadow(
+                const Aws::Iotshadow::DeleteShadowRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishUpdateShadow(
+                const Aws::Iotshadow::UpdateShadowRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishDeleteNamedShadow(
+                const Aws::Iotshadow::DeleteNamedShadowRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishGetNamedShadow(
+                const Aws::Iotshadow::GetNamedShadowRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            bool PublishUpdateNamedShadow(
+                const Aws::Iotshadow::UpdateNamedShadowRequest &request,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+          private:
+            IotShadowClient *ShardFor(const Aws::Crt::Optional<Aws::Crt::String> &thingName) noexcept;
+
+            Aws::Iotdevicecommon::ConnectionShardRing m_ring;
+            Aws::Crt::Vector<IotShadowClient> m_shards;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -0,0 +1,168 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowDocument.h>
+#include <aws/iotshadow/ShadowRequestCorrelator.h>
+
+#include <memory>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        class AWS_IOTSHADOW_API ShardedShadowDocumentConfig final
+        {
+          public:
+            ShardedShadowDocumentConfig() noexcept;
+            ShardedShadowDocumentConfig(const ShardedShadowDocumentConfig &rhs) = default;
+            ShardedShadowDocumentConfig(ShardedShadowDocumentConfig &&rhs) = default;
+
+            ShardedShadowDocumentConfig &operator=(const ShardedShadowDocumentConfig &rhs) = default;
+            ShardedShadowDocumentConfig &operator=(ShardedShadowDocumentConfig &&rhs) = default;
+
+            ~ShardedShadowDocumentConfig() = default;
+
+            /**
+             * The named shadow that stores each top-level state key, by key prefix. A key goes to the shard with
+             * the longest prefix it starts with; map "" to catch the keys no other prefix matches. Several
+             * prefixes may share a shadow.
+             */
+            Crt::Map<Crt::String, Crt::String> ShadowNamesByKeyPrefix;
+
+            /**
+             * How many updates a shard may send, counting the first, when they are rejected for a version
+             * conflict. Each retry is rebuilt against the shard as it is now.
+             */
+            uint32_t MaxUpdateAttempts;
+
+            /**
+             * The QoS used for the subscriptions and the requests of every shard.
+             */
+            Crt::Mqtt::QOS Qos;
+
+            /**
+             * The request timeout of every shard.
+             */
+            ShadowRequestCorrelatorConfig Requests;
+        };
+
+        /**
+         * Called once every shard of a GetAsync has answered. `state` holds the reassembled document unless a
+         * shard was rejected (`error`, other than 404 for a shard never written) or failed locally with ioErr.
+         */
+        using OnShardedShadowFetched = std::function<void(ShadowState *state, ErrorResponse *error, int ioErr)>;
+
+        /**
+         * Called once every shard an UpdateAsync changed has answered, with how many were accepted and the first
+         * rejection or local error, if any.
+         */
+        using OnShardedShadowUpdated = std::function<void(size_t shardsUpdated, ErrorResponse *error, int ioErr)>;
+
+        /**
+         * One logical shadow document stored across several named shadows of a thing, for state larger than a
+         * single shadow may hold.
+         *
+         * Top-level desired and reported keys are routed to a named shadow by key prefix. Reads get every shard
+         * at once and merge them; updates diff each shard's slice against its cached copy and only send the
+         * shards that changed, each as a merge patch at the version last seen. The cache follows the responses
+         * to this object's own requests, not shadow events, so call GetAsync again to pick up changes made
+         * elsewhere.
+         */
+        class AWS_IOTSHADOW_API ShardedShadowDocument final : public std::enable_shared_from_this<ShardedShadowDocument>
+        {
+          public:
+            ShardedShadowDocument(const ShardedShadowDocument &) = delete;
+            ShardedShadowDocument(ShardedShadowDocument &&) = delete;
+            ShardedShadowDocument &operator=(const ShardedShadowDocument &) = delete;
+            ShardedShadowDocument &operator=(ShardedShadowDocument &&) = delete;
+
+            ~ShardedShadowDocument() = default;
+
+            /**
+             * Subscribes to the request responses of every shard. onSubAck is invoked once, after all
+             * subscriptions complete, with the first error encountered (if any). Call once before any request.
+             */
+            bool Subscribe(const OnSubscribeComplete &onSubAck);
+
+            /**
+             * Gets every shard in parallel and reassembles the document from them.
+             */
+            bool GetAsync(const OnShardedShadowFetched &onComplete);
+
+            /**
+             * Makes the logical desired and/or reported document equal to those of `state`: keys missing from a
+             * document that is set are removed, a document that is not set is left alone. Only shards whose slice
+             * differs from the cache are updated; when none does, onComplete is invoked at once with zero.
+             *
+             * @return false, with AWS_ERROR_INVALID_ARGUMENT raised, if a key matches no shard.
+             */
+            bool UpdateAsync(const ShadowState &state, const OnShardedShadowUpdated &onComplete);
+
+            /**
+             * Returns the cached logical desired (or reported) document, merged from every shard.
+             */
+            Crt::Optional<Crt::JsonObject> GetDesired() const;
+            Crt::Optional<Crt::JsonObject> GetReported() const;
+
+            /**
+             * Returns the name of the shadow that stores `key`, or nullptr if no prefix matches it.
+             */
+            const Crt::String *GetShadowNameFor(const Crt::String &key) const;
+
+            /**
+             * Fails every in-flight shard request with errorCode, e.g. after the connection was lost.
+             */
+            void CancelAll(int errorCode);
+
+            /**
+             * @param eventLoopGroup runs the shard request timeouts when no TimerWheel is configured.
+             * @return nullptr, with AWS_ERROR_INVALID_ARGUMENT raised, when the config maps no prefix.
+             */
+            static std::shared_ptr<ShardedShadowDocument> Create(
+                const IotShadowClient &client,
+                Crt::Io::EventLoopGroup &eventLoopGroup,
+                const Crt::String &thingName,
+                const ShardedShadowDocumentConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            struct Shard
+            {
+                Crt::String ShadowName;
+                std::shared_ptr<ShadowDocument> Cache;
+                std::shared_ptr<ShadowRequestCorrelator> Requests;
+            };
+
+            ShardedShadowDocument(
+                const IotShadowClient &client,
+                const Crt::String &thingName,
+                const ShardedShadowDocumentConfig &config,
+                Crt::Allocator *allocator) noexcept;
+
+            bool Init(Crt::Io::EventLoopGroup &eventLoopGroup);
+            int GetShardFor(const Crt::String &key) const;
+            bool Split(const Crt::JsonView &document, Crt::Vector<Crt::JsonObject> &slices) const;
+            Crt::Optional<Crt::JsonObject> Assemble(bool desired) const;
+            bool UpdateShard(
+                Shard &shard,
+                const ShadowState &patch,
+                const Crt::Optional<Crt::JsonObject> &desired,
+                const Crt::Optional<Crt::JsonObject> &reported,
+                const OnUpdateShadowComplete &onShardComplete);
+
+            IotShadowClient m_client;
+            Crt::String m_thingName;
+            ShardedShadowDocumentConfig m_config;
+            Crt::Allocator *m_allocator;
+
+            Crt::Vector<Shard> m_shards;
+            /* Key prefixes and the index of their shard, longest prefix first. */
+            Crt::Vector<std::pair<Crt::String, size_t>> m_prefixes;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
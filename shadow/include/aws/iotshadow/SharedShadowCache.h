@@ -0,0 +1,132 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowDocument.h>
+
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        class AWS_IOTSHADOW_API SharedShadowCacheConfig final
+        {
+          public:
+            SharedShadowCacheConfig() noexcept;
+            SharedShadowCacheConfig(const SharedShadowCacheConfig &rhs) = default;
+            SharedShadowCacheConfig(SharedShadowCacheConfig &&rhs) = default;
+
+            SharedShadowCacheConfig &operator=(const SharedShadowCacheConfig &rhs) = default;
+            SharedShadowCacheConfig &operator=(SharedShadowCacheConfig &&rhs) = default;
+
+            ~SharedShadowCacheConfig() = default;
+
+            /**
+             * The file backing the shared region, which is created readable by its owner only. Put it on a
+             * memory file system, such as /dev/shm, so the region never reaches storage.
+             * Required.
+             */
+            Crt::String Path;
+
+            /**
+             * How many shadows the region holds. Defaults to 64.
+             */
+            uint32_t SlotCount;
+
+            /**
+             * Bytes per shadow, for its names and its encoded snapshot; rounded up to a multiple of 64.
+             * Defaults to 8192, the most a shadow document holds.
+             */
+            uint32_t SlotSize;
+        };
+
+        /**
+         * Shadow documents shared between the processes of a gateway through a memory-mapped region, so that
+         * only the process that owns the IotShadowClient subscribes and parses the service's messages.
+         *
+         * The owning process creates the region and mirrors its ShadowDocuments into it; each new snapshot is
+         * written to the shadow's slot in the region. Other processes open the region read-only and read the
+         * latest snapshot of a shadow without locking: each slot is guarded by a sequence counter, and a read
+         * that overlaps a write is retried. Reads never block the writer.
+         *
+         * Available on POSIX systems; elsewhere Create and Open fail with AWS_ERROR_UNSUPPORTED_OPERATION.
+         */
+        class AWS_IOTSHADOW_API SharedShadowCache final : public std::enable_shared_from_this<SharedShadowCache>
+        {
+          public:
+            SharedShadowCache(const SharedShadowCache &) = delete;
+            SharedShadowCache(SharedShadowCache &&) = delete;
+            SharedShadowCache &operator=(const SharedShadowCache &) = delete;
+            SharedShadowCache &operator=(SharedShadowCache &&) = delete;
+
+            ~SharedShadowCache();
+
+            /**
+             * Writes the document's current snapshot to its slot.
+             *
+             * @return false, with the error raised, if the cache was opened read-only, the encoded snapshot
+             * does not fit a slot (AWS_ERROR_SHORT_BUFFER), or every slot holds another shadow
+             * (AWS_ERROR_LIST_EXCEEDS_MAX_SIZE).
+             */
+            bool Publish(const ShadowDocument &document);
+
+            /**
+             * Publishes the document's snapshots from now on, as the document publishes them, through its
+             * OnSnapshotPublished handler, which this replaces.
+             */
+            bool Mirror(const std::shared_ptr<ShadowDocument> &document);
+
+            /**
+             * @return the latest snapshot of a shadow, or null, with the error raised, if the region holds none
+             * (AWS_ERROR_INVALID_ARGUMENT) or it could not be read consistently.
+             */
+            std::shared_ptr<const ShadowDocument::Snapshot> Read(
+                const Crt::String &thingName,
+                const Crt::Optional<Crt::String> &shadowName = Crt::Optional<Crt::String>()) const;
+
+            /**
+             * Creates, or recreates empty, the region at config.Path and opens it for writing. There must be
+             * only one writer of a region at a time. Readers of a region that was replaced keep reading the old
+             * one until they Open again.
+             */
+            static std::shared_ptr<SharedShadowCache> Create(
+                const SharedShadowCacheConfig &config,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+            /**
+             * Opens the region another process created at `path`, for reading.
+             */
+            static std::shared_ptr<SharedShadowCache> Open(
+                const char *path,
+                Crt::Allocator *allocator = Crt::DefaultAllocator());
+
+          private:
+            explicit SharedShadowCache(Crt::Allocator *allocator) noexcept;
+
+            bool Map(const char *path, bool writable, uint32_t slotCount, uint32_t slotSize);
+            uint8_t *GetSlot(uint32_t index) const noexcept;
+            bool Write(
+                const Crt::String &thingName,
+                const Crt::Optional<Crt::String> &shadowName,
+                const ShadowDocument::Snapshot &snapshot);
+
+            static Crt::String s_key(const Crt::String &thingName, const Crt::Optional<Crt::String> &shadowName);
+
+            Crt::Allocator *m_allocator;
+            uint8_t *m_region;
+            size_t m_regionSize;
+            bool m_writable;
+            uint32_t m_slotCount;
+            uint32_t m_slotSize;
+
+            /* Serializes the writes of this process, the only writer. */
+            std::mutex m_writeLock;
+        };
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -4,30 +4,34 @@
  */
 #include <aws/iotshadow/DeleteNamedShadowRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotshadow
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<DeleteNamedShadowRequest, true>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<DeleteNamedShadowRequest> s_fields[] = {
+                Fields::Field<Crt::String, &DeleteNamedShadowRequest::ClientToken>("clientToken"),
+            };
+        } // namespace
 
         void DeleteNamedShadowRequest::LoadFromObject(DeleteNamedShadowRequest &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void DeleteNamedShadowRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
+        void DeleteNamedShadowRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         DeleteNamedShadowRequest::DeleteNamedShadowRequest(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
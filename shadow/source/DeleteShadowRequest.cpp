@@ -4,30 +4,34 @@
  */
 #include <aws/iotshadow/DeleteShadowRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotshadow
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<DeleteShadowRequest, true>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<DeleteShadowRequest> s_fields[] = {
+                Fields::Field<Crt::String, &DeleteShadowRequest::ClientToken>("clientToken"),
+            };
+        } // namespace
 
         void DeleteShadowRequest::LoadFromObject(DeleteShadowRequest &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void DeleteShadowRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
+        void DeleteShadowRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         DeleteShadowRequest::DeleteShadowRequest(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
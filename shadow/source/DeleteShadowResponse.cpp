@@ -4,50 +4,31 @@
  */
 #include <aws/iotshadow/DeleteShadowResponse.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotshadow
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<DeleteShadowResponse>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<DeleteShadowResponse> s_fields[] = {
+                Fields::Field<int32_t, &DeleteShadowResponse::Version>("version"),
+                Fields::Field<Crt::String, &DeleteShadowResponse::ClientToken>("clientToken"),
+                Fields::Timestamp<&DeleteShadowResponse::Timestamp>("timestamp"),
+            };
+        } // namespace
 
         void DeleteShadowResponse::LoadFromObject(DeleteShadowResponse &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("version"))
-            {
-                val.Version = doc.GetInteger("version");
-            }
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
-
-            if (doc.ValueExists("timestamp"))
-            {
-                val.Timestamp = doc.GetDouble("timestamp");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void DeleteShadowResponse::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (Version)
-            {
-                object.WithInteger("version", *Version);
-            }
-
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
-
-            if (Timestamp)
-            {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         DeleteShadowResponse::DeleteShadowResponse(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
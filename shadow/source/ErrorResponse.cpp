@@ -4,60 +4,32 @@
  */
 #include <aws/iotshadow/ErrorResponse.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotshadow
     {
-
-        void ErrorResponse::LoadFromObject(ErrorResponse &val, const Aws::Crt::JsonView &doc)
+        namespace
         {
-            (void)val;
-            (void)doc;
+            using Fields = Aws::Iotdevicecommon::ModelFields<ErrorResponse>;
 
-            if (doc.ValueExists("timestamp"))
-            {
-                val.Timestamp = doc.GetDouble("timestamp");
-            }
+            constexpr Aws::Iotdevicecommon::ModelField<ErrorResponse> s_fields[] = {
+                Fields::Timestamp<&ErrorResponse::Timestamp>("timestamp"),
+                Fields::Field<Crt::String, &ErrorResponse::Message>("message"),
+                Fields::Field<Crt::String, &ErrorResponse::ClientToken>("clientToken"),
+                Fields::Field<int32_t, &ErrorResponse::Code>("code"),
+            };
+        } // namespace
 
-            if (doc.ValueExists("message"))
-            {
-                val.Message = doc.GetString("message");
-            }
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
-
-            if (doc.ValueExists("code"))
-            {
-                val.Code = doc.GetInteger("code");
-            }
+        void ErrorResponse::LoadFromObject(ErrorResponse &val, const Aws::Crt::JsonView &doc)
+        {
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void ErrorResponse::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (Timestamp)
-            {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
-            }
-
-            if (Message)
-            {
-                object.WithString("message", *Message);
-            }
-
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
-
-            if (Code)
-            {
-                object.WithInteger("code", *Code);
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         ErrorResponse::ErrorResponse(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
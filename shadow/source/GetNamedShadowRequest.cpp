@@ -4,30 +4,34 @@
  */
 #include <aws/iotshadow/GetNamedShadowRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotshadow
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<GetNamedShadowRequest, true>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<GetNamedShadowRequest> s_fields[] = {
+                Fields::Field<Crt::String, &GetNamedShadowRequest::ClientToken>("clientToken"),
+            };
+        } // namespace
 
         void GetNamedShadowRequest::LoadFromObject(GetNamedShadowRequest &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void GetNamedShadowRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
+        void GetNamedShadowRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         GetNamedShadowRequest::GetNamedShadowRequest(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
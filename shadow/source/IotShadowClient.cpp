@@ -4,6 +4,14 @@
  */
 #include <aws/iotshadow/IotShadowClient.h>
 
+#include <aws/crt/JsonObject.h>
+#include <aws/iotdevicecommon/JsonPayloadScanner.h>
+#include <aws/iotdevicecommon/JsonProjection.h>
+#include <aws/iotdevicecommon/MessageContext.h>
+#include <aws/iotdevicecommon/PayloadCodec.h>
+#include <aws/iotdevicecommon/ServiceOperations.h>
+#include <aws/iotdevicecommon/TopicBuilder.h>
+
 #include <aws/iotshadow/DeleteNamedShadowRequest.h>
 #include <aws/iotshadow/DeleteNamedShadowSubscriptionRequest.h>
 #include <aws/iotshadow/DeleteShadowRequest.h>
@@ -17,10 +25,13 @@
 #include <aws/iotshadow/GetShadowSubscriptionRequest.h>
 #include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
 #include <aws/iotshadow/NamedShadowUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/PreparedShadowUpdate.h>
 #include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
 #include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowRequestView.h>
 #include <aws/iotshadow/ShadowUpdatedEvent.h>
 #include <aws/iotshadow/ShadowUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowVersionTracker.h>
 #include <aws/iotshadow/UpdateNamedShadowRequest.h>
 #include <aws/iotshadow/UpdateNamedShadowSubscriptionRequest.h>
 #include <aws/iotshadow/UpdateShadowRequest.h>
@@ -32,67 +43,348 @@ namespace Aws
     namespace Iotshadow
     {
 
-        IotShadowClient::IotShadowClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection)
-            : m_connection(connection)
+        Crt::String CurrentShadowName()
         {
+            /* $aws/things/<thing>/shadow/name/<shadow>/... */
+            Crt::String shadowName;
+            const Crt::String *topic = Iotdevicecommon::CurrentMessageTopic();
+            Crt::String segment;
+            if (topic && Iotdevicecommon::TopicSegment(*topic, 4, segment) && segment == "name")
+            {
+                Iotdevicecommon::TopicSegment(*topic, 5, shadowName);
+            }
+            return shadowName;
         }
 
-        IotShadowClient::operator bool() const noexcept { return *m_connection; }
+        namespace
+        {
+            /**
+             * Per-subscription check against a ShadowVersionTracker. It is inactive without a tracker or for
+             * wildcard subscriptions, whose events would share one version.
+             */
+            class VersionGate final
+            {
+              public:
+                VersionGate(
+                    const std::shared_ptr<ShadowVersionTracker> &tracker,
+                    ShadowVersionTracker::EventStream stream,
+                    const Aws::Crt::Optional<Aws::Crt::String> &thingName,
+                    const Aws::Crt::Optional<Aws::Crt::String> &shadowName =
+                        Aws::Crt::Optional<Aws::Crt::String>()) noexcept
+                    : m_stream(stream)
+                {
+                    if (tracker && thingName && !s_isWildcard(*thingName) && !(shadowName && s_isWildcard(*shadowName)))
+                    {
+                        m_tracker = tracker;
+                        m_thingName = *thingName;
+                        if (shadowName)
+                        {
+                            m_shadowName = *shadowName;
+                        }
+                    }
+                }
 
-        int IotShadowClient::GetLastError() const noexcept { return aws_last_error(); }
+                /**
+                 * Reads the event version straight from a JSON payload, before it is parsed, and records it.
+                 * `checked` is set when no check after parsing is needed.
+                 *
+                 * @return true if the event is stale and should be dropped.
+                 */
+                bool IsStalePayload(
+                    const Aws::Crt::ByteBuf &payload,
+                    Aws::Iotdevicecommon::PayloadFormat format,
+                    bool &checked) const noexcept
+                {
+                    checked = !m_tracker;
+                    if (checked || format != Aws::Iotdevicecommon::PayloadFormat::Json)
+                    {
+                        return false;
+                    }
+
+                    Aws::Crt::ByteCursor document = Aws::Crt::ByteCursorFromByteBuf(payload);
+                    Aws::Crt::ByteCursor snapshot;
+                    Aws::Crt::ByteCursor version;
+                    int64_t value = 0;
+                    if (m_stream == ShadowVersionTracker::EventStream::Updated)
+                    {
+                        if (!Aws::Iotdevicecommon::JsonPayloadScanner::FindMember(document, "current", snapshot))
+                        {
+                            return false;
+                        }
+                        document = snapshot;
+                    }
+                    if (!Aws::Iotdevicecommon::JsonPayloadScanner::FindMember(document, "version", version) ||
+                        !Aws::Iotdevicecommon::JsonPayloadScanner::ReadInteger(version, value) || value < INT32_MIN ||
+                        value > INT32_MAX)
+                    {
+                        return false;
+                    }
+
+                    checked = true;
+                    return !m_tracker->Observe(m_stream, m_thingName, m_shadowName, static_cast<int32_t>(value));
+                }
 
-        bool IotShadowClient::SubscribeToDeleteNamedShadowRejected(
-            const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
-            Aws::Crt::Mqtt::QOS qos,
-            const OnSubscribeToDeleteNamedShadowRejectedResponse &handler,
-            const OnSubscribeComplete &onSubAck)
-        {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
+                /**
+                 * Checks a version taken from the parsed event, for payloads IsStalePayload could not read.
+                 *
+                 * @return true if the event is stale and should be dropped.
+                 */
+                bool IsStale(const Aws::Crt::Optional<int32_t> &version) const noexcept
+                {
+                    return m_tracker && version && !m_tracker->Observe(m_stream, m_thingName, m_shadowName, *version);
+                }
+
+                /**
+                 * Records the version of a full shadow document.
+                 */
+                void RecordDocumentVersion(const Aws::Crt::Optional<int32_t> &version) const noexcept
                 {
-                    handler(nullptr, errorCode);
+                    if (m_tracker && version)
+                    {
+                        m_tracker->RecordDocumentVersion(m_thingName, m_shadowName, *version);
+                    }
                 }
 
-                if (onSubAck)
+              private:
+                static bool s_isWildcard(const Aws::Crt::String &name) noexcept
                 {
-                    onSubAck(errorCode);
+                    return name.find_first_of("+#") != Aws::Crt::String::npos;
                 }
+
+                std::shared_ptr<ShadowVersionTracker> m_tracker;
+                ShadowVersionTracker::EventStream m_stream;
+                Aws::Crt::String m_thingName;
+                Aws::Crt::String m_shadowName;
             };
+            std::shared_ptr<Aws::Iotdevicecommon::JsonProjection> s_makeProjection(
+                const Aws::Crt::Optional<Aws::Crt::Vector<Aws::Crt::String>> &paths,
+                Aws::Crt::Allocator *allocator)
+            {
+                if (!paths)
+                {
+                    return nullptr;
+                }
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
+                return Aws::Crt::MakeShared<Aws::Iotdevicecommon::JsonProjection>(allocator, *paths, allocator);
+            }
+
+            /*
+             * Parses an update documents event without its "previous" snapshot. JSON payloads are sliced with the
+             * scanner so the skipped document is never parsed; CBOR ones are decoded whole and then trimmed.
+             */
+            bool s_parseCurrentOnly(
+                const Aws::Crt::ByteBuf &payload,
+                Aws::Iotdevicecommon::PayloadFormat payloadFormat,
+                Aws::Crt::String &payloadScratch,
+                Aws::Crt::JsonObject &jsonObject)
+            {
+                Aws::Crt::ByteCursor document = Aws::Crt::ByteCursorFromByteBuf(payload);
+                Aws::Crt::ByteCursor current;
+                if (payloadFormat != Aws::Iotdevicecommon::PayloadFormat::Json ||
+                    !Aws::Iotdevicecommon::JsonPayloadScanner::FindMember(document, "current", current))
+                {
+                    Aws::Crt::JsonObject full;
+                    if (!Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, full))
+                    {
+                        return false;
+                    }
+                    Aws::Crt::JsonView view = full.View();
+                    if (view.ValueExists("current"))
+                    {
+                        jsonObject.WithObject("current", view.GetJsonObjectCopy("current"));
+                    }
+                    if (view.ValueExists("timestamp"))
+                    {
+                        jsonObject.WithDouble("timestamp", view.GetDouble("timestamp"));
+                    }
+                    return true;
+                }
+
+                Aws::Crt::JsonObject currentObject;
+                Aws::Crt::ByteBuf currentPayload = aws_byte_buf_from_array(current.ptr, current.len);
+                if (!Aws::Iotdevicecommon::ParsePayload(currentPayload, payloadFormat, payloadScratch, currentObject))
+                {
+                    return false;
+                }
+                jsonObject.WithObject("current", std::move(currentObject));
+
+                Aws::Crt::ByteCursor timestamp;
+                double seconds = 0;
+                if (Aws::Iotdevicecommon::JsonPayloadScanner::FindMember(document, "timestamp", timestamp) &&
+                    Aws::Iotdevicecommon::JsonPayloadScanner::ReadDouble(timestamp, seconds))
+                {
+                    jsonObject.WithDouble("timestamp", seconds);
+                }
+                return true;
+            }
+
+            void s_mergeJson(Aws::Crt::JsonObject &target, const Aws::Crt::JsonView &patch)
+            {
+                for (const auto &entry : patch.GetAllObjects())
+                {
+                    Aws::Crt::JsonView current = target.View();
+                    if (entry.second.IsObject() && current.ValueExists(entry.first) &&
+                        current.GetJsonObject(entry.first).IsObject())
+                    {
+                        Aws::Crt::JsonObject merged = current.GetJsonObjectCopy(entry.first);
+                        s_mergeJson(merged, entry.second);
+                        target.WithObject(entry.first, std::move(merged));
+                    }
+                    else
+                    {
+                        target.WithObject(entry.first, entry.second.Materialize());
+                    }
+                }
+            }
+
+            /*
+             * Folds a queued shadow update into the one superseding it: the state documents are deep-merged, the
+             * newer client token wins, and the older version is kept, since that is what the device last saw.
+             */
+            bool s_mergeQueuedUpdate(
+                const Aws::Crt::ByteCursor &older,
+                const Aws::Crt::ByteCursor &newer,
+                Aws::Crt::String &merged)
+            {
+                Aws::Crt::JsonObject olderUpdate(
+                    Aws::Crt::String(reinterpret_cast<const char *>(older.ptr), older.len));
+                Aws::Crt::JsonObject newerUpdate(
+                    Aws::Crt::String(reinterpret_cast<const char *>(newer.ptr), newer.len));
+                if (!olderUpdate.WasParseSuccessful() || !newerUpdate.WasParseSuccessful())
+                {
+                    return false;
+                }
+
+                Aws::Crt::JsonView olderView = olderUpdate.View();
+                for (const auto &entry : newerUpdate.View().GetAllObjects())
+                {
+                    if (entry.first == "version" && olderView.ValueExists("version"))
+                    {
+                        continue;
+                    }
+
+                    Aws::Crt::JsonObject patch;
+                    patch.WithObject(entry.first, entry.second.Materialize());
+                    s_mergeJson(olderUpdate, patch.View());
+                }
+
+                merged = olderUpdate.View().WriteCompact();
+                return true;
+            }
+
+            /* Reports the throttling rejections (code 429) among a rejected topic's messages to the breaker. */
+            std::function<void(ErrorResponse *, int)> s_reportThrottling(
+                const std::shared_ptr<Aws::Iotdevicecommon::ThrottleBreaker> &breaker,
+                Aws::Iotdevicecommon::ThrottledOperation operation,
+                std::function<void(ErrorResponse *, int)> &&handler)
+            {
+                if (!breaker)
+                {
+                    return std::move(handler);
+                }
+
+                return [breaker, operation, handler](ErrorResponse *error, int ioErr) {
+                    if (error && error->Code && *error->Code == 429)
+                    {
+                        breaker->RecordThrottled(operation);
+                    }
+                    handler(error, ioErr);
                 };
+            }
+        } // namespace
+
+        IotShadowClient::IotShadowClient(
+            const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+            Aws::Crt::Allocator *allocator)
+            : IotShadowClient(connection, Aws::Iotdevicecommon::ServiceClientConfig(), allocator)
+        {
+        }
+
+        IotShadowClient::IotShadowClient(
+            const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+            const Aws::Iotdevicecommon::ServiceClientConfig &config,
+            Aws::Crt::Allocator *allocator)
+            : m_allocator(allocator), m_stringAllocator(allocator), m_connection(connection),
+              m_payloadBufferPool(config.PayloadBufferPool), m_payloadFormat(config.PayloadFormat),
+              m_handlerContext(), m_metrics(config.Metrics), m_tracer(config.Tracer), m_session(config.Session),
+              m_reuseInboundModels(config.ReuseInboundModels), m_offlineQueue(config.OfflineQueue),
+              m_memoryBudget(config.MemoryBudget), m_publishScheduler(config.PublishScheduler),
+              m_scheduledPublishDeadlineMs(config.ScheduledPublishDeadlineMs),
+              m_completionBatcher(config.CompletionBatcher), m_publishLanes(config.PublishLanes),
+              m_throttleBreaker(config.ThrottleBreaker), m_rateLimiter(config.RateLimiter),
+              m_hotStandby(config.HotStandby), m_qosPolicy(config.QosPolicy), m_versionTracker(),
+              m_metadataMode(ShadowMetadataMode::Full)
+        {
+            if (!m_payloadBufferPool)
+            {
+                m_payloadBufferPool =
+                    Aws::Crt::MakeShared<Aws::Iotdevicecommon::PayloadBufferPool>(m_allocator, 0, 0, m_allocator);
+            }
+
+            auto handlerContext = Aws::Crt::MakeShared<Aws::Iotdevicecommon::HandlerContext>(m_allocator);
+            handlerContext->Executor = config.HandlerExecutor;
+            handlerContext->Pool = m_payloadBufferPool;
+            handlerContext->Metrics = config.Metrics;
+            handlerContext->Tracer = config.Tracer;
+            handlerContext->Watchdog = config.HandlerWatchdog;
+            handlerContext->LoopMonitor = config.EventLoopMonitor;
+            handlerContext->Budget = config.MemoryBudget;
+            handlerContext->Standby = config.HotStandby;
+            m_handlerContext = std::move(handlerContext);
+        }
+
+        IotShadowClient::operator bool() const noexcept { return *m_connection; }
+
+        int IotShadowClient::GetLastError() const noexcept { return aws_last_error(); }
+
+        void IotShadowClient::SetMetadataMode(ShadowMetadataMode mode) noexcept { m_metadataMode = mode; }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "name"
-                               << "/" << *request.ShadowName << "/"
-                               << "delete"
-                               << "/"
-                               << "rejected";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        void IotShadowClient::SetVersionTracker(const std::shared_ptr<ShadowVersionTracker> &tracker) noexcept
+        {
+            m_versionTracker = tracker;
+        }
+
+        bool IotShadowClient::SubscribeToDeleteNamedShadowRejected(
+            const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToDeleteNamedShadowRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToDeleteNamedShadowRejected(
+                request, qos, OnSubscribeToDeleteNamedShadowRejectedResponse(handler), onSubAck);
+        }
+
+        bool IotShadowClient::SubscribeToDeleteNamedShadowRejected(
+            const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDeleteNamedShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequestResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "name"
+                           << "/" << *request.ShadowName << "/"
+                           << "delete"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotshadow::ErrorResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                s_reportThrottling(
+                    m_throttleBreaker, Aws::Iotdevicecommon::ThrottledOperation::ShadowDelete, std::move(handler)),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotShadowClient::SubscribeToGetNamedShadowAccepted(
@@ -101,52 +393,66 @@ namespace Aws
             const OnSubscribeToGetNamedShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
+            return SubscribeToGetNamedShadowAccepted(
+                request, qos, OnSubscribeToGetNamedShadowAcceptedResponse(handler), onSubAck);
+        }
 
+        bool IotShadowClient::SubscribeToGetNamedShadowAccepted(
+            const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetNamedShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequestResponses, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToGetNamedShadowAcceptedResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            std::shared_ptr<Aws::Iotdevicecommon::JsonProjection> projection =
+                s_makeProjection(request.Projection, m_allocator);
+            VersionGate versionGate(
+                m_versionTracker, ShadowVersionTracker::EventStream::Delta, request.ThingName, request.ShadowName);
+            Aws::Iotshadow::ShadowMetadataMode metadataMode = m_metadataMode;
             auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::GetShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
+                [sharedHandler, payloadScratch, payloadFormat, versionGate, projection, metadataMode](
+                    Aws::Crt::Mqtt::MqttConnection &,
+                    const Aws::Crt::String &,
+                    const Aws::Crt::ByteBuf &payload) mutable {
+                    Aws::Crt::JsonObject jsonObject;
+                    Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                    if (projection)
+                    {
+                        Aws::Crt::JsonObject projected;
+                        projection->Apply(jsonObject.View(), projected);
+                        jsonObject = std::move(projected);
+                    }
+                    Aws::Iotshadow::GetShadowResponse response(jsonObject, metadataMode);
+                    versionGate.RecordDocumentVersion(response.Version);
+                    (*sharedHandler)(&response, AWS_ERROR_SUCCESS);
                 };
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "name"
-                               << "/" << *request.ShadowName << "/"
-                               << "get"
-                               << "/"
-                               << "accepted";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "name"
+                           << "/" << *request.ShadowName << "/"
+                           << "get"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotShadowClient::SubscribeToShadowDeltaUpdatedEvents(
@@ -155,50 +461,80 @@ namespace Aws
             const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
+            return SubscribeToShadowDeltaUpdatedEvents(
+                request, qos, OnSubscribeToShadowDeltaUpdatedEventsResponse(handler), onSubAck);
+        }
 
+        bool IotShadowClient::SubscribeToShadowDeltaUpdatedEvents(
+            const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToShadowDeltaUpdatedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowEvents, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToShadowDeltaUpdatedEventsResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            std::shared_ptr<Aws::Iotdevicecommon::JsonProjection> projection =
+                s_makeProjection(request.Projection, m_allocator);
+            VersionGate versionGate(
+                m_versionTracker, ShadowVersionTracker::EventStream::Delta, request.ThingName);
+            Aws::Crt::Optional<Aws::Iotshadow::ShadowDeltaUpdatedEvent> reusableResponse;
+            if (m_reuseInboundModels)
+            {
+                reusableResponse.emplace();
+            }
             auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ShadowDeltaUpdatedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
+                [sharedHandler, payloadScratch, payloadFormat, versionGate, projection, reusableResponse](
+                    Aws::Crt::Mqtt::MqttConnection &,
+                    const Aws::Crt::String &,
+                    const Aws::Crt::ByteBuf &payload) mutable {
+                    bool versionChecked = false;
+                    if (versionGate.IsStalePayload(payload, payloadFormat, versionChecked))
+                    {
+                        return;
+                    }
+
+                    Aws::Crt::JsonObject jsonObject;
+                    Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                    if (projection)
+                    {
+                        Aws::Crt::JsonObject projected;
+                        projection->Apply(jsonObject.View(), projected);
+                        jsonObject = std::move(projected);
+                    }
+                    Aws::Iotshadow::ShadowDeltaUpdatedEvent freshResponse;
+                    Aws::Iotshadow::ShadowDeltaUpdatedEvent &response =
+                        reusableResponse ? *reusableResponse : freshResponse;
+                    response.Reload(jsonObject);
+                    if (!versionChecked && versionGate.IsStale(response.Version))
+                    {
+                        return;
+                    }
+                    (*sharedHandler)(&response, AWS_ERROR_SUCCESS);
                 };
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "update"
-                               << "/"
-                               << "delta";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "update"
+                           << "/"
+                           << "delta";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotShadowClient::SubscribeToDeleteShadowAccepted(
@@ -207,50 +543,38 @@ namespace Aws
             const OnSubscribeToDeleteShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::DeleteShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            return SubscribeToDeleteShadowAccepted(
+                request, qos, OnSubscribeToDeleteShadowAcceptedResponse(handler), onSubAck);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "delete"
-                               << "/"
-                               << "accepted";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotShadowClient::SubscribeToDeleteShadowAccepted(
+            const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDeleteShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequestResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "delete"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotshadow::DeleteShadowResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotShadowClient::SubscribeToUpdateNamedShadowAccepted(
@@ -259,52 +583,54 @@ namespace Aws
             const OnSubscribeToUpdateNamedShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
+            return SubscribeToUpdateNamedShadowAccepted(
+                request, qos, OnSubscribeToUpdateNamedShadowAcceptedResponse(handler), onSubAck);
+        }
 
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
+        bool IotShadowClient::SubscribeToUpdateNamedShadowAccepted(
+            const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateNamedShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowUpdateResponses, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToUpdateNamedShadowAcceptedResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            Aws::Iotshadow::ShadowMetadataMode metadataMode = m_metadataMode;
+            auto onSubscribePublish = [sharedHandler, payloadScratch, payloadFormat, metadataMode](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) mutable {
+                Aws::Crt::JsonObject jsonObject;
+                Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                Aws::Iotshadow::UpdateShadowResponse response(jsonObject, metadataMode);
+                (*sharedHandler)(&response, AWS_ERROR_SUCCESS);
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::UpdateShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "name"
-                               << "/" << *request.ShadowName << "/"
-                               << "update"
-                               << "/"
-                               << "accepted";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "name"
+                           << "/" << *request.ShadowName << "/"
+                           << "update"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotShadowClient::SubscribeToDeleteNamedShadowAccepted(
@@ -313,52 +639,40 @@ namespace Aws
             const OnSubscribeToDeleteNamedShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::DeleteShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            return SubscribeToDeleteNamedShadowAccepted(
+                request, qos, OnSubscribeToDeleteNamedShadowAcceptedResponse(handler), onSubAck);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "name"
-                               << "/" << *request.ShadowName << "/"
-                               << "delete"
-                               << "/"
-                               << "accepted";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotShadowClient::SubscribeToDeleteNamedShadowAccepted(
+            const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDeleteNamedShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequestResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "name"
+                           << "/" << *request.ShadowName << "/"
+                           << "delete"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotshadow::DeleteShadowResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotShadowClient::SubscribeToUpdateShadowAccepted(
@@ -367,50 +681,52 @@ namespace Aws
             const OnSubscribeToUpdateShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
+            return SubscribeToUpdateShadowAccepted(
+                request, qos, OnSubscribeToUpdateShadowAcceptedResponse(handler), onSubAck);
+        }
 
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
+        bool IotShadowClient::SubscribeToUpdateShadowAccepted(
+            const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowUpdateResponses, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToUpdateShadowAcceptedResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            Aws::Iotshadow::ShadowMetadataMode metadataMode = m_metadataMode;
+            auto onSubscribePublish = [sharedHandler, payloadScratch, payloadFormat, metadataMode](
+                                          Aws::Crt::Mqtt::MqttConnection &,
+                                          const Aws::Crt::String &,
+                                          const Aws::Crt::ByteBuf &payload) mutable {
+                Aws::Crt::JsonObject jsonObject;
+                Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                Aws::Iotshadow::UpdateShadowResponse response(jsonObject, metadataMode);
+                (*sharedHandler)(&response, AWS_ERROR_SUCCESS);
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::UpdateShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
-
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "update"
-                               << "/"
-                               << "accepted";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "update"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotShadowClient::SubscribeToUpdateShadowRejected(
@@ -419,50 +735,39 @@ namespace Aws
             const OnSubscribeToUpdateShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            return SubscribeToUpdateShadowRejected(
+                request, qos, OnSubscribeToUpdateShadowRejectedResponse(handler), onSubAck);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "update"
-                               << "/"
-                               << "rejected";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotShadowClient::SubscribeToUpdateShadowRejected(
+            const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowUpdateResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "update"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotshadow::ErrorResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                s_reportThrottling(
+                    m_throttleBreaker, Aws::Iotdevicecommon::ThrottledOperation::ShadowUpdate, std::move(handler)),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotShadowClient::SubscribeToDeleteShadowRejected(
@@ -471,50 +776,39 @@ namespace Aws
             const OnSubscribeToDeleteShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            return SubscribeToDeleteShadowRejected(
+                request, qos, OnSubscribeToDeleteShadowRejectedResponse(handler), onSubAck);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "delete"
-                               << "/"
-                               << "rejected";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotShadowClient::SubscribeToDeleteShadowRejected(
+            const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDeleteShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequestResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "delete"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotshadow::ErrorResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                s_reportThrottling(
+                    m_throttleBreaker, Aws::Iotdevicecommon::ThrottledOperation::ShadowDelete, std::move(handler)),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotShadowClient::SubscribeToUpdateNamedShadowRejected(
@@ -523,52 +817,41 @@ namespace Aws
             const OnSubscribeToUpdateNamedShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            return SubscribeToUpdateNamedShadowRejected(
+                request, qos, OnSubscribeToUpdateNamedShadowRejectedResponse(handler), onSubAck);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "name"
-                               << "/" << *request.ShadowName << "/"
-                               << "update"
-                               << "/"
-                               << "rejected";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotShadowClient::SubscribeToUpdateNamedShadowRejected(
+            const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateNamedShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowUpdateResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "name"
+                           << "/" << *request.ShadowName << "/"
+                           << "update"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotshadow::ErrorResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                s_reportThrottling(
+                    m_throttleBreaker, Aws::Iotdevicecommon::ThrottledOperation::ShadowUpdate, std::move(handler)),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotShadowClient::SubscribeToNamedShadowUpdatedEvents(
@@ -577,52 +860,84 @@ namespace Aws
             const OnSubscribeToNamedShadowUpdatedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
+            return SubscribeToNamedShadowUpdatedEvents(
+                request, qos, OnSubscribeToNamedShadowUpdatedEventsResponse(handler), onSubAck);
+        }
 
+        bool IotShadowClient::SubscribeToNamedShadowUpdatedEvents(
+            const Aws::Iotshadow::NamedShadowUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToNamedShadowUpdatedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowEvents, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToNamedShadowUpdatedEventsResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            std::shared_ptr<Aws::Iotdevicecommon::JsonProjection> projection =
+                s_makeProjection(request.Projection, m_allocator);
+            VersionGate versionGate(
+                m_versionTracker, ShadowVersionTracker::EventStream::Updated, request.ThingName, request.ShadowName);
+            Aws::Iotshadow::ShadowMetadataMode metadataMode =
+                request.MetadataMode.has_value() ? *request.MetadataMode : m_metadataMode;
+            bool currentOnly = request.CurrentOnly.has_value() && *request.CurrentOnly;
             auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ShadowUpdatedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
+                [sharedHandler, payloadScratch, payloadFormat, versionGate, projection, metadataMode, currentOnly](
+                    Aws::Crt::Mqtt::MqttConnection &,
+                    const Aws::Crt::String &,
+                    const Aws::Crt::ByteBuf &payload) mutable {
+                    bool versionChecked = false;
+                    if (versionGate.IsStalePayload(payload, payloadFormat, versionChecked))
+                    {
+                        return;
+                    }
+
+                    Aws::Crt::JsonObject jsonObject;
+                    if (currentOnly)
+                    {
+                        s_parseCurrentOnly(payload, payloadFormat, payloadScratch, jsonObject);
+                    }
+                    else
+                    {
+                        Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                    }
+                    if (projection)
+                    {
+                        Aws::Crt::JsonObject projected;
+                        projection->Apply(jsonObject.View(), projected);
+                        jsonObject = std::move(projected);
+                    }
+                    Aws::Iotshadow::ShadowUpdatedEvent response(jsonObject, metadataMode);
+                    if (!versionChecked && response.Current && versionGate.IsStale(response.Current->Version))
+                    {
+                        return;
+                    }
+                    (*sharedHandler)(&response, AWS_ERROR_SUCCESS);
                 };
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "name"
-                               << "/" << *request.ShadowName << "/"
-                               << "update"
-                               << "/"
-                               << "documents";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "name"
+                           << "/" << *request.ShadowName << "/"
+                           << "update"
+                           << "/"
+                           << "documents";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotShadowClient::SubscribeToGetShadowAccepted(
@@ -631,50 +946,64 @@ namespace Aws
             const OnSubscribeToGetShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
+            return SubscribeToGetShadowAccepted(
+                request, qos, OnSubscribeToGetShadowAcceptedResponse(handler), onSubAck);
+        }
 
+        bool IotShadowClient::SubscribeToGetShadowAccepted(
+            const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequestResponses, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToGetShadowAcceptedResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            std::shared_ptr<Aws::Iotdevicecommon::JsonProjection> projection =
+                s_makeProjection(request.Projection, m_allocator);
+            VersionGate versionGate(
+                m_versionTracker, ShadowVersionTracker::EventStream::Delta, request.ThingName);
+            Aws::Iotshadow::ShadowMetadataMode metadataMode = m_metadataMode;
             auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::GetShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
+                [sharedHandler, payloadScratch, payloadFormat, versionGate, projection, metadataMode](
+                    Aws::Crt::Mqtt::MqttConnection &,
+                    const Aws::Crt::String &,
+                    const Aws::Crt::ByteBuf &payload) mutable {
+                    Aws::Crt::JsonObject jsonObject;
+                    Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                    if (projection)
+                    {
+                        Aws::Crt::JsonObject projected;
+                        projection->Apply(jsonObject.View(), projected);
+                        jsonObject = std::move(projected);
+                    }
+                    Aws::Iotshadow::GetShadowResponse response(jsonObject, metadataMode);
+                    versionGate.RecordDocumentVersion(response.Version);
+                    (*sharedHandler)(&response, AWS_ERROR_SUCCESS);
                 };
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "get"
-                               << "/"
-                               << "accepted";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "get"
+                           << "/"
+                           << "accepted";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotShadowClient::SubscribeToShadowUpdatedEvents(
@@ -683,50 +1012,82 @@ namespace Aws
             const OnSubscribeToShadowUpdatedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
+            return SubscribeToShadowUpdatedEvents(
+                request, qos, OnSubscribeToShadowUpdatedEventsResponse(handler), onSubAck);
+        }
 
+        bool IotShadowClient::SubscribeToShadowUpdatedEvents(
+            const Aws::Iotshadow::ShadowUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToShadowUpdatedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowEvents, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToShadowUpdatedEventsResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            std::shared_ptr<Aws::Iotdevicecommon::JsonProjection> projection =
+                s_makeProjection(request.Projection, m_allocator);
+            VersionGate versionGate(
+                m_versionTracker, ShadowVersionTracker::EventStream::Updated, request.ThingName);
+            Aws::Iotshadow::ShadowMetadataMode metadataMode =
+                request.MetadataMode.has_value() ? *request.MetadataMode : m_metadataMode;
+            bool currentOnly = request.CurrentOnly.has_value() && *request.CurrentOnly;
             auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ShadowUpdatedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
+                [sharedHandler, payloadScratch, payloadFormat, versionGate, projection, metadataMode, currentOnly](
+                    Aws::Crt::Mqtt::MqttConnection &,
+                    const Aws::Crt::String &,
+                    const Aws::Crt::ByteBuf &payload) mutable {
+                    bool versionChecked = false;
+                    if (versionGate.IsStalePayload(payload, payloadFormat, versionChecked))
+                    {
+                        return;
+                    }
+
+                    Aws::Crt::JsonObject jsonObject;
+                    if (currentOnly)
+                    {
+                        s_parseCurrentOnly(payload, payloadFormat, payloadScratch, jsonObject);
+                    }
+                    else
+                    {
+                        Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                    }
+                    if (projection)
+                    {
+                        Aws::Crt::JsonObject projected;
+                        projection->Apply(jsonObject.View(), projected);
+                        jsonObject = std::move(projected);
+                    }
+                    Aws::Iotshadow::ShadowUpdatedEvent response(jsonObject, metadataMode);
+                    if (!versionChecked && response.Current && versionGate.IsStale(response.Current->Version))
+                    {
+                        return;
+                    }
+                    (*sharedHandler)(&response, AWS_ERROR_SUCCESS);
                 };
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "update"
-                               << "/"
-                               << "documents";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "update"
+                           << "/"
+                           << "documents";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotShadowClient::SubscribeToNamedShadowDeltaUpdatedEvents(
@@ -735,52 +1096,82 @@ namespace Aws
             const OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
+            return SubscribeToNamedShadowDeltaUpdatedEvents(
+                request, qos, OnSubscribeToNamedShadowDeltaUpdatedEventsResponse(handler), onSubAck);
+        }
 
+        bool IotShadowClient::SubscribeToNamedShadowDeltaUpdatedEvents(
+            const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowEvents, qos);
+            auto sharedHandler = Aws::Crt::MakeShared<OnSubscribeToNamedShadowDeltaUpdatedEventsResponse>(
+                m_allocator, std::move(handler));
+            Aws::Crt::String payloadScratch(m_stringAllocator);
+            Aws::Iotdevicecommon::PayloadFormat payloadFormat = m_payloadFormat;
+            std::shared_ptr<Aws::Iotdevicecommon::JsonProjection> projection =
+                s_makeProjection(request.Projection, m_allocator);
+            VersionGate versionGate(
+                m_versionTracker, ShadowVersionTracker::EventStream::Delta, request.ThingName, request.ShadowName);
+            Aws::Crt::Optional<Aws::Iotshadow::ShadowDeltaUpdatedEvent> reusableResponse;
+            if (m_reuseInboundModels)
+            {
+                reusableResponse.emplace();
+            }
             auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ShadowDeltaUpdatedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
+                [sharedHandler, payloadScratch, payloadFormat, versionGate, projection, reusableResponse](
+                    Aws::Crt::Mqtt::MqttConnection &,
+                    const Aws::Crt::String &,
+                    const Aws::Crt::ByteBuf &payload) mutable {
+                    bool versionChecked = false;
+                    if (versionGate.IsStalePayload(payload, payloadFormat, versionChecked))
+                    {
+                        return;
+                    }
+
+                    Aws::Crt::JsonObject jsonObject;
+                    Aws::Iotdevicecommon::ParsePayload(payload, payloadFormat, payloadScratch, jsonObject);
+                    if (projection)
+                    {
+                        Aws::Crt::JsonObject projected;
+                        projection->Apply(jsonObject.View(), projected);
+                        jsonObject = std::move(projected);
+                    }
+                    Aws::Iotshadow::ShadowDeltaUpdatedEvent freshResponse;
+                    Aws::Iotshadow::ShadowDeltaUpdatedEvent &response =
+                        reusableResponse ? *reusableResponse : freshResponse;
+                    response.Reload(jsonObject);
+                    if (!versionChecked && versionGate.IsStale(response.Version))
+                    {
+                        return;
+                    }
+                    (*sharedHandler)(&response, AWS_ERROR_SUCCESS);
                 };
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "name"
-                               << "/" << *request.ShadowName << "/"
-                               << "update"
-                               << "/"
-                               << "delta";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "name"
+                           << "/" << *request.ShadowName << "/"
+                           << "update"
+                           << "/"
+                           << "delta";
+
+            return Aws::Iotdevicecommon::SubscribeToTopic(
+                m_connection,
+                subscribeTopic,
+                qos,
+                Aws::Iotdevicecommon::OffloadPublishHandler(std::move(onSubscribePublish), m_handlerContext),
+                [sharedHandler](int errorCode) { (*sharedHandler)(nullptr, errorCode); },
+                onSubAck,
+                m_session,
+                m_hotStandby);
         }
 
         bool IotShadowClient::SubscribeToGetNamedShadowRejected(
@@ -789,52 +1180,41 @@ namespace Aws
             const OnSubscribeToGetNamedShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
-
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
-
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            return SubscribeToGetNamedShadowRejected(
+                request, qos, OnSubscribeToGetNamedShadowRejectedResponse(handler), onSubAck);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "name"
-                               << "/" << *request.ShadowName << "/"
-                               << "get"
-                               << "/"
-                               << "rejected";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotShadowClient::SubscribeToGetNamedShadowRejected(
+            const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetNamedShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequestResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "name"
+                           << "/" << *request.ShadowName << "/"
+                           << "get"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotshadow::ErrorResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                s_reportThrottling(
+                    m_throttleBreaker, Aws::Iotdevicecommon::ThrottledOperation::ShadowGet, std::move(handler)),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
         }
 
         bool IotShadowClient::SubscribeToGetShadowRejected(
@@ -843,50 +1223,76 @@ namespace Aws
             const OnSubscribeToGetShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
-            (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
-                if (errorCode)
-                {
-                    handler(nullptr, errorCode);
-                }
+            return SubscribeToGetShadowRejected(
+                request, qos, OnSubscribeToGetShadowRejectedResponse(handler), onSubAck);
+        }
 
-                if (onSubAck)
-                {
-                    onSubAck(errorCode);
-                }
-            };
+        bool IotShadowClient::SubscribeToGetShadowRejected(
+            const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequestResponses, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << *request.ThingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "get"
+                           << "/"
+                           << "rejected";
+
+            return Aws::Iotdevicecommon::SubscribeToModel<Aws::Iotshadow::ErrorResponse>(
+                m_connection,
+                subscribeTopic,
+                qos,
+                s_reportThrottling(
+                    m_throttleBreaker, Aws::Iotdevicecommon::ThrottledOperation::ShadowGet, std::move(handler)),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_payloadFormat,
+                m_allocator);
+        }
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+        bool IotShadowClient::SubscribeToShadowTopicsRaw(
+            const Aws::Crt::String &thingName,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnRawMessageReceived &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            return SubscribeToShadowTopicsRaw(
+                thingName, qos, Aws::Iotdevicecommon::OnRawMessageReceived(handler), onSubAck);
+        }
 
-            Aws::Crt::StringStream subscribeTopicSStr;
-            subscribeTopicSStr << "$aws"
-                               << "/"
-                               << "things"
-                               << "/" << *request.ThingName << "/"
-                               << "shadow"
-                               << "/"
-                               << "get"
-                               << "/"
-                               << "rejected";
-
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+        bool IotShadowClient::SubscribeToShadowTopicsRaw(
+            const Aws::Crt::String &thingName,
+            Aws::Crt::Mqtt::QOS qos,
+            Aws::Iotdevicecommon::OnRawMessageReceived &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowEvents, qos);
+            Aws::Iotdevicecommon::TopicBuilder subscribeTopic;
+            subscribeTopic << "$aws"
+                           << "/"
+                           << "things"
+                           << "/" << thingName << "/"
+                           << "shadow"
+                           << "/"
+                           << "#";
+
+            return Aws::Iotdevicecommon::SubscribeToRawMessages(
+                m_connection,
+                subscribeTopic,
+                qos,
+                std::move(handler),
+                onSubAck,
+                m_handlerContext,
+                m_session,
+                m_allocator);
         }
 
         bool IotShadowClient::PublishGetShadow(
@@ -894,28 +1300,64 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "things"
-                             << "/" << *request.ThingName << "/"
-                             << "shadow"
-                             << "/"
-                             << "get";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << *request.ThingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "get";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(Aws::Iotdevicecommon::ThrottledOperation::ShadowGet))
+            {
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Shadow,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
         bool IotShadowClient::PublishDeleteShadow(
@@ -923,28 +1365,64 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "things"
-                             << "/" << *request.ThingName << "/"
-                             << "shadow"
-                             << "/"
-                             << "delete";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << *request.ThingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "delete";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(Aws::Iotdevicecommon::ThrottledOperation::ShadowDelete))
+            {
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Shadow,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
         bool IotShadowClient::PublishUpdateShadow(
@@ -952,28 +1430,30 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "things"
-                             << "/" << *request.ThingName << "/"
-                             << "shadow"
-                             << "/"
-                             << "update";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << *request.ThingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "update";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            return PublishUpdatePayload(publishTopic.c_str(), qos, trace, buf, onPubAck);
         }
 
         bool IotShadowClient::PublishDeleteNamedShadow(
@@ -981,30 +1461,66 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "things"
-                             << "/" << *request.ThingName << "/"
-                             << "shadow"
-                             << "/"
-                             << "name"
-                             << "/" << *request.ShadowName << "/"
-                             << "delete";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << *request.ThingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "name"
+                         << "/" << *request.ShadowName << "/"
+                         << "delete";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(Aws::Iotdevicecommon::ThrottledOperation::ShadowDelete))
+            {
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Shadow,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
         bool IotShadowClient::PublishGetNamedShadow(
@@ -1012,30 +1528,66 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "things"
-                             << "/" << *request.ThingName << "/"
-                             << "shadow"
-                             << "/"
-                             << "name"
-                             << "/" << *request.ShadowName << "/"
-                             << "get";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
-
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << *request.ThingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "name"
+                         << "/" << *request.ShadowName << "/"
+                         << "get";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(Aws::Iotdevicecommon::ThrottledOperation::ShadowGet))
+            {
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Shadow,
+                    trace,
+                    publishTopic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                publishTopic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
         }
 
         bool IotShadowClient::PublishUpdateNamedShadow(
@@ -1043,30 +1595,517 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
-            Aws::Crt::StringStream publishTopicSStr;
-            publishTopicSStr << "$aws"
-                             << "/"
-                             << "things"
-                             << "/" << *request.ThingName << "/"
-                             << "shadow"
-                             << "/"
-                             << "name"
-                             << "/" << *request.ShadowName << "/"
-                             << "update";
-
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << *request.ThingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "name"
+                         << "/" << *request.ShadowName << "/"
+                         << "update";
+
+            if (!publishTopic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, publishTopic.c_str(), request);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            return PublishUpdatePayload(publishTopic.c_str(), qos, trace, buf, onPubAck);
+        }
+
+        PreparedShadowUpdate IotShadowClient::PrepareUpdateShadow(
+            const Aws::Crt::String &thingName,
+            Aws::Crt::Mqtt::QOS qos) const
+        {
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "update";
+
+            return PreparedShadowUpdate(
+                *this, publishTopic ? Aws::Crt::String(publishTopic.c_str()) : Aws::Crt::String(), qos);
+        }
+
+        PreparedShadowUpdate IotShadowClient::PrepareUpdateNamedShadow(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::String &shadowName,
+            Aws::Crt::Mqtt::QOS qos) const
+        {
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "name"
+                         << "/" << shadowName << "/"
+                         << "update";
+
+            return PreparedShadowUpdate(
+                *this, publishTopic ? Aws::Crt::String(publishTopic.c_str()) : Aws::Crt::String(), qos);
+        }
+
+        bool IotShadowClient::PublishUpdatePayload(
+            const char *topic,
+            Aws::Crt::Mqtt::QOS qos,
+            Aws::Iotdevicecommon::RequestTrace &trace,
+            Aws::Crt::ByteBuf &buf,
+            const OnPublishComplete &onPubAck) const
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowUpdate, qos);
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(Aws::Iotdevicecommon::ThrottledOperation::ShadowUpdate))
+            {
+                trace.EndPublish(aws_last_error());
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            if (m_offlineQueue)
+            {
+                /* Superseded updates to the same shadow are folded together; CBOR payloads are only replaced. */
+                bool queued = m_offlineQueue->Enqueue(
+                    topic,
+                    qos,
+                    buf,
+                    Aws::Iotdevicecommon::DurablePublishQueue::OnDelivered(onPubAck),
+                    topic,
+                    m_payloadFormat == Aws::Iotdevicecommon::PayloadFormat::Json
+                        ? Aws::Iotdevicecommon::DurablePublishQueue::MergePayloads(s_mergeQueuedUpdate)
+                        : Aws::Iotdevicecommon::DurablePublishQueue::MergePayloads());
+                trace.EndPublish(queued ? AWS_ERROR_SUCCESS : aws_last_error());
+                m_payloadBufferPool->Release(buf);
+                return queued;
+            }
+
+            if (m_publishScheduler)
+            {
+                bool scheduled = m_publishScheduler->Schedule(
+                    m_connection,
+                    topic,
+                    qos,
+                    buf,
+                    Aws::Iotdevicecommon::PublishScheduler::OnPublished(onPubAck),
+                    m_scheduledPublishDeadlineMs);
+                trace.EndPublish(scheduled ? AWS_ERROR_SUCCESS : aws_last_error());
+                m_payloadBufferPool->Release(buf);
+                return scheduled;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Shadow,
+                    trace,
+                    topic,
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                topic,
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes,
+                Aws::Iotdevicecommon::PublishPriority::Telemetry);
+        }
+
+        bool IotShadowClient::PublishGetShadowRaw(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "get";
+
+            return PublishRaw(
+                publishTopic,
+                payload,
+                qos,
+                false,
+                Aws::Iotdevicecommon::ThrottledOperation::ShadowGet,
+                onRelease,
+                onPubAck);
+        }
+
+        bool IotShadowClient::PublishDeleteShadowRaw(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "delete";
+
+            return PublishRaw(
+                publishTopic,
+                payload,
+                qos,
+                false,
+                Aws::Iotdevicecommon::ThrottledOperation::ShadowDelete,
+                onRelease,
+                onPubAck);
+        }
+
+        bool IotShadowClient::PublishUpdateShadowRaw(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowUpdate, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "update";
+
+            return PublishRaw(
+                publishTopic,
+                payload,
+                qos,
+                true,
+                Aws::Iotdevicecommon::ThrottledOperation::ShadowUpdate,
+                onRelease,
+                onPubAck);
+        }
+
+        bool IotShadowClient::PublishDeleteNamedShadowRaw(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::String &shadowName,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "name"
+                         << "/" << shadowName << "/"
+                         << "delete";
+
+            return PublishRaw(
+                publishTopic,
+                payload,
+                qos,
+                false,
+                Aws::Iotdevicecommon::ThrottledOperation::ShadowDelete,
+                onRelease,
+                onPubAck);
+        }
+
+        bool IotShadowClient::PublishGetNamedShadowRaw(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::String &shadowName,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequest, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "name"
+                         << "/" << shadowName << "/"
+                         << "get";
+
+            return PublishRaw(
+                publishTopic,
+                payload,
+                qos,
+                false,
+                Aws::Iotdevicecommon::ThrottledOperation::ShadowGet,
+                onRelease,
+                onPubAck);
+        }
+
+        bool IotShadowClient::PublishUpdateNamedShadowRaw(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::String &shadowName,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowUpdate, qos);
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws"
+                         << "/"
+                         << "things"
+                         << "/" << thingName << "/"
+                         << "shadow"
+                         << "/"
+                         << "name"
+                         << "/" << shadowName << "/"
+                         << "update";
+
+            return PublishRaw(
+                publishTopic,
+                payload,
+                qos,
+                true,
+                Aws::Iotdevicecommon::ThrottledOperation::ShadowUpdate,
+                onRelease,
+                onPubAck);
+        }
+
+        template <typename View>
+        bool IotShadowClient::PublishView(
+            const View &request,
+            const Aws::Iotdevicecommon::TopicBuilder &topic,
+            Aws::Iotdevicecommon::ThrottledOperation operation,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            qos = m_qosPolicy.Resolve(Aws::Iotdevicecommon::QosOperation::ShadowRequest, qos);
+            if (!topic)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(operation))
+            {
+                return false;
+            }
+
+            /* The token is only copied for a tracer to match the response by. */
+            Aws::Crt::Optional<Aws::Crt::String> clientToken;
+            if (m_tracer && request.ClientToken.len > 0)
+            {
+                clientToken = Aws::Crt::String(
+                    reinterpret_cast<const char *>(request.ClientToken.ptr), request.ClientToken.len);
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, topic.c_str(), &clientToken);
+            Aws::Crt::ByteBuf buf = m_payloadBufferPool->Acquire();
+            if (!trace.EndSerialize(Aws::Iotdevicecommon::SerializePayload(request, m_payloadFormat, buf)))
+            {
+                m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Shadow,
+                    trace,
+                    topic.c_str(),
+                    qos,
+                    m_payloadBufferPool,
+                    buf,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishPooledPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                topic.c_str(),
+                qos,
+                m_payloadBufferPool,
+                buf,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes);
+        }
+
+        bool IotShadowClient::PublishGetShadow(
+            const Aws::Iotshadow::ShadowRequestView &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws/things/" << request.ThingName << "/shadow/get";
+            return PublishView(
+                request, publishTopic, Aws::Iotdevicecommon::ThrottledOperation::ShadowGet, qos, onPubAck);
+        }
+
+        bool IotShadowClient::PublishDeleteShadow(
+            const Aws::Iotshadow::ShadowRequestView &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws/things/" << request.ThingName << "/shadow/delete";
+            return PublishView(
+                request, publishTopic, Aws::Iotdevicecommon::ThrottledOperation::ShadowDelete, qos, onPubAck);
+        }
+
+        bool IotShadowClient::PublishGetNamedShadow(
+            const Aws::Iotshadow::NamedShadowRequestView &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws/things/" << request.ThingName << "/shadow/name/" << request.ShadowName << "/get";
+            return PublishView(
+                request, publishTopic, Aws::Iotdevicecommon::ThrottledOperation::ShadowGet, qos, onPubAck);
+        }
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+        bool IotShadowClient::PublishDeleteNamedShadow(
+            const Aws::Iotshadow::NamedShadowRequestView &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            Aws::Iotdevicecommon::TopicBuilder publishTopic;
+            publishTopic << "$aws/things/" << request.ThingName << "/shadow/name/" << request.ShadowName << "/delete";
+            return PublishView(
+                request, publishTopic, Aws::Iotdevicecommon::ThrottledOperation::ShadowDelete, qos, onPubAck);
+        }
+
+        bool IotShadowClient::PublishRaw(
+            const Aws::Iotdevicecommon::TopicBuilder &topic,
+            const Aws::Crt::ByteCursor &payload,
+            Aws::Crt::Mqtt::QOS qos,
+            bool deferrable,
+            Aws::Iotdevicecommon::ThrottledOperation operation,
+            const Aws::Iotdevicecommon::OnPayloadReleased &onRelease,
+            const OnPublishComplete &onPubAck)
+        {
+            if (!topic)
+            {
+                if (onRelease)
+                {
+                    onRelease();
+                }
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_throttleBreaker && !m_throttleBreaker->Allow(operation))
+            {
+                if (onRelease)
+                {
+                    onRelease();
+                }
+                return false;
+            }
+
+            Aws::Iotdevicecommon::RequestTrace trace(m_tracer, topic.c_str(), nullptr);
+            trace.EndSerialize(true);
+            if (deferrable && (m_offlineQueue || m_publishScheduler))
+            {
+                /* Both keep a copy of what they hold back, so the caller's payload is released right away. */
+                Aws::Crt::ByteBuf view = aws_byte_buf_from_array(payload.ptr, payload.len);
+                bool accepted = m_offlineQueue
+                                    ? m_offlineQueue->Enqueue(
+                                          topic.c_str(),
+                                          qos,
+                                          view,
+                                          Aws::Iotdevicecommon::DurablePublishQueue::OnDelivered(onPubAck))
+                                    : m_publishScheduler->Schedule(
+                                          m_connection,
+                                          topic.c_str(),
+                                          qos,
+                                          view,
+                                          Aws::Iotdevicecommon::PublishScheduler::OnPublished(onPubAck),
+                                          m_scheduledPublishDeadlineMs);
+                trace.EndPublish(accepted ? AWS_ERROR_SUCCESS : aws_last_error());
+                if (onRelease)
+                {
+                    onRelease();
+                }
+                return accepted;
+            }
+
+            auto connection = Aws::Iotdevicecommon::ActiveConnection(m_hotStandby, m_connection);
+            bool delayed = false;
+            if (Aws::Iotdevicecommon::QueueIfRateLimited(
+                    m_rateLimiter,
+                    connection,
+                    Aws::Iotdevicecommon::RateLimitedApi::Shadow,
+                    trace,
+                    topic.c_str(),
+                    qos,
+                    payload,
+                    onRelease,
+                    onPubAck,
+                    delayed))
+            {
+                return delayed;
+            }
+
+            return Aws::Iotdevicecommon::PublishCallerPayload(
+                *connection,
+                m_metrics,
+                m_memoryBudget,
+                trace,
+                topic.c_str(),
+                qos,
+                payload,
+                onRelease,
+                onPubAck,
+                m_completionBatcher,
+                m_publishLanes,
+                deferrable ? Aws::Iotdevicecommon::PublishPriority::Telemetry
+                           : Aws::Iotdevicecommon::PublishPriority::Control);
         }
 
     } // namespace Iotshadow
@@ -0,0 +1,344 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/NamedShadowManager.h>
+
+#include <aws/iotshadow/DeleteNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/GetNamedShadowRequest.h>
+#include <aws/iotshadow/GetNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/NamedShadowUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowSubscriptionRequest.h>
+
+#include <aws/iotdevicecommon/SubscriptionHandle.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            const char *const s_topicSuffixes[] = {
+                "get/accepted",
+                "get/rejected",
+                "update/accepted",
+                "update/rejected",
+                "delete/accepted",
+                "delete/rejected",
+                "update/delta",
+                "update/documents",
+            };
+
+            struct SubscribeContext
+            {
+                SubscribeContext(const OnSubscribeComplete &onSubAck, int remaining)
+                    : OnSubAck(onSubAck), Remaining(remaining), FirstError(AWS_ERROR_SUCCESS)
+                {
+                }
+
+                std::mutex Lock;
+                OnSubscribeComplete OnSubAck;
+                int Remaining;
+                int FirstError;
+            };
+
+            template <typename Request> Request s_request(const Crt::String &thingName, const Crt::String &shadowName)
+            {
+                Request request;
+                request.ThingName = thingName;
+                request.ShadowName = shadowName;
+                return request;
+            }
+        } // namespace
+
+        NamedShadowManager::NamedShadowManager(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const std::shared_ptr<ShadowTopicDemultiplexer> &demux,
+            const Crt::String &thingName,
+            Crt::Allocator *allocator) noexcept
+            : m_connection(connection), m_demux(demux), m_client(connection, allocator), m_thingName(thingName),
+              m_allocator(allocator), m_getAllError(AWS_ERROR_SUCCESS)
+        {
+        }
+
+        std::shared_ptr<NamedShadowManager> NamedShadowManager::Create(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            const Crt::String &thingName,
+            Crt::Allocator *allocator)
+        {
+            if (thingName.empty() || thingName.find_first_of("+#") != Crt::String::npos)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto demux = ShadowTopicDemultiplexer::Create(connection, allocator);
+            if (!demux)
+            {
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<NamedShadowManager *>(aws_mem_acquire(allocator, sizeof(NamedShadowManager)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) NamedShadowManager(connection, demux, thingName, allocator);
+                return std::shared_ptr<NamedShadowManager>(
+                    toSeat, [allocator](NamedShadowManager *manager) { Crt::Delete(manager, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool NamedShadowManager::Subscribe(Crt::Mqtt::QOS qos, const OnSubscribeComplete &onSubAck)
+        {
+            const int subscriptionCount = static_cast<int>(sizeof(s_topicSuffixes) / sizeof(s_topicSuffixes[0]));
+            auto context = Crt::MakeShared<SubscribeContext>(m_allocator, onSubAck, subscriptionCount);
+            if (!context)
+            {
+                return false;
+            }
+
+            auto onSubscribeComplete = [context](
+                                           Crt::Mqtt::MqttConnection &,
+                                           uint16_t,
+                                           const Crt::String &,
+                                           Crt::Mqtt::QOS,
+                                           int errorCode) {
+                OnSubscribeComplete onAllSubAcked;
+                int result = AWS_ERROR_SUCCESS;
+                {
+                    std::lock_guard<std::mutex> lock(context->Lock);
+                    if (errorCode != AWS_ERROR_SUCCESS && context->FirstError == AWS_ERROR_SUCCESS)
+                    {
+                        context->FirstError = errorCode;
+                    }
+                    if (--context->Remaining == 0)
+                    {
+                        onAllSubAcked = context->OnSubAck;
+                        result = context->FirstError;
+                    }
+                }
+
+                if (onAllSubAcked)
+                {
+                    onAllSubAcked(result);
+                }
+            };
+
+            std::weak_ptr<ShadowTopicDemultiplexer> weakDemux = m_demux;
+            auto onSubscribePublish = [weakDemux](
+                                          Crt::Mqtt::MqttConnection &,
+                                          const Crt::String &topic,
+                                          const Crt::ByteBuf &payload) {
+                auto demux = weakDemux.lock();
+                if (demux)
+                {
+                    demux->Dispatch(topic, payload);
+                }
+            };
+
+            for (int i = 0; i < subscriptionCount; ++i)
+            {
+                Crt::String topic("$aws/things/");
+                topic.append(m_thingName);
+                topic.append("/shadow/name/+/");
+                topic.append(s_topicSuffixes[i]);
+
+                if (Iotdevicecommon::SubscribeWithHandle(
+                        m_connection,
+                        topic.c_str(),
+                        qos,
+                        Crt::Mqtt::OnMessageReceivedHandler(onSubscribePublish),
+                        Crt::Mqtt::OnSubAckHandler(onSubscribeComplete)) == 0)
+                {
+                    /* Subscriptions already issued still complete; account for this one and the rest. */
+                    int errorCode = aws_last_error();
+                    for (int unissued = i; unissued < subscriptionCount; ++unissued)
+                    {
+                        onSubscribeComplete(*m_connection, 0, topic, qos, errorCode);
+                    }
+                    aws_raise_error(errorCode);
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool NamedShadowManager::AddShadow(const Crt::String &shadowName, const NamedShadowHandlers &handlers)
+        {
+            if (shadowName.empty() || shadowName.find_first_of("+#/") != Crt::String::npos)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            std::weak_ptr<NamedShadowManager> weakManager = shared_from_this();
+            Crt::String name = shadowName;
+            auto onGetAccepted = [weakManager, name, handlers](GetShadowResponse *response, int ioErr) {
+                auto manager = weakManager.lock();
+                if (manager)
+                {
+                    manager->CompleteInitialGet(name, AWS_ERROR_SUCCESS);
+                }
+                if (handlers.OnGetAccepted)
+                {
+                    handlers.OnGetAccepted(response, ioErr);
+                }
+            };
+            auto onGetRejected = [weakManager, name, handlers](ErrorResponse *error, int ioErr) {
+                auto manager = weakManager.lock();
+                if (manager)
+                {
+                    manager->CompleteInitialGet(name, AWS_ERROR_SUCCESS);
+                }
+                if (handlers.OnGetRejected)
+                {
+                    handlers.OnGetRejected(error, ioErr);
+                }
+            };
+
+            bool registered =
+                m_demux->OnGetNamedShadowAccepted(
+                    s_request<GetNamedShadowSubscriptionRequest>(m_thingName, shadowName), onGetAccepted) &&
+                m_demux->OnGetNamedShadowRejected(
+                    s_request<GetNamedShadowSubscriptionRequest>(m_thingName, shadowName), onGetRejected);
+            if (registered && handlers.OnUpdateAccepted)
+            {
+                registered = m_demux->OnUpdateNamedShadowAccepted(
+                    s_request<UpdateNamedShadowSubscriptionRequest>(m_thingName, shadowName),
+                    handlers.OnUpdateAccepted);
+            }
+            if (registered && handlers.OnUpdateRejected)
+            {
+                registered = m_demux->OnUpdateNamedShadowRejected(
+                    s_request<UpdateNamedShadowSubscriptionRequest>(m_thingName, shadowName),
+                    handlers.OnUpdateRejected);
+            }
+            if (registered && handlers.OnDeleteAccepted)
+            {
+                registered = m_demux->OnDeleteNamedShadowAccepted(
+                    s_request<DeleteNamedShadowSubscriptionRequest>(m_thingName, shadowName),
+                    handlers.OnDeleteAccepted);
+            }
+            if (registered && handlers.OnDeleteRejected)
+            {
+                registered = m_demux->OnDeleteNamedShadowRejected(
+                    s_request<DeleteNamedShadowSubscriptionRequest>(m_thingName, shadowName),
+                    handlers.OnDeleteRejected);
+            }
+            if (registered && handlers.OnDeltaUpdated)
+            {
+                registered = m_demux->OnNamedShadowDeltaUpdatedEvents(
+                    s_request<NamedShadowDeltaUpdatedSubscriptionRequest>(m_thingName, shadowName),
+                    handlers.OnDeltaUpdated);
+            }
+            if (registered && handlers.OnUpdated)
+            {
+                registered = m_demux->OnNamedShadowUpdatedEvents(
+                    s_request<NamedShadowUpdatedSubscriptionRequest>(m_thingName, shadowName), handlers.OnUpdated);
+            }
+            if (!registered)
+            {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_shadowNames.push_back(shadowName);
+            return true;
+        }
+
+        bool NamedShadowManager::GetAllShadowsAsync(Crt::Mqtt::QOS qos, const OnGetAllShadowsComplete &onComplete)
+        {
+            Crt::Vector<Crt::String> shadowNames;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_pendingGets.empty())
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_STATE);
+                    return false;
+                }
+
+                shadowNames = m_shadowNames;
+                for (const Crt::String &shadowName : shadowNames)
+                {
+                    m_pendingGets[shadowName] = true;
+                }
+                m_onGetAllComplete = onComplete;
+                m_getAllError = AWS_ERROR_SUCCESS;
+            }
+
+            if (shadowNames.empty())
+            {
+                if (onComplete)
+                {
+                    onComplete(AWS_ERROR_SUCCESS);
+                }
+                return true;
+            }
+
+            std::weak_ptr<NamedShadowManager> weakManager = shared_from_this();
+            for (const Crt::String &shadowName : shadowNames)
+            {
+                GetNamedShadowRequest request;
+                request.ThingName = m_thingName;
+                request.ShadowName = shadowName;
+
+                /* A failed publish gets no response, so it completes its shadow here. */
+                Crt::String name = shadowName;
+                auto onPubAck = [weakManager, name](int ioErr) {
+                    auto manager = weakManager.lock();
+                    if (manager && ioErr != AWS_ERROR_SUCCESS)
+                    {
+                        manager->CompleteInitialGet(name, ioErr);
+                    }
+                };
+
+                if (!m_client.PublishGetNamedShadow(request, qos, onPubAck))
+                {
+                    CompleteInitialGet(shadowName, aws_last_error());
+                }
+            }
+
+            return true;
+        }
+
+        void NamedShadowManager::CompleteInitialGet(const Crt::String &shadowName, int ioErr)
+        {
+            OnGetAllShadowsComplete onComplete;
+            int result = AWS_ERROR_SUCCESS;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto pending = m_pendingGets.find(shadowName);
+                if (pending == m_pendingGets.end())
+                {
+                    return;
+                }
+
+                m_pendingGets.erase(pending);
+                if (ioErr != AWS_ERROR_SUCCESS && m_getAllError == AWS_ERROR_SUCCESS)
+                {
+                    m_getAllError = ioErr;
+                }
+                if (!m_pendingGets.empty())
+                {
+                    return;
+                }
+
+                onComplete = std::move(m_onGetAllComplete);
+                m_onGetAllComplete = nullptr;
+                result = m_getAllError;
+            }
+
+            if (onComplete)
+            {
+                onComplete(result);
+            }
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
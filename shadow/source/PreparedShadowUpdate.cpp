@@ -0,0 +1,172 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/PreparedShadowUpdate.h>
+
+#include <aws/iotdevicecommon/CborWriter.h>
+#include <aws/iotdevicecommon/JsonWriter.h>
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            const char s_jsonPrefix[] = "{\"state\":{\"reported\":{";
+
+            bool s_appendLiteral(Crt::ByteBuf &buf, const char *literal, size_t length)
+            {
+                Crt::ByteCursor cursor = Crt::ByteCursorFromArray(reinterpret_cast<const uint8_t *>(literal), length);
+                return aws_byte_buf_append_dynamic(&buf, &cursor) == AWS_OP_SUCCESS;
+            }
+
+            bool s_writeJsonSuffix(Crt::ByteBuf &buf, const Crt::Optional<int32_t> &version)
+            {
+                if (!version.has_value())
+                {
+                    return s_appendLiteral(buf, "}}}", 3);
+                }
+
+                char suffix[32];
+                int length = snprintf(suffix, sizeof(suffix), "}},\"version\":%" PRId32 "}", *version);
+                return length > 0 && s_appendLiteral(buf, suffix, static_cast<size_t>(length));
+            }
+
+            bool s_writeJson(
+                Crt::ByteBuf &buf,
+                const WriteReportedState &writeReported,
+                const Crt::Optional<int32_t> &version)
+            {
+                if (!s_appendLiteral(buf, s_jsonPrefix, sizeof(s_jsonPrefix) - 1))
+                {
+                    return false;
+                }
+
+                {
+                    /* A fresh writer puts no separator before the first member. */
+                    Iotdevicecommon::JsonWriter writer(buf);
+                    writeReported(writer);
+                    if (!writer)
+                    {
+                        return false;
+                    }
+                }
+
+                return s_writeJsonSuffix(buf, version);
+            }
+
+            bool s_writeCbor(
+                Crt::ByteBuf &buf,
+                const WriteReportedState &writeReported,
+                const Crt::Optional<int32_t> &version)
+            {
+                Iotdevicecommon::CborWriter writer(buf);
+                writer.BeginObject().Key("state").BeginObject().Key("reported").BeginObject();
+                writeReported(writer);
+                writer.EndObject().EndObject();
+                if (version.has_value())
+                {
+                    writer.Key("version").Integer(*version);
+                }
+                writer.EndObject();
+                return static_cast<bool>(writer);
+            }
+        } // namespace
+
+        PreparedShadowUpdate::PreparedShadowUpdate(
+            const IotShadowClient &client,
+            Crt::String &&topic,
+            Crt::Mqtt::QOS qos) noexcept
+            : m_client(client), m_topic(std::move(topic)), m_qos(qos)
+        {
+        }
+
+        bool PreparedShadowUpdate::Send(
+            const WriteReportedState &writeReported,
+            const Crt::Optional<int32_t> &version,
+            const OnPublishComplete &onPubAck) const
+        {
+            if (m_topic.empty() || !writeReported)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            Iotdevicecommon::RequestTrace trace(m_client.m_tracer, m_topic.c_str(), nullptr);
+            Crt::ByteBuf buf = m_client.m_payloadBufferPool->Acquire();
+            bool written = m_client.m_payloadFormat == Iotdevicecommon::PayloadFormat::Cbor
+                               ? s_writeCbor(buf, writeReported, version)
+                               : s_writeJson(buf, writeReported, version);
+            return SendPayload(trace, buf, written, onPubAck);
+        }
+
+        bool PreparedShadowUpdate::SendTemplate(
+            const Iotdevicecommon::JsonTemplate &reported,
+            const Iotdevicecommon::TemplateNumber *values,
+            size_t count,
+            const Crt::Optional<int32_t> &version,
+            const OnPublishComplete &onPubAck) const
+        {
+            if (m_topic.empty())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            if (m_client.m_payloadFormat == Iotdevicecommon::PayloadFormat::Cbor)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return false;
+            }
+
+            Iotdevicecommon::RequestTrace trace(m_client.m_tracer, m_topic.c_str(), nullptr);
+            Crt::ByteBuf buf = m_client.m_payloadBufferPool->Acquire();
+            bool written = s_appendLiteral(buf, s_jsonPrefix, sizeof(s_jsonPrefix) - 1) &&
+                           reported.Render(values, count, buf) && s_writeJsonSuffix(buf, version);
+            return SendPayload(trace, buf, written, onPubAck);
+        }
+
+        bool PreparedShadowUpdate::SendReported(
+            const Crt::JsonView &reported,
+            const Crt::Optional<int32_t> &version,
+            const OnPublishComplete &onPubAck) const
+        {
+            if (!reported.IsObject())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            return Send(
+                [&reported](Iotdevicecommon::PayloadWriter &writer) {
+                    for (const auto &member : reported.GetAllObjects())
+                    {
+                        writer.Key(member.first).Value(member.second);
+                    }
+                },
+                version,
+                onPubAck);
+        }
+
+        bool PreparedShadowUpdate::SendPayload(
+            Iotdevicecommon::RequestTrace &trace,
+            Crt::ByteBuf &buf,
+            bool written,
+            const OnPublishComplete &onPubAck) const
+        {
+            if (!trace.EndSerialize(written))
+            {
+                m_client.m_payloadBufferPool->Release(buf);
+                return false;
+            }
+
+            return m_client.PublishUpdatePayload(m_topic.c_str(), m_qos, trace, buf, onPubAck);
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
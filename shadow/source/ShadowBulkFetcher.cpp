@@ -0,0 +1,390 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowBulkFetcher.h>
+
+#include <aws/iotdevicecommon/ClientToken.h>
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/GetShadowRequest.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/GetShadowSubscriptionRequest.h>
+
+#include <aws/common/clock.h>
+#include <aws/io/event_loop.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            struct TimeoutTask
+            {
+                aws_task Task;
+                std::weak_ptr<ShadowBulkFetcher> Owner;
+                Crt::Allocator *Allocator;
+            };
+
+            struct SubscribeContext
+            {
+                std::mutex Lock;
+                OnSubscribeComplete OnSubAck;
+                int Remaining;
+                int FirstError;
+            };
+        } // namespace
+
+        ShadowBulkFetcherConfig::ShadowBulkFetcherConfig() noexcept
+            : MaxInFlight(16), TimeoutMs(10000), Qos(AWS_MQTT_QOS_AT_LEAST_ONCE)
+        {
+        }
+
+        ShadowBulkFetcher::ShadowBulkFetcher(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const ShadowBulkFetcherConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_client(client), m_config(config), m_allocator(allocator),
+              m_eventLoop(aws_event_loop_group_get_next_loop(eventLoopGroup.GetUnderlyingHandle())),
+              m_timeoutScheduled(false)
+        {
+            if (m_config.MaxInFlight == 0)
+            {
+                m_config.MaxInFlight = 1;
+            }
+        }
+
+        std::shared_ptr<ShadowBulkFetcher> ShadowBulkFetcher::Create(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const ShadowBulkFetcherConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<ShadowBulkFetcher *>(aws_mem_acquire(allocator, sizeof(ShadowBulkFetcher)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ShadowBulkFetcher(client, eventLoopGroup, config, allocator);
+                return std::shared_ptr<ShadowBulkFetcher>(
+                    toSeat, [allocator](ShadowBulkFetcher *fetcher) { Crt::Delete(fetcher, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool ShadowBulkFetcher::Subscribe(const OnSubscribeComplete &onSubAck)
+        {
+            auto context = Crt::MakeShared<SubscribeContext>(m_allocator);
+            if (!context)
+            {
+                return false;
+            }
+            context->OnSubAck = onSubAck;
+            context->Remaining = 2;
+            context->FirstError = AWS_ERROR_SUCCESS;
+
+            auto onEachSubAck = [context](int ioErr) {
+                OnSubscribeComplete onAllSubAcked;
+                int result = AWS_ERROR_SUCCESS;
+                {
+                    std::lock_guard<std::mutex> lock(context->Lock);
+                    if (ioErr != AWS_ERROR_SUCCESS && context->FirstError == AWS_ERROR_SUCCESS)
+                    {
+                        context->FirstError = ioErr;
+                    }
+                    if (--context->Remaining == 0)
+                    {
+                        onAllSubAcked = context->OnSubAck;
+                        result = context->FirstError;
+                    }
+                }
+
+                if (onAllSubAcked)
+                {
+                    onAllSubAcked(result);
+                }
+            };
+
+            std::weak_ptr<ShadowBulkFetcher> weakFetcher = shared_from_this();
+            auto onAccepted = [weakFetcher](GetShadowResponse *response, int) {
+                auto fetcher = weakFetcher.lock();
+                if (fetcher && response && response->ClientToken.has_value() &&
+                    fetcher->Finish(*response->ClientToken, response, nullptr, AWS_ERROR_SUCCESS))
+                {
+                    fetcher->Pump();
+                }
+            };
+            auto onRejected = [weakFetcher](ErrorResponse *error, int) {
+                auto fetcher = weakFetcher.lock();
+                if (fetcher && error && error->ClientToken.has_value() &&
+                    fetcher->Finish(*error->ClientToken, nullptr, error, AWS_ERROR_SUCCESS))
+                {
+                    fetcher->Pump();
+                }
+            };
+
+            GetShadowSubscriptionRequest request;
+            request.ThingName = "+";
+            return m_client.SubscribeToGetShadowAccepted(request, m_config.Qos, onAccepted, onEachSubAck) &&
+                   m_client.SubscribeToGetShadowRejected(request, m_config.Qos, onRejected, onEachSubAck);
+        }
+
+        bool ShadowBulkFetcher::Fetch(
+            const Crt::Vector<Crt::String> &thingNames,
+            const OnShadowFetched &onFetched,
+            const OnBulkFetchComplete &onComplete)
+        {
+            if (thingNames.empty())
+            {
+                if (onComplete)
+                {
+                    onComplete(0, 0);
+                }
+                return true;
+            }
+
+            auto batch = Crt::MakeShared<Batch>(m_allocator);
+            if (!batch)
+            {
+                return false;
+            }
+            batch->OnFetched = onFetched;
+            batch->OnComplete = onComplete;
+            batch->Remaining = thingNames.size();
+            batch->Accepted = 0;
+            batch->Failed = 0;
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                for (const Crt::String &thingName : thingNames)
+                {
+                    Request request;
+                    request.ThingName = thingName;
+                    request.Owner = batch;
+                    request.DeadlineNs = 0;
+                    m_queued.push_back(std::move(request));
+                }
+            }
+
+            Pump();
+            return true;
+        }
+
+        void ShadowBulkFetcher::Pump()
+        {
+            std::weak_ptr<ShadowBulkFetcher> weakFetcher = shared_from_this();
+            bool refused = true;
+            while (refused)
+            {
+                refused = false;
+
+                Crt::Vector<std::pair<Crt::String, Crt::String>> toSend;
+                bool scheduleTimeout = false;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    uint64_t now = 0;
+                    aws_event_loop_current_clock_time(m_eventLoop, &now);
+                    uint64_t timeout =
+                        aws_timestamp_convert(m_config.TimeoutMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+                    uint64_t deadline = now + timeout;
+
+                    while (m_inFlight.size() < m_config.MaxInFlight && !m_queued.empty())
+                    {
+                        Request request = std::move(m_queued.front());
+                        m_queued.pop_front();
+                        request.DeadlineNs = deadline;
+
+                        Crt::String clientToken = Iotdevicecommon::GenerateClientToken();
+                        toSend.emplace_back(clientToken, request.ThingName);
+                        m_inFlight.emplace(clientToken, std::move(request));
+                    }
+
+                    if (!m_inFlight.empty() && !m_timeoutScheduled)
+                    {
+                        m_timeoutScheduled = true;
+                        scheduleTimeout = true;
+                    }
+                }
+
+                if (scheduleTimeout)
+                {
+                    ScheduleTimeoutCheck();
+                }
+
+                for (const auto &send : toSend)
+                {
+                    const Crt::String &clientToken = send.first;
+                    auto onPubAck = [weakFetcher, clientToken](int ioErr) {
+                        auto fetcher = weakFetcher.lock();
+                        if (fetcher && ioErr != AWS_ERROR_SUCCESS &&
+                            fetcher->Finish(clientToken, nullptr, nullptr, ioErr))
+                        {
+                            fetcher->Pump();
+                        }
+                    };
+
+                    GetShadowRequest request;
+                    request.ThingName = send.second;
+                    request.ClientToken = clientToken;
+                    if (!m_client.PublishGetShadow(request, m_config.Qos, onPubAck))
+                    {
+                        /* Loop rather than recurse, so a dead connection cannot exhaust the stack. */
+                        refused = Finish(clientToken, nullptr, nullptr, Crt::LastErrorOrUnknown()) || refused;
+                    }
+                }
+            }
+        }
+
+        bool ShadowBulkFetcher::Finish(
+            const Crt::String &clientToken,
+            GetShadowResponse *response,
+            ErrorResponse *error,
+            int ioErr)
+        {
+            Request request;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto iter = m_inFlight.find(clientToken);
+                if (iter == m_inFlight.end())
+                {
+                    return false;
+                }
+                request = std::move(iter->second);
+                m_inFlight.erase(iter);
+            }
+
+            Report(request, response, error, ioErr);
+            return true;
+        }
+
+        void ShadowBulkFetcher::Report(Request &request, GetShadowResponse *response, ErrorResponse *error, int ioErr)
+        {
+            Batch &batch = *request.Owner;
+            bool batchComplete = false;
+            size_t accepted = 0;
+            size_t failed = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                ++(response ? batch.Accepted : batch.Failed);
+                batchComplete = --batch.Remaining == 0;
+                accepted = batch.Accepted;
+                failed = batch.Failed;
+            }
+
+            if (batch.OnFetched)
+            {
+                batch.OnFetched(request.ThingName, response, error, ioErr);
+            }
+            if (batchComplete && batch.OnComplete)
+            {
+                batch.OnComplete(accepted, failed);
+            }
+        }
+
+        void ShadowBulkFetcher::CancelAll(int errorCode)
+        {
+            Crt::List<Request> queued;
+            Crt::Map<Crt::String, Request> inFlight;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                queued.swap(m_queued);
+                inFlight.swap(m_inFlight);
+            }
+
+            for (auto &entry : inFlight)
+            {
+                Report(entry.second, nullptr, nullptr, errorCode);
+            }
+            for (Request &request : queued)
+            {
+                Report(request, nullptr, nullptr, errorCode);
+            }
+        }
+
+        size_t ShadowBulkFetcher::GetPendingCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_queued.size() + m_inFlight.size();
+        }
+
+        void ShadowBulkFetcher::ScheduleTimeoutCheck()
+        {
+            auto *timeoutTask = Crt::New<TimeoutTask>(m_allocator);
+            if (!timeoutTask)
+            {
+                /* Try again when the next get is sent. */
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_timeoutScheduled = false;
+                return;
+            }
+
+            timeoutTask->Owner = shared_from_this();
+            timeoutTask->Allocator = m_allocator;
+            aws_task_init(&timeoutTask->Task, s_onTimeoutTask, timeoutTask, "ShadowBulkFetcherTimeout");
+
+            /* Checking twice per timeout bounds how late an expired get is failed. */
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &now);
+            uint64_t period =
+                aws_timestamp_convert(m_config.TimeoutMs / 2 + 1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+            aws_event_loop_schedule_task_future(m_eventLoop, &timeoutTask->Task, now + period);
+        }
+
+        void ShadowBulkFetcher::s_onTimeoutTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *timeoutTask = static_cast<TimeoutTask *>(arg);
+            if (status == AWS_TASK_STATUS_RUN_READY)
+            {
+                auto owner = timeoutTask->Owner.lock();
+                if (owner)
+                {
+                    owner->ExpireRequests();
+                }
+            }
+
+            Crt::Delete(timeoutTask, timeoutTask->Allocator);
+        }
+
+        void ShadowBulkFetcher::ExpireRequests()
+        {
+            Crt::Vector<Request> expired;
+            bool reschedule = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                uint64_t now = 0;
+                aws_event_loop_current_clock_time(m_eventLoop, &now);
+                for (auto iter = m_inFlight.begin(); iter != m_inFlight.end();)
+                {
+                    if (iter->second.DeadlineNs <= now)
+                    {
+                        expired.push_back(std::move(iter->second));
+                        iter = m_inFlight.erase(iter);
+                    }
+                    else
+                    {
+                        ++iter;
+                    }
+                }
+
+                /* Otherwise the next Pump schedules a check for the gets it sends. */
+                reschedule = !m_inFlight.empty();
+                m_timeoutScheduled = reschedule;
+            }
+
+            for (Request &request : expired)
+            {
+                Report(request, nullptr, nullptr, AWS_ERROR_MQTT_TIMEOUT);
+            }
+            if (reschedule)
+            {
+                ScheduleTimeoutCheck();
+            }
+            if (!expired.empty())
+            {
+                Pump();
+            }
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
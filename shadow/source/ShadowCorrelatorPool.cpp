@@ -0,0 +1,45 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowCorrelatorPool.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        std::shared_ptr<ShadowCorrelatorPool> CreateShadowCorrelatorPool(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const ShadowRequestCorrelatorConfig &config,
+            const std::shared_ptr<Iotdevicecommon::TimerWheel> &timers,
+            uint32_t idleTtlMs,
+            Crt::Mqtt::QOS qos,
+            Crt::Allocator *allocator)
+        {
+            IotShadowClient shadowClient = client;
+            ShadowRequestCorrelatorConfig correlatorConfig = config;
+            if (!correlatorConfig.Timers)
+            {
+                correlatorConfig.Timers = timers;
+            }
+
+            /* The group outlives the pool, as it does the client's connection. */
+            Crt::Io::EventLoopGroup *group = &eventLoopGroup;
+            return ShadowCorrelatorPool::Create(
+                [shadowClient, group, correlatorConfig, allocator](const Crt::String &thingName) {
+                    return ShadowRequestCorrelator::Create(
+                        shadowClient, *group, thingName, correlatorConfig, allocator);
+                },
+                [qos](ShadowRequestCorrelator &correlator, const ShadowCorrelatorPool::OnSubscribed &onSubscribed) {
+                    return correlator.Subscribe(qos, onSubscribed);
+                },
+                [](const ShadowRequestCorrelator &correlator) { return correlator.GetInFlightCount() > 0; },
+                timers,
+                idleTtlMs,
+                allocator);
+        }
+
+    } // namespace Iotshadow
+} // namespace Aws
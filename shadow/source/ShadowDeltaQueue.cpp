@@ -0,0 +1,165 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowDeltaQueue.h>
+
+#include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            bool s_isWildcard(const Crt::Optional<Crt::String> &name)
+            {
+                return !name || name->find_first_of("+#") != Crt::String::npos;
+            }
+        } // namespace
+
+        ShadowDeltaQueueConfig::ShadowDeltaQueueConfig() noexcept : MaxQueuedPerShadow(1), Executor() {}
+
+        ShadowDeltaQueue::ShadowDeltaQueue(
+            const IotShadowClient &client,
+            const ShadowDeltaQueueConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_client(client), m_config(config), m_allocator(allocator), m_coalescedCount(0)
+        {
+            if (m_config.MaxQueuedPerShadow == 0)
+            {
+                m_config.MaxQueuedPerShadow = 1;
+            }
+        }
+
+        std::shared_ptr<ShadowDeltaQueue> ShadowDeltaQueue::Create(
+            const IotShadowClient &client,
+            const ShadowDeltaQueueConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<ShadowDeltaQueue *>(aws_mem_acquire(allocator, sizeof(ShadowDeltaQueue)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ShadowDeltaQueue(client, config, allocator);
+                return std::shared_ptr<ShadowDeltaQueue>(
+                    toSeat, [allocator](ShadowDeltaQueue *queue) { Crt::Delete(queue, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool ShadowDeltaQueue::SubscribeToShadowDeltaUpdatedEvents(
+            const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            if (s_isWildcard(request.ThingName))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            return m_client.SubscribeToShadowDeltaUpdatedEvents(
+                request, qos, MakeQueuedHandler(*request.ThingName, handler), onSubAck);
+        }
+
+        bool ShadowDeltaQueue::SubscribeToNamedShadowDeltaUpdatedEvents(
+            const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            if (s_isWildcard(request.ThingName) || s_isWildcard(request.ShadowName))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            return m_client.SubscribeToNamedShadowDeltaUpdatedEvents(
+                request, qos, MakeQueuedHandler(*request.ThingName, handler), onSubAck);
+        }
+
+        OnSubscribeToShadowDeltaUpdatedEventsResponse ShadowDeltaQueue::MakeQueuedHandler(
+            const Crt::String &thingName,
+            const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler)
+        {
+            auto queue = Crt::MakeShared<ShadowQueue>(m_allocator);
+            queue->ThingName = thingName;
+            queue->Handler = handler;
+
+            std::shared_ptr<ShadowDeltaQueue> self = shared_from_this();
+            return [self, queue](ShadowDeltaUpdatedEvent *event, int ioErr) {
+                if (ioErr || !event)
+                {
+                    /* Errors are not deltas; pass them straight through. */
+                    queue->Handler(event, ioErr);
+                    return;
+                }
+
+                self->Push(queue, std::move(*event));
+            };
+        }
+
+        void ShadowDeltaQueue::Push(const std::shared_ptr<ShadowQueue> &queue, ShadowDeltaUpdatedEvent &&event)
+        {
+            {
+                std::lock_guard<std::mutex> guard(queue->Lock);
+                if (event.Version && queue->LatestVersion && *event.Version <= *queue->LatestVersion)
+                {
+                    ++m_coalescedCount;
+                    return;
+                }
+                if (event.Version)
+                {
+                    queue->LatestVersion = *event.Version;
+                }
+
+                if (queue->Queued.size() >= m_config.MaxQueuedPerShadow)
+                {
+                    m_coalescedCount += queue->Queued.size();
+                    queue->Queued.clear();
+                }
+                queue->Queued.push_back(std::move(event));
+
+                if (queue->Draining)
+                {
+                    return;
+                }
+                queue->Draining = true;
+            }
+
+            if (!m_config.Executor)
+            {
+                Drain(queue);
+                return;
+            }
+
+            std::shared_ptr<ShadowDeltaQueue> self = shared_from_this();
+            m_config.Executor(queue->ThingName, [self, queue]() { self->Drain(queue); });
+        }
+
+        void ShadowDeltaQueue::Drain(const std::shared_ptr<ShadowQueue> &queue)
+        {
+            while (true)
+            {
+                ShadowDeltaUpdatedEvent event;
+                {
+                    std::lock_guard<std::mutex> guard(queue->Lock);
+                    if (queue->Queued.empty())
+                    {
+                        queue->Draining = false;
+                        return;
+                    }
+                    event = std::move(queue->Queued.front());
+                    queue->Queued.pop_front();
+                }
+
+                queue->Handler(&event, AWS_ERROR_SUCCESS);
+            }
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
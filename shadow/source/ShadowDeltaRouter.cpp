@@ -0,0 +1,321 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowDeltaRouter.h>
+
+#include <aws/iotdevicecommon/ServiceLog.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            /* A delta never carries nulls, so any other kind means the member is there. */
+            bool s_isPresent(const Crt::JsonView &member)
+            {
+                return member.IsObject() || member.IsListType() || member.IsString() || member.IsBool() ||
+                       member.IsIntegerType() || member.IsFloatingPointType();
+            }
+        } // namespace
+
+        ShadowDeltaRouter::ShadowDeltaRouter(const IotShadowClient &client, Crt::Allocator *allocator) noexcept
+            : m_client(client), m_allocator(allocator), m_nextRouteId(1)
+        {
+        }
+
+        std::shared_ptr<ShadowDeltaRouter> ShadowDeltaRouter::Create(
+            const IotShadowClient &client,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<ShadowDeltaRouter *>(aws_mem_acquire(allocator, sizeof(ShadowDeltaRouter)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ShadowDeltaRouter(client, allocator);
+                return std::shared_ptr<ShadowDeltaRouter>(
+                    toSeat, [allocator](ShadowDeltaRouter *router) { Crt::Delete(router, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        uint64_t ShadowDeltaRouter::Route(const Crt::String &path, OnShadowDeltaPathUpdated &&handler)
+        {
+            if (path.empty() || !handler)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return 0;
+            }
+
+            Crt::Vector<Crt::String> segments;
+            size_t begin = 0;
+            while (true)
+            {
+                size_t end = path.find('.', begin);
+                Crt::String segment = path.substr(begin, end == Crt::String::npos ? Crt::String::npos : end - begin);
+                if (segment.empty())
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                    return 0;
+                }
+                segments.push_back(std::move(segment));
+                if (end == Crt::String::npos)
+                {
+                    break;
+                }
+                begin = end + 1;
+            }
+
+            auto invoke = Crt::MakeShared<OnShadowDeltaPathUpdated>(m_allocator, std::move(handler));
+            uint64_t routeId = 0;
+            bool widened = false;
+            Subscribe resubscribe;
+            Crt::Vector<Crt::String> projection;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                auto index = Crt::MakeShared<Index>(m_allocator, Crt::StlAllocator<Node>(m_allocator));
+                if (!invoke || !index)
+                {
+                    aws_raise_error(AWS_ERROR_OOM);
+                    return 0;
+                }
+                if (m_index)
+                {
+                    *index = *m_index;
+                }
+                else
+                {
+                    index->emplace_back();
+                }
+
+                size_t node = 0;
+                for (const Crt::String &segment : segments)
+                {
+                    size_t child = 0;
+                    for (size_t candidate : (*index)[node].Children)
+                    {
+                        if ((*index)[candidate].Name == segment)
+                        {
+                            child = candidate;
+                            break;
+                        }
+                    }
+                    if (child == 0)
+                    {
+                        child = index->size();
+                        Node created;
+                        created.Name = segment;
+                        created.Path = (*index)[node].Path.empty() ? segment : (*index)[node].Path + "." + segment;
+                        index->push_back(std::move(created));
+                        (*index)[node].Children.push_back(child);
+                        widened = true;
+                    }
+                    node = child;
+                }
+
+                /* A handler on an interior node needs its whole subtree, where the projection had only paths. */
+                widened = widened || (!(*index)[node].Children.empty() && (*index)[node].Handlers.empty());
+                routeId = m_nextRouteId++;
+                (*index)[node].Handlers.push_back(Handler{routeId, std::move(invoke)});
+                if (widened && m_subscribe)
+                {
+                    resubscribe = m_subscribe;
+                    projection = ProjectionOf(*index);
+                }
+                m_index = std::move(index);
+            }
+
+            if (resubscribe && !resubscribe(std::move(projection), OnSubscribeComplete()))
+            {
+                AWS_IOTDEVICE_LOG_WARN(
+                    Iotdevicecommon::LogSubsystem::Shadow,
+                    "delta route resubscribe failed",
+                    {{"path", path}, {"error", aws_last_error()}});
+            }
+            return routeId;
+        }
+
+        bool ShadowDeltaRouter::Unroute(uint64_t routeId)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (!m_index)
+            {
+                return false;
+            }
+
+            auto index = Crt::MakeShared<Index>(m_allocator, *m_index);
+            if (!index)
+            {
+                return false;
+            }
+            for (Node &node : *index)
+            {
+                for (auto handler = node.Handlers.begin(); handler != node.Handlers.end(); ++handler)
+                {
+                    if (handler->Id == routeId)
+                    {
+                        /* The node stays, so the projection keeps covering it until resubscribed. */
+                        node.Handlers.erase(handler);
+                        m_index = std::move(index);
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        size_t ShadowDeltaRouter::GetRouteCount() const
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            size_t count = 0;
+            if (m_index)
+            {
+                for (const Node &node : *m_index)
+                {
+                    count += node.Handlers.size();
+                }
+            }
+            return count;
+        }
+
+        bool ShadowDeltaRouter::SubscribeToShadowDeltaUpdatedEvents(
+            const ShadowDeltaUpdatedSubscriptionRequest &request,
+            Crt::Mqtt::QOS qos,
+            const OnSubscribeComplete &onSubAck)
+        {
+            if (!request.ThingName)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            OnSubscribeToShadowDeltaUpdatedEventsResponse dispatcher = MakeDispatcher();
+            ShadowDeltaUpdatedSubscriptionRequest subscription = request;
+            return SubscribeWith(
+                [this, subscription, qos, dispatcher](
+                    Crt::Vector<Crt::String> &&projection, const OnSubscribeComplete &onAck) mutable {
+                    subscription.Projection = std::move(projection);
+                    return m_client.SubscribeToShadowDeltaUpdatedEvents(subscription, qos, dispatcher, onAck);
+                },
+                request.Projection,
+                onSubAck);
+        }
+
+        bool ShadowDeltaRouter::SubscribeToNamedShadowDeltaUpdatedEvents(
+            const NamedShadowDeltaUpdatedSubscriptionRequest &request,
+            Crt::Mqtt::QOS qos,
+            const OnSubscribeComplete &onSubAck)
+        {
+            if (!request.ThingName || !request.ShadowName)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            OnSubscribeToNamedShadowDeltaUpdatedEventsResponse dispatcher = MakeDispatcher();
+            NamedShadowDeltaUpdatedSubscriptionRequest subscription = request;
+            return SubscribeWith(
+                [this, subscription, qos, dispatcher](
+                    Crt::Vector<Crt::String> &&projection, const OnSubscribeComplete &onAck) mutable {
+                    subscription.Projection = std::move(projection);
+                    return m_client.SubscribeToNamedShadowDeltaUpdatedEvents(subscription, qos, dispatcher, onAck);
+                },
+                request.Projection,
+                onSubAck);
+        }
+
+        bool ShadowDeltaRouter::SubscribeWith(
+            Subscribe &&subscribe,
+            const Crt::Optional<Crt::Vector<Crt::String>> &requestProjection,
+            const OnSubscribeComplete &onSubAck)
+        {
+            Crt::Vector<Crt::String> projection;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_requestProjection = requestProjection ? *requestProjection : Crt::Vector<Crt::String>();
+                m_subscribe = subscribe;
+                projection = m_index ? ProjectionOf(*m_index) : m_requestProjection;
+            }
+            return subscribe(std::move(projection), onSubAck);
+        }
+
+        OnSubscribeToShadowDeltaUpdatedEventsResponse ShadowDeltaRouter::MakeDispatcher()
+        {
+            std::weak_ptr<ShadowDeltaRouter> weakSelf = shared_from_this();
+            return [weakSelf](ShadowDeltaUpdatedEvent *event, int ioErr) {
+                auto self = weakSelf.lock();
+                if (!self)
+                {
+                    return;
+                }
+                if (ioErr || !event)
+                {
+                    AWS_IOTDEVICE_LOG_WARN(
+                        Iotdevicecommon::LogSubsystem::Shadow, "delta route dropped", {{"error", ioErr}});
+                    return;
+                }
+                self->Dispatch(*event);
+            };
+        }
+
+        Crt::Vector<Crt::String> ShadowDeltaRouter::ProjectionOf(const Index &index) const
+        {
+            Crt::Vector<Crt::String> projection = m_requestProjection;
+            for (size_t node = 1; node < index.size(); ++node)
+            {
+                /* Interior nodes without handlers need no path of their own: every object along one is kept. */
+                if (index[node].Children.empty() || !index[node].Handlers.empty())
+                {
+                    projection.push_back("state." + index[node].Path);
+                }
+            }
+            return projection;
+        }
+
+        void ShadowDeltaRouter::Dispatch(const ShadowDeltaUpdatedEvent &event) const
+        {
+            std::shared_ptr<const Index> index;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                index = m_index;
+            }
+
+            if (!index || !event.State)
+            {
+                return;
+            }
+
+            Walk(*index, 0, event.State->View(), event);
+        }
+
+        void ShadowDeltaRouter::Walk(
+            const Index &index,
+            size_t node,
+            const Crt::JsonView &delta,
+            const ShadowDeltaUpdatedEvent &event) const
+        {
+            if (!delta.IsObject())
+            {
+                return;
+            }
+
+            for (size_t child : index[node].Children)
+            {
+                const Node &childNode = index[child];
+                Crt::JsonView member = delta.GetJsonObject(childNode.Name);
+                if (!s_isPresent(member))
+                {
+                    continue;
+                }
+
+                for (const Handler &handler : childNode.Handlers)
+                {
+                    (*handler.Invoke)(childNode.Path, member, event);
+                }
+                Walk(index, child, member, event);
+            }
+        }
+
+    } // namespace Iotshadow
+} // namespace Aws
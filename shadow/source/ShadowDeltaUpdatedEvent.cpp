@@ -21,7 +21,7 @@ namespace Aws
 
             if (doc.ValueExists("timestamp"))
             {
-                val.Timestamp = doc.GetDouble("timestamp");
+                val.Timestamp = Aws::Iotdevicecommon::PackedDateTime::FromSeconds(doc.GetDouble("timestamp"));
             }
 
             if (doc.ValueExists("metadata"))
@@ -46,7 +46,7 @@ namespace Aws
 
             if (Timestamp)
             {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
+                object.WithDouble("timestamp", Timestamp.Seconds());
             }
 
             if (Metadata)
@@ -68,5 +68,37 @@ namespace Aws
             return *this;
         }
 
+        void ShadowDeltaUpdatedEvent::Reload(const Crt::JsonView &doc)
+        {
+            Version.reset();
+            Timestamp.reset();
+            if (doc.ValueExists("metadata"))
+            {
+                Metadata = doc.GetJsonObjectCopy("metadata");
+            }
+            else
+            {
+                Metadata.reset();
+            }
+            if (doc.ValueExists("state"))
+            {
+                State = doc.GetJsonObjectCopy("state");
+            }
+            else
+            {
+                State.reset();
+            }
+
+            if (doc.ValueExists("version"))
+            {
+                Version = doc.GetInteger("version");
+            }
+
+            if (doc.ValueExists("timestamp"))
+            {
+                Timestamp = Aws::Iotdevicecommon::PackedDateTime::FromSeconds(doc.GetDouble("timestamp"));
+            }
+        }
+
     } // namespace Iotshadow
 } // namespace Aws
@@ -0,0 +1,679 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#if defined(_MSC_VER)
+/* The snapshot is swapped with the shared_ptr atomic functions, which C++20 deprecates in favour of
+ * std::atomic<std::shared_ptr>; C++11 builds have only the former. */
+#    define _SILENCE_CXX20_OLD_SHARED_PTR_ATOMIC_SUPPORT_DEPRECATION_WARNING
+#endif
+
+#include <aws/iotshadow/ShadowDocument.h>
+
+#include <aws/iotshadow/GetNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/GetShadowSubscriptionRequest.h>
+#include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/NamedShadowUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowUpdatedEvent.h>
+#include <aws/iotshadow/ShadowUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateShadowResponse.h>
+#include <aws/iotshadow/UpdateShadowSubscriptionRequest.h>
+
+#include <aws/common/file.h>
+
+#include <cstdio>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            struct SubscribeContext
+            {
+                SubscribeContext(const OnSubscribeComplete &onSubAck, int remaining)
+                    : OnSubAck(onSubAck), Remaining(remaining), FirstError(AWS_ERROR_SUCCESS)
+                {
+                }
+
+                std::mutex Lock;
+                OnSubscribeComplete OnSubAck;
+                int Remaining;
+                int FirstError;
+            };
+
+            /* Shadow update semantics: nested objects merge, null removes the key, anything else replaces. */
+            Crt::JsonObject s_applyPatch(const Crt::JsonView &base, const Crt::JsonView &patch)
+            {
+                Crt::JsonObject result;
+                Crt::Map<Crt::String, Crt::JsonView> baseEntries;
+                if (base.IsObject())
+                {
+                    baseEntries = base.GetAllObjects();
+                }
+                Crt::Map<Crt::String, Crt::JsonView> patchEntries = patch.GetAllObjects();
+
+                for (const auto &entry : baseEntries)
+                {
+                    if (patchEntries.find(entry.first) == patchEntries.end())
+                    {
+                        result.WithObject(entry.first, entry.second.Materialize());
+                    }
+                }
+
+                for (const auto &entry : patchEntries)
+                {
+                    if (entry.second.IsNull())
+                    {
+                        continue;
+                    }
+
+                    auto baseEntry = baseEntries.find(entry.first);
+                    if (entry.second.IsObject() && baseEntry != baseEntries.end() && baseEntry->second.IsObject())
+                    {
+                        result.WithObject(entry.first, s_applyPatch(baseEntry->second, entry.second));
+                    }
+                    else
+                    {
+                        result.WithObject(entry.first, entry.second.Materialize());
+                    }
+                }
+
+                return result;
+            }
+
+            using SharedJson = std::shared_ptr<const Crt::JsonObject>;
+
+            SharedJson s_share(Crt::Allocator *allocator, const Crt::Optional<Crt::JsonObject> &value)
+            {
+                return value.has_value() ? SharedJson(Crt::MakeShared<Crt::JsonObject>(allocator, *value))
+                                         : SharedJson();
+            }
+
+            /* Replaces `target` with the patched copy; the previous snapshot keeps the original. */
+            void s_patch(Crt::Allocator *allocator, SharedJson &target, const Crt::Optional<Crt::JsonObject> &patch)
+            {
+                if (!patch.has_value())
+                {
+                    return;
+                }
+
+                target = Crt::MakeShared<Crt::JsonObject>(
+                    allocator, s_applyPatch(target ? target->View() : Crt::JsonView(), patch->View()));
+            }
+
+            Crt::Optional<Crt::JsonObject> s_copy(const SharedJson &value)
+            {
+                return value ? Crt::Optional<Crt::JsonObject>(*value) : Crt::Optional<Crt::JsonObject>();
+            }
+
+            /* Replaces the whole of `snapshot` with a GetShadow response or an updated event's current state. */
+            template <typename Document>
+            void s_replace(Crt::Allocator *allocator, ShadowDocument::Snapshot &snapshot, const Document &document)
+            {
+                snapshot.Desired.reset();
+                snapshot.Reported.reset();
+                if (document.State.has_value())
+                {
+                    snapshot.Desired = s_share(allocator, document.State->Desired);
+                    snapshot.Reported = s_share(allocator, document.State->Reported);
+                }
+
+                snapshot.DesiredMetadata.reset();
+                snapshot.ReportedMetadata.reset();
+                if (document.Metadata.has_value())
+                {
+                    snapshot.DesiredMetadata = s_share(allocator, document.Metadata->Desired);
+                    snapshot.ReportedMetadata = s_share(allocator, document.Metadata->Reported);
+                }
+
+                snapshot.Version = document.Version;
+                snapshot.Restored = false;
+            }
+
+            void s_withPair(
+                Crt::JsonObject &record,
+                const char *key,
+                const SharedJson &desired,
+                const SharedJson &reported)
+            {
+                if (!desired && !reported)
+                {
+                    return;
+                }
+
+                Crt::JsonObject pair;
+                if (desired)
+                {
+                    pair.WithObject("desired", *desired);
+                }
+                if (reported)
+                {
+                    pair.WithObject("reported", *reported);
+                }
+                record.WithObject(key, std::move(pair));
+            }
+
+            bool s_diff(const Crt::JsonView &from, const Crt::JsonView &to, Crt::JsonObject &patch)
+            {
+                bool changed = false;
+                Crt::Map<Crt::String, Crt::JsonView> fromEntries;
+                if (from.IsObject())
+                {
+                    fromEntries = from.GetAllObjects();
+                }
+                Crt::Map<Crt::String, Crt::JsonView> toEntries = to.GetAllObjects();
+
+                for (const auto &entry : fromEntries)
+                {
+                    if (toEntries.find(entry.first) == toEntries.end())
+                    {
+                        patch.WithObject(entry.first, Crt::JsonObject().AsNull());
+                        changed = true;
+                    }
+                }
+
+                for (const auto &entry : toEntries)
+                {
+                    auto fromEntry = fromEntries.find(entry.first);
+                    if (fromEntry == fromEntries.end())
+                    {
+                        patch.WithObject(entry.first, entry.second.Materialize());
+                        changed = true;
+                    }
+                    else if (entry.second.IsObject() && fromEntry->second.IsObject())
+                    {
+                        Crt::JsonObject nested;
+                        if (s_diff(fromEntry->second, entry.second, nested))
+                        {
+                            patch.WithObject(entry.first, std::move(nested));
+                            changed = true;
+                        }
+                    }
+                    else
+                    {
+                        Crt::JsonObject value = entry.second.Materialize();
+                        if (value != fromEntry->second.Materialize())
+                        {
+                            patch.WithObject(entry.first, std::move(value));
+                            changed = true;
+                        }
+                    }
+                }
+
+                return changed;
+            }
+
+            template <typename Response>
+            std::function<void(Response *, int)> s_makeApplier(const std::weak_ptr<ShadowDocument> &weakDocument)
+            {
+                return [weakDocument](Response *response, int ioErr) {
+                    auto document = weakDocument.lock();
+                    if (document && ioErr == AWS_ERROR_SUCCESS && response)
+                    {
+                        document->Apply(*response);
+                    }
+                };
+            }
+        } // namespace
+
+        ShadowDocument::ShadowDocument(
+            const Crt::String &thingName,
+            const Crt::Optional<Crt::String> &shadowName,
+            Crt::Allocator *allocator) noexcept
+            : m_thingName(thingName), m_shadowName(shadowName), m_allocator(allocator),
+              m_snapshot(Crt::MakeShared<Snapshot>(allocator))
+        {
+        }
+
+        std::shared_ptr<ShadowDocument> ShadowDocument::Create(const Crt::String &thingName, Crt::Allocator *allocator)
+        {
+            return s_create(thingName, Crt::Optional<Crt::String>(), allocator);
+        }
+
+        std::shared_ptr<ShadowDocument> ShadowDocument::CreateNamed(
+            const Crt::String &thingName,
+            const Crt::String &shadowName,
+            Crt::Allocator *allocator)
+        {
+            return s_create(thingName, Crt::Optional<Crt::String>(shadowName), allocator);
+        }
+
+        std::shared_ptr<ShadowDocument> ShadowDocument::s_create(
+            const Crt::String &thingName,
+            const Crt::Optional<Crt::String> &shadowName,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<ShadowDocument *>(aws_mem_acquire(allocator, sizeof(ShadowDocument)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ShadowDocument(thingName, shadowName, allocator);
+                std::shared_ptr<ShadowDocument> created(
+                    toSeat, [allocator](ShadowDocument *document) { Crt::Delete(document, allocator); });
+                return created->m_snapshot ? created : nullptr;
+            }
+
+            return nullptr;
+        }
+
+        bool ShadowDocument::Subscribe(IotShadowClient &client, Crt::Mqtt::QOS qos, const OnSubscribeComplete &onSubAck)
+        {
+            auto context = Crt::MakeShared<SubscribeContext>(m_allocator, onSubAck, 4);
+            if (!context)
+            {
+                return false;
+            }
+
+            auto onEachSubAck = [context](int ioErr) {
+                OnSubscribeComplete onAllSubAcked;
+                int result = AWS_ERROR_SUCCESS;
+                {
+                    std::lock_guard<std::mutex> lock(context->Lock);
+                    if (ioErr != AWS_ERROR_SUCCESS && context->FirstError == AWS_ERROR_SUCCESS)
+                    {
+                        context->FirstError = ioErr;
+                    }
+                    if (--context->Remaining == 0)
+                    {
+                        onAllSubAcked = context->OnSubAck;
+                        result = context->FirstError;
+                    }
+                }
+
+                if (onAllSubAcked)
+                {
+                    onAllSubAcked(result);
+                }
+            };
+
+            std::weak_ptr<ShadowDocument> weakDocument = shared_from_this();
+
+            if (m_shadowName.has_value())
+            {
+                GetNamedShadowSubscriptionRequest getRequest;
+                getRequest.ThingName = m_thingName;
+                getRequest.ShadowName = *m_shadowName;
+
+                UpdateNamedShadowSubscriptionRequest updateRequest;
+                updateRequest.ThingName = m_thingName;
+                updateRequest.ShadowName = *m_shadowName;
+
+                NamedShadowUpdatedSubscriptionRequest updatedRequest;
+                updatedRequest.ThingName = m_thingName;
+                updatedRequest.ShadowName = *m_shadowName;
+
+                NamedShadowDeltaUpdatedSubscriptionRequest deltaRequest;
+                deltaRequest.ThingName = m_thingName;
+                deltaRequest.ShadowName = *m_shadowName;
+
+                return client.SubscribeToGetNamedShadowAccepted(
+                           getRequest, qos, s_makeApplier<GetShadowResponse>(weakDocument), onEachSubAck) &&
+                       client.SubscribeToUpdateNamedShadowAccepted(
+                           updateRequest, qos, s_makeApplier<UpdateShadowResponse>(weakDocument), onEachSubAck) &&
+                       client.SubscribeToNamedShadowUpdatedEvents(
+                           updatedRequest, qos, s_makeApplier<ShadowUpdatedEvent>(weakDocument), onEachSubAck) &&
+                       client.SubscribeToNamedShadowDeltaUpdatedEvents(
+                           deltaRequest, qos, s_makeApplier<ShadowDeltaUpdatedEvent>(weakDocument), onEachSubAck);
+            }
+
+            GetShadowSubscriptionRequest getRequest;
+            getRequest.ThingName = m_thingName;
+
+            UpdateShadowSubscriptionRequest updateRequest;
+            updateRequest.ThingName = m_thingName;
+
+            ShadowUpdatedSubscriptionRequest updatedRequest;
+            updatedRequest.ThingName = m_thingName;
+
+            ShadowDeltaUpdatedSubscriptionRequest deltaRequest;
+            deltaRequest.ThingName = m_thingName;
+
+            return client.SubscribeToGetShadowAccepted(
+                       getRequest, qos, s_makeApplier<GetShadowResponse>(weakDocument), onEachSubAck) &&
+                   client.SubscribeToUpdateShadowAccepted(
+                       updateRequest, qos, s_makeApplier<UpdateShadowResponse>(weakDocument), onEachSubAck) &&
+                   client.SubscribeToShadowUpdatedEvents(
+                       updatedRequest, qos, s_makeApplier<ShadowUpdatedEvent>(weakDocument), onEachSubAck) &&
+                   client.SubscribeToShadowDeltaUpdatedEvents(
+                       deltaRequest, qos, s_makeApplier<ShadowDeltaUpdatedEvent>(weakDocument), onEachSubAck);
+        }
+
+        std::shared_ptr<ShadowDocument::Snapshot> ShadowDocument::BeginUpdateLocked(
+            const Crt::Optional<int32_t> &version) const
+        {
+            std::shared_ptr<const Snapshot> current = GetSnapshot();
+            if (version.has_value() && current->Version.has_value() && *version < *current->Version)
+            {
+                return nullptr;
+            }
+
+            /* Copies only the version and the pointers; the documents themselves are shared. */
+            return Crt::MakeShared<Snapshot>(m_allocator, *current);
+        }
+
+        std::shared_ptr<ShadowDocument::Snapshot> ShadowDocument::BeginReplaceLocked(
+            const Crt::Optional<int32_t> &version) const
+        {
+            if (GetSnapshot()->Restored)
+            {
+                return Crt::MakeShared<Snapshot>(m_allocator);
+            }
+            return BeginUpdateLocked(version);
+        }
+
+        void ShadowDocument::PublishLocked(std::shared_ptr<const Snapshot> snapshot)
+        {
+            std::atomic_store(&m_snapshot, snapshot);
+            if (m_onSnapshotPublished)
+            {
+                m_onSnapshotPublished(*this, snapshot);
+            }
+        }
+
+        void ShadowDocument::SetOnSnapshotPublished(OnSnapshotPublished &&onPublished) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_updateLock);
+            m_onSnapshotPublished = std::move(onPublished);
+            if (m_onSnapshotPublished)
+            {
+                m_onSnapshotPublished(*this, GetSnapshot());
+            }
+        }
+
+        std::shared_ptr<const ShadowDocument::Snapshot> ShadowDocument::GetSnapshot() const
+        {
+            return std::atomic_load(&m_snapshot);
+        }
+
+        void ShadowDocument::Apply(const GetShadowResponse &response)
+        {
+            std::lock_guard<std::mutex> lock(m_updateLock);
+            std::shared_ptr<Snapshot> next = BeginReplaceLocked(response.Version);
+            if (next)
+            {
+                s_replace(m_allocator, *next, response);
+                PublishLocked(std::move(next));
+            }
+        }
+
+        void ShadowDocument::Apply(const UpdateShadowResponse &response)
+        {
+            std::lock_guard<std::mutex> lock(m_updateLock);
+            std::shared_ptr<Snapshot> next = BeginUpdateLocked(response.Version);
+            if (!next)
+            {
+                return;
+            }
+
+            if (response.State.has_value())
+            {
+                s_patch(m_allocator, next->Desired, response.State->Desired);
+                s_patch(m_allocator, next->Reported, response.State->Reported);
+            }
+
+            if (response.Metadata.has_value())
+            {
+                s_patch(m_allocator, next->DesiredMetadata, response.Metadata->Desired);
+                s_patch(m_allocator, next->ReportedMetadata, response.Metadata->Reported);
+            }
+
+            if (response.Version.has_value())
+            {
+                next->Version = response.Version;
+            }
+            PublishLocked(std::move(next));
+        }
+
+        void ShadowDocument::Apply(const ShadowUpdatedEvent &event)
+        {
+            if (!event.Current.has_value())
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_updateLock);
+            std::shared_ptr<Snapshot> next = BeginReplaceLocked(event.Current->Version);
+            if (next)
+            {
+                s_replace(m_allocator, *next, *event.Current);
+                PublishLocked(std::move(next));
+            }
+        }
+
+        void ShadowDocument::Apply(const ShadowDeltaUpdatedEvent &event)
+        {
+            std::lock_guard<std::mutex> lock(m_updateLock);
+            std::shared_ptr<Snapshot> next = BeginUpdateLocked(event.Version);
+            if (!next)
+            {
+                return;
+            }
+
+            /* The delta carries the desired values that differ from reported. */
+            s_patch(m_allocator, next->Desired, event.State);
+            s_patch(m_allocator, next->DesiredMetadata, event.Metadata);
+
+            if (event.Version.has_value())
+            {
+                next->Version = event.Version;
+            }
+            PublishLocked(std::move(next));
+        }
+
+        void ShadowDocument::Clear()
+        {
+            std::lock_guard<std::mutex> lock(m_updateLock);
+            std::shared_ptr<Snapshot> next = Crt::MakeShared<Snapshot>(m_allocator);
+            if (next)
+            {
+                PublishLocked(std::move(next));
+            }
+        }
+
+        Crt::String ShadowDocument::EncodeSnapshot(
+            const Crt::String &thingName,
+            const Crt::Optional<Crt::String> &shadowName,
+            const Snapshot &snapshot)
+        {
+            Crt::JsonObject record;
+            record.WithString("thingName", thingName);
+            if (shadowName.has_value())
+            {
+                record.WithString("shadowName", *shadowName);
+            }
+            if (snapshot.Version.has_value())
+            {
+                record.WithInteger("version", *snapshot.Version);
+            }
+            s_withPair(record, "state", snapshot.Desired, snapshot.Reported);
+            s_withPair(record, "metadata", snapshot.DesiredMetadata, snapshot.ReportedMetadata);
+            return record.View().WriteCompact(true);
+        }
+
+        bool ShadowDocument::DecodeSnapshot(
+            const Crt::String &encoded,
+            Crt::String &thingName,
+            Crt::Optional<Crt::String> &shadowName,
+            Snapshot &snapshot,
+            Crt::Allocator *allocator)
+        {
+            Crt::JsonObject record(encoded);
+            Crt::JsonView view = record.View();
+            if (!record.WasParseSuccessful() || !view.ValueExists("thingName"))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            thingName = view.GetString("thingName");
+            shadowName = view.ValueExists("shadowName") ? Crt::Optional<Crt::String>(view.GetString("shadowName"))
+                                                        : Crt::Optional<Crt::String>();
+            s_replace(allocator, snapshot, GetShadowResponse(view));
+            return true;
+        }
+
+        bool ShadowDocument::Save(const char *path) const
+        {
+            Crt::String line = EncodeSnapshot(m_thingName, m_shadowName, *GetSnapshot());
+            line.push_back('\n');
+
+            std::lock_guard<std::mutex> lock(m_saveLock);
+            Crt::String tempPath(path);
+            tempPath.append(".tmp");
+            FILE *file = aws_fopen(tempPath.c_str(), "wb");
+            if (!file)
+            {
+                return false;
+            }
+
+            bool written = fwrite(line.data(), 1, line.size(), file) == line.size() && fflush(file) == 0;
+            written = fclose(file) == 0 && written;
+            if (!written)
+            {
+                remove(tempPath.c_str());
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+
+            /* Windows will not rename over an existing file. */
+            if (rename(tempPath.c_str(), path) != 0 && (remove(path) != 0 || rename(tempPath.c_str(), path) != 0))
+            {
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+            return true;
+        }
+
+        bool ShadowDocument::Restore(const char *path)
+        {
+            FILE *file = aws_fopen(path, "rb");
+            if (!file)
+            {
+                return false;
+            }
+
+            Crt::String contents;
+            char chunk[4096];
+            size_t read = 0;
+            while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+            {
+                contents.append(chunk, read);
+            }
+            fclose(file);
+
+            std::shared_ptr<Snapshot> next = Crt::MakeShared<Snapshot>(m_allocator);
+            Crt::String thingName;
+            Crt::Optional<Crt::String> shadowName;
+            if (!next || !DecodeSnapshot(contents, thingName, shadowName, *next, m_allocator))
+            {
+                return false;
+            }
+            bool sameShadow = shadowName.has_value() == m_shadowName.has_value() &&
+                              (!shadowName.has_value() || *shadowName == *m_shadowName);
+            if (thingName != m_thingName || !sameShadow)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+            next->Restored = true;
+
+            std::lock_guard<std::mutex> lock(m_updateLock);
+            std::shared_ptr<const Snapshot> current = GetSnapshot();
+            if (current->Version.has_value() && (!next->Version.has_value() || *next->Version <= *current->Version))
+            {
+                return true;
+            }
+
+            PublishLocked(std::move(next));
+            return true;
+        }
+
+        Crt::Optional<int32_t> ShadowDocument::GetVersion() const
+        {
+            return GetSnapshot()->Version;
+        }
+
+        Crt::Optional<Crt::JsonObject> ShadowDocument::GetDesired() const
+        {
+            return s_copy(GetSnapshot()->Desired);
+        }
+
+        Crt::Optional<Crt::JsonObject> ShadowDocument::GetReported() const
+        {
+            return s_copy(GetSnapshot()->Reported);
+        }
+
+        Crt::Optional<ShadowMetadata> ShadowDocument::GetMetadata() const
+        {
+            std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+            if (!snapshot->DesiredMetadata && !snapshot->ReportedMetadata)
+            {
+                return Crt::Optional<ShadowMetadata>();
+            }
+
+            ShadowMetadata metadata;
+            metadata.Desired = s_copy(snapshot->DesiredMetadata);
+            metadata.Reported = s_copy(snapshot->ReportedMetadata);
+            return Crt::Optional<ShadowMetadata>(std::move(metadata));
+        }
+
+        Crt::Optional<Crt::JsonObject> ShadowDocument::CreateMergePatch(
+            const Crt::JsonView &from,
+            const Crt::JsonView &to)
+        {
+            if (!to.IsObject())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return Crt::Optional<Crt::JsonObject>();
+            }
+
+            Crt::JsonObject patch;
+            if (!s_diff(from, to, patch))
+            {
+                return Crt::Optional<Crt::JsonObject>();
+            }
+
+            return Crt::Optional<Crt::JsonObject>(std::move(patch));
+        }
+
+        Crt::Optional<Crt::JsonObject> ShadowDocument::DiffDesired(const Crt::JsonView &desired) const
+        {
+            std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+            return CreateMergePatch(snapshot->Desired ? snapshot->Desired->View() : Crt::JsonView(), desired);
+        }
+
+        Crt::Optional<Crt::JsonObject> ShadowDocument::DiffReported(const Crt::JsonView &reported) const
+        {
+            std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+            return CreateMergePatch(snapshot->Reported ? snapshot->Reported->View() : Crt::JsonView(), reported);
+        }
+
+        Crt::Optional<Crt::JsonObject> ShadowDocument::GetDesiredValue(const Crt::String &key) const
+        {
+            std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+            if (!snapshot->Desired || !snapshot->Desired->View().ValueExists(key))
+            {
+                return Crt::Optional<Crt::JsonObject>();
+            }
+
+            return Crt::Optional<Crt::JsonObject>(snapshot->Desired->View().GetJsonObjectCopy(key));
+        }
+
+        Crt::Optional<Crt::JsonObject> ShadowDocument::GetReportedValue(const Crt::String &key) const
+        {
+            std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+            if (!snapshot->Reported || !snapshot->Reported->View().ValueExists(key))
+            {
+                return Crt::Optional<Crt::JsonObject>();
+            }
+
+            return Crt::Optional<Crt::JsonObject>(snapshot->Reported->View().GetJsonObjectCopy(key));
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -0,0 +1,336 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowDocumentCache.h>
+
+#include <aws/iotshadow/GetShadowResponse.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            /* What a parsed JSON node takes, before its key and string value. */
+            constexpr size_t s_nodeBytes = 64;
+
+            size_t s_jsonBytes(const Crt::JsonView &view)
+            {
+                size_t bytes = s_nodeBytes;
+                if (view.IsObject())
+                {
+                    for (const auto &member : view.GetAllObjects())
+                    {
+                        bytes += member.first.size() + 1 + s_jsonBytes(member.second);
+                    }
+                }
+                else if (view.IsListType())
+                {
+                    for (const Crt::JsonView &element : view.AsArray())
+                    {
+                        bytes += s_jsonBytes(element);
+                    }
+                }
+                else if (view.IsString())
+                {
+                    bytes += view.AsString().size() + 1;
+                }
+                return bytes;
+            }
+        } // namespace
+
+        ShadowDocumentCacheConfig::ShadowDocumentCacheConfig() noexcept
+            : MaxBytes(4 * 1024 * 1024), Qos(AWS_MQTT_QOS_AT_LEAST_ONCE)
+        {
+        }
+
+        ShadowDocumentCache::ShadowDocumentCache(
+            const std::shared_ptr<ShadowCorrelatorPool> &correlators,
+            const ShadowDocumentCacheConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_correlators(correlators), m_config(config), m_allocator(allocator), m_bytes(0), m_evictionCount(0)
+        {
+        }
+
+        std::shared_ptr<ShadowDocumentCache> ShadowDocumentCache::Create(
+            const std::shared_ptr<ShadowCorrelatorPool> &correlators,
+            const ShadowDocumentCacheConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (!correlators)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<ShadowDocumentCache *>(aws_mem_acquire(allocator, sizeof(ShadowDocumentCache)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ShadowDocumentCache(correlators, config, allocator);
+                return std::shared_ptr<ShadowDocumentCache>(
+                    toSeat, [allocator](ShadowDocumentCache *cache) { Crt::Delete(cache, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool ShadowDocumentCache::Get(const Crt::String &thingName, OnShadowDocumentFetched &&onFetched)
+        {
+            std::shared_ptr<ShadowDocument> cached;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto entry = m_entries.find(thingName);
+                if (entry != m_entries.end())
+                {
+                    m_recency.splice(m_recency.begin(), m_recency, entry->second.Recency);
+                    cached = entry->second.Document;
+                }
+                else
+                {
+                    auto fetch = m_fetches.find(thingName);
+                    if (fetch != m_fetches.end())
+                    {
+                        fetch->second.push_back(std::move(onFetched));
+                        return true;
+                    }
+                    m_fetches[thingName].push_back(std::move(onFetched));
+                }
+            }
+
+            if (cached)
+            {
+                onFetched(cached, nullptr, AWS_ERROR_SUCCESS);
+                return true;
+            }
+
+            std::shared_ptr<ShadowDocumentCache> self = shared_from_this();
+            Crt::Mqtt::QOS qos = m_config.Qos;
+            bool acquired = m_correlators->Acquire(
+                thingName,
+                [self, thingName, qos](const std::shared_ptr<ShadowRequestCorrelator> &correlator, int errorCode) {
+                    if (!correlator)
+                    {
+                        self->Fetched(thingName, nullptr, nullptr, errorCode);
+                        return;
+                    }
+
+                    /* The correlator joins gets already in flight, so a document is never fetched twice at once. */
+                    bool sent = correlator->GetShadowAsync(
+                        qos, [self, thingName](GetShadowResponse *response, ErrorResponse *error, int ioErr) {
+                            self->Fetched(thingName, response, error, ioErr);
+                        });
+                    if (!sent)
+                    {
+                        self->Fetched(thingName, nullptr, nullptr, aws_last_error());
+                    }
+                });
+            if (acquired)
+            {
+                return true;
+            }
+
+            /* The caller's get is first in line and is failed by the return value; any others joined since. */
+            int errorCode = aws_last_error();
+            Crt::Vector<OnShadowDocumentFetched> waiters;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto fetch = m_fetches.find(thingName);
+                if (fetch != m_fetches.end())
+                {
+                    waiters = std::move(fetch->second);
+                    m_fetches.erase(fetch);
+                }
+            }
+            for (size_t i = 1; i < waiters.size(); ++i)
+            {
+                waiters[i](nullptr, nullptr, errorCode);
+            }
+            aws_raise_error(errorCode);
+            return false;
+        }
+
+        void ShadowDocumentCache::Fetched(
+            const Crt::String &thingName,
+            GetShadowResponse *response,
+            ErrorResponse *error,
+            int ioErr)
+        {
+            std::shared_ptr<ShadowDocument> document;
+            std::shared_ptr<ShadowDocument> replaced;
+            if (response)
+            {
+                document = ShadowDocument::Create(thingName, m_allocator);
+                if (document)
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    Entry &entry = m_entries[thingName];
+                    if (entry.Document)
+                    {
+                        replaced = std::move(entry.Document);
+                        m_recency.erase(entry.Recency);
+                        m_bytes -= entry.Bytes;
+                        entry = Entry();
+                    }
+                    entry.Document = document;
+                    entry.Recency = m_recency.insert(m_recency.begin(), thingName);
+                }
+                else
+                {
+                    ioErr = aws_last_error();
+                }
+            }
+
+            if (document)
+            {
+                /* Outside the cache lock: the handler runs under the document's, and takes the cache's. */
+                std::weak_ptr<ShadowDocumentCache> weakSelf = shared_from_this();
+                document->SetOnSnapshotPublished(
+                    [weakSelf](
+                        const ShadowDocument &published,
+                        const std::shared_ptr<const ShadowDocument::Snapshot> &snapshot) {
+                        if (auto self = weakSelf.lock())
+                        {
+                            self->OnSnapshot(published, snapshot);
+                        }
+                    });
+                document->Apply(*response);
+            }
+
+            Crt::Vector<OnShadowDocumentFetched> waiters;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto fetch = m_fetches.find(thingName);
+                if (fetch != m_fetches.end())
+                {
+                    waiters = std::move(fetch->second);
+                    m_fetches.erase(fetch);
+                }
+            }
+
+            for (OnShadowDocumentFetched &waiter : waiters)
+            {
+                waiter(document, document ? nullptr : error, document ? AWS_ERROR_SUCCESS : ioErr);
+            }
+        }
+
+        void ShadowDocumentCache::OnSnapshot(
+            const ShadowDocument &document,
+            const std::shared_ptr<const ShadowDocument::Snapshot> &snapshot)
+        {
+            Crt::Vector<std::shared_ptr<ShadowDocument>> evicted;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto entry = m_entries.find(document.GetThingName());
+                /* A document evicted, or replaced by a later fetch, is no longer accounted for. */
+                if (!snapshot || entry == m_entries.end() || entry->second.Document.get() != &document)
+                {
+                    return;
+                }
+
+                Charge(entry->second, *snapshot);
+                EvictOverBudgetLocked(entry->first, evicted);
+            }
+        }
+
+        void ShadowDocumentCache::Charge(Entry &entry, const ShadowDocument::Snapshot &snapshot)
+        {
+            const Crt::JsonObject *objects[4] = {
+                snapshot.Desired.get(),
+                snapshot.Reported.get(),
+                snapshot.DesiredMetadata.get(),
+                snapshot.ReportedMetadata.get(),
+            };
+
+            size_t bytes = sizeof(ShadowDocument) + sizeof(ShadowDocument::Snapshot) + entry.Recency->size();
+            for (size_t i = 0; i < 4; ++i)
+            {
+                Part &part = entry.Parts[i];
+                /* Snapshots share the parts an update left alone, so only the replaced ones are walked. */
+                if (part.Object != objects[i])
+                {
+                    part.Object = objects[i];
+                    part.Bytes = objects[i] ? s_jsonBytes(objects[i]->View()) : 0;
+                }
+                bytes += part.Bytes;
+            }
+
+            m_bytes = m_bytes - entry.Bytes + bytes;
+            entry.Bytes = bytes;
+        }
+
+        void ShadowDocumentCache::EvictOverBudgetLocked(
+            const Crt::String &keep,
+            Crt::Vector<std::shared_ptr<ShadowDocument>> &evicted)
+        {
+            auto victim = m_recency.end();
+            while (m_bytes > m_config.MaxBytes && victim != m_recency.begin())
+            {
+                --victim;
+                if (*victim == keep)
+                {
+                    continue;
+                }
+
+                auto entry = m_entries.find(*victim);
+                m_bytes -= entry->second.Bytes;
+                evicted.push_back(std::move(entry->second.Document));
+                m_entries.erase(entry);
+                victim = m_recency.erase(victim);
+                ++m_evictionCount;
+            }
+        }
+
+        std::shared_ptr<ShadowDocument> ShadowDocumentCache::Find(const Crt::String &thingName)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto entry = m_entries.find(thingName);
+            if (entry == m_entries.end())
+            {
+                return nullptr;
+            }
+
+            m_recency.splice(m_recency.begin(), m_recency, entry->second.Recency);
+            return entry->second.Document;
+        }
+
+        bool ShadowDocumentCache::Evict(const Crt::String &thingName)
+        {
+            std::shared_ptr<ShadowDocument> evicted;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto entry = m_entries.find(thingName);
+                if (entry == m_entries.end())
+                {
+                    return false;
+                }
+
+                m_bytes -= entry->second.Bytes;
+                m_recency.erase(entry->second.Recency);
+                evicted = std::move(entry->second.Document);
+                m_entries.erase(entry);
+                ++m_evictionCount;
+            }
+            return true;
+        }
+
+        size_t ShadowDocumentCache::GetDocumentCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_entries.size();
+        }
+
+        size_t ShadowDocumentCache::GetByteCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_bytes;
+        }
+
+        uint64_t ShadowDocumentCache::GetEvictionCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_evictionCount;
+        }
+
+    } // namespace Iotshadow
+} // namespace Aws
@@ -0,0 +1,254 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowEventFanOut.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        ShadowEventFanOut::ShadowEventFanOut(const IotShadowClient &client, Crt::Allocator *allocator) noexcept
+            : m_client(client), m_allocator(allocator), m_nextListenerId(1)
+        {
+        }
+
+        std::shared_ptr<ShadowEventFanOut> ShadowEventFanOut::Create(
+            const IotShadowClient &client,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<ShadowEventFanOut *>(aws_mem_acquire(allocator, sizeof(ShadowEventFanOut)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ShadowEventFanOut(client, allocator);
+                return std::shared_ptr<ShadowEventFanOut>(
+                    toSeat, [allocator](ShadowEventFanOut *fanOut) { Crt::Delete(fanOut, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        uint64_t ShadowEventFanOut::AttachToShadowDeltaUpdatedEvents(
+            const ShadowDeltaUpdatedSubscriptionRequest &request,
+            Crt::Mqtt::QOS qos,
+            OnSharedShadowDeltaUpdated &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            if (!request.ThingName || !handler)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return 0;
+            }
+
+            Crt::String key("$aws/things/");
+            key.append(*request.ThingName).append("/shadow/update/delta");
+            return Attach(
+                key,
+                std::move(handler),
+                onSubAck,
+                [this, &request, qos](
+                    OnSubscribeToShadowDeltaUpdatedEventsResponse &&dispatch, const OnSubscribeComplete &onAck) {
+                    return m_client.SubscribeToShadowDeltaUpdatedEvents(request, qos, std::move(dispatch), onAck);
+                });
+        }
+
+        uint64_t ShadowEventFanOut::AttachToNamedShadowDeltaUpdatedEvents(
+            const NamedShadowDeltaUpdatedSubscriptionRequest &request,
+            Crt::Mqtt::QOS qos,
+            OnSharedShadowDeltaUpdated &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            if (!request.ThingName || !request.ShadowName || !handler)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return 0;
+            }
+
+            Crt::String key("$aws/things/");
+            key.append(*request.ThingName).append("/shadow/name/").append(*request.ShadowName).append("/update/delta");
+            return Attach(
+                key,
+                std::move(handler),
+                onSubAck,
+                [this, &request, qos](
+                    OnSubscribeToShadowDeltaUpdatedEventsResponse &&dispatch, const OnSubscribeComplete &onAck) {
+                    return m_client.SubscribeToNamedShadowDeltaUpdatedEvents(request, qos, std::move(dispatch), onAck);
+                });
+        }
+
+        uint64_t ShadowEventFanOut::Attach(
+            const Crt::String &key,
+            OnSharedShadowDeltaUpdated &&handler,
+            const OnSubscribeComplete &onSubAck,
+            const Subscribe &subscribe)
+        {
+            std::shared_ptr<DeltaFanOut> fanOut;
+            uint64_t listenerId = 0;
+            uint64_t fanOutId = 0;
+            bool subscribed = false;
+            bool isNew = false;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                auto subscription = m_subscriptions.find(key);
+                if (subscription == m_subscriptions.end())
+                {
+                    Subscription created;
+                    created.FanOut = Crt::MakeShared<DeltaFanOut>(m_allocator, m_allocator);
+                    if (!created.FanOut)
+                    {
+                        aws_raise_error(AWS_ERROR_OOM);
+                        return 0;
+                    }
+                    created.Acknowledged = false;
+                    subscription = m_subscriptions.emplace(key, std::move(created)).first;
+                    isNew = true;
+                }
+
+                fanOut = subscription->second.FanOut;
+                fanOutId = fanOut->Add(std::move(handler));
+                listenerId = m_nextListenerId++;
+                m_listeners[listenerId] = ListenerRef{key, fanOutId};
+
+                subscribed = subscription->second.Acknowledged;
+                if (!subscribed && !isNew && onSubAck)
+                {
+                    subscription->second.PendingAcks.push_back(onSubAck);
+                }
+            }
+
+            if (subscribed)
+            {
+                if (onSubAck)
+                {
+                    onSubAck(AWS_ERROR_SUCCESS);
+                }
+                return listenerId;
+            }
+
+            if (!isNew)
+            {
+                return listenerId;
+            }
+
+            /* The first listener's onSubAck runs before those of listeners that attached while it was pending. */
+            std::weak_ptr<ShadowEventFanOut> weakSelf = shared_from_this();
+            OnSubscribeComplete onAck = [weakSelf, key, fanOut, onSubAck](int errorCode) {
+                if (onSubAck)
+                {
+                    onSubAck(errorCode);
+                }
+                if (auto self = weakSelf.lock())
+                {
+                    self->OnSubAck(key, fanOut, errorCode);
+                }
+            };
+            bool issued = subscribe(
+                [fanOut](ShadowDeltaUpdatedEvent *event, int ioErr) { fanOut->Dispatch(event, ioErr); }, onAck);
+            if (!issued)
+            {
+                int errorCode = aws_last_error();
+                fanOut->Remove(fanOutId);
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    m_listeners.erase(listenerId);
+                }
+
+                /* Listeners that attached meanwhile learn of the failure as a failed SUBACK. */
+                fanOut->Dispatch(nullptr, errorCode);
+                OnSubAck(key, fanOut, errorCode);
+                aws_raise_error(errorCode);
+                return 0;
+            }
+
+            return listenerId;
+        }
+
+        void ShadowEventFanOut::OnSubAck(
+            const Crt::String &key,
+            const std::shared_ptr<DeltaFanOut> &fanOut,
+            int errorCode)
+        {
+            Crt::Vector<OnSubscribeComplete> pendingAcks;
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                auto subscription = m_subscriptions.find(key);
+                if (subscription == m_subscriptions.end() || subscription->second.FanOut != fanOut)
+                {
+                    return;
+                }
+
+                pendingAcks = std::move(subscription->second.PendingAcks);
+                subscription->second.PendingAcks.clear();
+                if (errorCode == AWS_ERROR_SUCCESS)
+                {
+                    subscription->second.Acknowledged = true;
+                }
+                else
+                {
+                    Forget(key, fanOut);
+                }
+            }
+
+            for (const auto &pendingAck : pendingAcks)
+            {
+                pendingAck(errorCode);
+            }
+        }
+
+        void ShadowEventFanOut::Forget(const Crt::String &key, const std::shared_ptr<DeltaFanOut> &fanOut)
+        {
+            m_subscriptions.erase(key);
+            for (auto listener = m_listeners.begin(); listener != m_listeners.end();)
+            {
+                if (listener->second.Key == key)
+                {
+                    fanOut->Remove(listener->second.FanOutId);
+                    listener = m_listeners.erase(listener);
+                }
+                else
+                {
+                    ++listener;
+                }
+            }
+        }
+
+        bool ShadowEventFanOut::Detach(uint64_t listenerId)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            auto listener = m_listeners.find(listenerId);
+            if (listener == m_listeners.end())
+            {
+                return false;
+            }
+
+            auto subscription = m_subscriptions.find(listener->second.Key);
+            if (subscription != m_subscriptions.end())
+            {
+                subscription->second.FanOut->Remove(listener->second.FanOutId);
+            }
+            m_listeners.erase(listener);
+            return true;
+        }
+
+        size_t ShadowEventFanOut::GetListenerCount(const Crt::String &thingName, const Crt::String &shadowName) const
+        {
+            Crt::String key("$aws/things/");
+            key.append(thingName);
+            if (!shadowName.empty())
+            {
+                key.append("/shadow/name/").append(shadowName).append("/update/delta");
+            }
+            else
+            {
+                key.append("/shadow/update/delta");
+            }
+
+            std::lock_guard<std::mutex> guard(m_lock);
+            auto subscription = m_subscriptions.find(key);
+            return subscription == m_subscriptions.end() ? 0 : subscription->second.FanOut->GetListenerCount();
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -8,12 +8,71 @@ namespace Aws
 {
     namespace Iotshadow
     {
+        namespace
+        {
+            /* A metadata leaf is an object whose "timestamp" member is a number; a state key named
+             * "timestamp" shows up as an object under that name instead. */
+            void s_flattenTimestamps(
+                const Aws::Crt::JsonView &node,
+                Aws::Crt::String &path,
+                Aws::Crt::Map<Aws::Crt::String, int64_t> &timestamps)
+            {
+                if (node.IsObject())
+                {
+                    if (node.ValueExists("timestamp") && node.GetJsonObject("timestamp").IsIntegerType())
+                    {
+                        timestamps[path] = node.GetInt64("timestamp");
+                        return;
+                    }
+
+                    for (const auto &member : node.GetAllObjects())
+                    {
+                        size_t length = path.size();
+                        path.append(".").append(member.first.c_str());
+                        s_flattenTimestamps(member.second, path, timestamps);
+                        path.resize(length);
+                    }
+                }
+                else if (node.IsListType())
+                {
+                    Aws::Crt::Vector<Aws::Crt::JsonView> elements = node.AsArray();
+                    for (size_t i = 0; i < elements.size(); ++i)
+                    {
+                        size_t length = path.size();
+                        path.append(".").append(std::to_string(i).c_str());
+                        s_flattenTimestamps(elements[i], path, timestamps);
+                        path.resize(length);
+                    }
+                }
+            }
+        } // namespace
 
-        void ShadowMetadata::LoadFromObject(ShadowMetadata &val, const Aws::Crt::JsonView &doc)
+        void ShadowMetadata::LoadFromObject(ShadowMetadata &val, const Aws::Crt::JsonView &doc, ShadowMetadataMode mode)
         {
             (void)val;
             (void)doc;
 
+            if (mode == ShadowMetadataMode::Skip)
+            {
+                return;
+            }
+
+            if (mode == ShadowMetadataMode::Compact)
+            {
+                Aws::Crt::Map<Aws::Crt::String, int64_t> timestamps;
+                Aws::Crt::String path;
+                for (const char *section : {"desired", "reported"})
+                {
+                    if (doc.ValueExists(section))
+                    {
+                        path = section;
+                        s_flattenTimestamps(doc.GetJsonObject(section), path, timestamps);
+                    }
+                }
+                val.Timestamps = std::move(timestamps);
+                return;
+            }
+
             if (doc.ValueExists("desired"))
             {
                 val.Desired = doc.GetJsonObjectCopy("desired");
@@ -40,7 +99,15 @@ namespace Aws
             }
         }
 
-        ShadowMetadata::ShadowMetadata(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
+        ShadowMetadata::ShadowMetadata(const Crt::JsonView &doc)
+        {
+            LoadFromObject(*this, doc, ShadowMetadataMode::Full);
+        }
+
+        ShadowMetadata::ShadowMetadata(const Crt::JsonView &doc, ShadowMetadataMode mode)
+        {
+            LoadFromObject(*this, doc, mode);
+        }
 
         ShadowMetadata &ShadowMetadata::operator=(const Crt::JsonView &doc)
         {
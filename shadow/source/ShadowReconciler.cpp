@@ -0,0 +1,348 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowReconciler.h>
+
+#include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowState.h>
+#include <aws/iotshadow/UpdateNamedShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+
+#include <aws/common/clock.h>
+#include <aws/io/event_loop.h>
+
+#include <algorithm>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            struct SettleTask
+            {
+                aws_task Task;
+                std::weak_ptr<ShadowReconciler> Owner;
+                Crt::Allocator *Allocator;
+            };
+
+            uint64_t s_millisToNanos(uint32_t millis)
+            {
+                return aws_timestamp_convert(millis, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+            }
+        } // namespace
+
+        ShadowReconcilerConfig::ShadowReconcilerConfig() noexcept
+            : DebounceMs(250), MaxDelayMs(2000), Qos(AWS_MQTT_QOS_AT_LEAST_ONCE)
+        {
+        }
+
+        ShadowReconciler::ShadowReconciler(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const Crt::Optional<Crt::String> &shadowName,
+            const ShadowReconcilerConfig &config,
+            const OnReconcileDesired &onReconcile,
+            Crt::Allocator *allocator) noexcept
+            : m_client(client), m_thingName(thingName), m_shadowName(shadowName), m_config(config),
+              m_onReconcile(onReconcile), m_allocator(allocator),
+              m_eventLoop(aws_event_loop_group_get_next_loop(eventLoopGroup.GetUnderlyingHandle())),
+              m_settleScheduled(false), m_supersededCount(0), m_appliedCount(0)
+        {
+        }
+
+        std::shared_ptr<ShadowReconciler> ShadowReconciler::Create(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const ShadowReconcilerConfig &config,
+            const OnReconcileDesired &onReconcile,
+            Crt::Allocator *allocator)
+        {
+            return s_create(
+                client, eventLoopGroup, thingName, Crt::Optional<Crt::String>(), config, onReconcile, allocator);
+        }
+
+        std::shared_ptr<ShadowReconciler> ShadowReconciler::CreateNamed(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const Crt::String &shadowName,
+            const ShadowReconcilerConfig &config,
+            const OnReconcileDesired &onReconcile,
+            Crt::Allocator *allocator)
+        {
+            return s_create(
+                client,
+                eventLoopGroup,
+                thingName,
+                Crt::Optional<Crt::String>(shadowName),
+                config,
+                onReconcile,
+                allocator);
+        }
+
+        std::shared_ptr<ShadowReconciler> ShadowReconciler::s_create(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const Crt::Optional<Crt::String> &shadowName,
+            const ShadowReconcilerConfig &config,
+            const OnReconcileDesired &onReconcile,
+            Crt::Allocator *allocator)
+        {
+            if (!onReconcile)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<ShadowReconciler *>(aws_mem_acquire(allocator, sizeof(ShadowReconciler)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat)
+                    ShadowReconciler(client, eventLoopGroup, thingName, shadowName, config, onReconcile, allocator);
+                return std::shared_ptr<ShadowReconciler>(
+                    toSeat, [allocator](ShadowReconciler *reconciler) { Crt::Delete(reconciler, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool ShadowReconciler::Subscribe(const OnSubscribeComplete &onSubAck)
+        {
+            std::weak_ptr<ShadowReconciler> weakReconciler = shared_from_this();
+            auto onDelta = [weakReconciler](ShadowDeltaUpdatedEvent *event, int ioErr) {
+                auto reconciler = weakReconciler.lock();
+                if (reconciler && event && ioErr == AWS_ERROR_SUCCESS)
+                {
+                    reconciler->Apply(*event);
+                }
+            };
+
+            if (m_shadowName.has_value())
+            {
+                NamedShadowDeltaUpdatedSubscriptionRequest request;
+                request.ThingName = m_thingName;
+                request.ShadowName = *m_shadowName;
+                return m_client.SubscribeToNamedShadowDeltaUpdatedEvents(request, m_config.Qos, onDelta, onSubAck);
+            }
+
+            ShadowDeltaUpdatedSubscriptionRequest request;
+            request.ThingName = m_thingName;
+            return m_client.SubscribeToShadowDeltaUpdatedEvents(request, m_config.Qos, onDelta, onSubAck);
+        }
+
+        void ShadowReconciler::Apply(const ShadowDeltaUpdatedEvent &event)
+        {
+            if (!event.State.has_value())
+            {
+                return;
+            }
+
+            bool scheduleSettle = false;
+            uint64_t deadline = UINT64_MAX;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                /* Redelivered or reordered deltas would bring back values already superseded. */
+                if (event.Version.has_value() && m_version.has_value() && *event.Version <= *m_version)
+                {
+                    return;
+                }
+                if (event.Version.has_value())
+                {
+                    m_version = event.Version;
+                }
+
+                uint64_t now = 0;
+                aws_event_loop_current_clock_time(m_eventLoop, &now);
+                for (const auto &entry : event.State->View().GetAllObjects())
+                {
+                    Crt::JsonObject value = entry.second.Materialize();
+                    auto pending = m_pending.find(entry.first);
+                    if (pending == m_pending.end())
+                    {
+                        PendingKey key;
+                        key.FirstChangeNs = now;
+                        pending = m_pending.emplace(entry.first, std::move(key)).first;
+                    }
+                    else if (value == pending->second.Value)
+                    {
+                        /* Each delta repeats every key still unreported; only a new value restarts the wait. */
+                        continue;
+                    }
+                    else
+                    {
+                        ++m_supersededCount;
+                    }
+
+                    pending->second.Value = std::move(value);
+                    pending->second.DeadlineNs = now + s_millisToNanos(m_config.DebounceMs);
+                    if (m_config.MaxDelayMs != 0)
+                    {
+                        pending->second.DeadlineNs = std::min(
+                            pending->second.DeadlineNs,
+                            pending->second.FirstChangeNs + s_millisToNanos(m_config.MaxDelayMs));
+                    }
+                    deadline = std::min(deadline, pending->second.DeadlineNs);
+                }
+
+                /*
+                 * A check already scheduled is due no later than any deadline set now, since those only move
+                 * forward; otherwise the keys just queued are the only ones pending.
+                 */
+                if (!m_pending.empty() && !m_settleScheduled)
+                {
+                    m_settleScheduled = true;
+                    scheduleSettle = true;
+                }
+            }
+
+            if (scheduleSettle)
+            {
+                ScheduleSettle(deadline);
+            }
+        }
+
+        void ShadowReconciler::Flush()
+        {
+            Settle(true);
+        }
+
+        void ShadowReconciler::Settle(bool all)
+        {
+            Crt::JsonObject settled;
+            bool anySettled = false;
+            bool scheduleSettle = false;
+            uint64_t nextDeadline = UINT64_MAX;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                uint64_t now = 0;
+                aws_event_loop_current_clock_time(m_eventLoop, &now);
+                for (auto iter = m_pending.begin(); iter != m_pending.end();)
+                {
+                    if (all || iter->second.DeadlineNs <= now)
+                    {
+                        settled.WithObject(iter->first, std::move(iter->second.Value));
+                        anySettled = true;
+                        iter = m_pending.erase(iter);
+                    }
+                    else
+                    {
+                        nextDeadline = std::min(nextDeadline, iter->second.DeadlineNs);
+                        ++iter;
+                    }
+                }
+
+                if (!m_pending.empty() && !m_settleScheduled)
+                {
+                    m_settleScheduled = true;
+                    scheduleSettle = true;
+                }
+            }
+
+            if (scheduleSettle)
+            {
+                ScheduleSettle(nextDeadline);
+            }
+
+            if (!anySettled)
+            {
+                return;
+            }
+
+            ++m_appliedCount;
+            Crt::JsonObject reported(settled);
+            if (m_onReconcile(settled.View(), reported))
+            {
+                Report(std::move(reported));
+            }
+        }
+
+        void ShadowReconciler::Report(Crt::JsonObject &&reported)
+        {
+            if (!reported.View().IsObject() || reported.View().GetAllObjects().empty())
+            {
+                return;
+            }
+
+            OnPublishComplete onPubAck = m_config.OnReported;
+            auto onReported = [onPubAck](int ioErr) {
+                if (onPubAck)
+                {
+                    onPubAck(ioErr);
+                }
+            };
+
+            ShadowState state;
+            state.Reported = std::move(reported);
+
+            bool published = false;
+            if (m_shadowName.has_value())
+            {
+                UpdateNamedShadowRequest request;
+                request.ThingName = m_thingName;
+                request.ShadowName = *m_shadowName;
+                request.State = std::move(state);
+                published = m_client.PublishUpdateNamedShadow(request, m_config.Qos, onReported);
+            }
+            else
+            {
+                UpdateShadowRequest request;
+                request.ThingName = m_thingName;
+                request.State = std::move(state);
+                published = m_client.PublishUpdateShadow(request, m_config.Qos, onReported);
+            }
+
+            if (!published)
+            {
+                onReported(Crt::LastErrorOrUnknown());
+            }
+        }
+
+        void ShadowReconciler::ScheduleSettle(uint64_t deadlineNs)
+        {
+            auto *settleTask = Crt::New<SettleTask>(m_allocator);
+            if (!settleTask)
+            {
+                /* Without a timer nothing would ever settle, so apply what is pending now. */
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_settleScheduled = false;
+                }
+                Flush();
+                return;
+            }
+
+            settleTask->Owner = shared_from_this();
+            settleTask->Allocator = m_allocator;
+            aws_task_init(&settleTask->Task, s_onSettleTask, settleTask, "ShadowReconcilerSettle");
+            aws_event_loop_schedule_task_future(m_eventLoop, &settleTask->Task, deadlineNs);
+        }
+
+        void ShadowReconciler::s_onSettleTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *settleTask = static_cast<SettleTask *>(arg);
+            if (status == AWS_TASK_STATUS_RUN_READY)
+            {
+                auto owner = settleTask->Owner.lock();
+                if (owner)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(owner->m_lock);
+                        owner->m_settleScheduled = false;
+                    }
+                    owner->Settle(false);
+                }
+            }
+
+            Crt::Delete(settleTask, settleTask->Allocator);
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
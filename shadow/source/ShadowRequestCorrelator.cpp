@@ -0,0 +1,906 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowRequestCorrelator.h>
+
+#include <aws/iotshadow/DeleteNamedShadowRequest.h>
+#include <aws/iotshadow/DeleteNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/DeleteShadowRequest.h>
+#include <aws/iotshadow/DeleteShadowResponse.h>
+#include <aws/iotshadow/DeleteShadowSubscriptionRequest.h>
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/GetNamedShadowRequest.h>
+#include <aws/iotshadow/GetNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/GetShadowRequest.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/GetShadowSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowResponse.h>
+#include <aws/iotshadow/UpdateShadowSubscriptionRequest.h>
+
+#include <aws/iotdevicecommon/ClientToken.h>
+#include <aws/iotdevicecommon/SubscriptionHandle.h>
+
+#include <aws/common/clock.h>
+#include <aws/io/event_loop.h>
+#include <aws/mqtt/mqtt.h>
+
+#include <atomic>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            struct SubscribeContext
+            {
+                SubscribeContext(const OnSubscribeComplete &onSubAck, int remaining)
+                    : OnSubAck(onSubAck), Remaining(remaining), FirstError(AWS_ERROR_SUCCESS)
+                {
+                }
+
+                std::mutex Lock;
+                OnSubscribeComplete OnSubAck;
+                int Remaining;
+                int FirstError;
+            };
+
+            /*
+             * Takes a pending-request slot from `budget` for a request completing through `onComplete`,
+             * which is rewrapped to hold the slot so that dropping the pending entry gives it back.
+             */
+            template <typename Response>
+            bool s_holdRequestSlot(
+                const std::shared_ptr<Iotdevicecommon::MemoryBudget> &budget,
+                std::function<void(Response *, ErrorResponse *, int)> &onComplete)
+            {
+                Iotdevicecommon::MemoryBudget::Slot slot;
+                if (!Iotdevicecommon::AcquireRequestSlot(budget, slot))
+                {
+                    return false;
+                }
+
+                if (slot)
+                {
+                    auto inner = std::move(onComplete);
+                    onComplete = [inner, slot](Response *response, ErrorResponse *error, int ioErr) {
+                        if (inner)
+                        {
+                            inner(response, error, ioErr);
+                        }
+                    };
+                }
+                return true;
+            }
+
+            template <typename Callback> void s_cancel(Crt::Map<Crt::String, Callback> &pending, int errorCode)
+            {
+                for (auto &entry : pending)
+                {
+                    if (entry.second)
+                    {
+                        entry.second(nullptr, nullptr, errorCode);
+                    }
+                }
+            }
+
+            /* The code the shadow service rejects an update with when its version is not the current one. */
+            static const int32_t s_versionConflictCode = 409;
+        } // namespace
+
+        /*
+         * A request's timeout on the event loop. Referenced by its scheduled run and, once a completion claims it
+         * from m_timeoutTasks, by the cancellation that takes it off the loop.
+         */
+        struct ShadowRequestCorrelator::TimeoutTask
+        {
+            void Release()
+            {
+                if (--References == 0)
+                {
+                    Crt::Delete(this, Allocator);
+                }
+            }
+
+            aws_task Task;
+            aws_task CancelTask;
+            aws_event_loop *EventLoop;
+            std::weak_ptr<ShadowRequestCorrelator> Owner;
+            Crt::String ClientToken;
+            Crt::Allocator *Allocator;
+            std::atomic<int> References;
+            /* Whether Task has run or been cancelled. Only touched on the event loop. */
+            bool Done;
+        };
+
+        struct ShadowRequestCorrelator::VersionedUpdate
+        {
+            ShadowState State;
+            uint32_t AttemptsLeft;
+            Crt::Mqtt::QOS Qos;
+            OnUpdateShadowComplete OnComplete;
+            OnShadowVersionConflict OnConflict;
+        };
+
+        ShadowRequestCorrelatorConfig::ShadowRequestCorrelatorConfig() noexcept : RequestTimeoutMs(30000), Timers() {}
+
+        ShadowRequestCorrelator::ShadowRequestCorrelator(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const Crt::Optional<Crt::String> &shadowName,
+            const ShadowRequestCorrelatorConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_client(client), m_thingName(thingName), m_shadowName(shadowName), m_config(config),
+              m_allocator(allocator),
+              m_eventLoop(aws_event_loop_group_get_next_loop(eventLoopGroup.GetUnderlyingHandle()))
+        {
+        }
+
+        std::shared_ptr<ShadowRequestCorrelator> ShadowRequestCorrelator::Create(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const ShadowRequestCorrelatorConfig &config,
+            Crt::Allocator *allocator)
+        {
+            return s_create(client, eventLoopGroup, thingName, Crt::Optional<Crt::String>(), config, allocator);
+        }
+
+        std::shared_ptr<ShadowRequestCorrelator> ShadowRequestCorrelator::CreateNamed(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const Crt::String &shadowName,
+            const ShadowRequestCorrelatorConfig &config,
+            Crt::Allocator *allocator)
+        {
+            return s_create(
+                client, eventLoopGroup, thingName, Crt::Optional<Crt::String>(shadowName), config, allocator);
+        }
+
+        std::shared_ptr<ShadowRequestCorrelator> ShadowRequestCorrelator::s_create(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const Crt::Optional<Crt::String> &shadowName,
+            const ShadowRequestCorrelatorConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat =
+                static_cast<ShadowRequestCorrelator *>(aws_mem_acquire(allocator, sizeof(ShadowRequestCorrelator)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat)
+                    ShadowRequestCorrelator(client, eventLoopGroup, thingName, shadowName, config, allocator);
+                return std::shared_ptr<ShadowRequestCorrelator>(
+                    toSeat, [allocator](ShadowRequestCorrelator *correlator) { Crt::Delete(correlator, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool ShadowRequestCorrelator::Subscribe(Crt::Mqtt::QOS qos, const OnSubscribeComplete &onSubAck)
+        {
+            auto context = Crt::MakeShared<SubscribeContext>(m_allocator, onSubAck, 6);
+            if (!context)
+            {
+                return false;
+            }
+
+            auto onEachSubAck = [context](int ioErr) {
+                OnSubscribeComplete onAllSubAcked;
+                int result = AWS_ERROR_SUCCESS;
+                {
+                    std::lock_guard<std::mutex> lock(context->Lock);
+                    if (ioErr != AWS_ERROR_SUCCESS && context->FirstError == AWS_ERROR_SUCCESS)
+                    {
+                        context->FirstError = ioErr;
+                    }
+                    if (--context->Remaining == 0)
+                    {
+                        onAllSubAcked = context->OnSubAck;
+                        result = context->FirstError;
+                    }
+                }
+
+                if (onAllSubAcked)
+                {
+                    onAllSubAcked(result);
+                }
+            };
+
+            std::weak_ptr<ShadowRequestCorrelator> weakCorrelator = shared_from_this();
+
+            auto onGetAccepted = [weakCorrelator](GetShadowResponse *response, int) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && response && response->ClientToken.has_value())
+                {
+                    correlator->Complete<GetShadowResponse>(
+                        correlator->m_pendingGets,
+                        *response->ClientToken,
+                        response,
+                        nullptr,
+                        AWS_ERROR_SUCCESS);
+                }
+            };
+            auto onGetRejected = [weakCorrelator](ErrorResponse *error, int) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && error && error->ClientToken.has_value())
+                {
+                    correlator->Complete<GetShadowResponse>(
+                        correlator->m_pendingGets,
+                        *error->ClientToken,
+                        nullptr,
+                        error,
+                        AWS_ERROR_SUCCESS);
+                }
+            };
+
+            auto onUpdateAccepted = [weakCorrelator](UpdateShadowResponse *response, int) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && response && response->ClientToken.has_value())
+                {
+                    correlator->Complete<UpdateShadowResponse>(
+                        correlator->m_pendingUpdates,
+                        *response->ClientToken,
+                        response,
+                        nullptr,
+                        AWS_ERROR_SUCCESS);
+                }
+            };
+            auto onUpdateRejected = [weakCorrelator](ErrorResponse *error, int) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && error && error->ClientToken.has_value())
+                {
+                    correlator->Complete<UpdateShadowResponse>(
+                        correlator->m_pendingUpdates,
+                        *error->ClientToken,
+                        nullptr,
+                        error,
+                        AWS_ERROR_SUCCESS);
+                }
+            };
+
+            auto onDeleteAccepted = [weakCorrelator](DeleteShadowResponse *response, int) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && response && response->ClientToken.has_value())
+                {
+                    correlator->Complete<DeleteShadowResponse>(
+                        correlator->m_pendingDeletes,
+                        *response->ClientToken,
+                        response,
+                        nullptr,
+                        AWS_ERROR_SUCCESS);
+                }
+            };
+            auto onDeleteRejected = [weakCorrelator](ErrorResponse *error, int) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && error && error->ClientToken.has_value())
+                {
+                    correlator->Complete<DeleteShadowResponse>(
+                        correlator->m_pendingDeletes,
+                        *error->ClientToken,
+                        nullptr,
+                        error,
+                        AWS_ERROR_SUCCESS);
+                }
+            };
+
+            /* Captured, so the topics already subscribed can be dropped again if a later one fails. */
+            Iotdevicecommon::SubscriptionHandle *outer = Iotdevicecommon::SubscriptionHandle::Current();
+            Iotdevicecommon::SubscriptionHandle subscriptions;
+            bool subscribed = false;
+            {
+                Iotdevicecommon::SubscriptionHandle::Capture capture(subscriptions);
+                if (m_shadowName.has_value())
+                {
+                    GetNamedShadowSubscriptionRequest getRequest;
+                    getRequest.ThingName = m_thingName;
+                    getRequest.ShadowName = *m_shadowName;
+
+                    UpdateNamedShadowSubscriptionRequest updateRequest;
+                    updateRequest.ThingName = m_thingName;
+                    updateRequest.ShadowName = *m_shadowName;
+
+                    DeleteNamedShadowSubscriptionRequest deleteRequest;
+                    deleteRequest.ThingName = m_thingName;
+                    deleteRequest.ShadowName = *m_shadowName;
+
+                    subscribed =
+                        m_client.SubscribeToGetNamedShadowAccepted(getRequest, qos, onGetAccepted, onEachSubAck) &&
+                        m_client.SubscribeToGetNamedShadowRejected(getRequest, qos, onGetRejected, onEachSubAck) &&
+                        m_client.SubscribeToUpdateNamedShadowAccepted(
+                            updateRequest, qos, onUpdateAccepted, onEachSubAck) &&
+                        m_client.SubscribeToUpdateNamedShadowRejected(
+                            updateRequest, qos, onUpdateRejected, onEachSubAck) &&
+                        m_client.SubscribeToDeleteNamedShadowAccepted(
+                            deleteRequest, qos, onDeleteAccepted, onEachSubAck) &&
+                        m_client.SubscribeToDeleteNamedShadowRejected(
+                            deleteRequest, qos, onDeleteRejected, onEachSubAck);
+                }
+                else
+                {
+                    GetShadowSubscriptionRequest getRequest;
+                    getRequest.ThingName = m_thingName;
+
+                    UpdateShadowSubscriptionRequest updateRequest;
+                    updateRequest.ThingName = m_thingName;
+
+                    DeleteShadowSubscriptionRequest deleteRequest;
+                    deleteRequest.ThingName = m_thingName;
+
+                    subscribed =
+                        m_client.SubscribeToGetShadowAccepted(getRequest, qos, onGetAccepted, onEachSubAck) &&
+                        m_client.SubscribeToGetShadowRejected(getRequest, qos, onGetRejected, onEachSubAck) &&
+                        m_client.SubscribeToUpdateShadowAccepted(updateRequest, qos, onUpdateAccepted, onEachSubAck) &&
+                        m_client.SubscribeToUpdateShadowRejected(updateRequest, qos, onUpdateRejected, onEachSubAck) &&
+                        m_client.SubscribeToDeleteShadowAccepted(deleteRequest, qos, onDeleteAccepted, onEachSubAck) &&
+                        m_client.SubscribeToDeleteShadowRejected(deleteRequest, qos, onDeleteRejected, onEachSubAck);
+                }
+            }
+
+            if (subscribed)
+            {
+                if (outer)
+                {
+                    subscriptions.MoveTo(*outer);
+                }
+                else
+                {
+                    subscriptions.Release();
+                }
+                return true;
+            }
+
+            /* The acks of the topics that did go out never add up to six now, so the failure is reported here. */
+            int errorCode = aws_last_error() != AWS_ERROR_SUCCESS ? aws_last_error() : AWS_ERROR_UNKNOWN;
+            subscriptions.Unsubscribe();
+            OnSubscribeComplete onFailed;
+            {
+                std::lock_guard<std::mutex> lock(context->Lock);
+                onFailed = std::move(context->OnSubAck);
+                context->OnSubAck = nullptr;
+            }
+            if (onFailed)
+            {
+                onFailed(errorCode);
+            }
+            aws_raise_error(errorCode);
+            return false;
+        }
+
+        bool ShadowRequestCorrelator::GetShadowAsync(Crt::Mqtt::QOS qos, const OnGetShadowComplete &onComplete)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_sharedGetToken.empty() && m_pendingGets.find(m_sharedGetToken) != m_pendingGets.end())
+                {
+                    m_getWaiters.push_back(onComplete);
+                    return true;
+                }
+            }
+
+            return PublishGet(qos, onComplete);
+        }
+
+        bool ShadowRequestCorrelator::PublishGet(Crt::Mqtt::QOS qos, const OnGetShadowComplete &onComplete)
+        {
+            Crt::String clientToken = Iotdevicecommon::GenerateClientToken();
+            std::weak_ptr<ShadowRequestCorrelator> weakCorrelator = shared_from_this();
+            OnGetShadowComplete pendingComplete = [weakCorrelator, clientToken, onComplete](
+                                                      GetShadowResponse *response, ErrorResponse *error, int ioErr) {
+                Crt::Vector<OnGetShadowComplete> waiters;
+                if (auto correlator = weakCorrelator.lock())
+                {
+                    std::lock_guard<std::mutex> lock(correlator->m_lock);
+                    if (correlator->m_sharedGetToken == clientToken)
+                    {
+                        waiters.swap(correlator->m_getWaiters);
+                        correlator->m_sharedGetToken.clear();
+                    }
+                }
+
+                /* Each waiter gets copies to keep, taken before the sender may modify the response. */
+                for (const OnGetShadowComplete &waiter : waiters)
+                {
+                    if (!waiter)
+                    {
+                        continue;
+                    }
+                    Crt::Optional<GetShadowResponse> responseCopy;
+                    Crt::Optional<ErrorResponse> errorCopy;
+                    if (response)
+                    {
+                        responseCopy = *response;
+                    }
+                    if (error)
+                    {
+                        errorCopy = *error;
+                    }
+                    waiter(responseCopy ? &*responseCopy : nullptr, errorCopy ? &*errorCopy : nullptr, ioErr);
+                }
+                if (onComplete)
+                {
+                    onComplete(response, error, ioErr);
+                }
+            };
+
+            if (!s_holdRequestSlot<GetShadowResponse>(m_client.GetMemoryBudget(), pendingComplete))
+            {
+                return false;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_pendingGets.emplace(clientToken, std::move(pendingComplete));
+            }
+
+            auto onPubAck = [weakCorrelator, clientToken](int ioErr) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && ioErr != AWS_ERROR_SUCCESS)
+                {
+                    correlator->Complete<GetShadowResponse>(
+                        correlator->m_pendingGets, clientToken, nullptr, nullptr, ioErr);
+                }
+            };
+
+            bool published = false;
+            if (m_shadowName.has_value())
+            {
+                GetNamedShadowRequest request;
+                request.ThingName = m_thingName;
+                request.ShadowName = *m_shadowName;
+                request.ClientToken = clientToken;
+                published = m_client.PublishGetNamedShadow(request, qos, onPubAck);
+            }
+            else
+            {
+                GetShadowRequest request;
+                request.ThingName = m_thingName;
+                request.ClientToken = clientToken;
+                published = m_client.PublishGetShadow(request, qos, onPubAck);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!published)
+                {
+                    m_pendingGets.erase(clientToken);
+                    return false;
+                }
+                if (m_pendingGets.find(clientToken) == m_pendingGets.end())
+                {
+                    return true;
+                }
+                /* Shared only once published, so no get can join one that is never sent. */
+                m_sharedGetToken = clientToken;
+            }
+
+            ScheduleTimeout(clientToken);
+            return true;
+        }
+
+        bool ShadowRequestCorrelator::UpdateShadowAsync(
+            const ShadowState &state,
+            const Crt::Optional<int32_t> &version,
+            Crt::Mqtt::QOS qos,
+            const OnUpdateShadowComplete &onComplete)
+        {
+            OnUpdateShadowComplete pendingComplete(onComplete);
+            if (!s_holdRequestSlot<UpdateShadowResponse>(m_client.GetMemoryBudget(), pendingComplete))
+            {
+                return false;
+            }
+
+            Crt::String clientToken = Iotdevicecommon::GenerateClientToken();
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_pendingUpdates.emplace(clientToken, std::move(pendingComplete));
+            }
+
+            std::weak_ptr<ShadowRequestCorrelator> weakCorrelator = shared_from_this();
+            auto onPubAck = [weakCorrelator, clientToken](int ioErr) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && ioErr != AWS_ERROR_SUCCESS)
+                {
+                    correlator->Complete<UpdateShadowResponse>(
+                        correlator->m_pendingUpdates, clientToken, nullptr, nullptr, ioErr);
+                }
+            };
+
+            bool published = false;
+            if (m_shadowName.has_value())
+            {
+                UpdateNamedShadowRequest request;
+                request.ThingName = m_thingName;
+                request.ShadowName = *m_shadowName;
+                request.ClientToken = clientToken;
+                request.State = state;
+                if (version.has_value())
+                {
+                    request.Version = *version;
+                }
+                published = m_client.PublishUpdateNamedShadow(request, qos, onPubAck);
+            }
+            else
+            {
+                UpdateShadowRequest request;
+                request.ThingName = m_thingName;
+                request.ClientToken = clientToken;
+                request.State = state;
+                if (version.has_value())
+                {
+                    request.Version = *version;
+                }
+                published = m_client.PublishUpdateShadow(request, qos, onPubAck);
+            }
+
+            if (!published)
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_pendingUpdates.erase(clientToken);
+                return false;
+            }
+
+            ScheduleTimeout(clientToken);
+            return true;
+        }
+
+        bool ShadowRequestCorrelator::UpdateShadowWithRetryAsync(
+            const ShadowState &state,
+            int32_t version,
+            uint32_t maxAttempts,
+            Crt::Mqtt::QOS qos,
+            const OnUpdateShadowComplete &onComplete,
+            const OnShadowVersionConflict &onConflict)
+        {
+            auto update = Crt::MakeShared<VersionedUpdate>(m_allocator);
+            if (!update)
+            {
+                return false;
+            }
+
+            update->State = state;
+            update->AttemptsLeft = maxAttempts ? maxAttempts : 1;
+            update->Qos = qos;
+            update->OnComplete = onComplete;
+            update->OnConflict = onConflict;
+            return AttemptUpdate(update, version);
+        }
+
+        bool ShadowRequestCorrelator::AttemptUpdate(const std::shared_ptr<VersionedUpdate> &update, int32_t version)
+        {
+            --update->AttemptsLeft;
+
+            std::weak_ptr<ShadowRequestCorrelator> weakCorrelator = shared_from_this();
+            auto onAttemptComplete =
+                [weakCorrelator, update](UpdateShadowResponse *response, ErrorResponse *error, int ioErr) {
+                    auto correlator = weakCorrelator.lock();
+                    if (correlator && error && error->Code.has_value() && *error->Code == s_versionConflictCode &&
+                        update->AttemptsLeft > 0)
+                    {
+                        correlator->ResolveConflict(update, *error);
+                        return;
+                    }
+
+                    if (update->OnComplete)
+                    {
+                        update->OnComplete(response, error, ioErr);
+                    }
+                };
+
+            return UpdateShadowAsync(update->State, version, update->Qos, onAttemptComplete);
+        }
+
+        void ShadowRequestCorrelator::ResolveConflict(
+            const std::shared_ptr<VersionedUpdate> &update,
+            const ErrorResponse &conflict)
+        {
+            std::weak_ptr<ShadowRequestCorrelator> weakCorrelator = shared_from_this();
+            auto onCurrent = [weakCorrelator, update, conflict](GetShadowResponse *current, ErrorResponse *, int) {
+                ErrorResponse rejection(conflict);
+                auto correlator = weakCorrelator.lock();
+                if (!correlator || !current || !current->Version.has_value() ||
+                    (update->OnConflict && !update->OnConflict(*current, update->State)))
+                {
+                    /* Without the current version there is nothing to retry with; report the conflict. */
+                    if (update->OnComplete)
+                    {
+                        update->OnComplete(nullptr, &rejection, AWS_ERROR_SUCCESS);
+                    }
+                    return;
+                }
+
+                if (!correlator->AttemptUpdate(update, *current->Version) && update->OnComplete)
+                {
+                    update->OnComplete(nullptr, nullptr, Crt::LastErrorOrUnknown());
+                }
+            };
+
+            /* Not shared: a get already in flight may have been answered before the conflicting update. */
+            if (!PublishGet(update->Qos, onCurrent) && update->OnComplete)
+            {
+                ErrorResponse rejection(conflict);
+                update->OnComplete(nullptr, &rejection, AWS_ERROR_SUCCESS);
+            }
+        }
+
+        bool ShadowRequestCorrelator::DeleteShadowAsync(Crt::Mqtt::QOS qos, const OnDeleteShadowComplete &onComplete)
+        {
+            OnDeleteShadowComplete pendingComplete(onComplete);
+            if (!s_holdRequestSlot<DeleteShadowResponse>(m_client.GetMemoryBudget(), pendingComplete))
+            {
+                return false;
+            }
+
+            Crt::String clientToken = Iotdevicecommon::GenerateClientToken();
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_pendingDeletes.emplace(clientToken, std::move(pendingComplete));
+            }
+
+            std::weak_ptr<ShadowRequestCorrelator> weakCorrelator = shared_from_this();
+            auto onPubAck = [weakCorrelator, clientToken](int ioErr) {
+                auto correlator = weakCorrelator.lock();
+                if (correlator && ioErr != AWS_ERROR_SUCCESS)
+                {
+                    correlator->Complete<DeleteShadowResponse>(
+                        correlator->m_pendingDeletes, clientToken, nullptr, nullptr, ioErr);
+                }
+            };
+
+            bool published = false;
+            if (m_shadowName.has_value())
+            {
+                DeleteNamedShadowRequest request;
+                request.ThingName = m_thingName;
+                request.ShadowName = *m_shadowName;
+                request.ClientToken = clientToken;
+                published = m_client.PublishDeleteNamedShadow(request, qos, onPubAck);
+            }
+            else
+            {
+                DeleteShadowRequest request;
+                request.ThingName = m_thingName;
+                request.ClientToken = clientToken;
+                published = m_client.PublishDeleteShadow(request, qos, onPubAck);
+            }
+
+            if (!published)
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_pendingDeletes.erase(clientToken);
+                return false;
+            }
+
+            ScheduleTimeout(clientToken);
+            return true;
+        }
+
+        template <typename Response, typename Callback>
+        void ShadowRequestCorrelator::Complete(
+            Crt::Map<Crt::String, Callback> &pending,
+            const Crt::String &clientToken,
+            Response *response,
+            ErrorResponse *error,
+            int ioErr)
+        {
+            Callback onComplete;
+            uint64_t timeoutId = 0;
+            TimeoutTask *timeoutTask = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto iter = pending.find(clientToken);
+                if (iter == pending.end())
+                {
+                    return;
+                }
+                onComplete = std::move(iter->second);
+                pending.erase(iter);
+
+                auto timeout = m_timeoutIds.find(clientToken);
+                if (timeout != m_timeoutIds.end())
+                {
+                    timeoutId = timeout->second;
+                    m_timeoutIds.erase(timeout);
+                }
+
+                auto task = m_timeoutTasks.find(clientToken);
+                if (task != m_timeoutTasks.end())
+                {
+                    timeoutTask = task->second;
+                    ++timeoutTask->References;
+                    m_timeoutTasks.erase(task);
+                }
+            }
+
+            if (timeoutId != 0)
+            {
+                m_config.Timers->Cancel(timeoutId);
+            }
+            if (timeoutTask)
+            {
+                CancelTimeoutTask(timeoutTask);
+            }
+            if (onComplete)
+            {
+                onComplete(response, error, ioErr);
+            }
+        }
+
+        void ShadowRequestCorrelator::Fail(const Crt::String &clientToken, int ioErr)
+        {
+            /* Tokens are unique across the three kinds, so at most one of these finds the request. */
+            Complete<GetShadowResponse>(m_pendingGets, clientToken, nullptr, nullptr, ioErr);
+            Complete<UpdateShadowResponse>(m_pendingUpdates, clientToken, nullptr, nullptr, ioErr);
+            Complete<DeleteShadowResponse>(m_pendingDeletes, clientToken, nullptr, nullptr, ioErr);
+        }
+
+        void ShadowRequestCorrelator::ScheduleTimeout(const Crt::String &clientToken)
+        {
+            if (m_config.RequestTimeoutMs == 0)
+            {
+                return;
+            }
+
+            if (m_config.Timers)
+            {
+                std::weak_ptr<ShadowRequestCorrelator> weakCorrelator = shared_from_this();
+                Iotdevicecommon::TimerWheel::OnExpired onTimeout = [weakCorrelator, clientToken]() {
+                    auto correlator = weakCorrelator.lock();
+                    if (correlator)
+                    {
+                        correlator->Fail(clientToken, AWS_ERROR_MQTT_TIMEOUT);
+                    }
+                };
+                uint64_t timeoutId = m_config.Timers->Schedule(m_config.RequestTimeoutMs, std::move(onTimeout));
+                if (timeoutId != 0)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m_lock);
+                        if (m_pendingGets.count(clientToken) || m_pendingUpdates.count(clientToken) ||
+                            m_pendingDeletes.count(clientToken))
+                        {
+                            m_timeoutIds[clientToken] = timeoutId;
+                            return;
+                        }
+                    }
+
+                    /* Completed while the timer was being scheduled. */
+                    m_config.Timers->Cancel(timeoutId);
+                    return;
+                }
+            }
+
+            auto *timeoutTask = Crt::New<TimeoutTask>(m_allocator);
+            if (!timeoutTask)
+            {
+                return;
+            }
+
+            timeoutTask->EventLoop = m_eventLoop;
+            timeoutTask->Owner = shared_from_this();
+            timeoutTask->ClientToken = clientToken;
+            timeoutTask->Allocator = m_allocator;
+            timeoutTask->References = 1;
+            timeoutTask->Done = false;
+            aws_task_init(&timeoutTask->Task, s_onTimeoutTask, timeoutTask, "ShadowRequestCorrelatorTimeout");
+            aws_task_init(
+                &timeoutTask->CancelTask, s_onCancelTimeoutTask, timeoutTask, "ShadowRequestCorrelatorCancelTimeout");
+
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &now);
+            uint64_t timeout =
+                aws_timestamp_convert(m_config.RequestTimeoutMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+
+            /* Registered and scheduled under the lock, so no completion can cancel it before it is on the loop. */
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_pendingGets.count(clientToken) || m_pendingUpdates.count(clientToken) ||
+                    m_pendingDeletes.count(clientToken))
+                {
+                    m_timeoutTasks[clientToken] = timeoutTask;
+                    aws_event_loop_schedule_task_future(m_eventLoop, &timeoutTask->Task, now + timeout);
+                    return;
+                }
+            }
+
+            /* Completed before its timeout was scheduled. */
+            timeoutTask->Release();
+        }
+
+        void ShadowRequestCorrelator::CancelTimeoutTask(TimeoutTask *timeoutTask)
+        {
+            aws_event_loop_schedule_task_now(m_eventLoop, &timeoutTask->CancelTask);
+        }
+
+        void ShadowRequestCorrelator::s_onTimeoutTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *timeoutTask = static_cast<TimeoutTask *>(arg);
+            timeoutTask->Done = true;
+
+            /* Still registered, it has not been claimed by a completion: it times its request out. */
+            auto owner = timeoutTask->Owner.lock();
+            if (owner)
+            {
+                bool expired = false;
+                {
+                    std::lock_guard<std::mutex> lock(owner->m_lock);
+                    auto iter = owner->m_timeoutTasks.find(timeoutTask->ClientToken);
+                    if (iter != owner->m_timeoutTasks.end() && iter->second == timeoutTask)
+                    {
+                        owner->m_timeoutTasks.erase(iter);
+                        expired = status == AWS_TASK_STATUS_RUN_READY;
+                    }
+                }
+
+                if (expired)
+                {
+                    owner->Fail(timeoutTask->ClientToken, AWS_ERROR_MQTT_TIMEOUT);
+                }
+            }
+
+            timeoutTask->Release();
+        }
+
+        void ShadowRequestCorrelator::s_onCancelTimeoutTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *timeoutTask = static_cast<TimeoutTask *>(arg);
+
+            /* Both run on the event loop, so the timeout is either still scheduled here or has already run. */
+            if (status == AWS_TASK_STATUS_RUN_READY && !timeoutTask->Done)
+            {
+                aws_event_loop_cancel_task(timeoutTask->EventLoop, &timeoutTask->Task);
+            }
+
+            timeoutTask->Release();
+        }
+
+        void ShadowRequestCorrelator::CancelAll(int errorCode)
+        {
+            Crt::Map<Crt::String, OnGetShadowComplete> gets;
+            Crt::Map<Crt::String, OnUpdateShadowComplete> updates;
+            Crt::Map<Crt::String, OnDeleteShadowComplete> deletes;
+            Crt::Map<Crt::String, uint64_t> timeoutIds;
+            Crt::Map<Crt::String, TimeoutTask *> timeoutTasks;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                gets.swap(m_pendingGets);
+                updates.swap(m_pendingUpdates);
+                deletes.swap(m_pendingDeletes);
+                timeoutIds.swap(m_timeoutIds);
+                timeoutTasks.swap(m_timeoutTasks);
+                for (const auto &timeout : timeoutTasks)
+                {
+                    ++timeout.second->References;
+                }
+            }
+
+            for (const auto &timeout : timeoutIds)
+            {
+                m_config.Timers->Cancel(timeout.second);
+            }
+            for (const auto &timeout : timeoutTasks)
+            {
+                CancelTimeoutTask(timeout.second);
+            }
+
+            s_cancel(gets, errorCode);
+            s_cancel(updates, errorCode);
+            s_cancel(deletes, errorCode);
+        }
+
+        size_t ShadowRequestCorrelator::GetInFlightCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_pendingGets.size() + m_getWaiters.size() + m_pendingUpdates.size() + m_pendingDeletes.size();
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
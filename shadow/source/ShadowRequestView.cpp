@@ -0,0 +1,35 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowRequestView.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            void s_writeClientToken(const Crt::ByteCursor &clientToken, Aws::Iotdevicecommon::PayloadWriter &writer)
+            {
+                writer.BeginObject();
+                if (clientToken.len > 0)
+                {
+                    writer.Key("clientToken").String(clientToken);
+                }
+                writer.EndObject();
+            }
+        } // namespace
+
+        void ShadowRequestView::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            s_writeClientToken(ClientToken, writer);
+        }
+
+        void NamedShadowRequestView::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            s_writeClientToken(ClientToken, writer);
+        }
+
+    } // namespace Iotshadow
+} // namespace Aws
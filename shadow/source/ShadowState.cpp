@@ -4,40 +4,35 @@
  */
 #include <aws/iotshadow/ShadowState.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotshadow
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<ShadowState, true>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<ShadowState> s_fields[] = {
+                Fields::Field<Crt::JsonObject, &ShadowState::Desired>("desired"),
+                Fields::Field<Crt::JsonObject, &ShadowState::Reported>("reported"),
+            };
+        } // namespace
 
         void ShadowState::LoadFromObject(ShadowState &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("desired"))
-            {
-                val.Desired = doc.GetJsonObjectCopy("desired");
-            }
-
-            if (doc.ValueExists("reported"))
-            {
-                val.Reported = doc.GetJsonObjectCopy("reported");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void ShadowState::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (Desired)
-            {
-                object.WithObject("desired", *Desired);
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (Reported)
-            {
-                object.WithObject("reported", *Reported);
-            }
+        void ShadowState::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         ShadowState::ShadowState(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
@@ -4,50 +4,31 @@
  */
 #include <aws/iotshadow/ShadowStateWithDelta.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotshadow
     {
+        namespace
+        {
+            using Fields = Aws::Iotdevicecommon::ModelFields<ShadowStateWithDelta>;
+
+            constexpr Aws::Iotdevicecommon::ModelField<ShadowStateWithDelta> s_fields[] = {
+                Fields::Field<Crt::JsonObject, &ShadowStateWithDelta::Delta>("delta"),
+                Fields::Field<Crt::JsonObject, &ShadowStateWithDelta::Reported>("reported"),
+                Fields::Field<Crt::JsonObject, &ShadowStateWithDelta::Desired>("desired"),
+            };
+        } // namespace
 
         void ShadowStateWithDelta::LoadFromObject(ShadowStateWithDelta &val, const Aws::Crt::JsonView &doc)
         {
-            (void)val;
-            (void)doc;
-
-            if (doc.ValueExists("delta"))
-            {
-                val.Delta = doc.GetJsonObjectCopy("delta");
-            }
-
-            if (doc.ValueExists("reported"))
-            {
-                val.Reported = doc.GetJsonObjectCopy("reported");
-            }
-
-            if (doc.ValueExists("desired"))
-            {
-                val.Desired = doc.GetJsonObjectCopy("desired");
-            }
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void ShadowStateWithDelta::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (Delta)
-            {
-                object.WithObject("delta", *Delta);
-            }
-
-            if (Reported)
-            {
-                object.WithObject("reported", *Reported);
-            }
-
-            if (Desired)
-            {
-                object.WithObject("desired", *Desired);
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
         }
 
         ShadowStateWithDelta::ShadowStateWithDelta(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
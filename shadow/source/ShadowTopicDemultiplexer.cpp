@@ -0,0 +1,409 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowTopicDemultiplexer.h>
+
+#include <aws/iotdevicecommon/MessageContext.h>
+#include <aws/iotdevicecommon/SubscriptionHandle.h>
+
+#include <aws/iotshadow/DeleteNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/DeleteShadowResponse.h>
+#include <aws/iotshadow/DeleteShadowSubscriptionRequest.h>
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/GetNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/GetShadowSubscriptionRequest.h>
+#include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/NamedShadowUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowUpdatedEvent.h>
+#include <aws/iotshadow/ShadowUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateShadowResponse.h>
+#include <aws/iotshadow/UpdateShadowSubscriptionRequest.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            const size_t s_noChild = SIZE_MAX;
+
+            bool s_classicTopic(const Crt::Optional<Crt::String> &thingName, const char *suffix, Crt::String &topic)
+            {
+                if (!thingName.has_value())
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                    return false;
+                }
+
+                topic = "$aws/things/";
+                topic.append(*thingName);
+                topic.append("/shadow/");
+                topic.append(suffix);
+                return true;
+            }
+
+            bool s_namedTopic(
+                const Crt::Optional<Crt::String> &thingName,
+                const Crt::Optional<Crt::String> &shadowName,
+                const char *suffix,
+                Crt::String &topic)
+            {
+                if (!thingName.has_value() || !shadowName.has_value())
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                    return false;
+                }
+
+                topic = "$aws/things/";
+                topic.append(*thingName);
+                topic.append("/shadow/name/");
+                topic.append(*shadowName);
+                topic.append("/");
+                topic.append(suffix);
+                return true;
+            }
+
+            template <typename Response>
+            std::function<void(const Crt::ByteBuf &)> s_makeParser(const std::function<void(Response *, int)> &handler)
+            {
+                Crt::String payloadScratch;
+                return [handler, payloadScratch](const Crt::ByteBuf &payload) mutable {
+                    payloadScratch.assign(reinterpret_cast<char *>(payload.buffer), payload.len);
+                    Crt::JsonObject jsonObject(payloadScratch);
+                    Response response(jsonObject);
+                    handler(&response, AWS_ERROR_SUCCESS);
+                };
+            }
+        } // namespace
+
+        ShadowTopicDemultiplexer::TopicNode::TopicNode() noexcept : WildcardChild(s_noChild) {}
+
+        ShadowTopicDemultiplexer::ShadowTopicDemultiplexer(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            Crt::Allocator *allocator) noexcept
+            : m_connection(connection), m_allocator(allocator)
+        {
+            m_nodes.emplace_back();
+        }
+
+        std::shared_ptr<ShadowTopicDemultiplexer> ShadowTopicDemultiplexer::Create(
+            const std::shared_ptr<Crt::Mqtt::MqttConnection> &connection,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat =
+                static_cast<ShadowTopicDemultiplexer *>(aws_mem_acquire(allocator, sizeof(ShadowTopicDemultiplexer)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ShadowTopicDemultiplexer(connection, allocator);
+                return std::shared_ptr<ShadowTopicDemultiplexer>(
+                    toSeat, [allocator](ShadowTopicDemultiplexer *demux) { Crt::Delete(demux, allocator); });
+            }
+
+            return nullptr;
+        }
+
+        bool ShadowTopicDemultiplexer::Subscribe(
+            const Crt::String &thingFilter,
+            Crt::Mqtt::QOS qos,
+            const OnSubscribeComplete &onSubAck)
+        {
+            Crt::String subscribeTopic("$aws/things/");
+            subscribeTopic.append(thingFilter);
+            subscribeTopic.append("/shadow/#");
+
+            std::weak_ptr<ShadowTopicDemultiplexer> weakDemux = shared_from_this();
+            auto onSubscribePublish = [weakDemux](
+                                          Crt::Mqtt::MqttConnection &,
+                                          const Crt::String &topic,
+                                          const Crt::ByteBuf &payload) {
+                auto demux = weakDemux.lock();
+                if (demux)
+                {
+                    Iotdevicecommon::MessageTopicScope scope(topic);
+                    demux->Dispatch(topic, payload);
+                }
+            };
+
+            auto onSubscribeComplete = [onSubAck](
+                                           Crt::Mqtt::MqttConnection &,
+                                           uint16_t,
+                                           const Crt::String &,
+                                           Crt::Mqtt::QOS,
+                                           int errorCode) {
+                if (onSubAck)
+                {
+                    onSubAck(errorCode);
+                }
+            };
+
+            return Iotdevicecommon::SubscribeWithHandle(
+                       m_connection,
+                       subscribeTopic.c_str(),
+                       qos,
+                       std::move(onSubscribePublish),
+                       std::move(onSubscribeComplete)) != 0;
+        }
+
+        bool ShadowTopicDemultiplexer::Register(const Crt::String &topic, const OnPayload &handler)
+        {
+            auto sharedHandler = Crt::MakeShared<OnPayload>(m_allocator, handler);
+            if (!sharedHandler)
+            {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            size_t node = 0;
+            size_t segmentStart = 0;
+            while (segmentStart <= topic.length())
+            {
+                size_t segmentEnd = topic.find('/', segmentStart);
+                if (segmentEnd == Crt::String::npos)
+                {
+                    segmentEnd = topic.length();
+                }
+
+                Crt::String segment = topic.substr(segmentStart, segmentEnd - segmentStart);
+                size_t child = s_noChild;
+                if (segment == "+")
+                {
+                    child = m_nodes[node].WildcardChild;
+                    if (child == s_noChild)
+                    {
+                        child = m_nodes.size();
+                        m_nodes.emplace_back();
+                        m_nodes[node].WildcardChild = child;
+                    }
+                }
+                else
+                {
+                    auto existing = m_nodes[node].Children.find(segment);
+                    if (existing != m_nodes[node].Children.end())
+                    {
+                        child = existing->second;
+                    }
+                    else
+                    {
+                        child = m_nodes.size();
+                        m_nodes.emplace_back();
+                        m_nodes[node].Children.emplace(std::move(segment), child);
+                    }
+                }
+
+                node = child;
+                segmentStart = segmentEnd + 1;
+            }
+
+            m_nodes[node].Handlers.push_back(std::move(sharedHandler));
+            return true;
+        }
+
+        void ShadowTopicDemultiplexer::Match(
+            size_t node,
+            const Crt::Vector<Crt::ByteCursor> &segments,
+            size_t depth,
+            Crt::Vector<std::shared_ptr<OnPayload>> &matches) const
+        {
+            const TopicNode &current = m_nodes[node];
+            if (depth == segments.size())
+            {
+                matches.insert(matches.end(), current.Handlers.begin(), current.Handlers.end());
+                return;
+            }
+
+            const Crt::ByteCursor &segment = segments[depth];
+            auto exact = current.Children.find(Crt::String(reinterpret_cast<const char *>(segment.ptr), segment.len));
+            if (exact != current.Children.end())
+            {
+                Match(exact->second, segments, depth + 1, matches);
+            }
+
+            if (current.WildcardChild != s_noChild)
+            {
+                Match(current.WildcardChild, segments, depth + 1, matches);
+            }
+        }
+
+        void ShadowTopicDemultiplexer::Dispatch(const Crt::String &topic, const Crt::ByteBuf &payload)
+        {
+            Crt::Vector<Crt::ByteCursor> segments;
+            const char *segmentStart = topic.c_str();
+            const char *topicEnd = segmentStart + topic.length();
+            for (const char *cursor = segmentStart;; ++cursor)
+            {
+                if (cursor == topicEnd || *cursor == '/')
+                {
+                    segments.push_back(Crt::ByteCursorFromArray(
+                        reinterpret_cast<const uint8_t *>(segmentStart), static_cast<size_t>(cursor - segmentStart)));
+                    if (cursor == topicEnd)
+                    {
+                        break;
+                    }
+                    segmentStart = cursor + 1;
+                }
+            }
+
+            Crt::Vector<std::shared_ptr<OnPayload>> matches;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                Match(0, segments, 0, matches);
+            }
+
+            for (const auto &handler : matches)
+            {
+                (*handler)(payload);
+            }
+        }
+
+        bool ShadowTopicDemultiplexer::OnGetShadowAccepted(
+            const GetShadowSubscriptionRequest &request,
+            const OnSubscribeToGetShadowAcceptedResponse &handler)
+        {
+            Crt::String topic;
+            return s_classicTopic(request.ThingName, "get/accepted", topic) &&
+                   Register(topic, s_makeParser<GetShadowResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnGetShadowRejected(
+            const GetShadowSubscriptionRequest &request,
+            const OnSubscribeToGetShadowRejectedResponse &handler)
+        {
+            Crt::String topic;
+            return s_classicTopic(request.ThingName, "get/rejected", topic) &&
+                   Register(topic, s_makeParser<ErrorResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnUpdateShadowAccepted(
+            const UpdateShadowSubscriptionRequest &request,
+            const OnSubscribeToUpdateShadowAcceptedResponse &handler)
+        {
+            Crt::String topic;
+            return s_classicTopic(request.ThingName, "update/accepted", topic) &&
+                   Register(topic, s_makeParser<UpdateShadowResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnUpdateShadowRejected(
+            const UpdateShadowSubscriptionRequest &request,
+            const OnSubscribeToUpdateShadowRejectedResponse &handler)
+        {
+            Crt::String topic;
+            return s_classicTopic(request.ThingName, "update/rejected", topic) &&
+                   Register(topic, s_makeParser<ErrorResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnDeleteShadowAccepted(
+            const DeleteShadowSubscriptionRequest &request,
+            const OnSubscribeToDeleteShadowAcceptedResponse &handler)
+        {
+            Crt::String topic;
+            return s_classicTopic(request.ThingName, "delete/accepted", topic) &&
+                   Register(topic, s_makeParser<DeleteShadowResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnDeleteShadowRejected(
+            const DeleteShadowSubscriptionRequest &request,
+            const OnSubscribeToDeleteShadowRejectedResponse &handler)
+        {
+            Crt::String topic;
+            return s_classicTopic(request.ThingName, "delete/rejected", topic) &&
+                   Register(topic, s_makeParser<ErrorResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnShadowDeltaUpdatedEvents(
+            const ShadowDeltaUpdatedSubscriptionRequest &request,
+            const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler)
+        {
+            Crt::String topic;
+            return s_classicTopic(request.ThingName, "update/delta", topic) &&
+                   Register(topic, s_makeParser<ShadowDeltaUpdatedEvent>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnShadowUpdatedEvents(
+            const ShadowUpdatedSubscriptionRequest &request,
+            const OnSubscribeToShadowUpdatedEventsResponse &handler)
+        {
+            Crt::String topic;
+            return s_classicTopic(request.ThingName, "update/documents", topic) &&
+                   Register(topic, s_makeParser<ShadowUpdatedEvent>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnGetNamedShadowAccepted(
+            const GetNamedShadowSubscriptionRequest &request,
+            const OnSubscribeToGetNamedShadowAcceptedResponse &handler)
+        {
+            Crt::String topic;
+            return s_namedTopic(request.ThingName, request.ShadowName, "get/accepted", topic) &&
+                   Register(topic, s_makeParser<GetShadowResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnGetNamedShadowRejected(
+            const GetNamedShadowSubscriptionRequest &request,
+            const OnSubscribeToGetNamedShadowRejectedResponse &handler)
+        {
+            Crt::String topic;
+            return s_namedTopic(request.ThingName, request.ShadowName, "get/rejected", topic) &&
+                   Register(topic, s_makeParser<ErrorResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnUpdateNamedShadowAccepted(
+            const UpdateNamedShadowSubscriptionRequest &request,
+            const OnSubscribeToUpdateNamedShadowAcceptedResponse &handler)
+        {
+            Crt::String topic;
+            return s_namedTopic(request.ThingName, request.ShadowName, "update/accepted", topic) &&
+                   Register(topic, s_makeParser<UpdateShadowResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnUpdateNamedShadowRejected(
+            const UpdateNamedShadowSubscriptionRequest &request,
+            const OnSubscribeToUpdateNamedShadowRejectedResponse &handler)
+        {
+            Crt::String topic;
+            return s_namedTopic(request.ThingName, request.ShadowName, "update/rejected", topic) &&
+                   Register(topic, s_makeParser<ErrorResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnDeleteNamedShadowAccepted(
+            const DeleteNamedShadowSubscriptionRequest &request,
+            const OnSubscribeToDeleteNamedShadowAcceptedResponse &handler)
+        {
+            Crt::String topic;
+            return s_namedTopic(request.ThingName, request.ShadowName, "delete/accepted", topic) &&
+                   Register(topic, s_makeParser<DeleteShadowResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnDeleteNamedShadowRejected(
+            const DeleteNamedShadowSubscriptionRequest &request,
+            const OnSubscribeToDeleteNamedShadowRejectedResponse &handler)
+        {
+            Crt::String topic;
+            return s_namedTopic(request.ThingName, request.ShadowName, "delete/rejected", topic) &&
+                   Register(topic, s_makeParser<ErrorResponse>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnNamedShadowDeltaUpdatedEvents(
+            const NamedShadowDeltaUpdatedSubscriptionRequest &request,
+            const OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &handler)
+        {
+            Crt::String topic;
+            return s_namedTopic(request.ThingName, request.ShadowName, "update/delta", topic) &&
+                   Register(topic, s_makeParser<ShadowDeltaUpdatedEvent>(handler));
+        }
+
+        bool ShadowTopicDemultiplexer::OnNamedShadowUpdatedEvents(
+            const NamedShadowUpdatedSubscriptionRequest &request,
+            const OnSubscribeToNamedShadowUpdatedEventsResponse &handler)
+        {
+            Crt::String topic;
+            return s_namedTopic(request.ThingName, request.ShadowName, "update/documents", topic) &&
+                   Register(topic, s_makeParser<ShadowUpdatedEvent>(handler));
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
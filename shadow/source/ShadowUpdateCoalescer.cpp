@@ -0,0 +1,273 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowUpdateCoalescer.h>
+
+#include <aws/iotshadow/ShadowState.h>
+#include <aws/iotshadow/UpdateNamedShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+
+#include <aws/common/clock.h>
+#include <aws/io/event_loop.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            struct FlushTask
+            {
+                aws_task Task;
+                std::weak_ptr<ShadowUpdateCoalescer> Owner;
+                Crt::Allocator *Allocator;
+            };
+
+            void s_mergeReported(Crt::JsonObject &target, const Crt::JsonView &patch)
+            {
+                for (const auto &entry : patch.GetAllObjects())
+                {
+                    Crt::JsonView current = target.View();
+                    if (entry.second.IsObject() && current.ValueExists(entry.first) &&
+                        current.GetJsonObject(entry.first).IsObject())
+                    {
+                        Crt::JsonObject merged = current.GetJsonObjectCopy(entry.first);
+                        s_mergeReported(merged, entry.second);
+                        target.WithObject(entry.first, std::move(merged));
+                    }
+                    else
+                    {
+                        target.WithObject(entry.first, entry.second.Materialize());
+                    }
+                }
+            }
+        } // namespace
+
+        ShadowUpdateCoalescerConfig::ShadowUpdateCoalescerConfig() noexcept
+            : CoalesceWindowMs(100), MaxPendingUpdates(0), Qos(AWS_MQTT_QOS_AT_LEAST_ONCE)
+        {
+        }
+
+        ShadowUpdateCoalescer::ShadowUpdateCoalescer(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const ShadowUpdateCoalescerConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_client(client), m_config(config), m_allocator(allocator),
+              m_eventLoop(aws_event_loop_group_get_next_loop(eventLoopGroup.GetUnderlyingHandle())),
+              m_registry(config.Registry), m_pending(allocator), m_flushScheduled(false)
+        {
+            if (!m_registry)
+            {
+                m_registry = Crt::MakeShared<Iotdevicecommon::ThingRegistry>(allocator, allocator);
+            }
+        }
+
+        ShadowUpdateCoalescer::~ShadowUpdateCoalescer() { Flush(); }
+
+        std::shared_ptr<ShadowUpdateCoalescer> ShadowUpdateCoalescer::Create(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const ShadowUpdateCoalescerConfig &config,
+            Crt::Allocator *allocator)
+        {
+            auto *toSeat =
+                static_cast<ShadowUpdateCoalescer *>(aws_mem_acquire(allocator, sizeof(ShadowUpdateCoalescer)));
+            if (toSeat)
+            {
+                toSeat = new (toSeat) ShadowUpdateCoalescer(client, eventLoopGroup, config, allocator);
+                std::shared_ptr<ShadowUpdateCoalescer> coalescer(
+                    toSeat, [allocator](ShadowUpdateCoalescer *coalescer) { Crt::Delete(coalescer, allocator); });
+                if (!coalescer->m_registry)
+                {
+                    aws_raise_error(AWS_ERROR_OOM);
+                    return nullptr;
+                }
+                return coalescer;
+            }
+
+            return nullptr;
+        }
+
+        bool ShadowUpdateCoalescer::UpdateReported(
+            const Crt::String &thingName,
+            const Crt::JsonView &reported,
+            const OnPublishComplete &onPubAck)
+        {
+            return Enqueue(thingName, Crt::Optional<Crt::String>(), reported, onPubAck);
+        }
+
+        bool ShadowUpdateCoalescer::UpdateNamedReported(
+            const Crt::String &thingName,
+            const Crt::String &shadowName,
+            const Crt::JsonView &reported,
+            const OnPublishComplete &onPubAck)
+        {
+            return Enqueue(thingName, Crt::Optional<Crt::String>(shadowName), reported, onPubAck);
+        }
+
+        bool ShadowUpdateCoalescer::Enqueue(
+            const Crt::String &thingName,
+            const Crt::Optional<Crt::String> &shadowName,
+            const Crt::JsonView &reported,
+            const OnPublishComplete &onPubAck)
+        {
+            if (!reported.IsObject())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            const Iotdevicecommon::NameId thingId = m_registry->Intern(thingName);
+            const Iotdevicecommon::NameId shadowId =
+                shadowName.has_value() ? m_registry->Intern(*shadowName) : Iotdevicecommon::InvalidNameId;
+            if (thingId == Iotdevicecommon::InvalidNameId ||
+                (shadowName.has_value() && shadowId == Iotdevicecommon::InvalidNameId))
+            {
+                aws_raise_error(AWS_ERROR_OOM);
+                return false;
+            }
+            const uint64_t key = Iotdevicecommon::ThingRegistry::PairKey(thingId, shadowId);
+
+            PendingUpdate ready;
+            bool publishNow = false;
+            bool scheduleFlush = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                PendingUpdate &pending = m_pending.GetOrAdd(key);
+                if (pending.Callbacks.empty())
+                {
+                    pending.ThingName = thingName;
+                    pending.ShadowName = shadowName;
+                    pending.Reported = reported.Materialize();
+                }
+                else
+                {
+                    s_mergeReported(pending.Reported, reported);
+                }
+
+                pending.Callbacks.push_back(onPubAck);
+
+                if (m_config.MaxPendingUpdates != 0 && pending.Callbacks.size() >= m_config.MaxPendingUpdates)
+                {
+                    ready = std::move(pending);
+                    m_pending.Erase(key);
+                    publishNow = true;
+                }
+                else if (!m_flushScheduled)
+                {
+                    m_flushScheduled = true;
+                    scheduleFlush = true;
+                }
+            }
+
+            if (publishNow)
+            {
+                PublishPending(ready);
+            }
+
+            if (scheduleFlush)
+            {
+                ScheduleFlush();
+            }
+
+            return true;
+        }
+
+        void ShadowUpdateCoalescer::Flush()
+        {
+            Iotdevicecommon::IdHashMap<PendingUpdate> pending(m_allocator);
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                pending.Swap(m_pending);
+            }
+
+            pending.ForEach([this](uint64_t, PendingUpdate &update) { PublishPending(update); });
+        }
+
+        void ShadowUpdateCoalescer::ScheduleFlush()
+        {
+            auto *flushTask = Crt::New<FlushTask>(m_allocator);
+            if (!flushTask)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_flushScheduled = false;
+                }
+                Flush();
+                return;
+            }
+
+            flushTask->Owner = shared_from_this();
+            flushTask->Allocator = m_allocator;
+            aws_task_init(&flushTask->Task, s_onFlushTask, flushTask, "ShadowUpdateCoalescerFlush");
+
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &now);
+            uint64_t window =
+                aws_timestamp_convert(m_config.CoalesceWindowMs, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+            aws_event_loop_schedule_task_future(m_eventLoop, &flushTask->Task, now + window);
+        }
+
+        void ShadowUpdateCoalescer::s_onFlushTask(aws_task *, void *arg, aws_task_status status)
+        {
+            auto *flushTask = static_cast<FlushTask *>(arg);
+            if (status == AWS_TASK_STATUS_RUN_READY)
+            {
+                auto owner = flushTask->Owner.lock();
+                if (owner)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(owner->m_lock);
+                        owner->m_flushScheduled = false;
+                    }
+                    owner->Flush();
+                }
+            }
+
+            Crt::Delete(flushTask, flushTask->Allocator);
+        }
+
+        void ShadowUpdateCoalescer::PublishPending(PendingUpdate &pending)
+        {
+            Crt::Vector<OnPublishComplete> callbacks(std::move(pending.Callbacks));
+            auto onPubAck = [callbacks](int ioErr) {
+                for (const auto &callback : callbacks)
+                {
+                    if (callback)
+                    {
+                        callback(ioErr);
+                    }
+                }
+            };
+
+            ShadowState state;
+            state.Reported = std::move(pending.Reported);
+
+            bool published = false;
+            if (pending.ShadowName.has_value())
+            {
+                UpdateNamedShadowRequest request;
+                request.ThingName = pending.ThingName;
+                request.ShadowName = *pending.ShadowName;
+                request.State = std::move(state);
+                published = m_client.PublishUpdateNamedShadow(request, m_config.Qos, onPubAck);
+            }
+            else
+            {
+                UpdateShadowRequest request;
+                request.ThingName = pending.ThingName;
+                request.State = std::move(state);
+                published = m_client.PublishUpdateShadow(request, m_config.Qos, onPubAck);
+            }
+
+            if (!published)
+            {
+                onPubAck(Crt::LastErrorOrUnknown());
+            }
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
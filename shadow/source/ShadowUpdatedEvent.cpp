@@ -9,24 +9,27 @@ namespace Aws
     namespace Iotshadow
     {
 
-        void ShadowUpdatedEvent::LoadFromObject(ShadowUpdatedEvent &val, const Aws::Crt::JsonView &doc)
+        void ShadowUpdatedEvent::LoadFromObject(
+            ShadowUpdatedEvent &val,
+            const Aws::Crt::JsonView &doc,
+            ShadowMetadataMode metadataMode)
         {
             (void)val;
             (void)doc;
 
             if (doc.ValueExists("previous"))
             {
-                val.Previous = doc.GetJsonObject("previous");
+                val.Previous = ShadowUpdatedSnapshot(doc.GetJsonObject("previous"), metadataMode);
             }
 
             if (doc.ValueExists("current"))
             {
-                val.Current = doc.GetJsonObject("current");
+                val.Current = ShadowUpdatedSnapshot(doc.GetJsonObject("current"), metadataMode);
             }
 
             if (doc.ValueExists("timestamp"))
             {
-                val.Timestamp = doc.GetDouble("timestamp");
+                val.Timestamp = Aws::Iotdevicecommon::PackedDateTime::FromSeconds(doc.GetDouble("timestamp"));
             }
         }
 
@@ -50,11 +53,19 @@ namespace Aws
 
             if (Timestamp)
             {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
+                object.WithDouble("timestamp", Timestamp.Seconds());
             }
         }
 
-        ShadowUpdatedEvent::ShadowUpdatedEvent(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
+        ShadowUpdatedEvent::ShadowUpdatedEvent(const Crt::JsonView &doc)
+        {
+            LoadFromObject(*this, doc, ShadowMetadataMode::Full);
+        }
+
+        ShadowUpdatedEvent::ShadowUpdatedEvent(const Crt::JsonView &doc, ShadowMetadataMode metadataMode)
+        {
+            LoadFromObject(*this, doc, metadataMode);
+        }
 
         ShadowUpdatedEvent &ShadowUpdatedEvent::operator=(const Crt::JsonView &doc)
         {
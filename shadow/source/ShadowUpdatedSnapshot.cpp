@@ -9,7 +9,10 @@ namespace Aws
     namespace Iotshadow
     {
 
-        void ShadowUpdatedSnapshot::LoadFromObject(ShadowUpdatedSnapshot &val, const Aws::Crt::JsonView &doc)
+        void ShadowUpdatedSnapshot::LoadFromObject(
+            ShadowUpdatedSnapshot &val,
+            const Aws::Crt::JsonView &doc,
+            ShadowMetadataMode metadataMode)
         {
             (void)val;
             (void)doc;
@@ -19,9 +22,9 @@ namespace Aws
                 val.State = doc.GetJsonObject("state");
             }
 
-            if (doc.ValueExists("metadata"))
+            if (doc.ValueExists("metadata") && metadataMode != ShadowMetadataMode::Skip)
             {
-                val.Metadata = doc.GetJsonObject("metadata");
+                val.Metadata = ShadowMetadata(doc.GetJsonObject("metadata"), metadataMode);
             }
 
             if (doc.ValueExists("version"))
@@ -54,7 +57,15 @@ namespace Aws
             }
         }
 
-        ShadowUpdatedSnapshot::ShadowUpdatedSnapshot(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
+        ShadowUpdatedSnapshot::ShadowUpdatedSnapshot(const Crt::JsonView &doc)
+        {
+            LoadFromObject(*this, doc, ShadowMetadataMode::Full);
+        }
+
+        ShadowUpdatedSnapshot::ShadowUpdatedSnapshot(const Crt::JsonView &doc, ShadowMetadataMode metadataMode)
+        {
+            LoadFromObject(*this, doc, metadataMode);
+        }
 
         ShadowUpdatedSnapshot &ShadowUpdatedSnapshot::operator=(const Crt::JsonView &doc)
         {
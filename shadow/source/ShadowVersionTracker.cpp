@@ -0,0 +1,100 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowVersionTracker.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        ShadowVersionTracker::ShadowVersionTracker(Crt::Allocator *allocator) noexcept
+            : ShadowVersionTracker(Crt::MakeShared<Iotdevicecommon::ThingRegistry>(allocator, allocator), allocator)
+        {
+        }
+
+        ShadowVersionTracker::ShadowVersionTracker(
+            std::shared_ptr<Iotdevicecommon::ThingRegistry> registry,
+            Crt::Allocator *allocator) noexcept
+            : m_registry(std::move(registry)), m_versions(allocator), m_suppressedCount(0)
+        {
+        }
+
+        uint64_t ShadowVersionTracker::Key(const Crt::String &thingName, const Crt::String &shadowName)
+        {
+            const Iotdevicecommon::NameId shadowId =
+                shadowName.empty() ? Iotdevicecommon::InvalidNameId : m_registry->Intern(shadowName);
+            return Iotdevicecommon::ThingRegistry::PairKey(m_registry->Intern(thingName), shadowId);
+        }
+
+        bool ShadowVersionTracker::FindKey(
+            const Crt::String &thingName,
+            const Crt::String &shadowName,
+            uint64_t &key) const
+        {
+            const Iotdevicecommon::NameId thingId = m_registry->Find(thingName);
+            const Iotdevicecommon::NameId shadowId =
+                shadowName.empty() ? Iotdevicecommon::InvalidNameId : m_registry->Find(shadowName);
+            if (thingId == Iotdevicecommon::InvalidNameId ||
+                (!shadowName.empty() && shadowId == Iotdevicecommon::InvalidNameId))
+            {
+                return false;
+            }
+
+            key = Iotdevicecommon::ThingRegistry::PairKey(thingId, shadowId);
+            return true;
+        }
+
+        bool ShadowVersionTracker::Observe(
+            EventStream stream,
+            const Crt::String &thingName,
+            const Crt::String &shadowName,
+            int32_t version) noexcept
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            Versions &versions = m_versions.GetOrAdd(Key(thingName, shadowName));
+            Crt::Optional<int32_t> &latest = stream == EventStream::Delta ? versions.Delta : versions.Updated;
+            if (latest && version <= *latest)
+            {
+                ++m_suppressedCount;
+                return false;
+            }
+
+            latest = version;
+            return true;
+        }
+
+        void ShadowVersionTracker::RecordDocumentVersion(
+            const Crt::String &thingName,
+            const Crt::String &shadowName,
+            int32_t version) noexcept
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            Versions &versions = m_versions.GetOrAdd(Key(thingName, shadowName));
+            if (!versions.Delta || *versions.Delta < version)
+            {
+                versions.Delta = version;
+            }
+            if (!versions.Updated || *versions.Updated < version)
+            {
+                versions.Updated = version;
+            }
+        }
+
+        void ShadowVersionTracker::Forget(const Crt::String &thingName, const Crt::String &shadowName) noexcept
+        {
+            /* Find rather than Intern: forgetting a shadow never seen should not store its name. */
+            uint64_t key = 0;
+            if (!FindKey(thingName, shadowName, key))
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_versions.Erase(key);
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
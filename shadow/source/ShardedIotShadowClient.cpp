@@ -0,0 +1,464 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShardedIotShadowClient.h>
+
+#include <aws/iotshadow/DeleteNamedShadowRequest.h>
+#include <aws/iotshadow/DeleteNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/DeleteShadowRequest.h>
+#include <aws/iotshadow/DeleteShadowSubscriptionRequest.h>
+#include <aws/iotshadow/GetNamedShadowRequest.h>
+#include <aws/iotshadow/GetNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/GetShadowRequest.h>
+#include <aws/iotshadow/GetShadowSubscriptionRequest.h>
+#include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/NamedShadowUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowSubscriptionRequest.h>
+namespace Aws
+{
+    namespace Iotshadow
+    {
+
+        ShardedIotShadowClient::ShardedIotShadowClient(
+            const Aws::Crt::Vector<std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>> &connections,
+            Aws::Crt::Allocator *allocator)
+            : ShardedIotShadowClient(connections, Aws::Iotdevicecommon::ServiceClientConfig(), allocator)
+        {
+        }
+
+        ShardedIotShadowClient::ShardedIotShadowClient(
+            const Aws::Crt::Vector<std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>> &connections,
+            const Aws::Iotdevicecommon::ServiceClientConfig &config,
+            Aws::Crt::Allocator *allocator)
+            : m_ring(connections.size(), 64, allocator), m_shards(allocator)
+        {
+            m_shards.reserve(connections.size());
+            for (const auto &connection : connections)
+            {
+                m_shards.emplace_back(connection, config, allocator);
+            }
+        }
+
+        ShardedIotShadowClient::operator bool() const noexcept
+        {
+            if (m_shards.empty())
+            {
+                return false;
+            }
+            for (const auto &shard : m_shards)
+            {
+                if (!shard)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        int ShardedIotShadowClient::GetLastError() const noexcept { return aws_last_error(); }
+
+        size_t ShardedIotShadowClient::GetShardCount() const noexcept { return m_shards.size(); }
+
+        IotShadowClient &ShardedIotShadowClient::GetClientForThing(const Aws::Crt::String &thingName) noexcept
+        {
+            return m_shards[m_ring.ShardFor(thingName)];
+        }
+
+        IotShadowClient *ShardedIotShadowClient::ShardFor(
+            const Aws::Crt::Optional<Aws::Crt::String> &thingName) noexcept
+        {
+            if (m_shards.empty())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return nullptr;
+            }
+            if (!thingName)
+            {
+                return &m_shards[0];
+            }
+            return &m_shards[m_ring.ShardFor(*thingName)];
+        }
+
+        bool ShardedIotShadowClient::SubscribeToDeleteNamedShadowRejected(
+            const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToDeleteNamedShadowRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDeleteNamedShadowRejected(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToDeleteNamedShadowRejected(
+            const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDeleteNamedShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDeleteNamedShadowRejected(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToGetNamedShadowAccepted(
+            const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToGetNamedShadowAcceptedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToGetNamedShadowAccepted(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToGetNamedShadowAccepted(
+            const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetNamedShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToGetNamedShadowAccepted(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToShadowDeltaUpdatedEvents(
+            const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToShadowDeltaUpdatedEvents(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToShadowDeltaUpdatedEvents(
+            const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToShadowDeltaUpdatedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToShadowDeltaUpdatedEvents(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToDeleteShadowAccepted(
+            const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToDeleteShadowAcceptedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDeleteShadowAccepted(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToDeleteShadowAccepted(
+            const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDeleteShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDeleteShadowAccepted(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToUpdateNamedShadowAccepted(
+            const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToUpdateNamedShadowAcceptedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateNamedShadowAccepted(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToUpdateNamedShadowAccepted(
+            const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateNamedShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateNamedShadowAccepted(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToDeleteNamedShadowAccepted(
+            const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToDeleteNamedShadowAcceptedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDeleteNamedShadowAccepted(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToDeleteNamedShadowAccepted(
+            const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDeleteNamedShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDeleteNamedShadowAccepted(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToUpdateShadowAccepted(
+            const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToUpdateShadowAcceptedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateShadowAccepted(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToUpdateShadowAccepted(
+            const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateShadowAccepted(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToUpdateShadowRejected(
+            const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToUpdateShadowRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateShadowRejected(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToUpdateShadowRejected(
+            const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateShadowRejected(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToDeleteShadowRejected(
+            const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToDeleteShadowRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDeleteShadowRejected(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToDeleteShadowRejected(
+            const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToDeleteShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToDeleteShadowRejected(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToUpdateNamedShadowRejected(
+            const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToUpdateNamedShadowRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateNamedShadowRejected(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToUpdateNamedShadowRejected(
+            const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToUpdateNamedShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToUpdateNamedShadowRejected(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToNamedShadowUpdatedEvents(
+            const Aws::Iotshadow::NamedShadowUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToNamedShadowUpdatedEventsResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToNamedShadowUpdatedEvents(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToNamedShadowUpdatedEvents(
+            const Aws::Iotshadow::NamedShadowUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToNamedShadowUpdatedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToNamedShadowUpdatedEvents(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToGetShadowAccepted(
+            const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToGetShadowAcceptedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToGetShadowAccepted(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToGetShadowAccepted(
+            const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetShadowAcceptedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToGetShadowAccepted(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToShadowUpdatedEvents(
+            const Aws::Iotshadow::ShadowUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToShadowUpdatedEventsResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToShadowUpdatedEvents(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToShadowUpdatedEvents(
+            const Aws::Iotshadow::ShadowUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToShadowUpdatedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToShadowUpdatedEvents(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToNamedShadowDeltaUpdatedEvents(
+            const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToNamedShadowDeltaUpdatedEvents(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToNamedShadowDeltaUpdatedEvents(
+            const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToNamedShadowDeltaUpdatedEvents(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToGetNamedShadowRejected(
+            const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToGetNamedShadowRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToGetNamedShadowRejected(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToGetNamedShadowRejected(
+            const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetNamedShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToGetNamedShadowRejected(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToGetShadowRejected(
+            const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnSubscribeToGetShadowRejectedResponse &handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToGetShadowRejected(request, qos, handler, onSubAck);
+        }
+
+        bool ShardedIotShadowClient::SubscribeToGetShadowRejected(
+            const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            OnSubscribeToGetShadowRejectedResponse &&handler,
+            const OnSubscribeComplete &onSubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->SubscribeToGetShadowRejected(request, qos, std::move(handler), onSubAck);
+        }
+
+        bool ShardedIotShadowClient::PublishGetShadow(
+            const Aws::Iotshadow::GetShadowRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->PublishGetShadow(request, qos, onPubAck);
+        }
+
+        bool ShardedIotShadowClient::PublishDeleteShadow(
+            const Aws::Iotshadow::DeleteShadowRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->PublishDeleteShadow(request, qos, onPubAck);
+        }
+
+        bool ShardedIotShadowClient::PublishUpdateShadow(
+            const Aws::Iotshadow::UpdateShadowRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->PublishUpdateShadow(request, qos, onPubAck);
+        }
+
+        bool ShardedIotShadowClient::PublishDeleteNamedShadow(
+            const Aws::Iotshadow::DeleteNamedShadowRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->PublishDeleteNamedShadow(request, qos, onPubAck);
+        }
+
+        bool ShardedIotShadowClient::PublishGetNamedShadow(
+            const Aws::Iotshadow::GetNamedShadowRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->PublishGetNamedShadow(request, qos, onPubAck);
+        }
+
+        bool ShardedIotShadowClient::PublishUpdateNamedShadow(
+            const Aws::Iotshadow::UpdateNamedShadowRequest &request,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            auto *shard = ShardFor(request.ThingName);
+            return shard && shard->PublishUpdateNamedShadow(request, qos, onPubAck);
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -0,0 +1,449 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShardedShadowDocument.h>
+
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/UpdateShadowResponse.h>
+
+#include <algorithm>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            /* A shard nobody has written yet has no shadow, which reads as empty rather than as a failure. */
+            const int32_t s_notFoundCode = 404;
+
+            struct SubscribeContext
+            {
+                SubscribeContext(const OnSubscribeComplete &onSubAck, size_t remaining)
+                    : OnSubAck(onSubAck), Remaining(remaining), FirstError(AWS_ERROR_SUCCESS)
+                {
+                }
+
+                std::mutex Lock;
+                OnSubscribeComplete OnSubAck;
+                size_t Remaining;
+                int FirstError;
+            };
+
+            /* Collects the outcome of one request per shard; Finish reports true for the last of them. */
+            struct RequestContext
+            {
+                explicit RequestContext(size_t remaining)
+                    : Remaining(remaining), Accepted(0), FirstError(AWS_ERROR_SUCCESS)
+                {
+                }
+
+                bool Finish(ErrorResponse *error, int ioErr)
+                {
+                    std::lock_guard<std::mutex> lock(Lock);
+                    if (ioErr != AWS_ERROR_SUCCESS && FirstError == AWS_ERROR_SUCCESS)
+                    {
+                        FirstError = ioErr;
+                    }
+                    else if (error && !FirstRejection.has_value())
+                    {
+                        FirstRejection = *error;
+                    }
+                    else if (!error && ioErr == AWS_ERROR_SUCCESS)
+                    {
+                        ++Accepted;
+                    }
+                    return --Remaining == 0;
+                }
+
+                std::mutex Lock;
+                size_t Remaining;
+                size_t Accepted;
+                int FirstError;
+                Crt::Optional<ErrorResponse> FirstRejection;
+            };
+
+            /* The merge patch that brings a shard's cached state to its slices; false when nothing changed. */
+            bool s_shardPatch(
+                const ShadowDocument &cache,
+                const Crt::Optional<Crt::JsonObject> &desired,
+                const Crt::Optional<Crt::JsonObject> &reported,
+                ShadowState &patch)
+            {
+                if (desired.has_value())
+                {
+                    patch.Desired = cache.DiffDesired(desired->View());
+                }
+                if (reported.has_value())
+                {
+                    patch.Reported = cache.DiffReported(reported->View());
+                }
+                return patch.Desired.has_value() || patch.Reported.has_value();
+            }
+        } // namespace
+
+        ShardedShadowDocumentConfig::ShardedShadowDocumentConfig() noexcept
+            : MaxUpdateAttempts(3), Qos(AWS_MQTT_QOS_AT_LEAST_ONCE), Requests()
+        {
+        }
+
+        ShardedShadowDocument::ShardedShadowDocument(
+            const IotShadowClient &client,
+            const Crt::String &thingName,
+            const ShardedShadowDocumentConfig &config,
+            Crt::Allocator *allocator) noexcept
+            : m_client(client), m_thingName(thingName), m_config(config), m_allocator(allocator)
+        {
+        }
+
+        std::shared_ptr<ShardedShadowDocument> ShardedShadowDocument::Create(
+            const IotShadowClient &client,
+            Crt::Io::EventLoopGroup &eventLoopGroup,
+            const Crt::String &thingName,
+            const ShardedShadowDocumentConfig &config,
+            Crt::Allocator *allocator)
+        {
+            if (config.ShadowNamesByKeyPrefix.empty())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat =
+                static_cast<ShardedShadowDocument *>(aws_mem_acquire(allocator, sizeof(ShardedShadowDocument)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) ShardedShadowDocument(client, thingName, config, allocator);
+            std::shared_ptr<ShardedShadowDocument> document(
+                toSeat, [allocator](ShardedShadowDocument *document) { Crt::Delete(document, allocator); });
+            return document->Init(eventLoopGroup) ? document : nullptr;
+        }
+
+        bool ShardedShadowDocument::Init(Crt::Io::EventLoopGroup &eventLoopGroup)
+        {
+            for (const auto &mapping : m_config.ShadowNamesByKeyPrefix)
+            {
+                const Crt::String &shadowName = mapping.second;
+                auto shard = std::find_if(m_shards.begin(), m_shards.end(), [&shadowName](const Shard &existing) {
+                    return existing.ShadowName == shadowName;
+                });
+                if (shard == m_shards.end())
+                {
+                    Shard created;
+                    created.ShadowName = mapping.second;
+                    created.Cache = ShadowDocument::CreateNamed(m_thingName, mapping.second, m_allocator);
+                    created.Requests = ShadowRequestCorrelator::CreateNamed(
+                        m_client, eventLoopGroup, m_thingName, mapping.second, m_config.Requests, m_allocator);
+                    if (!created.Cache || !created.Requests)
+                    {
+                        return false;
+                    }
+                    m_shards.push_back(std::move(created));
+                    shard = m_shards.end() - 1;
+                }
+                m_prefixes.emplace_back(mapping.first, static_cast<size_t>(shard - m_shards.begin()));
+            }
+
+            std::sort(
+                m_prefixes.begin(),
+                m_prefixes.end(),
+                [](const std::pair<Crt::String, size_t> &lhs, const std::pair<Crt::String, size_t> &rhs) {
+                    return lhs.first.size() > rhs.first.size();
+                });
+            return true;
+        }
+
+        int ShardedShadowDocument::GetShardFor(const Crt::String &key) const
+        {
+            for (const auto &prefix : m_prefixes)
+            {
+                if (key.compare(0, prefix.first.size(), prefix.first) == 0)
+                {
+                    return static_cast<int>(prefix.second);
+                }
+            }
+            return -1;
+        }
+
+        const Crt::String *ShardedShadowDocument::GetShadowNameFor(const Crt::String &key) const
+        {
+            int shard = GetShardFor(key);
+            return shard < 0 ? nullptr : &m_shards[shard].ShadowName;
+        }
+
+        bool ShardedShadowDocument::Split(const Crt::JsonView &document, Crt::Vector<Crt::JsonObject> &slices) const
+        {
+            if (!document.IsObject())
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            slices.assign(m_shards.size(), Crt::JsonObject());
+            for (const auto &entry : document.GetAllObjects())
+            {
+                int shard = GetShardFor(entry.first);
+                if (shard < 0)
+                {
+                    aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                    return false;
+                }
+                slices[shard].WithObject(entry.first, entry.second.Materialize());
+            }
+            return true;
+        }
+
+        Crt::Optional<Crt::JsonObject> ShardedShadowDocument::Assemble(bool desired) const
+        {
+            Crt::Optional<Crt::JsonObject> merged;
+            for (const Shard &shard : m_shards)
+            {
+                Crt::Optional<Crt::JsonObject> slice = desired ? shard.Cache->GetDesired() : shard.Cache->GetReported();
+                if (!slice.has_value())
+                {
+                    continue;
+                }
+                if (!merged.has_value())
+                {
+                    merged = Crt::JsonObject();
+                }
+                for (const auto &entry : slice->View().GetAllObjects())
+                {
+                    merged->WithObject(entry.first, entry.second.Materialize());
+                }
+            }
+            return merged;
+        }
+
+        Crt::Optional<Crt::JsonObject> ShardedShadowDocument::GetDesired() const
+        {
+            return Assemble(true);
+        }
+
+        Crt::Optional<Crt::JsonObject> ShardedShadowDocument::GetReported() const
+        {
+            return Assemble(false);
+        }
+
+        bool ShardedShadowDocument::Subscribe(const OnSubscribeComplete &onSubAck)
+        {
+            auto context = Crt::MakeShared<SubscribeContext>(m_allocator, onSubAck, m_shards.size());
+            if (!context)
+            {
+                return false;
+            }
+
+            auto onEachSubAck = [context](int ioErr) {
+                OnSubscribeComplete onAllSubAcked;
+                int result = AWS_ERROR_SUCCESS;
+                {
+                    std::lock_guard<std::mutex> lock(context->Lock);
+                    if (ioErr != AWS_ERROR_SUCCESS && context->FirstError == AWS_ERROR_SUCCESS)
+                    {
+                        context->FirstError = ioErr;
+                    }
+                    if (--context->Remaining == 0)
+                    {
+                        onAllSubAcked = context->OnSubAck;
+                        result = context->FirstError;
+                    }
+                }
+
+                if (onAllSubAcked)
+                {
+                    onAllSubAcked(result);
+                }
+            };
+
+            for (Shard &shard : m_shards)
+            {
+                if (!shard.Requests->Subscribe(m_config.Qos, onEachSubAck))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool ShardedShadowDocument::GetAsync(const OnShardedShadowFetched &onComplete)
+        {
+            auto context = Crt::MakeShared<RequestContext>(m_allocator, m_shards.size());
+            if (!context)
+            {
+                return false;
+            }
+
+            std::weak_ptr<ShardedShadowDocument> weakDocument = shared_from_this();
+            for (Shard &shard : m_shards)
+            {
+                std::shared_ptr<ShadowDocument> cache = shard.Cache;
+                auto onShardComplete = [weakDocument, context, cache, onComplete](
+                                           GetShadowResponse *response, ErrorResponse *error, int ioErr) {
+                    if (response)
+                    {
+                        cache->Apply(*response);
+                    }
+                    else if (error && error->Code.has_value() && *error->Code == s_notFoundCode)
+                    {
+                        cache->Clear();
+                        error = nullptr;
+                    }
+
+                    if (!context->Finish(error, ioErr) || !onComplete)
+                    {
+                        return;
+                    }
+
+                    auto document = weakDocument.lock();
+                    if (context->FirstError != AWS_ERROR_SUCCESS || !document)
+                    {
+                        onComplete(nullptr, nullptr, document ? context->FirstError : AWS_ERROR_INVALID_STATE);
+                    }
+                    else if (context->FirstRejection.has_value())
+                    {
+                        onComplete(nullptr, &*context->FirstRejection, AWS_ERROR_SUCCESS);
+                    }
+                    else
+                    {
+                        ShadowState state;
+                        state.Desired = document->Assemble(true);
+                        state.Reported = document->Assemble(false);
+                        onComplete(&state, nullptr, AWS_ERROR_SUCCESS);
+                    }
+                };
+
+                if (!shard.Requests->GetShadowAsync(m_config.Qos, onShardComplete))
+                {
+                    onShardComplete(nullptr, nullptr, Crt::LastErrorOrUnknown());
+                }
+            }
+            return true;
+        }
+
+        bool ShardedShadowDocument::UpdateAsync(const ShadowState &state, const OnShardedShadowUpdated &onComplete)
+        {
+            Crt::Vector<Crt::JsonObject> desiredSlices;
+            Crt::Vector<Crt::JsonObject> reportedSlices;
+            if ((state.Desired.has_value() && !Split(state.Desired->View(), desiredSlices)) ||
+                (state.Reported.has_value() && !Split(state.Reported->View(), reportedSlices)))
+            {
+                return false;
+            }
+
+            struct ShardUpdate
+            {
+                size_t Index;
+                ShadowState Patch;
+                Crt::Optional<Crt::JsonObject> Desired;
+                Crt::Optional<Crt::JsonObject> Reported;
+            };
+            Crt::Vector<ShardUpdate> updates;
+            for (size_t i = 0; i < m_shards.size(); ++i)
+            {
+                ShardUpdate update;
+                update.Index = i;
+                if (state.Desired.has_value())
+                {
+                    update.Desired = std::move(desiredSlices[i]);
+                }
+                if (state.Reported.has_value())
+                {
+                    update.Reported = std::move(reportedSlices[i]);
+                }
+                if (s_shardPatch(*m_shards[i].Cache, update.Desired, update.Reported, update.Patch))
+                {
+                    updates.push_back(std::move(update));
+                }
+            }
+
+            if (updates.empty())
+            {
+                if (onComplete)
+                {
+                    onComplete(0, nullptr, AWS_ERROR_SUCCESS);
+                }
+                return true;
+            }
+
+            auto context = Crt::MakeShared<RequestContext>(m_allocator, updates.size());
+            if (!context)
+            {
+                return false;
+            }
+
+            for (ShardUpdate &update : updates)
+            {
+                std::shared_ptr<ShadowDocument> cache = m_shards[update.Index].Cache;
+                auto onShardComplete = [context, cache, onComplete](
+                                           UpdateShadowResponse *response, ErrorResponse *error, int ioErr) {
+                    if (response)
+                    {
+                        cache->Apply(*response);
+                    }
+
+                    if (context->Finish(error, ioErr) && onComplete)
+                    {
+                        ErrorResponse *rejection =
+                            context->FirstRejection.has_value() ? &*context->FirstRejection : nullptr;
+                        onComplete(context->Accepted, rejection, context->FirstError);
+                    }
+                };
+
+                if (!UpdateShard(
+                        m_shards[update.Index],
+                        update.Patch,
+                        update.Desired,
+                        update.Reported,
+                        onShardComplete))
+                {
+                    onShardComplete(nullptr, nullptr, Crt::LastErrorOrUnknown());
+                }
+            }
+            return true;
+        }
+
+        bool ShardedShadowDocument::UpdateShard(
+            Shard &shard,
+            const ShadowState &patch,
+            const Crt::Optional<Crt::JsonObject> &desired,
+            const Crt::Optional<Crt::JsonObject> &reported,
+            const OnUpdateShadowComplete &onShardComplete)
+        {
+            Crt::Optional<int32_t> version = shard.Cache->GetVersion();
+            if (!version.has_value())
+            {
+                /* Not fetched yet, so there is no version to guard against concurrent writers with. */
+                return shard.Requests->UpdateShadowAsync(patch, version, m_config.Qos, onShardComplete);
+            }
+
+            std::shared_ptr<ShadowDocument> cache = shard.Cache;
+            auto onConflict = [cache, desired, reported](const GetShadowResponse &current, ShadowState &retry) {
+                cache->Apply(current);
+                ShadowState rebuilt;
+                /* If the shard already holds the slices, resending the same patch is harmless. */
+                if (s_shardPatch(*cache, desired, reported, rebuilt))
+                {
+                    retry = std::move(rebuilt);
+                }
+                return true;
+            };
+            return shard.Requests->UpdateShadowWithRetryAsync(
+                patch, *version, m_config.MaxUpdateAttempts, m_config.Qos, onShardComplete, onConflict);
+        }
+
+        void ShardedShadowDocument::CancelAll(int errorCode)
+        {
+            for (Shard &shard : m_shards)
+            {
+                shard.Requests->CancelAll(errorCode);
+            }
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
@@ -0,0 +1,393 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/SharedShadowCache.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        namespace
+        {
+            const uint32_t s_magic = 0x53484443; /* "SHDC" */
+            const uint32_t s_layout = 1;
+            const size_t s_slotAlignment = 64;
+            const size_t s_headerSize = 64;
+            /* A read overlapping this many writes in a row gives up; the writer may have died mid-write. */
+            const int s_maxReadAttempts = 1000;
+
+            struct RegionHeader
+            {
+                std::atomic<uint32_t> Magic;
+                uint32_t Layout;
+                uint32_t SlotCount;
+                uint32_t SlotSize;
+            };
+
+            /*
+             * Odd while the slot is being written. The lengths are atomics too, since readers load them while
+             * the writer may be storing them; a reader only trusts them once the sequence is unchanged.
+             */
+            struct SlotHeader
+            {
+                std::atomic<uint32_t> Sequence;
+                std::atomic<uint32_t> KeyLength;
+                std::atomic<uint32_t> ValueLength;
+                uint32_t Reserved;
+            };
+
+            /* Both live in memory mapped by several processes, which needs atomics that never use a lock. */
+            static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "atomic layout");
+            static_assert(sizeof(RegionHeader) <= s_headerSize, "region header size");
+
+            uint32_t s_hash(const Crt::String &key) noexcept
+            {
+                /* FNV-1a */
+                uint32_t hash = 2166136261u;
+                for (char c : key)
+                {
+                    hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+                }
+                return hash;
+            }
+
+            /* Copies out a slot's key and value as of one complete write; false if no read was consistent. */
+            bool s_readSlot(const uint8_t *slot, uint32_t slotSize, Crt::String &key, Crt::String &value)
+            {
+                const auto *header = reinterpret_cast<const SlotHeader *>(slot);
+                const char *data = reinterpret_cast<const char *>(slot + sizeof(SlotHeader));
+                const uint32_t capacity = slotSize - static_cast<uint32_t>(sizeof(SlotHeader));
+
+                for (int attempt = 0; attempt < s_maxReadAttempts; ++attempt)
+                {
+                    uint32_t before = header->Sequence.load(std::memory_order_acquire);
+                    if (before & 1)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    uint32_t keyLength = header->KeyLength.load(std::memory_order_relaxed);
+                    uint32_t valueLength = header->ValueLength.load(std::memory_order_relaxed);
+                    bool fits = keyLength <= capacity && valueLength <= capacity - keyLength;
+                    if (fits)
+                    {
+                        key.assign(data, keyLength);
+                        value.assign(data + keyLength, valueLength);
+                    }
+
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (fits && header->Sequence.load(std::memory_order_relaxed) == before)
+                    {
+                        return true;
+                    }
+                }
+
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return false;
+            }
+        } // namespace
+
+        SharedShadowCacheConfig::SharedShadowCacheConfig() noexcept : SlotCount(64), SlotSize(8192) {}
+
+        SharedShadowCache::SharedShadowCache(Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_region(nullptr), m_regionSize(0), m_writable(false), m_slotCount(0),
+              m_slotSize(0)
+        {
+        }
+
+        SharedShadowCache::~SharedShadowCache()
+        {
+#ifndef _WIN32
+            if (m_region)
+            {
+                munmap(m_region, m_regionSize);
+            }
+#endif
+        }
+
+        std::shared_ptr<SharedShadowCache> SharedShadowCache::Create(
+            const SharedShadowCacheConfig &config,
+            Crt::Allocator *allocator)
+        {
+            uint32_t slotSize =
+                static_cast<uint32_t>((config.SlotSize + s_slotAlignment - 1) / s_slotAlignment * s_slotAlignment);
+            if (config.Path.empty() || config.SlotCount == 0 || slotSize <= sizeof(SlotHeader))
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return nullptr;
+            }
+
+            auto *toSeat = static_cast<SharedShadowCache *>(aws_mem_acquire(allocator, sizeof(SharedShadowCache)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) SharedShadowCache(allocator);
+            std::shared_ptr<SharedShadowCache> cache(
+                toSeat, [allocator](SharedShadowCache *sharedCache) { Crt::Delete(sharedCache, allocator); });
+            if (!cache->Map(config.Path.c_str(), true, config.SlotCount, slotSize))
+            {
+                return nullptr;
+            }
+            return cache;
+        }
+
+        std::shared_ptr<SharedShadowCache> SharedShadowCache::Open(const char *path, Crt::Allocator *allocator)
+        {
+            auto *toSeat = static_cast<SharedShadowCache *>(aws_mem_acquire(allocator, sizeof(SharedShadowCache)));
+            if (!toSeat)
+            {
+                return nullptr;
+            }
+
+            toSeat = new (toSeat) SharedShadowCache(allocator);
+            std::shared_ptr<SharedShadowCache> cache(
+                toSeat, [allocator](SharedShadowCache *sharedCache) { Crt::Delete(sharedCache, allocator); });
+            if (!cache->Map(path, false, 0, 0))
+            {
+                return nullptr;
+            }
+            return cache;
+        }
+
+#ifdef _WIN32
+        bool SharedShadowCache::Map(const char *, bool, uint32_t, uint32_t)
+        {
+            aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+            return false;
+        }
+#else
+        bool SharedShadowCache::Map(const char *path, bool writable, uint32_t slotCount, uint32_t slotSize)
+        {
+            /* A new region is laid out under a temporary name and renamed into place, so readers of the
+             * previous one never see it truncated under them. */
+            Crt::String tempPath(path);
+            tempPath.append(".tmp");
+            if (writable)
+            {
+                unlink(tempPath.c_str());
+            }
+            int fd = writable ? open(tempPath.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600) : open(path, O_RDONLY);
+            if (fd < 0)
+            {
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+
+            size_t regionSize = s_headerSize + static_cast<size_t>(slotCount) * slotSize;
+            struct stat status;
+            bool sized = writable ? ftruncate(fd, static_cast<off_t>(regionSize)) == 0
+                                  : fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) >= s_headerSize;
+            if (!writable && sized)
+            {
+                regionSize = static_cast<size_t>(status.st_size);
+            }
+
+            void *region = MAP_FAILED;
+            if (sized)
+            {
+                region = mmap(nullptr, regionSize, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+            }
+            /* The mapping keeps the file open. */
+            close(fd);
+            if (region == MAP_FAILED)
+            {
+                if (writable)
+                {
+                    unlink(tempPath.c_str());
+                }
+                aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                return false;
+            }
+
+            m_region = static_cast<uint8_t *>(region);
+            m_regionSize = regionSize;
+            m_writable = writable;
+
+            auto *header = reinterpret_cast<RegionHeader *>(m_region);
+            if (writable)
+            {
+                /* The file is new, so every slot starts empty. */
+                header->Layout = s_layout;
+                header->SlotCount = slotCount;
+                header->SlotSize = slotSize;
+                header->Magic.store(s_magic, std::memory_order_release);
+                if (rename(tempPath.c_str(), path) != 0)
+                {
+                    unlink(tempPath.c_str());
+                    aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+                    return false;
+                }
+            }
+            else if (
+                header->Magic.load(std::memory_order_acquire) != s_magic || header->Layout != s_layout ||
+                header->SlotSize <= sizeof(SlotHeader) ||
+                s_headerSize + static_cast<size_t>(header->SlotCount) * header->SlotSize > regionSize)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return false;
+            }
+
+            m_slotCount = header->SlotCount;
+            m_slotSize = header->SlotSize;
+            return true;
+        }
+#endif
+
+        uint8_t *SharedShadowCache::GetSlot(uint32_t index) const noexcept
+        {
+            return m_region + s_headerSize + static_cast<size_t>(index) * m_slotSize;
+        }
+
+        Crt::String SharedShadowCache::s_key(const Crt::String &thingName, const Crt::Optional<Crt::String> &shadowName)
+        {
+            Crt::String key(thingName);
+            if (shadowName.has_value())
+            {
+                key.push_back('/');
+                key.append(*shadowName);
+            }
+            return key;
+        }
+
+        bool SharedShadowCache::Publish(const ShadowDocument &document)
+        {
+            return Write(document.GetThingName(), document.GetShadowName(), *document.GetSnapshot());
+        }
+
+        bool SharedShadowCache::Mirror(const std::shared_ptr<ShadowDocument> &document)
+        {
+            if (!m_writable)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return false;
+            }
+
+            std::weak_ptr<SharedShadowCache> weakCache = shared_from_this();
+            document->SetOnSnapshotPublished(
+                [weakCache](
+                    const ShadowDocument &published, const std::shared_ptr<const ShadowDocument::Snapshot> &snapshot) {
+                    auto cache = weakCache.lock();
+                    if (cache)
+                    {
+                        /* A snapshot that does not fit leaves readers the previous one. */
+                        cache->Write(published.GetThingName(), published.GetShadowName(), *snapshot);
+                    }
+                });
+            return true;
+        }
+
+        bool SharedShadowCache::Write(
+            const Crt::String &thingName,
+            const Crt::Optional<Crt::String> &shadowName,
+            const ShadowDocument::Snapshot &snapshot)
+        {
+            if (!m_writable)
+            {
+                aws_raise_error(AWS_ERROR_INVALID_STATE);
+                return false;
+            }
+
+            Crt::String key = s_key(thingName, shadowName);
+            Crt::String value = ShadowDocument::EncodeSnapshot(thingName, shadowName, snapshot);
+            const uint32_t capacity = m_slotSize - static_cast<uint32_t>(sizeof(SlotHeader));
+            if (key.size() > capacity || value.size() > capacity - key.size())
+            {
+                aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_writeLock);
+
+            /* Open addressing with linear probing; a slot, once claimed, keeps its shadow for the region's life.
+             * Only this process writes, so it reads its own slots without the sequence check. */
+            uint8_t *slot = nullptr;
+            uint32_t start = s_hash(key) % m_slotCount;
+            for (uint32_t probe = 0; probe < m_slotCount && !slot; ++probe)
+            {
+                uint8_t *candidate = GetSlot((start + probe) % m_slotCount);
+                const auto *header = reinterpret_cast<const SlotHeader *>(candidate);
+                uint32_t keyLength = header->KeyLength.load(std::memory_order_relaxed);
+                if (keyLength == 0 ||
+                    (keyLength == key.size() && memcmp(candidate + sizeof(SlotHeader), key.data(), keyLength) == 0))
+                {
+                    slot = candidate;
+                }
+            }
+            if (!slot)
+            {
+                aws_raise_error(AWS_ERROR_LIST_EXCEEDS_MAX_SIZE);
+                return false;
+            }
+
+            auto *header = reinterpret_cast<SlotHeader *>(slot);
+            uint8_t *data = slot + sizeof(SlotHeader);
+            uint32_t sequence = header->Sequence.load(std::memory_order_relaxed);
+            header->Sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            header->KeyLength.store(static_cast<uint32_t>(key.size()), std::memory_order_relaxed);
+            header->ValueLength.store(static_cast<uint32_t>(value.size()), std::memory_order_relaxed);
+            memcpy(data, key.data(), key.size());
+            memcpy(data + key.size(), value.data(), value.size());
+
+            header->Sequence.store(sequence + 2, std::memory_order_release);
+            return true;
+        }
+
+        std::shared_ptr<const ShadowDocument::Snapshot> SharedShadowCache::Read(
+            const Crt::String &thingName,
+            const Crt::Optional<Crt::String> &shadowName) const
+        {
+            Crt::String wanted = s_key(thingName, shadowName);
+            Crt::String key;
+            Crt::String value;
+            uint32_t start = s_hash(wanted) % m_slotCount;
+            for (uint32_t probe = 0; probe < m_slotCount; ++probe)
+            {
+                if (!s_readSlot(GetSlot((start + probe) % m_slotCount), m_slotSize, key, value))
+                {
+                    return nullptr;
+                }
+                if (key.empty())
+                {
+                    break;
+                }
+                if (key != wanted)
+                {
+                    continue;
+                }
+
+                auto snapshot = Crt::MakeShared<ShadowDocument::Snapshot>(m_allocator);
+                Crt::String decodedThingName;
+                Crt::Optional<Crt::String> decodedShadowName;
+                if (!snapshot ||
+                    !ShadowDocument::DecodeSnapshot(value, decodedThingName, decodedShadowName, *snapshot, m_allocator))
+                {
+                    return nullptr;
+                }
+                return snapshot;
+            }
+
+            aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            return nullptr;
+        }
+
+    } // namespace Iotshadow
+
+} // namespace Aws
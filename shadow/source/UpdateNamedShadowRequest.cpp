@@ -4,52 +4,37 @@
  */
 #include <aws/iotshadow/UpdateNamedShadowRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotshadow
     {
-
-        void UpdateNamedShadowRequest::LoadFromObject(UpdateNamedShadowRequest &val, const Aws::Crt::JsonView &doc)
+        namespace
         {
-            (void)val;
-            (void)doc;
+            using Fields = Aws::Iotdevicecommon::ModelFields<UpdateNamedShadowRequest, true>;
+            using ShadowStateCodec = Aws::Iotdevicecommon::ModelCodec<ShadowState>;
 
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
+            constexpr Aws::Iotdevicecommon::ModelField<UpdateNamedShadowRequest> s_fields[] = {
+                Fields::Field<Crt::String, &UpdateNamedShadowRequest::ClientToken>("clientToken"),
+                Fields::Field<ShadowState, &UpdateNamedShadowRequest::State, ShadowStateCodec>("state"),
+                Fields::Field<int32_t, &UpdateNamedShadowRequest::Version>("version"),
+            };
+        } // namespace
 
-            if (doc.ValueExists("state"))
-            {
-                val.State = doc.GetJsonObject("state");
-            }
-
-            if (doc.ValueExists("version"))
-            {
-                val.Version = doc.GetInteger("version");
-            }
+        void UpdateNamedShadowRequest::LoadFromObject(UpdateNamedShadowRequest &val, const Aws::Crt::JsonView &doc)
+        {
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void UpdateNamedShadowRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
-
-            if (State)
-            {
-                Aws::Crt::JsonObject jsonObject;
-                State->SerializeToObject(jsonObject);
-                object.WithObject("state", std::move(jsonObject));
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (Version)
-            {
-                object.WithInteger("version", *Version);
-            }
+        void UpdateNamedShadowRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         UpdateNamedShadowRequest::UpdateNamedShadowRequest(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
@@ -4,52 +4,37 @@
  */
 #include <aws/iotshadow/UpdateShadowRequest.h>
 
+#include <aws/iotdevicecommon/ModelFields.h>
+
 namespace Aws
 {
     namespace Iotshadow
     {
-
-        void UpdateShadowRequest::LoadFromObject(UpdateShadowRequest &val, const Aws::Crt::JsonView &doc)
+        namespace
         {
-            (void)val;
-            (void)doc;
+            using Fields = Aws::Iotdevicecommon::ModelFields<UpdateShadowRequest, true>;
+            using ShadowStateCodec = Aws::Iotdevicecommon::ModelCodec<ShadowState>;
 
-            if (doc.ValueExists("state"))
-            {
-                val.State = doc.GetJsonObject("state");
-            }
+            constexpr Aws::Iotdevicecommon::ModelField<UpdateShadowRequest> s_fields[] = {
+                Fields::Field<ShadowState, &UpdateShadowRequest::State, ShadowStateCodec>("state"),
+                Fields::Field<int32_t, &UpdateShadowRequest::Version>("version"),
+                Fields::Field<Crt::String, &UpdateShadowRequest::ClientToken>("clientToken"),
+            };
+        } // namespace
 
-            if (doc.ValueExists("version"))
-            {
-                val.Version = doc.GetInteger("version");
-            }
-
-            if (doc.ValueExists("clientToken"))
-            {
-                val.ClientToken = doc.GetString("clientToken");
-            }
+        void UpdateShadowRequest::LoadFromObject(UpdateShadowRequest &val, const Aws::Crt::JsonView &doc)
+        {
+            Aws::Iotdevicecommon::LoadFields(val, s_fields, doc);
         }
 
         void UpdateShadowRequest::SerializeToObject(Aws::Crt::JsonObject &object) const
         {
-            (void)object;
-
-            if (State)
-            {
-                Aws::Crt::JsonObject jsonObject;
-                State->SerializeToObject(jsonObject);
-                object.WithObject("state", std::move(jsonObject));
-            }
-
-            if (Version)
-            {
-                object.WithInteger("version", *Version);
-            }
+            Aws::Iotdevicecommon::SaveFields(*this, s_fields, object);
+        }
 
-            if (ClientToken)
-            {
-                object.WithString("clientToken", *ClientToken);
-            }
+        void UpdateShadowRequest::SerializeTo(Aws::Iotdevicecommon::PayloadWriter &writer) const
+        {
+            Aws::Iotdevicecommon::WriteFields(*this, s_fields, writer);
         }
 
         UpdateShadowRequest::UpdateShadowRequest(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
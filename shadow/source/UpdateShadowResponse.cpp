@@ -9,7 +9,10 @@ namespace Aws
     namespace Iotshadow
     {
 
-        void UpdateShadowResponse::LoadFromObject(UpdateShadowResponse &val, const Aws::Crt::JsonView &doc)
+        void UpdateShadowResponse::LoadFromObject(
+            UpdateShadowResponse &val,
+            const Aws::Crt::JsonView &doc,
+            ShadowMetadataMode metadataMode)
         {
             (void)val;
             (void)doc;
@@ -29,14 +32,14 @@ namespace Aws
                 val.Version = doc.GetInteger("version");
             }
 
-            if (doc.ValueExists("metadata"))
+            if (doc.ValueExists("metadata") && metadataMode != ShadowMetadataMode::Skip)
             {
-                val.Metadata = doc.GetJsonObject("metadata");
+                val.Metadata = ShadowMetadata(doc.GetJsonObject("metadata"), metadataMode);
             }
 
             if (doc.ValueExists("timestamp"))
             {
-                val.Timestamp = doc.GetDouble("timestamp");
+                val.Timestamp = Aws::Iotdevicecommon::PackedDateTime::FromSeconds(doc.GetDouble("timestamp"));
             }
         }
 
@@ -70,11 +73,19 @@ namespace Aws
 
             if (Timestamp)
             {
-                object.WithDouble("timestamp", Timestamp->SecondsWithMSPrecision());
+                object.WithDouble("timestamp", Timestamp.Seconds());
             }
         }
 
-        UpdateShadowResponse::UpdateShadowResponse(const Crt::JsonView &doc) { LoadFromObject(*this, doc); }
+        UpdateShadowResponse::UpdateShadowResponse(const Crt::JsonView &doc)
+        {
+            LoadFromObject(*this, doc, ShadowMetadataMode::Full);
+        }
+
+        UpdateShadowResponse::UpdateShadowResponse(const Crt::JsonView &doc, ShadowMetadataMode metadataMode)
+        {
+            LoadFromObject(*this, doc, metadataMode);
+        }
 
         UpdateShadowResponse &UpdateShadowResponse::operator=(const Crt::JsonView &doc)
         {
@@ -0,0 +1,179 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/ShadowDocument.h>
+#include <aws/testing/aws_test_harness.h>
+
+namespace
+{
+    /* A document holding the state of a GetShadow response, as if the service had just sent it. */
+    std::shared_ptr<Aws::Iotshadow::ShadowDocument> s_cachedDocument(Aws::Crt::Allocator *allocator)
+    {
+        Aws::Crt::JsonObject response(Aws::Crt::String(
+            "{\"version\":3,\"state\":{"
+            "\"desired\":{\"color\":\"red\"},"
+            "\"reported\":{\"color\":\"red\",\"light\":{\"on\":true,\"level\":{\"value\":5,\"unit\":\"%\"}},"
+            "\"mode\":\"auto\",\"levels\":[1,2,3],\"tags\":{\"zone\":\"eu\"}}}}"));
+        auto document = Aws::Iotshadow::ShadowDocument::Create("TestThing", allocator);
+        if (document && response.WasParseSuccessful())
+        {
+            document->Apply(Aws::Iotshadow::GetShadowResponse(response.View()));
+        }
+        return document;
+    }
+
+    /* Whether `patch` is exactly the JSON `expected`, whatever order its keys were written in. */
+    bool s_isPatch(const Aws::Crt::Optional<Aws::Crt::JsonObject> &patch, const char *expected)
+    {
+        Aws::Crt::JsonObject expectedPatch{Aws::Crt::String(expected)};
+        return patch.has_value() && expectedPatch.WasParseSuccessful() && *patch == expectedPatch;
+    }
+
+    Aws::Crt::JsonObject s_reported(const char *state)
+    {
+        return Aws::Crt::JsonObject(Aws::Crt::String(state));
+    }
+} // namespace
+
+static int s_TestShadowDocumentMergePatchNested(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        auto document = s_cachedDocument(allocator);
+        ASSERT_NOT_NULL(document.get());
+        ASSERT_TRUE(document->GetVersion().has_value());
+
+        /* Only the changed leaf goes out, under the objects that lead to it, and none of its siblings. */
+        Aws::Crt::JsonObject reported = s_reported(
+            "{\"color\":\"red\",\"light\":{\"on\":true,\"level\":{\"value\":7,\"unit\":\"%\"}},"
+            "\"mode\":\"auto\",\"levels\":[1,2,3],\"tags\":{\"zone\":\"eu\"}}");
+        ASSERT_TRUE(s_isPatch(document->DiffReported(reported.View()), "{\"light\":{\"level\":{\"value\":7}}}"));
+
+        /* New keys, nested or not, carry their whole value. */
+        reported = s_reported(
+            "{\"color\":\"red\",\"light\":{\"on\":true,\"level\":{\"value\":5,\"unit\":\"%\"},\"hue\":{\"h\":1}},"
+            "\"mode\":\"auto\",\"levels\":[1,2,3],\"tags\":{\"zone\":\"eu\"},\"fan\":{\"speed\":2}}");
+        ASSERT_TRUE(s_isPatch(
+            document->DiffReported(reported.View()), "{\"light\":{\"hue\":{\"h\":1}},\"fan\":{\"speed\":2}}"));
+
+        /* A key that changes between an object and a scalar is replaced, not diffed. */
+        reported = s_reported(
+            "{\"color\":{\"r\":255},\"light\":\"off\",\"mode\":\"auto\",\"levels\":[1,2,3],"
+            "\"tags\":{\"zone\":\"eu\"}}");
+        ASSERT_TRUE(s_isPatch(document->DiffReported(reported.View()), "{\"color\":{\"r\":255},\"light\":\"off\"}"));
+
+        /* Desired is diffed against the cached desired state, not the reported one. */
+        Aws::Crt::JsonObject desired = s_reported("{\"color\":\"red\",\"mode\":\"manual\"}");
+        ASSERT_TRUE(s_isPatch(document->DiffDesired(desired.View()), "{\"mode\":\"manual\"}"));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowDocumentMergePatchNested, s_TestShadowDocumentMergePatchNested)
+
+static int s_TestShadowDocumentMergePatchRemovedKeys(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        auto document = s_cachedDocument(allocator);
+        ASSERT_NOT_NULL(document.get());
+
+        /* Removed keys are sent as null, at the top level and inside nested objects. */
+        Aws::Crt::JsonObject reported = s_reported(
+            "{\"color\":\"red\",\"light\":{\"on\":true,\"level\":{\"value\":5}},\"levels\":[1,2,3],"
+            "\"tags\":{\"zone\":\"eu\"}}");
+        ASSERT_TRUE(s_isPatch(
+            document->DiffReported(reported.View()), "{\"mode\":null,\"light\":{\"level\":{\"unit\":null}}}"));
+
+        /* Emptying a nested object removes each of its keys rather than the object itself. */
+        reported = s_reported(
+            "{\"color\":\"red\",\"light\":{\"on\":true,\"level\":{\"value\":5,\"unit\":\"%\"}},"
+            "\"mode\":\"auto\",\"levels\":[1,2,3],\"tags\":{}}");
+        ASSERT_TRUE(s_isPatch(document->DiffReported(reported.View()), "{\"tags\":{\"zone\":null}}"));
+
+        /* Without any cached state, nothing is removed and everything is sent. */
+        auto empty = Aws::Iotshadow::ShadowDocument::Create("TestThing", allocator);
+        ASSERT_NOT_NULL(empty.get());
+        reported = s_reported("{\"color\":\"red\"}");
+        ASSERT_TRUE(s_isPatch(empty->DiffReported(reported.View()), "{\"color\":\"red\"}"));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowDocumentMergePatchRemovedKeys, s_TestShadowDocumentMergePatchRemovedKeys)
+
+static int s_TestShadowDocumentMergePatchArrays(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        auto document = s_cachedDocument(allocator);
+        ASSERT_NOT_NULL(document.get());
+
+        /* A merge patch cannot address array elements, so a changed array goes out whole. */
+        Aws::Crt::JsonObject reported = s_reported(
+            "{\"color\":\"red\",\"light\":{\"on\":true,\"level\":{\"value\":5,\"unit\":\"%\"}},"
+            "\"mode\":\"auto\",\"levels\":[1,2,4],\"tags\":{\"zone\":\"eu\"}}");
+        ASSERT_TRUE(s_isPatch(document->DiffReported(reported.View()), "{\"levels\":[1,2,4]}"));
+
+        /* So does a shortened or reordered one. */
+        reported = s_reported(
+            "{\"color\":\"red\",\"light\":{\"on\":true,\"level\":{\"value\":5,\"unit\":\"%\"}},"
+            "\"mode\":\"auto\",\"levels\":[3,2],\"tags\":{\"zone\":\"eu\"}}");
+        ASSERT_TRUE(s_isPatch(document->DiffReported(reported.View()), "{\"levels\":[3,2]}"));
+
+        /* An array of objects is compared whole too, and left out when equal. */
+        reported = s_reported(
+            "{\"color\":\"red\",\"light\":{\"on\":true,\"level\":{\"value\":5,\"unit\":\"%\"}},"
+            "\"mode\":\"auto\",\"levels\":[{\"a\":1}],\"tags\":{\"zone\":\"eu\"}}");
+        ASSERT_TRUE(s_isPatch(document->DiffReported(reported.View()), "{\"levels\":[{\"a\":1}]}"));
+        Aws::Crt::JsonObject from(Aws::Crt::String("{\"list\":[{\"a\":1},{\"b\":[2]}]}"));
+        Aws::Crt::JsonObject to(Aws::Crt::String("{\"list\":[{\"a\":1},{\"b\":[2]}]}"));
+        ASSERT_FALSE(Aws::Iotshadow::ShadowDocument::CreateMergePatch(from.View(), to.View()).has_value());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowDocumentMergePatchArrays, s_TestShadowDocumentMergePatchArrays)
+
+static int s_TestShadowDocumentMergePatchUnchanged(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        auto document = s_cachedDocument(allocator);
+        ASSERT_NOT_NULL(document.get());
+
+        /* The cached state itself, with its keys in another order, needs no update at all. */
+        Aws::Crt::JsonObject reported = s_reported(
+            "{\"tags\":{\"zone\":\"eu\"},\"levels\":[1,2,3],\"mode\":\"auto\","
+            "\"light\":{\"level\":{\"unit\":\"%\",\"value\":5},\"on\":true},\"color\":\"red\"}");
+        ASSERT_FALSE(document->DiffReported(reported.View()).has_value());
+        Aws::Crt::JsonObject desired = s_reported("{\"color\":\"red\"}");
+        ASSERT_FALSE(document->DiffDesired(desired.View()).has_value());
+
+        /* Nor does an empty state against an empty document. */
+        auto empty = Aws::Iotshadow::ShadowDocument::Create("TestThing", allocator);
+        ASSERT_NOT_NULL(empty.get());
+        Aws::Crt::JsonObject nothing;
+        ASSERT_FALSE(empty->DiffReported(nothing.View()).has_value());
+
+        /* A state that is not an object is refused rather than diffed. */
+        Aws::Crt::JsonObject scalar(Aws::Crt::String("5"));
+        ASSERT_FALSE(document->DiffReported(scalar.View()).has_value());
+        ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowDocumentMergePatchUnchanged, s_TestShadowDocumentMergePatchUnchanged)
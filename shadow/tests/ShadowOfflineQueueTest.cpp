@@ -0,0 +1,218 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <aws/mqtt/mqtt.h>
+
+#include <cstdio>
+
+namespace
+{
+    const char *s_queuePath = "ShadowOfflineQueueTest.queue";
+
+    void s_removeQueue()
+    {
+        remove(s_queuePath);
+        remove("ShadowOfflineQueueTest.queue.tmp");
+    }
+
+    long s_fileSize(const char *path)
+    {
+        FILE *file = fopen(path, "rb");
+        if (!file)
+        {
+            return -1;
+        }
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fclose(file);
+        return size;
+    }
+
+    /* Rewrites the first `size` bytes of the queue file, with the byte at `flip` inverted if it is in range. */
+    bool s_damageQueue(long size, long flip)
+    {
+        FILE *file = fopen(s_queuePath, "rb");
+        if (!file)
+        {
+            return false;
+        }
+        Aws::Crt::String contents(static_cast<size_t>(size), '\0');
+        size_t read = fread(&contents[0], 1, contents.size(), file);
+        fclose(file);
+        if (read != contents.size())
+        {
+            return false;
+        }
+        if (flip >= 0 && flip < size)
+        {
+            contents[static_cast<size_t>(flip)] = static_cast<char>(~contents[static_cast<size_t>(flip)]);
+        }
+
+        file = fopen(s_queuePath, "wb");
+        if (!file)
+        {
+            return false;
+        }
+        bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+        return fclose(file) == 0 && written;
+    }
+
+    /*
+     * A shadow client whose updates go to the offline queue at s_queuePath. Its connection is never
+     * connected, so nothing is ever drained and everything enqueued stays in the file.
+     */
+    struct OfflineFixture
+    {
+        explicit OfflineFixture(Aws::Crt::Allocator *allocator)
+            : EventLoopGroup(1, allocator), HostResolver(EventLoopGroup, 8, 30, allocator),
+              Bootstrap(EventLoopGroup, HostResolver, allocator), MqttClient(Bootstrap, allocator)
+        {
+            Bootstrap.EnableBlockingShutdown();
+            Connection = MqttClient.NewConnection("localhost", 1883, SocketOptions);
+        }
+
+        /* Opens the queue as a restarted process would, along with a client using it. */
+        bool Open(Aws::Crt::Allocator *allocator)
+        {
+            Client.reset();
+            Aws::Iotdevicecommon::ServiceClientConfig config;
+            config.OfflineQueue = Aws::Iotdevicecommon::DurablePublishQueue::Open(
+                s_queuePath, Aws::Iotdevicecommon::DurablePublishQueueConfig(), allocator);
+            if (!Connection || !config.OfflineQueue)
+            {
+                return false;
+            }
+            Queue = config.OfflineQueue;
+            Client.emplace(Connection, config, allocator);
+            return true;
+        }
+
+        /* Drops the client and the queue, closing the file. */
+        void Close()
+        {
+            Client.reset();
+            Queue.reset();
+        }
+
+        bool Update(const char *thingName, const char *key, int value)
+        {
+            Aws::Iotshadow::UpdateShadowRequest request;
+            request.ThingName = Aws::Crt::String(thingName);
+            request.State = Aws::Iotshadow::ShadowState();
+            request.State->Reported = Aws::Crt::JsonObject().WithInteger(key, value);
+            return Client->PublishUpdateShadow(request, AWS_MQTT_QOS_AT_LEAST_ONCE, nullptr);
+        }
+
+        Aws::Crt::Io::EventLoopGroup EventLoopGroup;
+        Aws::Crt::Io::DefaultHostResolver HostResolver;
+        Aws::Crt::Io::ClientBootstrap Bootstrap;
+        Aws::Crt::Io::SocketOptions SocketOptions;
+        Aws::Crt::Mqtt::MqttClient MqttClient;
+        std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> Connection;
+        std::shared_ptr<Aws::Iotdevicecommon::DurablePublishQueue> Queue;
+        Aws::Crt::Optional<Aws::Iotshadow::IotShadowClient> Client;
+    };
+} // namespace
+
+static int s_TestShadowOfflineQueueRecovery(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        s_removeQueue();
+        OfflineFixture fixture(allocator);
+        ASSERT_TRUE(fixture.Open(allocator));
+        ASSERT_UINT_EQUALS(0, fixture.Queue->GetQueuedCount());
+
+        /* Updates to the same shadow fold into one; another shadow's stays apart. */
+        ASSERT_TRUE(fixture.Update("ThingA", "temperature", 20));
+        ASSERT_TRUE(fixture.Update("ThingA", "humidity", 40));
+        ASSERT_TRUE(fixture.Update("ThingB", "temperature", 21));
+        ASSERT_UINT_EQUALS(2, fixture.Queue->GetQueuedCount());
+        uint64_t queuedBytes = fixture.Queue->GetQueuedBytes();
+        ASSERT_TRUE(queuedBytes > 0);
+
+        /* A restart recovers both, superseded records and all, without counting the folded one twice. */
+        fixture.Close();
+        ASSERT_TRUE(fixture.Open(allocator));
+        ASSERT_UINT_EQUALS(2, fixture.Queue->GetQueuedCount());
+        ASSERT_UINT_EQUALS(queuedBytes, fixture.Queue->GetQueuedBytes());
+
+        /* A recovered update still folds with the next one to its shadow, and that survives the next restart. */
+        ASSERT_TRUE(fixture.Update("ThingA", "temperature", 22));
+        ASSERT_UINT_EQUALS(2, fixture.Queue->GetQueuedCount());
+        queuedBytes = fixture.Queue->GetQueuedBytes();
+        fixture.Close();
+        ASSERT_TRUE(fixture.Open(allocator));
+        ASSERT_UINT_EQUALS(2, fixture.Queue->GetQueuedCount());
+        ASSERT_UINT_EQUALS(queuedBytes, fixture.Queue->GetQueuedBytes());
+
+        fixture.Close();
+        s_removeQueue();
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowOfflineQueueRecovery, s_TestShadowOfflineQueueRecovery)
+
+static int s_TestShadowOfflineQueueDamagedRecords(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        s_removeQueue();
+        OfflineFixture fixture(allocator);
+        ASSERT_TRUE(fixture.Open(allocator));
+        ASSERT_TRUE(fixture.Update("ThingA", "temperature", 20));
+        long oneRecord = s_fileSize(s_queuePath);
+        ASSERT_TRUE(oneRecord > 0);
+        ASSERT_TRUE(fixture.Update("ThingB", "temperature", 21));
+        long twoRecords = s_fileSize(s_queuePath);
+        ASSERT_TRUE(fixture.Update("ThingC", "temperature", 22));
+        long threeRecords = s_fileSize(s_queuePath);
+        ASSERT_TRUE(oneRecord < twoRecords && twoRecords < threeRecords);
+        fixture.Close();
+
+        /* A record torn off mid-write, as by a crash, ends recovery; those before it are kept. */
+        ASSERT_TRUE(s_damageQueue(threeRecords - 3, -1));
+        ASSERT_TRUE(fixture.Open(allocator));
+        ASSERT_UINT_EQUALS(2, fixture.Queue->GetQueuedCount());
+        fixture.Close();
+
+        /* Recovery rewrote the file without the torn tail, so a record with a bad checksum is the last one. */
+        ASSERT_INT_EQUALS(twoRecords, s_fileSize(s_queuePath));
+        ASSERT_TRUE(s_damageQueue(twoRecords, twoRecords - 1));
+        ASSERT_TRUE(fixture.Open(allocator));
+        ASSERT_UINT_EQUALS(1, fixture.Queue->GetQueuedCount());
+
+        /* What is queued after a damaged recovery is appended to the clean file and recovered in turn. */
+        ASSERT_TRUE(fixture.Update("ThingD", "temperature", 23));
+        uint64_t queuedBytes = fixture.Queue->GetQueuedBytes();
+        fixture.Close();
+        ASSERT_TRUE(fixture.Open(allocator));
+        ASSERT_UINT_EQUALS(2, fixture.Queue->GetQueuedCount());
+        ASSERT_UINT_EQUALS(queuedBytes, fixture.Queue->GetQueuedBytes());
+        fixture.Close();
+
+        /* A file that is not a queue at all recovers as an empty one rather than failing to open. */
+        ASSERT_TRUE(s_damageQueue(s_fileSize(s_queuePath), 0));
+        ASSERT_TRUE(fixture.Open(allocator));
+        ASSERT_UINT_EQUALS(0, fixture.Queue->GetQueuedCount());
+        ASSERT_UINT_EQUALS(0, fixture.Queue->GetQueuedBytes());
+
+        fixture.Close();
+        s_removeQueue();
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowOfflineQueueDamagedRecords, s_TestShadowOfflineQueueDamagedRecords)
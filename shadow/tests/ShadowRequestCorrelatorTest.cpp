@@ -0,0 +1,169 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotshadow/ShadowRequestCorrelator.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <aws/mqtt/mqtt.h>
+
+#include <condition_variable>
+#include <mutex>
+
+namespace
+{
+    /* What each completion saw, in the order they completed. */
+    struct Completions
+    {
+        template <typename Response> std::function<void(Response *, Aws::Iotshadow::ErrorResponse *, int)> Record(
+            const char *name)
+        {
+            Aws::Crt::String label(name);
+            return [this, label](Response *response, Aws::Iotshadow::ErrorResponse *error, int ioErr) {
+                std::lock_guard<std::mutex> guard(Lock);
+                Aws::Crt::String outcome(label);
+                outcome.append(response ? ":accepted" : error ? ":rejected" : ":failed");
+                Order.push_back(outcome);
+                Errors.push_back(ioErr);
+                Signal.notify_all();
+            };
+        }
+
+        bool WaitFor(size_t count)
+        {
+            std::unique_lock<std::mutex> guard(Lock);
+            return Signal.wait_for(guard, std::chrono::seconds(30), [this, count]() { return Order.size() >= count; });
+        }
+
+        std::mutex Lock;
+        std::condition_variable Signal;
+        Aws::Crt::Vector<Aws::Crt::String> Order;
+        Aws::Crt::Vector<int> Errors;
+    };
+} // namespace
+
+/*
+ * The connection is never connected, so no response ever arrives: every request either times out or is
+ * cancelled.
+ */
+static int s_TestShadowRequestCorrelatorTimeout(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        Aws::Crt::Io::EventLoopGroup eventLoopGroup(1, allocator);
+        Aws::Crt::Io::DefaultHostResolver hostResolver(eventLoopGroup, 8, 30, allocator);
+        Aws::Crt::Io::ClientBootstrap clientBootstrap(eventLoopGroup, hostResolver, allocator);
+        clientBootstrap.EnableBlockingShutdown();
+        Aws::Crt::Mqtt::MqttClient mqttClient(clientBootstrap, allocator);
+        Aws::Crt::Io::SocketOptions socketOptions;
+        auto connection = mqttClient.NewConnection("localhost", 1883, socketOptions);
+        ASSERT_NOT_NULL(connection.get());
+        Aws::Iotshadow::IotShadowClient shadowClient(connection, allocator);
+
+        /* Once with a task per request, once with the timeouts in a shared wheel. */
+        for (int useWheel = 0; useWheel < 2; ++useWheel)
+        {
+            Aws::Iotshadow::ShadowRequestCorrelatorConfig config;
+            config.RequestTimeoutMs = 50;
+            if (useWheel)
+            {
+                config.Timers = Aws::Iotdevicecommon::TimerWheel::Create(eventLoopGroup, 10, allocator);
+                ASSERT_NOT_NULL(config.Timers.get());
+            }
+            auto correlator = Aws::Iotshadow::ShadowRequestCorrelator::Create(
+                shadowClient, eventLoopGroup, "TestThing", config, allocator);
+            ASSERT_NOT_NULL(correlator.get());
+            ASSERT_TRUE(correlator->Subscribe(AWS_MQTT_QOS_AT_LEAST_ONCE, nullptr));
+
+            Completions completions;
+            Aws::Iotshadow::ShadowState state;
+            state.Reported = Aws::Crt::JsonObject().WithBool("on", true);
+            ASSERT_TRUE(correlator->GetShadowAsync(
+                AWS_MQTT_QOS_AT_LEAST_ONCE, completions.Record<Aws::Iotshadow::GetShadowResponse>("get")));
+            ASSERT_TRUE(correlator->GetShadowAsync(
+                AWS_MQTT_QOS_AT_LEAST_ONCE, completions.Record<Aws::Iotshadow::GetShadowResponse>("joined")));
+            ASSERT_TRUE(correlator->UpdateShadowAsync(
+                state,
+                Aws::Crt::Optional<int32_t>(),
+                AWS_MQTT_QOS_AT_LEAST_ONCE,
+                completions.Record<Aws::Iotshadow::UpdateShadowResponse>("update")));
+            ASSERT_UINT_EQUALS(3, correlator->GetInFlightCount());
+
+            /* The joined get completes with the one it joined, and ahead of it. */
+            ASSERT_TRUE(completions.WaitFor(3));
+            {
+                std::lock_guard<std::mutex> guard(completions.Lock);
+                ASSERT_UINT_EQUALS(3, completions.Order.size());
+                size_t get = 3;
+                size_t joined = 3;
+                for (size_t i = 0; i < completions.Order.size(); ++i)
+                {
+                    get = completions.Order[i] == "get:failed" ? i : get;
+                    joined = completions.Order[i] == "joined:failed" ? i : joined;
+                    ASSERT_INT_EQUALS(AWS_ERROR_MQTT_TIMEOUT, completions.Errors[i]);
+                }
+                ASSERT_TRUE(joined < get && get < 3);
+            }
+            ASSERT_UINT_EQUALS(0, correlator->GetInFlightCount());
+            if (config.Timers)
+            {
+                ASSERT_UINT_EQUALS(0, config.Timers->GetTimerCount());
+            }
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowRequestCorrelatorTimeout, s_TestShadowRequestCorrelatorTimeout)
+
+static int s_TestShadowRequestCorrelatorCancelAll(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        Aws::Crt::ApiHandle apiHandle(allocator);
+        Aws::Crt::Io::EventLoopGroup eventLoopGroup(1, allocator);
+        Aws::Crt::Io::DefaultHostResolver hostResolver(eventLoopGroup, 8, 30, allocator);
+        Aws::Crt::Io::ClientBootstrap clientBootstrap(eventLoopGroup, hostResolver, allocator);
+        clientBootstrap.EnableBlockingShutdown();
+        Aws::Crt::Mqtt::MqttClient mqttClient(clientBootstrap, allocator);
+        Aws::Crt::Io::SocketOptions socketOptions;
+        auto connection = mqttClient.NewConnection("localhost", 1883, socketOptions);
+        ASSERT_NOT_NULL(connection.get());
+        Aws::Iotshadow::IotShadowClient shadowClient(connection, allocator);
+
+        auto timers = Aws::Iotdevicecommon::TimerWheel::Create(eventLoopGroup, 10, allocator);
+        ASSERT_NOT_NULL(timers.get());
+        Aws::Iotshadow::ShadowRequestCorrelatorConfig config;
+        config.Timers = timers;
+        auto correlator = Aws::Iotshadow::ShadowRequestCorrelator::CreateNamed(
+            shadowClient, eventLoopGroup, "TestThing", "config", config, allocator);
+        ASSERT_NOT_NULL(correlator.get());
+        ASSERT_TRUE(correlator->Subscribe(AWS_MQTT_QOS_AT_LEAST_ONCE, nullptr));
+
+        Completions completions;
+        ASSERT_TRUE(correlator->GetShadowAsync(
+            AWS_MQTT_QOS_AT_LEAST_ONCE, completions.Record<Aws::Iotshadow::GetShadowResponse>("get")));
+        ASSERT_TRUE(correlator->DeleteShadowAsync(
+            AWS_MQTT_QOS_AT_LEAST_ONCE, completions.Record<Aws::Iotshadow::DeleteShadowResponse>("delete")));
+        ASSERT_UINT_EQUALS(2, correlator->GetInFlightCount());
+        ASSERT_UINT_EQUALS(2, timers->GetTimerCount());
+
+        /* Cancelling completes everything in flight at once, and takes the timeouts with it. */
+        correlator->CancelAll(AWS_ERROR_INVALID_STATE);
+        ASSERT_TRUE(completions.WaitFor(2));
+        ASSERT_UINT_EQUALS(0, correlator->GetInFlightCount());
+        ASSERT_UINT_EQUALS(0, timers->GetTimerCount());
+        for (int ioErr : completions.Errors)
+        {
+            ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, ioErr);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowRequestCorrelatorCancelAll, s_TestShadowRequestCorrelatorCancelAll)